@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef RMF_FLEET_ADAPTER__PATHREQUESTBATCH_HPP
+#define RMF_FLEET_ADAPTER__PATHREQUESTBATCH_HPP
+
+#include <rmf_fleet_msgs/msg/path_request.hpp>
+#include <std_msgs/msg/u_int8_multi_array.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+
+//==============================================================================
+/// The message type that is published on PathRequestBatchTopicName. Each
+/// message carries the path requests of several robots of one fleet, so that
+/// a fleet driver receives one message instead of one per robot when many
+/// robots are given new paths at the same time, such as after a negotiation.
+using PathRequestBatch = std_msgs::msg::UInt8MultiArray;
+
+//==============================================================================
+/// Thrown when a PathRequestBatch cannot be decoded.
+class PathRequestBatchError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+/// Pack path requests into a batch. The data is laid out as
+///   [count: u32] ([size: u32][CDR PathRequest])...
+/// with every integer stored little-endian.
+PathRequestBatch encode_path_request_batch(
+  const std::vector<rmf_fleet_msgs::msg::PathRequest>& requests);
+
+//==============================================================================
+/// Unpack the path requests of a batch.
+///
+/// \throws PathRequestBatchError if the batch is malformed.
+std::vector<rmf_fleet_msgs::msg::PathRequest> decode_path_request_batch(
+  const PathRequestBatch& batch);
+
+} // namespace rmf_fleet_adapter
+
+#endif // RMF_FLEET_ADAPTER__PATHREQUESTBATCH_HPP
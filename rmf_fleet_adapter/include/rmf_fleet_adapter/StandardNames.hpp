@@ -26,6 +26,7 @@ const std::string FleetStateTopicName = "/fleet_states";
 const std::string DestinationRequestTopicName = "destination_requests";
 const std::string ModeRequestTopicName = "robot_mode_requests";
 const std::string PathRequestTopicName = "robot_path_requests";
+const std::string PathRequestBatchTopicName = "robot_path_request_batches";
 const std::string PauseRequestTopicName = "robot_pause_requests";
 
 const std::string FinalDoorRequestTopicName = "door_requests";
@@ -51,9 +52,12 @@ const std::string LoopRequestTopicName = "loop_requests";
 const std::string TaskSummaryTopicName = "task_summaries";
 
 const std::string BidNoticeTopicName = "rmf_task/bid_notice";
+const std::string BidNoticeTaskTypeTopicPrefix = BidNoticeTopicName + "/type_";
 const std::string BidProposalTopicName = "rmf_task/bid_proposal";
 const std::string DispatchRequestTopicName = "rmf_task/dispatch_request";
 const std::string DispatchAckTopicName = "rmf_task/dispatch_ack";
+const std::string AllocationMetricsTopicName = "rmf_task/allocation_metrics";
+const std::string PhaseMetricsTopicName = "rmf_task/phase_metrics";
 
 const std::string DockSummaryTopicName = "dock_summary";
 
@@ -23,6 +23,7 @@
 
 #include <rmf_traffic/agv/VehicleTraits.hpp>
 #include <rmf_traffic/agv/Graph.hpp>
+#include <rmf_traffic/agv/Planner.hpp>
 
 #include <rclcpp/node.hpp>
 
@@ -98,6 +99,23 @@ public:
     rmf_traffic::agv::VehicleTraits traits,
     rmf_traffic::agv::Graph navigation_graph);
 
+  /// Add a fleet to be adapted using a planner that has already been made.
+  ///
+  /// Fleets whose vehicles have identical traits and navigation graphs can
+  /// share one planner so that its cache only needs to be built and warmed up
+  /// once per process instead of once per fleet. If one of the fleets closes
+  /// lanes, it will switch to its own planner; the others are not affected.
+  ///
+  /// \param[in] fleet_name
+  ///   The name of the fleet that is being added.
+  ///
+  /// \param[in] planner
+  ///   The planner to use for the vehicles in this fleet. Its configuration
+  ///   provides the traits and navigation graph of the fleet.
+  std::shared_ptr<FleetUpdateHandle> add_fleet(
+    const std::string& fleet_name,
+    std::shared_ptr<const rmf_traffic::agv::Planner> planner);
+
   /// Create a traffic light to help manage robots that can only support pause
   /// and resume commands.
   ///
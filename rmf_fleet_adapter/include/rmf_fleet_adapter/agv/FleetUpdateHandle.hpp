@@ -30,6 +30,12 @@
 
 #include <rmf_task/RequestFactory.hpp>
 
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 namespace rmf_fleet_adapter {
 namespace agv {
 
@@ -63,6 +69,10 @@ public:
   ///   delay before the robot is ready to be used.
   ///
   /// \return a handle to give the adapter updates about the robot.
+  ///
+  /// This function may be called from any thread. It returns before the
+  /// participant is registered, and handle_cb will be triggered later from one
+  /// of the adapter's threads.
   void add_robot(
     std::shared_ptr<RobotCommandHandle> command,
     const std::string& name,
@@ -70,12 +80,43 @@ public:
     rmf_traffic::agv::Plan::StartSet start,
     std::function<void(std::shared_ptr<RobotUpdateHandle> handle)> handle_cb);
 
+  /// The arguments of add_robot() for one robot
+  struct NewRobot
+  {
+    std::shared_ptr<RobotCommandHandle> command;
+    std::string name;
+    rmf_traffic::Profile profile;
+    rmf_traffic::agv::Plan::StartSet start;
+    std::function<void(std::shared_ptr<RobotUpdateHandle> handle)> handle_cb;
+  };
+
+  /// Add many robots to this fleet adapter at once. This has the same effect
+  /// as calling add_robot() for each of them, but all the robots are
+  /// registered with the schedule node in one request, and their setup is
+  /// split across task_estimation_threads() threads. This is the fastest way
+  /// to bring up a large fleet.
+  ///
+  /// This function may be called from any thread. It returns before the
+  /// participants are registered, and the handle_cb of each robot will be
+  /// triggered later from one of the adapter's threads.
+  void add_robots(std::vector<NewRobot> robots);
+
   /// Specify a set of lanes that should be closed.
   void close_lanes(std::vector<std::size_t> lane_indices);
 
   /// Specify a set of lanes that should be open.
   void open_lanes(std::vector<std::size_t> lane_indices);
 
+  /// Open and close several lanes as one change. The planner of the fleet is
+  /// rebuilt once for all of them, and only if any lane actually changes, so
+  /// the robots and their plan caches only ever see a single new planner. A
+  /// lane that appears in both lists will be closed. If any lane index is not
+  /// in the navigation graph, the whole update is rejected with an error in
+  /// the log and none of the lanes change.
+  void update_lanes(
+    std::vector<std::size_t> open_lane_indices,
+    std::vector<std::size_t> close_lane_indices);
+
   /// Set the parameters required for task planning. Without calling this
   /// function, this fleet will not bid for and accept tasks.
   ///
@@ -112,6 +153,12 @@ public:
   ///   A factory for a request that should be performed by each robot in this
   ///   fleet at the end of its assignments.
   ///
+  /// \param[in] bid_planning_budget
+  ///   The fraction of a BidNotice's time window that may be spent searching
+  ///   for the optimal assignments of a bid. Once it runs out, the bid is made
+  ///   with greedy assignments so that it still arrives before the auction is
+  ///   decided. A value of 0.0 or less lets the search run without a limit.
+  ///
   /// \return true if task planner parameters were successfully updated.
   bool set_task_planner_params(
     std::shared_ptr<rmf_battery::agv::BatterySystem> battery_system,
@@ -121,7 +168,8 @@ public:
     double recharge_threshold,
     double recharge_soc,
     bool account_for_battery_drain,
-    rmf_task::ConstRequestFactoryPtr finishing_requst = nullptr);
+    rmf_task::ConstRequestFactoryPtr finishing_requst = nullptr,
+    double bid_planning_budget = 0.5);
 
   /// A callback function that evaluates whether a fleet will accept a task
   /// request
@@ -144,6 +192,15 @@ public:
   /// adapter internally.
   FleetUpdateHandle& accept_task_requests(AcceptTaskRequest check);
 
+  /// Declare the types of tasks that this fleet can perform, using the values
+  /// of rmf_task_msgs::msg::TaskType. The fleet will then only be sent the
+  /// BidNotices of those task types, so it does not receive and decode the
+  /// notices of tasks that it could never bid on. The callback given to
+  /// accept_task_requests() is still used to decide on the tasks of these
+  /// types. By default the fleet receives the BidNotices of every task type.
+  FleetUpdateHandle& accept_task_types(
+    const std::unordered_set<uint32_t>& types);
+
   /// A callback function that evaluates whether a fleet will accept a delivery
   /// request.
   ///
@@ -176,12 +233,430 @@ public:
   /// Get the default value for the maximum acceptable delay.
   std::optional<rmf_traffic::Duration> default_maximum_delay() const;
 
+  /// Specify how many traffic negotiation responses the robots of this fleet
+  /// may be calculating at once. Any further negotiation tables will wait
+  /// until a response finishes, with the deepest tables and the nearest
+  /// deadlines going first. Tables that go stale while waiting will be
+  /// forfeited. A std::nullopt value removes the limit. The default value is
+  /// 10.
+  FleetUpdateHandle& max_concurrent_negotiations(
+    std::optional<std::size_t> value);
+
+  /// Get the limit on concurrent negotiation responses.
+  std::optional<std::size_t> max_concurrent_negotiations() const;
+
+  /// Specify how many task allocations this fleet may plan at once. When many
+  /// tasks are submitted together, their bids are planned in parallel against
+  /// the same queues, and each one is reconciled with the tasks that were
+  /// awarded in the meantime when its own award arrives. A value of 1 plans
+  /// the bids one at a time. Values below 1 are treated as 1. The default
+  /// value is 4.
+  FleetUpdateHandle& max_concurrent_allocations(std::size_t value);
+
+  /// Get the limit on concurrent task allocations.
+  std::size_t max_concurrent_allocations() const;
+
+  /// Specify how long to collect task bid notices before planning them
+  /// together. When this has a value, the notices that arrive within that
+  /// period of the first one form a bundle, and all of their tasks are
+  /// allocated in one plan instead of one plan each. Each task still gets its
+  /// own proposal, and its cost is an equal share of the cost that the whole
+  /// bundle adds to the fleet. Since the fleet might not be awarded every task
+  /// of a bundle, each awarded task is allocated again on its own. A
+  /// std::nullopt value plans each notice as soon as it arrives, which is the
+  /// default.
+  FleetUpdateHandle& bid_bundle_period(
+    std::optional<rmf_traffic::Duration> value);
+
+  /// Get how long task bid notices are collected before they are planned.
+  std::optional<rmf_traffic::Duration> bid_bundle_period() const;
+
+  /// Specify how often the delays of the robots are reported to the traffic
+  /// schedule. When this has a value, the delays that the robots notice while
+  /// they move are collected and applied together once per period, which lets
+  /// the schedule writer send them in one batch. The threshold for reporting a
+  /// delay then rises while many robots of the fleet are delayed at once, and a
+  /// delay that would reverse the previous one must be twice as large. A
+  /// std::nullopt value applies each delay larger than 500ms as soon as it is
+  /// noticed, which is the default.
+  FleetUpdateHandle& delay_report_period(
+    std::optional<rmf_traffic::Duration> value);
+
+  /// Get how often the delays of the robots are reported.
+  std::optional<rmf_traffic::Duration> delay_report_period() const;
+
+  /// Specify whether new tasks should be allocated incrementally. When this is
+  /// enabled, the bid for a new task only considers inserting that task into
+  /// the current queues of the robots, so the time it takes grows with the
+  /// size of the queues rather than with the number of ways to rearrange
+  /// them. If the task cannot be inserted anywhere, every queued task will be
+  /// replanned as usual. This is disabled by default.
+  ///
+  /// \param[in] enable
+  ///   True to allocate new tasks incrementally.
+  ///
+  /// \param[in] optimize_in_background
+  ///   If true, every queued task will be replanned in the background after
+  ///   each incremental allocation is dispatched, and the result will replace
+  ///   the queues if it lowers their cost.
+  FleetUpdateHandle& incremental_task_allocation(
+    bool enable,
+    bool optimize_in_background = true);
+
+  /// Check whether new tasks are being allocated incrementally.
+  bool incremental_task_allocation() const;
+
+  /// Specify whether queued tasks should be cancelled without replanning the
+  /// whole fleet. When this is enabled, a cancelled task is taken out of the
+  /// queue of its robot, and only the tasks after it in that queue are
+  /// estimated again. If that queue can no longer be performed, every queued
+  /// task will be replanned as usual. This is disabled by default.
+  ///
+  /// \param[in] enable
+  ///   True to cancel tasks without replanning the whole fleet.
+  ///
+  /// \param[in] optimize_in_background
+  ///   If true, every queued task will be replanned in the background after
+  ///   each cancellation, and the result will replace the queues if it lowers
+  ///   their cost.
+  FleetUpdateHandle& fast_task_cancellation(
+    bool enable,
+    bool optimize_in_background = true);
+
+  /// Check whether tasks are being cancelled without replanning the fleet.
+  bool fast_task_cancellation() const;
+
+  /// Specify how many threads each task allocation may use to estimate the
+  /// finish states of the robots and to evaluate incremental insertions for
+  /// each robot. The results do not depend on the number of threads. A value
+  /// of 1 evaluates the robots one after another. Values below 1 are treated
+  /// as 1. The default value is 1.
+  FleetUpdateHandle& task_estimation_threads(std::size_t value);
+
+  /// Get the number of threads used to evaluate the robots.
+  std::size_t task_estimation_threads() const;
+
+  /// Measurements of a single task allocation, reported once its result has
+  /// been delivered back to the fleet.
+  struct AllocationMetrics
+  {
+    enum class Kind
+    {
+      /// Planning the bid for a BidNotice
+      Bid,
+      /// Replanning a bid whose assignments went stale before its award
+      Dispatch,
+      /// Replanning the queues without a cancelled task
+      Cancel,
+      /// Replanning the queues in the background
+      Optimization
+    };
+
+    Kind kind = Kind::Bid;
+
+    /// The task that the allocation was for. This is empty for optimizations.
+    std::string task_id;
+
+    /// The number of robots that were planned for
+    std::size_t robots = 0;
+
+    /// The number of requests that were planned for
+    std::size_t requests = 0;
+
+    /// How long the allocation waited for a planning slot
+    rmf_traffic::Duration queue_wait = rmf_traffic::Duration(0);
+
+    /// How long the allocation took to plan. This is zero for a cached result.
+    rmf_traffic::Duration planning_duration = rmf_traffic::Duration(0);
+
+    /// True if the result was taken from the allocation cache
+    bool cached = false;
+
+    /// True if the planning deadline of a bid was reached, so greedy
+    /// assignments were used instead of optimal ones
+    bool greedy = false;
+
+    /// The cost of the assignments, or std::nullopt if none could be found
+    std::optional<double> cost;
+
+    /// For bids that were proposed, the time from receiving the BidNotice to
+    /// publishing the BidProposal
+    std::optional<rmf_traffic::Duration> notice_to_proposal;
+  };
+
+  /// A histogram of how long one stage of one type of phase took for one
+  /// robot, collected over one period of phase_metrics_publish_period().
+  struct PhaseMetrics
+  {
+    enum class Stage
+    {
+      /// From the start of a GoToPlace phase until it executes its first plan
+      TimeToFirstPlan,
+      /// Searching for a plan, including emergency pullovers
+      Planning,
+      /// From being asked to respond to a negotiation until responding
+      NegotiationWait,
+      /// Waiting for a door to reach the requested mode
+      DoorWait,
+      /// Waiting for a lift to reach the requested floor with open doors
+      LiftWait,
+      /// From the start of a phase until it finishes
+      Execution
+    };
+
+    /// The name of the robot
+    std::string robot;
+
+    /// The type of phase, e.g. GoToPlace or DoorOpen
+    std::string phase;
+
+    Stage stage = Stage::Execution;
+
+    /// The number of samples
+    std::size_t count = 0;
+
+    /// The sum of the samples
+    rmf_traffic::Duration total = rmf_traffic::Duration(0);
+
+    /// The shortest sample
+    rmf_traffic::Duration min = rmf_traffic::Duration(0);
+
+    /// The longest sample
+    rmf_traffic::Duration max = rmf_traffic::Duration(0);
+
+    /// The upper bound of each bucket of the histogram, in increasing order
+    std::vector<rmf_traffic::Duration> bucket_bounds;
+
+    /// The number of samples in each bucket. This has one more element than
+    /// bucket_bounds, which counts the samples above the last bound.
+    std::vector<std::size_t> bucket_counts;
+  };
+
+  /// Specify whether the robots of this fleet should plan ahead. When this is
+  /// enabled, the path for the next phase of a task is planned while the
+  /// current phase is still active, starting from where the current phase is
+  /// expected to finish. The path for the first phase of the next task in the
+  /// queue is planned the same way. When the phase begins, the prepared path
+  /// is used if the robot is where it was expected to be and the path is free
+  /// of conflicts with the current schedule. Otherwise a new path is planned
+  /// as usual. This is disabled by default.
+  FleetUpdateHandle& phase_lookahead(bool enable);
+
+  /// Check whether the robots of this fleet plan ahead.
+  bool phase_lookahead() const;
+
+  /// Specify whether the robots of this fleet should ask for doors to open
+  /// before they arrive at them. When this is enabled, a robot sends its door
+  /// open request early enough that the door should be open by the time the
+  /// robot reaches it, according to the robot's plan and how long the door has
+  /// taken to open before. The request belongs to the same door supervisor
+  /// session that the robot uses once it arrives, and it is withdrawn if the
+  /// robot stops heading for the door. This is disabled by default.
+  FleetUpdateHandle& predictive_door_requests(bool enable);
+
+  /// Check whether the robots of this fleet ask for doors to open early.
+  bool predictive_door_requests() const;
+
+  /// Specify whether the robots of this fleet should summon lifts before they
+  /// arrive at them. When this is enabled, a robot begins its lift session
+  /// early enough that the lift should be waiting at the robot's floor when
+  /// the robot gets there, according to the robot's plan and how long the
+  /// lift has taken to arrive before. The session is ended if the robot stops
+  /// heading for the lift. This is disabled by default.
+  FleetUpdateHandle& predictive_lift_requests(bool enable);
+
+  /// Check whether the robots of this fleet summon lifts early.
+  bool predictive_lift_requests() const;
+
+  /// Specify how long before a robot of this fleet arrives at the pickup of a
+  /// delivery it should send its request to the dispenser, so that the
+  /// dispenser can have the items staged by the time the robot gets there.
+  /// The arrival time is taken from the robot's itinerary and is given as the
+  /// time stamp of the request. The robot uses the same request once it has
+  /// arrived. Only use this if the dispensers of the fleet hold on to the
+  /// items until the robot is in place. If this is a nullopt, the request is
+  /// sent once the robot has arrived. That is the default.
+  ///
+  /// Enable phase_lookahead as well to have the drop-off leg planned while
+  /// the items are being dispensed.
+  FleetUpdateHandle& dispenser_lead_time(
+    std::optional<rmf_traffic::Duration> value);
+
+  /// Get how long before their arrival the robots send dispenser requests.
+  std::optional<rmf_traffic::Duration> dispenser_lead_time() const;
+
+  /// A collection of state updates for robots of this fleet. Each function
+  /// accepts the same arguments as the matching function of RobotUpdateHandle,
+  /// but nothing happens until the collection is given to update_robots().
+  class RobotUpdates
+  {
+  public:
+
+    /// Create an empty collection of updates
+    RobotUpdates();
+
+    /// Same as RobotUpdateHandle::update_position(std::size_t, double)
+    RobotUpdates& update_position(
+      RobotUpdateHandlePtr robot,
+      std::size_t waypoint,
+      double orientation);
+
+    /// Same as
+    /// RobotUpdateHandle::update_position(Eigen::Vector3d, std::vector)
+    RobotUpdates& update_position(
+      RobotUpdateHandlePtr robot,
+      const Eigen::Vector3d& position,
+      std::vector<std::size_t> lanes);
+
+    /// Same as
+    /// RobotUpdateHandle::update_position(Eigen::Vector3d, std::size_t)
+    RobotUpdates& update_position(
+      RobotUpdateHandlePtr robot,
+      const Eigen::Vector3d& position,
+      std::size_t target_waypoint);
+
+    /// Same as
+    /// RobotUpdateHandle::update_position(std::string, Eigen::Vector3d)
+    RobotUpdates& update_position(
+      RobotUpdateHandlePtr robot,
+      std::string map_name,
+      const Eigen::Vector3d& position,
+      double max_merge_waypoint_distance = 0.1,
+      double max_merge_lane_distance = 1.0,
+      double min_lane_length = 1e-8);
+
+    /// Same as RobotUpdateHandle::update_battery_soc()
+    RobotUpdates& update_battery_soc(
+      RobotUpdateHandlePtr robot,
+      double battery_soc);
+
+    /// Add all of the updates of another collection after the updates of
+    /// this one. This allows the updates of several robots to be collected
+    /// separately, even on different threads, and then applied together.
+    RobotUpdates& append(const RobotUpdates& other);
+
+    /// The number of updates in this collection
+    std::size_t size() const;
+
+    /// Remove all the updates from this collection
+    void clear();
+
+    class Implementation;
+  private:
+    rmf_utils::impl_ptr<Implementation> _pimpl;
+  };
+
+  /// Apply a collection of updates to the robots of this fleet. This has the
+  /// same effect as making each call on the RobotUpdateHandle of the robot,
+  /// except that the updates are all applied together. Robots that share the
+  /// fleet's worker are updated in a single job, and robots that have their
+  /// own worker get one job each no matter how many updates they have.
+  ///
+  /// Updates of one robot are applied in the order that they were added.
+  /// Exceptions that the individual calls would throw, such as for an empty
+  /// set of lanes, are thrown before any of the updates are applied.
+  void update_robots(const RobotUpdates& updates);
+
+  using AllocationMetricsCallback =
+    std::function<void(const AllocationMetrics& metrics)>;
+
+  /// Provide a callback that receives the metrics of every task allocation of
+  /// this fleet. The callback is triggered from the fleet's worker, so it
+  /// should return quickly. The metrics are also published as YAML documents
+  /// on the AllocationMetricsTopicName topic whether or not a callback is
+  /// given.
+  FleetUpdateHandle& allocation_metrics_callback(
+    AllocationMetricsCallback callback);
+
+  using PhaseMetricsCallback =
+    std::function<void(const std::vector<PhaseMetrics>& metrics)>;
+
+  /// Provide a callback that receives the phase metrics histograms of this
+  /// fleet each time they are published. This can be used to export the
+  /// metrics to a monitoring system. The callback is triggered by the timer
+  /// that publishes the metrics, so it should return quickly.
+  FleetUpdateHandle& phase_metrics_callback(PhaseMetricsCallback callback);
+
+  /// Specify how often the robots of this fleet should publish histograms of
+  /// how long their phases take. The histograms of each period are published
+  /// as a YAML document on the PhaseMetricsTopicName topic and given to the
+  /// phase_metrics_callback(). A std::nullopt value stops collecting the
+  /// metrics, which is the default.
+  FleetUpdateHandle& phase_metrics_publish_period(
+    std::optional<rmf_traffic::Duration> value);
+
+  /// Get how often the phase metrics are published.
+  std::optional<rmf_traffic::Duration> phase_metrics_publish_period() const;
+
+  /// Specify how long this fleet keeps what it knows about a task, such as
+  /// its request, its profile and the assignments of its bid, after the
+  /// BidNotice of the task arrived. Tasks that are still being planned,
+  /// queued or performed by this fleet are kept until they are not anymore.
+  /// Bids that are not awarded to this fleet within this time are forgotten,
+  /// and so are tasks that were cancelled or finished. The default is 10
+  /// minutes.
+  ///
+  /// \throws std::runtime_error if the value is not positive.
+  FleetUpdateHandle& bid_lifetime(rmf_traffic::Duration value);
+
+  /// Get how long this fleet keeps what it knows about a task.
+  rmf_traffic::Duration bid_lifetime() const;
+
+  /// Specify how often this fleet should publish an estimate of the memory
+  /// held by its major containers, such as its bids, its task profiles, and
+  /// the negotiations of its adapter. The estimate is published as a YAML
+  /// document on the rmf_traffic_ros2::MemoryUsageTopicName topic. A
+  /// std::nullopt value stops publishing it, which is the default.
+  FleetUpdateHandle& memory_usage_publish_period(
+    std::optional<rmf_traffic::Duration> value);
+
+  /// Get how often the memory usage of this fleet is published.
+  std::optional<rmf_traffic::Duration> memory_usage_publish_period() const;
+
   /// Specify a period for how often the fleet state message is published for
   /// this fleet. Passing in std::nullopt will disable the fleet state message
   /// publishing. The default value is 1s.
   FleetUpdateHandle& fleet_state_publish_period(
     std::optional<rmf_traffic::Duration> value);
 
+  /// Specify a period for publishing the state of every robot of this fleet.
+  /// Between these keyframes, each fleet state message will only contain the
+  /// robots whose state has changed since they were last published, and no
+  /// message is published at all if nothing has changed. Subscribers should
+  /// treat these messages as updates to the robots they contain.
+  ///
+  /// Passing in std::nullopt will publish every robot in every message, which
+  /// is the default.
+  FleetUpdateHandle& fleet_state_keyframe_period(
+    std::optional<rmf_traffic::Duration> value);
+
+  /// Get the period for publishing the state of every robot of this fleet.
+  std::optional<rmf_traffic::Duration> fleet_state_keyframe_period() const;
+
+  /// Keep the runtime state of this fleet in a file, so that a fleet adapter
+  /// which gets restarted can pick up where it left off instead of having all
+  /// of its tasks planned and bid on again. The queue of each robot, the
+  /// profiles of the queued tasks, and the bids that have not been awarded
+  /// yet are saved once every period whenever they have changed.
+  ///
+  /// If the file already holds the state of this fleet, it gets restored.
+  /// Each robot gets its queue back when it is added, and bid notices are held
+  /// back until every saved robot has been added, or until a 30s grace period
+  /// has passed. Tasks that were in progress when the adapter stopped are not
+  /// restored. The schedule node keeps the itineraries of the robots, and it
+  /// gives each participant back its itinerary version when it registers
+  /// again, so those do not need to be saved here.
+  ///
+  /// This should be called after set_task_planner_params() and before any
+  /// robots are added. Passing in std::nullopt will stop saving the state,
+  /// which is the default.
+  FleetUpdateHandle& persist_state(
+    std::optional<std::string> file_path,
+    rmf_traffic::Duration period = std::chrono::seconds(5));
+
+  /// Get the file that the runtime state of this fleet is saved to.
+  std::optional<std::string> persist_state_file() const;
+
   class Implementation;
 private:
   FleetUpdateHandle();
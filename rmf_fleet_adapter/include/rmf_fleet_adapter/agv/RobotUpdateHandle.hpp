@@ -37,6 +37,10 @@ namespace agv {
 /// You will be given an instance of this class every time you add a new robot
 /// to your fleet. Use that instance to send updates to RoMi-H about your
 /// robot's state.
+///
+/// The update functions of this class may be called from any thread. They only
+/// schedule their work onto the worker of the fleet adapter and return without
+/// waiting for it, so they will not block on the adapter's internal state.
 class RobotUpdateHandle
 {
 public:
@@ -81,6 +85,9 @@ public:
   /// We will attempt to merge the robot back onto the navigation graph. The
   /// parameters for this function are passed along to
   /// rmf_traffic::agv::compute_plan_starts().
+  ///
+  /// \note See position_update_tolerance() to avoid repeating this search when
+  /// the robot is only moving a little between updates.
   void update_position(
     const std::string& map_name,
     const Eigen::Vector3d& position,
@@ -88,6 +95,17 @@ public:
     const double max_merge_lane_distance = 1.0,
     const double min_lane_length = 1e-8);
 
+  /// Specify how far the robot needs to move before
+  /// update_position(std::string, Eigen::Vector3d) searches the navigation
+  /// graph for where the robot should merge again. Until then, the result of
+  /// the previous search will be reused with the new pose of the robot.
+  ///
+  /// The default value of 0.0 searches the navigation graph on every update.
+  RobotUpdateHandle& position_update_tolerance(double distance);
+
+  /// Get the value for the position update tolerance.
+  double position_update_tolerance() const;
+
   /// Set the waypoint where the charger for this robot is located.
   /// If not specified, the nearest waypoint in the graph with the is_charger()
   /// property will be assumed as the charger for this robot.
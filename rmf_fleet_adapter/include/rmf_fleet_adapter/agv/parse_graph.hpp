@@ -23,16 +23,116 @@
 
 #include <rmf_utils/optional.hpp>
 
+#include <Eigen/Geometry>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
 namespace rmf_fleet_adapter {
 namespace agv {
 
+/// A callback that receives a description of a problem which parse_graph()
+/// was able to work around.
+using GraphWarningCallback = std::function<void(const std::string& message)>;
+
 /// Parse the graph described by a yaml file.
 ///
+/// \param[in] filename
+///   The yaml file that describes the graph
+///
+/// \param[in] vehicle_traits
+///   The traits of the vehicles that will use the graph
+///
+/// \param[in] warning
+///   Told when a compiled graph file is present but cannot be used, e.g.
+///   because it is corrupted, in which case the yaml file is parsed instead.
+///   This may be left as nullptr.
+///
 /// \warning This will throw a std::runtime_error if the file has a syntax
 /// error.
 rmf_traffic::agv::Graph parse_graph(
   const std::string& filename,
-  const rmf_traffic::agv::VehicleTraits& vehicle_traits);
+  const rmf_traffic::agv::VehicleTraits& vehicle_traits,
+  const GraphWarningCallback& warning = nullptr);
+
+/// Get the name of the compiled graph file that parse_graph() will look for
+/// alongside the given yaml file. When that file exists and is at least as new
+/// as the yaml file, parse_graph() will load it instead of parsing the yaml.
+std::string compiled_graph_file(const std::string& filename);
+
+/// Compile the graph described by a yaml file into a binary file that can be
+/// loaded much faster than the yaml. The compiled file does not depend on the
+/// vehicle traits, so one file can be shared by every fleet that uses the
+/// graph.
+///
+/// \warning This will throw a std::runtime_error if the yaml file has a syntax
+/// error or if the output file cannot be written.
+void compile_graph(
+  const std::string& filename,
+  const std::string& output_file);
+
+/// Properties that add_waypoints() can give to a waypoint. These may be
+/// combined with bitwise OR.
+enum WaypointFlag : uint8_t
+{
+  HoldingPoint = 1 << 0,
+  PassthroughPoint = 1 << 1,
+  ParkingSpot = 1 << 2,
+  Charger = 1 << 3
+};
+
+/// Add many waypoints to a graph at once. Waypoint i is placed at
+/// locations[i] on the map named map_names[map_indices[i]] and is given the
+/// properties of flags[i].
+///
+/// \param[in] flags
+///   A combination of WaypointFlag values for each waypoint. This may be left
+///   empty if none of the waypoints have any special properties.
+///
+/// \warning This will throw a std::runtime_error if the arguments do not have
+/// matching sizes or if a map index is out of range. The graph is not changed
+/// in that case.
+///
+/// \return the index of the first waypoint that was added.
+std::size_t add_waypoints(
+  rmf_traffic::agv::Graph& graph,
+  const std::vector<std::string>& map_names,
+  const std::vector<std::size_t>& map_indices,
+  const std::vector<Eigen::Vector2d>& locations,
+  const std::vector<uint8_t>& flags = {});
+
+/// Add many lanes to a graph at once. Lane i goes from the waypoint
+/// lanes[i][0] to the waypoint lanes[i][1].
+///
+/// \param[in] door_names
+///   The name of the door that each lane passes through, or an empty string
+///   for lanes without a door. Lanes with a door open it when they are entered
+///   and close it when they are exited, like the door_name option of
+///   parse_graph(). This may be left empty if none of the lanes have a door.
+///
+/// \param[in] dock_names
+///   The name of the dock at the end of each lane, or an empty string for
+///   lanes without a dock, like the dock_name option of parse_graph(). This
+///   may be left empty if none of the lanes have a dock.
+///
+/// \param[in] bidirectional
+///   If true, every lane is followed by a lane in the opposite direction. The
+///   opposite lane goes through the same door but does not have a dock.
+///
+/// \warning This will throw a std::runtime_error if the arguments do not have
+/// matching sizes, if a waypoint index is out of range, or if a lane has both
+/// a door and a dock. The graph is not changed in that case.
+///
+/// \return the index of the first lane that was added.
+std::size_t add_lanes(
+  rmf_traffic::agv::Graph& graph,
+  const std::vector<std::array<std::size_t, 2>>& lanes,
+  const std::vector<std::string>& door_names = {},
+  const std::vector<std::string>& dock_names = {},
+  bool bidirectional = false);
 
 } // namespace agv
 } // namespace rmf_fleet_adapter
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef RMF_RXCPP__CALLBACKTIMING_HPP
+#define RMF_RXCPP__CALLBACKTIMING_HPP
+
+#include <rclcpp/any_executable.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeinfo>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+namespace rmf_rxcpp {
+
+//==============================================================================
+/// An opt-in hook that is told how long each callback of an RxCppExecutor and
+/// each planning job ran for. Nothing is timed while no observer is set. The
+/// observer is shared by the whole process.
+class CallbackTiming
+{
+public:
+
+  using Duration = std::chrono::steady_clock::duration;
+
+  struct Observer
+  {
+    /// Told about each callback that an RxCppExecutor ran
+    std::function<void(const rclcpp::AnyExecutable&, Duration)> callback;
+
+    /// Told about each job that ran on the PlanningScheduler, by the name of
+    /// the type of its action
+    std::function<void(const std::string& job, Duration)> job;
+  };
+
+  /// Set the observer, or pass in nullptr to stop timing
+  static void set_observer(std::shared_ptr<const Observer> observer)
+  {
+    std::atomic_store(&_observer(), std::move(observer));
+  }
+
+  /// Get the current observer, if there is one
+  static std::shared_ptr<const Observer> observer()
+  {
+    return std::atomic_load(&_observer());
+  }
+
+  /// Run a job and tell the observer how long it took
+  template<typename Action, typename Job>
+  static void time_job(Job&& job)
+  {
+    const auto current = observer();
+    if (!current || !current->job)
+    {
+      job();
+      return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    job();
+    current->job(job_name<Action>(), std::chrono::steady_clock::now() - start);
+  }
+
+  /// The readable name of the type of an action
+  template<typename Action>
+  static const std::string& job_name()
+  {
+    static const std::string name = "job " + _demangle(typeid(Action).name());
+    return name;
+  }
+
+private:
+
+  static std::shared_ptr<const Observer>& _observer()
+  {
+    static std::shared_ptr<const Observer> observer;
+    return observer;
+  }
+
+  static std::string _demangle(const char* name)
+  {
+#ifdef __GNUG__
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status == 0 && demangled)
+    {
+      std::string result(demangled);
+      std::free(demangled);
+      return result;
+    }
+#endif
+    return name;
+  }
+};
+
+} // namespace rmf_rxcpp
+
+#endif // RMF_RXCPP__CALLBACKTIMING_HPP
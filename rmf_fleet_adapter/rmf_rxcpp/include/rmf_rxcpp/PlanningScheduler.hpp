@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef RMF_RXCPP__PLANNINGSCHEDULER_HPP
+#define RMF_RXCPP__PLANNINGSCHEDULER_HPP
+
+#include <rmf_rxcpp/detail/PlanningSchedulerDetail.hpp>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rmf_rxcpp {
+
+//==============================================================================
+/// Each priority level of planning work gets its own pool of threads, so that
+/// a flood of low priority work can never starve the high priority work of
+/// threads.
+enum class PlanningPriority : std::size_t
+{
+  /// Work that a robot is actively waiting on
+  High = 0,
+
+  /// The default level for jobs
+  Normal = 1,
+
+  /// Speculative work, like searching for alternative routes while
+  /// negotiating
+  Low = 2
+};
+
+//==============================================================================
+/// The schedulers that all rmf_rxcpp jobs run on. Unlike the rxcpp event
+/// loop, the number of threads, which CPUs they may run on, and how nice they
+/// are to other threads can be configured, so that planning does not compete
+/// with the middleware threads for the same cores.
+///
+/// The threads of a priority level are started the first time a job of that
+/// level is created. After that, its settings can no longer be changed.
+class PlanningScheduler
+{
+public:
+
+  struct Options
+  {
+    /// The number of threads. Zero means one thread per hardware core.
+    std::size_t threads = 0;
+
+    /// The CPUs that the threads may run on. An empty list means that the
+    /// threads may run on any CPU.
+    std::vector<int> cpu_affinity = {};
+
+    /// The niceness of the threads. Higher values give the threads a lower
+    /// priority. Lowering the niceness below zero normally requires elevated
+    /// permissions, in which case the threads will keep the default niceness.
+    int niceness = 0;
+
+    /// The SCHED_FIFO priority of the threads, from 1 to 99. Zero keeps the
+    /// normal time-sharing scheduling, in which case the niceness applies.
+    /// This normally requires elevated permissions as well.
+    int realtime_priority = 0;
+  };
+
+  /// Change the settings for a priority level.
+  ///
+  /// \return false if the threads of this level have already been started, in
+  /// which case nothing is changed.
+  static bool configure(PlanningPriority priority, Options options)
+  {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    const auto i = static_cast<std::size_t>(priority);
+    if (s.schedulers[i])
+      return false;
+
+    s.options[i] = std::move(options);
+    return true;
+  }
+
+  /// Get the current settings for a priority level.
+  static Options options(PlanningPriority priority)
+  {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.options[static_cast<std::size_t>(priority)];
+  }
+
+  /// Get the scheduler for a priority level, starting its threads if needed.
+  static rxcpp::schedulers::scheduler get(
+    PlanningPriority priority = PlanningPriority::Normal)
+  {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    const auto i = static_cast<std::size_t>(priority);
+    auto& scheduler = s.schedulers[i];
+    if (!scheduler)
+    {
+      scheduler = std::make_shared<rxcpp::schedulers::scheduler>(
+        make_scheduler(s.options[i]));
+    }
+
+    return *scheduler;
+  }
+
+  /// Make a standalone scheduler that follows the given settings. This is
+  /// independent of the schedulers that get() provides.
+  static rxcpp::schedulers::scheduler make_scheduler(const Options& options)
+  {
+    std::size_t threads = options.threads;
+    if (threads == 0)
+      threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    const auto cpu_affinity = options.cpu_affinity;
+    const int niceness = options.niceness;
+    const int realtime_priority = options.realtime_priority;
+    return rxcpp::schedulers::make_scheduler<detail::planning_loop>(
+      threads,
+      [cpu_affinity, niceness, realtime_priority](std::function<void()> start)
+      {
+        return std::thread(
+          [cpu_affinity, niceness, realtime_priority,
+          start = std::move(start)]()
+          {
+            detail::apply_thread_settings(
+              cpu_affinity, niceness, realtime_priority);
+            start();
+          });
+      });
+  }
+
+private:
+
+  struct State
+  {
+    std::mutex mutex;
+    std::array<Options, 3> options = default_options();
+    std::array<std::shared_ptr<rxcpp::schedulers::scheduler>, 3> schedulers;
+  };
+
+  static std::array<Options, 3> default_options()
+  {
+    std::array<Options, 3> options;
+    const auto low = static_cast<std::size_t>(PlanningPriority::Low);
+    options[low].threads =
+      std::max(std::thread::hardware_concurrency()/2, 1u);
+    options[low].niceness = 5;
+    return options;
+  }
+
+  static State& state()
+  {
+    static State s;
+    return s;
+  }
+};
+
+} // namespace rmf_rxcpp
+
+#endif // RMF_RXCPP__PLANNINGSCHEDULER_HPP
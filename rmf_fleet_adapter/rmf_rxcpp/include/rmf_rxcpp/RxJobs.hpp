@@ -26,24 +26,30 @@
 namespace rmf_rxcpp {
 
 template<typename T, typename Action>
-inline auto make_job(const std::shared_ptr<Action>& action)
+inline auto make_job(
+  const std::shared_ptr<Action>& action,
+  PlanningPriority priority = PlanningPriority::Normal)
 {
-  return detail::make_observable<T>(action);
+  return detail::make_observable<T>(action, priority);
 }
 
 template<typename Job0, typename... Jobs>
 inline auto merge_jobs(const Job0& o0, Jobs&& ... os)
 {
-  return o0.merge(rxcpp::serialize_event_loop(), os...);
+  return o0.merge(
+    rxcpp::serialize_one_worker(PlanningScheduler::get()), os...);
 }
 
 template<typename ActionsIterable>
-inline auto make_job_from_action_list(const ActionsIterable& actions)
+inline auto make_job_from_action_list(
+  const ActionsIterable& actions,
+  PlanningPriority priority = PlanningPriority::Normal)
 {
   using Action =
     typename std::iterator_traits<decltype(actions.begin())>::value_type::
     element_type;
-  return detail::make_merged_observable<typename Action::Result>(actions);
+  return detail::make_merged_observable<typename Action::Result>(
+    actions, priority);
 }
 
 struct subscription_guard
@@ -19,10 +19,19 @@
 #define RMF_RXCPP__TRANSPORT_HPP
 
 #include <rmf_rxcpp/detail/TransportDetail.hpp>
+#include <rmf_rxcpp/CallbackTiming.hpp>
 #include <rmf_rxcpp/RxJobs.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <rclcpp/scope_exit.hpp>
 #include <rxcpp/rx.hpp>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace rmf_rxcpp {
 
@@ -31,11 +40,27 @@ class RxCppExecutor :
   public std::enable_shared_from_this<RxCppExecutor>
 {
 public:
+
+  /// How the spin thread waits for ROS events
+  enum class Wakeup
+  {
+    /// Wake up every 50ms to check whether work is available or whether the
+    /// executor should stop.
+    Polling,
+
+    /// Sleep until the middleware reports that work is available or until
+    /// stop() is called. The wait set is interrupted by the guard condition
+    /// of the executor, so nothing needs to be checked periodically.
+    EventDriven
+  };
+
   RxCppExecutor(
     rxcpp::schedulers::worker worker,
-    const rclcpp::ExecutorOptions& options = rclcpp::ExecutorOptions())
+    const rclcpp::ExecutorOptions& options = rclcpp::ExecutorOptions(),
+    Wakeup wakeup = Wakeup::EventDriven)
   : rclcpp::Executor{options},
     _worker{std::move(worker)},
+    _wakeup{wakeup},
     _started{false},
     _stopping{false},
     _work_scheduled{false}
@@ -65,7 +90,10 @@ public:
         {
           if (const auto& self = w.lock())
           {
-            self->spin_some();
+            if (const auto observer = CallbackTiming::observer())
+              self->_spin_some_timed(*observer);
+            else
+              self->spin_some();
 
             {
               std::lock_guard<std::mutex> lock(self->_mutex);
@@ -82,7 +110,8 @@ public:
         {
           // If work is already scheduled to be done, wait until there is no
           // longer any work scheduled (or if we're no longer supposed to keep
-          // spinning).
+          // spinning). The worker notifies us as soon as it is done, so the
+          // timeout only matters if the context gets shut down meanwhile.
           _cv.wait_for(lock, std::chrono::milliseconds(50), [&]()
             {
               return !_work_scheduled || !keep_spinning();
@@ -90,12 +119,20 @@ public:
         }
       }
 
-      // TODO(MXG): It would be better if we could check whether work is really
-      // available before we keep looping. Or if we could interrupt an
-      // indefinite wait when a stop is requested (maybe by creating a no-op
-      // timer callback?).
-      if (keep_spinning())
+      if (!keep_spinning())
+        break;
+
+      if (_wakeup == Wakeup::EventDriven)
+      {
+        // This blocks until there is work for the next spin_some(). A stop()
+        // or a shutdown of the context triggers a guard condition of the
+        // executor, which wakes this up right away.
+        wait_for_work(std::chrono::nanoseconds(-1));
+      }
+      else
+      {
         wait_for_work(std::chrono::milliseconds(50));
+      }
     }
 
     _started = false;
@@ -106,6 +143,9 @@ public:
   {
     _stopping = true;
     _cv.notify_all();
+
+    // Interrupt the wait set in case the spin thread is blocked on it
+    cancel();
   }
 
   void wait_until_started()
@@ -118,14 +158,38 @@ public:
   }
 
 private:
-  rxcpp::schedulers::worker _worker;
 
+  /// This does the same as spin_some(), except that it tells the observer how
+  /// long each callback took
+  void _spin_some_timed(const CallbackTiming::Observer& observer)
+  {
+    if (spinning.exchange(true))
+      throw std::runtime_error("spin_some() called while already spinning");
+
+    RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
+
+    wait_for_work(std::chrono::milliseconds(0));
+    while (spinning.load())
+    {
+      rclcpp::AnyExecutable executable;
+      if (!get_next_ready_executable(executable))
+        break;
+
+      const auto start = std::chrono::steady_clock::now();
+      execute_any_executable(executable);
+      if (observer.callback)
+        observer.callback(executable, std::chrono::steady_clock::now() - start);
+    }
+  }
+
+  rxcpp::schedulers::worker _worker;
+  Wakeup _wakeup;
 
   bool _started;
   std::mutex _starting_mutex;
   std::condition_variable _started_cv;
 
-  bool _stopping;
+  std::atomic_bool _stopping;
 
   bool _work_scheduled;
   std::mutex _mutex;
@@ -137,6 +201,8 @@ class SubscriptionBridge
 {
 public:
 
+  using MessagePtr = typename Message::SharedPtr;
+
   SubscriptionBridge(
     rclcpp::Node::SharedPtr node,
     const std::string& topic_name,
@@ -153,6 +219,30 @@ public:
     _observable = _publisher.get_observable();
   }
 
+  /// Tag for creating a bridge whose rclcpp subscription only exists while
+  /// something is observing it
+  struct Lazy {};
+
+  SubscriptionBridge(
+    Lazy,
+    rclcpp::Node::SharedPtr node,
+    const std::string& topic_name,
+    const rclcpp::QoS& qos)
+  {
+    auto shared = std::make_shared<Shared>(
+      node, topic_name, qos, _publisher);
+
+    _observable = rxcpp::observable<>::create<MessagePtr>(
+      [shared, publisher = _publisher](rxcpp::subscriber<MessagePtr> s)
+      {
+        // If s has already been unsubscribed, then add() will release it
+        // right away, so every acquire() is always matched by a release().
+        shared->acquire();
+        s.add([shared]() { shared->release(); });
+        publisher.get_observable().subscribe(s);
+      }).as_dynamic();
+  }
+
   const rxcpp::observable<typename Message::SharedPtr>& observe() const
   {
     return _observable;
@@ -164,12 +254,218 @@ public:
   }
 
 private:
+
+  // The state of a lazy bridge, which counts how many observers it has
+  struct Shared
+  {
+    Shared(
+      const rclcpp::Node::SharedPtr& node_,
+      std::string topic_name_,
+      rclcpp::QoS qos_,
+      rxcpp::subjects::subject<MessagePtr> publisher_)
+    : node(node_),
+      topic_name(std::move(topic_name_)),
+      qos(std::move(qos_)),
+      publisher(std::move(publisher_))
+    {
+      // Do nothing
+    }
+
+    void acquire()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (observers++ > 0)
+        return;
+
+      const auto n = node.lock();
+      if (!n)
+        return;
+
+      subscription = n->create_subscription<Message>(
+        topic_name, qos,
+        [publisher = publisher](MessagePtr msg)
+        {
+          publisher.get_subscriber().on_next(msg);
+        });
+    }
+
+    void release()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--observers == 0)
+        subscription.reset();
+    }
+
+    // The node owns the bridge, so only a weak reference is kept here
+    std::weak_ptr<rclcpp::Node> node;
+    std::string topic_name;
+    rclcpp::QoS qos;
+    rxcpp::subjects::subject<MessagePtr> publisher;
+
+    std::mutex mutex;
+    std::size_t observers = 0;
+    typename rclcpp::Subscription<Message>::SharedPtr subscription;
+  };
+
   rxcpp::subjects::subject<typename Message::SharedPtr> _publisher;
   rxcpp::observable<typename Message::SharedPtr> _observable;
   typename rclcpp::Subscription<Message>::SharedPtr _subscription;
 
 };
 
+//==============================================================================
+/// Bridges an rclcpp subscription to observers that are each only interested
+/// in the messages with a certain key, such as the name of a door. Every
+/// message is handed straight to the observers of its key, instead of passing
+/// through a subject that every observer of the topic is subscribed to.
+///
+/// The observers of each key are kept in an immutable routing table. The
+/// subscription callback only loads the current table, while adding or
+/// removing an observer replaces the table with an updated copy, so
+/// delivering a message never takes a lock. Like a lazy SubscriptionBridge,
+/// the rclcpp subscription only exists while there is at least one observer.
+template<typename Message, typename Key>
+class KeyedSubscriptionBridge
+{
+public:
+
+  using MessagePtr = typename Message::SharedPtr;
+  using KeyOf = std::function<Key(const Message&)>;
+
+  KeyedSubscriptionBridge(
+    rclcpp::Node::SharedPtr node,
+    const std::string& topic_name,
+    const rclcpp::QoS& qos,
+    KeyOf key_of)
+  : _shared(std::make_shared<Shared>(
+        node, topic_name, qos, std::move(key_of)))
+  {
+    // Do nothing
+  }
+
+  /// Observe the messages whose key matches the given key
+  rxcpp::observable<MessagePtr> observe(Key key) const
+  {
+    return rxcpp::observable<>::create<MessagePtr>(
+      [shared = _shared, key = std::move(key)](
+        rxcpp::subscriber<MessagePtr> s)
+      {
+        const auto id = shared->add(key, s);
+        s.add([shared, key, id]() { shared->remove(key, id); });
+      }).as_dynamic();
+  }
+
+  ~KeyedSubscriptionBridge()
+  {
+    const auto routes = std::atomic_load(&_shared->routes);
+    for (const auto& route : *routes)
+    {
+      for (const auto& observer : route.second)
+        observer.second.on_completed();
+    }
+  }
+
+private:
+
+  using Observers =
+    std::vector<std::pair<std::size_t, rxcpp::subscriber<MessagePtr>>>;
+  using Routes = std::unordered_map<Key, Observers>;
+
+  struct Shared : std::enable_shared_from_this<Shared>
+  {
+    Shared(
+      const rclcpp::Node::SharedPtr& node_,
+      std::string topic_name_,
+      rclcpp::QoS qos_,
+      KeyOf key_of_)
+    : node(node_),
+      topic_name(std::move(topic_name_)),
+      qos(std::move(qos_)),
+      key_of(std::move(key_of_)),
+      routes(std::make_shared<const Routes>())
+    {
+      // Do nothing
+    }
+
+    std::size_t add(const Key& key, rxcpp::subscriber<MessagePtr> s)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      const auto id = next_id++;
+      auto updated = std::make_shared<Routes>(*routes);
+      (*updated)[key].emplace_back(id, std::move(s));
+      std::atomic_store(&routes, std::shared_ptr<const Routes>(updated));
+
+      if (observers++ == 0)
+      {
+        if (const auto n = node.lock())
+        {
+          subscription = n->create_subscription<Message>(
+            topic_name, qos,
+            [w = this->weak_from_this()](MessagePtr msg)
+            {
+              if (const auto self = w.lock())
+                self->deliver(msg);
+            });
+        }
+      }
+
+      return id;
+    }
+
+    void remove(const Key& key, const std::size_t id)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto updated = std::make_shared<Routes>(*routes);
+      const auto it = updated->find(key);
+      if (it == updated->end())
+        return;
+
+      auto& list = it->second;
+      const auto erased = std::remove_if(
+        list.begin(), list.end(),
+        [id](const auto& observer) { return observer.first == id; });
+      if (erased == list.end())
+        return;
+
+      list.erase(erased, list.end());
+      if (list.empty())
+        updated->erase(it);
+
+      std::atomic_store(&routes, std::shared_ptr<const Routes>(updated));
+
+      if (--observers == 0)
+        subscription.reset();
+    }
+
+    void deliver(const MessagePtr& msg) const
+    {
+      const auto current = std::atomic_load(&routes);
+      const auto it = current->find(key_of(*msg));
+      if (it == current->end())
+        return;
+
+      for (const auto& observer : it->second)
+        observer.second.on_next(msg);
+    }
+
+    // The node owns the bridge, so only a weak reference is kept here
+    std::weak_ptr<rclcpp::Node> node;
+    std::string topic_name;
+    rclcpp::QoS qos;
+    KeyOf key_of;
+
+    // This is only read and written through std::atomic_load and
+    // std::atomic_store. The mutex only serializes the writers.
+    std::shared_ptr<const Routes> routes;
+    std::mutex mutex;
+    std::size_t next_id = 0;
+    std::size_t observers = 0;
+    typename rclcpp::Subscription<Message>::SharedPtr subscription;
+  };
+
+  std::shared_ptr<Shared> _shared;
+};
+
 // TODO(MXG): We define all the member functions of this class inline so that we
 // don't need to export/install rmf_rxcpp as its own shared library (linking to
 // it as a static library results in linking errors related to symbols not being
@@ -182,6 +478,9 @@ public:
   template<typename Message>
   using Bridge = std::shared_ptr<SubscriptionBridge<Message>>;
 
+  template<typename Message, typename Key>
+  using KeyedBridge = std::shared_ptr<KeyedSubscriptionBridge<Message, Key>>;
+
   explicit Transport(
     rxcpp::schedulers::worker worker,
     const std::string& node_name,
@@ -193,6 +492,15 @@ public:
     // Do nothing
   }
 
+  /// Set a function for the spin thread to run before it starts spinning,
+  /// e.g. to change how the operating system schedules it. This takes effect
+  /// the next time start() is called.
+  void set_spin_thread_setup(std::function<void()> setup)
+  {
+    std::unique_lock<std::mutex> lock(_stopping_mutex);
+    _spin_thread_setup = std::move(setup);
+  }
+
   void start()
   {
     std::unique_lock<std::mutex> lock(_stopping_mutex);
@@ -207,8 +515,11 @@ public:
 
     _stopped = false;
 
-    _spin_thread = std::thread([&]()
+    _spin_thread = std::thread([&, setup = _spin_thread_setup]()
         {
+          if (setup)
+            setup();
+
           _executor->spin();
         });
 
@@ -259,6 +570,49 @@ public:
       SubscriptionBridge<Message>>(shared_from_this(), topic_name, qos);
   }
 
+  /**
+   * Like create_observable, except that the rclcpp subscription is only created
+   * while the observable has subscribers, and it is destroyed again when the
+   * last of them unsubscribes. Use this for topics that are only needed once
+   * in a while, so that their messages are not received and deserialized the
+   * rest of the time. Messages that are published while nothing is observing
+   * are missed, so the observers should not depend on them.
+   * @tparam Message
+   * @param topic_name
+   * @param qos
+   * @return
+   */
+  template<typename Message>
+  Bridge<Message> create_lazy_observable(
+    const std::string& topic_name, const rclcpp::QoS& qos)
+  {
+    return std::make_shared<SubscriptionBridge<Message>>(
+      typename SubscriptionBridge<Message>::Lazy(),
+      shared_from_this(), topic_name, qos);
+  }
+
+  /**
+   * Creates a bridge whose observers each pick the key of the messages that
+   * they want to receive. The key of each message is given by key_of. Like
+   * create_lazy_observable, the rclcpp subscription only exists while the
+   * bridge has observers.
+   * @tparam Message
+   * @tparam Key
+   * @param topic_name
+   * @param qos
+   * @param key_of
+   * @return
+   */
+  template<typename Message, typename Key>
+  KeyedBridge<Message, Key> create_keyed_observable(
+    const std::string& topic_name,
+    const rclcpp::QoS& qos,
+    typename KeyedSubscriptionBridge<Message, Key>::KeyOf key_of)
+  {
+    return std::make_shared<KeyedSubscriptionBridge<Message, Key>>(
+      shared_from_this(), topic_name, qos, std::move(key_of));
+  }
+
   ~Transport()
   {
     stop();
@@ -272,6 +626,7 @@ private:
   std::shared_ptr<RxCppExecutor> _executor;
   bool _node_added = false;
   std::thread _spin_thread;
+  std::function<void()> _spin_thread_setup;
 
   static rclcpp::ExecutorOptions _make_exec_args(
     const rclcpp::NodeOptions& options)
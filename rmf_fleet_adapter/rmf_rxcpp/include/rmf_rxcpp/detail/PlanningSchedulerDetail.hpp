@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef RMF_RXCPP__DETAIL__PLANNINGSCHEDULERDETAIL_HPP
+#define RMF_RXCPP__DETAIL__PLANNINGSCHEDULERDETAIL_HPP
+
+#include <rxcpp/rx.hpp>
+
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace rmf_rxcpp {
+namespace detail {
+
+//==============================================================================
+/// Pin the calling thread to a set of CPUs, give it a niceness and, if
+/// realtime_priority is not zero, a SCHED_FIFO priority. This is a best
+/// effort: if the platform or the permissions of the process do not allow it,
+/// the thread simply keeps running with its inherited settings.
+inline void apply_thread_settings(
+  const std::vector<int>& cpu_affinity,
+  int niceness,
+  int realtime_priority = 0)
+{
+#ifdef __linux__
+  if (!cpu_affinity.empty())
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto cpu : cpu_affinity)
+    {
+      if (0 <= cpu && cpu < CPU_SETSIZE)
+        CPU_SET(cpu, &set);
+    }
+
+    if (CPU_COUNT(&set) > 0)
+      pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  }
+
+  if (niceness != 0)
+  {
+    // On Linux the niceness is an attribute of each thread, so this does not
+    // affect the rest of the process.
+    const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    setpriority(PRIO_PROCESS, tid, niceness);
+  }
+
+  if (realtime_priority != 0)
+  {
+    sched_param param{};
+    param.sched_priority = realtime_priority;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  }
+#else
+  (void)cpu_affinity;
+  (void)niceness;
+  (void)realtime_priority;
+#endif
+}
+
+//==============================================================================
+/// A scheduler that distributes its workers over a fixed number of threads.
+/// This is the same as rxcpp::schedulers::event_loop except that the number
+/// of threads is chosen by the caller instead of being derived from the
+/// hardware.
+struct planning_loop : public rxcpp::schedulers::scheduler_interface
+{
+private:
+  using clock_type = rxcpp::schedulers::scheduler_interface::clock_type;
+  using worker = rxcpp::schedulers::worker;
+  using schedulable = rxcpp::schedulers::schedulable;
+  using composite_subscription = rxcpp::composite_subscription;
+
+  struct loop_worker : public rxcpp::schedulers::worker_interface
+  {
+    loop_worker(
+      composite_subscription cs,
+      worker w,
+      std::shared_ptr<const rxcpp::schedulers::scheduler_interface> alive)
+    : lifetime(cs),
+      controller(w),
+      alive(std::move(alive))
+    {
+      auto token = controller.add(cs);
+      cs.add([token, w]()
+        {
+          w.remove(token);
+        });
+    }
+
+    clock_type::time_point now() const override
+    {
+      return clock_type::now();
+    }
+
+    void schedule(const schedulable& scbl) const override
+    {
+      controller.schedule(lifetime, scbl.get_action());
+    }
+
+    void schedule(
+      clock_type::time_point when,
+      const schedulable& scbl) const override
+    {
+      controller.schedule(when, lifetime, scbl.get_action());
+    }
+
+    composite_subscription lifetime;
+    worker controller;
+    std::shared_ptr<const rxcpp::schedulers::scheduler_interface> alive;
+  };
+
+public:
+  planning_loop(std::size_t threads, rxcpp::schedulers::thread_factory tf)
+  : _newthread(rxcpp::schedulers::make_new_thread(std::move(tf))),
+    _count(0)
+  {
+    for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i)
+      _loops.push_back(_newthread.create_worker(_loops_lifetime));
+  }
+
+  planning_loop(const planning_loop&) = delete;
+
+  ~planning_loop()
+  {
+    _loops_lifetime.unsubscribe();
+  }
+
+  clock_type::time_point now() const override
+  {
+    return clock_type::now();
+  }
+
+  worker create_worker(composite_subscription cs) const override
+  {
+    return worker(
+      cs, std::make_shared<loop_worker>(
+        cs, _loops[++_count % _loops.size()], this->shared_from_this()));
+  }
+
+  std::size_t thread_count() const
+  {
+    return _loops.size();
+  }
+
+private:
+  rxcpp::schedulers::scheduler _newthread;
+  mutable std::atomic<std::size_t> _count;
+  composite_subscription _loops_lifetime;
+  std::vector<worker> _loops;
+};
+
+} // namespace detail
+} // namespace rmf_rxcpp
+
+#endif // RMF_RXCPP__DETAIL__PLANNINGSCHEDULERDETAIL_HPP
@@ -18,6 +18,8 @@
 #ifndef RMF_RXCPP__RXJOBSDETAIL_HPP
 #define RMF_RXCPP__RXJOBSDETAIL_HPP
 
+#include <rmf_rxcpp/CallbackTiming.hpp>
+#include <rmf_rxcpp/PlanningScheduler.hpp>
 #include <rxcpp/rx.hpp>
 
 namespace rmf_rxcpp {
@@ -38,7 +40,7 @@ void schedule_job(
     [a, s, w](const auto&)
     {
       if (const auto action = a.lock())
-        (*action)(s, w);
+        CallbackTiming::time_job<Action>([&]() { (*action)(s, w); });
     });
 }
 
@@ -53,61 +55,63 @@ void schedule_job(
     [a, s](const auto&)
     {
       if (const auto action = a.lock())
-        (*action)(s);
+        CallbackTiming::time_job<Action>([&]() { (*action)(s); });
     });
 }
 
-inline auto get_event_loop()
-{
-  static auto event_loop = rxcpp::schedulers::make_event_loop();
-  return event_loop;
-}
-
 /**
- * Creates an observable from a job, the observable runs the job in an event loop until it has
- * completed or cancelled. Each progress update on a job is queued at the back of the event loop
+ * Creates an observable from a job, the observable runs the job in a planning scheduler until it has
+ * completed or cancelled. Each progress update on a job is queued at the back of the scheduler
  * so that other jobs has a chance to start before earlier jobs are finished.
  *
  * @tparam Action
  * @tparam Result
  * @param action
+ * @param priority
  * @return
  */
 template<typename T, typename Action>
-auto make_observable(const std::shared_ptr<Action>& action)
+auto make_observable(
+  const std::shared_ptr<Action>& action,
+  PlanningPriority priority = PlanningPriority::Normal)
 {
   return rxcpp::observable<>::create<T>(
-    [a = std::weak_ptr<Action>(action)](const auto& s)
+    [a = std::weak_ptr<Action>(action), priority](const auto& s)
     {
-      auto worker = get_event_loop().create_worker();
+      auto worker = PlanningScheduler::get(priority).create_worker();
       detail::schedule_job(a, s, worker);
     });
 }
 
 /// Alternative to make_observable that is unconcerned about memory leaks
 template<typename T, typename Action>
-auto make_leaky_observable(const std::shared_ptr<Action>& action)
+auto make_leaky_observable(
+  const std::shared_ptr<Action>& action,
+  PlanningPriority priority = PlanningPriority::Normal)
 {
   return rxcpp::observable<>::create<T>(
-    [a = std::move(action)](const auto& s)
+    [a = std::move(action), priority](const auto& s)
     {
-      auto worker = get_event_loop().create_worker();
+      auto worker = PlanningScheduler::get(priority).create_worker();
       detail::schedule_job(a, s, worker);
     });
 }
 
 template<typename T, typename ActionsIterable>
-auto make_merged_observable(const ActionsIterable& actions)
+auto make_merged_observable(
+  const ActionsIterable& actions,
+  PlanningPriority priority = PlanningPriority::Normal)
 {
   // needed to prevent dynamic observables, which reduces performance
   using Observable = decltype(detail::make_observable<T>(*actions.begin()));
 
-  return rxcpp::observable<>::create<Observable>([&actions](const auto& s)
-      {
-        for (const auto& a : actions)
-          s.on_next(detail::make_observable<T>(a));
-        s.on_completed();
-      }).merge(rxcpp::serialize_event_loop());
+  return rxcpp::observable<>::create<Observable>(
+    [&actions, priority](const auto& s)
+    {
+      for (const auto& a : actions)
+        s.on_next(detail::make_observable<T>(a, priority));
+      s.on_completed();
+    }).merge(rxcpp::serialize_one_worker(PlanningScheduler::get(priority)));
 }
 
 } // namespace detail
@@ -19,6 +19,10 @@
 
 #include <rmf_rxcpp/RxJobs.hpp>
 
+#include <mutex>
+#include <set>
+#include <thread>
+
 struct AsyncCounterAction
 {
   int counter = 0;
@@ -74,3 +78,68 @@ TEST_CASE("make group jobs", "[Jobs]")
     REQUIRE(a->call_count == 1);
   }
 }
+
+struct ThreadIdAction
+{
+  using Result = std::thread::id;
+
+  template<typename Subscriber>
+  void operator()(const Subscriber& s)
+  {
+    s.on_next(std::this_thread::get_id());
+    s.on_completed();
+  }
+};
+
+TEST_CASE("planning scheduler", "[Jobs]")
+{
+  rmf_rxcpp::PlanningScheduler::Options options;
+  options.threads = 2;
+  options.cpu_affinity = {0};
+  options.niceness = 1;
+  const auto scheduler = rmf_rxcpp::PlanningScheduler::make_scheduler(options);
+
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  std::size_t count = 0;
+  rxcpp::observable<>::range(1, 20)
+  .flat_map([&](int)
+    {
+      return rxcpp::observable<>::just(0)
+      .subscribe_on(rxcpp::identity_one_worker(scheduler))
+      .map([](int)
+      {
+        return std::this_thread::get_id();
+      });
+    })
+  .as_blocking()
+  .subscribe([&](const std::thread::id& id)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.insert(id);
+      ++count;
+    });
+
+  CHECK(count == 20);
+  CHECK(threads.size() <= 2);
+
+  std::vector<std::shared_ptr<ThreadIdAction>> actions{
+    std::make_shared<ThreadIdAction>(),
+    std::make_shared<ThreadIdAction>()
+  };
+
+  const auto main_thread = std::this_thread::get_id();
+  std::size_t results = 0;
+  rmf_rxcpp::make_job_from_action_list(
+    actions, rmf_rxcpp::PlanningPriority::Low)
+  .as_blocking()
+  .subscribe([&](const std::thread::id& id)
+    {
+      CHECK(id != main_thread);
+      ++results;
+    });
+  CHECK(results == actions.size());
+
+  CHECK_FALSE(rmf_rxcpp::PlanningScheduler::configure(
+      rmf_rxcpp::PlanningPriority::Low, options));
+}
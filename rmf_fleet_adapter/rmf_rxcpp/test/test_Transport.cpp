@@ -116,3 +116,129 @@ TEST_CASE("publish subscribe loopback", "[Transport]")
     subscription.unsubscribe();
   }
 }
+
+//==============================================================================
+TEST_CASE("lazy observables only subscribe while observed", "[Transport]")
+{
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+
+  auto transport = std::make_shared<rmf_rxcpp::Transport>(
+    rxcpp::schedulers::make_event_loop().create_worker(),
+    "test_transport_" + std::to_string(node_counter++),
+    rclcpp::NodeOptions().context(context));
+
+  transport->start();
+
+  const std::string topic_name = "test_topic_" +
+    std::to_string(topic_counter++);
+
+  auto obs =
+    transport->create_lazy_observable<std_msgs::msg::String>(topic_name, 10);
+  CHECK(transport->count_subscribers(topic_name) == 0);
+
+  rxcpp::composite_subscription first{};
+  rxcpp::composite_subscription second{};
+  obs->observe().subscribe(first);
+  obs->observe().subscribe(second);
+  CHECK(transport->count_subscribers(topic_name) == 1);
+
+  first.unsubscribe();
+  CHECK(transport->count_subscribers(topic_name) == 1);
+
+  second.unsubscribe();
+  CHECK(transport->count_subscribers(topic_name) == 0);
+
+  SECTION("messages reach the observers")
+  {
+    auto publisher = transport->create_publisher<std_msgs::msg::String>(
+      topic_name, 10);
+
+    std_msgs::msg::String msg;
+    msg.data = "hello";
+    auto timer = transport->create_wall_timer(
+      std::chrono::milliseconds(100),
+      [publisher, msg]()
+      {
+        publisher->publish(msg);
+      });
+
+    auto received = std::make_shared<bool>(false);
+    auto action = std::make_shared<TestAction>(obs, received);
+    auto job = rmf_rxcpp::make_job<Empty>(action);
+    job.as_blocking().subscribe();
+
+    CHECK(*received);
+  }
+}
+
+//==============================================================================
+TEST_CASE("keyed observables route messages by key", "[Transport]")
+{
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+
+  auto transport = std::make_shared<rmf_rxcpp::Transport>(
+    rxcpp::schedulers::make_event_loop().create_worker(),
+    "test_transport_" + std::to_string(node_counter++),
+    rclcpp::NodeOptions().context(context));
+
+  transport->start();
+
+  const std::string topic_name = "test_topic_" +
+    std::to_string(topic_counter++);
+
+  auto bridge = transport->create_keyed_observable<
+    std_msgs::msg::String, std::string>(
+    topic_name, 10,
+    [](const std_msgs::msg::String& msg) { return msg.data; });
+  CHECK(transport->count_subscribers(topic_name) == 0);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::size_t hello_count = 0;
+  std::size_t other_count = 0;
+
+  rxcpp::composite_subscription subscription{};
+  bridge->observe("hello").subscribe(
+    subscription,
+    [&](const auto& msg)
+    {
+      CHECK(msg->data == "hello");
+      std::lock_guard<std::mutex> lock(mutex);
+      ++hello_count;
+      cv.notify_all();
+    });
+
+  bridge->observe("other").subscribe(
+    subscription,
+    [&](const auto&)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++other_count;
+    });
+
+  CHECK(transport->count_subscribers(topic_name) == 1);
+
+  auto publisher = transport->create_publisher<std_msgs::msg::String>(
+    topic_name, 10);
+  std_msgs::msg::String msg;
+  msg.data = "hello";
+  auto timer = transport->create_wall_timer(
+    std::chrono::milliseconds(100),
+    [publisher, msg]()
+    {
+      publisher->publish(msg);
+    });
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    CHECK(cv.wait_for(
+        lock, std::chrono::seconds(5), [&]() { return hello_count >= 2; }));
+    CHECK(other_count == 0);
+  }
+
+  timer->cancel();
+  subscription.unsubscribe();
+  CHECK(transport->count_subscribers(topic_name) == 0);
+}
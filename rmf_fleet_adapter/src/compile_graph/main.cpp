@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_fleet_adapter/agv/parse_graph.hpp>
+
+#include <iostream>
+
+//==============================================================================
+int help(const std::string& extra_message)
+{
+  if (!extra_message.empty())
+    std::cout << extra_message << "\n";
+
+  std::cout <<
+    R"raw(
+  Usage:
+    compile_graph <nav_graph.yaml> [output_file]
+
+  If no output_file is given, the compiled graph will be written next to the
+  yaml file where fleet adapters will find it automatically.
+)raw";
+  std::cout << std::endl;
+
+  return 1;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 3)
+    return help("Wrong number of arguments");
+
+  const std::string graph_file = argv[1];
+  const std::string output_file = argc > 2 ?
+    std::string(argv[2]) :
+    rmf_fleet_adapter::agv::compiled_graph_file(graph_file);
+
+  try
+  {
+    rmf_fleet_adapter::agv::compile_graph(graph_file, output_file);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Failed to compile graph [" << graph_file << "]: "
+              << e.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << "Compiled [" << graph_file << "] into [" << output_file << "]"
+            << std::endl;
+
+  return 0;
+}
@@ -17,6 +17,8 @@
 
 #include "Node.hpp"
 
+#include <rclcpp_components/register_node_macro.hpp>
+
 #include <rmf_fleet_adapter/StandardNames.hpp>
 
 namespace rmf_fleet_adapter {
@@ -25,8 +27,8 @@ namespace door_supervisor {
 const std::string DoorSupervisorRequesterID = "door_supervisor";
 
 //==============================================================================
-Node::Node()
-: rclcpp::Node("door_supervisor")
+Node::Node(const rclcpp::NodeOptions& options)
+: rclcpp::Node("door_supervisor", options)
 {
   const auto default_qos = rclcpp::SystemDefaultsQoS();
 
@@ -49,6 +51,22 @@ Node::Node()
 
   _door_heartbeat_pub = create_publisher<Heartbeat>(
     DoorSupervisorHeartbeatTopicName, default_qos);
+
+  const double heartbeat_period =
+    declare_parameter<double>("heartbeat_period", 0.1);
+  if (heartbeat_period > 0.0)
+  {
+    _heartbeat_timer = create_wall_timer(
+      std::chrono::duration<double>(heartbeat_period),
+      [&]()
+      {
+        if (!_heartbeat_pending)
+          return;
+
+        _heartbeat_pending = false;
+        _door_heartbeat_pub->publish(_heartbeat);
+      });
+  }
 }
 
 //==============================================================================
@@ -74,7 +92,16 @@ void Node::_process_open_request(
   {
     // Use the latest time in the log
     auto& logged_request_time = insertion.first->second;
-    logged_request_time = std::max(logged_request_time, rclcpp::Time(time));
+    const auto new_request_time = rclcpp::Time(time);
+    if (logged_request_time < new_request_time)
+    {
+      logged_request_time = new_request_time;
+      _update_sessions(door_name);
+    }
+  }
+  else
+  {
+    _update_sessions(door_name);
   }
 
   _send_open_request(door_name);
@@ -114,6 +141,7 @@ void Node::_process_close_request(
 
   // We can remove this requester from the log of open requests
   door_log.erase(request_it);
+  _update_sessions(door_name);
 
   if (!door_log.empty())
     return _publish_heartbeat();
@@ -168,24 +196,39 @@ void Node::_door_state_update(DoorState::UniquePtr msg)
 //==============================================================================
 void Node::_publish_heartbeat()
 {
-  rmf_door_msgs::msg::SupervisorHeartbeat msg;
-  for (const auto& door : _log)
+  if (_heartbeat_timer)
   {
-    rmf_door_msgs::msg::DoorSessions sessions;
-    sessions.door_name = door.first;
-    for (const auto& session : door.second)
-    {
-      rmf_door_msgs::msg::Session s;
-      s.request_time = session.second;
-      s.requester_id = session.first;
-      sessions.sessions.emplace_back(std::move(s));
-    }
+    _heartbeat_pending = true;
+    return;
+  }
 
-    msg.all_sessions.emplace_back(std::move(sessions));
+  _door_heartbeat_pub->publish(_heartbeat);
+}
+
+//==============================================================================
+void Node::_update_sessions(const std::string& door_name)
+{
+  const auto insertion =
+    _heartbeat_index.insert({door_name, _heartbeat.all_sessions.size()});
+  if (insertion.second)
+  {
+    rmf_door_msgs::msg::DoorSessions door_sessions;
+    door_sessions.door_name = door_name;
+    _heartbeat.all_sessions.emplace_back(std::move(door_sessions));
   }
 
-  _door_heartbeat_pub->publish(msg);
+  auto& sessions = _heartbeat.all_sessions[insertion.first->second].sessions;
+  sessions.clear();
+  for (const auto& session : _log.at(door_name))
+  {
+    rmf_door_msgs::msg::Session s;
+    s.request_time = session.second;
+    s.requester_id = session.first;
+    sessions.emplace_back(std::move(s));
+  }
 }
 
 } // namespace door_supervisor
 } // namespace rmf_fleet_adapter
+
+RCLCPP_COMPONENTS_REGISTER_NODE(rmf_fleet_adapter::door_supervisor::Node)
@@ -22,6 +22,7 @@
 #include <rmf_door_msgs/msg/door_request.hpp>
 #include <rmf_door_msgs/msg/supervisor_heartbeat.hpp>
 
+#include <chrono>
 #include <string>
 #include <unordered_map>
 
@@ -33,7 +34,8 @@ class Node : public rclcpp::Node
 {
 public:
 
-  Node();
+  explicit Node(
+    const rclcpp::NodeOptions& options = rclcpp::NodeOptions());
 
 private:
 
@@ -69,13 +71,26 @@ private:
   using Heartbeat = rmf_door_msgs::msg::SupervisorHeartbeat;
   using HeartbeatPub = rclcpp::Publisher<Heartbeat>;
   HeartbeatPub::SharedPtr _door_heartbeat_pub;
+
+  /// Ask for a heartbeat to be published. When a heartbeat period is set,
+  /// all the requests within one period share a single heartbeat.
   void _publish_heartbeat();
 
+  /// Refresh the heartbeat entry of a door after its sessions have changed
+  void _update_sessions(const std::string& door_name);
+
   using OpenRequestLog =
     std::unordered_map<
     std::string,
     std::unordered_map<std::string, rclcpp::Time>>;
   OpenRequestLog _log;
+
+  // The heartbeat is kept up to date one door at a time, so publishing it does
+  // not require visiting every door and session in the log.
+  Heartbeat _heartbeat;
+  std::unordered_map<std::string, std::size_t> _heartbeat_index;
+  bool _heartbeat_pending = false;
+  rclcpp::TimerBase::SharedPtr _heartbeat_timer;
 };
 
 } // namespace door_supervisor
@@ -0,0 +1,884 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// This is a load generator for full control fleet adapters. It hosts any
+// number of mock robots in a single fleet adapter and drives them itself.
+// The robots follow the plans that they are given in simulated time instead
+// of driving slotcars, so a single process can run a fleet of hundreds of
+// robots.
+//
+// The robots are laid out on a grid of waypoints that has no doors or lifts.
+// A stub dispatcher sends a loop task to the fleet every task_period seconds
+// through the same BidNotice and DispatchRequest topics that the dispatcher
+// node uses, and awards each task to the best proposal.
+//
+// It reports
+//   - the planning latency from a BidNotice until the fleet proposes a bid
+//   - how long a job waits for the worker of the fleet and for the workers
+//     of the robots before it runs, which grows with the depth of their queues
+//   - the number of tasks that were dispatched and completed per second
+//   - the CPU utilization of each group of threads in the process
+//   - the resident and peak memory of the process
+//
+// The adapter runs on the simulated clock that this benchmark publishes, so
+// the schedule node has to use simulated time too, e.g.
+//
+//   ros2 run rmf_traffic_ros2 rmf_traffic_schedule --ros-args \
+//     -p use_sim_time:=true -p timers_follow_clock:=true
+//   fleet_adapter_benchmark --ros-args -p robots:=500 -p time_scale:=2.0
+//
+// When max_planning_p99 or max_worker_lag_p99 are set, the benchmark exits
+// with a non-zero status if the run does not meet them, so it can be used as
+// a regression gate. Run this on an isolated ROS_DOMAIN_ID so that it does
+// not interfere with a live deployment.
+
+#include <rmf_fleet_adapter/agv/Adapter.hpp>
+#include <rmf_fleet_adapter/StandardNames.hpp>
+
+#include "../rmf_fleet_adapter/agv/internal_FleetUpdateHandle.hpp"
+#include "../rmf_fleet_adapter/agv/internal_RobotUpdateHandle.hpp"
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_traffic_ros2/Time.hpp>
+
+#include <rmf_battery/agv/BatterySystem.hpp>
+#include <rmf_battery/agv/SimpleMotionPowerSink.hpp>
+#include <rmf_battery/agv/SimpleDevicePowerSink.hpp>
+
+#include <rmf_task_msgs/msg/bid_notice.hpp>
+#include <rmf_task_msgs/msg/bid_proposal.hpp>
+#include <rmf_task_msgs/msg/dispatch_request.hpp>
+#include <rmf_task_msgs/msg/task_summary.hpp>
+
+#include <rosgraph_msgs/msg/clock.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std::chrono_literals;
+
+using Clock = std::chrono::steady_clock;
+using RobotCommandHandle = rmf_fleet_adapter::agv::RobotCommandHandle;
+using RobotUpdateHandle = rmf_fleet_adapter::agv::RobotUpdateHandle;
+using FleetUpdateHandle = rmf_fleet_adapter::agv::FleetUpdateHandle;
+
+namespace {
+//==============================================================================
+const std::string MapName = "L1";
+const std::string FleetName = "benchmark_fleet";
+
+//==============================================================================
+struct Options
+{
+  std::size_t robots;
+  std::size_t waypoints_per_robot;
+  double spacing;
+  double speed;
+  double update_rate;
+  double time_scale;
+  double task_period;
+  double bid_window;
+  double duration;
+  double warmup;
+  double max_planning_p99;
+  double max_worker_lag_p99;
+
+  static Options from(rclcpp::Node& node)
+  {
+    const auto positive = [&node](const std::string& name, const int value)
+      {
+        return static_cast<std::size_t>(
+          std::max<int64_t>(1, node.declare_parameter<int>(name, value)));
+      };
+
+    Options o;
+    o.robots = positive("robots", 100);
+    o.waypoints_per_robot = positive("waypoints_per_robot", 4);
+    o.spacing = node.declare_parameter<double>("spacing", 3.0);
+    o.speed = node.declare_parameter<double>("speed", 1.0);
+    o.update_rate = node.declare_parameter<double>("update_rate", 10.0);
+    o.time_scale = node.declare_parameter<double>("time_scale", 1.0);
+    o.task_period = node.declare_parameter<double>("task_period", 1.0);
+    o.bid_window = node.declare_parameter<double>("bid_window", 2.0);
+    o.duration = node.declare_parameter<double>("duration", 60.0);
+    o.warmup = node.declare_parameter<double>("warmup", 10.0);
+    o.max_planning_p99 =
+      node.declare_parameter<double>("max_planning_p99", 0.0);
+    o.max_worker_lag_p99 =
+      node.declare_parameter<double>("max_worker_lag_p99", 0.0);
+    return o;
+  }
+};
+
+//==============================================================================
+/// Latency samples of the benchmark, printed as a percentile summary
+class Samples
+{
+public:
+
+  void add(const Clock::duration value)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _values.push_back(
+      std::chrono::duration<double, std::milli>(value).count());
+  }
+
+  /// Get the given percentile in milliseconds, or 0 if there are no samples.
+  double percentile(const double p)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _percentile(p);
+  }
+
+  void print(const std::string& name)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::cout << "  " << std::left << std::setw(14) << name << std::right;
+    if (_values.empty())
+    {
+      std::cout << " no samples\n";
+      return;
+    }
+
+    double total = 0.0;
+    for (const auto v : _values)
+      total += v;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << " n=" << std::setw(8) << _values.size()
+              << " mean=" << std::setw(9) << total / _values.size()
+              << " p50=" << std::setw(9) << _percentile(0.5)
+              << " p90=" << std::setw(9) << _percentile(0.9)
+              << " p99=" << std::setw(9) << _percentile(0.99)
+              << " max=" << std::setw(9) << _percentile(1.0)
+              << "  [ms]\n";
+  }
+
+private:
+
+  double _percentile(const double p)
+  {
+    if (_values.empty())
+      return 0.0;
+
+    std::sort(_values.begin(), _values.end());
+    const auto index = static_cast<std::size_t>(
+      p * static_cast<double>(_values.size() - 1));
+    return _values[index];
+  }
+
+  std::mutex _mutex;
+  std::vector<double> _values;
+};
+
+//==============================================================================
+struct Stats
+{
+  std::atomic_bool recording{false};
+  std::atomic_size_t dispatched{0};
+  std::atomic_size_t completed{0};
+  std::atomic_size_t unanswered{0};
+  Samples planning;
+  Samples fleet_worker;
+  Samples robot_workers;
+};
+
+//==============================================================================
+/// A square grid of waypoints with lanes between neighbors in both
+/// directions. The first waypoint of every row is a charger.
+rmf_traffic::agv::Graph make_grid(const Options& options, std::size_t& side)
+{
+  side = static_cast<std::size_t>(std::ceil(
+      std::sqrt(static_cast<double>(
+        options.robots * options.waypoints_per_robot))));
+  side = std::max<std::size_t>(side, 2);
+
+  rmf_traffic::agv::Graph graph;
+  for (std::size_t row = 0; row < side; ++row)
+  {
+    for (std::size_t col = 0; col < side; ++col)
+    {
+      auto& wp = graph.add_waypoint(
+        MapName, {col * options.spacing, row * options.spacing});
+      wp.set_holding_point(true);
+      if (col == 0)
+        wp.set_charger(true);
+
+      graph.add_key(
+        "wp_" + std::to_string(wp.index()), wp.index());
+    }
+  }
+
+  const auto connect = [&graph](const std::size_t a, const std::size_t b)
+    {
+      graph.add_lane(a, b);
+      graph.add_lane(b, a);
+    };
+
+  for (std::size_t row = 0; row < side; ++row)
+  {
+    for (std::size_t col = 0; col < side; ++col)
+    {
+      const std::size_t i = row * side + col;
+      if (col + 1 < side)
+        connect(i, i + 1);
+
+      if (row + 1 < side)
+        connect(i, i + side);
+    }
+  }
+
+  return graph;
+}
+
+//==============================================================================
+// A robot that follows the timing of its plan exactly. The commands of the
+// adapter come from its workers while the robot is stepped by the driver
+// thread, so its state is guarded by a mutex. The callbacks that it gives back
+// to the adapter are always triggered after that mutex is released.
+class SimulatedRobot : public RobotCommandHandle
+{
+public:
+
+  void set_update_handle(std::shared_ptr<RobotUpdateHandle> handle)
+  {
+    handle->update_battery_soc(1.0);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _update = std::move(handle);
+  }
+
+  std::shared_ptr<RobotUpdateHandle> update_handle()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _update;
+  }
+
+  void follow_new_path(
+    const std::vector<rmf_traffic::agv::Plan::Waypoint>& waypoints,
+    ArrivalEstimator next_arrival_estimator,
+    std::function<void()> path_finished_callback) final
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _path = waypoints;
+    _target = 0;
+    _next_arrival_estimator = std::move(next_arrival_estimator);
+    _path_finished_callback = std::move(path_finished_callback);
+  }
+
+  void stop() final
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _path.clear();
+    _path_finished_callback = nullptr;
+  }
+
+  void dock(
+    const std::string&,
+    std::function<void()> docking_finished_callback) final
+  {
+    // There are no docks on the grid, but if one is asked for anyway, it is
+    // finished on the next step.
+    std::lock_guard<std::mutex> lock(_mutex);
+    _docking_finished_callback = std::move(docking_finished_callback);
+  }
+
+  /// Move the robot along its plan up to the given simulated time
+  void step(const rmf_traffic::Time now)
+  {
+    std::vector<std::function<void()>> triggers;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _step(now, triggers);
+    }
+
+    for (const auto& trigger : triggers)
+      trigger();
+  }
+
+private:
+
+  void _step(
+    const rmf_traffic::Time now,
+    std::vector<std::function<void()>>& triggers)
+  {
+    if (!_update)
+      return;
+
+    if (_docking_finished_callback)
+    {
+      triggers.push_back(std::move(_docking_finished_callback));
+      _docking_finished_callback = nullptr;
+    }
+
+    if (_path.empty())
+      return;
+
+    const auto previous = _target;
+    while (_target < _path.size() && _path[_target].time() <= now)
+      ++_target;
+
+    if (_target != previous && _target > 0)
+    {
+      const auto& reached = _path[_target - 1];
+      if (reached.graph_index().has_value())
+      {
+        triggers.push_back(
+          [update = _update, wp = *reached.graph_index(),
+          yaw = reached.position()[2]]()
+          {
+            update->update_position(wp, yaw);
+          });
+      }
+      else
+      {
+        triggers.push_back(
+          [update = _update, p = reached.position()]()
+          {
+            update->update_position(MapName, p);
+          });
+      }
+    }
+
+    if (_target < _path.size())
+    {
+      triggers.push_back(
+        [estimator = _next_arrival_estimator, target = _target,
+        remaining = _path[_target].time() - now]()
+        {
+          estimator(target, remaining);
+        });
+      return;
+    }
+
+    if (_path_finished_callback)
+      triggers.push_back(std::move(_path_finished_callback));
+
+    _path_finished_callback = nullptr;
+    _path.clear();
+  }
+
+  std::mutex _mutex;
+  std::shared_ptr<RobotUpdateHandle> _update;
+  std::vector<rmf_traffic::agv::Plan::Waypoint> _path;
+  std::size_t _target = 0;
+  ArrivalEstimator _next_arrival_estimator;
+  std::function<void()> _path_finished_callback;
+  std::function<void()> _docking_finished_callback;
+};
+
+//==============================================================================
+/// Sends loop tasks to the fleet the way the dispatcher node would, and awards
+/// each one to the proposal with the lowest added cost.
+class StubDispatcher
+{
+public:
+
+  StubDispatcher(
+    rclcpp::Node& node,
+    const Options& options,
+    const std::size_t num_waypoints,
+    Stats& stats)
+  : _node(&node),
+    _bid_window(options.bid_window),
+    _num_waypoints(num_waypoints),
+    _stats(&stats),
+    _random(42)
+  {
+    using namespace rmf_fleet_adapter;
+    using namespace rmf_task_msgs::msg;
+    const auto qos = rclcpp::SystemDefaultsQoS();
+
+    _notice_pub = node.create_publisher<BidNotice>(BidNoticeTopicName, qos);
+    _dispatch_pub =
+      node.create_publisher<DispatchRequest>(DispatchRequestTopicName, qos);
+
+    _proposal_sub = node.create_subscription<BidProposal>(
+      BidProposalTopicName, qos,
+      [this](const BidProposal::SharedPtr msg)
+      {
+        _receive(*msg);
+      });
+
+    _summary_sub = node.create_subscription<TaskSummary>(
+      TaskSummaryTopicName, rclcpp::SystemDefaultsQoS().keep_last(100),
+      [this](const TaskSummary::SharedPtr msg)
+      {
+        if (msg->state != TaskSummary::STATE_COMPLETED)
+          return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_completed.insert(msg->task_id).second && _stats->recording)
+          ++_stats->completed;
+      });
+  }
+
+  /// Announce a new task, and award the tasks whose bid windows have closed
+  void tick()
+  {
+    using namespace rmf_task_msgs::msg;
+    std::uniform_int_distribution<std::size_t> pick(0, _num_waypoints - 1);
+
+    BidNotice notice;
+    notice.task_profile.task_id = "benchmark_" + std::to_string(_next_id++);
+    notice.task_profile.submission_time = _node->now();
+    notice.task_profile.description.start_time = _node->now();
+    notice.task_profile.description.task_type.type = TaskType::TYPE_LOOP;
+    auto& loop = notice.task_profile.description.loop;
+    loop.robot_type = FleetName;
+    loop.num_loops = 1;
+    loop.start_name = "wp_" + std::to_string(pick(_random));
+    loop.finish_name = "wp_" + std::to_string(pick(_random));
+    notice.time_window = rmf_traffic_ros2::convert(
+      std::chrono::duration_cast<rmf_traffic::Duration>(
+        std::chrono::duration<double>(_bid_window)));
+
+    const auto now = Clock::now();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _open[notice.task_profile.task_id] = Auction{notice.task_profile, now};
+    }
+
+    _notice_pub->publish(notice);
+    _award(now);
+  }
+
+private:
+
+  struct Auction
+  {
+    rmf_task_msgs::msg::TaskProfile profile;
+    Clock::time_point opened;
+    std::optional<rmf_task_msgs::msg::BidProposal> best = std::nullopt;
+  };
+
+  void _receive(const rmf_task_msgs::msg::BidProposal& proposal)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _open.find(proposal.task_profile.task_id);
+    if (it == _open.end())
+      return;
+
+    auto& auction = it->second;
+    if (!auction.best.has_value() && _stats->recording)
+      _stats->planning.add(Clock::now() - auction.opened);
+
+    const auto cost = [](const rmf_task_msgs::msg::BidProposal& p)
+      {
+        return p.new_cost - p.prev_cost;
+      };
+
+    if (!auction.best.has_value() || cost(proposal) < cost(*auction.best))
+      auction.best = proposal;
+  }
+
+  void _award(const Clock::time_point now)
+  {
+    const auto window = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(_bid_window));
+
+    std::vector<rmf_task_msgs::msg::DispatchRequest> requests;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (auto it = _open.begin(); it != _open.end(); )
+      {
+        if (now - it->second.opened < window)
+        {
+          ++it;
+          continue;
+        }
+
+        if (it->second.best.has_value())
+        {
+          rmf_task_msgs::msg::DispatchRequest request;
+          request.fleet_name = it->second.best->fleet_name;
+          request.task_profile = it->second.profile;
+          request.method = rmf_task_msgs::msg::DispatchRequest::ADD;
+          requests.push_back(std::move(request));
+        }
+        else if (_stats->recording)
+        {
+          ++_stats->unanswered;
+        }
+
+        it = _open.erase(it);
+      }
+    }
+
+    for (const auto& request : requests)
+    {
+      _dispatch_pub->publish(request);
+      if (_stats->recording)
+        ++_stats->dispatched;
+    }
+  }
+
+  rclcpp::Node* _node;
+  double _bid_window;
+  std::size_t _num_waypoints;
+  Stats* _stats;
+  std::mt19937 _random;
+  std::size_t _next_id = 0;
+
+  std::mutex _mutex;
+  std::unordered_map<std::string, Auction> _open;
+  std::unordered_set<std::string> _completed;
+
+  rclcpp::Publisher<rmf_task_msgs::msg::BidNotice>::SharedPtr _notice_pub;
+  rclcpp::Publisher<rmf_task_msgs::msg::DispatchRequest>::SharedPtr
+    _dispatch_pub;
+  rclcpp::Subscription<rmf_task_msgs::msg::BidProposal>::SharedPtr
+    _proposal_sub;
+  rclcpp::Subscription<rmf_task_msgs::msg::TaskSummary>::SharedPtr
+    _summary_sub;
+};
+
+//==============================================================================
+/// Schedule a job on a worker and record how long it waited to run. The
+/// rxcpp workers do not expose their queues, so this wait is how the depth of
+/// a queue is measured.
+void probe(
+  const rxcpp::schedulers::worker& worker,
+  Samples& samples,
+  const Stats& stats)
+{
+  worker.schedule(
+    [&samples, &stats, scheduled = Clock::now()](const auto&)
+    {
+      if (stats.recording)
+        samples.add(Clock::now() - scheduled);
+    });
+}
+
+//==============================================================================
+/// The CPU time of every thread in the process, added up by thread name
+std::map<std::string, double> thread_cpu_seconds()
+{
+  std::map<std::string, double> seconds;
+  const double ticks = static_cast<double>(sysconf(_SC_CLK_TCK));
+
+  DIR* dir = opendir("/proc/self/task");
+  if (!dir)
+    return seconds;
+
+  while (const dirent* entry = readdir(dir))
+  {
+    if (entry->d_name[0] == '.')
+      continue;
+
+    std::ifstream file(
+      std::string("/proc/self/task/") + entry->d_name + "/stat");
+    std::string stat;
+    std::getline(file, stat);
+
+    // The name is in parentheses and may contain spaces
+    const auto open = stat.find('(');
+    const auto close = stat.rfind(')');
+    if (open == std::string::npos || close == std::string::npos)
+      continue;
+
+    const std::string name = stat.substr(open + 1, close - open - 1);
+
+    // utime and stime are the 12th and 13th fields after the name
+    std::istringstream fields(stat.substr(close + 2));
+    std::string field;
+    double utime = 0.0;
+    double stime = 0.0;
+    for (int i = 0; i < 13 && fields >> field; ++i)
+    {
+      if (i == 11)
+        utime = std::stod(field);
+      else if (i == 12)
+        stime = std::stod(field);
+    }
+
+    seconds[name] += (utime + stime) / ticks;
+  }
+
+  closedir(dir);
+  return seconds;
+}
+
+//==============================================================================
+/// Read a memory field of /proc/self/status, e.g. VmRSS, in megabytes
+double memory_megabytes(const std::string& field)
+{
+  std::ifstream file("/proc/self/status");
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (line.rfind(field + ":", 0) != 0)
+      continue;
+
+    std::istringstream value(line.substr(field.size() + 1));
+    double kilobytes = 0.0;
+    value >> kilobytes;
+    return kilobytes / 1024.0;
+  }
+
+  return 0.0;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+
+  auto driver_node = std::make_shared<rclcpp::Node>(
+    "fleet_adapter_benchmark_driver");
+  const auto options = Options::from(*driver_node);
+  Stats stats;
+
+  // The simulated clock starts at the current wall time and is advanced by
+  // the driver in steps of time_scale/update_rate seconds.
+  const auto clock_pub = driver_node->create_publisher<
+    rosgraph_msgs::msg::Clock>("/clock", rclcpp::SystemDefaultsQoS());
+  std::atomic<int64_t> sim_now{driver_node->now().nanoseconds()};
+  const auto publish_clock = [&clock_pub, &sim_now]()
+    {
+      rosgraph_msgs::msg::Clock msg;
+      msg.clock = rclcpp::Time(sim_now.load());
+      clock_pub->publish(msg);
+    };
+
+  rclcpp::executors::SingleThreadedExecutor driver_executor;
+  driver_executor.add_node(driver_node);
+  std::thread driver_thread([&]() { driver_executor.spin(); });
+
+  const double dt = 1.0 / std::max(options.update_rate, 1e-3);
+  const auto sim_dt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(dt * options.time_scale));
+
+  std::mutex robots_mutex;
+  std::vector<std::shared_ptr<SimulatedRobot>> robots;
+  const auto step_timer = driver_node->create_wall_timer(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(dt)),
+    [&]()
+    {
+      sim_now += sim_dt.count();
+      publish_clock();
+
+      const auto now = rmf_traffic::Time(
+        rmf_traffic::Duration(sim_now.load()));
+      std::lock_guard<std::mutex> lock(robots_mutex);
+      for (const auto& robot : robots)
+        robot->step(now);
+    });
+
+  const auto adapter = rmf_fleet_adapter::agv::Adapter::make(
+    "fleet_adapter_benchmark",
+    rclcpp::NodeOptions().parameter_overrides(
+      {{"use_sim_time", true}, {"timers_follow_clock", true}}));
+  if (!adapter)
+    return 1;
+
+  std::size_t side = 0;
+  const auto graph = make_grid(options, side);
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.4)};
+  const rmf_traffic::agv::VehicleTraits traits{
+    {options.speed, 0.5},
+    {1.0, 1.0},
+    profile
+  };
+
+  const auto fleet = adapter->add_fleet(FleetName, traits, graph);
+
+  using BatterySystem = rmf_battery::agv::BatterySystem;
+  using PowerSystem = rmf_battery::agv::PowerSystem;
+  using MechanicalSystem = rmf_battery::agv::MechanicalSystem;
+  using SimpleMotionPowerSink = rmf_battery::agv::SimpleMotionPowerSink;
+  using SimpleDevicePowerSink = rmf_battery::agv::SimpleDevicePowerSink;
+
+  const auto battery_system = std::make_shared<BatterySystem>(
+    *BatterySystem::make(24.0, 40.0, 8.8));
+  const auto motion_sink = std::make_shared<SimpleMotionPowerSink>(
+    *battery_system, *MechanicalSystem::make(70.0, 40.0, 0.22));
+  const auto ambient_sink = std::make_shared<SimpleDevicePowerSink>(
+    *battery_system, *PowerSystem::make(20.0));
+  const auto tool_sink = std::make_shared<SimpleDevicePowerSink>(
+    *battery_system, *PowerSystem::make(10.0));
+
+  // The robots report a full battery forever, so battery drain is not
+  // accounted for.
+  fleet->set_task_planner_params(
+    battery_system, motion_sink, ambient_sink, tool_sink, 0.2, 1.0, false);
+  fleet->accept_task_requests([](const auto&) { return true; });
+
+  adapter->start();
+
+  // Wait for the adapter to receive the simulated clock
+  while (adapter->node()->now().nanoseconds() == 0)
+    std::this_thread::sleep_for(10ms);
+
+  // Spread the robots over the grid so that they start on different
+  // waypoints
+  const auto start_time = rmf_traffic_ros2::convert(adapter->node()->now());
+  const std::size_t num_waypoints = graph.num_waypoints();
+  std::vector<FleetUpdateHandle::NewRobot> new_robots;
+  for (std::size_t i = 0; i < options.robots; ++i)
+  {
+    const std::size_t wp = i * num_waypoints / options.robots;
+    auto robot = std::make_shared<SimulatedRobot>();
+    {
+      std::lock_guard<std::mutex> lock(robots_mutex);
+      robots.push_back(robot);
+    }
+
+    new_robots.push_back(
+      {
+        robot,
+        "robot_" + std::to_string(i),
+        profile,
+        {{start_time, wp, 0.0}},
+        [w = std::weak_ptr<SimulatedRobot>(robot)](
+          std::shared_ptr<RobotUpdateHandle> handle)
+        {
+          if (const auto robot = w.lock())
+            robot->set_update_handle(std::move(handle));
+        }
+      });
+  }
+
+  fleet->add_robots(std::move(new_robots));
+
+  StubDispatcher dispatcher(*driver_node, options, num_waypoints, stats);
+  const auto task_timer = driver_node->create_wall_timer(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(options.task_period)),
+    [&dispatcher]() { dispatcher.tick(); });
+
+  // Probe the worker of the fleet and the workers of a few robots at a time,
+  // taking turns through the robots
+  const auto& fleet_worker = FleetUpdateHandle::Implementation::get(*fleet)
+    .worker;
+  std::size_t next_probe = 0;
+  const auto probe_timer = driver_node->create_wall_timer(
+    100ms,
+    [&]()
+    {
+      probe(fleet_worker, stats.fleet_worker, stats);
+
+      std::lock_guard<std::mutex> lock(robots_mutex);
+      for (std::size_t i = 0; i < std::min<std::size_t>(10, robots.size()); ++i)
+      {
+        const auto& robot = robots[next_probe++ % robots.size()];
+        const auto handle = robot->update_handle();
+        if (!handle)
+          continue;
+
+        const auto context =
+          RobotUpdateHandle::Implementation::get(*handle).get_context();
+        if (context)
+          probe(context->worker(), stats.robot_workers, stats);
+      }
+    });
+
+  RCLCPP_INFO(
+    driver_node->get_logger(),
+    "Started %lu robots on a %lux%lu grid; warming up for %.1fs",
+    options.robots, side, side, options.warmup);
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.warmup));
+
+  stats.recording = true;
+  const auto wall_start = Clock::now();
+  const auto cpu_start = thread_cpu_seconds();
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.duration));
+
+  stats.recording = false;
+  const double wall = std::chrono::duration<double>(
+    Clock::now() - wall_start).count();
+  const auto cpu_end = thread_cpu_seconds();
+
+  std::cout << "\nFleet adapter benchmark with " << options.robots
+            << " robots on " << num_waypoints << " waypoints over " << wall
+            << "s at " << options.time_scale << "x simulated time\n";
+
+  stats.planning.print("planning");
+  stats.fleet_worker.print("fleet worker");
+  stats.robot_workers.print("robot workers");
+
+  std::cout << std::fixed << std::setprecision(3)
+            << "  tasks: " << stats.dispatched / wall << " dispatched and "
+            << stats.completed / wall << " completed per second, "
+            << stats.unanswered << " without a bid\n"
+            << "  memory: " << memory_megabytes("VmRSS") << " MB resident, "
+            << memory_megabytes("VmHWM") << " MB peak\n"
+            << "  cpu by thread name [% of one core]:\n";
+  for (const auto& [name, end] : cpu_end)
+  {
+    const auto it = cpu_start.find(name);
+    const double used = end - (it == cpu_start.end() ? 0.0 : it->second);
+    std::cout << "    " << std::left << std::setw(16) << name << std::right
+              << std::setw(9) << 100.0 * used / wall << "\n";
+  }
+
+  bool passed = true;
+  const double planning_p99 = stats.planning.percentile(0.99) / 1000.0;
+  if (options.max_planning_p99 > 0.0
+    && planning_p99 > options.max_planning_p99)
+  {
+    std::cout << "REGRESSION: planning p99 of " << planning_p99
+              << "s is above " << options.max_planning_p99 << "s\n";
+    passed = false;
+  }
+
+  const double lag_p99 = std::max(
+    stats.fleet_worker.percentile(0.99),
+    stats.robot_workers.percentile(0.99)) / 1000.0;
+  if (options.max_worker_lag_p99 > 0.0 && lag_p99 > options.max_worker_lag_p99)
+  {
+    std::cout << "REGRESSION: worker lag p99 of " << lag_p99 << "s is above "
+              << options.max_worker_lag_p99 << "s\n";
+    passed = false;
+  }
+
+  driver_executor.cancel();
+  driver_thread.join();
+  adapter->stop();
+
+  // Nothing is stepping the robots anymore, so they can be torn down before
+  // the context goes away.
+  {
+    std::lock_guard<std::mutex> lock(robots_mutex);
+    robots.clear();
+  }
+  rclcpp::shutdown();
+  return passed ? 0 : 1;
+}
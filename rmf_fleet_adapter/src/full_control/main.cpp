@@ -26,6 +26,12 @@
 // Standard topic names for communicating with fleet drivers
 #include <rmf_fleet_adapter/StandardNames.hpp>
 
+// Batches of path requests for fleet drivers that support them
+#include <rmf_fleet_adapter/PathRequestBatch.hpp>
+
+// Threads that the planning jobs run on
+#include <rmf_rxcpp/PlanningScheduler.hpp>
+
 // Fleet driver state/command messages
 #include <rmf_fleet_msgs/msg/fleet_state.hpp>
 #include <rmf_fleet_msgs/msg/path_request.hpp>
@@ -44,6 +50,7 @@
 // Utility functions for estimating where a robot is on the graph based on
 // the information provided by fleet drivers.
 #include "../rmf_fleet_adapter/estimation.hpp"
+#include "../rmf_fleet_adapter/agv/LiftClearanceCache.hpp"
 
 // Public rmf_task API headers
 #include <rmf_task/requests/ChargeBatteryFactory.hpp>
@@ -51,6 +58,7 @@
 
 // Public rmf_traffic API headers
 #include <rmf_traffic/agv/Interpolate.hpp>
+#include <rmf_traffic/agv/Planner.hpp>
 #include <rmf_traffic/Route.hpp>
 
 #include <rmf_battery/agv/BatterySystem.hpp>
@@ -58,6 +66,15 @@
 #include <rmf_battery/agv/SimpleDevicePowerSink.hpp>
 
 #include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 
 //==============================================================================
@@ -147,14 +164,167 @@ std::optional<DistanceFromGraph> distance_from_graph(
   return output;
 }
 
+//==============================================================================
+/// Decides when a request to the fleet driver should be sent again. The
+/// interval follows how long the driver has taken to acknowledge earlier
+/// requests, estimated the same way TCP estimates round trip times, and it
+/// doubles each time the same request goes unacknowledged.
+class RequestResendTimer
+{
+public:
+
+  using Clock = std::chrono::steady_clock;
+
+  /// A new request was sent
+  void sent(const Clock::time_point now)
+  {
+    _sent_time = now;
+    _resends = 0;
+    _waiting = true;
+  }
+
+  /// Check whether the request should be sent again. If this returns true, the
+  /// request is counted as sent again.
+  bool resend_due(const Clock::time_point now)
+  {
+    if (!_waiting || now - _sent_time < _interval())
+      return false;
+
+    _sent_time = now;
+    ++_resends;
+    return true;
+  }
+
+  /// The driver has acknowledged the last request
+  void acknowledged(const Clock::time_point now)
+  {
+    if (!_waiting)
+      return;
+
+    _waiting = false;
+
+    // If the request was sent more than once, we can't tell which one got
+    // acknowledged, so the latency is not measured.
+    if (_resends > 0)
+      return;
+
+    const double sample =
+      std::chrono::duration<double>(now - _sent_time).count();
+    if (!_smoothed_latency)
+    {
+      _smoothed_latency = sample;
+      _latency_variation = sample/2.0;
+      return;
+    }
+
+    _latency_variation =
+      0.75*_latency_variation + 0.25*std::abs(*_smoothed_latency - sample);
+    _smoothed_latency = 0.875*(*_smoothed_latency) + 0.125*sample;
+  }
+
+private:
+
+  Clock::duration _interval() const
+  {
+    // Until the driver has acknowledged something, we resend every 200ms
+    double interval = 0.2;
+    if (_smoothed_latency)
+    {
+      interval = std::clamp(
+        *_smoothed_latency + 4.0*_latency_variation,
+        MinInterval, MaxInterval);
+    }
+
+    interval *= static_cast<double>(1u << std::min<std::size_t>(_resends, 4));
+    return std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(std::min(interval, MaxInterval)));
+  }
+
+  static constexpr double MinInterval = 0.1;
+  static constexpr double MaxInterval = 2.0;
+
+  Clock::time_point _sent_time;
+  std::size_t _resends = 0;
+  bool _waiting = false;
+  std::optional<double> _smoothed_latency;
+  double _latency_variation = 0.0;
+};
+
+//==============================================================================
+/// Sends path requests to the fleet driver. When a batch period is given, the
+/// requests are collected and published together on PathRequestBatchTopicName
+/// once per period, keeping only the newest request of each robot. Otherwise
+/// each request is published on PathRequestTopicName right away.
+class PathRequestSender
+{
+public:
+
+  PathRequestSender(
+    rclcpp::Node& node,
+    const std::optional<std::chrono::nanoseconds> batch_period)
+  {
+    if (!batch_period)
+    {
+      _publisher = node.create_publisher<rmf_fleet_msgs::msg::PathRequest>(
+        rmf_fleet_adapter::PathRequestTopicName, rclcpp::SystemDefaultsQoS());
+      return;
+    }
+
+    _batch_publisher =
+      node.create_publisher<rmf_fleet_adapter::PathRequestBatch>(
+      rmf_fleet_adapter::PathRequestBatchTopicName,
+      rclcpp::SystemDefaultsQoS());
+
+    _batch_timer = node.create_wall_timer(
+      *batch_period, [this]() { _flush(); });
+  }
+
+  void send(const rmf_fleet_msgs::msg::PathRequest& request)
+  {
+    if (_publisher)
+      return _publisher->publish(request);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.insert_or_assign(request.robot_name, request);
+  }
+
+private:
+
+  void _flush()
+  {
+    std::vector<rmf_fleet_msgs::msg::PathRequest> requests;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_pending.empty())
+        return;
+
+      requests.reserve(_pending.size());
+      for (auto& [_, request] : _pending)
+        requests.emplace_back(std::move(request));
+
+      _pending.clear();
+    }
+
+    _batch_publisher->publish(
+      rmf_fleet_adapter::encode_path_request_batch(requests));
+  }
+
+  rclcpp::Publisher<rmf_fleet_msgs::msg::PathRequest>::SharedPtr _publisher;
+  rclcpp::Publisher<rmf_fleet_adapter::PathRequestBatch>::SharedPtr
+    _batch_publisher;
+  rclcpp::TimerBase::SharedPtr _batch_timer;
+
+  std::mutex _mutex;
+  std::unordered_map<std::string, rmf_fleet_msgs::msg::PathRequest> _pending;
+};
+
 //==============================================================================
 class FleetDriverRobotCommandHandle
   : public rmf_fleet_adapter::agv::RobotCommandHandle
 {
 public:
 
-  using PathRequestPub =
-    rclcpp::Publisher<rmf_fleet_msgs::msg::PathRequest>::SharedPtr;
+  using PathRequestSenderPtr = std::shared_ptr<PathRequestSender>;
 
   using ModeRequestPub =
     rclcpp::Publisher<rmf_fleet_msgs::msg::ModeRequest>::SharedPtr;
@@ -165,10 +335,11 @@ public:
     std::string robot_name,
     std::shared_ptr<const rmf_traffic::agv::Graph> graph,
     std::shared_ptr<const rmf_traffic::agv::VehicleTraits> traits,
-    PathRequestPub path_request_pub,
+    std::shared_ptr<const rmf_fleet_adapter::agv::PlanStartIndex> graph_index,
+    PathRequestSenderPtr path_request_sender,
     ModeRequestPub mode_request_pub)
   : _node(&node),
-    _path_request_pub(std::move(path_request_pub)),
+    _path_request_sender(std::move(path_request_sender)),
     _mode_request_pub(std::move(mode_request_pub))
   {
     _current_path_request.fleet_name = fleet_name;
@@ -184,6 +355,7 @@ public:
 
     _travel_info.graph = std::move(graph);
     _travel_info.traits = std::move(traits);
+    _travel_info.graph_index = std::move(graph_index);
     _travel_info.fleet_name = std::move(fleet_name);
     _travel_info.robot_name = std::move(robot_name);
   }
@@ -225,8 +397,8 @@ public:
       _current_path_request.path.emplace_back(std::move(location));
     }
 
-    _path_requested_time = std::chrono::steady_clock::now();
-    _path_request_pub->publish(_current_path_request);
+    _path_resend.sent(std::chrono::steady_clock::now());
+    _path_request_sender->send(_current_path_request);
   }
 
   void stop() final
@@ -275,7 +447,7 @@ public:
     _current_dock_request.parameters.front().value = dock_name;
     _current_dock_request.task_id = std::to_string(++_current_task_id);
 
-    _dock_requested_time = std::chrono::steady_clock::now();
+    _dock_resend.sent(std::chrono::steady_clock::now());
     _mode_request_pub->publish(_current_dock_request);
 
     // TODO(MXG): We should come up with a better way to identify the docking
@@ -311,16 +483,37 @@ public:
       wp_name.c_str());
   }
 
-  void update_state(const rmf_fleet_msgs::msg::RobotState& state)
+  /// Update the state of the robot. If updates is not a nullptr, the new
+  /// position and battery level of the robot will be added to it instead of
+  /// being given to the robot's updater right away.
+  void update_state(
+    const rmf_fleet_msgs::msg::RobotState& state,
+    rmf_fleet_adapter::agv::FleetUpdateHandle::RobotUpdates* updates)
   {
     auto lock = _lock();
     _last_known_state = state;
 
+    // The updates are only collected while this function is running
+    struct UpdatesGuard
+    {
+      TravelInfo& info;
+      ~UpdatesGuard() { info.updates = nullptr; }
+    } updates_guard{_travel_info};
+    _travel_info.updates = updates;
+
     // Update battery soc
     const double battery_soc = state.battery_percent / 100.0;
     if (battery_soc >= 0.0 && battery_soc <= 1.0)
     {
-      _travel_info.updater->update_battery_soc(battery_soc);
+      if (_travel_info.updates)
+      {
+        _travel_info.updates->update_battery_soc(
+          _travel_info.updater, battery_soc);
+      }
+      else
+      {
+        _travel_info.updater->update_battery_soc(battery_soc);
+      }
     }
     else
     {
@@ -347,21 +540,22 @@ public:
       // The arrival estimator should be available
       assert(_travel_info.next_arrival_estimator);
 
+      const auto now = std::chrono::steady_clock::now();
       if (state.task_id != _current_path_request.task_id)
       {
         // The robot has not received our path request yet
-        const auto now = std::chrono::steady_clock::now();
-        if (std::chrono::milliseconds(200) < now - _path_requested_time)
+        if (_path_resend.resend_due(now))
         {
           // We published the request a while ago, so we'll send it again in
           // case it got dropped.
-          _path_requested_time = now;
-          _path_request_pub->publish(_current_path_request);
+          _path_request_sender->send(_current_path_request);
         }
 
         return estimate_state(_node, state.location, _travel_info);
       }
 
+      _path_resend.acknowledged(now);
+
       if (state.mode.mode == state.mode.MODE_ADAPTER_ERROR)
       {
         if (_interrupted)
@@ -377,6 +571,10 @@ public:
           _current_path_request.robot_name.c_str());
 
         _interrupted = true;
+
+        // The position needs to be scheduled before the interruption triggers
+        // a replan, so it cannot wait for the rest of the fleet's updates.
+        _travel_info.updates = nullptr;
         estimate_state(_node, state.location, _travel_info);
         return _travel_info.updater->interrupted();
       }
@@ -396,17 +594,18 @@ public:
       // If we have a _dock_finished_callback, then the robot should be docking
       if (state.task_id != _current_dock_request.task_id)
       {
-        if (std::chrono::milliseconds(200) < now - _dock_requested_time)
+        if (_dock_resend.resend_due(now))
         {
           // We published the request a while ago, so we'll send it again in
           // case it got dropped.
-          _dock_requested_time = now;
           _mode_request_pub->publish(_current_dock_request);
         }
 
         return;
       }
 
+      _dock_resend.acknowledged(now);
+
       if (state.mode.mode != state.mode.MODE_DOCKING)
       {
         estimate_waypoint(_node, state.location, _travel_info);
@@ -546,16 +745,16 @@ private:
 
   rclcpp::Node* _node;
 
-  PathRequestPub _path_request_pub;
+  PathRequestSenderPtr _path_request_sender;
   rmf_fleet_msgs::msg::PathRequest _current_path_request;
-  std::chrono::steady_clock::time_point _path_requested_time;
+  RequestResendTimer _path_resend;
   TravelInfo _travel_info;
   std::optional<rmf_fleet_msgs::msg::RobotState> _last_known_state;
   bool _interrupted = false;
 
   rmf_fleet_msgs::msg::ModeRequest _current_dock_request;
   rmf_utils::optional<std::size_t> _dock_target_wp;
-  std::chrono::steady_clock::time_point _dock_requested_time;
+  RequestResendTimer _dock_resend;
   std::chrono::steady_clock::time_point _dock_schedule_time =
     std::chrono::steady_clock::now();
   RequestCompleted _dock_finished_callback;
@@ -587,6 +786,122 @@ private:
 using FleetDriverRobotCommandHandlePtr =
   std::shared_ptr<FleetDriverRobotCommandHandle>;
 
+//==============================================================================
+/// A fixed set of threads for estimating the states of the robots in a fleet
+/// state message in parallel. The threads stay alive between messages so that
+/// none have to be started while the robots are waiting for their updates.
+class EstimationPool
+{
+public:
+
+  using Job = std::function<void(std::size_t)>;
+
+  /// The thread that calls run() counts as one of the threads.
+  EstimationPool(const std::size_t threads)
+  {
+    for (std::size_t i = 1; i < threads; ++i)
+      _threads.emplace_back([this]() { _work(); });
+  }
+
+  ~EstimationPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+
+    for (auto& thread : _threads)
+      thread.join();
+  }
+
+  /// Call job(i) for every i in [0, count). This returns once every call has
+  /// finished, and rethrows the first exception that any call threw. Only one
+  /// thread may call this at a time.
+  void run(const std::size_t count, const Job& job)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _job = &job;
+    _count = count;
+    _next = 0;
+    _error = nullptr;
+    ++_generation;
+    lock.unlock();
+    _wake.notify_all();
+
+    _drain();
+
+    lock.lock();
+    _finished.wait(lock, [&]() { return _next >= _count && _active == 0; });
+    _job = nullptr;
+
+    if (_error)
+      std::rethrow_exception(_error);
+  }
+
+private:
+
+  // Take indices of the current job until there are none left
+  void _drain()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_job && _next < _count)
+    {
+      const std::size_t i = _next++;
+      const Job& job = *_job;
+      ++_active;
+      lock.unlock();
+
+      try
+      {
+        job(i);
+      }
+      catch (...)
+      {
+        lock.lock();
+        if (!_error)
+          _error = std::current_exception();
+        lock.unlock();
+      }
+
+      lock.lock();
+      --_active;
+    }
+
+    if (_active == 0)
+      _finished.notify_all();
+  }
+
+  void _work()
+  {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+      _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+      if (_stop)
+        return;
+
+      seen = _generation;
+      lock.unlock();
+      _drain();
+      lock.lock();
+    }
+  }
+
+  std::vector<std::thread> _threads;
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _finished;
+  const Job* _job = nullptr;
+  std::size_t _count = 0;
+  std::size_t _next = 0;
+  std::size_t _active = 0;
+  uint64_t _generation = 0;
+  std::exception_ptr _error;
+  bool _stop = false;
+};
+
 //==============================================================================
 /// This is an RAII class that keeps the connections to the fleet driver alive.
 struct Connections : public std::enable_shared_from_this<Connections>
@@ -603,13 +918,15 @@ struct Connections : public std::enable_shared_from_this<Connections>
   /// The traits of the vehicles
   std::shared_ptr<const rmf_traffic::agv::VehicleTraits> traits;
 
+  /// A spatial index of the graph that the robots use to find waypoints
+  std::shared_ptr<const rmf_fleet_adapter::agv::PlanStartIndex> graph_index;
+
   /// The topic subscription for responding to new fleet states
   rclcpp::Subscription<rmf_fleet_msgs::msg::FleetState>::SharedPtr
     fleet_state_sub;
 
-  /// The publisher for sending out path requests
-  rclcpp::Publisher<rmf_fleet_msgs::msg::PathRequest>::SharedPtr
-    path_request_pub;
+  /// Sends out path requests, either one at a time or in batches
+  std::shared_ptr<PathRequestSender> path_request_sender;
 
   /// The publisher for sending out mode requests
   rclcpp::Publisher<rmf_fleet_msgs::msg::ModeRequest>::SharedPtr
@@ -619,6 +936,10 @@ struct Connections : public std::enable_shared_from_this<Connections>
   rclcpp::Client<rmf_fleet_msgs::srv::LiftClearance>::SharedPtr
     lift_watchdog_client;
 
+  /// Shares the replies of lift_watchdog_client among robots at the same lift
+  std::shared_ptr<rmf_fleet_adapter::agv::LiftClearanceCache>
+  lift_clearance_cache;
+
   /// The topic subscription for listening for lane closure requests
   rclcpp::Subscription<rmf_fleet_msgs::msg::LaneRequest>::SharedPtr
     lane_closure_request_sub;
@@ -634,6 +955,10 @@ struct Connections : public std::enable_shared_from_this<Connections>
   std::unordered_map<std::string, FleetDriverRobotCommandHandlePtr>
   robots;
 
+  /// Estimates the robot states of each fleet state message in parallel. This
+  /// is a nullptr when the robots are estimated one after another.
+  std::unique_ptr<EstimationPool> estimation_pool;
+
   void add_robot(
     const std::string& fleet_name,
     const rmf_fleet_msgs::msg::RobotState& state)
@@ -641,7 +966,7 @@ struct Connections : public std::enable_shared_from_this<Connections>
     const auto& robot_name = state.name;
     const auto command = std::make_shared<FleetDriverRobotCommandHandle>(
       *adapter->node(), fleet_name, robot_name, graph, traits,
-      path_request_pub, mode_request_pub);
+      graph_index, path_request_sender, mode_request_pub);
 
     const auto& l = state.location;
     const auto& starts = rmf_traffic::agv::compute_plan_starts(
@@ -717,29 +1042,10 @@ struct Connections : public std::enable_shared_from_this<Connections>
 
         auto lock = connections->lock();
 
-        if (connections->lift_watchdog_client)
+        if (connections->lift_clearance_cache)
         {
           updater->unstable().set_lift_entry_watchdog(
-            [robot_name, client = connections->lift_watchdog_client](
-              const std::string& lift_name,
-              auto decide)
-            {
-              auto request =
-              std::make_shared<rmf_fleet_msgs::srv::LiftClearance::Request>(
-                rmf_fleet_msgs::build<rmf_fleet_msgs::srv::LiftClearance::Request>()
-                .robot_name(robot_name)
-                .lift_name(lift_name));
-
-              client->async_send_request(
-                request,
-                [decide](
-                  rclcpp::Client<rmf_fleet_msgs::srv::LiftClearance>::
-                  SharedFuture response)
-                {
-                  const auto r = response.get();
-                  decide(convert_decision(r->decision));
-                });
-            });
+            connections->lift_clearance_cache->watchdog(robot_name));
         }
 
         command->set_updater(updater);
@@ -760,17 +1066,77 @@ struct Connections : public std::enable_shared_from_this<Connections>
   }
 };
 
+//==============================================================================
+using PlannerCache = std::unordered_map<
+  std::string, std::shared_ptr<const rmf_traffic::agv::Planner>>;
+
+//==============================================================================
+/// The planning threads are shared by every fleet in the process, so they are
+/// configured once, before any fleet creates planning jobs.
+void configure_planning_threads(rclcpp::Node& node)
+{
+  const auto planning_threads = static_cast<std::size_t>(
+    std::max(0, node.declare_parameter<int>("planning_threads", 0)));
+  std::vector<int> planning_cpu_affinity;
+  for (const auto cpu : node.declare_parameter<std::vector<int64_t>>(
+      "planning_cpu_affinity", std::vector<int64_t>()))
+  {
+    planning_cpu_affinity.push_back(static_cast<int>(cpu));
+  }
+
+  // Robots wait on the results of the high and normal priority planning, so
+  // only those levels may be given a realtime priority.
+  const int planning_realtime_priority =
+    node.declare_parameter<int>("planning_realtime_priority", 0);
+
+  bool planning_configured = true;
+  for (const auto priority :
+    {rmf_rxcpp::PlanningPriority::High, rmf_rxcpp::PlanningPriority::Normal})
+  {
+    auto options = rmf_rxcpp::PlanningScheduler::options(priority);
+    options.threads = planning_threads;
+    options.cpu_affinity = planning_cpu_affinity;
+    options.realtime_priority = planning_realtime_priority;
+    planning_configured &=
+      rmf_rxcpp::PlanningScheduler::configure(priority, std::move(options));
+  }
+
+  auto low_priority_options = rmf_rxcpp::PlanningScheduler::options(
+    rmf_rxcpp::PlanningPriority::Low);
+  const int low_priority_planning_threads =
+    node.declare_parameter<int>("low_priority_planning_threads", 0);
+  if (low_priority_planning_threads > 0)
+  {
+    low_priority_options.threads =
+      static_cast<std::size_t>(low_priority_planning_threads);
+  }
+  low_priority_options.cpu_affinity = planning_cpu_affinity;
+  low_priority_options.niceness = node.declare_parameter<int>(
+    "low_priority_planning_niceness", low_priority_options.niceness);
+  planning_configured &= rmf_rxcpp::PlanningScheduler::configure(
+    rmf_rxcpp::PlanningPriority::Low, std::move(low_priority_options));
+
+  if (!planning_configured)
+  {
+    RCLCPP_WARN(
+      node.get_logger(),
+      "Planning threads were started before they could be configured");
+  }
+}
+
 //==============================================================================
 std::shared_ptr<Connections> make_fleet(
-  const rmf_fleet_adapter::agv::AdapterPtr& adapter)
+  const rmf_fleet_adapter::agv::AdapterPtr& adapter,
+  const std::string& prefix,
+  PlannerCache& planners)
 {
   const auto& node = adapter->node();
   std::shared_ptr<Connections> connections = std::make_shared<Connections>();
   connections->adapter = adapter;
 
-  const std::string fleet_name_param_name = "fleet_name";
+  const std::string fleet_name_param_name = prefix + "fleet_name";
   const std::string fleet_name = node->declare_parameter(
-    "fleet_name", std::string());
+    fleet_name_param_name, std::string());
   if (fleet_name.empty())
   {
     RCLCPP_ERROR(
@@ -782,9 +1148,9 @@ std::shared_ptr<Connections> make_fleet(
 
   connections->traits = std::make_shared<rmf_traffic::agv::VehicleTraits>(
     rmf_fleet_adapter::get_traits_or_default(
-      *node, 0.7, 0.3, 0.5, 1.5, 0.5, 1.5));
+      *node, 0.7, 0.3, 0.5, 1.5, 0.5, 1.5, prefix));
 
-  const std::string nav_graph_param_name = "nav_graph_file";
+  const std::string nav_graph_param_name = prefix + "nav_graph_file";
   const std::string graph_file =
     node->declare_parameter(nav_graph_param_name, std::string());
   if (graph_file.empty())
@@ -798,15 +1164,49 @@ std::shared_ptr<Connections> make_fleet(
 
   connections->graph =
     std::make_shared<rmf_traffic::agv::Graph>(
-    rmf_fleet_adapter::agv::parse_graph(graph_file, *connections->traits));
+    rmf_fleet_adapter::agv::parse_graph(
+      graph_file, *connections->traits,
+      [node](const std::string& message)
+      {
+        RCLCPP_WARN(node->get_logger(), "%s", message.c_str());
+      }));
+  connections->graph_index =
+    std::make_shared<rmf_fleet_adapter::agv::PlanStartIndex>(
+    *connections->graph);
 
   std::cout << "The fleet [" << fleet_name
             << "] has the following named waypoints:\n";
   for (const auto& key : connections->graph->keys())
     std::cout << " -- " << key.first << std::endl;
 
-  connections->fleet = adapter->add_fleet(
-    fleet_name, *connections->traits, *connections->graph);
+  // Fleets that load the same graph with the same traits can share a planner
+  // and all of the heuristics that it caches.
+  std::string planner_key = graph_file;
+  for (const auto& name : {
+      "linear_velocity", "angular_velocity", "linear_acceleration",
+      "angular_acceleration", "footprint_radius", "vicinity_radius",
+      "reversible"})
+  {
+    planner_key += "|" + node->get_parameter(prefix + name).value_to_string();
+  }
+
+  auto& planner = planners[planner_key];
+  if (!planner)
+  {
+    planner = std::make_shared<rmf_traffic::agv::Planner>(
+      rmf_traffic::agv::Planner::Configuration(
+        *connections->graph, *connections->traits),
+      rmf_traffic::agv::Planner::Options(nullptr));
+  }
+  else
+  {
+    RCLCPP_INFO(
+      node->get_logger(),
+      "The fleet [%s] will share a planner with another fleet",
+      fleet_name.c_str());
+  }
+
+  connections->fleet = adapter->add_fleet(fleet_name, planner);
 
   // We disable fleet state publishing for this fleet adapter because we expect
   // the fleet drivers to publish these messages.
@@ -832,8 +1232,10 @@ std::shared_ptr<Connections> make_fleet(
       !request_msg->fleet_name.empty())
         return;
 
-      connections->fleet->open_lanes(request_msg->open_lanes);
-      connections->fleet->close_lanes(request_msg->close_lanes);
+      // Both lists are applied as one change, so the fleet only has to
+      // rebuild its planner once for the whole request
+      connections->fleet->update_lanes(
+        request_msg->open_lanes, request_msg->close_lanes);
 
       std::unordered_set<std::size_t> newly_closed_lanes;
       for (const auto& l : request_msg->close_lanes)
@@ -845,10 +1247,22 @@ std::shared_ptr<Connections> make_fleet(
       }
 
       for (const auto& l : request_msg->open_lanes)
-        connections->closed_lanes.erase(l);
+      {
+        if (std::find(
+            request_msg->close_lanes.begin(),
+            request_msg->close_lanes.end(), l)
+          == request_msg->close_lanes.end())
+        {
+          connections->closed_lanes.erase(l);
+        }
+      }
 
-      for (auto& [_, robot] : connections->robots)
-        robot->newly_closed_lanes(newly_closed_lanes);
+      // Each robot only replans if its remaining plan uses one of these lanes
+      if (!newly_closed_lanes.empty())
+      {
+        for (auto& [_, robot] : connections->robots)
+          robot->newly_closed_lanes(newly_closed_lanes);
+      }
 
       rmf_fleet_msgs::msg::ClosedLanes state_msg;
       state_msg.fleet_name = fleet_name;
@@ -863,7 +1277,7 @@ std::shared_ptr<Connections> make_fleet(
   // Parameters required for task planner
   // Battery system
   auto battery_system_optional = rmf_fleet_adapter::get_battery_system(
-    *node, 24.0, 40.0, 8.8);
+    *node, 24.0, 40.0, 8.8, prefix);
   if (!battery_system_optional)
   {
     RCLCPP_ERROR(
@@ -877,7 +1291,7 @@ std::shared_ptr<Connections> make_fleet(
 
   // Mechanical system and motion_sink
   auto mechanical_system_optional = rmf_fleet_adapter::get_mechanical_system(
-    *node, 70.0, 40.0, 0.22);
+    *node, 70.0, 40.0, 0.22, prefix);
   if (!mechanical_system_optional)
   {
     RCLCPP_ERROR(
@@ -896,7 +1310,7 @@ std::shared_ptr<Connections> make_fleet(
   // Ambient power system
   const double ambient_power_drain =
     rmf_fleet_adapter::get_parameter_or_default(
-    *node, "ambient_power_drain", 20.0);
+    *node, prefix + "ambient_power_drain", 20.0);
   auto ambient_power_system = rmf_battery::agv::PowerSystem::make(
     ambient_power_drain);
   if (!ambient_power_system)
@@ -913,7 +1327,7 @@ std::shared_ptr<Connections> make_fleet(
 
   // Tool power system
   const double tool_power_drain = rmf_fleet_adapter::get_parameter_or_default(
-    *node, "tool_power_drain", 10.0);
+    *node, prefix + "tool_power_drain", 10.0);
   auto tool_power_system = rmf_battery::agv::PowerSystem::make(
     tool_power_drain);
   if (!tool_power_system)
@@ -930,15 +1344,15 @@ std::shared_ptr<Connections> make_fleet(
 
   // Drain battery
   const bool drain_battery = rmf_fleet_adapter::get_parameter_or_default(
-    *node, "drain_battery", false);
+    *node, prefix + "drain_battery", false);
   // Recharge threshold
   const double recharge_threshold = rmf_fleet_adapter::get_parameter_or_default(
-    *node, "recharge_threshold", 0.2);
+    *node, prefix + "recharge_threshold", 0.2);
   // Recharge state of charge
   const double recharge_soc = rmf_fleet_adapter::get_parameter_or_default(
-    *node, "recharge_soc", 1.0);
+    *node, prefix + "recharge_soc", 1.0);
   const std::string finishing_request_string =
-    node->declare_parameter("finishing_request", "nothing");
+    node->declare_parameter(prefix + "finishing_request", "nothing");
   rmf_task::ConstRequestFactoryPtr finishing_request = nullptr;
   if (finishing_request_string == "charge")
   {
@@ -972,6 +1386,9 @@ std::shared_ptr<Connections> make_fleet(
       finishing_request_string.c_str());
   }
 
+  const double bid_planning_budget = node->declare_parameter<double>(
+    prefix + "bid_planning_budget", 0.5);
+
   if (!connections->fleet->set_task_planner_params(
       battery_system,
       motion_sink,
@@ -980,7 +1397,8 @@ std::shared_ptr<Connections> make_fleet(
       recharge_threshold,
       recharge_soc,
       drain_battery,
-      finishing_request))
+      finishing_request,
+      bid_planning_budget))
   {
     RCLCPP_ERROR(
       node->get_logger(),
@@ -990,21 +1408,21 @@ std::shared_ptr<Connections> make_fleet(
   }
 
   std::unordered_set<uint8_t> task_types;
-  if (node->declare_parameter<bool>("perform_loop", false))
+  if (node->declare_parameter<bool>(prefix + "perform_loop", false))
   {
     task_types.insert(rmf_task_msgs::msg::TaskType::TYPE_LOOP);
   }
 
   // If the perform_deliveries parameter is true, then we just blindly accept
   // all delivery requests.
-  if (node->declare_parameter<bool>("perform_deliveries", false))
+  if (node->declare_parameter<bool>(prefix + "perform_deliveries", false))
   {
     task_types.insert(rmf_task_msgs::msg::TaskType::TYPE_DELIVERY);
     connections->fleet->accept_delivery_requests(
       [](const rmf_task_msgs::msg::Delivery&) { return true; });
   }
 
-  if (node->declare_parameter<bool>("perform_cleaning", false))
+  if (node->declare_parameter<bool>(prefix + "perform_cleaning", false))
   {
     task_types.insert(rmf_task_msgs::msg::TaskType::TYPE_CLEAN);
   }
@@ -1018,7 +1436,85 @@ std::shared_ptr<Connections> make_fleet(
       return false;
     });
 
-  if (node->declare_parameter<bool>("disable_delay_threshold", false))
+  // The dispatcher will not send this fleet the notices of any other tasks
+  connections->fleet->accept_task_types({task_types.begin(), task_types.end()});
+
+  connections->fleet->max_concurrent_allocations(
+    std::max(1, node->declare_parameter<int>(
+      prefix + "max_concurrent_allocations", 4)));
+
+  // Task bid notices that arrive close together can be planned as one bundle
+  const double bid_bundle_period = node->declare_parameter<double>(
+    prefix + "bid_bundle_period", 0.0);
+  if (bid_bundle_period > 0.0)
+  {
+    connections->fleet->bid_bundle_period(
+      rmf_traffic::time::from_seconds(bid_bundle_period));
+  }
+
+  // How long the fleet remembers tasks whose bids it lost or that are done
+  const double bid_lifetime = node->declare_parameter<double>(
+    prefix + "bid_lifetime", 600.0);
+  if (bid_lifetime > 0.0)
+  {
+    connections->fleet->bid_lifetime(
+      rmf_traffic::time::from_seconds(bid_lifetime));
+  }
+
+  connections->fleet->phase_lookahead(
+    node->declare_parameter<bool>(prefix + "phase_lookahead", false));
+
+  connections->fleet->predictive_door_requests(
+    node->declare_parameter<bool>(prefix + "predictive_door_requests", false));
+
+  connections->fleet->predictive_lift_requests(
+    node->declare_parameter<bool>(prefix + "predictive_lift_requests", false));
+
+  // Dispensers can be told about a delivery before the robot arrives
+  const double dispenser_lead_time = node->declare_parameter<double>(
+    prefix + "dispenser_lead_time", 0.0);
+  if (dispenser_lead_time > 0.0)
+  {
+    connections->fleet->dispenser_lead_time(
+      rmf_traffic::time::from_seconds(dispenser_lead_time));
+  }
+
+  // The delays of the robots can be collected and reported together
+  const double delay_report_period = node->declare_parameter<double>(
+    prefix + "delay_report_period", 0.0);
+  if (delay_report_period > 0.0)
+  {
+    connections->fleet->delay_report_period(
+      rmf_traffic::time::from_seconds(delay_report_period));
+  }
+
+  // An estimate of the memory held by the fleet can be published to track
+  // down leaks
+  const double memory_usage_period = node->declare_parameter<double>(
+    prefix + "memory_usage_period", 0.0);
+  if (memory_usage_period > 0.0)
+  {
+    connections->fleet->memory_usage_publish_period(
+      rmf_traffic::time::from_seconds(memory_usage_period));
+  }
+
+  connections->fleet->task_estimation_threads(
+    std::max(1, node->declare_parameter<int>(
+      prefix + "task_estimation_threads", 1)));
+
+  const bool background_task_optimization = node->declare_parameter<bool>(
+    prefix + "background_task_optimization", true);
+
+  connections->fleet->incremental_task_allocation(
+    node->declare_parameter<bool>(
+      prefix + "incremental_task_allocation", false),
+    background_task_optimization);
+
+  connections->fleet->fast_task_cancellation(
+    node->declare_parameter<bool>(prefix + "fast_task_cancellation", false),
+    background_task_optimization);
+
+  if (node->declare_parameter<bool>(prefix + "disable_delay_threshold", false))
   {
     connections->fleet->default_maximum_delay(rmf_utils::nullopt);
   }
@@ -1026,17 +1522,36 @@ std::shared_ptr<Connections> make_fleet(
   {
     connections->fleet->default_maximum_delay(
       rmf_fleet_adapter::get_parameter_or_default_time(
-        *node, "delay_threshold", 10.0));
+        *node, prefix + "delay_threshold", 10.0));
+  }
+
+  // Fleet drivers that can take several robots' paths in one message can opt
+  // into batches by setting a period for them.
+  std::optional<std::chrono::nanoseconds> path_request_batch_period;
+  const double batch_period = node->declare_parameter<double>(
+    prefix + "path_request_batch_period", 0.0);
+  if (batch_period > 0.0)
+  {
+    path_request_batch_period =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(batch_period));
   }
 
-  connections->path_request_pub = node->create_publisher<
-    rmf_fleet_msgs::msg::PathRequest>(
-    rmf_fleet_adapter::PathRequestTopicName, rclcpp::SystemDefaultsQoS());
+  connections->path_request_sender = std::make_shared<PathRequestSender>(
+    *node, path_request_batch_period);
 
   connections->mode_request_pub = node->create_publisher<
     rmf_fleet_msgs::msg::ModeRequest>(
     rmf_fleet_adapter::ModeRequestTopicName, rclcpp::SystemDefaultsQoS());
 
+  const int fleet_state_threads =
+    node->declare_parameter<int>(prefix + "fleet_state_threads", 1);
+  if (fleet_state_threads > 1)
+  {
+    connections->estimation_pool = std::make_unique<EstimationPool>(
+      static_cast<std::size_t>(fleet_state_threads));
+  }
+
   connections->fleet_state_sub = node->create_subscription<
     rmf_fleet_msgs::msg::FleetState>(
     rmf_fleet_adapter::FleetStateTopicName,
@@ -1051,6 +1566,12 @@ std::shared_ptr<Connections> make_fleet(
       if (!connections)
         return;
 
+      using RobotUpdates =
+      rmf_fleet_adapter::agv::FleetUpdateHandle::RobotUpdates;
+
+      std::vector<std::pair<FleetDriverRobotCommandHandlePtr,
+        const rmf_fleet_msgs::msg::RobotState*>> ready;
+      ready.reserve(msg->robots.size());
       for (const auto& state : msg->robots)
       {
         const auto insertion = connections->robots.insert({state.name,
@@ -1066,19 +1587,76 @@ std::shared_ptr<Connections> make_fleet(
         if (command)
         {
           // We are ready to command this robot, so let's update its state
-          command->update_state(state);
+          ready.emplace_back(command, &state);
         }
       }
+
+      // Collect the updates of every robot so that they can all be applied
+      // together instead of scheduling separate jobs for each robot.
+      RobotUpdates updates;
+      if (connections->estimation_pool && ready.size() > 1)
+      {
+        // Each robot collects its own updates, which are then applied in the
+        // order of the message.
+        std::vector<RobotUpdates> robot_updates(ready.size());
+        connections->estimation_pool->run(
+          ready.size(), [&](const std::size_t i)
+          {
+            ready[i].first->update_state(*ready[i].second, &robot_updates[i]);
+          });
+
+        for (const auto& u : robot_updates)
+          updates.append(u);
+      }
+      else
+      {
+        for (const auto& [command, state] : ready)
+          command->update_state(*state, &updates);
+      }
+
+      connections->fleet->update_robots(updates);
     });
 
   const std::string lift_clearance_srv =
     node->declare_parameter<std::string>(
-    "experimental_lift_watchdog_service", "");
+    prefix + "experimental_lift_watchdog_service", "");
   if (!lift_clearance_srv.empty())
   {
     connections->lift_watchdog_client =
       node->create_client<rmf_fleet_msgs::srv::LiftClearance>(
       lift_clearance_srv);
+
+    // Robots that arrive at the same lift around the same time share one
+    // clearance check instead of each waiting on its own service round trip
+    const double lift_clearance_validity = node->declare_parameter<double>(
+      prefix + "lift_clearance_validity", 1.0);
+
+    connections->lift_clearance_cache =
+      rmf_fleet_adapter::agv::LiftClearanceCache::make(
+      [client = connections->lift_watchdog_client](
+        const std::string& robot_name,
+        const std::string& lift_name,
+        rmf_fleet_adapter::agv::LiftClearanceCache::Decide decide)
+      {
+        auto request =
+        std::make_shared<rmf_fleet_msgs::srv::LiftClearance::Request>(
+          rmf_fleet_msgs::build<rmf_fleet_msgs::srv::LiftClearance::Request>()
+          .robot_name(robot_name)
+          .lift_name(lift_name));
+
+        client->async_send_request(
+          request,
+          [decide = std::move(decide)](
+            rclcpp::Client<rmf_fleet_msgs::srv::LiftClearance>::
+            SharedFuture response)
+          {
+            const auto r = response.get();
+            decide(convert_decision(r->decision));
+          });
+      },
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(
+          std::max(0.0, lift_clearance_validity))));
   }
 
   return connections;
@@ -1092,9 +1670,32 @@ int main(int argc, char* argv[])
   if (!adapter)
     return 1;
 
-  const auto fleet_connections = make_fleet(adapter);
-  if (!fleet_connections)
-    return 1;
+  const auto& node = adapter->node();
+  configure_planning_threads(*node);
+
+  // Each name in the fleets parameter gets its parameters from the namespace
+  // of that name, e.g. fleet_a.fleet_name and fleet_a.nav_graph_file. All of
+  // the fleets share this adapter's schedule mirror and negotiation.
+  std::vector<std::string> prefixes;
+  for (const auto& name : node->declare_parameter<std::vector<std::string>>(
+      "fleets", std::vector<std::string>()))
+  {
+    prefixes.push_back(name + ".");
+  }
+
+  if (prefixes.empty())
+    prefixes.push_back("");
+
+  PlannerCache planners;
+  std::vector<std::shared_ptr<Connections>> fleet_connections;
+  for (const auto& prefix : prefixes)
+  {
+    auto connections = make_fleet(adapter, prefix, planners);
+    if (!connections)
+      return 1;
+
+    fleet_connections.push_back(std::move(connections));
+  }
 
   RCLCPP_INFO(adapter->node()->get_logger(), "Starting Fleet Adapter");
 
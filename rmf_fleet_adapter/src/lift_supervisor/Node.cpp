@@ -17,15 +17,19 @@
 
 #include "Node.hpp"
 
+#include <rclcpp_components/register_node_macro.hpp>
+
 #include <rmf_fleet_adapter/StandardNames.hpp>
 #include <rmf_traffic_ros2/StandardNames.hpp>
 
+#include <algorithm>
+
 namespace rmf_fleet_adapter {
 namespace lift_supervisor {
 
 //==============================================================================
-Node::Node()
-: rclcpp::Node("rmf_lift_supervisor")
+Node::Node(const rclcpp::NodeOptions& options)
+: rclcpp::Node("rmf_lift_supervisor", options)
 {
   const auto default_qos = rclcpp::SystemDefaultsQoS();
 
@@ -48,11 +52,26 @@ Node::Node()
 
   _emergency_notice_pub = create_publisher<EmergencyNotice>(
     rmf_traffic_ros2::EmergencyTopicName, default_qos);
+
+  _request_period = std::chrono::duration_cast<
+    std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(
+      std::max(0.0, declare_parameter<double>("request_period", 0.5))));
+
+  // A queued request is dropped if its requester stops repeating it for this
+  // long, e.g. because the robot went somewhere else
+  _queued_sessions = RequestQueue(
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(
+        std::max(0.0, declare_parameter<double>("queue_timeout", 30.0)))));
 }
 
 //==============================================================================
 void Node::_adapter_lift_request_update(LiftRequest::UniquePtr msg)
 {
+  const auto now = std::chrono::steady_clock::now();
+  _queued_sessions.prune(now);
+
   auto& curr_request = _active_sessions.insert(
     std::make_pair(msg->lift_name, nullptr)).first->second;
 
@@ -61,18 +80,36 @@ void Node::_adapter_lift_request_update(LiftRequest::UniquePtr msg)
     if (curr_request->session_id == msg->session_id)
     {
       if (msg->request_type != LiftRequest::REQUEST_END_SESSION)
+      {
+        // A changed request should reach the lift without waiting for the
+        // next reminder
+        if (curr_request->destination_floor != msg->destination_floor
+          || curr_request->door_state != msg->door_state
+          || curr_request->request_type != msg->request_type)
+        {
+          _last_reminders.erase(msg->lift_name);
+        }
+
         curr_request = std::move(msg);
+      }
       else
       {
         _lift_request_pub->publish(*msg);
+        _last_reminders.erase(msg->lift_name);
         curr_request = nullptr;
+        _start_next_session(msg->lift_name, msg->session_id);
       }
     }
+    else
+    {
+      _queued_sessions.push(std::move(msg), now);
+    }
   }
   else
   {
     if (msg->request_type != LiftRequest::REQUEST_END_SESSION)
     {
+      _last_reminders.erase(msg->lift_name);
       curr_request = std::move(msg);
     }
   }
@@ -80,17 +117,60 @@ void Node::_adapter_lift_request_update(LiftRequest::UniquePtr msg)
   // TODO(MXG): Make this more intelligent by scheduling the lift
 }
 
+//==============================================================================
+void Node::_start_next_session(
+  const std::string& lift_name,
+  const std::string& ended_session)
+{
+  // The lift only learns about the end of a session once it gets the end
+  // request, so until then it may still report the session that just ended.
+  // Any other session was not started by us, and the lift is left to it.
+  const auto lift_session = _lift_sessions.find(lift_name);
+  if (lift_session != _lift_sessions.end()
+    && !lift_session->second.empty()
+    && lift_session->second != ended_session)
+  {
+    return;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  auto next = _queued_sessions.pop(lift_name, now);
+  if (!next)
+    return;
+
+  auto& active = _active_sessions[lift_name];
+  active = std::move(next);
+  _lift_request_pub->publish(*active);
+  _last_reminders[lift_name] = now;
+}
+
 //==============================================================================
 void Node::_lift_state_update(LiftState::UniquePtr msg)
 {
+  _queued_sessions.prune(std::chrono::steady_clock::now());
+  _lift_sessions[msg->lift_name] = msg->session_id;
+
   auto& lift_request = _active_sessions.insert(
     std::make_pair(msg->lift_name, nullptr)).first->second;
 
+  // A queued session that was held back because the lift was busy with a
+  // session that we did not start can begin once the lift is free
+  if (!lift_request)
+    _start_next_session(msg->lift_name, "");
+
   if (lift_request)
   {
     if ((lift_request->destination_floor != msg->current_floor) ||
       (lift_request->door_state != msg->door_state))
-      _lift_request_pub->publish(*lift_request);
+    {
+      const auto now = std::chrono::steady_clock::now();
+      const auto insertion = _last_reminders.insert({msg->lift_name, now});
+      if (insertion.second || insertion.first->second + _request_period <= now)
+      {
+        insertion.first->second = now;
+        _lift_request_pub->publish(*lift_request);
+      }
+    }
   }
 
   // For now, we do not need to publish this.
@@ -109,3 +189,5 @@ void Node::_lift_state_update(LiftState::UniquePtr msg)
 
 } // namespace lift_supervisor
 } // namespace rmf_fleet_adapter
+
+RCLCPP_COMPONENTS_REGISTER_NODE(rmf_fleet_adapter::lift_supervisor::Node)
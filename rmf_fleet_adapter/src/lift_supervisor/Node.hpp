@@ -18,6 +18,8 @@
 #ifndef SRC__LIFT_SUPERVISOR__NODE_HPP
 #define SRC__LIFT_SUPERVISOR__NODE_HPP
 
+#include "RequestQueue.hpp"
+
 #include <rmf_lift_msgs/msg/lift_request.hpp>
 #include <rmf_lift_msgs/msg/lift_state.hpp>
 
@@ -25,6 +27,7 @@
 
 #include <rclcpp/node.hpp>
 
+#include <chrono>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -36,7 +39,8 @@ class Node : public rclcpp::Node
 {
 public:
 
-  Node();
+  explicit Node(
+    const rclcpp::NodeOptions& options = rclcpp::NodeOptions());
 
 private:
 
@@ -58,6 +62,27 @@ private:
   EmergencyNoticePub::SharedPtr _emergency_notice_pub;
 
   std::unordered_map<std::string, LiftRequest::UniquePtr> _active_sessions;
+
+  // Requests that arrived for each lift while another session was active. When
+  // the active session ends, the next one begins right away instead of
+  // waiting for its requester to ask again.
+  RequestQueue _queued_sessions;
+
+  // The session that each lift last reported that it is serving, which may
+  // belong to someone other than this supervisor
+  std::unordered_map<std::string, std::string> _lift_sessions;
+
+  /// Begin the next queued session for the lift, unless the lift is still
+  /// being held by a session other than the one that just ended.
+  void _start_next_session(
+    const std::string& lift_name,
+    const std::string& ended_session);
+
+  // When each lift was last reminded of its active session. A lift is reminded
+  // at most once per request period, however often it reports its state.
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+  _last_reminders;
+  std::chrono::steady_clock::duration _request_period;
 };
 
 } // namespace lift_supervisor
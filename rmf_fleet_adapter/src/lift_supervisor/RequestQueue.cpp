@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "RequestQueue.hpp"
+
+#include <algorithm>
+
+namespace rmf_fleet_adapter {
+namespace lift_supervisor {
+
+//==============================================================================
+RequestQueue::RequestQueue(const Clock::duration timeout)
+: _timeout(timeout)
+{
+  // Do nothing
+}
+
+//==============================================================================
+void RequestQueue::push(
+  LiftRequest::UniquePtr request,
+  const Clock::time_point now)
+{
+  const auto queue_it = _queues.find(request->lift_name);
+  const auto find_session = [&](std::deque<Entry>& queue)
+    {
+      return std::find_if(queue.begin(), queue.end(),
+          [&](const Entry& entry)
+          {
+            return entry.request->session_id == request->session_id;
+          });
+    };
+
+  if (request->request_type == LiftRequest::REQUEST_END_SESSION)
+  {
+    // The requester no longer needs the lift, so it leaves the line
+    if (queue_it == _queues.end())
+      return;
+
+    auto& queue = queue_it->second;
+    const auto it = find_session(queue);
+    if (it != queue.end())
+      queue.erase(it);
+
+    if (queue.empty())
+      _queues.erase(queue_it);
+
+    return;
+  }
+
+  auto& queue = _queues[request->lift_name];
+  const auto it = find_session(queue);
+  if (it != queue.end())
+  {
+    // The session keeps its place in line
+    it->request = std::move(request);
+    it->received = now;
+    return;
+  }
+
+  queue.push_back(Entry{std::move(request), now});
+}
+
+//==============================================================================
+void RequestQueue::prune(const Clock::time_point now)
+{
+  for (auto queue_it = _queues.begin(); queue_it != _queues.end(); )
+  {
+    auto& queue = queue_it->second;
+    queue.erase(
+      std::remove_if(queue.begin(), queue.end(),
+      [&](const Entry& entry) { return _expired(entry, now); }),
+      queue.end());
+
+    if (queue.empty())
+      queue_it = _queues.erase(queue_it);
+    else
+      ++queue_it;
+  }
+}
+
+//==============================================================================
+auto RequestQueue::pop(
+  const std::string& lift_name,
+  const Clock::time_point now) -> LiftRequest::UniquePtr
+{
+  const auto queue_it = _queues.find(lift_name);
+  if (queue_it == _queues.end())
+    return nullptr;
+
+  auto& queue = queue_it->second;
+  LiftRequest::UniquePtr next;
+  while (!queue.empty() && !next)
+  {
+    if (!_expired(queue.front(), now))
+      next = std::move(queue.front().request);
+
+    queue.pop_front();
+  }
+
+  if (queue.empty())
+    _queues.erase(queue_it);
+
+  return next;
+}
+
+//==============================================================================
+std::vector<std::string> RequestQueue::sessions(
+  const std::string& lift_name) const
+{
+  std::vector<std::string> sessions;
+  const auto queue_it = _queues.find(lift_name);
+  if (queue_it == _queues.end())
+    return sessions;
+
+  for (const auto& entry : queue_it->second)
+    sessions.push_back(entry.request->session_id);
+
+  return sessions;
+}
+
+//==============================================================================
+bool RequestQueue::empty() const
+{
+  return _queues.empty();
+}
+
+//==============================================================================
+bool RequestQueue::_expired(
+  const Entry& entry,
+  const Clock::time_point now) const
+{
+  return entry.received + _timeout < now;
+}
+
+} // namespace lift_supervisor
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__LIFT_SUPERVISOR__REQUESTQUEUE_HPP
+#define SRC__LIFT_SUPERVISOR__REQUESTQUEUE_HPP
+
+#include <rmf_lift_msgs/msg/lift_request.hpp>
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace lift_supervisor {
+
+//==============================================================================
+/// Requests that arrived for each lift while another session was using it, in
+/// the order that they arrived. A queued request is dropped if its requester
+/// stops repeating it for longer than the timeout, e.g. because the robot
+/// went somewhere else.
+class RequestQueue
+{
+public:
+
+  using LiftRequest = rmf_lift_msgs::msg::LiftRequest;
+  using Clock = std::chrono::steady_clock;
+
+  explicit RequestQueue(Clock::duration timeout = std::chrono::seconds(30));
+
+  /// Add a request to the line for its lift. A session that is already in
+  /// line keeps its place and is refreshed. A request to end a session takes
+  /// that session out of the line.
+  void push(LiftRequest::UniquePtr request, Clock::time_point now);
+
+  /// Drop every request whose requester has stopped repeating it.
+  void prune(Clock::time_point now);
+
+  /// Take the next request that is still being repeated out of the line for
+  /// the lift. This returns a nullptr if nobody is waiting for the lift.
+  LiftRequest::UniquePtr pop(
+    const std::string& lift_name,
+    Clock::time_point now);
+
+  /// Get the sessions that are waiting for the lift, in order.
+  std::vector<std::string> sessions(const std::string& lift_name) const;
+
+  /// Check whether any lift has a line.
+  bool empty() const;
+
+private:
+
+  struct Entry
+  {
+    LiftRequest::UniquePtr request;
+    Clock::time_point received;
+  };
+
+  bool _expired(const Entry& entry, Clock::time_point now) const;
+
+  Clock::duration _timeout;
+  std::unordered_map<std::string, std::deque<Entry>> _queues;
+};
+
+} // namespace lift_supervisor
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__LIFT_SUPERVISOR__REQUESTQUEUE_HPP
@@ -0,0 +1,683 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// This is a load generator for traffic light robots. Instead of driving
+// simulated slotcars like mock_traffic_light does, it hosts any number of
+// simulated robots in a single fleet adapter, and moves them itself along
+// rings of waypoints. A ring is shared by robots_per_ring robots that all
+// travel in the same direction, so the robots of a ring have to take turns
+// through the blockade. Every trip takes a robot path_length waypoints ahead.
+//
+// It reports
+//   - the latency from giving a robot a new path until the traffic light lets
+//     it depart from its first waypoint (go-ahead)
+//   - the number of trips that were completed per second
+//   - the CPU utilization of each group of threads in the process, which
+//     includes the workers of the adapter
+//   - the rate of the messages on each blockade topic
+//
+// This needs a schedule node and a blockade node to be running, e.g.
+//
+//   ros2 run rmf_traffic_ros2 rmf_traffic_schedule
+//   ros2 run rmf_traffic_ros2 rmf_traffic_blockade
+//   mock_traffic_light_benchmark --ros-args -p robots:=200 -p path_length:=10
+//
+// When max_go_ahead_p99 or min_trip_rate are set, the benchmark exits with a
+// non-zero status if the run does not meet them, so it can be used as a
+// regression gate. Run this on an isolated ROS_DOMAIN_ID so that it does not
+// interfere with a live deployment.
+
+#include <rmf_fleet_adapter/agv/Adapter.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+
+#include <rmf_traffic_msgs/msg/blockade_cancel.hpp>
+#include <rmf_traffic_msgs/msg/blockade_heartbeat.hpp>
+#include <rmf_traffic_msgs/msg/blockade_reached.hpp>
+#include <rmf_traffic_msgs/msg/blockade_ready.hpp>
+#include <rmf_traffic_msgs/msg/blockade_release.hpp>
+#include <rmf_traffic_msgs/msg/blockade_set.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+using Clock = std::chrono::steady_clock;
+using TrafficLight = rmf_fleet_adapter::agv::TrafficLight;
+
+namespace {
+//==============================================================================
+const std::string MapName = "L1";
+
+//==============================================================================
+struct Options
+{
+  std::size_t robots;
+  std::size_t robots_per_ring;
+  std::size_t path_length;
+  double spacing;
+  double speed;
+  double update_rate;
+  double duration;
+  double warmup;
+  double max_go_ahead_p99;
+  double min_trip_rate;
+
+  static Options from(rclcpp::Node& node)
+  {
+    const auto positive = [&node](const std::string& name, const int value)
+      {
+        return static_cast<std::size_t>(
+          std::max<int64_t>(1, node.declare_parameter<int>(name, value)));
+      };
+
+    Options o;
+    o.robots = positive("robots", 100);
+    o.robots_per_ring = positive("robots_per_ring", 4);
+    o.path_length = std::max<std::size_t>(2, positive("path_length", 8));
+    o.spacing = node.declare_parameter<double>("spacing", 2.0);
+    o.speed = node.declare_parameter<double>("speed", 1.0);
+    o.update_rate = node.declare_parameter<double>("update_rate", 10.0);
+    o.duration = node.declare_parameter<double>("duration", 60.0);
+    o.warmup = node.declare_parameter<double>("warmup", 10.0);
+    o.max_go_ahead_p99 =
+      node.declare_parameter<double>("max_go_ahead_p99", 0.0);
+    o.min_trip_rate = node.declare_parameter<double>("min_trip_rate", 0.0);
+    return o;
+  }
+};
+
+//==============================================================================
+/// Latency samples of the benchmark, printed as a percentile summary
+class Samples
+{
+public:
+
+  void add(const Clock::duration value)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _values.push_back(
+      std::chrono::duration<double, std::milli>(value).count());
+  }
+
+  /// Get the given percentile in milliseconds, or 0 if there are no samples.
+  double percentile(const double p)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _percentile(p);
+  }
+
+  void print(const std::string& name)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::cout << "  " << std::left << std::setw(10) << name << std::right;
+    if (_values.empty())
+    {
+      std::cout << " no samples\n";
+      return;
+    }
+
+    double total = 0.0;
+    for (const auto v : _values)
+      total += v;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << " n=" << std::setw(8) << _values.size()
+              << " mean=" << std::setw(9) << total / _values.size()
+              << " p50=" << std::setw(9) << _percentile(0.5)
+              << " p90=" << std::setw(9) << _percentile(0.9)
+              << " p99=" << std::setw(9) << _percentile(0.99)
+              << " max=" << std::setw(9) << _percentile(1.0)
+              << "  [ms]\n";
+  }
+
+private:
+
+  double _percentile(const double p)
+  {
+    if (_values.empty())
+      return 0.0;
+
+    std::sort(_values.begin(), _values.end());
+    const auto index = static_cast<std::size_t>(
+      p * static_cast<double>(_values.size() - 1));
+    return _values[index];
+  }
+
+  std::mutex _mutex;
+  std::vector<double> _values;
+};
+
+//==============================================================================
+struct Stats
+{
+  std::atomic_bool recording{false};
+  std::atomic_size_t trips{0};
+  std::atomic_size_t deadlocks{0};
+  Samples go_ahead;
+};
+
+//==============================================================================
+/// The positions of the waypoints of one ring
+std::vector<Eigen::Vector3d> make_ring(
+  const Options& options,
+  const std::size_t ring_index)
+{
+  const std::size_t size = options.robots_per_ring * options.path_length;
+  const double radius = size * options.spacing / (2.0 * M_PI);
+
+  // The rings are laid out in a row with some room between them
+  const double x_offset = ring_index * (2.0 * radius + 10.0);
+
+  std::vector<Eigen::Vector3d> ring;
+  ring.reserve(size);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    const double angle = 2.0 * M_PI * i / size;
+    ring.push_back(
+      {x_offset + radius * std::cos(angle), radius * std::sin(angle),
+        angle + M_PI/2.0});
+  }
+
+  return ring;
+}
+
+//==============================================================================
+// A robot that moves along its ring whenever the traffic light lets it. The
+// callbacks of the traffic light come from the workers of the adapter while
+// the robot is stepped by the driver thread, so its state is guarded by a
+// mutex. The callbacks that it gives back to the traffic light are always
+// triggered after that mutex is released.
+class SimulatedRobot : public TrafficLight::CommandHandle
+{
+public:
+
+  SimulatedRobot(
+    std::shared_ptr<const std::vector<Eigen::Vector3d>> ring,
+    const std::size_t start,
+    const Options& options,
+    Stats& stats)
+  : _ring(std::move(ring)),
+    _ring_index(start),
+    _path_length(options.path_length),
+    _speed(options.speed),
+    _stats(&stats)
+  {
+    // Do nothing
+  }
+
+  void set_update_handle(TrafficLight::UpdateHandlePtr handle)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _update = std::move(handle);
+    _update->fleet_state_publish_period(std::nullopt);
+    _next_trip();
+  }
+
+  void receive_checkpoints(
+    const std::size_t version,
+    std::vector<Checkpoint> checkpoints,
+    const std::size_t standby_at,
+    OnStandby on_standby,
+    Reject) final
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (version != _version)
+      return;
+
+    for (auto& c : checkpoints)
+      _checkpoints[c.waypoint_index] = std::move(c.departed);
+
+    _checkpoints.erase(
+      _checkpoints.lower_bound(standby_at), _checkpoints.end());
+    _standby_at = standby_at;
+    _on_standby = std::move(on_standby);
+
+    if (_awaiting_go_ahead && _checkpoints.count(0))
+    {
+      _awaiting_go_ahead = false;
+      if (_stats->recording)
+        _stats->go_ahead.add(Clock::now() - _path_sent);
+    }
+  }
+
+  void immediately_stop_until(
+    const std::size_t version,
+    rclcpp::Time,
+    StoppedAt stopped_at,
+    Departed departed) final
+  {
+    Eigen::Vector3d location;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (version != _version)
+        return;
+
+      _stopped = true;
+      _resume_departed = std::move(departed);
+      location = _location();
+    }
+
+    if (stopped_at)
+      stopped_at(location);
+  }
+
+  void resume(const std::size_t version) final
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (version != _version)
+      return;
+
+    _stopped = false;
+  }
+
+  void deadlock(std::vector<Blocker>) final
+  {
+    ++_stats->deadlocks;
+  }
+
+  /// Move the robot forward by dt seconds
+  void step(const double dt)
+  {
+    std::vector<std::function<void()>> triggers;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _step(dt, triggers);
+    }
+
+    for (const auto& trigger : triggers)
+      trigger();
+  }
+
+private:
+
+  void _step(const double dt, std::vector<std::function<void()>>& triggers)
+  {
+    if (!_update)
+      return;
+
+    if (_stopped)
+      return;
+
+    if (_resume_departed)
+    {
+      triggers.push_back(
+        [departed = std::move(_resume_departed), p = _location()]()
+        {
+          departed(p);
+        });
+      _resume_departed = nullptr;
+    }
+
+    if (!_moving)
+    {
+      if (_at + 1 == _path.size())
+      {
+        ++_stats->trips;
+        _ring_index = (_ring_index + _path_length - 1) % _ring->size();
+        _next_trip();
+        return;
+      }
+
+      if (_at == _standby_at)
+      {
+        if (_on_standby)
+          triggers.push_back(std::move(_on_standby));
+
+        _on_standby = nullptr;
+        return;
+      }
+
+      const auto it = _checkpoints.find(_at);
+      if (it == _checkpoints.end())
+        return;
+
+      triggers.push_back(
+        [departed = std::move(it->second), p = _path[_at]]()
+        {
+          departed(p);
+        });
+      _checkpoints.erase(it);
+      _moving = true;
+    }
+
+    const double length = (_path[_at+1] - _path[_at]).block<2, 1>(0, 0).norm();
+    _progress += _speed * dt / std::max(length, 1e-3);
+    if (_progress >= 1.0)
+    {
+      ++_at;
+      _progress = 0.0;
+      _moving = false;
+    }
+  }
+
+  Eigen::Vector3d _location() const
+  {
+    if (_path.empty())
+      return (*_ring)[_ring_index];
+
+    if (!_moving)
+      return _path[_at];
+
+    return _path[_at] + _progress * (_path[_at+1] - _path[_at]);
+  }
+
+  void _next_trip()
+  {
+    _path.clear();
+    std::vector<rmf_fleet_adapter::agv::Waypoint> waypoints;
+    for (std::size_t i = 0; i < _path_length; ++i)
+    {
+      const auto& p = (*_ring)[(_ring_index + i) % _ring->size()];
+      _path.push_back(p);
+      waypoints.emplace_back(MapName, p);
+    }
+
+    _at = 0;
+    _progress = 0.0;
+    _moving = false;
+    _standby_at = 0;
+    _on_standby = nullptr;
+    _checkpoints.clear();
+    _awaiting_go_ahead = true;
+    _path_sent = Clock::now();
+
+    // The traffic light hands its commands to a worker, so this will not
+    // call back into the robot while its mutex is locked.
+    _version = _update->follow_new_path(waypoints);
+  }
+
+  std::shared_ptr<const std::vector<Eigen::Vector3d>> _ring;
+  std::size_t _ring_index;
+  std::size_t _path_length;
+  double _speed;
+  Stats* _stats;
+
+  std::mutex _mutex;
+  TrafficLight::UpdateHandlePtr _update;
+  std::size_t _version = 0;
+  std::vector<Eigen::Vector3d> _path;
+  std::size_t _at = 0;
+  double _progress = 0.0;
+  bool _moving = false;
+  bool _stopped = false;
+  Departed _resume_departed;
+  std::map<std::size_t, Departed> _checkpoints;
+  std::size_t _standby_at = 0;
+  OnStandby _on_standby;
+  bool _awaiting_go_ahead = false;
+  Clock::time_point _path_sent;
+};
+
+//==============================================================================
+/// Counts the messages on every blockade topic
+class MessageCounter
+{
+public:
+
+  MessageCounter(rclcpp::Node& node)
+  {
+    using namespace rmf_traffic_ros2;
+    using namespace rmf_traffic_msgs::msg;
+    _count<BlockadeSet>(node, BlockadeSetTopicName);
+    _count<BlockadeReady>(node, BlockadeReadyTopicName);
+    _count<BlockadeReached>(node, BlockadeReachedTopicName);
+    _count<BlockadeRelease>(node, BlockadeReleaseTopicName);
+    _count<BlockadeCancel>(node, BlockadeCancelTopicName);
+    _count<BlockadeHeartbeat>(node, BlockadeHeartbeatTopicName);
+  }
+
+  std::map<std::string, std::size_t> snapshot() const
+  {
+    std::map<std::string, std::size_t> counts;
+    for (const auto& [topic, count] : _counts)
+      counts[topic] = *count;
+
+    return counts;
+  }
+
+private:
+
+  template<typename Message>
+  void _count(rclcpp::Node& node, const std::string& topic)
+  {
+    auto count = std::make_shared<std::atomic_size_t>(0);
+    _counts[topic] = count;
+
+    // Best effort subscriptions can be matched with publishers of either
+    // reliability
+    _subscriptions.push_back(
+      node.create_subscription<Message>(
+        topic, rclcpp::SystemDefaultsQoS().best_effort(),
+        [count](const std::shared_ptr<const Message>)
+        {
+          ++(*count);
+        }));
+  }
+
+  std::map<std::string, std::shared_ptr<std::atomic_size_t>> _counts;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> _subscriptions;
+};
+
+//==============================================================================
+/// The CPU time of every thread in the process, added up by thread name
+std::map<std::string, double> thread_cpu_seconds()
+{
+  std::map<std::string, double> seconds;
+  const double ticks = static_cast<double>(sysconf(_SC_CLK_TCK));
+
+  DIR* dir = opendir("/proc/self/task");
+  if (!dir)
+    return seconds;
+
+  while (const dirent* entry = readdir(dir))
+  {
+    if (entry->d_name[0] == '.')
+      continue;
+
+    std::ifstream file(
+      std::string("/proc/self/task/") + entry->d_name + "/stat");
+    std::string stat;
+    std::getline(file, stat);
+
+    // The name is in parentheses and may contain spaces
+    const auto open = stat.find('(');
+    const auto close = stat.rfind(')');
+    if (open == std::string::npos || close == std::string::npos)
+      continue;
+
+    const std::string name = stat.substr(open + 1, close - open - 1);
+
+    // utime and stime are the 12th and 13th fields after the name
+    std::istringstream fields(stat.substr(close + 2));
+    std::string field;
+    double utime = 0.0;
+    double stime = 0.0;
+    for (int i = 0; i < 13 && fields >> field; ++i)
+    {
+      if (i == 11)
+        utime = std::stod(field);
+      else if (i == 12)
+        stime = std::stod(field);
+    }
+
+    seconds[name] += (utime + stime) / ticks;
+  }
+
+  closedir(dir);
+  return seconds;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+
+  auto driver_node = std::make_shared<rclcpp::Node>(
+    "mock_traffic_light_benchmark_driver");
+  const auto options = Options::from(*driver_node);
+
+  const auto adapter = rmf_fleet_adapter::agv::Adapter::make(
+    "mock_traffic_light_benchmark");
+  if (!adapter)
+    return 1;
+
+  adapter->start();
+
+  Stats stats;
+  MessageCounter counter(*driver_node);
+  rclcpp::executors::SingleThreadedExecutor driver_executor;
+  driver_executor.add_node(driver_node);
+  std::thread driver_thread([&]() { driver_executor.spin(); });
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {options.speed, 0.5},
+    {1.0, 1.0},
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(0.4)}
+  };
+
+  std::vector<std::shared_ptr<SimulatedRobot>> robots;
+  std::shared_ptr<const std::vector<Eigen::Vector3d>> ring;
+  for (std::size_t i = 0; i < options.robots; ++i)
+  {
+    const std::size_t ring_index = i / options.robots_per_ring;
+    const std::size_t slot = i % options.robots_per_ring;
+    if (slot == 0)
+    {
+      ring = std::make_shared<std::vector<Eigen::Vector3d>>(
+        make_ring(options, ring_index));
+    }
+
+    auto robot = std::make_shared<SimulatedRobot>(
+      ring, slot * options.path_length, options, stats);
+    robots.push_back(robot);
+
+    adapter->add_traffic_light(
+      robot, "benchmark_fleet", "robot_" + std::to_string(i), traits,
+      [w = std::weak_ptr<SimulatedRobot>(robot)](
+        TrafficLight::UpdateHandlePtr handle)
+      {
+        if (const auto robot = w.lock())
+          robot->set_update_handle(std::move(handle));
+      });
+  }
+
+  const double dt = 1.0 / std::max(options.update_rate, 1e-3);
+  const auto step_timer = driver_node->create_wall_timer(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(dt)),
+    [&robots, dt]()
+    {
+      for (const auto& robot : robots)
+        robot->step(dt);
+    });
+
+  RCLCPP_INFO(
+    driver_node->get_logger(),
+    "Started %lu traffic light robots; warming up for %.1fs",
+    robots.size(), options.warmup);
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.warmup));
+
+  stats.recording = true;
+  const auto wall_start = Clock::now();
+  const auto cpu_start = thread_cpu_seconds();
+  const auto messages_start = counter.snapshot();
+  const std::size_t trips_start = stats.trips;
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.duration));
+
+  stats.recording = false;
+  const double wall = std::chrono::duration<double>(
+    Clock::now() - wall_start).count();
+  const auto cpu_end = thread_cpu_seconds();
+  const auto messages_end = counter.snapshot();
+  const double trip_rate = (stats.trips - trips_start) / wall;
+
+  std::cout << "\nTraffic light benchmark with " << options.robots
+            << " robots, " << options.robots_per_ring << " per ring, "
+            << options.path_length << " waypoints per trip over " << wall
+            << "s\n";
+
+  stats.go_ahead.print("go-ahead");
+
+  std::cout << std::fixed << std::setprecision(3)
+            << "  trips: " << trip_rate << " per second, "
+            << stats.deadlocks << " deadlocks reported\n"
+            << "  cpu by thread name [% of one core]:\n";
+  for (const auto& [name, end] : cpu_end)
+  {
+    const auto it = cpu_start.find(name);
+    const double used = end - (it == cpu_start.end() ? 0.0 : it->second);
+    std::cout << "    " << std::left << std::setw(16) << name << std::right
+              << std::setw(9) << 100.0 * used / wall << "\n";
+  }
+
+  std::cout << "  messages [per second]:\n";
+  for (const auto& [topic, end] : messages_end)
+  {
+    std::cout << "    " << std::left << std::setw(36) << topic << std::right
+              << std::setw(12) << (end - messages_start.at(topic)) / wall
+              << "\n";
+  }
+
+  bool passed = true;
+  const double p99 = stats.go_ahead.percentile(0.99) / 1000.0;
+  if (options.max_go_ahead_p99 > 0.0 && p99 > options.max_go_ahead_p99)
+  {
+    std::cout << "REGRESSION: go-ahead p99 of " << p99 << "s is above "
+              << options.max_go_ahead_p99 << "s\n";
+    passed = false;
+  }
+
+  if (options.min_trip_rate > 0.0 && trip_rate < options.min_trip_rate)
+  {
+    std::cout << "REGRESSION: " << trip_rate << " trips per second is below "
+              << options.min_trip_rate << "\n";
+    passed = false;
+  }
+
+  driver_executor.cancel();
+  driver_thread.join();
+  adapter->stop();
+
+  // Nothing is stepping the robots anymore, so they can be torn down before
+  // the context goes away.
+  robots.clear();
+  rclcpp::shutdown();
+  return passed ? 0 : 1;
+}
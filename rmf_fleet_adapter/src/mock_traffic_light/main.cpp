@@ -748,7 +748,12 @@ std::shared_ptr<Connections> make_fleet(
 
   auto graph =
     std::make_shared<rmf_traffic::agv::Graph>(
-    rmf_fleet_adapter::agv::parse_graph(graph_file, *connections->traits));
+    rmf_fleet_adapter::agv::parse_graph(
+      graph_file, *connections->traits,
+      [node](const std::string& message)
+      {
+        RCLCPP_WARN(node->get_logger(), "%s", message.c_str());
+      }));
 
   // We add pseudo-events on every lane to force the planner to include every
   // intermediate waypoint in its plan.
@@ -37,6 +37,53 @@
 namespace rmf_fleet_adapter {
 namespace read_only {
 
+namespace {
+//==============================================================================
+uint64_t extend_fingerprint(
+  uint64_t fingerprint,
+  const rmf_fleet_msgs::msg::Location& l)
+{
+  for (const double value : {l.x, l.y, l.yaw})
+  {
+    const uint64_t h = std::hash<double>()(value);
+    fingerprint ^= h + 0x9e3779b97f4a7c15 + (fingerprint << 6)
+      + (fingerprint >> 2);
+  }
+
+  return fingerprint;
+}
+
+//==============================================================================
+/// Fingerprints are built from the back of the path to the front so that the
+/// fingerprint of a whole path can be compared to the fingerprint of a tail
+/// of a longer path.
+uint64_t fingerprint_path(
+  const std::vector<rmf_fleet_msgs::msg::Location>& path)
+{
+  uint64_t fingerprint = 0;
+  for (auto it = path.rbegin(); it != path.rend(); ++it)
+    fingerprint = extend_fingerprint(fingerprint, *it);
+
+  return fingerprint;
+}
+
+//==============================================================================
+rmf_traffic::Duration travel_duration(
+  TrajectorySegmentCache& cache,
+  const rmf_fleet_msgs::msg::Location& from,
+  const rmf_fleet_msgs::msg::Location& to)
+{
+  const auto trajectory = cache.interpolate(
+    rmf_traffic::Time(),
+    {{from.x, from.y, from.yaw}, {to.x, to.y, to.yaw}});
+
+  if (trajectory.size() < 2)
+    return rmf_traffic::Duration(0);
+
+  return *trajectory.finish_time() - *trajectory.start_time();
+}
+} // anonymous namespace
+
 //==============================================================================
 std::shared_ptr<FleetAdapterNode> FleetAdapterNode::make()
 {
@@ -113,10 +160,8 @@ FleetAdapterNode::ScheduleEntry::ScheduleEntry(
           const rmf_traffic::schedule::Negotiation::Table::ViewerPtr& table,
           const rmf_traffic::schedule::Negotiator::ResponderPtr& responder)
         {
-          const auto itinerary = this->schedule->participant().itinerary();
-
+          const auto& cache = this->negotiation_cache();
           const auto proposals = table->base_proposals();
-          const auto& profile = this->schedule->description().profile();
           for (const auto& p : proposals)
           {
             const auto other_participant =
@@ -132,41 +177,77 @@ FleetAdapterNode::ScheduleEntry::ScheduleEntry(
               return responder->forfeit({});
             }
 
+            const auto& profile = this->schedule->description().profile();
             const auto& other_profile = other_participant->profile();
+            const double other_radius = RouteBounds::radius(other_profile);
             for (const auto& other_route : p.itinerary)
             {
-              for (const auto& item : itinerary)
+              // Most routes of other participants are nowhere near ours, so
+              // only the ones whose bounds overlap with one of our routes are
+              // checked precisely.
+              std::optional<RouteBounds> other_bounds;
+              for (std::size_t i = 0; i < cache.routes.size(); ++i)
               {
-                if (item.route->map() != other_route->map())
+                const auto& route = *cache.routes[i];
+                if (route.map() != other_route->map())
+                  continue;
+
+                if (!other_bounds)
+                  other_bounds.emplace(*other_route, other_radius);
+
+                if (!cache.bounds[i].might_conflict(*other_bounds))
                   continue;
 
                 if (rmf_traffic::DetectConflict::between(
                   profile,
-                  item.route->trajectory(),
+                  route.trajectory(),
                   other_profile,
                   other_route->trajectory()))
                 {
-                  rmf_traffic::schedule::Itinerary alternative;
-                  alternative.reserve(itinerary.size());
-                  for (const auto& item : itinerary)
-                    alternative.emplace_back(item.route);
-
-                  return responder->reject({std::move(alternative)});
+                  return responder->reject(cache.alternatives);
                 }
               }
             }
           }
 
-          std::vector<rmf_traffic::Route> submission;
-          submission.reserve(itinerary.size());
-          for (const auto& item : itinerary)
-            submission.push_back(*item.route);
-
-          return responder->submit(std::move(submission));
+          return responder->submit(cache.submission);
         });
     }, async_mutex);
 }
 
+//==============================================================================
+auto FleetAdapterNode::ScheduleEntry::negotiation_cache()
+-> const NegotiationCache&
+{
+  const auto& participant = schedule->participant();
+  const auto version = participant.version();
+  if (_negotiation_cache.version == version)
+    return _negotiation_cache;
+
+  const auto& itinerary = participant.itinerary();
+  const double radius =
+    RouteBounds::radius(schedule->description().profile());
+
+  NegotiationCache cache;
+  cache.version = version;
+  cache.routes.reserve(itinerary.size());
+  cache.bounds.reserve(itinerary.size());
+  cache.submission.reserve(itinerary.size());
+  for (const auto& item : itinerary)
+  {
+    cache.routes.push_back(item.route);
+    cache.bounds.emplace_back(*item.route, radius);
+    cache.submission.push_back(*item.route);
+  }
+
+  // A read-only robot cannot change its itinerary, so the only alternative
+  // that it can offer when it rejects a proposal is the itinerary itself.
+  cache.alternatives = {cache.routes};
+
+  _negotiation_cache = std::move(cache);
+  return _negotiation_cache;
+}
+
 //==============================================================================
 bool FleetAdapterNode::ignore_fleet(const std::string& fleet_name) const
 {
@@ -180,7 +261,9 @@ bool FleetAdapterNode::ignore_fleet(const std::string& fleet_name) const
 FleetAdapterNode::FleetAdapterNode()
 : rclcpp::Node("fleet_adapter"),
   _fleet_name(get_fleet_name_parameter(*this)),
-  _traits(get_traits_or_default(*this, 0.7, 0.3, 0.5, 1.5, 0.5, 1.5))
+  _traits(get_traits_or_default(*this, 0.7, 0.3, 0.5, 1.5, 0.5, 1.5)),
+  _path_tolerance(declare_parameter("path_tolerance", 1e-8)),
+  _segment_cache(_traits)
 {
   // Do nothing. Everything else is initialized in make()
 }
@@ -203,17 +286,74 @@ void FleetAdapterNode::fleet_state_update(FleetState::UniquePtr state)
   }
 }
 
+//==============================================================================
+void FleetAdapterNode::remember_path(
+  ScheduleEntry& entry,
+  const std::vector<Location>& path)
+{
+  entry.path = path;
+  entry.tail_fingerprints.assign(1, 0);
+  entry.tail_durations.assign(1, rmf_traffic::Duration(0));
+  entry.tail_fingerprints.reserve(path.size() + 1);
+  entry.tail_durations.reserve(path.size() + 1);
+
+  // The robot comes to a stop at each location of its path, so the time to
+  // travel each segment does not depend on the segments that came before it.
+  for (std::size_t k = 1; k <= path.size(); ++k)
+  {
+    const auto& l = path[path.size()-k];
+    entry.tail_fingerprints.push_back(
+      extend_fingerprint(entry.tail_fingerprints.back(), l));
+
+    auto duration = entry.tail_durations.back();
+    if (k > 1)
+      duration += travel_duration(_segment_cache, l, path[path.size()-k+1]);
+
+    entry.tail_durations.push_back(duration);
+  }
+}
+
+//==============================================================================
+bool FleetAdapterNode::same_path(
+  const ScheduleEntry& entry,
+  const std::vector<Location>& path) const
+{
+  if (entry.path.size() < path.size())
+  {
+    // If the state has more points in its path than what is remembered from
+    // before, then it must have a new path that it is following.
+    return false;
+  }
+
+  // This is the usual case: the robot is reporting exactly the same points as
+  // before, except for the ones that it has already passed.
+  if (fingerprint_path(path) == entry.tail_fingerprints[path.size()])
+    return true;
+
+  for (std::size_t i = 1; i <= path.size(); ++i)
+  {
+    const auto& l_state = path[path.size()-i];
+    const auto& l_entry = entry.path[entry.path.size()-i];
+
+    const Eigen::Vector3d p_state{l_state.x, l_state.y, l_state.yaw};
+    const Eigen::Vector3d p_entry{l_entry.x, l_entry.y, l_entry.yaw};
+
+    if ((p_state - p_entry).norm() > _path_tolerance)
+      return false;
+  }
+
+  return true;
+}
+
 //==============================================================================
 void FleetAdapterNode::push_route(
   const RobotState& state,
   const ScheduleEntries::iterator& it)
 {
-  it->second->path.clear();
-  for (const auto& location : state.path)
-    it->second->path.push_back(location);
+  remember_path(*it->second, state.path);
 
   it->second->cumulative_delay = std::chrono::seconds(0);
-  it->second->route = make_route(state, _traits, it->second->sitting);
+  it->second->route = make_route(state, _segment_cache, it->second->sitting);
   it->second->schedule->push_routes({*it->second->route});
 }
 
@@ -250,33 +390,33 @@ bool FleetAdapterNode::handle_delay(
 
   auto& entry = *it->second;
 
-  if (entry.path.size() < state.path.size())
-  {
-    // If the state has more points in its path than what is remembered from
-    // before, then it must have a new path that it is following, so sending a
-    // delay is not sufficient.
+  // If the robot is following a different path, then sending a delay is not
+  // sufficient.
+  if (!same_path(entry, state.path))
     return false;
-  }
-
-  for (std::size_t i = 1; i <= state.path.size(); ++i)
-  {
-    const auto& l_state = state.path[state.path.size()-i];
-    const auto& l_entry = entry.path[entry.path.size()-i];
-
-    const Eigen::Vector3d p_state{l_state.x, l_state.y, l_state.yaw};
-    const Eigen::Vector3d p_entry{l_entry.x, l_entry.y, l_entry.yaw};
-
-    // TODO(MXG): Make this threshold configurable
-    if ((p_state - p_entry).norm() > 1e-8)
-      return false;
-  }
-
-  entry.path.clear();
-  for (const auto& location : state.path)
-    entry.path.push_back(location);
 
-  bool sitting = false;
-  auto new_trajectory = make_trajectory(state, _traits, sitting);
+  // Only the head of the path has advanced, so we forget the points that the
+  // robot has passed. The remembered points are kept rather than replaced by
+  // the reported ones so that small drifts cannot add up over time.
+  const std::size_t remaining = state.path.size();
+  entry.path.erase(
+    entry.path.begin(), entry.path.end() - static_cast<std::ptrdiff_t>(remaining));
+  entry.tail_fingerprints.resize(remaining + 1);
+  entry.tail_durations.resize(remaining + 1);
+
+  // Rather than interpolating the whole remaining path again, we only need to
+  // interpolate from the robot's location to the next point of its path.
+  const auto start_time = rmf_traffic_ros2::convert(state.location.t);
+  const auto head = state.path.empty() ?
+    rmf_traffic::Duration(0) :
+    travel_duration(_segment_cache, state.location, state.path.front());
+  const auto tail = entry.tail_durations[remaining];
+  const auto new_finish_time = start_time + head + tail;
+
+  // A robot whose remaining path takes no time to travel is sitting, just as
+  // make_trajectory() would decide.
+  const bool sitting =
+    head == rmf_traffic::Duration(0) && tail == rmf_traffic::Duration(0);
 
   if (entry.sitting && sitting)
   {
@@ -325,7 +465,7 @@ bool FleetAdapterNode::handle_delay(
   }
 
   const auto time_difference =
-    *new_trajectory.finish_time() - *entry.route->trajectory().finish_time();
+    new_finish_time - *entry.route->trajectory().finish_time();
 
 //  std::cout << "Calculating delay: ["
 //            << rmf_traffic::time::to_seconds(time_difference) << "]" << std::endl;
@@ -26,6 +26,7 @@
 
 #include <rclcpp/node.hpp>
 
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -34,6 +35,8 @@
 #include <rmf_traffic_ros2/schedule/MirrorManager.hpp>
 
 #include "../rmf_fleet_adapter/ScheduleManager.hpp"
+#include "../rmf_fleet_adapter/make_trajectory.hpp"
+#include "../rmf_fleet_adapter/RouteBounds.hpp"
 
 namespace rmf_fleet_adapter {
 namespace read_only {
@@ -59,6 +62,14 @@ private:
 
   rmf_traffic::Duration _delay_threshold;
 
+  // How far each point of a reported path may drift from the remembered path
+  // before it is considered to be a new path.
+  double _path_tolerance;
+
+  // Robots of a read-only fleet tend to report the same path segments over and
+  // over, so their interpolated motions are shared through this cache.
+  TrajectorySegmentCache _segment_cache;
+
   using FleetState = rmf_fleet_msgs::msg::FleetState;
   rclcpp::Subscription<FleetState>::SharedPtr _fleet_state_subscription;
 
@@ -73,6 +84,15 @@ private:
   {
     rmf_utils::optional<ScheduleManager> schedule;
     std::vector<Location> path;
+
+    // Element k is the fingerprint of the last k locations of path, so a
+    // reported path can be checked against any tail of path at once.
+    std::vector<uint64_t> tail_fingerprints;
+
+    // Element k is how long it takes to travel through the last k locations
+    // of path, starting from the first of them.
+    std::vector<rmf_traffic::Duration> tail_durations;
+
     rmf_utils::optional<rmf_traffic::Route> route;
     rmf_traffic::Duration cumulative_delay = rmf_traffic::Duration(0);
     bool sitting = false;
@@ -81,6 +101,23 @@ private:
       FleetAdapterNode* node,
       std::string name,
       std::mutex& async_mutex);
+
+    // What the negotiator needs to know about the itinerary of the robot.
+    // This only changes when the itinerary does, so it is shared by every
+    // table that the robot is asked to respond to.
+    struct NegotiationCache
+    {
+      std::optional<rmf_traffic::schedule::ItineraryVersion> version;
+      rmf_traffic::schedule::Itinerary routes;
+      std::vector<RouteBounds> bounds;
+      std::vector<rmf_traffic::Route> submission;
+      rmf_traffic::schedule::Negotiator::Responder::Alternatives alternatives;
+    };
+
+    const NegotiationCache& negotiation_cache();
+
+  private:
+    NegotiationCache _negotiation_cache;
   };
 
   using ScheduleEntries =
@@ -89,6 +126,12 @@ private:
 
   using RobotState = rmf_fleet_msgs::msg::RobotState;
 
+  void remember_path(ScheduleEntry& entry, const std::vector<Location>& path);
+
+  bool same_path(
+    const ScheduleEntry& entry,
+    const std::vector<Location>& path) const;
+
   void push_route(
     const RobotState& state,
     const ScheduleEntries::iterator& it);
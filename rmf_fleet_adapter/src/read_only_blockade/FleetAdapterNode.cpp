@@ -57,7 +57,12 @@ std::shared_ptr<FleetAdapterNode> FleetAdapterNode::make()
     return nullptr;
   }
 
-  auto graph = rmf_fleet_adapter::agv::parse_graph(graph_file, node->_traits);
+  auto graph = rmf_fleet_adapter::agv::parse_graph(
+    graph_file, node->_traits,
+    [node](const std::string& message)
+    {
+      RCLCPP_WARN(node->get_logger(), "%s", message.c_str());
+    });
   auto planner = rmf_traffic::agv::Planner(
     rmf_traffic::agv::Planner::Configuration(std::move(graph), node->_traits),
     rmf_traffic::agv::Planner::Options(nullptr)
@@ -94,6 +99,11 @@ std::shared_ptr<FleetAdapterNode> FleetAdapterNode::make()
         std::move(planner)
       };
 
+      node->_plan_thread = std::thread([self = node.get()]()
+          {
+            self->plan_loop();
+          });
+
       node->_fleet_state_subscription =
         node->create_subscription<FleetState>(
         FleetStateTopicName, rclcpp::SystemDefaultsQoS(),
@@ -109,6 +119,19 @@ std::shared_ptr<FleetAdapterNode> FleetAdapterNode::make()
   return nullptr;
 }
 
+//==============================================================================
+FleetAdapterNode::~FleetAdapterNode()
+{
+  {
+    std::lock_guard<std::mutex> lock(_plan_mutex);
+    _plan_quit = true;
+  }
+  _plan_cv.notify_all();
+
+  if (_plan_thread.joinable())
+    _plan_thread.join();
+}
+
 //==============================================================================
 bool FleetAdapterNode::ignore_fleet(const std::string& fleet_name) const
 {
@@ -276,6 +299,7 @@ void FleetAdapterNode::update_robot(
     if (state.task_id.empty())
     {
       // Switch to not having a task
+      cancel_plan(*robot);
       robot->current_goal = std::nullopt;
       robot->schedule->set(make_hold(state, now));
       robot->blockade.cancel();
@@ -301,6 +325,8 @@ void FleetAdapterNode::update_robot(
 
     if (state.task_id.empty())
     {
+      cancel_plan(*robot);
+
       // Just report our current location to the schedule
       if (robot->schedule->itinerary().empty())
       {
@@ -444,12 +470,92 @@ void FleetAdapterNode::make_plan(
     return;
   }
 
+  // A plan for this goal is already on its way, so there is no need to ask for
+  // another one.
+  if (robot.planning_goal == state.task_id)
+    return;
+
+  robot.planning_goal = state.task_id;
+  const auto version = ++robot.plan_version;
+
+  {
+    std::lock_guard<std::mutex> lock(_plan_mutex);
+    const auto insertion = _plan_jobs.insert_or_assign(
+      state.name, PlanJob{state, now, goal_wp->index(), version});
+
+    // A robot that is already waiting in the queue keeps its place, but its
+    // job is replaced by the latest one.
+    if (insertion.second)
+      _plan_queue.push_back(state.name);
+  }
+  _plan_cv.notify_one();
+}
+
+//==============================================================================
+void FleetAdapterNode::cancel_plan(Robot& robot)
+{
+  if (!robot.planning_goal.has_value())
+    return;
+
+  // The background thread will discard the plan when it sees that the version
+  // has changed.
+  robot.planning_goal = std::nullopt;
+  ++robot.plan_version;
+}
+
+//==============================================================================
+void FleetAdapterNode::plan_loop()
+{
+  while (true)
+  {
+    std::string name;
+    std::optional<PlanJob> job;
+    {
+      std::unique_lock<std::mutex> lock(_plan_mutex);
+      _plan_cv.wait(lock, [&]() { return _plan_quit || !_plan_queue.empty(); });
+      if (_plan_quit)
+        return;
+
+      name = std::move(_plan_queue.front());
+      _plan_queue.pop_front();
+      const auto it = _plan_jobs.find(name);
+      job = std::move(it->second);
+      _plan_jobs.erase(it);
+    }
+
+    const auto result = compute_plan(*job);
+
+    std::lock_guard<std::mutex> lock(_async_mutex);
+    const auto it = _robots.find(name);
+    if (it == _robots.end() || !it->second)
+      continue;
+
+    auto& robot = *it->second;
+    if (robot.plan_version != job->version)
+    {
+      // The robot has been given a different goal or none at all since this
+      // job was queued.
+      continue;
+    }
+
+    // If planning failed, the next state update of the robot will try again
+    robot.planning_goal = std::nullopt;
+    if (result.has_value())
+      apply_plan(*job, robot, **result);
+  }
+}
+
+//==============================================================================
+std::optional<rmf_traffic::agv::Planner::Result>
+FleetAdapterNode::compute_plan(const PlanJob& job) const
+{
+  const auto& state = job.state;
   const auto& location = state.location;
   const Eigen::Vector3d p = {location.x, location.y, location.yaw};
   const auto starts = rmf_traffic::agv::compute_plan_starts(
     _connect->planner.get_configuration().graph(),
     location.level_name,
-    p, now,
+    p, job.time,
     _waypoint_snap_distance,
     _lane_snap_distance);
 
@@ -461,10 +567,10 @@ void FleetAdapterNode::make_plan(
        << location.x << ", " << location.y << "), yaw: " << location.yaw;
 
     RCLCPP_ERROR(get_logger(), "%s", ss.str().c_str());
-    return;
+    return std::nullopt;
   }
 
-  const auto result = _connect->planner.plan(starts, goal_wp->index());
+  auto result = _connect->planner.plan(starts, job.goal);
   if (!result.success())
   {
     std::stringstream ss;
@@ -472,13 +578,26 @@ void FleetAdapterNode::make_plan(
        << _fleet_name << "] to navigate from map [" << location.level_name
        << "], position (" << location.x << ", " << location.y << ") to the "
        << "waypoint named [" << state.task_id << "], graph index ["
-       << goal_wp->index() << "]";
+       << job.goal << "]";
 
     RCLCPP_ERROR(get_logger(), "%s", ss.str().c_str());
-    return;
+    return std::nullopt;
   }
 
-  if (result->get_waypoints().size() < 2)
+  return result;
+}
+
+//==============================================================================
+void FleetAdapterNode::apply_plan(
+  const PlanJob& job,
+  Robot& robot,
+  const rmf_traffic::agv::Plan& plan)
+{
+  const auto& state = job.state;
+  const auto now = job.time;
+  const auto& graph = _connect->planner.get_configuration().graph();
+
+  if (plan.get_waypoints().size() < 2)
   {
     // TODO(MXG): Refactor this condition with the one down below
     // We don't actually need to go anywhere
@@ -489,7 +608,7 @@ void FleetAdapterNode::make_plan(
     return;
   }
 
-  robot.expectation = convert_to_expectation(*result, state, graph);
+  robot.expectation = convert_to_expectation(plan, state, graph);
 
   if (robot.expectation->path.size() == 1)
   {
@@ -501,7 +620,7 @@ void FleetAdapterNode::make_plan(
     return;
   }
 
-  auto original = result->get_itinerary();
+  auto original = plan.get_itinerary();
   const auto& last_wp = original.back().trajectory().back();
   original.back().trajectory().insert(
     last_wp.time() + std::chrono::seconds(60),
@@ -11,6 +11,10 @@
 
 #include <rclcpp/node.hpp>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -33,6 +37,8 @@ public:
 
   static std::shared_ptr<FleetAdapterNode> make();
 
+  ~FleetAdapterNode();
+
   bool ignore_fleet(const std::string& fleet_name) const;
 
   using RobotState = rmf_fleet_msgs::msg::RobotState;
@@ -51,6 +57,13 @@ public:
     std::optional<Expectation> expectation;
 
     std::optional<std::string> current_goal;
+
+    // The goal that is currently being planned for in the background, if any
+    std::optional<std::string> planning_goal = std::nullopt;
+
+    // Incremented whenever a plan is requested or cancelled, so that plans
+    // which finish after they have been superseded can be discarded.
+    uint64_t plan_version = 0;
   };
 
 private:
@@ -88,6 +101,24 @@ private:
   using Robots = std::unordered_map<std::string, std::unique_ptr<Robot>>;
   Robots _robots;
 
+  struct PlanJob
+  {
+    RobotState state;
+    rmf_traffic::Time time;
+    std::size_t goal;
+    uint64_t version;
+  };
+
+  // Plans are computed by a background thread so that a slow plan does not
+  // hold up the state updates of the rest of the fleet. Only the latest job of
+  // each robot is kept, and robots are served in the order they asked.
+  std::mutex _plan_mutex;
+  std::condition_variable _plan_cv;
+  std::unordered_map<std::string, PlanJob> _plan_jobs;
+  std::deque<std::string> _plan_queue;
+  bool _plan_quit = false;
+  std::thread _plan_thread;
+
   void fleet_state_update(FleetState::UniquePtr new_state);
 
   void register_robot(const RobotState& state);
@@ -117,6 +148,18 @@ private:
     Robot& robot,
     rmf_traffic::Time now);
 
+  void cancel_plan(Robot& robot);
+
+  void plan_loop();
+
+  std::optional<rmf_traffic::agv::Planner::Result> compute_plan(
+    const PlanJob& job) const;
+
+  void apply_plan(
+    const PlanJob& job,
+    Robot& robot,
+    const rmf_traffic::agv::Plan& plan);
+
   rmf_traffic::Duration make_delay(
     const rmf_traffic::schedule::Participant& schedule,
     rmf_traffic::Time now);
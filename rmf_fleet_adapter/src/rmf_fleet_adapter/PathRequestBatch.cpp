@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_fleet_adapter/PathRequestBatch.hpp>
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace rmf_fleet_adapter {
+
+namespace {
+//==============================================================================
+void write_u32(std::vector<uint8_t>& data, const uint32_t value)
+{
+  for (int i = 0; i < 4; ++i)
+    data.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+uint32_t read_u32(const std::vector<uint8_t>& data, std::size_t& index)
+{
+  if (data.size() - index < 4)
+    throw PathRequestBatchError("[PathRequestBatch] Truncated batch");
+
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i)
+    value |= static_cast<uint32_t>(data[index++]) << (8*i);
+
+  return value;
+}
+} // anonymous namespace
+
+//==============================================================================
+PathRequestBatch encode_path_request_batch(
+  const std::vector<rmf_fleet_msgs::msg::PathRequest>& requests)
+{
+  const rclcpp::Serialization<rmf_fleet_msgs::msg::PathRequest> serializer;
+
+  PathRequestBatch batch;
+  write_u32(batch.data, static_cast<uint32_t>(requests.size()));
+  for (const auto& request : requests)
+  {
+    rclcpp::SerializedMessage serialized;
+    serializer.serialize_message(&request, &serialized);
+    const auto& raw = serialized.get_rcl_serialized_message();
+    write_u32(batch.data, static_cast<uint32_t>(raw.buffer_length));
+    batch.data.insert(
+      batch.data.end(), raw.buffer, raw.buffer + raw.buffer_length);
+  }
+
+  return batch;
+}
+
+//==============================================================================
+std::vector<rmf_fleet_msgs::msg::PathRequest> decode_path_request_batch(
+  const PathRequestBatch& batch)
+{
+  const rclcpp::Serialization<rmf_fleet_msgs::msg::PathRequest> serializer;
+
+  std::size_t index = 0;
+  const uint32_t count = read_u32(batch.data, index);
+
+  std::vector<rmf_fleet_msgs::msg::PathRequest> requests;
+  // Every request needs at least its size, so a corrupt count can't make us
+  // reserve more than the batch could possibly hold.
+  requests.reserve(std::min<std::size_t>(count, batch.data.size()/4));
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    const std::size_t size = read_u32(batch.data, index);
+    if (batch.data.size() - index < size)
+      throw PathRequestBatchError("[PathRequestBatch] Truncated batch");
+
+    rclcpp::SerializedMessage serialized(size);
+    auto& raw = serialized.get_rcl_serialized_message();
+    std::memcpy(raw.buffer, batch.data.data() + index, size);
+    raw.buffer_length = size;
+    index += size;
+
+    rmf_fleet_msgs::msg::PathRequest request;
+    serializer.deserialize_message(&serialized, &request);
+    requests.emplace_back(std::move(request));
+  }
+
+  if (index != batch.data.size())
+    throw PathRequestBatchError("[PathRequestBatch] Trailing bytes in batch");
+
+  return requests;
+}
+
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "RouteBounds.hpp"
+
+#include <rmf_traffic/Time.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace rmf_fleet_adapter {
+
+//==============================================================================
+RouteBounds::RouteBounds(
+  const rmf_traffic::Route& route,
+  const double radius,
+  const rmf_traffic::Duration slice_duration)
+: _map(route.map())
+{
+  const auto& trajectory = route.trajectory();
+  if (trajectory.size() == 0)
+    return;
+
+  const auto inflate = [](Box box, const double pad)
+    {
+      box.min() -= Eigen::Vector2d::Constant(pad);
+      box.max() += Eigen::Vector2d::Constant(pad);
+      return box;
+    };
+
+  if (trajectory.size() == 1)
+  {
+    const auto& wp = trajectory.front();
+    const Eigen::Vector2d p = wp.position().block<2, 1>(0, 0);
+    _slices.push_back(Slice{wp.time(), wp.time(), inflate(Box(p, p), radius)});
+    return;
+  }
+
+  auto it = trajectory.begin();
+  auto prev = it++;
+  for (; it != trajectory.end(); prev = it++)
+  {
+    const Eigen::Vector2d p0 = prev->position().block<2, 1>(0, 0);
+    const Eigen::Vector2d p1 = it->position().block<2, 1>(0, 0);
+    const double v0 = prev->velocity().block<2, 1>(0, 0).norm();
+    const double v1 = it->velocity().block<2, 1>(0, 0).norm();
+    const double dt = rmf_traffic::time::to_seconds(it->time() - prev->time());
+
+    // The motion between two waypoints is a cubic Hermite spline whose
+    // position basis functions are non-negative and sum to one, so the curve
+    // can only leave the box of its endpoints through the velocity terms. The
+    // magnitude of each velocity basis function never exceeds 4/27.
+    const double pad = radius + 4.0/27.0 * std::abs(dt) * (v0 + v1);
+    const Box box = inflate(Box(p0.cwiseMin(p1), p0.cwiseMax(p1)), pad);
+
+    if (!_slices.empty()
+      && prev->time() < _slices.back().start + slice_duration)
+    {
+      auto& slice = _slices.back();
+      slice.finish = it->time();
+      slice.box.extend(box);
+    }
+    else
+    {
+      _slices.push_back(Slice{prev->time(), it->time(), box});
+    }
+  }
+}
+
+//==============================================================================
+const std::string& RouteBounds::map() const
+{
+  return _map;
+}
+
+//==============================================================================
+auto RouteBounds::slices() const -> const std::vector<Slice>&
+{
+  return _slices;
+}
+
+//==============================================================================
+bool RouteBounds::might_conflict(const RouteBounds& other) const
+{
+  if (_map != other._map)
+    return false;
+
+  // Both sequences of slices are sorted by time, so we can walk through them
+  // together and only compare the slices whose windows overlap.
+  std::size_t i = 0;
+  std::size_t j = 0;
+  while (i < _slices.size() && j < other._slices.size())
+  {
+    const auto& a = _slices[i];
+    const auto& b = other._slices[j];
+    if (a.finish < b.start)
+    {
+      ++i;
+      continue;
+    }
+
+    if (b.finish < a.start)
+    {
+      ++j;
+      continue;
+    }
+
+    if (a.box.intersects(b.box))
+      return true;
+
+    if (a.finish < b.finish)
+      ++i;
+    else
+      ++j;
+  }
+
+  return false;
+}
+
+//==============================================================================
+double RouteBounds::radius(const rmf_traffic::Profile& profile)
+{
+  double r = 0.0;
+  if (const auto& footprint = profile.footprint())
+    r = std::max(r, footprint->get_characteristic_length());
+
+  if (const auto& vicinity = profile.vicinity())
+    r = std::max(r, vicinity->get_characteristic_length());
+
+  return r;
+}
+
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__ROUTEBOUNDS_HPP
+#define SRC__RMF_FLEET_ADAPTER__ROUTEBOUNDS_HPP
+
+#include <rmf_traffic/Profile.hpp>
+#include <rmf_traffic/Route.hpp>
+
+#include <Eigen/Geometry>
+
+#include <vector>
+
+namespace rmf_fleet_adapter {
+
+//==============================================================================
+/// The space that a route sweeps through over time, kept as a sequence of
+/// axis-aligned boxes that each cover a short window of time. The boxes are
+/// inflated by the radius of the participant's profile, so two routes can
+/// only be in conflict if they are on the same map and some of their boxes
+/// overlap both in time and in space.
+///
+/// This is meant as a cheap screening test to decide which pairs of routes
+/// need to be passed to rmf_traffic::DetectConflict::between.
+class RouteBounds
+{
+public:
+
+  using Box = Eigen::AlignedBox2d;
+
+  /// The swept box of a route during a window of time
+  struct Slice
+  {
+    rmf_traffic::Time start;
+    rmf_traffic::Time finish;
+    Box box;
+  };
+
+  /// Constructor
+  ///
+  /// \param[in] route
+  ///   The route to bound
+  ///
+  /// \param[in] radius
+  ///   How far to inflate the boxes. Use radius() to get the value for a
+  ///   profile.
+  ///
+  /// \param[in] slice_duration
+  ///   How much time each box should cover. Shorter slices give tighter
+  ///   bounds for long routes at the cost of more boxes.
+  RouteBounds(
+    const rmf_traffic::Route& route,
+    double radius,
+    rmf_traffic::Duration slice_duration = std::chrono::seconds(10));
+
+  /// The map of the route
+  const std::string& map() const;
+
+  /// The slices of the route, sorted by time
+  const std::vector<Slice>& slices() const;
+
+  /// True if the routes might be in conflict. When this returns false, the
+  /// routes are certainly not in conflict.
+  bool might_conflict(const RouteBounds& other) const;
+
+  /// Get the radius that a profile needs to be inflated by to encompass both
+  /// its footprint and its vicinity.
+  static double radius(const rmf_traffic::Profile& profile);
+
+private:
+  std::string _map;
+  std::vector<Slice> _slices;
+};
+
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__ROUTEBOUNDS_HPP
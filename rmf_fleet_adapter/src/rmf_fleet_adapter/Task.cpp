@@ -48,7 +48,18 @@ std::shared_ptr<Task> Task::make(
 void Task::begin()
 {
   if (!_active_phase)
+  {
+    _task_span = rmf_traffic_ros2::tracing::span(
+      "task.execute", rmf_traffic_ros2::tracing::task(_id));
     _start_next_phase();
+  }
+}
+
+//==============================================================================
+void Task::prepare()
+{
+  if (!_active_phase && !_pending_phases.empty())
+    _pending_phases.back()->prepare();
 }
 
 //==============================================================================
@@ -120,6 +131,12 @@ const Task::TaskProfileMsg& Task::task_profile() const
   return _profile;
 }
 
+//==============================================================================
+void Task::phase_finished_callback(PhaseFinishedCallback callback)
+{
+  _phase_finished_callback = std::move(callback);
+}
+
 //==============================================================================
 Task::Task(
   std::string id,
@@ -142,9 +159,18 @@ Task::Task(
 //==============================================================================
 void Task::_start_next_phase()
 {
+  if (_active_phase && _phase_finished_callback)
+  {
+    _phase_finished_callback(
+      typeid(*_active_phase),
+      std::chrono::steady_clock::now() - _active_phase_start);
+  }
+
+  _phase_span.end();
   if (_pending_phases.empty())
   {
     // All phases are now complete
+    _task_span.end();
     _active_phase = nullptr;
     _active_phase_subscription.get().unsubscribe();
     _status_publisher.get_subscriber().on_completed();
@@ -173,8 +199,16 @@ void Task::_start_next_phase()
       "[Task::_start_next_phase] INTERNAL ERROR: Next phase has a null value");
     // *INDENT-ON*
   }
+  _active_phase_start = std::chrono::steady_clock::now();
+  _phase_span = rmf_traffic_ros2::tracing::span(
+    "task.phase", rmf_traffic_ros2::tracing::task(_id),
+    {{"rmf.phase", next_pending->description()}});
   _active_phase = next_pending->begin();
 
+  // Give the next phase a chance to get ready while this one is underway
+  if (!_pending_phases.empty())
+    _pending_phases.back()->prepare();
+
   _active_phase_subscription =
     _active_phase->observe()
     .observe_on(rxcpp::identity_same_worker(_worker))
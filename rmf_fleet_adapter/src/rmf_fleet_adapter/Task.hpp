@@ -18,8 +18,10 @@
 #ifndef SRC__RMF_FLEET_ADAPTER__TASK_HPP
 #define SRC__RMF_FLEET_ADAPTER__TASK_HPP
 
+#include <functional>
 #include <string>
 #include <memory>
+#include <typeinfo>
 
 #include <rmf_traffic/schedule/Negotiator.hpp>
 #include <rmf_traffic/Time.hpp>
@@ -32,6 +34,8 @@
 #include <rmf_rxcpp/RxJobs.hpp>
 #include <rmf_rxcpp/Publisher.hpp>
 
+#include <rmf_traffic_ros2/Tracer.hpp>
+
 namespace rmf_fleet_adapter {
 
 //==============================================================================
@@ -87,6 +91,11 @@ public:
     /// Human-readable description of the phase
     virtual const std::string& description() const = 0;
 
+    /// Start any work for this phase that can be done before it begins. This
+    /// is called while the phase before it is still active, and it may be
+    /// called more than once. By default nothing is done.
+    virtual void prepare() {}
+
     // Virtual destructor
     virtual ~PendingPhase() = default;
   };
@@ -108,6 +117,9 @@ public:
 
   void begin();
 
+  /// Prepare the first phase of this task while it is still queued
+  void prepare();
+
   /// Get a reference to an observable for the status of this Task
   const rxcpp::observable<StatusMsg>& observe() const;
 
@@ -140,6 +152,14 @@ public:
   /// Get the TaskProfile of this task
   const TaskProfileMsg& task_profile() const;
 
+  using PhaseFinishedCallback = std::function<
+    void(const std::type_info& phase_type, rmf_traffic::Duration duration)>;
+
+  /// Set a callback that is given the type of each phase of this task and how
+  /// long the phase was active, once the phase has finished. Phases that fail
+  /// or are still active when the task is dropped are not reported.
+  void phase_finished_callback(PhaseFinishedCallback callback);
+
 private:
 
   Task(
@@ -156,6 +176,8 @@ private:
   // pop_back() to snatch the next phase.
   std::vector<std::unique_ptr<PendingPhase>> _pending_phases;
   std::shared_ptr<ActivePhase> _active_phase;
+  std::chrono::steady_clock::time_point _active_phase_start;
+  PhaseFinishedCallback _phase_finished_callback;
 
   rxcpp::schedulers::worker _worker;
 
@@ -172,6 +194,10 @@ private:
 
   TaskProfileMsg _profile;
 
+  // Trace spans of the whole task and of its active phase
+  rmf_traffic_ros2::Tracer::Span _task_span;
+  rmf_traffic_ros2::Tracer::Span _phase_span;
+
   void _start_next_phase();
 
   StatusMsg _process_summary(const StatusMsg& input_msg);
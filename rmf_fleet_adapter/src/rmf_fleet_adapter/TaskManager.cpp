@@ -33,12 +33,24 @@
 
 #include "phases/ResponsiveWait.hpp"
 
+#include <cmath>
+
 namespace rmf_fleet_adapter {
 
+namespace {
+//==============================================================================
+// How much the battery level of an idle robot must change before we check
+// again whether it should retreat to its charger
+const double RetreatEvaluationStep = 0.01;
+} // anonymous namespace
+
 //==============================================================================
-TaskManagerPtr TaskManager::make(agv::RobotContextPtr context)
+TaskManagerPtr TaskManager::make(
+  agv::RobotContextPtr context,
+  std::shared_ptr<agv::DeadlineTimer> deadlines)
 {
   auto mgr = TaskManagerPtr(new TaskManager(std::move(context)));
+  mgr->_deadlines = std::move(deadlines);
   mgr->_emergency_sub = mgr->_context->node()->emergency_notice()
     .observe_on(rxcpp::identity_same_worker(mgr->_context->worker()))
     .subscribe(
@@ -54,24 +66,20 @@ TaskManagerPtr TaskManager::make(agv::RobotContextPtr context)
       }
     });
 
-  mgr->_task_timer = mgr->context()->node()->try_create_wall_timer(
-    std::chrono::seconds(1),
-    [w = mgr->weak_from_this()]()
+  mgr->_battery_soc_sub = mgr->_context->observe_battery_soc()
+    .observe_on(rxcpp::identity_same_worker(mgr->_context->worker()))
+    .subscribe(
+    [w = mgr->weak_from_this()](const double soc)
     {
-      if (auto mgr = w.lock())
-      {
-        mgr->_begin_next_task();
-      }
-    });
+      const auto mgr = w.lock();
+      if (!mgr)
+        return;
 
-  mgr->_retreat_timer = mgr->context()->node()->try_create_wall_timer(
-    std::chrono::seconds(10),
-    [w = mgr->weak_from_this()]()
-    {
-      if (auto mgr = w.lock())
-      {
-        mgr->retreat_to_charger();
-      }
+      const auto& last_soc = mgr->_retreat_evaluated_soc;
+      if (last_soc && std::abs(*last_soc - soc) < RetreatEvaluationStep)
+        return;
+
+      mgr->retreat_to_charger();
     });
 
   mgr->_begin_waiting();
@@ -103,15 +111,29 @@ auto TaskManager::expected_finish_state() const -> State
   if (_active_task)
     return _context->current_task_end_state();
 
-  // Update battery soc and finish time in the current state
-  auto finish_state = _context->current_task_end_state();
+  const double current_battery_soc = _context->current_battery_soc();
+  const auto end_state_version = _context->current_task_end_state_version();
+
+  // Any change of the battery level changes the estimates that the task
+  // planner makes from this state, so the cached state is only reused while
+  // the battery level is exactly the same.
+  std::lock_guard<std::mutex> lock(_finish_state_mutex);
+  if (!_finish_state_cache
+    || _finish_state_cache->end_state_version != end_state_version
+    || _finish_state_cache->state.battery_soc() != current_battery_soc)
+  {
+    // Update battery soc in the current state
+    auto state = _context->current_task_end_state();
+    state.battery_soc(current_battery_soc);
+    _finish_state_cache = FinishStateCache{std::move(state), end_state_version};
+  }
+
+  // The finish time always needs to be the current time
+  auto finish_state = _finish_state_cache->state;
   auto location = finish_state.location();
   location.time(rmf_traffic_ros2::convert(_context->node()->now()));
   finish_state.location(location);
 
-  const double current_battery_soc = _context->current_battery_soc();
-  finish_state.battery_soc(current_battery_soc);
-
   return finish_state;
 }
 
@@ -143,6 +165,7 @@ void TaskManager::set_queue(
   {
     std::lock_guard<std::mutex> guard(_mutex);
     _queue.clear();
+    std::unordered_map<std::string, TaskSummaryMsg> queued_summaries;
 
     // We use dynamic cast to determine the type of request and then call the
     // appropriate make(~) function to convert the request into a task
@@ -308,22 +331,44 @@ void TaskManager::set_queue(
         continue;
       }
 
-      // publish queued task
+      // Only publish the queued tasks that are new to this robot or whose
+      // summary has changed, e.g. because they moved within the queue. Tasks
+      // that left the queue are reported by whoever takes them over.
       TaskSummaryMsg msg;
       _populate_task_summary(_queue.back(), msg.STATE_QUEUED, msg);
-      _context->node()->task_summary()->publish(msg);
+      const auto previous = _queued_summaries.find(msg.task_id);
+      if (previous == _queued_summaries.end() || !(previous->second == msg))
+        _context->node()->task_summary()->publish(msg);
+
+      queued_summaries.insert_or_assign(msg.task_id, std::move(msg));
     }
+
+    _queued_summaries = std::move(queued_summaries);
+
+    // The task that will follow the active one may have changed
+    if (_active_task && !_queue.empty())
+      _queue.front()->prepare();
+
+    _refresh_requests();
   }
 
+  _invalidate_finish_state();
+
+  _reserve_charger(assignments);
   _begin_next_task();
 }
 
 //==============================================================================
-const std::vector<rmf_task::ConstRequestPtr> TaskManager::requests() const
+const std::vector<rmf_task::ConstRequestPtr>& TaskManager::requests() const
 {
-  using namespace rmf_task::requests;
-  std::vector<rmf_task::ConstRequestPtr> requests;
-  requests.reserve(_queue.size());
+  return _requests;
+}
+
+//==============================================================================
+void TaskManager::_refresh_requests()
+{
+  _requests.clear();
+  _requests.reserve(_queue.size());
   for (const auto& task : _queue)
   {
     if (task->request()->automatic())
@@ -331,9 +376,30 @@ const std::vector<rmf_task::ConstRequestPtr> TaskManager::requests() const
       continue;
     }
 
-    requests.push_back(task->request());
+    _requests.push_back(task->request());
+  }
+}
+
+//==============================================================================
+void TaskManager::_invalidate_finish_state()
+{
+  std::lock_guard<std::mutex> lock(_finish_state_mutex);
+  _finish_state_cache = std::nullopt;
+}
+
+//==============================================================================
+auto TaskManager::assignments() const -> std::vector<Assignment>
+{
+  std::vector<Assignment> assignments;
+  assignments.reserve(_queue.size());
+  for (const auto& task : _queue)
+  {
+    assignments.emplace_back(
+      task->request(),
+      task->finish_state(),
+      task->deployment_time());
   }
-  return requests;
+  return assignments;
 }
 
 //==============================================================================
@@ -385,10 +451,14 @@ void TaskManager::_begin_next_task()
 
   if (now >= deployment_time)
   {
+    _next_task_deadline = nullptr;
+
     // Update state in RobotContext and Assign active task
     _context->current_task_end_state(_queue.front()->finish_state());
     _active_task = std::move(_queue.front());
     _queue.erase(_queue.begin());
+    _queued_summaries.erase(_active_task->id());
+    _refresh_requests();
 
     RCLCPP_INFO(
       _context->node()->get_logger(),
@@ -441,15 +511,46 @@ void TaskManager::_begin_next_task()
         self->_context->node()->task_summary()->publish(msg);
 
         self->_active_task = nullptr;
+        self->_invalidate_finish_state();
+        self->_begin_next_task();
+
+        // The robot may have become idle somewhere new
+        self->_retreat_evaluated_soc = std::nullopt;
+        self->retreat_to_charger();
       });
 
+    if (const auto& metrics = _context->phase_metrics())
+    {
+      _active_task->phase_finished_callback(
+        metrics->execution_recorder(_context->name()));
+    }
+
     _active_task->begin();
     _register_executed_task(_active_task->id());
+
+    if (!_queue.empty())
+      _queue.front()->prepare();
   }
   else
   {
     if (!_waiting)
       _begin_waiting();
+
+    _next_task_deadline = _deadlines->schedule(
+      deployment_time,
+      [w = weak_from_this()]()
+      {
+        const auto self = w.lock();
+        if (!self)
+          return;
+
+        self->_context->worker().schedule(
+          [w](const auto&)
+          {
+            if (const auto self = w.lock())
+              self->_begin_next_task();
+          });
+      });
   }
 }
 
@@ -528,6 +629,38 @@ void TaskManager::_begin_waiting()
     });
 }
 
+//==============================================================================
+void TaskManager::_reserve_charger(const std::vector<Assignment>& assignments)
+{
+  const auto& index = _context->charger_index();
+  if (!index)
+    return;
+
+  using rmf_task::requests::ChargeBattery;
+  const auto is_charging = [](const rmf_task::ConstRequestPtr& request)
+    {
+      return std::dynamic_pointer_cast<const ChargeBattery::Description>(
+        request->description()) != nullptr;
+    };
+
+  for (const auto& a : assignments)
+  {
+    if (!is_charging(a.request()))
+      continue;
+
+    // Only the first charge of the queue is reserved. The robot will be
+    // planned again long before any later charge.
+    index->reserve(
+      _context->name(), a.state().waypoint(), _context->now(),
+      a.state().finish_time());
+    return;
+  }
+
+  // A robot that is charging right now keeps its reservation until it is done
+  if (!_active_task || !is_charging(_active_task->request()))
+    index->release(_context->name());
+}
+
 //==============================================================================
 void TaskManager::retreat_to_charger()
 {
@@ -537,6 +670,8 @@ void TaskManager::retreat_to_charger()
       return;
   }
 
+  _retreat_evaluated_soc = _context->current_battery_soc();
+
   const auto task_planner = _context->task_planner();
   if (!task_planner)
     return;
@@ -556,49 +691,84 @@ void TaskManager::retreat_to_charger()
   const auto& parameters = task_planner->configuration().parameters();
   auto& estimate_cache = *(task_planner->estimate_cache());
 
-  double retreat_battery_drain = 0.0;
-  const auto endpoints = std::make_pair(current_state.waypoint(),
-      current_state.charging_waypoint());
-  const auto& cache_result = estimate_cache.get(endpoints);
+  using Estimate = agv::ChargerIndex::Estimate;
+  const auto compute_retreat = [&](std::size_t charger) -> Estimate
+    {
+      const auto endpoints = std::make_pair(current_state.waypoint(), charger);
+      const auto& cache_result = estimate_cache.get(endpoints);
+      if (cache_result)
+        return {cache_result->duration, cache_result->dsoc};
 
-  if (cache_result)
-  {
-    retreat_battery_drain = cache_result->dsoc;
-  }
-  else
+      const rmf_traffic::agv::Planner::Goal retreat_goal{charger};
+      const auto result_to_charger = parameters.planner()->plan(
+        current_state.location(), retreat_goal);
+
+      // We assume we can always compute a plan
+      double retreat_battery_drain = 0.0;
+      rmf_traffic::Duration retreat_duration = rmf_traffic::Duration{0};
+      rmf_traffic::Time itinerary_start_time = current_state.finish_time();
+
+      for (const auto& itinerary : result_to_charger->get_itinerary())
+      {
+        const auto& trajectory = itinerary.trajectory();
+        const auto& finish_time = *trajectory.finish_time();
+        const rmf_traffic::Duration itinerary_duration =
+          finish_time - itinerary_start_time;
+
+        const double dSOC_motion =
+          parameters.motion_sink()->compute_change_in_charge(
+          trajectory);
+        const double dSOC_device =
+          parameters.ambient_sink()->compute_change_in_charge(
+          rmf_traffic::time::to_seconds(itinerary_duration));
+        retreat_battery_drain += dSOC_motion + dSOC_device;
+        retreat_duration += itinerary_duration;
+        itinerary_start_time = finish_time;
+      }
+
+      estimate_cache.set(endpoints, retreat_duration, retreat_battery_drain);
+      return {retreat_duration, retreat_battery_drain};
+    };
+
+  // The estimates are shared by the whole fleet, so a robot does not repeat
+  // an estimate that another robot has already made from the same waypoint
+  const auto& index = _context->charger_index();
+  const auto estimate_retreat = [&](std::size_t charger) -> Estimate
+    {
+      if (!index)
+        return compute_retreat(charger);
+
+      return *index->estimate(
+        current_state.waypoint(), charger,
+        [&]() -> std::optional<Estimate> { return compute_retreat(charger); });
+    };
+
+  // If another robot has taken the designated charger of this robot, the
+  // robot retreats to the free charger that drains the least battery instead
+  const auto now = _context->now();
+  auto charger = current_state.charging_waypoint();
+  auto retreat = estimate_retreat(charger);
+  if (index && !index->available(charger, _context->name(), now))
   {
-    const rmf_traffic::agv::Planner::Goal retreat_goal{
-      current_state.charging_waypoint()};
-    const auto result_to_charger = parameters.planner()->plan(
-      current_state.location(), retreat_goal);
-
-    // We assume we can always compute a plan
-    double dSOC_motion = 0.0;
-    double dSOC_device = 0.0;
-    rmf_traffic::Duration retreat_duration = rmf_traffic::Duration{0};
-    rmf_traffic::Time itinerary_start_time = current_state.finish_time();
-
-    for (const auto& itinerary : result_to_charger->get_itinerary())
+    std::optional<std::pair<std::size_t, Estimate>> alternative;
+    for (const auto c : index->chargers())
+    {
+      if (c == charger || !index->available(c, _context->name(), now))
+        continue;
+
+      const auto e = estimate_retreat(c);
+      if (!alternative.has_value() || e.dsoc < alternative->second.dsoc)
+        alternative = std::make_pair(c, e);
+    }
+
+    if (alternative.has_value())
     {
-      const auto& trajectory = itinerary.trajectory();
-      const auto& finish_time = *trajectory.finish_time();
-      const rmf_traffic::Duration itinerary_duration =
-        finish_time - itinerary_start_time;
-
-      dSOC_motion =
-        parameters.motion_sink()->compute_change_in_charge(
-        trajectory);
-      dSOC_device =
-        parameters.ambient_sink()->compute_change_in_charge(
-        rmf_traffic::time::to_seconds(itinerary_duration));
-      retreat_battery_drain += dSOC_motion + dSOC_device;
-      retreat_duration += itinerary_duration;
-      itinerary_start_time = finish_time;
+      charger = alternative->first;
+      retreat = alternative->second;
     }
-    estimate_cache.set(endpoints, retreat_duration,
-      retreat_battery_drain);
   }
 
+  const double retreat_battery_drain = retreat.dsoc;
   const double battery_soc_after_retreat =
     current_battery_soc - retreat_battery_drain;
 
@@ -612,8 +782,10 @@ void TaskManager::retreat_to_charger()
       current_state.finish_time(),
       parameters);
 
+    auto charging_state = current_state;
+    charging_state.charging_waypoint(charger);
     const auto finish = model->estimate_finish(
-      current_state,
+      charging_state,
       constraints,
       estimate_cache);
 
@@ -645,7 +817,7 @@ void TaskManager::retreat_to_charger()
 }
 
 //==============================================================================
-const std::vector<std::string>& TaskManager::get_executed_tasks() const
+const std::deque<std::string>& TaskManager::get_executed_tasks() const
 {
   return _executed_task_registry;
 }
@@ -657,9 +829,12 @@ void TaskManager::_register_executed_task(const std::string& id)
   // TODO: Save a time stamp for when tasks are completed and cull entries after
   // a certain time window instead.
   if (_executed_task_registry.size() >= 100)
-    _executed_task_registry.erase(_executed_task_registry.begin());
+    _executed_task_registry.pop_front();
 
   _executed_task_registry.push_back(id);
+
+  if (const auto& index = _context->started_tasks())
+    index->started(_context->name(), id);
 }
 
 //==============================================================================
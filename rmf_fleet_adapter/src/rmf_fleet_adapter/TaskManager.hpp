@@ -19,6 +19,7 @@
 #define SRC__RMF_FLEET_ADAPTER__TASKMANAGER_HPP
 
 #include "Task.hpp"
+#include "agv/DeadlineTimer.hpp"
 #include "agv/RobotContext.hpp"
 
 #include <rmf_traffic/agv/Planner.hpp>
@@ -28,7 +29,10 @@
 #include <rmf_fleet_msgs/msg/robot_mode.hpp>
 #include <rmf_task_msgs/msg/task_summary.hpp>
 
+#include <deque>
 #include <mutex>
+#include <optional>
+#include <unordered_map>
 
 namespace rmf_fleet_adapter {
 
@@ -42,7 +46,17 @@ class TaskManager : public std::enable_shared_from_this<TaskManager>
 {
 public:
 
-  static std::shared_ptr<TaskManager> make(agv::RobotContextPtr context);
+  /// Make a task manager for a robot
+  ///
+  /// \param[in] context
+  ///   The context of the robot
+  ///
+  /// \param[in] deadlines
+  ///   The timer that will tell this task manager when a queued task may
+  ///   begin. This is normally shared by the whole fleet.
+  static std::shared_ptr<TaskManager> make(
+    agv::RobotContextPtr context,
+    std::shared_ptr<agv::DeadlineTimer> deadlines);
 
   using Start = rmf_traffic::agv::Plan::Start;
   using StartSet = rmf_traffic::agv::Plan::StartSet;
@@ -69,19 +83,27 @@ public:
     const std::vector<Assignment>& assignments,
     const TaskProfiles& task_profiles = {});
 
-  /// Get the non-charging requests among pending tasks
-  const std::vector<rmf_task::ConstRequestPtr> requests() const;
+  /// Get the non-charging requests among pending tasks. This list is cached
+  /// and only rebuilt when the queue changes.
+  const std::vector<rmf_task::ConstRequestPtr>& requests() const;
 
-  /// The state of the robot.
+  /// Get the assignments of all the pending tasks, in the order that they will
+  /// be performed.
+  std::vector<Assignment> assignments() const;
+
+  /// The state of the robot. While the robot is idle this is cached and only
+  /// recomputed when its end state or its battery level changes, although the
+  /// time of the state is always the current time.
   State expected_finish_state() const;
 
-  /// Callback for the retreat timer. Appends a charging task to the task queue
-  /// when robot is idle and battery level drops below a retreat threshold.
+  /// Appends a charging task to the task queue when robot is idle and battery
+  /// level drops below a retreat threshold. This is evaluated whenever the
+  /// robot becomes idle and whenever its battery level changes noticeably.
   void retreat_to_charger();
 
   /// Get the list of task ids for tasks that have started execution.
   /// The list will contain upto 100 latest task ids only.
-  const std::vector<std::string>& get_executed_tasks() const;
+  const std::deque<std::string>& get_executed_tasks() const;
 
   RobotModeMsg robot_mode() const;
 
@@ -92,9 +114,28 @@ private:
   agv::RobotContextPtr _context;
   std::shared_ptr<Task> _active_task;
   std::vector<std::shared_ptr<Task>> _queue;
+
+  // The last summary that was published for each queued task, so that a new
+  // queue only publishes the summaries that have changed
+  std::unordered_map<std::string, TaskSummaryMsg> _queued_summaries;
+
+  // The non-automatic requests in _queue. Use _refresh_requests() whenever
+  // _queue is modified.
+  std::vector<rmf_task::ConstRequestPtr> _requests;
+
+  // The idle finish state that was last computed by expected_finish_state()
+  struct FinishStateCache
+  {
+    State state;
+    std::size_t end_state_version;
+  };
+  mutable std::optional<FinishStateCache> _finish_state_cache;
+  mutable std::mutex _finish_state_mutex;
+
   rmf_utils::optional<Start> _expected_finish_location;
   rxcpp::subscription _task_sub;
   rxcpp::subscription _emergency_sub;
+  rxcpp::subscription _battery_soc_sub;
 
   /// This phase will kick in automatically when no task is being executed. It
   /// will ensure that the agent continues to respond to traffic negotiations so
@@ -105,24 +146,44 @@ private:
   // manager so that modifications of shared data only happen on designated
   // rxcpp worker
   std::mutex _mutex;
-  rclcpp::TimerBase::SharedPtr _task_timer;
-  rclcpp::TimerBase::SharedPtr _retreat_timer;
+
+  std::shared_ptr<agv::DeadlineTimer> _deadlines;
+
+  // Dropping this cancels the wake-up for the deployment of the next task
+  std::shared_ptr<void> _next_task_deadline;
+
+  // The battery level that retreat_to_charger() was last evaluated for while
+  // the robot was idle
+  std::optional<double> _retreat_evaluated_soc;
 
   // Container to keep track of tasks that have been started by this TaskManager
   // Use the _register_executed_task() to populate this container.
-  std::vector<std::string> _executed_task_registry;
+  std::deque<std::string> _executed_task_registry;
 
-  /// Callback for task timer which begins next task if its deployment time has passed
+  /// Begins the next task if its deployment time has passed. Otherwise a
+  /// deadline is set for when it will have passed.
   void _begin_next_task();
 
+  /// Rebuild the cached _requests from _queue
+  void _refresh_requests();
+
+  /// Make the next call to expected_finish_state() recompute its state
+  void _invalidate_finish_state();
+
   /// Begin responsively waiting for the next task
   void _begin_waiting();
 
   /// Function to register the task id of a task that has begun execution
   /// The input task id will be inserted into the registry such that the max
-  /// size of the registry is 100.
+  /// size of the registry is 100. It is also added to the started_tasks()
+  /// index of the fleet.
   void _register_executed_task(const std::string& id);
 
+  /// Reserve the charger of the first charging task in the assignments with
+  /// the charger_index() of the fleet, or release the reservation of this
+  /// robot if it will not be charging.
+  void _reserve_charger(const std::vector<Assignment>& assignments);
+
   void _populate_task_summary(
     std::shared_ptr<Task> task,
     uint32_t task_summary_state,
@@ -20,9 +20,11 @@
 
 #include "Node.hpp"
 #include "internal_FleetUpdateHandle.hpp"
+#include "PlannerWarmUp.hpp"
 
 #include <rmf_traffic_ros2/schedule/MirrorManager.hpp>
 #include <rmf_traffic_ros2/schedule/Negotiation.hpp>
+#include <rmf_traffic_ros2/schedule/SharedMirror.hpp>
 #include <rmf_traffic_ros2/schedule/Writer.hpp>
 #include <rmf_traffic_ros2/blockade/Writer.hpp>
 
@@ -64,7 +66,10 @@ public:
   std::shared_ptr<rmf_traffic_ros2::schedule::Negotiation> negotiation;
   std::shared_ptr<ParticipantFactory> schedule_writer;
   std::shared_ptr<rmf_traffic_ros2::blockade::Writer> blockade_writer;
-  rmf_traffic_ros2::schedule::MirrorManager mirror_manager;
+
+  // This is empty when the schedule is read from a shared mirror segment
+  std::optional<rmf_traffic_ros2::schedule::MirrorManager> mirror_manager;
+  std::shared_ptr<rmf_traffic::schedule::Snappable> schedule_snapshots;
 
   std::vector<std::shared_ptr<FleetUpdateHandle>> fleets = {};
 
@@ -88,18 +93,24 @@ public:
   // This mutex protects the initialization of traffic lights
   std::mutex _traffic_light_init_mutex;
 
+  // The immediate stops of all the easy traffic lights share this timer
+  std::shared_ptr<DeadlineTimer> traffic_light_deadlines;
+
   Implementation(
     rxcpp::schedulers::worker worker_,
     std::shared_ptr<Node> node_,
     std::shared_ptr<rmf_traffic_ros2::schedule::Negotiation> negotiation_,
     std::shared_ptr<ParticipantFactory> writer_,
-    rmf_traffic_ros2::schedule::MirrorManager mirror_manager_)
+    std::optional<rmf_traffic_ros2::schedule::MirrorManager> mirror_manager_,
+    std::shared_ptr<rmf_traffic::schedule::Snappable> schedule_snapshots_)
   : worker{std::move(worker_)},
     node{std::move(node_)},
     negotiation{std::move(negotiation_)},
     schedule_writer{std::move(writer_)},
     blockade_writer{rmf_traffic_ros2::blockade::Writer::make(*node)},
-    mirror_manager{std::move(mirror_manager_)}
+    mirror_manager{std::move(mirror_manager_)},
+    schedule_snapshots{std::move(schedule_snapshots_)},
+    traffic_light_deadlines{DeadlineTimer::make(node)}
   {
     // Do nothing
   }
@@ -120,7 +131,10 @@ public:
       // *INDENT-ON*
     }
 
-    const auto worker = rxcpp::schedulers::make_event_loop().create_worker();
+    // The worker gets a thread of its own instead of one that is shared with
+    // the rest of the event loop, so that the thread can be configured by the
+    // rx_worker thread settings of the node.
+    const auto worker = rxcpp::schedulers::make_new_thread().create_worker();
     auto node = Node::make(worker, node_name, node_options);
 
     if (!discovery_timeout)
@@ -129,8 +143,39 @@ public:
         get_parameter_or_default_time(*node, "discovery_timeout", 60.0);
     }
 
-    auto mirror_future = rmf_traffic_ros2::schedule::make_mirror(
-      *node, rmf_traffic::schedule::query_all());
+    // When a rmf_traffic_schedule_mirror is running on this host, its shared
+    // segment can stand in for a mirror of our own.
+    std::shared_ptr<rmf_traffic::schedule::Snappable> shared_mirror;
+    const std::string shared_mirror_segment =
+      node->declare_parameter<std::string>("shared_schedule_mirror", "");
+    if (!shared_mirror_segment.empty())
+    {
+      shared_mirror =
+        rmf_traffic_ros2::schedule::SharedMirror::make(shared_mirror_segment);
+      if (shared_mirror)
+      {
+        RCLCPP_INFO(
+          node->get_logger(),
+          "Reading the traffic schedule from shared mirror segment [%s]",
+          shared_mirror_segment.c_str());
+      }
+      else
+      {
+        RCLCPP_WARN(
+          node->get_logger(),
+          "Unable to open shared mirror segment [%s]. A mirror of the "
+          "schedule will be made for this adapter instead.",
+          shared_mirror_segment.c_str());
+      }
+    }
+
+    std::optional<rmf_traffic_ros2::schedule::MirrorManagerFuture>
+    mirror_future;
+    if (!shared_mirror)
+    {
+      mirror_future = rmf_traffic_ros2::schedule::make_mirror(
+        *node, rmf_traffic::schedule::query_all());
+    }
 
     auto writer = rmf_traffic_ros2::schedule::Writer::make(*node);
 
@@ -151,15 +196,26 @@ public:
 
       bool ready = true;
       ready &= writer->ready();
-      ready &= (mirror_future.wait_for(0s) == std::future_status::ready);
+      if (mirror_future)
+      {
+        ready &=
+          (mirror_future->wait_for(0s) == std::future_status::ready);
+      }
 
       if (ready)
       {
-        auto mirror_manager = mirror_future.get();
+        std::optional<rmf_traffic_ros2::schedule::MirrorManager>
+        mirror_manager;
+        auto schedule_snapshots = shared_mirror;
+        if (mirror_future)
+        {
+          mirror_manager = mirror_future->get();
+          schedule_snapshots = mirror_manager->snapshot_handle();
+        }
 
         auto negotiation =
           std::make_shared<rmf_traffic_ros2::schedule::Negotiation>(
-          *node, mirror_manager.snapshot_handle(),
+          *node, schedule_snapshots,
           std::make_shared<WorkerWrapper>(worker));
 
         return rmf_utils::make_unique_impl<Implementation>(
@@ -167,7 +223,8 @@ public:
           std::move(node),
           std::move(negotiation),
           std::make_shared<ParticipantFactoryRos2>(std::move(writer)),
-          std::move(mirror_manager));
+          std::move(mirror_manager),
+          std::move(schedule_snapshots));
       }
     }
 
@@ -210,17 +267,32 @@ std::shared_ptr<FleetUpdateHandle> Adapter::add_fleet(
   rmf_traffic::agv::VehicleTraits traits,
   rmf_traffic::agv::Graph navigation_graph)
 {
-  auto planner =
-    std::make_shared<std::shared_ptr<const rmf_traffic::agv::Planner>>(
+  std::shared_ptr<const rmf_traffic::agv::Planner> planner =
     std::make_shared<rmf_traffic::agv::Planner>(
-      rmf_traffic::agv::Planner::Configuration(
-        std::move(navigation_graph),
-        std::move(traits)),
-      rmf_traffic::agv::Planner::Options(nullptr)));
+    rmf_traffic::agv::Planner::Configuration(
+      std::move(navigation_graph),
+      std::move(traits)),
+    rmf_traffic::agv::Planner::Options(nullptr));
+
+  return add_fleet(fleet_name, std::move(planner));
+}
+
+//==============================================================================
+std::shared_ptr<FleetUpdateHandle> Adapter::add_fleet(
+  const std::string& fleet_name,
+  std::shared_ptr<const rmf_traffic::agv::Planner> planner)
+{
+  // For a planner that is shared with another fleet this only finds heuristics
+  // that have already been cached, so it finishes almost immediately.
+  warm_up_planner(planner);
+
+  auto shared_planner =
+    std::make_shared<std::shared_ptr<const rmf_traffic::agv::Planner>>(
+    std::move(planner));
 
   auto fleet = FleetUpdateHandle::Implementation::make(
-    fleet_name, std::move(planner), _pimpl->node, _pimpl->worker,
-    _pimpl->schedule_writer, _pimpl->mirror_manager.snapshot_handle(),
+    fleet_name, std::move(shared_planner), _pimpl->node, _pimpl->worker,
+    _pimpl->schedule_writer, _pimpl->schedule_snapshots,
     _pimpl->negotiation);
 
   _pimpl->fleets.push_back(fleet);
@@ -261,7 +333,7 @@ void Adapter::add_traffic_light(
     command = std::move(command),
     traits = std::move(traits),
     blockade_writer = _pimpl->blockade_writer,
-    schedule = _pimpl->mirror_manager.snapshot_handle(),
+    schedule = _pimpl->schedule_snapshots,
     worker = _pimpl->worker,
     handle_cb = std::move(handle_cb),
     negotiation = _pimpl->negotiation,
@@ -364,6 +436,7 @@ void Adapter::add_easy_traffic_light(
     blocker_callback = std::move(blocker_callback),
     worker = _pimpl->worker,
     node = _pimpl->node,
+    deadlines = _pimpl->traffic_light_deadlines,
     fleet_name,
     robot_name](
       TrafficLight::UpdateHandlePtr update_handle)
@@ -375,6 +448,7 @@ void Adapter::add_easy_traffic_light(
         std::move(blocker_callback),
         worker,
         node,
+        deadlines,
         robot_name,
         fleet_name);
 
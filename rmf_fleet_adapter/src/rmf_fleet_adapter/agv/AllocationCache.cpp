@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "AllocationCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+namespace {
+//==============================================================================
+void hash_combine(std::size_t& seed, std::size_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+} // anonymous namespace
+
+//==============================================================================
+bool AllocationCache::Key::Robot::operator==(const Robot& other) const
+{
+  return waypoint == other.waypoint
+    && charging_waypoint == other.charging_waypoint
+    && time == other.time
+    && orientation == other.orientation
+    && battery_soc == other.battery_soc;
+}
+
+//==============================================================================
+bool AllocationCache::Key::operator==(const Key& other) const
+{
+  return incremental == other.incremental
+    && robots == other.robots
+    && requests == other.requests;
+}
+
+//==============================================================================
+std::size_t AllocationCache::KeyHash::operator()(const Key& key) const
+{
+  std::size_t seed = std::hash<bool>()(key.incremental);
+  for (const auto& r : key.robots)
+  {
+    hash_combine(seed, std::hash<std::size_t>()(r.waypoint));
+    hash_combine(seed, std::hash<std::size_t>()(r.charging_waypoint));
+    hash_combine(seed, std::hash<int64_t>()(r.time));
+    hash_combine(seed, std::hash<int64_t>()(r.orientation));
+    hash_combine(seed, std::hash<int64_t>()(r.battery_soc));
+  }
+
+  for (const auto& request : key.requests)
+    hash_combine(seed, std::hash<std::string>()(request));
+
+  return seed;
+}
+
+//==============================================================================
+AllocationCache::AllocationCache(
+  const std::size_t capacity,
+  const rmf_traffic::Duration time_resolution)
+: _capacity(capacity),
+  _time_resolution(std::max(time_resolution, rmf_traffic::Duration(1)))
+{
+  // Do nothing
+}
+
+//==============================================================================
+auto AllocationCache::make_key(
+  const std::vector<State>& states,
+  std::vector<std::string> requests,
+  const bool incremental) const -> Key
+{
+  Key key;
+  key.incremental = incremental;
+  key.robots.reserve(states.size());
+  for (const auto& s : states)
+  {
+    const auto& location = s.location();
+    const auto time = location.time().time_since_epoch();
+    key.robots.push_back(
+      {
+        s.waypoint(),
+        s.charging_waypoint(),
+        static_cast<int64_t>(time / _time_resolution),
+        // Orientations are compared to the nearest hundredth of a radian and
+        // battery levels to the nearest tenth of a percent.
+        static_cast<int64_t>(std::llround(location.orientation() * 100.0)),
+        static_cast<int64_t>(std::llround(s.battery_soc() * 1000.0))
+      });
+  }
+
+  if (!incremental)
+    std::sort(requests.begin(), requests.end());
+
+  key.requests = std::move(requests);
+  return key;
+}
+
+//==============================================================================
+auto AllocationCache::get(const Key& key) -> std::optional<Assignments>
+{
+  const auto it = _lookup.find(key);
+  if (it == _lookup.end())
+    return std::nullopt;
+
+  // Move the entry to the front since it was the most recently used
+  _entries.splice(_entries.begin(), _entries, it->second);
+  return it->second->second;
+}
+
+//==============================================================================
+void AllocationCache::set(Key key, Assignments assignments)
+{
+  if (_capacity == 0)
+    return;
+
+  const auto it = _lookup.find(key);
+  if (it != _lookup.end())
+  {
+    it->second->second = std::move(assignments);
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return;
+  }
+
+  _entries.emplace_front(key, std::move(assignments));
+  _lookup.insert({std::move(key), _entries.begin()});
+
+  while (_entries.size() > _capacity)
+  {
+    _lookup.erase(_entries.back().first);
+    _entries.pop_back();
+  }
+}
+
+//==============================================================================
+void AllocationCache::clear()
+{
+  _lookup.clear();
+  _entries.clear();
+}
+
+//==============================================================================
+std::size_t AllocationCache::size() const
+{
+  return _entries.size();
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
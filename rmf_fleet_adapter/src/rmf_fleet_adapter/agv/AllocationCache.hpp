@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__ALLOCATIONCACHE_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__ALLOCATIONCACHE_HPP
+
+#include <rmf_task/agv/TaskPlanner.hpp>
+
+#include <rmf_traffic/Time.hpp>
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Remembers the results of recent task allocations so that an allocation
+/// which is asked for again with the same robot states and requests does not
+/// need to be planned again. The states are compared after rounding them to a
+/// coarse resolution, since the state of an idle robot carries the current
+/// time. Entries go stale by themselves as the robots make progress, because
+/// their states stop matching, and the least recently used entries are
+/// dropped once the capacity is reached.
+///
+/// This class is not thread-safe. It is meant to be used from the fleet's
+/// worker only.
+class AllocationCache
+{
+public:
+
+  using Assignments = rmf_task::agv::TaskPlanner::Assignments;
+  using State = rmf_task::agv::State;
+
+  static constexpr std::size_t DefaultCapacity = 32;
+  static constexpr rmf_traffic::Duration DefaultTimeResolution =
+    std::chrono::seconds(2);
+
+  /// A fingerprint of everything that an allocation depends on, apart from
+  /// the configuration of the task planner. The cache must be cleared when
+  /// that configuration changes.
+  struct Key
+  {
+    struct Robot
+    {
+      std::size_t waypoint;
+      std::size_t charging_waypoint;
+      int64_t time;
+      int64_t orientation;
+      int64_t battery_soc;
+
+      bool operator==(const Robot& other) const;
+    };
+
+    std::vector<Robot> robots;
+    std::vector<std::string> requests;
+    bool incremental = false;
+
+    bool operator==(const Key& other) const;
+  };
+
+  /// \param[in] capacity
+  ///   The most allocations that will be remembered. A capacity of 0 disables
+  ///   the cache.
+  ///
+  /// \param[in] time_resolution
+  ///   Times in the robot states are rounded down to a multiple of this.
+  AllocationCache(
+    std::size_t capacity = DefaultCapacity,
+    rmf_traffic::Duration time_resolution = DefaultTimeResolution);
+
+  /// Make the key of an allocation.
+  ///
+  /// \param[in] states
+  ///   The state of each robot, in the order given to the task planner.
+  ///
+  /// \param[in] requests
+  ///   The IDs of the requests that are being allocated. Unless incremental is
+  ///   true, the order does not matter.
+  ///
+  /// \param[in] incremental
+  ///   True if the allocation only inserts a request into the current queues.
+  ///   The requests should then list the new request followed by each queue
+  ///   in order, since the result depends on how the queues are arranged.
+  Key make_key(
+    const std::vector<State>& states,
+    std::vector<std::string> requests,
+    bool incremental) const;
+
+  /// Get the remembered result of an allocation, if there is one.
+  std::optional<Assignments> get(const Key& key);
+
+  /// Remember the result of an allocation.
+  void set(Key key, Assignments assignments);
+
+  /// Forget every allocation.
+  void clear();
+
+  /// Get the number of allocations that are remembered.
+  std::size_t size() const;
+
+private:
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  using Entry = std::pair<Key, Assignments>;
+  using Entries = std::list<Entry>;
+
+  std::size_t _capacity;
+  rmf_traffic::Duration _time_resolution;
+  Entries _entries;
+  std::unordered_map<Key, Entries::iterator, KeyHash> _lookup;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__ALLOCATIONCACHE_HPP
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "AllocationOutcome.hpp"
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+AllocationOutcome allocation_outcome(
+  const bool cancelled,
+  const bool speculative,
+  const std::size_t planned_version,
+  const std::size_t current_version)
+{
+  if (cancelled)
+    return AllocationOutcome::Drop;
+
+  if (!speculative && planned_version != current_version)
+    return AllocationOutcome::Replan;
+
+  return AllocationOutcome::Deliver;
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
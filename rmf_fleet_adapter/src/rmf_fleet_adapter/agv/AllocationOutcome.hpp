@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__ALLOCATIONOUTCOME_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__ALLOCATIONOUTCOME_HPP
+
+#include <cstddef>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// What should be done with the result of an allocation once it is back on
+/// the fleet's worker
+enum class AllocationOutcome
+{
+  /// The allocation was cancelled, so its result is thrown away
+  Drop,
+
+  /// The queues of the robots were replaced while the allocation was being
+  /// planned, so it needs to be planned again
+  Replan,
+
+  /// The result can be handed to the caller
+  Deliver
+};
+
+//==============================================================================
+/// Decide what to do with the result of an allocation.
+///
+/// \param[in] cancelled
+///   Whether the allocation was cancelled, which may have happened while it
+///   was being planned
+///
+/// \param[in] speculative
+///   Whether the caller reconciles the result using its version instead
+///
+/// \param[in] planned_version
+///   The assignments_version that the allocation was planned against
+///
+/// \param[in] current_version
+///   The assignments_version of the fleet right now
+AllocationOutcome allocation_outcome(
+  bool cancelled,
+  bool speculative,
+  std::size_t planned_version,
+  std::size_t current_version);
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__ALLOCATIONOUTCOME_HPP
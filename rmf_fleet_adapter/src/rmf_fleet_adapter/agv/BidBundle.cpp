@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "BidBundle.hpp"
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+std::string bid_bundle_key(const std::vector<std::string>& task_ids)
+{
+  std::string key = "bundle";
+  for (const auto& id : task_ids)
+    key += ":" + id;
+
+  return key;
+}
+
+//==============================================================================
+double bid_bundle_cost(
+  const double current_cost,
+  const double bundle_cost,
+  const std::size_t bundle_size)
+{
+  if (bundle_size <= 1)
+    return bundle_cost;
+
+  return current_cost
+    + (bundle_cost - current_cost) / static_cast<double>(bundle_size);
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
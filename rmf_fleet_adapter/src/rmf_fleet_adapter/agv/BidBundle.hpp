@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__BIDBUNDLE_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__BIDBUNDLE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Get the key that the allocation of a bundle of bids is planned under. It
+/// is different from the key of any single task, so cancelling the bundle
+/// never cancels the allocation of one of its tasks.
+std::string bid_bundle_key(const std::vector<std::string>& task_ids);
+
+//==============================================================================
+/// Get the cost that the bid for one task of a bundle should carry. Each task
+/// is charged an equal share of the cost that the whole bundle adds to the
+/// fleet, so that the bid compares fairly with the bids of fleets that plan
+/// one task at a time. A bundle of one task is charged its whole cost.
+///
+/// \param[in] current_cost
+///   The cost of the assignments that the fleet has without the bundle
+///
+/// \param[in] bundle_cost
+///   The cost of the assignments once the bundle has been added
+///
+/// \param[in] bundle_size
+///   How many tasks are in the bundle
+double bid_bundle_cost(
+  double current_cost,
+  double bundle_cost,
+  std::size_t bundle_size);
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__BIDBUNDLE_HPP
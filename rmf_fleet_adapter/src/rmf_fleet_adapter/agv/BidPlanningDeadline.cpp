@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "BidPlanningDeadline.hpp"
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+std::optional<std::chrono::steady_clock::time_point> bid_planning_deadline(
+  const std::chrono::steady_clock::time_point received,
+  const std::chrono::nanoseconds time_window,
+  const double budget)
+{
+  if (budget <= 0.0 || time_window <= std::chrono::nanoseconds(0))
+    return std::nullopt;
+
+  return received
+    + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    budget * time_window);
+}
+
+//==============================================================================
+rmf_task::agv::TaskPlanner::Result plan_before_deadline(
+  const std::function<rmf_task::agv::TaskPlanner::Result(
+    const rmf_task::agv::TaskPlanner::Options&)>& plan,
+  const std::optional<std::chrono::steady_clock::time_point>& deadline,
+  rmf_task::ConstRequestFactoryPtr finishing_request,
+  bool& greedy,
+  const std::function<bool()>& cancelled)
+{
+  using TaskPlanner = rmf_task::agv::TaskPlanner;
+  const auto past_deadline = [deadline]()
+    {
+      return deadline.has_value()
+        && std::chrono::steady_clock::now() >= *deadline;
+    };
+
+  const auto is_cancelled = [&cancelled]()
+    {
+      return cancelled && cancelled();
+    };
+
+  greedy = false;
+  if (is_cancelled())
+    return TaskPlanner::Assignments{};
+
+  std::optional<TaskPlanner::Result> planned;
+  if (!past_deadline())
+  {
+    std::function<bool()> interrupter = nullptr;
+    if (deadline.has_value() || cancelled)
+    {
+      interrupter = [past_deadline, is_cancelled]()
+        {
+          return past_deadline() || is_cancelled();
+        };
+    }
+
+    planned = plan(TaskPlanner::Options{false, interrupter, finishing_request});
+  }
+
+  // Nobody is waiting for the assignments of a cancelled search
+  if (is_cancelled())
+    return TaskPlanner::Assignments{};
+
+  // An interrupted search does not produce any assignments
+  const auto* optimal = planned.has_value() ?
+    std::get_if<TaskPlanner::Assignments>(&*planned) : nullptr;
+  const bool interrupted = (!optimal || optimal->empty()) && past_deadline();
+  if (planned.has_value() && !interrupted)
+    return *planned;
+
+  greedy = true;
+  return plan(TaskPlanner::Options{true, nullptr, finishing_request});
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__BIDPLANNINGDEADLINE_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__BIDPLANNINGDEADLINE_HPP
+
+#include <rmf_task/agv/TaskPlanner.hpp>
+
+#include <chrono>
+#include <functional>
+#include <optional>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Get the time by which the bid for a task should be planned. The auction is
+/// decided once its time window closes, so a bid that is still searching for
+/// optimal assignments by then would be wasted.
+///
+/// \param[in] received
+///   When the bid notice was received
+///
+/// \param[in] time_window
+///   The time window of the bid notice
+///
+/// \param[in] budget
+///   The fraction of the time window that may be spent on planning
+///
+/// \return the deadline, or std::nullopt if the planning is not bounded
+/// because the budget or the time window is not positive.
+std::optional<std::chrono::steady_clock::time_point> bid_planning_deadline(
+  std::chrono::steady_clock::time_point received,
+  std::chrono::nanoseconds time_window,
+  double budget);
+
+//==============================================================================
+/// Run a task planner search for optimal assignments that gives up at the
+/// deadline. An interrupted search does not produce any assignments, so when
+/// the deadline is reached, or has already passed, the greedy assignments are
+/// planned instead.
+///
+/// \param[in] plan
+///   Runs the task planner with the options that it is given
+///
+/// \param[in] deadline
+///   When to give up on the optimal assignments, if ever
+///
+/// \param[in] finishing_request
+///   The finishing request to plan with
+///
+/// \param[out] greedy
+///   Set to true if the greedy assignments were planned, or false otherwise
+///
+/// \param[in] cancelled
+///   If this returns true, the search is interrupted and no greedy assignments
+///   are planned, so an empty set of assignments is returned
+rmf_task::agv::TaskPlanner::Result plan_before_deadline(
+  const std::function<rmf_task::agv::TaskPlanner::Result(
+    const rmf_task::agv::TaskPlanner::Options&)>& plan,
+  const std::optional<std::chrono::steady_clock::time_point>& deadline,
+  rmf_task::ConstRequestFactoryPtr finishing_request,
+  bool& greedy,
+  const std::function<bool()>& cancelled = nullptr);
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__BIDPLANNINGDEADLINE_HPP
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ChargerIndex.hpp"
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+ChargerIndex::ChargerIndex(std::vector<std::size_t> chargers)
+: _chargers(std::move(chargers))
+{
+  // Do nothing
+}
+
+//==============================================================================
+std::vector<std::size_t> ChargerIndex::chargers() const
+{
+  return _chargers;
+}
+
+//==============================================================================
+auto ChargerIndex::estimate(
+  const std::size_t start,
+  const std::size_t charger,
+  const Compute& compute) -> std::optional<Estimate>
+{
+  const auto key = std::make_pair(start, charger);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _estimates.find(key);
+    if (it != _estimates.end())
+      return it->second;
+  }
+
+  // The estimate is computed without holding the lock since it may need to
+  // plan a route. Two robots might compute the same estimate at once, but
+  // they will get the same result.
+  const auto result = compute();
+  if (result.has_value())
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _estimates.insert({key, *result});
+  }
+
+  return result;
+}
+
+//==============================================================================
+void ChargerIndex::clear_estimates()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _estimates.clear();
+}
+
+//==============================================================================
+void ChargerIndex::seed(rmf_task::EstimateCache& cache) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (const auto& [key, estimate] : _estimates)
+    cache.set(key, estimate.duration, estimate.dsoc);
+}
+
+//==============================================================================
+bool ChargerIndex::reserve(
+  const std::string& robot,
+  const std::size_t charger,
+  const rmf_traffic::Time now,
+  const rmf_traffic::Time until)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _reservations.find(charger);
+  if (it != _reservations.end()
+    && it->second.robot != robot && now < it->second.until)
+  {
+    return false;
+  }
+
+  for (auto r = _reservations.begin(); r != _reservations.end(); )
+  {
+    if (r->second.robot == robot)
+      r = _reservations.erase(r);
+    else
+      ++r;
+  }
+
+  _reservations[charger] = Reservation{robot, until};
+  return true;
+}
+
+//==============================================================================
+void ChargerIndex::release(const std::string& robot)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (auto r = _reservations.begin(); r != _reservations.end(); )
+  {
+    if (r->second.robot == robot)
+      r = _reservations.erase(r);
+    else
+      ++r;
+  }
+}
+
+//==============================================================================
+bool ChargerIndex::available(
+  const std::size_t charger,
+  const std::string& robot,
+  const rmf_traffic::Time now) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _reservations.find(charger);
+  if (it == _reservations.end())
+    return true;
+
+  return it->second.robot == robot || it->second.until <= now;
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__CHARGERINDEX_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__CHARGERINDEX_HPP
+
+#include <rmf_task/Estimate.hpp>
+#include <rmf_traffic/Time.hpp>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Keeps track of which robots of a fleet are headed to or sitting at each
+/// charger, and remembers how much it costs to reach each charger from each
+/// waypoint, so that the robots do not repeat the same estimates or retreat
+/// to a charger that another robot is about to take.
+///
+/// This class is thread-safe.
+class ChargerIndex
+{
+public:
+
+  /// The cost of going from a waypoint to a charger
+  struct Estimate
+  {
+    rmf_traffic::Duration duration;
+    double dsoc;
+  };
+
+  using Compute = std::function<std::optional<Estimate>()>;
+
+  /// Constructor
+  ///
+  /// \param[in] chargers
+  ///   The charging waypoints of the fleet
+  ChargerIndex(std::vector<std::size_t> chargers = {});
+
+  /// Get the charging waypoints of the fleet
+  std::vector<std::size_t> chargers() const;
+
+  /// Get the estimate for going from start to charger. If there is no
+  /// estimate yet, compute is called to make one, and the result is
+  /// remembered.
+  std::optional<Estimate> estimate(
+    std::size_t start,
+    std::size_t charger,
+    const Compute& compute);
+
+  /// Forget every estimate. This should be called when the battery or
+  /// planning parameters of the fleet change.
+  void clear_estimates();
+
+  /// Copy every estimate into the cache of a task planner
+  void seed(rmf_task::EstimateCache& cache) const;
+
+  /// Reserve a charger for a robot until the given time. A robot only holds
+  /// one reservation at a time, so any earlier reservation of the robot is
+  /// released.
+  ///
+  /// \return false if another robot holds the charger at that time
+  bool reserve(
+    const std::string& robot,
+    std::size_t charger,
+    rmf_traffic::Time now,
+    rmf_traffic::Time until);
+
+  /// Release the reservation of a robot, if it has one
+  void release(const std::string& robot);
+
+  /// Check whether the charger is free for the robot to use right now
+  bool available(
+    std::size_t charger,
+    const std::string& robot,
+    rmf_traffic::Time now) const;
+
+private:
+
+  struct Reservation
+  {
+    std::string robot;
+    rmf_traffic::Time until;
+  };
+
+  std::vector<std::size_t> _chargers;
+  mutable std::mutex _mutex;
+  std::map<std::pair<std::size_t, std::size_t>, Estimate> _estimates;
+  std::unordered_map<std::size_t, Reservation> _reservations;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__CHARGERINDEX_HPP
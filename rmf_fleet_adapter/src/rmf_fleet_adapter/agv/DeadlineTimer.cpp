@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "DeadlineTimer.hpp"
+
+#include <rmf_traffic_ros2/Time.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+namespace {
+//==============================================================================
+// The timer runs on the wall clock while the deadlines follow the clock of the
+// node, which may be simulated. We never wait longer than this before checking
+// the clock of the node again.
+const auto MaximumWait = std::chrono::seconds(1);
+} // anonymous namespace
+
+//==============================================================================
+std::shared_ptr<DeadlineTimer> DeadlineTimer::make(std::shared_ptr<Node> node)
+{
+  return std::shared_ptr<DeadlineTimer>(new DeadlineTimer(std::move(node)));
+}
+
+//==============================================================================
+std::shared_ptr<void> DeadlineTimer::schedule(
+  const rmf_traffic::Time deadline,
+  Callback callback)
+{
+  auto handle = std::make_shared<bool>(true);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it =
+    _entries.insert({deadline, Entry{std::move(callback), handle}});
+  if (!_timer || (it == _entries.begin() && deadline < _armed_for))
+    _arm(rmf_traffic_ros2::convert(_node->now()));
+
+  return handle;
+}
+
+//==============================================================================
+DeadlineTimer::DeadlineTimer(std::shared_ptr<Node> node)
+: _node(std::move(node))
+{
+  // Do nothing
+}
+
+//==============================================================================
+void DeadlineTimer::_fire()
+{
+  std::vector<Callback> ready;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto now = rmf_traffic_ros2::convert(_node->now());
+    while (!_entries.empty() && _entries.begin()->first <= now)
+    {
+      auto entry = std::move(_entries.begin()->second);
+      _entries.erase(_entries.begin());
+      if (!entry.handle.expired())
+        ready.push_back(std::move(entry.callback));
+    }
+
+    _timer = nullptr;
+    _arm(now);
+  }
+
+  for (const auto& callback : ready)
+    callback();
+}
+
+//==============================================================================
+void DeadlineTimer::_arm(const rmf_traffic::Time now)
+{
+  // Cancelled deadlines are only forgotten once they reach the front
+  while (!_entries.empty() && _entries.begin()->second.handle.expired())
+    _entries.erase(_entries.begin());
+
+  if (_timer)
+    _timer->cancel();
+
+  _timer = nullptr;
+  if (_entries.empty())
+    return;
+
+  _armed_for = _entries.begin()->first;
+  const auto wait = std::clamp<rmf_traffic::Duration>(
+    _armed_for - now, std::chrono::milliseconds(1), MaximumWait);
+
+  _timer = _node->try_create_wall_timer(
+    wait,
+    [w = weak_from_this()]()
+    {
+      if (const auto self = w.lock())
+        self->_fire();
+    });
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__DEADLINETIMER_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__DEADLINETIMER_HPP
+
+#include "Node.hpp"
+
+#include <rmf_traffic/Time.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Triggers callbacks once the clock of a node reaches their deadlines. All
+/// the deadlines share a single timer that is armed for the earliest one, so a
+/// fleet can wait on the deadlines of all its robots without a timer per robot.
+class DeadlineTimer : public std::enable_shared_from_this<DeadlineTimer>
+{
+public:
+
+  using Callback = std::function<void()>;
+
+  static std::shared_ptr<DeadlineTimer> make(std::shared_ptr<Node> node);
+
+  /// Trigger the callback once the clock of the node reaches the deadline.
+  /// The callback is triggered by the executor of the node, so it should hand
+  /// off any real work to a worker. This is safe to call from any thread.
+  ///
+  /// \return a handle for the deadline. The deadline is cancelled when the
+  /// handle is dropped.
+  std::shared_ptr<void> schedule(rmf_traffic::Time deadline, Callback callback);
+
+private:
+
+  DeadlineTimer(std::shared_ptr<Node> node);
+
+  struct Entry
+  {
+    Callback callback;
+    std::weak_ptr<void> handle;
+  };
+
+  void _fire();
+
+  /// Arm the timer for the earliest deadline. The mutex must be locked.
+  void _arm(rmf_traffic::Time now);
+
+  std::shared_ptr<Node> _node;
+  std::mutex _mutex;
+  std::multimap<rmf_traffic::Time, Entry> _entries;
+  rclcpp::TimerBase::SharedPtr _timer;
+  rmf_traffic::Time _armed_for;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__DEADLINETIMER_HPP
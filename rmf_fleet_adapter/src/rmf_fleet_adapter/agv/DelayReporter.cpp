@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "DelayReporter.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+namespace {
+//==============================================================================
+// When every reporting robot is delayed, the threshold reaches this multiple
+// of its base value
+const double MaximumThresholdFactor = 4.0;
+
+// How quickly the load follows the share of delayed robots in each flush
+const double LoadSmoothing = 0.2;
+
+// How much larger a delay must be to reverse the previous one
+const double ReversalFactor = 2.0;
+
+//==============================================================================
+rmf_traffic::Duration scale(const rmf_traffic::Duration d, const double factor)
+{
+  return rmf_traffic::Duration(
+    static_cast<rmf_traffic::Duration::rep>(std::round(d.count() * factor)));
+}
+
+//==============================================================================
+rmf_traffic::Duration magnitude(const rmf_traffic::Duration d)
+{
+  return d < rmf_traffic::Duration(0) ? -d : d;
+}
+} // anonymous namespace
+
+//==============================================================================
+DelayReporter::DelayReporter(rmf_traffic::Duration base_threshold)
+: _base_threshold(base_threshold)
+{
+  // Do nothing
+}
+
+//==============================================================================
+void DelayReporter::report(
+  const ParticipantId participant,
+  const rmf_traffic::Duration delay,
+  Apply apply)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _pending[participant] = Pending{delay, std::move(apply)};
+}
+
+//==============================================================================
+std::size_t DelayReporter::flush()
+{
+  std::vector<std::pair<Apply, rmf_traffic::Duration>> ready;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_pending.empty())
+      return 0;
+
+    const auto threshold = _threshold();
+    std::size_t delayed = 0;
+    for (auto& [participant, pending] : _pending)
+    {
+      const auto size = magnitude(pending.delay);
+      if (_base_threshold < size)
+        ++delayed;
+
+      const bool late = pending.delay > rmf_traffic::Duration(0);
+      auto required = threshold;
+      const auto last = _last_was_late.find(participant);
+      if (last != _last_was_late.end() && last->second != late)
+        required = scale(required, ReversalFactor);
+
+      if (size <= required)
+        continue;
+
+      _last_was_late[participant] = late;
+      ready.emplace_back(std::move(pending.apply), pending.delay);
+    }
+
+    const double share =
+      static_cast<double>(delayed) / static_cast<double>(_pending.size());
+    _load += LoadSmoothing * (share - _load);
+    _pending.clear();
+  }
+
+  for (const auto& [apply, delay] : ready)
+    apply(delay);
+
+  return ready.size();
+}
+
+//==============================================================================
+rmf_traffic::Duration DelayReporter::threshold() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _threshold();
+}
+
+//==============================================================================
+rmf_traffic::Duration DelayReporter::_threshold() const
+{
+  return scale(_base_threshold, 1.0 + (MaximumThresholdFactor - 1.0) * _load);
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
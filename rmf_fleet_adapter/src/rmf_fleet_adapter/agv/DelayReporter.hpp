@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__DELAYREPORTER_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__DELAYREPORTER_HPP
+
+#include <rmf_traffic/Time.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Collects the delays that the robots of a fleet notice while they move, and
+/// applies them to the schedule together when the fleet flushes them. Only the
+/// latest delay of each robot is kept between flushes.
+///
+/// A delay is only applied if it is larger than a threshold. The threshold
+/// rises above its base value while a large share of the robots keep reporting
+/// delays, so that a busy fleet sends fewer and larger delays instead of
+/// triggering a conflict check for every small one. A delay whose direction is
+/// the opposite of the previous delay that was applied for the same robot must
+/// exceed twice the threshold, so that a robot which hovers around its
+/// schedule does not flip its itinerary back and forth.
+class DelayReporter
+{
+public:
+
+  using ParticipantId = rmf_traffic::schedule::ParticipantId;
+  using Apply = std::function<void(rmf_traffic::Duration delay)>;
+
+  /// Constructor
+  ///
+  /// \param[in] base_threshold
+  ///   The threshold that is used while few robots report delays
+  DelayReporter(
+    rmf_traffic::Duration base_threshold = std::chrono::milliseconds(500));
+
+  /// Report the delay that should be added to the itinerary of a participant.
+  /// This replaces any delay that was reported for the participant since the
+  /// last flush. This is safe to call from any thread.
+  ///
+  /// \param[in] apply
+  ///   Called by flush() if the delay should be applied. This should hand off
+  ///   the delay to the worker of the robot.
+  void report(
+    ParticipantId participant,
+    rmf_traffic::Duration delay,
+    Apply apply);
+
+  /// Apply the delays that exceed their thresholds, and drop the rest.
+  ///
+  /// \return the number of delays that were applied
+  std::size_t flush();
+
+  /// Get the threshold that the next flush will use
+  rmf_traffic::Duration threshold() const;
+
+private:
+
+  struct Pending
+  {
+    rmf_traffic::Duration delay;
+    Apply apply;
+  };
+
+  rmf_traffic::Duration _threshold() const;
+
+  rmf_traffic::Duration _base_threshold;
+  mutable std::mutex _mutex;
+  std::unordered_map<ParticipantId, Pending> _pending;
+
+  // Whether the last delay that was applied for each participant was positive
+  std::unordered_map<ParticipantId, bool> _last_was_late;
+
+  // A moving average of the share of reporting robots whose delay exceeded
+  // the base threshold
+  double _load = 0.0;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__DELAYREPORTER_HPP
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "DoorOpeningTimes.hpp"
+
+#include <rmf_door_msgs/msg/door_mode.hpp>
+
+#include <rmf_traffic_ros2/Time.hpp>
+
+#include <algorithm>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+DoorOpeningTimes::DoorOpeningTimes(double smoothing)
+: _smoothing(std::clamp(smoothing, 0.0, 1.0))
+{
+  // Do nothing
+}
+
+//==============================================================================
+void DoorOpeningTimes::observe(const rmf_door_msgs::msg::DoorState& state)
+{
+  observe(
+    state.door_name,
+    state.current_mode.value,
+    rmf_traffic_ros2::convert(state.door_time));
+}
+
+//==============================================================================
+void DoorOpeningTimes::observe(
+  const std::string& door_name,
+  const uint32_t mode,
+  const rmf_traffic::Time time)
+{
+  using rmf_door_msgs::msg::DoorMode;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& door = _doors[door_name];
+  const auto last_mode = door.last_mode;
+  door.last_mode = mode;
+  if (last_mode == mode)
+    return;
+
+  if (DoorMode::MODE_MOVING == mode)
+  {
+    // We only know when the door began to open if we saw it closed first
+    if (last_mode == DoorMode::MODE_CLOSED)
+      door.moving_since = time;
+
+    return;
+  }
+
+  if (DoorMode::MODE_OPEN == mode && door.moving_since
+    && last_mode == DoorMode::MODE_MOVING)
+  {
+    const auto sample = time - *door.moving_since;
+    if (sample >= rmf_traffic::Duration(0))
+    {
+      if (door.estimate)
+      {
+        door.estimate = *door.estimate + std::chrono::duration_cast<
+          rmf_traffic::Duration>(_smoothing * (sample - *door.estimate));
+      }
+      else
+      {
+        door.estimate = sample;
+      }
+    }
+  }
+
+  door.moving_since = std::nullopt;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Duration> DoorOpeningTimes::opening_time(
+  const std::string& door_name) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _doors.find(door_name);
+  if (it == _doors.end())
+    return std::nullopt;
+
+  return it->second.estimate;
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__DOOROPENINGTIMES_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__DOOROPENINGTIMES_HPP
+
+#include <rmf_traffic/Time.hpp>
+
+#include <rmf_door_msgs/msg/door_state.hpp>
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Learns how long each door takes to open from the history of its states.
+/// Each time a door is seen to go from closed to moving to open, the time
+/// that it spent moving is blended into a running estimate for that door.
+///
+/// This is safe to use from multiple threads.
+class DoorOpeningTimes
+{
+public:
+
+  /// How much weight each new observation gets in the running estimate
+  static constexpr double DefaultSmoothing = 0.3;
+
+  DoorOpeningTimes(double smoothing = DefaultSmoothing);
+
+  /// Tell this about the latest state of a door.
+  void observe(const rmf_door_msgs::msg::DoorState& state);
+
+  /// Tell this about the latest mode of a door and the time it was in it.
+  void observe(
+    const std::string& door_name,
+    uint32_t mode,
+    rmf_traffic::Time time);
+
+  /// Get the estimated opening time of a door, if it has ever been seen
+  /// opening.
+  std::optional<rmf_traffic::Duration> opening_time(
+    const std::string& door_name) const;
+
+private:
+
+  struct Door
+  {
+    std::optional<uint32_t> last_mode;
+    std::optional<rmf_traffic::Time> moving_since;
+    std::optional<rmf_traffic::Duration> estimate;
+  };
+
+  double _smoothing;
+  std::unordered_map<std::string, Door> _doors;
+  mutable std::mutex _mutex;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__DOOROPENINGTIMES_HPP
@@ -17,6 +17,8 @@
 
 #include "internal_EasyTrafficLight.hpp"
 
+#include <rmf_traffic_ros2/Time.hpp>
+
 namespace rmf_fleet_adapter {
 namespace agv {
 
@@ -76,53 +78,29 @@ void EasyTrafficLight::Implementation::receive_checkpoints(
   if (version != current_version)
     return;
 
-  if (last_received_checkpoints.has_value())
+  if (!last_received_checkpoints.has_value())
   {
-    // If we already have checkpoints that we've received but haven't processed
-    // yet, then we should merge the new checkpoints into the unprocessed ones.
-    last_received_checkpoints->reject = reject;
-    last_received_checkpoints->on_standby = on_standby;
-    last_received_checkpoints->standby_at = standby_at;
-
-    auto& old_checkpoints = last_received_checkpoints->checkpoints;
-    for (const auto& new_c : checkpoints)
-    {
-      bool duplicate = false;
-      for (auto& old_c : old_checkpoints)
-      {
-        if (old_c.waypoint_index == new_c.waypoint_index)
-        {
-          old_c = new_c;
-          duplicate = true;
-          break;
-        }
-      }
-
-      if (!duplicate)
-      {
-        old_checkpoints.push_back(new_c);
-      }
-    }
+    last_received_checkpoints =
+      CheckpointInfo{{}, standby_at, nullptr, nullptr};
+  }
 
-    const auto r_it = std::remove_if(
-      old_checkpoints.begin(), old_checkpoints.end(),
-      [standby_at](const Checkpoint& c)
-      {
-        return c.waypoint_index >= standby_at;
-      });
+  // If we already have checkpoints that we've received but haven't processed
+  // yet, then we merge the new checkpoints into the unprocessed ones. Only the
+  // checkpoints that were given to us are touched.
+  auto& info = last_received_checkpoints.value();
+  info.reject = std::move(reject);
+  info.on_standby = std::move(on_standby);
+  info.standby_at = standby_at;
 
-    old_checkpoints.erase(r_it, old_checkpoints.end());
-  }
-  else
+  auto& pending = info.checkpoints;
+  for (auto& c : checkpoints)
   {
-    last_received_checkpoints = CheckpointInfo{
-      std::move(checkpoints),
-      standby_at,
-      std::move(on_standby),
-      std::move(reject)
-    };
+    const auto index = c.waypoint_index;
+    pending.insert_or_assign(index, std::move(c));
   }
 
+  pending.erase(pending.lower_bound(standby_at), pending.end());
+
   if (last_departed_checkpoint.has_value())
   {
     if (standby_at < last_departed_checkpoint.value())
@@ -146,45 +124,18 @@ void EasyTrafficLight::Implementation::immediately_stop_until(
 
   const auto now = node->now();
 
-  if (time >= now)
+  if (time <= now)
     return;
 
   pause_cb();
 
-  *wait_until = time;
-  if (!(*wait_timer))
-  {
-    // It's okay to capture `this` by value here, because if `this` destructs
-    // then so does the wait_timer, in which case this callback will not be
-    // triggered.
-    *wait_timer =
-      node->try_create_wall_timer(
-      std::chrono::milliseconds(100),
-      [w_timer = std::weak_ptr<rclcpp::TimerBase::SharedPtr>(wait_timer),
-      w_node = std::weak_ptr<rclcpp::Node>(node),
-      wait_until = wait_until,
-      resume_cb = resume_cb]()
-      {
-        if (!wait_until->has_value())
-        {
-          if (const auto timer = w_timer.lock())
-            timer->reset();
-        }
-
-        const auto node = w_node.lock();
-        if (!node)
-          return;
-
-        const auto now = node->now();
-
-        if (now <= wait_until->value())
-        {
-          resume_cb();
-          if (const auto timer = w_timer.lock())
-            timer->reset();
-        }
-      });
-  }
+  // Replacing the deadline cancels the one from any earlier stop
+  wait_deadline = deadlines->schedule(
+    rmf_traffic_ros2::convert(time),
+    [resume_cb = resume_cb]()
+    {
+      resume_cb();
+    });
 
   last_received_stop_info = ImmediateStopInfo{
     time,
@@ -212,8 +163,7 @@ void EasyTrafficLight::Implementation::resume(std::size_t version)
   }
 
   last_received_stop_info.reset();
-  wait_timer->reset();
-  wait_until->reset();
+  wait_deadline = nullptr;
 
   resume_cb();
 }
@@ -258,8 +208,7 @@ void EasyTrafficLight::Implementation::clear()
   last_received_checkpoints.reset();
   last_received_stop_info.reset();
   resume_info.reset();
-  wait_until->reset();
-  wait_timer->reset();
+  wait_deadline = nullptr;
   standby_at = 0;
   on_standby = nullptr;
   last_departed_checkpoint.reset();
@@ -271,16 +220,22 @@ void EasyTrafficLight::Implementation::clear()
 void EasyTrafficLight::Implementation::accept_new_checkpoints()
 {
   assert(last_received_checkpoints.has_value());
+  auto& info = last_received_checkpoints.value();
 
-  for (const auto& c : last_received_checkpoints.value().checkpoints)
-    current_checkpoints.at(c.waypoint_index) = c;
+  // The pending checkpoints all come before the new standby, and every
+  // checkpoint from the old standby onwards is already empty, so only the
+  // checkpoints in between need to be cleared.
+  for (auto& [index, c] : info.checkpoints)
+    current_checkpoints.at(index) = std::move(c);
 
-  standby_at = last_received_checkpoints.value().standby_at;
-  on_standby = last_received_checkpoints.value().on_standby;
-
-  for (std::size_t i = standby_at; i < current_checkpoints.size(); ++i)
+  const auto end = std::min(
+    std::max(standby_at, info.standby_at), current_checkpoints.size());
+  for (std::size_t i = info.standby_at; i < end; ++i)
     current_checkpoints[i].reset();
 
+  standby_at = info.standby_at;
+  on_standby = std::move(info.on_standby);
+
   last_received_checkpoints.reset();
 }
 
@@ -655,6 +610,7 @@ EasyTrafficLightPtr EasyTrafficLight::Implementation::make(
   std::function<void(std::vector<Blocker>)> blocker_,
   rxcpp::schedulers::worker worker_,
   std::shared_ptr<Node> node_,
+  std::shared_ptr<DeadlineTimer> deadlines_,
   std::string name_,
   std::string owner_)
 {
@@ -666,6 +622,7 @@ EasyTrafficLightPtr EasyTrafficLight::Implementation::make(
     std::move(blocker_),
     std::move(worker_),
     std::move(node_),
+    std::move(deadlines_),
     std::move(name_),
     std::move(owner_));
 
@@ -680,10 +637,10 @@ EasyTrafficLight::Implementation::Implementation(
   std::function<void(std::vector<Blocker>)> blocker_,
   rxcpp::schedulers::worker worker_,
   std::shared_ptr<Node> node_,
+  std::shared_ptr<DeadlineTimer> deadlines_,
   std::string name_,
   std::string owner_)
-: wait_until(std::make_shared<std::optional<rclcpp::Time>>()),
-  wait_timer(std::make_shared<rclcpp::TimerBase::SharedPtr>()),
+: deadlines(std::move(deadlines_)),
   pause_cb(std::move(pause_)),
   resume_cb(std::move(resume_)),
   blocker_cb(std::move(blocker_)),
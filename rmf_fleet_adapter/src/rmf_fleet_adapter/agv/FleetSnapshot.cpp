@@ -0,0 +1,355 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "FleetSnapshot.hpp"
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+namespace {
+//==============================================================================
+// Every snapshot begins with this header. The final byte is the format
+// version.
+constexpr std::array<uint8_t, 8> Header =
+{'R', 'M', 'F', 'F', 'L', 'E', 'E', 1};
+
+// The file is laid out as
+//   [header: 8][body size: u64][body checksum: u32][reserved: u32][body]
+// with every integer stored little-endian at a fixed width. Strings inside
+// the body are stored as [size: u32][bytes] and messages as
+// [size: u32][CDR payload].
+constexpr std::size_t PrefixSize = 24;
+
+//==============================================================================
+uint32_t crc32(const uint8_t* data, const std::size_t size)
+{
+  uint32_t crc = ~0u;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    crc ^= data[i];
+    for (int k = 0; k < 8; ++k)
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+
+  return ~crc;
+}
+
+//==============================================================================
+class ByteWriter
+{
+public:
+
+  std::vector<uint8_t> buffer;
+
+  void u32(const uint32_t value)
+  {
+    for (int i = 0; i < 4; ++i)
+      buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+  }
+
+  void u64(const uint64_t value)
+  {
+    for (int i = 0; i < 8; ++i)
+      buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+  }
+
+  void string(const std::string& value)
+  {
+    u32(static_cast<uint32_t>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+  }
+
+  template<typename Msg>
+  void message(const Msg& msg)
+  {
+    rclcpp::SerializedMessage serialized;
+    rclcpp::Serialization<Msg>().serialize_message(&msg, &serialized);
+    const auto& raw = serialized.get_rcl_serialized_message();
+    u32(static_cast<uint32_t>(raw.buffer_length));
+    buffer.insert(buffer.end(), raw.buffer, raw.buffer + raw.buffer_length);
+  }
+};
+
+//==============================================================================
+class ByteReader
+{
+public:
+
+  ByteReader(const uint8_t* data, const std::size_t size)
+  : _data(data),
+    _size(size)
+  {
+    // Do nothing
+  }
+
+  uint32_t u32()
+  {
+    _require(4);
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+      value |= static_cast<uint32_t>(_data[_index++]) << (8*i);
+
+    return value;
+  }
+
+  uint64_t u64()
+  {
+    _require(8);
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i)
+      value |= static_cast<uint64_t>(_data[_index++]) << (8*i);
+
+    return value;
+  }
+
+  std::string string()
+  {
+    const std::size_t size = u32();
+    _require(size);
+    std::string value(reinterpret_cast<const char*>(_data + _index), size);
+    _index += size;
+    return value;
+  }
+
+  template<typename Msg>
+  Msg message()
+  {
+    const std::size_t size = u32();
+    _require(size);
+
+    rclcpp::SerializedMessage serialized(size);
+    auto& raw = serialized.get_rcl_serialized_message();
+    std::memcpy(raw.buffer, _data + _index, size);
+    raw.buffer_length = size;
+    _index += size;
+
+    Msg msg;
+    rclcpp::Serialization<Msg>().deserialize_message(&serialized, &msg);
+    return msg;
+  }
+
+  bool done() const
+  {
+    return _index == _size;
+  }
+
+private:
+
+  void _require(const std::size_t bytes) const
+  {
+    if (_size - _index < bytes)
+      throw FleetSnapshotError("[FleetSnapshot] Truncated fleet snapshot");
+  }
+
+  const uint8_t* _data;
+  std::size_t _size;
+  std::size_t _index = 0;
+};
+
+//==============================================================================
+[[noreturn]] void throw_errno(const std::string& what, const std::string& path)
+{
+  throw FleetSnapshotError(
+    "[FleetSnapshot] Failed to " + what + " [" + path + "]: "
+    + std::strerror(errno));
+}
+
+} // anonymous namespace
+
+//==============================================================================
+std::vector<uint8_t> encode_fleet_snapshot(const FleetSnapshot& snapshot)
+{
+  ByteWriter body;
+  body.string(snapshot.fleet_name);
+
+  body.u32(static_cast<uint32_t>(snapshot.robots.size()));
+  for (const auto& robot : snapshot.robots)
+  {
+    body.string(robot.name);
+    body.u32(static_cast<uint32_t>(robot.queue.size()));
+    for (const auto& id : robot.queue)
+      body.string(id);
+  }
+
+  body.u32(static_cast<uint32_t>(snapshot.bids.size()));
+  for (const auto& id : snapshot.bids)
+    body.string(id);
+
+  // Sort the profiles so that the same state always gives the same bytes,
+  // which lets the writer skip saving a state that has not changed.
+  std::vector<const rmf_task_msgs::msg::TaskProfile*> profiles;
+  profiles.reserve(snapshot.task_profiles.size());
+  for (const auto& [id, profile] : snapshot.task_profiles)
+    profiles.push_back(&profile);
+
+  std::sort(profiles.begin(), profiles.end(), [](auto a, auto b)
+    {
+      return a->task_id < b->task_id;
+    });
+
+  body.u32(static_cast<uint32_t>(profiles.size()));
+  for (const auto* profile : profiles)
+    body.message(*profile);
+
+  ByteWriter file;
+  file.buffer.reserve(PrefixSize + body.buffer.size());
+  file.buffer.insert(file.buffer.end(), Header.begin(), Header.end());
+  file.u64(body.buffer.size());
+  file.u32(crc32(body.buffer.data(), body.buffer.size()));
+  file.u32(0);
+  file.buffer.insert(
+    file.buffer.end(), body.buffer.begin(), body.buffer.end());
+
+  return std::move(file.buffer);
+}
+
+//==============================================================================
+FleetSnapshot decode_fleet_snapshot(
+  const std::vector<uint8_t>& data,
+  const std::string& source)
+{
+  if (data.size() < PrefixSize
+    || !std::equal(Header.begin(), Header.end(), data.begin()))
+  {
+    throw FleetSnapshotError(
+      "[FleetSnapshot] File [" + source + "] is not a fleet snapshot");
+  }
+
+  ByteReader prefix(data.data() + Header.size(), PrefixSize - Header.size());
+  const uint64_t body_size = prefix.u64();
+  const uint32_t checksum = prefix.u32();
+  if (body_size != data.size() - PrefixSize)
+  {
+    throw FleetSnapshotError(
+      "[FleetSnapshot] File [" + source + "] has the wrong size");
+  }
+
+  const uint8_t* const body = data.data() + PrefixSize;
+  if (crc32(body, body_size) != checksum)
+  {
+    throw FleetSnapshotError(
+      "[FleetSnapshot] File [" + source + "] is corrupt");
+  }
+
+  ByteReader r(body, body_size);
+  FleetSnapshot snapshot;
+  snapshot.fleet_name = r.string();
+
+  const uint32_t num_robots = r.u32();
+  for (uint32_t i = 0; i < num_robots; ++i)
+  {
+    FleetSnapshot::Robot robot;
+    robot.name = r.string();
+    const uint32_t queue_size = r.u32();
+    for (uint32_t k = 0; k < queue_size; ++k)
+      robot.queue.push_back(r.string());
+
+    snapshot.robots.emplace_back(std::move(robot));
+  }
+
+  const uint32_t num_bids = r.u32();
+  for (uint32_t i = 0; i < num_bids; ++i)
+    snapshot.bids.push_back(r.string());
+
+  const uint32_t num_profiles = r.u32();
+  for (uint32_t i = 0; i < num_profiles; ++i)
+  {
+    auto profile = r.message<rmf_task_msgs::msg::TaskProfile>();
+    auto id = profile.task_id;
+    snapshot.task_profiles.insert_or_assign(std::move(id), std::move(profile));
+  }
+
+  if (!r.done())
+  {
+    throw FleetSnapshotError(
+      "[FleetSnapshot] File [" + source + "] has trailing bytes");
+  }
+
+  return snapshot;
+}
+
+//==============================================================================
+void write_fleet_snapshot(
+  const std::string& file_path,
+  const std::vector<uint8_t>& encoded)
+{
+  const std::string tmp_path = file_path + ".tmp";
+  const int fd = ::open(
+    tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    throw_errno("create", tmp_path);
+
+  std::size_t written = 0;
+  while (written < encoded.size())
+  {
+    const auto n = ::write(
+      fd, encoded.data() + written, encoded.size() - written);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      ::close(fd);
+      std::filesystem::remove(tmp_path);
+      throw_errno("write to", tmp_path);
+    }
+
+    written += static_cast<std::size_t>(n);
+  }
+
+  if (::fsync(fd) != 0)
+  {
+    ::close(fd);
+    std::filesystem::remove(tmp_path);
+    throw_errno("sync", tmp_path);
+  }
+
+  ::close(fd);
+  std::filesystem::rename(tmp_path, file_path);
+}
+
+//==============================================================================
+std::optional<FleetSnapshot> read_fleet_snapshot(const std::string& file_path)
+{
+  if (!std::filesystem::exists(file_path))
+    return std::nullopt;
+
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file)
+    throw_errno("open", file_path);
+
+  const std::vector<uint8_t> data(
+    (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  return decode_fleet_snapshot(data, file_path);
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
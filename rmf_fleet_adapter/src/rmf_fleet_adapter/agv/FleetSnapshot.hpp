@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__FLEETSNAPSHOT_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__FLEETSNAPSHOT_HPP
+
+#include <rmf_task_msgs/msg/task_profile.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// The runtime state of a fleet adapter that is worth keeping across a
+/// restart: which tasks each robot has queued and what was bid on, along with
+/// the profiles of those tasks so that their requests can be generated again.
+struct FleetSnapshot
+{
+  struct Robot
+  {
+    std::string name;
+
+    /// The IDs of the tasks in the queue of the robot, in the order that they
+    /// will be performed. Automatic tasks, like charging, are left out.
+    std::vector<std::string> queue;
+  };
+
+  std::string fleet_name;
+  std::vector<Robot> robots;
+
+  /// The IDs of the tasks that a bid was submitted for but which have not
+  /// been dispatched to this fleet yet
+  std::vector<std::string> bids;
+
+  /// The profile of every task that is mentioned by the snapshot
+  std::unordered_map<std::string, rmf_task_msgs::msg::TaskProfile>
+  task_profiles;
+};
+
+//==============================================================================
+/// Thrown when a snapshot file exists but cannot be read.
+class FleetSnapshotError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+/// Encode a snapshot into the bytes that write_fleet_snapshot() puts into a
+/// file, including the header and checksum.
+std::vector<uint8_t> encode_fleet_snapshot(const FleetSnapshot& snapshot);
+
+//==============================================================================
+/// Decode the bytes produced by encode_fleet_snapshot(). The source is only
+/// used to describe where the bytes came from if a FleetSnapshotError gets
+/// thrown.
+FleetSnapshot decode_fleet_snapshot(
+  const std::vector<uint8_t>& data,
+  const std::string& source);
+
+//==============================================================================
+/// Write encoded snapshot bytes to disk. The bytes are written next to
+/// file_path and then renamed over it, so a crash will never leave a partial
+/// snapshot behind.
+void write_fleet_snapshot(
+  const std::string& file_path,
+  const std::vector<uint8_t>& encoded);
+
+//==============================================================================
+/// Read a snapshot from disk. This returns a std::nullopt if there is no
+/// snapshot at file_path, and throws a FleetSnapshotError if the file is not
+/// a valid snapshot.
+std::optional<FleetSnapshot> read_fleet_snapshot(const std::string& file_path);
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__FLEETSNAPSHOT_HPP
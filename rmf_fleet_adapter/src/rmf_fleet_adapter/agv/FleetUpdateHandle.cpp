@@ -19,10 +19,21 @@
 #include <rmf_fleet_msgs/msg/robot_mode.hpp>
 #include <rmf_fleet_msgs/msg/location.hpp>
 
+#include <rmf_traffic_ros2/MemoryUsage.hpp>
+#include <rmf_traffic_ros2/StandardNames.hpp>
 #include <rmf_traffic_ros2/Time.hpp>
+#include <rmf_traffic_ros2/Tracer.hpp>
 
 #include "internal_FleetUpdateHandle.hpp"
 #include "internal_RobotUpdateHandle.hpp"
+#include "AllocationOutcome.hpp"
+#include "BidBundle.hpp"
+#include "BidPlanningDeadline.hpp"
+#include "IncrementalAllocation.hpp"
+#include "LaneUpdate.hpp"
+#include "ParallelFor.hpp"
+#include "PlanningSlots.hpp"
+#include "PlannerWarmUp.hpp"
 #include "RobotContext.hpp"
 
 #include "../tasks/Delivery.hpp"
@@ -38,6 +49,10 @@
 #include <rmf_task_msgs/msg/delivery.hpp>
 #include <rmf_task_msgs/msg/loop.hpp>
 
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
@@ -47,6 +62,97 @@ namespace rmf_fleet_adapter {
 namespace agv {
 
 namespace {
+//==============================================================================
+// The allocation key used for replanning the queues in the background
+const std::string OptimizationKey = "optimize";
+
+//==============================================================================
+std::string to_string(FleetUpdateHandle::AllocationMetrics::Kind kind)
+{
+  using Kind = FleetUpdateHandle::AllocationMetrics::Kind;
+  switch (kind)
+  {
+    case Kind::Bid: return "bid";
+    case Kind::Dispatch: return "dispatch";
+    case Kind::Cancel: return "cancel";
+    case Kind::Optimization: return "optimization";
+  }
+
+  return "unknown";
+}
+
+//==============================================================================
+YAML::Node serialize(
+  const std::string& fleet,
+  const FleetUpdateHandle::AllocationMetrics& metrics)
+{
+  using rmf_traffic::time::to_seconds;
+
+  YAML::Node node;
+  node["fleet"] = fleet;
+  node["kind"] = to_string(metrics.kind);
+  node["task_id"] = metrics.task_id;
+  node["robots"] = metrics.robots;
+  node["requests"] = metrics.requests;
+  node["queue_wait"] = to_seconds(metrics.queue_wait);
+  node["planning_duration"] = to_seconds(metrics.planning_duration);
+  node["cached"] = metrics.cached;
+  node["greedy"] = metrics.greedy;
+  if (metrics.cost.has_value())
+    node["cost"] = *metrics.cost;
+  else
+    node["cost"] = YAML::Null;
+
+  if (metrics.notice_to_proposal.has_value())
+    node["notice_to_proposal"] = to_seconds(*metrics.notice_to_proposal);
+
+  return node;
+}
+
+//==============================================================================
+std::string to_string(FleetUpdateHandle::PhaseMetrics::Stage stage)
+{
+  using Stage = FleetUpdateHandle::PhaseMetrics::Stage;
+  switch (stage)
+  {
+    case Stage::TimeToFirstPlan: return "time_to_first_plan";
+    case Stage::Planning: return "planning";
+    case Stage::NegotiationWait: return "negotiation_wait";
+    case Stage::DoorWait: return "door_wait";
+    case Stage::LiftWait: return "lift_wait";
+    case Stage::Execution: return "execution";
+  }
+
+  return "unknown";
+}
+
+//==============================================================================
+YAML::Node serialize(const FleetUpdateHandle::PhaseMetrics& metrics)
+{
+  using rmf_traffic::time::to_seconds;
+
+  YAML::Node node;
+  node["robot"] = metrics.robot;
+  node["phase"] = metrics.phase;
+  node["stage"] = to_string(metrics.stage);
+  node["count"] = metrics.count;
+  node["total"] = to_seconds(metrics.total);
+  node["min"] = to_seconds(metrics.min);
+  node["max"] = to_seconds(metrics.max);
+
+  YAML::Node bounds(YAML::NodeType::Sequence);
+  for (const auto& bound : metrics.bucket_bounds)
+    bounds.push_back(to_seconds(bound));
+  node["bucket_bounds"] = bounds;
+
+  YAML::Node counts(YAML::NodeType::Sequence);
+  for (const auto count : metrics.bucket_counts)
+    counts.push_back(count);
+  node["bucket_counts"] = counts;
+
+  return node;
+}
+
 //==============================================================================
 class LiaisonNegotiator : public rmf_traffic::schedule::Negotiator
 {
@@ -100,74 +206,16 @@ void FleetUpdateHandle::Implementation::dock_summary_cb(
 }
 
 //==============================================================================
-void FleetUpdateHandle::Implementation::bid_notice_cb(
-  const BidNotice::SharedPtr msg)
+rmf_task::ConstRequestPtr FleetUpdateHandle::Implementation::make_request(
+  const TaskProfileMsg& task_profile)
 {
-  if (task_managers.empty())
-  {
-    RCLCPP_INFO(
-      node->get_logger(),
-      "Fleet [%s] does not have any robots to accept task [%s]. Use "
-      "FleetUpdateHadndle::add_robot(~) to add robots to this fleet. ",
-      name.c_str(), msg->task_profile.task_id.c_str());
-    return;
-  }
-
-  if (msg->task_profile.task_id.empty())
-  {
-    RCLCPP_WARN(
-      node->get_logger(),
-      "Received BidNotice for a task with invalid task_id. Request will be "
-      "ignored.");
-    return;
-  }
-
-  // TODO remove this block when we support task revival
-  if (bid_notice_assignments.find(msg->task_profile.task_id)
-    != bid_notice_assignments.end())
-    return;
-
-  if (!accept_task)
-  {
-    RCLCPP_WARN(
-      node->get_logger(),
-      "Fleet [%s] is not configured to accept any task requests. Use "
-      "FleetUpdateHadndle::accept_task_requests(~) to define a callback "
-      "for accepting requests", name.c_str());
-
-    return;
-  }
-
-  if (!accept_task(msg->task_profile))
-  {
-    RCLCPP_INFO(
-      node->get_logger(),
-      "Fleet [%s] is configured to not accept task [%s]",
-      name.c_str(),
-      msg->task_profile.task_id.c_str());
-
-    return;
-  }
-
-  if (!task_planner)
-  {
-    RCLCPP_WARN(
-      node->get_logger(),
-      "Fleet [%s] is not configured with parameters for task planning."
-      "Use FleetUpdateHandle::set_task_planner_params(~) to set the "
-      "parameters required.", name.c_str());
-
-    return;
-  }
-
   // Determine task type and convert to request pointer
   rmf_task::ConstRequestPtr new_request = nullptr;
-  const auto& task_profile = msg->task_profile;
   const auto& task_type = task_profile.description.task_type;
   const rmf_traffic::Time start_time =
     rmf_traffic_ros2::convert(task_profile.description.start_time);
   // TODO (YV) get rid of ID field in RequestPtr
-  std::string id = msg->task_profile.task_id;
+  const std::string& id = task_profile.task_id;
   const auto& graph = (*planner)->get_configuration().graph();
 
   // Generate the priority of the request. The current implementation supports
@@ -187,7 +235,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Required param [clean.start_waypoint] missing in TaskProfile."
         "Rejecting BidNotice with task_id:[%s]", id.c_str());
 
-      return;
+      return nullptr;
     }
 
     // Check for valid start waypoint
@@ -202,7 +250,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "nav graph. Rejecting BidNotice with task_id:[%s]",
         name.c_str(), start_wp_name.c_str(), id.c_str());
 
-      return;
+      return nullptr;
     }
 
     // Get dock parameters
@@ -214,7 +262,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Dock param for dock_name:[%s] unavailable. Rejecting BidNotice with "
         "task_id:[%s]", start_wp_name.c_str(), id.c_str());
 
-      return;
+      return nullptr;
     }
     const auto& clean_param = clean_param_it->second;
 
@@ -229,7 +277,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "nav graph. Rejecting BidNotice with task_id:[%s]",
         name.c_str(), finish_wp_name.c_str(), id.c_str());
 
-      return;
+      return nullptr;
     }
 
     // Interpolate docking waypoint into trajectory
@@ -249,7 +297,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Unable to generate cleaning trajectory from positions specified "
         " in DockSummary msg for [%s]", start_wp_name.c_str());
 
-      return;
+      return nullptr;
     }
 
     new_request = rmf_task::requests::Clean::make(
@@ -275,7 +323,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Required param [delivery.pickup_place_name] missing in TaskProfile."
         "Rejecting BidNotice with task_id:[%s]", id.c_str());
 
-      return;
+      return nullptr;
     }
 
     if (delivery.pickup_dispenser.empty())
@@ -285,7 +333,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Required param [delivery.pickup_dispenser] missing in TaskProfile."
         "Rejecting BidNotice with task_id:[%s]", id.c_str());
 
-      return;
+      return nullptr;
     }
 
     if (delivery.dropoff_place_name.empty())
@@ -295,7 +343,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Required param [delivery.dropoff_place_name] missing in TaskProfile."
         "Rejecting BidNotice with task_id:[%s]", id.c_str());
 
-      return;
+      return nullptr;
     }
 
     if (delivery.dropoff_place_name.empty())
@@ -305,7 +353,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Required param [delivery.dropoff_place_name] missing in TaskProfile."
         "Rejecting BidNotice with task_id:[%s]", id.c_str());
 
-      return;
+      return nullptr;
     }
 
     if (delivery.dropoff_ingestor.empty())
@@ -315,7 +363,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Required param [delivery.dropoff_ingestor] missing in TaskProfile."
         "Rejecting BidNotice with task_id:[%s]", id.c_str());
 
-      return;
+      return nullptr;
     }
 
     const auto pickup_wp = graph.find_waypoint(delivery.pickup_place_name);
@@ -327,7 +375,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "nav graph. Rejecting BidNotice with task_id:[%s]",
         name.c_str(), delivery.pickup_place_name.c_str(), id.c_str());
 
-      return;
+      return nullptr;
     }
 
     const auto dropoff_wp = graph.find_waypoint(delivery.dropoff_place_name);
@@ -339,7 +387,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "nav graph. Rejecting BidNotice with task_id:[%s]",
         name.c_str(), delivery.dropoff_place_name.c_str(), id.c_str());
 
-      return;
+      return nullptr;
     }
 
     // TODO: We set the waiting duration at the pickup and dropoff locations to
@@ -369,7 +417,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Required param [loop.start_name] missing in TaskProfile."
         "Rejecting BidNotice with task_id:[%s]", id.c_str());
 
-      return;
+      return nullptr;
     }
 
     if (loop.finish_name.empty())
@@ -379,7 +427,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Required param [loop.finish_name] missing in TaskProfile."
         "Rejecting BidNotice with task_id:[%s]", id.c_str());
 
-      return;
+      return nullptr;
     }
 
     if (loop.num_loops < 1)
@@ -389,7 +437,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "Required param [loop.num_loops: %d] in TaskProfile is invalid."
         "Rejecting BidNotice with task_id:[%s]", loop.num_loops, id.c_str());
 
-      return;
+      return nullptr;
     }
 
     const auto start_wp = graph.find_waypoint(loop.start_name);
@@ -401,7 +449,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "nav graph. Rejecting BidNotice with task_id:[%s]",
         name.c_str(), loop.start_name.c_str(), id.c_str());
 
-      return;
+      return nullptr;
     }
 
     const auto finish_wp = graph.find_waypoint(loop.finish_name);
@@ -413,7 +461,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
         "nav graph. Rejecting BidNotice with task_id:[%s]",
         name.c_str(), loop.finish_name.c_str(), id.c_str());
 
-      return;
+      return nullptr;
     }
 
     new_request = rmf_task::requests::Loop::make(
@@ -436,22 +484,239 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
       "task_id:[%s]",
       task_type.type, id.c_str());
 
+    return nullptr;
+  }
+
+  return new_request;
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::bid_notice_cb(
+  const BidNotice::SharedPtr msg)
+{
+  {
+    // Bids need to be planned against the queues that the robots had before
+    // the adapter restarted, so they wait until those are restored.
+    std::lock_guard<std::mutex> lock(warm_start_mutex);
+    if (warm_start.has_value())
+    {
+      warm_start_bids.push_back(msg);
+      return;
+    }
+  }
+
+  if (task_managers.empty())
+  {
+    RCLCPP_INFO(
+      node->get_logger(),
+      "Fleet [%s] does not have any robots to accept task [%s]. Use "
+      "FleetUpdateHadndle::add_robot(~) to add robots to this fleet. ",
+      name.c_str(), msg->task_profile.task_id.c_str());
+    return;
+  }
+
+  if (msg->task_profile.task_id.empty())
+  {
+    RCLCPP_WARN(
+      node->get_logger(),
+      "Received BidNotice for a task with invalid task_id. Request will be "
+      "ignored.");
+    return;
+  }
+
+  // TODO remove this block when we support task revival
+  if (task_received.count(msg->task_profile.task_id)
+    || bid_notice_assignments.count(msg->task_profile.task_id)
+    || allocation_jobs.count(msg->task_profile.task_id)
+    || bundled_bids.count(msg->task_profile.task_id))
+    return;
+
+  if (!accept_task)
+  {
+    RCLCPP_WARN(
+      node->get_logger(),
+      "Fleet [%s] is not configured to accept any task requests. Use "
+      "FleetUpdateHadndle::accept_task_requests(~) to define a callback "
+      "for accepting requests", name.c_str());
+
+    return;
+  }
+
+  if (!accept_task(msg->task_profile))
+  {
+    RCLCPP_INFO(
+      node->get_logger(),
+      "Fleet [%s] is configured to not accept task [%s]",
+      name.c_str(),
+      msg->task_profile.task_id.c_str());
+
+    return;
+  }
+
+  if (!task_planner)
+  {
+    RCLCPP_WARN(
+      node->get_logger(),
+      "Fleet [%s] is not configured with parameters for task planning."
+      "Use FleetUpdateHandle::set_task_planner_params(~) to set the "
+      "parameters required.", name.c_str());
+
     return;
   }
 
+  const auto& task_profile = msg->task_profile;
+  const std::string& id = task_profile.task_id;
+  const auto new_request = make_request(task_profile);
   if (!new_request)
     return;
   generated_requests.insert({id, new_request});
   task_profile_map.insert({id, task_profile});
+  instruments->bid_notices->increment();
+
+  const auto received = std::chrono::steady_clock::now();
+  bid_notice_times[id] = received;
+  task_received[id] = received;
+
+  // The auction is decided once the time window closes, so a bid that is still
+  // searching for optimal assignments by then would be wasted.
+  const auto deadline = bid_planning_deadline(
+    received,
+    std::chrono::nanoseconds(rclcpp::Duration(msg->time_window).nanoseconds()),
+    bid_planning_budget);
+  if (deadline.has_value())
+    bid_deadlines[id] = *deadline;
+
+  // A bid should not have to wait behind a background optimization. The
+  // optimization will be started again once the task is dispatched.
+  cancel_allocation(OptimizationKey);
+
+  // A high priority bid is planned right away instead of waiting to be
+  // bundled with others
+  if (bid_bundle_period.has_value() && !is_high_priority(id))
+  {
+    bid_bundle.push_back({id, new_request, task_profile});
+    bundled_bids.insert(id);
+    if (!bid_bundle_timer)
+    {
+      bid_bundle_timer = node->try_create_wall_timer(
+        *bid_bundle_period,
+        [w = weak_self]()
+        {
+          if (const auto self = w.lock())
+            self->_pimpl->plan_bid_bundle();
+        });
+    }
+
+    return;
+  }
 
-  const auto allocation_result = allocate_tasks(new_request);
+  async_allocate_tasks(
+    id, new_request, nullptr,
+    [this, id, task_profile](
+      const std::optional<Assignments>& result, std::size_t version)
+    {
+      this->submit_bid(id, task_profile, result, version);
+    }, true);
+}
 
-  if (!allocation_result.has_value())
+//==============================================================================
+void FleetUpdateHandle::Implementation::plan_bid_bundle()
+{
+  if (bid_bundle_timer)
+  {
+    bid_bundle_timer->cancel();
+    bid_bundle_timer = nullptr;
+  }
+
+  const auto bundle = std::move(bid_bundle);
+  bid_bundle.clear();
+  if (bundle.empty())
+    return;
+
+  if (bundle.size() == 1)
+  {
+    // There is nothing to plan jointly, so this is bid for as usual
+    const auto& bid = bundle.front();
+    bundled_bids.erase(bid.id);
+    async_allocate_tasks(
+      bid.id, bid.request, nullptr,
+      [this, id = bid.id, task_profile = bid.task_profile](
+        const std::optional<Assignments>& result, std::size_t version)
+      {
+        this->submit_bid(id, task_profile, result, version);
+      }, true);
     return;
+  }
+
+  std::vector<std::string> ids;
+  std::vector<rmf_task::ConstRequestPtr> requests;
+  ids.reserve(bundle.size());
+  requests.reserve(bundle.size());
+  for (const auto& bid : bundle)
+  {
+    ids.push_back(bid.id);
+    requests.push_back(bid.request);
+  }
+
+  const auto key = bid_bundle_key(ids);
+
+  RCLCPP_INFO(
+    node->get_logger(),
+    "Planning a bundle of [%ld] bids for fleet [%s]",
+    bundle.size(), name.c_str());
+
+  async_allocate_bundle(
+    key, requests,
+    [this, bundle](
+      const std::optional<Assignments>& result, std::size_t version)
+    {
+      for (const auto& bid : bundle)
+      {
+        // A bundle that could not be planned can be bid for again
+        if (!result.has_value())
+          bundled_bids.erase(bid.id);
+
+        bid_notice_times.erase(bid.id);
+        this->submit_bid(
+          bid.id, bid.task_profile, result, version, bundle.size());
+      }
+    });
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::submit_bid(
+  const std::string& id,
+  const TaskProfileMsg& task_profile,
+  const std::optional<Assignments>& allocation_result,
+  std::size_t version,
+  std::size_t bundle_size)
+{
+  bid_deadlines.erase(id);
+
+  // A dispatch request that arrived while this bid was being planned can be
+  // processed now, whether or not the planning succeeded.
+  const auto process_deferred_dispatch = [&]()
+    {
+      const auto deferred = deferred_dispatches.find(id);
+      if (deferred == deferred_dispatches.end())
+        return;
+
+      const auto dispatch = deferred->second;
+      deferred_dispatches.erase(deferred);
+      dispatch_request_cb(dispatch);
+    };
+
+  if (!allocation_result.has_value())
+    return process_deferred_dispatch();
 
   const auto& assignments = allocation_result.value();
 
-  const double cost = task_planner->compute_cost(assignments);
+  // A task that was planned in a bundle is charged an equal share of the cost
+  // that the whole bundle adds to the fleet
+  const double cost = bid_bundle_cost(
+    current_assignment_cost,
+    task_planner->compute_cost(assignments),
+    bundle_size);
 
   // Display computed assignments for debugging
   std::stringstream debug_stream;
@@ -512,6 +777,7 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
   }
 
   bid_proposal_pub->publish(bid_proposal);
+  instruments->bid_proposals->increment();
   RCLCPP_INFO(
     node->get_logger(),
     "Submitted BidProposal to accommodate task [%s] by robot [%s] with new cost [%f]",
@@ -519,7 +785,11 @@ void FleetUpdateHandle::Implementation::bid_notice_cb(
 
   // Store assignments in internal map
   bid_notice_assignments.insert({id, assignments});
+  bid_notice_versions[id] = version;
+  if (persist_file.has_value())
+    open_bids[id] = std::chrono::steady_clock::now();
 
+  process_deferred_dispatch();
 }
 
 //==============================================================================
@@ -530,6 +800,11 @@ void FleetUpdateHandle::Implementation::dispatch_request_cb(
     return;
 
   const std::string id = msg->task_profile.task_id;
+  const auto span = rmf_traffic_ros2::tracing::span(
+    "fleet.dispatch_request", rmf_traffic_ros2::tracing::task(id),
+    {{"rmf.fleet", name},
+      {"rmf.method", msg->method == DispatchRequest::ADD ? "add" : "cancel"}});
+
   DispatchAck dispatch_ack;
   dispatch_ack.dispatch_request = *msg;
   dispatch_ack.success = false;
@@ -539,6 +814,14 @@ void FleetUpdateHandle::Implementation::dispatch_request_cb(
     const auto task_it = bid_notice_assignments.find(id);
     if (task_it == bid_notice_assignments.end())
     {
+      if (allocation_jobs.count(id) || bundled_bids.count(id))
+      {
+        // The bid for this task is still being planned, so the request will
+        // be processed once it is ready.
+        deferred_dispatches[id] = msg;
+        return;
+      }
+
       RCLCPP_WARN(
         node->get_logger(),
         "Received DispatchRequest for task_id:[%s] before receiving BidNotice. "
@@ -556,17 +839,6 @@ void FleetUpdateHandle::Implementation::dispatch_request_cb(
 
     auto& assignments = task_it->second;
 
-    if (assignments.size() != task_managers.size())
-    {
-      RCLCPP_ERROR(
-        node->get_logger(),
-        "The number of available robots does not match that in the assignments "
-        "for task_id:[%s]. This request will be ignored.",
-        id.c_str());
-      dispatch_ack_pub->publish(dispatch_ack);
-      return;
-    }
-
     // Here we make sure none of the tasks in the assignments has already begun
     // execution. If so, we replan assignments until a valid set is obtained
     // and only then update the task manager queues
@@ -582,38 +854,56 @@ void FleetUpdateHandle::Implementation::dispatch_request_cb(
       return;
     }
 
-    bool valid_assignments = is_valid_assignments(assignments);
+    // The assignments of the bid are out of date if any other task has been
+    // assigned since the bid was planned. The assignments of a bundled bid
+    // also hold the other tasks of its bundle, which might not be awarded to
+    // this fleet.
+    // The assignments of a bid that was restored after a restart are empty,
+    // and robots may have been added since any other bid was planned.
+    const bool valid_assignments =
+      assignments.size() == task_managers.size()
+      && is_valid_assignments(assignments)
+      && bid_notice_versions[id] == assignments_version
+      && !bundled_bids.count(id);
     if (!valid_assignments)
     {
-      // TODO: This replanning is blocking the main thread. Instead, the
-      // replanning should run on a separate worker and then deliver the
-      // result back to the main worker.
-      const auto replan_results = allocate_tasks(request_it->second);
-      if (!replan_results)
-      {
-        RCLCPP_WARN(
-          node->get_logger(),
-          "Unable to replan assignments when accommodating task_id:[%s]. This "
-          "request will be ignored.",
-          id.c_str());
-        dispatch_ack_pub->publish(dispatch_ack);
-        return;
-      }
-      assignments = replan_results.value();
-      // We do not need to re-check if assignments are valid as this function
-      // is being called by the ROS2 executor and is running on the main
-      // rxcpp worker. Hence, no new tasks would have started during this replanning.
-    }
+      // The replanning runs on the planning worker. Once it is done, this
+      // request is processed again with the new assignments, which checks
+      // whether any tasks began while the replanning was underway.
+      async_allocate_tasks(
+        id, request_it->second, nullptr,
+        [this, msg, id, dispatch_ack](
+          const std::optional<Assignments>& replan_results, std::size_t)
+        {
+          bundled_bids.erase(id);
+          if (!replan_results)
+          {
+            RCLCPP_WARN(
+              node->get_logger(),
+              "Unable to replan assignments when accommodating task_id:[%s]. "
+              "This request will be ignored.",
+              id.c_str());
+            dispatch_ack_pub->publish(dispatch_ack);
+            return;
+          }
 
-    std::size_t index = 0;
-    for (auto& t : task_managers)
-    {
-      t.second->set_queue(assignments[index], task_profile_map);
-      ++index;
+          bid_notice_assignments[id] = *replan_results;
+          bid_notice_versions[id] = assignments_version;
+          dispatch_request_cb(msg);
+        });
+      return;
     }
 
-    current_assignment_cost = task_planner->compute_cost(assignments);
+    set_assignments(assignments);
     assigned_requests.insert({id, request_it->second});
+    open_bids.erase(id);
+    instruments->tasks_awarded->increment();
+
+    // The bid has served its purpose, so only the bookkeeping that is needed
+    // while the task is queued is kept
+    generated_requests.erase(request_it);
+    bid_notice_assignments.erase(task_it);
+    bid_notice_versions.erase(id);
     dispatch_ack.success = true;
     dispatch_ack_pub->publish(dispatch_ack);
 
@@ -621,6 +911,9 @@ void FleetUpdateHandle::Implementation::dispatch_request_cb(
       node->get_logger(),
       "Assignments updated for robots in fleet [%s] to accommodate task_id:[%s]",
       name.c_str(), id.c_str());
+
+    if (incremental_allocation && optimize_in_background)
+      optimize_assignments();
   }
 
   else if (msg->method == DispatchRequest::CANCEL)
@@ -656,15 +949,8 @@ void FleetUpdateHandle::Implementation::dispatch_request_cb(
       return;
     }
 
-    std::unordered_set<std::string> executed_tasks;
-    for (const auto& [context, mgr] : task_managers)
-    {
-      const auto& tasks = mgr->get_executed_tasks();
-      executed_tasks.insert(tasks.begin(), tasks.end());
-    }
-
     // Check if received request is to cancel an active task
-    if (executed_tasks.find(id) != executed_tasks.end())
+    if (started_tasks->contains(id))
     {
       RCLCPP_WARN(
         node->get_logger(),
@@ -677,39 +963,49 @@ void FleetUpdateHandle::Implementation::dispatch_request_cb(
     }
 
     // Re-plan assignments while ignoring request for task to be cancelled
-    const auto replan_results = allocate_tasks(
-      nullptr, request_to_cancel_it->second);
+    async_allocate_tasks(
+      "cancel/" + id, nullptr, request_to_cancel_it->second,
+      [this, msg, id, dispatch_ack](
+        const std::optional<Assignments>& replan_results,
+        std::size_t) mutable
+      {
+        if (!replan_results.has_value())
+        {
+          RCLCPP_WARN(
+            node->get_logger(),
+            "Unable to re-plan assignments when cancelling task with "
+            "task_id:[%s]",
+            id.c_str());
 
-    if (!replan_results.has_value())
-    {
-      RCLCPP_WARN(
-        node->get_logger(),
-        "Unable to re-plan assignments when cancelling task with task_id:[%s]",
-        id.c_str());
+          dispatch_ack_pub->publish(dispatch_ack);
+          return;
+        }
 
-      dispatch_ack_pub->publish(dispatch_ack);
-      return;
-    }
+        auto assignments = replan_results.value();
+        if (!is_valid_assignments(assignments))
+        {
+          // A task began while the re-planning was underway, so the request
+          // needs to be checked again from the start.
+          dispatch_request_cb(msg);
+          return;
+        }
 
-    const auto& assignments = replan_results.value();
-    std::size_t index = 0;
-    for (auto& t : task_managers)
-    {
-      t.second->set_queue(assignments[index], task_profile_map);
-      ++index;
-    }
+        set_assignments(assignments);
 
-    current_assignment_cost = task_planner->compute_cost(assignments);
+        dispatch_ack.success = true;
+        dispatch_ack_pub->publish(dispatch_ack);
+        cancelled_task_ids[id] = std::chrono::steady_clock::now();
+        instruments->tasks_cancelled->increment();
 
-    dispatch_ack.success = true;
-    dispatch_ack_pub->publish(dispatch_ack);
-    cancelled_task_ids.insert(id);
+        RCLCPP_INFO(
+          node->get_logger(),
+          "Task with task_id:[%s] has successfully been cancelled. Assignments "
+          "updated for robots in fleet [%s].",
+          id.c_str(), name.c_str());
 
-    RCLCPP_INFO(
-      node->get_logger(),
-      "Task with task_id:[%s] has successfully been cancelled. Assignments "
-      "updated for robots in fleet [%s].",
-      id.c_str(), name.c_str());
+        if (fast_cancellation && optimize_after_cancellation)
+          optimize_assignments();
+      });
   }
 
   else
@@ -728,18 +1024,11 @@ void FleetUpdateHandle::Implementation::dispatch_request_cb(
 auto FleetUpdateHandle::Implementation::is_valid_assignments(
   Assignments& assignments) const -> bool
 {
-  std::unordered_set<std::string> executed_tasks;
-  for (const auto& [context, mgr] : task_managers)
-  {
-    const auto& tasks = mgr->get_executed_tasks();
-    executed_tasks.insert(tasks.begin(), tasks.end());
-  }
-
   for (const auto& agent : assignments)
   {
     for (const auto& a : agent)
     {
-      if (executed_tasks.find(a.request()->id()) != executed_tasks.end())
+      if (started_tasks->contains(a.request()->id()))
         return false;
     }
   }
@@ -778,7 +1067,7 @@ void FleetUpdateHandle::Implementation::fleet_state_publish_period(
 {
   if (value.has_value())
   {
-    fleet_state_timer = node->create_wall_timer(
+    fleet_state_timer = node->try_create_wall_timer(
       std::chrono::seconds(1), [this]() { this->publish_fleet_state(); });
   }
   else
@@ -839,14 +1128,69 @@ rmf_fleet_msgs::msg::RobotState convert_state(const TaskManager& mgr)
     // information.
     .path({});
 }
+
+//==============================================================================
+/// Check whether a robot has changed enough since it was last published for
+/// its state to be worth publishing again. The timestamp of the location is
+/// ignored, since it changes with every position update of the robot.
+bool state_changed(
+  const rmf_fleet_msgs::msg::RobotState& previous,
+  const rmf_fleet_msgs::msg::RobotState& current)
+{
+  constexpr double PositionTolerance = 0.01;
+  constexpr double YawTolerance = 0.01;
+  constexpr double BatteryTolerance = 0.1;
+
+  const auto& p = previous.location;
+  const auto& c = current.location;
+  return previous.task_id != current.task_id
+    || previous.mode != current.mode
+    || std::abs(previous.battery_percent - current.battery_percent)
+    >= BatteryTolerance
+    || p.level_name != c.level_name
+    || std::hypot(p.x - c.x, p.y - c.y) >= PositionTolerance
+    || std::abs(p.yaw - c.yaw) >= YawTolerance;
+}
 } // anonymous namespace
 
 //==============================================================================
-void FleetUpdateHandle::Implementation::publish_fleet_state() const
+void FleetUpdateHandle::Implementation::publish_fleet_state()
 {
+  const auto now = std::chrono::steady_clock::now();
+  const bool on_change = fleet_state_keyframe_period.has_value();
+  const bool keyframe = !on_change
+    || *fleet_state_keyframe_period <= now - last_fleet_state_keyframe;
+
+  if (keyframe)
+  {
+    last_fleet_state_keyframe = now;
+
+    // Forget robots that are no longer in the fleet
+    published_robot_states.clear();
+  }
+
   std::vector<rmf_fleet_msgs::msg::RobotState> robot_states;
   for (const auto& [context, mgr] : task_managers)
-    robot_states.emplace_back(convert_state(*mgr));
+  {
+    auto state = convert_state(*mgr);
+    if (on_change)
+    {
+      const auto insertion =
+        published_robot_states.insert({state.name, state});
+      if (!insertion.second)
+      {
+        if (!state_changed(insertion.first->second, state))
+          continue;
+
+        insertion.first->second = state;
+      }
+    }
+
+    robot_states.emplace_back(std::move(state));
+  }
+
+  if (robot_states.empty() && !keyframe)
+    return;
 
   auto fleet_state = rmf_fleet_msgs::build<rmf_fleet_msgs::msg::FleetState>()
     .name(name)
@@ -856,359 +1200,2109 @@ void FleetUpdateHandle::Implementation::publish_fleet_state() const
 }
 
 //==============================================================================
-auto FleetUpdateHandle::Implementation::allocate_tasks(
-  rmf_task::ConstRequestPtr new_request,
-  rmf_task::ConstRequestPtr ignore_request) const -> std::optional<Assignments>
+void FleetUpdateHandle::Implementation::publish_phase_metrics()
 {
-  // Collate robot states, constraints and combine new requestptr with
-  // requestptr of non-charging tasks in task manager queues
-  std::vector<rmf_task::agv::State> states;
-  std::vector<rmf_task::ConstRequestPtr> pending_requests;
-  std::string id = "";
+  if (!phase_metrics)
+    return;
 
-  if (new_request)
-  {
-    pending_requests.push_back(new_request);
-    id = new_request->id();
-  }
+  const auto metrics = phase_metrics->collect();
+  if (metrics.empty())
+    return;
 
-  for (const auto& t : task_managers)
-  {
-    states.push_back(t.second->expected_finish_state());
-    const auto requests = t.second->requests();
-    pending_requests.insert(
-      pending_requests.end(), requests.begin(), requests.end());
-  }
+  if (phase_metrics_cb)
+    phase_metrics_cb(metrics);
 
-  // Remove the request to be ignored if present
-  if (ignore_request)
+  if (phase_metrics_pub)
   {
-    auto ignore_request_it = pending_requests.end();
-    for (auto it = pending_requests.begin(); it != pending_requests.end(); ++it)
-    {
-      auto pending_request = *it;
-      if (pending_request->id() == ignore_request->id())
-        ignore_request_it = it;
-    }
-    if (ignore_request_it != pending_requests.end())
-    {
-      pending_requests.erase(ignore_request_it);
-      RCLCPP_INFO(
-        node->get_logger(),
-        "Request with task_id:[%s] will be ignored during task allocation.",
-        ignore_request->id().c_str());
-    }
-    else
-    {
-      RCLCPP_WARN(
-        node->get_logger(),
-        "Request with task_id:[%s] is not present in any of the task queues.",
-        ignore_request->id().c_str());
-    }
-  }
+    YAML::Node histograms(YAML::NodeType::Sequence);
+    for (const auto& m : metrics)
+      histograms.push_back(serialize(m));
 
-  RCLCPP_INFO(
-    node->get_logger(),
-    "Planning for [%ld] robot(s) and [%ld] request(s)",
-    states.size(),
-    pending_requests.size());
+    YAML::Node node;
+    node["fleet"] = name;
+    node["histograms"] = histograms;
 
-  // Generate new task assignments
-  const auto result = task_planner->plan(
-    rmf_traffic_ros2::convert(node->now()),
-    states,
-    pending_requests);
+    YAML::Emitter emitter;
+    emitter << node;
 
-  auto assignments_ptr = std::get_if<
-    rmf_task::agv::TaskPlanner::Assignments>(&result);
+    PhaseMetricsMsg msg;
+    msg.data = emitter.c_str();
+    phase_metrics_pub->publish(msg);
+  }
+}
 
-  if (!assignments_ptr)
-  {
-    auto error = std::get_if<
-      rmf_task::agv::TaskPlanner::TaskPlannerError>(&result);
+//==============================================================================
+FleetUpdateHandle::Implementation::Instruments::Instruments(
+  rmf_traffic_ros2::Metrics& metrics,
+  const std::string& fleet)
+: bid_notices(metrics.counter(
+      "rmf_fleet_bid_notices",
+      "BidNotices that the fleet has planned a bid for",
+      {{"fleet", fleet}})),
+  bid_proposals(metrics.counter(
+      "rmf_fleet_bid_proposals",
+      "BidProposals that the fleet has submitted",
+      {{"fleet", fleet}})),
+  tasks_awarded(metrics.counter(
+      "rmf_fleet_tasks_awarded",
+      "Tasks that were dispatched to the fleet and added to its queues",
+      {{"fleet", fleet}})),
+  tasks_cancelled(metrics.counter(
+      "rmf_fleet_tasks_cancelled",
+      "Queued tasks that were cancelled",
+      {{"fleet", fleet}})),
+  notice_to_proposal_seconds(metrics.histogram(
+      "rmf_fleet_bid_seconds",
+      "How long the fleet took from a BidNotice to its BidProposal",
+      {{"fleet", fleet}})),
+  allocation_queue_seconds(metrics.histogram(
+      "rmf_fleet_allocation_queue_seconds",
+      "How long task allocations waited for a planning slot",
+      {{"fleet", fleet}})),
+  allocation_planning_seconds(metrics.histogram(
+      "rmf_fleet_allocation_planning_seconds",
+      "How long task allocations took to plan",
+      {{"fleet", fleet}})),
+  queued_tasks(metrics.gauge(
+      "rmf_fleet_queued_tasks",
+      "Tasks in the queues of the robots of the fleet",
+      {{"fleet", fleet}})),
+  assignment_cost(metrics.gauge(
+      "rmf_fleet_assignment_cost",
+      "The cost of the current assignments of the fleet",
+      {{"fleet", fleet}}))
+{
+  // Do nothing
+}
 
-    if (*error == rmf_task::agv::TaskPlanner::TaskPlannerError::low_battery)
+//==============================================================================
+void FleetUpdateHandle::Implementation::publish_memory_usage(
+  rmf_traffic_ros2::MemoryUsage usage)
+{
+  using rmf_traffic_ros2::memory::heap_bytes;
+  const auto key_bytes = [](const auto& element)
     {
-      RCLCPP_ERROR(
-        node->get_logger(),
-        "[TaskPlanner] Failed to compute assignments for task_id:[%s] due to"
-        " insufficient initial battery charge for all robots in this fleet.",
-        id.c_str());
-    }
+      return heap_bytes(element.first);
+    };
 
-    else if (*error ==
-      rmf_task::agv::TaskPlanner::TaskPlannerError::limited_capacity)
+  const auto id_bytes = [](const std::string& id)
     {
-      RCLCPP_ERROR(
-        node->get_logger(),
-        "[TaskPlanner] Failed to compute assignments for task_id:[%s] due to"
-        " insufficient battery capacity to accommodate one or more requests by"
-        " any of the robots in this fleet.", id.c_str());
-    }
+      return heap_bytes(id);
+    };
+
+  const std::string prefix = "fleet." + name + ".";
+  usage.add(
+    prefix + "bid_notice_assignments",
+    bid_notice_assignments.size(),
+    heap_bytes(
+      bid_notice_assignments,
+      [](const auto& element)
+      {
+        return heap_bytes(element.first)
+        + heap_bytes(
+          element.second,
+          [](const auto& queue) { return heap_bytes(queue); });
+      })
+    + heap_bytes(bid_notice_versions, key_bytes));
+
+  usage.add(
+    prefix + "generated_requests",
+    generated_requests.size(),
+    heap_bytes(generated_requests, key_bytes));
+
+  usage.add(
+    prefix + "assigned_requests",
+    assigned_requests.size(),
+    heap_bytes(assigned_requests, key_bytes));
+
+  usage.add(
+    prefix + "task_profiles",
+    task_profile_map.size(),
+    heap_bytes(
+      task_profile_map,
+      [](const auto& element)
+      {
+        return heap_bytes(element.first) + heap_bytes(element.second.task_id);
+      }));
+
+  usage.add(
+    prefix + "cancelled_task_ids",
+    cancelled_task_ids.size(),
+    heap_bytes(cancelled_task_ids, key_bytes));
+
+  usage.add(
+    prefix + "task_received",
+    task_received.size(),
+    heap_bytes(task_received, key_bytes));
+
+  usage.add(
+    prefix + "bid_times",
+    bid_notice_times.size() + bid_deadlines.size(),
+    heap_bytes(bid_notice_times, key_bytes)
+    + heap_bytes(bid_deadlines, key_bytes));
+
+  usage.add(
+    prefix + "bid_bundle",
+    bid_bundle.size() + bundled_bids.size(),
+    heap_bytes(bid_bundle) + heap_bytes(bundled_bids, id_bytes));
+
+  usage.add(
+    prefix + "open_bids",
+    open_bids.size(),
+    heap_bytes(open_bids, key_bytes));
+
+  usage.add(
+    prefix + "deferred_dispatches",
+    deferred_dispatches.size() + allocation_jobs.size(),
+    heap_bytes(deferred_dispatches, key_bytes)
+    + heap_bytes(allocation_jobs, key_bytes));
+
+  usage.add(
+    prefix + "published_robot_states",
+    published_robot_states.size(),
+    heap_bytes(published_robot_states, key_bytes));
+
+  usage.add(
+    prefix + "persisted_state",
+    last_persisted.size(),
+    heap_bytes(last_persisted));
+
+  std::size_t queued = 0;
+  for (const auto& [context, manager] : task_managers)
+    queued += manager->requests().size();
+
+  usage.add(
+    prefix + "task_queues",
+    queued,
+    queued * sizeof(rmf_task::ConstRequestPtr));
+
+  MemoryUsageMsg msg;
+  msg.data = rmf_traffic_ros2::serialize(
+    usage, node->get_fully_qualified_name());
+  memory_usage_pub->publish(msg);
+}
 
-    else
+//==============================================================================
+void FleetUpdateHandle::Implementation::start_expiry_timer()
+{
+  // Checking a few times per lifetime keeps the bookkeeping of expired tasks
+  // from lingering for much longer than the lifetime itself
+  const auto period = std::max<rmf_traffic::Duration>(
+    bid_lifetime / 10, std::chrono::seconds(1));
+
+  expiry_timer = node->try_create_wall_timer(
+    period,
+    [w = weak_self]()
     {
-      RCLCPP_ERROR(
-        node->get_logger(),
-        "[TaskPlanner] Failed to compute assignments for task_id:[%s]",
-        id.c_str());
-    }
+      if (const auto self = w.lock())
+      {
+        self->_pimpl->worker.schedule(
+          [w](const auto&)
+          {
+            if (const auto self = w.lock())
+              self->_pimpl->expire_tasks();
+          });
+      }
+    });
+}
 
-    return std::nullopt;
+//==============================================================================
+void FleetUpdateHandle::Implementation::expire_tasks()
+{
+  const auto now = std::chrono::steady_clock::now();
+  for (auto it = cancelled_task_ids.begin(); it != cancelled_task_ids.end(); )
+  {
+    if (it->second + bid_lifetime < now)
+      it = cancelled_task_ids.erase(it);
+    else
+      ++it;
   }
 
-  const auto assignments = *assignments_ptr;
-
-  if (assignments.empty())
+  std::unordered_set<std::string> queued;
+  for (const auto& [context, manager] : task_managers)
   {
-    RCLCPP_ERROR(
-      node->get_logger(),
-      "[TaskPlanner] Failed to compute assignments for task_id:[%s]",
-      id.c_str());
+    for (const auto& request : manager->requests())
+      queued.insert(request->id());
+  }
 
-    return std::nullopt;
+  const auto in_use = [&](const std::string& id)
+    {
+      return allocation_jobs.count(id)
+        || bundled_bids.count(id)
+        || deferred_dispatches.count(id)
+        || queued.count(id)
+        || started_tasks->contains(id);
+    };
+
+  std::vector<std::string> expired;
+  for (const auto& [id, received] : task_received)
+  {
+    if (received + bid_lifetime < now && !in_use(id))
+      expired.push_back(id);
   }
 
-  return assignments;
+  for (const auto& id : expired)
+    forget_task(id);
 }
 
 //==============================================================================
-void FleetUpdateHandle::add_robot(
-  std::shared_ptr<RobotCommandHandle> command,
-  const std::string& name,
-  const rmf_traffic::Profile& profile,
-  rmf_traffic::agv::Plan::StartSet start,
-  std::function<void(std::shared_ptr<RobotUpdateHandle>)> handle_cb)
+void FleetUpdateHandle::Implementation::forget_task(const std::string& id)
 {
+  generated_requests.erase(id);
+  assigned_requests.erase(id);
+  task_profile_map.erase(id);
+  bid_notice_assignments.erase(id);
+  bid_notice_versions.erase(id);
+  bid_notice_times.erase(id);
+  bid_deadlines.erase(id);
+  open_bids.erase(id);
+  task_received.erase(id);
+}
 
-  if (start.empty())
-  {
-    // *INDENT-OFF*
-    throw std::runtime_error(
-      "[FleetUpdateHandle::add_robot] StartSet is empty. Adding a robot to a "
-      "fleet requires at least one rmf_traffic::agv::Plan::Start to be "
-      "specified.");
-    // *INDENT-ON*
-  }
+//==============================================================================
+void FleetUpdateHandle::Implementation::persist_state()
+{
+  if (!persist_file.has_value())
+    return;
 
-  rmf_traffic::schedule::ParticipantDescription description(
-    name,
-    _pimpl->name,
-    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
-    profile);
+  FleetSnapshot snapshot;
+  snapshot.fleet_name = name;
 
-  _pimpl->writer->async_make_participant(
-    std::move(description),
-    [worker = _pimpl->worker,
-    command = std::move(command),
-    start = std::move(start),
-    handle_cb = std::move(handle_cb),
-    fleet = shared_from_this()](
-      rmf_traffic::schedule::Participant participant)
+  const auto keep_profile = [&](const std::string& id)
     {
-      const auto charger_wp = fleet->_pimpl->get_nearest_charger(start[0]);
-
-      if (!charger_wp.has_value())
-      {
-        // *INDENT-OFF*
-        throw std::runtime_error(
-          "[FleetUpdateHandle::add_robot] Unable to find nearest charging "
-          "waypoint. Adding a robot to a fleet requires at least one charging"
-          "waypoint to be present in its navigation graph.");
-        // *INDENT-ON*
-      }
-
-      rmf_task::agv::State state = rmf_task::agv::State{
-        start[0], charger_wp.value(), 1.0};
-      auto context = std::make_shared<RobotContext>(
-        RobotContext{
-          std::move(command),
-          std::move(start),
-          std::move(participant),
-          fleet->_pimpl->snappable,
-          fleet->_pimpl->planner,
-          fleet->_pimpl->node,
-          fleet->_pimpl->worker,
-          fleet->_pimpl->default_maximum_delay,
-          state,
-          fleet->_pimpl->task_planner
-        });
-
-      // We schedule the following operations on the worker to make sure we do not
-      // have a multiple read/write race condition on the FleetUpdateHandle.
-      worker.schedule(
-        [context, fleet, node = fleet->_pimpl->node,
-        handle_cb = std::move(handle_cb)](const auto&)
-        {
-          // TODO(MXG): We need to perform this test because we do not currently
-          // support the distributed negotiation in unit test environments. We
-          // should create an abstract NegotiationRoom interface in rmf_traffic and
-          // use that instead.
-          if (fleet->_pimpl->negotiation)
-          {
-            using namespace std::chrono_literals;
-            auto last_interrupt_time =
-            std::make_shared<std::optional<rmf_traffic::Time>>(std::nullopt);
-
-            context->_negotiation_license =
-            fleet->_pimpl->negotiation
-            ->register_negotiator(
-              context->itinerary().id(),
-              std::make_unique<LiaisonNegotiator>(context),
-              [w = std::weak_ptr<RobotContext>(context), last_interrupt_time]()
-              {
-                if (const auto c = w.lock())
-                {
-                  auto& last_time = *last_interrupt_time;
-                  const auto now = std::chrono::steady_clock::now();
-                  if (last_time.has_value())
-                  {
-                    if (now < *last_time + 10s)
-                      return;
-                  }
-
-                  last_time = now;
-                  c->trigger_interrupt();
-                }
-              });
-          }
-
-          RCLCPP_INFO(
-            node->get_logger(),
-            "Added a robot named [%s] with participant ID [%ld]",
-            context->name().c_str(),
-            context->itinerary().id());
+      const auto it = task_profile_map.find(id);
+      if (it != task_profile_map.end())
+        snapshot.task_profiles.insert(*it);
+    };
 
-          if (handle_cb)
-          {
-            handle_cb(RobotUpdateHandle::Implementation::make(std::move(context)));
-          }
-          else
-          {
-            RCLCPP_WARN(
-              node->get_logger(),
-              "FleetUpdateHandle::add_robot(~) was not provided a callback to "
-              "receive the RobotUpdateHandle of the new robot. This means you will "
-              "not be able to update the state of the new robot. This is likely to "
-              "be a fleet adapter development error.");
-            return;
-          }
+  for (const auto& [context, manager] : task_managers)
+  {
+    FleetSnapshot::Robot robot{context->name(), {}};
+    for (const auto& request : manager->requests())
+    {
+      robot.queue.push_back(request->id());
+      keep_profile(request->id());
+    }
 
-          fleet->_pimpl->task_managers.insert({context,
-            TaskManager::make(context)});
-        });
-    });
-}
+    snapshot.robots.emplace_back(std::move(robot));
+  }
 
-//==============================================================================
-void FleetUpdateHandle::close_lanes(std::vector<std::size_t> lane_indices)
-{
-  _pimpl->worker.schedule(
-    [w = weak_from_this(), lane_indices = std::move(lane_indices)](const auto&)
+  const auto now = std::chrono::steady_clock::now();
+  for (auto it = open_bids.begin(); it != open_bids.end(); )
+  {
+    if (it->second + bid_lifetime < now)
     {
-      const auto self = w.lock();
-      if (!self)
-        return;
+      it = open_bids.erase(it);
+      continue;
+    }
 
-      const auto& current_lane_closures =
-      (*self->_pimpl->planner)->get_configuration().lane_closures();
+    snapshot.bids.push_back(it->first);
+    keep_profile(it->first);
+    ++it;
+  }
 
-      bool any_changes = false;
-      for (const auto& lane : lane_indices)
+  {
+    // Robots that have not been added again since the restart keep the
+    // queues that were saved for them.
+    std::lock_guard<std::mutex> lock(warm_start_mutex);
+    if (warm_start.has_value())
+    {
+      for (const auto& robot : warm_start->robots)
       {
-        if (current_lane_closures.is_open(lane))
+        snapshot.robots.push_back(robot);
+        for (const auto& id : robot.queue)
         {
-          any_changes = true;
-          break;
+          const auto it = warm_start->task_profiles.find(id);
+          if (it != warm_start->task_profiles.end())
+            snapshot.task_profiles.insert(*it);
         }
       }
+    }
+  }
 
-      if (!any_changes)
-      {
-        // No changes are needed to the planner
-        return;
-      }
+  // Keep the order stable so that an unchanged state gives the same bytes
+  std::sort(snapshot.robots.begin(), snapshot.robots.end(),
+    [](const auto& a, const auto& b) { return a.name < b.name; });
+  std::sort(snapshot.bids.begin(), snapshot.bids.end());
 
-      auto new_config = (*self->_pimpl->planner)->get_configuration();
-      auto& new_lane_closures = new_config.lane_closures();
-      for (const auto& lane : lane_indices)
-        new_lane_closures.close(lane);
+  auto encoded = encode_fleet_snapshot(snapshot);
+  if (encoded == last_persisted)
+    return;
 
-      *self->_pimpl->planner =
-      std::make_shared<const rmf_traffic::agv::Planner>(
-        new_config, rmf_traffic::agv::Planner::Options(nullptr));
-    });
+  try
+  {
+    write_fleet_snapshot(*persist_file, encoded);
+    last_persisted = std::move(encoded);
+  }
+  catch (const std::exception& e)
+  {
+    RCLCPP_ERROR(
+      node->get_logger(),
+      "Failed to save the state of fleet [%s]: %s",
+      name.c_str(), e.what());
+  }
 }
 
 //==============================================================================
-void FleetUpdateHandle::open_lanes(std::vector<std::size_t> lane_indices)
+void FleetUpdateHandle::Implementation::begin_warm_start(
+  FleetSnapshot snapshot)
 {
-  _pimpl->worker.schedule(
-    [w = weak_from_this(), lane_indices = std::move(lane_indices)](const auto&)
+  // Bring back the bids that were still waiting to be awarded. Their
+  // assignments are left empty, so they will be planned again if they are
+  // dispatched to this fleet.
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto& id : snapshot.bids)
+  {
+    const auto p_it = snapshot.task_profiles.find(id);
+    if (p_it == snapshot.task_profiles.end())
+      continue;
+
+    const auto request = make_request(p_it->second);
+    if (!request)
+      continue;
+
+    generated_requests.insert({id, request});
+    task_profile_map.insert(*p_it);
+    bid_notice_assignments.insert({id, Assignments()});
+    open_bids[id] = now;
+    task_received[id] = now;
+  }
+
+  RCLCPP_INFO(
+    node->get_logger(),
+    "Restoring the state of fleet [%s] with %lu robots and %lu open bids",
+    name.c_str(), snapshot.robots.size(), snapshot.bids.size());
+
+  if (snapshot.robots.empty())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(warm_start_mutex);
+    warm_start = std::move(snapshot);
+  }
+
+  // Robots that do not come back within the grace period lose their saved
+  // queues so that bidding can resume.
+  warm_start_timer = node->try_create_wall_timer(
+    std::chrono::seconds(30),
+    [w = weak_self]()
     {
       const auto self = w.lock();
       if (!self)
         return;
 
-      const auto& current_lane_closures =
-      (*self->_pimpl->planner)->get_configuration().lane_closures();
-
-      bool any_changes = false;
-      for (const auto& lane : lane_indices)
-      {
-        if (current_lane_closures.is_closed(lane))
+      self->_pimpl->warm_start_timer->cancel();
+      self->_pimpl->worker.schedule(
+        [w](const auto&)
         {
-          any_changes = true;
-          break;
-        }
-      }
+          if (const auto self = w.lock())
+            self->_pimpl->finish_warm_start();
+        });
+    });
 
-      if (!any_changes)
-      {
-        // No changes are needed to the planner
+  // Any robots that were added before the state was loaded get their queues
+  // back right away.
+  worker.schedule(
+    [w = weak_self](const auto&)
+    {
+      const auto self = w.lock();
+      if (!self)
         return;
-      }
-
-      auto new_config = (*self->_pimpl->planner)->get_configuration();
-      auto& new_lane_closures = new_config.lane_closures();
-      for (const auto& lane : lane_indices)
-        new_lane_closures.open(lane);
 
-      *self->_pimpl->planner =
-      std::make_shared<const rmf_traffic::agv::Planner>(
-        new_config, rmf_traffic::agv::Planner::Options(nullptr));
+      for (const auto& [context, manager] : self->_pimpl->task_managers)
+        self->_pimpl->restore_robot(manager);
     });
 }
 
 //==============================================================================
-FleetUpdateHandle& FleetUpdateHandle::accept_task_requests(
-  AcceptTaskRequest check)
+void FleetUpdateHandle::Implementation::restore_robot(
+  const TaskManagerPtr& manager)
+{
+  const auto& context = manager->context();
+  FleetSnapshot::Robot robot;
+  std::unordered_map<std::string, TaskProfileMsg> profiles;
+  bool finished = false;
+  {
+    std::lock_guard<std::mutex> lock(warm_start_mutex);
+    if (!warm_start.has_value())
+      return;
+
+    auto& robots = warm_start->robots;
+    const auto r_it = std::find_if(robots.begin(), robots.end(),
+        [&](const auto& r) { return r.name == context->name(); });
+    if (r_it == robots.end())
+      return;
+
+    robot = std::move(*r_it);
+    robots.erase(r_it);
+    for (const auto& id : robot.queue)
+    {
+      const auto it = warm_start->task_profiles.find(id);
+      if (it != warm_start->task_profiles.end())
+        profiles.insert(*it);
+    }
+
+    finished = robots.empty();
+  }
+
+  if (!task_planner)
+  {
+    RCLCPP_WARN(
+      node->get_logger(),
+      "Unable to restore the queue of robot [%s] because fleet [%s] has no "
+      "task planner. Use FleetUpdateHandle::set_task_planner_params(~) "
+      "before FleetUpdateHandle::persist_state(~).",
+      context->name().c_str(), name.c_str());
+  }
+  else
+  {
+    // The saved queue is estimated again in its original order from the
+    // current state of the robot, instead of being replanned.
+    auto state = context->current_task_end_state();
+    std::vector<TaskManager::Assignment> queue;
+    for (const auto& id : robot.queue)
+    {
+      const auto p_it = profiles.find(id);
+      const auto request =
+        p_it == profiles.end() ? nullptr : make_request(p_it->second);
+      if (!request || !append_assignment(*task_planner, request, state, queue))
+      {
+        RCLCPP_WARN(
+          node->get_logger(),
+          "Unable to restore task [%s] to the queue of robot [%s]",
+          id.c_str(), context->name().c_str());
+        continue;
+      }
+
+      assigned_requests[id] = request;
+      task_profile_map[id] = p_it->second;
+      task_received[id] = std::chrono::steady_clock::now();
+    }
+
+    if (!queue.empty())
+    {
+      manager->set_queue(queue, task_profile_map);
+      ++assignments_version;
+    }
+
+    RCLCPP_INFO(
+      node->get_logger(),
+      "Restored %lu tasks to the queue of robot [%s]",
+      queue.size(), context->name().c_str());
+  }
+
+  if (finished)
+    finish_warm_start();
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::finish_warm_start()
+{
+  std::vector<BidNotice::SharedPtr> bids;
+  {
+    std::lock_guard<std::mutex> lock(warm_start_mutex);
+    if (!warm_start.has_value())
+      return;
+
+    warm_start = std::nullopt;
+    std::swap(bids, warm_start_bids);
+  }
+
+  warm_start_timer = nullptr;
+  for (const auto& bid : bids)
+    bid_notice_cb(bid);
+}
+
+//==============================================================================
+std::shared_ptr<RobotContext>
+FleetUpdateHandle::Implementation::make_robot_context(
+  std::shared_ptr<RobotCommandHandle> command,
+  rmf_traffic::agv::Plan::StartSet start,
+  rmf_traffic::schedule::Participant participant)
+{
+  const auto charger_wp = get_nearest_charger(start[0]);
+
+  if (!charger_wp.has_value())
+  {
+    // *INDENT-OFF*
+    throw std::runtime_error(
+      "[FleetUpdateHandle::add_robot] Unable to find nearest charging "
+      "waypoint. Adding a robot to a fleet requires at least one charging"
+      "waypoint to be present in its navigation graph.");
+    // *INDENT-ON*
+  }
+
+  rmf_task::agv::State state = rmf_task::agv::State{
+    start[0], charger_wp.value(), 1.0};
+  auto context = std::make_shared<RobotContext>(
+    RobotContext{
+      std::move(command),
+      std::move(start),
+      std::move(participant),
+      snappable,
+      planner,
+      node,
+      worker,
+      default_maximum_delay,
+      state,
+      task_planner
+    });
+
+  context->negotiation_admission(negotiation_admission);
+  context->negotiation_arena(negotiation_arena);
+  context->plan_cache(plan_cache);
+  context->pullover_candidates(pullover_candidates);
+  context->plan_start_index(plan_start_index);
+  context->phase_lookahead(phase_lookahead);
+  context->predictive_door_requests(predictive_door_requests);
+  context->door_opening_times(door_opening_times);
+  context->predictive_lift_requests(predictive_lift_requests);
+  context->lift_arrival_times(lift_arrival_times);
+  context->dispenser_lead_time(dispenser_lead_time);
+  context->delay_reporter(delay_reporter);
+  context->phase_metrics(phase_metrics);
+  context->started_tasks(started_tasks);
+  context->charger_index(charger_index);
+
+  return context;
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::onboard_robot(
+  std::shared_ptr<RobotContext> context,
+  std::function<void(std::shared_ptr<RobotUpdateHandle>)> handle_cb)
+{
+  // TODO(MXG): We need to perform this test because we do not currently
+  // support the distributed negotiation in unit test environments. We
+  // should create an abstract NegotiationRoom interface in rmf_traffic and
+  // use that instead.
+  if (negotiation)
+  {
+    using namespace std::chrono_literals;
+    auto last_interrupt_time =
+      std::make_shared<std::optional<rmf_traffic::Time>>(std::nullopt);
+
+    context->_negotiation_license =
+      negotiation
+      ->register_negotiator(
+      context->itinerary().id(),
+      std::make_unique<LiaisonNegotiator>(context),
+      [w = std::weak_ptr<RobotContext>(context), last_interrupt_time]()
+      {
+        if (const auto c = w.lock())
+        {
+          auto& last_time = *last_interrupt_time;
+          const auto now = std::chrono::steady_clock::now();
+          if (last_time.has_value())
+          {
+            if (now < *last_time + 10s)
+              return;
+          }
+
+          last_time = now;
+          c->trigger_interrupt();
+        }
+      });
+  }
+
+  RCLCPP_INFO(
+    node->get_logger(),
+    "Added a robot named [%s] with participant ID [%ld]",
+    context->name().c_str(),
+    context->itinerary().id());
+
+  if (handle_cb)
+  {
+    handle_cb(RobotUpdateHandle::Implementation::make(context));
+  }
+  else
+  {
+    RCLCPP_WARN(
+      node->get_logger(),
+      "FleetUpdateHandle::add_robot(~) was not provided a callback to "
+      "receive the RobotUpdateHandle of the new robot. This means you will "
+      "not be able to update the state of the new robot. This is likely to "
+      "be a fleet adapter development error.");
+    return;
+  }
+
+  const auto manager = TaskManager::make(context, deadline_timer);
+  task_managers.insert({context, manager});
+  restore_robot(manager);
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::set_assignments(
+  const Assignments& assignments)
+{
+  std::size_t index = 0;
+  for (auto& t : task_managers)
+  {
+    t.second->set_queue(assignments[index], task_profile_map);
+    ++index;
+  }
+
+  current_assignment_cost = task_planner->compute_cost(assignments);
+  ++assignments_version;
+
+  std::size_t queued = 0;
+  for (const auto& queue : assignments)
+    queued += queue.size();
+
+  instruments->queued_tasks->set(static_cast<double>(queued));
+  instruments->assignment_cost->set(current_assignment_cost);
+}
+
+//==============================================================================
+auto FleetUpdateHandle::Implementation::current_assignments() const
+-> Assignments
+{
+  Assignments assignments;
+  for (const auto& t : task_managers)
+    assignments.push_back(t.second->assignments());
+
+  return assignments;
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::async_allocate_tasks(
+  const std::string& key,
+  rmf_task::ConstRequestPtr new_request,
+  rmf_task::ConstRequestPtr ignore_request,
+  AllocationCallback on_result,
+  bool speculative)
+{
+  cancel_allocation(key);
+
+  auto input = collect_allocation_input(new_request, ignore_request);
+  if (speculative && new_request)
+  {
+    const auto deadline = bid_deadlines.find(new_request->id());
+    if (deadline != bid_deadlines.end())
+      input.deadline = deadline->second;
+  }
+
+  AllocationJob job{
+    key,
+    std::move(new_request),
+    std::move(ignore_request),
+    std::move(on_result),
+    speculative,
+    assignments_version,
+    make_cache_key(input),
+    std::make_shared<std::atomic_bool>(false)
+  };
+
+  job.urgent =
+    speculative && job.new_request && is_high_priority(job.new_request->id());
+
+  using Kind = AllocationMetrics::Kind;
+  auto& metrics = job.metrics;
+  if (job.new_request)
+  {
+    metrics.kind = speculative ? Kind::Bid : Kind::Dispatch;
+    metrics.task_id = job.new_request->id();
+  }
+  else if (job.ignore_request)
+  {
+    metrics.kind = Kind::Cancel;
+    metrics.task_id = job.ignore_request->id();
+  }
+  else
+  {
+    metrics.kind = Kind::Optimization;
+  }
+
+  start_allocation(std::move(input), std::move(job));
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::async_allocate_bundle(
+  const std::string& key,
+  const std::vector<rmf_task::ConstRequestPtr>& new_requests,
+  AllocationCallback on_result)
+{
+  cancel_allocation(key);
+
+  // The bundle is always planned together with every queued request, since
+  // inserting the requests one at a time would make the result depend on
+  // their order.
+  auto input = collect_allocation_input(nullptr, nullptr);
+  input.pending_requests.insert(
+    input.pending_requests.begin(), new_requests.begin(), new_requests.end());
+  input.id = key;
+
+  // The bundle has to be planned in time for the earliest of its bids
+  for (const auto& request : new_requests)
+  {
+    const auto deadline = bid_deadlines.find(request->id());
+    if (deadline == bid_deadlines.end())
+      continue;
+
+    if (!input.deadline.has_value() || deadline->second < *input.deadline)
+      input.deadline = deadline->second;
+  }
+
+  AllocationJob job{
+    key,
+    nullptr,
+    nullptr,
+    std::move(on_result),
+    true,
+    assignments_version,
+    make_cache_key(input),
+    std::make_shared<std::atomic_bool>(false)
+  };
+  job.metrics.kind = AllocationMetrics::Kind::Bid;
+  job.metrics.task_id = key;
+
+  start_allocation(std::move(input), std::move(job));
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::start_allocation(
+  AllocationInput input,
+  AllocationJob job)
+{
+  allocation_jobs[job.key] = job.cancelled;
+  job.metrics.robots = input.states.size();
+  job.metrics.requests = input.pending_requests.size();
+  job.submitted = std::chrono::steady_clock::now();
+
+  if (auto cached = allocation_cache.get(job.cache_key))
+  {
+    RCLCPP_INFO(
+      node->get_logger(),
+      "Reusing the cached allocation for [%ld] robot(s) and [%ld] request(s)",
+      input.states.size(),
+      input.pending_requests.size());
+
+    // The result is still delivered asynchronously, the same as a planned
+    // result would be.
+    job.metrics.cached = true;
+    worker.schedule(
+      [w = weak_self, job = std::move(job), cached = std::move(cached)](
+        const auto&)
+      {
+        if (const auto self = w.lock())
+          self->_pimpl->finish_allocation(job, cached);
+      });
+    return;
+  }
+
+  auto& slot = choose_planning_slot(job.urgent);
+  input.task_planner = slot.planner;
+  input.cancelled = job.cancelled;
+
+  ++*slot.load;
+  slot.worker.schedule(
+    [w = weak_self, load = slot.load, input = std::move(input),
+    job = std::move(job)](const auto&)
+    {
+      const auto self = *job.cancelled ? nullptr : w.lock();
+      if (!self)
+      {
+        --*load;
+        return;
+      }
+
+      auto delivered = job;
+      const auto start = std::chrono::steady_clock::now();
+      delivered.metrics.queue_wait = start - job.submitted;
+
+      auto result = self->_pimpl->plan_allocation(input, delivered.metrics);
+      delivered.metrics.planning_duration =
+        std::chrono::steady_clock::now() - start;
+      --*load;
+
+      self->_pimpl->worker.schedule(
+        [w, job = std::move(delivered), result = std::move(result)](
+          const auto&)
+        {
+          const auto self = w.lock();
+          if (!self)
+            return;
+
+          auto& impl = *self->_pimpl;
+          // Greedy assignments are not cached since the same input may have
+          // more time to be planned optimally later.
+          if (result.has_value() && !job.metrics.greedy)
+            impl.allocation_cache.set(job.cache_key, *result);
+
+          impl.finish_allocation(job, result);
+        });
+    });
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::finish_allocation(
+  const AllocationJob& job,
+  const std::optional<Assignments>& result)
+{
+  const auto outcome = allocation_outcome(
+    *job.cancelled, job.speculative, job.version, assignments_version);
+
+  if (outcome == AllocationOutcome::Drop)
+    return;
+
+  if (outcome == AllocationOutcome::Replan)
+  {
+    // The queues were replaced while this was being planned, so the result no
+    // longer applies.
+    async_allocate_tasks(
+      job.key, job.new_request, job.ignore_request, job.on_result);
+    return;
+  }
+
+  allocation_jobs.erase(job.key);
+  job.on_result(result, job.version);
+  report_allocation(job, result);
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::report_allocation(
+  const AllocationJob& job,
+  const std::optional<Assignments>& result)
+{
+  auto metrics = job.metrics;
+  if (result.has_value())
+    metrics.cost = task_planner->compute_cost(*result);
+
+  if (metrics.kind == AllocationMetrics::Kind::Bid)
+  {
+    // The proposal has been published by now if the bid succeeded
+    const auto it = bid_notice_times.find(metrics.task_id);
+    if (it != bid_notice_times.end())
+    {
+      if (bid_notice_assignments.count(metrics.task_id))
+      {
+        metrics.notice_to_proposal =
+          std::chrono::steady_clock::now() - it->second;
+      }
+
+      bid_notice_times.erase(it);
+    }
+  }
+
+  instruments->allocation_queue_seconds->observe(metrics.queue_wait);
+  if (!metrics.cached)
+  {
+    instruments->allocation_planning_seconds->observe(
+      metrics.planning_duration);
+  }
+
+  if (metrics.notice_to_proposal.has_value())
+    instruments->notice_to_proposal_seconds->observe(
+      *metrics.notice_to_proposal);
+
+  if (!metrics.task_id.empty() && rmf_traffic_ros2::tracing::tracer())
+  {
+    using namespace rmf_traffic_ros2;
+    tracing::record(
+      "fleet.allocation", tracing::task(metrics.task_id),
+      metrics.queue_wait + metrics.planning_duration,
+      {{"rmf.fleet", name},
+        {"rmf.kind", to_string(metrics.kind)},
+        {"rmf.queue_wait_ms", std::to_string(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+              metrics.queue_wait).count())},
+        {"rmf.cached", metrics.cached ? "true" : "false"},
+        {"rmf.greedy", metrics.greedy ? "true" : "false"}});
+
+    if (metrics.notice_to_proposal.has_value())
+    {
+      tracing::record(
+        "fleet.bid", tracing::task(metrics.task_id),
+        *metrics.notice_to_proposal, {{"rmf.fleet", name}});
+    }
+  }
+
+  if (allocation_metrics_cb)
+    allocation_metrics_cb(metrics);
+
+  if (allocation_metrics_pub)
+  {
+    YAML::Emitter emitter;
+    emitter << serialize(name, metrics);
+
+    AllocationMetricsMsg msg;
+    msg.data = emitter.c_str();
+    allocation_metrics_pub->publish(msg);
+  }
+}
+
+//==============================================================================
+auto FleetUpdateHandle::Implementation::make_cache_key(
+  const AllocationInput& input) const -> AllocationCache::Key
+{
+  std::vector<std::string> requests;
+  if (!input.current_assignments.has_value())
+  {
+    for (const auto& r : input.pending_requests)
+      requests.push_back(r->id());
+
+    return allocation_cache.make_key(input.states, std::move(requests), false);
+  }
+
+  // An insertion or removal depends on how each queue is arranged, so the
+  // queues are listed in order, with an empty ID to mark the end of each one.
+  // They are preceded by the ID of the request that is being inserted or
+  // removed, marked by a + or a - respectively.
+  if (input.removed_request)
+    requests.push_back("-" + input.removed_request->id());
+  else
+    requests.push_back("+" + input.pending_requests.front()->id());
+
+  for (const auto& queue : *input.current_assignments)
+  {
+    for (const auto& a : queue)
+      requests.push_back(a.request()->id());
+
+    requests.push_back("");
+  }
+
+  return allocation_cache.make_key(input.states, std::move(requests), true);
+}
+
+//==============================================================================
+auto FleetUpdateHandle::Implementation::choose_planning_slot(bool urgent)
+-> PlanningSlot&
+{
+  const auto make_slot = []() -> PlanningSlot
+    {
+      return {
+        rxcpp::schedulers::make_event_loop().create_worker(),
+        nullptr,
+        nullptr,
+        std::make_shared<std::atomic_size_t>(0)
+      };
+    };
+
+  std::vector<std::size_t> loads;
+  loads.reserve(planning_slots.size());
+  for (const auto& slot : planning_slots)
+    loads.push_back(slot.load->load());
+
+  const auto index = agv::choose_planning_slot(
+    loads, max_concurrent_allocations);
+  if (index == planning_slots.size())
+    planning_slots.push_back(make_slot());
+
+  PlanningSlot* chosen = &planning_slots[index];
+  if (urgent)
+  {
+    std::optional<std::size_t> priority_load;
+    if (priority_slot.has_value())
+      priority_load = priority_slot->load->load();
+
+    if (use_priority_slot(chosen->load->load(), priority_load))
+    {
+      if (!priority_slot.has_value())
+        priority_slot = make_slot();
+
+      chosen = &*priority_slot;
+    }
+  }
+
+  if (chosen->source != task_planner)
+  {
+    chosen->planner = std::make_shared<rmf_task::agv::TaskPlanner>(
+      task_planner->configuration(),
+      rmf_task::agv::TaskPlanner::Options{false, nullptr, finishing_request});
+    chosen->source = task_planner;
+
+    // Start the copy off with the charger estimates that the robots have
+    // already made
+    charger_index->seed(*chosen->planner->estimate_cache());
+  }
+
+  return *chosen;
+}
+
+//==============================================================================
+bool FleetUpdateHandle::Implementation::is_high_priority(
+  const std::string& task_id) const
+{
+  const auto it = task_profile_map.find(task_id);
+  return it != task_profile_map.end()
+    && it->second.description.priority.value > 0;
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::cancel_allocation(
+  const std::string& key)
+{
+  const auto it = allocation_jobs.find(key);
+  if (it == allocation_jobs.end())
+    return;
+
+  *it->second = true;
+  allocation_jobs.erase(it);
+}
+
+//==============================================================================
+void FleetUpdateHandle::Implementation::optimize_assignments()
+{
+  bool any_requests = false;
+  for (const auto& t : task_managers)
+    any_requests = any_requests || !t.second->requests().empty();
+
+  if (!any_requests)
+    return;
+
+  async_allocate_tasks(
+    OptimizationKey, nullptr, nullptr,
+    [this](const std::optional<Assignments>& result, std::size_t)
+    {
+      if (!result.has_value())
+        return;
+
+      auto assignments = result.value();
+      if (!is_valid_assignments(assignments))
+        return;
+
+      const auto current = current_assignments();
+      if (!optimization_improves(*task_planner, current, assignments))
+        return;
+
+      const double current_cost = task_planner->compute_cost(current);
+      const double optimized_cost = task_planner->compute_cost(assignments);
+
+      set_assignments(assignments);
+      RCLCPP_INFO(
+        node->get_logger(),
+        "Optimized the assignments for robots in fleet [%s] from a cost of "
+        "[%f] down to [%f]",
+        name.c_str(), current_cost, optimized_cost);
+    });
+}
+
+//==============================================================================
+auto FleetUpdateHandle::Implementation::collect_allocation_input(
+  rmf_task::ConstRequestPtr new_request,
+  rmf_task::ConstRequestPtr ignore_request) const -> AllocationInput
+{
+  // Collate robot states, constraints and combine new requestptr with
+  // requestptr of non-charging tasks in task manager queues
+  AllocationInput input;
+  input.task_planner = task_planner;
+  input.estimation_threads = estimation_threads;
+  input.finishing_request = finishing_request;
+  auto& states = input.states;
+  auto& pending_requests = input.pending_requests;
+
+  if (new_request)
+  {
+    pending_requests.push_back(new_request);
+    input.id = new_request->id();
+
+    if (incremental_allocation && !ignore_request)
+      input.current_assignments = current_assignments();
+  }
+  else if (ignore_request && fast_cancellation)
+  {
+    input.current_assignments = current_assignments();
+    input.removed_request = ignore_request;
+  }
+
+  std::vector<const TaskManager*> managers;
+  managers.reserve(task_managers.size());
+  for (const auto& t : task_managers)
+  {
+    managers.push_back(t.second.get());
+    const auto requests = t.second->requests();
+    pending_requests.insert(
+      pending_requests.end(), requests.begin(), requests.end());
+  }
+
+  std::vector<std::optional<rmf_task::agv::State>> estimated(managers.size());
+  parallel_for(
+    managers.size(), estimation_threads, [&](const std::size_t i)
+    {
+      estimated[i] = managers[i]->expected_finish_state();
+    });
+
+  states.reserve(estimated.size());
+  for (auto& s : estimated)
+    states.push_back(std::move(*s));
+
+  // Remove the request to be ignored if present
+  if (ignore_request)
+  {
+    auto ignore_request_it = pending_requests.end();
+    for (auto it = pending_requests.begin(); it != pending_requests.end(); ++it)
+    {
+      auto pending_request = *it;
+      if (pending_request->id() == ignore_request->id())
+        ignore_request_it = it;
+    }
+    if (ignore_request_it != pending_requests.end())
+    {
+      pending_requests.erase(ignore_request_it);
+      RCLCPP_INFO(
+        node->get_logger(),
+        "Request with task_id:[%s] will be ignored during task allocation.",
+        ignore_request->id().c_str());
+    }
+    else
+    {
+      RCLCPP_WARN(
+        node->get_logger(),
+        "Request with task_id:[%s] is not present in any of the task queues.",
+        ignore_request->id().c_str());
+    }
+  }
+
+  return input;
+}
+
+//==============================================================================
+auto FleetUpdateHandle::Implementation::plan_allocation(
+  const AllocationInput& input,
+  AllocationMetrics& metrics) const -> std::optional<Assignments>
+{
+  const auto& id = input.id;
+  if (input.removed_request)
+  {
+    auto removed = plan_removal(
+      *input.task_planner, input.states, input.current_assignments.value(),
+      input.removed_request->id());
+    if (removed.has_value())
+    {
+      RCLCPP_INFO(
+        node->get_logger(),
+        "Removed request [%s] from the current queues",
+        input.removed_request->id().c_str());
+      return removed;
+    }
+
+    RCLCPP_INFO(
+      node->get_logger(),
+      "Unable to repair the current queues without request [%s], so every "
+      "queued request will be replanned",
+      input.removed_request->id().c_str());
+  }
+  else if (input.current_assignments.has_value())
+  {
+    auto inserted = plan_insertion(
+      *input.task_planner, input.states, input.current_assignments.value(),
+      input.pending_requests.front(), input.estimation_threads);
+    if (inserted.has_value())
+    {
+      RCLCPP_INFO(
+        node->get_logger(),
+        "Inserted request [%s] into the queues of [%ld] robot(s)",
+        id.c_str(),
+        input.states.size());
+      return inserted;
+    }
+
+    RCLCPP_INFO(
+      node->get_logger(),
+      "Unable to insert request [%s] into the current queues, so every "
+      "queued request will be replanned",
+      id.c_str());
+  }
+
+  RCLCPP_INFO(
+    node->get_logger(),
+    "Planning for [%ld] robot(s) and [%ld] request(s)",
+    input.states.size(),
+    input.pending_requests.size());
+
+  // Generate new task assignments
+  using TaskPlanner = rmf_task::agv::TaskPlanner;
+  const auto time_now = rmf_traffic_ros2::convert(node->now());
+  bool greedy = false;
+  const auto result = plan_before_deadline(
+    [&](const TaskPlanner::Options& options)
+    {
+      return input.task_planner->plan(
+        time_now, input.states, input.pending_requests, options);
+    },
+    input.deadline, input.finishing_request, greedy,
+    [cancelled = input.cancelled]()
+    {
+      return cancelled && cancelled->load();
+    });
+
+  if (input.cancelled && *input.cancelled)
+    return std::nullopt;
+
+  if (greedy)
+  {
+    RCLCPP_WARN(
+      node->get_logger(),
+      "Ran out of time to plan the optimal assignments for [%s], so greedy "
+      "assignments will be used instead",
+      id.c_str());
+
+    metrics.greedy = true;
+  }
+
+  auto assignments_ptr = std::get_if<
+    rmf_task::agv::TaskPlanner::Assignments>(&result);
+
+  if (!assignments_ptr)
+  {
+    auto error = std::get_if<
+      rmf_task::agv::TaskPlanner::TaskPlannerError>(&result);
+
+    if (*error == rmf_task::agv::TaskPlanner::TaskPlannerError::low_battery)
+    {
+      RCLCPP_ERROR(
+        node->get_logger(),
+        "[TaskPlanner] Failed to compute assignments for task_id:[%s] due to"
+        " insufficient initial battery charge for all robots in this fleet.",
+        id.c_str());
+    }
+
+    else if (*error ==
+      rmf_task::agv::TaskPlanner::TaskPlannerError::limited_capacity)
+    {
+      RCLCPP_ERROR(
+        node->get_logger(),
+        "[TaskPlanner] Failed to compute assignments for task_id:[%s] due to"
+        " insufficient battery capacity to accommodate one or more requests by"
+        " any of the robots in this fleet.", id.c_str());
+    }
+
+    else
+    {
+      RCLCPP_ERROR(
+        node->get_logger(),
+        "[TaskPlanner] Failed to compute assignments for task_id:[%s]",
+        id.c_str());
+    }
+
+    return std::nullopt;
+  }
+
+  const auto assignments = *assignments_ptr;
+
+  if (assignments.empty())
+  {
+    RCLCPP_ERROR(
+      node->get_logger(),
+      "[TaskPlanner] Failed to compute assignments for task_id:[%s]",
+      id.c_str());
+
+    return std::nullopt;
+  }
+
+  return assignments;
+}
+
+//==============================================================================
+void FleetUpdateHandle::add_robot(
+  std::shared_ptr<RobotCommandHandle> command,
+  const std::string& name,
+  const rmf_traffic::Profile& profile,
+  rmf_traffic::agv::Plan::StartSet start,
+  std::function<void(std::shared_ptr<RobotUpdateHandle>)> handle_cb)
+{
+
+  if (start.empty())
+  {
+    // *INDENT-OFF*
+    throw std::runtime_error(
+      "[FleetUpdateHandle::add_robot] StartSet is empty. Adding a robot to a "
+      "fleet requires at least one rmf_traffic::agv::Plan::Start to be "
+      "specified.");
+    // *INDENT-ON*
+  }
+
+  rmf_traffic::schedule::ParticipantDescription description(
+    name,
+    _pimpl->name,
+    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+    profile);
+
+  _pimpl->writer->async_make_participant(
+    std::move(description),
+    [worker = _pimpl->worker,
+    command = std::move(command),
+    start = std::move(start),
+    handle_cb = std::move(handle_cb),
+    fleet = shared_from_this()](
+      rmf_traffic::schedule::Participant participant)
+    {
+      auto context = fleet->_pimpl->make_robot_context(
+        std::move(command),
+        std::move(start),
+        std::move(participant));
+
+      // We schedule the following operations on the worker to make sure we do not
+      // have a multiple read/write race condition on the FleetUpdateHandle.
+      worker.schedule(
+        [context, fleet, handle_cb = std::move(handle_cb)](const auto&)
+        {
+          fleet->_pimpl->onboard_robot(context, std::move(handle_cb));
+        });
+    });
+}
+
+//==============================================================================
+void FleetUpdateHandle::add_robots(std::vector<NewRobot> robots)
+{
+  std::vector<rmf_traffic::schedule::ParticipantDescription> descriptions;
+  descriptions.reserve(robots.size());
+  for (const auto& robot : robots)
+  {
+    if (robot.start.empty())
+    {
+      // *INDENT-OFF*
+      throw std::runtime_error(
+        "[FleetUpdateHandle::add_robots] StartSet of robot [" + robot.name
+        + "] is empty. Adding a robot to a fleet requires at least one "
+        "rmf_traffic::agv::Plan::Start to be specified.");
+      // *INDENT-ON*
+    }
+
+    descriptions.emplace_back(
+      robot.name,
+      _pimpl->name,
+      rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+      robot.profile);
+  }
+
+  _pimpl->writer->async_make_participants(
+    std::move(descriptions),
+    [robots = std::move(robots), fleet = shared_from_this()](
+      std::vector<rmf_traffic::schedule::Participant> participants) mutable
+    {
+      auto& impl = *fleet->_pimpl;
+
+      // Finding the nearest charger of each robot needs a planner query for
+      // every charger, which is most of the cost of setting up a robot.
+      std::vector<std::shared_ptr<RobotContext>> contexts(robots.size());
+      parallel_for(
+        robots.size(), impl.estimation_threads, [&](const std::size_t i)
+        {
+          contexts[i] = impl.make_robot_context(
+            std::move(robots[i].command),
+            std::move(robots[i].start),
+            std::move(participants[i]));
+        });
+
+      std::vector<std::function<void(std::shared_ptr<RobotUpdateHandle>)>>
+      handle_cbs;
+      handle_cbs.reserve(robots.size());
+      for (auto& robot : robots)
+        handle_cbs.push_back(std::move(robot.handle_cb));
+
+      // All of the robots are handed to the fleet in one job on its worker
+      impl.worker.schedule(
+        [contexts = std::move(contexts), handle_cbs = std::move(handle_cbs),
+        fleet](const auto&)
+        {
+          for (std::size_t i = 0; i < contexts.size(); ++i)
+            fleet->_pimpl->onboard_robot(contexts[i], handle_cbs[i]);
+        });
+    });
+}
+
+//==============================================================================
+void FleetUpdateHandle::close_lanes(std::vector<std::size_t> lane_indices)
+{
+  update_lanes({}, std::move(lane_indices));
+}
+
+//==============================================================================
+void FleetUpdateHandle::open_lanes(std::vector<std::size_t> lane_indices)
+{
+  update_lanes(std::move(lane_indices), {});
+}
+
+//==============================================================================
+void FleetUpdateHandle::update_lanes(
+  std::vector<std::size_t> open_lane_indices,
+  std::vector<std::size_t> close_lane_indices)
+{
+  _pimpl->worker.schedule(
+    [w = weak_from_this(),
+    open_lane_indices = std::move(open_lane_indices),
+    close_lane_indices = std::move(close_lane_indices)](const auto&)
+    {
+      const auto self = w.lock();
+      if (!self)
+        return;
+
+      // The new planner is built to the side, so the fleet keeps its current
+      // planner if any part of the update is rejected.
+      std::shared_ptr<const rmf_traffic::agv::Planner> new_planner;
+      try
+      {
+        new_planner = make_lane_update(
+          **self->_pimpl->planner, open_lane_indices, close_lane_indices);
+      }
+      catch (const std::exception& e)
+      {
+        RCLCPP_ERROR(
+          self->_pimpl->node->get_logger(),
+          "Rejecting a lane update for fleet [%s], so none of its lanes will "
+          "change: %s",
+          self->_pimpl->name.c_str(),
+          e.what());
+        return;
+      }
+
+      if (!new_planner)
+      {
+        // No changes are needed to the planner
+        return;
+      }
+
+      *self->_pimpl->planner = std::move(new_planner);
+
+      warm_up_planner(*self->_pimpl->planner);
+      self->_pimpl->pullover_candidates->update(*self->_pimpl->planner);
+    });
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::accept_task_requests(
+  AcceptTaskRequest check)
 {
   _pimpl->accept_task = std::move(check);
   return *this;
 }
 
 //==============================================================================
-FleetUpdateHandle& FleetUpdateHandle::accept_delivery_requests(
-  AcceptDeliveryRequest check)
+FleetUpdateHandle& FleetUpdateHandle::accept_task_types(
+  const std::unordered_set<uint32_t>& types)
+{
+  _pimpl->bid_notice_sub = nullptr;
+  _pimpl->typed_bid_notice_subs.clear();
+  for (const auto type : types)
+  {
+    _pimpl->typed_bid_notice_subs.push_back(
+      Implementation::subscribe_bid_notices(
+        *this, BidNoticeTaskTypeTopicPrefix + std::to_string(type)));
+  }
+
+  return *this;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::accept_delivery_requests(
+  AcceptDeliveryRequest check)
+{
+  _pimpl->accept_delivery = std::move(check);
+  return *this;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::default_maximum_delay(
+  std::optional<rmf_traffic::Duration> value)
+{
+  _pimpl->default_maximum_delay = value;
+  return *this;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Duration>
+FleetUpdateHandle::default_maximum_delay() const
+{
+  return _pimpl->default_maximum_delay;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::max_concurrent_negotiations(
+  std::optional<std::size_t> value)
+{
+  _pimpl->negotiation_admission->max_concurrent(value);
+  return *this;
+}
+
+//==============================================================================
+std::optional<std::size_t>
+FleetUpdateHandle::max_concurrent_negotiations() const
+{
+  return _pimpl->negotiation_admission->max_concurrent();
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::max_concurrent_allocations(
+  std::size_t value)
+{
+  _pimpl->max_concurrent_allocations = std::max<std::size_t>(1, value);
+  return *this;
+}
+
+//==============================================================================
+std::size_t FleetUpdateHandle::max_concurrent_allocations() const
+{
+  return _pimpl->max_concurrent_allocations;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::bid_bundle_period(
+  std::optional<rmf_traffic::Duration> value)
+{
+  _pimpl->bid_bundle_period = value;
+  if (!value.has_value())
+    _pimpl->plan_bid_bundle();
+
+  return *this;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Duration> FleetUpdateHandle::bid_bundle_period()
+const
+{
+  return _pimpl->bid_bundle_period;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::incremental_task_allocation(
+  bool enable,
+  bool optimize_in_background)
+{
+  _pimpl->incremental_allocation = enable;
+  _pimpl->optimize_in_background = optimize_in_background;
+  if (!enable || !optimize_in_background)
+    _pimpl->cancel_allocation(OptimizationKey);
+
+  return *this;
+}
+
+//==============================================================================
+bool FleetUpdateHandle::incremental_task_allocation() const
+{
+  return _pimpl->incremental_allocation;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::fast_task_cancellation(
+  bool enable,
+  bool optimize_in_background)
+{
+  _pimpl->fast_cancellation = enable;
+  _pimpl->optimize_after_cancellation = optimize_in_background;
+  return *this;
+}
+
+//==============================================================================
+bool FleetUpdateHandle::fast_task_cancellation() const
+{
+  return _pimpl->fast_cancellation;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::task_estimation_threads(
+  std::size_t value)
+{
+  _pimpl->estimation_threads = std::max<std::size_t>(1, value);
+  return *this;
+}
+
+//==============================================================================
+std::size_t FleetUpdateHandle::task_estimation_threads() const
+{
+  return _pimpl->estimation_threads;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::allocation_metrics_callback(
+  AllocationMetricsCallback callback)
+{
+  _pimpl->allocation_metrics_cb = std::move(callback);
+  return *this;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::phase_lookahead(bool enable)
+{
+  _pimpl->phase_lookahead = enable;
+  for (const auto& t : _pimpl->task_managers)
+  {
+    t.first->worker().schedule(
+      [context = t.first, enable](const auto&)
+      {
+        context->phase_lookahead(enable);
+      });
+  }
+
+  return *this;
+}
+
+//==============================================================================
+bool FleetUpdateHandle::phase_lookahead() const
+{
+  return _pimpl->phase_lookahead;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::predictive_door_requests(bool enable)
+{
+  _pimpl->predictive_door_requests = enable;
+  for (const auto& t : _pimpl->task_managers)
+  {
+    t.first->worker().schedule(
+      [context = t.first, enable](const auto&)
+      {
+        context->predictive_door_requests(enable);
+      });
+  }
+
+  return *this;
+}
+
+//==============================================================================
+bool FleetUpdateHandle::predictive_door_requests() const
+{
+  return _pimpl->predictive_door_requests;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::predictive_lift_requests(bool enable)
+{
+  _pimpl->predictive_lift_requests = enable;
+  for (const auto& t : _pimpl->task_managers)
+  {
+    t.first->worker().schedule(
+      [context = t.first, enable](const auto&)
+      {
+        context->predictive_lift_requests(enable);
+      });
+  }
+
+  return *this;
+}
+
+//==============================================================================
+bool FleetUpdateHandle::predictive_lift_requests() const
 {
-  _pimpl->accept_delivery = std::move(check);
+  return _pimpl->predictive_lift_requests;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::dispenser_lead_time(
+  std::optional<rmf_traffic::Duration> value)
+{
+  _pimpl->dispenser_lead_time = value;
+  for (const auto& t : _pimpl->task_managers)
+  {
+    t.first->worker().schedule(
+      [context = t.first, value](const auto&)
+      {
+        context->dispenser_lead_time(value);
+      });
+  }
+
   return *this;
 }
 
 //==============================================================================
-FleetUpdateHandle& FleetUpdateHandle::default_maximum_delay(
+std::optional<rmf_traffic::Duration> FleetUpdateHandle::dispenser_lead_time()
+const
+{
+  return _pimpl->dispenser_lead_time;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::delay_report_period(
   std::optional<rmf_traffic::Duration> value)
 {
-  _pimpl->default_maximum_delay = value;
+  // Apply whatever the previous reporter is still holding on to
+  if (_pimpl->delay_reporter)
+    _pimpl->delay_reporter->flush();
+
+  _pimpl->delay_report_period = value;
+  _pimpl->delay_reporter = nullptr;
+  _pimpl->delay_report_timer = nullptr;
+  if (value.has_value())
+  {
+    _pimpl->delay_reporter = std::make_shared<DelayReporter>();
+    _pimpl->delay_report_timer = _pimpl->node->try_create_wall_timer(
+      *value,
+      [w = std::weak_ptr<DelayReporter>(_pimpl->delay_reporter)]()
+      {
+        if (const auto reporter = w.lock())
+          reporter->flush();
+      });
+  }
+
+  for (const auto& t : _pimpl->task_managers)
+  {
+    t.first->worker().schedule(
+      [context = t.first, reporter = _pimpl->delay_reporter](const auto&)
+      {
+        context->delay_reporter(reporter);
+      });
+  }
+
+  return *this;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Duration> FleetUpdateHandle::delay_report_period()
+const
+{
+  return _pimpl->delay_report_period;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::phase_metrics_callback(
+  PhaseMetricsCallback callback)
+{
+  _pimpl->phase_metrics_cb = std::move(callback);
+  return *this;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::phase_metrics_publish_period(
+  std::optional<rmf_traffic::Duration> value)
+{
+  // Publish whatever the previous collector is still holding on to
+  _pimpl->publish_phase_metrics();
+
+  _pimpl->phase_metrics_period = value;
+  _pimpl->phase_metrics = nullptr;
+  _pimpl->phase_metrics_timer = nullptr;
+  if (value.has_value())
+  {
+    _pimpl->phase_metrics = std::make_shared<PhaseMetricsCollector>();
+    _pimpl->phase_metrics_timer = _pimpl->node->try_create_wall_timer(
+      *value,
+      [me = weak_from_this()]()
+      {
+        if (const auto self = me.lock())
+          self->_pimpl->publish_phase_metrics();
+      });
+  }
+
+  for (const auto& t : _pimpl->task_managers)
+  {
+    t.first->worker().schedule(
+      [context = t.first, metrics = _pimpl->phase_metrics](const auto&)
+      {
+        context->phase_metrics(metrics);
+      });
+  }
+
   return *this;
 }
 
 //==============================================================================
 std::optional<rmf_traffic::Duration>
-FleetUpdateHandle::default_maximum_delay() const
+FleetUpdateHandle::phase_metrics_publish_period() const
 {
-  return _pimpl->default_maximum_delay;
+  return _pimpl->phase_metrics_period;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::bid_lifetime(
+  rmf_traffic::Duration value)
+{
+  if (value <= rmf_traffic::Duration(0))
+  {
+    throw std::runtime_error(
+      "[FleetUpdateHandle::bid_lifetime] The lifetime must be positive");
+  }
+
+  _pimpl->bid_lifetime = value;
+  _pimpl->start_expiry_timer();
+  return *this;
+}
+
+//==============================================================================
+rmf_traffic::Duration FleetUpdateHandle::bid_lifetime() const
+{
+  return _pimpl->bid_lifetime;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::memory_usage_publish_period(
+  std::optional<rmf_traffic::Duration> value)
+{
+  _pimpl->memory_usage_period = value;
+  _pimpl->memory_usage_timer = nullptr;
+  if (!value.has_value())
+    return *this;
+
+  if (!_pimpl->memory_usage_pub)
+  {
+    _pimpl->memory_usage_pub =
+      _pimpl->node->create_publisher<Implementation::MemoryUsageMsg>(
+      rmf_traffic_ros2::MemoryUsageTopicName,
+      rclcpp::SystemDefaultsQoS().reliable().keep_last(10));
+  }
+
+  _pimpl->memory_usage_timer = _pimpl->node->try_create_wall_timer(
+    *value,
+    [w = weak_from_this()]()
+    {
+      const auto self = w.lock();
+      if (!self)
+        return;
+
+      // The negotiations are driven by the callbacks of the node, so they are
+      // accounted for here, while the containers of the fleet are accounted
+      // for on its worker.
+      rmf_traffic_ros2::MemoryUsage usage;
+      if (self->_pimpl->negotiation)
+        self->_pimpl->negotiation->account_memory(usage);
+
+      self->_pimpl->worker.schedule(
+        [w, usage = std::move(usage)](const auto&)
+        {
+          if (const auto self = w.lock())
+            self->_pimpl->publish_memory_usage(usage);
+        });
+    });
+
+  return *this;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Duration>
+FleetUpdateHandle::memory_usage_publish_period() const
+{
+  return _pimpl->memory_usage_period;
+}
+
+//==============================================================================
+class FleetUpdateHandle::RobotUpdates::Implementation
+{
+public:
+
+  /// Compute the new location of a robot, or a std::nullopt if it cannot be
+  /// placed on the graph.
+  using ComputeStarts =
+    std::function<std::optional<rmf_traffic::agv::Plan::StartSet>(
+        RobotUpdateHandle::Implementation& robot,
+        const RobotContext& context,
+        rmf_traffic::Time now)>;
+
+  struct Update
+  {
+    RobotUpdateHandlePtr robot;
+    ComputeStarts starts;
+    std::optional<double> battery_soc;
+  };
+
+  std::vector<Update> updates;
+};
+
+//==============================================================================
+FleetUpdateHandle::RobotUpdates::RobotUpdates()
+: _pimpl(rmf_utils::make_impl<Implementation>(Implementation{}))
+{
+  // Do nothing
+}
+
+//==============================================================================
+auto FleetUpdateHandle::RobotUpdates::update_position(
+  RobotUpdateHandlePtr robot,
+  const std::size_t waypoint,
+  const double orientation) -> RobotUpdates&
+{
+  _pimpl->updates.push_back(
+    {
+      std::move(robot),
+      [waypoint, orientation](
+        auto&, const auto&, const rmf_traffic::Time now)
+      {
+        return rmf_traffic::agv::Plan::StartSet{
+          rmf_traffic::agv::Plan::Start(now, waypoint, orientation)
+        };
+      },
+      std::nullopt
+    });
+
+  return *this;
+}
+
+//==============================================================================
+auto FleetUpdateHandle::RobotUpdates::update_position(
+  RobotUpdateHandlePtr robot,
+  const Eigen::Vector3d& position,
+  std::vector<std::size_t> lanes) -> RobotUpdates&
+{
+  _pimpl->updates.push_back(
+    {
+      std::move(robot),
+      [position, lanes = std::move(lanes)](
+        auto&, const RobotContext& context, const rmf_traffic::Time now)
+      {
+        return std::make_optional(
+          RobotUpdateHandle::Implementation::lane_starts(
+            context, position, lanes, now));
+      },
+      std::nullopt
+    });
+
+  return *this;
+}
+
+//==============================================================================
+auto FleetUpdateHandle::RobotUpdates::update_position(
+  RobotUpdateHandlePtr robot,
+  const Eigen::Vector3d& position,
+  const std::size_t target_waypoint) -> RobotUpdates&
+{
+  _pimpl->updates.push_back(
+    {
+      std::move(robot),
+      [position, target_waypoint](
+        auto&, const auto&, const rmf_traffic::Time now)
+      {
+        return rmf_traffic::agv::Plan::StartSet{
+          rmf_traffic::agv::Plan::Start(
+            now, target_waypoint, position[2],
+            Eigen::Vector2d(position.block<2, 1>(0, 0)))
+        };
+      },
+      std::nullopt
+    });
+
+  return *this;
+}
+
+//==============================================================================
+auto FleetUpdateHandle::RobotUpdates::update_position(
+  RobotUpdateHandlePtr robot,
+  std::string map_name,
+  const Eigen::Vector3d& position,
+  const double max_merge_waypoint_distance,
+  const double max_merge_lane_distance,
+  const double min_lane_length) -> RobotUpdates&
+{
+  _pimpl->updates.push_back(
+    {
+      std::move(robot),
+      [map_name = std::move(map_name), position, max_merge_waypoint_distance,
+      max_merge_lane_distance, min_lane_length](
+        RobotUpdateHandle::Implementation& robot,
+        const RobotContext& context,
+        const rmf_traffic::Time now)
+      {
+        return robot.merge_starts(
+          context, map_name, position,
+          max_merge_waypoint_distance, max_merge_lane_distance,
+          min_lane_length, now);
+      },
+      std::nullopt
+    });
+
+  return *this;
+}
+
+//==============================================================================
+auto FleetUpdateHandle::RobotUpdates::update_battery_soc(
+  RobotUpdateHandlePtr robot,
+  const double battery_soc) -> RobotUpdates&
+{
+  // Invalid values are ignored, the same as RobotUpdateHandle does
+  if (battery_soc < 0.0 || battery_soc > 1.0)
+    return *this;
+
+  _pimpl->updates.push_back({std::move(robot), nullptr, battery_soc});
+  return *this;
+}
+
+//==============================================================================
+auto FleetUpdateHandle::RobotUpdates::append(const RobotUpdates& other)
+-> RobotUpdates&
+{
+  _pimpl->updates.insert(
+    _pimpl->updates.end(),
+    other._pimpl->updates.begin(),
+    other._pimpl->updates.end());
+
+  return *this;
+}
+
+//==============================================================================
+std::size_t FleetUpdateHandle::RobotUpdates::size() const
+{
+  return _pimpl->updates.size();
+}
+
+//==============================================================================
+void FleetUpdateHandle::RobotUpdates::clear()
+{
+  _pimpl->updates.clear();
+}
+
+//==============================================================================
+void FleetUpdateHandle::update_robots(const RobotUpdates& updates)
+{
+  struct Change
+  {
+    std::optional<rmf_traffic::agv::Plan::StartSet> location;
+    std::optional<double> battery_soc;
+  };
+
+  using Changes = std::vector<std::pair<RobotContextPtr, Change>>;
+
+  // Everything that could fail or take time is done here on the caller's
+  // thread, the same as the individual RobotUpdateHandle functions.
+  const auto now = rmf_traffic_ros2::convert(_pimpl->node->now());
+  Changes shared;
+  std::unordered_map<RobotContextPtr, Changes> separate;
+  for (const auto& update : updates._pimpl->updates)
+  {
+    if (!update.robot)
+      continue;
+
+    auto& robot = RobotUpdateHandle::Implementation::get(*update.robot);
+    auto context = robot.get_context();
+    if (!context)
+      continue;
+
+    Change change{std::nullopt, update.battery_soc};
+    if (update.starts)
+    {
+      change.location = update.starts(robot, *context, now);
+      if (!change.location)
+        continue;
+    }
+
+    // Only robots of this fleet share the fleet's worker, so they can be
+    // updated together. Any other robot gets a job on its own worker.
+    if (context->description().owner() == _pimpl->name)
+    {
+      shared.push_back({std::move(context), std::move(change)});
+    }
+    else
+    {
+      auto& changes = separate[context];
+      changes.push_back({std::move(context), std::move(change)});
+    }
+  }
+
+  const auto apply = [](const Changes& changes)
+    {
+      for (const auto& [context, change] : changes)
+      {
+        if (change.location)
+          context->_location = *change.location;
+
+        if (change.battery_soc)
+          context->current_battery_soc(*change.battery_soc);
+      }
+    };
+
+  if (!shared.empty())
+  {
+    _pimpl->worker.schedule(
+      [apply, changes = std::move(shared)](const auto&)
+      {
+        apply(changes);
+      });
+  }
+
+  for (auto& [context, changes] : separate)
+  {
+    context->worker().schedule(
+      [apply, changes = std::move(changes)](const auto&)
+      {
+        apply(changes);
+      });
+  }
 }
 
 //==============================================================================
@@ -1233,6 +3327,89 @@ FleetUpdateHandle& FleetUpdateHandle::fleet_state_publish_period(
   return *this;
 }
 
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::fleet_state_keyframe_period(
+  std::optional<rmf_traffic::Duration> value)
+{
+  _pimpl->fleet_state_keyframe_period = value;
+
+  // Make sure the next publication is a keyframe
+  _pimpl->last_fleet_state_keyframe = std::chrono::steady_clock::time_point();
+  _pimpl->published_robot_states.clear();
+  return *this;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Duration>
+FleetUpdateHandle::fleet_state_keyframe_period() const
+{
+  return _pimpl->fleet_state_keyframe_period;
+}
+
+//==============================================================================
+FleetUpdateHandle& FleetUpdateHandle::persist_state(
+  std::optional<std::string> file_path,
+  rmf_traffic::Duration period)
+{
+  _pimpl->persist_file = std::move(file_path);
+  _pimpl->last_persisted.clear();
+  if (!_pimpl->persist_file.has_value())
+  {
+    _pimpl->persist_timer = nullptr;
+    _pimpl->open_bids.clear();
+    return *this;
+  }
+
+  try
+  {
+    auto snapshot = read_fleet_snapshot(*_pimpl->persist_file);
+    if (snapshot.has_value() && snapshot->fleet_name != _pimpl->name)
+    {
+      RCLCPP_WARN(
+        _pimpl->node->get_logger(),
+        "Ignoring the saved state in [%s] because it belongs to fleet [%s] "
+        "instead of [%s]",
+        _pimpl->persist_file->c_str(),
+        snapshot->fleet_name.c_str(),
+        _pimpl->name.c_str());
+    }
+    else if (snapshot.has_value())
+    {
+      _pimpl->begin_warm_start(std::move(*snapshot));
+    }
+  }
+  catch (const std::exception& e)
+  {
+    RCLCPP_ERROR(
+      _pimpl->node->get_logger(),
+      "Unable to restore the saved state of fleet [%s]: %s",
+      _pimpl->name.c_str(), e.what());
+  }
+
+  _pimpl->persist_timer = _pimpl->node->try_create_wall_timer(
+    period,
+    [w = weak_from_this()]()
+    {
+      if (const auto self = w.lock())
+      {
+        self->_pimpl->worker.schedule(
+          [w](const auto&)
+          {
+            if (const auto self = w.lock())
+              self->_pimpl->persist_state();
+          });
+      }
+    });
+
+  return *this;
+}
+
+//==============================================================================
+std::optional<std::string> FleetUpdateHandle::persist_state_file() const
+{
+  return _pimpl->persist_file;
+}
+
 //==============================================================================
 bool FleetUpdateHandle::set_task_planner_params(
   std::shared_ptr<rmf_battery::agv::BatterySystem> battery_system,
@@ -1242,7 +3419,8 @@ bool FleetUpdateHandle::set_task_planner_params(
   double recharge_threshold,
   double recharge_soc,
   bool account_for_battery_drain,
-  rmf_task::ConstRequestFactoryPtr finishing_request)
+  rmf_task::ConstRequestFactoryPtr finishing_request,
+  double bid_planning_budget)
 {
   if (battery_system &&
     motion_sink &&
@@ -1271,13 +3449,23 @@ bool FleetUpdateHandle::set_task_planner_params(
       finishing_request};
     _pimpl->task_planner = std::make_shared<rmf_task::agv::TaskPlanner>(
       std::move(task_config), std::move(options));
+    _pimpl->finishing_request = finishing_request;
+    _pimpl->bid_planning_budget = bid_planning_budget;
+    _pimpl->allocation_cache.clear();
+    _pimpl->charger_index->clear_estimates();
 
     // Here we update the task planner in all the RobotContexts.
     // The TaskManagers rely on the parameters in the task planner for
     // automatic retreat. Hence, we also update them whenever the
     // task planner here is updated.
     for (const auto& t : _pimpl->task_managers)
-      t.first->task_planner(_pimpl->task_planner);
+    {
+      t.first->worker().schedule(
+        [context = t.first, task_planner = _pimpl->task_planner](const auto&)
+        {
+          context->task_planner(task_planner);
+        });
+    }
 
     return true;
   }
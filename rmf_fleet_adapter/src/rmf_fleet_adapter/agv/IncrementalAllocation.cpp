@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "IncrementalAllocation.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+bool append_assignment(
+  const rmf_task::agv::TaskPlanner& planner,
+  const rmf_task::ConstRequestPtr& request,
+  rmf_task::agv::State& state,
+  std::vector<rmf_task::agv::TaskPlanner::Assignment>& queue)
+{
+  const auto& config = planner.configuration();
+  const auto model = request->description()->make_model(
+    request->earliest_start_time(), config.parameters());
+  const auto estimate = model->estimate_finish(
+    state, config.constraints(), *planner.estimate_cache());
+  if (!estimate)
+    return false;
+
+  queue.emplace_back(
+    request, estimate->finish_state(), estimate->wait_until());
+  state = estimate->finish_state();
+  return true;
+}
+
+//==============================================================================
+std::optional<Assignments> plan_insertion(
+  const rmf_task::agv::TaskPlanner& planner,
+  const std::vector<rmf_task::agv::State>& states,
+  const Assignments& current,
+  const rmf_task::ConstRequestPtr& new_request,
+  const std::size_t threads)
+{
+  using Assignment = rmf_task::agv::TaskPlanner::Assignment;
+
+  // The robots are evaluated independently, each keeping its own best
+  // insertion. Ties are broken by the lowest robot index and then the earliest
+  // position, so the result does not depend on how the robots were split
+  // across threads.
+  struct Candidate
+  {
+    double cost = std::numeric_limits<double>::infinity();
+    std::optional<Assignments> assignments;
+  };
+  std::vector<Candidate> candidates(current.size());
+
+  parallel_for(
+    current.size(), threads, [&](const std::size_t i)
+    {
+      const auto& queue = current[i];
+      auto& best = candidates[i];
+      for (std::size_t k = 0; k <= queue.size(); ++k)
+      {
+        // The queue before the insertion is kept as it is. Everything from
+        // the insertion onwards needs to be estimated again.
+        std::vector<Assignment> candidate(queue.begin(), queue.begin() + k);
+        auto state = k == 0 ? states[i] : queue[k-1].state();
+
+        bool feasible =
+          append_assignment(planner, new_request, state, candidate);
+        for (std::size_t j = k; feasible && j < queue.size(); ++j)
+        {
+          feasible =
+            append_assignment(planner, queue[j].request(), state, candidate);
+        }
+
+        if (!feasible)
+          continue;
+
+        auto assignments = current;
+        assignments[i] = std::move(candidate);
+        const double cost = planner.compute_cost(assignments);
+        if (cost < best.cost)
+        {
+          best.cost = cost;
+          best.assignments = std::move(assignments);
+        }
+      }
+    });
+
+  const Candidate* best = nullptr;
+  for (const auto& c : candidates)
+  {
+    if (c.assignments.has_value() && (!best || c.cost < best->cost))
+      best = &c;
+  }
+
+  if (!best)
+    return std::nullopt;
+
+  return best->assignments;
+}
+
+//==============================================================================
+std::optional<Assignments> plan_removal(
+  const rmf_task::agv::TaskPlanner& planner,
+  const std::vector<rmf_task::agv::State>& states,
+  const Assignments& current,
+  const std::string& removed_id)
+{
+  using Assignment = rmf_task::agv::TaskPlanner::Assignment;
+
+  auto assignments = current;
+  for (std::size_t i = 0; i < assignments.size(); ++i)
+  {
+    const auto& queue = assignments[i];
+    const auto removed = std::find_if(queue.begin(), queue.end(),
+        [&](const Assignment& a) { return a.request()->id() == removed_id; });
+
+    if (removed == queue.end())
+      continue;
+
+    // Only the queue of this robot is affected, and only from the removed
+    // request onwards.
+    std::vector<Assignment> repaired(queue.begin(), removed);
+    auto state = repaired.empty() ? states[i] : repaired.back().state();
+    for (auto it = removed + 1; it != queue.end(); ++it)
+    {
+      if (!append_assignment(planner, it->request(), state, repaired))
+        return std::nullopt;
+    }
+
+    assignments[i] = std::move(repaired);
+    return assignments;
+  }
+
+  return std::nullopt;
+}
+
+//==============================================================================
+bool optimization_improves(
+  const rmf_task::agv::TaskPlanner& planner,
+  const Assignments& current,
+  const Assignments& optimized)
+{
+  return planner.compute_cost(optimized) < planner.compute_cost(current);
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__INCREMENTALALLOCATION_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__INCREMENTALALLOCATION_HPP
+
+#include <rmf_task/agv/TaskPlanner.hpp>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+using Assignments = rmf_task::agv::TaskPlanner::Assignments;
+
+//==============================================================================
+/// Estimate how a robot will perform a request once it reaches the given
+/// state, and append the assignment to its queue. The state is updated to the
+/// finish state of the request. This returns false if the robot cannot perform
+/// the request from that state.
+bool append_assignment(
+  const rmf_task::agv::TaskPlanner& planner,
+  const rmf_task::ConstRequestPtr& request,
+  rmf_task::agv::State& state,
+  std::vector<rmf_task::agv::TaskPlanner::Assignment>& queue);
+
+//==============================================================================
+/// Find the cheapest way to insert a new request into the current assignments
+/// while keeping the order of the queued requests. Only the part of a queue
+/// from the insertion onwards is estimated again, so this is much cheaper
+/// than planning every request, but it can never do better than
+/// TaskPlanner::plan and it never adds any charging.
+///
+/// \param[in] planner
+///   The task planner whose configuration is used for the estimates
+///
+/// \param[in] states
+///   The current state of each robot
+///
+/// \param[in] current
+///   The queue of each robot
+///
+/// \param[in] new_request
+///   The request to insert
+///
+/// \param[in] threads
+///   How many threads may be used to evaluate the robots
+///
+/// \return the new assignments, or std::nullopt if there is no feasible
+/// insertion, in which case every request should be planned again.
+std::optional<Assignments> plan_insertion(
+  const rmf_task::agv::TaskPlanner& planner,
+  const std::vector<rmf_task::agv::State>& states,
+  const Assignments& current,
+  const rmf_task::ConstRequestPtr& new_request,
+  std::size_t threads);
+
+//==============================================================================
+/// Take a request out of the current assignments and estimate the rest of the
+/// affected queue again. Any charging that became unnecessary is left for a
+/// background optimization to clean up.
+///
+/// \return the new assignments, or std::nullopt if the request is not queued
+/// or if the rest of the queue is no longer feasible, in which case every
+/// request should be planned again.
+std::optional<Assignments> plan_removal(
+  const rmf_task::agv::TaskPlanner& planner,
+  const std::vector<rmf_task::agv::State>& states,
+  const Assignments& current,
+  const std::string& removed_id);
+
+//==============================================================================
+/// Decide whether the result of a background optimization should replace the
+/// current assignments. The queues keep executing while the optimization is
+/// planned, so the two are compared by their cost right now, and a result
+/// that is not strictly cheaper is thrown away.
+bool optimization_improves(
+  const rmf_task::agv::TaskPlanner& planner,
+  const Assignments& current,
+  const Assignments& optimized);
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__INCREMENTALALLOCATION_HPP
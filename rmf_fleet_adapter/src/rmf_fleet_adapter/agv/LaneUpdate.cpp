@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "LaneUpdate.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+std::shared_ptr<const rmf_traffic::agv::Planner> make_lane_update(
+  const rmf_traffic::agv::Planner& current,
+  const std::vector<std::size_t>& open_lanes,
+  const std::vector<std::size_t>& close_lanes)
+{
+  const auto& config = current.get_configuration();
+  const std::size_t num_lanes = config.graph().num_lanes();
+  const auto check_range = [&](const std::vector<std::size_t>& lanes)
+    {
+      for (const auto& lane : lanes)
+      {
+        if (lane >= num_lanes)
+        {
+          throw std::runtime_error(
+            "[rmf_fleet_adapter::agv::make_lane_update] Lane index ["
+            + std::to_string(lane) + "] is out of range for a graph with ["
+            + std::to_string(num_lanes) + "] lanes");
+        }
+      }
+    };
+
+  check_range(open_lanes);
+  check_range(close_lanes);
+
+  const auto& current_lane_closures = config.lane_closures();
+
+  // The lanes are applied to a copy of the current closures first, so that a
+  // lane which gets opened and closed again counts as no change.
+  auto new_lane_closures = current_lane_closures;
+  for (const auto& lane : open_lanes)
+    new_lane_closures.open(lane);
+
+  for (const auto& lane : close_lanes)
+    new_lane_closures.close(lane);
+
+  bool any_changes = false;
+  const auto check = [&](const std::vector<std::size_t>& lanes)
+    {
+      for (const auto& lane : lanes)
+      {
+        if (current_lane_closures.is_closed(lane)
+          != new_lane_closures.is_closed(lane))
+        {
+          any_changes = true;
+          return;
+        }
+      }
+    };
+
+  check(open_lanes);
+  if (!any_changes)
+    check(close_lanes);
+
+  if (!any_changes)
+    return nullptr;
+
+  auto new_config = config;
+  new_config.lane_closures() = std::move(new_lane_closures);
+
+  return std::make_shared<const rmf_traffic::agv::Planner>(
+    new_config, rmf_traffic::agv::Planner::Options(nullptr));
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__LANEUPDATE_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__LANEUPDATE_HPP
+
+#include <rmf_traffic/agv/Planner.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Build the planner that results from opening and closing a set of lanes as
+/// one change. The current planner is never modified, so if anything goes
+/// wrong the fleet simply keeps using it. A lane that appears in both lists
+/// will be closed.
+///
+/// \param[in] current
+///   The planner that the fleet is using now
+///
+/// \param[in] open_lanes
+///   The lanes that should be open
+///
+/// \param[in] close_lanes
+///   The lanes that should be closed
+///
+/// \return a new planner, or a nullptr if no lane changes state.
+///
+/// \throws std::runtime_error if a lane index is not in the graph of the
+/// planner, or if the new planner cannot be built.
+std::shared_ptr<const rmf_traffic::agv::Planner> make_lane_update(
+  const rmf_traffic::agv::Planner& current,
+  const std::vector<std::size_t>& open_lanes,
+  const std::vector<std::size_t>& close_lanes);
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__LANEUPDATE_HPP
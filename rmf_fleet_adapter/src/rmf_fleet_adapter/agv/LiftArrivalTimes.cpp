@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "LiftArrivalTimes.hpp"
+
+#include <algorithm>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+LiftArrivalTimes::LiftArrivalTimes(double smoothing)
+: _smoothing(std::clamp(smoothing, 0.0, 1.0))
+{
+  // Do nothing
+}
+
+//==============================================================================
+void LiftArrivalTimes::record(
+  const std::string& lift_name,
+  const rmf_traffic::Duration wait)
+{
+  if (wait < rmf_traffic::Duration(0))
+    return;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto insertion = _estimates.insert({lift_name, wait});
+  if (insertion.second)
+    return;
+
+  auto& estimate = insertion.first->second;
+  estimate += std::chrono::duration_cast<rmf_traffic::Duration>(
+    _smoothing * (wait - estimate));
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Duration> LiftArrivalTimes::arrival_time(
+  const std::string& lift_name) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _estimates.find(lift_name);
+  if (it == _estimates.end())
+    return std::nullopt;
+
+  return it->second;
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
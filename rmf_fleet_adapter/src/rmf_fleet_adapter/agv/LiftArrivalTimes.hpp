@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__LIFTARRIVALTIMES_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__LIFTARRIVALTIMES_HPP
+
+#include <rmf_traffic/Time.hpp>
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Learns how long each lift takes to arrive with its doors open after a robot
+/// of the fleet asks for it. Each observed wait is blended into a running
+/// estimate for that lift.
+///
+/// This is safe to use from multiple threads.
+class LiftArrivalTimes
+{
+public:
+
+  /// How much weight each new observation gets in the running estimate
+  static constexpr double DefaultSmoothing = 0.3;
+
+  LiftArrivalTimes(double smoothing = DefaultSmoothing);
+
+  /// Tell this how long a lift took to arrive after it was requested.
+  void record(const std::string& lift_name, rmf_traffic::Duration wait);
+
+  /// Get the estimated time that a lift takes to arrive, if it has ever been
+  /// recorded.
+  std::optional<rmf_traffic::Duration> arrival_time(
+    const std::string& lift_name) const;
+
+private:
+
+  double _smoothing;
+  std::unordered_map<std::string, rmf_traffic::Duration> _estimates;
+  mutable std::mutex _mutex;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__LIFTARRIVALTIMES_HPP
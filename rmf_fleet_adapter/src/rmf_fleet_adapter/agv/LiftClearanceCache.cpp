@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "LiftClearanceCache.hpp"
+
+#include <stdexcept>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+std::shared_ptr<LiftClearanceCache> LiftClearanceCache::make(
+  Evaluate evaluate,
+  const std::chrono::steady_clock::duration validity,
+  const std::chrono::steady_clock::duration pending_timeout)
+{
+  if (!evaluate)
+  {
+    throw std::runtime_error(
+            "[LiftClearanceCache::make] The evaluate callback is empty");
+  }
+
+  return std::shared_ptr<LiftClearanceCache>(
+    new LiftClearanceCache(std::move(evaluate), validity, pending_timeout));
+}
+
+//==============================================================================
+LiftClearanceCache::LiftClearanceCache(
+  Evaluate evaluate,
+  const std::chrono::steady_clock::duration validity,
+  const std::chrono::steady_clock::duration pending_timeout)
+: _evaluate(std::move(evaluate)),
+  _validity(validity),
+  _pending_timeout(pending_timeout)
+{
+  // Do nothing
+}
+
+//==============================================================================
+void LiftClearanceCache::check(
+  const std::string& robot_name,
+  const std::string& lift_name,
+  Decide decide)
+{
+  std::shared_ptr<Pending> pending;
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    const auto now = std::chrono::steady_clock::now();
+    auto& lift = _lifts[lift_name];
+    if (lift.decision && now - lift.decided <= _validity)
+    {
+      const auto decision = *lift.decision;
+      lock.unlock();
+      decide(decision);
+      return;
+    }
+
+    if (lift.pending && now - lift.pending->started < _pending_timeout)
+    {
+      lift.pending->waiting.push_back(std::move(decide));
+      return;
+    }
+
+    // Robots that were waiting on a check that timed out will still get its
+    // decision if it ever arrives, but nobody else will join them.
+    pending = std::make_shared<Pending>();
+    pending->started = now;
+    pending->waiting.push_back(std::move(decide));
+    lift.pending = pending;
+  }
+
+  _evaluate(
+    robot_name, lift_name,
+    [w = weak_from_this(), lift_name, pending](Decision decision)
+    {
+      if (const auto self = w.lock())
+      {
+        self->_conclude(lift_name, pending, decision);
+        return;
+      }
+
+      for (const auto& decide : pending->waiting)
+        decide(decision);
+    });
+}
+
+//==============================================================================
+auto LiftClearanceCache::watchdog(std::string robot_name) -> Watchdog
+{
+  return [w = weak_from_this(), robot_name = std::move(robot_name)](
+    const std::string& lift_name, Decide decide)
+    {
+      if (const auto self = w.lock())
+        self->check(robot_name, lift_name, std::move(decide));
+      else
+        decide(Decision::Undefined);
+    };
+}
+
+//==============================================================================
+void LiftClearanceCache::invalidate(const std::string& lift_name)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _lifts.find(lift_name);
+  if (it != _lifts.end())
+    it->second.decision = std::nullopt;
+}
+
+//==============================================================================
+void LiftClearanceCache::_conclude(
+  const std::string& lift_name,
+  const std::shared_ptr<Pending>& pending,
+  const Decision decision)
+{
+  std::vector<Decide> waiting;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& lift = _lifts[lift_name];
+    if (lift.pending == pending)
+    {
+      lift.pending = nullptr;
+
+      // An undefined decision is not worth sharing with robots that ask later
+      if (decision != Decision::Undefined)
+      {
+        lift.decision = decision;
+        lift.decided = std::chrono::steady_clock::now();
+      }
+    }
+
+    waiting = std::move(pending->waiting);
+    pending->waiting.clear();
+  }
+
+  for (const auto& decide : waiting)
+    decide(decision);
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__LIFTCLEARANCECACHE_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__LIFTCLEARANCECACHE_HPP
+
+#include <rmf_fleet_adapter/agv/RobotUpdateHandle.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Shares lift clearance decisions among the robots of a fleet. While a
+/// clearance check for a lift is waiting on its reply, any other robot that
+/// asks about the same lift waits on that same check instead of starting a new
+/// one. A decision is then reused for every robot that asks about the lift
+/// within a short validity window.
+///
+/// This is safe to use from multiple threads. The decisions are always given
+/// outside of the internal lock, and are never given while calling evaluate.
+class LiftClearanceCache
+  : public std::enable_shared_from_this<LiftClearanceCache>
+{
+public:
+
+  using Decision = RobotUpdateHandle::Unstable::Decision;
+  using Decide = RobotUpdateHandle::Unstable::Decide;
+  using Watchdog = RobotUpdateHandle::Unstable::Watchdog;
+
+  /// Begin a clearance check for a robot that wants to enter a lift. The
+  /// Decide callback must eventually be given the decision, from any thread.
+  using Evaluate = std::function<void(
+        const std::string& robot_name,
+        const std::string& lift_name,
+        Decide decide)>;
+
+  /// \param[in] evaluate
+  ///   Begins a clearance check, e.g. by sending a service request
+  ///
+  /// \param[in] validity
+  ///   How long a decision may be reused. A zero duration only shares checks
+  ///   that are in progress.
+  ///
+  /// \param[in] pending_timeout
+  ///   How long to wait on a check that has not replied before a new check is
+  ///   started for the lift.
+  static std::shared_ptr<LiftClearanceCache> make(
+    Evaluate evaluate,
+    std::chrono::steady_clock::duration validity,
+    std::chrono::steady_clock::duration pending_timeout =
+    std::chrono::seconds(10));
+
+  /// Get a decision about whether a robot may enter a lift. This never blocks
+  /// on the check. If a valid decision is cached, decide will be triggered
+  /// before this function returns.
+  void check(
+    const std::string& robot_name,
+    const std::string& lift_name,
+    Decide decide);
+
+  /// Make a watchdog that can be given to
+  /// RobotUpdateHandle::Unstable::set_lift_entry_watchdog for a robot.
+  Watchdog watchdog(std::string robot_name);
+
+  /// Forget any decision that was made about a lift. Checks that are in
+  /// progress will still be shared.
+  void invalidate(const std::string& lift_name);
+
+private:
+
+  LiftClearanceCache(
+    Evaluate evaluate,
+    std::chrono::steady_clock::duration validity,
+    std::chrono::steady_clock::duration pending_timeout);
+
+  struct Pending
+  {
+    std::chrono::steady_clock::time_point started;
+    std::vector<Decide> waiting;
+  };
+
+  struct Lift
+  {
+    std::optional<Decision> decision;
+    std::chrono::steady_clock::time_point decided;
+    std::shared_ptr<Pending> pending;
+  };
+
+  void _conclude(
+    const std::string& lift_name,
+    const std::shared_ptr<Pending>& pending,
+    Decision decision);
+
+  Evaluate _evaluate;
+  std::chrono::steady_clock::duration _validity;
+  std::chrono::steady_clock::duration _pending_timeout;
+  std::unordered_map<std::string, Lift> _lifts;
+  std::mutex _mutex;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__LIFTCLEARANCECACHE_HPP
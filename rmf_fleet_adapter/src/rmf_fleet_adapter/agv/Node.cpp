@@ -19,6 +19,8 @@
 
 #include <rmf_fleet_adapter/StandardNames.hpp>
 #include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/ThreadSettings.hpp>
+#include <rmf_traffic_ros2/Tracer.hpp>
 
 namespace rmf_fleet_adapter {
 namespace agv {
@@ -30,17 +32,26 @@ std::shared_ptr<Node> Node::make(
   const rclcpp::NodeOptions& options)
 {
   auto node = std::shared_ptr<Node>(
-    new Node(std::move(worker), node_name, options));
+    new Node(worker, node_name, options));
 
   auto default_qos = rclcpp::SystemDefaultsQoS();
   default_qos.keep_last(100);
 
+  // The state and result topics of the infrastructure are only subscribed to
+  // while some phase is observing them, so that an adapter does not receive
+  // every message of every door, lift, dispenser and ingestor on site all the
+  // time. The states are published periodically, and the phases retransmit
+  // their requests until they hear back, so no phase depends on a message that
+  // was published before it started observing.
+
+  // Each phase only hears the states of the door or lift that it is using
   node->_door_state_obs =
-    node->create_observable<DoorState>(
-    DoorStateTopicName, default_qos);
+    node->create_keyed_observable<DoorState, std::string>(
+    DoorStateTopicName, default_qos,
+    [](const DoorState& state) { return state.door_name; });
 
   node->_door_supervisor_obs =
-    node->create_observable<DoorSupervisorState>(
+    node->create_lazy_observable<DoorSupervisorState>(
     DoorSupervisorHeartbeatTopicName, default_qos);
 
   node->_door_request_pub =
@@ -48,8 +59,9 @@ std::shared_ptr<Node> Node::make(
     AdapterDoorRequestTopicName, default_qos);
 
   node->_lift_state_obs =
-    node->create_observable<LiftState>(
-    LiftStateTopicName, default_qos);
+    node->create_keyed_observable<LiftState, std::string>(
+    LiftStateTopicName, default_qos,
+    [](const LiftState& state) { return state.lift_name; });
 
   node->_lift_request_pub =
     node->create_publisher<LiftRequest>(
@@ -64,11 +76,11 @@ std::shared_ptr<Node> Node::make(
     DispenserRequestTopicName, default_qos);
 
   node->_dispenser_result_obs =
-    node->create_observable<DispenserResult>(
+    node->create_lazy_observable<DispenserResult>(
     DispenserResultTopicName, default_qos);
 
   node->_dispenser_state_obs =
-    node->create_observable<DispenserState>(
+    node->create_lazy_observable<DispenserState>(
     DispenserStateTopicName, default_qos);
 
   node->_emergency_notice_obs =
@@ -80,17 +92,69 @@ std::shared_ptr<Node> Node::make(
     IngestorRequestTopicName, default_qos);
 
   node->_ingestor_result_obs =
-    node->create_observable<IngestorResult>(
+    node->create_lazy_observable<IngestorResult>(
     IngestorResultTopicName, default_qos);
 
   node->_ingestor_state_obs =
-    node->create_observable<IngestorState>(
+    node->create_lazy_observable<IngestorState>(
     IngestorStateTopicName, default_qos);
 
   node->_fleet_state_pub =
     node->create_publisher<FleetState>(
     FleetStateTopicName, default_qos);
 
+  node->_metrics = std::make_shared<rmf_traffic_ros2::Metrics>();
+  node->_metrics_exporter = rmf_traffic_ros2::MetricsExporter::from_parameters(
+    *node, node->_metrics);
+
+  // When the callback_report_period parameter is positive, the callbacks of
+  // the executor and the planning jobs are timed. The observer is shared by
+  // the whole process, so the most recent adapter node takes it over.
+  node->_callback_watchdog =
+    rmf_traffic_ros2::CallbackWatchdog::from_parameters(*node, node->_metrics);
+  if (node->_callback_watchdog)
+  {
+    using Watchdog = rmf_traffic_ros2::CallbackWatchdog;
+    using Duration = rmf_rxcpp::CallbackTiming::Duration;
+    auto observer = std::make_shared<rmf_rxcpp::CallbackTiming::Observer>();
+    std::weak_ptr<Watchdog> weak = node->_callback_watchdog;
+    observer->callback =
+      [weak](const rclcpp::AnyExecutable& executable, Duration duration)
+      {
+        if (const auto watchdog = weak.lock())
+          watchdog->record(Watchdog::describe(executable), duration);
+      };
+
+    observer->job = [weak](const std::string& job, Duration duration)
+      {
+        if (const auto watchdog = weak.lock())
+          watchdog->record(job, duration);
+      };
+
+    rmf_rxcpp::CallbackTiming::set_observer(std::move(observer));
+  }
+
+  if (auto tracer = rmf_traffic_ros2::Tracer::from_parameters(*node))
+    rmf_traffic_ros2::tracing::set_tracer(std::move(tracer));
+
+  // The spin thread waits for ROS events and the worker runs their callbacks
+  // along with the rest of the work of the adapter.
+  using rmf_traffic_ros2::ThreadSettings;
+  node->set_spin_thread_setup(
+    ThreadSettings::from_parameters(*node, "executor")
+    .applier(*node, "executor"));
+
+  const auto rx_worker_settings =
+    ThreadSettings::from_parameters(*node, "rx_worker");
+  if (!rx_worker_settings.is_default())
+  {
+    worker.schedule(
+      [apply = rx_worker_settings.applier(*node, "rx_worker")](const auto&)
+      {
+        apply();
+      });
+  }
+
   return node;
 }
 
@@ -101,13 +165,19 @@ Node::Node(
   const rclcpp::NodeOptions& options)
 : rmf_rxcpp::Transport(std::move(worker), node_name, options)
 {
-  // Do nothing
+  rmf_traffic_ros2::declare_timers_follow_clock(*this);
+}
+
+//==============================================================================
+const std::shared_ptr<rmf_traffic_ros2::Metrics>& Node::metrics() const
+{
+  return _metrics;
 }
 
 //==============================================================================
-auto Node::door_state() const -> const DoorStateObs&
+auto Node::door_state(const std::string& door_name) const -> DoorStateObs
 {
-  return _door_state_obs->observe();
+  return _door_state_obs->observe(door_name);
 }
 
 //==============================================================================
@@ -123,9 +193,9 @@ auto Node::door_request() const -> const DoorRequestPub&
 }
 
 //==============================================================================
-auto Node::lift_state() const -> const LiftStateObs&
+auto Node::lift_state(const std::string& lift_name) const -> LiftStateObs
 {
-  return _lift_state_obs->observe();
+  return _lift_state_obs->observe(lift_name);
 }
 
 //==============================================================================
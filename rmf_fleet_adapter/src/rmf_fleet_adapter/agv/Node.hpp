@@ -20,6 +20,11 @@
 
 #include <rmf_rxcpp/Transport.hpp>
 
+#include <rmf_traffic_ros2/CallbackWatchdog.hpp>
+#include <rmf_traffic_ros2/Metrics.hpp>
+#include <rmf_traffic_ros2/MetricsExporter.hpp>
+#include <rmf_traffic_ros2/Timer.hpp>
+
 #include <rmf_dispenser_msgs/msg/dispenser_request.hpp>
 #include <rmf_dispenser_msgs/msg/dispenser_result.hpp>
 #include <rmf_dispenser_msgs/msg/dispenser_state.hpp>
@@ -51,7 +56,7 @@ public:
 
   using DoorState = rmf_door_msgs::msg::DoorState;
   using DoorStateObs = rxcpp::observable<DoorState::SharedPtr>;
-  const DoorStateObs& door_state() const;
+  DoorStateObs door_state(const std::string& door_name) const;
 
   using DoorSupervisorState = rmf_door_msgs::msg::SupervisorHeartbeat;
   using DoorSupervisorObs = rxcpp::observable<DoorSupervisorState::SharedPtr>;
@@ -63,7 +68,7 @@ public:
 
   using LiftState = rmf_lift_msgs::msg::LiftState;
   using LiftStateObs = rxcpp::observable<LiftState::SharedPtr>;
-  const LiftStateObs& lift_state() const;
+  LiftStateObs lift_state(const std::string& lift_name) const;
 
   using LiftRequest = rmf_lift_msgs::msg::LiftRequest;
   using LiftRequestPub = rclcpp::Publisher<LiftRequest>::SharedPtr;
@@ -113,9 +118,12 @@ public:
     // Race conditions with shutting down the ROS2 node may cause
     // create_wall_timer to throw an exception. We'll catch that exception here
     // so that the thread and process can wind down gracefully.
+    //
+    // When the timers_follow_clock parameter is set, the timer will run on the
+    // clock of the node (e.g. a simulated clock) instead of the wall clock.
     try
     {
-      return create_wall_timer(period, std::move(callback));
+      return rmf_traffic_ros2::create_timer(*this, period, std::move(callback));
     }
     catch (const rclcpp::exceptions::RCLError& e)
     {
@@ -139,6 +147,11 @@ public:
     }
   }
 
+  /// The metrics of every fleet of this adapter, which are exported
+  /// according to the metrics_period and metrics_http_port parameters of the
+  /// node
+  const std::shared_ptr<rmf_traffic_ros2::Metrics>& metrics() const;
+
 private:
 
   Node(
@@ -146,10 +159,10 @@ private:
     const std::string& node_name,
     const rclcpp::NodeOptions& options);
 
-  Bridge<DoorState> _door_state_obs;
+  KeyedBridge<DoorState, std::string> _door_state_obs;
   Bridge<DoorSupervisorState> _door_supervisor_obs;
   DoorRequestPub _door_request_pub;
-  Bridge<LiftState> _lift_state_obs;
+  KeyedBridge<LiftState, std::string> _lift_state_obs;
   LiftRequestPub _lift_request_pub;
   TaskSummaryPub _task_summary_pub;
   DispenserRequestPub _dispenser_request_pub;
@@ -160,6 +173,9 @@ private:
   Bridge<IngestorResult> _ingestor_result_obs;
   Bridge<IngestorState> _ingestor_state_obs;
   FleetStatePub _fleet_state_pub;
+  std::shared_ptr<rmf_traffic_ros2::Metrics> _metrics;
+  std::shared_ptr<rmf_traffic_ros2::MetricsExporter> _metrics_exporter;
+  std::shared_ptr<rmf_traffic_ros2::CallbackWatchdog> _callback_watchdog;
 };
 
 } // namespace agv
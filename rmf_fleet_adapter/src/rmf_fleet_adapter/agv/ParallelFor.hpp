@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__PARALLELFOR_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__PARALLELFOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Call f(i) for every i in [0, count), splitting the range into contiguous
+/// chunks across up to the given number of threads. The calling thread takes
+/// the first chunk, and this returns once every call has finished. Results
+/// should be written into slots indexed by i so that they come out in the same
+/// order no matter how the work was split.
+template<typename F>
+void parallel_for(std::size_t count, std::size_t threads, const F& f)
+{
+  threads = std::max<std::size_t>(1, std::min(threads, count));
+  const std::size_t chunk = (count + threads - 1) / threads;
+
+  std::vector<std::future<void>> futures;
+  for (std::size_t t = 1; t < threads; ++t)
+  {
+    const std::size_t begin = t * chunk;
+    const std::size_t end = std::min(count, begin + chunk);
+    if (begin >= end)
+      break;
+
+    futures.push_back(
+      std::async(
+        std::launch::async,
+        [&f, begin, end]()
+        {
+          for (std::size_t i = begin; i < end; ++i)
+            f(i);
+        }));
+  }
+
+  for (std::size_t i = 0; i < std::min(count, chunk); ++i)
+    f(i);
+
+  for (auto& future : futures)
+    future.get();
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__PARALLELFOR_HPP
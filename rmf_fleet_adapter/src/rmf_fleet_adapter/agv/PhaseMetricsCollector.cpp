@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "PhaseMetricsCollector.hpp"
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+namespace {
+//==============================================================================
+std::string demangle(const char* name)
+{
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status != 0 || !demangled)
+    return name;
+
+  std::string output(demangled);
+  std::free(demangled);
+  return output;
+}
+
+//==============================================================================
+void strip_prefix(std::string& name, const std::string& prefix)
+{
+  if (name.compare(0, prefix.size(), prefix) == 0)
+    name.erase(0, prefix.size());
+}
+
+//==============================================================================
+void strip_suffix(std::string& name, const std::string& suffix)
+{
+  if (name.size() > suffix.size()
+    && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+  {
+    name.erase(name.size() - suffix.size());
+  }
+}
+} // anonymous namespace
+
+//==============================================================================
+PhaseMetricsCollector::PhaseMetricsCollector(
+  std::vector<rmf_traffic::Duration> bucket_bounds)
+: _bucket_bounds(std::move(bucket_bounds))
+{
+  std::sort(_bucket_bounds.begin(), _bucket_bounds.end());
+}
+
+//==============================================================================
+std::vector<rmf_traffic::Duration>
+PhaseMetricsCollector::default_bucket_bounds()
+{
+  using namespace std::chrono_literals;
+  return {
+    100ms, 250ms, 500ms, 1s, 2500ms, 5s, 10s, 30s, 60s, 120s, 300s, 600s
+  };
+}
+
+//==============================================================================
+void PhaseMetricsCollector::record(
+  const std::string& robot,
+  const std::string& phase,
+  const Stage stage,
+  const rmf_traffic::Duration duration)
+{
+  const auto bucket = static_cast<std::size_t>(
+    std::lower_bound(_bucket_bounds.begin(), _bucket_bounds.end(), duration)
+    - _bucket_bounds.begin());
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto insertion = _histograms.insert({Key{robot, phase, stage}, Metrics()});
+  auto& histogram = insertion.first->second;
+  if (insertion.second)
+  {
+    histogram.robot = robot;
+    histogram.phase = phase;
+    histogram.stage = stage;
+    histogram.bucket_bounds = _bucket_bounds;
+    histogram.bucket_counts.resize(_bucket_bounds.size() + 1, 0);
+  }
+
+  if (histogram.count == 0 || duration < histogram.min)
+    histogram.min = duration;
+
+  if (histogram.count == 0 || histogram.max < duration)
+    histogram.max = duration;
+
+  ++histogram.count;
+  histogram.total += duration;
+  ++histogram.bucket_counts[bucket];
+}
+
+//==============================================================================
+auto PhaseMetricsCollector::execution_recorder(std::string robot)
+-> PhaseRecorder
+{
+  return [w = weak_from_this(), robot = std::move(robot)](
+    const std::type_info& phase, const rmf_traffic::Duration duration)
+    {
+      if (const auto self = w.lock())
+      {
+        self->record(
+          robot, self->phase_type(phase), Stage::Execution, duration);
+      }
+    };
+}
+
+//==============================================================================
+auto PhaseMetricsCollector::collect() -> std::vector<Metrics>
+{
+  std::map<Key, Metrics> histograms;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::swap(histograms, _histograms);
+  }
+
+  std::vector<Metrics> output;
+  output.reserve(histograms.size());
+  for (auto& h : histograms)
+    output.emplace_back(std::move(h.second));
+
+  return output;
+}
+
+//==============================================================================
+std::string PhaseMetricsCollector::phase_type(const std::type_info& type)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto insertion = _phase_types.insert({std::type_index(type), ""});
+  if (insertion.second)
+  {
+    auto name = demangle(type.name());
+    strip_prefix(name, "rmf_fleet_adapter::phases::");
+    strip_prefix(name, "rmf_fleet_adapter::");
+    strip_suffix(name, "::ActivePhase");
+    strip_suffix(name, "::Active");
+    insertion.first->second = std::move(name);
+  }
+
+  return insertion.first->second;
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__PHASEMETRICSCOLLECTOR_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__PHASEMETRICSCOLLECTOR_HPP
+
+#include <rmf_fleet_adapter/agv/FleetUpdateHandle.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Collects histograms of how long the stages of the phases of a fleet's
+/// robots take. Each robot, type of phase, and stage gets its own histogram,
+/// which keeps growing until the histograms are collected.
+class PhaseMetricsCollector
+  : public std::enable_shared_from_this<PhaseMetricsCollector>
+{
+public:
+
+  using Metrics = FleetUpdateHandle::PhaseMetrics;
+  using Stage = Metrics::Stage;
+
+  /// Called with the type of a phase and how long it took
+  using PhaseRecorder =
+    std::function<void(const std::type_info& phase, rmf_traffic::Duration)>;
+
+  /// Constructor
+  ///
+  /// \param[in] bucket_bounds
+  ///   The upper bounds of the buckets of every histogram, in increasing order
+  PhaseMetricsCollector(
+    std::vector<rmf_traffic::Duration> bucket_bounds = default_bucket_bounds());
+
+  /// Bucket bounds that span from a tenth of a second to ten minutes
+  static std::vector<rmf_traffic::Duration> default_bucket_bounds();
+
+  /// Record how long a stage of a phase took. This is safe to call from any
+  /// thread.
+  void record(
+    const std::string& robot,
+    const std::string& phase,
+    Stage stage,
+    rmf_traffic::Duration duration);
+
+  /// Get a recorder for how long the phases of a robot are active. The
+  /// recorder does not keep this collector alive.
+  PhaseRecorder execution_recorder(std::string robot);
+
+  /// Get the histograms that have samples, and start new ones
+  std::vector<Metrics> collect();
+
+  /// Get a readable name for a type of phase, e.g. "GoToPlace" for
+  /// phases::GoToPlace::Active.
+  std::string phase_type(const std::type_info& type);
+
+private:
+
+  using Key = std::tuple<std::string, std::string, Stage>;
+
+  std::vector<rmf_traffic::Duration> _bucket_bounds;
+  std::mutex _mutex;
+  std::map<Key, Metrics> _histograms;
+  std::unordered_map<std::type_index, std::string> _phase_types;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__PHASEMETRICSCOLLECTOR_HPP
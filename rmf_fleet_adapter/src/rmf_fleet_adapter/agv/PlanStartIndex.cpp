@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "PlanStartIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+std::size_t PlanStartIndex::CellHash::operator()(
+  const std::pair<int64_t, int64_t>& cell) const
+{
+  const std::size_t x = std::hash<int64_t>()(cell.first);
+  const std::size_t y = std::hash<int64_t>()(cell.second);
+  return x ^ (y + 0x9e3779b9 + (x << 6) + (x >> 2));
+}
+
+//==============================================================================
+PlanStartIndex::PlanStartIndex(
+  const rmf_traffic::agv::Graph& graph,
+  double cell_size)
+{
+  _locations.reserve(graph.num_waypoints());
+  for (std::size_t i = 0; i < graph.num_waypoints(); ++i)
+    _locations.push_back(graph.get_waypoint(i).get_location());
+
+  if (cell_size <= 0.0)
+  {
+    // A cell about as large as a typical lane keeps the number of cells that
+    // each lane spans small without putting too many waypoints in one cell.
+    double total_length = 0.0;
+    for (std::size_t i = 0; i < graph.num_lanes(); ++i)
+    {
+      const auto& lane = graph.get_lane(i);
+      total_length += (_locations[lane.exit().waypoint_index()]
+        - _locations[lane.entry().waypoint_index()]).norm();
+    }
+
+    const double mean_length = graph.num_lanes() > 0 ?
+      total_length / static_cast<double>(graph.num_lanes()) : 1.0;
+
+    cell_size = std::clamp(mean_length, 0.5, 10.0);
+  }
+  _cell_size = cell_size;
+
+  for (std::size_t i = 0; i < graph.num_waypoints(); ++i)
+  {
+    const auto& map = graph.get_waypoint(i).get_map_name();
+    _maps[map][_cell_of(_locations[i])].waypoints.push_back(i);
+  }
+
+  _lanes.reserve(graph.num_lanes());
+  for (std::size_t i = 0; i < graph.num_lanes(); ++i)
+  {
+    const auto& lane = graph.get_lane(i);
+    const std::size_t wp0 = lane.entry().waypoint_index();
+    const std::size_t wp1 = lane.exit().waypoint_index();
+    _lanes.push_back({wp0, wp1});
+
+    // Lanes that cross between maps can never be used to merge onto the graph
+    const auto& map = graph.get_waypoint(wp0).get_map_name();
+    if (map != graph.get_waypoint(wp1).get_map_name())
+      continue;
+
+    // Register the lane in every cell that its bounding box touches. Any
+    // point that is within some distance of the lane is also within that
+    // distance of its bounding box, so a query over the cells near a point
+    // will always find the lane.
+    const auto c0 = _cell_of(_locations[wp0]);
+    const auto c1 = _cell_of(_locations[wp1]);
+    auto& grid = _maps[map];
+    for (auto x = std::min(c0.first, c1.first);
+      x <= std::max(c0.first, c1.first); ++x)
+    {
+      for (auto y = std::min(c0.second, c1.second);
+        y <= std::max(c0.second, c1.second); ++y)
+      {
+        grid[{x, y}].lanes.push_back(i);
+      }
+    }
+  }
+}
+
+//==============================================================================
+std::vector<rmf_traffic::agv::Plan::Start>
+PlanStartIndex::compute_plan_starts(
+  const std::string& map_name,
+  const Eigen::Vector3d& pose,
+  const rmf_traffic::Time start_time,
+  const double max_merge_waypoint_distance,
+  const double max_merge_lane_distance,
+  const double min_lane_length) const
+{
+  const auto map_it = _maps.find(map_name);
+  if (map_it == _maps.end())
+    return {};
+
+  const auto& grid = map_it->second;
+  const Eigen::Vector2d p_location = pose.block<2, 1>(0, 0);
+  const double start_yaw = pose[2];
+
+  const auto cells_within = [&](const double radius)
+    {
+      std::vector<const Cell*> cells;
+      const Eigen::Vector2d r(radius, radius);
+      const auto lower = _cell_of(p_location - r);
+      const auto upper = _cell_of(p_location + r);
+
+      // For a very large radius it is cheaper to visit every occupied cell
+      const double span =
+        (static_cast<double>(upper.first - lower.first) + 1.0)
+        * (static_cast<double>(upper.second - lower.second) + 1.0);
+      if (static_cast<double>(grid.size()) < span)
+      {
+        for (const auto& cell : grid)
+          cells.push_back(&cell.second);
+
+        return cells;
+      }
+
+      for (auto x = lower.first; x <= upper.first; ++x)
+      {
+        for (auto y = lower.second; y <= upper.second; ++y)
+        {
+          const auto it = grid.find({x, y});
+          if (it != grid.end())
+            cells.push_back(&it->second);
+        }
+      }
+
+      return cells;
+    };
+
+  // compute_plan_starts() takes the first waypoint in the graph that is close
+  // enough, so we take the lowest index among the nearby candidates.
+  std::optional<std::size_t> merge_wp;
+  for (const auto* cell : cells_within(max_merge_waypoint_distance))
+  {
+    for (const auto wp : cell->waypoints)
+    {
+      if (merge_wp && *merge_wp < wp)
+        continue;
+
+      if ((p_location - _locations[wp]).norm() < max_merge_waypoint_distance)
+        merge_wp = wp;
+    }
+  }
+
+  if (merge_wp)
+  {
+    return {
+      rmf_traffic::agv::Plan::Start(
+        start_time, *merge_wp, start_yaw, p_location)
+    };
+  }
+
+  std::vector<std::size_t> candidate_lanes;
+  for (const auto* cell : cells_within(max_merge_lane_distance))
+  {
+    candidate_lanes.insert(
+      candidate_lanes.end(), cell->lanes.begin(), cell->lanes.end());
+  }
+
+  // A lane can be registered in several cells, and the starts should be in the
+  // same order that compute_plan_starts() would produce.
+  std::sort(candidate_lanes.begin(), candidate_lanes.end());
+  candidate_lanes.erase(
+    std::unique(candidate_lanes.begin(), candidate_lanes.end()),
+    candidate_lanes.end());
+
+  std::vector<rmf_traffic::agv::Plan::Start> starts;
+  for (const auto l : candidate_lanes)
+  {
+    const auto& lane = _lanes[l];
+    const Eigen::Vector2d& p0 = _locations[lane.first];
+    const Eigen::Vector2d& p1 = _locations[lane.second];
+
+    const double lane_length = (p1 - p0).norm();
+    if (lane_length < min_lane_length)
+      continue;
+
+    const Eigen::Vector2d pn = (p1 - p0) / lane_length;
+    const Eigen::Vector2d p_l = p_location - p0;
+    const double p_l_projection = p_l.dot(pn);
+    if (p_l_projection < 0.0 || lane_length < p_l_projection)
+      continue;
+
+    const double lane_dist = (p_l - p_l_projection*pn).norm();
+    if (lane_dist < max_merge_lane_distance)
+    {
+      starts.emplace_back(
+        start_time, lane.second, start_yaw, p_location, l);
+    }
+  }
+
+  return starts;
+}
+
+//==============================================================================
+std::optional<std::pair<std::size_t, double>>
+PlanStartIndex::nearest_waypoint(
+  const std::string& map_name,
+  const Eigen::Vector2d& location) const
+{
+  const auto map_it = _maps.find(map_name);
+  if (map_it == _maps.end())
+    return std::nullopt;
+
+  const auto& grid = map_it->second;
+  std::optional<std::pair<std::size_t, double>> nearest;
+  const auto check = [&](const Cell& cell)
+    {
+      for (const auto wp : cell.waypoints)
+      {
+        const double dist = (location - _locations[wp]).norm();
+        if (!nearest || dist < nearest->second
+          || (dist == nearest->second && wp < nearest->first))
+        {
+          nearest = std::make_pair(wp, dist);
+        }
+      }
+    };
+
+  // Visit rings of cells around the location, moving outwards. Every cell in
+  // ring r is at least (r-1) cells away from the location, so once the nearest
+  // waypoint so far is closer than that, no further ring can beat it.
+  const auto center = _cell_of(location);
+  for (int64_t r = 0; ; ++r)
+  {
+    if (nearest && nearest->second <= static_cast<double>(r-1) * _cell_size)
+      break;
+
+    // Once the rings cover more cells than are occupied, it is cheaper to
+    // visit every occupied cell.
+    const double span = 2.0 * static_cast<double>(r) + 1.0;
+    if (static_cast<double>(grid.size()) < span * span)
+    {
+      for (const auto& cell : grid)
+        check(cell.second);
+
+      break;
+    }
+
+    for (auto x = center.first - r; x <= center.first + r; ++x)
+    {
+      // Only the outermost columns of the ring need to visit every cell
+      const bool edge_row = (x == center.first - r || x == center.first + r);
+      const int64_t step = edge_row ? 1 : std::max<int64_t>(2*r, 1);
+      for (auto y = center.second - r; y <= center.second + r; y += step)
+      {
+        const auto it = grid.find({x, y});
+        if (it != grid.end())
+          check(it->second);
+      }
+    }
+  }
+
+  return nearest;
+}
+
+//==============================================================================
+double PlanStartIndex::cell_size() const
+{
+  return _cell_size;
+}
+
+//==============================================================================
+std::pair<int64_t, int64_t> PlanStartIndex::_cell_of(
+  const Eigen::Vector2d& p) const
+{
+  return {
+    static_cast<int64_t>(std::floor(p.x() / _cell_size)),
+    static_cast<int64_t>(std::floor(p.y() / _cell_size))
+  };
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__PLANSTARTINDEX_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__PLANSTARTINDEX_HPP
+
+#include <rmf_traffic/agv/Planner.hpp>
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// A spatial index of the waypoints and lanes of a navigation graph, used to
+/// merge a robot that has diverged from the graph back onto it without
+/// checking every waypoint and lane of the graph.
+///
+/// The index is immutable once it has been constructed, so it can be shared
+/// by every robot of a fleet and queried from any thread.
+class PlanStartIndex
+{
+public:
+
+  /// Build an index for the given graph. If cell_size is not positive, a size
+  /// will be chosen based on the lengths of the lanes.
+  PlanStartIndex(const rmf_traffic::agv::Graph& graph, double cell_size = 0.0);
+
+  /// Gives the same result as rmf_traffic::agv::compute_plan_starts() for the
+  /// graph that this index was built from.
+  std::vector<rmf_traffic::agv::Plan::Start> compute_plan_starts(
+    const std::string& map_name,
+    const Eigen::Vector3d& pose,
+    rmf_traffic::Time start_time,
+    double max_merge_waypoint_distance,
+    double max_merge_lane_distance,
+    double min_lane_length) const;
+
+  /// Find the waypoint on the given map that is closest to a location. If
+  /// several waypoints are equally close, the one with the lowest index is
+  /// chosen. This returns a std::nullopt if the map has no waypoints.
+  ///
+  /// \return the index of the waypoint and its distance from the location.
+  std::optional<std::pair<std::size_t, double>> nearest_waypoint(
+    const std::string& map_name,
+    const Eigen::Vector2d& location) const;
+
+  double cell_size() const;
+
+private:
+
+  struct Cell
+  {
+    std::vector<std::size_t> waypoints;
+    std::vector<std::size_t> lanes;
+  };
+
+  struct CellHash
+  {
+    std::size_t operator()(const std::pair<int64_t, int64_t>& cell) const;
+  };
+
+  using Grid = std::unordered_map<std::pair<int64_t, int64_t>, Cell, CellHash>;
+
+  std::pair<int64_t, int64_t> _cell_of(const Eigen::Vector2d& p) const;
+
+  double _cell_size;
+  std::vector<Eigen::Vector2d> _locations;
+  std::vector<std::pair<std::size_t, std::size_t>> _lanes;
+  std::unordered_map<std::string, Grid> _maps;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__PLANSTARTINDEX_HPP
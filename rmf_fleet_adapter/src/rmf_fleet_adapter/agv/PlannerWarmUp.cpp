@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "PlannerWarmUp.hpp"
+
+#include <rmf_rxcpp/PlanningScheduler.hpp>
+
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+namespace {
+//==============================================================================
+struct WarmUp : public std::enable_shared_from_this<WarmUp>
+{
+  std::weak_ptr<const rmf_traffic::agv::Planner> planner;
+  std::vector<std::size_t> goals;
+  std::size_t next_goal = 0;
+  rxcpp::schedulers::worker worker;
+
+  void step()
+  {
+    const auto current = planner.lock();
+    if (!current || next_goal >= goals.size())
+      return;
+
+    const auto goal = rmf_traffic::agv::Plan::Goal(goals[next_goal++]);
+    const auto& graph = current->get_configuration().graph();
+    const auto now = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < graph.num_waypoints(); ++i)
+    {
+      // We don't care about the result, only that the heuristic gets computed
+      // and cached inside the planner.
+      current->setup(rmf_traffic::agv::Plan::Start(now, i, 0.0), goal);
+    }
+
+    worker.schedule(
+      [self = shared_from_this()](const auto&)
+      {
+        self->step();
+      });
+  }
+};
+} // anonymous namespace
+
+//==============================================================================
+void warm_up_planner(std::weak_ptr<const rmf_traffic::agv::Planner> planner)
+{
+  const auto current = planner.lock();
+  if (!current)
+    return;
+
+  auto warm_up = std::make_shared<WarmUp>();
+  const auto& graph = current->get_configuration().graph();
+  for (std::size_t i = 0; i < graph.num_waypoints(); ++i)
+  {
+    const auto& wp = graph.get_waypoint(i);
+    if (wp.name() || wp.is_holding_point())
+      warm_up->goals.push_back(i);
+  }
+
+  if (warm_up->goals.empty())
+    return;
+
+  warm_up->planner = std::move(planner);
+  warm_up->worker = rmf_rxcpp::PlanningScheduler::get(
+    rmf_rxcpp::PlanningPriority::Low).create_worker();
+
+  warm_up->worker.schedule(
+    [warm_up](const auto&)
+    {
+      warm_up->step();
+    });
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
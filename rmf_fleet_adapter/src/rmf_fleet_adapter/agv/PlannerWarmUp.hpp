@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__PLANNERWARMUP_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__PLANNERWARMUP_HPP
+
+#include <rmf_traffic/agv/Planner.hpp>
+
+#include <memory>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Fill the heuristic cache of a planner in the background by estimating the
+/// cost of reaching each goal of its navigation graph from every waypoint.
+/// The goals are the named waypoints and the holding points, since those are
+/// where tasks and traffic send the robots.
+///
+/// The work runs on the low priority planning scheduler, one goal at a time,
+/// so that it never holds up real planning. It stops as soon as the planner
+/// is no longer used by anyone else, for example after its lanes have been
+/// changed and it has been replaced.
+void warm_up_planner(std::weak_ptr<const rmf_traffic::agv::Planner> planner);
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__PLANNERWARMUP_HPP
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "PlanningSlots.hpp"
+
+#include <algorithm>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+std::size_t choose_planning_slot(
+  const std::vector<std::size_t>& loads,
+  std::size_t limit)
+{
+  limit = std::max<std::size_t>(1, limit);
+  const std::size_t usable = std::min(loads.size(), limit);
+
+  std::optional<std::size_t> chosen;
+  for (std::size_t i = 0; i < usable; ++i)
+  {
+    if (!chosen || loads[i] < loads[*chosen])
+      chosen = i;
+  }
+
+  if (!chosen || (loads[*chosen] > 0 && loads.size() < limit))
+    return loads.size();
+
+  return *chosen;
+}
+
+//==============================================================================
+bool use_priority_slot(
+  const std::size_t chosen_load,
+  const std::optional<std::size_t> priority_load)
+{
+  if (chosen_load == 0)
+    return false;
+
+  // A priority slot that has not been made yet is idle
+  return priority_load.value_or(0) < chosen_load;
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__PLANNINGSLOTS_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__PLANNINGSLOTS_HPP
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Choose the planning slot that an allocation should be planned on.
+///
+/// \param[in] loads
+///   The number of allocations that are waiting for or running on each slot
+///
+/// \param[in] limit
+///   How many slots may be used. Slots beyond the limit are never chosen.
+///
+/// \return the index of the least loaded slot, preferring the earliest one.
+/// If every slot is busy and the limit allows another slot, this returns the
+/// number of slots, meaning that a new slot should be made. Once the limit is
+/// reached, allocations queue up on the least loaded slot.
+std::size_t choose_planning_slot(
+  const std::vector<std::size_t>& loads,
+  std::size_t limit);
+
+//==============================================================================
+/// Check whether an urgent allocation should be planned on the priority slot
+/// instead of the slot that was chosen for it, so that it does not wait
+/// behind other allocations.
+///
+/// \param[in] chosen_load
+///   The load of the slot that was chosen by choose_planning_slot()
+///
+/// \param[in] priority_load
+///   The load of the priority slot, or std::nullopt if it has not been made
+bool use_priority_slot(
+  std::size_t chosen_load,
+  std::optional<std::size_t> priority_load);
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__PLANNINGSLOTS_HPP
@@ -226,9 +226,16 @@ RobotContext& RobotContext::current_task_end_state(
   const rmf_task::agv::State& state)
 {
   _current_task_end_state = state;
+  ++_current_task_end_state_version;
   return *this;
 }
 
+//==============================================================================
+std::size_t RobotContext::current_task_end_state_version() const
+{
+  return _current_task_end_state_version;
+}
+
 //==============================================================================
 double RobotContext::current_battery_soc() const
 {
@@ -265,6 +272,218 @@ auto RobotContext::task_planner(
   return *this;
 }
 
+//==============================================================================
+const std::shared_ptr<services::NegotiationAdmission>&
+RobotContext::negotiation_admission() const
+{
+  return _negotiation_admission;
+}
+
+//==============================================================================
+RobotContext& RobotContext::negotiation_admission(
+  std::shared_ptr<services::NegotiationAdmission> admission)
+{
+  _negotiation_admission = std::move(admission);
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<services::NegotiationArena>&
+RobotContext::negotiation_arena() const
+{
+  return _negotiation_arena;
+}
+
+//==============================================================================
+RobotContext& RobotContext::negotiation_arena(
+  std::shared_ptr<services::NegotiationArena> arena)
+{
+  _negotiation_arena = std::move(arena);
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<jobs::PlanCache>& RobotContext::plan_cache() const
+{
+  return _plan_cache;
+}
+
+//==============================================================================
+RobotContext& RobotContext::plan_cache(std::shared_ptr<jobs::PlanCache> cache)
+{
+  _plan_cache = std::move(cache);
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<services::PulloverCandidates>&
+RobotContext::pullover_candidates() const
+{
+  return _pullover_candidates;
+}
+
+//==============================================================================
+RobotContext& RobotContext::pullover_candidates(
+  std::shared_ptr<services::PulloverCandidates> candidates)
+{
+  _pullover_candidates = std::move(candidates);
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<const PlanStartIndex>&
+RobotContext::plan_start_index() const
+{
+  return _plan_start_index;
+}
+
+//==============================================================================
+RobotContext& RobotContext::plan_start_index(
+  std::shared_ptr<const PlanStartIndex> index)
+{
+  _plan_start_index = std::move(index);
+  return *this;
+}
+
+//==============================================================================
+bool RobotContext::phase_lookahead() const
+{
+  return _phase_lookahead;
+}
+
+//==============================================================================
+RobotContext& RobotContext::phase_lookahead(bool enable)
+{
+  _phase_lookahead = enable;
+  return *this;
+}
+
+//==============================================================================
+bool RobotContext::predictive_door_requests() const
+{
+  return _predictive_door_requests;
+}
+
+//==============================================================================
+RobotContext& RobotContext::predictive_door_requests(bool enable)
+{
+  _predictive_door_requests = enable;
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<DoorOpeningTimes>&
+RobotContext::door_opening_times() const
+{
+  return _door_opening_times;
+}
+
+//==============================================================================
+RobotContext& RobotContext::door_opening_times(
+  std::shared_ptr<DoorOpeningTimes> times)
+{
+  _door_opening_times = std::move(times);
+  return *this;
+}
+
+//==============================================================================
+bool RobotContext::predictive_lift_requests() const
+{
+  return _predictive_lift_requests;
+}
+
+//==============================================================================
+RobotContext& RobotContext::predictive_lift_requests(bool enable)
+{
+  _predictive_lift_requests = enable;
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<LiftArrivalTimes>&
+RobotContext::lift_arrival_times() const
+{
+  return _lift_arrival_times;
+}
+
+//==============================================================================
+RobotContext& RobotContext::lift_arrival_times(
+  std::shared_ptr<LiftArrivalTimes> times)
+{
+  _lift_arrival_times = std::move(times);
+  return *this;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Duration> RobotContext::dispenser_lead_time() const
+{
+  return _dispenser_lead_time;
+}
+
+//==============================================================================
+RobotContext& RobotContext::dispenser_lead_time(
+  std::optional<rmf_traffic::Duration> value)
+{
+  _dispenser_lead_time = value;
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<DelayReporter>& RobotContext::delay_reporter() const
+{
+  return _delay_reporter;
+}
+
+//==============================================================================
+RobotContext& RobotContext::delay_reporter(
+  std::shared_ptr<DelayReporter> reporter)
+{
+  _delay_reporter = std::move(reporter);
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<PhaseMetricsCollector>&
+RobotContext::phase_metrics() const
+{
+  return _phase_metrics;
+}
+
+//==============================================================================
+RobotContext& RobotContext::phase_metrics(
+  std::shared_ptr<PhaseMetricsCollector> metrics)
+{
+  _phase_metrics = std::move(metrics);
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<StartedTaskIndex>& RobotContext::started_tasks() const
+{
+  return _started_tasks;
+}
+
+//==============================================================================
+RobotContext& RobotContext::started_tasks(
+  std::shared_ptr<StartedTaskIndex> index)
+{
+  _started_tasks = std::move(index);
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<ChargerIndex>& RobotContext::charger_index() const
+{
+  return _charger_index;
+}
+
+//==============================================================================
+RobotContext& RobotContext::charger_index(std::shared_ptr<ChargerIndex> index)
+{
+  _charger_index = std::move(index);
+  return *this;
+}
+
 //==============================================================================
 void RobotContext::set_lift_entry_watchdog(
   RobotUpdateHandle::Unstable::Watchdog watchdog,
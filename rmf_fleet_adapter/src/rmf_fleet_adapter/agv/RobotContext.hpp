@@ -20,7 +20,20 @@
 
 #include <rxcpp/rx-observable.hpp>
 
+#include <atomic>
+
 #include "Node.hpp"
+#include "../services/NegotiationAdmission.hpp"
+#include "../services/NegotiationArena.hpp"
+#include "../services/PulloverCandidates.hpp"
+#include "../jobs/PlanCache.hpp"
+#include "PlanStartIndex.hpp"
+#include "DelayReporter.hpp"
+#include "DoorOpeningTimes.hpp"
+#include "LiftArrivalTimes.hpp"
+#include "PhaseMetricsCollector.hpp"
+#include "StartedTaskIndex.hpp"
+#include "ChargerIndex.hpp"
 
 namespace rmf_fleet_adapter {
 namespace agv {
@@ -123,6 +136,10 @@ public:
   // current task
   const rmf_task::agv::State& current_task_end_state() const;
 
+  /// Get a counter that changes every time current_task_end_state is set, so
+  /// that anything derived from the end state can tell when it is stale
+  std::size_t current_task_end_state_version() const;
+
   /// Get the current battery state of charge
   double current_battery_soc() const;
 
@@ -140,6 +157,120 @@ public:
   RobotContext& task_planner(
     const std::shared_ptr<const rmf_task::agv::TaskPlanner> task_planner);
 
+  /// Get the admission controller that limits the negotiation responders of
+  /// this robot's fleet. This may be a nullptr, in which case responders are
+  /// started right away.
+  const std::shared_ptr<services::NegotiationAdmission>&
+  negotiation_admission() const;
+
+  /// Set the admission controller for negotiation responders
+  RobotContext& negotiation_admission(
+    std::shared_ptr<services::NegotiationAdmission> admission);
+
+  /// Get the arena that the negotiation jobs of this robot's fleet are
+  /// allocated from. This may be a nullptr, in which case the jobs are
+  /// allocated from the heap.
+  const std::shared_ptr<services::NegotiationArena>& negotiation_arena() const;
+
+  /// Set the arena for negotiation jobs
+  RobotContext& negotiation_arena(
+    std::shared_ptr<services::NegotiationArena> arena);
+
+  /// Get the cache of plans that is shared by the fleet of this robot
+  const std::shared_ptr<jobs::PlanCache>& plan_cache() const;
+
+  /// Set the cache of plans that is shared by the fleet of this robot
+  RobotContext& plan_cache(std::shared_ptr<jobs::PlanCache> cache);
+
+  /// Get the ranking of emergency pullover spots that is shared by the fleet
+  /// of this robot. This may be a nullptr.
+  const std::shared_ptr<services::PulloverCandidates>&
+  pullover_candidates() const;
+
+  /// Set the ranking of emergency pullover spots
+  RobotContext& pullover_candidates(
+    std::shared_ptr<services::PulloverCandidates> candidates);
+
+  /// Get the spatial index of the navigation graph that is shared by the fleet
+  /// of this robot. This may be a nullptr.
+  const std::shared_ptr<const PlanStartIndex>& plan_start_index() const;
+
+  /// Set the spatial index of the navigation graph
+  RobotContext& plan_start_index(std::shared_ptr<const PlanStartIndex> index);
+
+  /// Check whether the phases of this robot should be planned before they
+  /// begin
+  bool phase_lookahead() const;
+
+  /// Specify whether the phases of this robot should be planned before they
+  /// begin
+  RobotContext& phase_lookahead(bool enable);
+
+  /// Check whether this robot asks for doors to open before it arrives at
+  /// them
+  bool predictive_door_requests() const;
+
+  /// Specify whether this robot asks for doors to open before it arrives at
+  /// them
+  RobotContext& predictive_door_requests(bool enable);
+
+  /// Get the opening times of doors that are learned by the fleet of this
+  /// robot. This may be a nullptr.
+  const std::shared_ptr<DoorOpeningTimes>& door_opening_times() const;
+
+  /// Set the opening times of doors that are learned by the fleet
+  RobotContext& door_opening_times(std::shared_ptr<DoorOpeningTimes> times);
+
+  /// Check whether this robot summons lifts before it arrives at them
+  bool predictive_lift_requests() const;
+
+  /// Specify whether this robot summons lifts before it arrives at them
+  RobotContext& predictive_lift_requests(bool enable);
+
+  /// Get the arrival times of lifts that are learned by the fleet of this
+  /// robot. This may be a nullptr.
+  const std::shared_ptr<LiftArrivalTimes>& lift_arrival_times() const;
+
+  /// Set the arrival times of lifts that are learned by the fleet
+  RobotContext& lift_arrival_times(std::shared_ptr<LiftArrivalTimes> times);
+
+  /// Get how long before its arrival at a pickup this robot sends its request
+  /// to the dispenser. A nullopt means the request is sent once the robot has
+  /// arrived.
+  std::optional<rmf_traffic::Duration> dispenser_lead_time() const;
+
+  /// Set how long before its arrival at a pickup this robot sends its request
+  /// to the dispenser
+  RobotContext& dispenser_lead_time(std::optional<rmf_traffic::Duration> value);
+
+  /// Get the reporter that collects the delays of the fleet of this robot.
+  /// This is a nullptr if each delay should be applied as soon as it is noticed.
+  const std::shared_ptr<DelayReporter>& delay_reporter() const;
+
+  /// Set the reporter that collects the delays of the fleet of this robot
+  RobotContext& delay_reporter(std::shared_ptr<DelayReporter> reporter);
+
+  /// Get the collector of the phase metrics of the fleet of this robot. This
+  /// is a nullptr if the fleet does not collect phase metrics.
+  const std::shared_ptr<PhaseMetricsCollector>& phase_metrics() const;
+
+  /// Set the collector of the phase metrics of the fleet of this robot
+  RobotContext& phase_metrics(std::shared_ptr<PhaseMetricsCollector> metrics);
+
+  /// Get the index of the tasks that the robots of this fleet have started.
+  /// This is a nullptr if the robot does not belong to a fleet.
+  const std::shared_ptr<StartedTaskIndex>& started_tasks() const;
+
+  /// Set the index of the tasks that the robots of this fleet have started
+  RobotContext& started_tasks(std::shared_ptr<StartedTaskIndex> index);
+
+  /// Get the charger reservations and estimates of the fleet of this robot.
+  /// This is a nullptr if the robot does not belong to a fleet.
+  const std::shared_ptr<ChargerIndex>& charger_index() const;
+
+  /// Set the charger reservations and estimates of the fleet of this robot
+  RobotContext& charger_index(std::shared_ptr<ChargerIndex> index);
+
   void set_lift_entry_watchdog(
     RobotUpdateHandle::Unstable::Watchdog watchdog,
     rmf_traffic::Duration wait_duration);
@@ -195,7 +326,23 @@ private:
   rxcpp::subjects::subject<double> _battery_soc_publisher;
   rxcpp::observable<double> _battery_soc_obs;
   rmf_task::agv::State _current_task_end_state;
+  std::atomic<std::size_t> _current_task_end_state_version = 0;
   std::shared_ptr<const rmf_task::agv::TaskPlanner> _task_planner;
+  std::shared_ptr<services::NegotiationAdmission> _negotiation_admission;
+  std::shared_ptr<services::NegotiationArena> _negotiation_arena;
+  std::shared_ptr<jobs::PlanCache> _plan_cache;
+  std::shared_ptr<services::PulloverCandidates> _pullover_candidates;
+  std::shared_ptr<const PlanStartIndex> _plan_start_index;
+  bool _phase_lookahead = false;
+  bool _predictive_door_requests = false;
+  std::shared_ptr<DoorOpeningTimes> _door_opening_times;
+  bool _predictive_lift_requests = false;
+  std::shared_ptr<LiftArrivalTimes> _lift_arrival_times;
+  std::optional<rmf_traffic::Duration> _dispenser_lead_time;
+  std::shared_ptr<DelayReporter> _delay_reporter;
+  std::shared_ptr<PhaseMetricsCollector> _phase_metrics;
+  std::shared_ptr<StartedTaskIndex> _started_tasks;
+  std::shared_ptr<ChargerIndex> _charger_index;
 
   RobotUpdateHandle::Unstable::Watchdog _lift_watchdog;
   rmf_traffic::Duration _lift_rewait_duration = std::chrono::seconds(0);
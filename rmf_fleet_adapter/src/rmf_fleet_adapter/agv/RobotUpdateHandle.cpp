@@ -19,6 +19,7 @@
 
 #include <rmf_traffic_ros2/Time.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 namespace rmf_fleet_adapter {
@@ -47,6 +48,107 @@ RobotUpdateHandle::Implementation::get_context() const
   return const_cast<Implementation&>(*this).get_context();
 }
 
+//==============================================================================
+rmf_traffic::agv::Plan::StartSet RobotUpdateHandle::Implementation::lane_starts(
+  const RobotContext& context,
+  const Eigen::Vector3d& position,
+  const std::vector<std::size_t>& lanes,
+  const rmf_traffic::Time now)
+{
+  if (lanes.empty())
+  {
+    // *INDENT-OFF*
+    throw std::runtime_error(
+      "[RobotUpdateHandle::update_position] No lanes specified for "
+      "function signature that requires at least one lane.");
+    // *INDENT-ON*
+  }
+
+  rmf_traffic::agv::Plan::StartSet starts;
+  for (const auto l : lanes)
+  {
+    const auto& graph = context.navigation_graph();
+    const auto wp = graph.get_lane(l).exit().waypoint_index();
+    starts.push_back(
+      {
+        now, wp, position[2], Eigen::Vector2d(position.block<2, 1>(0, 0)), l
+      });
+  }
+
+  return starts;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::agv::Plan::StartSet>
+RobotUpdateHandle::Implementation::merge_starts(
+  const RobotContext& context,
+  const std::string& map_name,
+  const Eigen::Vector3d& position,
+  const double max_merge_waypoint_distance,
+  const double max_merge_lane_distance,
+  const double min_lane_length,
+  const rmf_traffic::Time now)
+{
+  const Eigen::Vector2d location = position.block<2, 1>(0, 0);
+
+  auto& last = last_merge;
+  if (last && last->map_name == map_name
+    && last->max_merge_waypoint_distance == max_merge_waypoint_distance
+    && last->max_merge_lane_distance == max_merge_lane_distance
+    && last->min_lane_length == min_lane_length
+    && (last->location - location).norm() < position_update_tolerance)
+  {
+    // The robot has barely moved, so it will merge onto the graph the same
+    // way as before.
+    auto starts = last->starts;
+    for (auto& start : starts)
+    {
+      start.time(now);
+      start.orientation(position[2]);
+      start.location(location);
+    }
+
+    return starts;
+  }
+
+  const auto& index = context.plan_start_index();
+  auto starts = index ?
+    index->compute_plan_starts(
+    map_name, position, now,
+    max_merge_waypoint_distance, max_merge_lane_distance,
+    min_lane_length) :
+    rmf_traffic::agv::compute_plan_starts(
+    context.navigation_graph(), map_name, position, now,
+    max_merge_waypoint_distance, max_merge_lane_distance,
+    min_lane_length);
+
+  if (starts.empty())
+  {
+    RCLCPP_ERROR(
+      context.node()->get_logger(),
+      "[RobotUpdateHandle::update_position] The robot [%s] has diverged "
+      "from its navigation graph, currently located at <%f, %f, %f> on "
+      "map [%s]", context.requester_id().c_str(),
+      position[0], position[1], position[2], map_name.c_str());
+    last.reset();
+    return std::nullopt;
+  }
+
+  if (position_update_tolerance > 0.0)
+  {
+    last = MergedPosition{
+      map_name,
+      location,
+      max_merge_waypoint_distance,
+      max_merge_lane_distance,
+      min_lane_length,
+      starts
+    };
+  }
+
+  return starts;
+}
+
 //==============================================================================
 void RobotUpdateHandle::interrupted()
 {
@@ -83,26 +185,8 @@ void RobotUpdateHandle::update_position(
 {
   if (const auto context = _pimpl->get_context())
   {
-    if (lanes.empty())
-    {
-      // *INDENT-OFF*
-      throw std::runtime_error(
-        "[RobotUpdateHandle::update_position] No lanes specified for "
-        "function signature that requires at least one lane.");
-      // *INDENT-ON*
-    }
-
     const auto now = rmf_traffic_ros2::convert(context->node()->now());
-    rmf_traffic::agv::Plan::StartSet starts;
-    for (const auto l : lanes)
-    {
-      const auto& graph = context->navigation_graph();
-      const auto wp = graph.get_lane(l).exit().waypoint_index();
-      starts.push_back(
-        {
-          now, wp, position[2], Eigen::Vector2d(position.block<2, 1>(0, 0)), l
-        });
-    }
+    auto starts = Implementation::lane_starts(*context, position, lanes, now);
 
     context->worker().schedule(
       [context, starts = std::move(starts)](const auto&)
@@ -142,7 +226,30 @@ void RobotUpdateHandle::update_position(
   if (const auto context = _pimpl->get_context())
   {
     const auto now = rmf_traffic_ros2::convert(context->node()->now());
-    auto starts = rmf_traffic::agv::compute_plan_starts(
+    auto starts = _pimpl->merge_starts(
+      *context, map_name, position,
+      max_merge_waypoint_distance, max_merge_lane_distance,
+      min_lane_length, now);
+
+    if (!starts)
+      return;
+
+    context->worker().schedule(
+        [context, starts = std::move(starts)](const auto&)
+        {
+          context->_location = std::move(starts);
+        });
+
+      return;
+    }
+
+    const auto& index = context->plan_start_index();
+    auto starts = index ?
+      index->compute_plan_starts(
+      map_name, position, now,
+      max_merge_waypoint_distance, max_merge_lane_distance,
+      min_lane_length) :
+      rmf_traffic::agv::compute_plan_starts(
       context->navigation_graph(), map_name, position, now,
       max_merge_waypoint_distance, max_merge_lane_distance,
       min_lane_length);
@@ -155,17 +262,45 @@ void RobotUpdateHandle::update_position(
         "from its navigation graph, currently located at <%f, %f, %f> on "
         "map [%s]", context->requester_id().c_str(),
         position[0], position[1], position[2], map_name.c_str());
+      last.reset();
       return;
     }
 
+    if (_pimpl->position_update_tolerance > 0.0)
+    {
+      last = Implementation::MergedPosition{
+        map_name,
+        location,
+        max_merge_waypoint_distance,
+        max_merge_lane_distance,
+        min_lane_length,
+        starts
+      };
+    }
+
     context->worker().schedule(
-      [context, starts = std::move(starts)](const auto&)
+      [context, starts = std::move(*starts)](const auto&)
       {
         context->_location = std::move(starts);
       });
   }
 }
 
+//==============================================================================
+RobotUpdateHandle& RobotUpdateHandle::position_update_tolerance(
+  const double distance)
+{
+  _pimpl->position_update_tolerance = std::max(0.0, distance);
+  _pimpl->last_merge.reset();
+  return *this;
+}
+
+//==============================================================================
+double RobotUpdateHandle::position_update_tolerance() const
+{
+  return _pimpl->position_update_tolerance;
+}
+
 //==============================================================================
 RobotUpdateHandle& RobotUpdateHandle::set_charger_waypoint(
   const std::size_t charger_wp)
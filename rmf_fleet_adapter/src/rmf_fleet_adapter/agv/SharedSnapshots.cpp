@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "SharedSnapshots.hpp"
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+SharedSnapshots::SharedSnapshots(
+  std::shared_ptr<const rmf_traffic::schedule::Snappable> source)
+: _source(std::move(source)),
+  _viewer(
+    std::dynamic_pointer_cast<const rmf_traffic::schedule::Viewer>(_source))
+{
+  // Do nothing
+}
+
+//==============================================================================
+std::shared_ptr<const rmf_traffic::schedule::Snapshot>
+SharedSnapshots::snapshot() const
+{
+  if (!_viewer)
+    return _source->snapshot();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_latest && _latest->latest_version() == _viewer->latest_version())
+    return _latest;
+
+  _latest = _source->snapshot();
+  return _latest;
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
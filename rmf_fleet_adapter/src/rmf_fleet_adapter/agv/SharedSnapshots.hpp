@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__SHAREDSNAPSHOTS_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__SHAREDSNAPSHOTS_HPP
+
+#include <rmf_traffic/schedule/Snapshot.hpp>
+#include <rmf_traffic/schedule/Viewer.hpp>
+
+#include <memory>
+#include <mutex>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Hands out one snapshot per version of the schedule that it wraps. When
+/// many robots of a fleet replan at the same time, e.g. after a lane closure,
+/// their planning jobs all share the same immutable snapshot instead of each
+/// making a copy of the same version of the schedule.
+///
+/// Versions can only be checked when the wrapped schedule is also a Viewer,
+/// such as a Mirror. Otherwise every request is passed straight through, which
+/// is fine for sources that already share their snapshots.
+///
+/// This is safe to use from multiple threads.
+class SharedSnapshots : public rmf_traffic::schedule::Snappable
+{
+public:
+
+  SharedSnapshots(
+    std::shared_ptr<const rmf_traffic::schedule::Snappable> source);
+
+  // Documentation inherited
+  std::shared_ptr<const rmf_traffic::schedule::Snapshot> snapshot()
+  const final;
+
+private:
+  std::shared_ptr<const rmf_traffic::schedule::Snappable> _source;
+  std::shared_ptr<const rmf_traffic::schedule::Viewer> _viewer;
+  mutable std::shared_ptr<const rmf_traffic::schedule::Snapshot> _latest;
+  mutable std::mutex _mutex;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__SHAREDSNAPSHOTS_HPP
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "StartedTaskIndex.hpp"
+
+#include <algorithm>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+StartedTaskIndex::StartedTaskIndex(const std::size_t history_per_robot)
+: _history_per_robot(std::max<std::size_t>(1, history_per_robot))
+{
+  // Do nothing
+}
+
+//==============================================================================
+void StartedTaskIndex::started(
+  const std::string& robot,
+  const std::string& task_id)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& history = _history[robot];
+  history.push_back(task_id);
+  ++_count[task_id];
+
+  while (history.size() > _history_per_robot)
+  {
+    const auto it = _count.find(history.front());
+    if (--it->second == 0)
+      _count.erase(it);
+
+    history.pop_front();
+  }
+}
+
+//==============================================================================
+bool StartedTaskIndex::contains(const std::string& task_id) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _count.count(task_id) > 0;
+}
+
+//==============================================================================
+std::size_t StartedTaskIndex::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _count.size();
+}
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
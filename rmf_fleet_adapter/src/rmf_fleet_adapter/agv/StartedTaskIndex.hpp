@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__AGV__STARTEDTASKINDEX_HPP
+#define SRC__RMF_FLEET_ADAPTER__AGV__STARTEDTASKINDEX_HPP
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace rmf_fleet_adapter {
+namespace agv {
+
+//==============================================================================
+/// Keeps track of which tasks the robots of a fleet have started, so that the
+/// fleet can check a task without going through the history of every robot.
+/// Only the most recent tasks of each robot are remembered.
+class StartedTaskIndex
+{
+public:
+
+  /// Constructor
+  ///
+  /// \param[in] history_per_robot
+  ///   How many of the most recently started tasks are remembered for each
+  ///   robot
+  StartedTaskIndex(std::size_t history_per_robot = 100);
+
+  /// Record that a robot has started a task. This is safe to call from any
+  /// thread.
+  void started(const std::string& robot, const std::string& task_id);
+
+  /// Check whether any robot has recently started the task
+  bool contains(const std::string& task_id) const;
+
+  /// Get the number of tasks that are being remembered
+  std::size_t size() const;
+
+private:
+
+  std::size_t _history_per_robot;
+  mutable std::mutex _mutex;
+  std::unordered_map<std::string, std::deque<std::string>> _history;
+
+  // How many times each task appears across the histories of the robots
+  std::unordered_map<std::string, std::size_t> _count;
+};
+
+} // namespace agv
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__AGV__STARTEDTASKINDEX_HPP
@@ -23,6 +23,8 @@
 #include <rmf_utils/Modular.hpp>
 #include <rmf_utils/math.hpp>
 
+#include <rmf_rxcpp/PlanningScheduler.hpp>
+
 #include <rmf_traffic_ros2/Time.hpp>
 
 #include <rmf_traffic/Motion.hpp>
@@ -35,9 +37,68 @@
 
 #include <rclcpp/exceptions.hpp>
 
+#include <atomic>
+
 namespace rmf_fleet_adapter {
 namespace agv {
 
+namespace {
+//==============================================================================
+bool same_path(
+  const std::vector<TrafficLight::Waypoint>& a,
+  const std::vector<TrafficLight::Waypoint>& b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (std::size_t i = 0; i < a.size(); ++i)
+  {
+    const auto& wp_a = a[i];
+    const auto& wp_b = b[i];
+    if (wp_a.map_name() != wp_b.map_name()
+      || wp_a.position() != wp_b.position()
+      || wp_a.yield() != wp_b.yield()
+      || wp_a.mandatory_delay() != wp_b.mandatory_delay())
+      return false;
+  }
+
+  return true;
+}
+
+//==============================================================================
+std::shared_ptr<rmf_traffic::agv::Planner> make_planner(
+  const std::vector<TrafficLight::Waypoint>& path,
+  const rmf_traffic::agv::VehicleTraits& traits)
+{
+  rmf_traffic::agv::Graph graph;
+  for (std::size_t i = 0; i < path.size(); ++i)
+  {
+    const auto& wp = path[i];
+    graph.add_waypoint(wp.map_name(), wp.position().block<2, 1>(0, 0))
+    .set_passthrough_point(!wp.yield())
+    .set_holding_point(wp.yield());
+
+    if (i > 0)
+    {
+      const auto& last_wp = path[i-1];
+      rmf_traffic::agv::Graph::Lane::EventPtr event = nullptr;
+      if (last_wp.mandatory_delay() > std::chrono::nanoseconds(0))
+      {
+        // We use DoorOpen for lack of a better placeholder
+        event = rmf_traffic::agv::Graph::Lane::Event::make(
+          rmf_traffic::agv::Graph::Lane::Wait(last_wp.mandatory_delay()));
+      }
+
+      graph.add_lane(rmf_traffic::agv::Graph::Lane::Node(i-1, event), i);
+    }
+  }
+
+  return std::make_shared<rmf_traffic::agv::Planner>(
+    rmf_traffic::agv::Plan::Configuration(graph, traits),
+    rmf_traffic::agv::Plan::Options(nullptr));
+}
+} // anonymous namespace
+
 //==============================================================================
 class TrafficLight::UpdateHandle::Implementation::Data
   : public std::enable_shared_from_this<Data>
@@ -105,6 +166,21 @@ public:
   std::shared_ptr<services::FindPath> find_path_service;
   rxcpp::subscription find_path_subscription;
 
+  /// Incremented for every timing that gets planned, so that a planning job
+  /// can tell when it has been superseded by a newer one. This is read by the
+  /// planning worker, so it is atomic.
+  std::atomic_size_t timing_version{0};
+
+  /// Planners are built and set up on this worker instead of the worker of the
+  /// robot, since setting up a search computes its heuristic.
+  rxcpp::schedulers::worker planning_worker =
+    rmf_rxcpp::PlanningScheduler::get().create_worker();
+
+  /// The planner of the most recent path. A robot that submits the same path
+  /// again reuses it, along with the heuristic that it has already computed.
+  std::vector<Waypoint> cached_path;
+  std::shared_ptr<rmf_traffic::agv::Planner> cached_planner;
+
   /// A timer that periodically checks if the next checkpoint is ready, when
   /// we're sitting and waiting for the departure time of our current checkpoint
   rclcpp::TimerBase::SharedPtr ready_check_timer;
@@ -132,7 +208,10 @@ public:
     std::size_t version,
     const std::vector<Waypoint>& new_path);
 
-  /// Calculate the preferred timing of the participant
+  /// Calculate the preferred timing of the participant. The planner is built
+  /// and the search is set up on the planning worker, and any timing that was
+  /// still being calculated is cancelled. If new_planner is a nullptr, a
+  /// planner is built for new_path.
   void plan_timing(
     rmf_traffic::agv::Plan::Start start,
     std::size_t version,
@@ -140,6 +219,14 @@ public:
     std::shared_ptr<rmf_traffic::agv::Planner> new_planner,
     std::function<void()> approval_cb);
 
+  /// Run a search that plan_timing has set up
+  void start_find_path(
+    std::size_t version,
+    std::shared_ptr<services::FindPath> service,
+    std::vector<Waypoint> new_path,
+    std::shared_ptr<rmf_traffic::agv::Planner> new_planner,
+    std::function<void()> approval_cb);
+
   rmf_utils::optional<rmf_traffic::schedule::ItineraryVersion> update_timing(
     std::size_t version,
     std::vector<Waypoint> new_path,
@@ -303,39 +390,19 @@ void TrafficLight::UpdateHandle::Implementation::Data::update_path(
   }
 
   std::vector<rmf_traffic::blockade::Writer::Checkpoint> checkpoints;
-
-  rmf_traffic::agv::Graph graph;
-  for (std::size_t i = 0; i < new_path.size(); ++i)
+  for (const auto& wp : new_path)
   {
-    const auto& wp = new_path[i];
-    graph.add_waypoint(wp.map_name(), wp.position().block<2, 1>(0, 0))
-    .set_passthrough_point(!wp.yield())
-    .set_holding_point(wp.yield());
-
-    if (i > 0)
-    {
-      const auto& last_wp = new_path[i-1];
-      rmf_traffic::agv::Graph::Lane::EventPtr event = nullptr;
-      if (last_wp.mandatory_delay() > std::chrono::nanoseconds(0))
-      {
-        // We use DoorOpen for lack of a better placeholder
-        event = rmf_traffic::agv::Graph::Lane::Event::make(
-          rmf_traffic::agv::Graph::Lane::Wait(last_wp.mandatory_delay()));
-      }
-
-      graph.add_lane(rmf_traffic::agv::Graph::Lane::Node(i-1, event), i);
-    }
-
     checkpoints.push_back(
       {wp.position().block<2, 1>(0, 0), wp.map_name(), wp.yield()});
   }
 
-  auto new_planner = std::make_shared<rmf_traffic::agv::Planner>(
-    rmf_traffic::agv::Plan::Configuration(graph, traits),
-    rmf_traffic::agv::Plan::Options(nullptr));
+  // A null planner tells plan_timing to build one for the new path
+  std::shared_ptr<rmf_traffic::agv::Planner> new_planner = nullptr;
+  if (cached_planner && same_path(cached_path, new_path))
+    new_planner = cached_planner;
 
   last_known_location = Location{
-    new_planner->get_configuration().graph().get_waypoint(0).get_map_name(),
+    new_path.front().map_name(),
     new_path.front().position()
   };
 
@@ -365,13 +432,77 @@ void TrafficLight::UpdateHandle::Implementation::Data::plan_timing(
   std::shared_ptr<rmf_traffic::agv::Planner> new_planner,
   std::function<void()> approval_cb)
 {
-  rmf_traffic::agv::Plan::Goal goal(
-    new_planner->get_configuration().graph().num_waypoints()-1);
+  // Any timing that is still being planned has been superseded by this one
+  const std::size_t timing = ++timing_version;
+  if (find_path_service)
+    find_path_service->interrupt();
+
+  find_path_subscription.unsubscribe();
+  find_path_service = nullptr;
+
+  planning_worker.schedule(
+    [w = weak_from_this(),
+    timing,
+    version,
+    start = std::move(start),
+    new_path = std::move(new_path),
+    new_planner = std::move(new_planner),
+    approval_cb = std::move(approval_cb),
+    traits = traits,
+    snapshot = schedule->snapshot(),
+    participant = itinerary.id(),
+    profile = profile,
+    worker = worker](const auto&) mutable
+    {
+      {
+        const auto data = w.lock();
+        if (!data || timing != data->timing_version)
+          return;
+      }
 
-  find_path_service = std::make_shared<services::FindPath>(
-    new_planner, rmf_traffic::agv::Plan::StartSet({std::move(start)}),
-    std::move(goal), schedule->snapshot(), itinerary.id(), profile);
+      if (!new_planner)
+        new_planner = make_planner(new_path, traits);
 
+      rmf_traffic::agv::Plan::Goal goal(
+        new_planner->get_configuration().graph().num_waypoints()-1);
+
+      // Setting up the search computes its heuristic, which is the most
+      // expensive part of this job.
+      auto service = std::make_shared<services::FindPath>(
+        new_planner, rmf_traffic::agv::Plan::StartSet({std::move(start)}),
+        std::move(goal), std::move(snapshot), participant, profile);
+
+      worker.schedule(
+        [w,
+        timing,
+        version,
+        service = std::move(service),
+        new_path = std::move(new_path),
+        new_planner = std::move(new_planner),
+        approval_cb = std::move(approval_cb)](const auto&) mutable
+        {
+          const auto data = w.lock();
+          if (!data || timing != data->timing_version)
+            return;
+
+          data->cached_path = new_path;
+          data->cached_planner = new_planner;
+          data->start_find_path(
+            version, std::move(service), std::move(new_path),
+            std::move(new_planner), std::move(approval_cb));
+        });
+    });
+}
+
+//==============================================================================
+void TrafficLight::UpdateHandle::Implementation::Data::start_find_path(
+  const std::size_t version,
+  std::shared_ptr<services::FindPath> service,
+  std::vector<Waypoint> new_path,
+  std::shared_ptr<rmf_traffic::agv::Planner> new_planner,
+  std::function<void()> approval_cb)
+{
+  find_path_service = std::move(service);
   find_path_subscription = rmf_rxcpp::make_job<services::FindPath::Result>(
     find_path_service)
     .observe_on(rxcpp::identity_same_worker(worker))
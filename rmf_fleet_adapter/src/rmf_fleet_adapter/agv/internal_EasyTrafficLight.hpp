@@ -25,8 +25,11 @@
 
 #include <rmf_rxcpp/RxJobs.hpp>
 
+#include "DeadlineTimer.hpp"
 #include "Node.hpp"
 
+#include <map>
+
 namespace rmf_fleet_adapter {
 namespace agv {
 
@@ -70,7 +73,9 @@ public:
 
   struct CheckpointInfo
   {
-    std::vector<Checkpoint> checkpoints;
+    /// The checkpoints that have not been accepted yet, keyed by their
+    /// waypoint index
+    std::map<std::size_t, Checkpoint> checkpoints;
     std::size_t standby_at;
     OnStandby on_standby;
     Reject reject;
@@ -142,10 +147,10 @@ public:
   std::optional<ImmediateStopInfo> last_received_stop_info;
   std::optional<ResumeInfo> resume_info;
 
-  std::shared_ptr<std::optional<rclcpp::Time>> wait_until;
-  // We use a nested std::shared_ptr here so we can share the timer with its own
-  // callback and have the timer clear itself when it's no longer needed.
-  std::shared_ptr<rclcpp::TimerBase::SharedPtr> wait_timer;
+  // The robot is resumed by this deadline after an immediate stop. The
+  // deadlines of all the traffic lights of an adapter share one timer.
+  std::shared_ptr<DeadlineTimer> deadlines;
+  std::shared_ptr<void> wait_deadline;
 
   std::size_t current_version;
   std::vector<Waypoint> current_path;
@@ -187,6 +192,7 @@ public:
     std::function<void(std::vector<Blocker>)> blocker_,
     rxcpp::schedulers::worker worker_,
     std::shared_ptr<Node> node_,
+    std::shared_ptr<DeadlineTimer> deadlines_,
     std::string name_,
     std::string owner_);
 
@@ -197,6 +203,7 @@ public:
     std::function<void(std::vector<Blocker>)> blocker,
     rxcpp::schedulers::worker worker_,
     std::shared_ptr<Node> node_,
+    std::shared_ptr<DeadlineTimer> deadlines_,
     std::string name_,
     std::string owner_);
 };
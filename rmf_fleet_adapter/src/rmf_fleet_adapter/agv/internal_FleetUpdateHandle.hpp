@@ -32,23 +32,43 @@
 
 #include <rmf_fleet_msgs/msg/dock_summary.hpp>
 
+#include <std_msgs/msg/string.hpp>
+
 #include <rmf_fleet_adapter/agv/FleetUpdateHandle.hpp>
 #include <rmf_fleet_adapter/StandardNames.hpp>
 
+#include "AllocationCache.hpp"
+#include "ChargerIndex.hpp"
+#include "DeadlineTimer.hpp"
+#include "DelayReporter.hpp"
+#include "DoorOpeningTimes.hpp"
+#include "LiftArrivalTimes.hpp"
+#include "FleetSnapshot.hpp"
 #include "Node.hpp"
+#include "PhaseMetricsCollector.hpp"
+#include "PlanStartIndex.hpp"
 #include "RobotContext.hpp"
+#include "SharedSnapshots.hpp"
+#include "StartedTaskIndex.hpp"
 #include "../TaskManager.hpp"
+#include "../services/NegotiationAdmission.hpp"
+#include "../services/NegotiationArena.hpp"
+#include "../services/PulloverCandidates.hpp"
+#include "../jobs/PlanCache.hpp"
 
 #include <rmf_traffic/schedule/Snapshot.hpp>
 #include <rmf_traffic/agv/Interpolate.hpp>
 #include <rmf_traffic/Trajectory.hpp>
 #include <rmf_traffic/agv/LaneClosure.hpp>
 
+#include <rmf_traffic_ros2/MemoryUsage.hpp>
 #include <rmf_traffic_ros2/schedule/Writer.hpp>
 #include <rmf_traffic_ros2/schedule/Negotiation.hpp>
 #include <rmf_traffic_ros2/Time.hpp>
 
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <unordered_set>
 #include <optional>
 
@@ -69,6 +89,54 @@ public:
     rmf_traffic::schedule::ParticipantDescription description,
     ReadyCallback ready_callback) = 0;
 
+  using BulkReadyCallback =
+    std::function<void(std::vector<rmf_traffic::schedule::Participant>)>;
+
+  /// Make many participants at once. The participants are passed to the
+  /// callback in the same order as the descriptions. By default this makes
+  /// each participant separately and waits for all of them.
+  virtual void async_make_participants(
+    std::vector<rmf_traffic::schedule::ParticipantDescription> descriptions,
+    BulkReadyCallback ready_callback)
+  {
+    struct Pending
+    {
+      std::mutex mutex;
+      std::vector<std::optional<rmf_traffic::schedule::Participant>> made;
+      std::size_t remaining;
+      BulkReadyCallback ready_callback;
+    };
+
+    auto pending = std::make_shared<Pending>();
+    pending->made.resize(descriptions.size());
+    pending->remaining = descriptions.size();
+    pending->ready_callback = std::move(ready_callback);
+
+    if (descriptions.empty())
+      return pending->ready_callback({});
+
+    for (std::size_t i = 0; i < descriptions.size(); ++i)
+    {
+      async_make_participant(
+        std::move(descriptions[i]),
+        [pending, i](rmf_traffic::schedule::Participant participant)
+        {
+          std::unique_lock<std::mutex> lock(pending->mutex);
+          pending->made[i] = std::move(participant);
+          if (--pending->remaining > 0)
+            return;
+
+          std::vector<rmf_traffic::schedule::Participant> participants;
+          participants.reserve(pending->made.size());
+          for (auto& p : pending->made)
+            participants.emplace_back(std::move(*p));
+
+          lock.unlock();
+          pending->ready_callback(std::move(participants));
+        });
+    }
+  }
+
   virtual ~ParticipantFactory() = default;
 };
 
@@ -121,6 +189,15 @@ public:
       std::move(ready_callback));
   }
 
+  void async_make_participants(
+    std::vector<rmf_traffic::schedule::ParticipantDescription> descriptions,
+    BulkReadyCallback ready_callback) final
+  {
+    _writer->async_make_participants(
+      std::move(descriptions),
+      std::move(ready_callback));
+  }
+
 private:
   rmf_traffic_ros2::schedule::WriterPtr _writer;
 };
@@ -146,6 +223,32 @@ public:
   rmf_utils::optional<rmf_traffic::Duration> default_maximum_delay =
     std::chrono::nanoseconds(std::chrono::seconds(10));
 
+  // Shared by all the robots of the fleet so that a burst of negotiations
+  // cannot crowd out the rest of the fleet's work
+  std::shared_ptr<services::NegotiationAdmission> negotiation_admission =
+    services::NegotiationAdmission::make();
+
+  // The memory of the fleet's negotiation jobs is recycled through this
+  // instead of the heap
+  std::shared_ptr<services::NegotiationArena> negotiation_arena =
+    services::NegotiationArena::make();
+
+  // Greedy plan costs of the legs that this fleet has travelled
+  std::shared_ptr<jobs::PlanCache> plan_cache =
+    std::make_shared<jobs::PlanCache>();
+
+  // The nearest parking spots of each waypoint, ranked ahead of time so that
+  // emergency pullovers do not need to search the whole graph
+  std::shared_ptr<services::PulloverCandidates> pullover_candidates =
+    std::make_shared<services::PulloverCandidates>();
+
+  // Used to merge robots of this fleet back onto the navigation graph. The
+  // graph of a fleet never changes, so this is built once.
+  std::shared_ptr<const PlanStartIndex> plan_start_index;
+
+  // Wakes up the task managers of this fleet when their next task may begin
+  std::shared_ptr<DeadlineTimer> deadline_timer;
+
   AcceptDeliveryRequest accept_delivery = nullptr;
   std::unordered_map<RobotContextPtr,
     std::shared_ptr<TaskManager>> task_managers = {};
@@ -154,6 +257,14 @@ public:
     fleet_state_pub = nullptr;
   rclcpp::TimerBase::SharedPtr fleet_state_timer = nullptr;
 
+  // When this has a value, the fleet state only includes the robots that
+  // changed since they were last published, except for a keyframe of every
+  // robot once per period.
+  std::optional<rmf_traffic::Duration> fleet_state_keyframe_period;
+  std::chrono::steady_clock::time_point last_fleet_state_keyframe;
+  std::unordered_map<std::string, rmf_fleet_msgs::msg::RobotState>
+  published_robot_states;
+
   // Map task id to pair of <RequestPtr, Assignments>
   using Assignments = rmf_task::agv::TaskPlanner::Assignments;
 
@@ -164,15 +275,24 @@ public:
   // TODO Support for various charging configurations
   std::unordered_set<std::size_t> charging_waypoints = {};
 
+  // Which robots are using each charger, and what it costs to reach them
+  std::shared_ptr<ChargerIndex> charger_index = nullptr;
+
   double current_assignment_cost = 0.0;
   // Map to store task id with assignments for BidNotice
   std::unordered_map<std::string, Assignments> bid_notice_assignments = {};
+  // The assignments_version that each of the bid_notice_assignments was
+  // planned against
+  std::unordered_map<std::string, std::size_t> bid_notice_versions = {};
 
   std::unordered_map<
     std::string, rmf_task::ConstRequestPtr> generated_requests = {};
   std::unordered_map<
     std::string, rmf_task::ConstRequestPtr> assigned_requests = {};
-  std::unordered_set<std::string> cancelled_task_ids = {};
+  // The tasks that have been cancelled, with the time that they were
+  // cancelled, so that repeated cancellations can be acknowledged
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+  cancelled_task_ids = {};
   using TaskProfileMsg = rmf_task_msgs::msg::TaskProfile;
   std::unordered_map<std::string, TaskProfileMsg> task_profile_map = {};
 
@@ -181,6 +301,9 @@ public:
   using BidNotice = rmf_task_msgs::msg::BidNotice;
   using BidNoticeSub = rclcpp::Subscription<BidNotice>::SharedPtr;
   BidNoticeSub bid_notice_sub = nullptr;
+  // Once the fleet declares the task types that it accepts, it listens to the
+  // bid notices of those types instead of the shared bid notice topic
+  std::vector<BidNoticeSub> typed_bid_notice_subs;
 
   using BidProposal = rmf_task_msgs::msg::BidProposal;
   using BidProposalPub = rclcpp::Publisher<BidProposal>::SharedPtr;
@@ -194,16 +317,239 @@ public:
   using DispatchAckPub = rclcpp::Publisher<DispatchAck>::SharedPtr;
   DispatchAckPub dispatch_ack_pub = nullptr;
 
+  using AllocationMetricsMsg = std_msgs::msg::String;
+  using AllocationMetricsPub =
+    rclcpp::Publisher<AllocationMetricsMsg>::SharedPtr;
+  AllocationMetricsPub allocation_metrics_pub = nullptr;
+  AllocationMetricsCallback allocation_metrics_cb = nullptr;
+
+  using PhaseMetricsMsg = std_msgs::msg::String;
+  using PhaseMetricsPub = rclcpp::Publisher<PhaseMetricsMsg>::SharedPtr;
+  PhaseMetricsPub phase_metrics_pub = nullptr;
+  PhaseMetricsCallback phase_metrics_cb = nullptr;
+
+  using MemoryUsageMsg = std_msgs::msg::String;
+  using MemoryUsagePub = rclcpp::Publisher<MemoryUsageMsg>::SharedPtr;
+  MemoryUsagePub memory_usage_pub = nullptr;
+
+  // Counters of the bidding and task allocation of this fleet. They are kept
+  // in the metrics of the adapter's node, labelled with the name of the fleet.
+  struct Instruments
+  {
+    Instruments(rmf_traffic_ros2::Metrics& metrics, const std::string& fleet);
+
+    using Counter = std::shared_ptr<rmf_traffic_ros2::Metrics::Counter>;
+    using Gauge = std::shared_ptr<rmf_traffic_ros2::Metrics::Gauge>;
+    using Histogram = std::shared_ptr<rmf_traffic_ros2::Metrics::Histogram>;
+
+    Counter bid_notices;
+    Counter bid_proposals;
+    Counter tasks_awarded;
+    Counter tasks_cancelled;
+    Histogram notice_to_proposal_seconds;
+    Histogram allocation_queue_seconds;
+    Histogram allocation_planning_seconds;
+    Gauge queued_tasks;
+    Gauge assignment_cost;
+  };
+  std::optional<Instruments> instruments = std::nullopt;
+
+  // The time when each BidNotice was received, for measuring how long it takes
+  // to propose a bid
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+  bid_notice_times = {};
+
+  // The fraction of a BidNotice's time window that may be spent searching for
+  // the optimal assignments of its bid, and the resulting deadline of each bid
+  // that is still being planned
+  double bid_planning_budget = 0.5;
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+  bid_deadlines = {};
+
+  // When this has a value, BidNotices are collected for this long and then
+  // planned together as one bundle
+  std::optional<rmf_traffic::Duration> bid_bundle_period = std::nullopt;
+  struct BundledBid
+  {
+    std::string id;
+    rmf_task::ConstRequestPtr request;
+    TaskProfileMsg task_profile;
+  };
+  std::vector<BundledBid> bid_bundle = {};
+  rclcpp::TimerBase::SharedPtr bid_bundle_timer = nullptr;
+  // The tasks whose bids are being collected or planned in a bundle, or that
+  // were proposed from a bundle and have not been awarded yet. These are
+  // allocated again on their own when they are awarded.
+  std::unordered_set<std::string> bundled_bids = {};
+
   using DockSummary = rmf_fleet_msgs::msg::DockSummary;
   using DockSummarySub = rclcpp::Subscription<DockSummary>::SharedPtr;
   DockSummarySub dock_summary_sub = nullptr;
 
+  std::weak_ptr<FleetUpdateHandle> weak_self = {};
+
+  // Task allocations are planned on these slots so that a long plan does not
+  // freeze the rest of the fleet, and so that several bids can be planned at
+  // once. Each slot has its own copy of the task planner, so a planner is
+  // never used by two threads at once. Results are delivered back to the
+  // fleet's worker.
+  struct PlanningSlot
+  {
+    rxcpp::schedulers::worker worker;
+    std::shared_ptr<rmf_task::agv::TaskPlanner> planner;
+    // The task_planner that the planner was copied from
+    std::shared_ptr<rmf_task::agv::TaskPlanner> source;
+    // The number of allocations that are waiting for or running on the slot
+    std::shared_ptr<std::atomic_size_t> load;
+  };
+  std::vector<PlanningSlot> planning_slots = {};
+  std::size_t max_concurrent_allocations = 4;
+  // The tasks that the robots of this fleet have started, for telling whether
+  // a task can still be replanned or cancelled
+  std::shared_ptr<StartedTaskIndex> started_tasks =
+    std::make_shared<StartedTaskIndex>();
+
+  // High priority bids are planned here when every other slot is busy, so
+  // they do not wait behind low priority planning
+  std::optional<PlanningSlot> priority_slot = std::nullopt;
+
+  // Needed to make copies of the task_planner for the planning_slots
+  rmf_task::ConstRequestFactoryPtr finishing_request = nullptr;
+
+  // Results of recent allocations, so that retried bids and replans do not
+  // need to be planned again. This is cleared whenever the task_planner
+  // changes.
+  AllocationCache allocation_cache = AllocationCache();
+
+  // When true, a new request is allocated by inserting it into the current
+  // queues of the robots instead of replanning every queued request
+  bool incremental_allocation = false;
+
+  // When true, every queued request is replanned in the background after an
+  // incremental allocation is dispatched, and the result replaces the queues
+  // if it lowers their cost
+  bool optimize_in_background = true;
+
+  // When true, a cancelled request is removed from the queue of its robot and
+  // only the rest of that queue is estimated again, instead of replanning
+  // every queued request
+  bool fast_cancellation = false;
+
+  // When true, every queued request is replanned in the background after a
+  // fast cancellation, the same as for optimize_in_background
+  bool optimize_after_cancellation = true;
+
+  // When true, the robots plan their next phase while the current phase is
+  // still active
+  bool phase_lookahead = false;
+
+  // When true, the robots ask for doors to open before they arrive at them
+  bool predictive_door_requests = false;
+
+  // How long the doors that the robots of this fleet pass through take to
+  // open
+  std::shared_ptr<DoorOpeningTimes> door_opening_times =
+    std::make_shared<DoorOpeningTimes>();
+
+  // When true, the robots summon lifts before they arrive at them
+  bool predictive_lift_requests = false;
+
+  // How long the lifts that the robots of this fleet use take to arrive
+  std::shared_ptr<LiftArrivalTimes> lift_arrival_times =
+    std::make_shared<LiftArrivalTimes>();
+
+  // When this has a value, the robots send their dispenser requests this long
+  // before they are expected to arrive at the pickup
+  std::optional<rmf_traffic::Duration> dispenser_lead_time = std::nullopt;
+
+  // When this has a value, the delays of the robots are collected by the
+  // delay_reporter and applied together once per period
+  std::optional<rmf_traffic::Duration> delay_report_period = std::nullopt;
+  std::shared_ptr<DelayReporter> delay_reporter = nullptr;
+  rclcpp::TimerBase::SharedPtr delay_report_timer = nullptr;
+
+  // When this has a value, the robots record how long their phases take in
+  // phase_metrics, and the histograms are published once per period
+  std::optional<rmf_traffic::Duration> phase_metrics_period = std::nullopt;
+  std::shared_ptr<PhaseMetricsCollector> phase_metrics = nullptr;
+  rclcpp::TimerBase::SharedPtr phase_metrics_timer = nullptr;
+
+  // When this has a value, an estimate of the memory held by the containers
+  // of this fleet is published once per period
+  std::optional<rmf_traffic::Duration> memory_usage_period = std::nullopt;
+  rclcpp::TimerBase::SharedPtr memory_usage_timer = nullptr;
+
+  // When this has a value, the runtime state of the fleet is saved to this
+  // file once per period, whenever it has changed since it was last saved
+  std::optional<std::string> persist_file = std::nullopt;
+  rclcpp::TimerBase::SharedPtr persist_timer = nullptr;
+  std::vector<uint8_t> last_persisted = {};
+
+  // The bids that have been submitted and not been dispatched to this fleet
+  // yet, with the time that they were submitted. Bids that are never awarded
+  // to this fleet are forgotten after a while.
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+  open_bids = {};
+
+  // The bookkeeping of a task, such as its request, its profile and the
+  // assignments of its bid, is forgotten once this long has passed since its
+  // BidNotice arrived, unless the task is still being planned, queued or
+  // performed by this fleet. The expiry_timer checks for such tasks.
+  rmf_traffic::Duration bid_lifetime = std::chrono::minutes(10);
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+  task_received = {};
+  rclcpp::TimerBase::SharedPtr expiry_timer = nullptr;
+
+  // The state that was saved before the adapter restarted, holding the robots
+  // whose queues have not been restored yet. BidNotices that arrive while
+  // this has a value are held in warm_start_bids, and they are processed once
+  // every robot has been restored or the warm_start_timer runs out.
+  std::mutex warm_start_mutex;
+  std::optional<FleetSnapshot> warm_start = std::nullopt;
+  std::vector<BidNotice::SharedPtr> warm_start_bids = {};
+  rclcpp::TimerBase::SharedPtr warm_start_timer = nullptr;
+
+  // How many threads may be used to estimate the finish states of the robots
+  // and to evaluate insertions for each robot
+  std::size_t estimation_threads = 1;
+
+  // Incremented whenever the queues of the robots are replaced, so that plans
+  // which were made against older queues can be recognized and redone.
+  std::size_t assignments_version = 0;
+
+  // Allocations that are waiting for or running on a planning slot. When
+  // a new allocation is started for the same key, the old one is cancelled.
+  std::unordered_map<std::string, std::shared_ptr<std::atomic_bool>>
+  allocation_jobs = {};
+
+  // Dispatch requests that arrived while the bid for their task was still
+  // being planned
+  std::unordered_map<std::string, DispatchRequest::SharedPtr>
+  deferred_dispatches = {};
+
   template<typename... Args>
   static std::shared_ptr<FleetUpdateHandle> make(Args&& ... args)
   {
     auto handle = std::shared_ptr<FleetUpdateHandle>(new FleetUpdateHandle);
     handle->_pimpl = rmf_utils::make_unique_impl<Implementation>(
       Implementation{std::forward<Args>(args)...});
+    handle->_pimpl->weak_self = handle;
+
+    handle->_pimpl->plan_start_index = std::make_shared<PlanStartIndex>(
+      (*handle->_pimpl->planner)->get_configuration().graph());
+
+    handle->_pimpl->pullover_candidates->update(*handle->_pimpl->planner);
+
+    // All the robots of the fleet share one snapshot per schedule version
+    handle->_pimpl->snappable = std::make_shared<SharedSnapshots>(
+      std::move(handle->_pimpl->snappable));
+
+    handle->_pimpl->deadline_timer =
+      DeadlineTimer::make(handle->_pimpl->node);
+
+    handle->_pimpl->start_expiry_timer();
+    handle->_pimpl->instruments.emplace(
+      *handle->_pimpl->node->metrics(), handle->_pimpl->name);
 
     handle->_pimpl->fleet_state_pub = handle->_pimpl->node->fleet_state();
     handle->_pimpl->fleet_state_timer =
@@ -228,16 +574,19 @@ public:
       handle->_pimpl->node->create_publisher<DispatchAck>(
       DispatchAckTopicName, default_qos);
 
+    // Publish the metrics of each task allocation
+    handle->_pimpl->allocation_metrics_pub =
+      handle->_pimpl->node->create_publisher<AllocationMetricsMsg>(
+      AllocationMetricsTopicName, default_qos);
+
+    // Publish the histograms of the phase metrics
+    handle->_pimpl->phase_metrics_pub =
+      handle->_pimpl->node->create_publisher<PhaseMetricsMsg>(
+      PhaseMetricsTopicName, default_qos);
+
     // Subscribe BidNotice
     handle->_pimpl->bid_notice_sub =
-      handle->_pimpl->node->create_subscription<BidNotice>(
-      BidNoticeTopicName,
-      default_qos,
-      [w = handle->weak_from_this()](const BidNotice::SharedPtr msg)
-      {
-        if (const auto self = w.lock())
-          self->_pimpl->bid_notice_cb(msg);
-      });
+      subscribe_bid_notices(*handle, BidNoticeTopicName);
 
     // Subscribe DispatchRequest
     handle->_pimpl->dispatch_request_sub =
@@ -269,6 +618,11 @@ public:
         handle->_pimpl->charging_waypoints.insert(i);
     }
 
+    handle->_pimpl->charger_index = std::make_shared<ChargerIndex>(
+      std::vector<std::size_t>(
+        handle->_pimpl->charging_waypoints.begin(),
+        handle->_pimpl->charging_waypoints.end()));
+
     return handle;
   }
 
@@ -276,17 +630,182 @@ public:
 
   void bid_notice_cb(const BidNotice::SharedPtr msg);
 
+  static BidNoticeSub subscribe_bid_notices(
+    FleetUpdateHandle& handle,
+    const std::string& topic_name)
+  {
+    return handle._pimpl->node->create_subscription<BidNotice>(
+      topic_name,
+      rclcpp::SystemDefaultsQoS(),
+      [w = handle.weak_from_this()](const BidNotice::SharedPtr msg)
+      {
+        if (const auto self = w.lock())
+          self->_pimpl->bid_notice_cb(msg);
+      });
+  }
+
+  /// Generate the request for a task profile. This returns a nullptr if the
+  /// profile does not describe a task that this fleet can perform.
+  rmf_task::ConstRequestPtr make_request(const TaskProfileMsg& task_profile);
+
   void dispatch_request_cb(const DispatchRequest::SharedPtr msg);
 
   std::optional<std::size_t> get_nearest_charger(
     const rmf_traffic::agv::Planner::Start& start);
 
-  /// Generate task assignments for a collection of task requests comprising of
-  /// task requests currently in TaskManager queues while optionally including a
-  /// new request and while optionally ignoring a specific request.
-  std::optional<Assignments> allocate_tasks(
-    rmf_task::ConstRequestPtr new_request = nullptr,
-    rmf_task::ConstRequestPtr ignore_request = nullptr) const;
+  /// Publish the bid for a task once its allocation has been planned against
+  /// the given assignments_version. If the allocation was planned for a bundle
+  /// of bids, the bid is charged an equal share of the bundle's cost.
+  void submit_bid(
+    const std::string& id,
+    const TaskProfileMsg& task_profile,
+    const std::optional<Assignments>& allocation_result,
+    std::size_t version,
+    std::size_t bundle_size = 1);
+
+  /// Plan the bids that have been collected in the bid_bundle.
+  void plan_bid_bundle();
+
+  /// Create the context of a robot whose participant has been registered.
+  /// This may be called from several threads at once.
+  std::shared_ptr<RobotContext> make_robot_context(
+    std::shared_ptr<RobotCommandHandle> command,
+    rmf_traffic::agv::Plan::StartSet start,
+    rmf_traffic::schedule::Participant participant);
+
+  /// Hand a new robot to the fleet, so it can negotiate and receive tasks.
+  /// This must be called from the worker of the fleet.
+  void onboard_robot(
+    std::shared_ptr<RobotContext> context,
+    std::function<void(std::shared_ptr<RobotUpdateHandle>)> handle_cb);
+
+  /// Replace the queues of the robots with a new set of assignments.
+  void set_assignments(const Assignments& assignments);
+
+  /// Get the assignments that are currently queued for the robots.
+  Assignments current_assignments() const;
+
+  /// Everything that the task planner needs in order to allocate the tasks of
+  /// the fleet. This is gathered on the fleet's worker.
+  struct AllocationInput
+  {
+    std::shared_ptr<rmf_task::agv::TaskPlanner> task_planner;
+    std::vector<rmf_task::agv::State> states;
+    std::vector<rmf_task::ConstRequestPtr> pending_requests;
+    std::string id;
+
+    // The queued assignments that the new request may be inserted into, or
+    // that the removed_request may be taken out of. This is only provided for
+    // incremental allocation and fast cancellation.
+    std::optional<Assignments> current_assignments;
+
+    // The request that is being cancelled by a fast cancellation
+    rmf_task::ConstRequestPtr removed_request;
+
+    // How many threads may be used to evaluate the robots
+    std::size_t estimation_threads = 1;
+
+    // When this has a value, the search for optimal assignments is stopped at
+    // this time and greedy assignments are used instead
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    rmf_task::ConstRequestFactoryPtr finishing_request;
+
+    // Planning gives up as soon as this is set, since the result would be
+    // thrown away
+    std::shared_ptr<const std::atomic_bool> cancelled;
+  };
+
+  /// Gather a collection of task requests comprising of task requests
+  /// currently in TaskManager queues while optionally including a new request
+  /// and while optionally ignoring a specific request.
+  AllocationInput collect_allocation_input(
+    rmf_task::ConstRequestPtr new_request,
+    rmf_task::ConstRequestPtr ignore_request) const;
+
+  /// Generate task assignments for the collected requests. This is safe to
+  /// call from a planning slot. The greedy field of the metrics is set if the
+  /// deadline of the input forced a greedy assignment.
+  std::optional<Assignments> plan_allocation(
+    const AllocationInput& input,
+    AllocationMetrics& metrics) const;
+
+  /// Called with the result of an allocation and the assignments_version that
+  /// it was planned against.
+  using AllocationCallback = std::function<
+    void(const std::optional<Assignments>& result, std::size_t version)>;
+
+  /// Plan task assignments on a planning slot and deliver the result to
+  /// on_result on the fleet's worker. Starting another allocation with the
+  /// same key cancels this one. If the queues of the robots are replaced while
+  /// this is being planned, it will be planned again before it is delivered,
+  /// unless it is speculative. A speculative result is delivered anyway and
+  /// must be reconciled by the caller using its version.
+  void async_allocate_tasks(
+    const std::string& key,
+    rmf_task::ConstRequestPtr new_request,
+    rmf_task::ConstRequestPtr ignore_request,
+    AllocationCallback on_result,
+    bool speculative = false);
+
+  /// Plan the assignments of several new requests together with every queued
+  /// request, the same as a speculative async_allocate_tasks().
+  void async_allocate_bundle(
+    const std::string& key,
+    const std::vector<rmf_task::ConstRequestPtr>& new_requests,
+    AllocationCallback on_result);
+
+  /// An allocation that is waiting for or running on a planning slot
+  struct AllocationJob
+  {
+    std::string key;
+    rmf_task::ConstRequestPtr new_request;
+    rmf_task::ConstRequestPtr ignore_request;
+    AllocationCallback on_result;
+    bool speculative;
+    std::size_t version;
+    AllocationCache::Key cache_key;
+    std::shared_ptr<std::atomic_bool> cancelled;
+
+    // True for the bid of a high priority task
+    bool urgent = false;
+
+    // Measurements that will be reported once the result is delivered
+    AllocationMetrics metrics = {};
+    std::chrono::steady_clock::time_point submitted = {};
+  };
+
+  /// Look up or plan the allocation of a job whose input has been collected.
+  void start_allocation(AllocationInput input, AllocationJob job);
+
+  /// Deliver the result of an allocation job. This must be called on the
+  /// fleet's worker.
+  void finish_allocation(
+    const AllocationJob& job,
+    const std::optional<Assignments>& result);
+
+  /// Report the metrics of an allocation to the allocation_metrics_cb and the
+  /// allocation_metrics_pub.
+  void report_allocation(
+    const AllocationJob& job,
+    const std::optional<Assignments>& result);
+
+  /// Make the key that the result of an allocation will be cached under.
+  AllocationCache::Key make_cache_key(const AllocationInput& input) const;
+
+  /// Choose the least loaded planning slot, making a new one if the limit
+  /// allows it, and make sure that its planner is up to date. An urgent job
+  /// gets the priority_slot if every other slot is busy.
+  PlanningSlot& choose_planning_slot(bool urgent = false);
+
+  /// Check whether the task with this ID has a high priority.
+  bool is_high_priority(const std::string& task_id) const;
+
+  /// Cancel the allocation with the given key, if there is one.
+  void cancel_allocation(const std::string& key);
+
+  /// Replan every queued request in the background and adopt the result if it
+  /// lowers the cost of the current assignments.
+  void optimize_assignments();
 
   /// Helper function to check if assignments are valid. An assignment set is
   /// invalid if one of the assignments has already begun execution.
@@ -305,7 +824,40 @@ public:
   void fleet_state_publish_period(
     std::optional<rmf_traffic::Duration> value);
 
-  void publish_fleet_state() const;
+  void publish_fleet_state();
+
+  /// Publish the phase metrics that were collected since the last time, and
+  /// give them to the phase_metrics_cb.
+  void publish_phase_metrics();
+
+  /// Add the containers of this fleet to the account and publish it. This
+  /// must be called from the worker of the fleet.
+  void publish_memory_usage(rmf_traffic_ros2::MemoryUsage usage);
+
+  /// (Re)start the timer that forgets the bookkeeping of tasks once their
+  /// bid_lifetime has passed
+  void start_expiry_timer();
+
+  /// Forget the bookkeeping of every task whose bid_lifetime has passed and
+  /// that is not being planned, queued or performed anymore. This must be
+  /// called from the worker of the fleet.
+  void expire_tasks();
+
+  /// Erase everything that this fleet holds about a task
+  void forget_task(const std::string& id);
+
+  /// Save the runtime state of the fleet to the persist_file
+  void persist_state();
+
+  /// Begin restoring the state that was saved before the adapter restarted
+  void begin_warm_start(FleetSnapshot snapshot);
+
+  /// Give a newly added robot back the queue that it had before the adapter
+  /// restarted. This must be called from the worker of the fleet.
+  void restore_robot(const TaskManagerPtr& manager);
+
+  /// Stop holding back BidNotices for the warm start
+  void finish_warm_start();
 };
 
 } // namespace agv
@@ -21,6 +21,8 @@
 #include "RobotContext.hpp"
 #include <rmf_fleet_adapter/agv/RobotUpdateHandle.hpp>
 
+#include <optional>
+
 namespace rmf_fleet_adapter {
 namespace agv {
 
@@ -34,6 +36,20 @@ public:
   RobotUpdateHandle::Unstable unstable = RobotUpdateHandle::Unstable();
   bool reported_loss = false;
 
+  // The last time that the robot was merged back onto the navigation graph
+  struct MergedPosition
+  {
+    std::string map_name;
+    Eigen::Vector2d location;
+    double max_merge_waypoint_distance;
+    double max_merge_lane_distance;
+    double min_lane_length;
+    std::vector<rmf_traffic::agv::Plan::Start> starts;
+  };
+
+  std::optional<MergedPosition> last_merge;
+  double position_update_tolerance = 0.0;
+
   static std::shared_ptr<RobotUpdateHandle> make(RobotContextPtr context)
   {
     std::string name = context->description().name();
@@ -60,6 +76,23 @@ public:
 
   std::shared_ptr<const RobotContext> get_context() const;
 
+  /// Get the starts for update_position(Eigen::Vector3d, std::vector).
+  static rmf_traffic::agv::Plan::StartSet lane_starts(
+    const RobotContext& context,
+    const Eigen::Vector3d& position,
+    const std::vector<std::size_t>& lanes,
+    rmf_traffic::Time now);
+
+  /// Get the starts for update_position(std::string, Eigen::Vector3d). This
+  /// returns a std::nullopt if the robot has diverged from the graph.
+  std::optional<rmf_traffic::agv::Plan::StartSet> merge_starts(
+    const RobotContext& context,
+    const std::string& map_name,
+    const Eigen::Vector3d& position,
+    double max_merge_waypoint_distance,
+    double max_merge_lane_distance,
+    double min_lane_length,
+    rmf_traffic::Time now);
 };
 
 } // namespace agv
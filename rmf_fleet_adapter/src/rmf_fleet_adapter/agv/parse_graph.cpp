@@ -19,13 +19,82 @@
 #include <unordered_map>
 #include <yaml-cpp/yaml.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+
 namespace rmf_fleet_adapter {
 namespace agv {
 
+namespace {
 //==============================================================================
-rmf_traffic::agv::Graph parse_graph(
-  const std::string& graph_file,
-  const rmf_traffic::agv::VehicleTraits& vehicle_traits)
+/// Everything that a graph file says, before it gets turned into a
+/// rmf_traffic::agv::Graph. This is what gets stored in a compiled graph file.
+struct GraphDescription
+{
+  struct Vertex
+  {
+    double x;
+    double y;
+    std::optional<std::string> name;
+    bool is_parking_spot = false;
+    bool is_holding_point = false;
+    bool is_passthrough_point = false;
+    bool is_charger = false;
+    std::optional<std::string> lift;
+  };
+
+  struct Lane
+  {
+    // These are indices within the level of the lane
+    std::size_t begin;
+    std::size_t end;
+    std::optional<std::string> orientation_constraint;
+    std::optional<std::string> demo_mock_floor_name;
+    std::optional<std::string> demo_mock_lift_name;
+    std::optional<std::string> door_name;
+    std::optional<std::string> dock_name;
+  };
+
+  struct Level
+  {
+    std::string map_name;
+    std::vector<Vertex> vertices;
+    std::vector<Lane> lanes;
+  };
+
+  std::vector<Level> levels;
+};
+
+//==============================================================================
+std::optional<std::string> get_string(
+  const YAML::Node& options, const std::string& key)
+{
+  if (const YAML::Node& option = options[key])
+    return option.as<std::string>();
+
+  return std::nullopt;
+}
+
+//==============================================================================
+bool get_flag(const YAML::Node& options, const std::string& key)
+{
+  if (const YAML::Node& option = options[key])
+    return option.as<bool>();
+
+  return false;
+}
+
+//==============================================================================
+GraphDescription load_yaml(const std::string& graph_file)
 {
   const YAML::Node graph_config = YAML::LoadFile(graph_file);
   if (!graph_config)
@@ -51,6 +120,55 @@ rmf_traffic::agv::Graph parse_graph(
     // *INDENT-ON*
   }
 
+  GraphDescription description;
+  for (const auto& level : levels)
+  {
+    GraphDescription::Level level_desc;
+    level_desc.map_name = level.first.as<std::string>();
+
+    const YAML::Node& vertices = level.second["vertices"];
+    for (const auto& vertex : vertices)
+    {
+      const YAML::Node& options = vertex[2];
+      GraphDescription::Vertex v;
+      v.x = vertex[0].as<double>();
+      v.y = vertex[1].as<double>();
+      v.name = get_string(options, "name");
+      v.is_parking_spot = get_flag(options, "is_parking_spot");
+      v.is_holding_point = get_flag(options, "is_holding_point");
+      v.is_passthrough_point = get_flag(options, "is_passthrough_point");
+      v.is_charger = get_flag(options, "is_charger");
+      v.lift = get_string(options, "lift");
+      level_desc.vertices.emplace_back(std::move(v));
+    }
+
+    const YAML::Node& lanes = level.second["lanes"];
+    for (const auto& lane : lanes)
+    {
+      const YAML::Node& options = lane[2];
+      GraphDescription::Lane l;
+      l.begin = lane[0].as<std::size_t>();
+      l.end = lane[1].as<std::size_t>();
+      l.orientation_constraint = get_string(options, "orientation_constraint");
+      l.demo_mock_floor_name = get_string(options, "demo_mock_floor_name");
+      l.demo_mock_lift_name = get_string(options, "demo_mock_lift_name");
+      l.door_name = get_string(options, "door_name");
+      l.dock_name = get_string(options, "dock_name");
+      level_desc.lanes.emplace_back(std::move(l));
+    }
+
+    description.levels.emplace_back(std::move(level_desc));
+  }
+
+  return description;
+}
+
+//==============================================================================
+rmf_traffic::agv::Graph build_graph(
+  const GraphDescription& description,
+  const rmf_traffic::agv::VehicleTraits& vehicle_traits,
+  const std::string& graph_file)
+{
   using Constraint = rmf_traffic::agv::Graph::OrientationConstraint;
   using ConstraintPtr = rmf_utils::clone_ptr<Constraint>;
   using Lane = rmf_traffic::agv::Graph::Lane;
@@ -61,24 +179,37 @@ rmf_traffic::agv::Graph parse_graph(
   std::unordered_map<std::size_t, std::string> lift_of_wp;
   std::size_t vnum = 0;  // To increment lane endpoint ids
 
-  for (const auto& level : levels)
+  for (const auto& level : description.levels)
   {
-    const std::string& map_name = level.first.as<std::string>();
+    const std::string& map_name = level.map_name;
     std::size_t vnum_temp = 0;
 
-    const YAML::Node& vertices = level.second["vertices"];
-    for (const auto& vertex : vertices)
+    std::vector<Eigen::Vector2d> locations;
+    std::vector<uint8_t> flags;
+    locations.reserve(level.vertices.size());
+    flags.reserve(level.vertices.size());
+    for (const auto& vertex : level.vertices)
     {
-      const Eigen::Vector2d location{
-        vertex[0].as<double>(), vertex[1].as<double>()};
+      locations.emplace_back(vertex.x, vertex.y);
+      flags.push_back(static_cast<uint8_t>(
+          (vertex.is_holding_point ? HoldingPoint : 0)
+          | (vertex.is_passthrough_point ? PassthroughPoint : 0)
+          | (vertex.is_parking_spot ? ParkingSpot : 0)
+          | (vertex.is_charger ? Charger : 0)));
+    }
 
-      auto& wp = graph.add_waypoint(map_name, location);
+    const std::size_t first_wp = add_waypoints(
+      graph, {map_name},
+      std::vector<std::size_t>(level.vertices.size(), 0),
+      locations, flags);
 
-      const YAML::Node& options = vertex[2];
-      const YAML::Node& name_option = options["name"];
-      if (name_option)
+    for (const auto& vertex : level.vertices)
+    {
+      auto& wp = graph.get_waypoint(first_wp + vnum_temp);
+
+      if (vertex.name)
       {
-        const std::string& name = name_option.as<std::string>();
+        const std::string& name = *vertex.name;
         if (!name.empty())
         {
           if (!graph.add_key(name, wp.index()))
@@ -93,42 +224,9 @@ rmf_traffic::agv::Graph parse_graph(
       }
       vnum_temp ++;
 
-      const YAML::Node& parking_spot_option = options["is_parking_spot"];
-      if (parking_spot_option)
-      {
-        const bool is_parking_spot = parking_spot_option.as<bool>();
-        if (is_parking_spot)
-          wp.set_parking_spot(true);
-      }
-
-      const YAML::Node& holding_point_option = options["is_holding_point"];
-      if (holding_point_option)
-      {
-        const bool is_holding_point = holding_point_option.as<bool>();
-        if (is_holding_point)
-          wp.set_holding_point(true);
-      }
-
-      const YAML::Node& passthrough_option = options["is_passthrough_point"];
-      if (passthrough_option)
+      if (vertex.lift)
       {
-        const bool is_passthrough_point = passthrough_option.as<bool>();
-        if (is_passthrough_point)
-          wp.set_passthrough_point(true);
-      }
-
-      const YAML::Node& charger_option = options["is_charger"];
-      if (charger_option)
-      {
-        const bool is_charger = charger_option.as<bool>();
-        if (is_charger)
-          wp.set_charger(true);
-      }
-
-      const YAML::Node& lift_option = options["lift"];
-      if (lift_option)
-      {
-        const std::string lift_name = lift_option.as<std::string>();
+        const std::string& lift_name = *vertex.lift;
         if (lift_name != "")
         {
           wps_of_lift[lift_name].push_back(wp.index());
@@ -137,19 +235,14 @@ rmf_traffic::agv::Graph parse_graph(
       }
     }
 
-    const YAML::Node& lanes = level.second["lanes"];
-    for (const auto& lane : lanes)
+    for (const auto& lane : level.lanes)
     {
 
       ConstraintPtr constraint = nullptr;
 
-      const YAML::Node& options = lane[2];
-      const YAML::Node& orientation_constraint_option =
-        options["orientation_constraint"];
-      if (orientation_constraint_option)
+      if (lane.orientation_constraint)
       {
-        const std::string& constraint_label =
-          orientation_constraint_option.as<std::string>();
+        const std::string& constraint_label = *lane.orientation_constraint;
         if (constraint_label == "forward")
         {
           constraint = Constraint::make(
@@ -167,8 +260,8 @@ rmf_traffic::agv::Graph parse_graph(
           // *INDENT-OFF*
           throw std::runtime_error(
             "Unrecognized orientation constraint label given to lane ["
-            + std::to_string(lane[0].as<std::size_t>() + vnum) + ", "
-            + std::to_string(lane[1].as<std::size_t>() + vnum) + "]: ["
+            + std::to_string(lane.begin + vnum) + ", "
+            + std::to_string(lane.end + vnum) + "]: ["
             + constraint_label + "] in graph ["
             + graph_file + "]");
           // *INDENT-ON*
@@ -177,8 +270,8 @@ rmf_traffic::agv::Graph parse_graph(
 
       rmf_utils::clone_ptr<Event> entry_event;
       rmf_utils::clone_ptr<Event> exit_event;
-      std::size_t begin = lane[0].as<std::size_t>() + vnum;
-      std::size_t end = lane[1].as<std::size_t>() + vnum;
+      std::size_t begin = lane.begin + vnum;
+      std::size_t end = lane.end + vnum;
 
       const auto lift_of_begin = lift_of_wp.find(begin);
       const auto lift_of_end = lift_of_wp.find(end);
@@ -231,14 +324,13 @@ rmf_traffic::agv::Graph parse_graph(
       }
       else
       {
-        if (const YAML::Node mock_lift_option = options["demo_mock_floor_name"])
+        if (lane.demo_mock_floor_name)
         {
           // NOTE: This is specifically for cases where users want to have a
           // mock lift in the map. It should not be used for real lifts.
-          const std::string floor_name = mock_lift_option.as<std::string>();
-          const YAML::Node lift_name_option = options["demo_mock_lift_name"];
+          const std::string& floor_name = *lane.demo_mock_floor_name;
 
-          if (!lift_name_option)
+          if (!lane.demo_mock_lift_name)
           {
             // *INDENT-OFF*
             throw std::runtime_error(
@@ -253,7 +345,7 @@ rmf_traffic::agv::Graph parse_graph(
           //
           // We will need to rework this implementation if we ever need to do
           // a demo where multiple robots negotiate the use of a mock lift.
-          const std::string lift_name = lift_name_option.as<std::string>();
+          const std::string& lift_name = *lane.demo_mock_lift_name;
           const rmf_traffic::Duration duration = std::chrono::seconds(4);
           entry_event = Event::make(
             Lane::LiftSessionBegin(lift_name, floor_name, duration));
@@ -261,16 +353,16 @@ rmf_traffic::agv::Graph parse_graph(
             Lane::LiftSessionEnd(lift_name, floor_name,
             rmf_traffic::Duration(0)));
         }
-        else if (const YAML::Node door_name_option = options["door_name"])
+        else if (lane.door_name)
         {
-          const std::string name = door_name_option.as<std::string>();
+          const std::string& name = *lane.door_name;
           const rmf_traffic::Duration duration = std::chrono::seconds(4);
           entry_event = Event::make(Lane::DoorOpen(name, duration));
           exit_event = Event::make(Lane::DoorClose(name, duration));
         }
       }
 
-      if (const YAML::Node docking_option = options["dock_name"])
+      if (lane.dock_name)
       {
         // TODO(MXG): Add support for this
         if (entry_event || exit_event)
@@ -282,7 +374,7 @@ rmf_traffic::agv::Graph parse_graph(
           // *INDENT-ON*
         }
 
-        const std::string dock_name = docking_option.as<std::string>();
+        const std::string& dock_name = *lane.dock_name;
         const rmf_traffic::Duration duration = std::chrono::seconds(5);
         entry_event = Event::make(Lane::Dock(dock_name, duration));
       }
@@ -320,5 +412,567 @@ rmf_traffic::agv::Graph parse_graph(
   return graph;
 }
 
+//==============================================================================
+// Every compiled graph begins with this header. The final byte is the format
+// version.
+constexpr std::array<uint8_t, 8> Header =
+{'R', 'M', 'F', 'G', 'R', 'A', 'P', 1};
+
+// The file is laid out as
+//   [header: 8][body size: u64][body]
+// with every integer stored little-endian at a fixed width and every double
+// stored as the bits of an IEEE 754 binary64. Strings are [size: u32][bytes]
+// and optional strings are preceded by a u8 that says whether they are set.
+constexpr std::size_t PrefixSize = 16;
+
+//==============================================================================
+class ByteWriter
+{
+public:
+
+  std::vector<uint8_t> buffer;
+
+  void u8(const uint8_t value)
+  {
+    buffer.push_back(value);
+  }
+
+  void u32(const uint32_t value)
+  {
+    for (int i = 0; i < 4; ++i)
+      buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+  }
+
+  void u64(const uint64_t value)
+  {
+    for (int i = 0; i < 8; ++i)
+      buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+  }
+
+  void f64(const double value)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    u64(bits);
+  }
+
+  void string(const std::string& value)
+  {
+    u32(static_cast<uint32_t>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+  }
+
+  void optional_string(const std::optional<std::string>& value)
+  {
+    u8(value.has_value());
+    if (value)
+      string(*value);
+  }
+};
+
+//==============================================================================
+class ByteReader
+{
+public:
+
+  ByteReader(const uint8_t* data, const std::size_t size)
+  : _data(data),
+    _size(size)
+  {
+    // Do nothing
+  }
+
+  uint8_t u8()
+  {
+    _require(1);
+    return _data[_index++];
+  }
+
+  uint32_t u32()
+  {
+    _require(4);
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+      value |= static_cast<uint32_t>(_data[_index++]) << (8*i);
+
+    return value;
+  }
+
+  uint64_t u64()
+  {
+    _require(8);
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i)
+      value |= static_cast<uint64_t>(_data[_index++]) << (8*i);
+
+    return value;
+  }
+
+  double f64()
+  {
+    const uint64_t bits = u64();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  std::string string()
+  {
+    const std::size_t size = u32();
+    _require(size);
+    std::string value(reinterpret_cast<const char*>(_data + _index), size);
+    _index += size;
+    return value;
+  }
+
+  std::optional<std::string> optional_string()
+  {
+    if (u8())
+      return string();
+
+    return std::nullopt;
+  }
+
+  /// Get a count of items that each take up at least min_bytes. This protects
+  /// us from reserving absurd amounts of memory for a corrupted file.
+  std::size_t count(const std::size_t min_bytes)
+  {
+    const uint64_t value = u64();
+    if (value > (_size - _index)/min_bytes)
+      throw std::runtime_error("Invalid item count in compiled graph");
+
+    return static_cast<std::size_t>(value);
+  }
+
+  bool done() const
+  {
+    return _index == _size;
+  }
+
+private:
+
+  void _require(const std::size_t bytes) const
+  {
+    if (_size - _index < bytes)
+      throw std::runtime_error("Truncated compiled graph");
+  }
+
+  const uint8_t* _data;
+  std::size_t _size;
+  std::size_t _index = 0;
+};
+
+//==============================================================================
+[[noreturn]] void throw_errno(const std::string& what, const std::string& path)
+{
+  throw std::runtime_error(
+    "Failed to " + what + " [" + path + "]: " + std::strerror(errno));
+}
+
+//==============================================================================
+/// A read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+
+  MappedFile(const std::string& path)
+  {
+    _fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (_fd < 0)
+      throw_errno("open", path);
+
+    struct stat info;
+    if (::fstat(_fd, &info) != 0)
+    {
+      ::close(_fd);
+      throw_errno("stat", path);
+    }
+
+    _size = static_cast<std::size_t>(info.st_size);
+    if (_size == 0)
+      return;
+
+    void* const data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (data == MAP_FAILED)
+    {
+      ::close(_fd);
+      throw_errno("map", path);
+    }
+
+    _data = static_cast<const uint8_t*>(data);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile()
+  {
+    if (_data)
+      ::munmap(const_cast<uint8_t*>(_data), _size);
+    ::close(_fd);
+  }
+
+  const uint8_t* data() const
+  {
+    return _data;
+  }
+
+  std::size_t size() const
+  {
+    return _size;
+  }
+
+private:
+  int _fd = -1;
+  const uint8_t* _data = nullptr;
+  std::size_t _size = 0;
+};
+
+//==============================================================================
+void write_compiled(
+  const GraphDescription& description,
+  const std::string& output_file)
+{
+  ByteWriter body;
+  body.u64(description.levels.size());
+  for (const auto& level : description.levels)
+  {
+    body.string(level.map_name);
+
+    body.u64(level.vertices.size());
+    for (const auto& v : level.vertices)
+    {
+      body.f64(v.x);
+      body.f64(v.y);
+      body.optional_string(v.name);
+      body.u8(
+        static_cast<uint8_t>(v.is_parking_spot)
+        | static_cast<uint8_t>(v.is_holding_point) << 1
+        | static_cast<uint8_t>(v.is_passthrough_point) << 2
+        | static_cast<uint8_t>(v.is_charger) << 3);
+      body.optional_string(v.lift);
+    }
+
+    body.u64(level.lanes.size());
+    for (const auto& l : level.lanes)
+    {
+      body.u64(l.begin);
+      body.u64(l.end);
+      body.optional_string(l.orientation_constraint);
+      body.optional_string(l.demo_mock_floor_name);
+      body.optional_string(l.demo_mock_lift_name);
+      body.optional_string(l.door_name);
+      body.optional_string(l.dock_name);
+    }
+  }
+
+  ByteWriter file;
+  file.buffer.reserve(PrefixSize + body.buffer.size());
+  file.buffer.insert(file.buffer.end(), Header.begin(), Header.end());
+  file.u64(body.buffer.size());
+  file.buffer.insert(
+    file.buffer.end(), body.buffer.begin(), body.buffer.end());
+
+  // Write next to the output and then rename, so that a reader never sees a
+  // partially written file.
+  const std::string tmp_file = output_file + ".tmp";
+  const int fd = ::open(
+    tmp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    throw_errno("create", tmp_file);
+
+  std::size_t written = 0;
+  while (written < file.buffer.size())
+  {
+    const auto n = ::write(
+      fd, file.buffer.data() + written, file.buffer.size() - written);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      ::close(fd);
+      std::filesystem::remove(tmp_file);
+      throw_errno("write to", tmp_file);
+    }
+
+    written += static_cast<std::size_t>(n);
+  }
+
+  ::close(fd);
+  std::filesystem::rename(tmp_file, output_file);
+}
+
+//==============================================================================
+GraphDescription read_compiled(const std::string& compiled_file)
+{
+  const MappedFile file(compiled_file);
+  if (file.size() < PrefixSize
+    || !std::equal(Header.begin(), Header.end(), file.data()))
+  {
+    throw std::runtime_error(
+      "[" + compiled_file + "] is not a compiled graph of a supported version");
+  }
+
+  ByteReader prefix(file.data() + Header.size(), PrefixSize - Header.size());
+  const uint64_t body_size = prefix.u64();
+  if (body_size != file.size() - PrefixSize)
+    throw std::runtime_error("Truncated compiled graph");
+
+  // The smallest encoding of each item, used to sanity check the counts
+  constexpr std::size_t MinLevel = 4 + 8 + 8;
+  constexpr std::size_t MinVertex = 8 + 8 + 1 + 1 + 1;
+  constexpr std::size_t MinLane = 8 + 8 + 5;
+
+  ByteReader body(file.data() + PrefixSize, body_size);
+  GraphDescription description;
+  description.levels.resize(body.count(MinLevel));
+  for (auto& level : description.levels)
+  {
+    level.map_name = body.string();
+
+    level.vertices.resize(body.count(MinVertex));
+    for (auto& v : level.vertices)
+    {
+      v.x = body.f64();
+      v.y = body.f64();
+      v.name = body.optional_string();
+      const uint8_t flags = body.u8();
+      v.is_parking_spot = flags & 1;
+      v.is_holding_point = flags & (1 << 1);
+      v.is_passthrough_point = flags & (1 << 2);
+      v.is_charger = flags & (1 << 3);
+      v.lift = body.optional_string();
+    }
+
+    level.lanes.resize(body.count(MinLane));
+    for (auto& l : level.lanes)
+    {
+      l.begin = body.u64();
+      l.end = body.u64();
+      l.orientation_constraint = body.optional_string();
+      l.demo_mock_floor_name = body.optional_string();
+      l.demo_mock_lift_name = body.optional_string();
+      l.door_name = body.optional_string();
+      l.dock_name = body.optional_string();
+    }
+  }
+
+  if (!body.done())
+    throw std::runtime_error("Unexpected data at the end of compiled graph");
+
+  return description;
+}
+
+//==============================================================================
+std::optional<GraphDescription> load_compiled_if_current(
+  const std::string& graph_file,
+  const GraphWarningCallback& warning)
+{
+  namespace fs = std::filesystem;
+  const auto compiled_file = compiled_graph_file(graph_file);
+
+  std::error_code ec;
+  const auto compiled_time = fs::last_write_time(compiled_file, ec);
+  if (ec)
+    return std::nullopt;
+
+  // If the yaml file is missing, the compiled graph is all we have.
+  const auto yaml_time = fs::last_write_time(graph_file, ec);
+  if (!ec && compiled_time < yaml_time)
+    return std::nullopt;
+
+  try
+  {
+    return read_compiled(compiled_file);
+  }
+  catch (const std::exception& e)
+  {
+    if (warning)
+    {
+      warning(
+        "[parse_graph] Ignoring compiled graph [" + compiled_file + "]: "
+        + e.what());
+    }
+  }
+
+  return std::nullopt;
+}
+} // anonymous namespace
+
+//==============================================================================
+rmf_traffic::agv::Graph parse_graph(
+  const std::string& graph_file,
+  const rmf_traffic::agv::VehicleTraits& vehicle_traits,
+  const GraphWarningCallback& warning)
+{
+  auto description = load_compiled_if_current(graph_file, warning);
+  if (!description)
+    description = load_yaml(graph_file);
+
+  return build_graph(*description, vehicle_traits, graph_file);
+}
+
+//==============================================================================
+std::size_t add_waypoints(
+  rmf_traffic::agv::Graph& graph,
+  const std::vector<std::string>& map_names,
+  const std::vector<std::size_t>& map_indices,
+  const std::vector<Eigen::Vector2d>& locations,
+  const std::vector<uint8_t>& flags)
+{
+  if (map_indices.size() != locations.size()
+    || (!flags.empty() && flags.size() != locations.size()))
+  {
+    // *INDENT-OFF*
+    throw std::runtime_error(
+      "[add_waypoints] Mismatched sizes: " + std::to_string(locations.size())
+      + " locations, " + std::to_string(map_indices.size())
+      + " map indices, and " + std::to_string(flags.size()) + " flags");
+    // *INDENT-ON*
+  }
+
+  for (const auto m : map_indices)
+  {
+    if (m >= map_names.size())
+    {
+      // *INDENT-OFF*
+      throw std::runtime_error(
+        "[add_waypoints] Map index [" + std::to_string(m) + "] is out of "
+        "range for " + std::to_string(map_names.size()) + " map names");
+      // *INDENT-ON*
+    }
+  }
+
+  const std::size_t first = graph.num_waypoints();
+  for (std::size_t i = 0; i < locations.size(); ++i)
+  {
+    auto& wp = graph.add_waypoint(map_names[map_indices[i]], locations[i]);
+    if (flags.empty() || flags[i] == 0)
+      continue;
+
+    const uint8_t f = flags[i];
+    if (f & HoldingPoint)
+      wp.set_holding_point(true);
+
+    if (f & PassthroughPoint)
+      wp.set_passthrough_point(true);
+
+    if (f & ParkingSpot)
+      wp.set_parking_spot(true);
+
+    if (f & Charger)
+      wp.set_charger(true);
+  }
+
+  return first;
+}
+
+//==============================================================================
+std::size_t add_lanes(
+  rmf_traffic::agv::Graph& graph,
+  const std::vector<std::array<std::size_t, 2>>& lanes,
+  const std::vector<std::string>& door_names,
+  const std::vector<std::string>& dock_names,
+  const bool bidirectional)
+{
+  using Lane = rmf_traffic::agv::Graph::Lane;
+  using Event = Lane::Event;
+
+  if ((!door_names.empty() && door_names.size() != lanes.size())
+    || (!dock_names.empty() && dock_names.size() != lanes.size()))
+  {
+    // *INDENT-OFF*
+    throw std::runtime_error(
+      "[add_lanes] Mismatched sizes: " + std::to_string(lanes.size())
+      + " lanes, " + std::to_string(door_names.size()) + " door names, and "
+      + std::to_string(dock_names.size()) + " dock names");
+    // *INDENT-ON*
+  }
+
+  const std::size_t num_waypoints = graph.num_waypoints();
+  for (std::size_t i = 0; i < lanes.size(); ++i)
+  {
+    const auto& lane = lanes[i];
+    if (lane[0] >= num_waypoints || lane[1] >= num_waypoints)
+    {
+      // *INDENT-OFF*
+      throw std::runtime_error(
+        "[add_lanes] Lane [" + std::to_string(lane[0]) + ", "
+        + std::to_string(lane[1]) + "] refers to a waypoint that is not in "
+        "the graph, which has " + std::to_string(num_waypoints)
+        + " waypoints");
+      // *INDENT-ON*
+    }
+
+    if (!door_names.empty() && !door_names[i].empty()
+      && !dock_names.empty() && !dock_names[i].empty())
+    {
+      // *INDENT-OFF*
+      throw std::runtime_error(
+        "[add_lanes] Lane [" + std::to_string(lane[0]) + ", "
+        + std::to_string(lane[1]) + "] has both a door and a dock, which is "
+        "not supported");
+      // *INDENT-ON*
+    }
+  }
+
+  // These durations match the ones that build_graph() uses
+  const rmf_traffic::Duration door_duration = std::chrono::seconds(4);
+  const rmf_traffic::Duration dock_duration = std::chrono::seconds(5);
+
+  const std::size_t first = graph.num_lanes();
+  for (std::size_t i = 0; i < lanes.size(); ++i)
+  {
+    const auto& lane = lanes[i];
+    rmf_utils::clone_ptr<Event> entry_event;
+    rmf_utils::clone_ptr<Event> exit_event;
+
+    const std::string* const door =
+      door_names.empty() || door_names[i].empty() ? nullptr : &door_names[i];
+    if (door)
+    {
+      entry_event = Event::make(Lane::DoorOpen(*door, door_duration));
+      exit_event = Event::make(Lane::DoorClose(*door, door_duration));
+    }
+    else if (!dock_names.empty() && !dock_names[i].empty())
+    {
+      entry_event = Event::make(Lane::Dock(dock_names[i], dock_duration));
+    }
+
+    graph.add_lane({lane[0], entry_event}, {lane[1], exit_event});
+
+    if (!bidirectional)
+      continue;
+
+    if (door)
+    {
+      graph.add_lane(
+        {lane[1], Event::make(Lane::DoorOpen(*door, door_duration))},
+        {lane[0], Event::make(Lane::DoorClose(*door, door_duration))});
+    }
+    else
+    {
+      graph.add_lane(lane[1], lane[0]);
+    }
+  }
+
+  return first;
+}
+
+//==============================================================================
+std::string compiled_graph_file(const std::string& graph_file)
+{
+  return graph_file + ".bin";
+}
+
+//==============================================================================
+void compile_graph(
+  const std::string& graph_file,
+  const std::string& output_file)
+{
+  write_compiled(load_yaml(graph_file), output_file);
+}
+
 } // namespace agv
 } // namespace rmf_fleet_adapter
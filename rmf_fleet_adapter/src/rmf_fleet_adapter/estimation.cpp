@@ -19,6 +19,18 @@
 
 #include <rmf_traffic_ros2/Time.hpp>
 
+namespace {
+//==============================================================================
+template<typename... Args>
+void update_position(TravelInfo& info, Args&& ... args)
+{
+  if (info.updates)
+    info.updates->update_position(info.updater, std::forward<Args>(args)...);
+  else
+    info.updater->update_position(std::forward<Args>(args)...);
+}
+} // anonymous namespace
+
 //==============================================================================
 void check_path_finish(
   rclcpp::Node* node,
@@ -64,7 +76,7 @@ void check_path_finish(
   {
     // We are close enough to the goal that we will say the robot is
     // currently located there.
-    info.updater->update_position(*wp.graph_index(), l.yaw);
+    update_position(info, *wp.graph_index(), l.yaw);
   }
 
   assert(info.path_finished_callback);
@@ -178,7 +190,7 @@ void estimate_midlane_state(
     {
       // This implies that the robot is either waiting at or rotating on the
       // waypoint.
-      info.updater->update_position(target_gi, l.yaw);
+      update_position(info, target_gi, l.yaw);
     }
     else if (const auto* forward_lane =
       info.graph->lane_from(last_gi, target_gi))
@@ -202,13 +214,14 @@ void estimate_midlane_state(
         }
       }
 
-      info.updater->update_position({l.x, l.y, l.yaw}, std::move(lanes));
+      update_position(
+        info, Eigen::Vector3d{l.x, l.y, l.yaw}, std::move(lanes));
     }
   }
 
   // The target should always have a graph index, because only the first
   // waypoint in a command should ever be lacking a graph index.
-  info.updater->update_position({l.x, l.y, l.yaw}, target_gi);
+  update_position(info, Eigen::Vector3d{l.x, l.y, l.yaw}, target_gi);
 }
 
 //==============================================================================
@@ -228,14 +241,15 @@ void estimate_state(
     {
       // We will assume that the robot is meant to be on this last known
       // waypoint.
-      info.updater->update_position(last_known_wp.index(), l.yaw);
+      update_position(info, last_known_wp.index(), l.yaw);
       return;
     }
     else if (dist < 1.5)
     {
       // We will assume that the robot is meant to be at this last known
       // waypoint, but is kind of diverged.
-      info.updater->update_position({l.x, l.y, l.yaw}, last_known_wp.index());
+      update_position(
+        info, Eigen::Vector3d{l.x, l.y, l.yaw}, last_known_wp.index());
       return;
     }
 
@@ -254,7 +268,7 @@ void estimate_state(
     return;
   }
 
-  info.updater->update_position(last_known_map, {l.x, l.y, l.yaw});
+  update_position(info, last_known_map, Eigen::Vector3d{l.x, l.y, l.yaw});
 }
 
 //==============================================================================
@@ -273,15 +287,30 @@ void estimate_waypoint(
   const Eigen::Vector2d p(l.x, l.y);
   const rmf_traffic::agv::Graph::Waypoint* closest_wp = nullptr;
   double nearest_dist = std::numeric_limits<double>::infinity();
-  for (std::size_t i = 0; i < info.graph->num_waypoints(); ++i)
+
+  std::optional<std::pair<std::size_t, double>> indexed;
+  if (info.graph_index && !last_known_map.empty())
+    indexed = info.graph_index->nearest_waypoint(last_known_map, p);
+
+  if (indexed)
+  {
+    closest_wp = &info.graph->get_waypoint(indexed->first);
+    nearest_dist = indexed->second;
+  }
+  else
   {
-    const auto& wp = info.graph->get_waypoint(i);
-    const Eigen::Vector2d p_wp = wp.get_location();
-    const double dist = (p - p_wp).norm();
-    if (dist < nearest_dist)
+    // We do not know which map the robot is on, or the map has no waypoints,
+    // so look through every waypoint of the graph.
+    for (std::size_t i = 0; i < info.graph->num_waypoints(); ++i)
     {
-      closest_wp = &wp;
-      nearest_dist = dist;
+      const auto& wp = info.graph->get_waypoint(i);
+      const Eigen::Vector2d p_wp = wp.get_location();
+      const double dist = (p - p_wp).norm();
+      if (dist < nearest_dist)
+      {
+        closest_wp = &wp;
+        nearest_dist = dist;
+      }
     }
   }
 
@@ -296,5 +325,5 @@ void estimate_waypoint(
       info.robot_name.c_str(), info.fleet_name.c_str(), nearest_dist);
   }
 
-  info.updater->update_position(closest_wp->index(), l.yaw);
+  update_position(info, closest_wp->index(), l.yaw);
 }
@@ -18,9 +18,12 @@
 #ifndef SRC__FULL_CONTROL__ESTIMATION_HPP
 #define SRC__FULL_CONTROL__ESTIMATION_HPP
 
+#include <rmf_fleet_adapter/agv/FleetUpdateHandle.hpp>
 #include <rmf_fleet_adapter/agv/RobotUpdateHandle.hpp>
 #include <rmf_fleet_adapter/agv/RobotCommandHandle.hpp>
 
+#include "agv/PlanStartIndex.hpp"
+
 #include <rmf_fleet_msgs/msg/robot_state.hpp>
 
 #include <rclcpp/node.hpp>
@@ -38,9 +41,17 @@ struct TravelInfo
   RequestCompleted path_finished_callback;
   rmf_utils::optional<std::size_t> last_known_wp;
   rmf_fleet_adapter::agv::RobotUpdateHandlePtr updater;
+
+  // When this is set, the estimated positions are added to it instead of being
+  // given to the updater right away.
+  rmf_fleet_adapter::agv::FleetUpdateHandle::RobotUpdates* updates = nullptr;
   std::shared_ptr<const rmf_traffic::agv::Graph> graph;
   std::shared_ptr<const rmf_traffic::agv::VehicleTraits> traits;
 
+  // A spatial index of the graph that is shared by every robot of the fleet.
+  // When this is null, nearest waypoint searches go through the whole graph.
+  std::shared_ptr<const rmf_fleet_adapter::agv::PlanStartIndex> graph_index;
+
   std::string fleet_name;
   std::string robot_name;
 
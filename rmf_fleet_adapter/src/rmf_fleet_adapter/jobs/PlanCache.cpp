@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "PlanCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+
+namespace rmf_fleet_adapter {
+namespace jobs {
+
+namespace {
+//==============================================================================
+// Orientations that round to the same hundredth of a radian share a key
+const double OrientationResolution = 1e-2;
+
+//==============================================================================
+int64_t discretize(double orientation)
+{
+  return static_cast<int64_t>(std::round(orientation/OrientationResolution));
+}
+
+//==============================================================================
+template<typename T>
+void hash_combine(std::size_t& seed, const T& value)
+{
+  seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+} // anonymous namespace
+
+//==============================================================================
+PlanCache::PlanCache(std::size_t capacity)
+: _capacity(std::max<std::size_t>(capacity, 1))
+{
+  // Do nothing
+}
+
+//==============================================================================
+std::optional<double> PlanCache::greedy_cost(
+  const std::shared_ptr<const rmf_traffic::agv::Planner>& planner,
+  const rmf_traffic::agv::Plan::Start& start,
+  const rmf_traffic::agv::Plan::Goal& goal)
+{
+  const auto key = make_key(start, goal);
+  if (!key)
+    return std::nullopt;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _use_planner(planner);
+  const auto it = _entries.find(*key);
+  if (it == _entries.end())
+    return std::nullopt;
+
+  return it->second.cost;
+}
+
+//==============================================================================
+void PlanCache::greedy_cost(
+  const std::shared_ptr<const rmf_traffic::agv::Planner>& planner,
+  const rmf_traffic::agv::Plan::Start& start,
+  const rmf_traffic::agv::Plan::Goal& goal,
+  const rmf_traffic::agv::Plan& plan)
+{
+  const auto key = make_key(start, goal);
+  if (!key)
+    return;
+
+  const auto& graph = planner->get_configuration().graph();
+  std::optional<std::vector<std::size_t>> lanes = std::vector<std::size_t>();
+  std::size_t last = start.waypoint();
+  for (const auto& wp : plan.get_waypoints())
+  {
+    const auto index = wp.graph_index();
+    if (!index || *index == last)
+      continue;
+
+    const auto* lane = graph.lane_from(last, *index);
+    if (!lane)
+    {
+      // The plan skipped over some waypoints, so we cannot tell exactly which
+      // lanes it uses. This entry will be forgotten whenever any lane closes.
+      lanes = std::nullopt;
+      break;
+    }
+
+    lanes->push_back(lane->index());
+    last = *index;
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _use_planner(planner);
+
+  // The legs of a fleet are normally few and stable, so we do not bother with
+  // tracking which entries are stale. If the cache ever overflows, we start
+  // over.
+  if (_entries.size() >= _capacity && _entries.find(*key) == _entries.end())
+    _entries.clear();
+
+  _entries[*key] = Entry{plan.get_cost(), std::move(lanes), _closed_lanes};
+}
+
+//==============================================================================
+void PlanCache::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _entries.clear();
+}
+
+//==============================================================================
+std::size_t PlanCache::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _entries.size();
+}
+
+//==============================================================================
+bool PlanCache::Key::operator==(const Key& other) const
+{
+  return start_waypoint == other.start_waypoint
+    && start_orientation == other.start_orientation
+    && goal_waypoint == other.goal_waypoint
+    && goal_orientation == other.goal_orientation;
+}
+
+//==============================================================================
+std::size_t PlanCache::Hash::operator()(const Key& key) const
+{
+  std::size_t seed = 0;
+  hash_combine(seed, key.start_waypoint);
+  hash_combine(seed, key.start_orientation);
+  hash_combine(seed, key.goal_waypoint);
+  hash_combine(seed, key.goal_orientation.value_or(
+      std::numeric_limits<int64_t>::max()));
+  return seed;
+}
+
+//==============================================================================
+auto PlanCache::make_key(
+  const rmf_traffic::agv::Plan::Start& start,
+  const rmf_traffic::agv::Plan::Goal& goal) -> std::optional<Key>
+{
+  if (start.location())
+    return std::nullopt;
+
+  std::optional<int64_t> goal_orientation;
+  if (const auto* orientation = goal.orientation())
+    goal_orientation = discretize(*orientation);
+
+  return Key{
+    start.waypoint(),
+    discretize(start.orientation()),
+    goal.waypoint(),
+    goal_orientation
+  };
+}
+
+//==============================================================================
+void PlanCache::_use_planner(
+  const std::shared_ptr<const rmf_traffic::agv::Planner>& planner)
+{
+  if (_planner.lock() == planner)
+    return;
+
+  _planner = planner;
+
+  const auto& config = planner->get_configuration();
+  const auto& graph = config.graph();
+  const auto& closures = config.lane_closures();
+  std::vector<std::size_t> closed_lanes;
+  for (std::size_t i = 0; i < graph.num_lanes(); ++i)
+  {
+    if (closures.is_closed(i))
+      closed_lanes.push_back(i);
+  }
+
+  if (graph.num_waypoints() != _num_waypoints
+    || graph.num_lanes() != _num_lanes)
+  {
+    // This is a different graph, so nothing that we know applies anymore
+    _entries.clear();
+    _num_waypoints = graph.num_waypoints();
+    _num_lanes = graph.num_lanes();
+    _closed_lanes = std::move(closed_lanes);
+    return;
+  }
+
+  std::unordered_set<std::size_t> newly_closed;
+  std::unordered_set<std::size_t> newly_opened(
+    _closed_lanes.begin(), _closed_lanes.end());
+  for (const auto lane : closed_lanes)
+  {
+    if (newly_opened.erase(lane) == 0)
+      newly_closed.insert(lane);
+  }
+
+  _closed_lanes = std::move(closed_lanes);
+  if (newly_closed.empty() && newly_opened.empty())
+    return;
+
+  const auto affected = [&](const Entry& entry) -> bool
+    {
+      if (!newly_closed.empty())
+      {
+        if (!entry.lanes)
+          return true;
+
+        for (const auto lane : *entry.lanes)
+        {
+          if (newly_closed.count(lane))
+            return true;
+        }
+      }
+
+      for (const auto lane : entry.closed_lanes)
+      {
+        if (newly_opened.count(lane))
+          return true;
+      }
+
+      return false;
+    };
+
+  for (auto it = _entries.begin(); it != _entries.end(); )
+  {
+    if (affected(it->second))
+      it = _entries.erase(it);
+    else
+      ++it;
+  }
+}
+
+} // namespace jobs
+} // namespace rmf_fleet_adapter
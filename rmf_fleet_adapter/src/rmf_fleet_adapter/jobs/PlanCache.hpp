@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__JOBS__PLANCACHE_HPP
+#define SRC__RMF_FLEET_ADAPTER__JOBS__PLANCACHE_HPP
+
+#include <rmf_traffic/agv/Planner.hpp>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace jobs {
+
+//==============================================================================
+/// Remembers the cost of the greedy (schedule-agnostic) plan for each leg that
+/// a fleet has travelled. The greedy plan only depends on the navigation graph
+/// and its lane closures, so its cost can be reused for as long as the fleet
+/// keeps using the same graph.
+///
+/// Closing or opening lanes replaces the planner of the fleet. When that
+/// happens, only the entries that could be affected are forgotten:
+/// * Closing a lane can only make paths more expensive, so an entry survives
+///   unless its plan travels along the closed lane.
+/// * Opening a lane can only make paths cheaper, so an entry survives unless
+///   it was computed while that lane was closed.
+///
+/// Only starts that are exactly on a waypoint are cached, since the cost from
+/// anywhere along a lane would depend on the precise location.
+class PlanCache
+{
+public:
+
+  static constexpr std::size_t DefaultCapacity = 256;
+
+  PlanCache(std::size_t capacity = DefaultCapacity);
+
+  /// Get the cost of the greedy plan from start to goal, if it is known for
+  /// this planner.
+  std::optional<double> greedy_cost(
+    const std::shared_ptr<const rmf_traffic::agv::Planner>& planner,
+    const rmf_traffic::agv::Plan::Start& start,
+    const rmf_traffic::agv::Plan::Goal& goal);
+
+  /// Remember the greedy plan from start to goal.
+  void greedy_cost(
+    const std::shared_ptr<const rmf_traffic::agv::Planner>& planner,
+    const rmf_traffic::agv::Plan::Start& start,
+    const rmf_traffic::agv::Plan::Goal& goal,
+    const rmf_traffic::agv::Plan& plan);
+
+  /// Forget everything that has been cached.
+  void clear();
+
+  std::size_t size() const;
+
+private:
+
+  struct Key
+  {
+    std::size_t start_waypoint;
+    int64_t start_orientation;
+    std::size_t goal_waypoint;
+    std::optional<int64_t> goal_orientation;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct Hash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Entry
+  {
+    double cost;
+
+    /// The lanes that the plan travels along, or std::nullopt if they could
+    /// not be identified
+    std::optional<std::vector<std::size_t>> lanes;
+
+    /// The lanes that were closed when the plan was found
+    std::vector<std::size_t> closed_lanes;
+  };
+
+  static std::optional<Key> make_key(
+    const rmf_traffic::agv::Plan::Start& start,
+    const rmf_traffic::agv::Plan::Goal& goal);
+
+  void _use_planner(
+    const std::shared_ptr<const rmf_traffic::agv::Planner>& planner);
+
+  std::size_t _capacity;
+  std::weak_ptr<const rmf_traffic::agv::Planner> _planner;
+  std::size_t _num_waypoints = 0;
+  std::size_t _num_lanes = 0;
+  std::vector<std::size_t> _closed_lanes;
+  std::unordered_map<Key, Entry, Hash> _entries;
+  mutable std::mutex _mutex;
+};
+
+} // namespace jobs
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__JOBS__PLANCACHE_HPP
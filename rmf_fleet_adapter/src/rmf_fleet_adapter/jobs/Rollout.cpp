@@ -25,14 +25,23 @@ Rollout::Rollout(
   rmf_traffic::agv::Planner::Result result,
   rmf_traffic::schedule::ParticipantId blocker,
   rmf_traffic::Duration span,
-  rmf_utils::optional<std::size_t> max_rollouts)
-: _rollout(std::move(result)),
+  rmf_utils::optional<std::size_t> max_rollouts,
+  std::optional<rmf_traffic::Duration> budget)
+: _options(result.options()),
+  _rollout(std::move(result)),
   _blocker(blocker),
   _span(span),
-  _max_rollouts(max_rollouts)
+  _max_rollouts(max_rollouts),
+  _budget(budget)
 {
   // Do nothing
 }
 
+//==============================================================================
+void Rollout::interrupt()
+{
+  *_interrupted = true;
+}
+
 } // namespace jobs
 } // namespace rmf_fleet_adapter
@@ -20,6 +20,10 @@
 
 #include <rmf_traffic/agv/Rollout.hpp>
 
+#include <atomic>
+#include <memory>
+#include <optional>
+
 namespace rmf_fleet_adapter {
 namespace jobs {
 
@@ -31,22 +35,39 @@ public:
   struct Result
   {
     std::vector<rmf_traffic::schedule::Itinerary> alternatives;
+
+    /// True if the expansion was cut short by interrupt() or by the budget,
+    /// in which case the alternatives may be incomplete.
+    bool interrupted = false;
   };
 
+  /// \param[in] budget
+  ///   The most wall-clock time that the expansion may take. When it runs
+  ///   out, the expansion stops and reports whatever alternatives it has
+  ///   found so far. A std::nullopt means there is no limit.
   Rollout(
     rmf_traffic::agv::Planner::Result result,
     rmf_traffic::schedule::ParticipantId blocker,
     rmf_traffic::Duration span,
-    rmf_utils::optional<std::size_t> max_rollouts = rmf_utils::nullopt);
+    rmf_utils::optional<std::size_t> max_rollouts = rmf_utils::nullopt,
+    std::optional<rmf_traffic::Duration> budget = std::nullopt);
 
   template<typename Subscriber, typename Worker>
   void operator()(const Subscriber& s, const Worker& w);
 
+  /// Stop the expansion as soon as possible. This is safe to call from any
+  /// thread.
+  void interrupt();
+
 private:
+  rmf_traffic::agv::Planner::Options _options;
   rmf_traffic::agv::Rollout _rollout;
   rmf_traffic::schedule::ParticipantId _blocker;
   rmf_traffic::Duration _span;
   rmf_utils::optional<std::size_t> _max_rollouts;
+  std::optional<rmf_traffic::Duration> _budget;
+  std::shared_ptr<std::atomic_bool> _interrupted =
+    std::make_shared<std::atomic_bool>(false);
 };
 
 } // namespace jobs
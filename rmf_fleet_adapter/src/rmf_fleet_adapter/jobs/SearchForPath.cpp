@@ -27,16 +27,19 @@ SearchForPath::SearchForPath(
   rmf_traffic::agv::Plan::Goal goal,
   std::shared_ptr<const rmf_traffic::schedule::Snapshot> schedule,
   rmf_traffic::schedule::ParticipantId participant_id,
-  const std::shared_ptr<const rmf_traffic::Profile>& profile)
+  const std::shared_ptr<const rmf_traffic::Profile>& profile,
+  std::shared_ptr<PlanCache> cache)
 : _planner(std::move(planner)),
   _starts(std::move(starts)),
   _goal(std::move(goal)),
   _schedule(std::move(schedule)),
   _participant_id(participant_id),
-  _worker(rxcpp::schedulers::make_event_loop().create_worker())
+  _cache(std::move(cache)),
+  _worker(rmf_rxcpp::PlanningScheduler::get().create_worker())
 {
   auto greedy_options = _planner->get_default_options();
   greedy_options.validator(nullptr);
+  greedy_options.interrupt_flag(_greedy_interrupt_flag);
 
   // TODO(MXG): This is a gross hack to side-step the saturation issue that
   // happens when too many start conditions are given. That problem should be
@@ -72,7 +75,11 @@ SearchForPath::SearchForPath(
   compliant_options.validator(
     rmf_traffic::agv::ScheduleRouteValidator::make(
       _schedule, _participant_id, *profile));
-  compliant_options.maximum_cost_estimate(_compliant_leeway*base_cost);
+  if (_cache)
+    _cached_greedy_cost = _cache->greedy_cost(_planner, _starts.front(), _goal);
+
+  compliant_options.maximum_cost_estimate(
+    _compliant_leeway*_cached_greedy_cost.value_or(base_cost));
   compliant_options.interrupt_flag(_interrupt_flag);
   auto compliant_setup = _planner->setup(_starts, _goal, compliant_options);
 
@@ -86,6 +93,13 @@ void SearchForPath::interrupt()
   *_interrupt_flag = true;
 }
 
+//==============================================================================
+void SearchForPath::cancel()
+{
+  *_interrupt_flag = true;
+  *_greedy_interrupt_flag = true;
+}
+
 //==============================================================================
 Planning& SearchForPath::greedy()
 {
@@ -116,5 +130,21 @@ void SearchForPath::set_cost_limit(double cost)
   _explicit_cost_limit = cost;
 }
 
+//==============================================================================
+bool SearchForPath::_conflict_free(const rmf_traffic::agv::Plan& plan) const
+{
+  const auto& validator = _compliant_job->progress().options().validator();
+  if (!validator)
+    return false;
+
+  for (const auto& route : plan.get_itinerary())
+  {
+    if (validator->find_conflict(route))
+      return false;
+  }
+
+  return true;
+}
+
 } // namespace jobs
 } // namespace rmf_fleet_adapter
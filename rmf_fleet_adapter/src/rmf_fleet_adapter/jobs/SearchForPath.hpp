@@ -19,6 +19,7 @@
 #define SRC__RMF_FLEET_ADAPTER__JOBS__SEARCHFORPATH_HPP
 
 #include "Planning.hpp"
+#include "PlanCache.hpp"
 
 namespace rmf_fleet_adapter {
 namespace jobs {
@@ -40,7 +41,8 @@ public:
     rmf_traffic::agv::Plan::Goal goal,
     std::shared_ptr<const rmf_traffic::schedule::Snapshot> schedule,
     rmf_traffic::schedule::ParticipantId participant_id,
-    const std::shared_ptr<const rmf_traffic::Profile>& profile);
+    const std::shared_ptr<const rmf_traffic::Profile>& profile,
+    std::shared_ptr<PlanCache> cache = nullptr);
 
   enum class Type
   {
@@ -62,6 +64,10 @@ public:
   // soon as it's ready.
   void interrupt();
 
+  // Stop both planners. This is used when nobody is waiting for the result
+  // anymore.
+  void cancel();
+
   void set_cost_limit(double cost);
 
   Planning& greedy();
@@ -71,6 +77,13 @@ public:
   const Planning& compliant() const;
 
 private:
+
+  template<typename Subscriber>
+  void _search_greedy(const Subscriber& s);
+
+  /// Check a plan against the schedule that the compliant job is using
+  bool _conflict_free(const rmf_traffic::agv::Plan& plan) const;
+
   std::shared_ptr<const rmf_traffic::agv::Planner> _planner;
   rmf_traffic::agv::Plan::StartSet _starts;
   rmf_traffic::agv::Plan::Goal _goal;
@@ -84,8 +97,16 @@ private:
   // 2. Provide a backup plan if a compliant job can't be found
   std::shared_ptr<Planning> _greedy_job;
   rmf_rxcpp::subscription_guard _greedy_sub;
+  std::shared_ptr<bool> _greedy_interrupt_flag = std::make_shared<bool>(false);
+  bool _greedy_started = false;
   bool _greedy_finished = false;
 
+  // If the cost of the greedy plan for this leg is already known, the
+  // compliant job is limited by it right away, and the greedy job is only run
+  // if the compliant job cannot find a plan.
+  std::shared_ptr<PlanCache> _cache;
+  std::optional<double> _cached_greedy_cost;
+
   // The compliant job makes the plan which is optimal without conflicting with
   // any other traffic currently on the schedule. In some cases, it might not
   // be feasible to find an acceptable compliant job, either because
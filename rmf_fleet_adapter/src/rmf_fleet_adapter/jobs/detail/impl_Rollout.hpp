@@ -27,7 +27,38 @@ namespace jobs {
 template<typename Subscriber, typename Worker>
 void Rollout::operator()(const Subscriber& s, const Worker&)
 {
-  s.on_next(Result{_rollout.expand(_blocker, _span, _max_rollouts)});
+  // The expansion cannot be paused and resumed, so instead we make sure that
+  // it checks in often enough to be stopped. The planner calls the
+  // interrupter regularly while it searches, so we use it to enforce the
+  // budget as well as interrupt(), on top of whatever interrupter the original
+  // plan was given.
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  if (_budget)
+    deadline = std::chrono::steady_clock::now() + *_budget;
+
+  auto interrupted = std::make_shared<bool>(false);
+  auto options = _options;
+  options.interrupter(
+    [interrupter = _options.interrupter(), flag = _interrupted,
+    deadline, interrupted]() -> bool
+    {
+      if (*flag || (deadline && *deadline < std::chrono::steady_clock::now()))
+        *interrupted = true;
+      else if (interrupter && interrupter())
+        *interrupted = true;
+
+      return *interrupted;
+    });
+
+  if (*_interrupted)
+  {
+    s.on_next(Result{{}, true});
+    s.on_completed();
+    return;
+  }
+
+  auto alternatives = _rollout.expand(_blocker, _span, options, _max_rollouts);
+  s.on_next(Result{std::move(alternatives), *interrupted});
   s.on_completed();
 }
 
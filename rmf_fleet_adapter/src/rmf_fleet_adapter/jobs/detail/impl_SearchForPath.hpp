@@ -32,7 +32,7 @@ void SearchForPath::operator()(const Subscriber& s, const Worker&)
       if (const auto search = weak.lock())
       {
         // This gets triggered if the subscription is discarded
-        search->interrupt();
+        search->cancel();
       }
     });
 
@@ -55,6 +55,124 @@ void SearchForPath::operator()(const Subscriber& s, const Worker&)
       _explicit_cost_limit);
   }
 
+  // If we already know what the greedy plan will cost, then there is no need
+  // to search for it unless the compliant search fails.
+  if (!_cached_greedy_cost || _explicit_cost_limit)
+    _search_greedy(s);
+
+  _compliant_sub = rmf_rxcpp::make_job<Planning::Result>(_compliant_job)
+    .observe_on(rxcpp::identity_same_worker(_worker))
+    .subscribe(
+    [this, s](const Planning::Result& result)
+    {
+      auto show_greedy = _greedy_finished ?
+      _greedy_job : std::shared_ptr<Planning>(nullptr);
+
+      Result next{show_greedy, _compliant_job, Type::compliant};
+
+      auto& r = result.job.progress();
+      if (r.success())
+      {
+        if (!_greedy_started)
+        {
+          // The cost limit of the compliant search was based on the cached
+          // greedy cost, so we can report the plan without a greedy search.
+          _compliant_finished = true;
+          s.on_next(next);
+          s.on_completed();
+          return;
+        }
+
+        // Return the successful schedule-compliant plan
+        if (_greedy_finished || _explicit_cost_limit)
+        {
+          s.on_next(next);
+        }
+        _compliant_finished = true;
+
+        if (_greedy_finished)
+        {
+          s.on_completed();
+        }
+        else if (!_explicit_cost_limit)
+        {
+          // The two searches run on separate threads. Whoever is waiting on
+          // us will use the compliant plan now that it has been found, so
+          // there is no reason to make them wait for the greedy search to
+          // catch up.
+          *_greedy_interrupt_flag = true;
+          _greedy_sub.get().unsubscribe();
+          s.on_next(next);
+          s.on_completed();
+        }
+
+        return;
+      }
+
+      if (*_interrupt_flag || r.saturated() || !r.cost_estimate())
+      {
+        if (_greedy_finished)
+        {
+          s.on_next(next);
+          s.on_completed();
+        }
+        else if (_explicit_cost_limit)
+        {
+          s.on_next(next);
+        }
+
+        _compliant_finished = true;
+        if (!_greedy_started)
+          _search_greedy(s);
+
+        return;
+      }
+
+      if (_explicit_cost_limit)
+      {
+        // An explicit cost limit means this is part of a Job, so we should
+        // report an update whenever we get an update.
+        s.on_next(next);
+        // We do not automatically resume, because that should be the choice of
+        // whoever we are reporting to.
+        return;
+      }
+
+      if (_greedy_finished)
+      {
+        // We don't have an explicit cost limit, so we'll just check if the
+        // greedy job search has granted us any more leeway.
+        const double new_maximum =
+        _compliant_leeway * _greedy_job->progress()->get_cost();
+
+        if (*r.options().maximum_cost_estimate() < new_maximum)
+        {
+          // Push the maximum out a bit more and let the job try again.
+          r.options().maximum_cost_estimate(new_maximum);
+          result.job.resume();
+          return;
+        }
+
+        // We shouldn't keep trying, because we have exceeded the cost limit, even
+        // when accounting for the greedy plan cost.
+        s.on_next(next);
+        s.on_completed();
+        return;
+      }
+
+      // Discard the job because it can no longer produce an acceptable result.
+      // The SearchForPath will continue looking for a greedy plan.
+      _compliant_finished = true;
+      if (!_greedy_started)
+        _search_greedy(s);
+    });
+}
+
+//==============================================================================
+template<typename Subscriber>
+void SearchForPath::_search_greedy(const Subscriber& s)
+{
+  _greedy_started = true;
   _greedy_sub = rmf_rxcpp::make_job<Planning::Result>(_greedy_job)
     .observe_on(rxcpp::identity_same_worker(_worker))
     .subscribe(
@@ -64,6 +182,12 @@ void SearchForPath::operator()(const Subscriber& s, const Worker&)
       if (!search)
         return;
 
+      if (*search->_greedy_interrupt_flag)
+      {
+        // The result of the greedy search is no longer needed
+        return;
+      }
+
       auto show_compliant = search->_compliant_finished ?
       search->_compliant_job : std::shared_ptr<Planning>(nullptr);
 
@@ -72,6 +196,28 @@ void SearchForPath::operator()(const Subscriber& s, const Worker&)
       const auto& r = result.job.progress();
       if (r.success())
       {
+        if (search->_cache)
+        {
+          search->_cache->greedy_cost(
+            search->_planner, search->_starts.front(), search->_goal, *r);
+        }
+
+        if (!search->_compliant_finished && !search->_explicit_cost_limit
+        && search->_starts.size() == 1 && search->_conflict_free(*r))
+        {
+          // Nothing can be cheaper than the greedy plan, so if it happens to
+          // be free of conflicts then it is as good as the compliant plan
+          // could ever be. We stop the compliant search and let the robot get
+          // going right away.
+          *search->_interrupt_flag = true;
+          search->_compliant_sub.get().unsubscribe();
+          search->_compliant_finished = true;
+          search->_greedy_finished = true;
+          s.on_next(next);
+          s.on_completed();
+          return;
+        }
+
         if (search->_compliant_finished)
         {
           s.on_next(next);
@@ -156,85 +302,6 @@ void SearchForPath::operator()(const Subscriber& s, const Worker&)
       // We do not automatically resume, because that should be the choice of
       // whoever we are reporting to
     });
-
-  _compliant_sub = rmf_rxcpp::make_job<Planning::Result>(_compliant_job)
-    .observe_on(rxcpp::identity_same_worker(_worker))
-    .subscribe(
-    [this, s](const Planning::Result& result)
-    {
-      auto show_greedy = _greedy_finished ?
-      _greedy_job : std::shared_ptr<Planning>(nullptr);
-
-      Result next{show_greedy, _compliant_job, Type::compliant};
-
-      auto& r = result.job.progress();
-      if (r.success())
-      {
-        // Return the successful schedule-compliant plan
-        if (_greedy_finished || _explicit_cost_limit)
-        {
-          s.on_next(next);
-        }
-        _compliant_finished = true;
-
-        if (_greedy_finished)
-          s.on_completed();
-
-        return;
-      }
-
-      if (*_interrupt_flag || r.saturated() || !r.cost_estimate())
-      {
-        if (_greedy_finished)
-        {
-          s.on_next(next);
-          s.on_completed();
-        }
-        else if (_explicit_cost_limit)
-        {
-          s.on_next(next);
-        }
-
-        _compliant_finished = true;
-        return;
-      }
-
-      if (_explicit_cost_limit)
-      {
-        // An explicit cost limit means this is part of a Job, so we should
-        // report an update whenever we get an update.
-        s.on_next(next);
-        // We do not automatically resume, because that should be the choice of
-        // whoever we are reporting to.
-        return;
-      }
-
-      if (_greedy_finished)
-      {
-        // We don't have an explicit cost limit, so we'll just check if the
-        // greedy job search has granted us any more leeway.
-        const double new_maximum =
-        _compliant_leeway * _greedy_job->progress()->get_cost();
-
-        if (*r.options().maximum_cost_estimate() < new_maximum)
-        {
-          // Push the maximum out a bit more and let the job try again.
-          r.options().maximum_cost_estimate(new_maximum);
-          result.job.resume();
-          return;
-        }
-
-        // We shouldn't keep trying, because we have exceeded the cost limit, even
-        // when accounting for the greedy plan cost.
-        s.on_next(next);
-        s.on_completed();
-        return;
-      }
-
-      // Discard the job because it can no longer produce an acceptable result.
-      // The SearchForPath will continue looking for a greedy plan.
-      _compliant_finished = true;
-    });
 }
 
 } // namespace jobs
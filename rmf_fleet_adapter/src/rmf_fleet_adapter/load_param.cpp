@@ -53,22 +53,25 @@ std::string get_fleet_name_parameter(rclcpp::Node& node)
 rmf_traffic::agv::VehicleTraits get_traits_or_default(rclcpp::Node& node,
   const double default_v_nom, const double default_w_nom,
   const double default_a_nom, const double default_alpha_nom,
-  const double default_r_f, const double default_r_v)
+  const double default_r_f, const double default_r_v,
+  const std::string& prefix)
 {
   const double v_nom =
-    get_parameter_or_default(node, "linear_velocity", default_v_nom);
+    get_parameter_or_default(node, prefix + "linear_velocity", default_v_nom);
   const double w_nom =
-    get_parameter_or_default(node, "angular_velocity", default_w_nom);
+    get_parameter_or_default(node, prefix + "angular_velocity", default_w_nom);
   const double a_nom =
-    get_parameter_or_default(node, "linear_acceleration", default_a_nom);
+    get_parameter_or_default(
+    node, prefix + "linear_acceleration", default_a_nom);
   const double b_nom =
-    get_parameter_or_default(node, "angular_acceleration", default_alpha_nom);
+    get_parameter_or_default(
+    node, prefix + "angular_acceleration", default_alpha_nom);
   const double r_f =
-    get_parameter_or_default(node, "footprint_radius", default_r_f);
+    get_parameter_or_default(node, prefix + "footprint_radius", default_r_f);
   const double r_v =
-    get_parameter_or_default(node, "vicinity_radius", default_r_v);
+    get_parameter_or_default(node, prefix + "vicinity_radius", default_r_v);
   const bool reversible =
-    get_parameter_or_default(node, "reversible", true);
+    get_parameter_or_default(node, prefix + "reversible", true);
 
   if (!reversible)
     std::cout << " ===== We have an irreversible robot" << std::endl;
@@ -94,15 +97,17 @@ std::optional<rmf_battery::agv::BatterySystem> get_battery_system(
   rclcpp::Node& node,
   const double default_voltage,
   const double default_capacity,
-  const double default_charging_current)
+  const double default_charging_current,
+  const std::string& prefix)
 {
   const double voltage =
-    get_parameter_or_default(node, "battery_voltage", default_voltage);
+    get_parameter_or_default(node, prefix + "battery_voltage", default_voltage);
   const double capacity =
-    get_parameter_or_default(node, "battery_capacity", default_capacity);
+    get_parameter_or_default(
+    node, prefix + "battery_capacity", default_capacity);
   const double charging_current =
     get_parameter_or_default(
-    node, "battery_charging_current", default_charging_current);
+    node, prefix + "battery_charging_current", default_charging_current);
 
   auto battery_system = rmf_battery::agv::BatterySystem::make(
     voltage, capacity, charging_current);
@@ -115,14 +120,16 @@ std::optional<rmf_battery::agv::MechanicalSystem> get_mechanical_system(
   rclcpp::Node& node,
   const double default_mass,
   const double default_moment,
-  const double default_friction)
+  const double default_friction,
+  const std::string& prefix)
 {
   const double mass =
-    get_parameter_or_default(node, "mass", default_mass);
+    get_parameter_or_default(node, prefix + "mass", default_mass);
   const double moment_of_inertia =
-    get_parameter_or_default(node, "inertia", default_moment);
+    get_parameter_or_default(node, prefix + "inertia", default_moment);
   const double friction =
-    get_parameter_or_default(node, "friction_coefficient", default_friction);
+    get_parameter_or_default(
+    node, prefix + "friction_coefficient", default_friction);
 
   auto mechanical_system = rmf_battery::agv::MechanicalSystem::make(
     mass, moment_of_inertia, friction);
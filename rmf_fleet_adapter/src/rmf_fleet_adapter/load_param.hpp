@@ -60,24 +60,29 @@ std::chrono::nanoseconds get_parameter_or_default_time(
   const double default_value);
 
 //==============================================================================
+/// The prefix is prepended to the name of each parameter so that several
+/// fleets can be configured on the same node, e.g. "fleet_a.linear_velocity".
 rmf_traffic::agv::VehicleTraits get_traits_or_default(
   rclcpp::Node& node,
   const double default_v_nom, const double default_w_nom,
   const double default_a_nom, const double default_alpha_nom,
-  const double default_r_f, const double default_r_v);
+  const double default_r_f, const double default_r_v,
+  const std::string& prefix = "");
 
 //==============================================================================
 std::optional<rmf_battery::agv::BatterySystem> get_battery_system(
   rclcpp::Node& node,
   const double default_voltage,
   const double default_capacity,
-  const double default_charging_current);
+  const double default_charging_current,
+  const std::string& prefix = "");
 
 std::optional<rmf_battery::agv::MechanicalSystem> get_mechanical_system(
   rclcpp::Node& node,
   const double default_mass,
   const double default_inertia,
-  const double default_friction);
+  const double default_friction,
+  const std::string& prefix = "");
 
 } // namespace rmf_fleet_adapter
 
@@ -20,12 +20,110 @@
 #include <rmf_traffic_ros2/Time.hpp>
 #include <rmf_traffic/agv/Interpolate.hpp>
 
+#include <cmath>
 #include <iostream>
 
 //==============================================================================
-rmf_traffic::Trajectory make_trajectory(
+std::size_t TrajectorySegmentCache::KeyHash::operator()(const Key& key) const
+{
+  std::size_t hash = 0;
+  for (const auto value : key)
+  {
+    const std::size_t h = std::hash<int64_t>()(value);
+    hash ^= h + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  }
+
+  return hash;
+}
+
+//==============================================================================
+TrajectorySegmentCache::TrajectorySegmentCache(
+  rmf_traffic::agv::VehicleTraits traits,
+  const double resolution,
+  const std::size_t max_segments)
+: _traits(std::move(traits)),
+  _resolution(resolution),
+  _max_segments(max_segments)
+{
+  // Do nothing
+}
+
+//==============================================================================
+rmf_traffic::Trajectory TrajectorySegmentCache::interpolate(
+  const rmf_traffic::Time start_time,
+  const std::vector<Eigen::Vector3d>& positions)
+{
+  rmf_traffic::Trajectory output;
+  if (positions.empty())
+    return output;
+
+  output.insert(start_time, positions.front(), Eigen::Vector3d::Zero());
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (std::size_t i = 1; i < positions.size(); ++i)
+  {
+    // Like Interpolate::positions(), each segment begins from the last
+    // waypoint that was kept, and the robot comes to a stop at the end of it.
+    const auto& last = output.back();
+    const auto segment_start = last.time();
+    const auto& segment = _segment(last.position(), positions[i]);
+    for (std::size_t j = 0; j < segment.times.size(); ++j)
+    {
+      output.insert(
+        segment_start + segment.times[j],
+        segment.positions[j],
+        segment.velocities[j]);
+    }
+  }
+
+  return output;
+}
+
+//==============================================================================
+const rmf_traffic::agv::VehicleTraits& TrajectorySegmentCache::traits() const
+{
+  return _traits;
+}
+
+//==============================================================================
+auto TrajectorySegmentCache::_segment(
+  const Eigen::Vector3d& p0,
+  const Eigen::Vector3d& p1) -> const Segment&
+{
+  const auto q = [&](const double value)
+    {
+      return static_cast<int64_t>(std::llround(value / _resolution));
+    };
+
+  const Key key{q(p0[0]), q(p0[1]), q(p0[2]), q(p1[0]), q(p1[1]), q(p1[2])};
+  const auto it = _segments.find(key);
+  if (it != _segments.end())
+    return it->second;
+
+  if (_segments.size() >= _max_segments)
+    _segments.clear();
+
+  Segment segment;
+  const auto start = rmf_traffic::Time(rmf_traffic::Duration(0));
+  const auto trajectory =
+    rmf_traffic::agv::Interpolate::positions(_traits, start, {p0, p1});
+
+  for (auto wp = ++trajectory.begin(); wp != trajectory.end(); ++wp)
+  {
+    segment.times.push_back(wp->time() - start);
+    segment.positions.push_back(wp->position());
+    segment.velocities.push_back(wp->velocity());
+  }
+
+  return _segments.insert({key, std::move(segment)}).first->second;
+}
+
+namespace {
+//==============================================================================
+template<typename InterpolateFn>
+rmf_traffic::Trajectory make_state_trajectory(
   const rmf_fleet_msgs::msg::RobotState& state,
-  const rmf_traffic::agv::VehicleTraits& traits,
+  const InterpolateFn& interpolate,
   bool& is_sitting)
 {
   // TODO(MXG): Account for the multi-floor use case
@@ -41,8 +139,7 @@ rmf_traffic::Trajectory make_trajectory(
 
   const auto start_time = rmf_traffic_ros2::convert(state.location.t);
 
-  auto trajectory = rmf_traffic::agv::Interpolate::positions(
-    traits, start_time, positions);
+  auto trajectory = interpolate(start_time, positions);
 
   if (trajectory.size() < 2)
   {
@@ -63,6 +160,40 @@ rmf_traffic::Trajectory make_trajectory(
 
   return trajectory;
 }
+} // anonymous namespace
+
+//==============================================================================
+rmf_traffic::Trajectory make_trajectory(
+  const rmf_fleet_msgs::msg::RobotState& state,
+  const rmf_traffic::agv::VehicleTraits& traits,
+  bool& is_sitting)
+{
+  return make_state_trajectory(
+    state,
+    [&traits](
+      const rmf_traffic::Time start_time,
+      const std::vector<Eigen::Vector3d>& positions)
+    {
+      return rmf_traffic::agv::Interpolate::positions(
+        traits, start_time, positions);
+    }, is_sitting);
+}
+
+//==============================================================================
+rmf_traffic::Trajectory make_trajectory(
+  const rmf_fleet_msgs::msg::RobotState& state,
+  TrajectorySegmentCache& cache,
+  bool& is_sitting)
+{
+  return make_state_trajectory(
+    state,
+    [&cache](
+      const rmf_traffic::Time start_time,
+      const std::vector<Eigen::Vector3d>& positions)
+    {
+      return cache.interpolate(start_time, positions);
+    }, is_sitting);
+}
 
 //==============================================================================
 rmf_traffic::Trajectory make_trajectory(
@@ -132,6 +263,18 @@ rmf_traffic::Route make_route(
   };
 }
 
+//==============================================================================
+rmf_traffic::Route make_route(
+  const rmf_fleet_msgs::msg::RobotState& state,
+  TrajectorySegmentCache& cache,
+  bool& is_sitting)
+{
+  return rmf_traffic::Route{
+    state.location.level_name,
+    make_trajectory(state, cache, is_sitting)
+  };
+}
+
 //==============================================================================
 rmf_traffic::Trajectory make_hold(
   const rmf_fleet_msgs::msg::Location& l,
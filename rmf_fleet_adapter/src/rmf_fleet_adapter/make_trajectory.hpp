@@ -24,12 +24,74 @@
 
 #include <rmf_fleet_msgs/msg/robot_state.hpp>
 
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
+//==============================================================================
+/// Remembers the interpolated motion between pairs of poses for one set of
+/// vehicle traits, so that robots which keep reporting the same path segments
+/// do not need them to be interpolated again.
+///
+/// Poses are matched after rounding them to the given resolution. The cached
+/// segments are stored relative to their start time, and the cache is cleared
+/// whenever it grows beyond max_segments.
+class TrajectorySegmentCache
+{
+public:
+
+  TrajectorySegmentCache(
+    rmf_traffic::agv::VehicleTraits traits,
+    double resolution = 1e-4,
+    std::size_t max_segments = 10000);
+
+  /// Gives the same trajectory as rmf_traffic::agv::Interpolate::positions()
+  /// would, assembled out of cached segments.
+  rmf_traffic::Trajectory interpolate(
+    rmf_traffic::Time start_time,
+    const std::vector<Eigen::Vector3d>& positions);
+
+  const rmf_traffic::agv::VehicleTraits& traits() const;
+
+private:
+
+  using Key = std::array<int64_t, 6>;
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Segment
+  {
+    // The waypoints after the first one, relative to the start of the segment
+    std::vector<rmf_traffic::Duration> times;
+    std::vector<Eigen::Vector3d> positions;
+    std::vector<Eigen::Vector3d> velocities;
+  };
+
+  const Segment& _segment(const Eigen::Vector3d& p0, const Eigen::Vector3d& p1);
+
+  rmf_traffic::agv::VehicleTraits _traits;
+  double _resolution;
+  std::size_t _max_segments;
+  std::mutex _mutex;
+  std::unordered_map<Key, Segment, KeyHash> _segments;
+};
+
 //==============================================================================
 rmf_traffic::Trajectory make_trajectory(
   const rmf_fleet_msgs::msg::RobotState& state,
   const rmf_traffic::agv::VehicleTraits& traits,
   bool& is_sitting);
 
+//==============================================================================
+/// Same as above, but the trajectory is assembled from cached segments.
+rmf_traffic::Trajectory make_trajectory(
+  const rmf_fleet_msgs::msg::RobotState& state,
+  TrajectorySegmentCache& cache,
+  bool& is_sitting);
+
 //==============================================================================
 rmf_traffic::Trajectory make_trajectory(
   const rmf_traffic::Time start_time,
@@ -47,6 +109,12 @@ rmf_traffic::Route make_route(
   const rmf_traffic::agv::VehicleTraits& traits,
   bool& is_sitting);
 
+//==============================================================================
+rmf_traffic::Route make_route(
+  const rmf_fleet_msgs::msg::RobotState& state,
+  TrajectorySegmentCache& cache,
+  bool& is_sitting);
+
 //==============================================================================
 rmf_traffic::Trajectory make_hold(
   const rmf_fleet_msgs::msg::Location& location,
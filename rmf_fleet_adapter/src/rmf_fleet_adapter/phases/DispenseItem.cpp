@@ -27,7 +27,8 @@ std::shared_ptr<DispenseItem::ActivePhase> DispenseItem::ActivePhase::make(
   std::string request_guid,
   std::string target,
   std::string transporter_type,
-  std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items)
+  std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items,
+  std::optional<PrenotifyDispenser::Handover> handover)
 {
   auto inst = std::shared_ptr<ActivePhase>(
     new ActivePhase(
@@ -35,7 +36,8 @@ std::shared_ptr<DispenseItem::ActivePhase> DispenseItem::ActivePhase::make(
       std::move(request_guid),
       std::move(target),
       std::move(transporter_type),
-      std::move(items)
+      std::move(items),
+      std::move(handover)
   ));
   inst->_init_obs();
   return inst;
@@ -79,13 +81,21 @@ DispenseItem::ActivePhase::ActivePhase(
   std::string request_guid,
   std::string target,
   std::string transporter_type,
-  std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items)
+  std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items,
+  std::optional<PrenotifyDispenser::Handover> handover)
 : _context(std::move(context)),
   _request_guid(std::move(request_guid)),
   _target(std::move(target)),
   _transporter_type(std::move(transporter_type)),
   _items(std::move(items))
 {
+  if (handover.has_value())
+  {
+    _request_acknowledged = handover->acknowledged;
+    _acknowledged_early = handover->acknowledged;
+    _early_result = std::move(handover->result);
+  }
+
   std::ostringstream oss;
   oss << "Dispense items (";
   for (size_t i = 0; i < _items.size(); i++)
@@ -108,8 +118,10 @@ void DispenseItem::ActivePhase::_init_obs()
       DispenserState::SharedPtr>;
 
   const auto& node = _context->node();
+  // If the dispenser already answered the early request, we start from its
+  // answer because it will not be repeated.
   _obs = node->dispenser_result()
-    .start_with(std::shared_ptr<DispenserResult>(nullptr))
+    .start_with(_early_result)
     .combine_latest(
     rxcpp::observe_on_event_loop(),
     node->dispenser_state().start_with(
@@ -210,6 +222,11 @@ Task::StatusMsg DispenseItem::ActivePhase::_get_status(
 //==============================================================================
 void DispenseItem::ActivePhase::_do_publish()
 {
+  // The dispenser may have finished an early request already, in which case
+  // publishing it again could have the items dispensed twice.
+  if (_acknowledged_early)
+    return;
+
   rmf_dispenser_msgs::msg::DispenserRequest msg{};
   msg.request_guid = _request_guid;
   msg.target_guid = _target;
@@ -224,12 +241,15 @@ DispenseItem::PendingPhase::PendingPhase(
   std::string request_guid,
   std::string target,
   std::string transporter_type,
-  std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items)
+  std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items,
+  std::optional<std::size_t> pickup_waypoint)
 : _context(std::move(context)),
   _request_guid(std::move(request_guid)),
   _target(std::move(target)),
   _transporter_type(std::move(transporter_type)),
-  _items(std::move(items))
+  _items(std::move(items)),
+  _pickup_waypoint(pickup_waypoint),
+  _preparation(std::make_shared<Preparation>())
 {
   std::ostringstream oss;
   oss << "Dispense items (";
@@ -247,12 +267,19 @@ DispenseItem::PendingPhase::PendingPhase(
 //==============================================================================
 std::shared_ptr<Task::ActivePhase> DispenseItem::PendingPhase::begin()
 {
+  std::optional<PrenotifyDispenser::Handover> handover;
+  if (_preparation->prenotice)
+    handover = _preparation->prenotice->hand_over();
+
+  _preparation = std::make_shared<Preparation>();
+
   return DispenseItem::ActivePhase::make(
     _context,
     _request_guid,
     _target,
     _transporter_type,
-    _items);
+    _items,
+    std::move(handover));
 }
 
 //==============================================================================
@@ -269,5 +296,34 @@ const std::string& DispenseItem::PendingPhase::description() const
   return _description;
 }
 
+//==============================================================================
+void DispenseItem::PendingPhase::prepare()
+{
+  const auto lead_time = _context->dispenser_lead_time();
+  if (!_pickup_waypoint.has_value() || !lead_time.has_value())
+    return;
+
+  rmf_dispenser_msgs::msg::DispenserRequest request{};
+  request.request_guid = _request_guid;
+  request.target_guid = _target;
+  request.transporter_type = _transporter_type;
+  request.items = _items;
+
+  // Task managers may ask for a preparation from outside of the worker of the
+  // robot, so we always prepare on the worker.
+  _context->worker().schedule(
+    [w = std::weak_ptr<Preparation>(_preparation), context = _context,
+    request = std::move(request), pickup = *_pickup_waypoint,
+    lead_time = *lead_time](const auto&)
+    {
+      const auto preparation = w.lock();
+      if (!preparation || preparation->prenotice)
+        return;
+
+      preparation->prenotice = PrenotifyDispenser::make(
+        context, request, pickup, lead_time);
+    });
+}
+
 } // namespace phases
 } // namespace rmf_fleet_adapter
@@ -18,6 +18,7 @@
 #ifndef SRC__RMF_FLEET_ADAPTER__PHASES__DISPENSEITEM_HPP
 #define SRC__RMF_FLEET_ADAPTER__PHASES__DISPENSEITEM_HPP
 
+#include "PrenotifyDispenser.hpp"
 #include "RxOperators.hpp"
 #include "../Task.hpp"
 #include "../agv/RobotContext.hpp"
@@ -38,12 +39,16 @@ struct DispenseItem
   {
   public:
 
+    /// \param[in] handover
+    ///   What the dispenser said about the request if it was sent before the
+    ///   robot arrived.
     static std::shared_ptr<ActivePhase> make(
       agv::RobotContextPtr context,
       std::string request_guid,
       std::string target,
       std::string transporter_type,
-      std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items);
+      std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items,
+      std::optional<PrenotifyDispenser::Handover> handover = std::nullopt);
 
     const rxcpp::observable<Task::StatusMsg>& observe() const override;
 
@@ -66,6 +71,8 @@ struct DispenseItem
     rxcpp::observable<Task::StatusMsg> _obs;
     rclcpp::TimerBase::SharedPtr _timer;
     bool _request_acknowledged = false;
+    bool _acknowledged_early = false;
+    rmf_dispenser_msgs::msg::DispenserResult::SharedPtr _early_result;
     builtin_interfaces::msg::Time _last_msg;
 
     ActivePhase(
@@ -73,7 +80,8 @@ struct DispenseItem
       std::string request_guid,
       std::string target,
       std::string transporter_type,
-      std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items);
+      std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items,
+      std::optional<PrenotifyDispenser::Handover> handover);
 
     void _init_obs();
 
@@ -88,12 +96,17 @@ struct DispenseItem
   {
   public:
 
+    /// \param[in] pickup_waypoint
+    ///   The waypoint where the robot picks up the items. If this is given and
+    ///   the robot has a dispenser lead time, the request is sent to the
+    ///   dispenser while the robot is still on its way there.
     PendingPhase(
       agv::RobotContextPtr context,
       std::string request_guid,
       std::string target,
       std::string transporter_type,
-      std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items);
+      std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> items,
+      std::optional<std::size_t> pickup_waypoint = std::nullopt);
 
     std::shared_ptr<Task::ActivePhase> begin() override;
 
@@ -101,14 +114,25 @@ struct DispenseItem
 
     const std::string& description() const override;
 
+    void prepare() override;
+
   private:
 
+    /// The early request that is made by prepare(). This is only used on the
+    /// worker of the robot.
+    struct Preparation
+    {
+      std::shared_ptr<PrenotifyDispenser> prenotice;
+    };
+
     agv::RobotContextPtr _context;
     std::string _request_guid;
     std::string _target;
     std::string _transporter_type;
     std::vector<rmf_dispenser_msgs::msg::DispenserRequestItem> _items;
+    std::optional<std::size_t> _pickup_waypoint;
     std::string _description;
+    std::shared_ptr<Preparation> _preparation;
   };
 };
 
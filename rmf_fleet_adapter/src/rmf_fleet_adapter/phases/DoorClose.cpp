@@ -85,6 +85,7 @@ void DoorClose::ActivePhase::_init_obs()
           return;
 
         me->_status.state = Task::StatusMsg::STATE_ACTIVE;
+        me->_requested = std::chrono::steady_clock::now();
         me->_publish_close_door();
         me->_timer = me->_context->node()->try_create_wall_timer(
           std::chrono::milliseconds(1000),
@@ -134,6 +135,15 @@ void DoorClose::ActivePhase::_update_status(
 {
   if (!supervisor_has_session(*heartbeat, _request_id, _door_name))
   {
+    const auto& metrics = _context->phase_metrics();
+    if (metrics && _status.state != Task::StatusMsg::STATE_COMPLETED)
+    {
+      metrics->record(
+        _context->name(), "DoorClose",
+        agv::PhaseMetricsCollector::Stage::DoorWait,
+        std::chrono::steady_clock::now() - _requested);
+    }
+
     _status.status = "success";
     _status.state = Task::StatusMsg::STATE_COMPLETED;
   }
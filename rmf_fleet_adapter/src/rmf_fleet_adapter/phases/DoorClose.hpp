@@ -66,6 +66,7 @@ struct DoorClose
     rxcpp::observable<Task::StatusMsg> _obs;
     std::string _description;
     rclcpp::TimerBase::SharedPtr _timer;
+    std::chrono::steady_clock::time_point _requested;
     Task::StatusMsg _status;
 
     ActivePhase(
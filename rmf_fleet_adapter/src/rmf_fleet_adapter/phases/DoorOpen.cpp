@@ -98,7 +98,7 @@ void DoorOpen::ActivePhase::_init_obs()
   using rmf_door_msgs::msg::SupervisorHeartbeat;
   using CombinedType = std::tuple<DoorState::SharedPtr,
       SupervisorHeartbeat::SharedPtr>;
-  _obs = transport->door_state().combine_latest(
+  _obs = transport->door_state(_door_name).combine_latest(
     rxcpp::observe_on_event_loop(),
     transport->door_supervisor())
     .lift<CombinedType>(on_subscribe([weak = weak_from_this(), transport]()
@@ -108,7 +108,9 @@ void DoorOpen::ActivePhase::_init_obs()
           return;
 
         me->_status.state = Task::StatusMsg::STATE_ACTIVE;
+        me->_requested = std::chrono::steady_clock::now();
         me->_publish_open_door();
+        me->_retransmission.published();
         me->_timer =
         transport->try_create_wall_timer(std::chrono::milliseconds(1000),
         [weak, transport]()
@@ -117,9 +119,10 @@ void DoorOpen::ActivePhase::_init_obs()
           if (!me)
             return;
 
-          // TODO(MXG): We can stop publishing the door request once the
-          // supervisor sees our request.
-          me->_publish_open_door();
+          // We stop publishing the door request once the supervisor sees our
+          // request, and back off while it does not.
+          if (me->_retransmission.due())
+            me->_publish_open_door();
 
           const auto current_expected_finish =
           me->_expected_finish + me->_context->itinerary().delay();
@@ -196,10 +199,30 @@ void DoorOpen::ActivePhase::_update_status(
   const rmf_door_msgs::msg::SupervisorHeartbeat::SharedPtr& heartbeat)
 {
   using rmf_door_msgs::msg::DoorMode;
+
+  if (const auto& times = _context->door_opening_times())
+    times->observe(*door_state);
+
+  // If the supervisor has forgotten our session, we remind it right away
+  if (_retransmission.acknowledged(
+      supervisor_has_session(*heartbeat, _request_id, _door_name)))
+  {
+    _publish_open_door();
+  }
+
   if (door_state->door_name == _door_name &&
     door_state->current_mode.value == DoorMode::MODE_OPEN
     && supervisor_has_session(*heartbeat, _request_id, _door_name))
   {
+    const auto& metrics = _context->phase_metrics();
+    if (metrics && _status.state != Task::StatusMsg::STATE_COMPLETED)
+    {
+      metrics->record(
+        _context->name(), "DoorOpen",
+        agv::PhaseMetricsCollector::Stage::DoorWait,
+        std::chrono::steady_clock::now() - _requested);
+    }
+
     _status.status = "success";
     _status.state = Task::StatusMsg::STATE_COMPLETED;
   }
@@ -215,11 +238,13 @@ DoorOpen::PendingPhase::PendingPhase(
   agv::RobotContextPtr context,
   std::string  door_name,
   std::string request_id,
-  rmf_traffic::Time expected_finish)
+  rmf_traffic::Time expected_finish,
+  std::shared_ptr<PreopenDoor> preopen)
 :  _context(std::move(context)),
   _door_name(std::move(door_name)),
   _request_id(std::move(request_id)),
-  _expected_finish(std::move(expected_finish))
+  _expected_finish(std::move(expected_finish)),
+  _preopen(std::move(preopen))
 {
   _description = "Open door \"" + _door_name + "\"";
 }
@@ -227,6 +252,9 @@ DoorOpen::PendingPhase::PendingPhase(
 //==============================================================================
 std::shared_ptr<Task::ActivePhase> DoorOpen::PendingPhase::begin()
 {
+  if (_preopen)
+    _preopen->hand_over();
+
   return ActivePhase::make(_context, _door_name, _request_id, _expected_finish);
 }
 
@@ -19,6 +19,8 @@
 #define SRC__RMF_FLEET_ADAPTER__PHASES__DOOROPEN_HPP
 
 #include "DoorClose.hpp"
+#include "PreopenDoor.hpp"
+#include "Retransmission.hpp"
 #include "../Task.hpp"
 #include "../agv/RobotContext.hpp"
 
@@ -35,7 +37,7 @@ struct DoorOpen
   /**
    * The phase should do the following
    * 1. Send out a MODE_OPEN door request
-   * 3. Periodically resend the open request while the supervisor state does not contain the requester_id
+   * 3. Resend the open request with an increasing interval while the supervisor state does not contain the requester_id
    * 2. It is completed when the supervisor state contains the requester_id and the door has an OPEN mode
    * 4. If cancelled, should start a door close phase
    */
@@ -71,6 +73,8 @@ struct DoorOpen
     rxcpp::observable<Task::StatusMsg> _obs;
     std::string _description;
     rclcpp::TimerBase::SharedPtr _timer;
+    std::chrono::steady_clock::time_point _requested;
+    Retransmission _retransmission;
     Task::StatusMsg _status;
     std::shared_ptr<DoorClose::ActivePhase> _door_close_phase;
 
@@ -93,11 +97,15 @@ struct DoorOpen
   {
   public:
 
+    /// \param[in] preopen
+    ///   If the door is being asked to open before the robot arrives, this
+    ///   phase takes over that request when it begins.
     PendingPhase(
       agv::RobotContextPtr context,
       std::string door_name,
       std::string request_id,
-      rmf_traffic::Time expected_finish);
+      rmf_traffic::Time expected_finish,
+      std::shared_ptr<PreopenDoor> preopen = nullptr);
 
     std::shared_ptr<Task::ActivePhase> begin() override;
 
@@ -111,6 +119,7 @@ struct DoorOpen
     std::string _door_name;
     std::string _request_id;
     rmf_traffic::Time _expected_finish;
+    std::shared_ptr<PreopenDoor> _preopen;
     std::string _description;
   };
 };
@@ -85,7 +85,7 @@ void EndLiftSession::Active::_init_obs()
 {
   using rmf_lift_msgs::msg::LiftRequest;
   using rmf_lift_msgs::msg::LiftState;
-  _obs = _context->node()->lift_state()
+  _obs = _context->node()->lift_state(_lift_name)
     .lift<LiftState::SharedPtr>(on_subscribe([weak = weak_from_this()]()
       {
         const auto me = weak.lock();
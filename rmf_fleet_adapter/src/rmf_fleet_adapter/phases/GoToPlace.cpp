@@ -21,9 +21,14 @@
 #include "DoorClose.hpp"
 #include "RequestLift.hpp"
 #include "DockRobot.hpp"
+#include "ResumePlan.hpp"
 
+#include <rmf_traffic/agv/RouteValidator.hpp>
 #include <rmf_traffic/schedule/StubbornNegotiator.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace rmf_fleet_adapter {
 namespace phases {
 
@@ -63,6 +68,8 @@ void GoToPlace::Active::emergency_alarm(const bool value)
     return;
 
   _emergency_active = value;
+  _negotiation_memo.clear();
+  _rollout_cache->clear();
   if (_emergency_active)
   {
     cancel();
@@ -114,6 +121,33 @@ void GoToPlace::Active::respond(
       return rmf_utils::nullopt;
     };
 
+  const auto requested = std::chrono::steady_clock::now();
+  const auto version = _context->itinerary().version();
+  if (const auto plan = _negotiation_memo.recall(
+      table_viewer, *_context->profile(), version, _context->now()))
+  {
+    // We already found a plan for a sibling of this table with the same
+    // proposals, so we can offer it again without searching.
+    std::vector<rmf_traffic::Route> itinerary;
+    for (const auto& route : plan->get_itinerary())
+    {
+      if (route.trajectory().size() > 1)
+        itinerary.push_back(route);
+    }
+
+    responder->submit(
+      std::move(itinerary),
+      [plan = *plan, approval_cb = std::move(approval_cb)]()
+      {
+        return approval_cb(plan);
+      });
+
+    record_metric(
+      agv::PhaseMetricsCollector::Stage::NegotiationWait,
+      std::chrono::steady_clock::now() - requested);
+    return;
+  }
+
   services::ProgressEvaluator evaluator;
   if (table_viewer->parent_id())
   {
@@ -128,7 +162,7 @@ void GoToPlace::Active::respond(
   {
     negotiate = services::Negotiate::emergency_pullover(
       _context->planner(), _context->location(), table_viewer, responder,
-      std::move(approval_cb), evaluator);
+      std::move(approval_cb), evaluator, _context->pullover_candidates());
   }
   else
   {
@@ -137,14 +171,80 @@ void GoToPlace::Active::respond(
       responder, std::move(approval_cb), evaluator);
   }
 
+  _rollout_cache->itinerary_version(version);
+  negotiate->arena(_context->negotiation_arena())
+  .rollout_cache(_rollout_cache);
+
+  using namespace std::chrono_literals;
+  const auto wait_duration = 2s + table_viewer->sequence().back().version * 10s;
+
+  const auto& admission = _context->negotiation_admission();
+  if (!admission)
+  {
+    return start_negotiation(
+      std::move(negotiate), version, requested, wait_duration, nullptr);
+  }
+
+  services::NegotiationAdmission::Request request;
+  request.depth = table_viewer->sequence().size();
+  request.deadline =
+    services::NegotiationAdmission::Clock::now() + wait_duration;
+  request.defunct = [table_viewer]() { return table_viewer->defunct(); };
+  request.shed = [responder]() { responder->forfeit({}); };
+  request.start =
+    [w = weak_from_this(), worker = _context->worker(),
+      negotiate, version, requested, wait_duration](
+      services::NegotiationAdmission::Ticket ticket)
+    {
+      // The slot may have been freed while another negotiation of this phase
+      // was being cleaned up, so start on the worker instead of right away.
+      worker.schedule(
+        [w, negotiate, version, requested, wait_duration,
+        ticket = std::move(ticket)](const auto&)
+        {
+          if (const auto phase = w.lock())
+          {
+            phase->start_negotiation(
+              negotiate, version, requested, wait_duration, ticket);
+            return;
+          }
+
+          // Nobody is left to negotiate for, but we must not leave the
+          // negotiation hanging.
+          negotiate->responder()->forfeit({});
+        });
+    };
+
+  admission->submit(std::move(request));
+}
+
+//==============================================================================
+void GoToPlace::Active::start_negotiation(
+  std::shared_ptr<services::Negotiate> negotiate,
+  const rmf_traffic::schedule::ItineraryVersion version,
+  const std::chrono::steady_clock::time_point requested,
+  const rmf_traffic::Duration wait_duration,
+  services::NegotiationAdmission::Ticket ticket)
+{
   auto negotiate_sub =
     rmf_rxcpp::make_job<services::Negotiate::Result>(negotiate)
     .observe_on(rxcpp::identity_same_worker(_context->worker()))
     .subscribe(
-    [w = weak_from_this()](const auto& result)
+    [w = weak_from_this(), version, requested](const auto& result)
     {
       if (auto phase = w.lock())
       {
+        phase->record_metric(
+          agv::PhaseMetricsCollector::Stage::NegotiationWait,
+          std::chrono::steady_clock::now() - requested);
+
+        if (result.plan)
+        {
+          phase->_negotiation_memo.remember(
+            result.service->viewer(), version, phase->_context->now(),
+            *result.plan);
+        }
+
         result.respond();
         phase->_negotiate_services.erase(result.service);
       }
@@ -159,8 +259,6 @@ void GoToPlace::Active::respond(
       }
     });
 
-  using namespace std::chrono_literals;
-  const auto wait_duration = 2s + table_viewer->sequence().back().version * 10s;
   auto negotiate_timer = _context->node()->try_create_wall_timer(
     wait_duration,
     [s = negotiate->weak_from_this()]
@@ -172,10 +270,20 @@ void GoToPlace::Active::respond(
   _negotiate_services[negotiate] =
     NegotiateManagers{
     std::move(negotiate_sub),
-    std::move(negotiate_timer)
+    std::move(negotiate_timer),
+    std::move(ticket)
   };
 }
 
+//==============================================================================
+void GoToPlace::Active::record_metric(
+  const agv::PhaseMetricsCollector::Stage stage,
+  const rmf_traffic::Duration duration) const
+{
+  if (const auto& metrics = _context->phase_metrics())
+    metrics->record(_context->name(), "GoToPlace", stage, duration);
+}
+
 //==============================================================================
 GoToPlace::Active::Active(
   agv::RobotContextPtr context,
@@ -212,6 +320,9 @@ void GoToPlace::Active::find_plan()
   if (_emergency_active)
     return find_emergency_plan();
 
+  if (resume_plan())
+    return;
+
   StatusMsg msg;
   msg.status = "Finding a plan for [" + _context->requester_id()
     + "] to go to [" + std::to_string(_goal.waypoint()) + "]";
@@ -223,19 +334,23 @@ void GoToPlace::Active::find_plan()
   _find_path_service = std::make_shared<services::FindPath>(
     _context->planner(), _context->location(), _goal,
     _context->schedule()->snapshot(), _context->itinerary().id(),
-    _context->profile());
+    _context->profile(), _context->plan_cache());
 
   _plan_subscription = rmf_rxcpp::make_job<services::FindPath::Result>(
     _find_path_service)
     .observe_on(rxcpp::identity_same_worker(_context->worker()))
     .subscribe(
-    [w = weak_from_this()](
+    [w = weak_from_this(), started = std::chrono::steady_clock::now()](
       const services::FindPath::Result& result)
     {
       const auto phase = w.lock();
       if (!phase)
         return;
 
+      phase->record_metric(
+        agv::PhaseMetricsCollector::Stage::Planning,
+        std::chrono::steady_clock::now() - started);
+
       if (!result)
       {
         // This shouldn't happen, but let's try to handle it gracefully
@@ -282,19 +397,23 @@ void GoToPlace::Active::find_emergency_plan()
   _pullover_service = std::make_shared<services::FindEmergencyPullover>(
     _context->planner(), _context->location(),
     _context->schedule()->snapshot(), _context->itinerary().id(),
-    _context->profile());
+    _context->profile(), _context->pullover_candidates());
 
   _plan_subscription = rmf_rxcpp::make_job<
     services::FindEmergencyPullover::Result>(_pullover_service)
     .observe_on(rxcpp::identity_same_worker(_context->worker()))
     .subscribe(
-    [w = weak_from_this()](
+    [w = weak_from_this(), started = std::chrono::steady_clock::now()](
       const services::FindEmergencyPullover::Result& result)
     {
       const auto phase = w.lock();
       if (!phase)
         return;
 
+      phase->record_metric(
+        agv::PhaseMetricsCollector::Stage::Planning,
+        std::chrono::steady_clock::now() - started);
+
       if (!result)
       {
         // This shouldn't happen, but let's try to handle it gracefully
@@ -334,16 +453,21 @@ class EventPhaseFactory : public rmf_traffic::agv::Graph::Lane::Executor
 public:
 
   using Lane = rmf_traffic::agv::Graph::Lane;
+  using EarlyRequests = GoToPlace::EarlyRequests;
 
   EventPhaseFactory(
     agv::RobotContextPtr context,
     Task::PendingPhases& phases,
     rmf_traffic::Time event_start_time,
-    bool& continuous)
+    bool& continuous,
+    const EarlyRequests& previous_requests,
+    EarlyRequests& next_requests)
   : _context(std::move(context)),
     _phases(phases),
     _event_start_time(event_start_time),
-    _continuous(continuous)
+    _continuous(continuous),
+    _previous_requests(previous_requests),
+    _next_requests(next_requests)
   {
     // Do nothing
   }
@@ -366,7 +490,8 @@ public:
         _context,
         open.name(),
         _context->requester_id(),
-        _event_start_time + open.duration()));
+        _event_start_time + open.duration(),
+        _preopen(open)));
     _continuous = true;
   }
 
@@ -394,7 +519,8 @@ public:
         open.lift_name(),
         open.floor_name(),
         _event_start_time,
-        phases::RequestLift::Located::Outside));
+        phases::RequestLift::Located::Outside,
+        _presummon(open)));
 
     _continuous = true;
   }
@@ -450,25 +576,153 @@ public:
   }
 
 private:
+
+  std::shared_ptr<PreopenDoor> _preopen(const DoorOpen& open)
+  {
+    // If a plan passes through the same door more than once, only the first
+    // pass is requested early.
+    auto& next = _next_requests.doors;
+    if (!_context->predictive_door_requests() || next.count(open.name()) > 0)
+      return nullptr;
+
+    // A robot that keeps heading for the same door after replanning keeps its
+    // request, so the door is not closed and opened again in between.
+    std::shared_ptr<PreopenDoor> preopen;
+    const auto& previous = _previous_requests.doors;
+    const auto it = previous.find(open.name());
+    if (it != previous.end() && !it->second->handed_over())
+    {
+      preopen = it->second;
+      preopen->arrival(_event_start_time);
+    }
+    else
+    {
+      preopen = PreopenDoor::make(
+        _context, open.name(), _context->requester_id(),
+        _event_start_time, open.duration());
+    }
+
+    next[open.name()] = preopen;
+    return preopen;
+  }
+
+  std::shared_ptr<PresummonLift> _presummon(const LiftSessionBegin& begin)
+  {
+    auto& next = _next_requests.lifts;
+    if (!_context->predictive_lift_requests()
+      || next.count(begin.lift_name()) > 0)
+      return nullptr;
+
+    // The lift keeps its session if the robot will still be waiting for it on
+    // the same floor after replanning.
+    std::shared_ptr<PresummonLift> presummon;
+    const auto& previous = _previous_requests.lifts;
+    const auto it = previous.find(begin.lift_name());
+    if (it != previous.end() && !it->second->handed_over()
+      && it->second->floor_name() == begin.floor_name())
+    {
+      presummon = it->second;
+      presummon->arrival(_event_start_time);
+    }
+    else
+    {
+      presummon = PresummonLift::make(
+        _context, begin.lift_name(), begin.floor_name(), _event_start_time);
+    }
+
+    next[begin.lift_name()] = presummon;
+    return presummon;
+  }
+
   agv::RobotContextPtr _context;
   Task::PendingPhases& _phases;
   rmf_traffic::Time _event_start_time;
   bool& _continuous;
+  const EarlyRequests& _previous_requests;
+  EarlyRequests& _next_requests;
   bool _moving_lift = false;
   rmf_traffic::Duration _lifting_duration = rmf_traffic::Duration(0);
 };
 } // anonymous namespace
 
+namespace {
+//==============================================================================
+bool holds_still(const rmf_traffic::Trajectory& trajectory)
+{
+  if (trajectory.size() < 2)
+    return false;
+
+  const Eigen::Vector3d p = trajectory.front().position();
+  for (const auto& wp : trajectory)
+  {
+    if ((wp.position() - p).norm() > 1e-6 || wp.velocity().norm() > 1e-6)
+      return false;
+  }
+
+  return true;
+}
+
+//==============================================================================
+/// If both itineraries hold the robot still at the same spot for the same
+/// length of time, get how much later the next one starts.
+std::optional<rmf_traffic::Duration> renewed_hold(
+  const std::vector<rmf_traffic::Route>& current,
+  const std::vector<rmf_traffic::Route>& next)
+{
+  if (current.size() != 1 || next.size() != 1)
+    return std::nullopt;
+
+  const auto& a = current.front();
+  const auto& b = next.front();
+  if (a.map() != b.map())
+    return std::nullopt;
+
+  const auto& ta = a.trajectory();
+  const auto& tb = b.trajectory();
+  if (!holds_still(ta) || !holds_still(tb))
+    return std::nullopt;
+
+  if ((ta.front().position() - tb.front().position()).norm() > 1e-6)
+    return std::nullopt;
+
+  const auto tolerance = std::chrono::milliseconds(1);
+  const auto length_diff = ta.duration() - tb.duration();
+  if (length_diff > tolerance || length_diff < -tolerance)
+    return std::nullopt;
+
+  const auto shift = *tb.start_time() - *ta.start_time();
+  if (shift <= rmf_traffic::Duration(0))
+    return std::nullopt;
+
+  return shift;
+}
+} // anonymous namespace
+
 //==============================================================================
-void GoToPlace::Active::execute_plan(rmf_traffic::agv::Plan new_plan)
+void GoToPlace::Active::execute_plan(
+  rmf_traffic::agv::Plan new_plan,
+  const rmf_traffic::Duration time_offset,
+  const std::size_t first_waypoint)
 {
+  if (!_executed_first_plan)
+  {
+    _executed_first_plan = true;
+    record_metric(
+      agv::PhaseMetricsCollector::Stage::TimeToFirstPlan,
+      std::chrono::steady_clock::now() - _begin_time);
+  }
+
   _plan = std::move(new_plan);
 
   std::vector<rmf_traffic::agv::Plan::Waypoint> waypoints =
     _plan->get_waypoints();
+  waypoints.erase(
+    waypoints.begin(),
+    waypoints.begin() + std::min(first_waypoint, waypoints.size()));
   std::vector<rmf_traffic::agv::Plan::Waypoint> move_through;
 
   Task::PendingPhases sub_phases;
+  EarlyRequests early_requests;
   while (!waypoints.empty())
   {
     auto it = waypoints.begin();
@@ -489,7 +743,9 @@ void GoToPlace::Active::execute_plan(rmf_traffic::agv::Plan new_plan)
         move_through.clear();
 
         bool continuous = true;
-        EventPhaseFactory factory(_context, sub_phases, it->time(), continuous);
+        EventPhaseFactory factory(
+          _context, sub_phases, it->time() + time_offset, continuous,
+          _early_requests, early_requests);
         it->event()->execute(factory);
         while (factory.moving_lift())
         {
@@ -550,6 +806,10 @@ void GoToPlace::Active::execute_plan(rmf_traffic::agv::Plan new_plan)
     }
   }
 
+  // Any early requests that the new plan does not need anymore will be
+  // withdrawn once the old subtasks are gone as well.
+  _early_requests = std::move(early_requests);
+
   // TODO: Make distinctions between task and subtasks to avoid passing
   // dummy parameters for subtasks
   rmf_traffic::Time dummy_time;
@@ -562,6 +822,12 @@ void GoToPlace::Active::execute_plan(rmf_traffic::agv::Plan new_plan)
     dummy_state,
     nullptr);
 
+  if (const auto& metrics = _context->phase_metrics())
+  {
+    _subtasks->phase_finished_callback(
+      metrics->execution_recorder(_context->name()));
+  }
+
   _status_subscription = _subtasks->observe()
     .observe_on(rxcpp::identity_same_worker(_context->worker()))
     .subscribe(
@@ -593,7 +859,101 @@ void GoToPlace::Active::execute_plan(rmf_traffic::agv::Plan new_plan)
 
   _subtasks->begin();
 
-  _context->itinerary().set(_plan->get_itinerary());
+  // A robot that keeps waiting in the same place, like an idle robot in a
+  // ResponsiveWait, only needs its hold to be pushed back instead of sending
+  // a whole new itinerary to the schedule.
+  const auto& itinerary = _plan->get_itinerary();
+  const auto renewal = time_offset == rmf_traffic::Duration(0) ?
+    renewed_hold(_context->itinerary().itinerary(), itinerary) : std::nullopt;
+  if (renewal.has_value())
+  {
+    _context->itinerary().delay(*renewal);
+    return;
+  }
+
+  _context->itinerary().set(itinerary);
+  if (time_offset != rmf_traffic::Duration(0))
+    _context->itinerary().delay(time_offset);
+}
+
+//==============================================================================
+bool GoToPlace::Active::execute_prepared_plan(
+  const rmf_traffic::agv::Plan::Start& expected_start,
+  rmf_traffic::agv::Plan plan)
+{
+  const auto& location = _context->location();
+  const bool at_start = std::any_of(
+    location.begin(), location.end(),
+    [&](const auto& start) { return matches_start(start, expected_start); });
+
+  if (!at_start)
+    return false;
+
+  // The plan expects the robot to leave at the estimated start time, so its
+  // itinerary needs to be shifted to when the robot is really leaving.
+  const auto time_offset = _context->now() - expected_start.time();
+
+  const rmf_traffic::agv::ScheduleRouteValidator validator(
+    _context->schedule()->snapshot(),
+    _context->itinerary().id(),
+    *_context->profile());
+
+  for (const auto& route : plan.get_itinerary())
+  {
+    auto shifted = route;
+    if (shifted.trajectory().size() > 0)
+      shifted.trajectory().begin()->adjust_times(time_offset);
+
+    if (validator.find_conflict(shifted))
+      return false;
+  }
+
+  RCLCPP_DEBUG(
+    _context->node()->get_logger(),
+    "Using the plan that was prepared in advance for [%s] to go to [%ld]",
+    _context->requester_id().c_str(),
+    _goal.waypoint());
+
+  execute_plan(std::move(plan), time_offset);
+  return true;
+}
+
+//==============================================================================
+bool GoToPlace::Active::resume_plan()
+{
+  if (!_plan)
+    return false;
+
+  const auto& waypoints = _plan->get_waypoints();
+  const auto resume = find_resume_waypoint(
+    waypoints, _context->location(), _goal.waypoint());
+
+  if (!resume.has_value())
+    return false;
+
+  const auto now = _context->now();
+  const auto time_offset = now - waypoints[*resume].time();
+
+  const rmf_traffic::agv::ScheduleRouteValidator validator(
+    _context->schedule()->snapshot(),
+    _context->itinerary().id(),
+    *_context->profile());
+
+  if (!resumed_itinerary_is_clear(
+      _plan->get_itinerary(), time_offset, now, validator))
+    return false;
+
+  RCLCPP_INFO(
+    _context->node()->get_logger(),
+    "Resuming the plan of [%s] to go to [%ld] %.1fs later instead of "
+    "replanning",
+    _context->requester_id().c_str(),
+    _goal.waypoint(),
+    rmf_traffic::time::to_seconds(time_offset));
+
+  auto plan = *_plan;
+  execute_plan(std::move(plan), time_offset, *resume);
+  return true;
 }
 
 //==============================================================================
@@ -603,7 +963,15 @@ std::shared_ptr<Task::ActivePhase> GoToPlace::Pending::begin()
     std::shared_ptr<Active>(
     new Active(_context, _goal, _time_estimate, _tail_period));
 
-  active->find_plan();
+  // If the prepared plan is still being searched for, we drop it and plan
+  // from wherever the robot really is.
+  auto prepared = std::move(_preparation->plan);
+  _preparation = std::make_shared<Preparation>();
+  if (!prepared || !active->execute_prepared_plan(
+      _start_estimate, *std::move(prepared)))
+  {
+    active->find_plan();
+  }
 
   active->_interrupt_subscription = _context->observe_interrupt()
     .observe_on(rxcpp::identity_same_worker(_context->worker()))
@@ -636,16 +1004,67 @@ const std::string& GoToPlace::Pending::description() const
   return _description;
 }
 
+//==============================================================================
+void GoToPlace::Pending::prepare()
+{
+  if (!_context->phase_lookahead())
+    return;
+
+  // Task managers may ask for a preparation from outside of the worker of the
+  // robot, so we always prepare on the worker.
+  _context->worker().schedule(
+    [w = std::weak_ptr<Preparation>(_preparation), context = _context,
+    start = _start_estimate, goal = _goal](const auto&)
+    {
+      const auto preparation = w.lock();
+      if (!preparation || preparation->started)
+        return;
+
+      preparation->started = true;
+      preparation->service = std::make_shared<services::FindPath>(
+        context->planner(), rmf_traffic::agv::Plan::StartSet{start}, goal,
+        context->schedule()->snapshot(), context->itinerary().id(),
+        context->profile(), context->plan_cache());
+
+      // Nobody is waiting on this plan yet, so it should not hold up the
+      // planning of robots that are.
+      preparation->subscription =
+        rmf_rxcpp::make_job<services::FindPath::Result>(
+          preparation->service, rmf_rxcpp::PlanningPriority::Low)
+        .observe_on(rxcpp::identity_same_worker(context->worker()))
+        .subscribe(
+        [w](const services::FindPath::Result& result)
+        {
+          const auto preparation = w.lock();
+          if (!preparation)
+            return;
+
+          preparation->service = nullptr;
+          if (result)
+            preparation->plan = *result;
+        },
+        [w](std::exception_ptr)
+        {
+          // The phase will plan for itself when it begins
+          if (const auto preparation = w.lock())
+            preparation->service = nullptr;
+        });
+    });
+}
+
 //==============================================================================
 GoToPlace::Pending::Pending(
   agv::RobotContextPtr context,
+  rmf_traffic::agv::Plan::Start start_estimate,
   rmf_traffic::agv::Plan::Goal goal,
   double time_estimate,
   std::optional<rmf_traffic::Duration> tail_period)
 : _context(std::move(context)),
+  _start_estimate(std::move(start_estimate)),
   _goal(std::move(goal)),
   _time_estimate(time_estimate),
-  _tail_period(tail_period)
+  _tail_period(tail_period),
+  _preparation(std::make_shared<Preparation>())
 {
   _description = "Send robot to [" + std::to_string(_goal.waypoint()) + "]";
 }
@@ -677,7 +1096,9 @@ auto GoToPlace::make(
 
   const double cost = *estimate.cost_estimate();
   return std::unique_ptr<Pending>(
-    new Pending(std::move(context), std::move(goal), cost, tail_period));
+    new Pending(
+      std::move(context), std::move(start_estimate), std::move(goal),
+      cost, tail_period));
 }
 
 } // namespace phases
@@ -20,10 +20,14 @@
 
 #include "../Task.hpp"
 #include "../agv/RobotContext.hpp"
+#include "PreopenDoor.hpp"
+#include "PresummonLift.hpp"
 
 #include "../services/FindPath.hpp"
 #include "../services/FindEmergencyPullover.hpp"
 #include "../services/Negotiate.hpp"
+#include "../services/NegotiationMemo.hpp"
+#include "../services/RolloutCache.hpp"
 
 namespace rmf_fleet_adapter {
 namespace phases {
@@ -36,6 +40,14 @@ public:
   using StatusMsg = Task::StatusMsg;
   class Pending;
 
+  /// Requests that are sent for the doors and lifts along a plan before the
+  /// robot arrives at them, by the name of the door or lift
+  struct EarlyRequests
+  {
+    std::unordered_map<std::string, std::shared_ptr<PreopenDoor>> doors;
+    std::unordered_map<std::string, std::shared_ptr<PresummonLift>> lifts;
+  };
+
   class Active
     : public Task::ActivePhase,
     public rmf_traffic::schedule::Negotiator,
@@ -75,7 +87,45 @@ public:
 
     void find_emergency_plan();
 
-    void execute_plan(rmf_traffic::agv::Plan new_plan);
+    /// Execute a plan. If the plan was found for a start time other than the
+    /// current time, time_offset should say how much later the robot is
+    /// starting than the plan expects. The robot will be commanded from the
+    /// waypoint of the plan at first_waypoint onwards.
+    void execute_plan(
+      rmf_traffic::agv::Plan new_plan,
+      rmf_traffic::Duration time_offset = rmf_traffic::Duration(0),
+      std::size_t first_waypoint = 0);
+
+    /// Execute a plan that was prepared before this phase began, as long as
+    /// the robot is still at the start that the plan was prepared for and the
+    /// plan does not conflict with the current schedule.
+    ///
+    /// \return true if the plan is being executed.
+    bool execute_prepared_plan(
+      const rmf_traffic::agv::Plan::Start& expected_start,
+      rmf_traffic::agv::Plan plan);
+
+    /// Resume the current plan from the waypoint that the robot is stopped at,
+    /// shifted to the current time, as long as the rest of it does not
+    /// conflict with the current schedule. Most replanning is needed because
+    /// the robot has fallen behind, so this saves a full search when the robot
+    /// can simply follow the same path later.
+    ///
+    /// \return true if the plan is being resumed.
+    bool resume_plan();
+
+    void start_negotiation(
+      std::shared_ptr<services::Negotiate> negotiate,
+      rmf_traffic::schedule::ItineraryVersion version,
+      std::chrono::steady_clock::time_point requested,
+      rmf_traffic::Duration wait_duration,
+      services::NegotiationAdmission::Ticket ticket);
+
+    /// Record how long a stage of this phase took, if the fleet collects
+    /// phase metrics.
+    void record_metric(
+      agv::PhaseMetricsCollector::Stage stage,
+      rmf_traffic::Duration duration) const;
 
     agv::RobotContextPtr _context;
     rmf_traffic::agv::Plan::Goal _goal;
@@ -85,6 +135,9 @@ public:
     std::shared_ptr<Task> _subtasks;
     bool _emergency_active = false;
     bool _performing_emergency_task = false;
+    std::chrono::steady_clock::time_point _begin_time =
+      std::chrono::steady_clock::now();
+    bool _executed_first_plan = false;
     rxcpp::subjects::subject<StatusMsg> _status_publisher;
     rxcpp::observable<StatusMsg> _status_obs;
     rmf_rxcpp::subscription_guard _status_subscription;
@@ -95,17 +148,23 @@ public:
     rclcpp::TimerBase::SharedPtr _find_pullover_timer;
     std::optional<rmf_traffic::Duration> _tail_period;
 
+    EarlyRequests _early_requests;
+
     rmf_rxcpp::subscription_guard _interrupt_subscription;
 
     struct NegotiateManagers
     {
       rmf_rxcpp::subscription_guard subscription;
       rclcpp::TimerBase::SharedPtr timer;
+      services::NegotiationAdmission::Ticket admission_ticket;
     };
     using NegotiatePtr = std::shared_ptr<services::Negotiate>;
     using NegotiateServiceMap =
       std::unordered_map<NegotiatePtr, NegotiateManagers>;
     NegotiateServiceMap _negotiate_services;
+    services::NegotiationMemo _negotiation_memo;
+    std::shared_ptr<services::RolloutCache> _rollout_cache =
+      std::make_shared<services::RolloutCache>();
 
     std::shared_ptr<void> _negotiator_license;
   };
@@ -123,19 +182,35 @@ public:
     // Documentation inherited
     const std::string& description() const final;
 
+    // Documentation inherited
+    void prepare() final;
+
   private:
     friend class GoToPlace;
     Pending(
       agv::RobotContextPtr context,
+      rmf_traffic::agv::Plan::Start start_estimate,
       rmf_traffic::agv::Plan::Goal goal,
       double time_estimate,
       std::optional<rmf_traffic::Duration> tail_period);
 
+    /// The plan that is found by prepare(). This is only used on the worker
+    /// of the robot.
+    struct Preparation
+    {
+      bool started = false;
+      std::shared_ptr<services::FindPath> service;
+      rmf_rxcpp::subscription_guard subscription;
+      std::optional<rmf_traffic::agv::Plan> plan;
+    };
+
     agv::RobotContextPtr _context;
+    rmf_traffic::agv::Plan::Start _start_estimate;
     rmf_traffic::agv::Plan::Goal _goal;
     double _time_estimate;
     std::optional<rmf_traffic::Duration> _tail_period;
     std::string _description;
+    std::shared_ptr<Preparation> _preparation;
   };
 
   /// Make a Task Phase for going to a place
@@ -122,7 +122,8 @@ MoveRobot::Action::Action(
   std::optional<rmf_traffic::Duration> tail_period)
 : _context{context},
   _waypoints{waypoints},
-  _tail_period{tail_period}
+  _tail_period{tail_period},
+  _delay_reporter{context->delay_reporter()}
 {
   // no op
 }
@@ -99,6 +99,7 @@ struct MoveRobot
     agv::RobotContextPtr _context;
     std::vector<rmf_traffic::agv::Plan::Waypoint> _waypoints;
     std::optional<rmf_traffic::Duration> _tail_period;
+    std::shared_ptr<agv::DelayReporter> _delay_reporter;
     std::optional<rmf_traffic::Time> _last_tail_bump;
     std::size_t _next_path_index = 0;
     bool _interrupted = false;
@@ -206,7 +207,22 @@ void MoveRobot::Action::operator()(const Subscriber& s)
         }
       }
 
-      if (std::chrono::milliseconds(500).count() < std::abs(new_delay.count()))
+      if (action->_delay_reporter)
+      {
+        // The fleet decides when and whether this delay gets applied
+        action->_delay_reporter->report(
+          action->_context->itinerary().id(), new_delay,
+          [context = action->_context](rmf_traffic::Duration delay)
+          {
+            context->worker().schedule(
+              [context, delay](const auto&)
+              {
+                context->itinerary().delay(delay);
+              });
+          });
+      }
+      else if (std::chrono::milliseconds(500).count()
+        < std::abs(new_delay.count()))
       {
         action->_context->worker().schedule(
           [context = action->_context, new_delay](const auto&)
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "PrenotifyDispenser.hpp"
+
+#include <rmf_traffic_ros2/Time.hpp>
+
+#include <algorithm>
+
+namespace rmf_fleet_adapter {
+namespace phases {
+
+//==============================================================================
+std::shared_ptr<PrenotifyDispenser> PrenotifyDispenser::make(
+  agv::RobotContextPtr context,
+  DispenserRequest request,
+  std::size_t pickup_waypoint,
+  rmf_traffic::Duration lead_time)
+{
+  auto prenotice = std::shared_ptr<PrenotifyDispenser>(
+    new PrenotifyDispenser(
+      std::move(context),
+      std::move(request),
+      pickup_waypoint,
+      lead_time));
+
+  const auto& context_ref = prenotice->_context;
+  const auto& node = context_ref->node();
+  const auto& worker = context_ref->worker();
+  prenotice->_result_sub = node->dispenser_result()
+    .observe_on(rxcpp::identity_same_worker(worker))
+    .subscribe([w = prenotice->weak_from_this()](const auto& result)
+      {
+        const auto me = w.lock();
+        if (!me || !me->_requested || me->_handed_over)
+          return;
+
+        if (result->request_guid != me->_request.request_guid)
+          return;
+
+        me->_handover.acknowledged = true;
+        me->_handover.result = result;
+        me->_retransmission.acknowledged(true);
+      });
+
+  prenotice->_state_sub = node->dispenser_state()
+    .observe_on(rxcpp::identity_same_worker(worker))
+    .subscribe([w = prenotice->weak_from_this()](const auto& state)
+      {
+        const auto me = w.lock();
+        if (!me || !me->_requested || me->_handed_over)
+          return;
+
+        if (state->guid != me->_request.target_guid)
+          return;
+
+        // Once the request leaves the queue it may have been dispensed, so we
+        // never treat its absence as a lost acknowledgment. Publishing it
+        // again could make the dispenser hand over the items twice.
+        const auto& queue = state->request_guid_queue;
+        if (std::find(queue.begin(), queue.end(), me->_request.request_guid)
+        != queue.end())
+        {
+          me->_handover.acknowledged = true;
+          me->_retransmission.acknowledged(true);
+        }
+      });
+
+  prenotice->_timer = node->try_create_wall_timer(
+    std::chrono::milliseconds(250),
+    [w = prenotice->weak_from_this(), worker]()
+    {
+      worker.schedule([w](const auto&)
+      {
+        if (const auto me = w.lock())
+          me->_update();
+      });
+    });
+
+  return prenotice;
+}
+
+//==============================================================================
+PrenotifyDispenser::PrenotifyDispenser(
+  agv::RobotContextPtr context,
+  DispenserRequest request,
+  std::size_t pickup_waypoint,
+  rmf_traffic::Duration lead_time)
+: _context(std::move(context)),
+  _request(std::move(request)),
+  _pickup_waypoint(pickup_waypoint),
+  _lead_time(lead_time)
+{
+  // Do nothing
+}
+
+//==============================================================================
+PrenotifyDispenser::~PrenotifyDispenser()
+{
+  // There is no way to withdraw a dispenser request, so the best we can do is
+  // let the operators know that the items will not be picked up.
+  if (_requested && !_handed_over)
+  {
+    RCLCPP_WARN(
+      _context->node()->get_logger(),
+      "Robot [%s] will not pick up the items of request [%s] that it asked "
+      "dispenser [%s] to prepare in advance",
+      _context->requester_id().c_str(),
+      _request.request_guid.c_str(),
+      _request.target_guid.c_str());
+  }
+}
+
+//==============================================================================
+auto PrenotifyDispenser::hand_over() -> std::optional<Handover>
+{
+  _handed_over = true;
+  _timer.reset();
+  _result_sub = rmf_rxcpp::subscription_guard();
+  _state_sub = rmf_rxcpp::subscription_guard();
+
+  if (!_requested)
+    return std::nullopt;
+
+  return _handover;
+}
+
+//==============================================================================
+void PrenotifyDispenser::_update()
+{
+  if (_handed_over)
+    return;
+
+  if (_requested)
+  {
+    if (_retransmission.due())
+      _publish();
+
+    return;
+  }
+
+  const auto arrival = _expected_arrival();
+  if (!arrival.has_value())
+    return;
+
+  if (_context->now() < *arrival - _lead_time)
+    return;
+
+  _request.time = rmf_traffic_ros2::convert(*arrival);
+  _requested = true;
+  _publish();
+  _retransmission.published();
+
+  RCLCPP_INFO(
+    _context->node()->get_logger(),
+    "Robot [%s] asked dispenser [%s] to prepare request [%s] ahead of its "
+    "arrival",
+    _context->requester_id().c_str(),
+    _request.target_guid.c_str(),
+    _request.request_guid.c_str());
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Time> PrenotifyDispenser::_expected_arrival() const
+{
+  const auto& itinerary = _context->itinerary().itinerary();
+  if (itinerary.empty())
+    return std::nullopt;
+
+  const auto& route = itinerary.back();
+  const auto& trajectory = route.trajectory();
+  if (trajectory.size() == 0)
+    return std::nullopt;
+
+  const auto& pickup =
+    _context->navigation_graph().get_waypoint(_pickup_waypoint);
+  if (route.map() != pickup.get_map_name())
+    return std::nullopt;
+
+  // Plans finish exactly on their goal waypoint, so this only needs to allow
+  // for rounding.
+  const Eigen::Vector2d p = trajectory.back().position().block<2, 1>(0, 0);
+  if ((p - pickup.get_location()).norm() > 1e-3)
+    return std::nullopt;
+
+  // The delays of the robot are applied to its itinerary, so this is already
+  // up to date.
+  return *trajectory.finish_time();
+}
+
+//==============================================================================
+void PrenotifyDispenser::_publish()
+{
+  _context->node()->dispenser_request()->publish(_request);
+}
+
+} // namespace phases
+} // namespace rmf_fleet_adapter
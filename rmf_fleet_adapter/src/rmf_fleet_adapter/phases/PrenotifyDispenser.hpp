@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__PHASES__PRENOTIFYDISPENSER_HPP
+#define SRC__RMF_FLEET_ADAPTER__PHASES__PRENOTIFYDISPENSER_HPP
+
+#include "Retransmission.hpp"
+#include "../agv/RobotContext.hpp"
+
+#include <rmf_rxcpp/RxJobs.hpp>
+
+#include <rmf_dispenser_msgs/msg/dispenser_request.hpp>
+#include <rmf_dispenser_msgs/msg/dispenser_result.hpp>
+
+#include <optional>
+
+namespace rmf_fleet_adapter {
+namespace phases {
+
+//==============================================================================
+/// Sends the request of a DispenseItem phase to the dispenser ahead of the
+/// robot's arrival at the pickup, so that the dispenser can stage the items
+/// by the time the robot gets there. The request has the same request_guid
+/// that the DispenseItem phase uses once the robot arrives, so the dispenser
+/// only sees one request.
+///
+/// DispenserRequest has no field for an arrival time, so the time stamp of an
+/// early request is the time when the robot is expected to arrive.
+///
+/// The arrival time is taken from the itinerary of the robot once the
+/// itinerary ends at the pickup waypoint, so nothing is sent while the robot
+/// is still planning its way there.
+///
+/// This is only used on the worker of the robot.
+class PrenotifyDispenser
+  : public std::enable_shared_from_this<PrenotifyDispenser>
+{
+public:
+
+  using DispenserRequest = rmf_dispenser_msgs::msg::DispenserRequest;
+  using DispenserResult = rmf_dispenser_msgs::msg::DispenserResult;
+
+  /// \param[in] lead_time
+  ///   How long before the robot is expected to arrive the request is sent.
+  static std::shared_ptr<PrenotifyDispenser> make(
+    agv::RobotContextPtr context,
+    DispenserRequest request,
+    std::size_t pickup_waypoint,
+    rmf_traffic::Duration lead_time);
+
+  ~PrenotifyDispenser();
+
+  /// What the dispenser has said about the request by the time it is handed
+  /// over to the DispenseItem phase
+  struct Handover
+  {
+    /// True if the dispenser has received the request
+    bool acknowledged = false;
+
+    /// The latest result that the dispenser gave for the request
+    DispenserResult::SharedPtr result;
+  };
+
+  /// The DispenseItem phase has begun, so it is responsible for the request
+  /// from now on.
+  ///
+  /// \return what the dispenser has said about the request, or a nullopt if
+  /// the request was never sent.
+  std::optional<Handover> hand_over();
+
+private:
+
+  PrenotifyDispenser(
+    agv::RobotContextPtr context,
+    DispenserRequest request,
+    std::size_t pickup_waypoint,
+    rmf_traffic::Duration lead_time);
+
+  void _update();
+
+  std::optional<rmf_traffic::Time> _expected_arrival() const;
+
+  void _publish();
+
+  agv::RobotContextPtr _context;
+  DispenserRequest _request;
+  std::size_t _pickup_waypoint;
+  rmf_traffic::Duration _lead_time;
+  bool _requested = false;
+  bool _handed_over = false;
+  Handover _handover;
+  Retransmission _retransmission;
+  rclcpp::TimerBase::SharedPtr _timer;
+  rmf_rxcpp::subscription_guard _result_sub;
+  rmf_rxcpp::subscription_guard _state_sub;
+};
+
+} // namespace phases
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__PHASES__PRENOTIFYDISPENSER_HPP
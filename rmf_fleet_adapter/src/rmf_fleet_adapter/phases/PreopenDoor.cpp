@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "PreopenDoor.hpp"
+#include "SupervisorHasSession.hpp"
+
+#include <rmf_door_msgs/msg/door_mode.hpp>
+
+namespace rmf_fleet_adapter {
+namespace phases {
+
+//==============================================================================
+std::shared_ptr<PreopenDoor> PreopenDoor::make(
+  agv::RobotContextPtr context,
+  std::string door_name,
+  std::string requester_id,
+  rmf_traffic::Time arrival,
+  rmf_traffic::Duration nominal_opening_time)
+{
+  auto preopen = std::shared_ptr<PreopenDoor>(
+    new PreopenDoor(
+      std::move(context),
+      std::move(door_name),
+      std::move(requester_id),
+      arrival,
+      nominal_opening_time));
+
+  const auto& node = preopen->_context->node();
+  if (const auto& times = preopen->_context->door_opening_times())
+  {
+    preopen->_door_state_sub = node->door_state(preopen->_door_name)
+      .subscribe([times](const auto& state)
+        {
+          times->observe(*state);
+        });
+  }
+
+  preopen->_supervisor_sub = node->door_supervisor()
+    .subscribe([w = preopen->weak_from_this()](const auto& heartbeat)
+      {
+        const auto me = w.lock();
+        if (!me)
+          return;
+
+        std::lock_guard<std::mutex> lock(me->_mutex);
+        if (!me->_requested || me->_handed_over)
+          return;
+
+        // If the supervisor has forgotten our session, we remind it right away
+        if (me->_retransmission.acknowledged(
+          supervisor_has_session(
+            *heartbeat, me->_requester_id, me->_door_name)))
+        {
+          me->_publish(rmf_door_msgs::msg::DoorMode::MODE_OPEN);
+        }
+      });
+
+  preopen->_timer = node->try_create_wall_timer(
+    std::chrono::milliseconds(250),
+    [w = preopen->weak_from_this()]()
+    {
+      if (const auto me = w.lock())
+        me->_update();
+    });
+
+  return preopen;
+}
+
+//==============================================================================
+PreopenDoor::PreopenDoor(
+  agv::RobotContextPtr context,
+  std::string door_name,
+  std::string requester_id,
+  rmf_traffic::Time arrival,
+  rmf_traffic::Duration nominal_opening_time)
+: _context(std::move(context)),
+  _door_name(std::move(door_name)),
+  _requester_id(std::move(requester_id)),
+  _arrival(arrival),
+  _nominal_opening_time(nominal_opening_time)
+{
+  // Do nothing
+}
+
+//==============================================================================
+PreopenDoor::~PreopenDoor()
+{
+  // Nobody is going to take over the session anymore, so we should not hold
+  // the door open for a robot that is not coming.
+  if (_requested && !_handed_over)
+    _publish(rmf_door_msgs::msg::DoorMode::MODE_CLOSED);
+}
+
+//==============================================================================
+const std::string& PreopenDoor::door_name() const
+{
+  return _door_name;
+}
+
+//==============================================================================
+void PreopenDoor::arrival(rmf_traffic::Time value)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _arrival = value;
+}
+
+//==============================================================================
+void PreopenDoor::hand_over()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _handed_over = true;
+  _timer.reset();
+  _door_state_sub = rmf_rxcpp::subscription_guard();
+  _supervisor_sub = rmf_rxcpp::subscription_guard();
+}
+
+//==============================================================================
+bool PreopenDoor::handed_over() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _handed_over;
+}
+
+//==============================================================================
+bool PreopenDoor::requested() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _requested;
+}
+
+//==============================================================================
+void PreopenDoor::_update()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_handed_over)
+    return;
+
+  if (_requested)
+  {
+    if (_retransmission.due())
+      _publish(rmf_door_msgs::msg::DoorMode::MODE_OPEN);
+
+    return;
+  }
+
+  auto opening_time = _nominal_opening_time;
+  if (const auto& times = _context->door_opening_times())
+  {
+    if (const auto learned = times->opening_time(_door_name))
+      opening_time = *learned;
+  }
+
+  const auto expected_arrival = _arrival + _context->itinerary().delay();
+  if (_context->now() < expected_arrival - opening_time - Margin)
+    return;
+
+  _requested = true;
+  _publish(rmf_door_msgs::msg::DoorMode::MODE_OPEN);
+  _retransmission.published();
+}
+
+//==============================================================================
+void PreopenDoor::_publish(const uint32_t mode)
+{
+  rmf_door_msgs::msg::DoorRequest msg;
+  msg.door_name = _door_name;
+  msg.request_time = _context->node()->now();
+  msg.requested_mode.value = mode;
+  msg.requester_id = _requester_id;
+  _context->node()->door_request()->publish(msg);
+}
+
+} // namespace phases
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__PHASES__PREOPENDOOR_HPP
+#define SRC__RMF_FLEET_ADAPTER__PHASES__PREOPENDOOR_HPP
+
+#include "Retransmission.hpp"
+#include "../agv/RobotContext.hpp"
+
+#include <rmf_rxcpp/RxJobs.hpp>
+
+#include <mutex>
+
+namespace rmf_fleet_adapter {
+namespace phases {
+
+//==============================================================================
+/// Asks for a door to open ahead of a robot's arrival, so that the door has
+/// finished opening by the time the robot gets there. The request is sent
+/// with the requester ID of the robot, so the door supervisor treats it as the
+/// same session that the DoorOpen phase will use once the robot arrives, and
+/// the sessions of other robots are not affected.
+///
+/// If this is destroyed before the DoorOpen phase takes over the request, e.g.
+/// because the robot was given a different plan, the request is withdrawn.
+class PreopenDoor : public std::enable_shared_from_this<PreopenDoor>
+{
+public:
+
+  /// How long before the estimated opening time a request is sent, to cover
+  /// the latency of the door supervisor and the door itself
+  static constexpr rmf_traffic::Duration Margin = std::chrono::seconds(1);
+
+  /// \param[in] arrival
+  ///   When the plan of the robot expects it to arrive at the door. The delay
+  ///   of the robot's itinerary is added to this.
+  ///
+  /// \param[in] nominal_opening_time
+  ///   How long the door is expected to take to open if the fleet has not
+  ///   learned its opening time yet.
+  static std::shared_ptr<PreopenDoor> make(
+    agv::RobotContextPtr context,
+    std::string door_name,
+    std::string requester_id,
+    rmf_traffic::Time arrival,
+    rmf_traffic::Duration nominal_opening_time);
+
+  ~PreopenDoor();
+
+  const std::string& door_name() const;
+
+  /// Change when the robot is expected to arrive at the door.
+  void arrival(rmf_traffic::Time value);
+
+  /// The DoorOpen phase has begun, so it is responsible for the request from
+  /// now on.
+  void hand_over();
+
+  bool handed_over() const;
+
+  /// True if the open request has been sent
+  bool requested() const;
+
+private:
+
+  PreopenDoor(
+    agv::RobotContextPtr context,
+    std::string door_name,
+    std::string requester_id,
+    rmf_traffic::Time arrival,
+    rmf_traffic::Duration nominal_opening_time);
+
+  void _update();
+
+  void _publish(uint32_t mode);
+
+  agv::RobotContextPtr _context;
+  std::string _door_name;
+  std::string _requester_id;
+  rmf_traffic::Time _arrival;
+  rmf_traffic::Duration _nominal_opening_time;
+  bool _requested = false;
+  bool _handed_over = false;
+  Retransmission _retransmission;
+  rclcpp::TimerBase::SharedPtr _timer;
+  rmf_rxcpp::subscription_guard _door_state_sub;
+  rmf_rxcpp::subscription_guard _supervisor_sub;
+  mutable std::mutex _mutex;
+};
+
+} // namespace phases
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__PHASES__PREOPENDOOR_HPP
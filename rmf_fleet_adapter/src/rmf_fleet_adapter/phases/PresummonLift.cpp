@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "PresummonLift.hpp"
+
+namespace rmf_fleet_adapter {
+namespace phases {
+
+//==============================================================================
+std::shared_ptr<PresummonLift> PresummonLift::make(
+  agv::RobotContextPtr context,
+  std::string lift_name,
+  std::string floor_name,
+  rmf_traffic::Time arrival)
+{
+  auto presummon = std::shared_ptr<PresummonLift>(
+    new PresummonLift(
+      std::move(context),
+      std::move(lift_name),
+      std::move(floor_name),
+      arrival));
+
+  const auto& node = presummon->_context->node();
+  presummon->_lift_state_sub = node->lift_state(presummon->_lift_name)
+    .subscribe([w = presummon->weak_from_this()](const auto& state)
+      {
+        const auto me = w.lock();
+        if (!me)
+          return;
+
+        std::lock_guard<std::mutex> lock(me->_mutex);
+        if (!me->_requested)
+          return;
+
+        if (!me->_arrived
+        && state->session_id == me->_context->requester_id()
+        && state->current_floor == me->_floor_name
+        && state->door_state == rmf_lift_msgs::msg::LiftState::DOOR_OPEN)
+        {
+          me->_arrived = true;
+          if (const auto& times = me->_context->lift_arrival_times())
+          {
+            times->record(
+              me->_lift_name,
+              std::chrono::steady_clock::now() - *me->_requested);
+          }
+        }
+
+        if (me->_handed_over)
+          return;
+
+        // If the lift has dropped our session, we ask for it again right away
+        const bool acknowledged =
+        state->session_id == me->_context->requester_id()
+        && state->destination_floor == me->_floor_name;
+
+        if (me->_retransmission.acknowledged(acknowledged))
+          me->_publish(rmf_lift_msgs::msg::LiftRequest::REQUEST_AGV_MODE);
+      });
+
+  presummon->_timer = node->try_create_wall_timer(
+    std::chrono::milliseconds(250),
+    [w = presummon->weak_from_this()]()
+    {
+      if (const auto me = w.lock())
+        me->_update();
+    });
+
+  return presummon;
+}
+
+//==============================================================================
+PresummonLift::PresummonLift(
+  agv::RobotContextPtr context,
+  std::string lift_name,
+  std::string floor_name,
+  rmf_traffic::Time arrival)
+: _context(std::move(context)),
+  _lift_name(std::move(lift_name)),
+  _floor_name(std::move(floor_name)),
+  _arrival(arrival)
+{
+  // Do nothing
+}
+
+//==============================================================================
+PresummonLift::~PresummonLift()
+{
+  // Nobody is going to take over the session anymore, so the lift should be
+  // free to serve other robots.
+  if (_requested && !_handed_over)
+    _publish(rmf_lift_msgs::msg::LiftRequest::REQUEST_END_SESSION);
+}
+
+//==============================================================================
+const std::string& PresummonLift::lift_name() const
+{
+  return _lift_name;
+}
+
+//==============================================================================
+const std::string& PresummonLift::floor_name() const
+{
+  return _floor_name;
+}
+
+//==============================================================================
+void PresummonLift::arrival(rmf_traffic::Time value)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _arrival = value;
+}
+
+//==============================================================================
+bool PresummonLift::hand_over()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _handed_over = true;
+  _timer.reset();
+
+  // We keep watching the lift until it arrives so that we can learn how long
+  // it took, unless it was never summoned.
+  if (!_requested || _arrived)
+    _lift_state_sub = rmf_rxcpp::subscription_guard();
+
+  return _requested.has_value();
+}
+
+//==============================================================================
+bool PresummonLift::handed_over() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _handed_over;
+}
+
+//==============================================================================
+void PresummonLift::_update()
+{
+  using rmf_lift_msgs::msg::LiftRequest;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_handed_over)
+    return;
+
+  if (_requested)
+  {
+    if (_retransmission.due())
+      _publish(LiftRequest::REQUEST_AGV_MODE);
+
+    return;
+  }
+
+  auto arrival_time = DefaultArrivalTime;
+  if (const auto& times = _context->lift_arrival_times())
+  {
+    if (const auto learned = times->arrival_time(_lift_name))
+      arrival_time = *learned;
+  }
+
+  const auto expected_arrival = _arrival + _context->itinerary().delay();
+  if (_context->now() < expected_arrival - arrival_time - Margin)
+    return;
+
+  _requested = std::chrono::steady_clock::now();
+  _publish(LiftRequest::REQUEST_AGV_MODE);
+  _retransmission.published();
+}
+
+//==============================================================================
+void PresummonLift::_publish(const uint8_t request_type)
+{
+  rmf_lift_msgs::msg::LiftRequest msg{};
+  msg.lift_name = _lift_name;
+  msg.destination_floor = _floor_name;
+  msg.session_id = _context->requester_id();
+  msg.request_time = _context->node()->now();
+  msg.request_type = request_type;
+  msg.door_state = rmf_lift_msgs::msg::LiftRequest::DOOR_OPEN;
+
+  _context->node()->lift_request()->publish(msg);
+}
+
+} // namespace phases
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__PHASES__PRESUMMONLIFT_HPP
+#define SRC__RMF_FLEET_ADAPTER__PHASES__PRESUMMONLIFT_HPP
+
+#include "Retransmission.hpp"
+#include "../agv/RobotContext.hpp"
+
+#include <rmf_rxcpp/RxJobs.hpp>
+
+#include <mutex>
+#include <optional>
+
+namespace rmf_fleet_adapter {
+namespace phases {
+
+//==============================================================================
+/// Summons a lift to the floor of a robot ahead of the robot's arrival, so
+/// that the lift is waiting with its doors open by the time the robot gets
+/// there. The request uses the robot's session ID, so it is the same session
+/// that the RequestLift phase continues once the robot arrives.
+///
+/// If this is destroyed before the RequestLift phase takes over the session,
+/// e.g. because the robot was given a different plan, the session is ended.
+///
+/// Once it has summoned a lift, this records how long the lift took to arrive
+/// in the lift arrival times of the fleet, even after the RequestLift phase has
+/// taken over.
+class PresummonLift : public std::enable_shared_from_this<PresummonLift>
+{
+public:
+
+  /// How long the lift is assumed to take to arrive if the fleet has not
+  /// learned its arrival time yet
+  static constexpr rmf_traffic::Duration DefaultArrivalTime =
+    std::chrono::seconds(15);
+
+  /// How long before the estimated arrival time a request is sent, to cover
+  /// the latency of the lift supervisor and the lift itself
+  static constexpr rmf_traffic::Duration Margin = std::chrono::seconds(1);
+
+  /// \param[in] arrival
+  ///   When the plan of the robot expects it to arrive at the lift. The delay
+  ///   of the robot's itinerary is added to this.
+  static std::shared_ptr<PresummonLift> make(
+    agv::RobotContextPtr context,
+    std::string lift_name,
+    std::string floor_name,
+    rmf_traffic::Time arrival);
+
+  ~PresummonLift();
+
+  const std::string& lift_name() const;
+
+  const std::string& floor_name() const;
+
+  /// Change when the robot is expected to arrive at the lift.
+  void arrival(rmf_traffic::Time value);
+
+  /// The RequestLift phase has begun, so it is responsible for the session
+  /// from now on.
+  ///
+  /// \return true if the lift has already been summoned
+  bool hand_over();
+
+  bool handed_over() const;
+
+private:
+
+  PresummonLift(
+    agv::RobotContextPtr context,
+    std::string lift_name,
+    std::string floor_name,
+    rmf_traffic::Time arrival);
+
+  void _update();
+
+  void _publish(uint8_t request_type);
+
+  agv::RobotContextPtr _context;
+  std::string _lift_name;
+  std::string _floor_name;
+  rmf_traffic::Time _arrival;
+  std::optional<std::chrono::steady_clock::time_point> _requested;
+  bool _handed_over = false;
+  bool _arrived = false;
+  Retransmission _retransmission;
+  rclcpp::TimerBase::SharedPtr _timer;
+  rmf_rxcpp::subscription_guard _lift_state_sub;
+  mutable std::mutex _mutex;
+};
+
+} // namespace phases
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__PHASES__PRESUMMONLIFT_HPP
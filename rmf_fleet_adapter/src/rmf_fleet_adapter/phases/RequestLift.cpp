@@ -28,7 +28,8 @@ std::shared_ptr<RequestLift::ActivePhase> RequestLift::ActivePhase::make(
   std::string lift_name,
   std::string destination,
   rmf_traffic::Time expected_finish,
-  const Located located)
+  const Located located,
+  const bool presummoned)
 {
   auto inst = std::shared_ptr<ActivePhase>(
     new ActivePhase(
@@ -36,7 +37,8 @@ std::shared_ptr<RequestLift::ActivePhase> RequestLift::ActivePhase::make(
       std::move(lift_name),
       std::move(destination),
       std::move(expected_finish),
-      located
+      located,
+      presummoned
   ));
   inst->_init_obs();
   return inst;
@@ -80,12 +82,14 @@ RequestLift::ActivePhase::ActivePhase(
   std::string lift_name,
   std::string destination,
   rmf_traffic::Time expected_finish,
-  Located located)
+  Located located,
+  bool presummoned)
 : _context(std::move(context)),
   _lift_name(std::move(lift_name)),
   _destination(std::move(destination)),
   _expected_finish(std::move(expected_finish)),
-  _located(located)
+  _located(located),
+  _record_arrival(located == Located::Outside && !presummoned)
 {
   std::ostringstream oss;
   oss << "Requesting lift [" << lift_name << "] to [" << destination << "]";
@@ -98,7 +102,7 @@ void RequestLift::ActivePhase::_init_obs()
 {
   using rmf_lift_msgs::msg::LiftState;
 
-  _obs = _context->node()->lift_state()
+  _obs = _context->node()->lift_state(_lift_name)
     .lift<LiftState::SharedPtr>(
     on_subscribe(
       [weak = weak_from_this()]()
@@ -107,7 +111,9 @@ void RequestLift::ActivePhase::_init_obs()
         if (!me)
           return;
 
+        me->_requested = std::chrono::steady_clock::now();
         me->_do_publish();
+        me->_retransmission.published();
         me->_timer = me->_context->node()->try_create_wall_timer(
           std::chrono::milliseconds(1000),
           [weak]()
@@ -116,9 +122,10 @@ void RequestLift::ActivePhase::_init_obs()
             if (!me)
               return;
 
-            // TODO(MXG): We can stop publishing the door request once the
-            // supervisor sees our request.
-            me->_do_publish();
+            // We stop publishing the lift request once the lift has taken on
+            // our session, and back off while it has not.
+            if (me->_retransmission.due())
+              me->_do_publish();
 
             const auto current_expected_finish =
             me->_expected_finish + me->_context->itinerary().delay();
@@ -153,6 +160,15 @@ void RequestLift::ActivePhase::_init_obs()
           status.state == Task::StatusMsg::STATE_COMPLETED ||
           status.state == Task::StatusMsg::STATE_FAILED)
         {
+          const auto& metrics = me->_context->phase_metrics();
+          if (metrics && status.state == Task::StatusMsg::STATE_COMPLETED)
+          {
+            metrics->record(
+              me->_context->name(), "RequestLift",
+              agv::PhaseMetricsCollector::Stage::LiftWait,
+              std::chrono::steady_clock::now() - me->_requested);
+          }
+
           me->_timer.reset();
           return false;
         }
@@ -192,12 +208,34 @@ Task::StatusMsg RequestLift::ActivePhase::_get_status(
   using rmf_lift_msgs::msg::LiftRequest;
   Task::StatusMsg status{};
   status.state = Task::StatusMsg::STATE_ACTIVE;
+
+  if (lift_state->lift_name == _lift_name)
+  {
+    // If the lift has dropped our session, we ask for it again right away
+    const bool acknowledged =
+      lift_state->session_id == _context->requester_id()
+      && lift_state->destination_floor == _destination;
+
+    if (_retransmission.acknowledged(acknowledged))
+      _do_publish();
+  }
+
   if (!_rewaiting &&
     lift_state->lift_name == _lift_name &&
     lift_state->current_floor == _destination &&
     lift_state->door_state == LiftState::DOOR_OPEN &&
     lift_state->session_id == _context->requester_id())
   {
+    if (_record_arrival)
+    {
+      _record_arrival = false;
+      if (const auto& times = _context->lift_arrival_times())
+      {
+        times->record(
+          _lift_name, std::chrono::steady_clock::now() - _requested);
+      }
+    }
+
     bool completed = false;
     const auto& watchdog = _context->get_lift_watchdog();
 
@@ -320,12 +358,14 @@ RequestLift::PendingPhase::PendingPhase(
   std::string lift_name,
   std::string destination,
   rmf_traffic::Time expected_finish,
-  Located located)
+  Located located,
+  std::shared_ptr<PresummonLift> presummon)
 : _context(std::move(context)),
   _lift_name(std::move(lift_name)),
   _destination(std::move(destination)),
   _expected_finish(std::move(expected_finish)),
-  _located(located)
+  _located(located),
+  _presummon(std::move(presummon))
 {
   std::ostringstream oss;
   oss << "Requesting lift \"" << lift_name << "\" to \"" << destination << "\"";
@@ -336,12 +376,14 @@ RequestLift::PendingPhase::PendingPhase(
 //==============================================================================
 std::shared_ptr<Task::ActivePhase> RequestLift::PendingPhase::begin()
 {
+  const bool presummoned = _presummon && _presummon->hand_over();
   return ActivePhase::make(
     _context,
     _lift_name,
     _destination,
     _expected_finish,
-    _located);
+    _located,
+    presummoned);
 }
 
 //==============================================================================
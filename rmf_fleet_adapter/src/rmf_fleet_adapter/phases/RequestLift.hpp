@@ -22,6 +22,8 @@
 #include "../agv/RobotContext.hpp"
 #include "rmf_fleet_adapter/StandardNames.hpp"
 #include "EndLiftSession.hpp"
+#include "PresummonLift.hpp"
+#include "Retransmission.hpp"
 
 namespace rmf_fleet_adapter {
 namespace phases {
@@ -39,12 +41,16 @@ struct RequestLift
   {
   public:
 
+    /// \param[in] presummoned
+    ///   True if the lift was already summoned before this phase began, in
+    ///   which case this phase does not learn how long the lift took to arrive.
     static std::shared_ptr<ActivePhase> make(
       agv::RobotContextPtr context,
       std::string lift_name,
       std::string destination,
       rmf_traffic::Time expected_finish,
-      Located located);
+      Located located,
+      bool presummoned = false);
 
     const rxcpp::observable<Task::StatusMsg>& observe() const override;
 
@@ -67,8 +73,11 @@ struct RequestLift
     std::string _description;
     rxcpp::observable<Task::StatusMsg> _obs;
     rclcpp::TimerBase::SharedPtr _timer;
+    std::chrono::steady_clock::time_point _requested;
+    Retransmission _retransmission;
     std::shared_ptr<EndLiftSession::Active> _lift_end_phase;
     Located _located;
+    bool _record_arrival;
     rmf_rxcpp::subscription_guard _reset_session_subscription;
 
     struct WatchdogInfo
@@ -86,7 +95,8 @@ struct RequestLift
       std::string lift_name,
       std::string destination,
       rmf_traffic::Time expected_finish,
-      Located located);
+      Located located,
+      bool presummoned);
 
     void _init_obs();
 
@@ -100,12 +110,16 @@ struct RequestLift
   {
   public:
 
+    /// \param[in] presummon
+    ///   If the lift is being summoned before the robot arrives, this phase
+    ///   takes over that session when it begins.
     PendingPhase(
       agv::RobotContextPtr context,
       std::string lift_name,
       std::string destination,
       rmf_traffic::Time expected_finish,
-      Located located);
+      Located located,
+      std::shared_ptr<PresummonLift> presummon = nullptr);
 
     std::shared_ptr<Task::ActivePhase> begin() override;
 
@@ -119,6 +133,7 @@ struct RequestLift
     std::string _destination;
     rmf_traffic::Time _expected_finish;
     Located _located;
+    std::shared_ptr<PresummonLift> _presummon;
     std::string _description;
   };
 };
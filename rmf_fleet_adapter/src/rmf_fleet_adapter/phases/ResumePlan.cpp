@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ResumePlan.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rmf_fleet_adapter {
+namespace phases {
+
+namespace {
+//==============================================================================
+// How far the orientation of the robot may be from the start of a plan for
+// the plan to still be used
+const double StartOrientationTolerance = 10.0*M_PI/180.0;
+} // anonymous namespace
+
+//==============================================================================
+bool matches_start(
+  const rmf_traffic::agv::Plan::Start& start,
+  const rmf_traffic::agv::Plan::Start& expected)
+{
+  if (start.waypoint() != expected.waypoint())
+    return false;
+
+  // A robot that is partway along a lane would need a different plan
+  if (start.lane().has_value() || start.location().has_value())
+    return false;
+
+  const double diff = start.orientation() - expected.orientation();
+  return std::abs(std::atan2(std::sin(diff), std::cos(diff)))
+    <= StartOrientationTolerance;
+}
+
+//==============================================================================
+std::optional<std::size_t> find_resume_waypoint(
+  const std::vector<rmf_traffic::agv::Plan::Waypoint>& waypoints,
+  const std::vector<rmf_traffic::agv::Plan::Start>& location,
+  const std::size_t goal)
+{
+  if (waypoints.empty())
+    return std::nullopt;
+
+  if (waypoints.back().graph_index() != goal)
+    return std::nullopt;
+
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+  {
+    const auto& wp = waypoints[i];
+    if (!wp.graph_index() || wp.event() || (i > 0 && waypoints[i-1].event()))
+      continue;
+
+    const rmf_traffic::agv::Plan::Start expected(
+      wp.time(), *wp.graph_index(), wp.position()[2]);
+
+    const bool at_waypoint = std::any_of(
+      location.begin(), location.end(),
+      [&](const auto& start) { return matches_start(start, expected); });
+
+    if (!at_waypoint)
+      continue;
+
+    // There is nothing left to resume if the robot is already at the end
+    if (i + 1 >= waypoints.size())
+      return std::nullopt;
+
+    return i;
+  }
+
+  return std::nullopt;
+}
+
+//==============================================================================
+bool resumed_itinerary_is_clear(
+  const std::vector<rmf_traffic::Route>& itinerary,
+  const rmf_traffic::Duration time_offset,
+  const rmf_traffic::Time now,
+  const rmf_traffic::agv::RouteValidator& validator)
+{
+  for (const auto& route : itinerary)
+  {
+    auto shifted = route;
+    auto& trajectory = shifted.trajectory();
+    if (trajectory.size() == 0)
+      continue;
+
+    trajectory.begin()->adjust_times(time_offset);
+
+    // The robot has already travelled the part of the route that is now in
+    // the past, so only the rest of it needs to be clear.
+    trajectory.erase(
+      trajectory.begin(),
+      trajectory.find(now - std::chrono::milliseconds(1)));
+
+    if (trajectory.size() < 2)
+      continue;
+
+    if (validator.find_conflict(shifted))
+      return false;
+  }
+
+  return true;
+}
+
+} // namespace phases
+} // namespace rmf_fleet_adapter
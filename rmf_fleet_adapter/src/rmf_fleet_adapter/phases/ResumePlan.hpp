@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__PHASES__RESUMEPLAN_HPP
+#define SRC__RMF_FLEET_ADAPTER__PHASES__RESUMEPLAN_HPP
+
+#include <rmf_traffic/agv/Planner.hpp>
+#include <rmf_traffic/agv/RouteValidator.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace phases {
+
+//==============================================================================
+/// Check if the robot is stopped at the start that a plan expects, facing
+/// close enough to the same direction.
+bool matches_start(
+  const rmf_traffic::agv::Plan::Start& start,
+  const rmf_traffic::agv::Plan::Start& expected);
+
+//==============================================================================
+/// Find the waypoint of a plan that the robot can resume the plan from. This
+/// is the first waypoint that the robot is stopped at, as long as it is not
+/// at or right after an event, since we cannot tell how far the event got.
+///
+/// \param[in] waypoints
+///   The waypoints of the plan
+///
+/// \param[in] location
+///   The current location of the robot
+///
+/// \param[in] goal
+///   The graph index of the goal. A plan that leads somewhere else, such as a
+///   leftover emergency pullover, cannot be resumed.
+///
+/// \return the index of the waypoint to resume from, or std::nullopt if the
+/// plan cannot be resumed.
+std::optional<std::size_t> find_resume_waypoint(
+  const std::vector<rmf_traffic::agv::Plan::Waypoint>& waypoints,
+  const std::vector<rmf_traffic::agv::Plan::Start>& location,
+  std::size_t goal);
+
+//==============================================================================
+/// Check that an itinerary, shifted later by time_offset, does not conflict
+/// with anything from now on. The part of the itinerary that is already in
+/// the past once it is shifted has been travelled, so it is not checked.
+bool resumed_itinerary_is_clear(
+  const std::vector<rmf_traffic::Route>& itinerary,
+  rmf_traffic::Duration time_offset,
+  rmf_traffic::Time now,
+  const rmf_traffic::agv::RouteValidator& validator);
+
+} // namespace phases
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__PHASES__RESUMEPLAN_HPP
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "Retransmission.hpp"
+
+#include <algorithm>
+
+namespace rmf_fleet_adapter {
+namespace phases {
+
+//==============================================================================
+Retransmission::Retransmission(
+  Clock::duration initial_interval,
+  Clock::duration maximum_interval)
+: _initial_interval(initial_interval),
+  _maximum_interval(std::max(initial_interval, maximum_interval))
+{
+  _reset(Clock::now());
+}
+
+//==============================================================================
+void Retransmission::published()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _reset(Clock::now());
+}
+
+//==============================================================================
+bool Retransmission::due()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_acknowledged)
+    return false;
+
+  const auto now = Clock::now();
+  if (now < _last_published + _interval)
+    return false;
+
+  _last_published = now;
+  _interval = std::min(2*_interval, _maximum_interval);
+  return true;
+}
+
+//==============================================================================
+bool Retransmission::acknowledged(const bool value)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const bool lost = _acknowledged && !value;
+  _acknowledged = value;
+  if (lost)
+    _reset(Clock::now());
+
+  return lost;
+}
+
+//==============================================================================
+void Retransmission::_reset(const Clock::time_point now)
+{
+  _last_published = now;
+  _interval = _initial_interval;
+}
+
+} // namespace phases
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__PHASES__RETRANSMISSION_HPP
+#define SRC__RMF_FLEET_ADAPTER__PHASES__RETRANSMISSION_HPP
+
+#include <chrono>
+#include <mutex>
+
+namespace rmf_fleet_adapter {
+namespace phases {
+
+//==============================================================================
+/// Decides when a request should be published again. While the receiver has
+/// not acknowledged the request, the wait between retransmissions doubles
+/// each time, up to a maximum. Once the request is acknowledged, nothing more
+/// is published unless the acknowledgement is lost again, e.g. because the
+/// receiver restarted.
+///
+/// This is safe to use from multiple threads.
+class Retransmission
+{
+public:
+
+  using Clock = std::chrono::steady_clock;
+
+  Retransmission(
+    Clock::duration initial_interval = std::chrono::seconds(1),
+    Clock::duration maximum_interval = std::chrono::seconds(16));
+
+  /// Call this when the request has been published outside of due().
+  void published();
+
+  /// Check whether the request should be published again. If this returns
+  /// true, it is assumed that the request will be published right away.
+  bool due();
+
+  /// Tell this whether the receiver currently acknowledges the request.
+  ///
+  /// \return true if an earlier acknowledgement has been lost, in which case
+  /// the request should be published right away.
+  bool acknowledged(bool value);
+
+private:
+
+  /// The mutex must be locked
+  void _reset(Clock::time_point now);
+
+  Clock::duration _initial_interval;
+  Clock::duration _maximum_interval;
+  Clock::duration _interval;
+  Clock::time_point _last_published;
+  bool _acknowledged = false;
+  std::mutex _mutex;
+};
+
+} // namespace phases
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__PHASES__RETRANSMISSION_HPP
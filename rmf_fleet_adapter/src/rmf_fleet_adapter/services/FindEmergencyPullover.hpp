@@ -20,6 +20,7 @@
 
 #include "../jobs/SearchForPath.hpp"
 #include "ProgressEvaluator.hpp"
+#include "PulloverCandidates.hpp"
 
 namespace rmf_fleet_adapter {
 namespace services {
@@ -35,7 +36,8 @@ public:
     rmf_traffic::agv::Plan::StartSet starts,
     std::shared_ptr<const rmf_traffic::schedule::Snapshot> schedule,
     rmf_traffic::schedule::ParticipantId participant_id,
-    std::shared_ptr<const rmf_traffic::Profile> profile);
+    std::shared_ptr<const rmf_traffic::Profile> profile,
+    std::shared_ptr<PulloverCandidates> candidates = nullptr);
 
   using Result = rmf_traffic::agv::Plan::Result;
 
@@ -53,6 +55,7 @@ private:
   std::shared_ptr<const rmf_traffic::schedule::Snapshot> _schedule;
   rmf_traffic::schedule::ParticipantId _participant_id;
   std::shared_ptr<const rmf_traffic::Profile> _profile;
+  std::shared_ptr<PulloverCandidates> _candidates;
 
   std::vector<std::shared_ptr<jobs::SearchForPath>> _search_jobs;
   rmf_rxcpp::subscription_guard _search_sub;
@@ -36,7 +36,8 @@ public:
     rmf_traffic::agv::Plan::Goal goal,
     std::shared_ptr<const rmf_traffic::schedule::Snapshot> schedule,
     rmf_traffic::schedule::ParticipantId participant_id,
-    const std::shared_ptr<const rmf_traffic::Profile>& profile);
+    const std::shared_ptr<const rmf_traffic::Profile>& profile,
+    std::shared_ptr<jobs::PlanCache> cache = nullptr);
 
   using Result = rmf_traffic::agv::Plan::Result;
 
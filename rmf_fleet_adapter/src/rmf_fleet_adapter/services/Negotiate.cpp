@@ -35,6 +35,9 @@ Negotiate::Negotiate(
   _goals(std::move(goals)),
   _viewer(std::move(viewer)),
   _responder(std::move(responder)),
+  _cancelled(_responder ?
+    rmf_traffic_ros2::schedule::Negotiation::cancellation_token(*_responder) :
+    nullptr),
   _approval(std::move(approval)),
   _initial_itinerary(std::move(initial_itinerary)),
   _evaluator(evaluator)
@@ -71,18 +74,27 @@ std::shared_ptr<Negotiate> Negotiate::emergency_pullover(
   rmf_traffic::schedule::Negotiation::Table::ViewerPtr viewer,
   rmf_traffic::schedule::Negotiator::ResponderPtr responder,
   ApprovalCallback approval,
-  const ProgressEvaluator evaluator)
+  const ProgressEvaluator evaluator,
+  const std::shared_ptr<PulloverCandidates>& candidates)
 {
-  const auto& graph = planner->get_configuration().graph();
-  const std::size_t N = graph.num_waypoints();
-
   std::vector<rmf_traffic::agv::Plan::Goal> goals;
-  goals.reserve(N);
-  for (std::size_t i = 0; i < N; ++i)
+  if (candidates)
+  {
+    for (const auto wp : candidates->candidates(planner, starts))
+      goals.push_back(wp);
+  }
+
+  if (goals.empty())
   {
-    const auto& wp = graph.get_waypoint(i);
-    if (wp.is_parking_spot())
-      goals.push_back(wp.index());
+    const auto& graph = planner->get_configuration().graph();
+    const std::size_t N = graph.num_waypoints();
+    goals.reserve(N);
+    for (std::size_t i = 0; i < N; ++i)
+    {
+      const auto& wp = graph.get_waypoint(i);
+      if (wp.is_parking_spot())
+        goals.push_back(wp.index());
+    }
   }
 
   return std::make_shared<Negotiate>(
@@ -101,6 +113,69 @@ void Negotiate::interrupt()
   *_interrupted = true;
 }
 
+//==============================================================================
+Negotiate& Negotiate::max_concurrent_jobs(const std::size_t value)
+{
+  _max_concurrent_jobs = std::max<std::size_t>(value, 1);
+  return *this;
+}
+
+//==============================================================================
+std::size_t Negotiate::max_concurrent_jobs() const
+{
+  return _max_concurrent_jobs;
+}
+
+//==============================================================================
+std::size_t Negotiate::default_max_concurrent_jobs()
+{
+  std::size_t threads = rmf_rxcpp::PlanningScheduler::options(
+    rmf_rxcpp::PlanningPriority::Normal).threads;
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+
+  return std::max<std::size_t>(threads, 5);
+}
+
+//==============================================================================
+Negotiate& Negotiate::arena(std::shared_ptr<NegotiationArena> value)
+{
+  _arena = std::move(value);
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<NegotiationArena>& Negotiate::arena() const
+{
+  return _arena;
+}
+
+//==============================================================================
+Negotiate& Negotiate::rollout_cache(std::shared_ptr<RolloutCache> value)
+{
+  _rollout_cache = std::move(value);
+  return *this;
+}
+
+//==============================================================================
+const std::shared_ptr<RolloutCache>& Negotiate::rollout_cache() const
+{
+  return _rollout_cache;
+}
+
+//==============================================================================
+Negotiate& Negotiate::statistics(std::shared_ptr<Statistics> value)
+{
+  _statistics = std::move(value);
+  return *this;
+}
+
+//==============================================================================
+auto Negotiate::statistics() const -> const std::shared_ptr<Statistics>&
+{
+  return _statistics;
+}
+
 //==============================================================================
 void Negotiate::discard()
 {
@@ -111,7 +186,7 @@ void Negotiate::discard()
 //==============================================================================
 bool Negotiate::discarded() const
 {
-  return _discarded || _viewer->defunct();
+  return _discarded || _viewer->defunct() || (_cancelled && *_cancelled);
 }
 
 //==============================================================================
@@ -121,6 +196,13 @@ Negotiate::responder() const
   return _responder;
 }
 
+//==============================================================================
+const rmf_traffic::schedule::Negotiator::TableViewerPtr&
+Negotiate::viewer() const
+{
+  return _viewer;
+}
+
 //==============================================================================
 Negotiate::~Negotiate()
 {
@@ -138,7 +220,7 @@ void Negotiate::_resume_next()
 {
   const auto top = _resume_jobs.top();
   _resume_jobs.pop();
-  _current_jobs.insert(top);
+  _current_jobs.push_back(top);
   top->resume();
 }
 
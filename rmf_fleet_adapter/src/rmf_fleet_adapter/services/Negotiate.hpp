@@ -19,9 +19,15 @@
 #define SRC__RMF_FLEET_ADAPTER__SERVICES__NEGOTIATEPATH_HPP
 
 #include <rmf_traffic/schedule/Negotiator.hpp>
+#include <rmf_traffic_ros2/schedule/Negotiation.hpp>
 #include "../jobs/Planning.hpp"
 #include "../jobs/Rollout.hpp"
+#include "NegotiationArena.hpp"
 #include "ProgressEvaluator.hpp"
+#include "PulloverCandidates.hpp"
+#include "RolloutCache.hpp"
+
+#include <atomic>
 
 namespace rmf_fleet_adapter {
 namespace services {
@@ -62,12 +68,16 @@ public:
     rmf_traffic::schedule::Negotiation::Table::ViewerPtr viewer,
     rmf_traffic::schedule::Negotiator::ResponderPtr responder,
     ApprovalCallback approval,
-    ProgressEvaluator evaluator);
+    ProgressEvaluator evaluator,
+    const std::shared_ptr<PulloverCandidates>& candidates = nullptr);
 
   struct Result
   {
     std::shared_ptr<Negotiate> service;
     std::function<void()> respond;
+
+    /// The plan that respond() will submit, if the service found one
+    rmf_utils::optional<rmf_traffic::agv::Plan> plan;
   };
 
   template<typename Subscriber>
@@ -75,12 +85,71 @@ public:
 
   void interrupt();
 
+  /// Set how many of the most promising planning jobs may be resumed at the
+  /// same time. Each job runs on its own worker of the planning scheduler, so
+  /// the jobs are searched in parallel up to this limit. This should be set
+  /// before the service is started.
+  Negotiate& max_concurrent_jobs(std::size_t value);
+
+  /// Get how many planning jobs may be resumed at the same time.
+  std::size_t max_concurrent_jobs() const;
+
+  /// The default limit on concurrent jobs. This is the number of threads of
+  /// the normal priority planning scheduler, but never less than 5.
+  static std::size_t default_max_concurrent_jobs();
+
+  /// Set the arena that the planning jobs of this service are allocated from.
+  /// When this is left as nullptr the jobs are allocated from the heap. This
+  /// should be set before the service is started.
+  Negotiate& arena(std::shared_ptr<NegotiationArena> value);
+
+  /// Get the arena that the planning jobs are allocated from.
+  const std::shared_ptr<NegotiationArena>& arena() const;
+
+  /// Set the cache that rollouts are shared through. When this is left as
+  /// nullptr every table that needs alternatives expands its own rollout.
+  /// This should be set before the service is started.
+  Negotiate& rollout_cache(std::shared_ptr<RolloutCache> value);
+
+  /// Get the cache that rollouts are shared through.
+  const std::shared_ptr<RolloutCache>& rollout_cache() const;
+
+  /// Counters of the work done by negotiation services. One instance may be
+  /// shared by every service of a negotiation to profile all of it.
+  struct Statistics
+  {
+    /// Planning jobs that were started, one per goal and validator
+    std::atomic_size_t planning_jobs{0};
+
+    /// Times that a planning job was stepped forward. rmf_traffic does not
+    /// report how many nodes its planner expands, so this is the measure of
+    /// how much searching was done.
+    std::atomic_size_t planning_steps{0};
+
+    /// Rollouts that were started to find alternatives for a parent
+    std::atomic_size_t rollouts{0};
+
+    /// Times that the alternatives of a rollout were taken from another table
+    /// instead of starting a new rollout
+    std::atomic_size_t shared_rollouts{0};
+  };
+
+  /// Set the statistics that this service adds its work to. When this is
+  /// left as nullptr nothing is counted. This should be set before the
+  /// service is started.
+  Negotiate& statistics(std::shared_ptr<Statistics> value);
+
+  /// Get the statistics that this service adds its work to.
+  const std::shared_ptr<Statistics>& statistics() const;
+
   void discard();
 
   bool discarded() const;
 
   const rmf_traffic::schedule::Negotiator::ResponderPtr& responder() const;
 
+  const rmf_traffic::schedule::Negotiator::TableViewerPtr& viewer() const;
+
   ~Negotiate();
 
 private:
@@ -92,6 +161,8 @@ private:
   std::vector<rmf_traffic::agv::Plan::Goal> _goals;
   rmf_traffic::schedule::Negotiator::TableViewerPtr _viewer;
   rmf_traffic::schedule::Negotiator::ResponderPtr _responder;
+  // Raised by the negotiation once our response is no longer wanted
+  rmf_traffic_ros2::schedule::Negotiation::CancellationToken _cancelled;
   ApprovalCallback _approval;
   std::vector<rmf_traffic::Route> _initial_itinerary;
 
@@ -110,7 +181,9 @@ private:
     }
   };
 
-  std::unordered_set<JobPtr> _current_jobs;
+  // There are never more than _max_concurrent_jobs of these, so a vector is
+  // cheaper to search than a hash set and does not allocate per insertion.
+  std::vector<JobPtr> _current_jobs;
   std::priority_queue<JobPtr, std::vector<JobPtr>, CompareJobs> _resume_jobs;
   std::vector<JobPtr> _queued_jobs; // Used to keep the jobs alive
   JobPtr _best_job;
@@ -127,7 +200,10 @@ private:
   std::shared_ptr<bool> _interrupted = std::make_shared<bool>(false);
   bool _discarded = false;
 
-  static constexpr std::size_t max_concurrent_jobs = 5;
+  std::size_t _max_concurrent_jobs = default_max_concurrent_jobs();
+  std::shared_ptr<NegotiationArena> _arena;
+  std::shared_ptr<RolloutCache> _rollout_cache;
+  std::shared_ptr<Statistics> _statistics;
 
   ProgressEvaluator _evaluator;
 };
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "NegotiationAdmission.hpp"
+
+namespace rmf_fleet_adapter {
+namespace services {
+
+//==============================================================================
+std::shared_ptr<NegotiationAdmission> NegotiationAdmission::make(
+  std::optional<std::size_t> max_concurrent,
+  std::size_t max_queued)
+{
+  return std::shared_ptr<NegotiationAdmission>(
+    new NegotiationAdmission(max_concurrent, max_queued));
+}
+
+//==============================================================================
+void NegotiationAdmission::submit(Request request)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queue.emplace_back(std::move(request));
+  }
+
+  _process();
+}
+
+//==============================================================================
+void NegotiationAdmission::max_concurrent(std::optional<std::size_t> value)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _max_concurrent = value;
+  }
+
+  _process();
+}
+
+//==============================================================================
+std::optional<std::size_t> NegotiationAdmission::max_concurrent() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _max_concurrent;
+}
+
+//==============================================================================
+std::size_t NegotiationAdmission::active() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _active;
+}
+
+//==============================================================================
+std::size_t NegotiationAdmission::queued() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _queue.size();
+}
+
+//==============================================================================
+NegotiationAdmission::NegotiationAdmission(
+  std::optional<std::size_t> max_concurrent,
+  std::size_t max_queued)
+: _max_concurrent(max_concurrent),
+  _max_queued(max_queued)
+{
+  // Do nothing
+}
+
+//==============================================================================
+auto NegotiationAdmission::_make_ticket() -> Ticket
+{
+  // The ticket does not own anything. It only exists so that its deleter can
+  // release the slot.
+  return Ticket(
+    static_cast<void*>(nullptr),
+    [w = weak_from_this()](void*)
+    {
+      if (const auto admission = w.lock())
+        admission->_release();
+    });
+}
+
+//==============================================================================
+void NegotiationAdmission::_release()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_active > 0)
+      --_active;
+  }
+
+  _process();
+}
+
+//==============================================================================
+void NegotiationAdmission::_process()
+{
+  std::vector<Request> start;
+  std::vector<Request> shed;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto now = Clock::now();
+    for (auto it = _queue.begin(); it != _queue.end(); )
+    {
+      if (it->defunct && it->defunct())
+      {
+        // Nobody is waiting on a defunct table, so it can be dropped quietly
+        it = _queue.erase(it);
+        continue;
+      }
+
+      if (it->deadline <= now)
+      {
+        shed.emplace_back(std::move(*it));
+        it = _queue.erase(it);
+        continue;
+      }
+
+      ++it;
+    }
+
+    while (!_max_concurrent || _active < *_max_concurrent)
+    {
+      const auto next = _most_urgent();
+      if (!next)
+        break;
+
+      ++_active;
+      start.emplace_back(std::move(_queue[*next]));
+      _queue.erase(_queue.begin() + *next);
+    }
+
+    while (_queue.size() > _max_queued)
+    {
+      // Shed the least urgent request, which is the one that would have been
+      // chosen last.
+      std::size_t least = 0;
+      for (std::size_t i = 1; i < _queue.size(); ++i)
+      {
+        const auto& a = _queue[i];
+        const auto& b = _queue[least];
+        if (a.depth < b.depth
+          || (a.depth == b.depth && a.deadline > b.deadline))
+        {
+          least = i;
+        }
+      }
+
+      shed.emplace_back(std::move(_queue[least]));
+      _queue.erase(_queue.begin() + least);
+    }
+  }
+
+  for (const auto& request : shed)
+  {
+    if (request.shed)
+      request.shed();
+  }
+
+  for (const auto& request : start)
+    request.start(_make_ticket());
+}
+
+//==============================================================================
+std::optional<std::size_t> NegotiationAdmission::_most_urgent() const
+{
+  if (_queue.empty())
+    return std::nullopt;
+
+  std::size_t best = 0;
+  for (std::size_t i = 1; i < _queue.size(); ++i)
+  {
+    const auto& a = _queue[i];
+    const auto& b = _queue[best];
+    if (a.depth > b.depth || (a.depth == b.depth && a.deadline < b.deadline))
+      best = i;
+  }
+
+  return best;
+}
+
+} // namespace services
+} // namespace rmf_fleet_adapter
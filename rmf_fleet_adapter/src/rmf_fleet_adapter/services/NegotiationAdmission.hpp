@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__SERVICES__NEGOTIATIONADMISSION_HPP
+#define SRC__RMF_FLEET_ADAPTER__SERVICES__NEGOTIATIONADMISSION_HPP
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace services {
+
+//==============================================================================
+/// Limits how many negotiation responders a fleet runs at once. Requests that
+/// arrive while the fleet is at capacity wait in a queue, and the most urgent
+/// one is started whenever a running responder finishes. Requests that go
+/// stale while they wait are shed instead of being started.
+class NegotiationAdmission
+  : public std::enable_shared_from_this<NegotiationAdmission>
+{
+public:
+
+  using Clock = std::chrono::steady_clock;
+
+  /// A running responder holds on to its ticket until it is finished. The
+  /// slot is released when the last copy of the ticket is destroyed.
+  using Ticket = std::shared_ptr<void>;
+
+  static constexpr std::size_t DefaultMaxConcurrent = 10;
+  static constexpr std::size_t DefaultMaxQueued = 40;
+
+  struct Request
+  {
+    /// The depth of the table in the negotiation. Deeper tables are closer to
+    /// completing a proposal, so they are started first.
+    std::size_t depth;
+
+    /// The time by which a response is expected. Among tables of the same
+    /// depth, the earliest deadline is started first. The request is shed if
+    /// it is still waiting when its deadline passes.
+    Clock::time_point deadline;
+
+    /// Return true if the table no longer needs a response
+    std::function<bool()> defunct;
+
+    /// Start the responder
+    std::function<void(Ticket)> start;
+
+    /// Called instead of start when the request is shed before its table has
+    /// become defunct, so that the negotiation is not left waiting on it.
+    std::function<void()> shed;
+  };
+
+  /// \param[in] max_concurrent
+  ///   The most responders that may run at once. A std::nullopt allows any
+  ///   number of responders.
+  ///
+  /// \param[in] max_queued
+  ///   The most requests that may wait for a slot. When the queue is full, the
+  ///   least urgent request is shed.
+  static std::shared_ptr<NegotiationAdmission> make(
+    std::optional<std::size_t> max_concurrent = DefaultMaxConcurrent,
+    std::size_t max_queued = DefaultMaxQueued);
+
+  /// Submit a request for a responder. The request may be started right away,
+  /// from within this function.
+  void submit(Request request);
+
+  /// Change the limit on concurrent responders
+  void max_concurrent(std::optional<std::size_t> value);
+
+  /// Get the limit on concurrent responders
+  std::optional<std::size_t> max_concurrent() const;
+
+  /// Get the number of responders that are currently running
+  std::size_t active() const;
+
+  /// Get the number of requests that are waiting for a slot
+  std::size_t queued() const;
+
+private:
+
+  NegotiationAdmission(
+    std::optional<std::size_t> max_concurrent,
+    std::size_t max_queued);
+
+  Ticket _make_ticket();
+
+  void _release();
+
+  /// Start or shed whatever the current capacity allows. This must be called
+  /// without the mutex locked, because it runs the request callbacks.
+  void _process();
+
+  /// Choose the next request that should take a slot, or std::nullopt if the
+  /// queue is empty. The mutex must be locked.
+  std::optional<std::size_t> _most_urgent() const;
+
+  mutable std::mutex _mutex;
+  std::optional<std::size_t> _max_concurrent;
+  std::size_t _max_queued;
+  std::size_t _active = 0;
+  std::vector<Request> _queue;
+};
+
+} // namespace services
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__SERVICES__NEGOTIATIONADMISSION_HPP
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "NegotiationArena.hpp"
+
+namespace rmf_fleet_adapter {
+namespace services {
+
+//==============================================================================
+std::shared_ptr<NegotiationArena> NegotiationArena::make()
+{
+  return std::shared_ptr<NegotiationArena>(new NegotiationArena);
+}
+
+//==============================================================================
+std::size_t NegotiationArena::bytes_in_use() const
+{
+  return _bytes_in_use;
+}
+
+//==============================================================================
+void* NegotiationArena::_allocate(
+  const std::size_t bytes,
+  const std::size_t alignment)
+{
+  void* p = _pool.allocate(bytes, alignment);
+  _bytes_in_use += bytes;
+  return p;
+}
+
+//==============================================================================
+void NegotiationArena::_deallocate(
+  void* p,
+  const std::size_t bytes,
+  const std::size_t alignment)
+{
+  _bytes_in_use -= bytes;
+  _pool.deallocate(p, bytes, alignment);
+}
+
+} // namespace services
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__SERVICES__NEGOTIATIONARENA_HPP
+#define SRC__RMF_FLEET_ADAPTER__SERVICES__NEGOTIATIONARENA_HPP
+
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+
+namespace rmf_fleet_adapter {
+namespace services {
+
+//==============================================================================
+/// A pool of memory that the negotiation services of a fleet share for the
+/// state of their planning jobs. Every negotiation creates and discards many
+/// jobs of the same few sizes, so the memory of discarded jobs is kept in the
+/// pool and handed to the jobs of the next negotiation instead of going back
+/// to the heap.
+///
+/// Anything that is allocated from the arena keeps the arena alive, so it is
+/// safe to drop the arena while jobs are still running.
+class NegotiationArena : public std::enable_shared_from_this<NegotiationArena>
+{
+public:
+
+  /// An allocator that takes its memory from an arena
+  template<typename T>
+  class Allocator
+  {
+  public:
+
+    using value_type = T;
+
+    Allocator(std::shared_ptr<NegotiationArena> arena)
+    : _arena(std::move(arena))
+    {
+      // Do nothing
+    }
+
+    template<typename U>
+    Allocator(const Allocator<U>& other)
+    : _arena(other._arena)
+    {
+      // Do nothing
+    }
+
+    T* allocate(const std::size_t n)
+    {
+      return static_cast<T*>(_arena->_allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, const std::size_t n)
+    {
+      _arena->_deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    template<typename U>
+    bool operator==(const Allocator<U>& other) const
+    {
+      return _arena == other._arena;
+    }
+
+    template<typename U>
+    bool operator!=(const Allocator<U>& other) const
+    {
+      return _arena != other._arena;
+    }
+
+  private:
+    template<typename U> friend class Allocator;
+    std::shared_ptr<NegotiationArena> _arena;
+  };
+
+  static std::shared_ptr<NegotiationArena> make();
+
+  /// Create an object whose memory, including its control block, comes from
+  /// this arena. This is safe to call from any thread.
+  template<typename T, typename... Args>
+  std::shared_ptr<T> make_shared(Args&& ... args)
+  {
+    return std::allocate_shared<T>(
+      Allocator<T>(shared_from_this()), std::forward<Args>(args)...);
+  }
+
+  /// Get the number of bytes that are currently handed out by this arena
+  std::size_t bytes_in_use() const;
+
+private:
+
+  NegotiationArena() = default;
+
+  void* _allocate(std::size_t bytes, std::size_t alignment);
+
+  void _deallocate(void* p, std::size_t bytes, std::size_t alignment);
+
+  std::pmr::synchronized_pool_resource _pool;
+  std::atomic_size_t _bytes_in_use{0};
+};
+
+} // namespace services
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__SERVICES__NEGOTIATIONARENA_HPP
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "NegotiationMemo.hpp"
+
+#include <rmf_traffic/DetectConflict.hpp>
+
+#include <rmf_traffic_ros2/TrajectoryCircles.hpp>
+
+#include <algorithm>
+
+namespace rmf_fleet_adapter {
+namespace services {
+
+namespace {
+//==============================================================================
+bool same_trajectory(
+  const rmf_traffic::Trajectory& a,
+  const rmf_traffic::Trajectory& b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  auto it_b = b.begin();
+  for (auto it_a = a.begin(); it_a != a.end(); ++it_a, ++it_b)
+  {
+    if (it_a->time() != it_b->time())
+      return false;
+
+    if (it_a->position() != it_b->position())
+      return false;
+
+    if (it_a->velocity() != it_b->velocity())
+      return false;
+  }
+
+  return true;
+}
+
+//==============================================================================
+bool conflicts_with_proposals(
+  const rmf_traffic::agv::Plan& plan,
+  const rmf_traffic::Profile& profile,
+  const NegotiationMemo::TableViewerPtr& viewer)
+{
+  const auto& itinerary = plan.get_itinerary();
+  std::vector<rmf_traffic_ros2::TrajectoryCircles> circles;
+  circles.reserve(itinerary.size());
+  for (const auto& route : itinerary)
+    circles.emplace_back(route.trajectory(), profile);
+
+  for (const auto& submission : viewer->base_proposals())
+  {
+    const auto description = viewer->get_description(submission.participant);
+    if (!description)
+      return true;
+
+    const auto& other_profile = description->profile();
+    for (const auto& other_route : submission.itinerary)
+    {
+      const rmf_traffic_ros2::TrajectoryCircles other_circles(
+        other_route->trajectory(), other_profile);
+
+      for (std::size_t i = 0; i < itinerary.size(); ++i)
+      {
+        const auto& route = itinerary[i];
+        if (route.map() != other_route->map())
+          continue;
+
+        if (route.trajectory().size() < 2)
+          continue;
+
+        // Most proposals stay far away from this plan, which the bounding
+        // circles of the segments can tell without the full conflict check
+        if (!circles[i].might_conflict(other_circles))
+          continue;
+
+        if (rmf_traffic::DetectConflict::between(
+            profile, route.trajectory(),
+            other_profile, other_route->trajectory()))
+        {
+          return true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+} // anonymous namespace
+
+//==============================================================================
+bool same_proposals(
+  const rmf_traffic::schedule::Negotiation::Proposal& a,
+  const rmf_traffic::schedule::Negotiation::Proposal& b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  // Siblings may list the same submissions in a different order, so match
+  // each submission of a with the submission of b from the same participant.
+  for (const auto& submission_a : a)
+  {
+    const auto it_b = std::find_if(b.begin(), b.end(),
+        [&](const auto& submission_b)
+        {
+          return submission_b.participant == submission_a.participant;
+        });
+
+    if (it_b == b.end())
+      return false;
+
+    const auto& itinerary_a = submission_a.itinerary;
+    const auto& itinerary_b = it_b->itinerary;
+    if (itinerary_a.size() != itinerary_b.size())
+      return false;
+
+    for (std::size_t i = 0; i < itinerary_a.size(); ++i)
+    {
+      const auto& route_a = itinerary_a[i];
+      const auto& route_b = itinerary_b[i];
+
+      // Sibling tables usually share the routes of their common ancestors
+      if (route_a == route_b)
+        continue;
+
+      if (route_a->map() != route_b->map())
+        return false;
+
+      if (!same_trajectory(route_a->trajectory(), route_b->trajectory()))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+//==============================================================================
+NegotiationMemo::NegotiationMemo(
+  const std::size_t capacity,
+  const rmf_traffic::Duration lifetime)
+: _capacity(std::max<std::size_t>(capacity, 1)),
+  _lifetime(lifetime)
+{
+  // Do nothing
+}
+
+//==============================================================================
+void NegotiationMemo::remember(
+  const TableViewerPtr& viewer,
+  const ItineraryVersion version,
+  const rmf_traffic::Time now,
+  rmf_traffic::agv::Plan plan)
+{
+  _forget_expired(version, now);
+
+  const auto& proposals = viewer->base_proposals();
+  const auto it = std::find_if(_entries.begin(), _entries.end(),
+      [&](const Entry& entry)
+      {
+        return same_proposals(entry.proposals, proposals);
+      });
+
+  if (it != _entries.end())
+    _entries.erase(it);
+
+  while (_entries.size() >= _capacity)
+    _entries.pop_front();
+
+  _entries.push_back(Entry{proposals, version, now, std::move(plan)});
+}
+
+//==============================================================================
+std::optional<rmf_traffic::agv::Plan> NegotiationMemo::recall(
+  const TableViewerPtr& viewer,
+  const rmf_traffic::Profile& profile,
+  const ItineraryVersion version,
+  const rmf_traffic::Time now)
+{
+  _forget_expired(version, now);
+
+  // A rejected table is asking for something other than what we offered
+  // before, so it always deserves a fresh search.
+  if (_entries.empty() || viewer->rejected())
+    return std::nullopt;
+
+  const auto& proposals = viewer->base_proposals();
+  for (auto it = _entries.rbegin(); it != _entries.rend(); ++it)
+  {
+    if (!same_proposals(it->proposals, proposals))
+      continue;
+
+    if (conflicts_with_proposals(it->plan, profile, viewer))
+      return std::nullopt;
+
+    return it->plan;
+  }
+
+  return std::nullopt;
+}
+
+//==============================================================================
+void NegotiationMemo::clear()
+{
+  _entries.clear();
+}
+
+//==============================================================================
+std::size_t NegotiationMemo::size() const
+{
+  return _entries.size();
+}
+
+//==============================================================================
+void NegotiationMemo::_forget_expired(
+  const ItineraryVersion version,
+  const rmf_traffic::Time now)
+{
+  // Entries are in the order they were found and itinerary versions only ever
+  // increase, so the expired entries are always at the front.
+  while (!_entries.empty()
+    && (_entries.front().version != version
+    || _entries.front().found_at + _lifetime < now))
+  {
+    _entries.pop_front();
+  }
+}
+
+} // namespace services
+} // namespace rmf_fleet_adapter
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__SERVICES__NEGOTIATIONMEMO_HPP
+#define SRC__RMF_FLEET_ADAPTER__SERVICES__NEGOTIATIONMEMO_HPP
+
+#include <rmf_traffic/agv/Planner.hpp>
+#include <rmf_traffic/schedule/Negotiation.hpp>
+
+#include <deque>
+#include <optional>
+
+namespace rmf_fleet_adapter {
+namespace services {
+
+//==============================================================================
+/// Check whether two proposals hold the same itineraries for the same
+/// participants. The order of the submissions does not matter.
+bool same_proposals(
+  const rmf_traffic::schedule::Negotiation::Proposal& a,
+  const rmf_traffic::schedule::Negotiation::Proposal& b);
+
+//==============================================================================
+/// Remembers the plans that a robot has submitted to negotiation tables so
+/// that they can be offered again to sibling tables. When several participants
+/// negotiate, the robot is asked to respond to many tables whose proposals are
+/// often the same, e.g. because they only differ in the order of participants
+/// that have no bearing on this robot. A plan that was found for one of those
+/// tables is just as good for the others, so there is no need to search again.
+///
+/// A plan is only recalled for a table whose base proposals are identical to
+/// the ones it was found for, while the robot is still following the same
+/// itinerary version, and for a short time after it was found. The plan is
+/// also checked for conflicts against the proposals of the new table before
+/// it is recalled.
+///
+/// This is not thread-safe. It is meant to be used from the worker of the
+/// robot.
+class NegotiationMemo
+{
+public:
+
+  using TableViewerPtr = rmf_traffic::schedule::Negotiation::Table::ViewerPtr;
+  using ItineraryVersion = rmf_traffic::schedule::ItineraryVersion;
+
+  /// Constructor
+  ///
+  /// \param[in] capacity
+  ///   The most plans to remember at once. The oldest plan is forgotten when
+  ///   a new one would exceed this.
+  ///
+  /// \param[in] lifetime
+  ///   How long after it was found a plan may still be recalled. The robot
+  ///   keeps moving while it negotiates, so older plans start from a position
+  ///   that it has already left.
+  NegotiationMemo(
+    std::size_t capacity = 16,
+    rmf_traffic::Duration lifetime = std::chrono::seconds(3));
+
+  /// Remember the plan that was found for a table.
+  ///
+  /// \param[in] viewer
+  ///   The viewer of the table that the plan was found for
+  ///
+  /// \param[in] version
+  ///   The itinerary version of the robot when the search for the plan began
+  ///
+  /// \param[in] now
+  ///   The current time
+  ///
+  /// \param[in] plan
+  ///   The plan that was found
+  void remember(
+    const TableViewerPtr& viewer,
+    ItineraryVersion version,
+    rmf_traffic::Time now,
+    rmf_traffic::agv::Plan plan);
+
+  /// Find a plan that can be submitted to a table without searching.
+  ///
+  /// \param[in] viewer
+  ///   The viewer of the table that needs a response
+  ///
+  /// \param[in] profile
+  ///   The profile of the robot
+  ///
+  /// \param[in] version
+  ///   The current itinerary version of the robot
+  ///
+  /// \param[in] now
+  ///   The current time
+  ///
+  /// \return a plan if one was remembered for an identical table and it does
+  /// not conflict with the proposals of this table, otherwise std::nullopt.
+  std::optional<rmf_traffic::agv::Plan> recall(
+    const TableViewerPtr& viewer,
+    const rmf_traffic::Profile& profile,
+    ItineraryVersion version,
+    rmf_traffic::Time now);
+
+  /// Forget all the plans, e.g. because the goal of the robot has changed.
+  void clear();
+
+  /// Get the number of plans that are being remembered.
+  std::size_t size() const;
+
+private:
+
+  struct Entry
+  {
+    rmf_traffic::schedule::Negotiation::Proposal proposals;
+    ItineraryVersion version;
+    rmf_traffic::Time found_at;
+    rmf_traffic::agv::Plan plan;
+  };
+
+  void _forget_expired(ItineraryVersion version, rmf_traffic::Time now);
+
+  std::size_t _capacity;
+  rmf_traffic::Duration _lifetime;
+  std::deque<Entry> _entries;
+};
+
+} // namespace services
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__SERVICES__NEGOTIATIONMEMO_HPP
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "PulloverCandidates.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace rmf_fleet_adapter {
+namespace services {
+
+//==============================================================================
+PulloverCandidates::PulloverCandidates(std::size_t max_candidates)
+: _max_candidates(std::max<std::size_t>(max_candidates, 1))
+{
+  // Do nothing
+}
+
+//==============================================================================
+void PulloverCandidates::update(
+  const std::shared_ptr<const rmf_traffic::agv::Planner>& planner)
+{
+  auto ranking = _rank(planner);
+  std::lock_guard<std::mutex> lock(_mutex);
+  _ranking = std::move(ranking);
+}
+
+//==============================================================================
+std::vector<std::size_t> PulloverCandidates::candidates(
+  const std::shared_ptr<const rmf_traffic::agv::Planner>& planner,
+  const rmf_traffic::agv::Plan::StartSet& starts)
+{
+  std::shared_ptr<const Ranking> ranking;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ranking = _ranking;
+  }
+
+  if (!ranking || ranking->planner.lock() != planner)
+  {
+    ranking = _rank(planner);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _ranking = ranking;
+  }
+
+  const auto& graph = planner->get_configuration().graph();
+  std::unordered_map<std::size_t, double> nearest;
+  for (const auto& start : starts)
+  {
+    const std::size_t wp = start.waypoint();
+    if (wp >= ranking->waypoints.size())
+      continue;
+
+    double offset = 0.0;
+    if (const auto location = start.location())
+      offset = (*location - graph.get_waypoint(wp).get_location()).norm();
+
+    for (const auto& c : ranking->waypoints[wp])
+    {
+      const double distance = offset + c.distance;
+      const auto insertion = nearest.insert({c.parking_spot, distance});
+      if (!insertion.second && distance < insertion.first->second)
+        insertion.first->second = distance;
+    }
+  }
+
+  std::vector<Candidate> merged;
+  merged.reserve(nearest.size());
+  for (const auto& [spot, distance] : nearest)
+    merged.push_back({distance, spot});
+
+  _sort_and_trim(merged);
+
+  std::vector<std::size_t> output;
+  output.reserve(merged.size());
+  for (const auto& c : merged)
+    output.push_back(c.parking_spot);
+
+  return output;
+}
+
+//==============================================================================
+std::size_t PulloverCandidates::max_candidates() const
+{
+  return _max_candidates;
+}
+
+//==============================================================================
+auto PulloverCandidates::_rank(
+  const std::shared_ptr<const rmf_traffic::agv::Planner>& planner) const
+-> std::shared_ptr<const Ranking>
+{
+  const auto& config = planner->get_configuration();
+  const auto& graph = config.graph();
+  const auto& closures = config.lane_closures();
+  const std::size_t N = graph.num_waypoints();
+
+  // We search outwards from each parking spot, so we need to know which lanes
+  // lead into each waypoint.
+  std::vector<std::vector<std::pair<std::size_t, double>>> incoming(N);
+  for (std::size_t i = 0; i < graph.num_lanes(); ++i)
+  {
+    if (closures.is_closed(i))
+      continue;
+
+    const auto& lane = graph.get_lane(i);
+    const std::size_t entry = lane.entry().waypoint_index();
+    const std::size_t exit = lane.exit().waypoint_index();
+    const double length = (graph.get_waypoint(exit).get_location()
+      - graph.get_waypoint(entry).get_location()).norm();
+    incoming[exit].push_back({entry, length});
+  }
+
+  auto ranking = std::make_shared<Ranking>();
+  ranking->planner = planner;
+  ranking->waypoints.resize(N);
+
+  using QueueEntry = std::pair<double, std::size_t>;
+  constexpr double inf = std::numeric_limits<double>::infinity();
+  std::vector<double> distance(N);
+  for (std::size_t spot = 0; spot < N; ++spot)
+  {
+    if (!graph.get_waypoint(spot).is_parking_spot())
+      continue;
+
+    std::fill(distance.begin(), distance.end(), inf);
+
+    std::priority_queue<
+      QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    distance[spot] = 0.0;
+    queue.push({0.0, spot});
+    while (!queue.empty())
+    {
+      const auto [d, wp] = queue.top();
+      queue.pop();
+      if (d > distance[wp])
+        continue;
+
+      for (const auto& [from, length] : incoming[wp])
+      {
+        const double next = d + length;
+        if (next < distance[from])
+        {
+          distance[from] = next;
+          queue.push({next, from});
+        }
+      }
+    }
+
+    for (std::size_t wp = 0; wp < N; ++wp)
+    {
+      if (distance[wp] == inf)
+        continue;
+
+      auto& candidates = ranking->waypoints[wp];
+      candidates.push_back({distance[wp], spot});
+
+      // Trim occasionally so that a graph with many parking spots does not
+      // hold on to a candidate for every one of them.
+      if (candidates.size() >= 2*_max_candidates)
+        _sort_and_trim(candidates);
+    }
+  }
+
+  for (auto& candidates : ranking->waypoints)
+    _sort_and_trim(candidates);
+
+  return ranking;
+}
+
+//==============================================================================
+void PulloverCandidates::_sort_and_trim(
+  std::vector<Candidate>& candidates) const
+{
+  std::sort(candidates.begin(), candidates.end(),
+    [](const Candidate& a, const Candidate& b)
+    {
+      if (a.distance == b.distance)
+        return a.parking_spot < b.parking_spot;
+      return a.distance < b.distance;
+    });
+
+  if (candidates.size() > _max_candidates)
+    candidates.resize(_max_candidates);
+}
+
+} // namespace services
+} // namespace rmf_fleet_adapter
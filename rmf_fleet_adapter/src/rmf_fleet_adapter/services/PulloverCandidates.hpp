@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_FLEET_ADAPTER__SERVICES__PULLOVERCANDIDATES_HPP
+#define SRC__RMF_FLEET_ADAPTER__SERVICES__PULLOVERCANDIDATES_HPP
+
+#include <rmf_traffic/agv/Planner.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rmf_fleet_adapter {
+namespace services {
+
+//==============================================================================
+/// Ranks the parking spots of a navigation graph by how far a robot would need
+/// to travel to reach them from each waypoint. This is computed ahead of time
+/// so that an emergency pullover only needs to search for paths to a handful
+/// of nearby parking spots instead of every parking spot in the graph, which
+/// matters when every robot of a fleet begins searching at the same moment.
+///
+/// The ranking only considers the lengths of the lanes and respects the lane
+/// closures of the planner that it was computed for. It is recomputed whenever
+/// it is queried with a different planner, but the fleet should call update()
+/// as soon as its planner changes so that this does not happen during an
+/// emergency.
+class PulloverCandidates
+{
+public:
+
+  static constexpr std::size_t DefaultMaxCandidates = 5;
+
+  PulloverCandidates(std::size_t max_candidates = DefaultMaxCandidates);
+
+  /// Rank the parking spots of the planner's graph.
+  void update(const std::shared_ptr<const rmf_traffic::agv::Planner>& planner);
+
+  /// Get the parking spots that are worth considering for a robot at the
+  /// given starts, in order of increasing travel distance. This will be empty
+  /// if no parking spot can be reached from any of the starts.
+  std::vector<std::size_t> candidates(
+    const std::shared_ptr<const rmf_traffic::agv::Planner>& planner,
+    const rmf_traffic::agv::Plan::StartSet& starts);
+
+  std::size_t max_candidates() const;
+
+private:
+
+  struct Candidate
+  {
+    double distance;
+    std::size_t parking_spot;
+  };
+
+  struct Ranking
+  {
+    std::weak_ptr<const rmf_traffic::agv::Planner> planner;
+
+    /// The nearest parking spots from each waypoint, nearest first
+    std::vector<std::vector<Candidate>> waypoints;
+  };
+
+  std::shared_ptr<const Ranking> _rank(
+    const std::shared_ptr<const rmf_traffic::agv::Planner>& planner) const;
+
+  void _sort_and_trim(std::vector<Candidate>& candidates) const;
+
+  std::size_t _max_candidates;
+  std::shared_ptr<const Ranking> _ranking;
+  mutable std::mutex _mutex;
+};
+
+} // namespace services
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__SERVICES__PULLOVERCANDIDATES_HPP
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "RolloutCache.hpp"
+#include "NegotiationMemo.hpp"
+
+#include <algorithm>
+
+namespace rmf_fleet_adapter {
+namespace services {
+
+namespace {
+//==============================================================================
+rmf_traffic::schedule::Negotiation::Proposal proposals_without(
+  const rmf_traffic::schedule::Negotiation::Proposal& proposals,
+  const rmf_traffic::schedule::ParticipantId blocker)
+{
+  rmf_traffic::schedule::Negotiation::Proposal others;
+  others.reserve(proposals.size());
+  for (const auto& submission : proposals)
+  {
+    if (submission.participant != blocker)
+      others.push_back(submission);
+  }
+
+  return others;
+}
+} // anonymous namespace
+
+//==============================================================================
+RolloutCache::RolloutCache(
+  const std::size_t capacity,
+  const Clock::duration lifetime)
+: _capacity(std::max<std::size_t>(capacity, 1)),
+  _lifetime(lifetime)
+{
+  // Do nothing
+}
+
+//==============================================================================
+void RolloutCache::itinerary_version(const ItineraryVersion version)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_version == version)
+    return;
+
+  _version = version;
+  for (const auto& entry : _entries)
+    entry->shareable = false;
+
+  _forget_expired(Clock::now());
+}
+
+//==============================================================================
+bool RolloutCache::request(
+  const TableViewerPtr& viewer,
+  rmf_traffic::agv::Planner::Result source,
+  const rmf_traffic::Duration span,
+  const std::optional<std::size_t> max_rollouts,
+  const std::optional<rmf_traffic::Duration> budget,
+  std::function<bool()> interested,
+  Callback callback)
+{
+  const auto parent = viewer->parent_id();
+  if (!parent)
+  {
+    throw std::runtime_error(
+            "[RolloutCache::request] The table has no parent to roll out "
+            "alternatives for");
+  }
+
+  const auto blocker = *parent;
+  auto proposals = proposals_without(viewer->base_proposals(), blocker);
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _forget_expired(Clock::now());
+
+  const auto it = std::find_if(_entries.begin(), _entries.end(),
+      [&](const EntryPtr& entry)
+      {
+        return entry->shareable && !entry->abandoned
+        && entry->blocker == blocker
+        && entry->span == span
+        && same_proposals(entry->proposals, proposals);
+      });
+
+  if (it != _entries.end())
+  {
+    const auto entry = *it;
+    if (entry->alternatives)
+    {
+      const auto alternatives = *entry->alternatives;
+      lock.unlock();
+      callback(alternatives);
+      return false;
+    }
+
+    entry->waiters.push_back(
+      Waiter{std::move(interested), std::move(callback)});
+    return false;
+  }
+
+  auto entry = std::make_shared<Entry>();
+  entry->blocker = blocker;
+  entry->span = span;
+  entry->proposals = std::move(proposals);
+  entry->waiters.push_back(Waiter{std::move(interested), std::move(callback)});
+
+  // The expansion belongs to every table that waits for it, so it must not be
+  // stopped by the interrupter of the table that happened to start it.
+  source.options().interrupter(
+    [w = weak_from_this(), e = std::weak_ptr<Entry>(entry)]() -> bool
+    {
+      const auto self = w.lock();
+      const auto entry = e.lock();
+      if (!self || !entry)
+        return true;
+
+      return !self->_still_wanted(entry);
+    });
+
+  const auto job = std::make_shared<jobs::Rollout>(
+    std::move(source), blocker, span, max_rollouts, budget);
+
+  _entries.push_back(entry);
+  lock.unlock();
+
+  // The subscription is given to the entry afterwards because the job may
+  // finish on another thread before make_job returns.
+  auto subscription = rmf_rxcpp::make_job<jobs::Rollout::Result>(
+    job, rmf_rxcpp::PlanningPriority::Low)
+    .observe_on(rxcpp::observe_on_event_loop())
+    .subscribe(
+    [w = weak_from_this(), e = std::weak_ptr<Entry>(entry)](
+      const jobs::Rollout::Result& result)
+    {
+      const auto self = w.lock();
+      const auto entry = e.lock();
+      if (self && entry)
+        self->_finish(entry, result);
+    });
+
+  lock.lock();
+  if (!entry->alternatives)
+    entry->subscription = std::move(subscription);
+
+  return true;
+}
+
+//==============================================================================
+void RolloutCache::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (const auto& entry : _entries)
+    entry->shareable = false;
+
+  _forget_expired(Clock::now());
+}
+
+//==============================================================================
+std::size_t RolloutCache::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _entries.size();
+}
+
+//==============================================================================
+bool RolloutCache::_still_wanted(const EntryPtr& entry)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (entry->abandoned)
+    return false;
+
+  for (const auto& waiter : entry->waiters)
+  {
+    if (!waiter.interested || waiter.interested())
+      return true;
+  }
+
+  entry->abandoned = true;
+  return false;
+}
+
+//==============================================================================
+void RolloutCache::_finish(
+  const EntryPtr& entry,
+  const jobs::Rollout::Result& result)
+{
+  std::vector<Waiter> waiters;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (entry->alternatives)
+      return;
+
+    entry->alternatives = result.alternatives;
+    entry->finished_at = Clock::now();
+    waiters = std::move(entry->waiters);
+    entry->waiters.clear();
+
+    // Running out of budget still leaves us with the best alternatives that
+    // we are willing to look for, but an abandoned expansion may have been
+    // stopped before it found anything.
+    if (entry->abandoned)
+      entry->shareable = false;
+
+    _forget_expired(*entry->finished_at);
+  }
+
+  for (const auto& waiter : waiters)
+    waiter.callback(result.alternatives);
+}
+
+//==============================================================================
+void RolloutCache::_forget_expired(const Clock::time_point now)
+{
+  // Expansions that are still running are never forgotten, otherwise the
+  // tables that are waiting for them would never hear back.
+  const auto forgettable = [&](const EntryPtr& entry)
+    {
+      if (!entry->alternatives)
+        return false;
+
+      return !entry->shareable || *entry->finished_at + _lifetime < now;
+    };
+
+  _entries.erase(
+    std::remove_if(_entries.begin(), _entries.end(), forgettable),
+    _entries.end());
+
+  auto it = _entries.begin();
+  while (_entries.size() > _capacity && it != _entries.end())
+  {
+    if ((*it)->alternatives)
+      it = _entries.erase(it);
+    else
+      ++it;
+  }
+}
+
+} // namespace services
+} // namespace rmf_fleet_adapter
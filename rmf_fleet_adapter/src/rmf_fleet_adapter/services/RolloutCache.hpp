@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_FLEET_ADAPTER__SERVICES__ROLLOUTCACHE_HPP
+#define SRC__RMF_FLEET_ADAPTER__SERVICES__ROLLOUTCACHE_HPP
+
+#include "../jobs/Rollout.hpp"
+
+#include <rmf_rxcpp/RxJobs.hpp>
+#include <rmf_traffic/agv/Planner.hpp>
+#include <rmf_traffic/schedule/Negotiation.hpp>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace rmf_fleet_adapter {
+namespace services {
+
+//==============================================================================
+/// Shares the alternatives of rollouts between the tables of a negotiation.
+/// When a robot is blocked by the parent of a table, it expands a rollout to
+/// offer the parent some alternatives with its rejection. The parent is masked
+/// out during that expansion, so every table where the robot is blocked by the
+/// same parent and faces the same proposals from everyone else needs exactly
+/// the same alternatives. Rollouts are among the most expensive parts of a
+/// deep negotiation, so only the first of those tables expands one, and the
+/// rest wait for its alternatives.
+///
+/// Alternatives are only shared while the robot is following the same
+/// itinerary version, and for a short time after they were found. An
+/// expansion is interrupted once nobody is waiting for it anymore, and the
+/// alternatives of an interrupted expansion are never shared with later
+/// tables.
+///
+/// This is thread-safe. Rollouts finish on the event loop while new tables
+/// arrive from the worker of the robot.
+class RolloutCache : public std::enable_shared_from_this<RolloutCache>
+{
+public:
+
+  using TableViewerPtr = rmf_traffic::schedule::Negotiation::Table::ViewerPtr;
+  using ItineraryVersion = rmf_traffic::schedule::ItineraryVersion;
+  using Alternatives = std::vector<rmf_traffic::schedule::Itinerary>;
+  using Callback = std::function<void(const Alternatives&)>;
+  using Clock = std::chrono::steady_clock;
+
+  /// Constructor
+  ///
+  /// \param[in] capacity
+  ///   The most finished rollouts to keep at once. The oldest one is forgotten
+  ///   when a new one would exceed this.
+  ///
+  /// \param[in] lifetime
+  ///   How long after it finished a rollout may still be shared. The robot
+  ///   keeps moving while it negotiates, so older alternatives start from a
+  ///   position that it has already left.
+  RolloutCache(
+    std::size_t capacity = 16,
+    Clock::duration lifetime = std::chrono::seconds(3));
+
+  /// Tell the cache which itinerary version the robot is following. Rollouts
+  /// that were expanded for any other version will not be shared anymore.
+  void itinerary_version(ItineraryVersion version);
+
+  /// Ask for the alternatives of a rollout for a table whose parent blocks
+  /// the robot. If an identical rollout has already finished, the callback is
+  /// triggered before this function returns. If one is being expanded, the
+  /// callback is triggered when it finishes. Otherwise a new expansion is
+  /// started.
+  ///
+  /// \param[in] viewer
+  ///   The viewer of the table that needs the alternatives. Its parent is the
+  ///   blocker of the rollout.
+  ///
+  /// \param[in] source
+  ///   The planning result to expand, with the parent already masked out of
+  ///   its validator. This is only used if a new expansion is needed.
+  ///
+  /// \param[in] span
+  ///   The span of the rollout
+  ///
+  /// \param[in] max_rollouts
+  ///   The most alternatives that a new expansion may produce
+  ///
+  /// \param[in] budget
+  ///   The most wall-clock time that a new expansion may take
+  ///
+  /// \param[in] interested
+  ///   Returns false once the caller no longer needs the alternatives
+  ///
+  /// \param[in] callback
+  ///   Triggered with the alternatives
+  ///
+  /// \return true if a new expansion was started for this request.
+  bool request(
+    const TableViewerPtr& viewer,
+    rmf_traffic::agv::Planner::Result source,
+    rmf_traffic::Duration span,
+    std::optional<std::size_t> max_rollouts,
+    std::optional<rmf_traffic::Duration> budget,
+    std::function<bool()> interested,
+    Callback callback);
+
+  /// Forget all the rollouts, e.g. because the goal of the robot has changed.
+  /// Expansions that are still running will still reach the tables that are
+  /// waiting for them.
+  void clear();
+
+  /// Get the number of rollouts that are being kept, including the ones that
+  /// are still being expanded.
+  std::size_t size() const;
+
+private:
+
+  struct Waiter
+  {
+    std::function<bool()> interested;
+    Callback callback;
+  };
+
+  struct Entry
+  {
+    rmf_traffic::schedule::ParticipantId blocker;
+    rmf_traffic::Duration span;
+    rmf_traffic::schedule::Negotiation::Proposal proposals;
+    bool shareable = true;
+    bool abandoned = false;
+    std::optional<Alternatives> alternatives;
+    std::optional<Clock::time_point> finished_at;
+    std::vector<Waiter> waiters;
+    rmf_rxcpp::subscription_guard subscription;
+  };
+
+  using EntryPtr = std::shared_ptr<Entry>;
+
+  bool _still_wanted(const EntryPtr& entry);
+
+  void _finish(const EntryPtr& entry, const jobs::Rollout::Result& result);
+
+  void _forget_expired(Clock::time_point now);
+
+  std::size_t _capacity;
+  Clock::duration _lifetime;
+  ItineraryVersion _version = 0;
+  mutable std::mutex _mutex;
+  std::deque<EntryPtr> _entries;
+};
+
+} // namespace services
+} // namespace rmf_fleet_adapter
+
+#endif // SRC__RMF_FLEET_ADAPTER__SERVICES__ROLLOUTCACHE_HPP
@@ -38,25 +38,42 @@ void Negotiate::operator()(const Subscriber& s)
     rmf_traffic::agv::NegotiatingRouteValidator::Generator(_viewer).all();
 
   _queued_jobs.reserve(validators.size() * _goals.size());
+  _current_jobs.reserve(_max_concurrent_jobs);
+  {
+    // Give the resume queue all the room it can ever need up front so it does
+    // not grow while the jobs are being evaluated.
+    std::vector<JobPtr> resume_storage;
+    resume_storage.reserve(_queued_jobs.capacity());
+    _resume_jobs = decltype(_resume_jobs)(
+      CompareJobs(), std::move(resume_storage));
+  }
 
   auto interrupter = [
-    service_interrupted = _interrupted, viewer = _viewer]() -> bool
+    service_interrupted = _interrupted, viewer = _viewer,
+    cancelled = _cancelled]() -> bool
     {
-      return *service_interrupted || viewer->defunct();
+      return *service_interrupted || viewer->defunct()
+        || (cancelled && *cancelled);
     };
 
   for (const auto& goal : _goals)
   {
     for (const auto& validator : validators)
     {
-      auto job = std::make_shared<jobs::Planning>(
-        _planner, _starts, goal,
-        rmf_traffic::agv::Plan::Options(validator)
-        .interrupter(interrupter));
+      auto options = rmf_traffic::agv::Plan::Options(validator)
+        .interrupter(interrupter);
+
+      auto job = _arena ?
+        _arena->make_shared<jobs::Planning>(
+        _planner, _starts, goal, std::move(options)) :
+        std::make_shared<jobs::Planning>(
+        _planner, _starts, goal, std::move(options));
 
       _evaluator.initialize(job->progress());
 
       _queued_jobs.emplace_back(std::move(job));
+      if (_statistics)
+        ++_statistics->planning_jobs;
     }
   }
 
@@ -115,7 +132,8 @@ void Negotiate::operator()(const Subscriber& s)
 
                     return rmf_utils::nullopt;
                   });
-              }
+              },
+              **_evaluator.best_result.progress
             });
 
           s.on_completed();
@@ -190,6 +208,9 @@ void Negotiate::operator()(const Subscriber& s)
         return;
       }
 
+      if (n->_statistics)
+        ++n->_statistics->planning_steps;
+
       bool resume = false;
       if (n->_evaluator.evaluate(result.job.progress()))
       {
@@ -204,16 +225,60 @@ void Negotiate::operator()(const Subscriber& s)
           if (p == parent_id)
           {
             n->_attempting_rollout = true;
+
             auto rollout_source = result.job.progress();
             static_cast<rmf_traffic::agv::NegotiatingRouteValidator*>(
               rollout_source.options().validator().get())->mask(parent_id);
 
+            const auto span = std::chrono::seconds(15);
+            const std::size_t max_rollouts = 200;
+            const auto budget = std::chrono::seconds(2);
+
+            if (n->_rollout_cache)
+            {
+              // Other tables where the parent blocks us may already be
+              // expanding the same rollout, in which case we wait for theirs.
+              const bool started = n->_rollout_cache->request(
+                n->_viewer, std::move(rollout_source), span, max_rollouts,
+                budget,
+                [w = n->weak_from_this()]() -> bool
+                {
+                  const auto n = w.lock();
+                  return n && !n->_finished && !n->discarded();
+                },
+                [w = n->weak_from_this(), check_if_finished](
+                  const RolloutCache::Alternatives& alternatives)
+                {
+                  const auto n = w.lock();
+                  if (!n)
+                    return;
+
+                  n->_alternatives = alternatives;
+                  n->_attempting_rollout = false;
+                  check_if_finished();
+                });
+
+              if (n->_statistics)
+              {
+                if (started)
+                  ++n->_statistics->rollouts;
+                else
+                  ++n->_statistics->shared_rollouts;
+              }
+
+              break;
+            }
+
+            if (n->_statistics)
+              ++n->_statistics->rollouts;
+
             n->_rollout_job = std::make_shared<jobs::Rollout>(
-              std::move(rollout_source), parent_id,
-              std::chrono::seconds(15), 200);
+              std::move(rollout_source), parent_id, span, max_rollouts,
+              budget);
 
             n->_rollout_sub =
-            rmf_rxcpp::make_job<jobs::Rollout::Result>(n->_rollout_job)
+            rmf_rxcpp::make_job<jobs::Rollout::Result>(
+              n->_rollout_job, rmf_rxcpp::PlanningPriority::Low)
             .observe_on(rxcpp::observe_on_event_loop())
             .subscribe(
               [n, check_if_finished](const jobs::Rollout::Result& result)
@@ -231,7 +296,8 @@ void Negotiate::operator()(const Subscriber& s)
         const auto job = result.job.shared_from_this();
         if (resume)
         {
-          if (n->_current_jobs.find(job) != n->_current_jobs.end())
+          if (std::find(n->_current_jobs.begin(), n->_current_jobs.end(), job)
+            != n->_current_jobs.end())
           {
             job->resume();
           }
@@ -255,10 +321,13 @@ void Negotiate::operator()(const Subscriber& s)
             n->_queued_jobs.erase(job_it);
           }
 
-          n->_current_jobs.erase(job);
+          const auto current_it = std::find(
+            n->_current_jobs.begin(), n->_current_jobs.end(), job);
+          if (current_it != n->_current_jobs.end())
+            n->_current_jobs.erase(current_it);
         }
 
-        while (n->_current_jobs.size() < max_concurrent_jobs
+        while (n->_current_jobs.size() < n->_max_concurrent_jobs
         && !n->_resume_jobs.empty())
         {
           n->_resume_next();
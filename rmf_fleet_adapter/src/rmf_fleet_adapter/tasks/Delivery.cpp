@@ -59,7 +59,8 @@ std::shared_ptr<Task> make_delivery(
       request->id(),
       delivery_profile.pickup_dispenser,
       context->itinerary().description().owner(),
-      delivery_profile.items));
+      delivery_profile.items,
+      pickup_waypoint));
 
   const auto dropoff_start = [&]() -> rmf_traffic::agv::Planner::Start
     {
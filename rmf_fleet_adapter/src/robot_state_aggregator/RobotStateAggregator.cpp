@@ -23,6 +23,11 @@
 
 #include <rmf_fleet_adapter/StandardNames.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
 #ifdef FAILOVER_MODE
 #include "stubborn_buddies_msgs/msg/status.hpp"
 #endif
@@ -112,6 +117,22 @@ public:
 
     this->_prefix = std::move(prefix);
     this->_fleet_name = std::move(fleet_name);
+    _fleet_state.name = _fleet_name;
+
+    // With a flush period, the fleet state is published at most once per
+    // period, or as soon as every robot has reported, instead of once for
+    // every robot state that arrives.
+    const double flush_period = this->declare_parameter("flush_period", 0.0);
+    if (flush_period > 0.0)
+    {
+      _flush_timer = create_wall_timer(
+        std::chrono::duration<double>(flush_period),
+        [this]()
+        {
+          if (_num_reported > 0)
+            _flush();
+        });
+    }
   }
 
 private:
@@ -126,10 +147,18 @@ private:
   std::string _namespace;
 #endif
 
-  std::unordered_map<std::string, std::unique_ptr<RobotState>> _latest_states;
+  // The fleet state is kept in one message that gets updated in place. Each
+  // robot has a slot in its robots field.
+  FleetState _fleet_state;
+  std::unordered_map<std::string, std::size_t> _slots;
+
+  // Which robots have reported since the last flush
+  std::vector<bool> _reported;
+  std::size_t _num_reported = 0;
 
   rclcpp::Publisher<FleetState>::SharedPtr _fleet_state_pub;
   rclcpp::Subscription<RobotState>::SharedPtr _robot_state_sub;
+  rclcpp::TimerBase::SharedPtr _flush_timer;
 
 #ifdef FAILOVER_MODE
   rclcpp::Subscription<stubborn_buddies_msgs::msg::Status>::SharedPtr
@@ -145,32 +174,41 @@ private:
     if (name.substr(0, _prefix.size()) != _prefix)
       return;
 
-    const auto insertion = _latest_states.insert(std::make_pair(name, nullptr));
-    const auto it = insertion.first;
-    bool updated = false;
+    const auto insertion =
+      _slots.insert(std::make_pair(name, _fleet_state.robots.size()));
+    const std::size_t slot = insertion.first->second;
     if (insertion.second)
     {
-      it->second = std::move(msg);
-      updated = true;
+      _fleet_state.robots.emplace_back(std::move(*msg));
+      _reported.push_back(false);
     }
     else
     {
-      if (rclcpp::Time(it->second->location.t) < rclcpp::Time(msg->location.t) )
-      {
-        it->second = std::move(msg);
-        updated = true;
-      }
+      auto& latest = _fleet_state.robots[slot];
+      if (rclcpp::Time(msg->location.t) <= rclcpp::Time(latest.location.t))
+        return;
+
+      latest = std::move(*msg);
     }
 
-    if (updated)
-    {
-      FleetState fleet;
-      fleet.name = _fleet_name;
-      for (const auto& robot_state : _latest_states)
-        fleet.robots.emplace_back(*robot_state.second);
+    if (!_flush_timer)
+      return _fleet_state_pub->publish(_fleet_state);
 
-      _fleet_state_pub->publish(fleet);
+    if (!_reported[slot])
+    {
+      _reported[slot] = true;
+      ++_num_reported;
     }
+
+    if (_num_reported == _reported.size())
+      _flush();
+  }
+
+  void _flush()
+  {
+    _fleet_state_pub->publish(_fleet_state);
+    std::fill(_reported.begin(), _reported.end(), false);
+    _num_reported = 0;
   }
 
 };
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__TASK_AGGREGATOR__TASKAGGREGATOR_HPP
+#define SRC__TASK_AGGREGATOR__TASKAGGREGATOR_HPP
+
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp/callback_group.hpp>
+
+#include <rmf_fleet_adapter/StandardNames.hpp>
+
+#include <rmf_task_msgs/msg/tasks.hpp>
+#include <rmf_task_msgs/msg/task_summary.hpp>
+#include <rmf_task_msgs/srv/get_task_list.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+//==============================================================================
+class TaskAggregator : public rclcpp::Node
+{
+
+  using TaskSummary = rmf_task_msgs::msg::TaskSummary;
+  using Tasks = rmf_task_msgs::msg::Tasks;
+  using GetTaskList = rmf_task_msgs::srv::GetTaskList;
+
+public:
+
+  struct Options
+  {
+    /// The most tasks that have finished to keep track of
+    std::size_t max_terminal_tasks = 1000;
+
+    /// How long to keep track of a task after it has finished. A nullopt will
+    /// keep them until there are more than max_terminal_tasks.
+    std::optional<std::chrono::steady_clock::duration> max_terminal_age =
+      std::chrono::hours(1);
+
+    /// Only publish the tasks that changed since the last publication. Late
+    /// joiners can use the get_tasks service to get all the tasks.
+    bool delta = false;
+  };
+
+  TaskAggregator(
+    std::string node_name,
+    std::string input_topic,
+    double rate,
+    Options options)
+  : Node(node_name),
+    _rate(rate),
+    _options(options)
+  {
+    _initialize(input_topic);
+  }
+
+  /// Constructor for loading the aggregator as a component. The settings that
+  /// the executable takes as command line arguments are read from parameters
+  /// instead.
+  explicit TaskAggregator(const rclcpp::NodeOptions& node_options)
+  : Node("task_aggregator", node_options)
+  {
+    const auto input_topic = this->declare_parameter<std::string>(
+      "input_topic", rmf_fleet_adapter::TaskSummaryTopicName);
+
+    _rate = this->declare_parameter<double>("rate", 1.0);
+
+    _options.max_terminal_tasks = static_cast<std::size_t>(
+      this->declare_parameter<int64_t>(
+        "max_terminal_tasks",
+        static_cast<int64_t>(_options.max_terminal_tasks)));
+
+    // A non-positive age keeps finished tasks until there are too many
+    const double age = this->declare_parameter<double>(
+      "max_terminal_age", 3600.0);
+    if (age > 0.0)
+    {
+      _options.max_terminal_age =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(age));
+    }
+    else
+    {
+      _options.max_terminal_age = std::nullopt;
+    }
+
+    _options.delta = this->declare_parameter<bool>("delta", false);
+
+    _initialize(input_topic);
+  }
+
+private:
+
+  void _initialize(const std::string& input_topic)
+  {
+    // Create a wall timer to periodically publish Tasks msg
+    const double period = 1.0/_rate;
+    auto timer_period = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double, std::ratio<1>>(period));
+    _timer = this->create_wall_timer(
+      timer_period, std::bind(&TaskAggregator::timer_callback, this));
+
+    // Create publisher for Tasks msg
+    _tasks_pub = this->create_publisher<Tasks>(
+      "/tasks",
+      rclcpp::ServicesQoS());
+
+    // Create subscription to receive TaskSummary msgs from fleet adapters
+    _cb_group_task_summary = this->create_callback_group(
+      rclcpp::CallbackGroupType::MutuallyExclusive);
+    auto sub_map_opt = rclcpp::SubscriptionOptions();
+    sub_map_opt.callback_group = _cb_group_task_summary;
+    auto qos_profile = rclcpp::QoS(10);
+    _task_summary_sub = this->create_subscription<TaskSummary>(
+      input_topic,
+      qos_profile,
+      std::bind(
+        &TaskAggregator::task_summary_cb,
+        this,
+        std::placeholders::_1),
+      sub_map_opt);
+
+    // Let late joiners get every task that is being tracked
+    _get_tasks_srv = this->create_service<GetTaskList>(
+      "~/get_tasks",
+      [this](
+        const std::shared_ptr<GetTaskList::Request> request,
+        std::shared_ptr<GetTaskList::Response> response)
+      {
+        get_tasks_cb(*request, *response);
+      });
+
+    RCLCPP_INFO(
+      get_logger(),
+      "Listening for Task Summaries on topic /%s",
+      input_topic.c_str());
+  }
+
+  struct Entry
+  {
+    TaskSummary summary;
+    std::chrono::steady_clock::time_point updated;
+  };
+
+  static bool is_terminal(const TaskSummary& summary)
+  {
+    return summary.state == summary.STATE_COMPLETED
+      || summary.state == summary.STATE_FAILED
+      || summary.state == summary.STATE_CANCELED;
+  }
+
+  void timer_callback()
+  {
+    prune();
+
+    Tasks tasks;
+    if (_options.delta)
+    {
+      if (_changed.empty())
+        return;
+
+      tasks.tasks.reserve(_changed.size());
+      for (const auto& id : _changed)
+      {
+        const auto it = _db.find(id);
+        if (it != _db.end())
+          tasks.tasks.push_back(it->second.summary);
+      }
+    }
+    else
+    {
+      tasks.tasks.reserve(_db.size());
+      for (const auto& t : _db)
+        tasks.tasks.push_back(t.second.summary);
+    }
+
+    _changed.clear();
+    _tasks_pub->publish(tasks);
+  }
+
+  void task_summary_cb(TaskSummary::UniquePtr msg)
+  {
+    _changed.insert(msg->task_id);
+    auto& entry = _db[msg->task_id];
+    entry.summary = std::move(*msg);
+    entry.updated = std::chrono::steady_clock::now();
+  }
+
+  void get_tasks_cb(
+    const GetTaskList::Request& request,
+    GetTaskList::Response& response)
+  {
+    const auto add = [&](const TaskSummary& summary)
+      {
+        if (is_terminal(summary))
+          response.terminated_tasks.push_back(summary);
+        else
+          response.active_tasks.push_back(summary);
+      };
+
+    if (request.task_id.empty())
+    {
+      for (const auto& t : _db)
+        add(t.second.summary);
+    }
+    else
+    {
+      for (const auto& id : request.task_id)
+      {
+        const auto it = _db.find(id);
+        if (it != _db.end())
+          add(it->second.summary);
+      }
+    }
+
+    response.success = true;
+  }
+
+  /// Forget the tasks that finished too long ago, and the oldest finished
+  /// tasks if there are too many of them
+  void prune()
+  {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<std::unordered_map<std::string, Entry>::iterator> terminal;
+    for (auto it = _db.begin(); it != _db.end(); )
+    {
+      if (!is_terminal(it->second.summary))
+      {
+        ++it;
+        continue;
+      }
+
+      if (_options.max_terminal_age.has_value()
+        && *_options.max_terminal_age < now - it->second.updated)
+      {
+        _changed.erase(it->first);
+        it = _db.erase(it);
+        continue;
+      }
+
+      terminal.push_back(it);
+      ++it;
+    }
+
+    if (terminal.size() <= _options.max_terminal_tasks)
+      return;
+
+    const auto excess = terminal.size() - _options.max_terminal_tasks;
+    std::nth_element(
+      terminal.begin(), terminal.begin() + excess, terminal.end(),
+      [](const auto& a, const auto& b)
+      {
+        return a->second.updated < b->second.updated;
+      });
+
+    for (std::size_t i = 0; i < excess; ++i)
+    {
+      _changed.erase(terminal[i]->first);
+      _db.erase(terminal[i]);
+    }
+  }
+
+  double _rate;
+  Options _options;
+
+  std::unordered_map<std::string, Entry> _db;
+
+  // The tasks that have changed since the last publication
+  std::unordered_set<std::string> _changed;
+
+  rclcpp::TimerBase::SharedPtr _timer;
+  rclcpp::Publisher<Tasks>::SharedPtr _tasks_pub;
+  rclcpp::Subscription<TaskSummary>::SharedPtr _task_summary_sub;
+  rclcpp::CallbackGroup::SharedPtr _cb_group_task_summary;
+  rclcpp::Service<GetTaskList>::SharedPtr _get_tasks_srv;
+};
+
+#endif // SRC__TASK_AGGREGATOR__TASKAGGREGATOR_HPP
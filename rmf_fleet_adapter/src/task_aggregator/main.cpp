@@ -15,95 +15,9 @@
  *
 */
 
-#include <rclcpp/rclcpp.hpp>
-#include <rclcpp/callback_group.hpp>
+#include "TaskAggregator.hpp"
 
-#include <rmf_fleet_adapter/StandardNames.hpp>
-
-#include <rmf_task_msgs/msg/tasks.hpp>
-#include <rmf_task_msgs/msg/task_summary.hpp>
-
-
-class TaskAggregator : public rclcpp::Node
-{
-
-  using TaskSummary = rmf_task_msgs::msg::TaskSummary;
-  using Tasks = rmf_task_msgs::msg::Tasks;
-
-public:
-  TaskAggregator(
-    std::string node_name,
-    std::string input_topic,
-    double rate)
-  : Node(node_name),
-    _rate(rate)
-  {
-    // Create a wall timer to periodically publish Tasks msg
-    const double period = 1.0/_rate;
-    auto timer_period = std::chrono::duration_cast<std::chrono::nanoseconds>(
-      std::chrono::duration<double, std::ratio<1>>(period));
-    _timer = this->create_wall_timer(
-      timer_period, std::bind(&TaskAggregator::timer_callback, this));
-
-    // Create publisher for Tasks msg
-    _tasks_pub = this->create_publisher<Tasks>(
-      "/tasks",
-      rclcpp::ServicesQoS());
-
-    // Create subscription to receive TaskSummary msgs from fleet adapters
-    _cb_group_task_summary = this->create_callback_group(
-      rclcpp::CallbackGroupType::MutuallyExclusive);
-    auto sub_map_opt = rclcpp::SubscriptionOptions();
-    sub_map_opt.callback_group = _cb_group_task_summary;
-    auto qos_profile = rclcpp::QoS(10);
-    _task_summary_sub = this->create_subscription<TaskSummary>(
-      input_topic,
-      qos_profile,
-      std::bind(
-        &TaskAggregator::task_summary_cb,
-        this,
-        std::placeholders::_1),
-      sub_map_opt);
-
-    RCLCPP_INFO(
-      get_logger(),
-      "Listening for Task Summaries on topic /%s",
-      input_topic.c_str());
-  }
-
-private:
-
-  void timer_callback()
-  {
-    Tasks tasks;
-
-    for (const auto& t : _db)
-      tasks.tasks.push_back(t.second);
-
-    _tasks_pub->publish(tasks);
-  }
-
-  void task_summary_cb(const TaskSummary::SharedPtr msg)
-  {
-    if (_db.find(msg->task_id) != _db.end())
-    {
-      _db[msg->task_id] = *msg;
-    }
-    else
-    {
-      _db.insert(std::make_pair(msg->task_id, *msg));
-    }
-  }
-
-  double _rate;
-
-  std::unordered_map<std::string, TaskSummary> _db;
-
-  rclcpp::TimerBase::SharedPtr _timer;
-  rclcpp::Publisher<Tasks>::SharedPtr _tasks_pub;
-  rclcpp::Subscription<TaskSummary>::SharedPtr _task_summary_sub;
-  rclcpp::CallbackGroup::SharedPtr _cb_group_task_summary;
-};
+#include <iostream>
 
 bool get_arg(
   const std::vector<std::string>& args,
@@ -148,10 +62,35 @@ int main(int argc, char* argv[])
   get_arg(args, "-r", rate_string, "rate", false);
   double rate = rate_string.empty() ? 1.0 : std::stod(rate_string);
 
+  TaskAggregator::Options options;
+  std::string max_terminal_tasks_string;
+  if (get_arg(args, "-k", max_terminal_tasks_string, "count", false))
+    options.max_terminal_tasks = std::stoul(max_terminal_tasks_string);
+
+  std::string max_terminal_age_string;
+  if (get_arg(args, "-a", max_terminal_age_string, "age in seconds", false))
+  {
+    const double age = std::stod(max_terminal_age_string);
+    if (age > 0.0)
+    {
+      options.max_terminal_age =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(age));
+    }
+    else
+    {
+      options.max_terminal_age = std::nullopt;
+    }
+  }
+
+  options.delta =
+    std::find(args.begin(), args.end(), "--delta") != args.end();
+
   auto task_aggregator_node = std::make_shared<TaskAggregator>(
     node_name,
     input_topic,
-    rate);
+    rate,
+    options);
 
   rclcpp::spin(task_aggregator_node);
 
@@ -0,0 +1,406 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Per-call latency of the routines that full_control uses to estimate where
+// each robot is whenever a FleetState message arrives. The navigation graphs
+// are synthetic grids, and the robot states are randomized so that they are
+// spread across the whole grid:
+//
+//   estimate_state          A robot near a random last known waypoint.
+//   estimate_midlane_state  A robot somewhere along a lane of its plan.
+//   estimate_path_traveling A robot following a plan with a remaining path.
+//   estimate_waypoint       A robot close to a random waypoint, found with the
+//                           spatial index of the graph.
+//   estimate_waypoint_scan  The same, but searching every waypoint of the
+//                           graph as happens when there is no spatial index.
+//
+// For every graph size it reports the mean, median, 99th percentile and
+// maximum latency of each routine.
+//
+//   benchmark_estimation [--waypoints 100,1000,10000,50000] [--calls N]
+//     [--robots N] [--seed N]
+
+#include "estimation.hpp"
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+//==============================================================================
+const std::string MapName = "L1";
+const double Spacing = 3.0;
+
+//==============================================================================
+struct Options
+{
+  std::vector<std::size_t> waypoints = {100, 1000, 10000, 50000};
+  std::size_t calls = 20000;
+  std::size_t robots = 500;
+  unsigned int seed = 42;
+};
+
+//==============================================================================
+std::vector<std::string> split(const std::string& list)
+{
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ','))
+  {
+    if (!item.empty())
+      items.push_back(item);
+  }
+
+  return items;
+}
+
+//==============================================================================
+Options parse(const std::vector<std::string>& args)
+{
+  Options options;
+  for (std::size_t i = 1; i + 1 < args.size(); i += 2)
+  {
+    const std::string& flag = args[i];
+    const std::string& value = args[i+1];
+    if (flag == "--waypoints")
+    {
+      options.waypoints.clear();
+      for (const auto& n : split(value))
+        options.waypoints.push_back(std::stoul(n));
+    }
+    else if (flag == "--calls")
+      options.calls = std::max<std::size_t>(1, std::stoul(value));
+    else if (flag == "--robots")
+      options.robots = std::max<std::size_t>(1, std::stoul(value));
+    else if (flag == "--seed")
+      options.seed = static_cast<unsigned int>(std::stoul(value));
+    else
+      throw std::runtime_error("[benchmark_estimation] Unknown flag " + flag);
+  }
+
+  return options;
+}
+
+//==============================================================================
+/// A square grid with the given number of waypoints, where every waypoint has
+/// a bidirectional lane to its neighbors
+rmf_traffic::agv::Graph make_grid(const std::size_t waypoints)
+{
+  rmf_traffic::agv::Graph graph;
+  const std::size_t side = std::max<std::size_t>(
+    2, static_cast<std::size_t>(std::ceil(std::sqrt(waypoints))));
+
+  for (std::size_t i = 0; i < waypoints; ++i)
+  {
+    const double x = Spacing * (i % side);
+    const double y = Spacing * (i / side);
+    graph.add_waypoint(MapName, {x, y});
+
+    if (i % side > 0)
+    {
+      graph.add_lane(i-1, i);
+      graph.add_lane(i, i-1);
+    }
+
+    if (i >= side)
+    {
+      graph.add_lane(i-side, i);
+      graph.add_lane(i, i-side);
+    }
+  }
+
+  return graph;
+}
+
+//==============================================================================
+rmf_fleet_msgs::msg::Location make_location(
+  const Eigen::Vector2d& p,
+  const double yaw)
+{
+  rmf_fleet_msgs::msg::Location l;
+  l.x = p.x();
+  l.y = p.y();
+  l.yaw = yaw;
+  l.level_name = MapName;
+  return l;
+}
+
+//==============================================================================
+/// A robot that is partway through one of the plans
+struct Travel
+{
+  std::size_t plan;
+  std::size_t next_index;
+  rmf_fleet_msgs::msg::RobotState state;
+};
+
+//==============================================================================
+struct Scenario
+{
+  std::shared_ptr<const rmf_traffic::agv::Graph> graph;
+  std::shared_ptr<const rmf_traffic::agv::VehicleTraits> traits;
+  std::shared_ptr<const rmf_fleet_adapter::agv::PlanStartIndex> graph_index;
+  std::vector<std::vector<rmf_traffic::agv::Plan::Waypoint>> plans;
+
+  std::vector<std::pair<std::size_t, rmf_fleet_msgs::msg::Location>> near;
+  std::vector<Travel> travels;
+};
+
+//==============================================================================
+Scenario make_scenario(
+  const std::size_t waypoints,
+  const Options& options,
+  std::mt19937& rng)
+{
+  Scenario s;
+  s.graph = std::make_shared<rmf_traffic::agv::Graph>(make_grid(waypoints));
+  s.traits = std::make_shared<rmf_traffic::agv::VehicleTraits>(
+    rmf_traffic::agv::VehicleTraits{
+      {0.7, 0.3},
+      {1.0, 0.45},
+      rmf_traffic::Profile{
+        rmf_traffic::geometry::make_final_convex<
+          rmf_traffic::geometry::Circle>(0.5)
+      }
+    });
+  s.graph_index =
+    std::make_shared<rmf_fleet_adapter::agv::PlanStartIndex>(*s.graph);
+
+  const std::size_t n = s.graph->num_waypoints();
+  std::uniform_int_distribution<std::size_t> random_wp(0, n-1);
+  std::uniform_real_distribution<double> random_yaw(-M_PI, M_PI);
+  std::uniform_real_distribution<double> random_offset(-0.2, 0.2);
+  std::uniform_real_distribution<double> random_fraction(0.0, 1.0);
+
+  for (std::size_t i = 0; i < options.robots; ++i)
+  {
+    const std::size_t wp = random_wp(rng);
+    const Eigen::Vector2d offset{random_offset(rng), random_offset(rng)};
+    s.near.push_back(
+      {wp, make_location(
+          s.graph->get_waypoint(wp).get_location() + offset,
+          random_yaw(rng))});
+  }
+
+  // Plans between random waypoints that are a few lanes apart along a row of
+  // the grid, so that the planner does not dominate the setup time
+  const rmf_traffic::agv::Planner planner(
+    rmf_traffic::agv::Planner::Configuration{*s.graph, *s.traits},
+    rmf_traffic::agv::Plan::Options(nullptr));
+
+  const auto now = std::chrono::steady_clock::now();
+  const std::size_t plan_count = std::min<std::size_t>(16, options.robots);
+  for (std::size_t i = 0; s.plans.size() < plan_count && i < 10*plan_count;
+    ++i)
+  {
+    const std::size_t start = random_wp(rng);
+    const std::size_t goal = std::min(start + 4, n-1);
+    if (goal == start)
+      continue;
+
+    const auto plan = planner.plan(
+      rmf_traffic::agv::Plan::Start(now, start, 0.0),
+      rmf_traffic::agv::Plan::Goal(goal));
+
+    if (!plan || plan->get_waypoints().size() < 3)
+      continue;
+
+    s.plans.push_back(plan->get_waypoints());
+  }
+
+  if (s.plans.empty())
+    throw std::runtime_error("[benchmark_estimation] Failed to make any plans");
+
+  std::uniform_int_distribution<std::size_t> random_plan(0, s.plans.size()-1);
+  for (std::size_t i = 0; i < options.robots; ++i)
+  {
+    Travel travel;
+    travel.plan = random_plan(rng);
+    const auto& plan = s.plans[travel.plan];
+    std::uniform_int_distribution<std::size_t> random_next(2, plan.size()-1);
+    travel.next_index = random_next(rng);
+
+    const Eigen::Vector2d p0 =
+      plan[travel.next_index-1].position().block<2, 1>(0, 0);
+    const Eigen::Vector2d p1 =
+      plan[travel.next_index].position().block<2, 1>(0, 0);
+    const Eigen::Vector2d offset{random_offset(rng), random_offset(rng)};
+
+    travel.state.location = make_location(
+      p0 + random_fraction(rng) * (p1 - p0) + offset,
+      plan[travel.next_index].position()[2]);
+    travel.state.path.resize(plan.size() - travel.next_index);
+    s.travels.push_back(std::move(travel));
+  }
+
+  return s;
+}
+
+//==============================================================================
+struct Latency
+{
+  double mean;
+  double median;
+  double p99;
+  double max;
+};
+
+//==============================================================================
+/// Time each call of a routine on its own. Preparing the TravelInfo for a
+/// call and discarding the updates that it produced are not timed.
+Latency measure(
+  const std::size_t calls,
+  TravelInfo& info,
+  const std::function<void(std::size_t)>& prepare,
+  const std::function<void(std::size_t)>& call)
+{
+  rmf_fleet_adapter::agv::FleetUpdateHandle::RobotUpdates updates;
+  info.updates = &updates;
+
+  std::vector<double> durations;
+  durations.reserve(calls);
+  for (std::size_t i = 0; i < calls; ++i)
+  {
+    prepare(i);
+    const auto start = std::chrono::steady_clock::now();
+    call(i);
+    const auto finish = std::chrono::steady_clock::now();
+    durations.push_back(
+      std::chrono::duration<double, std::micro>(finish - start).count());
+
+    updates.clear();
+  }
+
+  info.updates = nullptr;
+
+  Latency latency;
+  double total = 0.0;
+  for (const auto d : durations)
+    total += d;
+
+  latency.mean = total / durations.size();
+  std::sort(durations.begin(), durations.end());
+  latency.median = durations[durations.size() / 2];
+  latency.p99 = durations[
+    std::min(durations.size() - 1, durations.size() * 99 / 100)];
+  latency.max = durations.back();
+  return latency;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  const auto options = parse(rclcpp::remove_ros_arguments(argc, argv));
+  const auto node = std::make_shared<rclcpp::Node>("benchmark_estimation");
+
+  std::cout << std::left << std::setw(25) << "routine" << std::right
+            << std::setw(8) << "n" << std::setw(11) << "mean[us]"
+            << std::setw(11) << "p50[us]" << std::setw(11) << "p99[us]"
+            << std::setw(11) << "max[us]" << std::endl;
+
+  std::mt19937 rng(options.seed);
+  for (const auto waypoints : options.waypoints)
+  {
+    const auto s = make_scenario(waypoints, options, rng);
+
+    TravelInfo info;
+    info.graph = s.graph;
+    info.traits = s.traits;
+    info.graph_index = s.graph_index;
+    info.fleet_name = "benchmark";
+    info.robot_name = "robot";
+    info.next_arrival_estimator = [](std::size_t, rmf_traffic::Duration) {};
+
+    const auto report = [&](const std::string& routine, const Latency& l)
+      {
+        std::cout << std::left << std::setw(25) << routine << std::right
+                  << std::setw(8) << s.graph->num_waypoints()
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(11) << l.mean << std::setw(11) << l.median
+                  << std::setw(11) << l.p99 << std::setw(11) << l.max
+                  << std::endl;
+      };
+
+    const auto near_waypoint = [&](const std::size_t i)
+      {
+        info.last_known_wp = s.near[i % s.near.size()].first;
+      };
+
+    const auto unknown_waypoint = [&](std::size_t)
+      {
+        info.last_known_wp = std::nullopt;
+      };
+
+    const auto traveling = [&](const std::size_t i)
+      {
+        info.waypoints = s.plans[s.travels[i % s.travels.size()].plan];
+        info.last_known_wp = std::nullopt;
+      };
+
+    report("estimate_state", measure(options.calls, info, near_waypoint,
+      [&](const std::size_t i)
+      {
+        estimate_state(node.get(), s.near[i % s.near.size()].second, info);
+      }));
+
+    report("estimate_midlane_state", measure(options.calls, info, traveling,
+      [&](const std::size_t i)
+      {
+        const auto& travel = s.travels[i % s.travels.size()];
+        estimate_midlane_state(
+          travel.state.location,
+          info.waypoints[travel.next_index-1].graph_index(),
+          travel.next_index, info);
+      }));
+
+    report("estimate_path_traveling", measure(options.calls, info, traveling,
+      [&](const std::size_t i)
+      {
+        const auto& travel = s.travels[i % s.travels.size()];
+        estimate_path_traveling(node.get(), travel.state, info);
+      }));
+
+    const auto find_waypoint = [&](const std::size_t i)
+      {
+        estimate_waypoint(node.get(), s.near[i % s.near.size()].second, info);
+      };
+
+    report("estimate_waypoint", measure(
+      options.calls, info, unknown_waypoint, find_waypoint));
+
+    info.graph_index = nullptr;
+    report("estimate_waypoint_scan", measure(
+      options.calls, info, unknown_waypoint, find_waypoint));
+  }
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <agv/AllocationCache.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+using rmf_fleet_adapter::agv::AllocationCache;
+
+//==============================================================================
+SCENARIO("Allocation cache reuses results for matching fleet states")
+{
+  using namespace std::chrono_literals;
+  AllocationCache cache(2, 2s);
+
+  const auto start = rmf_traffic::Time(100s);
+  const auto state = [](rmf_traffic::Time time, double soc)
+    {
+      return rmf_task::agv::State{{time, 0, 0.0}, 1, soc};
+    };
+
+  const auto cached = [&](const AllocationCache::Key& k)
+    {
+      return cache.get(k).has_value();
+    };
+
+  const auto key = cache.make_key(
+    {state(start, 0.8), state(start, 0.5)}, {"b", "a"}, false);
+
+  CHECK_FALSE(cache.get(key).has_value());
+  cache.set(key, AllocationCache::Assignments(2));
+  REQUIRE(cache.get(key).has_value());
+  CHECK(cache.get(key)->size() == 2);
+
+  // A small amount of progress is rounded away, and the order of the
+  // requests does not matter for a full allocation
+  const auto same = cache.make_key(
+    {state(start + 500ms, 0.8001), state(start, 0.5)}, {"a", "b"}, false);
+  CHECK(cache.get(same).has_value());
+
+  // Real progress of a robot makes the entry stale
+  CHECK_FALSE(cached(
+      cache.make_key(
+        {state(start + 5s, 0.8), state(start, 0.5)}, {"a", "b"}, false)));
+  CHECK_FALSE(cached(
+      cache.make_key(
+        {state(start, 0.7), state(start, 0.5)}, {"a", "b"}, false)));
+
+  // Different requests or modes do not match
+  CHECK_FALSE(cached(
+      cache.make_key(
+        {state(start, 0.8), state(start, 0.5)}, {"a"}, false)));
+  CHECK_FALSE(cached(
+      cache.make_key(
+        {state(start, 0.8), state(start, 0.5)}, {"a", "b"}, true)));
+
+  // The queue order matters for an incremental allocation
+  const auto incremental = cache.make_key(
+    {state(start, 0.8), state(start, 0.5)}, {"c", "a", "", "b", ""}, true);
+  cache.set(incremental, AllocationCache::Assignments(2));
+  CHECK(cache.get(incremental).has_value());
+  CHECK_FALSE(cached(
+      cache.make_key(
+        {state(start, 0.8), state(start, 0.5)}, {"c", "b", "", "a", ""},
+        true)));
+
+  WHEN("The capacity is exceeded")
+  {
+    // Use the first key so that the incremental key is the least recent
+    CHECK(cache.get(key).has_value());
+
+    const auto other = cache.make_key({state(start, 0.3)}, {"d"}, false);
+    cache.set(other, AllocationCache::Assignments(1));
+
+    CHECK(cache.size() == 2);
+    CHECK(cache.get(key).has_value());
+    CHECK(cache.get(other).has_value());
+    CHECK_FALSE(cache.get(incremental).has_value());
+  }
+
+  WHEN("The cache is cleared")
+  {
+    cache.clear();
+    CHECK(cache.size() == 0);
+    CHECK_FALSE(cache.get(key).has_value());
+  }
+
+  WHEN("The capacity is zero")
+  {
+    AllocationCache disabled(0);
+    disabled.set(key, AllocationCache::Assignments(2));
+    CHECK_FALSE(disabled.get(key).has_value());
+  }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/AllocationOutcome.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+using rmf_fleet_adapter::agv::AllocationOutcome;
+using rmf_fleet_adapter::agv::allocation_outcome;
+
+//==============================================================================
+SCENARIO("Allocations planned against old queues are planned again")
+{
+  GIVEN("An allocation planned against the current queues")
+  {
+    THEN("Its result is delivered")
+    {
+      CHECK(allocation_outcome(false, false, 3, 3)
+        == AllocationOutcome::Deliver);
+      CHECK(allocation_outcome(false, true, 3, 3)
+        == AllocationOutcome::Deliver);
+    }
+  }
+
+  GIVEN("The queues were replaced while the allocation was being planned")
+  {
+    THEN("A dispatch or cancellation is planned again")
+    {
+      CHECK(allocation_outcome(false, false, 3, 4)
+        == AllocationOutcome::Replan);
+    }
+
+    THEN("A speculative bid is delivered to be reconciled on award")
+    {
+      CHECK(allocation_outcome(false, true, 3, 4)
+        == AllocationOutcome::Deliver);
+    }
+  }
+
+  GIVEN("An allocation that was cancelled while it was being planned")
+  {
+    THEN("Its result is dropped, even if it is also out of date")
+    {
+      CHECK(allocation_outcome(true, false, 3, 3)
+        == AllocationOutcome::Drop);
+      CHECK(allocation_outcome(true, false, 3, 4)
+        == AllocationOutcome::Drop);
+      CHECK(allocation_outcome(true, true, 3, 4)
+        == AllocationOutcome::Drop);
+    }
+  }
+}
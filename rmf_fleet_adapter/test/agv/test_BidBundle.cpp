@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/BidBundle.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+//==============================================================================
+SCENARIO("The tasks of a bid bundle share the cost of the bundle")
+{
+  using rmf_fleet_adapter::agv::bid_bundle_cost;
+  using rmf_fleet_adapter::agv::bid_bundle_key;
+
+  const double current_cost = 100.0;
+
+  GIVEN("A bundle of one task")
+  {
+    THEN("The task is charged the whole cost, like an ordinary bid")
+    {
+      CHECK(bid_bundle_cost(current_cost, 130.0, 1) == Approx(130.0));
+    }
+  }
+
+  GIVEN("A bundle of three tasks that adds 60 to the cost of the fleet")
+  {
+    const double bundle_cost = 160.0;
+    const std::size_t size = 3;
+    const double share = bid_bundle_cost(current_cost, bundle_cost, size);
+
+    THEN("Each task is charged a third of what the bundle adds")
+    {
+      CHECK(share == Approx(120.0));
+      CHECK(
+        (share - current_cost) * static_cast<double>(size)
+        == Approx(bundle_cost - current_cost));
+    }
+
+    THEN("Each task costs less than the whole bundle")
+    {
+      CHECK(share < bundle_cost);
+      CHECK(share > current_cost);
+    }
+  }
+
+  GIVEN("The ids of the tasks in a bundle")
+  {
+    const auto key = bid_bundle_key({"task_a", "task_b"});
+
+    THEN("The bundle is planned under a key of its own")
+    {
+      CHECK(key == bid_bundle_key({"task_a", "task_b"}));
+      CHECK(key != bid_bundle_key({"task_b", "task_a"}));
+      CHECK(key != "task_a");
+      CHECK(key != "task_b");
+      CHECK(key.find("task_a") != std::string::npos);
+      CHECK(key.find("task_b") != std::string::npos);
+    }
+  }
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/BidPlanningDeadline.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+//==============================================================================
+SCENARIO("Bid planning falls back to greedy assignments at its deadline")
+{
+  using namespace std::chrono_literals;
+  using rmf_fleet_adapter::agv::bid_planning_deadline;
+  using rmf_fleet_adapter::agv::plan_before_deadline;
+  using TaskPlanner = rmf_task::agv::TaskPlanner;
+  using Clock = std::chrono::steady_clock;
+
+  const auto now = Clock::now();
+
+  GIVEN("A bid notice with a time window")
+  {
+    THEN("The deadline is the budgeted fraction of the window")
+    {
+      const auto deadline = bid_planning_deadline(now, 10s, 0.5);
+      REQUIRE(deadline.has_value());
+      CHECK(*deadline == now + 5s);
+    }
+
+    THEN("There is no deadline without a budget or a window")
+    {
+      CHECK_FALSE(bid_planning_deadline(now, 10s, 0.0).has_value());
+      CHECK_FALSE(bid_planning_deadline(now, 0s, 0.5).has_value());
+    }
+  }
+
+  // Records the options of every search. The optimal search keeps going
+  // until it is interrupted when search_forever is true.
+  std::vector<bool> searches;
+  bool search_forever = false;
+  const auto plan = [&](const TaskPlanner::Options& options)
+    -> TaskPlanner::Result
+    {
+      searches.push_back(options.greedy());
+      if (!options.greedy() && search_forever)
+      {
+        REQUIRE(options.interrupter());
+        while (!options.interrupter()())
+        {
+          // Keep searching
+        }
+
+        return TaskPlanner::Assignments{};
+      }
+
+      // One robot with no assignments
+      return TaskPlanner::Assignments{{}};
+    };
+
+  bool greedy = true;
+
+  WHEN("There is no deadline")
+  {
+    const auto result = plan_before_deadline(
+      plan, std::nullopt, nullptr, greedy);
+
+    THEN("Only the optimal search runs")
+    {
+      CHECK_FALSE(greedy);
+      CHECK(searches == std::vector<bool>({false}));
+      CHECK(std::get_if<TaskPlanner::Assignments>(&result));
+    }
+  }
+
+  WHEN("The optimal search finishes before the deadline")
+  {
+    plan_before_deadline(plan, Clock::now() + 1min, nullptr, greedy);
+
+    THEN("Its assignments are used")
+    {
+      CHECK_FALSE(greedy);
+      CHECK(searches == std::vector<bool>({false}));
+    }
+  }
+
+  WHEN("The optimal search is still running at the deadline")
+  {
+    search_forever = true;
+    const auto result = plan_before_deadline(
+      plan, Clock::now() + 50ms, nullptr, greedy);
+
+    THEN("It is interrupted and the greedy assignments are used")
+    {
+      CHECK(greedy);
+      CHECK(searches == std::vector<bool>({false, true}));
+      const auto* assignments =
+        std::get_if<TaskPlanner::Assignments>(&result);
+      REQUIRE(assignments);
+      CHECK(assignments->size() == 1);
+    }
+  }
+
+  WHEN("The deadline passed while the bid was waiting to be planned")
+  {
+    plan_before_deadline(plan, now - 1s, nullptr, greedy);
+
+    THEN("Only the greedy search runs")
+    {
+      CHECK(greedy);
+      CHECK(searches == std::vector<bool>({true}));
+    }
+  }
+
+  WHEN("The allocation is cancelled while the optimal search is running")
+  {
+    search_forever = true;
+    std::atomic_bool cancelled = false;
+    std::thread canceller([&cancelled]()
+      {
+        std::this_thread::sleep_for(50ms);
+        cancelled = true;
+      });
+
+    const auto result = plan_before_deadline(
+      plan, std::nullopt, nullptr, greedy,
+      [&cancelled]() { return cancelled.load(); });
+    canceller.join();
+
+    THEN("The search is interrupted without planning greedy assignments")
+    {
+      CHECK_FALSE(greedy);
+      CHECK(searches == std::vector<bool>({false}));
+      const auto* assignments =
+        std::get_if<TaskPlanner::Assignments>(&result);
+      REQUIRE(assignments);
+      CHECK(assignments->empty());
+    }
+  }
+
+  WHEN("The allocation was cancelled before it was planned")
+  {
+    plan_before_deadline(
+      plan, Clock::now() + 1min, nullptr, greedy, []() { return true; });
+
+    THEN("No search runs")
+    {
+      CHECK_FALSE(greedy);
+      CHECK(searches.empty());
+    }
+  }
+}
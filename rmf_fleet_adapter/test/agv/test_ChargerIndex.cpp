@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/ChargerIndex.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+using rmf_fleet_adapter::agv::ChargerIndex;
+
+//==============================================================================
+SCENARIO("Chargers are reserved by one robot at a time")
+{
+  ChargerIndex index({3, 7});
+  const auto now = std::chrono::steady_clock::now();
+  const auto later = now + std::chrono::minutes(10);
+
+  CHECK(index.available(3, "robot_a", now));
+  CHECK(index.reserve("robot_a", 3, now, later));
+
+  THEN("Another robot cannot take the charger until the reservation expires")
+  {
+    CHECK(index.available(3, "robot_a", now));
+    CHECK_FALSE(index.available(3, "robot_b", now));
+    CHECK_FALSE(index.reserve("robot_b", 3, now, later));
+    CHECK(index.available(3, "robot_b", later));
+    CHECK(index.reserve("robot_b", 3, later, later + std::chrono::minutes(1)));
+  }
+
+  WHEN("The robot reserves a different charger")
+  {
+    CHECK(index.reserve("robot_a", 7, now, later));
+
+    THEN("Its first reservation is given up")
+    {
+      CHECK(index.available(3, "robot_b", now));
+      CHECK_FALSE(index.available(7, "robot_b", now));
+    }
+  }
+
+  WHEN("The robot releases its reservation")
+  {
+    index.release("robot_a");
+
+    THEN("The charger is free again")
+    {
+      CHECK(index.available(3, "robot_b", now));
+    }
+  }
+}
+
+//==============================================================================
+SCENARIO("Retreat estimates are shared across robots")
+{
+  ChargerIndex index({3});
+  std::size_t computed = 0;
+  const auto compute = [&]() -> std::optional<ChargerIndex::Estimate>
+    {
+      ++computed;
+      return ChargerIndex::Estimate{std::chrono::seconds(30), 0.05};
+    };
+
+  const auto first = index.estimate(1, 3, compute);
+  REQUIRE(first.has_value());
+  CHECK(first->dsoc == Approx(0.05));
+
+  const auto second = index.estimate(1, 3, compute);
+  REQUIRE(second.has_value());
+  CHECK(second->duration == std::chrono::seconds(30));
+  CHECK(computed == 1);
+
+  index.estimate(2, 3, compute);
+  CHECK(computed == 2);
+
+  index.clear_estimates();
+  index.estimate(1, 3, compute);
+  CHECK(computed == 3);
+
+  const auto failed = index.estimate(
+    5, 3, []() -> std::optional<ChargerIndex::Estimate>
+    {
+      return std::nullopt;
+    });
+  CHECK_FALSE(failed.has_value());
+}
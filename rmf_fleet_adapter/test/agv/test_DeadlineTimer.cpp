@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "../phases/MockAdapterFixture.hpp"
+
+#include <agv/DeadlineTimer.hpp>
+#include <rmf_traffic_ros2/Time.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+//==============================================================================
+SCENARIO("Deadlines fire in order once the clock of the node reaches them")
+{
+  rmf_fleet_adapter::phases::test::MockAdapterFixture fixture;
+  const auto& node = fixture.data->node;
+  const auto timer = rmf_fleet_adapter::agv::DeadlineTimer::make(node);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  struct Fired
+  {
+    std::string name;
+    rmf_traffic::Time deadline;
+    rmf_traffic::Time time;
+  };
+  std::vector<Fired> fired;
+
+  const auto now = rmf_traffic_ros2::convert(node->now());
+  const auto schedule = [&](const std::string& name, rmf_traffic::Time time)
+    {
+      return timer->schedule(
+        time, [&, name, time]()
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          fired.push_back(
+            {name, time, rmf_traffic_ros2::convert(node->now())});
+          cv.notify_all();
+        });
+    };
+
+  // The deadlines are scheduled out of order, so the timer has to be armed
+  // again for the earlier ones
+  const auto late = schedule("late", now + 600ms);
+  auto cancelled = schedule("cancelled", now + 400ms);
+  const auto early = schedule("early", now + 200ms);
+  cancelled = nullptr;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait_for(lock, 5s, [&]() { return fired.size() >= 2; });
+  }
+
+  // Give the cancelled deadline a chance to fire if it was going to
+  std::this_thread::sleep_for(200ms);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  REQUIRE(fired.size() == 2);
+  CHECK(fired[0].name == "early");
+  CHECK(fired[1].name == "late");
+  for (const auto& f : fired)
+  {
+    CAPTURE(f.name);
+    CHECK(f.time >= f.deadline);
+    CHECK(f.time - f.deadline < 500ms);
+  }
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/DelayReporter.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <map>
+
+using rmf_fleet_adapter::agv::DelayReporter;
+
+//==============================================================================
+SCENARIO("Delay reporter batches and filters the delays of a fleet")
+{
+  using namespace std::chrono_literals;
+  DelayReporter reporter(500ms);
+  std::map<DelayReporter::ParticipantId, rmf_traffic::Duration> applied;
+
+  const auto report = [&](
+    const DelayReporter::ParticipantId id,
+    const rmf_traffic::Duration delay)
+    {
+      reporter.report(
+        id, delay,
+        [&applied, id](rmf_traffic::Duration d) { applied[id] += d; });
+    };
+
+  WHEN("Delays are reported")
+  {
+    report(0, 2s);
+    report(0, 1s);
+    report(1, 100ms);
+    CHECK(applied.empty());
+
+    THEN("Only the latest delay above the threshold of each robot is applied")
+    {
+      CHECK(reporter.flush() == 1);
+      REQUIRE(applied.size() == 1);
+      CHECK(applied.at(0) == 1s);
+      CHECK(reporter.flush() == 0);
+    }
+  }
+
+  WHEN("A delay would reverse the previous one")
+  {
+    report(0, 1s);
+    CHECK(reporter.flush() == 1);
+
+    // This would be enough to continue in the same direction
+    report(0, -(2*reporter.threshold() - 100ms));
+    CHECK(reporter.flush() == 0);
+
+    const auto reversal = -(2*reporter.threshold() + 100ms);
+    report(0, reversal);
+    CHECK(reporter.flush() == 1);
+    CHECK(applied.at(0) == 1s + reversal);
+  }
+
+  WHEN("Many robots keep reporting delays")
+  {
+    const auto base = reporter.threshold();
+    for (std::size_t i = 0; i < 10; ++i)
+    {
+      for (DelayReporter::ParticipantId id = 0; id < 5; ++id)
+        report(id, 10s);
+
+      reporter.flush();
+    }
+
+    THEN("The threshold rises")
+    {
+      CHECK(base < reporter.threshold());
+      CHECK(reporter.threshold() <= 4*base);
+
+      report(0, 2*base);
+      applied.clear();
+      CHECK(reporter.flush() == 0);
+    }
+
+    AND_WHEN("The robots stop being delayed")
+    {
+      const auto raised = reporter.threshold();
+      for (std::size_t i = 0; i < 10; ++i)
+      {
+        for (DelayReporter::ParticipantId id = 0; id < 5; ++id)
+          report(id, 100ms);
+
+        reporter.flush();
+      }
+
+      THEN("The threshold falls again")
+      {
+        CHECK(reporter.threshold() < raised);
+      }
+    }
+  }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <agv/DoorOpeningTimes.hpp>
+
+#include <rmf_door_msgs/msg/door_mode.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+//==============================================================================
+SCENARIO("Learn the opening times of doors")
+{
+  using rmf_door_msgs::msg::DoorMode;
+  using namespace std::chrono_literals;
+
+  rmf_fleet_adapter::agv::DoorOpeningTimes times(0.5);
+  const auto t0 = rmf_traffic::Time(100s);
+
+  CHECK_FALSE(times.opening_time("door"));
+
+  WHEN("A door is seen opening")
+  {
+    times.observe("door", DoorMode::MODE_CLOSED, t0);
+    times.observe("door", DoorMode::MODE_MOVING, t0 + 1s);
+    times.observe("door", DoorMode::MODE_MOVING, t0 + 2s);
+    times.observe("door", DoorMode::MODE_OPEN, t0 + 5s);
+
+    const auto estimate = times.opening_time("door");
+    REQUIRE(estimate);
+    CHECK(*estimate == 4s);
+    CHECK_FALSE(times.opening_time("other_door"));
+
+    AND_WHEN("It is seen opening again")
+    {
+      times.observe("door", DoorMode::MODE_MOVING, t0 + 10s);
+      times.observe("door", DoorMode::MODE_CLOSED, t0 + 15s);
+      times.observe("door", DoorMode::MODE_MOVING, t0 + 20s);
+      times.observe("door", DoorMode::MODE_OPEN, t0 + 22s);
+
+      // The estimate is blended with the new observation
+      const auto estimate = times.opening_time("door");
+      REQUIRE(estimate);
+      CHECK(*estimate == 3s);
+    }
+  }
+
+  WHEN("The door was not seen closed before it moved")
+  {
+    times.observe("door", DoorMode::MODE_MOVING, t0);
+    times.observe("door", DoorMode::MODE_OPEN, t0 + 5s);
+    CHECK_FALSE(times.opening_time("door"));
+  }
+
+  WHEN("The door closes again before it finishes opening")
+  {
+    times.observe("door", DoorMode::MODE_CLOSED, t0);
+    times.observe("door", DoorMode::MODE_MOVING, t0 + 1s);
+    times.observe("door", DoorMode::MODE_CLOSED, t0 + 2s);
+    times.observe("door", DoorMode::MODE_OPEN, t0 + 5s);
+    CHECK_FALSE(times.opening_time("door"));
+  }
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/FleetSnapshot.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <cstdio>
+
+using namespace rmf_fleet_adapter::agv;
+
+//==============================================================================
+SCENARIO("Fleet snapshots survive a round trip")
+{
+  FleetSnapshot snapshot;
+  snapshot.fleet_name = "tinyRobot";
+  snapshot.robots.push_back({"tinyRobot1", {"delivery_1", "loop_2"}});
+  snapshot.robots.push_back({"tinyRobot2", {}});
+  snapshot.bids = {"clean_3"};
+  for (const auto& id : {"delivery_1", "loop_2", "clean_3"})
+  {
+    rmf_task_msgs::msg::TaskProfile profile;
+    profile.task_id = id;
+    profile.description.priority.value = 1;
+    snapshot.task_profiles[id] = profile;
+  }
+
+  const auto encoded = encode_fleet_snapshot(snapshot);
+  CHECK(encoded == encode_fleet_snapshot(snapshot));
+
+  WHEN("The bytes are decoded")
+  {
+    const auto decoded = decode_fleet_snapshot(encoded, "test");
+    CHECK(decoded.fleet_name == snapshot.fleet_name);
+    REQUIRE(decoded.robots.size() == 2);
+    CHECK(decoded.robots[0].name == "tinyRobot1");
+    CHECK(decoded.robots[0].queue == snapshot.robots[0].queue);
+    CHECK(decoded.robots[1].queue.empty());
+    CHECK(decoded.bids == snapshot.bids);
+    REQUIRE(decoded.task_profiles.size() == 3);
+    CHECK(decoded.task_profiles.at("loop_2").task_id == "loop_2");
+    CHECK(decoded.task_profiles.at("clean_3").description.priority.value == 1);
+  }
+
+  WHEN("The bytes are corrupted")
+  {
+    auto corrupted = encoded;
+    corrupted.back() ^= 0xFF;
+    CHECK_THROWS_AS(
+      decode_fleet_snapshot(corrupted, "test"), FleetSnapshotError);
+
+    auto truncated = encoded;
+    truncated.resize(truncated.size()/2);
+    CHECK_THROWS_AS(
+      decode_fleet_snapshot(truncated, "test"), FleetSnapshotError);
+  }
+
+  WHEN("The snapshot is written to a file")
+  {
+    const std::string path = "/tmp/test_FleetSnapshot.bin";
+    std::remove(path.c_str());
+    CHECK_FALSE(read_fleet_snapshot(path).has_value());
+
+    write_fleet_snapshot(path, encoded);
+    const auto loaded = read_fleet_snapshot(path);
+    REQUIRE(loaded.has_value());
+    CHECK(encode_fleet_snapshot(*loaded) == encoded);
+    std::remove(path.c_str());
+  }
+}
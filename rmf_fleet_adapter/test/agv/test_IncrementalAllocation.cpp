@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/IncrementalAllocation.hpp>
+
+#include <rmf_battery/agv/BatterySystem.hpp>
+#include <rmf_battery/agv/SimpleMotionPowerSink.hpp>
+#include <rmf_battery/agv/SimpleDevicePowerSink.hpp>
+#include <rmf_task/BinaryPriorityScheme.hpp>
+#include <rmf_task/requests/Loop.hpp>
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <algorithm>
+
+namespace {
+using namespace std::chrono_literals;
+using rmf_fleet_adapter::agv::Assignments;
+using TaskPlanner = rmf_task::agv::TaskPlanner;
+
+//==============================================================================
+/// Five waypoints in a row, ten meters apart, with a charger at the first one
+std::shared_ptr<const rmf_traffic::agv::Planner> make_planner()
+{
+  rmf_traffic::agv::Graph graph;
+  for (std::size_t i = 0; i < 5; ++i)
+  {
+    graph.add_waypoint("L1", {10.0 * i, 0.0});
+    if (i > 0)
+    {
+      graph.add_lane(i-1, i);
+      graph.add_lane(i, i-1);
+    }
+  }
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3},
+    {1.0, 0.45},
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(0.5)
+    }
+  };
+
+  return std::make_shared<rmf_traffic::agv::Planner>(
+    rmf_traffic::agv::Planner::Configuration(graph, traits),
+    rmf_traffic::agv::Planner::Options(nullptr));
+}
+
+//==============================================================================
+std::shared_ptr<TaskPlanner> make_task_planner(
+  const std::shared_ptr<const rmf_traffic::agv::Planner>& planner,
+  const bool account_for_battery_drain)
+{
+  using BatterySystem = rmf_battery::agv::BatterySystem;
+  using PowerSystem = rmf_battery::agv::PowerSystem;
+  using MechanicalSystem = rmf_battery::agv::MechanicalSystem;
+  using SimpleMotionPowerSink = rmf_battery::agv::SimpleMotionPowerSink;
+  using SimpleDevicePowerSink = rmf_battery::agv::SimpleDevicePowerSink;
+
+  const auto battery_system = *BatterySystem::make(24.0, 40.0, 8.8);
+  const auto mechanical_system = *MechanicalSystem::make(70.0, 40.0, 0.22);
+  const auto motion_sink = std::make_shared<SimpleMotionPowerSink>(
+    battery_system, mechanical_system);
+  const auto ambient_sink = std::make_shared<SimpleDevicePowerSink>(
+    battery_system, *PowerSystem::make(20.0));
+  const auto tool_sink = std::make_shared<SimpleDevicePowerSink>(
+    battery_system, *PowerSystem::make(10.0));
+
+  const rmf_task::agv::Parameters parameters{
+    planner, battery_system, motion_sink, ambient_sink, tool_sink};
+  const rmf_task::agv::Constraints constraints{
+    0.2, 1.0, account_for_battery_drain};
+  const TaskPlanner::Configuration config{
+    parameters,
+    constraints,
+    rmf_task::BinaryPriorityScheme::make_cost_calculator()};
+
+  return std::make_shared<TaskPlanner>(
+    config, TaskPlanner::Options{false, nullptr, nullptr});
+}
+
+//==============================================================================
+rmf_task::ConstRequestPtr make_loop(
+  const std::string& id,
+  const std::size_t start,
+  const std::size_t finish,
+  const std::size_t num_loops,
+  const rmf_traffic::Time time)
+{
+  return rmf_task::requests::Loop::make(
+    start, finish, num_loops, id, time, nullptr);
+}
+
+//==============================================================================
+/// The ids that each robot has queued, leaving out the given one
+std::vector<std::vector<std::string>> queued_ids(
+  const Assignments& assignments,
+  const std::string& leave_out = "")
+{
+  std::vector<std::vector<std::string>> ids;
+  for (const auto& queue : assignments)
+  {
+    ids.emplace_back();
+    for (const auto& a : queue)
+    {
+      if (a.request()->id() != leave_out)
+        ids.back().push_back(a.request()->id());
+    }
+  }
+
+  return ids;
+}
+
+//==============================================================================
+TaskPlanner::Assignments plan(
+  const TaskPlanner& planner,
+  const rmf_traffic::Time time,
+  const std::vector<rmf_task::agv::State>& states,
+  const std::vector<rmf_task::ConstRequestPtr>& requests)
+{
+  const auto result = planner.plan(time, states, requests);
+  const auto* assignments = std::get_if<TaskPlanner::Assignments>(&result);
+  REQUIRE(assignments);
+  return *assignments;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Incremental allocation is checked against the full task planner")
+{
+  using rmf_fleet_adapter::agv::append_assignment;
+  using rmf_fleet_adapter::agv::optimization_improves;
+  using rmf_fleet_adapter::agv::plan_insertion;
+  using rmf_fleet_adapter::agv::plan_removal;
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto planner = make_planner();
+  const auto task_planner = make_task_planner(planner, false);
+
+  // One robot at each end of the row, both charging at the first waypoint
+  const std::vector<rmf_task::agv::State> states = {
+    rmf_task::agv::State{{now, 0, 0.0}, 0, 1.0},
+    rmf_task::agv::State{{now, 4, 0.0}, 0, 1.0}
+  };
+
+  const auto r1 = make_loop("r1", 0, 2, 1, now);
+  const auto r2 = make_loop("r2", 4, 2, 1, now);
+  const auto r3 = make_loop("r3", 1, 3, 2, now);
+
+  GIVEN("Robots with empty queues")
+  {
+    const Assignments empty(states.size());
+
+    THEN("Inserting a request costs the same as planning it")
+    {
+      const auto inserted = plan_insertion(
+        *task_planner, states, empty, r1, 2);
+      REQUIRE(inserted.has_value());
+
+      const auto planned = plan(*task_planner, now, states, {r1});
+      CHECK(task_planner->compute_cost(*inserted)
+        == Approx(task_planner->compute_cost(planned)));
+    }
+  }
+
+  GIVEN("Robots with requests already queued")
+  {
+    const auto current = plan(*task_planner, now, states, {r1, r2});
+    const auto inserted = plan_insertion(
+      *task_planner, states, current, r3, 2);
+    REQUIRE(inserted.has_value());
+
+    THEN("The insertion costs no less than planning every request")
+    {
+      const auto planned = plan(*task_planner, now, states, {r1, r2, r3});
+      CHECK(task_planner->compute_cost(*inserted)
+        >= Approx(task_planner->compute_cost(planned)));
+    }
+
+    THEN("The queued requests keep their order")
+    {
+      CHECK(queued_ids(*inserted, "r3") == queued_ids(current));
+    }
+
+    THEN("The result does not depend on the number of threads")
+    {
+      const auto single = plan_insertion(
+        *task_planner, states, current, r3, 1);
+      REQUIRE(single.has_value());
+      CHECK(queued_ids(*single) == queued_ids(*inserted));
+    }
+
+    WHEN("A request is removed")
+    {
+      const auto removed = plan_removal(
+        *task_planner, states, *inserted, "r3");
+      REQUIRE(removed.has_value());
+
+      THEN("The other requests keep their order")
+      {
+        CHECK(queued_ids(*removed) == queued_ids(*inserted, "r3"));
+      }
+    }
+
+    WHEN("The removed request is not queued")
+    {
+      THEN("The queues cannot be repaired")
+      {
+        CHECK_FALSE(
+          plan_removal(*task_planner, states, current, "r3").has_value());
+      }
+    }
+  }
+
+  GIVEN("A robot that must charge before it can take the request")
+  {
+    const auto draining_planner = make_task_planner(planner, true);
+    const std::vector<rmf_task::agv::State> low_states = {
+      rmf_task::agv::State{{now, 0, 0.0}, 0, 0.201}
+    };
+
+    const auto long_loop = make_loop("long_loop", 0, 4, 10, now);
+
+    THEN("Insertion fails so that the full planner can add the charging")
+    {
+      CHECK_FALSE(
+        plan_insertion(
+          *draining_planner, low_states, Assignments(1), long_loop, 1)
+        .has_value());
+
+      const auto planned =
+        plan(*draining_planner, now, low_states, {long_loop});
+      REQUIRE(planned.size() == 1);
+      const auto& queue = planned.front();
+      CHECK(std::any_of(queue.begin(), queue.end(),
+        [](const TaskPlanner::Assignment& a)
+        {
+          return a.request()->id() == "long_loop";
+        }));
+      CHECK(queue.size() > 1);
+    }
+  }
+
+  GIVEN("A background optimization")
+  {
+    // The same request queued for the robot next to it or the one at the
+    // far end of the row
+    Assignments near(states.size());
+    auto near_state = states[0];
+    REQUIRE(append_assignment(*task_planner, r1, near_state, near[0]));
+
+    Assignments far(states.size());
+    auto far_state = states[1];
+    REQUIRE(append_assignment(*task_planner, r1, far_state, far[1]));
+
+    REQUIRE(task_planner->compute_cost(near)
+      < task_planner->compute_cost(far));
+
+    THEN("Only a strictly cheaper result is adopted")
+    {
+      CHECK(optimization_improves(*task_planner, far, near));
+      CHECK_FALSE(optimization_improves(*task_planner, near, far));
+      CHECK_FALSE(optimization_improves(*task_planner, near, near));
+    }
+  }
+}
+
+//==============================================================================
+SCENARIO("Cancelling a queued request only replans the rest of its queue")
+{
+  using rmf_fleet_adapter::agv::append_assignment;
+  using rmf_fleet_adapter::agv::plan_removal;
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto task_planner = make_task_planner(make_planner(), false);
+
+  const std::vector<rmf_task::agv::State> states = {
+    rmf_task::agv::State{{now, 0, 0.0}, 0, 1.0},
+    rmf_task::agv::State{{now, 4, 0.0}, 0, 1.0}
+  };
+
+  const auto r1 = make_loop("r1", 0, 2, 1, now);
+  const auto r2 = make_loop("r2", 4, 2, 1, now);
+  const auto r3 = make_loop("r3", 1, 3, 2, now);
+
+  // The first robot does r1 and then r3, the second robot does r2
+  Assignments current(states.size());
+  auto state_0 = states[0];
+  REQUIRE(append_assignment(*task_planner, r1, state_0, current[0]));
+  REQUIRE(append_assignment(*task_planner, r3, state_0, current[0]));
+  auto state_1 = states[1];
+  REQUIRE(append_assignment(*task_planner, r2, state_1, current[1]));
+
+  WHEN("The first request of a queue is cancelled")
+  {
+    const auto removed = plan_removal(*task_planner, states, current, "r1");
+    REQUIRE(removed.has_value());
+
+    THEN("The rest of its queue is estimated again")
+    {
+      REQUIRE(queued_ids(*removed) == queued_ids(current, "r1"));
+      CHECK((*removed)[0][0].state().finish_time()
+        < current[0][1].state().finish_time());
+      CHECK(task_planner->compute_cost(*removed)
+        < task_planner->compute_cost(current));
+    }
+
+    THEN("The queues of the other robots are left alone")
+    {
+      REQUIRE((*removed)[1].size() == 1);
+      CHECK((*removed)[1][0].state().finish_time()
+        == current[1][0].state().finish_time());
+    }
+  }
+
+  WHEN("The last request of a queue is cancelled")
+  {
+    const auto removed = plan_removal(*task_planner, states, current, "r3");
+    REQUIRE(removed.has_value());
+
+    THEN("The requests before it keep their estimates")
+    {
+      REQUIRE((*removed)[0].size() == 1);
+      CHECK((*removed)[0][0].state().finish_time()
+        == current[0][0].state().finish_time());
+    }
+  }
+
+  WHEN("The only request of a queue is cancelled")
+  {
+    const auto removed = plan_removal(*task_planner, states, current, "r2");
+    REQUIRE(removed.has_value());
+
+    THEN("The robot is left with an empty queue")
+    {
+      CHECK((*removed)[1].empty());
+      CHECK(queued_ids(*removed)[0] == queued_ids(current)[0]);
+    }
+  }
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/LaneUpdate.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+//==============================================================================
+SCENARIO("Lane updates are applied as one change or not at all")
+{
+  using rmf_fleet_adapter::agv::make_lane_update;
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3}, {0.5, 1.5},
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(0.5)
+    }
+  };
+
+  rmf_traffic::agv::Graph graph;
+  for (std::size_t i = 0; i < 3; ++i)
+    graph.add_waypoint("L1", {10.0 * static_cast<double>(i), 0.0});
+
+  // Lanes 0 and 1 go forwards, lanes 2 and 3 go backwards
+  graph.add_lane(0, 1);
+  graph.add_lane(1, 2);
+  graph.add_lane(1, 0);
+  graph.add_lane(2, 1);
+
+  rmf_traffic::agv::Planner::Configuration config{graph, traits};
+  config.lane_closures().close(3);
+
+  const rmf_traffic::agv::Planner current{
+    config, rmf_traffic::agv::Planner::Options{nullptr}};
+
+  const auto closed = [](const rmf_traffic::agv::Planner& planner)
+    {
+      std::vector<std::size_t> lanes;
+      const auto& closures = planner.get_configuration().lane_closures();
+      for (std::size_t i = 0; i < 4; ++i)
+      {
+        if (closures.is_closed(i))
+          lanes.push_back(i);
+      }
+
+      return lanes;
+    };
+
+  const std::vector<std::size_t> originally_closed = {3};
+  REQUIRE(closed(current) == originally_closed);
+
+  WHEN("Lanes are opened and closed together")
+  {
+    const auto updated = make_lane_update(current, {3}, {0, 1});
+
+    THEN("One new planner has all of the changes")
+    {
+      REQUIRE(updated);
+      CHECK(closed(*updated) == std::vector<std::size_t>({0, 1}));
+      CHECK(closed(current) == originally_closed);
+    }
+  }
+
+  WHEN("A lane is both opened and closed")
+  {
+    const auto updated = make_lane_update(current, {0}, {0});
+
+    THEN("It ends up closed")
+    {
+      REQUIRE(updated);
+      CHECK(closed(*updated) == std::vector<std::size_t>({0, 3}));
+    }
+  }
+
+  WHEN("No lane changes state")
+  {
+    THEN("No new planner is built")
+    {
+      CHECK_FALSE(make_lane_update(current, {0, 1}, {3}));
+      CHECK_FALSE(make_lane_update(current, {}, {}));
+    }
+  }
+
+  WHEN("One of the lanes is not in the graph")
+  {
+    THEN("The whole update is rejected and the current planner is untouched")
+    {
+      CHECK_THROWS_AS(
+        make_lane_update(current, {3}, {0, 4}), std::runtime_error);
+      CHECK_THROWS_AS(
+        make_lane_update(current, {10}, {0}), std::runtime_error);
+      CHECK(closed(current) == originally_closed);
+    }
+  }
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <agv/LiftArrivalTimes.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+//==============================================================================
+SCENARIO("Learn the arrival times of lifts")
+{
+  using namespace std::chrono_literals;
+
+  rmf_fleet_adapter::agv::LiftArrivalTimes times(0.5);
+  CHECK_FALSE(times.arrival_time("lift"));
+
+  times.record("lift", 20s);
+  REQUIRE(times.arrival_time("lift"));
+  CHECK(*times.arrival_time("lift") == 20s);
+  CHECK_FALSE(times.arrival_time("other_lift"));
+
+  // New observations are blended into the estimate
+  times.record("lift", 10s);
+  REQUIRE(times.arrival_time("lift"));
+  CHECK(*times.arrival_time("lift") == 15s);
+
+  // Nonsense observations are ignored
+  times.record("lift", -5s);
+  CHECK(*times.arrival_time("lift") == 15s);
+}
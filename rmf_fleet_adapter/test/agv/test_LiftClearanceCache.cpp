@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <agv/LiftClearanceCache.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+//==============================================================================
+SCENARIO("Share lift clearance checks among robots")
+{
+  using namespace std::chrono_literals;
+  using Decision = rmf_fleet_adapter::agv::LiftClearanceCache::Decision;
+  using Decide = rmf_fleet_adapter::agv::LiftClearanceCache::Decide;
+
+  std::vector<std::pair<std::string, Decide>> evaluations;
+  const auto evaluate = [&](
+    const std::string&, const std::string& lift_name, Decide decide)
+    {
+      evaluations.push_back({lift_name, std::move(decide)});
+    };
+
+  std::vector<std::optional<Decision>> decisions(3);
+  const auto decide_for = [&](const std::size_t robot) -> Decide
+    {
+      return [&decisions, robot](Decision d) { decisions[robot] = d; };
+    };
+
+  GIVEN("A long validity window")
+  {
+    const auto cache =
+      rmf_fleet_adapter::agv::LiftClearanceCache::make(evaluate, 1h);
+
+    cache->check("robot_0", "lift", decide_for(0));
+    cache->check("robot_1", "lift", decide_for(1));
+    cache->check("robot_2", "other_lift", decide_for(2));
+
+    // The robots at the same lift share one check
+    REQUIRE(evaluations.size() == 2);
+    CHECK_FALSE(decisions[0]);
+    CHECK_FALSE(decisions[1]);
+
+    evaluations[0].second(Decision::Crowded);
+    REQUIRE(decisions[0]);
+    CHECK(*decisions[0] == Decision::Crowded);
+    REQUIRE(decisions[1]);
+    CHECK(*decisions[1] == Decision::Crowded);
+    CHECK_FALSE(decisions[2]);
+
+    // The decision is reused right away without another check
+    decisions[0] = std::nullopt;
+    cache->check("robot_0", "lift", decide_for(0));
+    REQUIRE(decisions[0]);
+    CHECK(*decisions[0] == Decision::Crowded);
+    CHECK(evaluations.size() == 2);
+
+    // Until it is invalidated
+    decisions[0] = std::nullopt;
+    cache->invalidate("lift");
+    cache->check("robot_0", "lift", decide_for(0));
+    CHECK_FALSE(decisions[0]);
+    REQUIRE(evaluations.size() == 3);
+
+    // Undefined decisions are passed along but never reused
+    evaluations[2].second(Decision::Undefined);
+    REQUIRE(decisions[0]);
+    CHECK(*decisions[0] == Decision::Undefined);
+    cache->check("robot_1", "lift", decide_for(1));
+    CHECK(evaluations.size() == 4);
+  }
+
+  GIVEN("No validity window")
+  {
+    const auto cache =
+      rmf_fleet_adapter::agv::LiftClearanceCache::make(evaluate, 0s);
+
+    cache->check("robot_0", "lift", decide_for(0));
+    evaluations[0].second(Decision::Clear);
+    REQUIRE(decisions[0]);
+    CHECK(*decisions[0] == Decision::Clear);
+
+    // Every new check goes to the evaluator
+    cache->check("robot_1", "lift", decide_for(1));
+    CHECK_FALSE(decisions[1]);
+    CHECK(evaluations.size() == 2);
+  }
+
+  GIVEN("A check that never replies")
+  {
+    const auto cache =
+      rmf_fleet_adapter::agv::LiftClearanceCache::make(evaluate, 1h, 0s);
+
+    cache->check("robot_0", "lift", decide_for(0));
+    cache->check("robot_1", "lift", decide_for(1));
+
+    // The second robot does not wait on the check that timed out
+    REQUIRE(evaluations.size() == 2);
+    evaluations[1].second(Decision::Clear);
+    CHECK_FALSE(decisions[0]);
+    REQUIRE(decisions[1]);
+    CHECK(*decisions[1] == Decision::Clear);
+
+    // A late reply still reaches the robot that was waiting on it
+    evaluations[0].second(Decision::Crowded);
+    REQUIRE(decisions[0]);
+    CHECK(*decisions[0] == Decision::Crowded);
+  }
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/ParallelFor.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using rmf_fleet_adapter::agv::parallel_for;
+
+//==============================================================================
+SCENARIO("Robots are evaluated across threads exactly once each")
+{
+  for (const std::size_t count : {0, 1, 7, 64})
+  {
+    for (const std::size_t threads : {0, 1, 3, 8, 100})
+    {
+      std::vector<std::atomic_size_t> calls(count);
+      parallel_for(count, threads, [&](const std::size_t i) { ++calls[i]; });
+
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        CAPTURE(count, threads, i);
+        CHECK(calls[i].load() == 1);
+      }
+    }
+  }
+
+  GIVEN("More than one thread")
+  {
+    const auto caller = std::this_thread::get_id();
+    std::vector<std::thread::id> ids(8);
+    parallel_for(8, 4, [&](const std::size_t i)
+      {
+        ids[i] = std::this_thread::get_id();
+      });
+
+    THEN("The caller takes the first chunk and the rest run elsewhere")
+    {
+      CHECK(ids[0] == caller);
+      CHECK(ids[1] == caller);
+      CHECK(ids[2] != caller);
+      CHECK(ids[7] != caller);
+    }
+  }
+
+  GIVEN("A single thread")
+  {
+    std::vector<std::size_t> order;
+    parallel_for(5, 1, [&](const std::size_t i) { order.push_back(i); });
+
+    THEN("Everything runs in order")
+    {
+      CHECK(order == std::vector<std::size_t>({0, 1, 2, 3, 4}));
+    }
+  }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/PhaseMetricsCollector.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+namespace rmf_fleet_adapter {
+namespace phases {
+// A stand-in for a phase type whose name should be shortened
+struct MockPhase
+{
+  struct Active {};
+};
+} // namespace phases
+} // namespace rmf_fleet_adapter
+
+using rmf_fleet_adapter::agv::PhaseMetricsCollector;
+
+//==============================================================================
+SCENARIO("Phase metrics are collected into histograms")
+{
+  using namespace std::chrono_literals;
+  using Stage = PhaseMetricsCollector::Stage;
+  const auto collector = std::make_shared<PhaseMetricsCollector>(
+    std::vector<rmf_traffic::Duration>{1s, 10s});
+
+  CHECK(collector->collect().empty());
+
+  collector->record("robot_a", "GoToPlace", Stage::Planning, 500ms);
+  collector->record("robot_a", "GoToPlace", Stage::Planning, 1s);
+  collector->record("robot_a", "GoToPlace", Stage::Planning, 4s);
+  collector->record("robot_a", "GoToPlace", Stage::Planning, 20s);
+  collector->record("robot_b", "GoToPlace", Stage::Planning, 2s);
+  collector->record("robot_a", "DoorOpen", Stage::DoorWait, 3s);
+
+  auto metrics = collector->collect();
+  REQUIRE(metrics.size() == 3);
+
+  const auto find = [&](const std::string& robot, const std::string& phase)
+    {
+      for (const auto& m : metrics)
+      {
+        if (m.robot == robot && m.phase == phase)
+          return m;
+      }
+
+      FAIL("Missing histogram for " << robot << " " << phase);
+      return PhaseMetricsCollector::Metrics();
+    };
+
+  const auto planning = find("robot_a", "GoToPlace");
+  CHECK(planning.stage == Stage::Planning);
+  CHECK(planning.count == 4);
+  CHECK(planning.total == 25500ms);
+  CHECK(planning.min == 500ms);
+  CHECK(planning.max == 20s);
+  REQUIRE(planning.bucket_counts.size() == 3);
+  CHECK(planning.bucket_counts[0] == 2);
+  CHECK(planning.bucket_counts[1] == 1);
+  CHECK(planning.bucket_counts[2] == 1);
+
+  CHECK(find("robot_b", "GoToPlace").count == 1);
+  CHECK(find("robot_a", "DoorOpen").stage == Stage::DoorWait);
+
+  // Each collection starts new histograms
+  CHECK(collector->collect().empty());
+
+  WHEN("Phases are recorded by their type")
+  {
+    const auto recorder = collector->execution_recorder("robot_a");
+    recorder(typeid(rmf_fleet_adapter::phases::MockPhase::Active), 5s);
+
+    metrics = collector->collect();
+    REQUIRE(metrics.size() == 1);
+    CHECK(metrics.front().phase == "MockPhase");
+    CHECK(metrics.front().stage == Stage::Execution);
+  }
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <agv/PlanStartIndex.hpp>
+
+#include <rmf_fleet_adapter/agv/parse_graph.hpp>
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <limits>
+#include <optional>
+
+//==============================================================================
+SCENARIO("Plan start index matches compute_plan_starts")
+{
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.5, 0.75},
+    {0.6, 2.0},
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(1.0)
+    }
+  };
+
+  const auto graph = rmf_fleet_adapter::agv::parse_graph(
+    TEST_RESOURCES_DIR "/office_nav.yaml", traits);
+  REQUIRE(graph.num_waypoints() > 0);
+
+  const std::string map = graph.get_waypoint(0).get_map_name();
+  const auto now = rmf_traffic::Time(std::chrono::seconds(100));
+
+  // Find the bounds of the map so we can sample positions over all of it
+  Eigen::Vector2d lower = graph.get_waypoint(0).get_location();
+  Eigen::Vector2d upper = lower;
+  for (std::size_t i = 0; i < graph.num_waypoints(); ++i)
+  {
+    const auto& wp = graph.get_waypoint(i);
+    if (wp.get_map_name() != map)
+      continue;
+
+    lower = lower.cwiseMin(wp.get_location());
+    upper = upper.cwiseMax(wp.get_location());
+  }
+
+  const auto check_same = [&](
+    const rmf_fleet_adapter::agv::PlanStartIndex& index,
+    const double waypoint_distance,
+    const double lane_distance)
+    {
+      std::size_t num_merged = 0;
+      for (double x = lower.x() - 2.0; x <= upper.x() + 2.0; x += 0.37)
+      {
+        for (double y = lower.y() - 2.0; y <= upper.y() + 2.0; y += 0.37)
+        {
+          const Eigen::Vector3d pose{x, y, 0.5};
+          const auto expected = rmf_traffic::agv::compute_plan_starts(
+            graph, map, pose, now, waypoint_distance, lane_distance, 1e-8);
+          const auto starts = index.compute_plan_starts(
+            map, pose, now, waypoint_distance, lane_distance, 1e-8);
+
+          REQUIRE(starts.size() == expected.size());
+          for (std::size_t i = 0; i < starts.size(); ++i)
+          {
+            CHECK(starts[i].waypoint() == expected[i].waypoint());
+            CHECK(starts[i].lane() == expected[i].lane());
+            CHECK(starts[i].orientation() == expected[i].orientation());
+          }
+
+          num_merged += starts.empty() ? 0 : 1;
+        }
+      }
+
+      // Make sure the samples covered some interesting cases
+      CHECK(num_merged > 0);
+    };
+
+  WHEN("The cell size is chosen automatically")
+  {
+    const rmf_fleet_adapter::agv::PlanStartIndex index(graph);
+    CHECK(index.cell_size() > 0.0);
+    check_same(index, 0.1, 1.0);
+    check_same(index, 1.5, 3.0);
+  }
+
+  WHEN("The cells are much smaller than the merge distances")
+  {
+    const rmf_fleet_adapter::agv::PlanStartIndex index(graph, 0.25);
+    check_same(index, 0.1, 1.0);
+    check_same(index, 1.5, 3.0);
+  }
+
+  WHEN("The cells are much larger than the map")
+  {
+    const rmf_fleet_adapter::agv::PlanStartIndex index(graph, 1000.0);
+    check_same(index, 0.1, 1.0);
+  }
+
+  CHECK(rmf_fleet_adapter::agv::PlanStartIndex(graph).compute_plan_starts(
+      "not a map", {0.0, 0.0, 0.0}, now, 0.1, 1.0, 1e-8).empty());
+
+  const auto check_nearest = [&](
+    const rmf_fleet_adapter::agv::PlanStartIndex& index)
+    {
+      for (double x = lower.x() - 20.0; x <= upper.x() + 20.0; x += 0.73)
+      {
+        for (double y = lower.y() - 20.0; y <= upper.y() + 20.0; y += 0.73)
+        {
+          const Eigen::Vector2d p{x, y};
+          std::optional<std::size_t> expected;
+          double expected_dist = std::numeric_limits<double>::infinity();
+          for (std::size_t i = 0; i < graph.num_waypoints(); ++i)
+          {
+            const auto& wp = graph.get_waypoint(i);
+            if (wp.get_map_name() != map)
+              continue;
+
+            const double dist = (p - wp.get_location()).norm();
+            if (dist < expected_dist)
+            {
+              expected = i;
+              expected_dist = dist;
+            }
+          }
+
+          const auto nearest = index.nearest_waypoint(map, p);
+          REQUIRE(nearest.has_value());
+          CHECK(nearest->first == *expected);
+          CHECK(nearest->second == Approx(expected_dist));
+        }
+      }
+    };
+
+  WHEN("Searching for the nearest waypoint")
+  {
+    check_nearest(rmf_fleet_adapter::agv::PlanStartIndex(graph));
+    check_nearest(rmf_fleet_adapter::agv::PlanStartIndex(graph, 0.25));
+    check_nearest(rmf_fleet_adapter::agv::PlanStartIndex(graph, 1000.0));
+
+    CHECK_FALSE(rmf_fleet_adapter::agv::PlanStartIndex(graph)
+      .nearest_waypoint("not a map", {0.0, 0.0}).has_value());
+  }
+}
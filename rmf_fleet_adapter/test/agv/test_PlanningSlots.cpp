@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/PlanningSlots.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+using rmf_fleet_adapter::agv::choose_planning_slot;
+using rmf_fleet_adapter::agv::use_priority_slot;
+
+//==============================================================================
+SCENARIO("Allocations queue up once every planning slot is in use")
+{
+  GIVEN("No planning slots yet")
+  {
+    THEN("A new slot is made")
+    {
+      CHECK(choose_planning_slot({}, 4) == 0);
+    }
+  }
+
+  GIVEN("A slot that is idle")
+  {
+    THEN("It is used instead of making a new one")
+    {
+      CHECK(choose_planning_slot({2, 0, 1}, 4) == 1);
+    }
+  }
+
+  GIVEN("Every slot is busy but the limit allows another one")
+  {
+    THEN("A new slot is made")
+    {
+      CHECK(choose_planning_slot({1, 2}, 4) == 2);
+    }
+  }
+
+  GIVEN("Every slot is busy and the limit has been reached")
+  {
+    THEN("The allocation waits on the least loaded slot")
+    {
+      CHECK(choose_planning_slot({3, 1, 2, 1}, 4) == 1);
+      CHECK(choose_planning_slot({2, 2, 2, 2}, 4) == 0);
+    }
+
+    THEN("A limit of zero still allows one slot")
+    {
+      CHECK(choose_planning_slot({}, 0) == 0);
+      CHECK(choose_planning_slot({5}, 0) == 0);
+    }
+  }
+
+  GIVEN("The limit was lowered below the number of slots")
+  {
+    THEN("The slots beyond the limit are not used")
+    {
+      CHECK(choose_planning_slot({3, 2, 0, 0}, 2) == 1);
+    }
+  }
+
+  GIVEN("An urgent allocation")
+  {
+    THEN("It stays on its slot if that slot is idle")
+    {
+      CHECK_FALSE(use_priority_slot(0, std::nullopt));
+      CHECK_FALSE(use_priority_slot(0, 0));
+    }
+
+    THEN("It skips the queue when the priority slot is less busy")
+    {
+      CHECK(use_priority_slot(3, std::nullopt));
+      CHECK(use_priority_slot(3, 0));
+      CHECK(use_priority_slot(3, 2));
+    }
+
+    THEN("It stays in the queue when the priority slot is as busy")
+    {
+      CHECK_FALSE(use_priority_slot(3, 3));
+      CHECK_FALSE(use_priority_slot(3, 4));
+    }
+  }
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/SharedSnapshots.hpp>
+
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+//==============================================================================
+SCENARIO("Share one snapshot per schedule version")
+{
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  rmf_fleet_adapter::agv::SharedSnapshots snapshots(database);
+
+  const auto first = snapshots.snapshot();
+  REQUIRE(first);
+  CHECK(snapshots.snapshot() == first);
+
+  rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(1.0)
+  };
+
+  auto participant = rmf_traffic::schedule::make_participant(
+    rmf_traffic::schedule::ParticipantDescription{
+      "participant",
+      "test_SharedSnapshots",
+      rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+      profile
+    },
+    database);
+
+  // A new version of the schedule gets a new snapshot, which is then shared
+  const auto second = snapshots.snapshot();
+  REQUIRE(second);
+  CHECK(second != first);
+  CHECK(second->latest_version() == database->latest_version());
+  CHECK(snapshots.snapshot() == second);
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <agv/StartedTaskIndex.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+using rmf_fleet_adapter::agv::StartedTaskIndex;
+
+//==============================================================================
+SCENARIO("Started tasks are indexed across robots")
+{
+  StartedTaskIndex index(2);
+  CHECK_FALSE(index.contains("task_1"));
+
+  index.started("robot_a", "task_1");
+  index.started("robot_b", "task_2");
+  CHECK(index.contains("task_1"));
+  CHECK(index.contains("task_2"));
+  CHECK(index.size() == 2);
+
+  WHEN("A robot starts more tasks than it remembers")
+  {
+    index.started("robot_a", "task_3");
+    index.started("robot_a", "task_4");
+
+    THEN("Its oldest task is forgotten")
+    {
+      CHECK_FALSE(index.contains("task_1"));
+      CHECK(index.contains("task_3"));
+      CHECK(index.contains("task_4"));
+    }
+
+    THEN("The history of the other robots is kept")
+    {
+      CHECK(index.contains("task_2"));
+      CHECK(index.size() == 3);
+    }
+  }
+
+  WHEN("The same task is started by two robots")
+  {
+    index.started("robot_b", "task_1");
+    index.started("robot_a", "task_5");
+    index.started("robot_a", "task_6");
+
+    THEN("It is remembered while either robot remembers it")
+    {
+      CHECK(index.contains("task_1"));
+      index.started("robot_b", "task_7");
+      index.started("robot_b", "task_8");
+      CHECK_FALSE(index.contains("task_1"));
+    }
+  }
+}
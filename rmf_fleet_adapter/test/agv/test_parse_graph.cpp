@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_fleet_adapter/agv/parse_graph.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+//==============================================================================
+SCENARIO("Compiled graphs match the yaml they were compiled from")
+{
+  using namespace rmf_fleet_adapter::agv;
+  namespace fs = std::filesystem;
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.5, 0.75},
+    {0.6, 2.0},
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(1.0)
+    }
+  };
+
+  const std::string yaml_file = "test_parse_graph_nav.yaml";
+  const std::string compiled_file = compiled_graph_file(yaml_file);
+  fs::copy_file(
+    TEST_RESOURCES_DIR "/office_nav.yaml", yaml_file,
+    fs::copy_options::overwrite_existing);
+  fs::remove(compiled_file);
+
+  const auto expected = parse_graph(yaml_file, traits);
+
+  compile_graph(yaml_file, compiled_file);
+  REQUIRE(fs::exists(compiled_file));
+
+  const auto check_same = [&](const rmf_traffic::agv::Graph& graph)
+    {
+      REQUIRE(graph.num_waypoints() == expected.num_waypoints());
+      REQUIRE(graph.num_lanes() == expected.num_lanes());
+      CHECK(graph.keys().size() == expected.keys().size());
+
+      for (std::size_t i = 0; i < graph.num_waypoints(); ++i)
+      {
+        const auto& wp = graph.get_waypoint(i);
+        const auto& expected_wp = expected.get_waypoint(i);
+        CHECK(wp.get_map_name() == expected_wp.get_map_name());
+        CHECK((wp.get_location() - expected_wp.get_location()).norm() == 0.0);
+        CHECK(wp.is_holding_point() == expected_wp.is_holding_point());
+        CHECK(wp.is_parking_spot() == expected_wp.is_parking_spot());
+        CHECK(wp.is_charger() == expected_wp.is_charger());
+      }
+
+      for (std::size_t i = 0; i < graph.num_lanes(); ++i)
+      {
+        const auto& lane = graph.get_lane(i);
+        const auto& expected_lane = expected.get_lane(i);
+        CHECK(lane.entry().waypoint_index()
+          == expected_lane.entry().waypoint_index());
+        CHECK(lane.exit().waypoint_index()
+          == expected_lane.exit().waypoint_index());
+        CHECK(static_cast<bool>(lane.entry().event())
+          == static_cast<bool>(expected_lane.entry().event()));
+      }
+    };
+
+  // The compiled file is newer than the yaml, so it will be used
+  bool warned = false;
+  check_same(
+    parse_graph(
+      yaml_file, traits, [&warned](const std::string&) { warned = true; }));
+  CHECK_FALSE(warned);
+
+  GIVEN("The yaml file is missing")
+  {
+    fs::remove(yaml_file);
+    check_same(parse_graph(yaml_file, traits));
+  }
+
+  GIVEN("A compiled file that has been corrupted")
+  {
+    {
+      std::fstream f(
+        compiled_file, std::ios::in | std::ios::out | std::ios::binary);
+      f.seekp(-1, std::ios::end);
+      f.put('\xFF');
+      f.put('\xFF');
+    }
+
+    // The corrupted file is ignored and the yaml gets parsed instead
+    std::vector<std::string> warnings;
+    check_same(
+      parse_graph(
+        yaml_file, traits,
+        [&warnings](const std::string& message)
+        {
+          warnings.push_back(message);
+        }));
+
+    REQUIRE(warnings.size() == 1);
+    CHECK(warnings.front().find(compiled_file) != std::string::npos);
+  }
+
+  fs::remove(yaml_file);
+  fs::remove(compiled_file);
+}
+
+//==============================================================================
+SCENARIO("Adding waypoints and lanes in bulk")
+{
+  using namespace rmf_fleet_adapter::agv;
+
+  rmf_traffic::agv::Graph graph;
+  graph.add_waypoint("L1", {0.0, 0.0});
+
+  const auto first_wp = add_waypoints(
+    graph, {"L1", "L2"}, {0, 1, 0},
+    {{1.0, 0.0}, {2.0, 0.0}, {3.0, 0.0}},
+    {HoldingPoint | Charger, 0, ParkingSpot});
+
+  CHECK(first_wp == 1);
+  REQUIRE(graph.num_waypoints() == 4);
+  CHECK(graph.get_waypoint(2).get_map_name() == "L2");
+  CHECK(graph.get_waypoint(3).get_location().x() == Approx(3.0));
+  CHECK(graph.get_waypoint(1).is_holding_point());
+  CHECK(graph.get_waypoint(1).is_charger());
+  CHECK_FALSE(graph.get_waypoint(2).is_holding_point());
+  CHECK(graph.get_waypoint(3).is_parking_spot());
+
+  const auto first_lane = add_lanes(
+    graph, {{0, 1}, {1, 3}}, {"door", ""}, {"", "dock"}, true);
+
+  CHECK(first_lane == 0);
+  REQUIRE(graph.num_lanes() == 4);
+  CHECK(graph.get_lane(0).entry().event());
+  CHECK(graph.get_lane(0).exit().event());
+  CHECK(graph.get_lane(1).entry().waypoint_index() == 1);
+  CHECK(graph.get_lane(1).entry().event());
+  CHECK(graph.get_lane(2).entry().event());
+  CHECK(graph.get_lane(3).entry().waypoint_index() == 3);
+  CHECK_FALSE(graph.get_lane(3).entry().event());
+
+  CHECK_THROWS(add_waypoints(graph, {"L1"}, {1}, {{0.0, 0.0}}));
+  CHECK_THROWS(add_lanes(graph, {{0, 4}}));
+  CHECK_THROWS(add_lanes(graph, {{0, 1}}, {"door"}, {"dock"}));
+  CHECK(graph.num_waypoints() == 4);
+  CHECK(graph.num_lanes() == 4);
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "../../src/lift_supervisor/RequestQueue.hpp"
+
+#include <rmf_utils/catch.hpp>
+
+using rmf_fleet_adapter::lift_supervisor::RequestQueue;
+using LiftRequest = RequestQueue::LiftRequest;
+using namespace std::chrono_literals;
+
+namespace {
+//==============================================================================
+LiftRequest::UniquePtr make_request(
+  const std::string& lift,
+  const std::string& session,
+  const std::string& floor = "L1",
+  uint8_t type = LiftRequest::REQUEST_AGV_MODE)
+{
+  auto request = std::make_unique<LiftRequest>();
+  request->lift_name = lift;
+  request->session_id = session;
+  request->destination_floor = floor;
+  request->request_type = type;
+  return request;
+}
+
+using Sessions = std::vector<std::string>;
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Lift sessions wait in line while their requesters keep asking")
+{
+  RequestQueue queue(10s);
+  const auto start = RequestQueue::Clock::now();
+
+  queue.push(make_request("lift", "A"), start);
+  queue.push(make_request("lift", "B"), start + 1s);
+  queue.push(make_request("lift", "C"), start + 2s);
+  queue.push(make_request("other_lift", "D"), start + 2s);
+
+  THEN("Each lift has its own line in the order of arrival")
+  {
+    CHECK(queue.sessions("lift") == Sessions({"A", "B", "C"}));
+    CHECK(queue.sessions("other_lift") == Sessions({"D"}));
+  }
+
+  WHEN("A session asks again")
+  {
+    queue.push(make_request("lift", "A", "L2"), start + 3s);
+
+    THEN("It keeps its place in line with its latest request")
+    {
+      CHECK(queue.sessions("lift") == Sessions({"A", "B", "C"}));
+      const auto next = queue.pop("lift", start + 3s);
+      REQUIRE(next);
+      CHECK(next->destination_floor == "L2");
+    }
+  }
+
+  WHEN("A session ends while it is waiting")
+  {
+    queue.push(
+      make_request("lift", "B", "", LiftRequest::REQUEST_END_SESSION),
+      start + 3s);
+
+    THEN("It leaves the line")
+    {
+      CHECK(queue.sessions("lift") == Sessions({"A", "C"}));
+    }
+  }
+
+  WHEN("The lift becomes free")
+  {
+    THEN("The sessions begin in the order that they arrived")
+    {
+      for (const auto& session : {"A", "B", "C"})
+      {
+        const auto next = queue.pop("lift", start + 3s);
+        REQUIRE(next);
+        CHECK(next->session_id == session);
+      }
+
+      CHECK_FALSE(queue.pop("lift", start + 3s));
+      CHECK(queue.sessions("other_lift") == Sessions({"D"}));
+    }
+  }
+
+  WHEN("A requester in the middle of the line stops asking")
+  {
+    // A and C keep asking, but B has gone somewhere else
+    queue.push(make_request("lift", "A"), start + 9s);
+    queue.push(make_request("lift", "C"), start + 9s);
+    queue.push(make_request("other_lift", "D"), start + 9s);
+    queue.prune(start + 12s);
+
+    THEN("It is pruned without waiting to reach the front")
+    {
+      CHECK(queue.sessions("lift") == Sessions({"A", "C"}));
+    }
+  }
+
+  WHEN("Every requester stops asking")
+  {
+    queue.prune(start + 20s);
+
+    THEN("Nothing is left to start")
+    {
+      CHECK(queue.empty());
+      CHECK_FALSE(queue.pop("lift", start + 20s));
+    }
+  }
+
+  WHEN("The lift becomes free after the front of the line expired")
+  {
+    queue.push(make_request("lift", "C"), start + 9s);
+
+    THEN("The expired requests are skipped instead of summoning the lift")
+    {
+      const auto next = queue.pop("lift", start + 12s);
+      REQUIRE(next);
+      CHECK(next->session_id == "C");
+      CHECK_FALSE(queue.pop("lift", start + 12s));
+    }
+  }
+}
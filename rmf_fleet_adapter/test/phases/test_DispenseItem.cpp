@@ -318,6 +318,89 @@ SCENARIO_METHOD(MockAdapterFixture, "dispense item phase", "[phases]")
   }
 }
 
+SCENARIO_METHOD(
+  MockAdapterFixture, "dispense item phase after an early request", "[phases]")
+{
+  const auto test = std::make_shared<TestData>();
+  auto rcl_subscription =
+    data->adapter->node()->create_subscription<DispenserRequest>(
+    DispenserRequestTopicName,
+    10,
+    [test](DispenserRequest::UniquePtr dispenser_request)
+    {
+      {
+        std::unique_lock<std::mutex> lk(test->m);
+        test->received_requests.emplace_back(*dispenser_request);
+      }
+      test->received_requests_cv.notify_all();
+    });
+
+  std::string request_guid = "test_guid";
+  std::vector<DispenserRequestItem> items;
+  DispenserRequestItem item;
+  item.type_guid = "test_item_type";
+  item.compartment_name = "test_compartment";
+  item.quantity = 1;
+  items.emplace_back(std::move(item));
+
+  const auto info = add_robot();
+  const auto& context = info.context;
+
+  auto result = std::make_shared<DispenserResult>();
+  result->request_guid = request_guid;
+  result->status = DispenserResult::SUCCESS;
+  result->time = data->ros_node->now();
+
+  PrenotifyDispenser::Handover handover;
+  handover.acknowledged = true;
+  handover.result = result;
+
+  auto active_phase = DispenseItem::ActivePhase::make(
+    context,
+    request_guid,
+    "test_dispenser",
+    "test_type",
+    items,
+    handover);
+
+  WHEN("it is started")
+  {
+    auto sub = active_phase->observe().subscribe(
+      [test](const auto& status)
+      {
+        {
+          std::unique_lock<std::mutex> lk(test->m);
+          test->status_updates.emplace_back(status);
+        }
+        test->status_updates_cv.notify_all();
+      });
+
+    THEN("it is completed by the answer to the early request")
+    {
+      std::unique_lock<std::mutex> lk(test->m);
+      bool completed = test->status_updates_cv.wait_for(
+        lk, std::chrono::milliseconds(100), [test]()
+        {
+          return test->last_state_value() == Task::StatusMsg::STATE_COMPLETED;
+        });
+      CHECK(completed);
+    }
+
+    THEN("it does not send the request again")
+    {
+      std::unique_lock<std::mutex> lk(test->m);
+      const bool received = test->received_requests_cv.wait_for(
+        lk, std::chrono::milliseconds(100), [test]()
+        {
+          return !test->received_requests.empty();
+        });
+      CHECK_FALSE(received);
+    }
+
+    sub.unsubscribe();
+  }
+}
+
 } // namespace test
 } // namespace phases
 } // namespace rmf_fleet_adapter
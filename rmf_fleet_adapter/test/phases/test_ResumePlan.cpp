@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <phases/ResumePlan.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+using namespace std::chrono_literals;
+
+//==============================================================================
+SCENARIO("A plan is resumed later only when its shifted remainder is clear")
+{
+  using rmf_fleet_adapter::phases::find_resume_waypoint;
+  using rmf_fleet_adapter::phases::resumed_itinerary_is_clear;
+
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3}, {0.5, 1.5}, profile
+  };
+
+  // A straight corridor along y = 0
+  const std::string map = "L1";
+  rmf_traffic::agv::Graph graph;
+  for (std::size_t i = 0; i < 4; ++i)
+    graph.add_waypoint(map, {10.0 * static_cast<double>(i), 0.0});
+
+  for (std::size_t i = 0; i + 1 < 4; ++i)
+  {
+    graph.add_lane(i, i+1);
+    graph.add_lane(i+1, i);
+  }
+
+  const rmf_traffic::agv::Planner planner{
+    rmf_traffic::agv::Planner::Configuration{graph, traits},
+    rmf_traffic::agv::Planner::Options{nullptr}
+  };
+
+  const auto start_time = rmf_traffic::Time(100s);
+  const std::size_t goal = 3;
+  const auto plan = planner.plan(
+    rmf_traffic::agv::Plan::Start(start_time, 0, 0.0),
+    rmf_traffic::agv::Plan::Goal(goal));
+  REQUIRE(plan);
+
+  const auto& waypoints = plan->get_waypoints();
+
+  // The robot stopped at waypoint 1 and is ready to leave 10 seconds late
+  std::optional<std::size_t> at_1;
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+  {
+    if (waypoints[i].graph_index() == 1)
+    {
+      at_1 = i;
+      break;
+    }
+  }
+  REQUIRE(at_1.has_value());
+
+  const auto time_offset = rmf_traffic::Duration(10s);
+  const auto now = waypoints[*at_1].time() + time_offset;
+  const rmf_traffic::agv::Plan::StartSet location = {
+    rmf_traffic::agv::Plan::Start(now, 1, 0.0)
+  };
+
+  const auto resume = find_resume_waypoint(waypoints, location, goal);
+  REQUIRE(resume.has_value());
+  CHECK(*resume == *at_1);
+
+  GIVEN("A robot that is partway along a lane")
+  {
+    const rmf_traffic::agv::Plan::StartSet on_lane = {
+      rmf_traffic::agv::Plan::Start(now, 1, 0.0, Eigen::Vector2d(12.0, 0.0))
+    };
+
+    CHECK_FALSE(find_resume_waypoint(waypoints, on_lane, goal).has_value());
+  }
+
+  GIVEN("A plan that does not lead to the goal")
+  {
+    CHECK_FALSE(find_resume_waypoint(waypoints, location, 2).has_value());
+  }
+
+  GIVEN("A robot that has already arrived")
+  {
+    const rmf_traffic::agv::Plan::StartSet arrived = {
+      rmf_traffic::agv::Plan::Start(now, goal, waypoints.back().position()[2])
+    };
+
+    CHECK_FALSE(find_resume_waypoint(waypoints, arrived, goal).has_value());
+  }
+
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  const auto make_participant = [&](const std::string& name)
+    {
+      return rmf_traffic::schedule::make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          name,
+          "test_ResumePlan",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile
+        },
+        database);
+    };
+
+  auto robot = make_participant("robot");
+  auto other = make_participant("other");
+
+  const rmf_traffic::agv::ScheduleRouteValidator validator(
+    *database, robot.id(), profile);
+
+  const auto park_other_at = [&](const std::size_t wp)
+    {
+      const auto p = graph.get_waypoint(wp).get_location();
+      rmf_traffic::Trajectory parked;
+      parked.insert(now - 1h, {p[0], p[1], 0.0}, Eigen::Vector3d::Zero());
+      parked.insert(now + 1h, {p[0], p[1], 0.0}, Eigen::Vector3d::Zero());
+      other.set({rmf_traffic::Route(map, std::move(parked))});
+    };
+
+  WHEN("Nothing is in the way")
+  {
+    THEN("The shifted plan is reused")
+    {
+      CHECK(resumed_itinerary_is_clear(
+          plan->get_itinerary(), time_offset, now, validator));
+    }
+  }
+
+  WHEN("Something is parked on the part of the plan already travelled")
+  {
+    park_other_at(0);
+
+    THEN("The shifted plan is still reused")
+    {
+      CHECK(resumed_itinerary_is_clear(
+          plan->get_itinerary(), time_offset, now, validator));
+    }
+  }
+
+  WHEN("Something is parked on the rest of the plan")
+  {
+    park_other_at(2);
+
+    THEN("The shifted plan conflicts, so a full replan is needed")
+    {
+      CHECK_FALSE(resumed_itinerary_is_clear(
+          plan->get_itinerary(), time_offset, now, validator));
+    }
+  }
+}
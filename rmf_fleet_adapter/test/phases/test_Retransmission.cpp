@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <phases/Retransmission.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <thread>
+
+using rmf_fleet_adapter::phases::Retransmission;
+
+//==============================================================================
+SCENARIO("Retransmission backs off and stops once acknowledged")
+{
+  using namespace std::chrono_literals;
+  Retransmission retransmission(100ms, 400ms);
+  retransmission.published();
+  CHECK_FALSE(retransmission.due());
+
+  std::this_thread::sleep_for(110ms);
+  CHECK(retransmission.due());
+  CHECK_FALSE(retransmission.due());
+
+  // The interval has doubled to 200ms
+  std::this_thread::sleep_for(110ms);
+  CHECK_FALSE(retransmission.due());
+  std::this_thread::sleep_for(150ms);
+  CHECK(retransmission.due());
+
+  WHEN("The request is acknowledged")
+  {
+    CHECK_FALSE(retransmission.acknowledged(true));
+    std::this_thread::sleep_for(500ms);
+    CHECK_FALSE(retransmission.due());
+
+    THEN("Losing the acknowledgement asks for a retransmission")
+    {
+      CHECK(retransmission.acknowledged(false));
+      CHECK_FALSE(retransmission.acknowledged(false));
+      CHECK_FALSE(retransmission.due());
+
+      // The interval is back to its initial value
+      std::this_thread::sleep_for(110ms);
+      CHECK(retransmission.due());
+    }
+  }
+}
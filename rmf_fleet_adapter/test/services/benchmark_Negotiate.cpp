@@ -0,0 +1,474 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Reproducible measurements of traffic negotiations. The scenarios are the
+// layouts of test_Negotiate.cpp, generalized so that they can be scaled to any
+// number of participants:
+//
+//   crossroads  Participants on the arms of a star each cross the hub to the
+//               next arm, like "Multi-participant negotiation".
+//   alcoves     Participants on both ends of a single lane with alcoves swap
+//               ends, like "A single lane with an alcove holding space".
+//   loop        Participants on a loop with alcoves at each vertex go to the
+//               opposite side, like "A single loop with alcoves at each
+//               vertex".
+//   bottleneck  Participants on two rows of docks that are joined by a single
+//               neck swap rows, like "fan-in-fan-out bottleneck".
+//
+// For every scenario and participant count it reports the time until the
+// negotiation concludes, the submissions, rejections and forfeits of the
+// participants, the planning jobs, planning steps and rollouts of the
+// negotiation services, and the peak memory of the process.
+//
+//   benchmark_Negotiate [--scenarios crossroads,loop] [--participants 2,3,4]
+//     [--repeat N] [--timeout seconds] [--compliant-leeway-base value]
+//     [--compliant-leeway-multiplier value] [--estimate-leeway value]
+//     [--max-cost-threshold value]
+//
+// The thresholds of the ProgressEvaluator default to the values that the
+// fleet adapter uses.
+
+#include "NegotiationRoom.hpp"
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+using namespace rmf_fleet_adapter_test;
+
+namespace {
+//==============================================================================
+const std::string MapName = "test_map";
+
+//==============================================================================
+struct Layout
+{
+  rmf_traffic::agv::Graph graph;
+
+  /// The start and goal waypoint of each participant
+  std::vector<std::pair<std::size_t, std::size_t>> trips;
+};
+
+using MakeLayout = std::function<Layout(std::size_t participants)>;
+
+//==============================================================================
+void add_bidir_lane(
+  rmf_traffic::agv::Graph& graph,
+  const std::size_t w0,
+  const std::size_t w1)
+{
+  graph.add_lane(w0, w1);
+  graph.add_lane(w1, w0);
+}
+
+//==============================================================================
+Layout crossroads(const std::size_t participants)
+{
+  Layout layout;
+  auto& graph = layout.graph;
+  const std::size_t hub = graph.add_waypoint(MapName, {0.0, 0.0}).index();
+
+  std::vector<std::size_t> ends;
+  for (std::size_t i = 0; i < participants; ++i)
+  {
+    const double angle = 2.0 * M_PI * i / participants;
+    const Eigen::Vector2d direction{std::cos(angle), std::sin(angle)};
+    const auto near = graph.add_waypoint(MapName, 5.0 * direction).index();
+    const auto end = graph.add_waypoint(MapName, 10.0 * direction)
+      .set_holding_point(true).index();
+
+    add_bidir_lane(graph, hub, near);
+    add_bidir_lane(graph, near, end);
+    ends.push_back(end);
+  }
+
+  for (std::size_t i = 0; i < participants; ++i)
+    layout.trips.push_back({ends[i], ends[(i+1) % participants]});
+
+  return layout;
+}
+
+//==============================================================================
+Layout alcoves(const std::size_t participants)
+{
+  Layout layout;
+  auto& graph = layout.graph;
+
+  // Each participant gets a waypoint on the lane at its own end, and there is
+  // an alcove at every other waypoint in between
+  const std::size_t length = 2 * participants + 1;
+  std::vector<std::size_t> lane;
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    lane.push_back(
+      graph.add_waypoint(MapName, {3.0 * i, 0.0})
+      .set_holding_point(true).index());
+
+    if (i > 0)
+      add_bidir_lane(graph, lane[i-1], lane[i]);
+
+    if (i % 2 == 1)
+    {
+      const auto alcove = graph.add_waypoint(MapName, {3.0 * i, 3.0})
+        .set_holding_point(true).index();
+      add_bidir_lane(graph, lane[i], alcove);
+    }
+  }
+
+  const std::size_t left = (participants + 1) / 2;
+  for (std::size_t i = 0; i < participants; ++i)
+  {
+    if (i < left)
+      layout.trips.push_back({lane[i], lane[length - 1 - i]});
+    else
+      layout.trips.push_back(
+        {lane[length - 1 - (i - left)], lane[i - left]});
+  }
+
+  return layout;
+}
+
+//==============================================================================
+Layout loop(const std::size_t participants)
+{
+  Layout layout;
+  auto& graph = layout.graph;
+
+  const std::size_t size = std::max<std::size_t>(4, 2 * participants);
+  const double radius = 3.0 * size / (2.0 * M_PI);
+  std::vector<std::size_t> ring;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    const double angle = 2.0 * M_PI * i / size;
+    const Eigen::Vector2d direction{std::cos(angle), std::sin(angle)};
+    ring.push_back(graph.add_waypoint(MapName, radius * direction).index());
+
+    const auto alcove = graph.add_waypoint(
+      MapName, (radius + 3.0) * direction).set_holding_point(true).index();
+    add_bidir_lane(graph, ring.back(), alcove);
+  }
+
+  for (std::size_t i = 0; i < size; ++i)
+    add_bidir_lane(graph, ring[i], ring[(i+1) % size]);
+
+  for (std::size_t i = 0; i < participants; ++i)
+  {
+    const std::size_t start = 2 * i % size;
+    layout.trips.push_back({ring[start], ring[(start + size/2) % size]});
+  }
+
+  return layout;
+}
+
+//==============================================================================
+Layout bottleneck(const std::size_t participants)
+{
+  Layout layout;
+  auto& graph = layout.graph;
+
+  // Two rows of docks that each feed a corridor. The corridors are joined by
+  // a neck through a single waypoint.
+  const std::size_t docks = std::max<std::size_t>(1, (participants + 1) / 2);
+  const double width = 3.0 * (docks - 1);
+  const auto make_row = [&](const double y_dock, const double y_corridor)
+    {
+      std::vector<std::size_t> row_docks;
+      std::vector<std::size_t> corridor;
+      for (std::size_t i = 0; i < docks; ++i)
+      {
+        const double x = 3.0 * i - width / 2.0;
+        row_docks.push_back(
+          graph.add_waypoint(MapName, {x, y_dock})
+          .set_parking_spot(true).index());
+        corridor.push_back(
+          graph.add_waypoint(MapName, {x, y_corridor})
+          .set_passthrough_point(true).index());
+
+        add_bidir_lane(graph, row_docks.back(), corridor.back());
+        if (i > 0)
+          add_bidir_lane(graph, corridor[i-1], corridor[i]);
+      }
+
+      return std::make_pair(row_docks, corridor[docks / 2]);
+    };
+
+  const auto top = make_row(6.0, 3.0);
+  const auto bottom = make_row(-6.0, -3.0);
+  const auto neck = graph.add_waypoint(MapName, {0.0, 0.0})
+    .set_passthrough_point(true).index();
+  add_bidir_lane(graph, top.second, neck);
+  add_bidir_lane(graph, bottom.second, neck);
+
+  for (std::size_t i = 0; i < participants; ++i)
+  {
+    const std::size_t dock = i / 2;
+    if (i % 2 == 0)
+      layout.trips.push_back({top.first[dock], bottom.first[docks - 1 - dock]});
+    else
+      layout.trips.push_back({bottom.first[dock], top.first[docks - 1 - dock]});
+  }
+
+  return layout;
+}
+
+//==============================================================================
+struct Options
+{
+  std::vector<std::string> scenarios = {
+    "crossroads", "alcoves", "loop", "bottleneck"};
+  std::vector<std::size_t> participants = {2, 3, 4};
+  std::size_t repeat = 1;
+  double timeout = 120.0;
+  rmf_fleet_adapter::services::ProgressEvaluator evaluator;
+};
+
+//==============================================================================
+std::vector<std::string> split(const std::string& list)
+{
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ','))
+  {
+    if (!item.empty())
+      items.push_back(item);
+  }
+
+  return items;
+}
+
+//==============================================================================
+Options parse(const int argc, char** argv)
+{
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    const std::string flag = argv[i];
+    const std::string value = argv[i+1];
+    if (flag == "--scenarios")
+      options.scenarios = split(value);
+    else if (flag == "--participants")
+    {
+      options.participants.clear();
+      for (const auto& n : split(value))
+        options.participants.push_back(std::stoul(n));
+    }
+    else if (flag == "--repeat")
+      options.repeat = std::max<std::size_t>(1, std::stoul(value));
+    else if (flag == "--timeout")
+      options.timeout = std::stod(value);
+    else if (flag == "--compliant-leeway-base")
+      options.evaluator.compliant_leeway_base = std::stod(value);
+    else if (flag == "--compliant-leeway-multiplier")
+      options.evaluator.compliant_leeway_multiplier = std::stod(value);
+    else if (flag == "--estimate-leeway")
+      options.evaluator.estimate_leeway = std::stod(value);
+    else if (flag == "--max-cost-threshold")
+      options.evaluator.max_cost_threshold = std::stod(value);
+    else
+      throw std::runtime_error("[benchmark_Negotiate] Unknown flag " + flag);
+  }
+
+  return options;
+}
+
+//==============================================================================
+/// Read a memory field of /proc/self/status, e.g. VmHWM, in megabytes
+double memory_megabytes(const std::string& field)
+{
+  std::ifstream file("/proc/self/status");
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (line.rfind(field + ":", 0) != 0)
+      continue;
+
+    std::istringstream value(line.substr(field.size() + 1));
+    double kilobytes = 0.0;
+    value >> kilobytes;
+    return kilobytes / 1024.0;
+  }
+
+  return 0.0;
+}
+
+//==============================================================================
+/// Reset the peak memory of the process to its current memory, so that the
+/// peak of each negotiation can be measured on its own
+void reset_peak_memory()
+{
+  std::ofstream file("/proc/self/clear_refs");
+  file << "5";
+}
+
+//==============================================================================
+struct Measurement
+{
+  std::string outcome;
+  double seconds = 0.0;
+  std::size_t submissions = 0;
+  std::size_t rejections = 0;
+  std::size_t forfeits = 0;
+  std::size_t planning_jobs = 0;
+  std::size_t planning_steps = 0;
+  std::size_t rollouts = 0;
+  double peak_megabytes = 0.0;
+};
+
+//==============================================================================
+Measurement measure(const Layout& layout, const Options& options)
+{
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(1.0)
+  };
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3},
+    {1.0, 0.45},
+    profile
+  };
+
+  const auto planner = std::make_shared<rmf_traffic::agv::Planner>(
+    rmf_traffic::agv::Planner::Configuration{layout.graph, traits},
+    rmf_traffic::agv::Plan::Options(nullptr));
+
+  auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  std::vector<rmf_traffic::schedule::Participant> participants;
+  TestPathNegotiator::Intentions intentions;
+  const auto now = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < layout.trips.size(); ++i)
+  {
+    participants.emplace_back(
+      rmf_traffic::schedule::make_participant(
+        rmf_traffic::schedule::ParticipantDescription{
+          "p" + std::to_string(i),
+          "benchmark_Negotiate",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile
+        },
+        database));
+
+    const auto& trip = layout.trips[i];
+    intentions.insert(
+      {participants.back().id(), {{now, trip.first, 0.0}, trip.second,
+          planner}});
+  }
+
+  const auto statistics = std::make_shared<TestPathNegotiator::Statistics>();
+  const auto room = std::make_shared<TestPathNegotiationRoom>(
+    database->snapshot(), intentions);
+  for (const auto& n : room->negotiators)
+    n.second->statistics(statistics).evaluator(options.evaluator);
+
+  reset_peak_memory();
+  const auto start = std::chrono::steady_clock::now();
+  auto future_proposal = room->solve();
+  const auto status = future_proposal.wait_for(
+    std::chrono::duration<double>(options.timeout));
+
+  Measurement m;
+  m.seconds = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  if (status != std::future_status::ready)
+    m.outcome = "timeout";
+  else
+    m.outcome = future_proposal.get().has_value() ? "success" : "failure";
+
+  m.submissions = room->submissions;
+  m.rejections = room->rejections;
+  m.forfeits = room->forfeits;
+  m.planning_jobs = statistics->planning_jobs;
+  m.planning_steps = statistics->planning_steps;
+  m.rollouts = statistics->rollouts;
+  m.peak_megabytes = memory_megabytes("VmHWM");
+  return m;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+int main(int argc, char** argv)
+{
+  const auto options = parse(argc, argv);
+
+  const std::map<std::string, MakeLayout> layouts = {
+    {"crossroads", crossroads},
+    {"alcoves", alcoves},
+    {"loop", loop},
+    {"bottleneck", bottleneck}
+  };
+
+  std::cout << std::left << std::setw(12) << "scenario" << std::right
+            << std::setw(4) << "n" << std::setw(9) << "outcome"
+            << std::setw(11) << "time[ms]" << std::setw(8) << "submit"
+            << std::setw(8) << "reject" << std::setw(9) << "forfeit"
+            << std::setw(7) << "jobs" << std::setw(9) << "steps"
+            << std::setw(9) << "rollout" << std::setw(11) << "peak[MB]"
+            << std::endl;
+
+  bool all_succeeded = true;
+  for (const auto& name : options.scenarios)
+  {
+    const auto it = layouts.find(name);
+    if (it == layouts.end())
+    {
+      std::cerr << "Unknown scenario [" << name << "]" << std::endl;
+      return 1;
+    }
+
+    for (const auto n : options.participants)
+    {
+      const auto layout = it->second(n);
+      bool timed_out = false;
+      for (std::size_t r = 0; r < options.repeat; ++r)
+      {
+        const auto m = measure(layout, options);
+        std::cout << std::left << std::setw(12) << name << std::right
+                  << std::setw(4) << n << std::setw(9) << m.outcome
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(11) << 1000.0 * m.seconds
+                  << std::setw(8) << m.submissions
+                  << std::setw(8) << m.rejections
+                  << std::setw(9) << m.forfeits
+                  << std::setw(7) << m.planning_jobs
+                  << std::setw(9) << m.planning_steps
+                  << std::setw(9) << m.rollouts
+                  << std::setw(11) << m.peak_megabytes << std::endl;
+
+        all_succeeded &= m.outcome == "success";
+        timed_out |= m.outcome == "timeout";
+      }
+
+      // A negotiation that timed out is still running in the background, and
+      // a larger one would only take longer
+      if (timed_out)
+        break;
+    }
+  }
+
+  return all_succeeded ? 0 : 1;
+}
@@ -284,6 +284,80 @@ SCENARIO("Find a path")
 
     CHECK(at_least_one_conflict);
   }
+
+  WHEN("The same leg is planned repeatedly with a plan cache")
+  {
+    const auto cache = std::make_shared<rmf_fleet_adapter::jobs::PlanCache>();
+    const auto goal = rmf_traffic::agv::Plan::Goal(7);
+
+    const auto find_path = [&](const rmf_traffic::Time start_time)
+      {
+        auto path_service =
+          std::make_shared<rmf_fleet_adapter::services::FindPath>(
+          planner, rmf_traffic::agv::Plan::StartSet(
+            {rmf_traffic::agv::Plan::Start(start_time, 3, 0.0)}),
+          goal, database->snapshot(), p1.id(),
+          std::make_shared<rmf_traffic::Profile>(p1.description().profile()),
+          cache);
+
+        std::promise<rmf_traffic::agv::Plan::Result> promise;
+        auto future = promise.get_future();
+        auto sub =
+          rmf_rxcpp::make_job<rmf_fleet_adapter::services::FindPath::Result>(
+          path_service)
+          .observe_on(rxcpp::observe_on_event_loop())
+          .subscribe(
+          [&promise](const auto& result)
+          {
+            promise.set_value(result);
+          });
+
+        REQUIRE(std::future_status::ready == future.wait_for(1s));
+        return future.get();
+      };
+
+    const auto first = find_path(now);
+    REQUIRE(first.success());
+    CHECK(cache->size() == 1);
+
+    const auto second = find_path(now + 10min);
+    REQUIRE(second.success());
+    CHECK(cache->size() == 1);
+    CHECK(second->get_cost() == Approx(first->get_cost()));
+
+    const auto start = rmf_traffic::agv::Plan::Start(now, 3, 0.0);
+
+    THEN("A new planner with the same lane closures keeps the cache")
+    {
+      const auto other_planner = std::make_shared<rmf_traffic::agv::Planner>(
+        configuration, rmf_traffic::agv::Planner::Options{nullptr});
+
+      CHECK(cache->greedy_cost(other_planner, start, goal));
+    }
+
+    THEN("Closing a lane along the path invalidates the cached cost")
+    {
+      auto closed_config = configuration;
+      closed_config.lane_closures().close(graph.lane_from(5, 6)->index());
+      const auto closed_planner = std::make_shared<rmf_traffic::agv::Planner>(
+        closed_config, rmf_traffic::agv::Planner::Options{nullptr});
+
+      CHECK_FALSE(cache->greedy_cost(closed_planner, start, goal));
+      CHECK(cache->size() == 0);
+
+      AND_THEN("Opening it again invalidates costs found while it was closed")
+      {
+        const auto detour = closed_planner->plan(start, goal);
+        REQUIRE(detour);
+        cache->greedy_cost(closed_planner, start, goal, *detour);
+        CHECK(cache->greedy_cost(closed_planner, start, goal));
+
+        const auto open_planner = std::make_shared<rmf_traffic::agv::Planner>(
+          configuration, rmf_traffic::agv::Planner::Options{nullptr});
+        CHECK_FALSE(cache->greedy_cost(open_planner, start, goal));
+      }
+    }
+  }
 }
 
 //==============================================================================
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <services/NegotiationAdmission.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+using rmf_fleet_adapter::services::NegotiationAdmission;
+
+//==============================================================================
+SCENARIO("Negotiation admission limits the concurrent responders")
+{
+  using namespace std::chrono_literals;
+  const auto admission = NegotiationAdmission::make(2, 2);
+
+  std::vector<std::string> started;
+  std::vector<std::string> shed;
+  std::vector<NegotiationAdmission::Ticket> tickets;
+  bool defunct = false;
+
+  const auto request = [&](
+    const std::string& name,
+    const std::size_t depth,
+    const NegotiationAdmission::Clock::duration deadline)
+    {
+      NegotiationAdmission::Request r;
+      r.depth = depth;
+      r.deadline = NegotiationAdmission::Clock::now() + deadline;
+      r.defunct = [&defunct, name]() { return defunct && name == "defunct"; };
+      r.start = [&, name](NegotiationAdmission::Ticket ticket)
+        {
+          started.push_back(name);
+          tickets.push_back(std::move(ticket));
+        };
+      r.shed = [&shed, name]() { shed.push_back(name); };
+      return r;
+    };
+
+  // Releasing a ticket may start another request, which adds a ticket, so
+  // take the ticket out of the vector before letting go of it.
+  const auto release = [&](const std::size_t i)
+    {
+      const auto ticket = std::move(tickets[i]);
+      tickets.erase(tickets.begin() + i);
+    };
+
+  admission->submit(request("a", 1, 10s));
+  admission->submit(request("b", 1, 10s));
+  CHECK(started == std::vector<std::string>{"a", "b"});
+  CHECK(admission->active() == 2);
+
+  admission->submit(request("shallow", 1, 10s));
+  admission->submit(request("urgent", 1, 5s));
+  admission->submit(request("deep", 3, 10s));
+  CHECK(admission->queued() == 2);
+  REQUIRE(shed.size() == 1);
+  CHECK(shed.front() == "shallow");
+
+  release(0);
+  CHECK(started.back() == "deep");
+  release(0);
+  CHECK(started.back() == "urgent");
+  CHECK(admission->active() == 2);
+  CHECK(admission->queued() == 0);
+
+  WHEN("A queued table becomes defunct")
+  {
+    admission->submit(request("defunct", 2, 10s));
+    defunct = true;
+    release(1);
+    release(0);
+    CHECK(started.back() == "urgent");
+    CHECK(shed.size() == 1);
+    CHECK(admission->active() == 0);
+    CHECK(admission->queued() == 0);
+  }
+
+  WHEN("A queued table misses its deadline")
+  {
+    admission->submit(request("late", 2, -1s));
+    CHECK(shed.back() == "late");
+    CHECK(admission->queued() == 0);
+  }
+
+  WHEN("The limit is lifted")
+  {
+    admission->submit(request("waiting", 2, 10s));
+    admission->max_concurrent(std::nullopt);
+    CHECK(started.back() == "waiting");
+    CHECK(admission->active() == 3);
+  }
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <services/NegotiationArena.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+using rmf_fleet_adapter::services::NegotiationArena;
+
+namespace {
+//==============================================================================
+struct Payload : std::enable_shared_from_this<Payload>
+{
+  Payload(int v)
+  : value(v)
+  {
+    // Do nothing
+  }
+
+  int value;
+  std::array<double, 16> data = {};
+};
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Negotiation arena recycles the memory of its objects")
+{
+  auto arena = NegotiationArena::make();
+  CHECK(arena->bytes_in_use() == 0);
+
+  std::vector<std::shared_ptr<Payload>> payloads;
+  std::vector<const void*> addresses;
+  for (int i = 0; i < 10; ++i)
+  {
+    payloads.push_back(arena->make_shared<Payload>(i));
+    addresses.push_back(payloads.back().get());
+  }
+
+  CHECK(arena->bytes_in_use() >= 10 * sizeof(Payload));
+  CHECK(payloads[3]->value == 3);
+  CHECK(payloads[3]->shared_from_this() == payloads[3]);
+
+  WHEN("The objects are dropped")
+  {
+    payloads.clear();
+    CHECK(arena->bytes_in_use() == 0);
+
+    THEN("New objects reuse the memory of the old ones")
+    {
+      const auto reused = arena->make_shared<Payload>(42);
+      CHECK(reused->value == 42);
+      CHECK(std::find(addresses.begin(), addresses.end(), reused.get())
+        != addresses.end());
+    }
+  }
+
+  WHEN("The arena is dropped before its objects")
+  {
+    std::weak_ptr<NegotiationArena> weak = arena;
+    arena.reset();
+    CHECK_FALSE(weak.expired());
+    CHECK(payloads[7]->value == 7);
+
+    payloads.clear();
+    CHECK(weak.expired());
+  }
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <services/NegotiationMemo.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+#include <rmf_traffic/schedule/Negotiator.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+using rmf_fleet_adapter::services::NegotiationMemo;
+
+namespace {
+//==============================================================================
+rmf_traffic::schedule::ParticipantDescription make_description(
+  const std::string& name,
+  const rmf_traffic::Profile& profile)
+{
+  return rmf_traffic::schedule::ParticipantDescription{
+    name,
+    "test_NegotiationMemo",
+    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+    profile
+  };
+}
+
+//==============================================================================
+std::vector<rmf_traffic::Route> stay_at(
+  const Eigen::Vector2d& p,
+  const rmf_traffic::Time start,
+  const rmf_traffic::Duration duration)
+{
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {p.x(), p.y(), 0.0}, Eigen::Vector3d::Zero());
+  trajectory.insert(
+    start + duration, {p.x(), p.y(), 0.0}, Eigen::Vector3d::Zero());
+
+  return {rmf_traffic::Route("test_map", std::move(trajectory))};
+}
+
+//==============================================================================
+void submit(
+  const rmf_traffic::schedule::Negotiation::TablePtr& table,
+  std::vector<rmf_traffic::Route> itinerary)
+{
+  REQUIRE(table);
+  rmf_traffic::schedule::SimpleResponder(table).submit(
+    std::move(itinerary),
+    []() -> rmf_utils::optional<rmf_traffic::schedule::ItineraryVersion>
+    {
+      return rmf_utils::nullopt;
+    });
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Negotiation memo recalls plans for sibling tables")
+{
+  using namespace std::chrono_literals;
+
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3},
+    {1.0, 0.45},
+    profile
+  };
+
+  rmf_traffic::agv::Graph graph;
+  graph.add_waypoint("test_map", {0.0, 0.0});
+  graph.add_waypoint("test_map", {10.0, 0.0});
+  graph.add_lane(0, 1);
+  graph.add_lane(1, 0);
+
+  const rmf_traffic::agv::Planner planner{
+    rmf_traffic::agv::Planner::Configuration{graph, traits},
+    rmf_traffic::agv::Planner::Options{nullptr}
+  };
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto result = planner.plan(
+    rmf_traffic::agv::Plan::Start(now, 0, 0.0),
+    rmf_traffic::agv::Plan::Goal(1));
+  REQUIRE(result.success());
+  const rmf_traffic::agv::Plan plan = *result;
+
+  const auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  auto p0 = rmf_traffic::schedule::make_participant(
+    make_description("p0", profile), database);
+  auto p1 = rmf_traffic::schedule::make_participant(
+    make_description("p1", profile), database);
+  auto p2 = rmf_traffic::schedule::make_participant(
+    make_description("p2", profile), database);
+
+  const auto negotiation = rmf_traffic::schedule::Negotiation::make_shared(
+    database, {p0.id(), p1.id(), p2.id()});
+
+  // p0 and p1 stay far away from each other and from the plan of p2, so their
+  // proposals are the same no matter who goes first.
+  const auto p0_itinerary = stay_at({0.0, 50.0}, now, 60s);
+  const auto p1_itinerary = stay_at({10.0, 50.0}, now, 60s);
+
+  submit(negotiation->table(p0.id(), {}), p0_itinerary);
+  submit(negotiation->table(p1.id(), {p0.id()}), p1_itinerary);
+  submit(negotiation->table(p1.id(), {}), p1_itinerary);
+  submit(negotiation->table(p0.id(), {p1.id()}), p0_itinerary);
+
+  const auto first = negotiation->table(p2.id(), {p0.id(), p1.id()});
+  const auto sibling = negotiation->table(p2.id(), {p1.id(), p0.id()});
+  const auto cousin = negotiation->table(p2.id(), {p0.id()});
+  REQUIRE(first);
+  REQUIRE(sibling);
+  REQUIRE(cousin);
+
+  NegotiationMemo memo(16, 3s);
+  CHECK_FALSE(memo.recall(sibling->viewer(), profile, 0, now));
+
+  memo.remember(first->viewer(), 0, now, plan);
+  CHECK(memo.size() == 1);
+
+  WHEN("A sibling table has the same proposals")
+  {
+    const auto recalled = memo.recall(sibling->viewer(), profile, 0, now + 1s);
+    REQUIRE(recalled);
+    CHECK(recalled->get_itinerary().size() == plan.get_itinerary().size());
+  }
+
+  WHEN("A table has different proposals")
+  {
+    CHECK_FALSE(memo.recall(cousin->viewer(), profile, 0, now));
+  }
+
+  WHEN("The robot has started a new itinerary")
+  {
+    CHECK_FALSE(memo.recall(sibling->viewer(), profile, 1, now));
+    CHECK(memo.size() == 0);
+  }
+
+  WHEN("The plan is too old")
+  {
+    CHECK_FALSE(memo.recall(sibling->viewer(), profile, 0, now + 5s));
+    CHECK(memo.size() == 0);
+  }
+
+  WHEN("The plan conflicts with the proposals of the table")
+  {
+    const auto blocking = rmf_traffic::schedule::Negotiation::make_shared(
+      database, {p0.id(), p2.id()});
+
+    submit(blocking->table(p0.id(), {}), stay_at({10.0, 0.0}, now, 60s));
+    const auto blocked = blocking->table(p2.id(), {p0.id()});
+    REQUIRE(blocked);
+
+    memo.remember(blocked->viewer(), 0, now, plan);
+    CHECK_FALSE(memo.recall(blocked->viewer(), profile, 0, now));
+  }
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <services/PulloverCandidates.hpp>
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+//==============================================================================
+SCENARIO("Pullover candidates are ranked by travel distance")
+{
+  using Candidates = std::vector<std::size_t>;
+
+  const std::string test_map_name = "test_map";
+  rmf_traffic::agv::Graph graph;
+  graph.add_waypoint(test_map_name, {0.0, 0.0}).set_parking_spot(true); // 0
+  graph.add_waypoint(test_map_name, {5.0, 0.0}); // 1
+  graph.add_waypoint(test_map_name, {10.0, 0.0}); // 2
+  graph.add_waypoint(test_map_name, {15.0, 0.0}).set_parking_spot(true); // 3
+  graph.add_waypoint(test_map_name, {20.0, 0.0}).set_parking_spot(true); // 4
+  graph.add_waypoint(test_map_name, {0.0, 10.0}); // 5
+
+  /*
+   *   5
+   *
+   *   0(P)----1------2------3(P)---4(P)
+   */
+
+  auto add_bidir_lane = [&](const std::size_t w0, const std::size_t w1)
+    {
+      graph.add_lane(w0, w1);
+      graph.add_lane(w1, w0);
+    };
+
+  add_bidir_lane(0, 1); // lanes 0 and 1
+  add_bidir_lane(1, 2); // lanes 2 and 3
+  add_bidir_lane(2, 3); // lanes 4 and 5
+  add_bidir_lane(3, 4); // lanes 6 and 7
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3},
+    {1.0, 0.45},
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(1.0)
+    }
+  };
+
+  rmf_traffic::agv::Planner::Configuration configuration{graph, traits};
+  const auto planner = std::make_shared<rmf_traffic::agv::Planner>(
+    configuration, rmf_traffic::agv::Planner::Options{nullptr});
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto start_at = [&](const std::size_t wp)
+    {
+      return rmf_traffic::agv::Plan::Start(now, wp, 0.0);
+    };
+
+  rmf_fleet_adapter::services::PulloverCandidates candidates(2);
+  candidates.update(planner);
+
+  WHEN("The robot is on a waypoint")
+  {
+    CHECK(candidates.candidates(planner, {start_at(1)}) == Candidates{0, 3});
+    CHECK(candidates.candidates(planner, {start_at(3)}) == Candidates{3, 4});
+  }
+
+  WHEN("The robot is between waypoints")
+  {
+    const auto start = rmf_traffic::agv::Plan::Start(
+      now, 2, 0.0, Eigen::Vector2d(6.0, 0.0));
+    CHECK(candidates.candidates(planner, {start}) == Candidates{3, 0});
+  }
+
+  WHEN("The robot has several starts")
+  {
+    rmf_fleet_adapter::services::PulloverCandidates more(3);
+    CHECK(more.candidates(planner, {start_at(1), start_at(3)})
+      == Candidates{3, 0, 4});
+  }
+
+  WHEN("No parking spot can be reached")
+  {
+    CHECK(candidates.candidates(planner, {start_at(5)}).empty());
+  }
+
+  WHEN("A lane is closed")
+  {
+    auto closed_configuration = configuration;
+    closed_configuration.lane_closures().close(1);
+    const auto closed_planner = std::make_shared<rmf_traffic::agv::Planner>(
+      closed_configuration, rmf_traffic::agv::Planner::Options{nullptr});
+
+    // The ranking is recomputed for the new planner even without an update
+    CHECK(candidates.candidates(closed_planner, {start_at(1)})
+      == Candidates{3, 4});
+    CHECK(candidates.candidates(closed_planner, {start_at(0)})
+      == Candidates{0, 3});
+  }
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <services/RolloutCache.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+#include <rmf_traffic/schedule/Negotiator.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+#include <future>
+
+using rmf_fleet_adapter::services::RolloutCache;
+
+namespace {
+//==============================================================================
+rmf_traffic::schedule::ParticipantDescription make_description(
+  const std::string& name,
+  const rmf_traffic::Profile& profile)
+{
+  return rmf_traffic::schedule::ParticipantDescription{
+    name,
+    "test_RolloutCache",
+    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+    profile
+  };
+}
+
+//==============================================================================
+std::vector<rmf_traffic::Route> stay_at(
+  const Eigen::Vector2d& p,
+  const rmf_traffic::Time start,
+  const rmf_traffic::Duration duration)
+{
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {p.x(), p.y(), 0.0}, Eigen::Vector3d::Zero());
+  trajectory.insert(
+    start + duration, {p.x(), p.y(), 0.0}, Eigen::Vector3d::Zero());
+
+  return {rmf_traffic::Route("test_map", std::move(trajectory))};
+}
+
+//==============================================================================
+void submit(
+  const rmf_traffic::schedule::Negotiation::TablePtr& table,
+  std::vector<rmf_traffic::Route> itinerary)
+{
+  REQUIRE(table);
+  rmf_traffic::schedule::SimpleResponder(table).submit(
+    std::move(itinerary),
+    []() -> rmf_utils::optional<rmf_traffic::schedule::ItineraryVersion>
+    {
+      return rmf_utils::nullopt;
+    });
+}
+
+//==============================================================================
+struct Request
+{
+  bool started;
+  std::future<std::size_t> alternatives;
+};
+
+//==============================================================================
+Request request(
+  RolloutCache& cache,
+  const rmf_traffic::schedule::Negotiation::TablePtr& table,
+  const rmf_traffic::agv::Planner::Result& source)
+{
+  using namespace std::chrono_literals;
+
+  auto promise = std::make_shared<std::promise<std::size_t>>();
+  auto future = promise->get_future();
+  const bool started = cache.request(
+    table->viewer(), source, 15s, 10, 1s,
+    []() { return true; },
+    [promise](const RolloutCache::Alternatives& alternatives)
+    {
+      promise->set_value(alternatives.size());
+    });
+
+  return Request{started, std::move(future)};
+}
+
+//==============================================================================
+bool ready(
+  const std::future<std::size_t>& future,
+  const rmf_traffic::Duration wait)
+{
+  return future.wait_for(wait) == std::future_status::ready;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Rollout cache shares alternatives between tables")
+{
+  using namespace std::chrono_literals;
+
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3},
+    {1.0, 0.45},
+    profile
+  };
+
+  rmf_traffic::agv::Graph graph;
+  graph.add_waypoint("test_map", {0.0, 0.0});
+  graph.add_waypoint("test_map", {10.0, 0.0});
+  graph.add_lane(0, 1);
+  graph.add_lane(1, 0);
+
+  const rmf_traffic::agv::Planner planner{
+    rmf_traffic::agv::Planner::Configuration{graph, traits},
+    rmf_traffic::agv::Planner::Options{nullptr}
+  };
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto source = planner.setup(
+    rmf_traffic::agv::Plan::Start(now, 0, 0.0),
+    rmf_traffic::agv::Plan::Goal(1));
+
+  const auto database = std::make_shared<rmf_traffic::schedule::Database>();
+  auto p0 = rmf_traffic::schedule::make_participant(
+    make_description("p0", profile), database);
+  auto p1 = rmf_traffic::schedule::make_participant(
+    make_description("p1", profile), database);
+  auto p2 = rmf_traffic::schedule::make_participant(
+    make_description("p2", profile), database);
+
+  // The blocker p0 proposes something different in each negotiation, but it
+  // is masked out of the rollout, so both tables need the same alternatives.
+  const auto first_negotiation =
+    rmf_traffic::schedule::Negotiation::make_shared(
+    database, {p0.id(), p1.id(), p2.id()});
+  submit(
+    first_negotiation->table(p0.id(), {}), stay_at({10.0, 0.0}, now, 60s));
+
+  const auto second_negotiation =
+    rmf_traffic::schedule::Negotiation::make_shared(
+    database, {p0.id(), p2.id()});
+  submit(
+    second_negotiation->table(p0.id(), {}), stay_at({5.0, 0.0}, now, 60s));
+
+  const auto first = first_negotiation->table(p2.id(), {p0.id()});
+  const auto second = second_negotiation->table(p2.id(), {p0.id()});
+  REQUIRE(first);
+  REQUIRE(second);
+
+  // The proposal of p1 does constrain the rollout, so this table needs its
+  // own alternatives.
+  submit(
+    first_negotiation->table(p1.id(), {}), stay_at({0.0, 50.0}, now, 60s));
+  submit(
+    first_negotiation->table(p0.id(), {p1.id()}),
+    stay_at({10.0, 0.0}, now, 60s));
+  const auto cousin = first_negotiation->table(p2.id(), {p1.id(), p0.id()});
+  REQUIRE(cousin);
+
+  const auto cache = std::make_shared<RolloutCache>(16, 3s);
+
+  auto first_request = request(*cache, first, source);
+  auto second_request = request(*cache, second, source);
+  CHECK(first_request.started);
+  CHECK_FALSE(second_request.started);
+  CHECK(cache->size() == 1);
+
+  REQUIRE(ready(first_request.alternatives, 10s));
+  REQUIRE(ready(second_request.alternatives, 10s));
+  CHECK(first_request.alternatives.get() == second_request.alternatives.get());
+
+  WHEN("A table faces different proposals")
+  {
+    auto cousin_request = request(*cache, cousin, source);
+    CHECK(cousin_request.started);
+    CHECK(ready(cousin_request.alternatives, 10s));
+    CHECK(cache->size() == 2);
+  }
+
+  WHEN("Another table asks after the rollout has finished")
+  {
+    auto late_request = request(*cache, second, source);
+    CHECK_FALSE(late_request.started);
+    CHECK(ready(late_request.alternatives, 0s));
+  }
+
+  WHEN("The robot has started a new itinerary")
+  {
+    cache->itinerary_version(1);
+    CHECK(cache->size() == 0);
+
+    auto late_request = request(*cache, second, source);
+    CHECK(late_request.started);
+    CHECK(ready(late_request.alternatives, 10s));
+  }
+
+  WHEN("The cache is cleared")
+  {
+    cache->clear();
+    CHECK(cache->size() == 0);
+
+    auto late_request = request(*cache, second, source);
+    CHECK(late_request.started);
+    CHECK(ready(late_request.alternatives, 10s));
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include <rmf_fleet_adapter/PathRequestBatch.hpp>
+
+//==============================================================================
+SCENARIO("Path request batches round trip")
+{
+  std::vector<rmf_fleet_msgs::msg::PathRequest> requests;
+  for (const auto& name : {"robot_a", "robot_b", "robot_c"})
+  {
+    rmf_fleet_msgs::msg::PathRequest request;
+    request.fleet_name = "fleet";
+    request.robot_name = name;
+    request.task_id = std::to_string(requests.size());
+    for (std::size_t i = 0; i <= requests.size(); ++i)
+    {
+      rmf_fleet_msgs::msg::Location location;
+      location.x = static_cast<double>(i);
+      location.level_name = "L1";
+      request.path.push_back(location);
+    }
+
+    requests.push_back(request);
+  }
+
+  const auto batch = rmf_fleet_adapter::encode_path_request_batch(requests);
+  const auto decoded = rmf_fleet_adapter::decode_path_request_batch(batch);
+  CHECK(decoded == requests);
+
+  CHECK(rmf_fleet_adapter::decode_path_request_batch(
+      rmf_fleet_adapter::encode_path_request_batch({})).empty());
+
+  WHEN("The batch is truncated")
+  {
+    auto truncated = batch;
+    truncated.data.pop_back();
+    CHECK_THROWS_AS(
+      rmf_fleet_adapter::decode_path_request_batch(truncated),
+      rmf_fleet_adapter::PathRequestBatchError);
+  }
+
+  WHEN("The batch has trailing bytes")
+  {
+    auto padded = batch;
+    padded.data.push_back(0);
+    CHECK_THROWS_AS(
+      rmf_fleet_adapter::decode_path_request_batch(padded),
+      rmf_fleet_adapter::PathRequestBatchError);
+  }
+}
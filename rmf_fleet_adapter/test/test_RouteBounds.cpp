@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <RouteBounds.hpp>
+
+#include <rmf_traffic/DetectConflict.hpp>
+#include <rmf_traffic/agv/Interpolate.hpp>
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+//==============================================================================
+SCENARIO("Route bounds never screen out a real conflict")
+{
+  using namespace std::chrono_literals;
+  using rmf_fleet_adapter::RouteBounds;
+
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)
+  };
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3}, {0.5, 1.5}, profile
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto make_route = [&](
+    const std::string& map,
+    const rmf_traffic::Time t,
+    const std::vector<Eigen::Vector3d>& positions)
+    {
+      return rmf_traffic::Route(
+        map, rmf_traffic::agv::Interpolate::positions(traits, t, positions));
+    };
+
+  // A long route that goes east along y = 0
+  const auto east = make_route("L1", start, {
+      {0.0, 0.0, 0.0}, {20.0, 0.0, 0.0}, {40.0, 0.0, 0.0}
+    });
+
+  const double r = RouteBounds::radius(profile);
+  const RouteBounds east_bounds(east, r, 5s);
+  CHECK(east_bounds.slices().size() > 1);
+
+  GIVEN("A route that crosses it at the same time")
+  {
+    const auto north = make_route("L1", start, {
+        {1.0, -5.0, M_PI/2.0}, {1.0, 5.0, M_PI/2.0}
+      });
+
+    CHECK(rmf_traffic::DetectConflict::between(
+        profile, east.trajectory(), profile, north.trajectory()));
+    CHECK(east_bounds.might_conflict(RouteBounds(north, r, 5s)));
+  }
+
+  GIVEN("A route that crosses the same place much later")
+  {
+    const auto north = make_route("L1", start + 10min, {
+        {1.0, -5.0, M_PI/2.0}, {1.0, 5.0, M_PI/2.0}
+      });
+
+    CHECK_FALSE(east_bounds.might_conflict(RouteBounds(north, r, 5s)));
+  }
+
+  GIVEN("A route that is far away at the same time")
+  {
+    const auto far = make_route("L1", start, {
+        {0.0, 50.0, 0.0}, {40.0, 50.0, 0.0}
+      });
+
+    CHECK_FALSE(east_bounds.might_conflict(RouteBounds(far, r, 5s)));
+  }
+
+  GIVEN("The same route on a different map")
+  {
+    const auto other_map = make_route("L2", start, {
+        {0.0, 0.0, 0.0}, {40.0, 0.0, 0.0}
+      });
+
+    CHECK_FALSE(east_bounds.might_conflict(RouteBounds(other_map, r, 5s)));
+  }
+}
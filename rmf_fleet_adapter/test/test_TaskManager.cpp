@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "phases/MockAdapterFixture.hpp"
+
+#include <TaskManager.hpp>
+#include <agv/internal_FleetUpdateHandle.hpp>
+
+#include <rmf_battery/agv/BatterySystem.hpp>
+#include <rmf_battery/agv/SimpleMotionPowerSink.hpp>
+#include <rmf_battery/agv/SimpleDevicePowerSink.hpp>
+#include <rmf_task/requests/ChargeBattery.hpp>
+#include <rmf_traffic_ros2/Time.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include <future>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+//==============================================================================
+/// Run a function on the worker of a robot and wait for its result, since the
+/// task manager is only meant to be used from there
+template<typename F>
+auto on_worker(const rmf_fleet_adapter::agv::RobotContextPtr& context, F f)
+{
+  std::promise<decltype(f())> promise;
+  context->worker().schedule(
+    [&promise, &f](const auto&)
+    {
+      promise.set_value(f());
+    });
+
+  return promise.get_future().get();
+}
+
+//==============================================================================
+/// Wait until the robot has started a task, and get the request of that task
+rmf_task::ConstRequestPtr wait_for_task(
+  const rmf_fleet_adapter::agv::RobotContextPtr& context,
+  const std::shared_ptr<rmf_fleet_adapter::TaskManager>& manager,
+  const std::chrono::steady_clock::duration timeout)
+{
+  const auto stop = std::chrono::steady_clock::now() + timeout;
+  while (std::chrono::steady_clock::now() < stop)
+  {
+    auto request = on_worker(
+      context, [&]() -> rmf_task::ConstRequestPtr
+      {
+        const auto* task = manager->current_task();
+        return task ? task->request() : nullptr;
+      });
+
+    if (request)
+      return request;
+
+    std::this_thread::sleep_for(10ms);
+  }
+
+  return nullptr;
+}
+
+//==============================================================================
+bool is_charging(const rmf_task::ConstRequestPtr& request)
+{
+  using ChargeBattery = rmf_task::requests::ChargeBattery;
+  return std::dynamic_pointer_cast<const ChargeBattery::Description>(
+    request->description()) != nullptr;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Task managers react to deadlines and battery changes")
+{
+  using namespace rmf_fleet_adapter;
+  phases::test::MockAdapterFixture fixture;
+  const auto& fleet = fixture.data->fleet;
+  const auto& node = fixture.data->node;
+
+  using BatterySystem = rmf_battery::agv::BatterySystem;
+  using PowerSystem = rmf_battery::agv::PowerSystem;
+  using MechanicalSystem = rmf_battery::agv::MechanicalSystem;
+  using SimpleMotionPowerSink = rmf_battery::agv::SimpleMotionPowerSink;
+  using SimpleDevicePowerSink = rmf_battery::agv::SimpleDevicePowerSink;
+
+  auto battery_system = std::make_shared<BatterySystem>(
+    *BatterySystem::make(24.0, 40.0, 8.8));
+  auto mechanical_system = MechanicalSystem::make(70.0, 40.0, 0.22);
+  auto motion_sink = std::make_shared<SimpleMotionPowerSink>(
+    *battery_system, *mechanical_system);
+  auto ambient_sink = std::make_shared<SimpleDevicePowerSink>(
+    *battery_system, *PowerSystem::make(20.0));
+  auto tool_sink = std::make_shared<SimpleDevicePowerSink>(
+    *battery_system, *PowerSystem::make(10.0));
+
+  REQUIRE(fleet->set_task_planner_params(
+      battery_system, motion_sink, ambient_sink, tool_sink, 0.2, 1.0, true));
+
+  const auto robot = fixture.add_robot();
+  const auto& context = robot.context;
+  const auto manager = on_worker(
+    context, [&]()
+    {
+      return agv::FleetUpdateHandle::Implementation::get(*fleet)
+      .task_managers.at(context);
+    });
+
+  REQUIRE(manager);
+  CHECK_FALSE(wait_for_task(context, manager, 0s));
+
+  WHEN("A task is queued to begin in the future")
+  {
+    const auto now = rmf_traffic_ros2::convert(node->now());
+    const auto deployment_time = now + 1500ms;
+    const auto request =
+      rmf_task::requests::ChargeBattery::make(deployment_time);
+
+    on_worker(
+      context, [&]()
+      {
+        manager->set_queue(
+          {{request, context->current_task_end_state(), deployment_time}});
+        return true;
+      });
+
+    THEN("It begins at its deployment time and not before")
+    {
+      CHECK_FALSE(wait_for_task(context, manager, 1s));
+
+      const auto started = wait_for_task(context, manager, 5s);
+      REQUIRE(started);
+      CHECK(started->id() == request->id());
+
+      const auto started_at = rmf_traffic_ros2::convert(node->now());
+      CHECK(started_at >= deployment_time);
+      CHECK(started_at - deployment_time < 1s);
+    }
+  }
+
+  WHEN("The battery level of an idle robot changes slightly")
+  {
+    const auto battery_soc = [&]()
+      {
+        return on_worker(
+          context, [&]() { return manager->expected_finish_state(); })
+        .battery_soc();
+      };
+
+    // The update is handled on the worker of the robot, so it has been
+    // applied once the worker gets to anything that is scheduled after it
+    const auto wait_for_battery = [&](const double soc)
+      {
+        robot.command->updater->update_battery_soc(soc);
+        on_worker(context, [&]() { return context->current_battery_soc(); });
+      };
+
+    wait_for_battery(0.9);
+    CHECK(battery_soc() == Approx(0.9));
+
+    THEN("The expected finish state follows it")
+    {
+      wait_for_battery(0.9002);
+      CHECK(battery_soc() == 0.9002);
+
+      wait_for_battery(0.9001);
+      CHECK(battery_soc() == 0.9001);
+    }
+  }
+
+  WHEN("The battery of an idle robot away from its charger runs low")
+  {
+    // Pretend that the robot finished its last task out at waypoint 3
+    on_worker(
+      context, [&]()
+      {
+        auto state = context->current_task_end_state();
+        auto location = state.location();
+        location.waypoint(3);
+        state.location(location);
+        context->current_task_end_state(state);
+        return true;
+      });
+
+    THEN("Nothing happens while there is plenty of battery left")
+    {
+      robot.command->updater->update_battery_soc(0.9);
+      CHECK_FALSE(wait_for_task(context, manager, 500ms));
+    }
+
+    THEN("The robot retreats to its charger once it is near the threshold")
+    {
+      robot.command->updater->update_battery_soc(0.22);
+      const auto started = wait_for_task(context, manager, 5s);
+      REQUIRE(started);
+      CHECK(is_charging(started));
+    }
+  }
+}
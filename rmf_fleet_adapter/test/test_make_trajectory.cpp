@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <make_trajectory.hpp>
+
+#include <rmf_traffic/agv/Interpolate.hpp>
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rmf_utils/catch.hpp>
+
+//==============================================================================
+SCENARIO("Cached trajectory segments match direct interpolation")
+{
+  using namespace std::chrono_literals;
+
+  const rmf_traffic::agv::VehicleTraits traits{
+    {0.7, 0.3},
+    {0.5, 1.5},
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(0.5)
+    }
+  };
+
+  TrajectorySegmentCache cache(traits);
+
+  const std::vector<Eigen::Vector3d> positions = {
+    {0.0, 0.0, 0.0},
+    {5.0, 0.0, 0.0},
+    {5.0, 0.0, M_PI/2.0},
+    {5.0, 5.0, M_PI/2.0},
+    {5.0, 5.0, M_PI/2.0},
+    {-3.0, 2.0, 1.0}
+  };
+
+  const auto check_same = [](
+    const rmf_traffic::Trajectory& expected,
+    const rmf_traffic::Trajectory& actual)
+    {
+      REQUIRE(actual.size() == expected.size());
+      auto e = expected.begin();
+      auto a = actual.begin();
+      for (; e != expected.end(); ++e, ++a)
+      {
+        CHECK(rmf_traffic::time::to_seconds(a->time() - e->time())
+          == Approx(0.0).margin(1e-6));
+        CHECK((a->position() - e->position()).norm() == Approx(0.0));
+        CHECK((a->velocity() - e->velocity()).norm() == Approx(0.0));
+      }
+    };
+
+  const auto start = rmf_traffic::Time(100s);
+  check_same(
+    rmf_traffic::agv::Interpolate::positions(traits, start, positions),
+    cache.interpolate(start, positions));
+
+  WHEN("The same segments are used again at a different time")
+  {
+    const auto later = start + 37s;
+    check_same(
+      rmf_traffic::agv::Interpolate::positions(traits, later, positions),
+      cache.interpolate(later, positions));
+  }
+
+  WHEN("Only the tail of the path is used")
+  {
+    const std::vector<Eigen::Vector3d> tail(
+      positions.begin() + 2, positions.end());
+    check_same(
+      rmf_traffic::agv::Interpolate::positions(traits, start, tail),
+      cache.interpolate(start, tail));
+  }
+
+  WHEN("A robot state is turned into a trajectory")
+  {
+    rmf_fleet_msgs::msg::RobotState state;
+    state.location.x = 1.0;
+    state.location.y = 1.0;
+    state.location.yaw = 0.0;
+    for (const auto& p : positions)
+    {
+      rmf_fleet_msgs::msg::Location l;
+      l.x = p.x();
+      l.y = p.y();
+      l.yaw = p.z();
+      state.path.push_back(l);
+    }
+
+    bool expected_sitting = true;
+    bool actual_sitting = true;
+    check_same(
+      make_trajectory(state, traits, expected_sitting),
+      make_trajectory(state, cache, actual_sitting));
+    CHECK_FALSE(expected_sitting);
+    CHECK_FALSE(actual_sitting);
+
+    state.path.clear();
+    check_same(
+      make_trajectory(state, traits, expected_sitting),
+      make_trajectory(state, cache, actual_sitting));
+    CHECK(expected_sitting);
+    CHECK(actual_sitting);
+  }
+}
@@ -27,6 +27,13 @@
 
 // Trampoline RobotCommandHandle wrapper class
 // to allow method overrides from Python
+//
+// The fleet adapter calls these functions from its own threads while the
+// Python side may be running without the GIL. PYBIND11_OVERLOAD_PURE acquires
+// the GIL before it looks up the Python override, and pybind11 acquires it
+// again whenever the std::function callbacks are invoked from Python, so the
+// overrides only hold the GIL for as long as they run. They should therefore
+// hand any long running work over to their own threads and return quickly.
 class PyRobotCommandHandle :
   public rmf_fleet_adapter::agv::RobotCommandHandle
 {
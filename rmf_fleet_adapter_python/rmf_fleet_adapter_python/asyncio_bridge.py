@@ -0,0 +1,161 @@
+"""
+Drive rmf_adapter fleets from a single asyncio event loop.
+
+The C++ fleet adapter calls back into Python from its own worker and ROS
+threads. LoopBridge forwards those calls onto an asyncio event loop with
+loop.call_soon_threadsafe(), which wakes the loop through its self-pipe, so
+every callback runs on the loop's thread and many robots can be driven by
+coroutines instead of one thread each.
+
+Blocking calls such as planning or compute_plan_starts release the GIL, so the
+awaitable versions here run them on the loop's default executor.
+"""
+
+import asyncio
+import functools
+
+import rmf_adapter as adpt
+import rmf_adapter.plan as plan
+
+
+class LoopBridge:
+    def __init__(self, loop=None):
+        if loop is None:
+            loop = asyncio.get_event_loop()
+
+        self.loop = loop
+        # Keep a reference to every running task so that it does not get
+        # garbage collected before it finishes
+        self._tasks = set()
+
+    def post(self, callback, *args):
+        """
+        Call callback(*args) on the event loop. This may be called from any
+        thread. If callback is a coroutine function, its coroutine is started
+        as a task on the loop. Posts to a closed loop are dropped.
+        """
+        if self.loop.is_closed():
+            return
+
+        try:
+            self.loop.call_soon_threadsafe(self._run, callback, args)
+        except RuntimeError:
+            # The loop was closed after we checked it
+            pass
+
+    def wrap(self, callback):
+        """
+        Get a function that posts its calls to callback onto the event loop.
+        Use this for callbacks that are handed to the C++ adapter.
+        """
+        return functools.partial(self.post, callback)
+
+    def spawn(self, coroutine):
+        """Start a coroutine as a task on the loop. Call from the loop."""
+        task = self.loop.create_task(coroutine)
+        self._tasks.add(task)
+        task.add_done_callback(self._tasks.discard)
+        return task
+
+    def future(self):
+        """
+        Get a future of the event loop along with a function that resolves it
+        from any thread. The future gets the single argument that the function
+        is called with, or a tuple of its arguments if there are several.
+        """
+        future = self.loop.create_future()
+
+        def resolve(*args):
+            value = args[0] if len(args) == 1 else args
+            self.post(_set_result, future, value)
+
+        return future, resolve
+
+    async def run_blocking(self, function, *args, **kwargs):
+        """Await function(*args, **kwargs) on the loop's default executor."""
+        return await self.loop.run_in_executor(
+            None, functools.partial(function, *args, **kwargs))
+
+    async def add_robot(self, fleet, command, name, profile, starts):
+        """Add a robot to the fleet and await its RobotUpdateHandle."""
+        future, resolve = self.future()
+        fleet.add_robot(command, name, profile, starts, resolve)
+        return await future
+
+    async def get_plan_waypoints(self, planner, start, goal):
+        """Awaitable version of Planner.get_plan_waypoints"""
+        return await self.run_blocking(
+            planner.get_plan_waypoints, start, goal)
+
+    async def get_plan_arrays(self, planner, start, goal):
+        """Awaitable version of Planner.get_plan_arrays"""
+        return await self.run_blocking(planner.get_plan_arrays, start, goal)
+
+    async def compute_plan_starts(self, *args, **kwargs):
+        """Awaitable version of plan.compute_plan_starts"""
+        return await self.run_blocking(
+            plan.compute_plan_starts, *args, **kwargs)
+
+    async def update_robots(self, fleet, updates):
+        """Awaitable version of FleetUpdateHandle.update_robots"""
+        return await self.run_blocking(fleet.update_robots, updates)
+
+    def _run(self, callback, args):
+        if asyncio.iscoroutinefunction(callback):
+            self.spawn(callback(*args))
+        else:
+            callback(*args)
+
+
+def _set_result(future, value):
+    if not future.done():
+        future.set_result(value)
+
+
+class AsyncRobotCommandHandle(adpt.RobotCommandHandle):
+    """
+    A RobotCommandHandle whose commands run as coroutines on an event loop.
+
+    Subclasses implement the coroutines on_follow_new_path, on_stop and
+    on_dock, which receive the same arguments as follow_new_path, stop and
+    dock. A new command cancels the task of the previous command, so a
+    coroutine should expect asyncio.CancelledError at any await.
+    """
+
+    def __init__(self, bridge):
+        adpt.RobotCommandHandle.__init__(self)
+        self.bridge = bridge
+        self._command = None
+
+    def follow_new_path(self,
+                        waypoints,
+                        next_arrival_estimator,
+                        path_finished_callback):
+        self.bridge.post(self._start_command, self.on_follow_new_path,
+                         waypoints, next_arrival_estimator,
+                         path_finished_callback)
+
+    def stop(self):
+        self.bridge.post(self._start_command, self.on_stop)
+
+    def dock(self, dock_name, docking_finished_callback):
+        self.bridge.post(self._start_command, self.on_dock,
+                         dock_name, docking_finished_callback)
+
+    async def on_follow_new_path(self,
+                                 waypoints,
+                                 next_arrival_estimator,
+                                 path_finished_callback):
+        raise NotImplementedError
+
+    async def on_stop(self):
+        pass
+
+    async def on_dock(self, dock_name, docking_finished_callback):
+        raise NotImplementedError
+
+    def _start_command(self, command, *args):
+        if self._command is not None:
+            self._command.cancel()
+
+        self._command = self.bridge.spawn(command(*args))
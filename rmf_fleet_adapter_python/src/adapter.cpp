@@ -1,6 +1,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/functional.h>
 #include <pybind11/iostream.h>
+#include <pybind11/numpy.h>
 #include <pybind11/chrono.h>
 #include <pybind11/eigen.h>
 #include <pybind11/stl.h>
@@ -30,6 +31,31 @@ namespace battery = rmf_battery::agv;
 using TimePoint = std::chrono::time_point<std::chrono::system_clock,
     std::chrono::nanoseconds>;
 
+template<typename T>
+using InputArray = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+//==============================================================================
+// Check that an array has a row for each robot and the given number of
+// columns, or is one dimensional if columns is 0
+template<typename T>
+void check_rows(
+  const InputArray<T>& array,
+  const std::size_t robots,
+  const py::ssize_t columns,
+  const char* name)
+{
+  const bool shape_ok = columns == 0 ?
+    array.ndim() == 1 : (array.ndim() == 2 && array.shape(1) == columns);
+
+  if (!shape_ok || static_cast<std::size_t>(array.shape(0)) != robots)
+  {
+    throw std::runtime_error(
+            std::string("The [") + name + "] array must have one "
+            + (columns == 0 ? "entry" : "row of " + std::to_string(columns))
+            + " for each of the " + std::to_string(robots) + " robots");
+  }
+}
+
 void bind_types(py::module&);
 void bind_graph(py::module&);
 void bind_shapes(py::module&);
@@ -40,6 +66,12 @@ void bind_nodes(py::module&);
 void bind_battery(py::module&);
 void bind_schedule(py::module&);
 
+// NOTE: Bindings that may block or do a lot of work in C++ release the GIL
+// with py::call_guard<py::gil_scoped_release> so that other Python threads
+// can keep running. Those bindings do not redirect std::cout and std::cerr,
+// because the redirected streams write to Python without holding the GIL.
+// Python callbacks that get passed into them are wrapped by pybind11 so that
+// the GIL is acquired again whenever C++ calls them.
 PYBIND11_MODULE(rmf_adapter, m) {
   bind_types(m);
   bind_graph(m);
@@ -74,24 +106,21 @@ PYBIND11_MODULE(rmf_adapter, m) {
       &agv::RobotUpdateHandle::update_position),
     py::arg("waypoint"),
     py::arg("orientation"),
-    py::call_guard<py::scoped_ostream_redirect,
-    py::scoped_estream_redirect>())
+    py::call_guard<py::gil_scoped_release>())
   .def("update_current_lanes",
     py::overload_cast<const Eigen::Vector3d&,
     const std::vector<std::size_t>&>(
       &agv::RobotUpdateHandle::update_position),
     py::arg("position"),
     py::arg("lanes"),
-    py::call_guard<py::scoped_ostream_redirect,
-    py::scoped_estream_redirect>())
+    py::call_guard<py::gil_scoped_release>())
   .def("update_off_grid_position",
     py::overload_cast<const Eigen::Vector3d&,
     std::size_t>(
       &agv::RobotUpdateHandle::update_position),
     py::arg("position"),
     py::arg("target_waypoint"),
-    py::call_guard<py::scoped_ostream_redirect,
-    py::scoped_estream_redirect>())
+    py::call_guard<py::gil_scoped_release>())
   .def("update_lost_position",
     py::overload_cast<const std::string&,
     const Eigen::Vector3d&,
@@ -104,16 +133,23 @@ PYBIND11_MODULE(rmf_adapter, m) {
     py::arg("max_merge_waypoint_distance") = 0.1,
     py::arg("max_merge_lane_distance") = 1.0,
     py::arg("min_lane_length") = 1e-8,
-    py::call_guard<py::scoped_ostream_redirect,
-    py::scoped_estream_redirect>())
+    py::call_guard<py::gil_scoped_release>())
+  .def_property("position_update_tolerance",
+    py::overload_cast<>(
+      &agv::RobotUpdateHandle::position_update_tolerance, py::const_),
+    [&](agv::RobotUpdateHandle& self, double distance)
+    {
+      self.position_update_tolerance(distance);
+    },
+    "How far the robot must move before update_lost_position searches the "
+    "navigation graph again")
   .def("set_charger_waypoint", &agv::RobotUpdateHandle::set_charger_waypoint,
     py::arg("charger_wp"),
     py::call_guard<py::scoped_ostream_redirect,
     py::scoped_estream_redirect>())
   .def("update_battery_soc", &agv::RobotUpdateHandle::update_battery_soc,
     py::arg("battery_soc"),
-    py::call_guard<py::scoped_ostream_redirect,
-    py::scoped_estream_redirect>())
+    py::call_guard<py::gil_scoped_release>())
   .def_property("maximum_delay",
     py::overload_cast<>(
       &agv::RobotUpdateHandle::maximum_delay, py::const_),
@@ -142,6 +178,176 @@ PYBIND11_MODULE(rmf_adapter, m) {
     py::return_value_policy::reference_internal,
     "Experimental API to access the schedule participant");
 
+  // ROBOT UPDATES ===========================================================
+  using RobotUpdates = agv::FleetUpdateHandle::RobotUpdates;
+  py::class_<RobotUpdates>(m, "RobotUpdates")
+  .def(py::init<>())
+  .def("update_current_waypoint",
+    py::overload_cast<agv::RobotUpdateHandlePtr, std::size_t, double>(
+      &RobotUpdates::update_position),
+    py::arg("robot"),
+    py::arg("waypoint"),
+    py::arg("orientation"),
+    py::return_value_policy::reference_internal)
+  .def("update_current_lanes",
+    py::overload_cast<agv::RobotUpdateHandlePtr, const Eigen::Vector3d&,
+    std::vector<std::size_t>>(
+      &RobotUpdates::update_position),
+    py::arg("robot"),
+    py::arg("position"),
+    py::arg("lanes"),
+    py::return_value_policy::reference_internal)
+  .def("update_off_grid_position",
+    py::overload_cast<agv::RobotUpdateHandlePtr, const Eigen::Vector3d&,
+    std::size_t>(
+      &RobotUpdates::update_position),
+    py::arg("robot"),
+    py::arg("position"),
+    py::arg("target_waypoint"),
+    py::return_value_policy::reference_internal)
+  .def("update_lost_position",
+    py::overload_cast<agv::RobotUpdateHandlePtr, std::string,
+    const Eigen::Vector3d&, double, double, double>(
+      &RobotUpdates::update_position),
+    py::arg("robot"),
+    py::arg("map_name"),
+    py::arg("position"),
+    py::arg("max_merge_waypoint_distance") = 0.1,
+    py::arg("max_merge_lane_distance") = 1.0,
+    py::arg("min_lane_length") = 1e-8,
+    py::return_value_policy::reference_internal)
+  .def("update_battery_soc", &RobotUpdates::update_battery_soc,
+    py::arg("robot"),
+    py::arg("battery_soc"),
+    py::return_value_policy::reference_internal)
+  .def("update_current_waypoints",
+    [](RobotUpdates& self,
+    const std::vector<agv::RobotUpdateHandlePtr>& robots,
+    const InputArray<int64_t>& waypoints,
+    const InputArray<double>& orientations) -> RobotUpdates&
+    {
+      check_rows(waypoints, robots.size(), 0, "waypoints");
+      check_rows(orientations, robots.size(), 0, "orientations");
+      const auto wp = waypoints.unchecked<1>();
+      const auto yaw = orientations.unchecked<1>();
+      for (std::size_t i = 0; i < robots.size(); ++i)
+      {
+        const auto r = static_cast<py::ssize_t>(i);
+        self.update_position(
+          robots[i], static_cast<std::size_t>(wp(r)), yaw(r));
+      }
+
+      return self;
+    },
+    py::arg("robots"),
+    py::arg("waypoints"),
+    py::arg("orientations"),
+    py::return_value_policy::reference_internal,
+    "Same as update_current_waypoint for each robot in a list")
+  .def("update_off_grid_positions",
+    [](RobotUpdates& self,
+    const std::vector<agv::RobotUpdateHandlePtr>& robots,
+    const InputArray<double>& positions,
+    const InputArray<int64_t>& target_waypoints) -> RobotUpdates&
+    {
+      check_rows(positions, robots.size(), 3, "positions");
+      check_rows(target_waypoints, robots.size(), 0, "target_waypoints");
+      const auto p = positions.unchecked<2>();
+      const auto wp = target_waypoints.unchecked<1>();
+      for (std::size_t i = 0; i < robots.size(); ++i)
+      {
+        const auto r = static_cast<py::ssize_t>(i);
+        self.update_position(
+          robots[i], Eigen::Vector3d(p(r, 0), p(r, 1), p(r, 2)),
+          static_cast<std::size_t>(wp(r)));
+      }
+
+      return self;
+    },
+    py::arg("robots"),
+    py::arg("positions"),
+    py::arg("target_waypoints"),
+    py::return_value_policy::reference_internal,
+    "Same as update_off_grid_position for each robot in a list, with an Nx3 "
+    "array of positions")
+  .def("update_lost_positions",
+    [](RobotUpdates& self,
+    const std::vector<agv::RobotUpdateHandlePtr>& robots,
+    const std::string& map_name,
+    const InputArray<double>& positions,
+    double max_merge_waypoint_distance,
+    double max_merge_lane_distance,
+    double min_lane_length) -> RobotUpdates&
+    {
+      check_rows(positions, robots.size(), 3, "positions");
+      const auto p = positions.unchecked<2>();
+      for (std::size_t i = 0; i < robots.size(); ++i)
+      {
+        const auto r = static_cast<py::ssize_t>(i);
+        self.update_position(
+          robots[i], map_name, Eigen::Vector3d(p(r, 0), p(r, 1), p(r, 2)),
+          max_merge_waypoint_distance, max_merge_lane_distance,
+          min_lane_length);
+      }
+
+      return self;
+    },
+    py::arg("robots"),
+    py::arg("map_name"),
+    py::arg("positions"),
+    py::arg("max_merge_waypoint_distance") = 0.1,
+    py::arg("max_merge_lane_distance") = 1.0,
+    py::arg("min_lane_length") = 1e-8,
+    py::return_value_policy::reference_internal,
+    "Same as update_lost_position for each robot in a list of robots that "
+    "are all on the same map, with an Nx3 array of positions")
+  .def("update_battery_socs",
+    [](RobotUpdates& self,
+    const std::vector<agv::RobotUpdateHandlePtr>& robots,
+    const InputArray<double>& battery_socs) -> RobotUpdates&
+    {
+      check_rows(battery_socs, robots.size(), 0, "battery_socs");
+      const auto soc = battery_socs.unchecked<1>();
+      for (std::size_t i = 0; i < robots.size(); ++i)
+        self.update_battery_soc(robots[i], soc(static_cast<py::ssize_t>(i)));
+
+      return self;
+    },
+    py::arg("robots"),
+    py::arg("battery_socs"),
+    py::return_value_policy::reference_internal,
+    "Same as update_battery_soc for each robot in a list")
+  .def("append", &RobotUpdates::append,
+    py::arg("other"),
+    py::return_value_policy::reference_internal)
+  .def("clear", &RobotUpdates::clear)
+  .def("__len__", &RobotUpdates::size);
+
+  // NEW ROBOT ===============================================================
+  using NewRobot = agv::FleetUpdateHandle::NewRobot;
+  py::class_<NewRobot>(m, "NewRobot")
+  .def(py::init(
+      [](std::shared_ptr<agv::RobotCommandHandle> command,
+      std::string name,
+      rmf_traffic::Profile profile,
+      rmf_traffic::agv::Plan::StartSet start,
+      std::function<void(std::shared_ptr<agv::RobotUpdateHandle>)> handle_cb)
+      {
+        return NewRobot{
+          std::move(command),
+          std::move(name),
+          std::move(profile),
+          std::move(start),
+          std::move(handle_cb)
+        };
+      }),
+    py::arg("command"),
+    py::arg("name"),
+    py::arg("profile"),
+    py::arg("start"),
+    py::arg("handle_cb"))
+  .def_readwrite("name", &NewRobot::name);
+
   // FLEETUPDATE HANDLE ======================================================
   py::class_<agv::FleetUpdateHandle,
     std::shared_ptr<agv::FleetUpdateHandle>>(
@@ -164,13 +370,28 @@ PYBIND11_MODULE(rmf_adapter, m) {
     py::arg("name"),
     py::arg("profile"),
     py::arg("start"),
-    py::arg("handle_cb"))
+    py::arg("handle_cb"),
+    py::call_guard<py::gil_scoped_release>())
+  .def("add_robots", &agv::FleetUpdateHandle::add_robots,
+    py::arg("robots"),
+    py::call_guard<py::gil_scoped_release>(),
+    "Add many robots at once with one schedule registration request")
   .def("close_lanes",
     &agv::FleetUpdateHandle::close_lanes,
     py::arg("lane_indices"))
   .def("open_lanes",
     &agv::FleetUpdateHandle::open_lanes,
     py::arg("lane_indices"))
+  .def("update_lanes",
+    &agv::FleetUpdateHandle::update_lanes,
+    py::arg("open_lane_indices"),
+    py::arg("close_lane_indices"),
+    "Open and close lanes together so the planner only changes once")
+  .def("update_robots",
+    &agv::FleetUpdateHandle::update_robots,
+    py::arg("updates"),
+    py::call_guard<py::gil_scoped_release>(),
+    "Apply a RobotUpdates collection to the robots of this fleet at once")
   .def("set_task_planner_params",
     [&](agv::FleetUpdateHandle& self,
     battery::BatterySystem& b_sys,
@@ -180,7 +401,8 @@ PYBIND11_MODULE(rmf_adapter, m) {
     double recharge_threshold,
     double recharge_soc,
     bool account_for_battery_drain,
-    const std::string& finishing_request_string = "nothing")
+    const std::string& finishing_request_string = "nothing",
+    double bid_planning_budget = 0.5)
     {
       // Supported finishing_request_string: [charge, park, nothing]
       rmf_task::ConstRequestFactoryPtr finishing_request;
@@ -207,7 +429,8 @@ PYBIND11_MODULE(rmf_adapter, m) {
         recharge_threshold,
         recharge_soc,
         account_for_battery_drain,
-        finishing_request);
+        finishing_request,
+        bid_planning_budget);
     },
     py::arg("battery_system"),
     py::arg("motion_sink"),
@@ -216,7 +439,8 @@ PYBIND11_MODULE(rmf_adapter, m) {
     py::arg("recharge_threshold"),
     py::arg("recharge_soc"),
     py::arg("account_for_battery_drain"),
-    py::arg("finishing_request_string") = "nothing")
+    py::arg("finishing_request_string") = "nothing",
+    py::arg("bid_planning_budget") = 0.5)
   .def("accept_delivery_requests",
     &agv::FleetUpdateHandle::accept_delivery_requests,
     "NOTE: deprecated, use accept_task_requests() instead")
@@ -224,6 +448,10 @@ PYBIND11_MODULE(rmf_adapter, m) {
     &agv::FleetUpdateHandle::accept_task_requests,
     py::arg("check"),
     "Provide a callback function which will accept rmf tasks requests")
+  .def("accept_task_types",
+    &agv::FleetUpdateHandle::accept_task_types,
+    py::arg("types"),
+    "Only receive the bid notices of these rmf_task_msgs TaskType values")
   .def_property("default_maximum_delay",
     py::overload_cast<>(
       &agv::FleetUpdateHandle::default_maximum_delay, py::const_),
@@ -234,7 +462,16 @@ PYBIND11_MODULE(rmf_adapter, m) {
   .def("fleet_state_publish_period",
     &agv::FleetUpdateHandle::fleet_state_publish_period,
     py::arg("value"),
-    "The default value is 1s");
+    "The default value is 1s")
+  .def_property("fleet_state_keyframe_period",
+    py::overload_cast<>(
+      &agv::FleetUpdateHandle::fleet_state_keyframe_period, py::const_),
+    [&](agv::FleetUpdateHandle& self,
+    std::optional<rmf_traffic::Duration> value)
+    {
+      self.fleet_state_keyframe_period(value);
+    },
+    "When set, only changed robots are published between full keyframes");
 
   // EASY TRAFFIC LIGHT HANDLE ===============================================
   py::class_<agv::Waypoint>(m, "Waypoint")
@@ -335,11 +572,13 @@ PYBIND11_MODULE(rmf_adapter, m) {
   m.def("spin_rclcpp", [](rclcpp::Node::SharedPtr node_pt)
     {
       rclcpp::spin(node_pt);
-    });
+    },
+    py::call_guard<py::gil_scoped_release>());
   m.def("spin_some_rclcpp", [](rclcpp::Node::SharedPtr node_pt)
     {
       rclcpp::spin_some(node_pt);
-    });
+    },
+    py::call_guard<py::gil_scoped_release>());
 
   py::class_<agv::Adapter, std::shared_ptr<agv::Adapter>>(m, "Adapter")
   // .def(py::init<>())  // Private constructor
@@ -1,11 +1,18 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/iostream.h>
+#include <pybind11/numpy.h>
 #include <pybind11/chrono.h>
 #include <pybind11/eigen.h>
+#include <pybind11/functional.h>
 #include <pybind11/stl.h>
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <random>
+#include <string>
+#include <vector>
 
 #include <rmf_utils/clone_ptr.hpp>
 #include "rmf_fleet_adapter/agv/Adapter.hpp"
@@ -18,11 +25,49 @@ namespace py = pybind11;
 void bind_lane(py::module&);
 
 using Duration = rmf_traffic::Duration;
+namespace agv = rmf_fleet_adapter::agv;
 using Graph = rmf_traffic::agv::Graph;
 using Lane = rmf_traffic::agv::Graph::Lane;
 
 using OrientationConstraint = Graph::OrientationConstraint;
 
+template<typename T>
+using InputArray = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+//==============================================================================
+// Read an Nx2 array into a vector of 2D points
+template<typename T, typename Point>
+std::vector<Point> to_pairs(const InputArray<T>& array, const char* name)
+{
+  if (array.ndim() != 2 || array.shape(1) != 2)
+  {
+    throw std::runtime_error(
+            std::string("The [") + name + "] array must have a shape of (N, 2)");
+  }
+
+  const auto data = array.template unchecked<2>();
+  std::vector<Point> output;
+  output.reserve(static_cast<std::size_t>(data.shape(0)));
+  for (py::ssize_t i = 0; i < data.shape(0); ++i)
+    output.push_back({data(i, 0), data(i, 1)});
+
+  return output;
+}
+
+//==============================================================================
+// Read a one dimensional array into a vector
+template<typename T, typename U = T>
+std::vector<U> to_vector(const InputArray<T>& array)
+{
+  const auto data = array.template unchecked<1>();
+  std::vector<U> output;
+  output.reserve(static_cast<std::size_t>(data.shape(0)));
+  for (py::ssize_t i = 0; i < data.shape(0); ++i)
+    output.push_back(static_cast<U>(data(i)));
+
+  return output;
+}
+
 void bind_graph(py::module& m)
 {
   auto m_graph = m.def_submodule("graph");
@@ -125,6 +170,31 @@ void bind_graph(py::module& m)
       &Graph::find_waypoint, py::const_),
     py::return_value_policy::reference_internal)
   .def_property_readonly("num_waypoints", &Graph::num_waypoints)
+  .def("add_waypoints",
+    [](Graph& self,
+    const std::vector<std::string>& map_names,
+    const InputArray<double>& locations,
+    std::optional<InputArray<int64_t>> map_indices,
+    std::optional<InputArray<uint8_t>> flags)
+    {
+      auto points = to_pairs<double, Eigen::Vector2d>(locations, "locations");
+      auto indices = map_indices ?
+      to_vector<int64_t, std::size_t>(*map_indices) :
+      std::vector<std::size_t>(points.size(), 0);
+      auto flag_values = flags ?
+      to_vector<uint8_t>(*flags) : std::vector<uint8_t>();
+
+      return agv::add_waypoints(
+        self, map_names, indices, points, flag_values);
+    },
+    py::arg("map_names"),
+    py::arg("locations"),
+    py::arg("map_indices") = std::nullopt,
+    py::arg("flags") = std::nullopt,
+    "Add a waypoint for each row of an Nx2 array of locations. Waypoint i "
+    "goes on map_names[map_indices[i]], or on map_names[0] when map_indices "
+    "is not given, and gets the WaypointFlag combination of flags[i]. "
+    "Returns the index of the first new waypoint.")
 
   // Keys
   .def("add_key", &Graph::add_key)
@@ -183,11 +253,57 @@ void bind_graph(py::module& m)
       &Graph::lane_from, py::const_),
     py::return_value_policy::reference_internal)
   .def_property_readonly("num_lanes", &Graph::num_lanes)
+  .def("add_lanes",
+    [](Graph& self,
+    const InputArray<int64_t>& lanes,
+    const std::vector<std::string>& door_names,
+    const std::vector<std::string>& dock_names,
+    bool bidirectional)
+    {
+      const auto pairs = to_pairs<int64_t, std::array<int64_t, 2>>(
+        lanes, "lanes");
+      std::vector<std::array<std::size_t, 2>> indices;
+      indices.reserve(pairs.size());
+      for (const auto& p : pairs)
+      {
+        if (p[0] < 0 || p[1] < 0)
+          throw std::runtime_error("Lanes cannot have negative indices");
+
+        indices.push_back({
+            static_cast<std::size_t>(p[0]), static_cast<std::size_t>(p[1])});
+      }
+
+      return agv::add_lanes(
+        self, indices, door_names, dock_names, bidirectional);
+    },
+    py::arg("lanes"),
+    py::arg("door_names") = std::vector<std::string>(),
+    py::arg("dock_names") = std::vector<std::string>(),
+    py::arg("bidirectional") = false,
+    "Add a lane for each row of an Nx2 array of waypoint indices. Empty door "
+    "and dock names mean that a lane has no door or dock. Returns the index "
+    "of the first new lane.")
   .def("lanes_from_waypoint",
     py::overload_cast<std::size_t>(&Graph::lanes_from, py::const_),
     py::arg("wp_index"));
 
+  py::enum_<agv::WaypointFlag>(m_graph, "WaypointFlag", py::arithmetic())
+  .value("HoldingPoint", agv::WaypointFlag::HoldingPoint)
+  .value("PassthroughPoint", agv::WaypointFlag::PassthroughPoint)
+  .value("ParkingSpot", agv::WaypointFlag::ParkingSpot)
+  .value("Charger", agv::WaypointFlag::Charger);
+
   // PARSE GRAPH ==============================================================
   // Helper function to parse a graph from a yaml file
-  m_graph.def("parse_graph", &rmf_fleet_adapter::agv::parse_graph);
+  m_graph.def("parse_graph",
+    [](const std::string& filename,
+    const rmf_traffic::agv::VehicleTraits& vehicle_traits,
+    const rmf_fleet_adapter::agv::GraphWarningCallback& warning)
+    {
+      return rmf_fleet_adapter::agv::parse_graph(
+        filename, vehicle_traits, warning);
+    },
+    py::arg("filename"),
+    py::arg("vehicle_traits"),
+    py::arg("warning") = nullptr);
 }
@@ -7,6 +7,8 @@
 #include "rmf_traffic_ros2/Time.hpp"
 #include <rmf_traffic/agv/Planner.hpp>
 
+#include <tuple>
+
 namespace py = pybind11;
 
 using Plan = rmf_traffic::agv::Plan;
@@ -25,6 +27,10 @@ using Interpolate = rmf_traffic::agv::Interpolate;
 using TimePoint = std::chrono::time_point<std::chrono::system_clock,
     std::chrono::nanoseconds>;
 
+using PositionArray =
+  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>;
+using IndexArray = Eigen::Matrix<int64_t, Eigen::Dynamic, 1>;
+
 // NOTE(CH3):
 // Factory method for Start() to allow passing in of system_clock::time_points,
 // as Start objects are constructed using steady_clock::time_points
@@ -48,6 +54,29 @@ Start make_start(TimePoint initial_time,
       initial_lane);
 }
 
+// Gather the positions, times and graph indices of plan waypoints into
+// contiguous arrays, which pybind11 hands over to NumPy without copying them
+// again. Times are nanoseconds since the epoch, like the time of a Waypoint,
+// and waypoints without a graph index are given an index of -1.
+std::tuple<PositionArray, IndexArray, IndexArray> make_waypoint_arrays(
+  const std::vector<Plan::Waypoint>& waypoints)
+{
+  const auto N = static_cast<Eigen::Index>(waypoints.size());
+  PositionArray positions(N, 3);
+  IndexArray times(N);
+  IndexArray graph_indices(N);
+  for (Eigen::Index i = 0; i < N; ++i)
+  {
+    const auto& wp = waypoints[static_cast<std::size_t>(i)];
+    positions.row(i) = wp.position().transpose();
+    times[i] = wp.time().time_since_epoch().count();
+    graph_indices[i] = wp.graph_index().has_value() ?
+      static_cast<int64_t>(*wp.graph_index()) : -1;
+  }
+
+  return {std::move(positions), std::move(times), std::move(graph_indices)};
+}
+
 Planner make_planner(Configuration config)
 {
   const auto default_options = Options{nullptr};
@@ -117,8 +146,7 @@ void bind_plan(py::module& m)
     py::arg("max_merge_waypoint_distance") = 0.1,
     py::arg("max_merge_lane_distance") = 1.0,
     py::arg("min_lane_length") = 1e-8,
-    py::call_guard<py::scoped_ostream_redirect,
-    py::scoped_estream_redirect>());
+    py::call_guard<py::gil_scoped_release>());
 
   // PLAN ======================================================================
   py::class_<Plan>(m_plan, "Plan")
@@ -128,7 +156,18 @@ void bind_plan(py::module& m)
   .def_property_readonly("waypoints",
     &Plan::get_waypoints)
   .def_property_readonly("start",
-    &Plan::get_start);
+    &Plan::get_start)
+  .def("waypoint_arrays",
+    [](const Plan& self)
+    {
+      return make_waypoint_arrays(self.get_waypoints());
+    },
+    "Get (positions, times, graph_indices) of the waypoints as NumPy arrays");
+
+  m_plan.def("waypoint_arrays", &make_waypoint_arrays,
+    py::arg("waypoints"),
+    "Get (positions, times, graph_indices) of a list of waypoints as NumPy "
+    "arrays");
 
   // WAYPOINT ==================================================================
   py::class_<Plan::Waypoint>(m_plan, "Waypoint")
@@ -197,6 +236,26 @@ void bind_plan(py::module& m)
 
     },
     py::arg("start"), py::arg("goal"),
-    py::return_value_policy::reference_internal);
+    py::return_value_policy::reference_internal,
+    // Planning only reads the Planner and its configuration, so other Python
+    // threads may run, and even plan with the same Planner, in the meantime.
+    py::call_guard<py::gil_scoped_release>())
+  .def("get_plan_arrays",
+    [&](Planner& self,
+    Start start,
+    Goal goal)
+    {
+      std::vector<Plan::Waypoint> waypoints;
+      const auto result = self.plan(start, goal);
+      if (result.success())
+      {
+        waypoints = result->get_waypoints();
+      }
 
+      return make_waypoint_arrays(waypoints);
+    },
+    py::arg("start"), py::arg("goal"),
+    py::call_guard<py::gil_scoped_release>(),
+    "Same as get_plan_waypoints, but returns the (positions, times, "
+    "graph_indices) of the waypoints as NumPy arrays");
 }
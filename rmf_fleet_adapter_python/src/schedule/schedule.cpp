@@ -83,5 +83,43 @@ void bind_schedule(py::module& m)
 
   // TRAJECTORY ================================================================
   py::class_<rmf_traffic::Trajectory,
-    std::shared_ptr<rmf_traffic::Trajectory>>(m_schedule, "Trajectory");
+    std::shared_ptr<rmf_traffic::Trajectory>>(m_schedule, "Trajectory")
+  .def("__len__", &rmf_traffic::Trajectory::size)
+  .def("positions",
+    [](const rmf_traffic::Trajectory& self)
+    {
+      Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>
+      positions(static_cast<Eigen::Index>(self.size()), 3);
+      Eigen::Index i = 0;
+      for (const auto& wp : self)
+        positions.row(i++) = wp.position().transpose();
+
+      return positions;
+    },
+    "Get an Nx3 NumPy array of the (x, y, yaw) of each waypoint")
+  .def("velocities",
+    [](const rmf_traffic::Trajectory& self)
+    {
+      Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>
+      velocities(static_cast<Eigen::Index>(self.size()), 3);
+      Eigen::Index i = 0;
+      for (const auto& wp : self)
+        velocities.row(i++) = wp.velocity().transpose();
+
+      return velocities;
+    },
+    "Get an Nx3 NumPy array of the velocity of each waypoint")
+  .def("times",
+    [](const rmf_traffic::Trajectory& self)
+    {
+      Eigen::Matrix<int64_t, Eigen::Dynamic, 1>
+      times(static_cast<Eigen::Index>(self.size()));
+      Eigen::Index i = 0;
+      for (const auto& wp : self)
+        times[i++] = wp.time().time_since_epoch().count();
+
+      return times;
+    },
+    "Get a NumPy array of the time of each waypoint in nanoseconds since the "
+    "epoch");
 }
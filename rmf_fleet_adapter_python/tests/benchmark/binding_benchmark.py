@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+
+# This benchmark measures the overhead of the Python bindings on the calls that
+# a Python fleet adapter makes most often: robot updates, plan queries, graph
+# construction and schedule itineraries. Each case is measured for several
+# fleet sizes and reports the time per operation in the manner of Google
+# Benchmark.
+#
+# Usage:
+#
+#   binding_benchmark.py [--filter=<substring>] [--min_time=<seconds>]
+#                        [--robots=100,1000] [--save=<file>]
+#                        [--baseline=<file>] [--tolerance=<fraction>]
+#
+# Only the cases whose name contains the filter are run. Each case is repeated
+# until at least min_time seconds (0.5 by default) have passed. The results
+# can be saved as JSON with --save. When a baseline saved by an earlier run is
+# given, every case that is slower than the baseline by more than the
+# tolerance (0.25 by default) is reported as a regression, and the benchmark
+# exits with a non-zero status.
+
+import argparse
+import datetime
+import json
+import sys
+import threading
+import time
+
+import numpy as np
+
+import rmf_adapter as adpt
+import rmf_adapter.geometry as geometry
+import rmf_adapter.graph as graph
+import rmf_adapter.plan as plan
+import rmf_adapter.schedule as schedule
+import rmf_adapter.vehicletraits as traits
+
+map_name = "benchmark_map"
+spacing = 5.0
+
+
+class IdleRobotCommand(adpt.RobotCommandHandle):
+    def __init__(self):
+        adpt.RobotCommandHandle.__init__(self)
+
+    def follow_new_path(self,
+                        waypoints,
+                        next_arrival_estimator,
+                        path_finished_callback):
+        pass
+
+    def stop(self):
+        pass
+
+    def dock(self, dock_name, docking_finished_callback):
+        pass
+
+
+def grid_arrays(side):
+    """The waypoint locations and bidirectional lanes of a square grid"""
+    xs, ys = np.meshgrid(np.arange(side), np.arange(side))
+    locations = spacing * np.stack(
+        [xs.ravel(), ys.ravel()], axis=1).astype(np.float64)
+
+    index = np.arange(side * side).reshape(side, side)
+    lanes = np.concatenate([
+        np.stack([index[:, :-1].ravel(), index[:, 1:].ravel()], axis=1),
+        np.stack([index[:-1, :].ravel(), index[1:, :].ravel()], axis=1)])
+    return locations, lanes
+
+
+def build_grid_per_call(side):
+    locations, lanes = grid_arrays(side)
+    g = graph.Graph()
+    for location in locations:
+        g.add_waypoint(map_name, location)
+    for lane in lanes:
+        g.add_bidir_lane(int(lane[0]), int(lane[1]))
+    return g
+
+
+def build_grid_bulk(side):
+    locations, lanes = grid_arrays(side)
+    g = graph.Graph()
+    flags = np.zeros(len(locations), dtype=np.uint8)
+    flags[0] = graph.WaypointFlag.Charger
+    g.add_waypoints([map_name], locations, flags=flags)
+    g.add_lanes(lanes, bidirectional=True)
+    return g
+
+
+def make_traits():
+    profile = traits.Profile(geometry.make_final_convex_circle(0.5))
+    return traits.VehicleTraits(linear=traits.Limits(0.7, 0.3),
+                                angular=traits.Limits(1.0, 0.45),
+                                profile=profile)
+
+
+class Fleet:
+    """A mock fleet adapter with one robot on every waypoint of a grid"""
+
+    def __init__(self, num_robots):
+        self.side = int(np.ceil(np.sqrt(num_robots)))
+        self.graph = build_grid_bulk(self.side)
+        self.traits = make_traits()
+        self.adapter = adpt.MockAdapter("binding_benchmark_%d" % num_robots)
+        self.fleet = self.adapter.add_fleet(
+            "benchmark_fleet", self.traits, self.graph)
+        self.adapter.start()
+
+        self.commands = []
+        self.updaters = [None] * num_robots
+        ready = threading.Semaphore(0)
+
+        def on_ready(i, updater):
+            self.updaters[i] = updater
+            ready.release()
+
+        for i in range(num_robots):
+            command = IdleRobotCommand()
+            self.commands.append(command)
+            self.fleet.add_robot(
+                command, "robot_%d" % i, self.traits.profile,
+                [plan.Start(self.adapter.now(), i, 0.0)],
+                lambda updater, i=i: on_ready(i, updater))
+
+        for _ in range(num_robots):
+            if not ready.acquire(timeout=30.0):
+                raise RuntimeError("Timed out while adding robots")
+
+        self.waypoints = np.arange(num_robots, dtype=np.int64)
+        self.orientations = np.zeros(num_robots)
+        self.positions = np.zeros((num_robots, 3))
+        self.positions[:, :2] = spacing * np.stack(
+            [self.waypoints % self.side, self.waypoints // self.side], axis=1)
+        self.socs = np.full(num_robots, 0.8)
+
+        start_time = self.adapter.now()
+        self.routes = [
+            [schedule.Route(map_name, schedule.make_trajectory(
+                self.traits, start_time,
+                [p, p + [spacing, 0.0, 0.0]]))]
+            for p in self.positions]
+        self.participants = [
+            u.get_unstable_participant() for u in self.updaters]
+
+    def stop(self):
+        self.adapter.stop()
+
+
+def run_case(name, run, min_time):
+    # Warm up the caches and the allocator before measuring
+    for _ in range(3):
+        run()
+
+    iterations = 0
+    batch = 1
+    start = time.perf_counter()
+    elapsed = 0.0
+    while elapsed < min_time:
+        for _ in range(batch):
+            run()
+        iterations += batch
+        batch *= 2
+        elapsed = time.perf_counter() - start
+
+    ns_per_op = 1e9 * elapsed / iterations
+    print("%-48s %15.0f ns %12d" % (name, ns_per_op, iterations))
+    sys.stdout.flush()
+    return ns_per_op
+
+
+fleet_case_names = [
+    "robot_updates/per_robot/%d",
+    "robot_updates/batched/%d",
+    "robot_updates/contended/%d",
+    "participant/set_itinerary/%d",
+]
+
+
+def fleet_cases(fleet, n):
+    updaters = fleet.updaters
+    planner = plan.Planner(plan.Configuration(fleet.graph, fleet.traits))
+    start = plan.Start(datetime.datetime.now(), 0, 0.0)
+    goal = plan.Goal(fleet.graph.num_waypoints - 1)
+
+    def per_robot_updates():
+        for i, u in enumerate(updaters):
+            u.update_current_waypoint(i, 0.0)
+            u.update_battery_soc(0.8)
+
+    def batched_updates():
+        updates = adpt.RobotUpdates()
+        updates.update_current_waypoints(
+            updaters, fleet.waypoints, fleet.orientations)
+        updates.update_battery_socs(updaters, fleet.socs)
+        fleet.fleet.update_robots(updates)
+
+    def set_itineraries():
+        for participant, routes in zip(fleet.participants, fleet.routes):
+            participant.set_itinerary(routes)
+
+    def contended_updates():
+        # Another Python thread plans in a loop while the robots get updated.
+        # Planning releases the GIL, so this should stay close to the
+        # uncontended time.
+        stop = threading.Event()
+
+        def plan_loop():
+            while not stop.is_set():
+                planner.get_plan_waypoints(start, goal)
+
+        thread = threading.Thread(target=plan_loop)
+        thread.start()
+        try:
+            per_robot_updates()
+        finally:
+            stop.set()
+            thread.join()
+
+    runs = [per_robot_updates, batched_updates, contended_updates,
+            set_itineraries]
+    return [(name % n, run) for name, run in zip(fleet_case_names, runs)]
+
+
+def graph_cases(n):
+    side = int(np.ceil(np.sqrt(n)))
+    planner = plan.Planner(plan.Configuration(
+        build_grid_bulk(side), make_traits()))
+    start = plan.Start(datetime.datetime.now(), 0, 0.0)
+    goal = plan.Goal(side * side - 1)
+
+    return [
+        ("graph/per_call/%d" % n, lambda: build_grid_per_call(side)),
+        ("graph/bulk/%d" % n, lambda: build_grid_bulk(side)),
+        ("plan/waypoints/%d" % n,
+         lambda: planner.get_plan_waypoints(start, goal)),
+        ("plan/arrays/%d" % n,
+         lambda: planner.get_plan_arrays(start, goal)),
+    ]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Measure the overhead of the rmf_adapter bindings")
+    parser.add_argument("--filter", default="")
+    parser.add_argument("--min_time", type=float, default=0.5)
+    parser.add_argument("--robots", default="100,1000")
+    parser.add_argument("--save", default=None)
+    parser.add_argument("--baseline", default=None)
+    parser.add_argument("--tolerance", type=float, default=0.25)
+    args = parser.parse_args()
+
+    try:
+        adpt.init_rclcpp()
+    except RuntimeError:
+        # Continue if it is already initialized
+        pass
+
+    print("%-48s %18s %12s" % ("Benchmark", "Time", "Iterations"))
+    print("-" * 80)
+
+    results = {}
+    for n in [int(r) for r in args.robots.split(",")]:
+        cases = graph_cases(n)
+
+        # Adding the robots takes a while, so only do it if a fleet case will
+        # be run
+        fleet = None
+        if any(args.filter in (name % n) for name in fleet_case_names):
+            fleet = Fleet(n)
+            cases += fleet_cases(fleet, n)
+
+        for name, run in cases:
+            if args.filter in name:
+                results[name] = run_case(name, run, args.min_time)
+
+        if fleet is not None:
+            fleet.stop()
+
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+
+    if not args.baseline:
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    regressions = 0
+    for name, ns_per_op in sorted(results.items()):
+        expected = baseline.get(name)
+        if expected is None:
+            continue
+
+        if ns_per_op > expected * (1.0 + args.tolerance):
+            regressions += 1
+            print("REGRESSION: %s took %.0f ns instead of %.0f ns" %
+                  (name, ns_per_op, expected))
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
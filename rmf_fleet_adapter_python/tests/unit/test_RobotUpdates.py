@@ -0,0 +1,24 @@
+import numpy as np
+import pytest
+
+import rmf_adapter as adpt
+
+
+def test_bulk_updates_check_their_arrays():
+    updates = adpt.RobotUpdates()
+    assert len(updates) == 0
+
+    updates.update_current_waypoints([], np.array([], dtype=np.int64), [])
+    updates.update_off_grid_positions([], np.zeros((0, 3)), [])
+    updates.update_lost_positions([], "L1", np.zeros((0, 3)))
+    updates.update_battery_socs([], [])
+    assert len(updates) == 0
+
+    with pytest.raises(RuntimeError):
+        updates.update_battery_socs([], [0.5])
+
+    with pytest.raises(RuntimeError):
+        updates.update_off_grid_positions([], np.zeros((0, 2)), [])
+
+    other = adpt.RobotUpdates()
+    assert len(updates.append(other)) == 0
@@ -0,0 +1,100 @@
+import asyncio
+import threading
+
+from rmf_fleet_adapter_python.asyncio_bridge import (
+    LoopBridge, AsyncRobotCommandHandle)
+
+
+class SlowHandle(AsyncRobotCommandHandle):
+    __test__ = False
+
+    def __init__(self, bridge):
+        AsyncRobotCommandHandle.__init__(self, bridge)
+        self.loop_thread = None
+        self.finished = []
+        self.cancelled = []
+
+    async def on_follow_new_path(self,
+                                 waypoints,
+                                 next_arrival_estimator,
+                                 path_finished_callback):
+        self.loop_thread = threading.get_ident()
+        try:
+            await asyncio.sleep(waypoints)
+        except asyncio.CancelledError:
+            self.cancelled.append(waypoints)
+            raise
+        self.finished.append(waypoints)
+        path_finished_callback()
+
+    async def on_dock(self, dock_name, docking_finished_callback):
+        docking_finished_callback()
+
+
+def run(coroutine):
+    loop = asyncio.new_event_loop()
+    try:
+        return loop.run_until_complete(coroutine(loop))
+    finally:
+        loop.close()
+
+
+def test_post_from_other_threads():
+    async def body(loop):
+        bridge = LoopBridge(loop)
+        future, resolve = bridge.future()
+        received = []
+
+        def callback(value):
+            received.append((value, threading.get_ident()))
+            if len(received) == 10:
+                resolve(len(received))
+
+        threads = [
+            threading.Thread(target=bridge.wrap(callback), args=(i,))
+            for i in range(10)]
+        for t in threads:
+            t.start()
+
+        assert await asyncio.wait_for(future, 5.0) == 10
+        for t in threads:
+            t.join()
+
+        assert all(ident == threading.get_ident() for _, ident in received)
+        assert sorted(value for value, _ in received) == list(range(10))
+
+    run(body)
+
+
+def test_new_command_cancels_previous_one():
+    async def body(loop):
+        bridge = LoopBridge(loop)
+        handle = SlowHandle(bridge)
+        future, resolve = bridge.future()
+
+        # Commands arrive from the adapter's threads
+        first = threading.Thread(
+            target=handle.follow_new_path, args=(10.0, None, None))
+        first.start()
+        first.join()
+        await asyncio.sleep(0.05)
+
+        second = threading.Thread(
+            target=handle.follow_new_path, args=(0.01, None, resolve))
+        second.start()
+        second.join()
+
+        await asyncio.wait_for(future, 5.0)
+        assert handle.cancelled == [10.0]
+        assert handle.finished == [0.01]
+        assert handle.loop_thread == threading.get_ident()
+
+    run(body)
+
+
+def test_awaitable_blocking_call():
+    async def body(loop):
+        bridge = LoopBridge(loop)
+        assert await bridge.run_blocking(sum, [1, 2, 3]) == 6
+
+    run(body)
@@ -347,3 +347,32 @@ def test_graph():
         rawr_graph.add_dock_lane(*_lane, "test")
 
     assert rawr_graph.num_lanes == 49
+
+
+def test_bulk_graph():
+    bulk_graph = graph.Graph()
+    locations = np.array([[0.0, 0.0], [5.0, 0.0], [5.0, 5.0], [0.0, 5.0]])
+    flags = np.array([graph.WaypointFlag.HoldingPoint, 0,
+                      graph.WaypointFlag.Charger
+                      | graph.WaypointFlag.ParkingSpot, 0], dtype=np.uint8)
+
+    assert bulk_graph.add_waypoints(
+        ["L1", "L2"], locations, np.array([0, 0, 0, 1]), flags) == 0
+    assert bulk_graph.num_waypoints == 4
+    assert bulk_graph.get_waypoint(0).holding_point
+    assert bulk_graph.get_waypoint(2).charger
+    assert bulk_graph.get_waypoint(2).parking_spot
+    assert not bulk_graph.get_waypoint(1).holding_point
+    assert bulk_graph.get_waypoint(3).map_name == "L2"
+    assert (bulk_graph.get_waypoint(1).location == [5.0, 0.0]).all()
+
+    assert bulk_graph.add_waypoints(["L1"], [[10.0, 0.0]]) == 4
+
+    lanes = np.array([[0, 1], [1, 2], [2, 3]])
+    assert bulk_graph.add_lanes(lanes, bidirectional=True) == 0
+    assert bulk_graph.num_lanes == 6
+    assert bulk_graph.add_lanes(
+        [[0, 4]], door_names=["door"]) == 6
+    assert bulk_graph.num_lanes == 7
+    assert bulk_graph.lane_from(1, 2) is not None
+    assert bulk_graph.lane_from(2, 1) is not None
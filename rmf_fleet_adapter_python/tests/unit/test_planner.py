@@ -75,3 +75,18 @@ start = plan.Start(
 goal = plan.Goal(7)
 waypoints = planner.get_plan_waypoints(start, goal)
 assert(waypoints)
+
+positions, times, graph_indices = planner.get_plan_arrays(start, goal)
+assert positions.shape == (len(waypoints), 3)
+assert len(times) == len(waypoints)
+assert graph_indices[-1] == 7
+for i, wp in enumerate(waypoints):
+    assert (positions[i] == wp.position).all()
+    if wp.graph_index is None:
+        assert graph_indices[i] == -1
+    else:
+        assert graph_indices[i] == wp.graph_index
+
+positions, times, graph_indices = plan.waypoint_arrays(waypoints)
+assert positions.shape == (len(waypoints), 3)
+assert (times[1:] >= times[:-1]).all()
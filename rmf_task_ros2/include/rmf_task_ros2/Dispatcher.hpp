@@ -23,6 +23,8 @@
 #include <rmf_utils/impl_ptr.hpp>
 #include <rmf_utils/optional.hpp>
 
+#include <vector>
+
 #include <rmf_task_ros2/bidding/Auctioneer.hpp>
 #include <rmf_task_ros2/TaskStatus.hpp>
 
@@ -81,6 +83,19 @@ public:
   std::optional<TaskID> submit_task(
     const TaskDescription& task_description);
 
+  /// Submit several tasks to the dispatcher at once. This is equivalent to
+  /// calling submit_task() for each description, except that the batch is
+  /// all-or-nothing: if any description has an invalid task type then none of
+  /// the tasks are submitted. The tasks are bid for in the order given.
+  ///
+  /// \param [in] task_descriptions
+  ///   The tasks to dispatch
+  ///
+  /// \return the self-generated task_ids, in the same order as the
+  ///   descriptions, or nullopt if the batch was rejected
+  std::optional<std::vector<TaskID>> submit_tasks(
+    const std::vector<TaskDescription>& task_descriptions);
+
   /// Cancel an active task which was previously submitted to Dispatcher. This
   /// will terminate the task with a State of: `Canceled`. If a task is
   /// `Queued` or `Executing`, this function will send a cancel req to
@@ -102,11 +117,26 @@ public:
   const rmf_utils::optional<TaskStatus::State> get_task_state(
     const TaskID& task_id) const;
 
-  /// Get a mutable ref of active tasks map list handled by dispatcher
-  const DispatchTasks& active_tasks() const;
+  /// Get a copy of the active tasks that are handled by the dispatcher. The
+  /// statuses are copied while the dispatcher is locked, so this is safe to
+  /// call while the node is being spun by other threads. Later changes to the
+  /// tasks will not be reflected in the copy.
+  DispatchTasks active_tasks() const;
 
-  /// Get a mutable ref of terminated tasks map list
-  const DispatchTasks& terminated_tasks() const;
+  /// Get a copy of the terminated tasks, in the same way as active_tasks().
+  DispatchTasks terminated_tasks() const;
+
+  /// Get a page of the terminated tasks, ordered from the most recently
+  /// submitted task to the earliest one.
+  ///
+  /// \param [in] offset
+  ///   The number of more recent tasks to skip
+  ///
+  /// \param [in] limit
+  ///   The largest number of tasks to return
+  std::vector<TaskStatusPtr> terminated_tasks(
+    std::size_t offset,
+    std::size_t limit) const;
 
   using StatusCallback = std::function<void(const TaskStatusPtr status)>;
 
@@ -126,7 +156,9 @@ public:
   /// Get the rclcpp::Node that this dispatcher will be using for communication.
   std::shared_ptr<rclcpp::Node> node();
 
-  /// spin dispatcher node
+  /// spin dispatcher node with a multi-threaded executor. The number of
+  /// threads is given by the executor_threads parameter, where 0 uses one
+  /// thread per core.
   void spin();
 
   class Implementation;
@@ -18,6 +18,7 @@
 #ifndef RMF_TASK_ROS2__STANDARDNAMES_HPP
 #define RMF_TASK_ROS2__STANDARDNAMES_HPP
 
+#include <cstdint>
 #include <string>
 
 namespace rmf_task_ros2 {
@@ -26,6 +27,15 @@ const std::string Prefix = "rmf_task/";
 const std::string BidNoticeTopicName = Prefix + "bid_notice";
 const std::string BidProposalTopicName = Prefix + "bid_proposal";
 
+// Each bid notice is also published on a topic for its task type, so bidders
+// that only serve some types of tasks never receive the others.
+const std::string BidNoticeTaskTypeTopicPrefix = BidNoticeTopicName + "/type_";
+
+inline std::string bid_notice_topic_name(uint32_t task_type)
+{
+  return BidNoticeTaskTypeTopicPrefix + std::to_string(task_type);
+}
+
 const std::string SubmitTaskSrvName = "submit_task";
 const std::string CancelTaskSrvName = "cancel_task";
 const std::string GetTaskListSrvName = "get_tasks";
@@ -33,7 +43,9 @@ const std::string GetTaskListSrvName = "get_tasks";
 const std::string TaskRequestTopicName = Prefix + "dispatch_request";
 const std::string TaskAckTopicName = Prefix + "dispatch_ack";
 const std::string TaskStatusTopicName = "task_summaries";
+const std::string TaskStatusBatchTopicName = "task_summaries_batch";
 const std::string ActiveTasksTopicName = "dispatcher_ongoing_tasks";
+const std::string TaskChangesTopicName = "dispatcher_task_changes";
 
 } // namespace rmf_task_ros2
 
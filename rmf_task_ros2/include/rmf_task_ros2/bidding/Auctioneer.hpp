@@ -22,6 +22,9 @@
 #include <rclcpp/node.hpp>
 #include <rmf_utils/impl_ptr.hpp>
 
+#include <rmf_traffic/Time.hpp>
+#include <rmf_traffic_ros2/Metrics.hpp>
+
 #include <rmf_task_ros2/bidding/Submission.hpp>
 
 namespace rmf_task_ros2 {
@@ -59,13 +62,71 @@ public:
     const std::shared_ptr<rclcpp::Node>& node,
     BiddingResultCallback result_callback);
 
-  /// Start a bidding process by provide a bidding task. Note the each
-  /// bidding process is conducted sequentially
+  /// Start a bidding process by provide a bidding task. Up to
+  /// max_concurrent_auctions() bidding processes are conducted at the same
+  /// time. Any other bidding tasks wait in a queue until an auction closes.
+  ///
+  /// High priority tasks wait in a separate queue that is served before any
+  /// low priority task. One high priority auction may be opened on top of
+  /// max_concurrent_auctions(), so an urgent task does not have to wait for
+  /// low priority auctions to close.
   ///
   /// \param[in] bid_notice
   ///   bidding task, task which will call for bid
   void start_bidding(const BidNotice& bid_notice);
 
+  /// Set the maximum number of auctions that may be open at the same time.
+  /// The default is 1, which conducts the auctions one after another. A value
+  /// of 0 is treated as 1.
+  ///
+  /// When auctions overlap, a fleet may receive a new BidNotice before it
+  /// learns whether it has won an earlier one, so each bid is planned against
+  /// the tasks that the fleet had been assigned at the time. Fleet adapters
+  /// are expected to check whether their assignments have changed since a
+  /// bid was planned when that bid is awarded, and to replan the task into
+  /// their current assignments if they have.
+  Auctioneer& max_concurrent_auctions(std::size_t value);
+
+  /// Get the maximum number of auctions that may be open at the same time.
+  std::size_t max_concurrent_auctions() const;
+
+  /// Close an auction as soon as every fleet that is known to be present has
+  /// submitted a proposal for it, instead of waiting until the end of its
+  /// time window. This is off by default.
+  ///
+  /// A fleet is known to be present if it was given to register_fleet(), or
+  /// if it has submitted a proposal for any auction within the
+  /// fleet_presence_timeout(). A fleet that has never done either is not
+  /// waited for, so it may miss auctions that close early until it submits
+  /// its first proposal.
+  Auctioneer& close_auctions_early(bool value);
+
+  /// Check whether auctions are closed early.
+  bool close_auctions_early() const;
+
+  /// Set how long a fleet that has submitted a proposal is considered to be
+  /// present. The default is 60 seconds.
+  Auctioneer& fleet_presence_timeout(rmf_traffic::Duration value);
+
+  /// Get how long a fleet that has submitted a proposal is considered to be
+  /// present.
+  rmf_traffic::Duration fleet_presence_timeout() const;
+
+  /// Register a fleet that is always expected to bid, until it is given to
+  /// unregister_fleet().
+  void register_fleet(const std::string& fleet_name);
+
+  /// Stop expecting a registered fleet to bid.
+  void unregister_fleet(const std::string& fleet_name);
+
+  /// Record how many auctions are opened and concluded, how long they take,
+  /// and how many proposals each fleet submits in a Metrics registry. Pass
+  /// in a nullptr to stop recording, which is the default.
+  Auctioneer& metrics(std::shared_ptr<rmf_traffic_ros2::Metrics> value);
+
+  /// Get the registry that the auctions are recorded in, if any.
+  std::shared_ptr<rmf_traffic_ros2::Metrics> metrics() const;
+
   /// A pure abstract interface class for the auctioneer to choose the best
   /// choosing the best submissions.
   class Evaluator
@@ -113,6 +174,47 @@ public:
   std::size_t choose(const Submissions& submissions) const final;
 };
 
+//==============================================================================
+/// Scores every submission on several criteria and chooses the one with the
+/// lowest weighted sum. Each criterion is scaled across the submissions to the
+/// range [0, 1], so the weights do not depend on the units of cost or time.
+/// Ties go to the earliest submission.
+class WeightedEvaluator : public Auctioneer::Evaluator
+{
+public:
+
+  struct Weights
+  {
+    /// How much the fleet's cost would increase, as with
+    /// LeastFleetDiffCostEvaluator
+    double cost_diff = 1.0;
+
+    /// The fleet's cost with the task, as with LeastFleetCostEvaluator
+    double new_cost = 0.0;
+
+    /// When the task would be finished, as with QuickestFinishEvaluator
+    double finish_time = 0.0;
+
+    /// The fleet's cost without the task. Weighing this favors the fleets
+    /// that are less busy, which balances the tasks among the fleets.
+    double fleet_load = 0.0;
+  };
+
+  /// Constructor
+  ///
+  /// \param[in] weights
+  ///   How much each criterion counts towards the score of a submission
+  WeightedEvaluator(Weights weights);
+
+  /// Get the weights of the criteria.
+  const Weights& weights() const;
+
+  std::size_t choose(const Submissions& submissions) const final;
+
+private:
+  Weights _weights;
+};
+
 } // namespace bidding
 } // namespace rmf_task_ros2
 
@@ -64,7 +64,9 @@ public:
   ///   Name of the bidder
   ///
   /// \param[in] valid_task_types
-  ///   A list of valid tasks types which are supported by the bidder
+  ///   A list of valid tasks types which are supported by the bidder. The
+  ///   bidder only subscribes to the bid notices of these task types, so the
+  ///   auctioneer's notices for other types of tasks never reach it.
   ///
   /// \param[in] submission_cb
   ///   fn which is used to provide a bid submission during a call for bid
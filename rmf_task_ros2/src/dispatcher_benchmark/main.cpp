@@ -0,0 +1,517 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// This benchmark runs a Dispatcher in-process together with a number of mock
+// fleets, each made of a MinimalBidder and an action server like the ones of
+// rmf_bidder_node. Tasks are submitted to the dispatcher at a steady rate and
+// each one is tracked until its auction has concluded. It reports
+//   - the latency from submitting a task until it is queued by a fleet (award)
+//   - the number of auctions that were concluded per second
+//   - the CPU time of the dispatcher's executor thread and of the process
+//   - the memory of the process
+//
+// Every parameter is given through --ros-args, for example
+//
+//   rmf_dispatcher_benchmark --ros-args -p fleets:=20 -p submission_rate:=10.0
+//
+// Parameters of the Dispatcher itself, such as bidding_time_window,
+// max_concurrent_auctions or close_auctions_early, can be passed the same way.
+// With the default parameters of the Dispatcher, every auction stays open for
+// the whole bidding window, so the throughput is bound by that window.
+//
+// When max_award_p99 or min_throughput are set, the benchmark exits with a
+// non-zero status if the run does not meet them, so it can be used as a
+// regression gate. Run this on an isolated ROS_DOMAIN_ID so that it does not
+// interfere with a live dispatcher.
+
+#include <rmf_task_ros2/Dispatcher.hpp>
+#include <rmf_task_ros2/bidding/MinimalBidder.hpp>
+#include "../rmf_task_ros2/action/Server.hpp"
+
+#include <rclcpp/rclcpp.hpp>
+#include <rmf_traffic_ros2/Time.hpp>
+
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+using namespace std::chrono_literals;
+using namespace rmf_task_ros2;
+
+using Clock = std::chrono::steady_clock;
+using TaskType = bidding::MinimalBidder::TaskType;
+
+namespace {
+//==============================================================================
+struct Options
+{
+  std::size_t fleets;
+  double planning_delay;
+  double planning_jitter;
+  double submission_rate;
+  double execution_time;
+  double duration;
+  double warmup;
+  double drain;
+  double max_award_p99;
+  double min_throughput;
+  int seed;
+
+  static Options from(rclcpp::Node& node)
+  {
+    Options o;
+    o.fleets = static_cast<std::size_t>(
+      std::max<int64_t>(1, node.declare_parameter<int>("fleets", 10)));
+    o.planning_delay = node.declare_parameter<double>("planning_delay", 0.05);
+    o.planning_jitter = node.declare_parameter<double>("planning_jitter", 0.5);
+    o.submission_rate = node.declare_parameter<double>("submission_rate", 2.0);
+    o.execution_time = node.declare_parameter<double>("execution_time", 5.0);
+    o.duration = node.declare_parameter<double>("duration", 30.0);
+    o.warmup = node.declare_parameter<double>("warmup", 5.0);
+    o.drain = node.declare_parameter<double>("drain", 5.0);
+    o.max_award_p99 = node.declare_parameter<double>("max_award_p99", 0.0);
+    o.min_throughput = node.declare_parameter<double>("min_throughput", 0.0);
+    o.seed = node.declare_parameter<int>("seed", 42);
+    return o;
+  }
+};
+
+//==============================================================================
+/// Latency samples of the benchmark, printed as a percentile summary
+class Samples
+{
+public:
+
+  void add(const Clock::duration value)
+  {
+    _values.push_back(
+      std::chrono::duration<double, std::milli>(value).count());
+  }
+
+  /// Get the given percentile in milliseconds, or 0 if there are no samples.
+  double percentile(const double p)
+  {
+    if (_values.empty())
+      return 0.0;
+
+    std::sort(_values.begin(), _values.end());
+    const auto index = static_cast<std::size_t>(
+      p * static_cast<double>(_values.size() - 1));
+    return _values[index];
+  }
+
+  void print(const std::string& name)
+  {
+    std::cout << "  " << std::left << std::setw(10) << name << std::right;
+    if (_values.empty())
+    {
+      std::cout << " no samples\n";
+      return;
+    }
+
+    double total = 0.0;
+    for (const auto v : _values)
+      total += v;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << " n=" << std::setw(8) << _values.size()
+              << " mean=" << std::setw(9) << total / _values.size()
+              << " p50=" << std::setw(9) << percentile(0.5)
+              << " p90=" << std::setw(9) << percentile(0.9)
+              << " p99=" << std::setw(9) << percentile(0.99)
+              << " max=" << std::setw(9) << percentile(1.0)
+              << "  [ms]\n";
+  }
+
+private:
+  std::vector<double> _values;
+};
+
+//==============================================================================
+// Every task that is submitted will be tracked until its auction concludes,
+// which is either when a fleet queues it or when it fails.
+class Tracker
+{
+public:
+
+  void submitted(const TaskID& id)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_num_submitted;
+    _submitted[id] = {Clock::now(), _recording};
+  }
+
+  void changed(const TaskStatus& status)
+  {
+    const bool awarded = status.state == TaskStatus::State::Queued;
+    const bool failed = status.state == TaskStatus::State::Failed;
+    if (!awarded && !failed)
+      return;
+
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _submitted.find(status.task_profile.task_id);
+    if (it == _submitted.end())
+      return;
+
+    const auto sent = it->second;
+    _submitted.erase(it);
+
+    // Throughput counts every auction that concludes while recording, while
+    // latency only counts the tasks that were also submitted while recording.
+    if (_recording)
+      ++_num_concluded;
+
+    if (!sent.recording)
+      return;
+
+    if (awarded)
+    {
+      ++_num_awarded;
+      award.add(now - sent.time);
+    }
+    else
+      ++_num_failed;
+  }
+
+  void recording(const bool choice)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _recording = choice;
+  }
+
+  /// Print the results, and return false if they do not meet the gates of the
+  /// options.
+  bool report(
+    const Options& options,
+    const double wall_seconds,
+    const double dispatcher_cpu_seconds,
+    const double process_cpu_seconds)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const double throughput = _num_concluded / wall_seconds;
+
+    std::cout << "\nDispatcher benchmark with " << options.fleets
+              << " fleets over " << wall_seconds << "s\n"
+              << "  tasks submitted: " << _num_submitted
+              << ", awarded while recording: " << _num_awarded
+              << ", failed while recording: " << _num_failed
+              << ", still in auction: " << _submitted.size() << "\n";
+
+    award.print("award");
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "  throughput: " << throughput << " auctions/s\n"
+              << "  cpu: " << 100.0 * dispatcher_cpu_seconds / wall_seconds
+              << "% of one core in the dispatcher thread, "
+              << 100.0 * process_cpu_seconds / wall_seconds
+              << "% for the whole process (includes the fleets)\n"
+              << "  memory: " << read_status_kb("VmRSS:") << " kB resident, "
+              << read_status_kb("VmHWM:") << " kB peak "
+              << "(includes the fleets)\n";
+
+    bool passed = true;
+    const double p99 = award.percentile(0.99) / 1000.0;
+    if (options.max_award_p99 > 0.0 && p99 > options.max_award_p99)
+    {
+      std::cout << "REGRESSION: award p99 of " << p99 << "s is above "
+                << options.max_award_p99 << "s\n";
+      passed = false;
+    }
+
+    if (options.min_throughput > 0.0 && throughput < options.min_throughput)
+    {
+      std::cout << "REGRESSION: throughput of " << throughput
+                << " auctions/s is below " << options.min_throughput << "\n";
+      passed = false;
+    }
+
+    return passed;
+  }
+
+  Samples award;
+
+private:
+
+  struct Sent
+  {
+    Clock::time_point time;
+    bool recording;
+  };
+
+  static std::string read_status_kb(const std::string& field)
+  {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+      if (line.rfind(field, 0) != 0)
+        continue;
+
+      std::istringstream value(line.substr(field.size()));
+      std::string kb;
+      value >> kb;
+      return kb;
+    }
+
+    return "?";
+  }
+
+  std::mutex _mutex;
+  bool _recording = false;
+  std::size_t _num_submitted = 0;
+  std::size_t _num_concluded = 0;
+  std::size_t _num_awarded = 0;
+  std::size_t _num_failed = 0;
+  std::unordered_map<TaskID, Sent> _submitted;
+};
+
+//==============================================================================
+double cpu_seconds()
+{
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  const auto to_seconds = [](const timeval& t)
+    {
+      return static_cast<double>(t.tv_sec) + 1e-6 * t.tv_usec;
+    };
+
+  return to_seconds(usage.ru_utime) + to_seconds(usage.ru_stime);
+}
+
+//==============================================================================
+double cpu_seconds(std::thread& thread)
+{
+  clockid_t clock;
+  timespec t;
+  if (pthread_getcpuclockid(thread.native_handle(), &clock) != 0
+    || clock_gettime(clock, &t) != 0)
+    return 0.0;
+
+  return static_cast<double>(t.tv_sec) + 1e-9 * t.tv_nsec;
+}
+
+//==============================================================================
+// A mock fleet adapter. It bids for every task after a simulated planning
+// delay, and completes the tasks that it wins after the execution time.
+class Fleet
+{
+public:
+
+  Fleet(const std::string& fleet_name, const Options& options, const int seed)
+  : node(std::make_shared<rclcpp::Node>(fleet_name)),
+    _fleet_name(fleet_name),
+    _execution_time(options.execution_time),
+    _rng(seed)
+  {
+    const double delay = options.planning_delay;
+    const double jitter = std::clamp(options.planning_jitter, 0.0, 1.0);
+    std::uniform_real_distribution<double> fleet_cost(0.0, 100.0);
+    const double prev_cost = fleet_cost(_rng);
+
+    _bidder = bidding::MinimalBidder::make(
+      node,
+      _fleet_name,
+      { TaskType::Station, TaskType::Clean, TaskType::Delivery },
+      [this, delay, jitter, prev_cost](const bidding::BidNotice& notice)
+      {
+        std::uniform_real_distribution<double> planning(
+          delay * (1.0 - jitter), delay * (1.0 + jitter));
+        std::uniform_real_distribution<double> task_cost(1.0, 20.0);
+
+        // Planning blocks this fleet's executor just like a real fleet
+        // adapter would be busy while it plans.
+        std::this_thread::sleep_for(
+          std::chrono::duration<double>(planning(_rng)));
+
+        const auto start = rmf_traffic_ros2::convert(
+          notice.task_profile.description.start_time);
+        const double cost = task_cost(_rng);
+
+        bidding::Submission submission;
+        submission.robot_name = "robot";
+        submission.prev_cost = prev_cost;
+        submission.new_cost = prev_cost + cost;
+        submission.finish_time = rmf_traffic::time::apply_offset(start, cost);
+        return submission;
+      });
+
+    _action_server = action::Server::make(node, _fleet_name);
+    _action_server->register_callbacks(
+      [this](const TaskProfile& task_profile)
+      {
+        TaskStatus status;
+        status.task_profile = task_profile;
+        status.robot_name = "robot";
+        _executing.push_back(
+          {Clock::now() + std::chrono::duration_cast<Clock::duration>(
+              std::chrono::duration<double>(_execution_time)),
+            std::move(status)});
+        return true; // The action server sends State::Queued
+      },
+      [](const TaskProfile&)
+      {
+        return true; // The action server sends State::Canceled
+      });
+
+    _execution_timer = node->create_wall_timer(
+      100ms, [this]()
+      {
+        const auto now = Clock::now();
+        while (!_executing.empty() && _executing.front().first <= now)
+        {
+          auto& status = _executing.front().second;
+          status.state = TaskStatus::State::Completed;
+          _action_server->update_status(status);
+          _executing.pop_front();
+        }
+      });
+  }
+
+  std::shared_ptr<rclcpp::Node> node;
+
+private:
+  std::string _fleet_name;
+  double _execution_time;
+  std::mt19937 _rng;
+  std::shared_ptr<bidding::MinimalBidder> _bidder;
+  std::shared_ptr<action::Server> _action_server;
+  rclcpp::TimerBase::SharedPtr _execution_timer;
+
+  // Every task takes the same time, so they finish in the order they came
+  std::deque<std::pair<Clock::time_point, TaskStatus>> _executing;
+};
+
+} // anonymous namespace
+
+//==============================================================================
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+
+  Tracker tracker;
+  const auto dispatcher = Dispatcher::make_node("rmf_dispatcher_benchmark");
+  dispatcher->on_change(
+    [&tracker](const TaskStatusPtr status)
+    {
+      tracker.changed(*status);
+    });
+
+  auto driver_node = std::make_shared<rclcpp::Node>(
+    "rmf_dispatcher_benchmark_driver");
+  const auto options = Options::from(*driver_node);
+
+  // Each fleet gets its own executor thread, like a separate fleet adapter
+  // process would, so that fleets plan their bids in parallel.
+  std::vector<std::unique_ptr<Fleet>> fleets;
+  std::vector<std::unique_ptr<rclcpp::executors::SingleThreadedExecutor>>
+  fleet_executors;
+  std::vector<std::thread> fleet_threads;
+  for (std::size_t i = 0; i < options.fleets; ++i)
+  {
+    fleets.push_back(
+      std::make_unique<Fleet>(
+        "benchmark_fleet_" + std::to_string(i), options,
+        options.seed + static_cast<int>(i)));
+
+    fleet_executors.push_back(
+      std::make_unique<rclcpp::executors::SingleThreadedExecutor>());
+    auto& executor = *fleet_executors.back();
+    executor.add_node(fleets.back()->node);
+    fleet_threads.emplace_back([&executor]() { executor.spin(); });
+  }
+
+  // Tasks are submitted from the dispatcher's own executor, since the
+  // dispatcher is not meant to be called from other threads.
+  rclcpp::executors::SingleThreadedExecutor dispatcher_executor;
+  dispatcher_executor.add_node(dispatcher->node());
+  dispatcher_executor.add_node(driver_node);
+  std::thread dispatcher_thread([&]() { dispatcher_executor.spin(); });
+
+  rclcpp::TimerBase::SharedPtr submit_timer;
+  if (options.submission_rate > 0.0)
+  {
+    const auto period = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(1.0 / options.submission_rate));
+
+    submit_timer = driver_node->create_wall_timer(
+      period, [&]()
+      {
+        Dispatcher::TaskDescription description;
+        description.task_type.type = rmf_task_msgs::msg::TaskType::TYPE_STATION;
+        description.start_time = driver_node->now();
+
+        const auto id = dispatcher->submit_task(description);
+        if (id)
+          tracker.submitted(*id);
+      });
+  }
+
+  RCLCPP_INFO(
+    driver_node->get_logger(),
+    "Started %lu fleets; warming up for %.1fs",
+    fleets.size(), options.warmup);
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.warmup));
+
+  tracker.recording(true);
+  const auto wall_start = Clock::now();
+  const double dispatcher_cpu_start = cpu_seconds(dispatcher_thread);
+  const double process_cpu_start = cpu_seconds();
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.duration));
+
+  tracker.recording(false);
+  const double wall = std::chrono::duration<double>(
+    Clock::now() - wall_start).count();
+  const double dispatcher_cpu =
+    cpu_seconds(dispatcher_thread) - dispatcher_cpu_start;
+  const double process_cpu = cpu_seconds() - process_cpu_start;
+
+  // Give the auctions that are still open a chance to conclude
+  if (submit_timer)
+    submit_timer->cancel();
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.drain));
+
+  const bool passed = tracker.report(
+    options, wall, dispatcher_cpu, process_cpu);
+
+  dispatcher_executor.cancel();
+  for (auto& executor : fleet_executors)
+    executor->cancel();
+
+  dispatcher_thread.join();
+  for (auto& thread : fleet_threads)
+    thread.join();
+
+  // Nothing is spinning anymore, so the fleets can be safely torn down before
+  // the context goes away.
+  fleets.clear();
+  rclcpp::shutdown();
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_task_ros2/Dispatcher.hpp>
+
+#include <rclcpp_components/register_node_macro.hpp>
+
+namespace rmf_task_ros2 {
+
+//==============================================================================
+/// Loads a task dispatcher into a component container.
+class DispatcherComponent
+{
+public:
+
+  explicit DispatcherComponent(const rclcpp::NodeOptions& options)
+  : _dispatcher(
+      Dispatcher::make(
+        std::make_shared<rclcpp::Node>("rmf_dispatcher_node", options)))
+  {
+    // Do nothing
+  }
+
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
+  get_node_base_interface() const
+  {
+    return _dispatcher->node()->get_node_base_interface();
+  }
+
+private:
+  std::shared_ptr<Dispatcher> _dispatcher;
+};
+
+} // namespace rmf_task_ros2
+
+RCLCPP_COMPONENTS_REGISTER_NODE(rmf_task_ros2::DispatcherComponent)
@@ -18,16 +18,30 @@
 #include <rmf_task_ros2/Dispatcher.hpp>
 
 #include <rclcpp/node.hpp>
-#include <rclcpp/executors/single_threaded_executor.hpp>
+#include <rclcpp/executors/multi_threaded_executor.hpp>
 
 #include "action/Client.hpp"
+#include "bidding/internal_Auctioneer.hpp"
+#include "Synchronization.hpp"
+#include "TaskJournal.hpp"
 
 #include <rmf_task_msgs/srv/submit_task.hpp>
 #include <rmf_task_msgs/srv/cancel_task.hpp>
 #include <rmf_task_msgs/srv/get_task_list.hpp>
 #include <rmf_task_msgs/msg/tasks.hpp>
 
+#include <std_msgs/msg/string.hpp>
+
+#include <rmf_traffic_ros2/MemoryUsage.hpp>
+#include <rmf_traffic_ros2/Metrics.hpp>
+#include <rmf_traffic_ros2/MetricsExporter.hpp>
+#include <rmf_traffic_ros2/StandardNames.hpp>
 #include <rmf_traffic_ros2/Time.hpp>
+#include <rmf_traffic_ros2/Tracer.hpp>
+
+#include <algorithm>
+#include <set>
+#include <unordered_set>
 
 namespace rmf_task_ros2 {
 
@@ -39,6 +53,18 @@ public:
   std::shared_ptr<bidding::Auctioneer> auctioneer;
   std::shared_ptr<action::Client> action_client;
 
+  // Every callback of the dispatcher, the auctioneer and the action client
+  // locks this mutex, but they are split into callback groups so that a
+  // multi-threaded executor can do the work outside of the lock, like
+  // serializing a large task list, side by side with the other callbacks.
+  Synchronization sync;
+  rclcpp::CallbackGroup::SharedPtr submission_group;
+  rclcpp::CallbackGroup::SharedPtr task_list_group;
+  rclcpp::CallbackGroup::SharedPtr auction_group;
+  rclcpp::CallbackGroup::SharedPtr status_group;
+  rclcpp::CallbackGroup::SharedPtr publication_group;
+  int executor_threads;
+
   using SubmitTaskSrv = rmf_task_msgs::srv::SubmitTask;
   using CancelTaskSrv = rmf_task_msgs::srv::CancelTask;
   using GetTaskListSrv = rmf_task_msgs::srv::GetTaskList;
@@ -50,22 +76,64 @@ public:
 
   using ActiveTasksPub = rclcpp::Publisher<TasksMsg>;
   ActiveTasksPub::SharedPtr ongoing_tasks_pub;
+  ActiveTasksPub::SharedPtr task_changes_pub;
 
   rclcpp::TimerBase::SharedPtr timer;
+  rclcpp::TimerBase::SharedPtr task_changes_timer;
+
+  using MemoryUsageMsg = std_msgs::msg::String;
+  rclcpp::Publisher<MemoryUsageMsg>::SharedPtr memory_usage_pub;
+  rclcpp::TimerBase::SharedPtr memory_usage_timer;
+
+  // Counters of the tasks that pass through the dispatcher, which are shared
+  // with the auctioneer and exported according to the metrics parameters
+  using Metrics = rmf_traffic_ros2::Metrics;
+  std::shared_ptr<Metrics> metrics = std::make_shared<Metrics>();
+  std::shared_ptr<Metrics::Counter> submitted_tasks = metrics->counter(
+    "rmf_dispatcher_tasks_submitted", "Tasks that have been submitted");
+  std::shared_ptr<Metrics::Histogram> assignment_seconds = metrics->histogram(
+    "rmf_dispatcher_assignment_seconds",
+    "How long tasks took from their submission to being awarded to a fleet");
+  std::shared_ptr<Metrics::Gauge> active_tasks = metrics->gauge(
+    "rmf_dispatcher_active_tasks", "Tasks that have not terminated yet");
+  std::shared_ptr<Metrics::Gauge> bidding_tasks = metrics->gauge(
+    "rmf_dispatcher_bidding_tasks",
+    "Tasks that are waiting for or taking part in an auction");
+  std::shared_ptr<rmf_traffic_ros2::MetricsExporter> metrics_exporter;
+
+  // The tasks whose status changed since the last publication of changes
+  std::unordered_map<TaskID, TaskStatusPtr> changed_tasks;
+
+  // Records every change to the tasks so that they can be recovered after a
+  // restart. This is only used when a task_journal_path is given.
+  std::unique_ptr<TaskJournal> journal;
+  TaskJournal::State recovered;
 
   StatusCallback on_change_fn;
 
   std::queue<bidding::BidNotice> queue_bidding_tasks;
+  // Tasks whose auction has started, but which have not yet been heard from
+  // the winning fleet adapter
+  std::unordered_set<TaskID> bidding_in_flight;
 
   /// TODO: should rename "active" to "ongoing" to prevent confusion
   /// of with task STATE_ACTIVE
   DispatchTasks active_dispatch_tasks;
   DispatchTasks terminal_dispatch_tasks;
+  // The terminal_dispatch_tasks ordered by their submission time, so that the
+  // earliest one can be evicted without searching for it
+  std::set<std::pair<rmf_traffic::Time, TaskID>> terminated_index;
   std::set<std::string> user_submitted_tasks;  // ongoing submitted task_ids
   std::size_t task_counter = 0; // index for generating task_id
   double bidding_time_window;
   int terminated_tasks_max_size;
+  int task_list_max_terminated_tasks;
   int publish_active_tasks_period;
+  double task_changes_period;
+  double memory_usage_period;
+  int max_concurrent_auctions;
+  bool close_auctions_early;
+  double fleet_presence_timeout;
 
   std::unordered_map<std::size_t, std::string> task_type_name =
   {
@@ -80,6 +148,13 @@ public:
   Implementation(std::shared_ptr<rclcpp::Node> node_)
   : node{std::move(node_)}
   {
+    const auto exclusive = rclcpp::CallbackGroupType::MutuallyExclusive;
+    submission_group = node->create_callback_group(exclusive);
+    task_list_group = node->create_callback_group(exclusive);
+    auction_group = node->create_callback_group(exclusive);
+    status_group = node->create_callback_group(exclusive);
+    publication_group = node->create_callback_group(exclusive);
+
     // ros2 param
     bidding_time_window =
       node->declare_parameter<double>("bidding_time_window", 2.0);
@@ -90,20 +165,108 @@ public:
     RCLCPP_INFO(node->get_logger(),
       " Declared Terminated Tasks Max Size Param as: %d",
       terminated_tasks_max_size);
+    task_list_max_terminated_tasks =
+      node->declare_parameter<int>("task_list_max_terminated_tasks", -1);
+    RCLCPP_INFO(node->get_logger(),
+      " Declared task_list_max_terminated_tasks as: %d",
+      task_list_max_terminated_tasks);
     publish_active_tasks_period =
       node->declare_parameter<int>("publish_active_tasks_period", 2);
     RCLCPP_INFO(node->get_logger(),
       " Declared publish_active_tasks_period as: %f secs",
       publish_active_tasks_period);
+    max_concurrent_auctions =
+      node->declare_parameter<int>("max_concurrent_auctions", 1);
+    RCLCPP_INFO(node->get_logger(),
+      " Declared max_concurrent_auctions as: %d", max_concurrent_auctions);
+    close_auctions_early =
+      node->declare_parameter<bool>("close_auctions_early", false);
+    RCLCPP_INFO(node->get_logger(),
+      " Declared close_auctions_early as: %s",
+      close_auctions_early ? "true" : "false");
+    fleet_presence_timeout =
+      node->declare_parameter<double>("fleet_presence_timeout", 60.0);
+    RCLCPP_INFO(node->get_logger(),
+      " Declared fleet_presence_timeout as: %f secs", fleet_presence_timeout);
+
+    task_changes_period =
+      node->declare_parameter<double>("task_changes_period", 0.0);
+    RCLCPP_INFO(node->get_logger(),
+      " Declared task_changes_period as: %f secs", task_changes_period);
+    memory_usage_period =
+      node->declare_parameter<double>("memory_usage_period", 0.0);
+    RCLCPP_INFO(node->get_logger(),
+      " Declared memory_usage_period as: %f secs", memory_usage_period);
+    executor_threads =
+      node->declare_parameter<int>("executor_threads", 0);
+    RCLCPP_INFO(node->get_logger(),
+      " Declared executor_threads as: %d", executor_threads);
+    const auto task_journal_path =
+      node->declare_parameter<std::string>("task_journal_path", "");
+    if (!task_journal_path.empty())
+    {
+      RCLCPP_INFO(node->get_logger(),
+        " Declared task_journal_path as: %s", task_journal_path.c_str());
+      journal = std::make_unique<TaskJournal>(task_journal_path, recovered);
+    }
 
     const auto qos = rclcpp::ServicesQoS().reliable();
     ongoing_tasks_pub = node->create_publisher<TasksMsg>(
       rmf_task_ros2::ActiveTasksTopicName, qos);
 
+    // When changes are published, the ongoing tasks only need to be published
+    // periodically as a keyframe for subscribers that join late or miss a
+    // change.
+    if (task_changes_period > 0.0)
+    {
+      task_changes_pub = node->create_publisher<TasksMsg>(
+        rmf_task_ros2::TaskChangesTopicName, qos);
+
+      task_changes_timer = node->create_wall_timer(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double>(task_changes_period)),
+        [this]()
+        {
+          const auto lock = sync.lock();
+          publish_task_changes();
+        }, publication_group);
+    }
+
+    // Publish an estimate of the memory held by the containers of the
+    // dispatcher so that budgets can be set and leaks traced to a container
+    if (memory_usage_period > 0.0)
+    {
+      memory_usage_pub = node->create_publisher<MemoryUsageMsg>(
+        rmf_traffic_ros2::MemoryUsageTopicName,
+        rclcpp::SystemDefaultsQoS().reliable().keep_last(10));
+
+      memory_usage_timer = node->create_wall_timer(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double>(memory_usage_period)),
+        [this]()
+        {
+          const auto lock = sync.lock();
+          publish_memory_usage();
+        }, publication_group);
+    }
+
+    metrics_exporter = rmf_traffic_ros2::MetricsExporter::from_parameters(
+      *node, metrics, [this]()
+      {
+        const auto lock = sync.lock();
+        this->refresh_metrics();
+      });
+
+    if (auto tracer = rmf_traffic_ros2::Tracer::from_parameters(*node))
+      rmf_traffic_ros2::tracing::set_tracer(std::move(tracer));
+
     timer = node->create_wall_timer(
       std::chrono::seconds(publish_active_tasks_period),
-      std::bind(
-        &Dispatcher::Implementation::publish_ongoing_tasks, this));
+      [this]()
+      {
+        const auto lock = sync.lock();
+        publish_ongoing_tasks();
+      }, publication_group);
 
     // Setup up stream srv interfaces
     submit_task_srv = node->create_service<SubmitTaskSrv>(
@@ -112,6 +275,7 @@ public:
         const std::shared_ptr<SubmitTaskSrv::Request> request,
         std::shared_ptr<SubmitTaskSrv::Response> response)
       {
+        const auto lock = sync.lock();
         const auto id = this->submit_task(request->description);
         if (id == std::nullopt)
         {
@@ -122,8 +286,9 @@ public:
 
         response->task_id = *id;
         response->success = true;
-      }
-    );
+      },
+      rmw_qos_profile_services_default,
+      submission_group);
 
     cancel_task_srv = node->create_service<CancelTaskSrv>(
       rmf_task_ros2::CancelTaskSrvName,
@@ -131,10 +296,12 @@ public:
         const std::shared_ptr<CancelTaskSrv::Request> request,
         std::shared_ptr<CancelTaskSrv::Response> response)
       {
+        const auto lock = sync.lock();
         auto id = request->task_id;
         response->success = this->cancel_task(id);
-      }
-    );
+      },
+      rmw_qos_profile_services_default,
+      submission_group);
 
     get_task_list_srv = node->create_service<GetTaskListSrv>(
       rmf_task_ros2::GetTaskListSrvName,
@@ -142,54 +309,179 @@ public:
         const std::shared_ptr<GetTaskListSrv::Request> request,
         std::shared_ptr<GetTaskListSrv::Response> response)
       {
-        for (auto task : (this->active_dispatch_tasks))
+        // Only copy the statuses while the dispatcher is locked, so that a
+        // long task list does not hold up submissions and auctions.
+        std::vector<TaskStatus> active;
+        std::vector<TaskStatus> terminated;
         {
-          response->active_tasks.push_back(
-            rmf_task_ros2::convert_status(*(task.second)));
+          const auto lock = sync.lock();
+          active.reserve(active_dispatch_tasks.size());
+          for (const auto& task : active_dispatch_tasks)
+            active.push_back(*task.second);
+
+          // Terminated Tasks, the most recently submitted first. A negative
+          // limit lists all of them.
+          const std::size_t limit = task_list_max_terminated_tasks < 0 ?
+            terminal_dispatch_tasks.size() :
+            static_cast<std::size_t>(task_list_max_terminated_tasks);
+          for (const auto& status : this->terminated_tasks(0, limit))
+            terminated.push_back(*status);
         }
 
-        // Terminated Tasks
-        for (auto task : (this->terminal_dispatch_tasks))
-        {
+        response->active_tasks.reserve(active.size());
+        for (const auto& status : active)
+          response->active_tasks.push_back(
+            rmf_task_ros2::convert_status(status));
+
+        response->terminated_tasks.reserve(terminated.size());
+        for (const auto& status : terminated)
           response->terminated_tasks.push_back(
-            rmf_task_ros2::convert_status(*(task.second)));
-        }
+            rmf_task_ros2::convert_status(status));
+
         response->success = true;
-      }
-    );
+      },
+      rmw_qos_profile_services_default,
+      task_list_group);
   }
 
   void start()
   {
     using namespace std::placeholders;
-    auctioneer = bidding::Auctioneer::make(node,
-        std::bind(&Implementation::receive_bidding_winner_cb, this, _1, _2));
+    auctioneer = bidding::Auctioneer::Implementation::make(node,
+        std::bind(&Implementation::receive_bidding_winner_cb, this, _1, _2),
+        sync.with_group(auction_group));
+    auctioneer->max_concurrent_auctions(
+      static_cast<std::size_t>(std::max(1, max_concurrent_auctions)));
+    auctioneer->close_auctions_early(close_auctions_early);
+    auctioneer->fleet_presence_timeout(
+      rmf_traffic::time::from_seconds(fleet_presence_timeout));
+    auctioneer->metrics(metrics);
     action_client->on_terminate(
       std::bind(&Implementation::terminate_task, this, _1));
     action_client->on_change(
       std::bind(&Implementation::task_status_cb, this, _1));
+
+    if (journal)
+      recover();
   }
 
-  std::optional<TaskID> submit_task(const TaskDescription& description)
+  /// Resume the tasks that were recovered from the journal. The tasks that had
+  /// not been awarded yet are bid for again, while the tasks that had been
+  /// awarded are tracked without being dispatched again.
+  void recover()
   {
-    TaskProfile submitted_task;
-    submitted_task.submission_time = node->now();
-    submitted_task.description = description;
+    task_counter = recovered.task_counter;
 
-    const auto task_type = static_cast<std::size_t>(description.task_type.type);
+    for (const auto& [id, status] : recovered.terminated_tasks)
+    {
+      terminal_dispatch_tasks[id] = std::make_shared<TaskStatus>(status);
+      terminated_index.insert(
+        {rmf_traffic_ros2::convert(status.task_profile.submission_time), id});
+    }
+
+    std::vector<TaskStatusPtr> unawarded;
+    for (const auto& [id, status] : recovered.active_tasks)
+    {
+      auto status_ptr = std::make_shared<TaskStatus>(status);
+      active_dispatch_tasks[id] = status_ptr;
+      if (recovered.user_submitted_tasks.count(id))
+        user_submitted_tasks.insert(id);
+
+      if (status.state == TaskStatus::State::Pending
+        && status.fleet_name.empty())
+        unawarded.push_back(status_ptr);
+      else
+        action_client->track_task(status_ptr);
+    }
 
+    // Bid for the tasks in the order that they were submitted
+    std::sort(unawarded.begin(), unawarded.end(),
+      [](const TaskStatusPtr& a, const TaskStatusPtr& b)
+      {
+        return rmf_traffic_ros2::convert(a->task_profile.submission_time)
+        < rmf_traffic_ros2::convert(b->task_profile.submission_time);
+      });
+
+    for (const auto& status : unawarded)
+    {
+      bidding::BidNotice bid_notice;
+      bid_notice.task_profile = status->task_profile;
+      bid_notice.time_window = rmf_traffic_ros2::convert(
+        rmf_traffic::time::from_seconds(bidding_time_window));
+      queue_bidding_tasks.push(bid_notice);
+    }
+
+    RCLCPP_INFO(node->get_logger(),
+      "Recovered [%ld] active task(s), of which [%ld] will be bid for again, "
+      "and [%ld] terminated task(s) from the task journal",
+      recovered.active_tasks.size(), unawarded.size(),
+      recovered.terminated_tasks.size());
+
+    recovered = TaskJournal::State();
+    start_next_biddings();
+  }
+
+  bool is_valid(const TaskDescription& description) const
+  {
+    const auto task_type = static_cast<std::size_t>(description.task_type.type);
     if (!task_type_name.count(task_type))
     {
       RCLCPP_ERROR(node->get_logger(), "TaskType: %ld is invalid", task_type);
+      return false;
+    }
+
+    return true;
+  }
+
+  std::optional<TaskID> submit_task(const TaskDescription& description)
+  {
+    if (!is_valid(description))
       return std::nullopt;
+
+    const auto id = add_pending_task(description);
+    start_next_biddings();
+    return id;
+  }
+
+  std::optional<std::vector<TaskID>> submit_tasks(
+    const std::vector<TaskDescription>& descriptions)
+  {
+    // Check the whole batch before adding any of it
+    for (const auto& description : descriptions)
+    {
+      if (!is_valid(description))
+        return std::nullopt;
     }
 
+    std::vector<TaskID> ids;
+    ids.reserve(descriptions.size());
+    for (const auto& description : descriptions)
+      ids.push_back(add_pending_task(description));
+
+    start_next_biddings();
+    return ids;
+  }
+
+  /// Create the status of a newly submitted task and queue it for bidding.
+  /// The task type must already have been validated.
+  TaskID add_pending_task(const TaskDescription& description)
+  {
+    TaskProfile submitted_task;
+    submitted_task.submission_time = node->now();
+    submitted_task.description = description;
+
+    const auto task_type = static_cast<std::size_t>(description.task_type.type);
+
     // auto generate a task_id for a given submitted task
     submitted_task.task_id =
-      task_type_name[task_type] + std::to_string(task_counter++);
+      task_type_name.at(task_type) + std::to_string(task_counter++);
 
     RCLCPP_INFO(node->get_logger(),
       "Received Task Submission [%s]", submitted_task.task_id.c_str());
+    submitted_tasks->increment();
+
+    if (journal)
+      journal->record_task_counter(task_counter);
 
     // add task to internal cache
     TaskStatus status;
@@ -198,6 +490,7 @@ public:
     active_dispatch_tasks[submitted_task.task_id] = new_task_status;
     user_submitted_tasks.insert(submitted_task.task_id);
 
+    record_change(new_task_status);
     if (on_change_fn)
       on_change_fn(new_task_status);
 
@@ -207,12 +500,37 @@ public:
       rmf_traffic::time::from_seconds(bidding_time_window));
     queue_bidding_tasks.push(bid_notice);
 
-    if (queue_bidding_tasks.size() == 1)
-      auctioneer->start_bidding(queue_bidding_tasks.front());
-
     return submitted_task.task_id;
   }
 
+  /// Hand queued tasks over to the auctioneer while fewer than
+  /// max_concurrent_auctions tasks are being bid for
+  void start_next_biddings()
+  {
+    const std::size_t limit =
+      static_cast<std::size_t>(std::max(1, max_concurrent_auctions));
+    while (!queue_bidding_tasks.empty() && bidding_in_flight.size() < limit)
+    {
+      const auto bid_notice = queue_bidding_tasks.front();
+      queue_bidding_tasks.pop();
+
+      // Skip the tasks that were cancelled while they were waiting
+      const auto& id = bid_notice.task_profile.task_id;
+      if (!active_dispatch_tasks.count(id))
+        continue;
+
+      bidding_in_flight.insert(id);
+      auctioneer->start_bidding(bid_notice);
+    }
+  }
+
+  /// The bidding of a task is over, so the next task may be bid for
+  void finish_bidding(const TaskID& task_id)
+  {
+    if (bidding_in_flight.erase(task_id))
+      start_next_biddings();
+  }
+
   bool cancel_task(const TaskID& task_id)
   {
     // check if key exists
@@ -304,7 +622,11 @@ public:
   {
     const auto it = active_dispatch_tasks.find(task_id);
     if (it == active_dispatch_tasks.end())
+    {
+      // The task was cancelled during its auction
+      finish_bidding(task_id);
       return;
+    }
     const auto& pending_task_status = it->second;
 
     if (!winner)
@@ -312,19 +634,28 @@ public:
       RCLCPP_WARN(node->get_logger(), "Dispatcher Bidding Result: task [%s]"
         " has no submissions during bidding, Task Failed", task_id.c_str());
       pending_task_status->state = TaskStatus::State::Failed;
+      rmf_traffic_ros2::tracing::record(
+        "dispatcher.assignment", rmf_traffic_ros2::tracing::task(task_id),
+        time_since_submission(*pending_task_status),
+        {{"rmf.outcome", "no_bids"}});
       terminate_task(pending_task_status);
 
       if (on_change_fn)
         on_change_fn(pending_task_status);
 
-      queue_bidding_tasks.pop();
-      if (!queue_bidding_tasks.empty())
-        auctioneer->start_bidding(queue_bidding_tasks.front());
+      finish_bidding(task_id);
       return;
     }
 
     // now we know which fleet will execute the task
     pending_task_status->fleet_name = winner->fleet_name;
+    const auto assignment_time = time_since_submission(*pending_task_status);
+    assignment_seconds->observe(assignment_time);
+    rmf_traffic_ros2::tracing::record(
+      "dispatcher.assignment", rmf_traffic_ros2::tracing::task(task_id),
+      assignment_time,
+      {{"rmf.outcome", "awarded"}, {"rmf.fleet", winner->fleet_name}});
+    record_change(pending_task_status);
 
     RCLCPP_INFO(node->get_logger(), "Dispatcher Bidding Result: task [%s]"
       " is accepted by fleet adapter [%s]",
@@ -359,32 +690,104 @@ public:
   void terminate_task(const TaskStatusPtr terminate_status)
   {
     assert(terminate_status->is_terminated());
-    publish_ongoing_tasks();
 
-    // prevent terminal_dispatch_tasks from piling up meaning
-    if (terminal_dispatch_tasks.size() >= terminated_tasks_max_size)
+    // Without the publication of changes, the ongoing tasks are published
+    // while the terminated task is still among them, so that subscribers see
+    // its final state.
+    if (!task_changes_pub)
+      publish_ongoing_tasks();
+
+    const auto id = terminate_status->task_profile.task_id;
+    const auto submission_time = rmf_traffic_ros2::convert(
+      terminate_status->task_profile.submission_time);
+
+    const auto existing = terminal_dispatch_tasks.find(id);
+    if (existing == terminal_dispatch_tasks.end())
+      record_termination(*terminate_status);
+
+    if (existing != terminal_dispatch_tasks.end())
     {
+      // The earlier entry of this task is replaced
+      terminated_index.erase(
+        {rmf_traffic_ros2::convert(
+            existing->second->task_profile.submission_time), id});
+    }
+    else if (!terminated_index.empty()
+      && terminal_dispatch_tasks.size() >=
+      static_cast<std::size_t>(std::max(0, terminated_tasks_max_size)))
+    {
+      // prevent terminal_dispatch_tasks from piling up
       RCLCPP_WARN(node->get_logger(),
         "Terminated tasks reached max size, remove earliest submited task");
 
-      auto rm_task = terminal_dispatch_tasks.begin();
-      for (auto it = rm_task++; it != terminal_dispatch_tasks.end(); it++)
-      {
-        const auto t1 = it->second->task_profile.submission_time;
-        const auto t2 = rm_task->second->task_profile.submission_time;
-        if (rmf_traffic_ros2::convert(t1) < rmf_traffic_ros2::convert(t2))
-          rm_task = it;
-      }
-      terminal_dispatch_tasks.erase(rm_task);
-    }
+      const auto earliest = terminated_index.begin();
+      if (journal)
+        journal->record_evicted(earliest->second);
 
-    const auto id = terminate_status->task_profile.task_id;
+      terminal_dispatch_tasks.erase(earliest->second);
+      terminated_index.erase(earliest);
+    }
 
     // destroy prev status ptr and recreate one
     auto status = std::make_shared<TaskStatus>(*terminate_status);
-    (terminal_dispatch_tasks)[id] = status;
+    terminal_dispatch_tasks[id] = status;
+    terminated_index.insert({submission_time, id});
     user_submitted_tasks.erase(id);
     active_dispatch_tasks.erase(id);
+    record_change(status);
+  }
+
+  /// Count a task that has terminated by its final state
+  void record_termination(const TaskStatus& status)
+  {
+    const char* state = "other";
+    if (status.state == TaskStatus::State::Completed)
+      state = "completed";
+    else if (status.state == TaskStatus::State::Failed)
+      state = "failed";
+    else if (status.state == TaskStatus::State::Canceled)
+      state = "canceled";
+
+    metrics->counter(
+      "rmf_dispatcher_tasks_terminated",
+      "Tasks that have terminated, by their final state",
+      {{"state", state}})->increment();
+
+    rmf_traffic_ros2::tracing::record(
+      "dispatcher.task",
+      rmf_traffic_ros2::tracing::task(status.task_profile.task_id),
+      time_since_submission(status),
+      {{"rmf.state", state}, {"rmf.fleet", status.fleet_name}});
+  }
+
+  /// How long ago a task was submitted
+  rmf_traffic::Duration time_since_submission(const TaskStatus& status) const
+  {
+    return rmf_traffic_ros2::convert(
+      node->now() - rclcpp::Time(status.task_profile.submission_time));
+  }
+
+  void refresh_metrics()
+  {
+    active_tasks->set(static_cast<double>(active_dispatch_tasks.size()));
+    bidding_tasks->set(
+      static_cast<double>(
+        queue_bidding_tasks.size() + bidding_in_flight.size()));
+  }
+
+  std::vector<TaskStatusPtr> terminated_tasks(
+    const std::size_t offset, const std::size_t limit) const
+  {
+    std::vector<TaskStatusPtr> page;
+    if (offset >= terminated_index.size())
+      return page;
+
+    page.reserve(std::min(limit, terminated_index.size() - offset));
+    auto it = std::next(terminated_index.rbegin(), offset);
+    for (; it != terminated_index.rend() && page.size() < limit; ++it)
+      page.push_back(terminal_dispatch_tasks.at(it->second));
+
+    return page;
   }
 
   void task_status_cb(const TaskStatusPtr status)
@@ -401,20 +804,72 @@ public:
         "Add previously unheard task: [%s]", id.c_str());
     }
 
-    // check if there's a change in state for the previous completed bidding task
-    // TODO, better way to impl this
-    if (!queue_bidding_tasks.empty()
-      && id == queue_bidding_tasks.front().task_profile.task_id)
-    {
-      queue_bidding_tasks.pop();
-      if (!queue_bidding_tasks.empty())
-        auctioneer->start_bidding(queue_bidding_tasks.front());
-    }
+    // check if there's a change in state for a completed bidding task
+    finish_bidding(id);
+    record_change(status);
 
     if (on_change_fn)
       on_change_fn(status);
   }
 
+  void record_change(const TaskStatusPtr& status)
+  {
+    const auto& id = status->task_profile.task_id;
+    if (task_changes_pub)
+      changed_tasks[id] = status;
+
+    if (!journal)
+      return;
+
+    if (status->is_terminated())
+      journal->record_terminated(*status);
+    else
+      journal->record_active(*status, user_submitted_tasks.count(id) > 0);
+
+    // Keep the journal from growing much larger than the state it describes
+    const std::size_t tasks =
+      active_dispatch_tasks.size() + terminal_dispatch_tasks.size();
+    if (journal->size() > 1000 + 2*tasks)
+      compact_journal();
+  }
+
+  void compact_journal()
+  {
+    TaskJournal::State state;
+    state.task_counter = task_counter;
+    state.user_submitted_tasks.insert(
+      user_submitted_tasks.begin(), user_submitted_tasks.end());
+    for (const auto& [id, status] : active_dispatch_tasks)
+    {
+      // A task may be terminated before it is moved out of the active tasks
+      if (status->is_terminated())
+        state.terminated_tasks[id] = *status;
+      else
+        state.active_tasks[id] = *status;
+    }
+
+    for (const auto& [id, status] : terminal_dispatch_tasks)
+      state.terminated_tasks.insert({id, *status});
+
+    journal->compact(state);
+  }
+
+  /// Publish the tasks whose status changed since the last time. A task that
+  /// was terminated is published once with its final state.
+  void publish_task_changes()
+  {
+    if (changed_tasks.empty())
+      return;
+
+    TasksMsg task_msgs;
+    task_msgs.tasks.reserve(changed_tasks.size());
+    for (const auto& [id, status] : changed_tasks)
+      task_msgs.tasks.push_back(rmf_task_ros2::convert_status(*status));
+
+    changed_tasks.clear();
+    task_changes_pub->publish(task_msgs);
+  }
+
   void publish_ongoing_tasks()
   {
     TasksMsg task_msgs;
@@ -425,6 +880,66 @@ public:
     }
     ongoing_tasks_pub->publish(task_msgs);
   }
+
+  void publish_memory_usage()
+  {
+    using rmf_traffic_ros2::memory::heap_bytes;
+    const auto task_bytes = [](const auto& element)
+      {
+        std::size_t bytes = heap_bytes(element.first);
+        if (const auto& status = element.second)
+        {
+          bytes += sizeof(TaskStatus)
+            + heap_bytes(status->fleet_name)
+            + heap_bytes(status->robot_name)
+            + heap_bytes(status->status);
+        }
+
+        return bytes;
+      };
+
+    const auto id_bytes = [](const std::string& id)
+      {
+        return heap_bytes(id);
+      };
+
+    rmf_traffic_ros2::MemoryUsage usage;
+    usage.add(
+      "tasks.active",
+      active_dispatch_tasks.size(),
+      heap_bytes(active_dispatch_tasks, task_bytes));
+
+    usage.add(
+      "tasks.terminated",
+      terminal_dispatch_tasks.size(),
+      heap_bytes(terminal_dispatch_tasks, task_bytes)
+      + heap_bytes(terminated_index));
+
+    usage.add(
+      "tasks.changed",
+      changed_tasks.size(),
+      heap_bytes(changed_tasks));
+
+    usage.add(
+      "tasks.user_submitted",
+      user_submitted_tasks.size(),
+      heap_bytes(user_submitted_tasks, id_bytes));
+
+    usage.add(
+      "bidding.queue",
+      queue_bidding_tasks.size(),
+      queue_bidding_tasks.size() * sizeof(bidding::BidNotice));
+
+    usage.add(
+      "bidding.in_flight",
+      bidding_in_flight.size(),
+      heap_bytes(bidding_in_flight, id_bytes));
+
+    MemoryUsageMsg msg;
+    msg.data = rmf_traffic_ros2::serialize(
+      usage, node->get_fully_qualified_name());
+    memory_usage_pub->publish(msg);
+  }
 };
 
 //==============================================================================
@@ -447,7 +962,8 @@ std::shared_ptr<Dispatcher> Dispatcher::make(
   const std::shared_ptr<rclcpp::Node>& node)
 {
   auto pimpl = rmf_utils::make_impl<Implementation>(node);
-  pimpl->action_client = action::Client::make(node);
+  pimpl->action_client = action::Client::make(
+    node, pimpl->sync.with_group(pimpl->status_group));
 
   auto dispatcher = std::shared_ptr<Dispatcher>(new Dispatcher());
   dispatcher->_pimpl = std::move(pimpl);
@@ -459,12 +975,22 @@ std::shared_ptr<Dispatcher> Dispatcher::make(
 std::optional<TaskID> Dispatcher::submit_task(
   const TaskDescription& task_description)
 {
+  const auto lock = _pimpl->sync.lock();
   return _pimpl->submit_task(task_description);
 }
 
+//==============================================================================
+std::optional<std::vector<TaskID>> Dispatcher::submit_tasks(
+  const std::vector<TaskDescription>& task_descriptions)
+{
+  const auto lock = _pimpl->sync.lock();
+  return _pimpl->submit_tasks(task_descriptions);
+}
+
 //==============================================================================
 bool Dispatcher::cancel_task(const TaskID& task_id)
 {
+  const auto lock = _pimpl->sync.lock();
   return _pimpl->cancel_task(task_id);
 }
 
@@ -472,24 +998,51 @@ bool Dispatcher::cancel_task(const TaskID& task_id)
 const std::optional<TaskStatus::State> Dispatcher::get_task_state(
   const TaskID& task_id) const
 {
+  const auto lock = _pimpl->sync.lock();
   return _pimpl->get_task_state(task_id);
 }
 
 //==============================================================================
-const Dispatcher::DispatchTasks& Dispatcher::active_tasks() const
+namespace {
+//==============================================================================
+Dispatcher::DispatchTasks copy_tasks(const Dispatcher::DispatchTasks& tasks)
+{
+  Dispatcher::DispatchTasks copy;
+  copy.reserve(tasks.size());
+  for (const auto& [id, status] : tasks)
+    copy.insert({id, std::make_shared<TaskStatus>(*status)});
+
+  return copy;
+}
+} // anonymous namespace
+
+//==============================================================================
+Dispatcher::DispatchTasks Dispatcher::active_tasks() const
+{
+  const auto lock = _pimpl->sync.lock();
+  return copy_tasks(_pimpl->active_dispatch_tasks);
+}
+
+//==============================================================================
+Dispatcher::DispatchTasks Dispatcher::terminated_tasks() const
 {
-  return _pimpl->active_dispatch_tasks;
+  const auto lock = _pimpl->sync.lock();
+  return copy_tasks(_pimpl->terminal_dispatch_tasks);
 }
 
 //==============================================================================
-const Dispatcher::DispatchTasks& Dispatcher::terminated_tasks() const
+std::vector<TaskStatusPtr> Dispatcher::terminated_tasks(
+  const std::size_t offset,
+  const std::size_t limit) const
 {
-  return _pimpl->terminal_dispatch_tasks;
+  const auto lock = _pimpl->sync.lock();
+  return _pimpl->terminated_tasks(offset, limit);
 }
 
 //==============================================================================
 void Dispatcher::on_change(StatusCallback on_change_fn)
 {
+  const auto lock = _pimpl->sync.lock();
   _pimpl->on_change_fn = on_change_fn;
 }
 
@@ -497,6 +1050,7 @@ void Dispatcher::on_change(StatusCallback on_change_fn)
 void Dispatcher::evaluator(
   std::shared_ptr<bidding::Auctioneer::Evaluator> evaluator)
 {
+  const auto lock = _pimpl->sync.lock();
   _pimpl->auctioneer->select_evaluator(evaluator);
 }
 
@@ -511,7 +1065,8 @@ void Dispatcher::spin()
 {
   rclcpp::ExecutorOptions options;
   options.context = _pimpl->node->get_node_options().context();
-  rclcpp::executors::SingleThreadedExecutor executor(options);
+  rclcpp::executors::MultiThreadedExecutor executor(
+    options, static_cast<std::size_t>(std::max(0, _pimpl->executor_threads)));
   executor.add_node(_pimpl->node);
   executor.spin();
 }
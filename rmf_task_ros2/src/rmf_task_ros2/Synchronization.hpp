@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TASK_ROS2__SYNCHRONIZATION_HPP
+#define SRC__RMF_TASK_ROS2__SYNCHRONIZATION_HPP
+
+#include <rclcpp/callback_group.hpp>
+
+#include <memory>
+#include <mutex>
+
+namespace rmf_task_ros2 {
+
+//==============================================================================
+/// How the callbacks of one part of the dispatcher are scheduled. The parts of
+/// the dispatcher share a node that may be spun by a multi-threaded executor,
+/// so each part gets its own callback group and a slow callback of one part
+/// does not hold up the others. The state that the parts share is guarded by
+/// a single mutex, which is recursive because the parts call into each other.
+struct Synchronization
+{
+  using Mutex = std::recursive_mutex;
+
+  /// Locked by every callback while it touches the state of the dispatcher
+  std::shared_ptr<Mutex> mutex = std::make_shared<Mutex>();
+
+  /// The callback group of this part. A nullptr uses the default callback
+  /// group of the node.
+  rclcpp::CallbackGroup::SharedPtr callback_group = nullptr;
+
+  std::unique_lock<Mutex> lock() const
+  {
+    return std::unique_lock<Mutex>(*mutex);
+  }
+
+  /// Get the synchronization of another part that shares this mutex
+  Synchronization with_group(rclcpp::CallbackGroup::SharedPtr group) const
+  {
+    return Synchronization{mutex, std::move(group)};
+  }
+};
+
+} // namespace rmf_task_ros2
+
+#endif // SRC__RMF_TASK_ROS2__SYNCHRONIZATION_HPP
@@ -0,0 +1,490 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "TaskJournal.hpp"
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace rmf_task_ros2 {
+
+namespace {
+//==============================================================================
+// The journal and its snapshot both begin with this header. The final byte is
+// the format version.
+constexpr std::array<uint8_t, 8> Header =
+{'R', 'M', 'F', 'T', 'J', 'R', 'N', 1};
+
+// Each record is laid out as
+//   [payload length: u32][checksum: u32][kind: u8][payload]
+// where the checksum covers the kind byte and the payload.
+constexpr std::size_t RecordPrefixSize = 9;
+
+// The kinds of records. These are stored in journals, so they must never be
+// changed or reused.
+enum Kind : uint8_t
+{
+  TaskCounter = 1,
+  Active = 2,
+  Terminated = 3,
+  Evicted = 4
+};
+
+//==============================================================================
+// Standard (IEEE 802.3) CRC-32 checksum
+uint32_t crc32(const uint8_t* data, const std::size_t size, uint32_t crc = 0)
+{
+  crc = ~crc;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    crc ^= data[i];
+    for (int k = 0; k < 8; ++k)
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+
+  return ~crc;
+}
+
+//==============================================================================
+void write_u64(std::vector<uint8_t>& buffer, const uint64_t value)
+{
+  for (int i = 0; i < 8; ++i)
+    buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+void write_u32(std::vector<uint8_t>& buffer, const uint32_t value)
+{
+  for (int i = 0; i < 4; ++i)
+    buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+uint64_t read_u64(const uint8_t* data)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i)
+    value |= static_cast<uint64_t>(data[i]) << (8*i);
+
+  return value;
+}
+
+//==============================================================================
+uint32_t read_u32(const uint8_t* data)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i)
+    value |= static_cast<uint32_t>(data[i]) << (8*i);
+
+  return value;
+}
+
+//==============================================================================
+void append_status(std::vector<uint8_t>& buffer, const TaskStatus& status)
+{
+  const auto msg = convert_status(status);
+  rclcpp::SerializedMessage serialized;
+  rclcpp::Serialization<StatusMsg>().serialize_message(&msg, &serialized);
+  const auto& raw = serialized.get_rcl_serialized_message();
+  buffer.insert(buffer.end(), raw.buffer, raw.buffer + raw.buffer_length);
+}
+
+//==============================================================================
+TaskStatus read_status(const uint8_t* data, const std::size_t size)
+{
+  rclcpp::SerializedMessage serialized(size);
+  auto& raw = serialized.get_rcl_serialized_message();
+  std::memcpy(raw.buffer, data, size);
+  raw.buffer_length = size;
+
+  StatusMsg msg;
+  rclcpp::Serialization<StatusMsg>().deserialize_message(&serialized, &msg);
+  return convert_status(msg);
+}
+
+//==============================================================================
+std::vector<uint8_t> encode_active(
+  const TaskStatus& status,
+  const bool user_submitted)
+{
+  std::vector<uint8_t> payload;
+  payload.push_back(user_submitted ? 1 : 0);
+  append_status(payload, status);
+  return payload;
+}
+
+//==============================================================================
+std::vector<uint8_t> encode_terminated(const TaskStatus& status)
+{
+  std::vector<uint8_t> payload;
+  append_status(payload, status);
+  return payload;
+}
+
+//==============================================================================
+std::vector<uint8_t> encode_counter(const std::size_t counter)
+{
+  std::vector<uint8_t> payload;
+  write_u64(payload, counter);
+  return payload;
+}
+
+//==============================================================================
+void append_record(
+  std::vector<uint8_t>& buffer,
+  const uint8_t kind,
+  const std::vector<uint8_t>& payload)
+{
+  write_u32(buffer, static_cast<uint32_t>(payload.size()));
+  write_u32(buffer, crc32(payload.data(), payload.size(), crc32(&kind, 1)));
+  buffer.push_back(kind);
+  buffer.insert(buffer.end(), payload.begin(), payload.end());
+}
+
+//==============================================================================
+// Apply one record to the state. Returns false if the record is malformed.
+bool apply(
+  TaskJournal::State& state,
+  const uint8_t kind,
+  const std::vector<uint8_t>& payload)
+{
+  try
+  {
+    switch (kind)
+    {
+      case TaskCounter:
+      {
+        if (payload.size() != 8)
+          return false;
+
+        state.task_counter = std::max<std::size_t>(
+          state.task_counter, read_u64(payload.data()));
+        return true;
+      }
+      case Active:
+      {
+        if (payload.empty())
+          return false;
+
+        auto status = read_status(payload.data() + 1, payload.size() - 1);
+        const auto id = status.task_profile.task_id;
+        if (payload[0])
+          state.user_submitted_tasks.insert(id);
+
+        state.active_tasks[id] = std::move(status);
+        return true;
+      }
+      case Terminated:
+      {
+        auto status = read_status(payload.data(), payload.size());
+        const auto id = status.task_profile.task_id;
+        state.active_tasks.erase(id);
+        state.user_submitted_tasks.erase(id);
+        state.terminated_tasks[id] = std::move(status);
+        return true;
+      }
+      case Evicted:
+      {
+        state.terminated_tasks.erase(
+          std::string(payload.begin(), payload.end()));
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+  catch (const std::exception&)
+  {
+    // The payload could not be deserialized
+    return false;
+  }
+}
+
+//==============================================================================
+// Replay the records of a file into the state. A file that does not exist is
+// treated as empty.
+void replay(const std::string& file_path, TaskJournal::State& state)
+{
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file)
+    return;
+
+  file.seekg(0, std::ios::end);
+  const auto file_size = static_cast<uint64_t>(file.tellg());
+  file.seekg(0, std::ios::beg);
+
+  std::array<uint8_t, Header.size()> header;
+  file.read(reinterpret_cast<char*>(header.data()), header.size());
+  if (!file || header != Header)
+    return;
+
+  std::array<uint8_t, RecordPrefixSize> prefix;
+  std::vector<uint8_t> payload;
+  while (true)
+  {
+    file.read(reinterpret_cast<char*>(prefix.data()), prefix.size());
+    if (file.gcount() < static_cast<std::streamsize>(prefix.size()))
+      return;
+
+    const auto size = read_u32(prefix.data());
+    const auto checksum = read_u32(prefix.data() + 4);
+    const auto kind = prefix[8];
+
+    // A corrupted length could ask for far more memory than the file holds
+    const auto position = static_cast<uint64_t>(file.tellg());
+    if (size > file_size - std::min(file_size, position))
+      return;
+
+    payload.resize(size);
+    file.read(reinterpret_cast<char*>(payload.data()), size);
+    if (file.gcount() < static_cast<std::streamsize>(size))
+      return;
+
+    if (crc32(payload.data(), size, crc32(&kind, 1)) != checksum)
+      return;
+
+    if (!apply(state, kind, payload))
+      return;
+  }
+}
+
+//==============================================================================
+void write_all(
+  const int fd,
+  const uint8_t* data,
+  std::size_t size,
+  const std::string& file_path)
+{
+  while (size > 0)
+  {
+    const auto written = ::write(fd, data, size);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      throw TaskJournalError(
+        "[TaskJournal] Unable to write [" + file_path + "]: "
+        + std::strerror(errno));
+    }
+
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+}
+
+//==============================================================================
+void sync(const int fd, const std::string& file_path)
+{
+  if (::fsync(fd) != 0)
+  {
+    throw TaskJournalError(
+      "[TaskJournal] Unable to sync [" + file_path + "]: "
+      + std::strerror(errno));
+  }
+}
+
+//==============================================================================
+// A renamed file is only sure to keep its new name after a crash once the
+// directory that holds it has been synced as well.
+void sync_directory(const std::string& file_path)
+{
+  const auto slash = file_path.find_last_of('/');
+  const std::string directory =
+    slash == std::string::npos ? "." :
+    slash == 0 ? "/" : file_path.substr(0, slash);
+
+  const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    throw TaskJournalError(
+      "[TaskJournal] Unable to open directory [" + directory + "]: "
+      + std::strerror(errno));
+  }
+
+  const bool synced = ::fsync(fd) == 0;
+  const int error = errno;
+  ::close(fd);
+  if (!synced)
+  {
+    throw TaskJournalError(
+      "[TaskJournal] Unable to sync directory [" + directory + "]: "
+      + std::strerror(error));
+  }
+}
+
+//==============================================================================
+int open_file(const std::string& file_path)
+{
+  const int fd = ::open(
+    file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+  {
+    throw TaskJournalError(
+      "[TaskJournal] Unable to open [" + file_path + "] for writing: "
+      + std::strerror(errno));
+  }
+
+  try
+  {
+    write_all(fd, Header.data(), Header.size(), file_path);
+  }
+  catch (...)
+  {
+    ::close(fd);
+    throw;
+  }
+
+  return fd;
+}
+
+//==============================================================================
+std::string snapshot_path(const std::string& file_path)
+{
+  return file_path + ".snapshot";
+}
+
+} // anonymous namespace
+
+//==============================================================================
+TaskJournal::TaskJournal(const std::string& file_path, State& recovered)
+: _file_path(file_path)
+{
+  replay(snapshot_path(_file_path), recovered);
+  replay(_file_path, recovered);
+
+  // The journal may end with a partial record, so it is always compacted
+  // before anything new is appended to it.
+  compact(recovered);
+}
+
+//==============================================================================
+TaskJournal::~TaskJournal()
+{
+  if (_fd >= 0)
+    ::close(_fd);
+}
+
+//==============================================================================
+void TaskJournal::record_task_counter(const std::size_t counter)
+{
+  write(TaskCounter, encode_counter(counter));
+}
+
+//==============================================================================
+void TaskJournal::record_active(
+  const TaskStatus& status,
+  const bool user_submitted)
+{
+  write(Active, encode_active(status, user_submitted));
+}
+
+//==============================================================================
+void TaskJournal::record_terminated(const TaskStatus& status)
+{
+  write(Terminated, encode_terminated(status));
+}
+
+//==============================================================================
+void TaskJournal::record_evicted(const TaskID& task_id)
+{
+  write(Evicted, std::vector<uint8_t>(task_id.begin(), task_id.end()));
+}
+
+//==============================================================================
+std::size_t TaskJournal::size() const
+{
+  return _records;
+}
+
+//==============================================================================
+void TaskJournal::compact(const State& state)
+{
+  // The snapshot is written next to its final path and then renamed over it,
+  // so a crash will never leave a partial snapshot behind.
+  const auto snapshot = snapshot_path(_file_path);
+  const auto temporary = snapshot + ".tmp";
+
+  std::vector<uint8_t> buffer;
+  append_record(buffer, TaskCounter, encode_counter(state.task_counter));
+  for (const auto& [id, status] : state.terminated_tasks)
+    append_record(buffer, Terminated, encode_terminated(status));
+
+  for (const auto& [id, status] : state.active_tasks)
+  {
+    append_record(
+      buffer, Active,
+      encode_active(status, state.user_submitted_tasks.count(id) > 0));
+  }
+
+  // The snapshot has to be on disk before it replaces the old one, or a crash
+  // could leave the new name pointing at missing data.
+  const int fd = open_file(temporary);
+  try
+  {
+    write_all(fd, buffer.data(), buffer.size(), temporary);
+    sync(fd, temporary);
+  }
+  catch (...)
+  {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+
+  if (std::rename(temporary.c_str(), snapshot.c_str()) != 0)
+  {
+    throw TaskJournalError(
+      "[TaskJournal::compact] Unable to replace [" + snapshot + "]");
+  }
+  sync_directory(snapshot);
+
+  // Replaying the old journal on top of the new snapshot would give the same
+  // state, so a crash before this point loses nothing.
+  if (_fd >= 0)
+    ::close(_fd);
+
+  _fd = -1;
+  _fd = open_file(_file_path);
+  sync(_fd, _file_path);
+  _records = 0;
+}
+
+//==============================================================================
+void TaskJournal::write(const uint8_t kind, const std::vector<uint8_t>& payload)
+{
+  _buffer.clear();
+  append_record(_buffer, kind, payload);
+  write_all(_fd, _buffer.data(), _buffer.size(), _file_path);
+
+  // Each record is synced right away, so that it survives a crash of the
+  // dispatcher or of the whole machine.
+  sync(_fd, _file_path);
+  ++_records;
+}
+
+} // namespace rmf_task_ros2
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TASK_ROS2__TASKJOURNAL_HPP
+#define SRC__RMF_TASK_ROS2__TASKJOURNAL_HPP
+
+#include <rmf_task_ros2/TaskStatus.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rmf_task_ros2 {
+
+//==============================================================================
+/// Thrown when a task journal cannot be written.
+class TaskJournalError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+/// Records the changes to the tasks of a dispatcher in an append-only file, so
+/// that a dispatcher which restarts can resume where it left off instead of
+/// dispatching its tasks all over again.
+///
+/// The journal is kept next to a snapshot of the state at the time when the
+/// journal was last compacted. Every record carries a checksum, and replaying
+/// stops at the first record that is incomplete or corrupted, so a journal
+/// that was cut short by a crash can still be recovered up to that point.
+/// Each record is synced to disk as soon as it is recorded, and a
+/// TaskJournalError is thrown if it cannot be written.
+class TaskJournal
+{
+public:
+
+  /// The state of a dispatcher that a journal can restore
+  struct State
+  {
+    std::size_t task_counter = 0;
+    std::unordered_map<TaskID, TaskStatus> active_tasks;
+    std::unordered_set<TaskID> user_submitted_tasks;
+    std::unordered_map<TaskID, TaskStatus> terminated_tasks;
+  };
+
+  /// Open the journal at file_path, creating it if it does not exist yet. The
+  /// snapshot and journal that are already there are replayed into recovered,
+  /// and then compacted into a new snapshot. Throws a TaskJournalError if the
+  /// files cannot be written.
+  TaskJournal(const std::string& file_path, State& recovered);
+
+  TaskJournal(const TaskJournal&) = delete;
+  TaskJournal& operator=(const TaskJournal&) = delete;
+
+  ~TaskJournal();
+
+  /// Record the counter that the next task ID will be generated from.
+  void record_task_counter(std::size_t counter);
+
+  /// Record the status of a task that has not been terminated.
+  void record_active(const TaskStatus& status, bool user_submitted);
+
+  /// Record the final status of a terminated task.
+  void record_terminated(const TaskStatus& status);
+
+  /// Record that a terminated task is no longer kept.
+  void record_evicted(const TaskID& task_id);
+
+  /// Get the number of records since the journal was last compacted.
+  std::size_t size() const;
+
+  /// Replace the snapshot with the given state and empty the journal.
+  void compact(const State& state);
+
+private:
+  void write(uint8_t kind, const std::vector<uint8_t>& payload);
+
+  std::string _file_path;
+  int _fd = -1;
+  std::size_t _records = 0;
+  std::vector<uint8_t> _buffer;
+};
+
+} // namespace rmf_task_ros2
+
+#endif // SRC__RMF_TASK_ROS2__TASKJOURNAL_HPP
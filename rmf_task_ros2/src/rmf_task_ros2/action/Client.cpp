@@ -21,16 +21,19 @@ namespace rmf_task_ros2 {
 namespace action {
 
 std::shared_ptr<Client>
-Client::make(std::shared_ptr<rclcpp::Node> node)
+Client::make(std::shared_ptr<rclcpp::Node> node, Synchronization sync)
 {
-  return std::shared_ptr<Client>(new Client(node));
+  return std::shared_ptr<Client>(new Client(node, std::move(sync)));
 }
 
 //==============================================================================
-Client::Client(std::shared_ptr<rclcpp::Node> node)
-: _node(node)
+Client::Client(std::shared_ptr<rclcpp::Node> node, Synchronization sync)
+: _node(node),
+  _sync(std::move(sync))
 {
   const auto dispatch_qos = rclcpp::ServicesQoS().reliable();
+  rclcpp::SubscriptionOptions sub_options;
+  sub_options.callback_group = _sync.callback_group;
 
   _request_msg_pub = _node->create_publisher<RequestMsg>(
     TaskRequestTopicName, dispatch_qos);
@@ -39,50 +42,24 @@ Client::Client(std::shared_ptr<rclcpp::Node> node)
     TaskStatusTopicName, dispatch_qos,
     [&](const std::unique_ptr<StatusMsg> msg)
     {
-      const auto task_id = msg->task_profile.task_id;
-      if (task_id.empty())
-        return;
+      const auto lock = _sync.lock();
+      receive_status(*msg);
+    }, sub_options);
 
-      // status update, check if task_id is previously known
-      if (_active_task_status.count(task_id))
-      {
-        auto weak_status = _active_task_status[task_id].lock();
-
-        if (!weak_status)
-        {
-          RCLCPP_INFO(_node->get_logger(), "Task was previously terminated");
-          _active_task_status.erase(task_id);
-          return;
-        }
-
-        // TODO: hack to retain task profile and fleet name (to remove)
-        auto cache_profile = weak_status->task_profile;
-        // update status to ptr
-        *weak_status = convert_status(*msg);
-        weak_status->task_profile = cache_profile;
-
-        if (weak_status->is_terminated())
-          RCLCPP_INFO(_node->get_logger(),
-          "Received status from fleet [%s], task [%s] is now terminated",
-          msg->fleet_name.c_str(), task_id.c_str());
-
-        update_task_status(weak_status);
-      }
-      else
-      {
-        // will still provide onchange even if the task_id is unknown.
-        RCLCPP_DEBUG(_node->get_logger(),
-        "[action] Unknown task: [%s]", task_id.c_str());
-        auto task_status = std::make_shared<TaskStatus>(convert_status(*msg));
-        _active_task_status[task_id] = task_status;
-        update_task_status(task_status);
-      }
-    });
+  _status_batch_sub = _node->create_subscription<StatusBatchMsg>(
+    TaskStatusBatchTopicName, dispatch_qos,
+    [&](const std::unique_ptr<StatusBatchMsg> msg)
+    {
+      const auto lock = _sync.lock();
+      for (const auto& status : msg->tasks)
+        receive_status(status);
+    }, sub_options);
 
   _ack_msg_sub = _node->create_subscription<AckMsg>(
     TaskAckTopicName, dispatch_qos,
     [&](const std::unique_ptr<AckMsg> msg)
     {
+      const auto lock = _sync.lock();
       const auto task_id = msg->dispatch_request.task_profile.task_id;
       const auto weak_status = _active_task_status[task_id].lock();
 
@@ -122,7 +99,53 @@ Client::Client(std::shared_ptr<rclcpp::Node> node)
       }
 
       update_task_status(weak_status);
-    });
+    }, sub_options);
+}
+
+//==============================================================================
+void Client::receive_status(const StatusMsg& msg)
+{
+  // Each status that arrives pays for checking one tracked task
+  expire_front();
+
+  const auto task_id = msg.task_profile.task_id;
+  if (task_id.empty())
+    return;
+
+  // status update, check if task_id is previously known
+  if (_active_task_status.count(task_id))
+  {
+    auto weak_status = _active_task_status[task_id].lock();
+
+    if (!weak_status)
+    {
+      RCLCPP_INFO(_node->get_logger(), "Task was previously terminated");
+      _active_task_status.erase(task_id);
+      return;
+    }
+
+    // TODO: hack to retain task profile and fleet name (to remove)
+    auto cache_profile = weak_status->task_profile;
+    // update status to ptr
+    *weak_status = convert_status(msg);
+    weak_status->task_profile = cache_profile;
+
+    if (weak_status->is_terminated())
+      RCLCPP_INFO(_node->get_logger(),
+      "Received status from fleet [%s], task [%s] is now terminated",
+      msg.fleet_name.c_str(), task_id.c_str());
+
+    update_task_status(weak_status);
+  }
+  else
+  {
+    // will still provide onchange even if the task_id is unknown.
+    RCLCPP_DEBUG(_node->get_logger(),
+    "[action] Unknown task: [%s]", task_id.c_str());
+    auto task_status = std::make_shared<TaskStatus>(convert_status(msg));
+    track(task_id, task_status);
+    update_task_status(task_status);
+  }
 }
 
 //==============================================================================
@@ -160,12 +183,21 @@ void Client::add_task(
   // save status ptr
   status_ptr->fleet_name = fleet_name;
   status_ptr->task_profile = task_profile;
-  _active_task_status[task_profile.task_id] = status_ptr;
+  track(task_profile.task_id, status_ptr);
   RCLCPP_DEBUG(_node->get_logger(), "Assign task: [%s] to fleet [%s]",
     task_profile.task_id.c_str(), fleet_name.c_str());
   return;
 }
 
+//==============================================================================
+void Client::track_task(TaskStatusPtr status_ptr)
+{
+  const auto& task_id = status_ptr->task_profile.task_id;
+  track(task_id, status_ptr);
+  RCLCPP_DEBUG(_node->get_logger(), "Track task: [%s] of fleet [%s]",
+    task_id.c_str(), status_ptr->fleet_name.c_str());
+}
+
 //==============================================================================
 bool Client::cancel_task(
   const TaskProfile& task_profile)
@@ -203,19 +235,43 @@ bool Client::cancel_task(
 //==============================================================================
 int Client::size()
 {
-  for (auto it = _active_task_status.begin(); it != _active_task_status.end(); )
+  // Every tracked task is checked once
+  for (std::size_t i = _expiry_queue.size(); i > 0; --i)
+    expire_front();
+
+  return _active_task_status.size();
+}
+
+//==============================================================================
+void Client::track(const TaskID& task_id, const TaskStatusPtr& status_ptr)
+{
+  if (!_active_task_status.count(task_id))
+    _expiry_queue.push_back(task_id);
+
+  _active_task_status[task_id] = status_ptr;
+}
+
+//==============================================================================
+void Client::expire_front()
+{
+  if (_expiry_queue.empty())
+    return;
+
+  auto task_id = std::move(_expiry_queue.front());
+  _expiry_queue.pop_front();
+
+  const auto it = _active_task_status.find(task_id);
+  if (it == _active_task_status.end())
+    return;
+
+  const auto status = it->second.lock();
+  if (!status || status->is_terminated())
   {
-    if (auto weak_status = it->second.lock() )
-    {
-      if (weak_status->is_terminated())
-        it = _active_task_status.erase(it);
-      else
-        ++it;
-    }
-    else
-      it = _active_task_status.erase(it);
+    _active_task_status.erase(it);
+    return;
   }
-  return _active_task_status.size();
+
+  _expiry_queue.push_back(std::move(task_id));
 }
 
 //==============================================================================
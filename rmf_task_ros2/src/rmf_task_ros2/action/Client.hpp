@@ -24,6 +24,11 @@
 #include <rmf_task_ros2/TaskStatus.hpp>
 #include <rmf_task_msgs/msg/dispatch_request.hpp>
 #include <rmf_task_msgs/msg/dispatch_ack.hpp>
+#include <rmf_task_msgs/msg/tasks.hpp>
+
+#include "../Synchronization.hpp"
+
+#include <deque>
 
 namespace rmf_task_ros2 {
 namespace action {
@@ -41,8 +46,13 @@ public:
   ///
   /// \param[in] node
   ///   ros2 node instance
+  ///
+  /// \param[in] sync
+  ///   The callback group of the status subscriptions, and the mutex that they
+  ///   lock while they update the statuses and trigger the callbacks
   static std::shared_ptr<Client> make(
-    std::shared_ptr<rclcpp::Node> node);
+    std::shared_ptr<rclcpp::Node> node,
+    Synchronization sync = Synchronization());
 
   /// Add a task to a targeted fleet
   ///
@@ -59,6 +69,14 @@ public:
     const TaskProfile& task_profile,
     TaskStatusPtr status_ptr);
 
+  /// Track the status of a task that was added to a fleet before, without
+  /// sending the request again. This is used to resume the tasks that a
+  /// restarted dispatcher had already dispatched.
+  ///
+  /// \param[out] status_ptr
+  ///   Will update the status of the task here
+  void track_task(TaskStatusPtr status_ptr);
+
   /// Cancel an added task
   ///
   /// \param[in] task_profile
@@ -67,7 +85,9 @@ public:
   /// \return bool which indicate if cancel task is success
   bool cancel_task(const TaskProfile& task_profile);
 
-  /// Get the number of active task being track by client
+  /// Get the number of active task being track by client. This checks every
+  /// tracked task, so it is meant for diagnostics rather than for frequent
+  /// use.
   ///
   /// \return number of active task
   int size();
@@ -91,17 +111,35 @@ public:
   void on_terminate(StatusCallback status_cb_fn);
 
 private:
-  Client(std::shared_ptr<rclcpp::Node> node);
+  Client(std::shared_ptr<rclcpp::Node> node, Synchronization sync);
 
   void update_task_status(const TaskStatusPtr status);
 
+  void receive_status(const StatusMsg& msg);
+
+  /// Start tracking the status of a task
+  void track(const TaskID& task_id, const TaskStatusPtr& status_ptr);
+
+  /// Check the task at the front of the _expiry_queue, and stop tracking it if
+  /// its status is terminated or no longer exists. Otherwise it goes to the
+  /// back of the queue.
+  void expire_front();
+
   using RequestMsg = rmf_task_msgs::msg::DispatchRequest;
   using AckMsg = rmf_task_msgs::msg::DispatchAck;
 
   std::shared_ptr<rclcpp::Node> _node;
+  Synchronization _sync;
   StatusCallback _on_change_callback;
   StatusCallback _on_terminate_callback;
   std::unordered_map<TaskID, std::weak_ptr<TaskStatus>> _active_task_status;
+  // Every tracked task, checked one at a time as statuses arrive so that the
+  // tasks whose status was dropped without being terminated do not pile up.
+  // A task may appear here after it stopped being tracked, in which case it
+  // is simply discarded when it reaches the front.
+  std::deque<TaskID> _expiry_queue;
+  using StatusBatchMsg = rmf_task_msgs::msg::Tasks;
+  rclcpp::Subscription<StatusBatchMsg>::SharedPtr _status_batch_sub;
   rclcpp::Publisher<RequestMsg>::SharedPtr _request_msg_pub;
   rclcpp::Subscription<StatusMsg>::SharedPtr _status_msg_sub;
   rclcpp::Subscription<AckMsg>::SharedPtr _ack_msg_sub;
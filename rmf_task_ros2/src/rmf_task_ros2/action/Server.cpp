@@ -42,9 +42,49 @@ void Server::update_status(
 {
   auto msg = convert_status(task_status);
   msg.fleet_name = _fleet_name;
+  if (_status_batch_timer)
+  {
+    _pending_statuses[msg.task_profile.task_id] = std::move(msg);
+    return;
+  }
+
   _status_msg_pub->publish(msg);
 }
 
+//==============================================================================
+void Server::batch_status_updates(std::optional<rmf_traffic::Duration> period)
+{
+  // Anything that was waiting for the previous period is sent right away
+  publish_status_batch();
+  _status_batch_timer = nullptr;
+  if (!period.has_value())
+    return;
+
+  if (!_status_batch_pub)
+  {
+    _status_batch_pub = _node->create_publisher<StatusBatchMsg>(
+      TaskStatusBatchTopicName, rclcpp::ServicesQoS().reliable());
+  }
+
+  _status_batch_timer = _node->create_wall_timer(
+    *period, [this]() { publish_status_batch(); });
+}
+
+//==============================================================================
+void Server::publish_status_batch()
+{
+  if (_pending_statuses.empty())
+    return;
+
+  StatusBatchMsg batch;
+  batch.tasks.reserve(_pending_statuses.size());
+  for (auto& [id, msg] : _pending_statuses)
+    batch.tasks.push_back(std::move(msg));
+
+  _pending_statuses.clear();
+  _status_batch_pub->publish(batch);
+}
+
 //==============================================================================
 Server::Server(
   std::shared_ptr<rclcpp::Node> node,
@@ -24,8 +24,12 @@
 #include <rmf_task_ros2/TaskStatus.hpp>
 #include <rmf_task_msgs/msg/dispatch_request.hpp>
 #include <rmf_task_msgs/msg/dispatch_ack.hpp>
+#include <rmf_task_msgs/msg/tasks.hpp>
 #include <rmf_traffic/Time.hpp>
 
+#include <optional>
+#include <unordered_map>
+
 using TaskProfile = rmf_task_msgs::msg::TaskProfile;
 
 namespace rmf_task_ros2 {
@@ -71,13 +75,25 @@ public:
   ///   latest status of the task
   void update_status(const TaskStatus& task_status);
 
+  /// Send the status updates in batches instead of one message per update.
+  /// When this has a value, only the latest status of each task is kept, and
+  /// the statuses that changed are sent together once per period. A
+  /// std::nullopt value sends each update right away, which is the default.
+  ///
+  /// \param[in] period
+  ///   How often to send the batch of changed statuses
+  void batch_status_updates(std::optional<rmf_traffic::Duration> period);
+
 private:
+  void publish_status_batch();
+
   Server(
     std::shared_ptr<rclcpp::Node> node,
     const std::string& fleet_name);
 
   using RequestMsg = rmf_task_msgs::msg::DispatchRequest;
   using AckMsg = rmf_task_msgs::msg::DispatchAck;
+  using StatusBatchMsg = rmf_task_msgs::msg::Tasks;
 
   std::shared_ptr<rclcpp::Node> _node;
   std::string _fleet_name;
@@ -86,6 +102,10 @@ private:
   rclcpp::Subscription<RequestMsg>::SharedPtr _request_msg_sub;
   rclcpp::Publisher<StatusMsg>::SharedPtr _status_msg_pub;
   rclcpp::Publisher<AckMsg>::SharedPtr _ack_msg_pub;
+  rclcpp::Publisher<StatusBatchMsg>::SharedPtr _status_batch_pub;
+  rclcpp::TimerBase::SharedPtr _status_batch_timer;
+  // The latest status of each task that changed since the last batch
+  std::unordered_map<TaskID, StatusMsg> _pending_statuses;
 };
 
 } // namespace action
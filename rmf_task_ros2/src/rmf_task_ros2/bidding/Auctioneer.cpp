@@ -17,6 +17,14 @@
 
 #include "internal_Auctioneer.hpp"
 
+#include <rmf_traffic_ros2/Tracer.hpp>
+
+#include <rmf_task_msgs/msg/task_type.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
 namespace rmf_task_ros2 {
 namespace bidding {
 
@@ -32,11 +40,19 @@ Submission convert(const BidProposal& from)
   return submission;
 }
 
+//==============================================================================
+bool is_high_priority(const BidNotice& bid_notice)
+{
+  return bid_notice.task_profile.description.priority.value > 0;
+}
+
 //==============================================================================
 Auctioneer::Implementation::Implementation(
   const std::shared_ptr<rclcpp::Node>& node_,
-  BiddingResultCallback result_callback)
+  BiddingResultCallback result_callback,
+  Synchronization sync_)
 : node{std::move(node_)},
+  sync{std::move(sync_)},
   bidding_result_callback{std::move(result_callback)}
 {
   // default evaluator
@@ -46,17 +62,35 @@ Auctioneer::Implementation::Implementation(
   bid_notice_pub = node->create_publisher<BidNotice>(
     rmf_task_ros2::BidNoticeTopicName, dispatch_qos);
 
+  // The publishers of the standard task types are made up front so they have
+  // discovered their bidders by the time the first notice goes out
+  using TaskTypeMsg = rmf_task_msgs::msg::TaskType;
+  for (const uint32_t task_type : {
+      TaskTypeMsg::TYPE_STATION,
+      TaskTypeMsg::TYPE_LOOP,
+      TaskTypeMsg::TYPE_DELIVERY,
+      TaskTypeMsg::TYPE_CHARGE_BATTERY,
+      TaskTypeMsg::TYPE_CLEAN,
+      TaskTypeMsg::TYPE_PATROL})
+  {
+    typed_bid_notice_pub(task_type);
+  }
+
+  rclcpp::SubscriptionOptions sub_options;
+  sub_options.callback_group = sync.callback_group;
   bid_proposal_sub = node->create_subscription<BidProposal>(
     rmf_task_ros2::BidProposalTopicName, dispatch_qos,
     [&](const BidProposal::UniquePtr msg)
     {
+      const auto lock = sync.lock();
       this->receive_proposal(*msg);
-    });
+    }, sub_options);
 
   timer = node->create_wall_timer(std::chrono::milliseconds(200), [&]()
       {
+        const auto lock = sync.lock();
         this->check_bidding_process();
-      });
+      }, sync.callback_group);
 }
 
 //==============================================================================
@@ -69,7 +103,39 @@ void Auctioneer::Implementation::start_bidding(
   BiddingTask bidding_task;
   bidding_task.bid_notice = bid_notice;
   bidding_task.start_time = node->now();
-  queue_bidding_tasks.push(bidding_task);
+  if (is_high_priority(bid_notice))
+    priority_bidding_tasks.push_back(bidding_task);
+  else
+    queue_bidding_tasks.push_back(bidding_task);
+
+  record_queue_size();
+}
+
+//==============================================================================
+auto Auctioneer::Implementation::typed_bid_notice_pub(uint32_t task_type)
+-> const BidNoticePub::SharedPtr&
+{
+  auto& pub = typed_bid_notice_pubs[task_type];
+  if (!pub)
+  {
+    pub = node->create_publisher<BidNotice>(
+      rmf_task_ros2::bid_notice_topic_name(task_type),
+      rclcpp::ServicesQoS().reliable());
+  }
+
+  return pub;
+}
+
+//==============================================================================
+void Auctioneer::Implementation::publish_notice(const BidNotice& bid_notice)
+{
+  // Bidders that have not declared which task types they serve still listen
+  // to the shared topic. The middleware only sends each notice to the
+  // subscribers of the topics it is published on, so the fleets that declared
+  // other task types do not receive it at all.
+  bid_notice_pub->publish(bid_notice);
+  typed_bid_notice_pub(bid_notice.task_profile.description.task_type.type)
+  ->publish(bid_notice);
 }
 
 //==============================================================================
@@ -82,37 +148,176 @@ void Auctioneer::Implementation::receive_proposal(
     id.c_str(), msg.fleet_name.c_str());
 
   // check if bidding task is initiated by the auctioneer previously
-  // add submited proposal to the current bidding tasks list
-  if (queue_bidding_tasks.front().bid_notice.task_profile.task_id == id)
-    queue_bidding_tasks.front().submissions.push_back(convert(msg));
+  // add submited proposal to the bidding task of that auction
+  fleet_last_seen[msg.fleet_name] = node->now();
+  const auto it = open_auctions.find(id);
+  if (it == open_auctions.end())
+    return;
+
+  it->second.submissions.push_back(convert(msg));
+  if (metrics)
+  {
+    metrics->counter(
+      "rmf_auction_proposals",
+      "Proposals that fleets have submitted to open auctions",
+      {{"fleet", msg.fleet_name}})->increment();
+  }
+
+  if (close_auctions_early && all_present_fleets_submitted(it->second))
+  {
+    RCLCPP_DEBUG(node->get_logger(),
+      "All present fleets have submitted proposals for: %s", id.c_str());
+
+    // Take the auction out before concluding it, in case the result callback
+    // starts another bidding
+    const auto bidding_task = std::move(it->second);
+    open_auctions.erase(it);
+    conclude(bidding_task);
+    open_auctions_from_queue();
+  }
+}
+
+//==============================================================================
+bool Auctioneer::Implementation::all_present_fleets_submitted(
+  const BiddingTask& bidding_task) const
+{
+  const auto has_submitted = [&](const std::string& fleet_name)
+    {
+      return std::any_of(
+        bidding_task.submissions.begin(), bidding_task.submissions.end(),
+        [&](const Submission& s) { return s.fleet_name == fleet_name; });
+    };
+
+  for (const auto& fleet_name : registered_fleets)
+  {
+    if (!has_submitted(fleet_name))
+      return false;
+  }
+
+  const auto now = node->now();
+  const auto timeout = rclcpp::Duration(fleet_presence_timeout);
+  for (const auto& [fleet_name, last_seen] : fleet_last_seen)
+  {
+    if (now - last_seen > timeout)
+      continue;
+
+    if (!has_submitted(fleet_name))
+      return false;
+  }
+
+  return true;
 }
 
 //==============================================================================
 // determine the winner within a bidding task instance
 void Auctioneer::Implementation::check_bidding_process()
 {
-  if (queue_bidding_tasks.size() == 0)
+  for (auto it = open_auctions.begin(); it != open_auctions.end(); )
+  {
+    if (determine_winner(it->second))
+      it = open_auctions.erase(it);
+    else
+      ++it;
+  }
+
+  open_auctions_from_queue();
+}
+
+//==============================================================================
+void Auctioneer::Implementation::open_auctions_from_queue()
+{
+  const std::size_t limit = std::max<std::size_t>(1, max_concurrent_auctions);
+  release_held_tasks();
+
+  // One high priority auction may be opened on top of the limit, so that an
+  // urgent task never waits for low priority auctions to close
+  while (!priority_bidding_tasks.empty())
+  {
+    if (open_auctions.size() >= limit && open_priority_auctions() > 0)
+      break;
+
+    open_next_auction(priority_bidding_tasks);
+  }
+
+  // Low priority tasks wait until every high priority task has been announced
+  while (priority_bidding_tasks.empty() && !queue_bidding_tasks.empty()
+    && open_auctions.size() < limit)
+  {
+    open_next_auction(queue_bidding_tasks);
+  }
+
+  record_queue_size();
+}
+
+//==============================================================================
+void Auctioneer::Implementation::record_queue_size()
+{
+  if (!instruments)
+    return;
+
+  instruments->queued->set(
+    static_cast<double>(
+      queue_bidding_tasks.size() + priority_bidding_tasks.size()
+      + held_bidding_tasks.size()));
+}
+
+//==============================================================================
+void Auctioneer::Implementation::open_next_auction(
+  std::deque<BiddingTask>& queue)
+{
+  auto& front_task = queue.front();
+  const auto id = front_task.bid_notice.task_profile.task_id;
+
+  // A task can only have one auction at a time, so a repeated task waits
+  // for its earlier auction to close. It waits on the side so that the other
+  // tasks can still be announced.
+  if (open_auctions.count(id))
+  {
+    RCLCPP_DEBUG(node->get_logger(),
+      " - Hold back repeated bidding task: %s", id.c_str());
+    held_bidding_tasks.push_back(std::move(front_task));
+    queue.pop_front();
     return;
+  }
 
-  // Executing the task at the front queue
-  auto front_task = queue_bidding_tasks.front();
+  RCLCPP_DEBUG(node->get_logger(), " - Start new bidding task: %s",
+    id.c_str());
+  front_task.start_time = node->now();
+  publish_notice(front_task.bid_notice);
+  open_auctions.insert({id, std::move(front_task)});
+  queue.pop_front();
+  if (instruments)
+    instruments->opened->increment();
+}
 
-  if (bidding_in_proccess)
+//==============================================================================
+void Auctioneer::Implementation::release_held_tasks()
+{
+  // Go backwards so that the released tasks keep their order at the front of
+  // their queues. A task that is repeated more than once is released along
+  // with its twin and simply gets held again when its turn comes.
+  for (auto it = held_bidding_tasks.rbegin();
+    it != held_bidding_tasks.rend(); )
   {
-    if (determine_winner(front_task))
+    const auto& id = it->bid_notice.task_profile.task_id;
+    if (open_auctions.count(id))
     {
-      queue_bidding_tasks.pop();
-      bidding_in_proccess = false;
+      ++it;
+      continue;
     }
+
+    auto& queue = is_high_priority(it->bid_notice) ?
+      priority_bidding_tasks : queue_bidding_tasks;
+    queue.push_front(std::move(*it));
+    it = decltype(it)(held_bidding_tasks.erase(std::next(it).base()));
   }
-  else
-  {
-    RCLCPP_DEBUG(node->get_logger(), " - Start new bidding task: %s",
-      front_task.bid_notice.task_profile.task_id.c_str());
-    queue_bidding_tasks.front().start_time = node->now();
-    bid_notice_pub->publish(front_task.bid_notice);
-    bidding_in_proccess = true;
-  }
+}
+
+//==============================================================================
+std::size_t Auctioneer::Implementation::open_priority_auctions() const
+{
+  return std::count_if(open_auctions.begin(), open_auctions.end(),
+      [](const auto& a) { return is_high_priority(a.second.bid_notice); });
 }
 
 //==============================================================================
@@ -123,33 +328,51 @@ bool Auctioneer::Implementation::determine_winner(
 
   if (duration > bidding_task.bid_notice.time_window)
   {
-    auto id = bidding_task.bid_notice.task_profile.task_id;
     RCLCPP_DEBUG(node->get_logger(), "Bidding Deadline reached: %s",
-      id.c_str());
-    std::optional<Submission> winner = std::nullopt;
+      bidding_task.bid_notice.task_profile.task_id.c_str());
+    conclude(bidding_task);
+    return true;
+  }
+  return false;
+}
 
-    if (bidding_task.submissions.size() == 0)
-    {
-      RCLCPP_DEBUG(node->get_logger(),
-        "Bidding task has not received any bids");
-    }
-    else
-    {
-      winner = evaluate(bidding_task.submissions);
-      RCLCPP_INFO(
-        node->get_logger(),
-        "Determined winning Fleet Adapter: [%s], from %ld submissions",
-        winner->fleet_name.c_str(),
-        bidding_task.submissions.size());
-    }
+//==============================================================================
+void Auctioneer::Implementation::conclude(const BiddingTask& bidding_task)
+{
+  auto id = bidding_task.bid_notice.task_profile.task_id;
+  std::optional<Submission> winner = std::nullopt;
 
-    // Call the user defined callback function
-    if (bidding_result_callback)
-      bidding_result_callback(id, winner);
+  if (bidding_task.submissions.size() == 0)
+  {
+    RCLCPP_DEBUG(node->get_logger(),
+      "Bidding task has not received any bids");
+  }
+  else
+  {
+    winner = evaluate(bidding_task.submissions);
+    RCLCPP_INFO(
+      node->get_logger(),
+      "Determined winning Fleet Adapter: [%s], from %ld submissions",
+      winner->fleet_name.c_str(),
+      bidding_task.submissions.size());
+  }
 
-    return true;
+  const auto auction_time =
+    rmf_traffic_ros2::convert(node->now() - bidding_task.start_time);
+  if (instruments)
+  {
+    (winner ? instruments->awarded : instruments->without_bids)->increment();
+    instruments->auction_seconds->observe(auction_time);
   }
-  return false;
+
+  rmf_traffic_ros2::tracing::record(
+    "auctioneer.auction", rmf_traffic_ros2::tracing::task(id), auction_time,
+    {{"rmf.submissions", std::to_string(bidding_task.submissions.size())},
+      {"rmf.winner", winner ? winner->fleet_name : ""}});
+
+  // Call the user defined callback function
+  if (bidding_result_callback)
+    bidding_result_callback(id, winner);
 }
 
 //==============================================================================
@@ -177,9 +400,19 @@ std::optional<Submission> Auctioneer::Implementation::evaluate(
 std::shared_ptr<Auctioneer> Auctioneer::make(
   const std::shared_ptr<rclcpp::Node>& node,
   BiddingResultCallback result_callback)
+{
+  return Implementation::make(
+    node, std::move(result_callback), Synchronization());
+}
+
+//==============================================================================
+std::shared_ptr<Auctioneer> Auctioneer::Implementation::make(
+  const std::shared_ptr<rclcpp::Node>& node,
+  BiddingResultCallback result_callback,
+  Synchronization sync)
 {
   auto pimpl = rmf_utils::make_unique_impl<Implementation>(
-    node, result_callback);
+    node, std::move(result_callback), std::move(sync));
   auto auctioneer = std::shared_ptr<Auctioneer>(new Auctioneer());
   auctioneer->_pimpl = std::move(pimpl);
   return auctioneer;
@@ -191,6 +424,91 @@ void Auctioneer::start_bidding(const BidNotice& bid_notice)
   _pimpl->start_bidding(bid_notice);
 }
 
+//==============================================================================
+auto Auctioneer::max_concurrent_auctions(const std::size_t value)
+-> Auctioneer&
+{
+  _pimpl->max_concurrent_auctions = value;
+  return *this;
+}
+
+//==============================================================================
+std::size_t Auctioneer::max_concurrent_auctions() const
+{
+  return _pimpl->max_concurrent_auctions;
+}
+
+//==============================================================================
+auto Auctioneer::close_auctions_early(const bool value) -> Auctioneer&
+{
+  _pimpl->close_auctions_early = value;
+  return *this;
+}
+
+//==============================================================================
+bool Auctioneer::close_auctions_early() const
+{
+  return _pimpl->close_auctions_early;
+}
+
+//==============================================================================
+auto Auctioneer::fleet_presence_timeout(const rmf_traffic::Duration value)
+-> Auctioneer&
+{
+  _pimpl->fleet_presence_timeout = value;
+  return *this;
+}
+
+//==============================================================================
+rmf_traffic::Duration Auctioneer::fleet_presence_timeout() const
+{
+  return _pimpl->fleet_presence_timeout;
+}
+
+//==============================================================================
+void Auctioneer::register_fleet(const std::string& fleet_name)
+{
+  _pimpl->registered_fleets.insert(fleet_name);
+}
+
+//==============================================================================
+void Auctioneer::unregister_fleet(const std::string& fleet_name)
+{
+  _pimpl->registered_fleets.erase(fleet_name);
+}
+
+//==============================================================================
+auto Auctioneer::metrics(std::shared_ptr<rmf_traffic_ros2::Metrics> value)
+-> Auctioneer&
+{
+  _pimpl->metrics = std::move(value);
+  _pimpl->instruments = std::nullopt;
+  if (!_pimpl->metrics)
+    return *this;
+
+  auto& m = *_pimpl->metrics;
+  const std::string concluded = "rmf_auctions_concluded";
+  const std::string concluded_help = "Auctions that have concluded";
+  _pimpl->instruments = Implementation::Instruments{
+    m.counter("rmf_auctions_opened", "Auctions that have been announced"),
+    m.counter(concluded, concluded_help, {{"outcome", "awarded"}}),
+    m.counter(concluded, concluded_help, {{"outcome", "no_bids"}}),
+    m.histogram(
+      "rmf_auction_seconds",
+      "How long auctions took from their announcement to their conclusion"),
+    m.gauge("rmf_auctions_queued", "Tasks that are waiting for an auction")
+  };
+
+  _pimpl->record_queue_size();
+  return *this;
+}
+
+//==============================================================================
+std::shared_ptr<rmf_traffic_ros2::Metrics> Auctioneer::metrics() const
+{
+  return _pimpl->metrics;
+}
+
 //==============================================================================
 void Auctioneer::select_evaluator(
   std::shared_ptr<Auctioneer::Evaluator> evaluator)
@@ -251,5 +569,83 @@ std::size_t QuickestFinishEvaluator::choose(
   return std::distance(submissions.begin(), winner_it);
 }
 
+//==============================================================================
+WeightedEvaluator::WeightedEvaluator(Weights weights)
+: _weights(std::move(weights))
+{
+  // Do nothing
+}
+
+//==============================================================================
+auto WeightedEvaluator::weights() const -> const Weights&
+{
+  return _weights;
+}
+
+//==============================================================================
+std::size_t WeightedEvaluator::choose(const Submissions& submissions) const
+{
+  constexpr std::size_t N = 4;
+  const auto criteria = [](const Submission& s) -> std::array<double, N>
+    {
+      return {
+        s.new_cost - s.prev_cost,
+        s.new_cost,
+        rmf_traffic::time::to_seconds(s.finish_time.time_since_epoch()),
+        s.prev_cost
+      };
+    };
+
+  const std::array<double, N> weights = {
+    _weights.cost_diff,
+    _weights.new_cost,
+    _weights.finish_time,
+    _weights.fleet_load
+  };
+
+  // Find the range of each criterion
+  std::vector<std::array<double, N>> values;
+  values.reserve(submissions.size());
+  std::array<double, N> lower;
+  std::array<double, N> upper;
+  lower.fill(std::numeric_limits<double>::infinity());
+  upper.fill(-std::numeric_limits<double>::infinity());
+  for (const auto& s : submissions)
+  {
+    values.push_back(criteria(s));
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      lower[c] = std::min(lower[c], values.back()[c]);
+      upper[c] = std::max(upper[c], values.back()[c]);
+    }
+  }
+
+  // Scale each criterion to [0, 1] and weigh it. A criterion on which every
+  // submission is equal does not count.
+  std::array<double, N> scale;
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    const double range = upper[c] - lower[c];
+    scale[c] = range > 0.0 ? weights[c] / range : 0.0;
+  }
+
+  std::size_t winner = 0;
+  double winner_score = std::numeric_limits<double>::infinity();
+  for (std::size_t i = 0; i < values.size(); ++i)
+  {
+    double score = 0.0;
+    for (std::size_t c = 0; c < N; ++c)
+      score += scale[c] * (values[i][c] - lower[c]);
+
+    if (score < winner_score)
+    {
+      winner = i;
+      winner_score = score;
+    }
+  }
+
+  return winner;
+}
+
 } // namespace bidding
 } // namespace rmf_task_ros2
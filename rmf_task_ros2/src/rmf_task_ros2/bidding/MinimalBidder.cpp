@@ -49,8 +49,9 @@ public:
   std::unordered_set<TaskType> valid_task_types;
   ParseSubmissionCallback get_submission_fn;
 
+  // The bidder only listens to the bid notices of its valid task types
   using BidNoticeSub = rclcpp::Subscription<BidNotice>;
-  BidNoticeSub::SharedPtr dispatch_notice_sub;
+  std::vector<BidNoticeSub::SharedPtr> dispatch_notice_subs;
 
   using BidProposalPub = rclcpp::Publisher<BidProposal>;
   BidProposalPub::SharedPtr dispatch_proposal_pub;
@@ -67,12 +68,18 @@ public:
   {
     const auto dispatch_qos = rclcpp::ServicesQoS().reliable();
 
-    dispatch_notice_sub = node->create_subscription<BidNotice>(
-      rmf_task_ros2::BidNoticeTopicName, dispatch_qos,
-      [&](const BidNotice::UniquePtr msg)
-      {
-        this->receive_notice(*msg);
-      });
+    for (const auto task_type : valid_task_types)
+    {
+      dispatch_notice_subs.push_back(
+        node->create_subscription<BidNotice>(
+          rmf_task_ros2::bid_notice_topic_name(
+            static_cast<uint32_t>(task_type)),
+          dispatch_qos,
+          [&](const BidNotice::UniquePtr msg)
+          {
+            this->receive_notice(*msg);
+          }));
+    }
 
     dispatch_proposal_pub = node->create_publisher<BidProposal>(
       rmf_task_ros2::BidProposalTopicName, dispatch_qos);
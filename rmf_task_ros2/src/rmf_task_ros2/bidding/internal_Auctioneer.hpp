@@ -26,6 +26,12 @@
 #include <rmf_traffic_ros2/Time.hpp>
 #include <rmf_task_ros2/StandardNames.hpp>
 
+#include "../Synchronization.hpp"
+
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace rmf_task_ros2 {
 namespace bidding {
 
@@ -36,6 +42,7 @@ class Auctioneer::Implementation
 {
 public:
   std::shared_ptr<rclcpp::Node> node;
+  Synchronization sync;
   rclcpp::TimerBase::SharedPtr timer;
   BiddingResultCallback bidding_result_callback;
   std::shared_ptr<Evaluator> evaluator;
@@ -47,30 +54,99 @@ public:
     std::vector<bidding::Submission> submissions;
   };
 
-  bool bidding_in_proccess = false;
-  std::queue<BiddingTask> queue_bidding_tasks;
+  // Auctions that have been announced, keyed by task_id
+  std::unordered_map<std::string, BiddingTask> open_auctions;
+  // Bidding tasks that are waiting for an auction to close. High priority
+  // tasks wait in their own queue, which is always served first.
+  std::deque<BiddingTask> queue_bidding_tasks;
+  std::deque<BiddingTask> priority_bidding_tasks;
+  // Repeated tasks that reached the front of a queue while their earlier
+  // auction was still open. They step aside so the tasks behind them are not
+  // held up, and return to the front of their queue once that auction closes.
+  std::vector<BiddingTask> held_bidding_tasks;
+  std::size_t max_concurrent_auctions = 1;
+
+  bool close_auctions_early = false;
+  rmf_traffic::Duration fleet_presence_timeout = std::chrono::seconds(60);
+  // The last time that each fleet submitted a proposal
+  std::unordered_map<std::string, rclcpp::Time> fleet_last_seen;
+  std::unordered_set<std::string> registered_fleets;
+
+  // Where the auctions are recorded, if anywhere
+  std::shared_ptr<rmf_traffic_ros2::Metrics> metrics;
+  struct Instruments
+  {
+    std::shared_ptr<rmf_traffic_ros2::Metrics::Counter> opened;
+    std::shared_ptr<rmf_traffic_ros2::Metrics::Counter> awarded;
+    std::shared_ptr<rmf_traffic_ros2::Metrics::Counter> without_bids;
+    std::shared_ptr<rmf_traffic_ros2::Metrics::Histogram> auction_seconds;
+    std::shared_ptr<rmf_traffic_ros2::Metrics::Gauge> queued;
+  };
+  std::optional<Instruments> instruments;
 
   using BidNoticePub = rclcpp::Publisher<BidNotice>;
   BidNoticePub::SharedPtr bid_notice_pub;
 
+  // Publishers for the topic of each task type, which the bidders that have
+  // declared the task types they serve listen to
+  std::unordered_map<uint32_t, BidNoticePub::SharedPtr> typed_bid_notice_pubs;
+
   using BidProposalSub = rclcpp::Subscription<BidProposal>;
   BidProposalSub::SharedPtr bid_proposal_sub;
 
   Implementation(
     const std::shared_ptr<rclcpp::Node>& node_,
-    BiddingResultCallback result_callback);
+    BiddingResultCallback result_callback,
+    Synchronization sync_ = Synchronization());
+
+  /// Same as Auctioneer::make, except the timer and the proposal subscription
+  /// of the auctioneer use the callback group and mutex of sync.
+  static std::shared_ptr<Auctioneer> make(
+    const std::shared_ptr<rclcpp::Node>& node,
+    BiddingResultCallback result_callback,
+    Synchronization sync);
 
   /// Start a bidding process
   void start_bidding(const BidNotice& bid_notice);
 
+  // Get the publisher for the topic of a task type, creating it if needed
+  const BidNoticePub::SharedPtr& typed_bid_notice_pub(uint32_t task_type);
+
+  // Announce a bid notice to the bidders that may serve it
+  void publish_notice(const BidNotice& bid_notice);
+
   // Receive proposal and evaluate
   void receive_proposal(const BidProposal& msg);
 
   // determine the winner within a bidding task instance
   void check_bidding_process();
 
+  // Announce queued bidding tasks while there is room for more auctions
+  void open_auctions_from_queue();
+
+  // Update the gauge of the tasks that are waiting for an auction
+  void record_queue_size();
+
+  // Announce the task at the front of the queue, or hold it back if it
+  // already has an open auction
+  void open_next_auction(std::deque<BiddingTask>& queue);
+
+  // Return the held tasks whose earlier auction has closed to the front of
+  // their queues
+  void release_held_tasks();
+
+  // The number of open auctions that are for high priority tasks
+  std::size_t open_priority_auctions() const;
+
   bool determine_winner(const BiddingTask& bidding_task);
 
+  // Choose the winner of an auction and report it to the result callback
+  void conclude(const BiddingTask& bidding_task);
+
+  // Check whether every fleet that is known to be present has submitted a
+  // proposal for the auction
+  bool all_present_fleets_submitted(const BiddingTask& bidding_task) const;
+
   std::optional<Submission> evaluate(const Submissions& submissions);
 
   static const Implementation& get(const Auctioneer& auctioneer)
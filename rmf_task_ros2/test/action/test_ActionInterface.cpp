@@ -195,6 +195,33 @@ SCENARIO("Action communication with client and server", "[ActionInterface]")
     CHECK((*test_task_onterminate)->state == TaskStatus::State::Completed);
   }
 
+  WHEN("Status updates are sent in batches")
+  {
+    action_server->batch_status_updates(
+      rmf_traffic::time::from_seconds(0.2));
+
+    TaskStatusPtr status_ptr(new TaskStatus);
+    action_client->add_task("test_server", task_profile1, status_ptr);
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(0.5));
+    REQUIRE(status_ptr->state == TaskStatus::State::Queued);
+
+    // Only the latest of these updates needs to arrive
+    TaskStatus server_task;
+    server_task.task_profile = task_profile1;
+    server_task.state = TaskStatus::State::Executing;
+    action_server->update_status(server_task);
+    server_task.state = TaskStatus::State::Completed;
+    action_server->update_status(server_task);
+
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(1.0));
+
+    REQUIRE(test_task_onterminate->has_value());
+    CHECK((*test_task_onterminate)->state == TaskStatus::State::Completed);
+    CHECK(action_client->size() == 0);
+  }
+
   rclcpp::shutdown(rcl_context);
 }
 
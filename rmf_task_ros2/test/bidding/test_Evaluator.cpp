@@ -112,6 +112,50 @@ SCENARIO("Auctioneer Winner Evaluator", "[Evaluator]")
     }
   }
 
+  WHEN("Weighted Evaluator")
+  {
+    AND_WHEN("0 submissions")
+    {
+      auctioneer->select_evaluator(
+        std::make_shared<WeightedEvaluator>(WeightedEvaluator::Weights()));
+      std::vector<Submission> submissions{};
+      auto winner = evaluate(*auctioneer, submissions);
+      REQUIRE(!winner); // no winner
+    }
+    AND_WHEN("Only the cost difference is weighed")
+    {
+      auctioneer->select_evaluator(
+        std::make_shared<WeightedEvaluator>(WeightedEvaluator::Weights()));
+      std::vector<Submission> submissions{
+        submission1, submission2, submission3, submission4, submission5 };
+      auto winner = evaluate(*auctioneer, submissions);
+      REQUIRE(winner->fleet_name == "fleet2"); // same as least diff cost
+    }
+    AND_WHEN("Only the finish time is weighed")
+    {
+      WeightedEvaluator::Weights weights;
+      weights.cost_diff = 0.0;
+      weights.finish_time = 1.0;
+      auctioneer->select_evaluator(
+        std::make_shared<WeightedEvaluator>(weights));
+      std::vector<Submission> submissions{
+        submission1, submission2, submission3, submission4, submission5 };
+      auto winner = evaluate(*auctioneer, submissions);
+      REQUIRE(winner->fleet_name == "fleet3"); // same as quickest finish
+    }
+    AND_WHEN("The cost difference and finish time are weighed equally")
+    {
+      WeightedEvaluator::Weights weights;
+      weights.finish_time = 1.0;
+      auctioneer->select_evaluator(
+        std::make_shared<WeightedEvaluator>(weights));
+      std::vector<Submission> submissions{
+        submission1, submission2, submission3, submission4, submission5 };
+      auto winner = evaluate(*auctioneer, submissions);
+      REQUIRE(winner->fleet_name == "fleet5"); // best compromise
+    }
+  }
+
   rclcpp::shutdown(rcl_context);
 }
 
@@ -17,11 +17,14 @@
 
 #include <rmf_task_ros2/bidding/MinimalBidder.hpp>
 #include <rmf_task_ros2/bidding/Auctioneer.hpp>
+#include <rmf_task_ros2/StandardNames.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <rmf_traffic_ros2/Time.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
+#include <vector>
 #include <rmf_utils/catch.hpp>
 
 namespace rmf_task_ros2 {
@@ -50,6 +53,7 @@ SCENARIO("Auction with 2 Bids", "[TwoBids]")
   bidding_task2.time_window = timeout;
   bidding_task2.task_profile.description.task_type.type =
     rmf_task_msgs::msg::TaskType::TYPE_DELIVERY;
+  bidding_task2.task_profile.description.priority.value = 0;
 
   //============================================================================
   // test received msg
@@ -57,6 +61,7 @@ SCENARIO("Auction with 2 Bids", "[TwoBids]")
   std::optional<TaskProfile> test_notice_bidder2;
   std::string r_result_id = "";
   std::string r_result_winner = "";
+  std::vector<std::string> r_result_ids;
 
   // Creating 1 auctioneer and 1 bidder
   const auto rcl_context = std::make_shared<rclcpp::Context>();
@@ -67,9 +72,10 @@ SCENARIO("Auction with 2 Bids", "[TwoBids]")
   auto auctioneer = Auctioneer::make(
     node,
     /// Bidding Result Callback Function
-    [&r_result_id, &r_result_winner](
+    [&r_result_id, &r_result_winner, &r_result_ids](
       const std::string& task_id, const std::optional<Submission> winner)
     {
+      r_result_ids.push_back(task_id);
       if (!winner)
         return;
       r_result_id = task_id;
@@ -153,6 +159,139 @@ SCENARIO("Auction with 2 Bids", "[TwoBids]")
     REQUIRE(r_result_id == "bid2");
   }
 
+  WHEN("Both tasks are bid for concurrently")
+  {
+    auctioneer->max_concurrent_auctions(2);
+    CHECK(auctioneer->max_concurrent_auctions() == 2);
+
+    bidding_task1.task_profile.submission_time = node->now();
+    bidding_task2.task_profile.submission_time = node->now();
+    auctioneer->start_bidding(bidding_task1);
+    auctioneer->start_bidding(bidding_task2);
+
+    // Conducted one after another, the two auctions would need more than
+    // twice the time window
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(3.0));
+
+    REQUIRE(r_result_ids.size() == 2);
+    CHECK(std::count(r_result_ids.begin(), r_result_ids.end(), "bid1") == 1);
+    CHECK(std::count(r_result_ids.begin(), r_result_ids.end(), "bid2") == 1);
+  }
+
+  WHEN("A repeated task is queued ahead of a distinct task")
+  {
+    auctioneer->max_concurrent_auctions(2);
+
+    bidding_task1.task_profile.submission_time = node->now();
+    bidding_task2.task_profile.submission_time = node->now();
+    auctioneer->start_bidding(bidding_task1);
+    auctioneer->start_bidding(bidding_task1);
+    auctioneer->start_bidding(bidding_task2);
+
+    // The repeated task has to wait for the first auction of bid1, but bid2
+    // behind it is announced right away in the free slot
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(1.0));
+    REQUIRE(test_notice_bidder2);
+    CHECK(test_notice_bidder2->task_id == "bid2");
+    CHECK(r_result_ids.empty());
+
+    // The repeated task is auctioned once the first auction of bid1 closes
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(4.5));
+    REQUIRE(r_result_ids.size() == 3);
+    CHECK(std::count(r_result_ids.begin(), r_result_ids.end(), "bid1") == 2);
+    CHECK(std::count(r_result_ids.begin(), r_result_ids.end(), "bid2") == 1);
+  }
+
+  WHEN("The auction closes once all present fleets have bid")
+  {
+    auctioneer->close_auctions_early(true);
+    CHECK(auctioneer->close_auctions_early());
+    auctioneer->register_fleet("bidder1");
+    auctioneer->register_fleet("bidder2");
+
+    bidding_task2.task_profile.submission_time = node->now();
+    auctioneer->start_bidding(bidding_task2);
+
+    // Both bidders support the task, so the auction should close well before
+    // the end of its time window
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(1.0));
+
+    REQUIRE(r_result_id == "bid2");
+    CHECK(r_result_winner == "bidder2");
+  }
+
+  WHEN("A registered fleet does not bid")
+  {
+    auctioneer->close_auctions_early(true);
+    auctioneer->register_fleet("bidder1");
+    auctioneer->register_fleet("bidder2");
+
+    // bidder2 does not support Station tasks, so the auction waits for the
+    // end of its time window
+    bidding_task1.task_profile.submission_time = node->now();
+    auctioneer->start_bidding(bidding_task1);
+
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(1.0));
+    CHECK(r_result_ids.empty());
+
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(2.0));
+    REQUIRE(r_result_id == "bid1");
+    CHECK(r_result_winner == "bidder1");
+  }
+
+  WHEN("A high priority task is bid for during a low priority auction")
+  {
+    bidding_task1.task_profile.submission_time = node->now();
+    auctioneer->start_bidding(bidding_task1);
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(0.5));
+    REQUIRE(test_notice_bidder1);
+    CHECK(test_notice_bidder1->task_id == "bid1");
+
+    bidding_task2.task_profile.description.priority.value = 1;
+    bidding_task2.task_profile.submission_time = node->now();
+    auctioneer->start_bidding(bidding_task2);
+
+    // The urgent task is announced without waiting for the end of the first
+    // auction
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(0.5));
+    REQUIRE(test_notice_bidder2);
+    CHECK(test_notice_bidder2->task_id == "bid2");
+    CHECK(r_result_ids.empty());
+  }
+
+  WHEN("A bidder only listens to the notices of one task type")
+  {
+    std::vector<std::string> station_notices;
+    const auto station_sub = node->create_subscription<BidNotice>(
+      bid_notice_topic_name(rmf_task_msgs::msg::TaskType::TYPE_STATION),
+      rclcpp::ServicesQoS().reliable(),
+      [&station_notices](const BidNotice::UniquePtr msg)
+      {
+        station_notices.push_back(msg->task_profile.task_id);
+      });
+
+    auctioneer->max_concurrent_auctions(2);
+    bidding_task1.task_profile.submission_time = node->now();
+    bidding_task2.task_profile.submission_time = node->now();
+    auctioneer->start_bidding(bidding_task1);
+    auctioneer->start_bidding(bidding_task2);
+
+    executor.spin_until_future_complete(ready_future,
+      rmf_traffic::time::from_seconds(1.0));
+
+    // The Delivery notice was never delivered to the Station topic
+    REQUIRE(station_notices.size() == 1);
+    CHECK(station_notices.front() == "bid1");
+  }
+
   rclcpp::shutdown(rcl_context);
 }
 
@@ -25,9 +25,13 @@
 #include <rmf_task_msgs/srv/submit_task.hpp>
 #include <rmf_task_msgs/srv/cancel_task.hpp>
 #include <rmf_task_msgs/srv/get_task_list.hpp>
+#include <rmf_task_msgs/msg/tasks.hpp>
 
+#include <atomic>
 #include <chrono>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <rmf_utils/catch.hpp>
 
 namespace rmf_task_ros2 {
@@ -99,6 +103,50 @@ SCENARIO("Dispatcher API Test", "[Dispatcher][.flaky]")
     REQUIRE(dispatcher->submit_task(task_desc2) == std::nullopt);
   }
 
+  WHEN("Add a batch of tasks")
+  {
+    const auto ids = dispatcher->submit_tasks({task_desc1, task_desc2});
+    REQUIRE(ids.has_value());
+    REQUIRE(ids->size() == 2);
+    CHECK((*ids)[0] != (*ids)[1]);
+    REQUIRE(dispatcher->active_tasks().size() == 2);
+    for (const auto& id : *ids)
+      CHECK(dispatcher->get_task_state(id) == TaskStatus::State::Pending);
+
+    // A batch with an invalid task is rejected as a whole
+    Dispatcher::TaskDescription invalid_desc;
+    invalid_desc.task_type.type = 10;
+    CHECK(dispatcher->submit_tasks({task_desc1, invalid_desc}) == std::nullopt);
+    CHECK(dispatcher->active_tasks().size() == 2);
+  }
+
+  WHEN("Page through terminated tasks")
+  {
+    std::vector<TaskID> ids;
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      const auto id = dispatcher->submit_task(task_desc1);
+      REQUIRE(id.has_value());
+      ids.push_back(*id);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    for (const auto& id : ids)
+      REQUIRE(dispatcher->cancel_task(id));
+
+    // The most recently submitted task comes first
+    const auto first_page = dispatcher->terminated_tasks(0, 2);
+    REQUIRE(first_page.size() == 2);
+    CHECK(first_page[0]->task_profile.task_id == ids[2]);
+    CHECK(first_page[1]->task_profile.task_id == ids[1]);
+
+    const auto second_page = dispatcher->terminated_tasks(2, 2);
+    REQUIRE(second_page.size() == 1);
+    CHECK(second_page[0]->task_profile.task_id == ids[0]);
+
+    CHECK(dispatcher->terminated_tasks(3, 2).empty());
+  }
+
   //============================================================================
   // test on change fn callback
   const auto change_times = std::make_shared<int>(0);
@@ -264,4 +312,160 @@ SCENARIO("Dispatcher API Test", "[Dispatcher][.flaky]")
   dispatcher_spin_thread.join();
 }
 
+//==============================================================================
+SCENARIO("Dispatcher publishes the changes of its tasks", "[Dispatcher]")
+{
+  using TasksMsg = rmf_task_msgs::msg::Tasks;
+
+  Dispatcher::TaskDescription task_desc;
+  task_desc.task_type.type = rmf_task_msgs::msg::TaskType::TYPE_STATION;
+
+  const auto rcl_context = std::make_shared<rclcpp::Context>();
+  rcl_context->init(0, nullptr);
+
+  const auto node = std::make_shared<rclcpp::Node>(
+    "test_dispatcher_changes_node",
+    rclcpp::NodeOptions()
+    .context(rcl_context)
+    .parameter_overrides({{"task_changes_period", 0.1}}));
+
+  // The latest state of each task that was published as a change, and how
+  // many times each task was published
+  std::mutex mutex;
+  std::unordered_map<std::string, uint32_t> states;
+  std::unordered_map<std::string, std::size_t> counts;
+  const auto sub = node->create_subscription<TasksMsg>(
+    rmf_task_ros2::TaskChangesTopicName,
+    rclcpp::ServicesQoS().reliable(),
+    [&](const TasksMsg::SharedPtr msg)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (const auto& task : msg->tasks)
+      {
+        states[task.task_id] = task.state;
+        ++counts[task.task_id];
+      }
+    });
+
+  const auto dispatcher = Dispatcher::make(node);
+  auto dispatcher_spin_thread = std::thread(
+    [dispatcher]()
+    {
+      dispatcher->spin();
+    });
+
+  const auto state_of = [](TaskStatus::State state)
+    {
+      return static_cast<uint32_t>(state);
+    };
+
+  const auto id_0 = dispatcher->submit_task(task_desc);
+  const auto id_1 = dispatcher->submit_task(task_desc);
+  REQUIRE(id_0.has_value());
+  REQUIRE(id_1.has_value());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(400));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    CHECK(states.size() == 2);
+    CHECK(states[*id_0] == state_of(TaskStatus::State::Pending));
+    CHECK(states[*id_1] == state_of(TaskStatus::State::Pending));
+    CHECK(counts[*id_0] == 1);
+    CHECK(counts[*id_1] == 1);
+  }
+
+  // Only the task that was cancelled gets published again, with its final
+  // state, and it is only published once
+  REQUIRE(dispatcher->cancel_task(*id_0));
+  std::this_thread::sleep_for(std::chrono::milliseconds(400));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    CHECK(states[*id_0] == state_of(TaskStatus::State::Canceled));
+    CHECK(counts[*id_0] == 2);
+    CHECK(states[*id_1] == state_of(TaskStatus::State::Pending));
+    CHECK(counts[*id_1] == 1);
+  }
+
+  rclcpp::shutdown(rcl_context);
+  dispatcher_spin_thread.join();
+}
+
+//==============================================================================
+SCENARIO("Dispatcher task lists can be read while it spins", "[Dispatcher]")
+{
+  Dispatcher::TaskDescription task_desc;
+  task_desc.task_type.type = rmf_task_msgs::msg::TaskType::TYPE_STATION;
+
+  const auto rcl_context = std::make_shared<rclcpp::Context>();
+  rcl_context->init(0, nullptr);
+
+  const auto node = std::make_shared<rclcpp::Node>(
+    "test_dispatcher_threads_node",
+    rclcpp::NodeOptions()
+    .context(rcl_context)
+    .parameter_overrides({{"executor_threads", 4}}));
+
+  const auto dispatcher = Dispatcher::make(node);
+  auto dispatcher_spin_thread = std::thread(
+    [dispatcher]()
+    {
+      dispatcher->spin();
+    });
+
+  // Read the task lists over and over while tasks come and go. Catch cannot
+  // be used from this thread, so the results are checked after it is joined.
+  std::atomic_bool done{false};
+  std::size_t reads = 0;
+  std::size_t mismatches = 0;
+  auto reader = std::thread(
+    [&]()
+    {
+      while (!done)
+      {
+        for (const auto& [id, status] : dispatcher->active_tasks())
+        {
+          if (status->task_profile.task_id != id)
+            ++mismatches;
+        }
+
+        for (const auto& [id, status] : dispatcher->terminated_tasks())
+        {
+          if (!status->is_terminated())
+            ++mismatches;
+        }
+
+        ++reads;
+      }
+    });
+
+  const std::size_t num_tasks = 50;
+  std::vector<TaskID> ids;
+  for (std::size_t i = 0; i < num_tasks; ++i)
+  {
+    const auto id = dispatcher->submit_task(task_desc);
+    REQUIRE(id.has_value());
+    ids.push_back(*id);
+  }
+
+  // The copy of the active tasks does not change when the tasks do
+  const auto active = dispatcher->active_tasks();
+  CHECK(active.size() == num_tasks);
+
+  for (const auto& id : ids)
+    CHECK(dispatcher->cancel_task(id));
+
+  done = true;
+  reader.join();
+  CHECK(reads > 0);
+  CHECK(mismatches == 0);
+
+  CHECK(dispatcher->active_tasks().empty());
+  CHECK(dispatcher->terminated_tasks().size() == num_tasks);
+  REQUIRE(active.count(ids.front()) > 0);
+  CHECK(active.at(ids.front())->state == TaskStatus::State::Pending);
+
+  rclcpp::shutdown(rcl_context);
+  dispatcher_spin_thread.join();
+}
+
 } // namespace rmf_task_ros2
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "../../src/rmf_task_ros2/TaskJournal.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#include <rmf_utils/catch.hpp>
+
+namespace rmf_task_ros2 {
+
+namespace {
+//==============================================================================
+TaskStatus make_status(const std::string& id, const TaskStatus::State state)
+{
+  TaskStatus status;
+  status.task_profile.task_id = id;
+  status.fleet_name = "fleet";
+  status.robot_name = "robot";
+  status.state = state;
+  return status;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Recovering dispatcher tasks from a journal", "[TaskJournal]")
+{
+  const std::string path = "test_task_journal.bin";
+  std::remove(path.c_str());
+  std::remove((path + ".snapshot").c_str());
+
+  {
+    TaskJournal::State empty;
+    TaskJournal journal(path, empty);
+    CHECK(empty.task_counter == 0);
+    CHECK(empty.active_tasks.empty());
+
+    journal.record_task_counter(1);
+    journal.record_active(
+      make_status("Station0", TaskStatus::State::Pending), true);
+    journal.record_task_counter(2);
+    journal.record_active(
+      make_status("Loop1", TaskStatus::State::Queued), true);
+    journal.record_task_counter(3);
+    journal.record_active(
+      make_status("Clean2", TaskStatus::State::Pending), true);
+    journal.record_terminated(
+      make_status("Clean2", TaskStatus::State::Canceled));
+    journal.record_active(
+      make_status("Charge", TaskStatus::State::Executing), false);
+    CHECK(journal.size() == 8);
+  }
+
+  WHEN("The journal is reopened")
+  {
+    TaskJournal::State recovered;
+    TaskJournal journal(path, recovered);
+    CHECK(journal.size() == 0);
+
+    CHECK(recovered.task_counter == 3);
+    REQUIRE(recovered.active_tasks.size() == 3);
+    CHECK(recovered.active_tasks.at("Station0").state ==
+      TaskStatus::State::Pending);
+    CHECK(recovered.active_tasks.at("Loop1").state ==
+      TaskStatus::State::Queued);
+    CHECK(recovered.active_tasks.at("Loop1").robot_name == "robot");
+    CHECK(recovered.user_submitted_tasks.count("Station0"));
+    CHECK(!recovered.user_submitted_tasks.count("Charge"));
+    REQUIRE(recovered.terminated_tasks.size() == 1);
+    CHECK(recovered.terminated_tasks.at("Clean2").state ==
+      TaskStatus::State::Canceled);
+
+    THEN("Changes after the compaction are recovered as well")
+    {
+      journal.record_evicted("Clean2");
+      journal.record_terminated(
+        make_status("Loop1", TaskStatus::State::Completed));
+
+      TaskJournal::State again;
+      TaskJournal reopened(path, again);
+      CHECK(again.task_counter == 3);
+      CHECK(again.active_tasks.size() == 2);
+      REQUIRE(again.terminated_tasks.size() == 1);
+      CHECK(again.terminated_tasks.count("Loop1"));
+    }
+  }
+
+  WHEN("The journal ends with a partial record")
+  {
+    {
+      std::ofstream file(path, std::ios::binary | std::ios::app);
+      file.write("\x40\x00\x00\x00\x12\x34", 6);
+    }
+
+    TaskJournal::State recovered;
+    TaskJournal journal(path, recovered);
+    CHECK(recovered.task_counter == 3);
+    CHECK(recovered.active_tasks.size() == 3);
+    CHECK(recovered.terminated_tasks.size() == 1);
+  }
+
+  WHEN("A corrupted record claims to be larger than the journal")
+  {
+    {
+      std::ofstream file(path, std::ios::binary | std::ios::app);
+      file.write("\xff\xff\xff\xff\x12\x34\x56\x78\x02\x00", 10);
+    }
+
+    THEN("Replaying stops there instead of trying to read it")
+    {
+      TaskJournal::State recovered;
+      TaskJournal journal(path, recovered);
+      CHECK(recovered.task_counter == 3);
+      CHECK(recovered.active_tasks.size() == 3);
+      CHECK(recovered.terminated_tasks.size() == 1);
+    }
+  }
+
+  WHEN("The journal is compacted")
+  {
+    TaskJournal::State recovered;
+    TaskJournal journal(path, recovered);
+
+    THEN("No temporary snapshot is left behind")
+    {
+      std::ifstream temporary(path + ".snapshot.tmp");
+      CHECK_FALSE(temporary.good());
+    }
+  }
+
+  std::remove(path.c_str());
+  std::remove((path + ".snapshot").c_str());
+}
+
+} // namespace rmf_task_ros2
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef RMF_TRAFFIC_ROS2__CALLBACKWATCHDOG_HPP
+#define RMF_TRAFFIC_ROS2__CALLBACKWATCHDOG_HPP
+
+#include <rmf_traffic_ros2/Metrics.hpp>
+
+#include <rclcpp/any_executable.hpp>
+#include <rclcpp/node.hpp>
+
+#include <rmf_utils/impl_ptr.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+/// The name of the node parameter that sets how often, in seconds, a node
+/// reports the timing of its executor callbacks. A value of 0 turns the
+/// timing off, which is the default.
+const std::string CallbackReportPeriodParameterName = "callback_report_period";
+
+//==============================================================================
+/// The name of the node parameter that sets how long, in seconds, a callback
+/// may run before it is counted as slow. The default is 0.1.
+const std::string SlowCallbackThresholdParameterName =
+  "slow_callback_threshold";
+
+//==============================================================================
+/// Collects how long each executor callback or planning job took, so that
+/// blocking work on an executor thread can be found without attaching a
+/// profiler. Each report lists the sources whose longest run was the worst
+/// since the previous report, together with a histogram of every duration
+/// that was recorded.
+///
+/// record() is safe to call from any thread.
+class CallbackWatchdog
+{
+public:
+
+  using Duration = std::chrono::steady_clock::duration;
+
+  /// Constructor
+  ///
+  /// \param[in] slow_threshold
+  ///   Callbacks that run longer than this are counted as slow
+  ///
+  /// \param[in] metrics
+  ///   If provided, every duration is also observed by the
+  ///   rmf_callback_seconds histogram of this registry, and slow callbacks
+  ///   are counted by rmf_slow_callbacks.
+  CallbackWatchdog(
+    Duration slow_threshold = std::chrono::milliseconds(100),
+    std::shared_ptr<Metrics> metrics = nullptr);
+
+  /// Record how long a callback took.
+  ///
+  /// \param[in] source
+  ///   What ran, e.g. the result of describe() or the name of a job
+  ///
+  /// \param[in] duration
+  ///   How long it ran for
+  void record(const std::string& source, Duration duration);
+
+  /// Describe an executable that an rclcpp executor is about to run, e.g.
+  /// "subscription /fleet_states [/rmf_traffic_schedule_node]"
+  static std::string describe(const rclcpp::AnyExecutable& executable);
+
+  /// The bucket bounds, in seconds, of the histogram of a report
+  static std::vector<double> histogram_bounds();
+
+  struct Offender
+  {
+    std::string source;
+
+    /// How many times this source ran during the report
+    uint64_t count = 0;
+
+    /// How many of those runs were slower than the threshold
+    uint64_t slow = 0;
+
+    Duration total = Duration(0);
+    Duration max = Duration(0);
+  };
+
+  struct Report
+  {
+    /// How much time the report covers
+    Duration period = Duration(0);
+
+    Duration slow_threshold = Duration(0);
+
+    /// How many callbacks were recorded
+    uint64_t count = 0;
+
+    /// How many of them were slower than the threshold
+    uint64_t slow = 0;
+
+    /// The sources with the longest single runs, longest first
+    std::vector<Offender> worst;
+
+    /// How many of the recorded durations fall in each bucket
+    Metrics::Histogram::Snapshot histogram;
+  };
+
+  /// Get the report of everything that was recorded since the previous
+  /// report, and start a new one.
+  ///
+  /// \param[in] worst
+  ///   How many offenders to list
+  Report take_report(std::size_t worst = 10);
+
+  /// Render a report as text for a log
+  static std::string format(const Report& report);
+
+  /// Log a report of the node every period, as a warning if any callback was
+  /// slow. This replaces any previous reporting.
+  void start_reporting(rclcpp::Node& node, Duration period);
+
+  /// Declare the callback_report_period and slow_callback_threshold
+  /// parameters of the node, and make a watchdog that reports on the node
+  /// according to them.
+  ///
+  /// \return nullptr if the callback_report_period parameter is not
+  /// positive, in which case nothing should be timed.
+  static std::shared_ptr<CallbackWatchdog> from_parameters(
+    rclcpp::Node& node,
+    std::shared_ptr<Metrics> metrics = nullptr);
+
+  class Implementation;
+private:
+  rmf_utils::unique_impl_ptr<Implementation> _pimpl;
+};
+
+} // namespace rmf_traffic_ros2
+
+#endif // RMF_TRAFFIC_ROS2__CALLBACKWATCHDOG_HPP
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef RMF_TRAFFIC_ROS2__MEMORYUSAGE_HPP
+#define RMF_TRAFFIC_ROS2__MEMORYUSAGE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+/// An approximate account of the memory that a node holds in its major
+/// containers. Nodes fill this in periodically and publish it on the
+/// MemoryUsageTopicName topic so that memory budgets can be set for each
+/// container and leaks can be traced to the container that is growing.
+///
+/// The byte counts are estimates. They include the storage of the containers
+/// and whatever each node knows about the size of their elements, but not the
+/// overhead of the allocator.
+struct MemoryUsage
+{
+  struct Entry
+  {
+    /// The name of the container
+    std::string name;
+
+    /// The number of elements in the container
+    std::size_t count;
+
+    /// The estimated number of bytes that the container holds
+    std::size_t bytes;
+  };
+
+  std::vector<Entry> entries;
+
+  /// Add an entry to the account
+  MemoryUsage& add(std::string name, std::size_t count, std::size_t bytes);
+
+  /// The sum of the bytes of all the entries
+  std::size_t accounted_bytes() const;
+};
+
+//==============================================================================
+/// Serialize the account as a YAML document, together with the resident and
+/// peak resident memory of the process.
+///
+/// \param[in] usage
+///   The account to serialize
+///
+/// \param[in] node
+///   The fully qualified name of the node that filled in the account
+std::string serialize(const MemoryUsage& usage, const std::string& node);
+
+//==============================================================================
+/// The resident memory of this process, in bytes, or 0 if it is not known.
+std::size_t resident_memory_bytes();
+
+//==============================================================================
+/// The peak resident memory of this process, in bytes, or 0 if it is not
+/// known.
+std::size_t peak_resident_memory_bytes();
+
+namespace memory {
+
+//==============================================================================
+/// The bytes that a string holds on the heap, beyond its own size
+inline std::size_t heap_bytes(const std::string& s)
+{
+  // Short strings are stored inside the string object itself
+  return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
+
+//==============================================================================
+template<typename T, typename A>
+std::size_t heap_bytes(const std::vector<T, A>& v)
+{
+  return v.capacity() * sizeof(T);
+}
+
+//==============================================================================
+template<typename T, typename A>
+std::size_t heap_bytes(const std::deque<T, A>& d)
+{
+  return d.size() * sizeof(T);
+}
+
+//==============================================================================
+template<typename T, typename A>
+std::size_t heap_bytes(const std::list<T, A>& l)
+{
+  return l.size() * (sizeof(T) + 2 * sizeof(void*));
+}
+
+//==============================================================================
+template<typename K, typename V, typename C, typename A>
+std::size_t heap_bytes(const std::map<K, V, C, A>& m)
+{
+  // Each tree node holds a value, three links, and a color
+  return m.size() * (sizeof(typename std::map<K, V, C, A>::value_type)
+    + 4 * sizeof(void*));
+}
+
+//==============================================================================
+template<typename T, typename C, typename A>
+std::size_t heap_bytes(const std::set<T, C, A>& s)
+{
+  return s.size() * (sizeof(T) + 4 * sizeof(void*));
+}
+
+//==============================================================================
+template<typename K, typename V, typename H, typename E, typename A>
+std::size_t heap_bytes(const std::unordered_map<K, V, H, E, A>& m)
+{
+  // The bucket array, and each node holds a value, a link, and maybe a hash
+  using Value = typename std::unordered_map<K, V, H, E, A>::value_type;
+  return m.bucket_count() * sizeof(void*)
+    + m.size() * (sizeof(Value) + 2 * sizeof(void*));
+}
+
+//==============================================================================
+template<typename T, typename H, typename E, typename A>
+std::size_t heap_bytes(const std::unordered_set<T, H, E, A>& s)
+{
+  return s.bucket_count() * sizeof(void*)
+    + s.size() * (sizeof(T) + 2 * sizeof(void*));
+}
+
+//==============================================================================
+/// The bytes that a container holds on the heap, plus whatever the elements
+/// hold on the heap according to element_bytes.
+///
+/// \param[in] container
+///   The container to estimate
+///
+/// \param[in] element_bytes
+///   A callable that takes an element of the container and gives the bytes
+///   that it holds outside of the container's own storage
+template<typename Container, typename ElementBytes>
+std::size_t heap_bytes(const Container& container, ElementBytes element_bytes)
+{
+  std::size_t bytes = heap_bytes(container);
+  for (const auto& element : container)
+    bytes += element_bytes(element);
+
+  return bytes;
+}
+
+} // namespace memory
+} // namespace rmf_traffic_ros2
+
+#endif // RMF_TRAFFIC_ROS2__MEMORYUSAGE_HPP
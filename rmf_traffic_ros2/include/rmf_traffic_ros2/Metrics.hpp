@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef RMF_TRAFFIC_ROS2__METRICS_HPP
+#define RMF_TRAFFIC_ROS2__METRICS_HPP
+
+#include <rmf_traffic/Time.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+/// A registry of performance counters, gauges and histograms that the schedule
+/// node, the dispatcher and the fleet adapters share, so that their throughput
+/// and latency can be watched from one dashboard instead of scraped from their
+/// logs. The registry is exported by a MetricsExporter.
+///
+/// Each metric has a name, a help text, and any number of series that are
+/// told apart by their labels. Asking for the same name and labels again
+/// gives back the same series. Every method is safe to call from any thread,
+/// and recording a value into a series does not lock the registry.
+class Metrics
+{
+public:
+
+  /// The labels of a series, e.g. {{"fleet", "tinyRobot"}}
+  using Labels = std::map<std::string, std::string>;
+
+  /// A value that only goes up, such as the number of tasks submitted
+  class Counter
+  {
+  public:
+    void increment(uint64_t amount = 1);
+    uint64_t value() const;
+
+  private:
+    std::atomic<uint64_t> _value{0};
+  };
+
+  /// A value that can go up and down, such as the number of open negotiations
+  class Gauge
+  {
+  public:
+    void set(double value);
+    void add(double amount);
+    double value() const;
+
+  private:
+    std::atomic<double> _value{0.0};
+  };
+
+  /// Counts how many observations fall within each bucket. Each observation
+  /// falls in the first bucket whose upper bound it does not exceed, and the
+  /// final bucket catches everything beyond the last bound.
+  class Histogram
+  {
+  public:
+
+    /// Bucket bounds, in seconds, from a millisecond to five minutes
+    static std::vector<double> default_bounds();
+
+    /// Constructor
+    ///
+    /// \param[in] bounds
+    ///   The upper bound of each bucket except the last, in increasing order
+    Histogram(std::vector<double> bounds = default_bounds());
+
+    void observe(double value);
+
+    /// Observe a duration in seconds
+    void observe(rmf_traffic::Duration duration);
+
+    struct Snapshot
+    {
+      /// The upper bound of each bucket except the last
+      std::vector<double> bounds;
+
+      /// The number of observations in each bucket. This has one more entry
+      /// than bounds.
+      std::vector<uint64_t> counts;
+
+      uint64_t count = 0;
+      double sum = 0.0;
+    };
+
+    Snapshot snapshot() const;
+
+  private:
+    mutable std::mutex _mutex;
+    std::vector<double> _bounds;
+    std::vector<uint64_t> _counts;
+    uint64_t _count = 0;
+    double _sum = 0.0;
+  };
+
+  /// Get a counter. Its name should not end with _total, which is added when
+  /// the counter is exported.
+  ///
+  /// \throws std::runtime_error if the name is already used by a metric of
+  /// another type.
+  std::shared_ptr<Counter> counter(
+    const std::string& name,
+    const std::string& help,
+    const Labels& labels = {});
+
+  /// Get a gauge.
+  ///
+  /// \throws std::runtime_error if the name is already used by a metric of
+  /// another type.
+  std::shared_ptr<Gauge> gauge(
+    const std::string& name,
+    const std::string& help,
+    const Labels& labels = {});
+
+  /// Get a histogram. The bounds are only used when the series is created.
+  ///
+  /// \throws std::runtime_error if the name is already used by a metric of
+  /// another type.
+  std::shared_ptr<Histogram> histogram(
+    const std::string& name,
+    const std::string& help,
+    const Labels& labels = {},
+    std::vector<double> bounds = Histogram::default_bounds());
+
+  /// One exported value of a series. A histogram gives a _bucket sample for
+  /// each bucket, plus a _count and a _sum sample.
+  struct Sample
+  {
+    std::string name;
+    Labels labels;
+    double value;
+  };
+
+  /// Get the current value of every series, ordered by name and labels
+  std::vector<Sample> samples() const;
+
+  /// Render every series in the OpenMetrics text format, which Prometheus
+  /// can scrape
+  std::string openmetrics() const;
+
+private:
+
+  enum class Type
+  {
+    Counter,
+    Gauge,
+    Histogram
+  };
+
+  struct Family
+  {
+    Type type;
+    std::string help;
+    std::map<Labels, std::shared_ptr<Counter>> counters;
+    std::map<Labels, std::shared_ptr<Gauge>> gauges;
+    std::map<Labels, std::shared_ptr<Histogram>> histograms;
+  };
+
+  Family& family(
+    const std::string& caller,
+    const std::string& name,
+    const std::string& help,
+    Type type);
+
+  static void append_samples(
+    const std::string& name,
+    const Family& family,
+    std::vector<Sample>& output);
+
+  mutable std::mutex _mutex;
+  std::map<std::string, Family> _families;
+};
+
+//==============================================================================
+/// Format a series as it appears in the OpenMetrics text format, e.g.
+/// rmf_tasks_total{fleet="tinyRobot"}
+std::string format_series(
+  const std::string& name,
+  const Metrics::Labels& labels);
+
+} // namespace rmf_traffic_ros2
+
+#endif // RMF_TRAFFIC_ROS2__METRICS_HPP
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef RMF_TRAFFIC_ROS2__METRICSEXPORTER_HPP
+#define RMF_TRAFFIC_ROS2__METRICSEXPORTER_HPP
+
+#include <rmf_traffic_ros2/Metrics.hpp>
+
+#include <rclcpp/node.hpp>
+
+#include <rmf_utils/impl_ptr.hpp>
+
+#include <functional>
+#include <optional>
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+/// The name of the node parameter that sets how often, in seconds, the metrics
+/// of a node are refreshed and published on the diagnostics topic. A value of
+/// 0 turns the export off, which is the default.
+const std::string MetricsPeriodParameterName = "metrics_period";
+
+//==============================================================================
+/// The name of the node parameter that sets the TCP port of the OpenMetrics
+/// HTTP endpoint of a node. A value of 0 turns the endpoint off, which is the
+/// default.
+const std::string MetricsHttpPortParameterName = "metrics_http_port";
+
+//==============================================================================
+/// Exports a Metrics registry in two ways:
+/// * Periodically as a diagnostic_msgs/DiagnosticArray on the
+///   MetricsDiagnosticsTopicName topic, with one key-value pair per sample.
+/// * Optionally through an HTTP endpoint that serves the OpenMetrics text on
+///   GET /metrics, so that Prometheus can scrape it directly.
+///
+/// The endpoint is served from a thread of the exporter, so it never waits on
+/// the executor of the node. It is stopped when the exporter is destroyed.
+class MetricsExporter
+{
+public:
+
+  /// A callback that is triggered on the executor of the node right before
+  /// the metrics are published, so that gauges can be brought up to date.
+  using Refresh = std::function<void()>;
+
+  /// Make an exporter.
+  ///
+  /// \param[in] node
+  ///   The node that will publish the diagnostics. This must outlive the
+  ///   exporter.
+  ///
+  /// \param[in] metrics
+  ///   The registry to export
+  ///
+  /// \param[in] period
+  ///   How often to refresh and publish the metrics
+  ///
+  /// \param[in] http_port
+  ///   The port of the HTTP endpoint, or std::nullopt to not serve one. A
+  ///   port of 0 lets the operating system choose, which can be checked with
+  ///   http_port().
+  ///
+  /// \param[in] refresh
+  ///   Triggered before the metrics are published
+  ///
+  /// \param[in] group
+  ///   The callback group of the timer that publishes the metrics
+  ///
+  /// \throws std::runtime_error if the HTTP endpoint cannot be opened.
+  static std::shared_ptr<MetricsExporter> make(
+    rclcpp::Node& node,
+    std::shared_ptr<const Metrics> metrics,
+    rmf_traffic::Duration period,
+    std::optional<uint16_t> http_port = std::nullopt,
+    Refresh refresh = nullptr,
+    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+
+  /// Declare the metrics_period and metrics_http_port parameters of the node,
+  /// and make an exporter according to them.
+  ///
+  /// \return nullptr if the metrics_period parameter is not positive.
+  static std::shared_ptr<MetricsExporter> from_parameters(
+    rclcpp::Node& node,
+    std::shared_ptr<const Metrics> metrics,
+    Refresh refresh = nullptr,
+    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+
+  /// The port that the HTTP endpoint is listening on, if it is served
+  std::optional<uint16_t> http_port() const;
+
+  class Implementation;
+private:
+  MetricsExporter();
+  rmf_utils::unique_impl_ptr<Implementation> _pimpl;
+};
+
+} // namespace rmf_traffic_ros2
+
+#endif // RMF_TRAFFIC_ROS2__METRICSEXPORTER_HPP
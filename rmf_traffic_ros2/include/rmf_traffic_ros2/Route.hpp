@@ -27,6 +27,13 @@ rmf_traffic::Route convert(const rmf_traffic_msgs::msg::Route& from);
 //==============================================================================
 rmf_traffic_msgs::msg::Route convert(const rmf_traffic::Route& from);
 
+//==============================================================================
+/// Convert a Route into an existing Route message, reusing the memory of the
+/// message.
+void convert(
+  const rmf_traffic::Route& from,
+  rmf_traffic_msgs::msg::Route& into);
+
 //==============================================================================
 std::vector<rmf_traffic::Route> convert(
   const std::vector<rmf_traffic_msgs::msg::Route>& from);
@@ -33,13 +33,24 @@ const std::string ItineraryExtendTopicName = Prefix + "itinerary_extend";
 const std::string ItineraryDelayTopicName = Prefix + "itinerary_delay";
 const std::string ItineraryEraseTopicName = Prefix + "itinerary_erase";
 const std::string ItineraryClearTopicName = Prefix + "itinerary_clear";
+const std::string ItineraryBatchTopicName = Prefix + "itinerary_batch";
 const std::string RegisterParticipantSrvName = Prefix + "register_participant";
 const std::string UnregisterParticipantSrvName = Prefix +
   "unregister_participant";
+const std::string BulkRegistrationRequestTopicName = Prefix +
+  "register_participants/request";
+const std::string BulkRegistrationResponseTopicName = Prefix +
+  "register_participants/response";
 const std::string RegisterQueryServiceName = Prefix + "register_query";
 const std::string ParticipantsInfoTopicName = Prefix + "participants";
+const std::string ParticipantsDeltaTopicName = Prefix + "participants_delta";
 const std::string QueryUpdateTopicNameBase = Prefix + "query_update_";
+const std::string CompactQueryUpdateTopicSuffix = "/compact";
+const std::string QuerySyncTopicSuffix = "/sync";
+const std::string QueryRateClassTopicSuffix = "/period_";
+const std::string QueryLevelOfDetailTopicSuffix = "/coarse_period_";
 const std::string RequestChangesServiceName = Prefix + "request_changes";
+const std::string RequestSyncServiceName = Prefix + "request_sync";
 const std::string ScheduleInconsistencyTopicName = Prefix +
   "schedule_inconsistency";
 const std::string NegotiationAckTopicName = Prefix +
@@ -52,12 +63,16 @@ const std::string NegotiationRefusalTopicName = Prefix +
   "negotiation_refusal";
 const std::string NegotiationProposalTopicName = Prefix +
   "negotiation_proposal";
+const std::string NegotiationProposalDiffTopicName = Prefix +
+  "negotiation_proposal_diff";
 const std::string NegotiationRejectionTopicName = Prefix +
   "negotiation_rejection";
 const std::string NegotiationForfeitTopicName = Prefix +
   "negotiation_forfeit";
 const std::string NegotiationConclusionTopicName = Prefix +
   "negotiation_conclusion";
+const std::string NegotiationStatusTopicName = Prefix +
+  "negotiation_status";
 
 const std::string BlockadeCancelTopicName = Prefix +
   "blockade_cancel";
@@ -74,6 +89,14 @@ const std::string BlockadeSetTopicName = Prefix +
 
 const std::string EmergencyTopicName = "fire_alarm_trigger";
 
+// The schedule node, the task dispatcher, and the fleet adapters all publish
+// their MemoryUsage on this topic
+const std::string MemoryUsageTopicName = "rmf_memory_usage";
+
+// The MetricsExporter of each node publishes its Metrics on the standard ROS
+// diagnostics topic
+const std::string MetricsDiagnosticsTopicName = "/diagnostics";
+
 } // namespace rmf_traffic_ros2
 
 #endif // RMF_TRAFFIC_ROS2__STANDARDNAMES_HPP
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef RMF_TRAFFIC_ROS2__THREADSETTINGS_HPP
+#define RMF_TRAFFIC_ROS2__THREADSETTINGS_HPP
+
+#include <rclcpp/node.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+/// How the operating system should schedule the threads of one role, e.g. the
+/// executor threads or the conflict checker of the schedule node. This allows
+/// the traffic-critical threads to keep a deterministic latency on a computer
+/// that is shared with other heavy processes.
+///
+/// The settings of a role are given by three node parameters:
+/// * <role>_cpu_affinity: the CPUs that the threads may run on. An empty list,
+///   which is the default, means any CPU.
+/// * <role>_niceness: the niceness of the threads. Higher values give the
+///   threads a lower priority.
+/// * <role>_realtime_priority: a SCHED_FIFO priority from 1 to 99 for the
+///   threads. The default of 0 keeps the normal time-sharing scheduling.
+///
+/// Lowering the niceness below zero or using a realtime priority normally
+/// requires the CAP_SYS_NICE capability or an rtprio limit for the user.
+struct ThreadSettings
+{
+  /// The CPUs that the threads may run on. An empty list means any CPU.
+  std::vector<int> cpu_affinity = {};
+
+  /// The niceness of the threads
+  int niceness = 0;
+
+  /// The SCHED_FIFO priority of the threads. Zero keeps the normal
+  /// time-sharing scheduling.
+  int realtime_priority = 0;
+
+  /// True if these settings leave the threads as they are
+  bool is_default() const;
+
+  /// Apply these settings to the calling thread. This is a best effort: each
+  /// setting that cannot be applied is skipped and the thread keeps what it
+  /// inherited for it.
+  ///
+  /// \return a description of the settings that could not be applied, or an
+  /// empty string if they all were.
+  std::string apply() const;
+
+  /// Get a function that applies these settings to the thread that calls it
+  /// and logs a warning with the logger of the node if that fails. This is
+  /// meant to be run at the start of each thread of the role. If the
+  /// settings are the default, the function does nothing.
+  std::function<void()> applier(
+    const rclcpp::Node& node,
+    const std::string& role) const;
+
+  /// Declare the parameters of a role and read its settings from them.
+  ///
+  /// \param[in] node
+  ///   The node to declare the parameters on
+  ///
+  /// \param[in] role
+  ///   The prefix of the parameter names
+  ///
+  /// \param[in] defaults
+  ///   The settings to use for any parameter that is not given
+  static ThreadSettings from_parameters(
+    rclcpp::Node& node,
+    const std::string& role,
+    const ThreadSettings& defaults);
+
+  /// Same as the other from_parameters(), with the default settings used for
+  /// any parameter that is not given
+  static ThreadSettings from_parameters(
+    rclcpp::Node& node,
+    const std::string& role);
+};
+
+} // namespace rmf_traffic_ros2
+
+#endif // RMF_TRAFFIC_ROS2__THREADSETTINGS_HPP
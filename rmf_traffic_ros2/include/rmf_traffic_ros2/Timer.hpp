@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef RMF_TRAFFIC_ROS2__TIMER_HPP
+#define RMF_TRAFFIC_ROS2__TIMER_HPP
+
+#include <rmf_traffic_ros2/Time.hpp>
+
+#include <rclcpp/node.hpp>
+#include <rclcpp/timer.hpp>
+
+#include <chrono>
+#include <string>
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+/// The name of the node parameter that makes the timers of a node follow the
+/// clock of the node instead of the wall clock. Together with use_sim_time,
+/// this lets the schedule node and the fleet adapters run as fast as a
+/// simulated /clock is published, so long scenarios can finish faster than
+/// real time. It is false by default.
+const std::string TimersFollowClockParameterName = "timers_follow_clock";
+
+//==============================================================================
+/// Declare the timers_follow_clock parameter for a node that creates its
+/// timers with create_timer(). If the parameter was already declared, its
+/// current value is kept.
+inline void declare_timers_follow_clock(rclcpp::Node& node)
+{
+  if (!node.has_parameter(TimersFollowClockParameterName))
+    node.declare_parameter<bool>(TimersFollowClockParameterName, false);
+}
+
+//==============================================================================
+/// True if the timers of this node should follow the clock of the node. This
+/// is false for nodes that have not declared the parameter.
+inline bool timers_follow_clock(rclcpp::Node& node)
+{
+  bool follow = false;
+  node.get_parameter_or(TimersFollowClockParameterName, follow, false);
+  return follow;
+}
+
+//==============================================================================
+/// The time to compare against the periods of timers made by create_timer().
+/// This is the time of the node clock when timers follow it, and the steady
+/// clock otherwise.
+inline rmf_traffic::Time timer_now(rclcpp::Node& node)
+{
+  if (timers_follow_clock(node))
+    return convert(node.now());
+
+  return std::chrono::steady_clock::now();
+}
+
+//==============================================================================
+/// Create a timer for the node. This is the same as node.create_wall_timer(~)
+/// unless the timers_follow_clock parameter of the node is true, in which case
+/// the timer follows the clock of the node, e.g. a simulated clock.
+template<typename DurationRepT, typename DurationT, typename CallbackT>
+rclcpp::TimerBase::SharedPtr create_timer(
+  rclcpp::Node& node,
+  std::chrono::duration<DurationRepT, DurationT> period,
+  CallbackT callback,
+  rclcpp::CallbackGroup::SharedPtr group = nullptr)
+{
+  if (!timers_follow_clock(node))
+    return node.create_wall_timer(period, std::move(callback), group);
+
+  auto timer = rclcpp::GenericTimer<CallbackT>::make_shared(
+    node.get_clock(),
+    std::chrono::duration_cast<std::chrono::nanoseconds>(period),
+    std::move(callback),
+    node.get_node_base_interface()->get_context());
+
+  node.get_node_timers_interface()->add_timer(timer, group);
+  return timer;
+}
+
+} // namespace rmf_traffic_ros2
+
+#endif // RMF_TRAFFIC_ROS2__TIMER_HPP
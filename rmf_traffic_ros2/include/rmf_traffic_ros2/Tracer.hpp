@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef RMF_TRAFFIC_ROS2__TRACER_HPP
+#define RMF_TRAFFIC_ROS2__TRACER_HPP
+
+#include <rmf_traffic/Time.hpp>
+
+#include <rclcpp/node.hpp>
+
+#include <rmf_utils/impl_ptr.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+/// The name of the node parameter that sets a file that the trace spans of
+/// the process are appended to, as one OTLP/JSON export request per line. An
+/// empty value, which is the default, does not write a file.
+const std::string TraceFileParameterName = "trace_file";
+
+//==============================================================================
+/// The name of the node parameter that sets the OTLP/HTTP endpoint that the
+/// trace spans of the process are sent to, e.g.
+/// http://localhost:4318/v1/traces. An empty value, which is the default,
+/// does not send them anywhere.
+const std::string TraceEndpointParameterName = "trace_endpoint";
+
+//==============================================================================
+/// Collects trace spans and exports them in the OpenTelemetry (OTLP/JSON)
+/// format from a thread of its own.
+///
+/// The components of RMF do not pass trace contexts to each other. Instead,
+/// the trace ID of a span is derived from a correlation ID that every
+/// component already knows, such as the ID of a task or the version of a
+/// conflict. The spans that the dispatcher, the fleet adapters and the
+/// schedule node record for the same task therefore land in the same trace,
+/// where the gaps between them show which hop adds latency.
+class Tracer : public std::enable_shared_from_this<Tracer>
+{
+public:
+
+  using Time = std::chrono::system_clock::time_point;
+  using Attributes = std::map<std::string, std::string>;
+  using ErrorCallback = std::function<void(const std::string& error)>;
+
+  struct SpanData
+  {
+    std::string name;
+    std::string correlation;
+    uint64_t span_id = 0;
+    Time start;
+    Time end;
+    Attributes attributes;
+  };
+
+  /// A span that is recorded when it ends. It ends when end() is called, when
+  /// it is destroyed, or when another span is moved into it. A default
+  /// constructed span is inactive and records nothing.
+  class Span
+  {
+  public:
+    Span() = default;
+    Span(Span&& other) noexcept;
+    Span& operator=(Span&& other) noexcept;
+    ~Span();
+
+    /// True if this span will be recorded when it ends
+    bool active() const;
+
+    /// Set an attribute of the span
+    Span& attribute(const std::string& key, std::string value);
+
+    /// End the span now
+    void end();
+
+  private:
+    friend class Tracer;
+    std::shared_ptr<Tracer> _tracer;
+    SpanData _data;
+  };
+
+  /// Make a tracer.
+  ///
+  /// \param[in] service_name
+  ///   The service.name of the spans of this tracer
+  ///
+  /// \param[in] file
+  ///   The file to append the exported spans to, or empty for none
+  ///
+  /// \param[in] endpoint
+  ///   The OTLP/HTTP endpoint to send the exported spans to, or empty for none
+  ///
+  /// \param[in] on_error
+  ///   Triggered from the export thread when an export starts failing
+  ///
+  /// \throws std::runtime_error if the endpoint is not an http:// URL.
+  static std::shared_ptr<Tracer> make(
+    std::string service_name,
+    std::string file,
+    std::string endpoint,
+    ErrorCallback on_error = nullptr);
+
+  /// Declare the trace_file and trace_endpoint parameters of the node, and
+  /// make a tracer according to them whose service.name is the fully
+  /// qualified name of the node.
+  ///
+  /// \return nullptr if both parameters are empty.
+  static std::shared_ptr<Tracer> from_parameters(rclcpp::Node& node);
+
+  /// Start a span that ends when the returned object does
+  Span start(
+    std::string name,
+    std::string correlation,
+    Attributes attributes = {});
+
+  /// Record a span whose start and end are already known
+  void record(
+    std::string name,
+    std::string correlation,
+    Time start,
+    Time end,
+    Attributes attributes = {});
+
+  /// Export every span that has been recorded so far, and wait until that is
+  /// done
+  void flush();
+
+  /// The number of spans that were dropped because the export could not keep
+  /// up with them
+  uint64_t dropped() const;
+
+  /// The 32 hexadecimal digit trace ID of a correlation ID
+  static std::string trace_id(const std::string& correlation);
+
+  /// Render spans as an OTLP/JSON ExportTraceServiceRequest
+  static std::string to_otlp_json(
+    const std::string& service_name,
+    const std::vector<SpanData>& spans);
+
+  /// Stops the export thread after exporting the remaining spans
+  ~Tracer();
+
+  class Implementation;
+private:
+  Tracer();
+  rmf_utils::unique_impl_ptr<Implementation> _pimpl;
+};
+
+namespace tracing {
+
+//==============================================================================
+/// Set the tracer that the components of this process record their spans
+/// with, or nullptr to stop tracing
+void set_tracer(std::shared_ptr<Tracer> tracer);
+
+//==============================================================================
+/// Get the tracer of this process, if there is one
+std::shared_ptr<Tracer> tracer();
+
+//==============================================================================
+/// Start a span with the tracer of this process. This gives an inactive span
+/// if there is no tracer.
+Tracer::Span span(
+  std::string name,
+  std::string correlation,
+  Tracer::Attributes attributes = {});
+
+//==============================================================================
+/// Record a span that ended just now with the tracer of this process, if
+/// there is one
+void record(
+  std::string name,
+  std::string correlation,
+  rmf_traffic::Duration duration,
+  Tracer::Attributes attributes = {});
+
+//==============================================================================
+/// The correlation ID of everything that happens for a task
+std::string task(const std::string& task_id);
+
+//==============================================================================
+/// The correlation ID of the negotiation of a conflict
+std::string negotiation(uint64_t conflict_version);
+
+//==============================================================================
+/// The correlation ID of one version of the itinerary of a participant
+std::string itinerary(uint64_t participant, uint64_t itinerary_version);
+
+} // namespace tracing
+} // namespace rmf_traffic_ros2
+
+#endif // RMF_TRAFFIC_ROS2__TRACER_HPP
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef RMF_TRAFFIC_ROS2__TRAJECTORYCIRCLES_HPP
+#define RMF_TRAFFIC_ROS2__TRAJECTORYCIRCLES_HPP
+
+#include <rmf_traffic/Profile.hpp>
+#include <rmf_traffic/Trajectory.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+/// A bounding circle for each segment of a trajectory, inflated by the radius
+/// of a profile. Two trajectories can only be in conflict if, at some time
+/// when both are active, the circles of their segments overlap. Most pairs of
+/// routes that get compared are far apart for the whole time that they
+/// overlap, and this rules them out before the much more expensive
+/// rmf_traffic::DetectConflict::between is needed.
+///
+/// The circles are stored as a structure of arrays, so that a segment can be
+/// compared against a whole window of segments of another trajectory in a
+/// loop that the compiler can vectorize.
+class TrajectoryCircles
+{
+public:
+
+  /// Constructor
+  ///
+  /// \param[in] trajectory
+  ///   The trajectory to bound
+  ///
+  /// \param[in] radius
+  ///   How far to inflate the circles. Use radius() to get the value for a
+  ///   profile.
+  TrajectoryCircles(const rmf_traffic::Trajectory& trajectory, double radius);
+
+  /// Same as the other constructor, using the radius of a profile
+  TrajectoryCircles(
+    const rmf_traffic::Trajectory& trajectory,
+    const rmf_traffic::Profile& profile);
+
+  /// The number of segments
+  std::size_t size() const;
+
+  /// True if the trajectories might be in conflict. When this returns false,
+  /// they are certainly not in conflict. Trajectories with fewer than two
+  /// waypoints cannot be bounded, so this always returns true for them.
+  bool might_conflict(const TrajectoryCircles& other) const;
+
+  /// Get the radius that a profile needs to be inflated by to encompass both
+  /// its footprint and its vicinity.
+  static double radius(const rmf_traffic::Profile& profile);
+
+private:
+  bool _bounded = false;
+
+  // The time window of each segment, in nanoseconds since the epoch of the
+  // trajectory clock. The segments are sorted, and each one starts where the
+  // previous one finished.
+  std::vector<int64_t> _start;
+  std::vector<int64_t> _finish;
+
+  std::vector<double> _x;
+  std::vector<double> _y;
+  std::vector<double> _r;
+};
+
+} // namespace rmf_traffic_ros2
+
+#endif // RMF_TRAFFIC_ROS2__TRAJECTORYCIRCLES_HPP
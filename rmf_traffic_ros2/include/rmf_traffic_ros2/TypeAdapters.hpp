@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef RMF_TRAFFIC_ROS2__TYPEADAPTERS_HPP
+#define RMF_TRAFFIC_ROS2__TYPEADAPTERS_HPP
+
+#include <rmf_traffic_ros2/Route.hpp>
+#include <rmf_traffic_ros2/Trajectory.hpp>
+#include <rmf_traffic_ros2/schedule/Patch.hpp>
+
+#include <cassert>
+#include <memory>
+
+// rclcpp::TypeAdapter was introduced in ROS 2 Humble. On older distributions
+// this header only provides the conversion functions, and
+// RMF_TRAFFIC_ROS2__HAS_TYPE_ADAPTERS will not be defined.
+#if __has_include(<rclcpp/type_adapter.hpp>)
+#include <rclcpp/type_adapter.hpp>
+
+#define RMF_TRAFFIC_ROS2__HAS_TYPE_ADAPTERS 1
+
+//==============================================================================
+/// Lets a publisher and subscription in the same process pass an
+/// rmf_traffic::Trajectory along as-is. It is only converted to a
+/// rmf_traffic_msgs::msg::Trajectory when it needs to leave the process.
+template<>
+struct rclcpp::TypeAdapter<
+  rmf_traffic::Trajectory,
+  rmf_traffic_msgs::msg::Trajectory>
+{
+  using is_specialized = std::true_type;
+  using custom_type = rmf_traffic::Trajectory;
+  using ros_message_type = rmf_traffic_msgs::msg::Trajectory;
+
+  static void convert_to_ros_message(
+    const custom_type& source,
+    ros_message_type& destination)
+  {
+    destination = rmf_traffic_ros2::convert(source);
+  }
+
+  static void convert_to_custom(
+    const ros_message_type& source,
+    custom_type& destination)
+  {
+    destination = rmf_traffic_ros2::convert(source);
+  }
+};
+
+//==============================================================================
+/// Routes and patches are adapted through shared pointers, the same way that
+/// rmf_traffic hands them around, since they cannot be default constructed.
+/// Within one process the subscription receives the same instance that was
+/// published.
+template<>
+struct rclcpp::TypeAdapter<
+  std::shared_ptr<const rmf_traffic::Route>,
+  rmf_traffic_msgs::msg::Route>
+{
+  using is_specialized = std::true_type;
+  using custom_type = std::shared_ptr<const rmf_traffic::Route>;
+  using ros_message_type = rmf_traffic_msgs::msg::Route;
+
+  static void convert_to_ros_message(
+    const custom_type& source,
+    ros_message_type& destination)
+  {
+    assert(source);
+    destination = rmf_traffic_ros2::convert(*source);
+  }
+
+  static void convert_to_custom(
+    const ros_message_type& source,
+    custom_type& destination)
+  {
+    destination = std::make_shared<rmf_traffic::Route>(
+      rmf_traffic_ros2::convert(source));
+  }
+};
+
+//==============================================================================
+template<>
+struct rclcpp::TypeAdapter<
+  std::shared_ptr<const rmf_traffic::schedule::Patch>,
+  rmf_traffic_msgs::msg::SchedulePatch>
+{
+  using is_specialized = std::true_type;
+  using custom_type = std::shared_ptr<const rmf_traffic::schedule::Patch>;
+  using ros_message_type = rmf_traffic_msgs::msg::SchedulePatch;
+
+  static void convert_to_ros_message(
+    const custom_type& source,
+    ros_message_type& destination)
+  {
+    assert(source);
+    destination = rmf_traffic_ros2::convert(*source);
+  }
+
+  static void convert_to_custom(
+    const ros_message_type& source,
+    custom_type& destination)
+  {
+    destination = std::make_shared<rmf_traffic::schedule::Patch>(
+      rmf_traffic_ros2::convert(source));
+  }
+};
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+/// Use these as the message type of a publisher or subscription, for example
+/// node.create_publisher<rmf_traffic_ros2::TrajectoryTypeAdapter>(...)
+using TrajectoryTypeAdapter = rclcpp::TypeAdapter<
+  rmf_traffic::Trajectory,
+  rmf_traffic_msgs::msg::Trajectory>;
+
+using RouteTypeAdapter = rclcpp::TypeAdapter<
+  std::shared_ptr<const rmf_traffic::Route>,
+  rmf_traffic_msgs::msg::Route>;
+
+using PatchTypeAdapter = rclcpp::TypeAdapter<
+  std::shared_ptr<const rmf_traffic::schedule::Patch>,
+  rmf_traffic_msgs::msg::SchedulePatch>;
+
+} // namespace rmf_traffic_ros2
+
+#endif // __has_include(<rclcpp/type_adapter.hpp>)
+
+#endif // RMF_TRAFFIC_ROS2__TYPEADAPTERS_HPP
@@ -36,6 +36,11 @@ public:
   /// depend on the life of the rclcpp::Node. It's best to keep all of these as
   /// members of the Node.
   ///
+  /// If the node has a blockade_shards parameter, each entry of the form
+  /// "<namespace>:<map>,<map>,..." sends the reservations that begin on those
+  /// maps to the blockade node running in that namespace. Reservations on any
+  /// other map go to the blockade node in the namespace of this node.
+  ///
   /// \param[in] node
   ///   The node that will manage the subscriptions of this writer.
   static std::shared_ptr<Writer> make(rclcpp::Node& node);
@@ -34,6 +34,11 @@ rmf_traffic::schedule::Change::Add::Item convert(
 rmf_traffic_msgs::msg::ScheduleChangeAdd convert(
   const rmf_traffic::schedule::Change::Add::Item& from);
 
+//==============================================================================
+void convert(
+  const rmf_traffic::schedule::Change::Add::Item& from,
+  rmf_traffic_msgs::msg::ScheduleChangeAdd& into);
+
 //==============================================================================
 rmf_traffic::schedule::Change::Delay convert(
   const rmf_traffic_msgs::msg::ScheduleChangeDelay& from);
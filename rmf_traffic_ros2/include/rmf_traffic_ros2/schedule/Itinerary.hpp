@@ -29,6 +29,13 @@ namespace rmf_traffic_ros2 {
 std::vector<rmf_traffic_msgs::msg::Route> convert(
   const rmf_traffic::schedule::Itinerary& from);
 
+//==============================================================================
+/// Convert an Itinerary into an existing vector of Route messages, reusing
+/// the memory of the routes that are already in it.
+void convert(
+  const rmf_traffic::schedule::Itinerary& from,
+  std::vector<rmf_traffic_msgs::msg::Route>& into);
+
 //==============================================================================
 std::vector<rmf_traffic::schedule::Itinerary> convert(
   const std::vector<rmf_traffic_msgs::msg::Itinerary>& from);
@@ -37,6 +44,11 @@ std::vector<rmf_traffic::schedule::Itinerary> convert(
 std::vector<rmf_traffic_msgs::msg::Itinerary> convert(
   const std::vector<rmf_traffic::schedule::Itinerary>& from);
 
+//==============================================================================
+void convert(
+  const std::vector<rmf_traffic::schedule::Itinerary>& from,
+  std::vector<rmf_traffic_msgs::msg::Itinerary>& into);
+
 } // namespace rmf_traffic_ros2
 
 #endif // RMF_TRAFFIC_ROS2__SCHEDULE__ITINERARY_HPP
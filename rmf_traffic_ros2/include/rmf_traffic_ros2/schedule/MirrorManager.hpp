@@ -20,9 +20,15 @@
 
 #include <rmf_traffic/schedule/Database.hpp>
 #include <rmf_traffic/schedule/Mirror.hpp>
+#include <rmf_traffic/schedule/Patch.hpp>
 
 #include <rclcpp/node.hpp>
 
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+
 namespace rmf_traffic_ros2 {
 namespace schedule {
 
@@ -64,6 +70,114 @@ public:
     /// Toggle the choice to wakeup on an update.
     Options& update_on_wakeup(bool choice);
 
+    /// True if the mirror should receive its updates as compact binary
+    /// payloads instead of full MirrorUpdate messages. This requires the
+    /// schedule node to have its compact_mirror_updates parameter enabled.
+    /// By default this is false.
+    bool compact_updates() const;
+
+    /// Toggle the choice to receive compact updates.
+    Options& compact_updates(bool choice);
+
+    /// True if the mirror should fetch the initial state of its query through
+    /// a dedicated sync transfer instead of a remedial update on the query
+    /// topic. The transfer only reaches the mirrors that are joining, so other
+    /// mirrors of the same query are not slowed down by it. Once the transfer
+    /// is applied, the mirror resumes incremental updates from its version.
+    /// By default this is false.
+    bool snapshot_sync() const;
+
+    /// Toggle the choice to use a sync transfer for the initial state.
+    Options& snapshot_sync(bool choice);
+
+    /// True if patches should be applied to a private copy of the mirror,
+    /// which is then published atomically through snapshot_handle(). Readers
+    /// of snapshot_handle() never wait for a patch to be applied, and the
+    /// update_mutex is not locked while patches are applied. In this mode the
+    /// viewer() and fork() functions may only be used from the thread that
+    /// spins this mirror's node. By default this is false.
+    bool double_buffered() const;
+
+    /// Toggle the choice to double buffer the mirror.
+    Options& double_buffered(bool choice);
+
+    /// True if the updates that are waiting in the subscription queue should
+    /// be taken along with the one that is being handled, so that all of them
+    /// are applied in one pass. The update_mutex is then locked once for the
+    /// whole pass instead of once per update, which lets a mirror that has
+    /// fallen behind catch up without contending with its readers for every
+    /// patch. By default this is false.
+    bool batch_updates() const;
+
+    /// Toggle the choice to apply waiting updates in one pass.
+    Options& batch_updates(bool choice);
+
+    /// The period of the rate class that the mirror should receive its
+    /// updates from. The schedule node coalesces the changes for a rate class
+    /// into at most one update per period, which saves bandwidth for mirrors
+    /// that do not need to be current, such as dashboards. The period must
+    /// match one of the schedule node's mirror_update_rate_classes, otherwise
+    /// no updates will arrive. This is ignored when compact_updates() is on.
+    /// By default this is std::nullopt, which receives every update.
+    std::optional<std::chrono::milliseconds> update_period() const;
+
+    /// Set the period of the rate class to receive updates from.
+    Options& update_period(std::optional<std::chrono::milliseconds> period);
+
+    /// True if the mirror should receive its updates from a coarse rate class,
+    /// whose trajectories are decimated by the schedule node. This suits
+    /// visualization and monitoring, but the routes in the mirror will not
+    /// be exact, so it must not be used for planning. The update_period()
+    /// must match one of the schedule node's mirror_update_lod_rate_classes.
+    /// This is ignored when there is no update_period(). By default this is
+    /// false.
+    bool level_of_detail() const;
+
+    /// Toggle the choice to receive coarse updates.
+    Options& level_of_detail(bool choice);
+
+    /// True if the mirror should follow the participants through numbered
+    /// deltas. If a delta is missed, the mirror keeps its participants until
+    /// the next periodic resync. When this is false, the mirror follows the
+    /// full set of participants instead, which the schedule node only
+    /// publishes at each resync, so the mirror may take up to a resync period
+    /// to learn about a new participant. By default this is true.
+    bool participant_deltas() const;
+
+    /// Toggle the choice to follow the participants through deltas.
+    Options& participant_deltas(bool choice);
+
+    /// The namespace of the schedule shard that the mirror should follow,
+    /// relative to the namespace of the node. When the schedule is sharded by
+    /// map, each shard only knows about the itineraries on its own maps, so a
+    /// view of the whole site needs one mirror for each shard. The shard must
+    /// be chosen before the mirror is made. By default this is empty, which
+    /// follows the schedule node that registers participants.
+    const std::string& shard() const;
+
+    /// Set the namespace of the schedule shard to follow.
+    Options& shard(std::string name);
+
+    /// A callback for each patch that has been applied to the mirror
+    using PatchCallback =
+      std::function<void(const rmf_traffic::schedule::Patch& patch)>;
+
+    /// The callback that is triggered each time a patch has been applied to
+    /// the mirror, so that it can be passed on to other mirrors. It is called
+    /// on the thread that spins the node. By default this is nullptr.
+    const PatchCallback& on_patch() const;
+
+    /// Set the callback for applied patches.
+    Options& on_patch(PatchCallback callback);
+
+    /// The callback that is triggered each time the descriptions of the
+    /// participants in the mirror have been updated. It is called on the
+    /// thread that spins the node. By default this is nullptr.
+    const std::function<void()>& on_participants() const;
+
+    /// Set the callback for updated participant descriptions.
+    Options& on_participants(std::function<void()> callback);
+
     class Implementation;
   private:
     rmf_utils::impl_ptr<Implementation> _pimpl;
@@ -72,7 +186,9 @@ public:
   /// Get the viewer of the mirror that is being managed
   const rmf_traffic::schedule::Viewer& viewer() const;
 
-  /// Get a stub that can take snapshots of the schedule
+  /// Get a stub that can take snapshots of the schedule. When the mirror is
+  /// double buffered, the stub hands out the most recently published snapshot
+  /// and can be used from any thread without locking.
   std::shared_ptr<rmf_traffic::schedule::Snappable> snapshot_handle() const;
 
   /// Attempt to update this mirror immediately.
@@ -24,8 +24,13 @@
 #include <rmf_traffic/schedule/Participant.hpp>
 #include <rmf_traffic/schedule/Snapshot.hpp>
 
+#include <rmf_traffic_ros2/MemoryUsage.hpp>
+
 #include <rmf_utils/impl_ptr.hpp>
 
+#include <atomic>
+#include <optional>
+
 namespace rmf_traffic_ros2 {
 namespace schedule {
 
@@ -111,6 +116,37 @@ public:
   ///   The number of negotiations to retain
   void set_retained_history_count(uint count);
 
+  /// Set the longest time that a concluded negotiation will be retained for.
+  /// The retained history is pruned whenever a negotiation concludes, but an
+  /// expired negotiation will never be returned by table_view().
+  ///
+  /// \param[in] max_age
+  ///   The maximum age, or std::nullopt to retain negotiations for any amount
+  ///   of time. This is the default.
+  void set_retained_history_max_age(
+    std::optional<rmf_traffic::Duration> max_age);
+
+  /// Set a budget for the estimated memory that the retained negotiations may
+  /// hold. The oldest negotiations will be discarded to stay within it.
+  ///
+  /// \param[in] bytes
+  ///   The budget in bytes, or std::nullopt for no budget. This is the
+  ///   default.
+  void set_retained_history_byte_budget(std::optional<std::size_t> bytes);
+
+  /// Get the number of concluded negotiations that are being retained.
+  std::size_t retained_history_size() const;
+
+  /// Get an estimate of the memory, in bytes, that is held by the concluded
+  /// negotiations that are being retained.
+  std::size_t retained_history_bytes() const;
+
+  /// Add the estimated memory of the open negotiations, the retained history,
+  /// and the message buffers of this Negotiation manager to an account. This
+  /// must be called from a callback of the node that was given to the
+  /// constructor.
+  void account_memory(MemoryUsage& usage) const;
+
   /// Register a negotiator with this Negotiation manager.
   ///
   /// \param[in] for_participant
@@ -163,6 +199,19 @@ public:
     std::function<void(TableViewPtr view, ResponderPtr responder)> respond,
     std::function<void()> on_negotiation_failure = nullptr);
 
+  /// A token that becomes true as soon as a response is no longer wanted.
+  using CancellationToken = std::shared_ptr<const std::atomic_bool>;
+
+  /// Get the cancellation token of a responder that was handed out by a
+  /// Negotiation. The token becomes true when the negotiation concludes, or
+  /// when the table being responded to is forfeited, becomes defunct, or is
+  /// superseded by a newer proposal. Negotiators can use it to stop planning
+  /// for decisions that have already been made.
+  ///
+  /// \return nullptr if the responder did not come from a Negotiation.
+  static CancellationToken cancellation_token(
+    const rmf_traffic::schedule::Negotiator::Responder& responder);
+
   class Implementation;
 private:
   rmf_utils::unique_impl_ptr<Implementation> _pimpl;
@@ -27,6 +27,14 @@ namespace schedule {
 std::shared_ptr<rclcpp::Node> make_node(
   const rclcpp::NodeOptions& options = rclcpp::NodeOptions());
 
+/// Spin a ScheduleNode instance until ROS is shut down. The node's callback
+/// groups will be run on a multi-threaded executor with the number of threads
+/// given by its executor_threads parameter. If the callback_report_period
+/// parameter of the node is positive, the duration of each callback is
+/// recorded and the slowest ones are reported periodically. The threads of the
+/// executor follow the ThreadSettings of the executor role.
+void spin_node(const std::shared_ptr<rclcpp::Node>& node);
+
 } // namespace schedule
 } // namespace rmf_traffic_ros2
 
@@ -22,6 +22,11 @@
 #include <rmf_traffic_ros2/Profile.hpp>
 #include <rmf_traffic_ros2/geometry/ConvexShape.hpp>
 #include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic_msgs/msg/participant_description.hpp>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <optional>
 #include <string>
 #include <yaml-cpp/yaml.h>
 #include <unordered_map>
@@ -59,6 +64,11 @@ public:
   /// \returns a std::nullopt when we have exhausted all records.
   virtual std::optional<AtomicOperation> read_next_record() = 0;
 
+  /// Called when every operation that has been written so far needs to be
+  /// durable. Loggers that are durable as soon as write_operation() returns
+  /// do not need to override this.
+  virtual void sync() {}
+
   virtual ~AbstractParticipantLogger() = default;
 };
 
@@ -91,6 +101,56 @@ private:
   rmf_utils::unique_impl_ptr<Implementation> _pimpl;
 };
 
+//=============================================================================
+/// Binary journal logger. Each operation is appended to the file as a single
+/// length-prefixed record, so the cost of logging does not grow with the
+/// number of participants that are already registered. Records that have been
+/// superseded by later updates are dropped by periodically compacting the
+/// journal.
+class BinaryLogger : public AbstractParticipantLogger
+{
+public:
+  /// Constructor
+  /// Loads and logs to the specified file.
+  ///
+  /// \param[in] file_path
+  ///   The journal to load and append to. It will be created if it does not
+  ///   exist yet.
+  ///
+  /// \param[in] sync_period
+  ///   Appended records will be flushed to disk at least this often. Records
+  ///   that arrive within the same period share a single fsync. A zero period
+  ///   will flush every record as soon as it is written.
+  ///
+  /// \param[in] compaction_threshold
+  ///   The journal will be rewritten once it contains this many superseded
+  ///   records.
+  ///
+  /// \throws std::runtime_error if the file cannot be opened, or if it is
+  /// corrupt anywhere other than its final record. A final record that was
+  /// only partially written will be discarded.
+  ///
+  /// \throws std::filesystem_error if there is no permission to create the
+  /// directory.
+  BinaryLogger(
+    std::string file_path,
+    std::chrono::nanoseconds sync_period = std::chrono::milliseconds(100),
+    std::size_t compaction_threshold = 1000);
+
+  /// See AbstractParticipantLogger
+  void write_operation(AtomicOperation operation) override;
+
+  /// See AbstractParticipantLogger
+  std::optional<AtomicOperation> read_next_record() override;
+
+  /// Flush every record that has been written so far to disk.
+  void sync() override;
+
+  class Implementation;
+private:
+  rmf_utils::unique_impl_ptr<Implementation> _pimpl;
+};
+
 //=============================================================================
 /// Adds a persistance layer to the participant ids. This allows the scheduler
 /// to restart without the need to restart fleet adapters.
@@ -111,6 +171,42 @@ public:
     std::unique_ptr<AbstractParticipantLogger> logger,
     std::shared_ptr<Database> database);
 
+  /// Options for writing to the logger from a dedicated thread, so that
+  /// registering a participant never has to wait for the disk.
+  struct AsyncLogging
+  {
+    /// The maximum number of operations that may be waiting to be written.
+    /// When the queue is full, registration will block until the writer
+    /// thread has caught up.
+    std::size_t max_queue_size = 1024;
+
+    /// Triggered from the writer thread once an operation has been written
+    /// and synced by the logger. If that failed, the exception will be
+    /// passed along; otherwise it will be a nullptr.
+    std::function<void(const AtomicOperation&, std::exception_ptr)>
+    on_durable;
+  };
+
+  /// Constructor for asynchronous logging. The in-memory registry is updated
+  /// immediately, while the logger catches up in the background.
+  ///
+  /// \param[in] logger
+  ///   The logging implementation to use for recording registration.
+  ///
+  /// \param[in] database
+  ///   The database that will register the participants.
+  ///
+  /// \param[in] async
+  ///   Options for the asynchronous logging.
+  ParticipantRegistry(
+    std::unique_ptr<AbstractParticipantLogger> logger,
+    std::shared_ptr<Database> database,
+    AsyncLogging async);
+
+  /// Block until every operation that has been queued so far is durable. This
+  /// returns immediately when logging is synchronous.
+  void flush();
+
   using Registration = rmf_traffic::schedule::Writer::Registration;
 
   /// Adds a participant or retrieves its ID if it was already added in the past
@@ -121,6 +217,32 @@ public:
   /// \returns ParticipantId of the participant
   Registration add_or_retrieve_participant(ParticipantDescription description);
 
+  /// Retrieve the registration of a participant that was already added with
+  /// exactly this description. This never modifies the database or writes to
+  /// the logger, so a repeated registration can be answered without anything
+  /// needing to be announced.
+  ///
+  /// \param[in] description
+  ///   The description of the participant that one wishes to register.
+  ///
+  /// \returns the registration of the participant, or std::nullopt if the
+  /// participant is new or its description has changed.
+  std::optional<Registration> retrieve_unchanged_participant(
+    const ParticipantDescription& description);
+
+  /// Get the message form of the description of a participant. Each
+  /// description is converted into a message once and then kept until it is
+  /// updated, so broadcasting the participants does not need to convert their
+  /// profiles every time.
+  ///
+  /// \param[in] id
+  ///   The ID of the participant
+  ///
+  /// \returns the description message, or std::nullopt if the participant
+  /// was not added through this registry.
+  std::optional<rmf_traffic_msgs::msg::ParticipantDescription>
+  description_msg(ParticipantId id);
+
   class Implementation;
 private:
   rmf_utils::unique_impl_ptr<Implementation> _pimpl;
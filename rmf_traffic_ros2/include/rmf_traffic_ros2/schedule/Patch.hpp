@@ -28,6 +28,15 @@ namespace rmf_traffic_ros2 {
 rmf_traffic_msgs::msg::SchedulePatch convert(
   const rmf_traffic::schedule::Patch& from);
 
+//==============================================================================
+/// Convert a Patch into an existing SchedulePatch message. The participants,
+/// routes and waypoints that are already in the message are overwritten in
+/// place, so a message that is reused for every patch will rarely need to
+/// allocate.
+void convert(
+  const rmf_traffic::schedule::Patch& from,
+  rmf_traffic_msgs::msg::SchedulePatch& into);
+
 //==============================================================================
 rmf_traffic::schedule::Patch convert(
   const rmf_traffic_msgs::msg::SchedulePatch& from);
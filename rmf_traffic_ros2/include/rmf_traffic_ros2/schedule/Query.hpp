@@ -20,8 +20,11 @@
 
 #include <rmf_traffic_msgs/msg/schedule_query.hpp>
 
+#include <rmf_traffic/agv/Graph.hpp>
 #include <rmf_traffic/schedule/Query.hpp>
 
+#include <optional>
+
 namespace rmf_traffic_ros2 {
 
 //==============================================================================
@@ -48,6 +51,34 @@ rmf_traffic::schedule::Query convert(
 rmf_traffic_msgs::msg::ScheduleQuery convert(
   const rmf_traffic::schedule::Query& from);
 
+namespace schedule {
+
+//==============================================================================
+/// Make a query that only matches traffic inside the bounding box of the
+/// waypoints of a navigation graph, with one region for each map that the
+/// graph uses. A fleet adapter can register this instead of query_all() so
+/// that its mirror only holds traffic that it could possibly conflict with.
+///
+/// \param[in] graph
+///   The navigation graph whose waypoints should be covered
+///
+/// \param[in] padding
+///   How far, in meters, to grow the bounding box on every side. This should
+///   be at least the footprint radius of the largest vehicle in the area.
+///
+/// \param[in] lower_time_bound
+///   If given, traffic that ends before this time will not be matched
+///
+/// \param[in] upper_time_bound
+///   If given, traffic that begins after this time will not be matched
+rmf_traffic::schedule::Query make_region_query(
+  const rmf_traffic::agv::Graph& graph,
+  double padding,
+  std::optional<rmf_traffic::Time> lower_time_bound = std::nullopt,
+  std::optional<rmf_traffic::Time> upper_time_bound = std::nullopt);
+
+} // namespace schedule
+
 } // namespace rmf_traffic_ros2
 
 #endif // RMF_TRAFFIC_ROS2__SCHEDULE__QUERY_HPP
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef RMF_TRAFFIC_ROS2__SCHEDULE__SHAREDMIRROR_HPP
+#define RMF_TRAFFIC_ROS2__SCHEDULE__SHAREDMIRROR_HPP
+
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Snapshot.hpp>
+
+#include <rmf_utils/impl_ptr.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Publishes the contents of a schedule database into a shared memory segment
+/// so that processes on the same host can read them through a SharedMirror
+/// instead of each keeping a MirrorManager of their own. The segment is a file
+/// in /dev/shm that holds the most recent snapshot along with a stamp that
+/// changes each time a new snapshot is published.
+///
+/// Only one publisher should use a segment at a time.
+class SharedMirrorPublisher
+{
+public:
+
+  /// Constructor
+  ///
+  /// \param[in] segment_name
+  ///   The name of the segment file inside of /dev/shm.
+  ///
+  /// \param[in] capacity
+  ///   The largest encoded snapshot, in bytes, that the segment can hold. The
+  ///   pages of the segment are only allocated as they get used. If the
+  ///   segment already exists with a larger capacity, that capacity is kept.
+  ///
+  /// \throws std::runtime_error if the segment cannot be created.
+  SharedMirrorPublisher(const std::string& segment_name, std::size_t capacity);
+
+  /// Publish the current contents of a database. Readers will see the change
+  /// the next time they ask for a snapshot.
+  ///
+  /// \return false if the encoded snapshot does not fit in the segment, in
+  /// which case the previous snapshot stays in place.
+  bool publish(const rmf_traffic::schedule::Database& database);
+
+  /// Quantize the trajectories of the snapshots that get published to this
+  /// resolution, in meters for positions and radians for orientations, and
+  /// delta code them. This shrinks the segment, and the memory that readers
+  /// have to go through to decode it, by several times. Pass std::nullopt,
+  /// which is the default, to publish trajectories at full precision.
+  SharedMirrorPublisher& compact_resolution(std::optional<double> resolution);
+
+  /// The stamp of the last snapshot that was published. This starts at 0 for
+  /// a segment that has never had a snapshot.
+  uint64_t stamp() const;
+
+  class Implementation;
+private:
+  rmf_utils::unique_impl_ptr<Implementation> _pimpl;
+};
+
+//==============================================================================
+/// A read-only view of a segment written by a SharedMirrorPublisher. Each new
+/// stamp is decoded once, the first time a snapshot is asked for. After that
+/// the same snapshot is handed out until the publisher stamps another one, so
+/// checking for changes only costs one atomic load.
+///
+/// This can be used from any thread.
+class SharedMirror : public rmf_traffic::schedule::Snappable
+{
+public:
+
+  /// Map a segment that was created by a SharedMirrorPublisher.
+  ///
+  /// \return nullptr if the segment does not exist or was not made by a
+  /// SharedMirrorPublisher.
+  static std::shared_ptr<SharedMirror> make(const std::string& segment_name);
+
+  /// The stamp of the newest snapshot in the segment.
+  uint64_t stamp() const;
+
+  // Documentation inherited
+  std::shared_ptr<const rmf_traffic::schedule::Snapshot> snapshot()
+  const final;
+
+  class Implementation;
+private:
+  SharedMirror();
+  rmf_utils::unique_impl_ptr<Implementation> _pimpl;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // RMF_TRAFFIC_ROS2__SCHEDULE__SHAREDMIRROR_HPP
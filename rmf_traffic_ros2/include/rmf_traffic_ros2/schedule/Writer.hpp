@@ -81,6 +81,23 @@ public:
     rmf_traffic::schedule::ParticipantDescription description,
     std::function<void(rmf_traffic::schedule::Participant)> ready_callback);
 
+  /// Asynchronously create many schedule participants at once, such as all
+  /// the robots of a fleet that is starting up. The participants are
+  /// registered with one request to the schedule node instead of one request
+  /// each. If the schedule node does not support bulk registration, the
+  /// participants will be registered one at a time instead.
+  ///
+  /// \param[in] descriptions
+  ///   The descriptions of the participants.
+  ///
+  /// \param[in] ready_callback
+  ///   The callback that will be triggered when all the participants are
+  ///   ready. They will be in the same order as the descriptions.
+  void async_make_participants(
+    std::vector<rmf_traffic::schedule::ParticipantDescription> descriptions,
+    std::function<void(std::vector<rmf_traffic::schedule::Participant>)>
+    ready_callback);
+
   class Implementation;
 private:
   Writer(rclcpp::Node& node);
@@ -99,6 +116,13 @@ rmf_traffic::schedule::Writer::Input convert(
 std::vector<rmf_traffic_msgs::msg::ScheduleWriterItem> convert(
   const rmf_traffic::schedule::Writer::Input& from);
 
+//==============================================================================
+/// Convert writer input into an existing vector of messages, reusing the
+/// memory of the items that are already in it.
+void convert(
+  const rmf_traffic::schedule::Writer::Input& from,
+  std::vector<rmf_traffic_msgs::msg::ScheduleWriterItem>& into);
+
 } // namespace rmf_traffic_ros2
 
 #endif // RMF_TRAFFIC_ROS2__SCHEDULE__WRITER_HPP
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/blockade/Node.hpp>
+
+#include <rclcpp_components/register_node_macro.hpp>
+
+namespace rmf_traffic_ros2 {
+namespace blockade {
+
+//==============================================================================
+/// Loads a blockade moderator node into a component container.
+class BlockadeComponent
+{
+public:
+
+  explicit BlockadeComponent(const rclcpp::NodeOptions& options)
+  : _node(make_node(options))
+  {
+    // Do nothing
+  }
+
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
+  get_node_base_interface() const
+  {
+    return _node->get_node_base_interface();
+  }
+
+private:
+  std::shared_ptr<rclcpp::Node> _node;
+};
+
+} // namespace blockade
+} // namespace rmf_traffic_ros2
+
+RCLCPP_COMPONENTS_REGISTER_NODE(rmf_traffic_ros2::blockade::BlockadeComponent)
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/schedule/Node.hpp>
+
+#include <rclcpp_components/register_node_macro.hpp>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Loads a ScheduleNode into a component container. The container's executor
+/// runs the node, so the executor_threads and thread settings that spin_node
+/// would apply are left to the container. The schedule needs a multi-threaded
+/// container for its ingest and query callback groups to run in parallel.
+class ScheduleComponent
+{
+public:
+
+  explicit ScheduleComponent(const rclcpp::NodeOptions& options)
+  : _node(make_node(options))
+  {
+    // Do nothing
+  }
+
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
+  get_node_base_interface() const
+  {
+    return _node->get_node_base_interface();
+  }
+
+private:
+  std::shared_ptr<rclcpp::Node> _node;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+RCLCPP_COMPONENTS_REGISTER_NODE(rmf_traffic_ros2::schedule::ScheduleComponent)
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/CallbackWatchdog.hpp>
+#include <rmf_traffic_ros2/Timer.hpp>
+
+#include <rmf_traffic/Time.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace rmf_traffic_ros2 {
+
+namespace {
+//==============================================================================
+double seconds(const CallbackWatchdog::Duration duration)
+{
+  return std::chrono::duration_cast<std::chrono::duration<double>>(
+    duration).count();
+}
+} // anonymous namespace
+
+//==============================================================================
+class CallbackWatchdog::Implementation
+{
+public:
+
+  struct Stats
+  {
+    uint64_t count = 0;
+    uint64_t slow = 0;
+    Duration total = Duration(0);
+    Duration max = Duration(0);
+  };
+
+  Duration slow_threshold;
+  std::shared_ptr<Metrics::Histogram> callback_seconds;
+  std::shared_ptr<Metrics::Counter> slow_callbacks;
+
+  std::mutex mutex;
+  std::unordered_map<std::string, Stats> stats;
+  std::unique_ptr<Metrics::Histogram> histogram =
+    std::make_unique<Metrics::Histogram>(histogram_bounds());
+  std::chrono::steady_clock::time_point since =
+    std::chrono::steady_clock::now();
+  uint64_t count = 0;
+  uint64_t slow = 0;
+
+  rclcpp::TimerBase::SharedPtr timer;
+};
+
+//==============================================================================
+CallbackWatchdog::CallbackWatchdog(
+  const Duration slow_threshold,
+  std::shared_ptr<Metrics> metrics)
+: _pimpl(rmf_utils::make_unique_impl<Implementation>())
+{
+  _pimpl->slow_threshold = slow_threshold;
+  if (metrics)
+  {
+    _pimpl->callback_seconds = metrics->histogram(
+      "rmf_callback_seconds",
+      "How long executor callbacks and planning jobs ran for",
+      {}, histogram_bounds());
+
+    _pimpl->slow_callbacks = metrics->counter(
+      "rmf_slow_callbacks",
+      "Executor callbacks and planning jobs that ran longer than the "
+      "slow_callback_threshold");
+  }
+}
+
+//==============================================================================
+void CallbackWatchdog::record(const std::string& source, Duration duration)
+{
+  const bool slow = duration > _pimpl->slow_threshold;
+  const double s = seconds(duration);
+  if (_pimpl->callback_seconds)
+    _pimpl->callback_seconds->observe(s);
+
+  if (slow && _pimpl->slow_callbacks)
+    _pimpl->slow_callbacks->increment();
+
+  std::lock_guard<std::mutex> lock(_pimpl->mutex);
+  auto& stats = _pimpl->stats[source];
+  ++stats.count;
+  stats.total += duration;
+  stats.max = std::max(stats.max, duration);
+  ++_pimpl->count;
+  if (slow)
+  {
+    ++stats.slow;
+    ++_pimpl->slow;
+  }
+
+  _pimpl->histogram->observe(s);
+}
+
+//==============================================================================
+std::string CallbackWatchdog::describe(const rclcpp::AnyExecutable& executable)
+{
+  std::ostringstream source;
+  if (executable.subscription)
+    source << "subscription " << executable.subscription->get_topic_name();
+  else if (executable.timer)
+    source << "timer " << executable.timer.get();
+  else if (executable.service)
+    source << "service " << executable.service->get_service_name();
+  else if (executable.client)
+    source << "client " << executable.client->get_service_name();
+  else if (executable.waitable)
+    source << "waitable";
+  else
+    source << "unknown";
+
+  if (executable.node_base)
+    source << " [" << executable.node_base->get_fully_qualified_name() << "]";
+
+  return source.str();
+}
+
+//==============================================================================
+std::vector<double> CallbackWatchdog::histogram_bounds()
+{
+  return {0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0, 10.0};
+}
+
+//==============================================================================
+auto CallbackWatchdog::take_report(const std::size_t worst) -> Report
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  Report report;
+  std::unordered_map<std::string, Implementation::Stats> stats;
+  std::unique_ptr<Metrics::Histogram> histogram =
+    std::make_unique<Metrics::Histogram>(histogram_bounds());
+  {
+    std::lock_guard<std::mutex> lock(_pimpl->mutex);
+    std::swap(stats, _pimpl->stats);
+    std::swap(histogram, _pimpl->histogram);
+    report.period = now - _pimpl->since;
+    report.count = _pimpl->count;
+    report.slow = _pimpl->slow;
+    _pimpl->since = now;
+    _pimpl->count = 0;
+    _pimpl->slow = 0;
+  }
+
+  report.slow_threshold = _pimpl->slow_threshold;
+  report.histogram = histogram->snapshot();
+
+  report.worst.reserve(stats.size());
+  for (auto& [source, s] : stats)
+    report.worst.push_back({source, s.count, s.slow, s.total, s.max});
+
+  const auto longer = [](const Offender& a, const Offender& b)
+    {
+      if (a.max != b.max)
+        return a.max > b.max;
+
+      return a.source < b.source;
+    };
+
+  if (report.worst.size() > worst)
+  {
+    std::partial_sort(
+      report.worst.begin(), report.worst.begin() + worst, report.worst.end(),
+      longer);
+    report.worst.resize(worst);
+  }
+  else
+  {
+    std::sort(report.worst.begin(), report.worst.end(), longer);
+  }
+
+  return report;
+}
+
+//==============================================================================
+std::string CallbackWatchdog::format(const Report& report)
+{
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(4);
+  out << "Callback timing over the last [" << seconds(report.period)
+      << "] seconds: [" << report.count << "] callbacks, [" << report.slow
+      << "] slower than [" << seconds(report.slow_threshold) << "] seconds";
+
+  for (const auto& offender : report.worst)
+  {
+    const double mean = offender.count > 0 ?
+      seconds(offender.total) / static_cast<double>(offender.count) : 0.0;
+
+    out << "\n  max " << seconds(offender.max) << "s, mean " << mean
+        << "s, runs " << offender.count << ", slow " << offender.slow
+        << ": " << offender.source;
+  }
+
+  const auto& histogram = report.histogram;
+  out << "\n  histogram:";
+  for (std::size_t i = 0; i < histogram.counts.size(); ++i)
+  {
+    if (i < histogram.bounds.size())
+      out << " <=" << histogram.bounds[i];
+    else if (!histogram.bounds.empty())
+      out << " >" << histogram.bounds.back();
+
+    out << "s: " << histogram.counts[i];
+    if (i + 1 < histogram.counts.size())
+      out << ",";
+  }
+
+  return out.str();
+}
+
+//==============================================================================
+void CallbackWatchdog::start_reporting(rclcpp::Node& node, Duration period)
+{
+  // Start the first report now, so that it does not cover the time before
+  // reporting was started
+  take_report(0);
+
+  _pimpl->timer = rmf_traffic_ros2::create_timer(
+    node, period, [this, logger = node.get_logger()]()
+    {
+      const auto report = take_report();
+      if (report.count == 0)
+        return;
+
+      const auto text = format(report);
+      if (report.slow > 0)
+        RCLCPP_WARN(logger, "%s", text.c_str());
+      else
+        RCLCPP_INFO(logger, "%s", text.c_str());
+    });
+}
+
+//==============================================================================
+std::shared_ptr<CallbackWatchdog> CallbackWatchdog::from_parameters(
+  rclcpp::Node& node,
+  std::shared_ptr<Metrics> metrics)
+{
+  const double period = node.declare_parameter<double>(
+    CallbackReportPeriodParameterName, 0.0);
+  const double threshold = node.declare_parameter<double>(
+    SlowCallbackThresholdParameterName, 0.1);
+
+  if (period <= 0.0)
+    return nullptr;
+
+  if (threshold <= 0.0)
+  {
+    throw std::runtime_error(
+      "[CallbackWatchdog::from_parameters] Invalid "
+      + SlowCallbackThresholdParameterName + " [" + std::to_string(threshold)
+      + "]");
+  }
+
+  auto watchdog = std::make_shared<CallbackWatchdog>(
+    rmf_traffic::time::from_seconds(threshold), std::move(metrics));
+  watchdog->start_reporting(node, rmf_traffic::time::from_seconds(period));
+
+  RCLCPP_INFO(
+    node.get_logger(),
+    "Timing executor callbacks and reporting every [%f] seconds", period);
+
+  return watchdog;
+}
+
+} // namespace rmf_traffic_ros2
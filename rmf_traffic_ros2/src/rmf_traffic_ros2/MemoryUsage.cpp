@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/MemoryUsage.hpp>
+
+#include <yaml-cpp/yaml.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace rmf_traffic_ros2 {
+
+namespace {
+//==============================================================================
+// Read a field like "VmRSS:    1234 kB" from /proc/self/status
+std::size_t read_status_bytes(const std::string& field)
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (line.rfind(field + ":", 0) != 0)
+      continue;
+
+    std::istringstream values(line.substr(field.size() + 1));
+    std::size_t kilobytes = 0;
+    values >> kilobytes;
+    return kilobytes * 1024;
+  }
+
+  return 0;
+}
+} // anonymous namespace
+
+//==============================================================================
+MemoryUsage& MemoryUsage::add(
+  std::string name,
+  const std::size_t count,
+  const std::size_t bytes)
+{
+  entries.push_back({std::move(name), count, bytes});
+  return *this;
+}
+
+//==============================================================================
+std::size_t MemoryUsage::accounted_bytes() const
+{
+  std::size_t total = 0;
+  for (const auto& entry : entries)
+    total += entry.bytes;
+
+  return total;
+}
+
+//==============================================================================
+std::string serialize(const MemoryUsage& usage, const std::string& node)
+{
+  YAML::Node containers(YAML::NodeType::Sequence);
+  for (const auto& entry : usage.entries)
+  {
+    YAML::Node container;
+    container["name"] = entry.name;
+    container["count"] = entry.count;
+    container["bytes"] = entry.bytes;
+    containers.push_back(container);
+  }
+
+  YAML::Node root;
+  root["node"] = node;
+  root["resident_bytes"] = resident_memory_bytes();
+  root["peak_resident_bytes"] = peak_resident_memory_bytes();
+  root["accounted_bytes"] = usage.accounted_bytes();
+  root["containers"] = containers;
+
+  YAML::Emitter emitter;
+  emitter << root;
+  return emitter.c_str();
+}
+
+//==============================================================================
+std::size_t resident_memory_bytes()
+{
+  return read_status_bytes("VmRSS");
+}
+
+//==============================================================================
+std::size_t peak_resident_memory_bytes()
+{
+  return read_status_bytes("VmHWM");
+}
+
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/Metrics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace rmf_traffic_ros2 {
+
+namespace {
+//==============================================================================
+std::string format_value(const double value)
+{
+  if (std::isinf(value))
+    return value > 0.0 ? "+Inf" : "-Inf";
+
+  if (std::isnan(value))
+    return "NaN";
+
+  std::ostringstream out;
+  if (value == std::floor(value) && std::abs(value) < 1e15)
+    out << std::fixed << std::setprecision(0) << value;
+  else
+    out << std::setprecision(15) << value;
+
+  return out.str();
+}
+
+//==============================================================================
+std::string escape(const std::string& text, const bool quotes)
+{
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (const char c : text)
+  {
+    if (c == '\\')
+      escaped += "\\\\";
+    else if (c == '\n')
+      escaped += "\\n";
+    else if (c == '"' && quotes)
+      escaped += "\\\"";
+    else
+      escaped += c;
+  }
+
+  return escaped;
+}
+} // anonymous namespace
+
+//==============================================================================
+void Metrics::Counter::increment(const uint64_t amount)
+{
+  _value.fetch_add(amount, std::memory_order_relaxed);
+}
+
+//==============================================================================
+uint64_t Metrics::Counter::value() const
+{
+  return _value.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+void Metrics::Gauge::set(const double value)
+{
+  _value.store(value, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void Metrics::Gauge::add(const double amount)
+{
+  double current = _value.load(std::memory_order_relaxed);
+  while (!_value.compare_exchange_weak(
+      current, current + amount, std::memory_order_relaxed))
+  {
+    // current has been refreshed, so try again
+  }
+}
+
+//==============================================================================
+double Metrics::Gauge::value() const
+{
+  return _value.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+std::vector<double> Metrics::Histogram::default_bounds()
+{
+  return {
+    0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5,
+    1.0, 2.5, 5.0, 10.0, 30.0, 60.0, 120.0, 300.0
+  };
+}
+
+//==============================================================================
+Metrics::Histogram::Histogram(std::vector<double> bounds)
+: _bounds(std::move(bounds)),
+  _counts(_bounds.size() + 1, 0)
+{
+  if (!std::is_sorted(_bounds.begin(), _bounds.end()))
+  {
+    throw std::runtime_error(
+      "[Metrics::Histogram] The bucket bounds must be in increasing order");
+  }
+}
+
+//==============================================================================
+void Metrics::Histogram::observe(const double value)
+{
+  const auto bucket = static_cast<std::size_t>(
+    std::lower_bound(_bounds.begin(), _bounds.end(), value) - _bounds.begin());
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  ++_counts[bucket];
+  ++_count;
+  _sum += value;
+}
+
+//==============================================================================
+void Metrics::Histogram::observe(const rmf_traffic::Duration duration)
+{
+  observe(rmf_traffic::time::to_seconds(duration));
+}
+
+//==============================================================================
+auto Metrics::Histogram::snapshot() const -> Snapshot
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return Snapshot{_bounds, _counts, _count, _sum};
+}
+
+//==============================================================================
+auto Metrics::family(
+  const std::string& caller,
+  const std::string& name,
+  const std::string& help,
+  const Type type) -> Family&
+{
+  const auto insertion =
+    _families.insert({name, Family{type, help, {}, {}, {}}});
+  if (insertion.first->second.type != type)
+  {
+    throw std::runtime_error(
+      "[Metrics::" + caller + "] The metric [" + name + "] already exists "
+      "with a different type");
+  }
+
+  return insertion.first->second;
+}
+
+//==============================================================================
+auto Metrics::counter(
+  const std::string& name,
+  const std::string& help,
+  const Labels& labels) -> std::shared_ptr<Counter>
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& series = family("counter", name, help, Type::Counter).counters[labels];
+  if (!series)
+    series = std::make_shared<Counter>();
+
+  return series;
+}
+
+//==============================================================================
+auto Metrics::gauge(
+  const std::string& name,
+  const std::string& help,
+  const Labels& labels) -> std::shared_ptr<Gauge>
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& series = family("gauge", name, help, Type::Gauge).gauges[labels];
+  if (!series)
+    series = std::make_shared<Gauge>();
+
+  return series;
+}
+
+//==============================================================================
+auto Metrics::histogram(
+  const std::string& name,
+  const std::string& help,
+  const Labels& labels,
+  std::vector<double> bounds) -> std::shared_ptr<Histogram>
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& series =
+    family("histogram", name, help, Type::Histogram).histograms[labels];
+  if (!series)
+    series = std::make_shared<Histogram>(std::move(bounds));
+
+  return series;
+}
+
+//==============================================================================
+void Metrics::append_samples(
+  const std::string& name,
+  const Family& family,
+  std::vector<Sample>& output)
+{
+  for (const auto& [labels, counter] : family.counters)
+  {
+    output.push_back(
+      {name + "_total", labels, static_cast<double>(counter->value())});
+  }
+
+  for (const auto& [labels, gauge] : family.gauges)
+    output.push_back({name, labels, gauge->value()});
+
+  for (const auto& [labels, histogram] : family.histograms)
+  {
+    const auto snapshot = histogram->snapshot();
+    uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < snapshot.counts.size(); ++i)
+    {
+      cumulative += snapshot.counts[i];
+      auto bucket_labels = labels;
+      bucket_labels["le"] = i < snapshot.bounds.size() ?
+        format_value(snapshot.bounds[i]) : "+Inf";
+
+      output.push_back(
+        {name + "_bucket", std::move(bucket_labels),
+          static_cast<double>(cumulative)});
+    }
+
+    output.push_back(
+      {name + "_count", labels, static_cast<double>(snapshot.count)});
+    output.push_back({name + "_sum", labels, snapshot.sum});
+  }
+}
+
+//==============================================================================
+auto Metrics::samples() const -> std::vector<Sample>
+{
+  std::vector<Sample> output;
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (const auto& [name, family] : _families)
+    append_samples(name, family, output);
+
+  return output;
+}
+
+//==============================================================================
+std::string Metrics::openmetrics() const
+{
+  std::ostringstream out;
+  std::vector<Sample> family_samples;
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (const auto& [name, family] : _families)
+  {
+    const char* type = family.type == Type::Counter ? "counter" :
+      family.type == Type::Gauge ? "gauge" : "histogram";
+
+    out << "# TYPE " << name << " " << type << "\n"
+        << "# HELP " << name << " " << escape(family.help, false) << "\n";
+
+    family_samples.clear();
+    append_samples(name, family, family_samples);
+    for (const auto& sample : family_samples)
+    {
+      out << format_series(sample.name, sample.labels) << " "
+          << format_value(sample.value) << "\n";
+    }
+  }
+
+  out << "# EOF\n";
+  return out.str();
+}
+
+//==============================================================================
+std::string format_series(
+  const std::string& name,
+  const Metrics::Labels& labels)
+{
+  if (labels.empty())
+    return name;
+
+  std::string series = name + "{";
+  bool first = true;
+  for (const auto& [key, value] : labels)
+  {
+    if (!first)
+      series += ",";
+
+    series += key + "=\"" + escape(value, true) + "\"";
+    first = false;
+  }
+
+  return series + "}";
+}
+
+} // namespace rmf_traffic_ros2
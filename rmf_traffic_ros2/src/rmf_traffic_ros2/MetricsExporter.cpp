@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/MetricsExporter.hpp>
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/Timer.hpp>
+
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+class MetricsExporter::Implementation
+{
+public:
+
+  using DiagnosticArray = diagnostic_msgs::msg::DiagnosticArray;
+  using DiagnosticStatus = diagnostic_msgs::msg::DiagnosticStatus;
+
+  std::shared_ptr<const Metrics> metrics;
+  Refresh refresh;
+  std::string status_name;
+  rclcpp::Clock::SharedPtr clock;
+  rclcpp::Publisher<DiagnosticArray>::SharedPtr diagnostics_pub;
+  rclcpp::TimerBase::SharedPtr timer;
+
+  int server_fd = -1;
+  std::optional<uint16_t> port;
+  std::atomic_bool quit{false};
+  std::thread server_thread;
+
+  ~Implementation()
+  {
+    timer.reset();
+    quit = true;
+    if (server_thread.joinable())
+      server_thread.join();
+
+    if (server_fd >= 0)
+      close(server_fd);
+  }
+
+  void publish()
+  {
+    if (refresh)
+      refresh();
+
+    DiagnosticStatus status;
+    status.level = DiagnosticStatus::OK;
+    status.name = status_name;
+    status.message = "metrics";
+
+    for (const auto& sample : metrics->samples())
+    {
+      std::ostringstream value;
+      value.precision(15);
+      value << sample.value;
+
+      diagnostic_msgs::msg::KeyValue entry;
+      entry.key = format_series(sample.name, sample.labels);
+      entry.value = value.str();
+      status.values.emplace_back(std::move(entry));
+    }
+
+    DiagnosticArray msg;
+    msg.header.stamp = clock->now();
+    msg.status.emplace_back(std::move(status));
+    diagnostics_pub->publish(msg);
+  }
+
+  void open_server(const uint16_t requested_port)
+  {
+    const auto fail = [&](const std::string& what)
+      {
+        const std::string reason = std::strerror(errno);
+        if (server_fd >= 0)
+          close(server_fd);
+
+        server_fd = -1;
+        throw std::runtime_error(
+          "[MetricsExporter::make] Unable to " + what + " for port ["
+          + std::to_string(requested_port) + "]: " + reason);
+      };
+
+    server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_fd < 0)
+      fail("open a socket");
+
+    const int reuse = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(requested_port);
+    if (bind(server_fd, reinterpret_cast<sockaddr*>(&address),
+      sizeof(address)) < 0)
+      fail("bind a socket");
+
+    if (listen(server_fd, 16) < 0)
+      fail("listen");
+
+    socklen_t length = sizeof(address);
+    if (getsockname(server_fd, reinterpret_cast<sockaddr*>(&address),
+      &length) < 0)
+      fail("find the bound address");
+
+    port = ntohs(address.sin_port);
+    server_thread = std::thread([this]() { this->serve(); });
+  }
+
+  void serve()
+  {
+    while (!quit)
+    {
+      // Wake up regularly to check whether the exporter is being destroyed
+      pollfd listener{server_fd, POLLIN, 0};
+      if (poll(&listener, 1, 200) <= 0)
+        continue;
+
+      const int client = accept(server_fd, nullptr, nullptr);
+      if (client < 0)
+        continue;
+
+      respond(client);
+      close(client);
+    }
+  }
+
+  void respond(const int client)
+  {
+    // A scraper that stops talking should not hold up the next one
+    timeval timeout{1, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos
+      && request.size() < 8192)
+    {
+      const auto received = recv(client, buffer, sizeof(buffer), 0);
+      if (received <= 0)
+        break;
+
+      request.append(buffer, static_cast<std::size_t>(received));
+    }
+
+    const std::string path = "GET /metrics";
+    const bool found = request.compare(0, path.size(), path) == 0
+      && request.size() > path.size()
+      && (request[path.size()] == ' ' || request[path.size()] == '?');
+
+    const std::string body = found ? metrics->openmetrics() : "Not Found\n";
+    const std::string content_type = found ?
+      "application/openmetrics-text; version=1.0.0; charset=utf-8" :
+      "text/plain";
+
+    const std::string response =
+      std::string(found ? "HTTP/1.1 200 OK" : "HTTP/1.1 404 Not Found")
+      + "\r\nContent-Type: " + content_type
+      + "\r\nContent-Length: " + std::to_string(body.size())
+      + "\r\nConnection: close\r\n\r\n" + body;
+
+    std::size_t sent = 0;
+    while (sent < response.size())
+    {
+      const auto n = send(
+        client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0)
+        return;
+
+      sent += static_cast<std::size_t>(n);
+    }
+  }
+};
+
+//==============================================================================
+std::shared_ptr<MetricsExporter> MetricsExporter::make(
+  rclcpp::Node& node,
+  std::shared_ptr<const Metrics> metrics,
+  const rmf_traffic::Duration period,
+  const std::optional<uint16_t> http_port,
+  Refresh refresh,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  if (!metrics)
+    throw std::runtime_error("[MetricsExporter::make] metrics is null");
+
+  std::shared_ptr<MetricsExporter> exporter(new MetricsExporter);
+  auto& impl = *exporter->_pimpl;
+  impl.metrics = std::move(metrics);
+  impl.refresh = std::move(refresh);
+  impl.status_name = node.get_fully_qualified_name();
+  impl.clock = node.get_clock();
+
+  if (http_port.has_value())
+    impl.open_server(*http_port);
+
+  impl.diagnostics_pub =
+    node.create_publisher<Implementation::DiagnosticArray>(
+    MetricsDiagnosticsTopicName, rclcpp::SystemDefaultsQoS());
+
+  impl.timer = rmf_traffic_ros2::create_timer(
+    node, period, [impl = &impl]() { impl->publish(); }, std::move(group));
+
+  return exporter;
+}
+
+//==============================================================================
+std::shared_ptr<MetricsExporter> MetricsExporter::from_parameters(
+  rclcpp::Node& node,
+  std::shared_ptr<const Metrics> metrics,
+  Refresh refresh,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  const double period = node.declare_parameter<double>(
+    MetricsPeriodParameterName, 0.0);
+  const int64_t port = node.declare_parameter<int64_t>(
+    MetricsHttpPortParameterName, 0);
+
+  if (period <= 0.0)
+    return nullptr;
+
+  if (port > 65535)
+  {
+    throw std::runtime_error(
+      "[MetricsExporter::from_parameters] Invalid " +
+      MetricsHttpPortParameterName + " [" + std::to_string(port) + "]");
+  }
+
+  std::optional<uint16_t> http_port;
+  if (port > 0)
+    http_port = static_cast<uint16_t>(port);
+
+  auto exporter = make(
+    node, std::move(metrics), rmf_traffic::time::from_seconds(period),
+    http_port, std::move(refresh), std::move(group));
+
+  std::string endpoint;
+  if (http_port.has_value())
+  {
+    endpoint = " and on http://0.0.0.0:" + std::to_string(*http_port)
+      + "/metrics";
+  }
+
+  RCLCPP_INFO(
+    node.get_logger(),
+    "Exporting metrics every [%f] seconds%s", period, endpoint.c_str());
+
+  return exporter;
+}
+
+//==============================================================================
+std::optional<uint16_t> MetricsExporter::http_port() const
+{
+  return _pimpl->port;
+}
+
+//==============================================================================
+MetricsExporter::MetricsExporter()
+: _pimpl(rmf_utils::make_unique_impl<Implementation>())
+{
+  // Do nothing
+}
+
+} // namespace rmf_traffic_ros2
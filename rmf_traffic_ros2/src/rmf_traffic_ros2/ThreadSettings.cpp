@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/ThreadSettings.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace rmf_traffic_ros2 {
+
+//==============================================================================
+bool ThreadSettings::is_default() const
+{
+  return cpu_affinity.empty() && niceness == 0 && realtime_priority == 0;
+}
+
+//==============================================================================
+std::string ThreadSettings::apply() const
+{
+  std::string failures;
+  const auto fail = [&](const std::string& what, int error)
+    {
+      if (!failures.empty())
+        failures += "; ";
+
+      failures += what + ": " + std::strerror(error);
+    };
+
+#ifdef __linux__
+  if (!cpu_affinity.empty())
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto cpu : cpu_affinity)
+    {
+      if (0 <= cpu && cpu < CPU_SETSIZE)
+        CPU_SET(cpu, &set);
+    }
+
+    const int error = CPU_COUNT(&set) > 0 ?
+      pthread_setaffinity_np(pthread_self(), sizeof(set), &set) : EINVAL;
+    if (error != 0)
+      fail("cpu affinity", error);
+  }
+
+  if (niceness != 0)
+  {
+    // On Linux the niceness is an attribute of each thread, so this does not
+    // affect the rest of the process.
+    const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    if (setpriority(PRIO_PROCESS, tid, niceness) != 0)
+      fail("niceness " + std::to_string(niceness), errno);
+  }
+
+  if (realtime_priority != 0)
+  {
+    sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = realtime_priority;
+    const int error =
+      pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error != 0)
+    {
+      fail(
+        "realtime priority " + std::to_string(realtime_priority), error);
+    }
+  }
+#else
+  if (!is_default())
+    failures = "thread settings are only supported on Linux";
+#endif
+
+  return failures;
+}
+
+//==============================================================================
+std::function<void()> ThreadSettings::applier(
+  const rclcpp::Node& node,
+  const std::string& role) const
+{
+  if (is_default())
+    return [](){};
+
+  return [settings = *this, logger = node.get_logger(), role]()
+    {
+      const auto failures = settings.apply();
+      if (!failures.empty())
+      {
+        RCLCPP_WARN(
+          logger,
+          "Unable to apply the thread settings of [%s]: %s",
+          role.c_str(), failures.c_str());
+      }
+    };
+}
+
+//==============================================================================
+ThreadSettings ThreadSettings::from_parameters(
+  rclcpp::Node& node,
+  const std::string& role,
+  const ThreadSettings& defaults)
+{
+  std::vector<int64_t> default_affinity;
+  for (const auto cpu : defaults.cpu_affinity)
+    default_affinity.push_back(cpu);
+
+  ThreadSettings settings;
+  for (const auto cpu : node.declare_parameter<std::vector<int64_t>>(
+      role + "_cpu_affinity", default_affinity))
+  {
+    settings.cpu_affinity.push_back(static_cast<int>(cpu));
+  }
+
+  settings.niceness = node.declare_parameter<int>(
+    role + "_niceness", defaults.niceness);
+  settings.realtime_priority = node.declare_parameter<int>(
+    role + "_realtime_priority", defaults.realtime_priority);
+
+  if (settings.realtime_priority < 0 || 99 < settings.realtime_priority)
+  {
+    throw std::runtime_error(
+      "[ThreadSettings::from_parameters] Invalid " + role
+      + "_realtime_priority [" + std::to_string(settings.realtime_priority)
+      + "]. It must be between 0 and 99.");
+  }
+
+  return settings;
+}
+
+//==============================================================================
+ThreadSettings ThreadSettings::from_parameters(
+  rclcpp::Node& node,
+  const std::string& role)
+{
+  return from_parameters(node, role, ThreadSettings());
+}
+
+} // namespace rmf_traffic_ros2
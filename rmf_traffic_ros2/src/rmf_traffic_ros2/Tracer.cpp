@@ -0,0 +1,641 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/Tracer.hpp>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace rmf_traffic_ros2 {
+
+namespace {
+//==============================================================================
+struct Endpoint
+{
+  std::string host;
+  std::string port;
+  std::string path;
+};
+
+//==============================================================================
+Endpoint parse_endpoint(const std::string& url)
+{
+  const std::string scheme = "http://";
+  if (url.compare(0, scheme.size(), scheme) != 0)
+  {
+    throw std::runtime_error(
+      "[Tracer::make] Only http:// endpoints are supported, not [" + url + "]");
+  }
+
+  Endpoint endpoint;
+  const auto authority_start = scheme.size();
+  const auto path_start = url.find('/', authority_start);
+  const auto authority =
+    url.substr(authority_start, path_start - authority_start);
+  endpoint.path = path_start == std::string::npos ?
+    "/v1/traces" : url.substr(path_start);
+
+  const auto colon = authority.rfind(':');
+  if (colon == std::string::npos)
+  {
+    endpoint.host = authority;
+    endpoint.port = "4318";
+  }
+  else
+  {
+    endpoint.host = authority.substr(0, colon);
+    endpoint.port = authority.substr(colon + 1);
+  }
+
+  if (endpoint.host.empty() || endpoint.port.empty())
+    throw std::runtime_error("[Tracer::make] Invalid endpoint [" + url + "]");
+
+  return endpoint;
+}
+
+//==============================================================================
+/// Send a POST request and return an error, or an empty string on success
+std::string post(const Endpoint& endpoint, const std::string& body)
+{
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  if (getaddrinfo(
+      endpoint.host.c_str(), endpoint.port.c_str(), &hints, &addresses) != 0)
+  {
+    return "Unable to resolve [" + endpoint.host + "]";
+  }
+
+  int fd = -1;
+  for (auto* a = addresses; a != nullptr; a = a->ai_next)
+  {
+    fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd < 0)
+      continue;
+
+    // Do not let an unresponsive collector hold up the export for long
+    timeval timeout = {};
+    timeout.tv_sec = 5;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (connect(fd, a->ai_addr, a->ai_addrlen) == 0)
+      break;
+
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addresses);
+
+  if (fd < 0)
+    return "Unable to connect to [" + endpoint.host + ":" + endpoint.port + "]";
+
+  const std::string request =
+    "POST " + endpoint.path + " HTTP/1.1"
+    + "\r\nHost: " + endpoint.host + ":" + endpoint.port
+    + "\r\nContent-Type: application/json"
+    + "\r\nContent-Length: " + std::to_string(body.size())
+    + "\r\nConnection: close\r\n\r\n" + body;
+
+  std::size_t sent = 0;
+  while (sent < request.size())
+  {
+    const auto n = send(
+      fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0)
+    {
+      close(fd);
+      return "Unable to send the spans";
+    }
+
+    sent += static_cast<std::size_t>(n);
+  }
+
+  char response[64] = {};
+  const auto n = recv(fd, response, sizeof(response) - 1, 0);
+  close(fd);
+
+  // The status line looks like "HTTP/1.1 200 OK"
+  const std::string status(response, n > 0 ? static_cast<std::size_t>(n) : 0);
+  const auto space = status.find(' ');
+  if (space == std::string::npos || space + 1 >= status.size())
+    return "No response from the endpoint";
+
+  if (status[space + 1] != '2')
+  {
+    return "The endpoint responded with ["
+      + status.substr(space + 1, status.find('\r') - space - 1) + "]";
+  }
+
+  return {};
+}
+
+//==============================================================================
+std::string escape_json(const std::string& text)
+{
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (const char c : text)
+  {
+    switch (c)
+    {
+      case '"': escaped += "\\\""; break;
+      case '\\': escaped += "\\\\"; break;
+      case '\n': escaped += "\\n"; break;
+      case '\r': escaped += "\\r"; break;
+      case '\t': escaped += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+          char code[8];
+          std::snprintf(code, sizeof(code), "\\u%04x", c);
+          escaped += code;
+        }
+        else
+        {
+          escaped += c;
+        }
+    }
+  }
+
+  return escaped;
+}
+
+//==============================================================================
+std::string hex(const uint64_t value)
+{
+  char text[17];
+  std::snprintf(
+    text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+  return text;
+}
+
+//==============================================================================
+uint64_t fnv1a(const std::string& text, uint64_t hash)
+{
+  for (const char c : text)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
+
+//==============================================================================
+uint64_t unix_nanos(const Tracer::Time time)
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      time.time_since_epoch()).count());
+}
+
+//==============================================================================
+uint64_t new_span_id()
+{
+  thread_local std::mt19937_64 generator{std::random_device{}()};
+  uint64_t id = 0;
+  while (id == 0)
+    id = generator();
+
+  return id;
+}
+
+//==============================================================================
+std::mutex global_mutex;
+std::shared_ptr<Tracer> global_tracer;
+} // anonymous namespace
+
+//==============================================================================
+class Tracer::Implementation
+{
+public:
+
+  std::string service_name;
+  std::string file;
+  std::optional<Endpoint> endpoint;
+  ErrorCallback on_error;
+
+  // Spans beyond this many are dropped until the export catches up
+  static constexpr std::size_t MaxPending = 10000;
+
+  mutable std::mutex mutex;
+  std::condition_variable wake_cv;
+  std::condition_variable flushed_cv;
+  std::vector<SpanData> pending;
+  uint64_t dropped = 0;
+  uint64_t queued_count = 0;
+  uint64_t exported_count = 0;
+  bool flush_requested = false;
+  bool failing = false;
+  bool quit = false;
+  std::thread thread;
+
+  void add(SpanData span)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (pending.size() >= MaxPending)
+      {
+        ++dropped;
+        return;
+      }
+
+      pending.emplace_back(std::move(span));
+      ++queued_count;
+    }
+  }
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+      wake_cv.wait_for(lock, std::chrono::seconds(1), [&]()
+        {
+          return quit || flush_requested || pending.size() >= 512;
+        });
+
+      std::vector<SpanData> batch;
+      batch.swap(pending);
+      flush_requested = false;
+      const auto count = queued_count;
+      const bool stopping = quit;
+
+      lock.unlock();
+      if (!batch.empty())
+        export_batch(batch);
+      lock.lock();
+
+      exported_count = count;
+      flushed_cv.notify_all();
+
+      if (stopping)
+        return;
+    }
+  }
+
+  void export_batch(const std::vector<SpanData>& batch)
+  {
+    const auto json = to_otlp_json(service_name, batch);
+
+    std::string error;
+    if (!file.empty())
+    {
+      std::ofstream output(file, std::ios::app);
+      if (output)
+        output << json << "\n";
+      else
+        error = "Unable to write to [" + file + "]";
+    }
+
+    if (endpoint.has_value())
+    {
+      const auto endpoint_error = post(*endpoint, json);
+      if (!endpoint_error.empty())
+        error = endpoint_error;
+    }
+
+    // Only report the first of a streak of failures
+    if (!error.empty() && !failing && on_error)
+      on_error(error);
+
+    failing = !error.empty();
+  }
+};
+
+//==============================================================================
+Tracer::Span::Span(Span&& other) noexcept
+: _tracer(std::move(other._tracer)),
+  _data(std::move(other._data))
+{
+  other._tracer = nullptr;
+}
+
+//==============================================================================
+auto Tracer::Span::operator=(Span&& other) noexcept -> Span&
+{
+  if (this != &other)
+  {
+    end();
+    _tracer = std::move(other._tracer);
+    _data = std::move(other._data);
+    other._tracer = nullptr;
+  }
+
+  return *this;
+}
+
+//==============================================================================
+Tracer::Span::~Span()
+{
+  end();
+}
+
+//==============================================================================
+bool Tracer::Span::active() const
+{
+  return _tracer != nullptr;
+}
+
+//==============================================================================
+auto Tracer::Span::attribute(const std::string& key, std::string value)
+-> Span&
+{
+  if (_tracer)
+    _data.attributes[key] = std::move(value);
+
+  return *this;
+}
+
+//==============================================================================
+void Tracer::Span::end()
+{
+  if (!_tracer)
+    return;
+
+  _data.end = std::chrono::system_clock::now();
+  const auto tracer = std::move(_tracer);
+  _tracer = nullptr;
+  tracer->_pimpl->add(std::move(_data));
+}
+
+//==============================================================================
+std::shared_ptr<Tracer> Tracer::make(
+  std::string service_name,
+  std::string file,
+  std::string endpoint,
+  ErrorCallback on_error)
+{
+  std::shared_ptr<Tracer> tracer(new Tracer);
+  auto& impl = *tracer->_pimpl;
+  impl.service_name = std::move(service_name);
+  impl.file = std::move(file);
+  if (!endpoint.empty())
+    impl.endpoint = parse_endpoint(endpoint);
+
+  impl.on_error = std::move(on_error);
+  impl.thread = std::thread([impl = &impl]() { impl->run(); });
+  return tracer;
+}
+
+//==============================================================================
+std::shared_ptr<Tracer> Tracer::from_parameters(rclcpp::Node& node)
+{
+  const auto file = node.declare_parameter<std::string>(
+    TraceFileParameterName, "");
+  const auto endpoint = node.declare_parameter<std::string>(
+    TraceEndpointParameterName, "");
+
+  if (file.empty() && endpoint.empty())
+    return nullptr;
+
+  auto tracer = make(
+    node.get_fully_qualified_name(), file, endpoint,
+    [logger = node.get_logger()](const std::string& error)
+    {
+      RCLCPP_WARN(logger, "Failed to export trace spans: %s", error.c_str());
+    });
+
+  RCLCPP_INFO(
+    node.get_logger(),
+    "Exporting trace spans to%s%s%s%s",
+    file.empty() ? "" : " file ",
+    file.c_str(),
+    endpoint.empty() ? "" : " endpoint ",
+    endpoint.c_str());
+
+  return tracer;
+}
+
+//==============================================================================
+auto Tracer::start(
+  std::string name,
+  std::string correlation,
+  Attributes attributes) -> Span
+{
+  Span span;
+  span._tracer = shared_from_this();
+  span._data.name = std::move(name);
+  span._data.correlation = std::move(correlation);
+  span._data.span_id = new_span_id();
+  span._data.start = std::chrono::system_clock::now();
+  span._data.attributes = std::move(attributes);
+  return span;
+}
+
+//==============================================================================
+void Tracer::record(
+  std::string name,
+  std::string correlation,
+  const Time start,
+  const Time end,
+  Attributes attributes)
+{
+  SpanData span;
+  span.name = std::move(name);
+  span.correlation = std::move(correlation);
+  span.span_id = new_span_id();
+  span.start = start;
+  span.end = end;
+  span.attributes = std::move(attributes);
+  _pimpl->add(std::move(span));
+}
+
+//==============================================================================
+void Tracer::flush()
+{
+  std::unique_lock<std::mutex> lock(_pimpl->mutex);
+  const auto target = _pimpl->queued_count;
+  if (_pimpl->exported_count >= target)
+    return;
+
+  _pimpl->flush_requested = true;
+  _pimpl->wake_cv.notify_all();
+  _pimpl->flushed_cv.wait(lock, [&]()
+    {
+      return _pimpl->exported_count >= target;
+    });
+}
+
+//==============================================================================
+uint64_t Tracer::dropped() const
+{
+  std::lock_guard<std::mutex> lock(_pimpl->mutex);
+  return _pimpl->dropped;
+}
+
+//==============================================================================
+std::string Tracer::trace_id(const std::string& correlation)
+{
+  // Two differently seeded hashes give the 128 bits of a trace ID. A trace ID
+  // of all zeros is invalid, so that one hash is nudged.
+  const uint64_t high = fnv1a(correlation, 14695981039346656037ull);
+  uint64_t low = fnv1a(correlation, 0x9e3779b97f4a7c15ull);
+  if (high == 0 && low == 0)
+    low = 1;
+
+  return hex(high) + hex(low);
+}
+
+//==============================================================================
+std::string Tracer::to_otlp_json(
+  const std::string& service_name,
+  const std::vector<SpanData>& spans)
+{
+  const auto attribute = [](const std::string& key, const std::string& value)
+    {
+      return "{\"key\":\"" + escape_json(key)
+        + "\",\"value\":{\"stringValue\":\"" + escape_json(value) + "\"}}";
+    };
+
+  std::ostringstream out;
+  out << "{\"resourceSpans\":[{\"resource\":{\"attributes\":["
+      << attribute("service.name", service_name)
+      << "]},\"scopeSpans\":[{\"scope\":{\"name\":\"rmf\"},\"spans\":[";
+
+  bool first_span = true;
+  for (const auto& span : spans)
+  {
+    if (!first_span)
+      out << ",";
+    first_span = false;
+
+    out << "{\"traceId\":\"" << trace_id(span.correlation)
+        << "\",\"spanId\":\"" << hex(span.span_id)
+        << "\",\"name\":\"" << escape_json(span.name)
+        << "\",\"kind\":1"
+        << ",\"startTimeUnixNano\":\"" << unix_nanos(span.start)
+        << "\",\"endTimeUnixNano\":\"" << unix_nanos(span.end)
+        << "\",\"attributes\":["
+        << attribute("rmf.correlation", span.correlation);
+
+    for (const auto& [key, value] : span.attributes)
+      out << "," << attribute(key, value);
+
+    out << "]}";
+  }
+
+  out << "]}]}]}";
+  return out.str();
+}
+
+//==============================================================================
+Tracer::~Tracer()
+{
+  {
+    std::lock_guard<std::mutex> lock(_pimpl->mutex);
+    _pimpl->quit = true;
+  }
+
+  _pimpl->wake_cv.notify_all();
+  if (_pimpl->thread.joinable())
+    _pimpl->thread.join();
+}
+
+//==============================================================================
+Tracer::Tracer()
+: _pimpl(rmf_utils::make_unique_impl<Implementation>())
+{
+  // Do nothing
+}
+
+namespace tracing {
+
+//==============================================================================
+void set_tracer(std::shared_ptr<Tracer> tracer)
+{
+  std::lock_guard<std::mutex> lock(global_mutex);
+  global_tracer = std::move(tracer);
+}
+
+//==============================================================================
+std::shared_ptr<Tracer> tracer()
+{
+  std::lock_guard<std::mutex> lock(global_mutex);
+  return global_tracer;
+}
+
+//==============================================================================
+Tracer::Span span(
+  std::string name,
+  std::string correlation,
+  Tracer::Attributes attributes)
+{
+  if (const auto t = tracer())
+  {
+    return t->start(
+      std::move(name), std::move(correlation), std::move(attributes));
+  }
+
+  return Tracer::Span();
+}
+
+//==============================================================================
+void record(
+  std::string name,
+  std::string correlation,
+  const rmf_traffic::Duration duration,
+  Tracer::Attributes attributes)
+{
+  const auto t = tracer();
+  if (!t)
+    return;
+
+  const auto end = std::chrono::system_clock::now();
+  const auto start = end -
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(duration);
+  t->record(
+    std::move(name), std::move(correlation), start, end,
+    std::move(attributes));
+}
+
+//==============================================================================
+std::string task(const std::string& task_id)
+{
+  return "task:" + task_id;
+}
+
+//==============================================================================
+std::string negotiation(const uint64_t conflict_version)
+{
+  return "negotiation:" + std::to_string(conflict_version);
+}
+
+//==============================================================================
+std::string itinerary(const uint64_t participant, const uint64_t version)
+{
+  return "itinerary:" + std::to_string(participant) + ":"
+    + std::to_string(version);
+}
+
+} // namespace tracing
+} // namespace rmf_traffic_ros2
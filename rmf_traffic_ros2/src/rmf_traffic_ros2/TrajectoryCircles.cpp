@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/TrajectoryCircles.hpp>
+
+#include <rmf_traffic/Time.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace rmf_traffic_ros2 {
+
+namespace {
+//==============================================================================
+int64_t nanoseconds(const rmf_traffic::Time t)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    t.time_since_epoch()).count();
+}
+} // anonymous namespace
+
+//==============================================================================
+TrajectoryCircles::TrajectoryCircles(
+  const rmf_traffic::Trajectory& trajectory,
+  const double radius)
+{
+  if (trajectory.size() < 2)
+    return;
+
+  _bounded = true;
+  const std::size_t n = trajectory.size() - 1;
+  _start.reserve(n);
+  _finish.reserve(n);
+  _x.reserve(n);
+  _y.reserve(n);
+  _r.reserve(n);
+
+  auto it = trajectory.begin();
+  auto prev = it++;
+  for (; it != trajectory.end(); prev = it++)
+  {
+    const Eigen::Vector2d p0 = prev->position().block<2, 1>(0, 0);
+    const Eigen::Vector2d p1 = it->position().block<2, 1>(0, 0);
+    const Eigen::Vector2d v0 = prev->velocity().block<2, 1>(0, 0);
+    const Eigen::Vector2d v1 = it->velocity().block<2, 1>(0, 0);
+    const double dt = rmf_traffic::time::to_seconds(it->time() - prev->time());
+
+    // The motion between two waypoints is a cubic Hermite spline, which is
+    // the same curve as the Bezier curve with these control points. The curve
+    // never leaves the convex hull of its control points, so a circle that
+    // contains the control points contains the whole segment.
+    const std::array<Eigen::Vector2d, 4> control = {
+      p0, p0 + v0*dt/3.0, p1 - v1*dt/3.0, p1
+    };
+
+    Eigen::Vector2d lower = p0;
+    Eigen::Vector2d upper = p0;
+    for (const auto& c : control)
+    {
+      lower = lower.cwiseMin(c);
+      upper = upper.cwiseMax(c);
+    }
+
+    const Eigen::Vector2d center = (lower + upper)/2.0;
+    double r = 0.0;
+    for (const auto& c : control)
+      r = std::max(r, (c - center).norm());
+
+    _start.push_back(nanoseconds(prev->time()));
+    _finish.push_back(nanoseconds(it->time()));
+    _x.push_back(center.x());
+    _y.push_back(center.y());
+    _r.push_back(r + radius);
+  }
+}
+
+//==============================================================================
+TrajectoryCircles::TrajectoryCircles(
+  const rmf_traffic::Trajectory& trajectory,
+  const rmf_traffic::Profile& profile)
+: TrajectoryCircles(trajectory, radius(profile))
+{
+  // Do nothing
+}
+
+//==============================================================================
+std::size_t TrajectoryCircles::size() const
+{
+  return _start.size();
+}
+
+//==============================================================================
+bool TrajectoryCircles::might_conflict(const TrajectoryCircles& other) const
+{
+  if (!_bounded || !other._bounded)
+    return true;
+
+  // Compare each segment of the shorter trajectory against the window of
+  // segments of the longer one that overlaps it in time
+  const auto& a = size() <= other.size() ? *this : other;
+  const auto& b = size() <= other.size() ? other : *this;
+
+  const double* const bx = b._x.data();
+  const double* const by = b._y.data();
+  const double* const br = b._r.data();
+  for (std::size_t i = 0; i < a.size(); ++i)
+  {
+    // The segments of b are sorted and contiguous in time, so the ones that
+    // overlap segment i form a single run
+    const auto begin = std::lower_bound(
+      b._finish.begin(), b._finish.end(), a._start[i]) - b._finish.begin();
+    const auto end = std::upper_bound(
+      b._start.begin(), b._start.end(), a._finish[i]) - b._start.begin();
+
+    const double ax = a._x[i];
+    const double ay = a._y[i];
+    const double ar = a._r[i];
+
+    // This loop has no branches or early exits, and it only does arithmetic
+    // on doubles, so that it gets vectorized even without SSE4 or AVX
+    double overlaps = 0.0;
+    for (auto j = begin; j < end; ++j)
+    {
+      const double dx = ax - bx[j];
+      const double dy = ay - by[j];
+      const double reach = ar + br[j];
+      overlaps += dx*dx + dy*dy <= reach*reach ? 1.0 : 0.0;
+    }
+
+    if (overlaps > 0.0)
+      return true;
+  }
+
+  return false;
+}
+
+//==============================================================================
+double TrajectoryCircles::radius(const rmf_traffic::Profile& profile)
+{
+  double r = 0.0;
+  if (const auto& footprint = profile.footprint())
+    r = std::max(r, footprint->get_characteristic_length());
+
+  if (const auto& vicinity = profile.vicinity())
+    r = std::max(r, vicinity->get_characteristic_length());
+
+  return r;
+}
+
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "HeartbeatChecks.hpp"
+
+namespace rmf_traffic_ros2 {
+namespace blockade {
+
+//==============================================================================
+HeartbeatChecks::HeartbeatChecks(const std::size_t shard_count)
+: _shard_heartbeat_counts(shard_count, 0),
+  _last_reported(shard_count)
+{
+  // Do nothing
+}
+
+//==============================================================================
+void HeartbeatChecks::add(const ParticipantId id)
+{
+  _tracked.insert_or_assign(id, Tracked());
+}
+
+//==============================================================================
+void HeartbeatChecks::remove(const ParticipantId id)
+{
+  _tracked.erase(id);
+}
+
+//==============================================================================
+bool HeartbeatChecks::tracks(const ParticipantId id) const
+{
+  return _tracked.count(id) > 0;
+}
+
+//==============================================================================
+void HeartbeatChecks::retry(const ParticipantId id)
+{
+  const auto it = _tracked.find(id);
+  if (it != _tracked.end())
+    it->second.last_status = std::nullopt;
+}
+
+//==============================================================================
+auto HeartbeatChecks::next(
+  const std::size_t shard,
+  const std::vector<StatusMsg>& statuses,
+  const std::unordered_set<ParticipantId>& dirty,
+  const std::function<bool(ParticipantId)>& in_shard) -> Checks
+{
+  const uint64_t current = ++_heartbeat_count;
+  const bool full_check =
+    ++_shard_heartbeat_counts.at(shard) % FullCheckInterval == 0;
+
+  Checks checks;
+  std::vector<ParticipantId> reported;
+  for (const auto& status : statuses)
+  {
+    const auto it = _tracked.find(status.participant);
+    if (it == _tracked.end())
+      continue;
+
+    auto& tracked = it->second;
+    tracked.last_reported = current;
+    reported.push_back(status.participant);
+
+    const bool unchanged =
+      tracked.last_status.has_value() && *tracked.last_status == status;
+    if (unchanged && !full_check && dirty.count(status.participant) == 0)
+      continue;
+
+    tracked.last_status = status;
+    checks.reported.push_back(status);
+  }
+
+  // Only the participants that have just dropped out of the heartbeat or have
+  // changed since the last one can need any attention, except during a full
+  // check.
+  std::unordered_set<ParticipantId> unreported;
+  const auto check_unreported = [&](const ParticipantId id, Tracked& tracked)
+    {
+      if (tracked.last_reported == current || !unreported.insert(id).second)
+        return;
+
+      tracked.last_status = std::nullopt;
+      checks.unreported.push_back(id);
+    };
+
+  if (full_check)
+  {
+    for (auto& [id, tracked] : _tracked)
+    {
+      if (in_shard(id))
+        check_unreported(id, tracked);
+    }
+  }
+  else
+  {
+    for (const auto id : _last_reported[shard])
+    {
+      const auto it = _tracked.find(id);
+      if (it != _tracked.end())
+        check_unreported(id, it->second);
+    }
+
+    for (const auto id : dirty)
+    {
+      const auto it = _tracked.find(id);
+      if (it != _tracked.end())
+        check_unreported(id, it->second);
+    }
+  }
+
+  _last_reported[shard] = std::move(reported);
+  return checks;
+}
+
+} // namespace blockade
+} // namespace rmf_traffic_ros2
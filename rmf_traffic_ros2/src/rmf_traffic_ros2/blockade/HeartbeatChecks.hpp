@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__BLOCKADE__HEARTBEATCHECKS_HPP
+#define SRC__RMF_TRAFFIC_ROS2__BLOCKADE__HEARTBEATCHECKS_HPP
+
+#include <rmf_traffic/blockade/Participant.hpp>
+
+#include <rmf_traffic_msgs/msg/blockade_status.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace blockade {
+
+//==============================================================================
+/// Decides which participants of a blockade writer need to be rectified when
+/// a heartbeat arrives from one shard of the blockade moderation.
+///
+/// A participant whose status in the heartbeat is the same as the last one
+/// that was checked gets skipped, unless it changed on its own side since
+/// then. Every FullCheckInterval heartbeats of a shard, all the participants
+/// of that shard get checked anyway, so a set or ready that was lost on its
+/// way to the moderator is always sent again within FullCheckInterval
+/// heartbeats.
+///
+/// This class is not thread-safe.
+class HeartbeatChecks
+{
+public:
+
+  using ParticipantId = rmf_traffic::blockade::ParticipantId;
+  using StatusMsg = rmf_traffic_msgs::msg::BlockadeStatus;
+
+  static constexpr uint64_t FullCheckInterval = 10;
+
+  /// Constructor
+  ///
+  /// \param[in] shard_count
+  ///   The number of shards that send heartbeats.
+  HeartbeatChecks(std::size_t shard_count);
+
+  /// Start tracking a participant. Anything that was tracked for an earlier
+  /// participant with the same ID is forgotten.
+  void add(ParticipantId id);
+
+  /// Stop tracking a participant.
+  void remove(ParticipantId id);
+
+  /// Check whether a participant is being tracked.
+  bool tracks(ParticipantId id) const;
+
+  /// Make sure a participant gets checked on the next heartbeat of its shard,
+  /// e.g. because the check that was chosen for it could not be done.
+  void retry(ParticipantId id);
+
+  struct Checks
+  {
+    /// The statuses that their participants should be checked against
+    std::vector<StatusMsg> reported;
+
+    /// The participants that were left out of the heartbeat and should be
+    /// checked against having no reservation
+    std::vector<ParticipantId> unreported;
+  };
+
+  /// Decide what needs to be checked for a heartbeat.
+  ///
+  /// \param[in] shard
+  ///   The shard that sent the heartbeat.
+  ///
+  /// \param[in] statuses
+  ///   The statuses of the heartbeat. Participants that are not tracked are
+  ///   ignored.
+  ///
+  /// \param[in] dirty
+  ///   The participants of this shard that changed on their own side since
+  ///   the last heartbeat of the shard.
+  ///
+  /// \param[in] in_shard
+  ///   Tells whether a participant belongs to this shard.
+  Checks next(
+    std::size_t shard,
+    const std::vector<StatusMsg>& statuses,
+    const std::unordered_set<ParticipantId>& dirty,
+    const std::function<bool(ParticipantId)>& in_shard);
+
+private:
+
+  struct Tracked
+  {
+    // The last status that was checked for this participant
+    std::optional<StatusMsg> last_status;
+
+    // The last heartbeat that included this participant
+    uint64_t last_reported = 0;
+  };
+
+  std::unordered_map<ParticipantId, Tracked> _tracked;
+  uint64_t _heartbeat_count = 0;
+  std::vector<uint64_t> _shard_heartbeat_counts;
+  std::vector<std::vector<ParticipantId>> _last_reported;
+};
+
+} // namespace blockade
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__BLOCKADE__HEARTBEATCHECKS_HPP
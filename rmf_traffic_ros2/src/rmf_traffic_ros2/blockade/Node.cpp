@@ -17,6 +17,7 @@
 
 #include <rmf_traffic_ros2/blockade/Node.hpp>
 #include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/Timer.hpp>
 
 #include <rmf_traffic/blockade/Moderator.hpp>
 
@@ -28,6 +29,9 @@
 #include <rmf_traffic_msgs/msg/blockade_set.hpp>
 #include <rmf_traffic_msgs/msg/blockade_status.hpp>
 
+#include <optional>
+#include <variant>
+
 namespace rmf_traffic_ros2 {
 namespace blockade {
 
@@ -51,7 +55,7 @@ public:
       rclcpp::SystemDefaultsQoS().best_effort(),
       [=](const SetMsg::UniquePtr msg)
       {
-        this->blockade_set(*msg);
+        this->queue(std::move(*msg));
       });
 
     blockade_ready_sub =
@@ -60,7 +64,7 @@ public:
       rclcpp::SystemDefaultsQoS().best_effort(),
       [=](const ReadyMsg::UniquePtr msg)
       {
-        this->blockade_ready(*msg);
+        this->queue(std::move(*msg));
       });
 
     blockade_reached_sub =
@@ -69,7 +73,7 @@ public:
       rclcpp::SystemDefaultsQoS().best_effort(),
       [=](const ReachedMsg::UniquePtr msg)
       {
-        this->blockade_reached(*msg);
+        this->queue(std::move(*msg));
       });
 
     blockade_release_sub =
@@ -78,7 +82,7 @@ public:
       rclcpp::SystemDefaultsQoS().best_effort(),
       [=](const ReleaseMsg::UniquePtr msg)
       {
-        this->blockade_release(*msg);
+        this->queue(std::move(*msg));
       });
 
     blockade_cancel_sub =
@@ -87,24 +91,37 @@ public:
       rclcpp::SystemDefaultsQoS().best_effort(),
       [=](const CancelMsg::UniquePtr msg)
       {
-        this->blockade_cancel(*msg);
+        this->queue(std::move(*msg));
       });
 
     heartbeat_pub = create_publisher<HeartbeatMsg>(
       BlockadeHeartbeatTopicName,
       rclcpp::SystemDefaultsQoS().reliable());
 
-    heartbeat_timer = create_wall_timer(
-      std::chrono::seconds(1),
+    // The status is published whenever it changes, but no more often than
+    // this, so that a burst of updates produces one heartbeat.
+    status_min_interval = std::chrono::milliseconds(
+      declare_parameter<int>("status_min_interval", 50));
+
+    // The status is also published at least this often, even if nothing has
+    // changed, so that listeners which missed a heartbeat catch up.
+    const auto heartbeat_period = std::chrono::milliseconds(
+      declare_parameter<int>("heartbeat_period", 1000));
+
+    declare_timers_follow_clock(*this);
+
+    heartbeat_timer = rmf_traffic_ros2::create_timer(
+      *this,
+      heartbeat_period,
       [this]()
       {
-        this->publish_status();
+        this->publish_status(true);
       });
   }
 
   using SetMsg = rmf_traffic_msgs::msg::BlockadeSet;
   rclcpp::Subscription<SetMsg>::SharedPtr blockade_set_sub;
-  void blockade_set(const SetMsg& set)
+  void blockade_apply(const SetMsg& set)
   {
     std::vector<Checkpoint> path;
     for (const auto& c : set.path)
@@ -128,13 +145,11 @@ public:
       RCLCPP_ERROR(
         get_logger(), "Exception due to [set] update: %s", e.what());
     }
-
-    check_for_updates();
   }
 
   using ReadyMsg = rmf_traffic_msgs::msg::BlockadeReady;
   rclcpp::Subscription<ReadyMsg>::SharedPtr blockade_ready_sub;
-  void blockade_ready(const ReadyMsg& ready)
+  void blockade_apply(const ReadyMsg& ready)
   {
     try
     {
@@ -145,13 +160,11 @@ public:
       RCLCPP_ERROR(
         get_logger(), "Exception due to [ready] update: %s", e.what());
     }
-
-    check_for_updates();
   }
 
   using ReleaseMsg = rmf_traffic_msgs::msg::BlockadeRelease;
   rclcpp::Subscription<ReleaseMsg>::SharedPtr blockade_release_sub;
-  void blockade_release(const ReleaseMsg& release)
+  void blockade_apply(const ReleaseMsg& release)
   {
     try
     {
@@ -163,13 +176,11 @@ public:
       RCLCPP_ERROR(
         get_logger(), "Exception due to [release] update: %s", e.what());
     }
-
-    check_for_updates();
   }
 
   using ReachedMsg = rmf_traffic_msgs::msg::BlockadeReached;
   rclcpp::Subscription<ReachedMsg>::SharedPtr blockade_reached_sub;
-  void blockade_reached(const ReachedMsg& reached)
+  void blockade_apply(const ReachedMsg& reached)
   {
     try
     {
@@ -181,13 +192,11 @@ public:
       RCLCPP_ERROR(
         get_logger(), "Exception due to [reached] update: %s", e.what());
     }
-
-    check_for_updates();
   }
 
   using CancelMsg = rmf_traffic_msgs::msg::BlockadeCancel;
   rclcpp::Subscription<CancelMsg>::SharedPtr blockade_cancel_sub;
-  void blockade_cancel(const CancelMsg& cancel)
+  void blockade_apply(const CancelMsg& cancel)
   {
     try
     {
@@ -201,24 +210,81 @@ public:
       RCLCPP_ERROR(
         get_logger(), "Exception due to [cancel] update: %s", e.what());
     }
+  }
+
+  // Blockade messages are queued up and applied together on the next pass of
+  // the executor, so that a burst of messages only leads to one check for
+  // updates.
+  using BlockadeMsg =
+    std::variant<SetMsg, ReadyMsg, ReachedMsg, ReleaseMsg, CancelMsg>;
+  std::vector<BlockadeMsg> pending_msgs;
+  rclcpp::TimerBase::SharedPtr apply_timer;
+
+  void queue(BlockadeMsg msg)
+  {
+    pending_msgs.emplace_back(std::move(msg));
+    if (apply_timer && !apply_timer->is_canceled())
+      return;
+
+    apply_timer = rmf_traffic_ros2::create_timer(
+      *this,
+      std::chrono::nanoseconds(0),
+      [this]()
+      {
+        // This is a one-shot timer
+        this->apply_timer->cancel();
+        this->apply_pending();
+      });
+  }
+
+  void apply_pending()
+  {
+    std::vector<BlockadeMsg> msgs;
+    msgs.swap(pending_msgs);
+    for (const auto& msg : msgs)
+      std::visit([this](const auto& m) { this->blockade_apply(m); }, msg);
 
     check_for_updates();
   }
 
   void check_for_updates()
   {
+    // A change in the assignments is worth a heartbeat right away, since
+    // robots may be waiting on it for a go-ahead.
     const std::size_t current_version = moderator->assignments().version();
-    if (current_version == last_assignment_version)
+    const bool assignments_changed = current_version != last_assignment_version;
+    last_assignment_version = current_version;
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto next_allowed = last_publish_time + status_min_interval;
+    if (assignments_changed || now >= next_allowed)
+    {
+      publish_status(false);
       return;
+    }
 
-    last_assignment_version = current_version;
-    publish_status();
+    // Too soon after the last heartbeat, so check again once the minimum
+    // interval has passed.
+    if (deferred_timer && !deferred_timer->is_canceled())
+      return;
+
+    deferred_timer = rmf_traffic_ros2::create_timer(
+      *this,
+      next_allowed - now,
+      [this]()
+      {
+        // This is a one-shot timer
+        this->deferred_timer->cancel();
+        this->publish_status(false);
+      });
   }
 
   using HeartbeatMsg = rmf_traffic_msgs::msg::BlockadeHeartbeat;
   rclcpp::Publisher<HeartbeatMsg>::SharedPtr heartbeat_pub;
   using StatusMsg = rmf_traffic_msgs::msg::BlockadeStatus;
-  void publish_status()
+  /// Publish the current status of the moderator. Unless forced, nothing is
+  /// published if the status is the same as the last one.
+  void publish_status(const bool force)
   {
     const auto& ranges = moderator->assignments().ranges();
 
@@ -244,12 +310,21 @@ public:
       .statuses(std::move(statuses))
       .has_gridlock(moderator->has_gridlock());
 
+    if (!force && last_heartbeat.has_value() && *last_heartbeat == msg)
+      return;
+
     heartbeat_pub->publish(msg);
+    last_heartbeat = std::move(msg);
+    last_publish_time = std::chrono::steady_clock::now();
   }
 
   std::shared_ptr<rmf_traffic::blockade::Moderator> moderator;
   std::size_t last_assignment_version = 0;
   rclcpp::TimerBase::SharedPtr heartbeat_timer;
+  rclcpp::TimerBase::SharedPtr deferred_timer;
+  std::chrono::steady_clock::duration status_min_interval;
+  std::chrono::steady_clock::time_point last_publish_time;
+  std::optional<HeartbeatMsg> last_heartbeat;
 };
 
 //==============================================================================
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ShardAssignments.hpp"
+
+namespace rmf_traffic_ros2 {
+namespace blockade {
+
+//==============================================================================
+std::size_t ShardAssignments::get(const ParticipantId id) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _shards.find(id);
+  return it == _shards.end() ? 0 : it->second;
+}
+
+//==============================================================================
+std::optional<std::size_t> ShardAssignments::assign(
+  const ParticipantId id,
+  const std::size_t shard)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto [it, inserted] = _shards.insert({id, shard});
+  if (inserted || it->second == shard)
+    return std::nullopt;
+
+  const auto previous = it->second;
+  it->second = shard;
+  return previous;
+}
+
+//==============================================================================
+auto ShardAssignments::take_shard(
+  std::unordered_set<ParticipantId>& participants,
+  const std::size_t shard) const -> std::unordered_set<ParticipantId>
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::unordered_set<ParticipantId> taken;
+  for (auto it = participants.begin(); it != participants.end(); )
+  {
+    const auto s_it = _shards.find(*it);
+    const std::size_t s = s_it == _shards.end() ? 0 : s_it->second;
+    if (s != shard)
+    {
+      ++it;
+      continue;
+    }
+
+    taken.insert(*it);
+    it = participants.erase(it);
+  }
+
+  return taken;
+}
+
+} // namespace blockade
+} // namespace rmf_traffic_ros2
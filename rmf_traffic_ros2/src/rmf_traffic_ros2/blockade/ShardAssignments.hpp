@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__BLOCKADE__SHARDASSIGNMENTS_HPP
+#define SRC__RMF_TRAFFIC_ROS2__BLOCKADE__SHARDASSIGNMENTS_HPP
+
+#include <rmf_traffic/blockade/Participant.hpp>
+
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace rmf_traffic_ros2 {
+namespace blockade {
+
+//==============================================================================
+/// Keeps track of which shard of the blockade moderation each participant
+/// belongs to. Participants that have never set a reservation belong to shard
+/// 0, which is the blockade node in the namespace of the writer.
+///
+/// This class is thread-safe.
+class ShardAssignments
+{
+public:
+
+  using ParticipantId = rmf_traffic::blockade::ParticipantId;
+
+  /// Get the shard that a participant belongs to.
+  std::size_t get(ParticipantId id) const;
+
+  /// Assign a participant to a shard.
+  ///
+  /// \return the shard that the participant is moving away from, or
+  /// std::nullopt if it was not in another shard before.
+  std::optional<std::size_t> assign(ParticipantId id, std::size_t shard);
+
+  /// Take the participants of a shard out of a set, leaving the participants
+  /// of every other shard behind.
+  std::unordered_set<ParticipantId> take_shard(
+    std::unordered_set<ParticipantId>& participants,
+    std::size_t shard) const;
+
+private:
+  mutable std::mutex _mutex;
+  std::unordered_map<ParticipantId, std::size_t> _shards;
+};
+
+} // namespace blockade
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__BLOCKADE__SHARDASSIGNMENTS_HPP
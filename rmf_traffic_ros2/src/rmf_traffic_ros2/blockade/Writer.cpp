@@ -18,6 +18,10 @@
 #include <rmf_traffic_ros2/blockade/Writer.hpp>
 #include <rmf_traffic_ros2/StandardNames.hpp>
 
+#include "../schedule/ScheduleShards.hpp"
+#include "HeartbeatChecks.hpp"
+#include "ShardAssignments.hpp"
+
 #include <rmf_traffic_msgs/msg/blockade_cancel.hpp>
 #include <rmf_traffic_msgs/msg/blockade_heartbeat.hpp>
 #include <rmf_traffic_msgs/msg/blockade_reached.hpp>
@@ -25,12 +29,36 @@
 #include <rmf_traffic_msgs/msg/blockade_release.hpp>
 #include <rmf_traffic_msgs/msg/blockade_set.hpp>
 
+#include <mutex>
+#include <optional>
 #include <unordered_set>
 
 namespace rmf_traffic_ros2 {
 namespace blockade {
 
 namespace {
+//==============================================================================
+/// The name of the parameter that splits the blockade moderation into shards.
+/// Each entry has the form "<namespace>:<map>,<map>,..." and says that the
+/// reservations which begin on those maps are moderated by the blockade node
+/// running in that namespace. Maps that can be reached from one another, e.g.
+/// through lifts, should be given to the same shard. Maps that are not listed
+/// stay with the blockade node in the namespace of the writer.
+const std::string BlockadeShardsParameter = "blockade_shards";
+
+//==============================================================================
+schedule::ScheduleShards get_blockade_shards(rclcpp::Node& node)
+{
+  if (!node.has_parameter(BlockadeShardsParameter))
+  {
+    node.declare_parameter<std::vector<std::string>>(
+      BlockadeShardsParameter, std::vector<std::string>());
+  }
+
+  return schedule::ScheduleShards(
+    node.get_parameter(BlockadeShardsParameter).as_string_array());
+}
+
 //==============================================================================
 class RectifierFactory
   : public rmf_traffic::blockade::RectificationRequesterFactory
@@ -44,25 +72,59 @@ public:
 
   struct RectifierStub;
 
+  // Participants report their own departure and their own updates here, so
+  // that each heartbeat only needs to revisit the participants that could
+  // have changed instead of every participant of this writer. This has its
+  // own mutex because participants may be destroyed or send updates while
+  // the factory_mutex is held for a heartbeat.
+  struct Notices
+  {
+    std::mutex mutex;
+    std::vector<ParticipantId> dead;
+    std::unordered_set<ParticipantId> dirty;
+
+    void died(const ParticipantId id)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      dead.push_back(id);
+    }
+
+    void changed(const ParticipantId id)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      dirty.insert(id);
+    }
+  };
+
   class Requester : public rmf_traffic::blockade::RectificationRequester
   {
   public:
 
     std::shared_ptr<RectifierStub> stub;
+    ParticipantId id;
+    std::shared_ptr<Notices> notices;
 
     Requester(
       rmf_traffic::blockade::Rectifier rectifier,
-      NewRangeCallback callback)
+      NewRangeCallback callback,
+      ParticipantId id_,
+      std::shared_ptr<Notices> notices_)
     : stub(std::make_shared<RectifierStub>(
           RectifierStub{
             std::move(rectifier),
             std::nullopt,
             std::move(callback)
-          }))
+          })),
+      id(id_),
+      notices(std::move(notices_))
     {
       // Do nothing
     }
 
+    ~Requester()
+    {
+      notices->died(id);
+    }
   };
 
   struct RectifierStub
@@ -72,6 +134,8 @@ public:
     NewRangeCallback range_cb;
   };
 
+  using StatusMsg = rmf_traffic_msgs::msg::BlockadeStatus;
+
   using StubMap = std::unordered_map<
     rmf_traffic::blockade::ParticipantId,
     std::weak_ptr<RectifierStub>
@@ -80,11 +144,17 @@ public:
   std::weak_ptr<rmf_traffic::blockade::Writer> weak_writer;
   StubMap stub_map;
   std::unordered_set<ParticipantId> dead_set;
+  std::shared_ptr<Notices> notices = std::make_shared<Notices>();
+
+  // Each shard of the blockade sends its own heartbeats, which only cover the
+  // participants that it moderates.
+  HeartbeatChecks heartbeat_checks;
+  std::shared_ptr<ShardAssignments> assignments;
 
   std::unordered_map<ParticipantId, NewRangeCallback> pending_callbacks;
 
   using HeartbeatMsg = rmf_traffic_msgs::msg::BlockadeHeartbeat;
-  rclcpp::Subscription<HeartbeatMsg>::SharedPtr heartbeat_sub;
+  std::vector<rclcpp::Subscription<HeartbeatMsg>::SharedPtr> heartbeat_subs;
 
   // NOTE(MXG): Because of some awkwardness in the design of the rectification
   // factory, we can only allow one participant to be constructed at a time.
@@ -96,16 +166,25 @@ public:
 
   RectifierFactory(
     rclcpp::Node& node,
-    std::shared_ptr<rmf_traffic::blockade::Writer> writer)
-  : weak_writer(std::move(writer))
+    std::shared_ptr<rmf_traffic::blockade::Writer> writer,
+    const schedule::ScheduleShards& shards,
+    std::shared_ptr<ShardAssignments> assignments_)
+  : weak_writer(std::move(writer)),
+    heartbeat_checks(shards.size()),
+    assignments(std::move(assignments_))
   {
-    heartbeat_sub = node.create_subscription<HeartbeatMsg>(
-      BlockadeHeartbeatTopicName,
-      rclcpp::SystemDefaultsQoS().reliable(),
-      [&](const HeartbeatMsg::UniquePtr msg)
-      {
-        check_status(*msg);
-      });
+    for (std::size_t i = 0; i < shards.size(); ++i)
+    {
+      heartbeat_subs.push_back(
+        node.create_subscription<HeartbeatMsg>(
+          schedule::shard_topic_name(
+            shards.name(i), BlockadeHeartbeatTopicName),
+          rclcpp::SystemDefaultsQoS().reliable(),
+          [this, i](const HeartbeatMsg::UniquePtr msg)
+          {
+            check_status(*msg, i);
+          }));
+    }
   }
 
   std::unique_ptr<rmf_traffic::blockade::RectificationRequester> make(
@@ -119,32 +198,41 @@ public:
     assert(pending_callbacks.empty());
 
     auto requester = std::make_unique<Requester>(
-      std::move(rectifier), std::move(callback));
+      std::move(rectifier), std::move(callback), participant_id, notices);
 
-    stub_map.insert({participant_id, requester->stub});
+    // A stale entry may still be here if a participant with this ID died
+    // since the last heartbeat.
+    stub_map.insert_or_assign(participant_id, requester->stub);
+    heartbeat_checks.add(participant_id);
+    notices->changed(participant_id);
 
     return requester;
   }
 
   void bring_out_your_dead()
   {
-    auto s_it = stub_map.begin();
-    while (s_it != stub_map.end())
+    std::vector<ParticipantId> dead;
     {
-      const auto stub = s_it->second.lock();
-      if (stub)
-      {
-        ++s_it;
-      }
-      else
+      std::lock_guard<std::mutex> lock(notices->mutex);
+      dead.swap(notices->dead);
+    }
+
+    for (const auto id : dead)
+    {
+      const auto s_it = stub_map.find(id);
+      if (s_it == stub_map.end() || !s_it->second.expired())
       {
-        dead_set.insert(s_it->first);
-        stub_map.erase(s_it++);
+        // Either this was already cleaned up, or the ID has been taken over
+        // by a new participant
+        continue;
       }
+
+      dead_set.insert(id);
+      stub_map.erase(s_it);
+      heartbeat_checks.remove(id);
     }
   }
 
-  using StatusMsg = rmf_traffic_msgs::msg::BlockadeStatus;
   rmf_traffic::blockade::Status convert(const StatusMsg& msg)
   {
     rmf_traffic::blockade::Status output;
@@ -165,7 +253,7 @@ public:
     return range;
   }
 
-  void check_status(const HeartbeatMsg& heartbeat)
+  void check_status(const HeartbeatMsg& heartbeat, const std::size_t shard)
   {
     const auto writer = weak_writer.lock();
     if (!writer)
@@ -174,13 +262,33 @@ public:
     std::unique_lock<std::mutex> lock(factory_mutex);
 
     bring_out_your_dead();
-    std::unordered_set<rmf_traffic::blockade::ParticipantId> not_dead_yet;
 
-    auto stub_map_copy = stub_map;
+    const auto in_shard = [&](const ParticipantId id) -> bool
+      {
+        return assignments->get(id) == shard;
+      };
+
+    std::unordered_set<ParticipantId> dirty;
+    {
+      std::lock_guard<std::mutex> notice_lock(notices->mutex);
+
+      // The participants of other shards will be checked when their own
+      // shard sends a heartbeat.
+      dirty = assignments->take_shard(notices->dirty, shard);
+    }
+
+    std::unordered_set<rmf_traffic::blockade::ParticipantId> not_dead_yet;
+    std::vector<StatusMsg> statuses;
     for (const auto& status : heartbeat.statuses)
     {
-      const auto it = stub_map_copy.find(status.participant);
-      if (it == stub_map.end())
+      if (!in_shard(status.participant))
+      {
+        // This participant has moved on to another shard, so whatever this
+        // shard still says about it is out of date.
+        continue;
+      }
+
+      if (stub_map.count(status.participant) == 0)
       {
         const auto d_it = dead_set.find(status.participant);
         if (d_it != dead_set.end())
@@ -192,13 +300,22 @@ public:
         continue;
       }
 
-      const auto stub = it->second.lock();
+      statuses.push_back(status);
+    }
+
+    const auto checks =
+      heartbeat_checks.next(shard, statuses, dirty, in_shard);
+
+    for (const auto& status : checks.reported)
+    {
+      const auto stub = stub_map.at(status.participant).lock();
       if (!stub)
       {
         // We hit a race condition where this stub died just moments after we
         // swept through looking for which stubs died. As an easy way to deal
         // with this, we will simply skip this iteration and let any necessary
         // corrections happen the next time we get a heartbeat.
+        heartbeat_checks.retry(status.participant);
         continue;
       }
 
@@ -207,27 +324,33 @@ public:
       const auto range = get_range(status);
       stub->last_reservation_id = status.reservation;
       stub->range_cb(status.reservation, range);
-
-      stub_map_copy.erase(it);
     }
 
-    for (const auto& s : stub_map_copy)
+    // Make sure that the stubs which were not in this heartbeat shouldn't have
+    // any active reservations.
+    for (const auto id : checks.unreported)
     {
-      // Check on the remaining stubs to make sure they shouldn't have any
-      // active reservations.
-      const auto stub = s.second.lock();
+      const auto stub = stub_map.at(id).lock();
       if (!stub)
       {
-        // We hit a race condition where this stub died just moments after we
-        // wiped away the dead stubs. Just skip this for now and deal with
-        // cleaning it up on the next round.
+        // We hit a race condition where this stub died just moments after
+        // we wiped away the dead stubs. Just skip this for now and deal
+        // with cleaning it up on the next round.
         continue;
       }
 
       stub->rectifier.check();
     }
 
-    dead_set = not_dead_yet;
+    // The dead participants of this shard no longer need to be cancelled
+    // unless this heartbeat still reported them.
+    for (auto d_it = dead_set.begin(); d_it != dead_set.end(); )
+    {
+      if (in_shard(*d_it) && not_dead_yet.count(*d_it) == 0)
+        d_it = dead_set.erase(d_it);
+      else
+        ++d_it;
+    }
   }
 };
 
@@ -252,48 +375,66 @@ public:
     using Cancel = rmf_traffic_msgs::msg::BlockadeCancel;
     using Checkpoint = rmf_traffic_msgs::msg::BlockadeCheckpoint;
 
-    rclcpp::Publisher<Set>::SharedPtr set_pub;
-    rclcpp::Publisher<Ready>::SharedPtr ready_pub;
-    rclcpp::Publisher<Release>::SharedPtr release_pub;
-    rclcpp::Publisher<Reached>::SharedPtr reached_pub;
-    rclcpp::Publisher<Cancel>::SharedPtr cancel_pub;
+    struct ShardPublishers
+    {
+      rclcpp::Publisher<Set>::SharedPtr set;
+      rclcpp::Publisher<Ready>::SharedPtr ready;
+      rclcpp::Publisher<Release>::SharedPtr release;
+      rclcpp::Publisher<Reached>::SharedPtr reached;
+      rclcpp::Publisher<Cancel>::SharedPtr cancel;
+    };
+
+    // When the blockade_shards parameter is set, each shard gets its own
+    // publishers, and every participant is moderated by the shard of the map
+    // that its latest reservation begins on. Shard 0 is the blockade node in
+    // the namespace of the writer.
+    schedule::ScheduleShards shards;
+    std::vector<ShardPublishers> shard_pubs;
+    std::shared_ptr<ShardAssignments> assignments =
+      std::make_shared<ShardAssignments>();
 
     static std::shared_ptr<Transport> make(rclcpp::Node& node)
     {
-      auto transport = std::make_shared<Transport>(node);
-      transport->rectifier_factory =
-        std::make_shared<RectifierFactory>(node, transport);
+      auto transport =
+        std::make_shared<Transport>(node, get_blockade_shards(node));
+      transport->rectifier_factory = std::make_shared<RectifierFactory>(
+        node, transport, transport->shards, transport->assignments);
 
       return transport;
     }
 
-    Transport(rclcpp::Node& node)
+    Transport(rclcpp::Node& node, schedule::ScheduleShards shards_)
+    : shards(std::move(shards_))
     {
-      set_pub = node.create_publisher<Set>(
-        BlockadeSetTopicName,
-        rclcpp::SystemDefaultsQoS().best_effort());
-
-      ready_pub = node.create_publisher<Ready>(
-        BlockadeReadyTopicName,
-        rclcpp::SystemDefaultsQoS().best_effort());
-
-      reached_pub = node.create_publisher<Reached>(
-        BlockadeReachedTopicName,
-        rclcpp::SystemDefaultsQoS().best_effort());
-
-      release_pub = node.create_publisher<Release>(
-        BlockadeReleaseTopicName,
-        rclcpp::SystemDefaultsQoS().best_effort());
-
-      cancel_pub = node.create_publisher<Cancel>(
-        BlockadeCancelTopicName,
-        rclcpp::SystemDefaultsQoS().best_effort());
+      const auto qos = rclcpp::SystemDefaultsQoS().best_effort();
+      for (std::size_t i = 0; i < shards.size(); ++i)
+      {
+        const auto& ns = shards.name(i);
+        shard_pubs.push_back(
+          ShardPublishers{
+            node.create_publisher<Set>(
+              schedule::shard_topic_name(ns, BlockadeSetTopicName), qos),
+            node.create_publisher<Ready>(
+              schedule::shard_topic_name(ns, BlockadeReadyTopicName), qos),
+            node.create_publisher<Release>(
+              schedule::shard_topic_name(ns, BlockadeReleaseTopicName), qos),
+            node.create_publisher<Reached>(
+              schedule::shard_topic_name(ns, BlockadeReachedTopicName), qos),
+            node.create_publisher<Cancel>(
+              schedule::shard_topic_name(ns, BlockadeCancelTopicName), qos)
+          });
+      }
     }
 
     using ParticipantId = rmf_traffic::blockade::ParticipantId;
     using ReservationId = rmf_traffic::blockade::ReservationId;
     using CheckpointId = rmf_traffic::blockade::CheckpointId;
 
+    const ShardPublishers& publishers_for(const ParticipantId id) const
+    {
+      return shard_pubs.at(assignments->get(id));
+    }
+
     rmf_traffic::blockade::Participant make_participant(
       ParticipantId id,
       double radius,
@@ -330,7 +471,24 @@ public:
         .radius(reservation.radius)
         .path(std::move(checkpoints));
 
-      set_pub->publish(msg);
+      if (!reservation.path.empty())
+      {
+        const auto shard =
+          shards.shard_of(reservation.path.front().map_name);
+        if (const auto previous = assignments->assign(participant_id, shard))
+        {
+          // The participant is moving to a different shard, so the moderator
+          // of the old one should forget about it.
+          shard_pubs.at(*previous).cancel->publish(
+            rmf_traffic_msgs::build<rmf_traffic_msgs::msg::BlockadeCancel>()
+            .participant(participant_id)
+            .all_reservations(true)
+            .reservation(0));
+        }
+      }
+
+      publishers_for(participant_id).set->publish(msg);
+      rectifier_factory->notices->changed(participant_id);
     }
 
     void ready(
@@ -344,7 +502,8 @@ public:
         .reservation(reservation_id)
         .checkpoint(checkpoint);
 
-      ready_pub->publish(msg);
+      publishers_for(participant_id).ready->publish(msg);
+      rectifier_factory->notices->changed(participant_id);
     }
 
     void release(
@@ -358,7 +517,8 @@ public:
         .reservation(reservation_id)
         .checkpoint(checkpoint);
 
-      release_pub->publish(msg);
+      publishers_for(participant_id).release->publish(msg);
+      rectifier_factory->notices->changed(participant_id);
     }
 
     void reached(
@@ -372,7 +532,8 @@ public:
         .reservation(reservation_id)
         .checkpoint(checkpoint);
 
-      reached_pub->publish(msg);
+      publishers_for(participant_id).reached->publish(msg);
+      rectifier_factory->notices->changed(participant_id);
     }
 
     void cancel(
@@ -385,7 +546,8 @@ public:
         .all_reservations(false)
         .reservation(reservation_id);
 
-      cancel_pub->publish(msg);
+      publishers_for(participant_id).cancel->publish(msg);
+      rectifier_factory->notices->changed(participant_id);
     }
 
     void cancel(ParticipantId participant_id) final
@@ -396,7 +558,8 @@ public:
         .all_reservations(true)
         .reservation(0);
 
-      cancel_pub->publish(msg);
+      publishers_for(participant_id).cancel->publish(msg);
+      rectifier_factory->notices->changed(participant_id);
     }
   };
 
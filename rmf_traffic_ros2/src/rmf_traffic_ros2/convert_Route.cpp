@@ -30,11 +30,19 @@ rmf_traffic::Route convert(const rmf_traffic_msgs::msg::Route& from)
 rmf_traffic_msgs::msg::Route convert(const rmf_traffic::Route& from)
 {
   rmf_traffic_msgs::msg::Route output;
-  output.map = from.map();
-  output.trajectory = convert(from.trajectory());
+  convert(from, output);
   return output;
 }
 
+//==============================================================================
+void convert(
+  const rmf_traffic::Route& from,
+  rmf_traffic_msgs::msg::Route& into)
+{
+  into.map = from.map();
+  convert(from.trajectory(), into.trajectory);
+}
+
 //==============================================================================
 std::vector<rmf_traffic::Route> convert(
   const std::vector<rmf_traffic_msgs::msg::Route>& from)
@@ -51,6 +59,7 @@ std::vector<rmf_traffic_msgs::msg::Route> convert(
   const std::vector<rmf_traffic::Route>& from)
 {
   std::vector<rmf_traffic_msgs::msg::Route> output;
+  output.reserve(from.size());
   for (const auto& msg : from)
     output.emplace_back(convert(msg));
 
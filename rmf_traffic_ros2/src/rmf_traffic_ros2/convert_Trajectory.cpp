@@ -55,14 +55,13 @@ rmf_traffic::Trajectory convert(const rmf_traffic_msgs::msg::Trajectory& from)
 
 namespace {
 //==============================================================================
-rmf_traffic_msgs::msg::TrajectoryWaypoint convert_waypoint(
-  const rmf_traffic::Trajectory::Waypoint& from)
+void convert_waypoint(
+  const rmf_traffic::Trajectory::Waypoint& from,
+  rmf_traffic_msgs::msg::TrajectoryWaypoint& into)
 {
-  rmf_traffic_msgs::msg::TrajectoryWaypoint output;
-  output.time = from.time().time_since_epoch().count();
-  output.position = from_eigen(from.position());
-  output.velocity = from_eigen(from.velocity());
-  return output;
+  into.time = from.time().time_since_epoch().count();
+  into.position = from_eigen(from.position());
+  into.velocity = from_eigen(from.velocity());
 }
 
 } // anonymous namespace
@@ -71,10 +70,19 @@ rmf_traffic_msgs::msg::TrajectoryWaypoint convert_waypoint(
 rmf_traffic_msgs::msg::Trajectory convert(const rmf_traffic::Trajectory& from)
 {
   rmf_traffic_msgs::msg::Trajectory output;
-  for (const auto& waypoint : from)
-    output.waypoints.emplace_back(convert_waypoint(waypoint));
-
+  convert(from, output);
   return output;
 }
 
+//==============================================================================
+void convert(
+  const rmf_traffic::Trajectory& from,
+  rmf_traffic_msgs::msg::Trajectory& into)
+{
+  into.waypoints.resize(from.size());
+  auto it = into.waypoints.begin();
+  for (const auto& waypoint : from)
+    convert_waypoint(waypoint, *it++);
+}
+
 } // namespace rmf_traffic_ros2
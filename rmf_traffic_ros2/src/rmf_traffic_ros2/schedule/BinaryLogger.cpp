@@ -0,0 +1,471 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/schedule/ParticipantRegistry.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+
+#include "Crc32.hpp"
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// Every journal begins with this header. The final byte is the format version.
+constexpr std::array<uint8_t, 8> Header =
+{'R', 'M', 'F', 'P', 'J', 'R', 'N', 1};
+
+// Each record is laid out as
+//   [payload length: u32][checksum: u32][operation: u8][payload]
+// where the checksum covers the operation byte and the payload.
+constexpr std::size_t RecordPrefixSize = 9;
+
+using DescriptionMsg = rmf_traffic_msgs::msg::ParticipantDescription;
+
+//==============================================================================
+void write_u32(std::vector<uint8_t>& buffer, const uint32_t value)
+{
+  for (int i = 0; i < 4; ++i)
+    buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+uint32_t read_u32(const uint8_t* data)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i)
+    value |= static_cast<uint32_t>(data[i]) << (8*i);
+
+  return value;
+}
+
+//==============================================================================
+void encode_record(std::vector<uint8_t>& buffer, const AtomicOperation& op)
+{
+  const auto msg = rmf_traffic_ros2::convert(op.description);
+  rclcpp::SerializedMessage serialized;
+  rclcpp::Serialization<DescriptionMsg>().serialize_message(&msg, &serialized);
+  const auto& raw = serialized.get_rcl_serialized_message();
+
+  const auto op_byte = static_cast<uint8_t>(op.operation);
+  const uint32_t checksum =
+    crc32(raw.buffer, raw.buffer_length, crc32(&op_byte, 1));
+
+  write_u32(buffer, static_cast<uint32_t>(raw.buffer_length));
+  write_u32(buffer, checksum);
+  buffer.push_back(op_byte);
+  buffer.insert(buffer.end(), raw.buffer, raw.buffer + raw.buffer_length);
+}
+
+//==============================================================================
+ParticipantDescription decode_payload(const uint8_t* data, std::size_t size)
+{
+  rclcpp::SerializedMessage serialized(size);
+  auto& raw = serialized.get_rcl_serialized_message();
+  std::memcpy(raw.buffer, data, size);
+  raw.buffer_length = size;
+
+  DescriptionMsg msg;
+  rclcpp::Serialization<DescriptionMsg>().deserialize_message(
+    &serialized, &msg);
+
+  return rmf_traffic_ros2::convert(msg);
+}
+
+//==============================================================================
+[[noreturn]] void throw_errno(const std::string& what, const std::string& path)
+{
+  throw std::runtime_error(
+    "[BinaryLogger] Failed to " + what + " [" + path + "]: "
+    + std::strerror(errno));
+}
+
+//==============================================================================
+void write_all(const int fd, const std::vector<uint8_t>& data,
+  const std::string& path)
+{
+  std::size_t written = 0;
+  while (written < data.size())
+  {
+    const auto n = ::write(fd, data.data() + written, data.size() - written);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      throw_errno("write to", path);
+    }
+
+    written += static_cast<std::size_t>(n);
+  }
+}
+
+} // anonymous namespace
+
+//==============================================================================
+class BinaryLogger::Implementation
+{
+public:
+  //===========================================================================
+  Implementation(
+    std::string file_path,
+    std::chrono::nanoseconds sync_period,
+    std::size_t compaction_threshold)
+  : _file_path(std::move(file_path)),
+    _sync_period(sync_period),
+    _compaction_threshold(std::max<std::size_t>(1, compaction_threshold))
+  {
+    if (std::filesystem::exists(_file_path)
+      && std::filesystem::file_size(_file_path) > 0)
+    {
+      _load();
+    }
+    else
+    {
+      std::filesystem::create_directories(
+        std::filesystem::absolute(_file_path).parent_path());
+      _fd = _create(_file_path);
+    }
+
+    if (_sync_period > std::chrono::nanoseconds(0))
+      _sync_thread = std::thread([this]() { _sync_loop(); });
+  }
+
+  //===========================================================================
+  ~Implementation()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _quit = true;
+    }
+    _cv.notify_all();
+
+    if (_sync_thread.joinable())
+      _sync_thread.join();
+
+    if (_fd >= 0)
+    {
+      ::fsync(_fd);
+      ::close(_fd);
+    }
+  }
+
+  //===========================================================================
+  void write_operation(AtomicOperation operation)
+  {
+    std::vector<uint8_t> record;
+    encode_record(record, operation);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    write_all(_fd, record, _file_path);
+    _apply(operation);
+    ++_records_in_file;
+
+    if (_records_in_file - _entries.size() >= _compaction_threshold)
+    {
+      _compact();
+      return;
+    }
+
+    _unsynced = true;
+    if (_sync_period <= std::chrono::nanoseconds(0))
+      _sync();
+    else
+      _cv.notify_all();
+  }
+
+  //===========================================================================
+  std::optional<AtomicOperation> read_next_record()
+  {
+    if (_counter >= _initial_records.size())
+    {
+      // Restoration is complete, so we can let go of the loaded records
+      _initial_records.clear();
+      _initial_records.shrink_to_fit();
+      _counter = 0;
+      return std::nullopt;
+    }
+
+    return _initial_records[_counter++];
+  }
+
+  //===========================================================================
+  void sync()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sync();
+  }
+
+private:
+  //===========================================================================
+  void _load()
+  {
+    std::ifstream file(_file_path, std::ios::binary);
+    if (!file)
+      throw_errno("open", _file_path);
+
+    const std::vector<uint8_t> data(
+      (std::istreambuf_iterator<char>(file)),
+      std::istreambuf_iterator<char>());
+
+    if (data.size() < Header.size()
+      || !std::equal(Header.begin(), Header.end(), data.begin()))
+    {
+      throw std::runtime_error(
+        "[BinaryLogger] File [" + _file_path + "] is not a participant "
+        "journal. Failing so that we don't corrupt data.");
+    }
+
+    std::size_t offset = Header.size();
+    while (offset < data.size())
+    {
+      const std::size_t remaining = data.size() - offset;
+      if (remaining < RecordPrefixSize)
+        break;
+
+      const uint8_t* record = data.data() + offset;
+      const std::size_t length = read_u32(record);
+      if (remaining - RecordPrefixSize < length)
+        break;
+
+      const std::size_t record_size = RecordPrefixSize + length;
+      const uint32_t checksum = crc32(record + 8, length + 1);
+      if (checksum != read_u32(record + 4))
+      {
+        // A bad checksum on the very last record means that we were
+        // interrupted while writing it. Anywhere else, it means the file
+        // has been damaged.
+        if (remaining == record_size)
+          break;
+
+        throw std::runtime_error(
+          "[BinaryLogger] Corrupt record at byte [" + std::to_string(offset)
+          + "] of [" + _file_path + "]");
+      }
+
+      const auto op = static_cast<AtomicOperation::OpType>(record[8]);
+      if (op != AtomicOperation::OpType::Add
+        && op != AtomicOperation::OpType::Update)
+      {
+        throw std::runtime_error(
+          "[BinaryLogger] Unknown operation ["
+          + std::to_string(record[8]) + "] in [" + _file_path + "]");
+      }
+
+      AtomicOperation operation{
+        op, decode_payload(record + RecordPrefixSize, length)};
+
+      _apply(operation);
+      _initial_records.emplace_back(std::move(operation));
+      ++_records_in_file;
+      offset += record_size;
+    }
+
+    _fd = ::open(_file_path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (_fd < 0)
+      throw_errno("open", _file_path);
+
+    if (offset < data.size())
+    {
+      // Drop the torn record so that new records get appended after the last
+      // complete one.
+      if (::ftruncate(_fd, static_cast<off_t>(offset)) != 0)
+        throw_errno("truncate", _file_path);
+
+      ::fsync(_fd);
+    }
+  }
+
+  //===========================================================================
+  static int _create(const std::string& path)
+  {
+    const int fd = ::open(
+      path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+      throw_errno("create", path);
+
+    write_all(fd, std::vector<uint8_t>(Header.begin(), Header.end()), path);
+    return fd;
+  }
+
+  //===========================================================================
+  void _apply(const AtomicOperation& operation)
+  {
+    const std::string uuid =
+      operation.description.name() + operation.description.owner();
+
+    const auto it = _index.find(uuid);
+    if (it == _index.end())
+    {
+      _index[uuid] = _entries.size();
+      _entries.push_back(
+        {AtomicOperation::OpType::Add, operation.description});
+      return;
+    }
+
+    _entries[it->second].description = operation.description;
+  }
+
+  //===========================================================================
+  // Rewrite the journal with a single Add record for each participant, in the
+  // order that they were first added so that their IDs are preserved. The new
+  // journal is written next to the old one and then renamed over it, so a
+  // crash will always leave one complete journal behind.
+  void _compact()
+  {
+    const std::string tmp_path = _file_path + ".tmp";
+    const int fd = _create(tmp_path);
+
+    std::vector<uint8_t> data;
+    for (const auto& entry : _entries)
+      encode_record(data, entry);
+
+    try
+    {
+      write_all(fd, data, tmp_path);
+      if (::fsync(fd) != 0)
+        throw_errno("sync", tmp_path);
+    }
+    catch (const std::exception&)
+    {
+      ::close(fd);
+      std::filesystem::remove(tmp_path);
+      throw;
+    }
+
+    std::filesystem::rename(tmp_path, _file_path);
+
+    const auto dir = std::filesystem::absolute(_file_path).parent_path();
+    const int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0)
+    {
+      ::fsync(dir_fd);
+      ::close(dir_fd);
+    }
+
+    ::close(_fd);
+    _fd = fd;
+    _records_in_file = _entries.size();
+    _unsynced = false;
+  }
+
+  //===========================================================================
+  void _sync()
+  {
+    if (!_unsynced)
+      return;
+
+    if (::fsync(_fd) != 0)
+      throw_errno("sync", _file_path);
+
+    _unsynced = false;
+  }
+
+  //===========================================================================
+  void _sync_loop()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_quit)
+    {
+      _cv.wait(lock, [&]() { return _quit || _unsynced; });
+      if (_quit)
+        return;
+
+      // Give other records a chance to share this fsync
+      _cv.wait_for(lock, _sync_period, [&]() { return _quit; });
+
+      try
+      {
+        _sync();
+      }
+      catch (const std::exception&)
+      {
+        // The records are still marked as unsynced, so we will try again
+        // after the next period.
+      }
+    }
+  }
+
+  std::string _file_path;
+  std::chrono::nanoseconds _sync_period;
+  std::size_t _compaction_threshold;
+  int _fd = -1;
+
+  std::vector<AtomicOperation> _initial_records;
+  std::size_t _counter = 0;
+
+  // The latest description of each participant, in the order of their
+  // original registration
+  std::vector<AtomicOperation> _entries;
+  std::unordered_map<std::string, std::size_t> _index;
+  std::size_t _records_in_file = 0;
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bool _unsynced = false;
+  bool _quit = false;
+  std::thread _sync_thread;
+};
+
+//=============================================================================
+BinaryLogger::BinaryLogger(
+  std::string file_path,
+  std::chrono::nanoseconds sync_period,
+  std::size_t compaction_threshold)
+: _pimpl(rmf_utils::make_unique_impl<Implementation>(
+      std::move(file_path), sync_period, compaction_threshold))
+{
+  // Do nothing
+}
+
+//=============================================================================
+void BinaryLogger::write_operation(AtomicOperation operation)
+{
+  _pimpl->write_operation(std::move(operation));
+}
+
+//=============================================================================
+std::optional<AtomicOperation> BinaryLogger::read_next_record()
+{
+  return _pimpl->read_next_record();
+}
+
+//=============================================================================
+void BinaryLogger::sync()
+{
+  _pimpl->sync();
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "BulkRegistration.hpp"
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// Requests and responses are both laid out as
+//   [magic: 3][format: u8][request_id: u64][count: u32]
+//   [[size: u32][CDR payload: size] for each entry]
+// where the entries are participant descriptions for a request, and
+// RegisterParticipant responses for a response.
+constexpr std::array<uint8_t, 4> RequestHeader = {'R', 'M', 'G', 1};
+constexpr std::array<uint8_t, 4> ResponseHeader = {'R', 'M', 'H', 1};
+constexpr std::size_t PrefixSize = 16;
+constexpr std::size_t EntryPrefixSize = 4;
+
+//==============================================================================
+void write_uint(std::vector<uint8_t>& buffer, uint64_t value, int bytes)
+{
+  for (int i = 0; i < bytes; ++i)
+    buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+uint64_t read_uint(const uint8_t* data, int bytes)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i)
+    value |= static_cast<uint64_t>(data[i]) << (8*i);
+
+  return value;
+}
+
+//==============================================================================
+template<typename Message>
+std::vector<uint8_t> encode(
+  const std::array<uint8_t, 4>& header,
+  const uint64_t request_id,
+  const std::vector<Message>& entries)
+{
+  std::vector<uint8_t> buffer;
+  buffer.insert(buffer.end(), header.begin(), header.end());
+  write_uint(buffer, request_id, 8);
+  write_uint(buffer, entries.size(), 4);
+
+  const rclcpp::Serialization<Message> serialization;
+  for (const auto& entry : entries)
+  {
+    rclcpp::SerializedMessage serialized;
+    serialization.serialize_message(&entry, &serialized);
+    const auto& raw = serialized.get_rcl_serialized_message();
+
+    write_uint(buffer, raw.buffer_length, 4);
+    buffer.insert(buffer.end(), raw.buffer, raw.buffer + raw.buffer_length);
+  }
+
+  return buffer;
+}
+
+//==============================================================================
+template<typename Message>
+uint64_t decode(
+  const std::array<uint8_t, 4>& header,
+  const std::vector<uint8_t>& buffer,
+  std::vector<Message>& entries)
+{
+  if (buffer.size() < PrefixSize
+    || !std::equal(header.begin(), header.end(), buffer.begin()))
+  {
+    throw BulkRegistrationError("Buffer is not a bulk registration message");
+  }
+
+  const uint64_t request_id = read_uint(buffer.data() + 4, 8);
+  const std::size_t count = read_uint(buffer.data() + 12, 4);
+  if ((buffer.size() - PrefixSize) / EntryPrefixSize < count)
+    throw BulkRegistrationError("Bulk registration is too short for its count");
+
+  entries.clear();
+  entries.reserve(count);
+
+  const rclcpp::Serialization<Message> serialization;
+  const uint8_t* data = buffer.data() + PrefixSize;
+  const uint8_t* const end = buffer.data() + buffer.size();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (static_cast<std::size_t>(end - data) < EntryPrefixSize)
+      throw BulkRegistrationError("Bulk registration ends inside a size");
+
+    const std::size_t size = read_uint(data, 4);
+    data += EntryPrefixSize;
+
+    if (static_cast<std::size_t>(end - data) < size)
+      throw BulkRegistrationError("Bulk registration ends inside an entry");
+
+    rclcpp::SerializedMessage serialized(size);
+    auto& raw = serialized.get_rcl_serialized_message();
+    std::memcpy(raw.buffer, data, size);
+    raw.buffer_length = size;
+
+    Message entry;
+    try
+    {
+      serialization.deserialize_message(&serialized, &entry);
+    }
+    catch (const std::exception& e)
+    {
+      throw BulkRegistrationError(
+        std::string("Malformed bulk registration entry: ") + e.what());
+    }
+
+    entries.push_back(std::move(entry));
+    data += size;
+  }
+
+  return request_id;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+std::vector<uint8_t> encode_bulk_registration_request(
+  const BulkRegistrationRequest& request)
+{
+  return encode(RequestHeader, request.request_id, request.descriptions);
+}
+
+//==============================================================================
+BulkRegistrationRequest decode_bulk_registration_request(
+  const std::vector<uint8_t>& buffer)
+{
+  BulkRegistrationRequest request;
+  request.request_id = decode(RequestHeader, buffer, request.descriptions);
+  return request;
+}
+
+//==============================================================================
+std::vector<uint8_t> encode_bulk_registration_response(
+  const BulkRegistrationResponse& response)
+{
+  return encode(ResponseHeader, response.request_id, response.registrations);
+}
+
+//==============================================================================
+BulkRegistrationResponse decode_bulk_registration_response(
+  const std::vector<uint8_t>& buffer)
+{
+  BulkRegistrationResponse response;
+  response.request_id = decode(ResponseHeader, buffer, response.registrations);
+  return response;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
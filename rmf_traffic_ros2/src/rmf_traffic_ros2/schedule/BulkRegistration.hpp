@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__BULKREGISTRATION_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__BULKREGISTRATION_HPP
+
+#include <rmf_traffic_msgs/msg/participant_description.hpp>
+#include <rmf_traffic_msgs/srv/register_participant.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Asks the schedule node to register many participants at once, such as all
+/// the robots of a fleet that is starting up.
+struct BulkRegistrationRequest
+{
+  uint64_t request_id = 0;
+  std::vector<rmf_traffic_msgs::msg::ParticipantDescription> descriptions;
+};
+
+//==============================================================================
+/// The answer to a BulkRegistrationRequest. There is one registration for each
+/// description of the request, in the same order. A registration with a
+/// non-empty error failed while the rest may have succeeded.
+struct BulkRegistrationResponse
+{
+  using Registration = rmf_traffic_msgs::srv::RegisterParticipant::Response;
+
+  uint64_t request_id = 0;
+  std::vector<Registration> registrations;
+};
+
+//==============================================================================
+/// Thrown when a bulk registration buffer cannot be decoded.
+class BulkRegistrationError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+std::vector<uint8_t> encode_bulk_registration_request(
+  const BulkRegistrationRequest& request);
+
+//==============================================================================
+/// This will throw a BulkRegistrationError if the buffer is malformed.
+BulkRegistrationRequest decode_bulk_registration_request(
+  const std::vector<uint8_t>& buffer);
+
+//==============================================================================
+std::vector<uint8_t> encode_bulk_registration_response(
+  const BulkRegistrationResponse& response);
+
+//==============================================================================
+/// This will throw a BulkRegistrationError if the buffer is malformed.
+BulkRegistrationResponse decode_bulk_registration_response(
+  const std::vector<uint8_t>& buffer);
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__BULKREGISTRATION_HPP
@@ -0,0 +1,441 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "CompactMirrorUpdate.hpp"
+
+#include <rmf_traffic_ros2/schedule/Patch.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// Bump this whenever the layout of the buffer changes
+constexpr uint8_t FormatVersion = 1;
+constexpr uint8_t Magic[3] = {'R', 'M', 'U'};
+
+//==============================================================================
+class Writer
+{
+public:
+
+  std::vector<uint8_t> buffer;
+
+  void byte(const uint8_t value)
+  {
+    buffer.push_back(value);
+  }
+
+  void varint(uint64_t value)
+  {
+    while (value >= 0x80)
+    {
+      buffer.push_back(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+  }
+
+  void zigzag(const int64_t value)
+  {
+    varint((static_cast<uint64_t>(value) << 1) ^
+      static_cast<uint64_t>(value >> 63));
+  }
+
+  void real(const double value)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i)
+      buffer.push_back(static_cast<uint8_t>(bits >> (8*i)));
+  }
+
+  void string(const std::string& value)
+  {
+    varint(value.size());
+    buffer.insert(buffer.end(), value.begin(), value.end());
+  }
+};
+
+//==============================================================================
+class Reader
+{
+public:
+
+  Reader(const std::vector<uint8_t>& buffer)
+  : _buffer(buffer)
+  {
+    // Do nothing
+  }
+
+  uint8_t byte()
+  {
+    _require(1);
+    return _buffer[_index++];
+  }
+
+  uint64_t varint()
+  {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+      const uint8_t b = byte();
+      value |= static_cast<uint64_t>(b & 0x7F) << shift;
+      if ((b & 0x80) == 0)
+        return value;
+    }
+
+    throw CompactDecodeError("Malformed varint in compact mirror update");
+  }
+
+  int64_t zigzag()
+  {
+    const uint64_t value = varint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  double real()
+  {
+    _require(8);
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i)
+      bits |= static_cast<uint64_t>(_buffer[_index++]) << (8*i);
+
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  std::string string()
+  {
+    const auto size = varint();
+    _require(size);
+    std::string value(
+      _buffer.begin() + _index, _buffer.begin() + _index + size);
+    _index += size;
+    return value;
+  }
+
+  /// Get a count of elements, sanity-checked against the bytes that remain so
+  /// that a corrupt buffer cannot trigger a huge allocation.
+  std::size_t count()
+  {
+    const auto value = varint();
+    if (value > _buffer.size() - _index)
+    {
+      throw CompactDecodeError(
+        "Invalid element count in compact mirror update");
+    }
+
+    return value;
+  }
+
+  bool done() const
+  {
+    return _index == _buffer.size();
+  }
+
+private:
+
+  void _require(const std::size_t bytes) const
+  {
+    if (_buffer.size() - _index < bytes)
+      throw CompactDecodeError("Truncated compact mirror update");
+  }
+
+  const std::vector<uint8_t>& _buffer;
+  std::size_t _index = 0;
+};
+
+//==============================================================================
+struct Quantizer
+{
+  double linear;
+  double angular;
+
+  std::array<int64_t, 3> operator()(const Eigen::Vector3d& v) const
+  {
+    return {
+      std::llround(v[0] / linear),
+      std::llround(v[1] / linear),
+      std::llround(v[2] / angular)
+    };
+  }
+
+  Eigen::Vector3d operator()(const std::array<int64_t, 3>& q) const
+  {
+    return Eigen::Vector3d(
+      static_cast<double>(q[0]) * linear,
+      static_cast<double>(q[1]) * linear,
+      static_cast<double>(q[2]) * angular);
+  }
+};
+
+//==============================================================================
+void encode_trajectory(
+  Writer& w,
+  const rmf_traffic::Trajectory& trajectory,
+  const Quantizer& quantize)
+{
+  w.varint(trajectory.size());
+
+  int64_t last_time = 0;
+  std::array<int64_t, 3> last_p = {0, 0, 0};
+  std::array<int64_t, 3> last_v = {0, 0, 0};
+  for (const auto& wp : trajectory)
+  {
+    const int64_t t = wp.time().time_since_epoch().count();
+    w.zigzag(t - last_time);
+    last_time = t;
+
+    const auto p = quantize(wp.position());
+    const auto v = quantize(wp.velocity());
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      w.zigzag(p[i] - last_p[i]);
+      w.zigzag(v[i] - last_v[i]);
+    }
+
+    last_p = p;
+    last_v = v;
+  }
+}
+
+//==============================================================================
+rmf_traffic::Trajectory decode_trajectory(
+  Reader& r,
+  const Quantizer& quantize)
+{
+  rmf_traffic::Trajectory trajectory;
+  const auto size = r.count();
+
+  int64_t last_time = 0;
+  std::array<int64_t, 3> last_p = {0, 0, 0};
+  std::array<int64_t, 3> last_v = {0, 0, 0};
+  for (std::size_t n = 0; n < size; ++n)
+  {
+    last_time += r.zigzag();
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      last_p[i] += r.zigzag();
+      last_v[i] += r.zigzag();
+    }
+
+    trajectory.insert(
+      rmf_traffic::Time(rmf_traffic::Duration(last_time)),
+      quantize(last_p),
+      quantize(last_v));
+  }
+
+  return trajectory;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+std::vector<uint8_t> encode_compact_mirror_update(
+  const uint64_t node_version,
+  const uint64_t database_version,
+  const rmf_traffic::schedule::Patch& patch,
+  const bool is_remedial_update,
+  const CompactResolution& resolution)
+{
+  const Quantizer quantize{resolution.linear, resolution.angular};
+
+  Writer w;
+  for (const auto m : Magic)
+    w.byte(m);
+  w.byte(FormatVersion);
+  w.real(resolution.linear);
+  w.real(resolution.angular);
+
+  w.varint(node_version);
+  w.varint(database_version);
+  w.byte(is_remedial_update ? 1 : 0);
+
+  w.byte(patch.base_version().has_value() ? 1 : 0);
+  if (patch.base_version().has_value())
+    w.varint(*patch.base_version());
+  w.varint(patch.latest_version());
+
+  const auto& cull = patch.cull();
+  w.byte(cull ? 1 : 0);
+  if (cull)
+    w.zigzag(cull->time().time_since_epoch().count());
+
+  w.varint(patch.size());
+  for (const auto& p : patch)
+  {
+    w.varint(p.participant_id());
+    w.varint(p.itinerary_version());
+
+    const auto& erasures = p.erasures().ids();
+    w.varint(erasures.size());
+    for (const auto id : erasures)
+      w.varint(id);
+
+    const auto& delays = p.delays();
+    w.varint(delays.size());
+    for (const auto& delay : delays)
+      w.zigzag(delay.duration().count());
+
+    const auto& additions = p.additions().items();
+    w.varint(additions.size());
+    for (const auto& item : additions)
+    {
+      if (!item.route)
+        throw std::runtime_error("Cannot encode a nullptr route");
+
+      w.varint(item.id);
+      w.string(item.route->map());
+      encode_trajectory(w, item.route->trajectory(), quantize);
+    }
+  }
+
+  return std::move(w.buffer);
+}
+
+//==============================================================================
+rmf_traffic_msgs::msg::MirrorUpdate decode_compact_mirror_update(
+  const std::vector<uint8_t>& buffer)
+{
+  Reader r(buffer);
+  for (const auto m : Magic)
+  {
+    if (r.byte() != m)
+      throw CompactDecodeError("Buffer is not a compact mirror update");
+  }
+
+  const auto format = r.byte();
+  if (format != FormatVersion)
+  {
+    throw CompactDecodeError(
+      "Unsupported compact mirror update format ["
+      + std::to_string(format) + "]");
+  }
+
+  const double linear = r.real();
+  const double angular = r.real();
+  if (!(linear > 0.0) || !(angular > 0.0))
+    throw CompactDecodeError("Invalid resolution in compact mirror update");
+
+  const Quantizer quantize{linear, angular};
+
+  rmf_traffic_msgs::msg::MirrorUpdate msg;
+  msg.node_version = r.varint();
+  msg.database_version = r.varint();
+  msg.is_remedial_update = r.byte() != 0;
+
+  std::optional<rmf_traffic::schedule::Version> base_version;
+  if (r.byte() != 0)
+    base_version = r.varint();
+  const auto latest_version = r.varint();
+
+  std::optional<rmf_traffic::schedule::Change::Cull> cull;
+  if (r.byte() != 0)
+    cull = rmf_traffic::Time(rmf_traffic::Duration(r.zigzag()));
+
+  using Participant = rmf_traffic::schedule::Patch::Participant;
+  using Change = rmf_traffic::schedule::Change;
+  std::vector<Participant> participants;
+  const auto num_participants = r.count();
+  participants.reserve(num_participants);
+  for (std::size_t i = 0; i < num_participants; ++i)
+  {
+    const auto participant_id = r.varint();
+    const auto itinerary_version = r.varint();
+
+    std::vector<rmf_traffic::RouteId> erasures(r.count());
+    for (auto& id : erasures)
+      id = r.varint();
+
+    std::vector<Change::Delay> delays;
+    const auto num_delays = r.count();
+    delays.reserve(num_delays);
+    for (std::size_t d = 0; d < num_delays; ++d)
+      delays.emplace_back(rmf_traffic::Duration(r.zigzag()));
+
+    std::vector<Change::Add::Item> additions;
+    const auto num_additions = r.count();
+    additions.reserve(num_additions);
+    for (std::size_t a = 0; a < num_additions; ++a)
+    {
+      const auto id = r.varint();
+      auto map = r.string();
+      auto trajectory = decode_trajectory(r, quantize);
+      additions.push_back(
+        {id, std::make_shared<rmf_traffic::Route>(
+            std::move(map), std::move(trajectory))});
+    }
+
+    participants.emplace_back(
+      participant_id,
+      itinerary_version,
+      Change::Erase{std::move(erasures)},
+      std::move(delays),
+      Change::Add{std::move(additions)});
+  }
+
+  if (!r.done())
+    throw CompactDecodeError("Trailing bytes in compact mirror update");
+
+  msg.patch = rmf_traffic_ros2::convert(
+    rmf_traffic::schedule::Patch{
+      std::move(participants),
+      std::move(cull),
+      base_version,
+      latest_version
+    });
+
+  return msg;
+}
+
+//==============================================================================
+std::vector<uint8_t> encode_compact_route(
+  const rmf_traffic::Route& route,
+  const CompactResolution& resolution)
+{
+  Writer w;
+  w.string(route.map());
+  encode_trajectory(
+    w, route.trajectory(), Quantizer{resolution.linear, resolution.angular});
+
+  return std::move(w.buffer);
+}
+
+//==============================================================================
+rmf_traffic::Route decode_compact_route(
+  const std::vector<uint8_t>& buffer,
+  const CompactResolution& resolution)
+{
+  Reader r(buffer);
+  auto map = r.string();
+  auto trajectory = decode_trajectory(
+    r, Quantizer{resolution.linear, resolution.angular});
+
+  if (!r.done())
+    throw CompactDecodeError("Trailing bytes in compact route");
+
+  return rmf_traffic::Route(std::move(map), std::move(trajectory));
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
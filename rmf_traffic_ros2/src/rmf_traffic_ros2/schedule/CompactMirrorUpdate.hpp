@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__COMPACTMIRRORUPDATE_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__COMPACTMIRRORUPDATE_HPP
+
+#include <rmf_traffic/schedule/Patch.hpp>
+
+#include <rmf_traffic_msgs/msg/mirror_update.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// The resolution that positions and velocities are quantized to when a
+/// mirror update is encoded compactly. Times are always encoded losslessly so
+/// that waypoint ordering can never be disturbed by the encoding.
+struct CompactResolution
+{
+  /// Resolution of x/y positions (meters) and velocities (meters/second)
+  double linear = 1e-4;
+
+  /// Resolution of yaw (radians) and yaw rate (radians/second)
+  double angular = 1e-4;
+};
+
+//==============================================================================
+/// Thrown when a compact mirror update buffer cannot be decoded.
+class CompactDecodeError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+/// Encode a mirror update into a flat byte buffer. Each trajectory is
+/// quantized to the given resolution, and every waypoint is stored as a
+/// zigzag varint delta from the waypoint before it.
+std::vector<uint8_t> encode_compact_mirror_update(
+  uint64_t node_version,
+  uint64_t database_version,
+  const rmf_traffic::schedule::Patch& patch,
+  bool is_remedial_update,
+  const CompactResolution& resolution = CompactResolution());
+
+//==============================================================================
+/// Decode a buffer that was produced by encode_compact_mirror_update(). This
+/// will throw a CompactDecodeError if the buffer is malformed.
+rmf_traffic_msgs::msg::MirrorUpdate decode_compact_mirror_update(
+  const std::vector<uint8_t>& buffer);
+
+//==============================================================================
+/// Encode a single route compactly, in the same way that the routes of a
+/// compact mirror update are encoded. The dependencies of the route are not
+/// kept.
+std::vector<uint8_t> encode_compact_route(
+  const rmf_traffic::Route& route,
+  const CompactResolution& resolution = CompactResolution());
+
+//==============================================================================
+/// Decode a buffer that was produced by encode_compact_route() with the same
+/// resolution. This will throw a CompactDecodeError if the buffer is
+/// malformed.
+rmf_traffic::Route decode_compact_route(
+  const std::vector<uint8_t>& buffer,
+  const CompactResolution& resolution = CompactResolution());
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__COMPACTMIRRORUPDATE_HPP
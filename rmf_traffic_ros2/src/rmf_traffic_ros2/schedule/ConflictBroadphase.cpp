@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ConflictBroadphase.hpp"
+
+#include <rmf_traffic/Time.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+int64_t bucket_of(
+  const rmf_traffic::Time t,
+  const rmf_traffic::Duration time_bucket)
+{
+  const int64_t count = t.time_since_epoch().count();
+  const int64_t size = time_bucket.count();
+  const int64_t q = count / size;
+  // Round towards negative infinity so that buckets stay contiguous
+  return (count % size != 0 && count < 0) ? q - 1 : q;
+}
+} // anonymous namespace
+
+//==============================================================================
+ConflictBroadphase::ConflictBroadphase(const rmf_traffic::Duration time_bucket)
+: _time_bucket(time_bucket)
+{
+  if (_time_bucket.count() <= 0)
+    _time_bucket = std::chrono::seconds(10);
+}
+
+//==============================================================================
+void ConflictBroadphase::update(
+  const ParticipantId participant,
+  const rmf_traffic::schedule::ItineraryViewer& viewer)
+{
+  erase(participant);
+
+  const auto description = viewer.get_participant(participant);
+  const auto itinerary = viewer.get_itinerary(participant);
+  if (!description || !itinerary)
+    return;
+
+  const double r = radius(description->profile());
+
+  Record record;
+  record.routes = *itinerary;
+  for (std::size_t i = 0; i < record.routes.size(); ++i)
+  {
+    const auto& route = record.routes[i];
+    assert(route);
+    record.fingerprints.push_back(ConflictCache::fingerprint(*route));
+
+    auto& buckets = _maps[route->map()];
+    for (const auto& slice : sweep(route->trajectory(), r, _time_bucket))
+    {
+      buckets[slice.bucket].push_back(Entry{participant, i, slice.box});
+      record.keys.push_back(Key{route->map(), slice.bucket});
+      ++_size;
+    }
+  }
+
+  _records.insert({participant, std::move(record)});
+}
+
+//==============================================================================
+void ConflictBroadphase::erase(const ParticipantId participant)
+{
+  const auto r_it = _records.find(participant);
+  if (r_it == _records.end())
+    return;
+
+  for (const auto& key : r_it->second.keys)
+  {
+    const auto m_it = _maps.find(key.map);
+    if (m_it == _maps.end())
+      continue;
+
+    auto& buckets = m_it->second;
+    const auto b_it = buckets.find(key.bucket);
+    if (b_it == buckets.end())
+      continue;
+
+    auto& entries = b_it->second;
+    const auto end = std::remove_if(entries.begin(), entries.end(),
+        [participant](const Entry& e) { return e.participant == participant; });
+    _size -= static_cast<std::size_t>(std::distance(end, entries.end()));
+    entries.erase(end, entries.end());
+
+    if (entries.empty())
+      buckets.erase(b_it);
+
+    if (buckets.empty())
+      _maps.erase(m_it);
+  }
+
+  _records.erase(r_it);
+}
+
+//==============================================================================
+void ConflictBroadphase::rebuild(
+  const rmf_traffic::schedule::ItineraryViewer& viewer)
+{
+  _maps.clear();
+  _records.clear();
+  _size = 0;
+
+  for (const auto p : viewer.participant_ids())
+    update(p, viewer);
+}
+
+//==============================================================================
+auto ConflictBroadphase::candidates(
+  const ParticipantId participant,
+  const rmf_traffic::Profile& profile,
+  const rmf_traffic::Route& route) const -> std::vector<Candidate>
+{
+  std::vector<Candidate> output;
+  const auto m_it = _maps.find(route.map());
+  if (m_it == _maps.end())
+    return output;
+
+  const auto& buckets = m_it->second;
+  std::set<std::pair<ParticipantId, std::size_t>> found;
+  const auto slices = sweep(route.trajectory(), radius(profile), _time_bucket);
+  for (const auto& slice : slices)
+  {
+    const auto b_it = buckets.find(slice.bucket);
+    if (b_it == buckets.end())
+      continue;
+
+    for (const auto& entry : b_it->second)
+    {
+      if (entry.participant == participant)
+        continue;
+
+      if (entry.box.intersects(slice.box))
+        found.insert({entry.participant, entry.route_index});
+    }
+  }
+
+  output.reserve(found.size());
+  for (const auto& f : found)
+  {
+    const auto& record = _records.at(f.first);
+    output.push_back(
+      Candidate{
+        f.first,
+        record.routes.at(f.second),
+        record.fingerprints.at(f.second)
+      });
+  }
+
+  return output;
+}
+
+//==============================================================================
+std::size_t ConflictBroadphase::size() const
+{
+  return _size;
+}
+
+//==============================================================================
+auto ConflictBroadphase::sweep(
+  const rmf_traffic::Trajectory& trajectory,
+  const double radius,
+  const rmf_traffic::Duration time_bucket) -> std::vector<Slice>
+{
+  std::vector<Slice> slices;
+  if (trajectory.size() < 2)
+    return slices;
+
+  auto it = trajectory.begin();
+  auto prev = it++;
+  for (; it != trajectory.end(); prev = it++)
+  {
+    const Eigen::Vector2d p0 = prev->position().block<2, 1>(0, 0);
+    const Eigen::Vector2d p1 = it->position().block<2, 1>(0, 0);
+    const double v0 = prev->velocity().block<2, 1>(0, 0).norm();
+    const double v1 = it->velocity().block<2, 1>(0, 0).norm();
+    const double dt = rmf_traffic::time::to_seconds(it->time() - prev->time());
+
+    // The motion between two waypoints is a cubic Hermite spline whose
+    // position basis functions are non-negative and sum to one, so the curve
+    // can only leave the box of its endpoints through the velocity terms. The
+    // magnitude of each velocity basis function never exceeds 4/27.
+    const double pad = radius + 4.0/27.0 * std::abs(dt) * (v0 + v1);
+
+    Box box(p0.cwiseMin(p1), p0.cwiseMax(p1));
+    box.min() -= Eigen::Vector2d::Constant(pad);
+    box.max() += Eigen::Vector2d::Constant(pad);
+
+    const int64_t b0 = bucket_of(prev->time(), time_bucket);
+    const int64_t b1 = bucket_of(it->time(), time_bucket);
+    for (int64_t b = b0; b <= b1; ++b)
+    {
+      if (!slices.empty() && slices.back().bucket == b)
+        slices.back().box.extend(box);
+      else
+        slices.push_back(Slice{b, box});
+    }
+  }
+
+  return slices;
+}
+
+//==============================================================================
+std::optional<Eigen::Vector2d> ConflictBroadphase::stationary_point(
+  const rmf_traffic::Trajectory& trajectory)
+{
+  // Waiting in place is planned with waypoints that share one position, so an
+  // exact comparison is enough
+  const double tolerance = 1e-6;
+  if (trajectory.size() < 2)
+    return std::nullopt;
+
+  const Eigen::Vector2d p = trajectory.front().position().block<2, 1>(0, 0);
+  for (const auto& wp : trajectory)
+  {
+    if ((wp.position().block<2, 1>(0, 0) - p).norm() > tolerance)
+      return std::nullopt;
+
+    if (wp.velocity().block<2, 1>(0, 0).norm() > tolerance)
+      return std::nullopt;
+  }
+
+  return p;
+}
+
+//==============================================================================
+bool ConflictBroadphase::might_reach(
+  const rmf_traffic::Trajectory& trajectory,
+  const Eigen::Vector2d& point,
+  const double distance,
+  const rmf_traffic::Time start,
+  const rmf_traffic::Time finish)
+{
+  if (trajectory.size() < 2)
+    return false;
+
+  auto it = trajectory.begin();
+  auto prev = it++;
+  for (; it != trajectory.end(); prev = it++)
+  {
+    if (it->time() < start)
+      continue;
+
+    if (finish < prev->time())
+      break;
+
+    // Same bound on the spline as sweep(), but for each segment on its own
+    const Eigen::Vector2d p0 = prev->position().block<2, 1>(0, 0);
+    const Eigen::Vector2d p1 = it->position().block<2, 1>(0, 0);
+    const double v0 = prev->velocity().block<2, 1>(0, 0).norm();
+    const double v1 = it->velocity().block<2, 1>(0, 0).norm();
+    const double dt = rmf_traffic::time::to_seconds(it->time() - prev->time());
+    const double pad = distance + 4.0/27.0 * std::abs(dt) * (v0 + v1);
+
+    Box box(p0.cwiseMin(p1), p0.cwiseMax(p1));
+    box.min() -= Eigen::Vector2d::Constant(pad);
+    box.max() += Eigen::Vector2d::Constant(pad);
+    if (box.contains(point))
+      return true;
+  }
+
+  return false;
+}
+
+//==============================================================================
+double ConflictBroadphase::radius(const rmf_traffic::Profile& profile)
+{
+  double r = 0.0;
+  if (const auto& footprint = profile.footprint())
+    r = std::max(r, footprint->get_characteristic_length());
+
+  if (const auto& vicinity = profile.vicinity())
+    r = std::max(r, vicinity->get_characteristic_length());
+
+  return r;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
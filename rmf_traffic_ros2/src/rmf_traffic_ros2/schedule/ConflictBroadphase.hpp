@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__CONFLICTBROADPHASE_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__CONFLICTBROADPHASE_HPP
+
+#include "ConflictCache.hpp"
+
+#include <rmf_traffic/Profile.hpp>
+#include <rmf_traffic/Route.hpp>
+#include <rmf_traffic/schedule/ItineraryViewer.hpp>
+
+#include <Eigen/Geometry>
+
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A broadphase index for the conflict-check thread of the schedule node.
+///
+/// Each route in the schedule is broken down into fixed-size time buckets and
+/// the space that the route sweeps through during each bucket is recorded as
+/// an axis-aligned bounding box which has been inflated by the participant's
+/// profile. Only routes whose boxes overlap a changed route in the same map
+/// and the same time bucket need to be passed along to the narrowphase
+/// rmf_traffic::DetectConflict::between check.
+///
+/// The index is not thread-safe. It is meant to be owned by the same thread
+/// that owns the Mirror which it is describing.
+class ConflictBroadphase
+{
+public:
+
+  using ParticipantId = rmf_traffic::schedule::ParticipantId;
+  using Box = Eigen::AlignedBox2d;
+
+  /// A route of another participant which might be in conflict.
+  struct Candidate
+  {
+    ParticipantId participant;
+    rmf_traffic::ConstRoutePtr route;
+    ConflictCache::Fingerprint fingerprint;
+  };
+
+  /// Constructor
+  ///
+  /// \param[in] time_bucket
+  ///   The duration of each time bucket. Smaller buckets give tighter bounding
+  ///   boxes at the cost of more entries per route.
+  ConflictBroadphase(
+    rmf_traffic::Duration time_bucket = std::chrono::seconds(10));
+
+  /// Re-index every route that currently belongs to the participant. If the
+  /// viewer no longer has an itinerary for the participant, the participant
+  /// will be removed from the index.
+  void update(
+    ParticipantId participant,
+    const rmf_traffic::schedule::ItineraryViewer& viewer);
+
+  /// Remove all the routes of a participant from the index.
+  void erase(ParticipantId participant);
+
+  /// Clear the index and re-index every participant in the viewer.
+  void rebuild(const rmf_traffic::schedule::ItineraryViewer& viewer);
+
+  /// Get the routes of participants other than the given participant whose
+  /// swept volumes might overlap with the given route. The candidates are
+  /// sorted by participant.
+  std::vector<Candidate> candidates(
+    ParticipantId participant,
+    const rmf_traffic::Profile& profile,
+    const rmf_traffic::Route& route) const;
+
+  /// Get the number of (route, time bucket) entries in the index.
+  std::size_t size() const;
+
+  /// A swept bounding box of a route during one time bucket.
+  struct Slice
+  {
+    int64_t bucket;
+    Box box;
+  };
+
+  /// Compute the time-bucketed swept volume of a trajectory, inflated by the
+  /// given radius. The slices are sorted by bucket.
+  static std::vector<Slice> sweep(
+    const rmf_traffic::Trajectory& trajectory,
+    double radius,
+    rmf_traffic::Duration time_bucket);
+
+  /// Get the radius that a profile needs to be inflated by to encompass both
+  /// its footprint and its vicinity.
+  static double radius(const rmf_traffic::Profile& profile);
+
+  /// Get the position of a trajectory that holds still for its whole
+  /// duration, such as a robot that is waiting in place. This returns
+  /// std::nullopt if the trajectory moves at all.
+  static std::optional<Eigen::Vector2d> stationary_point(
+    const rmf_traffic::Trajectory& trajectory);
+
+  /// Check whether a trajectory might come within the given distance of a
+  /// point at any time from start to finish. This is a cheap test which may
+  /// give false positives, but a false return value is certain.
+  static bool might_reach(
+    const rmf_traffic::Trajectory& trajectory,
+    const Eigen::Vector2d& point,
+    double distance,
+    rmf_traffic::Time start,
+    rmf_traffic::Time finish);
+
+private:
+
+  struct Entry
+  {
+    ParticipantId participant;
+    std::size_t route_index;
+    Box box;
+  };
+
+  struct Key
+  {
+    std::string map;
+    int64_t bucket;
+  };
+
+  struct Record
+  {
+    rmf_traffic::schedule::Itinerary routes;
+    std::vector<ConflictCache::Fingerprint> fingerprints;
+    std::vector<Key> keys;
+  };
+
+  using Buckets = std::unordered_map<int64_t, std::vector<Entry>>;
+
+  rmf_traffic::Duration _time_bucket;
+  std::unordered_map<std::string, Buckets> _maps;
+  std::unordered_map<ParticipantId, Record> _records;
+  std::size_t _size = 0;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__CONFLICTBROADPHASE_HPP
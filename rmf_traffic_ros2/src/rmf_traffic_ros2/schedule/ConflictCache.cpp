@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ConflictCache.hpp"
+
+#include <functional>
+#include <utility>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+void hash_combine(std::size_t& seed, const std::size_t value)
+{
+  seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+//==============================================================================
+void hash_vector(std::size_t& seed, const Eigen::Vector3d& v)
+{
+  const std::hash<double> h;
+  for (int i = 0; i < 3; ++i)
+    hash_combine(seed, h(v[i]));
+}
+} // anonymous namespace
+
+//==============================================================================
+ConflictCache::ConflictCache(const std::size_t max_idle_cycles)
+: _max_idle_cycles(max_idle_cycles)
+{
+  // Do nothing
+}
+
+//==============================================================================
+auto ConflictCache::fingerprint(const rmf_traffic::Route& route)
+-> Fingerprint
+{
+  std::size_t seed = std::hash<std::string>()(route.map());
+  for (const auto& wp : route.trajectory())
+  {
+    const int64_t t = wp.time().time_since_epoch().count();
+    hash_combine(seed, std::hash<int64_t>()(t));
+    hash_vector(seed, wp.position());
+    hash_vector(seed, wp.velocity());
+  }
+
+  return seed;
+}
+
+//==============================================================================
+bool ConflictCache::same_route(
+  const rmf_traffic::Route& a,
+  const rmf_traffic::Route& b)
+{
+  if (&a == &b)
+    return true;
+
+  if (a.map() != b.map())
+    return false;
+
+  const auto& trajectory_a = a.trajectory();
+  const auto& trajectory_b = b.trajectory();
+  if (trajectory_a.size() != trajectory_b.size())
+    return false;
+
+  auto wp_b = trajectory_b.begin();
+  for (const auto& wp_a : trajectory_a)
+  {
+    if (wp_a.time() != wp_b->time()
+      || wp_a.position() != wp_b->position()
+      || wp_a.velocity() != wp_b->velocity())
+      return false;
+
+    ++wp_b;
+  }
+
+  return true;
+}
+
+//==============================================================================
+std::optional<bool> ConflictCache::find(const Side& a, const Side& b)
+{
+  const auto [first, second] = _order(a, b);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _verdicts.find(
+    Key{
+      first->participant, first->fingerprint,
+      second->participant, second->fingerprint
+    });
+
+  if (it == _verdicts.end())
+    return std::nullopt;
+
+  auto& verdict = it->second;
+  if (!same_route(*verdict.route_a, *first->route)
+    || !same_route(*verdict.route_b, *second->route))
+  {
+    // The fingerprints collided, so this verdict is for different routes
+    return std::nullopt;
+  }
+
+  verdict.last_used = _cycle;
+  return verdict.conflict;
+}
+
+//==============================================================================
+void ConflictCache::insert(const Side& a, const Side& b, const bool conflict)
+{
+  const auto [first, second] = _order(a, b);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _verdicts[Key{
+      first->participant, first->fingerprint,
+      second->participant, second->fingerprint
+    }] = Verdict{first->route, second->route, conflict, _cycle};
+}
+
+//==============================================================================
+void ConflictCache::next_cycle()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  ++_cycle;
+  if (_cycle < _max_idle_cycles)
+    return;
+
+  const std::size_t oldest = _cycle - _max_idle_cycles;
+  auto it = _verdicts.begin();
+  while (it != _verdicts.end())
+  {
+    if (it->second.last_used < oldest)
+      it = _verdicts.erase(it);
+    else
+      ++it;
+  }
+}
+
+//==============================================================================
+void ConflictCache::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _verdicts.clear();
+}
+
+//==============================================================================
+std::size_t ConflictCache::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _verdicts.size();
+}
+
+//==============================================================================
+bool ConflictCache::Key::operator==(const Key& other) const
+{
+  return participant_a == other.participant_a
+    && route_a == other.route_a
+    && participant_b == other.participant_b
+    && route_b == other.route_b;
+}
+
+//==============================================================================
+std::size_t ConflictCache::KeyHash::operator()(const Key& key) const
+{
+  std::size_t seed = key.route_a;
+  hash_combine(seed, key.route_b);
+  hash_combine(seed, std::hash<ParticipantId>()(key.participant_a));
+  hash_combine(seed, std::hash<ParticipantId>()(key.participant_b));
+  return seed;
+}
+
+//==============================================================================
+auto ConflictCache::_order(const Side& a, const Side& b)
+-> std::pair<const Side*, const Side*>
+{
+  if (std::make_pair(b.participant, b.fingerprint)
+    < std::make_pair(a.participant, a.fingerprint))
+    return {&b, &a};
+
+  return {&a, &b};
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__CONFLICTCACHE_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__CONFLICTCACHE_HPP
+
+#include <rmf_traffic/Route.hpp>
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Remembers the narrowphase verdict for pairs of routes so that
+/// rmf_traffic::DetectConflict::between only needs to run again when one side
+/// of the pair has actually changed.
+///
+/// Verdicts are looked up by a fingerprint of each route's content rather than
+/// by an itinerary version, so a route that a participant sends again without
+/// changing it will keep hitting the cache even though it arrives in a new
+/// itinerary. Each verdict holds on to the routes that it was computed for,
+/// and a lookup only hits if those routes are identical to the routes that
+/// are being checked, so two routes whose fingerprints collide can never
+/// share a verdict. The verdicts assume that participant profiles do not
+/// change, so clear() must be called whenever the participant descriptions
+/// are updated.
+///
+/// This class is thread-safe.
+class ConflictCache
+{
+public:
+
+  using ParticipantId = rmf_traffic::schedule::ParticipantId;
+  using Fingerprint = std::size_t;
+
+  /// One route of a pair that is being checked
+  struct Side
+  {
+    ParticipantId participant;
+    rmf_traffic::ConstRoutePtr route;
+    Fingerprint fingerprint;
+  };
+
+  /// Constructor
+  ///
+  /// \param[in] max_idle_cycles
+  ///   Verdicts that have not been used for this many cycles will be dropped.
+  ConflictCache(std::size_t max_idle_cycles = 10);
+
+  /// Compute the fingerprint of a route
+  static Fingerprint fingerprint(const rmf_traffic::Route& route);
+
+  /// Check whether two routes have the same map and the same waypoints
+  static bool same_route(
+    const rmf_traffic::Route& a,
+    const rmf_traffic::Route& b);
+
+  /// Look up the verdict for a pair of routes. The order of the pair does not
+  /// matter.
+  std::optional<bool> find(const Side& a, const Side& b);
+
+  /// Save the verdict for a pair of routes. This replaces any verdict whose
+  /// fingerprints collide with this pair.
+  void insert(const Side& a, const Side& b, bool conflict);
+
+  /// Move on to the next conflict-check cycle, dropping stale verdicts.
+  void next_cycle();
+
+  /// Forget every verdict.
+  void clear();
+
+  /// The number of verdicts that are being remembered.
+  std::size_t size() const;
+
+private:
+
+  struct Key
+  {
+    ParticipantId participant_a;
+    Fingerprint route_a;
+    ParticipantId participant_b;
+    Fingerprint route_b;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Verdict
+  {
+    rmf_traffic::ConstRoutePtr route_a;
+    rmf_traffic::ConstRoutePtr route_b;
+    bool conflict;
+    std::size_t last_used;
+  };
+
+  /// Order the pair so that (a, b) and (b, a) share the same verdict
+  static std::pair<const Side*, const Side*> _order(
+    const Side& a, const Side& b);
+
+  std::size_t _max_idle_cycles;
+  std::size_t _cycle = 0;
+  mutable std::mutex _mutex;
+  std::unordered_map<Key, Verdict, KeyHash> _verdicts;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__CONFLICTCACHE_HPP
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__CRC32_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__CRC32_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Standard (IEEE 802.3) CRC-32 checksum, used to detect corruption in the
+/// files that the schedule node writes. Pass in a previous result as crc to
+/// continue a checksum across several buffers.
+inline uint32_t crc32(
+  const uint8_t* data,
+  const std::size_t size,
+  uint32_t crc = 0)
+{
+  crc = ~crc;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    crc ^= data[i];
+    for (int k = 0; k < 8; ++k)
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+
+  return ~crc;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__CRC32_HPP
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "DelayCoalescer.hpp"
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+ItineraryMsg release(const CoalescedDelay& held)
+{
+  if (held.itinerary_version != held.last_version)
+    return held;
+
+  DelayCoalescer::Delay delay;
+  delay.participant = held.participant;
+  delay.delay = held.delay;
+  delay.itinerary_version = held.itinerary_version;
+  return delay;
+}
+} // anonymous namespace
+
+//==============================================================================
+std::optional<ItineraryMsg> DelayCoalescer::add(const Delay& delay)
+{
+  const auto insertion = _held.insert({delay.participant, CoalescedDelay()});
+  auto& held = insertion.first->second;
+
+  std::optional<ItineraryMsg> previous;
+  if (!insertion.second)
+  {
+    // Only a delay that directly follows the held ones can be merged into
+    // them. Anything else, like a retransmission, starts a new run.
+    if (held.last_version + 1 == delay.itinerary_version)
+    {
+      held.delay += delay.delay;
+      held.last_version = delay.itinerary_version;
+      return std::nullopt;
+    }
+
+    previous = release(held);
+  }
+
+  held.participant = delay.participant;
+  held.delay = delay.delay;
+  held.itinerary_version = delay.itinerary_version;
+  held.last_version = delay.itinerary_version;
+  return previous;
+}
+
+//==============================================================================
+std::optional<ItineraryMsg> DelayCoalescer::take(const uint64_t participant)
+{
+  const auto it = _held.find(participant);
+  if (it == _held.end())
+    return std::nullopt;
+
+  auto output = release(it->second);
+  _held.erase(it);
+  return output;
+}
+
+//==============================================================================
+std::vector<ItineraryMsg> DelayCoalescer::take_all()
+{
+  std::vector<ItineraryMsg> output;
+  output.reserve(_held.size());
+  for (const auto& entry : _held)
+    output.push_back(release(entry.second));
+
+  _held.clear();
+  return output;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__DELAYCOALESCER_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__DELAYCOALESCER_HPP
+
+#include "ItineraryBatch.hpp"
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Holds back the delays of each participant so that a run of delays with
+/// consecutive itinerary versions can be sent as one message. Whoever owns
+/// the coalescer must take() the held delay of a participant before sending
+/// any other change for that participant, so that delays are never reordered
+/// relative to sets, extends, or erases.
+///
+/// This class is not thread-safe.
+class DelayCoalescer
+{
+public:
+
+  using Delay = rmf_traffic_msgs::msg::ItineraryDelay;
+
+  /// Hold onto a delay. If the participant already had a delay held that
+  /// this one cannot be merged with, the older one is returned so it can be
+  /// sent first.
+  std::optional<ItineraryMsg> add(const Delay& delay);
+
+  /// Release the delay that is being held for a participant, if there is one.
+  /// This will be an ItineraryDelay if only one delay was held, or a
+  /// CoalescedDelay if several were merged.
+  std::optional<ItineraryMsg> take(uint64_t participant);
+
+  /// Release every delay that is being held.
+  std::vector<ItineraryMsg> take_all();
+
+private:
+  std::unordered_map<uint64_t, CoalescedDelay> _held;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__DELAYCOALESCER_HPP
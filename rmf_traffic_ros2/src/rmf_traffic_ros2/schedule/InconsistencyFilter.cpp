@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "InconsistencyFilter.hpp"
+
+#include <algorithm>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+std::optional<std::string> inconsistency_filter(
+  std::vector<rmf_traffic::schedule::ParticipantId> participants)
+{
+  if (participants.empty()
+    || participants.size() > MaxFilteredInconsistencyParticipants)
+    return std::nullopt;
+
+  // Sort the participants so the same set always gives the same expression
+  std::sort(participants.begin(), participants.end());
+  participants.erase(
+    std::unique(participants.begin(), participants.end()),
+    participants.end());
+
+  std::string expression;
+  for (const auto p : participants)
+  {
+    if (!expression.empty())
+      expression += " OR ";
+
+    expression += "participant = " + std::to_string(p);
+  }
+
+  return expression;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
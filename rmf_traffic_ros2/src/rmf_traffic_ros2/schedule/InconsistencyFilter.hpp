@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INCONSISTENCYFILTER_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INCONSISTENCYFILTER_HPP
+
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// The most participants that one content filter will name. A writer with
+/// more participants than this receives the inconsistencies of every
+/// participant and discards the ones that it does not own.
+constexpr std::size_t MaxFilteredInconsistencyParticipants = 64;
+
+//==============================================================================
+/// Make the content filter expression for the ScheduleInconsistency topic that
+/// only admits the inconsistencies of the given participants. This returns a
+/// nullopt when there are no participants or too many to name, in which case
+/// the subscription should not be filtered.
+std::optional<std::string> inconsistency_filter(
+  std::vector<rmf_traffic::schedule::ParticipantId> participants);
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INCONSISTENCYFILTER_HPP
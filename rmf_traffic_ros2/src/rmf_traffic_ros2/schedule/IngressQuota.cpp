@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "IngressQuota.hpp"
+
+#include <rmf_utils/Modular.hpp>
+
+#include <algorithm>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+uint64_t participant_of(const ItineraryMsg& msg)
+{
+  return std::visit([](const auto& m) { return m.participant; }, msg);
+}
+
+//==============================================================================
+uint64_t version_of(const ItineraryMsg& msg)
+{
+  return std::visit([](const auto& m) { return m.itinerary_version; }, msg);
+}
+
+//==============================================================================
+uint64_t last_version_of(const ItineraryMsg& msg)
+{
+  if (const auto* delay = std::get_if<CoalescedDelay>(&msg))
+    return delay->last_version;
+
+  return version_of(msg);
+}
+
+//==============================================================================
+bool replaces_itinerary(const ItineraryMsg& msg)
+{
+  return std::holds_alternative<rmf_traffic_msgs::msg::ItinerarySet>(msg)
+    || std::holds_alternative<rmf_traffic_msgs::msg::ItineraryClear>(msg);
+}
+
+//==============================================================================
+bool is_filler(const ItineraryMsg& msg)
+{
+  const auto* delay = std::get_if<CoalescedDelay>(&msg);
+  return delay && delay->delay == 0;
+}
+} // anonymous namespace
+
+//==============================================================================
+IngressQuota::IngressQuota(Limit participant_limit, Limit fleet_limit)
+: _participant_limit(participant_limit),
+  _fleet_limit(fleet_limit)
+{
+  // Do nothing
+}
+
+//==============================================================================
+bool IngressQuota::admit(
+  const uint64_t participant,
+  const std::string& fleet,
+  const Clock::time_point now)
+{
+  if (throttled(participant))
+    return false;
+
+  return take_tokens(participant, fleet, now);
+}
+
+//==============================================================================
+std::size_t IngressQuota::defer(ItineraryMsg msg, const std::string& fleet)
+{
+  auto& held = _held[participant_of(msg)];
+  held.fleet = fleet;
+
+  std::size_t replaced = 0;
+  if (replaces_itinerary(msg))
+  {
+    // Everything deferred before this message is overridden by it. The older
+    // versions are turned into runs of empty delays, which the schedule can
+    // apply without any real work.
+    const auto version = version_of(msg);
+    std::vector<ItineraryMsg> kept;
+    std::vector<CoalescedDelay> fillers;
+    for (auto& m : held.msgs)
+    {
+      if (!rmf_utils::modular(version_of(m)).less_than(version))
+      {
+        kept.emplace_back(std::move(m));
+        continue;
+      }
+
+      if (!is_filler(m))
+        ++replaced;
+
+      const auto first = version_of(m);
+      const auto last = last_version_of(m);
+      if (!fillers.empty() && fillers.back().last_version + 1 == first)
+      {
+        fillers.back().last_version = last;
+        continue;
+      }
+
+      CoalescedDelay filler;
+      filler.participant = participant_of(m);
+      filler.itinerary_version = first;
+      filler.last_version = last;
+      fillers.push_back(filler);
+    }
+
+    _deferred -= held.msgs.size();
+    held.msgs.clear();
+    for (const auto& filler : fillers)
+      held.msgs.emplace_back(filler);
+
+    for (auto& m : kept)
+      held.msgs.emplace_back(std::move(m));
+
+    _deferred += held.msgs.size();
+  }
+
+  held.msgs.emplace_back(std::move(msg));
+  ++_deferred;
+  return replaced;
+}
+
+//==============================================================================
+std::vector<ItineraryMsg> IngressQuota::release(const Clock::time_point now)
+{
+  std::vector<ItineraryMsg> output;
+  if (_held.empty())
+    return output;
+
+  // Go around the participants once, starting where the last release stopped
+  auto it = _held.lower_bound(_next_release);
+  const std::size_t count = _held.size();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (it == _held.end())
+      it = _held.begin();
+
+    if (!take_tokens(it->first, it->second.fleet, now))
+    {
+      ++it;
+      continue;
+    }
+
+    _next_release = it->first + 1;
+    _deferred -= it->second.msgs.size();
+    for (auto& m : it->second.msgs)
+      output.emplace_back(std::move(m));
+
+    it = _held.erase(it);
+  }
+
+  return output;
+}
+
+//==============================================================================
+bool IngressQuota::throttled(const uint64_t participant) const
+{
+  return _held.count(participant) > 0;
+}
+
+//==============================================================================
+std::size_t IngressQuota::throttled_participants() const
+{
+  return _held.size();
+}
+
+//==============================================================================
+std::size_t IngressQuota::deferred() const
+{
+  return _deferred;
+}
+
+//==============================================================================
+template<typename Key>
+auto IngressQuota::refill(
+  std::unordered_map<Key, Bucket>& buckets,
+  const Key& key,
+  const Limit& limit,
+  const Clock::time_point now) -> Bucket*
+{
+  if (limit.unlimited())
+    return nullptr;
+
+  const auto insertion = buckets.insert({key, Bucket{limit.burst, now}});
+  auto& bucket = insertion.first->second;
+  if (!insertion.second)
+  {
+    const double elapsed =
+      std::chrono::duration<double>(now - bucket.updated).count();
+    if (elapsed > 0.0)
+    {
+      bucket.tokens =
+        std::min(limit.burst, bucket.tokens + elapsed * limit.rate);
+      bucket.updated = now;
+    }
+  }
+
+  return &bucket;
+}
+
+//==============================================================================
+bool IngressQuota::take_tokens(
+  const uint64_t participant,
+  const std::string& fleet,
+  const Clock::time_point now)
+{
+  Bucket* const p = refill(_participants, participant, _participant_limit, now);
+  if (p && p->tokens < 1.0)
+    return false;
+
+  Bucket* const f = refill(_fleets, fleet, _fleet_limit, now);
+  if (f && f->tokens < 1.0)
+    return false;
+
+  if (p)
+    p->tokens -= 1.0;
+
+  if (f)
+    f->tokens -= 1.0;
+
+  return true;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
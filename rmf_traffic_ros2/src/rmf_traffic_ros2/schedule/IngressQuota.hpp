@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INGRESSQUOTA_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INGRESSQUOTA_HPP
+
+#include "ItineraryBatch.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Rate limits for the itinerary writes that the schedule node accepts from
+/// each participant and from each fleet. Every write takes one token from the
+/// bucket of its participant and one from the bucket of its fleet. A write
+/// that finds either bucket empty is deferred until release() finds tokens
+/// for it, and once a participant has deferred writes, all of its writes are
+/// deferred so that they stay in order.
+///
+/// While writes are deferred, a set or a clear replaces the deferred writes
+/// that came before it. The itinerary versions of the replaced writes are
+/// kept as empty delays, so the schedule does not see them as missing.
+///
+/// This class is not thread-safe.
+class IngressQuota
+{
+public:
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Limit
+  {
+    /// Writes per second that are allowed on average. Zero or less means
+    /// there is no limit.
+    double rate = 0.0;
+
+    /// How many writes are allowed in a burst
+    double burst = 1.0;
+
+    bool unlimited() const
+    {
+      return rate <= 0.0;
+    }
+  };
+
+  /// Constructor
+  ///
+  /// \param[in] participant_limit
+  ///   The limit for each participant
+  ///
+  /// \param[in] fleet_limit
+  ///   The limit for all the participants of one fleet together
+  IngressQuota(Limit participant_limit, Limit fleet_limit);
+
+  /// Check if a write may be applied right away, and take its tokens if so.
+  bool admit(
+    uint64_t participant,
+    const std::string& fleet,
+    Clock::time_point now);
+
+  /// Hold onto a write that was not admitted. The number of deferred writes
+  /// that it replaced is returned.
+  std::size_t defer(ItineraryMsg msg, const std::string& fleet);
+
+  /// Take the deferred writes of every participant that has tokens again.
+  /// All the deferred writes of a participant are released together for the
+  /// price of one write.
+  std::vector<ItineraryMsg> release(Clock::time_point now);
+
+  /// Check if a participant has deferred writes
+  bool throttled(uint64_t participant) const;
+
+  /// The number of participants that have deferred writes
+  std::size_t throttled_participants() const;
+
+  /// The number of writes that are being held
+  std::size_t deferred() const;
+
+private:
+
+  struct Bucket
+  {
+    double tokens;
+    Clock::time_point updated;
+  };
+
+  // Refill the bucket of a key and return it, or return nullptr if the limit
+  // is unlimited
+  template<typename Key>
+  static Bucket* refill(
+    std::unordered_map<Key, Bucket>& buckets,
+    const Key& key,
+    const Limit& limit,
+    Clock::time_point now);
+
+  // Take a token from both buckets if they each have one
+  bool take_tokens(
+    uint64_t participant,
+    const std::string& fleet,
+    Clock::time_point now);
+
+  struct Held
+  {
+    std::string fleet;
+    std::vector<ItineraryMsg> msgs;
+  };
+
+  Limit _participant_limit;
+  Limit _fleet_limit;
+  std::unordered_map<uint64_t, Bucket> _participants;
+  std::unordered_map<std::string, Bucket> _fleets;
+  std::map<uint64_t, Held> _held;
+  std::size_t _deferred = 0;
+
+  // Where the next release() begins, so participants with lower IDs do not
+  // always get the tokens of their fleet first
+  uint64_t _next_release = 0;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__INGRESSQUOTA_HPP
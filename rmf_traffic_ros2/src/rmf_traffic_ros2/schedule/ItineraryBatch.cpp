@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "ItineraryBatch.hpp"
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// Each batch is laid out as
+//   [magic: 3][format: u8][count: u32]
+//   [[kind: u8][size: u32][CDR payload: size] for each message]
+// where the kind is the index of the message type in ItineraryMsg. A
+// CoalescedDelay is not a ROS message, so its payload is its four fields as
+// little-endian 64-bit integers instead of CDR.
+constexpr std::array<uint8_t, 4> Header = {'R', 'M', 'I', 1};
+constexpr std::size_t PrefixSize = 8;
+constexpr std::size_t ItemPrefixSize = 5;
+constexpr std::size_t CoalescedDelaySize = 32;
+
+//==============================================================================
+void write_uint(std::vector<uint8_t>& buffer, uint64_t value, int bytes)
+{
+  for (int i = 0; i < bytes; ++i)
+    buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+uint64_t read_uint(const uint8_t* data, int bytes)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i)
+    value |= static_cast<uint64_t>(data[i]) << (8*i);
+
+  return value;
+}
+
+//==============================================================================
+template<typename Message>
+void write_item(
+  std::vector<uint8_t>& buffer,
+  const std::size_t kind,
+  const Message& msg)
+{
+  rclcpp::SerializedMessage serialized;
+  rclcpp::Serialization<Message>().serialize_message(&msg, &serialized);
+  const auto& raw = serialized.get_rcl_serialized_message();
+
+  write_uint(buffer, kind, 1);
+  write_uint(buffer, raw.buffer_length, 4);
+  buffer.insert(buffer.end(), raw.buffer, raw.buffer + raw.buffer_length);
+}
+
+//==============================================================================
+void write_item(
+  std::vector<uint8_t>& buffer,
+  const std::size_t kind,
+  const CoalescedDelay& msg)
+{
+  write_uint(buffer, kind, 1);
+  write_uint(buffer, CoalescedDelaySize, 4);
+  write_uint(buffer, msg.participant, 8);
+  write_uint(buffer, static_cast<uint64_t>(msg.delay), 8);
+  write_uint(buffer, msg.itinerary_version, 8);
+  write_uint(buffer, msg.last_version, 8);
+}
+
+//==============================================================================
+template<std::size_t Kind>
+ItineraryMsg read_item(const uint8_t* data, const std::size_t size)
+{
+  using Message = std::variant_alternative_t<Kind, ItineraryMsg>;
+
+  rclcpp::SerializedMessage serialized(size);
+  auto& raw = serialized.get_rcl_serialized_message();
+  std::memcpy(raw.buffer, data, size);
+  raw.buffer_length = size;
+
+  Message msg;
+  rclcpp::Serialization<Message>().deserialize_message(&serialized, &msg);
+  return msg;
+}
+
+//==============================================================================
+ItineraryMsg read_coalesced_delay(const uint8_t* data, const std::size_t size)
+{
+  if (size != CoalescedDelaySize)
+    throw ItineraryBatchError("Coalesced delay has the wrong size");
+
+  CoalescedDelay msg;
+  msg.participant = read_uint(data, 8);
+  msg.delay = static_cast<int64_t>(read_uint(data + 8, 8));
+  msg.itinerary_version = read_uint(data + 16, 8);
+  msg.last_version = read_uint(data + 24, 8);
+  return msg;
+}
+
+//==============================================================================
+ItineraryMsg read_item(
+  const uint8_t kind,
+  const uint8_t* data,
+  const std::size_t size)
+{
+  switch (kind)
+  {
+    case 0: return read_item<0>(data, size);
+    case 1: return read_item<1>(data, size);
+    case 2: return read_item<2>(data, size);
+    case 3: return read_item<3>(data, size);
+    case 4: return read_item<4>(data, size);
+    case 5: return read_coalesced_delay(data, size);
+  }
+
+  throw ItineraryBatchError(
+    "Unknown itinerary message kind [" + std::to_string(kind) + "]");
+}
+
+} // anonymous namespace
+
+//==============================================================================
+std::vector<uint8_t> encode_itinerary_batch(
+  const std::vector<ItineraryMsg>& msgs)
+{
+  std::vector<uint8_t> buffer;
+  buffer.insert(buffer.end(), Header.begin(), Header.end());
+  write_uint(buffer, msgs.size(), 4);
+
+  for (const auto& msg : msgs)
+  {
+    std::visit(
+      [&](const auto& m) { write_item(buffer, msg.index(), m); }, msg);
+  }
+
+  return buffer;
+}
+
+//==============================================================================
+std::vector<ItineraryMsg> decode_itinerary_batch(
+  const std::vector<uint8_t>& buffer)
+{
+  if (buffer.size() < PrefixSize
+    || !std::equal(Header.begin(), Header.end(), buffer.begin()))
+  {
+    throw ItineraryBatchError("Buffer is not an itinerary batch");
+  }
+
+  const std::size_t count = read_uint(buffer.data() + 4, 4);
+  if ((buffer.size() - PrefixSize) / ItemPrefixSize < count)
+    throw ItineraryBatchError("Itinerary batch is too short for its count");
+
+  std::vector<ItineraryMsg> msgs;
+  msgs.reserve(count);
+
+  const uint8_t* data = buffer.data() + PrefixSize;
+  const uint8_t* const end = buffer.data() + buffer.size();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (static_cast<std::size_t>(end - data) < ItemPrefixSize)
+      throw ItineraryBatchError("Itinerary batch ends in the middle of a kind");
+
+    const auto kind = data[0];
+    const std::size_t size = read_uint(data + 1, 4);
+    data += ItemPrefixSize;
+
+    if (static_cast<std::size_t>(end - data) < size)
+      throw ItineraryBatchError("Itinerary batch ends in the middle of a msg");
+
+    try
+    {
+      msgs.emplace_back(read_item(kind, data, size));
+    }
+    catch (const ItineraryBatchError&)
+    {
+      throw;
+    }
+    catch (const std::exception& e)
+    {
+      throw ItineraryBatchError(
+        std::string("Malformed itinerary batch message: ") + e.what());
+    }
+
+    data += size;
+  }
+
+  return msgs;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__ITINERARYBATCH_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__ITINERARYBATCH_HPP
+
+#include <rmf_traffic_msgs/msg/itinerary_set.hpp>
+#include <rmf_traffic_msgs/msg/itinerary_extend.hpp>
+#include <rmf_traffic_msgs/msg/itinerary_delay.hpp>
+#include <rmf_traffic_msgs/msg/itinerary_erase.hpp>
+#include <rmf_traffic_msgs/msg/itinerary_clear.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A run of consecutive delays of one participant that a writer merged into
+/// one message. It stands for a delay of the whole duration at
+/// itinerary_version followed by empty delays up to last_version, so the
+/// itinerary versions that the participant has handed out all stay
+/// accounted for.
+struct CoalescedDelay
+{
+  uint64_t participant = 0;
+  int64_t delay = 0;
+  uint64_t itinerary_version = 0;
+  uint64_t last_version = 0;
+
+  bool operator==(const CoalescedDelay& other) const
+  {
+    return participant == other.participant
+      && delay == other.delay
+      && itinerary_version == other.itinerary_version
+      && last_version == other.last_version;
+  }
+};
+
+//==============================================================================
+/// Any one of the itinerary messages that a schedule writer can send
+using ItineraryMsg = std::variant<
+  rmf_traffic_msgs::msg::ItinerarySet,
+  rmf_traffic_msgs::msg::ItineraryExtend,
+  rmf_traffic_msgs::msg::ItineraryDelay,
+  rmf_traffic_msgs::msg::ItineraryErase,
+  rmf_traffic_msgs::msg::ItineraryClear,
+  CoalescedDelay
+>;
+
+//==============================================================================
+/// Thrown when an itinerary batch buffer cannot be decoded.
+class ItineraryBatchError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+/// Pack the itinerary messages of any number of participants into one buffer.
+/// The messages keep their order.
+std::vector<uint8_t> encode_itinerary_batch(
+  const std::vector<ItineraryMsg>& msgs);
+
+//==============================================================================
+/// This will throw an ItineraryBatchError if the buffer is malformed.
+std::vector<ItineraryMsg> decode_itinerary_batch(
+  const std::vector<uint8_t>& buffer);
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__ITINERARYBATCH_HPP
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "LevelOfDetail.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+/// How far a waypoint is from the point that moves in a straight line, at a
+/// constant speed, from one kept waypoint to the next
+double deviation(
+  const rmf_traffic::Trajectory::Waypoint& start,
+  const rmf_traffic::Trajectory::Waypoint& middle,
+  const rmf_traffic::Trajectory::Waypoint& finish)
+{
+  const Eigen::Vector2d p0 = start.position().block<2, 1>(0, 0);
+  const Eigen::Vector2d p1 = finish.position().block<2, 1>(0, 0);
+  const Eigen::Vector2d p = middle.position().block<2, 1>(0, 0);
+
+  const double span = rmf_traffic::time::to_seconds(
+    finish.time() - start.time());
+  if (span <= 0.0)
+    return (p - p0).norm();
+
+  const double s = rmf_traffic::time::to_seconds(
+    middle.time() - start.time()) / span;
+  return (p - (p0 + s*(p1 - p0))).norm();
+}
+} // anonymous namespace
+
+//==============================================================================
+rmf_traffic::Trajectory decimate(
+  const rmf_traffic::Trajectory& trajectory,
+  const double tolerance)
+{
+  const std::size_t n = trajectory.size();
+  if (n <= 2)
+    return trajectory;
+
+  // Douglas-Peucker over the waypoints, with an explicit stack so a long
+  // trajectory cannot overflow the call stack
+  std::vector<bool> keep(n, false);
+  keep.front() = true;
+  keep.back() = true;
+
+  std::vector<std::pair<std::size_t, std::size_t>> spans;
+  spans.push_back({0, n-1});
+  while (!spans.empty())
+  {
+    const auto [first, last] = spans.back();
+    spans.pop_back();
+    if (last <= first + 1)
+      continue;
+
+    double worst = -1.0;
+    std::size_t worst_index = first;
+    for (std::size_t i = first + 1; i < last; ++i)
+    {
+      const double d =
+        deviation(trajectory[first], trajectory[i], trajectory[last]);
+      if (d > worst)
+      {
+        worst = d;
+        worst_index = i;
+      }
+    }
+
+    if (worst <= tolerance)
+      continue;
+
+    keep[worst_index] = true;
+    spans.push_back({first, worst_index});
+    spans.push_back({worst_index, last});
+  }
+
+  rmf_traffic::Trajectory output;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (!keep[i])
+      continue;
+
+    const auto& wp = trajectory[i];
+    output.insert(wp.time(), wp.position(), wp.velocity());
+  }
+
+  return output;
+}
+
+//==============================================================================
+rmf_traffic::schedule::Patch decimate(
+  const rmf_traffic::schedule::Patch& patch,
+  const double tolerance)
+{
+  using Change = rmf_traffic::schedule::Change;
+
+  std::vector<rmf_traffic::schedule::Patch::Participant> participants;
+  participants.reserve(patch.size());
+  for (const auto& p : patch)
+  {
+    std::vector<Change::Add::Item> additions;
+    additions.reserve(p.additions().items().size());
+    for (const auto& item : p.additions().items())
+    {
+      additions.push_back(
+        {
+          item.id,
+          std::make_shared<rmf_traffic::Route>(
+            item.route->map(),
+            decimate(item.route->trajectory(), tolerance))
+        });
+    }
+
+    participants.emplace_back(
+      p.participant_id(),
+      p.itinerary_version(),
+      p.erasures(),
+      p.delays(),
+      Change::Add(std::move(additions)));
+  }
+
+  std::optional<Change::Cull> cull;
+  if (patch.cull())
+    cull = *patch.cull();
+
+  return rmf_traffic::schedule::Patch(
+    std::move(participants),
+    std::move(cull),
+    patch.base_version(),
+    patch.latest_version());
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
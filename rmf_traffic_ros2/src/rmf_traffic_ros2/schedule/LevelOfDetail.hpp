@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__LEVELOFDETAIL_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__LEVELOFDETAIL_HPP
+
+#include <rmf_traffic/Trajectory.hpp>
+#include <rmf_traffic/schedule/Patch.hpp>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Drop the waypoints of a trajectory that lie within tolerance meters of
+/// where the robot would be, at the same time, moving in a straight line
+/// between the waypoints that are kept. The first and last waypoints are
+/// always kept, and the kept waypoints are not changed, so the result is only
+/// meant for drawing and monitoring, not for planning or conflict checks.
+rmf_traffic::Trajectory decimate(
+  const rmf_traffic::Trajectory& trajectory,
+  double tolerance);
+
+//==============================================================================
+/// Decimate the trajectory of every route that a patch adds. Everything else
+/// about the patch stays the same, so a mirror that only ever receives
+/// decimated patches stays consistent with the schedule.
+rmf_traffic::schedule::Patch decimate(
+  const rmf_traffic::schedule::Patch& patch,
+  double tolerance);
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__LEVELOFDETAIL_HPP
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__LOANEDPUBLISH_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__LOANEDPUBLISH_HPP
+
+#include <rclcpp/publisher.hpp>
+
+#include <utility>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Publish msg through memory loaned from the middleware when the RMW can loan
+/// messages of this type, such as a shared-memory RMW with a bounded message
+/// layout. Subscribers on the same host then receive it without any
+/// serialization. Otherwise msg is published as usual.
+///
+/// \return true if a loaned message was used.
+template<typename Message>
+bool publish_loaned(rclcpp::Publisher<Message>& publisher, const Message& msg)
+{
+  if (publisher.can_loan_messages())
+  {
+    auto loaned = publisher.borrow_loaned_message();
+    loaned.get() = msg;
+    publisher.publish(std::move(loaned));
+    return true;
+  }
+
+  publisher.publish(msg);
+  return false;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__LOANEDPUBLISH_HPP
@@ -15,6 +15,7 @@
  *
 */
 
+#include <atomic>
 #include <chrono>
 
 #include <rclcpp/logger.hpp>
@@ -23,11 +24,20 @@
 #include <rmf_utils/Modular.hpp>
 
 #include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/Timer.hpp>
 #include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
 #include <rmf_traffic_ros2/schedule/MirrorManager.hpp>
 #include <rmf_traffic_ros2/schedule/Patch.hpp>
 #include <rmf_traffic_ros2/schedule/Query.hpp>
 
+#include "CompactMirrorUpdate.hpp"
+#include "MirrorSync.hpp"
+#include "ParticipantDescriptionCache.hpp"
+#include "ParticipantsDelta.hpp"
+#include "PatchBatch.hpp"
+#include "ReconnectBackoff.hpp"
+#include "ScheduleShards.hpp"
+
 #include <rmf_traffic_msgs/msg/mirror_update.hpp>
 #include <rmf_traffic_msgs/msg/participant.hpp>
 #include <rmf_traffic_msgs/msg/participants.hpp>
@@ -39,6 +49,8 @@
 #include <rmf_traffic_msgs/srv/register_query.hpp>
 #include <rmf_traffic_msgs/srv/request_changes.hpp>
 
+#include <std_msgs/msg/u_int8_multi_array.hpp>
+
 using namespace std::chrono_literals;
 
 namespace rmf_traffic_ros2 {
@@ -51,6 +63,9 @@ using ParticipantsInfoSub = rclcpp::Subscription<ParticipantsInfo>::SharedPtr;
 using MirrorUpdate = rmf_traffic_msgs::msg::MirrorUpdate;
 using MirrorUpdateSub = rclcpp::Subscription<MirrorUpdate>::SharedPtr;
 
+using CompactUpdate = std_msgs::msg::UInt8MultiArray;
+using CompactUpdateSub = rclcpp::Subscription<CompactUpdate>::SharedPtr;
+
 using RequestChanges = rmf_traffic_msgs::srv::RequestChanges;
 using RequestChangesFuture = rclcpp::Client<RequestChanges>::SharedFuture;
 using RequestChangesClient = rclcpp::Client<RequestChanges>::SharedPtr;
@@ -70,6 +85,28 @@ bool is_new_version(const uint64_t expected_version, const uint64_t msg_version)
 {
   return rmf_utils::modular(expected_version).less_than(msg_version);
 }
+
+//==============================================================================
+/// Hands out the last snapshot that was published by a double-buffered
+/// MirrorManager. Swapping in a new snapshot is atomic, so readers never wait
+/// for a patch to be applied.
+class SnapshotBuffer : public rmf_traffic::schedule::Snappable
+{
+public:
+
+  std::shared_ptr<const rmf_traffic::schedule::Snapshot> snapshot() const final
+  {
+    return std::atomic_load(&_front);
+  }
+
+  void publish(std::shared_ptr<const rmf_traffic::schedule::Snapshot> front)
+  {
+    std::atomic_store(&_front, std::move(front));
+  }
+
+private:
+  std::shared_ptr<const rmf_traffic::schedule::Snapshot> _front;
+};
 }
 
 //==============================================================================
@@ -86,19 +123,44 @@ public:
   Options options;
   FailOverEventSub fail_over_event_sub;
   MirrorUpdateSub mirror_update_sub;
+  CompactUpdateSub compact_update_sub;
   ParticipantsInfoSub participants_info_sub;
+  ParticipantDescriptionCache participants_info_cache;
+  CompactUpdateSub participants_delta_sub;
+  ParticipantsDeltaTracker participants_tracker;
   rclcpp::Subscription<ScheduleQueries>::SharedPtr queries_info_sub;
   RequestChangesClient request_changes_client;
   rclcpp::TimerBase::SharedPtr update_timer;
   rclcpp::TimerBase::SharedPtr redo_query_registration_timer;
   RegisterQueryClient register_query_client;
 
+  // Every mirror redoes its query registration at about the same time after a
+  // fail over, so each one waits for a random delay before it does
+  std::optional<ReconnectBackoff> registration_backoff;
+
   std::shared_ptr<rmf_traffic::schedule::Mirror> mirror;
 
+  // This will be a nullptr unless the double_buffered option is turned on
+  std::shared_ptr<SnapshotBuffer> snapshot_buffer;
+
   bool initial_update = true;
 
   rmf_traffic::schedule::Version next_minimum_version = 0;
 
+  // The state of a sync transfer while the mirror is joining
+  struct SnapshotSync
+  {
+    CompactUpdateSub sub;
+    rclcpp::TimerBase::SharedPtr request_timer;
+    std::optional<uint64_t> transfer_id;
+    uint32_t expected_chunks = 0;
+    uint32_t received_chunks = 0;
+    std::vector<rmf_traffic::schedule::Patch::Participant> participants;
+    std::optional<rmf_traffic::schedule::Change::Cull> cull;
+  };
+  std::optional<SnapshotSync> sync;
+  RequestChangesClient request_sync_client;
+
   Implementation(
     rclcpp::Node& _node,
     rmf_traffic::schedule::Query _query,
@@ -110,25 +172,251 @@ public:
     options(std::move(_options)),
     mirror(std::make_shared<rmf_traffic::schedule::Mirror>())
   {
+    update_snapshot_buffer();
     setup_update_topics();
     setup_queries_sub();
 
     request_changes_client = node.create_client<RequestChanges>(
-      rmf_traffic_ros2::RequestChangesServiceName);
+      shard_name(rmf_traffic_ros2::RequestChangesServiceName));
+
+    const auto jitter = get_fail_over_jitter(node);
+    registration_backoff.emplace(
+      jitter, 8*std::max<std::chrono::nanoseconds>(jitter, 100ms));
 
     fail_over_event_sub = node.create_subscription<FailOverEvent>(
-      rmf_traffic_ros2::FailOverEventTopicName,
+      shard_name(rmf_traffic_ros2::FailOverEventTopicName),
       rclcpp::SystemDefaultsQoS(),
       [&](const FailOverEvent::SharedPtr msg)
       {
         handle_fail_over_event(msg->new_schedule_node_version);
       });
+
+    if (options.snapshot_sync())
+      start_snapshot_sync();
+  }
+
+  std::string shard_name(const std::string& name) const
+  {
+    return shard_topic_name(options.shard(), name);
+  }
+
+  void start_snapshot_sync()
+  {
+    if (!request_sync_client)
+    {
+      request_sync_client = node.create_client<RequestChanges>(
+        shard_name(rmf_traffic_ros2::RequestSyncServiceName));
+    }
+
+    sync.emplace();
+    sync->sub = node.create_subscription<CompactUpdate>(
+      shard_name(
+        QueryUpdateTopicNameBase + std::to_string(query_id)
+        + QuerySyncTopicSuffix),
+      rclcpp::QoS(rclcpp::KeepAll()).reliable(),
+      [&](const CompactUpdate::SharedPtr msg)
+      {
+        handle_sync_chunk(*msg);
+      });
+
+    // The request has to wait until our subscription has been matched with
+    // the schedule node, otherwise the transfer would pass us by.
+    sync->request_timer = rmf_traffic_ros2::create_timer(
+      node,
+      100ms,
+      [&]() -> void
+      {
+        send_sync_request();
+      });
+  }
+
+  void send_sync_request()
+  {
+    if (!sync)
+      return;
+
+    if (!request_sync_client->service_is_ready()
+      || sync->sub->get_publisher_count() == 0)
+    {
+      // Keep waiting. If this takes too long, handle_update_timeout() will
+      // fall back to a regular update.
+      return;
+    }
+
+    sync->request_timer.reset();
+
+    RequestChanges::Request request;
+    request.query_id = query_id;
+    request.version = 0;
+    request.full_update = true;
+    RCLCPP_INFO(
+      node.get_logger(),
+      "[rmf_traffic_ros2::MirrorManager::send_sync_request] Requesting sync "
+      "transfer for query ID [%ld]",
+      request.query_id);
+
+    request_sync_client->async_send_request(
+      std::make_shared<RequestChanges::Request>(request),
+      [&](const RequestChangesFuture response)
+      {
+        auto value = *response.get();
+        if (value.result == RequestChanges::Response::UNKNOWN_QUERY_ID)
+        {
+          sync.reset();
+          redo_query_registration();
+        }
+      });
+  }
+
+  void handle_sync_chunk(const CompactUpdate& msg)
+  {
+    if (!sync)
+      return;
+
+    SyncChunk chunk;
+    try
+    {
+      chunk = decode_sync_chunk(msg.data);
+    }
+    catch (const SyncDecodeError& e)
+    {
+      abandon_snapshot_sync(e.what());
+      return;
+    }
+
+    if (!sync->transfer_id.has_value())
+    {
+      // Latch onto the first transfer that we see the beginning of. It may
+      // have been requested by another mirror that is joining, but its
+      // content is just as good for us.
+      if (chunk.index != 0)
+        return;
+
+      sync->transfer_id = chunk.transfer_id;
+      sync->expected_chunks = chunk.count;
+    }
+    else if (*sync->transfer_id != chunk.transfer_id)
+    {
+      return;
+    }
+
+    if (chunk.index != sync->received_chunks)
+    {
+      abandon_snapshot_sync("A chunk of the transfer went missing");
+      return;
+    }
+
+    try
+    {
+      const auto patch = convert(chunk.update.patch);
+      if (patch.cull())
+        sync->cull = *patch.cull();
+
+      for (const auto& p : patch)
+        sync->participants.push_back(p);
+    }
+    catch (const std::exception& e)
+    {
+      abandon_snapshot_sync(e.what());
+      return;
+    }
+
+    ++sync->received_chunks;
+    if (sync->received_chunks < sync->expected_chunks)
+      return;
+
+    const rmf_traffic::schedule::Patch patch(
+      std::move(sync->participants),
+      std::move(sync->cull),
+      std::nullopt,
+      chunk.update.patch.latest_version);
+    sync.reset();
+
+    if (is_new_version(expected_node_version, chunk.update.node_version))
+      expected_node_version = chunk.update.node_version;
+
+    bool updated = false;
+    change_mirror(
+      [&](rmf_traffic::schedule::Mirror& m)
+      {
+        updated = m.update(patch);
+      });
+
+    if (updated && options.on_patch())
+      options.on_patch()(patch);
+
+    RCLCPP_INFO(
+      node.get_logger(),
+      "[rmf_traffic_ros2::MirrorManager] Finished sync transfer of %lu "
+      "participants at version [%ld]",
+      patch.size(),
+      patch.latest_version());
+
+    // Hand off to incremental updates. Anything that changed while the
+    // transfer was in flight will be sent as a small remedial update.
+    update_timer->reset();
+    request_update(mirror->latest_version());
+  }
+
+  void abandon_snapshot_sync(const std::string& reason)
+  {
+    RCLCPP_WARN(
+      node.get_logger(),
+      "[rmf_traffic_ros2::MirrorManager] Abandoning sync transfer for query "
+      "ID [%ld]: %s. Falling back to a full update.",
+      query_id,
+      reason.c_str());
+
+    sync.reset();
+    request_update();
+  }
+
+  // Create or drop the snapshot buffer to match the current options
+  void update_snapshot_buffer()
+  {
+    if (!options.double_buffered())
+    {
+      snapshot_buffer.reset();
+      return;
+    }
+
+    if (!snapshot_buffer)
+    {
+      snapshot_buffer = std::make_shared<SnapshotBuffer>();
+      snapshot_buffer->publish(mirror->snapshot());
+    }
+  }
+
+  // Apply a change to the mirror. When double buffered, nobody else can see
+  // the mirror itself, so the change is made without the update mutex and is
+  // then published as a new snapshot. Otherwise the update mutex, if there is
+  // one, is held while the change is made.
+  template<typename Change>
+  void change_mirror(const Change& change)
+  {
+    if (snapshot_buffer)
+    {
+      change(*mirror);
+      snapshot_buffer->publish(mirror->snapshot());
+      return;
+    }
+
+    std::mutex* update_mutex = options.update_mutex();
+    if (update_mutex)
+    {
+      std::lock_guard<std::mutex> lock(*update_mutex);
+      change(*mirror);
+    }
+    else
+    {
+      change(*mirror);
+    }
   }
 
   void setup_queries_sub()
   {
     queries_info_sub = node.create_subscription<ScheduleQueries>(
-      rmf_traffic_ros2::QueriesInfoTopicName,
+      shard_name(rmf_traffic_ros2::QueriesInfoTopicName),
       rclcpp::SystemDefaultsQoS().reliable().keep_last(100).transient_local(),
       [=](const ScheduleQueries::SharedPtr msg)
       {
@@ -199,28 +487,75 @@ public:
 
   void setup_update_topics()
   {
-    participants_info_sub = node.create_subscription<ParticipantsInfo>(
-      ParticipantsInfoTopicName,
-      rclcpp::SystemDefaultsQoS().reliable().keep_last(100).transient_local(),
-      [&](const ParticipantsInfo::SharedPtr msg)
-      {
-        handle_participants_info(msg);
-      });
+    if (options.participant_deltas())
+    {
+      participants_delta_sub = node.create_subscription<CompactUpdate>(
+        shard_name(ParticipantsDeltaTopicName),
+        rclcpp::SystemDefaultsQoS().reliable().keep_last(100)
+        .transient_local(),
+        [&](const CompactUpdate::SharedPtr msg)
+        {
+          handle_participants_delta(*msg);
+        });
+    }
+    else
+    {
+      participants_info_sub = node.create_subscription<ParticipantsInfo>(
+        shard_name(ParticipantsInfoTopicName),
+        rclcpp::SystemDefaultsQoS().reliable().keep_last(100)
+        .transient_local(),
+        [&](const ParticipantsInfo::SharedPtr msg)
+        {
+          handle_participants_info(msg);
+        });
+    }
+
+    std::string update_topic =
+      QueryUpdateTopicNameBase + std::to_string(query_id);
+    if (!options.compact_updates() && options.update_period())
+    {
+      update_topic += (options.level_of_detail() ?
+        QueryLevelOfDetailTopicSuffix : QueryRateClassTopicSuffix)
+        + std::to_string(options.update_period()->count());
+    }
+    update_topic = shard_name(update_topic);
 
     RCLCPP_DEBUG(node.get_logger(), "Registering to query topic %s",
-      (QueryUpdateTopicNameBase + std::to_string(query_id)).c_str());
-    mirror_update_sub = node.create_subscription<MirrorUpdate>(
-      QueryUpdateTopicNameBase + std::to_string(query_id),
-      rclcpp::SystemDefaultsQoS(),
-      [&, qid = query_id](const MirrorUpdate::SharedPtr msg)
-      {
-        handle_update(msg);
-      });
+      update_topic.c_str());
+    if (options.compact_updates())
+    {
+      compact_update_sub = node.create_subscription<CompactUpdate>(
+        shard_name(
+          QueryUpdateTopicNameBase + std::to_string(query_id)
+          + CompactQueryUpdateTopicSuffix),
+        rclcpp::SystemDefaultsQoS(),
+        [&](const CompactUpdate::SharedPtr msg)
+        {
+          if (!options.batch_updates())
+            return handle_compact_update(*msg);
+
+          handle_updates(take_waiting_compact_updates(*msg));
+        });
+    }
+    else
+    {
+      mirror_update_sub = node.create_subscription<MirrorUpdate>(
+        update_topic,
+        rclcpp::SystemDefaultsQoS(),
+        [&, qid = query_id](const MirrorUpdate::SharedPtr msg)
+        {
+          if (!options.batch_updates())
+            return handle_update(msg);
+
+          handle_updates(take_waiting_updates(msg));
+        });
+    }
     // At this point we know we have the correct ID for our query
     require_query_validation = false;
     process_stashed_queries();
 
-    update_timer = node.create_wall_timer(
+    update_timer = rmf_traffic_ros2::create_timer(
+      node,
       5s,
       [&]() -> void
       {
@@ -232,22 +567,57 @@ public:
   {
     try
     {
-      std::mutex* update_mutex = options.update_mutex();
-      if (update_mutex)
-      {
-        std::lock_guard<std::mutex> lock(*update_mutex);
-        mirror->update_participants_info(convert(*msg));
-      }
-      else
+      const auto info = participants_info_cache.convert(*msg);
+      change_mirror(
+        [&](rmf_traffic::schedule::Mirror& m)
+        {
+          m.update_participants_info(info);
+        });
+
+      if (options.on_participants())
+        options.on_participants()();
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_ERROR(
+        node.get_logger(),
+        "[rmf_traffic_ros2::MirrorManager] Failed to update participant info: %s",
+        e.what());
+    }
+  }
+
+  void handle_participants_delta(const CompactUpdate& msg)
+  {
+    try
+    {
+      const auto delta = decode_participants_delta(msg.data);
+      if (!participants_tracker.apply(delta))
       {
-        mirror->update_participants_info(convert(*msg));
+        // The mirror keeps the participants that it already has until the
+        // next resync arrives.
+        RCLCPP_DEBUG(
+          node.get_logger(),
+          "Missed a participants delta before version %lu; waiting for a "
+          "resync",
+          delta.version);
+        return;
       }
+
+      change_mirror(
+        [&](rmf_traffic::schedule::Mirror& m)
+        {
+          m.update_participants_info(participants_tracker.participants());
+        });
+
+      if (options.on_participants())
+        options.on_participants()();
     }
     catch (const std::exception& e)
     {
       RCLCPP_ERROR(
         node.get_logger(),
-        "[rmf_traffic_ros2::MirrorManager] Failed to update participant info: %s",
+        "[rmf_traffic_ros2::MirrorManager] Failed to apply participants "
+        "delta: %s",
         e.what());
     }
   }
@@ -276,10 +646,173 @@ public:
     stashed_query_updates.clear();
   }
 
-  void handle_update(const MirrorUpdate::SharedPtr msg)
+  /// Returns a nullptr if the update could not be decoded, in which case a
+  /// full update has already been requested.
+  MirrorUpdate::SharedPtr decode_compact_update(const CompactUpdate& msg)
   {
+    try
+    {
+      return std::make_shared<MirrorUpdate>(
+        decode_compact_mirror_update(msg.data));
+    }
+    catch (const CompactDecodeError& e)
+    {
+      RCLCPP_ERROR(
+        node.get_logger(),
+        "[rmf_traffic_ros2::MirrorManager] Failed to decode a compact mirror "
+        "update: %s",
+        e.what());
+
+      request_update();
+      return nullptr;
+    }
+  }
+
+  void handle_compact_update(const CompactUpdate& msg)
+  {
+    if (auto update = decode_compact_update(msg))
+      handle_update(std::move(update));
+  }
+
+  // The most updates that are applied in one pass when batch_updates is on,
+  // so that a flood of updates cannot starve the other callbacks of the node
+  static constexpr std::size_t MaxBatchedUpdates = 100;
+
+  std::vector<MirrorUpdate::SharedPtr> take_waiting_updates(
+    MirrorUpdate::SharedPtr first)
+  {
+    std::vector<MirrorUpdate::SharedPtr> updates;
+    updates.push_back(std::move(first));
+
+    rclcpp::MessageInfo info;
+    while (updates.size() < MaxBatchedUpdates)
+    {
+      auto next = std::make_shared<MirrorUpdate>();
+      if (!mirror_update_sub->take(*next, info))
+        break;
+
+      updates.push_back(std::move(next));
+    }
+
+    return updates;
+  }
+
+  std::vector<MirrorUpdate::SharedPtr> take_waiting_compact_updates(
+    const CompactUpdate& first)
+  {
+    std::vector<MirrorUpdate::SharedPtr> updates;
+    if (auto update = decode_compact_update(first))
+      updates.push_back(std::move(update));
+
+    rclcpp::MessageInfo info;
+    CompactUpdate next;
+    std::size_t taken = 1;
+    while (taken < MaxBatchedUpdates && compact_update_sub->take(next, info))
+    {
+      ++taken;
+      if (auto update = decode_compact_update(next))
+        updates.push_back(std::move(update));
+    }
+
+    return updates;
+  }
+
+  void handle_update(MirrorUpdate::SharedPtr msg)
+  {
+    handle_updates({std::move(msg)});
+  }
+
+  /// Apply a run of updates in the order that they arrived. The patches are
+  /// converted first, and then all of them are applied within one change to
+  /// the mirror.
+  void handle_updates(const std::vector<MirrorUpdate::SharedPtr>& msgs)
+  {
+    if (sync)
+    {
+      // Incremental updates cannot be applied until the sync transfer has
+      // given us a base to apply them to. Whatever we miss here will be
+      // requested when the transfer is finished.
+      return;
+    }
+
+    if (msgs.empty())
+      return;
+
     update_timer->reset();
 
+    PatchBatch batch;
+    for (const auto& msg : msgs)
+    {
+      if (!accept_update(msg))
+        continue;
+
+      try
+      {
+        batch.add(convert(msg->patch), msg->is_remedial_update);
+      }
+      catch (const std::exception& e)
+      {
+        RCLCPP_ERROR(
+          node.get_logger(),
+          "[rmf_traffic_ros2::MirrorManager] Failed to deserialize Patch "
+          "message: %s",
+          e.what());
+
+        // Get a full update in case we're just missing some information.
+        // Only one update gets requested for the whole run, since the rest of
+        // the run would only ask for the same thing.
+        if (batch.claim_request())
+          request_update();
+      }
+    }
+
+    if (batch.empty())
+      return;
+
+    try
+    {
+      change_mirror(
+        [&](rmf_traffic::schedule::Mirror& m)
+        {
+          batch.apply(m);
+        });
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_ERROR(
+        node.get_logger(),
+        "[rmf_traffic_ros2::MirrorManager] Failed to apply Patch: %s",
+        e.what());
+
+      if (batch.claim_request())
+        request_update();
+
+      return;
+    }
+
+    if (options.on_patch())
+    {
+      for (const auto* patch : batch.applied())
+        options.on_patch()(*patch);
+    }
+
+    const auto* failed = batch.failed();
+    if (failed && batch.claim_request())
+    {
+      RCLCPP_WARN(
+        node.get_logger(),
+        "Failed to update using patch for DB version %d; "
+        "requesting new update",
+        failed->latest_version());
+      request_update(mirror->latest_version());
+    }
+  }
+
+  /// Check that an update came from the schedule node that we expect and
+  /// that our query has been validated. Returns false if the update should
+  /// not be applied now.
+  bool accept_update(const MirrorUpdate::SharedPtr& msg)
+  {
     // Verify that the expected schedule node version sent the update
 
     if (rmf_utils::modular(expected_node_version).less_than(msg->node_version))
@@ -290,7 +823,7 @@ public:
         " ignoring update",
         msg->node_version,
         expected_node_version);
-      return;
+      return false;
     }
     else if (msg->node_version > expected_node_version)
     {
@@ -307,7 +840,7 @@ public:
     else if (msg->node_version != expected_node_version)
     {
       // Ignore this message because it's coming from an out-of-date version
-      return;
+      return false;
     }
 
     if (require_query_validation)
@@ -318,54 +851,20 @@ public:
         "Stashing suspect query for DB version %d",
         msg->patch.latest_version);
       stashed_query_updates.push_back(msg);
-      return;
+      return false;
     }
 
-    try
-    {
-      const rmf_traffic::schedule::Patch patch = convert(msg->patch);
-
-      std::mutex* update_mutex = options.update_mutex();
-      if (update_mutex)
-      {
-        std::lock_guard<std::mutex> lock(*update_mutex);
-        if (!mirror->update(patch) && !msg->is_remedial_update)
-        {
-          RCLCPP_WARN(
-            node.get_logger(),
-            "Failed to update using patch for DB version %d; "
-            "requesting new update",
-            patch.latest_version());
-          request_update(mirror->latest_version());
-        }
-      }
-      else
-      {
-        if (!mirror->update(patch) && !msg->is_remedial_update)
-        {
-          RCLCPP_WARN(
-            node.get_logger(),
-            "Failed to update using patch for DB version %d; "
-            "requesting new update",
-            patch.latest_version());
-          request_update(mirror->latest_version());
-        }
-      }
-    }
-    catch (const std::exception& e)
-    {
-      RCLCPP_ERROR(
-        node.get_logger(),
-        "[rmf_traffic_ros2::MirrorManager] Failed to deserialize Patch "
-        "message: %s",
-        e.what());
-      // Get a full update in case we're just missing some information
-      request_update();
-    }
+    return true;
   }
 
   void handle_update_timeout()
   {
+    if (sync)
+    {
+      abandon_snapshot_sync("The transfer timed out");
+      return;
+    }
+
     RCLCPP_DEBUG(node.get_logger(), "Update timed out");
     request_update(mirror->latest_version());
   }
@@ -417,14 +916,22 @@ public:
     // Make sure nothing is truly coming in on this topic and triggering a
     // callback while we are remaking it
     mirror_update_sub.reset();
+    compact_update_sub.reset();
+    sync.reset();
     // Also make sure we don't try to handle another update of queries,
     // or it might cause a particularly icky cycle of never-ending redos
     queries_info_sub.reset();
 
-    register_query_client =
-      node.create_client<RegisterQuery>(RegisterQueryServiceName);
-    redo_query_registration_timer = node.create_wall_timer(
-      100ms,
+    register_query_client = node.create_client<RegisterQuery>(
+      shard_name(RegisterQueryServiceName));
+    schedule_query_registration(0ms);
+  }
+
+  void schedule_query_registration(std::chrono::nanoseconds minimum_delay)
+  {
+    redo_query_registration_timer = rmf_traffic_ros2::create_timer(
+      node,
+      std::max(minimum_delay, registration_backoff->next()),
       std::bind(
         &MirrorManager::Implementation::redo_query_registration_callback,
         this));
@@ -432,6 +939,9 @@ public:
 
   void redo_query_registration_callback()
   {
+    // This is a one-shot timer
+    redo_query_registration_timer->cancel();
+
     if (register_query_client->service_is_ready())
     {
       RCLCPP_DEBUG(
@@ -457,6 +967,7 @@ public:
           setup_update_topics();
           setup_queries_sub();
           this->register_query_client.reset();
+          this->registration_backoff->reset();
 
           // Finish by requesting an update on this newly subscribed query topic
           request_update();
@@ -469,6 +980,9 @@ public:
       RCLCPP_ERROR(
         node.get_logger(),
         "Failed to get query registry service");
+
+      // Try again later, backing off while the service is not available
+      schedule_query_registration(100ms);
     }
   }
 
@@ -514,6 +1028,26 @@ public:
 
   bool update_on_wakeup;
 
+  bool compact_updates = false;
+
+  bool snapshot_sync = false;
+
+  bool double_buffered = false;
+
+  bool batch_updates = false;
+
+  std::optional<std::chrono::milliseconds> update_period;
+
+  bool level_of_detail = false;
+
+  bool participant_deltas = true;
+
+  std::string shard;
+
+  PatchCallback on_patch;
+
+  std::function<void()> on_participants;
+
 };
 
 //==============================================================================
@@ -523,7 +1057,17 @@ MirrorManager::Options::Options(
 : _pimpl(rmf_utils::make_impl<Implementation>(
       Implementation{
         update_mutex,
-        update_on_wakeup
+        update_on_wakeup,
+        false,
+        false,
+        false,
+        false,
+        std::nullopt,
+        false,
+        false,
+        std::string(),
+        nullptr,
+        nullptr
       }))
 {
   // Do nothing
@@ -555,6 +1099,139 @@ auto MirrorManager::Options::update_on_wakeup(bool choice) -> Options&
   return *this;
 }
 
+//==============================================================================
+bool MirrorManager::Options::compact_updates() const
+{
+  return _pimpl->compact_updates;
+}
+
+//==============================================================================
+auto MirrorManager::Options::compact_updates(bool choice) -> Options&
+{
+  _pimpl->compact_updates = choice;
+  return *this;
+}
+
+//==============================================================================
+bool MirrorManager::Options::snapshot_sync() const
+{
+  return _pimpl->snapshot_sync;
+}
+
+//==============================================================================
+auto MirrorManager::Options::snapshot_sync(bool choice) -> Options&
+{
+  _pimpl->snapshot_sync = choice;
+  return *this;
+}
+
+//==============================================================================
+bool MirrorManager::Options::double_buffered() const
+{
+  return _pimpl->double_buffered;
+}
+
+//==============================================================================
+auto MirrorManager::Options::double_buffered(bool choice) -> Options&
+{
+  _pimpl->double_buffered = choice;
+  return *this;
+}
+
+//==============================================================================
+bool MirrorManager::Options::batch_updates() const
+{
+  return _pimpl->batch_updates;
+}
+
+//==============================================================================
+auto MirrorManager::Options::batch_updates(bool choice) -> Options&
+{
+  _pimpl->batch_updates = choice;
+  return *this;
+}
+
+//==============================================================================
+std::optional<std::chrono::milliseconds>
+MirrorManager::Options::update_period() const
+{
+  return _pimpl->update_period;
+}
+
+//==============================================================================
+auto MirrorManager::Options::update_period(
+  std::optional<std::chrono::milliseconds> period) -> Options&
+{
+  _pimpl->update_period = period;
+  return *this;
+}
+
+//==============================================================================
+bool MirrorManager::Options::level_of_detail() const
+{
+  return _pimpl->level_of_detail;
+}
+
+//==============================================================================
+auto MirrorManager::Options::level_of_detail(bool choice) -> Options&
+{
+  _pimpl->level_of_detail = choice;
+  return *this;
+}
+
+//==============================================================================
+bool MirrorManager::Options::participant_deltas() const
+{
+  return _pimpl->participant_deltas;
+}
+
+//==============================================================================
+auto MirrorManager::Options::participant_deltas(bool choice) -> Options&
+{
+  _pimpl->participant_deltas = choice;
+  return *this;
+}
+
+//==============================================================================
+const std::string& MirrorManager::Options::shard() const
+{
+  return _pimpl->shard;
+}
+
+//==============================================================================
+auto MirrorManager::Options::shard(std::string name) -> Options&
+{
+  _pimpl->shard = std::move(name);
+  return *this;
+}
+
+//==============================================================================
+auto MirrorManager::Options::on_patch() const -> const PatchCallback&
+{
+  return _pimpl->on_patch;
+}
+
+//==============================================================================
+auto MirrorManager::Options::on_patch(PatchCallback callback) -> Options&
+{
+  _pimpl->on_patch = std::move(callback);
+  return *this;
+}
+
+//==============================================================================
+const std::function<void()>& MirrorManager::Options::on_participants() const
+{
+  return _pimpl->on_participants;
+}
+
+//==============================================================================
+auto MirrorManager::Options::on_participants(
+  std::function<void()> callback) -> Options&
+{
+  _pimpl->on_participants = std::move(callback);
+  return *this;
+}
+
 //==============================================================================
 const rmf_traffic::schedule::Viewer& MirrorManager::viewer() const
 {
@@ -565,6 +1242,9 @@ const rmf_traffic::schedule::Viewer& MirrorManager::viewer() const
 std::shared_ptr<rmf_traffic::schedule::Snappable>
 MirrorManager::snapshot_handle() const
 {
+  if (_pimpl->snapshot_buffer)
+    return _pimpl->snapshot_buffer;
+
   return _pimpl->mirror;
 }
 
@@ -584,6 +1264,7 @@ auto MirrorManager::get_options() const -> const Options&
 MirrorManager& MirrorManager::set_options(Options options)
 {
   _pimpl->options = std::move(options);
+  _pimpl->update_snapshot_buffer();
   return *this;
 }
 
@@ -627,8 +1308,8 @@ public:
     abandon_discovery(false),
     registration_sent(false)
   {
-    register_query_client =
-      node.create_client<RegisterQuery>(RegisterQueryServiceName);
+    register_query_client = node.create_client<RegisterQuery>(
+      shard_topic_name(options.shard(), RegisterQueryServiceName));
 
     registration_future = registration_promise.get_future();
 
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "MirrorSync.hpp"
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// Each chunk is laid out as
+//   [magic: 3][format: u8][transfer: u64][index: u32][count: u32][payload]
+// where the payload is the CDR serialization of a MirrorUpdate message.
+constexpr std::array<uint8_t, 4> Header = {'R', 'M', 'S', 1};
+constexpr std::size_t PrefixSize = 20;
+
+using MirrorUpdate = rmf_traffic_msgs::msg::MirrorUpdate;
+
+//==============================================================================
+void write_uint(std::vector<uint8_t>& buffer, uint64_t value, int bytes)
+{
+  for (int i = 0; i < bytes; ++i)
+    buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+uint64_t read_uint(const uint8_t* data, int bytes)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i)
+    value |= static_cast<uint64_t>(data[i]) << (8*i);
+
+  return value;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+std::vector<rmf_traffic::schedule::Patch> split_sync_patch(
+  const rmf_traffic::schedule::Patch& patch,
+  const std::size_t participants_per_chunk)
+{
+  using Participant = rmf_traffic::schedule::Patch::Participant;
+  using Cull = rmf_traffic::schedule::Change::Cull;
+
+  const std::size_t per_chunk =
+    std::max<std::size_t>(1, participants_per_chunk);
+
+  std::vector<rmf_traffic::schedule::Patch> chunks;
+  std::vector<Participant> participants;
+  std::optional<Cull> cull;
+  if (patch.cull())
+    cull = *patch.cull();
+
+  const auto flush = [&]()
+    {
+      chunks.emplace_back(
+        std::move(participants),
+        std::move(cull),
+        patch.base_version(),
+        patch.latest_version());
+
+      participants = {};
+      cull = std::nullopt;
+    };
+
+  for (const auto& p : patch)
+  {
+    participants.push_back(p);
+    if (participants.size() >= per_chunk)
+      flush();
+  }
+
+  if (!participants.empty() || chunks.empty())
+    flush();
+
+  return chunks;
+}
+
+//==============================================================================
+std::vector<uint8_t> encode_sync_chunk(const SyncChunk& chunk)
+{
+  rclcpp::SerializedMessage serialized;
+  rclcpp::Serialization<MirrorUpdate>().serialize_message(
+    &chunk.update, &serialized);
+  const auto& raw = serialized.get_rcl_serialized_message();
+
+  std::vector<uint8_t> buffer;
+  buffer.reserve(PrefixSize + raw.buffer_length);
+  buffer.insert(buffer.end(), Header.begin(), Header.end());
+  write_uint(buffer, chunk.transfer_id, 8);
+  write_uint(buffer, chunk.index, 4);
+  write_uint(buffer, chunk.count, 4);
+  buffer.insert(buffer.end(), raw.buffer, raw.buffer + raw.buffer_length);
+
+  return buffer;
+}
+
+//==============================================================================
+SyncChunk decode_sync_chunk(const std::vector<uint8_t>& buffer)
+{
+  if (buffer.size() < PrefixSize
+    || !std::equal(Header.begin(), Header.end(), buffer.begin()))
+  {
+    throw SyncDecodeError("Buffer is not a mirror sync chunk");
+  }
+
+  SyncChunk chunk;
+  chunk.transfer_id = read_uint(buffer.data() + 4, 8);
+  chunk.index = static_cast<uint32_t>(read_uint(buffer.data() + 12, 4));
+  chunk.count = static_cast<uint32_t>(read_uint(buffer.data() + 16, 4));
+  if (chunk.index >= chunk.count)
+    throw SyncDecodeError("Invalid index in mirror sync chunk");
+
+  const std::size_t size = buffer.size() - PrefixSize;
+  rclcpp::SerializedMessage serialized(size);
+  auto& raw = serialized.get_rcl_serialized_message();
+  std::memcpy(raw.buffer, buffer.data() + PrefixSize, size);
+  raw.buffer_length = size;
+
+  try
+  {
+    rclcpp::Serialization<MirrorUpdate>().deserialize_message(
+      &serialized, &chunk.update);
+  }
+  catch (const std::exception& e)
+  {
+    throw SyncDecodeError(
+      std::string("Malformed mirror sync chunk payload: ") + e.what());
+  }
+
+  return chunk;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
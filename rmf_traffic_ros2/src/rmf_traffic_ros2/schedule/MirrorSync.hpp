@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__MIRRORSYNC_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__MIRRORSYNC_HPP
+
+#include <rmf_traffic/schedule/Patch.hpp>
+
+#include <rmf_traffic_msgs/msg/mirror_update.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// One piece of the full state of a query, sent to a mirror that is joining.
+/// All the chunks of one transfer share a transfer_id and a database version,
+/// and are published in order of their index.
+struct SyncChunk
+{
+  uint64_t transfer_id = 0;
+  uint32_t index = 0;
+  uint32_t count = 0;
+  rmf_traffic_msgs::msg::MirrorUpdate update;
+};
+
+//==============================================================================
+/// Thrown when a sync chunk buffer cannot be decoded.
+class SyncDecodeError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+/// Split a full patch into patches of at most participants_per_chunk
+/// participants each. The cull, if any, is carried by the first patch. This
+/// always returns at least one patch, even if there are no participants.
+std::vector<rmf_traffic::schedule::Patch> split_sync_patch(
+  const rmf_traffic::schedule::Patch& patch,
+  std::size_t participants_per_chunk);
+
+//==============================================================================
+std::vector<uint8_t> encode_sync_chunk(const SyncChunk& chunk);
+
+//==============================================================================
+/// This will throw a SyncDecodeError if the buffer is malformed.
+SyncChunk decode_sync_chunk(const std::vector<uint8_t>& buffer);
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__MIRRORSYNC_HPP
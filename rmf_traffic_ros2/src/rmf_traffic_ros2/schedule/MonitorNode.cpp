@@ -22,6 +22,8 @@
 #include <rmf_traffic_ros2/StandardNames.hpp>
 #include <rmf_traffic_ros2/schedule/Query.hpp>
 
+#include <rmf_traffic/schedule/Mirror.hpp>
+
 #include <rclcpp/executors.hpp>
 
 namespace rmf_traffic_ros2 {
@@ -47,6 +49,12 @@ MonitorNode::MonitorNode(
   setup();
 }
 
+//==============================================================================
+MonitorNode::~MonitorNode()
+{
+  stop_standby_executor();
+}
+
 //==============================================================================
 void MonitorNode::setup()
 {
@@ -56,14 +64,42 @@ void MonitorNode::setup()
   heartbeat_period = std::chrono::milliseconds(
     get_parameter("heartbeat_period").as_int());
 
+  // Lease duration, in milliseconds, after which the primary node is declared
+  // dead. This must be at least the heartbeat_lease_duration of the primary
+  // node. Use 0 to match the heartbeat_period.
+  declare_parameter<int>("heartbeat_lease_duration", 0);
+  const auto lease_param = get_parameter("heartbeat_lease_duration").as_int();
+  heartbeat_lease_duration = lease_param > 0 ?
+    std::chrono::milliseconds(lease_param) : heartbeat_period;
+
   // Version number to use for the replacement schedule node.
   // The default is 1, given the original schedule node starts with 0
   declare_parameter<int>("next_version", 1);
   next_schedule_node_version = get_parameter("next_version").as_int();
 
+  // When this is true, the replacement schedule node will be set up in
+  // advance and follow the schedule so that it can take over as soon as the
+  // primary node dies
+  declare_parameter<bool>("hot_standby", false);
+  hot_standby = get_parameter("hot_standby").as_bool();
+
+  // When this is true, the schedule is rebuilt from a log of the itinerary
+  // messages instead of a mirror of the whole schedule
+  declare_parameter<bool>("replication_log_standby", false);
+  log_standby = get_parameter("replication_log_standby").as_bool();
+
+  // Period, in milliseconds, for folding the replication log into its
+  // snapshot of the schedule
+  declare_parameter<int>("replication_compact_period", 10000);
+  replication_compact_period = std::chrono::milliseconds(
+    get_parameter("replication_compact_period").as_int());
+
   start_heartbeat_listener();
   start_fail_over_event_broadcaster();
   start_data_synchronisers();
+
+  if (log_standby)
+    start_replication_log();
 }
 
 //==============================================================================
@@ -71,7 +107,7 @@ void MonitorNode::start_heartbeat_listener()
 {
   heartbeat_qos_profile
   .liveliness(RMW_QOS_POLICY_LIVELINESS_AUTOMATIC)
-  .liveliness_lease_duration(heartbeat_period);
+  .liveliness_lease_duration(heartbeat_lease_duration);
 
   heartbeat_sub_options.event_callbacks.liveliness_callback =
     [this](rclcpp::QOSLivelinessChangedInfo& event) -> void
@@ -102,8 +138,7 @@ void MonitorNode::start_heartbeat_listener()
         RCLCPP_ERROR(
           get_logger(),
           "Detected death of primary schedule node");
-        on_fail_over_callback(create_new_schedule_node());
-        announce_fail_over();
+        fail_over();
       }
     };
   heartbeat_sub = create_subscription<Heartbeat>(
@@ -112,16 +147,18 @@ void MonitorNode::start_heartbeat_listener()
     [this](const typename Heartbeat::SharedPtr msg) -> void
     {
       (void) msg;
-      RCLCPP_INFO(
+      // A manual heartbeat arrives several times per lease, so this would
+      // flood the log at the info level.
+      RCLCPP_DEBUG(
         get_logger(),
         "Received heartbeat from primary schedule node");
     },
     heartbeat_sub_options);
   RCLCPP_INFO(
     get_logger(),
-    "Set up heartbeat listener on %s with liveliness lease duration of %d ms",
+    "Set up heartbeat listener on %s with liveliness lease duration of %ld ms",
     heartbeat_sub->get_topic_name(),
-    heartbeat_period);
+    heartbeat_lease_duration.count());
 }
 
 //==============================================================================
@@ -176,18 +213,211 @@ void MonitorNode::start_data_synchronisers()
     });
 }
 
+//==============================================================================
+template<typename Msg>
+void MonitorNode::follow_itinerary_topic(
+  const std::string& topic,
+  const rclcpp::QoS& qos)
+{
+  itinerary_subs.push_back(
+    create_subscription<Msg>(
+      topic, qos,
+      [=](typename Msg::UniquePtr msg)
+      {
+        replication_log.record(std::move(*msg));
+      }));
+}
+
+//==============================================================================
+void MonitorNode::start_replication_log()
+{
+  // The full set of participants is only published at each resync, so the
+  // deltas are followed to learn about new participants right away.
+  participants_delta_sub = create_subscription<ScheduleNode::CompactUpdate>(
+    rmf_traffic_ros2::ParticipantsDeltaTopicName,
+    rclcpp::SystemDefaultsQoS().reliable()
+    .keep_last(2*ScheduleNode::ParticipantsResyncInterval).transient_local(),
+    [=](ScheduleNode::CompactUpdate::UniquePtr msg)
+    {
+      try
+      {
+        if (!participants_tracker.apply(decode_participants_delta(msg->data)))
+          return;
+      }
+      catch (const ParticipantsDeltaDecodeError& e)
+      {
+        RCLCPP_ERROR(
+          get_logger(),
+          "[MonitorNode::start_replication_log] Failed to decode a "
+          "participants delta: %s", e.what());
+        return;
+      }
+
+      participants = participants_tracker.participants();
+      replication_log.participants(participants);
+    });
+
+  // These are the same topics that the schedule node takes its itinerary
+  // changes from.
+  const auto itinerary_qos =
+    rclcpp::SystemDefaultsQoS()
+    .reliable()
+    .keep_last(100);
+
+  using namespace rmf_traffic_msgs::msg;
+  follow_itinerary_topic<ItinerarySet>(
+    rmf_traffic_ros2::ItinerarySetTopicName, itinerary_qos);
+  follow_itinerary_topic<ItineraryExtend>(
+    rmf_traffic_ros2::ItineraryExtendTopicName, itinerary_qos);
+  follow_itinerary_topic<ItineraryDelay>(
+    rmf_traffic_ros2::ItineraryDelayTopicName, itinerary_qos);
+  follow_itinerary_topic<ItineraryErase>(
+    rmf_traffic_ros2::ItineraryEraseTopicName, itinerary_qos);
+  follow_itinerary_topic<ItineraryClear>(
+    rmf_traffic_ros2::ItineraryClearTopicName, itinerary_qos);
+
+  itinerary_subs.push_back(
+    create_subscription<ScheduleNode::CompactUpdate>(
+      rmf_traffic_ros2::ItineraryBatchTopicName,
+      itinerary_qos,
+      [=](ScheduleNode::CompactUpdate::UniquePtr msg)
+      {
+        try
+        {
+          for (auto& m : decode_itinerary_batch(msg->data))
+            replication_log.record(std::move(m));
+        }
+        catch (const ItineraryBatchError& e)
+        {
+          RCLCPP_ERROR(
+            get_logger(),
+            "[MonitorNode::start_replication_log] Failed to decode a batch: "
+            "%s", e.what());
+        }
+      }));
+
+  replication_compact_timer = create_wall_timer(
+    replication_compact_period,
+    [=]()
+    {
+      replication_log.compact();
+    });
+
+  RCLCPP_INFO(
+    get_logger(),
+    "Following the schedule with a replication log that is compacted every "
+    "%ld ms", replication_compact_period.count());
+}
+
+//==============================================================================
+std::shared_ptr<Database> MonitorNode::make_database()
+{
+  if (!log_standby)
+    return std::make_shared<Database>(mirror.value().fork());
+
+  replication_log.compact();
+
+  // A mirror that only knows the participants gives us a database where they
+  // are registered under the same IDs as in the old schedule.
+  rmf_traffic::schedule::Mirror registrations;
+  registrations.update_participants_info(participants);
+  auto database = std::make_shared<Database>(registrations.fork());
+
+  const auto snapshot = replication_log.snapshot();
+  const auto restored = restore_schedule_snapshot(snapshot, *database);
+  RCLCPP_INFO(
+    get_logger(),
+    "Restored the itineraries of %lu out of %lu participants from the "
+    "replication log",
+    restored,
+    snapshot.participants.size());
+
+  return database;
+}
+
+//==============================================================================
+void MonitorNode::prepare_standby_node(std::shared_ptr<Database> database)
+{
+  // The standby has the same name as the primary node, so its parameter
+  // services are only started once it has been promoted.
+  standby_node = std::make_shared<ScheduleNode>(
+    next_schedule_node_version,
+    std::move(database),
+    rclcpp::NodeOptions()
+    .context(get_node_options().context())
+    .start_parameter_services(false)
+    .start_parameter_event_publisher(false),
+    ScheduleNode::no_automatic_setup);
+  standby_node->setup_standby(registered_queries);
+
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = get_node_options().context();
+  standby_executor =
+    std::make_shared<rclcpp::executors::SingleThreadedExecutor>(
+    executor_options);
+  standby_executor->add_node(standby_node);
+
+  // spin_once is used instead of spin so that a cancel() that arrives before
+  // the thread gets going is not lost
+  standby_quit = false;
+  standby_thread = std::thread(
+    [this, executor = standby_executor,
+    context = get_node_options().context()]()
+    {
+      while (!standby_quit && rclcpp::ok(context))
+        executor->spin_once(100ms);
+    });
+
+  RCLCPP_INFO(
+    get_logger(),
+    "Prepared hot standby schedule node with version %d",
+    next_schedule_node_version);
+}
+
+//==============================================================================
+void MonitorNode::stop_standby_executor()
+{
+  if (!standby_executor)
+    return;
+
+  standby_quit = true;
+  standby_executor->cancel();
+  if (standby_thread.joinable())
+    standby_thread.join();
+
+  if (standby_node)
+    standby_executor->remove_node(standby_node);
+
+  standby_executor.reset();
+}
+
 //==============================================================================
 std::shared_ptr<rclcpp::Node> MonitorNode::create_new_schedule_node()
 {
-  auto database = std::make_shared<Database>(mirror.value().fork());
+  if (standby_node)
+  {
+    // Whoever receives the node will spin it from now on
+    stop_standby_executor();
+    auto node = std::move(standby_node);
+    node->promote(registered_queries);
+    return node;
+  }
+
   auto node = std::make_shared<rmf_traffic_ros2::schedule::ScheduleNode>(
     next_schedule_node_version,
-    database,
+    make_database(),
     registered_queries,
     rclcpp::NodeOptions());
   return node;
 }
 
+//==============================================================================
+void MonitorNode::fail_over()
+{
+  on_fail_over_callback(create_new_schedule_node());
+  announce_fail_over();
+}
+
 //==============================================================================
 std::shared_ptr<rclcpp::Node> make_monitor_node(
   std::function<void(std::shared_ptr<rclcpp::Node>)> callback,
@@ -211,7 +441,27 @@ std::shared_ptr<rclcpp::Node> make_monitor_node(
       RCLCPP_INFO(
         node->get_logger(),
         "Got mirror for monitor node");
-      node->mirror = mirror_future.get();
+
+      auto mirror = mirror_future.get();
+      if (node->hot_standby)
+      {
+        node->prepare_standby_node(
+          std::make_shared<Database>(mirror.fork()));
+      }
+
+      if (node->log_standby)
+      {
+        // The mirror is only needed for the starting point of the log, so we
+        // let it go right away.
+        node->replication_log.rebase(
+          take_schedule_snapshot(mirror.fork(), {}, 0));
+        node->replication_log.compact();
+      }
+      else
+      {
+        node->mirror = std::move(mirror);
+      }
+
       return node;
     }
   }
@@ -16,12 +16,18 @@
 */
 
 #include "NegotiationRoom.hpp"
+#include "NegotiationTopics.hpp"
+#include "ProposalDiff.hpp"
+#include "RepeatCoalescer.hpp"
+#include "TimeoutWheel.hpp"
 
 #include <rmf_traffic_ros2/Route.hpp>
 #include <rmf_traffic_ros2/schedule/Itinerary.hpp>
 #include <rmf_traffic_ros2/schedule/Negotiation.hpp>
 
 #include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/Timer.hpp>
+#include <rmf_traffic_ros2/Tracer.hpp>
 
 #include <rmf_traffic_msgs/msg/negotiation_ack.hpp>
 #include <rmf_traffic_msgs/msg/negotiation_repeat.hpp>
@@ -32,8 +38,16 @@
 #include <rmf_traffic_msgs/msg/negotiation_rejection.hpp>
 #include <rmf_traffic_msgs/msg/negotiation_conclusion.hpp>
 
+#include <std_msgs/msg/u_int8_multi_array.hpp>
+
 #include <rclcpp/logging.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
 namespace rmf_traffic_ros2 {
 namespace schedule {
 
@@ -74,7 +88,11 @@ public:
       table(table_),
       table_version(table->version()),
       parent(table->parent()),
-      parent_version(parent ? OptVersion(parent->version()) : OptVersion())
+      parent_version(parent ? OptVersion(parent->version()) : OptVersion()),
+      span(tracing::span(
+          "negotiation.respond", tracing::negotiation(conflict_version),
+          {{"rmf.participant", std::to_string(table->participant())},
+            {"rmf.depth", std::to_string(table->sequence().size())}}))
     {
       // Do nothing
     }
@@ -84,31 +102,39 @@ public:
       Args&& ... args)
     {
       auto responder = std::make_shared<Responder>(std::forward<Args>(args)...);
-      rclcpp::Node& node = responder->impl->node;
-      responder->timer = node.create_wall_timer(
-        responder->impl->timeout,
+      responder->impl->schedule_timeout(
         [r = std::weak_ptr<Responder>(responder)]()
         {
           if (auto responder = r.lock())
-          {
-            responder->timer.reset();
             responder->timeout();
-          }
         });
 
+      responder->impl->register_responder(
+        responder->conflict_version, responder->table,
+        responder->table_version, responder->cancelled);
+
       return responder;
     }
 
+    CancellationToken cancellation_token() const
+    {
+      return cancelled;
+    }
+
     void submit(
       std::vector<rmf_traffic::Route> itinerary,
       std::function<UpdateVersion()> approval_callback) const final
     {
       responded = true;
-      if (table->defunct())
+      span.attribute("rmf.outcome", "submit").end();
+      if (*cancelled || table->defunct())
         return;
 
       if (table->submit(itinerary, table_version+1))
       {
+        // Anyone still responding to our previous proposal is wasting effort
+        impl->cancel_stale_responders(conflict_version);
+
         impl->approvals[conflict_version][table] = {
           table->sequence(),
           std::move(approval_callback)
@@ -139,6 +165,10 @@ public:
     void reject(const Alternatives& alternatives) const final
     {
       responded = true;
+      span.attribute("rmf.outcome", "reject").end();
+      if (*cancelled)
+        return;
+
       if (parent && !parent->defunct())
       {
         // We will reject the parent to communicate that its proposal is not
@@ -172,19 +202,24 @@ public:
     void forfeit(const std::vector<ParticipantId>& /*blockers*/) const final
     {
       responded = true;
-      if (!table->defunct())
+      span.attribute("rmf.outcome", "forfeit").end();
+      if (!*cancelled && !table->defunct())
       {
         // TODO(MXG): Consider using blockers to invite more participants into the
         // negotiation
         table->forfeit(table_version);
         impl->publish_forfeit(conflict_version, *table);
+        impl->cancel_stale_responders(conflict_version);
       }
     }
 
     void timeout()
     {
       if (!responded)
+      {
+        span.attribute("rmf.timed_out", "true");
         forfeit({});
+      }
     }
 
     ~Responder()
@@ -204,9 +239,14 @@ public:
     const rmf_traffic::schedule::Negotiation::TablePtr parent;
     OptVersion parent_version;
 
-    rclcpp::TimerBase::SharedPtr timer;
     mutable bool responded = false;
 
+    // Raised by the Negotiation as soon as this response is no longer wanted
+    const std::shared_ptr<std::atomic_bool> cancelled =
+      std::make_shared<std::atomic_bool>(false);
+
+    // Covers the time that the negotiator takes to respond
+    mutable Tracer::Span span;
   };
 
   rclcpp::Node& node;
@@ -214,16 +254,146 @@ public:
   std::shared_ptr<Worker> worker;
   rmf_traffic::Duration timeout = std::chrono::seconds(15);
 
+  // The timeouts of all our responders share one wheel that is driven by a
+  // single timer, instead of each responder creating a timer of its own. The
+  // timer only exists while some responder is waiting. Responders may be
+  // created from the worker, so this is guarded by its own mutex.
+  std::mutex timeout_mutex;
+  TimeoutWheel timeout_wheel;
+  rclcpp::TimerBase::SharedPtr timeout_timer;
+
+  void schedule_timeout(TimeoutWheel::Callback callback)
+  {
+    std::lock_guard<std::mutex> lock(timeout_mutex);
+    timeout_wheel.schedule(
+      rmf_traffic_ros2::timer_now(node), timeout, std::move(callback));
+
+    if (!timeout_timer)
+    {
+      timeout_timer = rmf_traffic_ros2::create_timer(
+        node,
+        timeout_wheel.resolution(), [this]() { fire_timeouts(); });
+    }
+  }
+
+  void fire_timeouts()
+  {
+    std::vector<TimeoutWheel::Callback> expired;
+    {
+      std::lock_guard<std::mutex> lock(timeout_mutex);
+      expired = timeout_wheel.advance(rmf_traffic_ros2::timer_now(node));
+      if (timeout_wheel.empty() && timeout_timer)
+      {
+        timeout_timer->cancel();
+        timeout_timer.reset();
+      }
+    }
+
+    // A responder that times out may forfeit, which can create new
+    // responders, so the callbacks are triggered without holding the lock.
+    for (const auto& callback : expired)
+      callback();
+  }
+
+  using Version = rmf_traffic::schedule::Version;
+
+  // The cancellation tokens of the responders that have been handed out for
+  // each negotiation. Stale responders are cancelled as soon as we learn that
+  // their answer is no longer wanted, so their negotiators can stop planning.
+  // Responders may be created from the worker, so this is guarded by its own
+  // mutex.
+  struct RegisteredResponder
+  {
+    std::weak_ptr<rmf_traffic::schedule::Negotiation::Table> table;
+    Version table_version;
+    std::weak_ptr<std::atomic_bool> cancelled;
+  };
+  std::mutex responders_mutex;
+  std::unordered_map<Version, std::vector<RegisteredResponder>> responders;
+
+  void register_responder(
+    const Version conflict_version,
+    const rmf_traffic::schedule::Negotiation::TablePtr& table,
+    const Version table_version,
+    const std::shared_ptr<std::atomic_bool>& cancelled)
+  {
+    std::lock_guard<std::mutex> lock(responders_mutex);
+    responders[conflict_version].push_back({table, table_version, cancelled});
+  }
+
+  /// Cancel the responders of a negotiation whose tables have been forfeited,
+  /// made defunct, or moved on to a newer version.
+  void cancel_stale_responders(const Version conflict_version)
+  {
+    std::lock_guard<std::mutex> lock(responders_mutex);
+    const auto it = responders.find(conflict_version);
+    if (it == responders.end())
+      return;
+
+    auto& registered = it->second;
+    const auto stale = [](const RegisteredResponder& r) -> bool
+      {
+        const auto cancelled = r.cancelled.lock();
+        if (!cancelled)
+          return true;
+
+        const auto table = r.table.lock();
+        if (!table || table->defunct() || table->forfeited()
+          || table->version() != r.table_version)
+        {
+          *cancelled = true;
+          return true;
+        }
+
+        return false;
+      };
+
+    registered.erase(
+      std::remove_if(registered.begin(), registered.end(), stale),
+      registered.end());
+
+    if (registered.empty())
+      responders.erase(it);
+  }
+
+  /// Cancel every responder of a negotiation that has concluded.
+  void cancel_responders(const Version conflict_version)
+  {
+    std::lock_guard<std::mutex> lock(responders_mutex);
+    const auto it = responders.find(conflict_version);
+    if (it == responders.end())
+      return;
+
+    for (const auto& r : it->second)
+    {
+      if (const auto cancelled = r.cancelled.lock())
+        *cancelled = true;
+    }
+
+    responders.erase(it);
+  }
+
   using Repeat = rmf_traffic_msgs::msg::NegotiationRepeat;
   using RepeatSub = rclcpp::Subscription<Repeat>;
   using RepeatPub = rclcpp::Publisher<Repeat>;
   RepeatSub::SharedPtr repeat_sub;
   RepeatPub::SharedPtr repeat_pub;
 
+  // The repeats that we asked for, and the ones that we answered, within the
+  // last negotiation_repeat_period. These are only used by the subscription
+  // callbacks.
+  std::optional<RepeatCoalescer> requested_repeats;
+  std::optional<RepeatCoalescer> answered_repeats;
+
+  // The notices, proposals, rejections, forfeits and conclusions make up most
+  // of the negotiation traffic, so when the topics are sharded we only listen
+  // to the shards of our own negotiators.
+  std::size_t num_shards = 0;
+
   using Notice = rmf_traffic_msgs::msg::NegotiationNotice;
-  using NoticeSub = rclcpp::Subscription<Notice>;
+  using NoticeSubs = NegotiationSubscriptions<Notice>;
   using NoticePub = rclcpp::Publisher<Notice>;
-  NoticeSub::SharedPtr notice_sub;
+  std::unique_ptr<NoticeSubs> notice_subs;
   NoticePub::SharedPtr notice_pub;
 
   using Refusal = rmf_traffic_msgs::msg::NegotiationRefusal;
@@ -231,26 +401,61 @@ public:
   RefusalPub::SharedPtr refusal_pub;
 
   using Proposal = rmf_traffic_msgs::msg::NegotiationProposal;
-  using ProposalSub = rclcpp::Subscription<Proposal>;
-  using ProposalPub = rclcpp::Publisher<Proposal>;
-  ProposalSub::SharedPtr proposal_sub;
-  ProposalPub::SharedPtr proposal_pub;
+  using ProposalSubs = NegotiationSubscriptions<Proposal>;
+  using ProposalPub = NegotiationPublisher<Proposal>;
+  std::unique_ptr<ProposalSubs> proposal_subs;
+  std::unique_ptr<ProposalPub> proposal_pub;
+
+  // Proposals that only describe what changed since the previous proposal
+  // for the same table. We always listen for these, but we only send them
+  // when the negotiation_proposal_diffs parameter is turned on.
+  using ProposalDiffMsg = std_msgs::msg::UInt8MultiArray;
+  using ProposalDiffSubs = NegotiationSubscriptions<ProposalDiffMsg>;
+  using ProposalDiffPub = NegotiationPublisher<ProposalDiffMsg>;
+  std::unique_ptr<ProposalDiffSubs> proposal_diff_subs;
+  std::unique_ptr<ProposalDiffPub> proposal_diff_pub;
+
+  struct PublishedProposal
+  {
+    Version version;
+    std::vector<rmf_traffic_msgs::msg::Route> itinerary;
+  };
+
+  // The last proposal that we published for each of our tables, identified
+  // by proposal_key(), which the next proposal for that table is diffed
+  // against.
+  using PublishedProposals =
+    std::unordered_map<std::string, PublishedProposal>;
+  std::unordered_map<Version, PublishedProposals> published_proposals;
+
+  // Proposals and rejections are converted into these messages so that their
+  // routes can reuse the memory of the earlier messages.
+  mutable std::mutex publish_buffer_mutex;
+  rmf_traffic_msgs::msg::NegotiationProposal proposal_buffer;
+  rmf_traffic_msgs::msg::NegotiationRejection rejection_buffer;
 
   using Rejection = rmf_traffic_msgs::msg::NegotiationRejection;
-  using RejectionSub = rclcpp::Subscription<Rejection>;
-  using RejectionPub = rclcpp::Publisher<Rejection>;
-  RejectionSub::SharedPtr rejection_sub;
-  RejectionPub::SharedPtr rejection_pub;
+  using RejectionSubs = NegotiationSubscriptions<Rejection>;
+  using RejectionPub = NegotiationPublisher<Rejection>;
+  std::unique_ptr<RejectionSubs> rejection_subs;
+  std::unique_ptr<RejectionPub> rejection_pub;
 
   using Forfeit = rmf_traffic_msgs::msg::NegotiationForfeit;
-  using ForfeitSub = rclcpp::Subscription<Forfeit>;
-  using ForfeitPub = rclcpp::Publisher<Forfeit>;
-  ForfeitSub::SharedPtr forfeit_sub;
-  ForfeitPub::SharedPtr forfeit_pub;
+  using ForfeitSubs = NegotiationSubscriptions<Forfeit>;
+  using ForfeitPub = NegotiationPublisher<Forfeit>;
+  std::unique_ptr<ForfeitSubs> forfeit_subs;
+  std::unique_ptr<ForfeitPub> forfeit_pub;
 
   using Conclusion = rmf_traffic_msgs::msg::NegotiationConclusion;
-  using ConclusionSub = rclcpp::Subscription<Conclusion>;
-  ConclusionSub::SharedPtr conclusion_sub;
+  using ConclusionSubs = NegotiationSubscriptions<Conclusion>;
+  std::unique_ptr<ConclusionSubs> conclusion_subs;
+
+  // The participants of each open negotiation, which decide the shards that
+  // our messages about it are published to. The responders may publish from
+  // the worker, so this is guarded by its own mutex.
+  mutable std::mutex negotiation_participants_mutex;
+  std::unordered_map<Version, std::vector<ParticipantId>>
+  negotiation_participants;
 
   using ParticipantAck = rmf_traffic_msgs::msg::NegotiationParticipantAck;
   using Ack = rmf_traffic_msgs::msg::NegotiationAck;
@@ -266,7 +471,6 @@ public:
   using WeakFailureMapPtr = std::weak_ptr<FailureMap>;
   FailureMapPtr failure_callbacks;
 
-  using Version = rmf_traffic::schedule::Version;
   using Negotiation = rmf_traffic::schedule::Negotiation;
   struct Entry
   {
@@ -302,8 +506,22 @@ public:
     std::function<void (uint64_t conflict_version, bool success)>;
   StatusConclusionCallback conclusion_callback;
 
+  struct HistoryEntry
+  {
+    rmf_traffic::schedule::Negotiation negotiation;
+    std::chrono::steady_clock::time_point concluded_at;
+    std::size_t bytes;
+  };
+
   uint retained_history_count = 0;
-  std::map<Version, rmf_traffic::schedule::Negotiation> history;
+  std::optional<rmf_traffic::Duration> retained_history_max_age;
+  std::optional<std::size_t> retained_history_byte_budget;
+  std::map<Version, HistoryEntry> history;
+
+  // The order that negotiations were concluded in, which is the order they
+  // will be evicted in
+  std::deque<Version> history_order;
+  std::size_t history_bytes = 0;
 
   Implementation(
     rclcpp::Node& node_,
@@ -328,11 +546,17 @@ public:
     repeat_pub = node.create_publisher<Repeat>(
       NegotiationRepeatTopicName, qos);
 
-    notice_sub = node.create_subscription<Notice>(
-      NegotiationNoticeTopicName, qos,
-      [&](const Notice::UniquePtr msg)
+    const auto repeat_period = get_negotiation_repeat_period(node);
+    requested_repeats.emplace(repeat_period);
+    answered_repeats.emplace(repeat_period);
+
+    num_shards = get_negotiation_topic_shards(node);
+
+    notice_subs = std::make_unique<NoticeSubs>(
+      node, NegotiationNoticeTopicName, qos, num_shards,
+      [this](const Notice& msg)
       {
-        this->receive_notice(*msg);
+        this->receive_notice(msg);
       });
 
     notice_pub = node.create_publisher<Notice>(
@@ -341,43 +565,62 @@ public:
     refusal_pub = node.create_publisher<Refusal>(
       NegotiationRefusalTopicName, qos);
 
-    proposal_sub = node.create_subscription<Proposal>(
-      NegotiationProposalTopicName, qos,
-      [&](const Proposal::UniquePtr msg)
+    proposal_subs = std::make_unique<ProposalSubs>(
+      node, NegotiationProposalTopicName, qos, num_shards,
+      [this](const Proposal& msg)
+      {
+        this->receive_proposal(msg);
+      });
+
+    proposal_pub = std::make_unique<ProposalPub>(
+      node, NegotiationProposalTopicName, qos, num_shards);
+
+    proposal_diff_subs = std::make_unique<ProposalDiffSubs>(
+      node, NegotiationProposalDiffTopicName, qos, num_shards,
+      [this](const ProposalDiffMsg& msg)
       {
-        this->receive_proposal(*msg);
+        this->receive_proposal_diff(msg);
       });
 
-    proposal_pub = node.create_publisher<Proposal>(
-      NegotiationProposalTopicName, qos);
+    if (get_negotiation_proposal_diffs(node))
+    {
+      proposal_diff_pub = std::make_unique<ProposalDiffPub>(
+        node, NegotiationProposalDiffTopicName, qos, num_shards);
+    }
 
-    rejection_sub = node.create_subscription<Rejection>(
-      NegotiationRejectionTopicName, qos,
-      [&](const Rejection::UniquePtr msg)
+    rejection_subs = std::make_unique<RejectionSubs>(
+      node, NegotiationRejectionTopicName, qos, num_shards,
+      [this](const Rejection& msg)
       {
-        this->receive_rejection(*msg);
+        this->receive_rejection(msg);
       });
 
-    rejection_pub = node.create_publisher<Rejection>(
-      NegotiationRejectionTopicName, qos);
+    rejection_pub = std::make_unique<RejectionPub>(
+      node, NegotiationRejectionTopicName, qos, num_shards);
 
-    forfeit_sub = node.create_subscription<Forfeit>(
-      NegotiationForfeitTopicName, qos,
-      [&](const Forfeit::UniquePtr msg)
+    forfeit_subs = std::make_unique<ForfeitSubs>(
+      node, NegotiationForfeitTopicName, qos, num_shards,
+      [this](const Forfeit& msg)
       {
-        this->receive_forfeit(*msg);
+        this->receive_forfeit(msg);
       });
 
-    forfeit_pub = node.create_publisher<Forfeit>(
-      NegotiationForfeitTopicName, qos);
+    forfeit_pub = std::make_unique<ForfeitPub>(
+      node, NegotiationForfeitTopicName, qos, num_shards);
 
-    conclusion_sub = node.create_subscription<Conclusion>(
-      NegotiationConclusionTopicName, qos,
-      [&](const Conclusion::UniquePtr msg)
+    conclusion_subs = std::make_unique<ConclusionSubs>(
+      node, NegotiationConclusionTopicName, qos, num_shards,
+      [this](const Conclusion& msg)
       {
-        this->receive_conclusion(*msg);
+        this->receive_conclusion(msg);
       });
 
+    if (num_shards == 0)
+    {
+      // Without sharding, everyone receives everything anyway
+      subscribe_all();
+    }
+
     ack_pub = node.create_publisher<Ack>(
       NegotiationAckTopicName, qos);
   }
@@ -421,13 +664,24 @@ public:
       return;
     }
 
-    publish_proposal(msg.conflict_version, *table);
+    // Other participants that lost the same proposal may have asked for it
+    // too, and they will all receive the one that we already repeated.
+    if (!answered_repeats->admit(
+        msg.conflict_version, msg.table, table->version(),
+        std::chrono::steady_clock::now()))
+      return;
+
+    // The repeat may have been requested because a diff could not be applied,
+    // so always send the full proposal.
+    publish_proposal(msg.conflict_version, *table, true);
   }
 
   void respond_to_queue(
     std::vector<TablePtr> queue,
     Version conflict_version)
   {
+    cancel_stale_responders(conflict_version);
+
     while (!queue.empty())
     {
       const auto top = queue.back();
@@ -505,6 +759,11 @@ public:
       return;
     }
 
+    {
+      std::lock_guard<std::mutex> lock(negotiation_participants_mutex);
+      negotiation_participants[msg.conflict_version] = msg.participants;
+    }
+
     const auto insertion = negotiations.insert(
       {msg.conflict_version, Entry{relevant, *std::move(new_negotiation)}});
 
@@ -550,6 +809,13 @@ public:
       return;
     }
 
+    // This answers any repeat that we asked for
+    RepeatCoalescer::Table repeat_table;
+    for (const auto& key : msg.to_accommodate)
+      repeat_table.push_back(key.participant);
+    repeat_table.push_back(msg.for_participant);
+    requested_repeats->clear(msg.conflict_version, repeat_table);
+
     const bool participating = negotiate_it->second.participating;
     auto& room = negotiate_it->second.room;
     Negotiation& negotiation = room.negotiation;
@@ -606,6 +872,49 @@ public:
     respond_to_queue(queue, msg.conflict_version);
   }
 
+  void receive_proposal_diff(const ProposalDiffMsg& msg)
+  {
+    ProposalDiff diff;
+    try
+    {
+      diff = decode_proposal_diff(msg.data);
+    }
+    catch (const ProposalDiffError& e)
+    {
+      RCLCPP_WARN(
+        node.get_logger(),
+        "[rmf_traffic_ros2::schedule::Negotiation::receive_proposal_diff] "
+        "Ignoring a proposal diff: %s", e.what());
+      return;
+    }
+
+    const auto negotiate_it = negotiations.find(diff.proposal.conflict_version);
+    if (negotiate_it == negotiations.end())
+      return;
+
+    auto reconstruction = negotiate_it->second.room.reconstruct_proposal(diff);
+    if (reconstruction.proposal)
+      return receive_proposal(*reconstruction.proposal);
+
+    if (reconstruction.missing_base)
+    {
+      // We never received the proposal that this diff builds on, so ask for
+      // the whole proposal instead.
+      Repeat repeat;
+      repeat.conflict_version = diff.proposal.conflict_version;
+      for (const auto& key : diff.proposal.to_accommodate)
+        repeat.table.push_back(key.participant);
+      repeat.table.push_back(diff.proposal.for_participant);
+
+      // Every diff that arrives before the full proposal would otherwise ask
+      // for the same proposal again.
+      if (requested_repeats->admit(
+          repeat.conflict_version, repeat.table,
+          diff.proposal.proposal_version, std::chrono::steady_clock::now()))
+        repeat_pub->publish(repeat);
+    }
+  }
+
   void receive_rejection(const Rejection& msg)
   {
     const auto negotiate_it = negotiations.find(msg.conflict_version);
@@ -760,6 +1069,10 @@ public:
 
   void receive_conclusion(const Conclusion& msg)
   {
+    // Whatever our negotiators are still working on for this negotiation is
+    // no longer needed.
+    cancel_responders(msg.conflict_version);
+
     const auto negotiate_it = negotiations.find(msg.conflict_version);
     if (negotiate_it == negotiations.end())
     {
@@ -918,27 +1231,54 @@ public:
     // add to retained history
     if (retained_history_count > 0)
     {
-      while (history.size() >= retained_history_count)
-        history.erase(history.begin());
+      auto& negotiation = negotiate_it->second.room.negotiation;
+      const auto bytes = estimate_negotiation_bytes(negotiation);
+      const auto inserted = history.emplace(
+        msg.conflict_version,
+        HistoryEntry{
+          std::move(negotiation),
+          std::chrono::steady_clock::now(),
+          bytes
+        });
 
-      history.emplace(
-        msg.conflict_version, std::move(negotiate_it->second.room.negotiation));
+      if (inserted.second)
+      {
+        history_order.push_back(msg.conflict_version);
+        history_bytes += bytes;
+      }
+
+      prune_history();
     }
 
     // Erase these entries because the negotiation has concluded
     negotiations.erase(negotiate_it);
+    published_proposals.erase(msg.conflict_version);
+
+    std::lock_guard<std::mutex> lock(negotiation_participants_mutex);
+    negotiation_participants.erase(msg.conflict_version);
+  }
+
+  static std::string proposal_key(const Proposal& msg)
+  {
+    std::string key;
+    for (const auto& p : msg.to_accommodate)
+      key += std::to_string(p.participant) + ":" + std::to_string(p.version)
+        + " ";
+    return key + std::to_string(msg.for_participant);
   }
 
   void publish_proposal(
     const Version conflict_version,
-    const Negotiation::Table& table)
+    const Negotiation::Table& table,
+    const bool full = false)
   {
-    Proposal msg;
+    std::lock_guard<std::mutex> lock(publish_buffer_mutex);
+    auto& msg = proposal_buffer;
     msg.conflict_version = conflict_version;
     msg.proposal_version = table.version();
 
     assert(table.submission());
-    msg.itinerary = convert(*table.submission());
+    convert(*table.submission(), msg.itinerary);
     msg.for_participant = table.participant();
     msg.to_accommodate = convert(table.sequence());
 
@@ -947,7 +1287,29 @@ public:
     // provided by for_participant.
     msg.to_accommodate.pop_back();
 
-    proposal_pub->publish(msg);
+    if (!proposal_diff_pub)
+      return publish_to_participants(*proposal_pub, msg);
+
+    auto& published = published_proposals[conflict_version][proposal_key(msg)];
+    std::optional<ProposalDiff> diff;
+    if (!full && !published.itinerary.empty())
+      diff = make_proposal_diff(msg, published.itinerary, published.version);
+
+    if (diff)
+    {
+      ProposalDiffMsg diff_msg;
+      diff_msg.data = encode_proposal_diff(*diff);
+      publish_to_participants(*proposal_diff_pub, conflict_version, diff_msg);
+    }
+    else
+    {
+      publish_to_participants(*proposal_pub, msg);
+    }
+
+    // The buffer takes over the memory of the older itinerary for the next
+    // conversion
+    published.version = msg.proposal_version;
+    std::swap(published.itinerary, msg.itinerary);
   }
 
   void publish_rejection(
@@ -956,13 +1318,14 @@ public:
     const ParticipantId rejected_by,
     const Negotiation::Alternatives& alternatives)
   {
-    Rejection msg;
+    std::lock_guard<std::mutex> lock(publish_buffer_mutex);
+    auto& msg = rejection_buffer;
     msg.conflict_version = conflict_version;
     msg.table = convert(table.sequence());
     msg.rejected_by = rejected_by;
-    msg.alternatives = convert(alternatives);
+    convert(alternatives, msg.alternatives);
 
-    rejection_pub->publish(msg);
+    publish_to_participants(*rejection_pub, msg);
   }
 
   void publish_forfeit(
@@ -973,7 +1336,58 @@ public:
     msg.conflict_version = conflict_version;
     msg.table = convert(table.sequence());
 
-    forfeit_pub->publish(msg);
+    publish_to_participants(*forfeit_pub, msg);
+  }
+
+  template<typename Message>
+  void publish_to_participants(
+    NegotiationPublisher<Message>& publisher,
+    const Message& msg)
+  {
+    publish_to_participants(publisher, msg.conflict_version, msg);
+  }
+
+  template<typename Message>
+  void publish_to_participants(
+    NegotiationPublisher<Message>& publisher,
+    const Version conflict_version,
+    const Message& msg)
+  {
+    std::vector<ParticipantId> participants;
+    {
+      std::lock_guard<std::mutex> lock(negotiation_participants_mutex);
+      const auto it = negotiation_participants.find(conflict_version);
+      if (it == negotiation_participants.end())
+      {
+        // We no longer know who is taking part, so make sure that whoever is
+        // still waiting on this message gets it.
+        return publisher.publish_all(msg);
+      }
+
+      participants = it->second;
+    }
+
+    publisher.publish(msg, participants);
+  }
+
+  void subscribe_for(const ParticipantId participant)
+  {
+    notice_subs->subscribe_for(participant);
+    proposal_subs->subscribe_for(participant);
+    proposal_diff_subs->subscribe_for(participant);
+    rejection_subs->subscribe_for(participant);
+    forfeit_subs->subscribe_for(participant);
+    conclusion_subs->subscribe_for(participant);
+  }
+
+  void subscribe_all()
+  {
+    notice_subs->subscribe_all();
+    proposal_subs->subscribe_all();
+    proposal_diff_subs->subscribe_all();
+    rejection_subs->subscribe_all();
+    forfeit_subs->subscribe_all();
+    conclusion_subs->subscribe_all();
   }
 
   struct Handle
@@ -1027,6 +1441,8 @@ public:
         std::make_pair(for_participant, std::move(failure_cb)));
     }
 
+    subscribe_for(for_participant);
+
     return std::make_shared<Handle>(
       for_participant, negotiators, failure_callbacks);
   }
@@ -1034,6 +1450,129 @@ public:
   void set_retained_history_count(uint count)
   {
     retained_history_count = count;
+    prune_history();
+  }
+
+  void set_retained_history_max_age(std::optional<rmf_traffic::Duration> age)
+  {
+    retained_history_max_age = age;
+    prune_history();
+  }
+
+  void set_retained_history_byte_budget(std::optional<std::size_t> bytes)
+  {
+    retained_history_byte_budget = bytes;
+    prune_history();
+  }
+
+  bool history_expired(const HistoryEntry& entry) const
+  {
+    return retained_history_max_age.has_value()
+      && *retained_history_max_age
+      < std::chrono::steady_clock::now() - entry.concluded_at;
+  }
+
+  void prune_history()
+  {
+    const auto over_limit = [&]()
+      {
+        if (history.size() > retained_history_count)
+          return true;
+
+        if (retained_history_byte_budget.has_value()
+          && *retained_history_byte_budget < history_bytes)
+          return true;
+
+        return history_expired(history.at(history_order.front()));
+      };
+
+    // The oldest entries are evicted first, so each constraint can be
+    // enforced by popping from the front until it is satisfied.
+    while (!history_order.empty() && over_limit())
+    {
+      const auto it = history.find(history_order.front());
+      history_bytes -= it->second.bytes;
+      history.erase(it);
+      history_order.pop_front();
+    }
+  }
+
+  void account_memory(MemoryUsage& usage) const
+  {
+    usage.add(
+      "negotiation.open",
+      negotiations.size(),
+      memory::heap_bytes(
+        negotiations,
+        [](const auto& element)
+        {
+          return estimate_room_bytes(element.second.room);
+        }));
+
+    usage.add(
+      "negotiation.history",
+      history.size(),
+      history_bytes + memory::heap_bytes(history)
+      + memory::heap_bytes(history_order));
+
+    std::size_t approval_count = 0;
+    for (const auto& [_, callbacks] : approvals)
+      approval_count += callbacks.size();
+
+    usage.add(
+      "negotiation.approvals",
+      approval_count,
+      memory::heap_bytes(
+        approvals,
+        [](const auto& element)
+        {
+          return memory::heap_bytes(
+            element.second,
+            [](const auto& callback)
+            {
+              return memory::heap_bytes(callback.second.sequence);
+            });
+        }));
+
+    {
+      std::lock_guard<std::mutex> lock(negotiation_participants_mutex);
+      usage.add(
+        "negotiation.participants",
+        negotiation_participants.size(),
+        memory::heap_bytes(
+          negotiation_participants,
+          [](const auto& element)
+          {
+            return memory::heap_bytes(element.second);
+          }));
+    }
+
+    std::lock_guard<std::mutex> lock(publish_buffer_mutex);
+    std::size_t published_count = 0;
+    for (const auto& [_, published] : published_proposals)
+      published_count += published.size();
+
+    usage.add(
+      "negotiation.published_proposals",
+      published_count,
+      memory::heap_bytes(
+        published_proposals,
+        [](const auto& element)
+        {
+          return memory::heap_bytes(
+            element.second,
+            [](const auto& published)
+            {
+              return memory::heap_bytes(published.first)
+              + memory::heap_bytes(published.second.itinerary, route_msg_bytes);
+            });
+        }));
+
+    usage.add(
+      "negotiation.publish_buffers",
+      proposal_buffer.itinerary.size() + rejection_buffer.alternatives.size(),
+      memory::heap_bytes(proposal_buffer.itinerary, route_msg_bytes)
+      + memory::heap_bytes(rejection_buffer.alternatives));
   }
 
   TableViewPtr table_view(
@@ -1046,7 +1585,7 @@ public:
     if (negotiate_it == negotiations.end())
     {
       const auto history_it = history.find(conflict_version);
-      if (history_it == history.end())
+      if (history_it == history.end() || history_expired(history_it->second))
       {
         RCLCPP_WARN(
           node.get_logger(),
@@ -1056,7 +1595,7 @@ public:
         return nullptr;
       }
 
-      table = history_it->second.table(sequence);
+      table = history_it->second.negotiation.table(sequence);
     }
     else
     {
@@ -1076,12 +1615,17 @@ public:
 
   void on_status_update(StatusUpdateCallback cb)
   {
+    // Observers want to hear about every negotiation, not only our own
     status_callback = cb;
+    if (status_callback)
+      subscribe_all();
   }
 
   void on_conclusion(StatusConclusionCallback cb)
   {
     conclusion_callback = cb;
+    if (conclusion_callback)
+      subscribe_all();
   }
 };
 
@@ -1108,6 +1652,18 @@ void Negotiation::on_conclusion(StatusConclusionCallback cb)
   _pimpl->on_conclusion(cb);
 }
 
+//==============================================================================
+auto Negotiation::cancellation_token(
+  const rmf_traffic::schedule::Negotiator::Responder& responder)
+-> CancellationToken
+{
+  const auto* r = dynamic_cast<const Implementation::Responder*>(&responder);
+  if (!r)
+    return nullptr;
+
+  return r->cancellation_token();
+}
+
 //==============================================================================
 Negotiation& Negotiation::timeout_duration(rmf_traffic::Duration duration)
 {
@@ -1135,6 +1691,38 @@ void Negotiation::set_retained_history_count(uint count)
   return _pimpl->set_retained_history_count(count);
 }
 
+//==============================================================================
+void Negotiation::set_retained_history_max_age(
+  std::optional<rmf_traffic::Duration> max_age)
+{
+  _pimpl->set_retained_history_max_age(max_age);
+}
+
+//==============================================================================
+void Negotiation::set_retained_history_byte_budget(
+  std::optional<std::size_t> bytes)
+{
+  _pimpl->set_retained_history_byte_budget(bytes);
+}
+
+//==============================================================================
+std::size_t Negotiation::retained_history_size() const
+{
+  return _pimpl->history.size();
+}
+
+//==============================================================================
+std::size_t Negotiation::retained_history_bytes() const
+{
+  return _pimpl->history_bytes;
+}
+
+//==============================================================================
+void Negotiation::account_memory(MemoryUsage& usage) const
+{
+  _pimpl->account_memory(usage);
+}
+
 //==============================================================================
 std::shared_ptr<void> Negotiation::register_negotiator(
   rmf_traffic::schedule::ParticipantId for_participant,
@@ -17,9 +17,11 @@
 
 #include "NegotiationRoom.hpp"
 
+#include <rmf_traffic_ros2/MemoryUsage.hpp>
 #include <rmf_traffic_ros2/Route.hpp>
 #include <rmf_traffic_ros2/schedule/Itinerary.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 namespace rmf_traffic_ros2 {
@@ -55,6 +57,93 @@ std::vector<rmf_traffic_msgs::msg::NegotiationKey> convert(
 
 namespace schedule {
 
+namespace {
+//==============================================================================
+// Waypoints are hidden behind an implementation pointer, so sizeof would not
+// tell us much. Each one holds a time, a position, a velocity, and the
+// bookkeeping of the trajectory container.
+constexpr std::size_t WaypointBytes = 96;
+
+//==============================================================================
+std::size_t route_bytes(const rmf_traffic::Route& route)
+{
+  return sizeof(rmf_traffic::Route) + route.map().size()
+    + route.trajectory().size() * WaypointBytes;
+}
+
+//==============================================================================
+std::size_t route_bytes(const rmf_traffic::ConstRoutePtr& route)
+{
+  return route ? sizeof(route) + route_bytes(*route) : sizeof(route);
+}
+
+//==============================================================================
+std::size_t table_bytes(
+  const rmf_traffic::schedule::Negotiation& negotiation,
+  std::vector<rmf_traffic::schedule::ParticipantId>& sequence)
+{
+  const auto table = negotiation.table(sequence);
+  if (!table)
+    return 0;
+
+  std::size_t bytes = sizeof(*table);
+  if (const auto* submission = table->submission())
+  {
+    for (const auto& route : *submission)
+      bytes += route_bytes(route);
+  }
+
+  for (const auto p : negotiation.participants())
+  {
+    if (std::find(sequence.begin(), sequence.end(), p) != sequence.end())
+      continue;
+
+    sequence.push_back(p);
+    bytes += table_bytes(negotiation, sequence);
+    sequence.pop_back();
+  }
+
+  return bytes;
+}
+} // anonymous namespace
+
+//==============================================================================
+std::size_t route_msg_bytes(const rmf_traffic_msgs::msg::Route& route)
+{
+  return memory::heap_bytes(route.map)
+    + memory::heap_bytes(route.trajectory.waypoints);
+}
+
+//==============================================================================
+std::size_t estimate_negotiation_bytes(
+  const rmf_traffic::schedule::Negotiation& negotiation)
+{
+  std::size_t bytes = sizeof(negotiation);
+  std::vector<rmf_traffic::schedule::ParticipantId> sequence;
+  for (const auto p : negotiation.participants())
+  {
+    sequence.push_back(p);
+    bytes += table_bytes(negotiation, sequence);
+    sequence.pop_back();
+  }
+
+  return bytes;
+}
+
+//==============================================================================
+std::size_t estimate_room_bytes(const NegotiationRoom& room)
+{
+  return estimate_negotiation_bytes(room.negotiation)
+    + memory::heap_bytes(
+    room.cached_proposals,
+    [](const rmf_traffic_msgs::msg::NegotiationProposal& proposal)
+    {
+      return memory::heap_bytes(proposal.itinerary, route_msg_bytes);
+    })
+    + memory::heap_bytes(room.cached_rejections)
+    + memory::heap_bytes(room.cached_forfeits);
+}
+
 //==============================================================================
 NegotiationRoom::NegotiationRoom(rmf_traffic::schedule::Negotiation negotiation_)
 : negotiation(std::move(negotiation_))
@@ -171,6 +260,38 @@ check_cache(const NegotiatorMap& negotiators)
   return respond_to;
 }
 
+//==============================================================================
+auto NegotiationRoom::reconstruct_proposal(const ProposalDiff& diff)
+-> Reconstruction
+{
+  const auto& proposal = diff.proposal;
+  const auto search = negotiation.find(
+    proposal.for_participant, convert(proposal.to_accommodate));
+
+  if (search.deprecated())
+    return {};
+
+  const auto table = search.table;
+  if (table && table->version() >= proposal.proposal_version)
+    return {};
+
+  if (!table || table->version() != diff.base_version || !table->submission())
+    return {std::nullopt, true};
+
+  try
+  {
+    return {
+      apply_proposal_diff(
+        diff, rmf_traffic_ros2::convert(*table->submission())),
+      false
+    };
+  }
+  catch (const ProposalDiffError&)
+  {
+    return {std::nullopt, true};
+  }
+}
+
 //==============================================================================
 void print_negotiation_status(
   rmf_traffic::schedule::Version conflict_version,
@@ -25,7 +25,10 @@
 #include <rmf_traffic_msgs/msg/negotiation_forfeit.hpp>
 #include <rmf_traffic_msgs/msg/negotiation_key.hpp>
 
+#include "ProposalDiff.hpp"
+
 #include <list>
+#include <optional>
 
 namespace rmf_traffic_ros2 {
 
@@ -56,8 +59,38 @@ struct NegotiationRoom
 
   std::vector<rmf_traffic::schedule::Negotiation::TablePtr> check_cache(
     const NegotiatorMap& negotiators);
+
+  struct Reconstruction
+  {
+    /// The full proposal, if it could be rebuilt
+    std::optional<rmf_traffic_msgs::msg::NegotiationProposal> proposal;
+
+    /// True if the proposal that the diff builds on is missing, in which case
+    /// the full proposal needs to be requested again
+    bool missing_base = false;
+  };
+
+  /// Rebuild the full proposal that a diff describes out of the proposal that
+  /// it builds on. Diffs that are out of date give neither a proposal nor a
+  /// missing base.
+  Reconstruction reconstruct_proposal(const ProposalDiff& diff);
 };
 
+//==============================================================================
+/// A rough estimate of the memory held by a route message
+std::size_t route_msg_bytes(const rmf_traffic_msgs::msg::Route& route);
+
+//==============================================================================
+/// A rough estimate of the memory held by a negotiation, dominated by the
+/// trajectories of the proposals in its tables
+std::size_t estimate_negotiation_bytes(
+  const rmf_traffic::schedule::Negotiation& negotiation);
+
+//==============================================================================
+/// A rough estimate of the memory held by a room, including the messages that
+/// are waiting in its caches
+std::size_t estimate_room_bytes(const NegotiationRoom& room);
+
 //==============================================================================
 // TODO(MXG): Refactor this by putting it somewhere more meaningful.
 void print_negotiation_status(
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "NegotiationStatus.hpp"
+#include "Tracing.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+double to_seconds(const rmf_traffic::Duration duration)
+{
+  return std::chrono::duration_cast<std::chrono::duration<double>>(
+    duration).count();
+}
+
+//==============================================================================
+YAML::Node serialize(const NegotiationLatencyHistogram& histogram)
+{
+  YAML::Node buckets;
+  const auto& bounds = histogram.bounds();
+  const auto& counts = histogram.counts();
+  for (std::size_t i = 0; i < counts.size(); ++i)
+  {
+    YAML::Node bucket;
+    bucket["le"] = i < bounds.size() ?
+      to_seconds(bounds[i]) : std::numeric_limits<double>::infinity();
+    bucket["count"] = counts[i];
+    buckets.push_back(bucket);
+  }
+
+  YAML::Node node;
+  node["count"] = histogram.total();
+  node["sum"] = to_seconds(histogram.sum());
+  node["max"] = to_seconds(histogram.max());
+  node["buckets"] = buckets;
+  return node;
+}
+
+//==============================================================================
+std::size_t table_depth(
+  const rmf_traffic::schedule::Negotiation::TablePtr& table)
+{
+  if (!table || !table->submission())
+    return 0;
+
+  std::size_t depth = table->sequence().size();
+  for (const auto& child : table->children())
+    depth = std::max(depth, table_depth(child));
+
+  return depth;
+}
+} // anonymous namespace
+
+//==============================================================================
+std::vector<rmf_traffic::Duration>
+NegotiationLatencyHistogram::default_bounds()
+{
+  using namespace std::chrono_literals;
+  return {100ms, 250ms, 500ms, 1s, 2s, 5s, 10s, 30s, 60s};
+}
+
+//==============================================================================
+NegotiationLatencyHistogram::NegotiationLatencyHistogram(
+  std::vector<Duration> bounds)
+: _bounds(std::move(bounds)),
+  _counts(_bounds.size() + 1, 0)
+{
+  std::sort(_bounds.begin(), _bounds.end());
+}
+
+//==============================================================================
+void NegotiationLatencyHistogram::record(const Duration latency)
+{
+  const auto it = std::lower_bound(_bounds.begin(), _bounds.end(), latency);
+  ++_counts[it - _bounds.begin()];
+  ++_total;
+  _sum += latency;
+  _max = std::max(_max, latency);
+}
+
+//==============================================================================
+auto NegotiationLatencyHistogram::bounds() const
+-> const std::vector<Duration>&
+{
+  return _bounds;
+}
+
+//==============================================================================
+const std::vector<uint64_t>& NegotiationLatencyHistogram::counts() const
+{
+  return _counts;
+}
+
+//==============================================================================
+uint64_t NegotiationLatencyHistogram::total() const
+{
+  return _total;
+}
+
+//==============================================================================
+auto NegotiationLatencyHistogram::sum() const -> Duration
+{
+  return _sum;
+}
+
+//==============================================================================
+auto NegotiationLatencyHistogram::max() const -> Duration
+{
+  return _max;
+}
+
+//==============================================================================
+YAML::Node serialize(const NegotiationStatus& status)
+{
+  YAML::Node open = YAML::Node(YAML::NodeType::Sequence);
+  for (const auto& n : status.open)
+  {
+    YAML::Node entry;
+    entry["conflict_version"] = n.conflict_version;
+    entry["participants"] = n.participants;
+    entry["depth"] = n.depth;
+    entry["since_notice"] = to_seconds(n.since_notice);
+    open.push_back(entry);
+  }
+
+  YAML::Node concluded = YAML::Node(YAML::NodeType::Sequence);
+  for (const auto& n : status.concluded)
+  {
+    YAML::Node entry;
+    entry["conflict_version"] = n.conflict_version;
+    entry["resolved"] = n.resolved;
+    entry["notice_to_conclusion"] = to_seconds(n.notice_to_conclusion);
+    concluded.push_back(entry);
+  }
+
+  YAML::Node latency;
+  latency["resolved"] = serialize(status.resolved_latency);
+  latency["failed"] = serialize(status.failed_latency);
+
+  YAML::Node node;
+  node["open"] = open;
+  node["concluded"] = concluded;
+  node["awaiting_acknowledgment"] = status.awaiting_acknowledgment;
+  node["latency"] = latency;
+  return node;
+}
+
+//==============================================================================
+std::size_t negotiation_depth(rmf_traffic::schedule::Negotiation& negotiation)
+{
+  std::size_t depth = 0;
+  for (const auto p : negotiation.participants())
+    depth = std::max(depth, table_depth(negotiation.table(p, {})));
+
+  return depth;
+}
+
+//==============================================================================
+void NegotiationStatusTracker::opened(
+  const Version conflict_version,
+  const Clock::time_point now)
+{
+  RMF_TRAFFIC_ROS2_TRACE(
+    "negotiation_opened", "conflict_version=%lu", conflict_version);
+  _notice_times.insert({conflict_version, now});
+}
+
+//==============================================================================
+void NegotiationStatusTracker::keep_conclusions(const bool keep)
+{
+  _keep_conclusions = keep;
+  if (!keep)
+    _concluded.clear();
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Duration> NegotiationStatusTracker::concluded(
+  const Version conflict_version,
+  const bool resolved,
+  const Clock::time_point now)
+{
+  const auto it = _notice_times.find(conflict_version);
+  if (it == _notice_times.end())
+    return std::nullopt;
+
+  const rmf_traffic::Duration latency = now - it->second;
+  _notice_times.erase(it);
+
+  RMF_TRAFFIC_ROS2_TRACE(
+    "negotiation_concluded", "conflict_version=%lu resolved=%d latency_ns=%ld",
+    conflict_version, resolved ? 1 : 0,
+    std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+
+  (resolved ? _resolved_latency : _failed_latency).record(latency);
+  if (_keep_conclusions)
+    _concluded.push_back({conflict_version, resolved, latency});
+
+  return latency;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Duration> NegotiationStatusTracker::since_notice(
+  const Version conflict_version,
+  const Clock::time_point now) const
+{
+  const auto it = _notice_times.find(conflict_version);
+  if (it == _notice_times.end())
+    return std::nullopt;
+
+  return now - it->second;
+}
+
+//==============================================================================
+NegotiationStatus NegotiationStatusTracker::report()
+{
+  NegotiationStatus status;
+  status.concluded = std::move(_concluded);
+  _concluded.clear();
+  status.resolved_latency = _resolved_latency;
+  status.failed_latency = _failed_latency;
+  return status;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
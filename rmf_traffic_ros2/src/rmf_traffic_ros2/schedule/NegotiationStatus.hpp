@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__NEGOTIATIONSTATUS_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__NEGOTIATIONSTATUS_HPP
+
+#include <rmf_traffic/schedule/Negotiation.hpp>
+
+#include <yaml-cpp/yaml.h>
+
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Counts how long negotiations took from their notice to their conclusion.
+/// Each latency falls in the first bucket whose upper bound it does not
+/// exceed, and the final bucket catches everything beyond the last bound.
+class NegotiationLatencyHistogram
+{
+public:
+
+  using Duration = rmf_traffic::Duration;
+
+  static std::vector<Duration> default_bounds();
+
+  NegotiationLatencyHistogram(std::vector<Duration> bounds = default_bounds());
+
+  void record(Duration latency);
+
+  /// The upper bound of each bucket except the last
+  const std::vector<Duration>& bounds() const;
+
+  /// The number of latencies in each bucket. This has one more entry than
+  /// bounds().
+  const std::vector<uint64_t>& counts() const;
+
+  uint64_t total() const;
+
+  Duration sum() const;
+
+  Duration max() const;
+
+private:
+  std::vector<Duration> _bounds;
+  std::vector<uint64_t> _counts;
+  uint64_t _total = 0;
+  Duration _sum = Duration(0);
+  Duration _max = Duration(0);
+};
+
+//==============================================================================
+/// A summary of what the schedule node's negotiations are doing, which is
+/// published periodically so that the negotiation timeouts can be tuned.
+struct NegotiationStatus
+{
+  using Version = rmf_traffic::schedule::Version;
+  using ParticipantId = rmf_traffic::schedule::ParticipantId;
+  using Duration = rmf_traffic::Duration;
+
+  struct Open
+  {
+    Version conflict_version;
+    std::vector<ParticipantId> participants;
+
+    /// The length of the longest sequence that has received a proposal
+    std::size_t depth;
+
+    Duration since_notice;
+  };
+
+  struct Concluded
+  {
+    Version conflict_version;
+    bool resolved;
+    Duration notice_to_conclusion;
+  };
+
+  std::vector<Open> open;
+
+  /// The negotiations that concluded since the previous status
+  std::vector<Concluded> concluded;
+
+  /// How many participants still owe us an acknowledgment of a conclusion
+  std::size_t awaiting_acknowledgment = 0;
+
+  NegotiationLatencyHistogram resolved_latency;
+  NegotiationLatencyHistogram failed_latency;
+};
+
+//==============================================================================
+YAML::Node serialize(const NegotiationStatus& status);
+
+//==============================================================================
+/// Get the length of the longest table sequence in the negotiation that has
+/// received a proposal.
+std::size_t negotiation_depth(rmf_traffic::schedule::Negotiation& negotiation);
+
+//==============================================================================
+/// Remembers when each negotiation was noticed so that its latency can be
+/// recorded when it concludes.
+class NegotiationStatusTracker
+{
+public:
+
+  using Clock = std::chrono::steady_clock;
+  using Version = rmf_traffic::schedule::Version;
+
+  /// Tell the tracker that a notice went out for this negotiation. Notices
+  /// for negotiations that are already open are ignored.
+  void opened(Version conflict_version, Clock::time_point now = Clock::now());
+
+  /// Choose whether concluded negotiations are kept until the next report().
+  /// This should be turned off when nobody calls report(), or else the
+  /// conclusions will pile up forever. The latency histograms are kept either
+  /// way. This is on by default.
+  void keep_conclusions(bool keep);
+
+  /// Tell the tracker that this negotiation has concluded
+  ///
+  /// \return how long the negotiation took since its notice, or std::nullopt
+  /// if no notice went out for it
+  std::optional<rmf_traffic::Duration> concluded(
+    Version conflict_version,
+    bool resolved,
+    Clock::time_point now = Clock::now());
+
+  /// Get how long ago the notice for this negotiation went out
+  std::optional<rmf_traffic::Duration> since_notice(
+    Version conflict_version,
+    Clock::time_point now = Clock::now()) const;
+
+  /// Produce a status with the latency histograms and the negotiations that
+  /// concluded since the last status. The caller fills in the open
+  /// negotiations.
+  NegotiationStatus report();
+
+private:
+  std::unordered_map<Version, Clock::time_point> _notice_times;
+  std::vector<NegotiationStatus::Concluded> _concluded;
+  bool _keep_conclusions = true;
+  NegotiationLatencyHistogram _resolved_latency;
+  NegotiationLatencyHistogram _failed_latency;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__NEGOTIATIONSTATUS_HPP
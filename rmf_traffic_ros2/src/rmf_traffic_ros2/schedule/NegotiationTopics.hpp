@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__NEGOTIATIONTOPICS_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__NEGOTIATIONTOPICS_HPP
+
+#include <rmf_traffic/schedule/Participant.hpp>
+
+#include <rclcpp/node.hpp>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// The name of the parameter that decides how many shards each negotiation
+/// topic is split into. Every node that takes part in negotiations must use
+/// the same value. When it is 0, each negotiation topic is a single topic
+/// that everyone receives.
+const std::string NegotiationTopicShardsParameter = "negotiation_topic_shards";
+
+//==============================================================================
+/// Get the number of negotiation topic shards that the node is configured
+/// with, declaring the parameter if nobody has declared it yet.
+inline std::size_t get_negotiation_topic_shards(rclcpp::Node& node)
+{
+  if (!node.has_parameter(NegotiationTopicShardsParameter))
+    node.declare_parameter<int>(NegotiationTopicShardsParameter, 0);
+
+  const auto shards =
+    node.get_parameter(NegotiationTopicShardsParameter).as_int();
+  return shards > 0 ? static_cast<std::size_t>(shards) : 0;
+}
+
+//==============================================================================
+/// The name of the parameter that decides whether proposals are sent as diffs
+/// against the previous proposal for the same table. Receivers always accept
+/// diffs, so this only needs to be turned on for the nodes that send them.
+const std::string NegotiationProposalDiffsParameter =
+  "negotiation_proposal_diffs";
+
+//==============================================================================
+inline bool get_negotiation_proposal_diffs(rclcpp::Node& node)
+{
+  if (!node.has_parameter(NegotiationProposalDiffsParameter))
+    node.declare_parameter<bool>(NegotiationProposalDiffsParameter, false);
+
+  return node.get_parameter(NegotiationProposalDiffsParameter).as_bool();
+}
+
+//==============================================================================
+/// The name of the parameter that decides, in milliseconds, how long a
+/// negotiation repeat covers later requests for the same table. Requests that
+/// it covers are not sent, and repeats that it covers are not answered again,
+/// because everyone receives the one repeated proposal. Zero turns this off.
+const std::string NegotiationRepeatPeriodParameter =
+  "negotiation_repeat_period";
+
+//==============================================================================
+inline std::chrono::milliseconds get_negotiation_repeat_period(
+  rclcpp::Node& node)
+{
+  if (!node.has_parameter(NegotiationRepeatPeriodParameter))
+    node.declare_parameter<int>(NegotiationRepeatPeriodParameter, 500);
+
+  return std::chrono::milliseconds(
+    node.get_parameter(NegotiationRepeatPeriodParameter).as_int());
+}
+
+//==============================================================================
+inline std::string negotiation_shard_topic(
+  const std::string& base,
+  const std::size_t shard)
+{
+  return base + "/shard_" + std::to_string(shard);
+}
+
+//==============================================================================
+/// Get the shards that a message about a negotiation between these
+/// participants must be delivered to.
+template<typename Participants>
+std::set<std::size_t> negotiation_shards(
+  const Participants& participants,
+  const std::size_t num_shards)
+{
+  std::set<std::size_t> shards;
+  if (num_shards == 0)
+    return shards;
+
+  for (const auto p : participants)
+    shards.insert(static_cast<std::size_t>(p) % num_shards);
+
+  return shards;
+}
+
+//==============================================================================
+/// Publishes each negotiation message to the shards of the participants that
+/// it concerns, so that it only reaches the nodes that are taking part.
+template<typename Message>
+class NegotiationPublisher
+{
+public:
+
+  NegotiationPublisher(
+    rclcpp::Node& node,
+    const std::string& topic,
+    const rclcpp::QoS& qos,
+    const std::size_t num_shards)
+  : _num_shards(num_shards)
+  {
+    if (num_shards == 0)
+    {
+      _publishers.push_back(node.create_publisher<Message>(topic, qos));
+      return;
+    }
+
+    for (std::size_t shard = 0; shard < num_shards; ++shard)
+    {
+      _publishers.push_back(
+        node.create_publisher<Message>(
+          negotiation_shard_topic(topic, shard), qos));
+    }
+  }
+
+  template<typename Participants>
+  void publish(const Message& msg, const Participants& participants)
+  {
+    if (_num_shards == 0)
+      return publish_all(msg);
+
+    for (const auto shard : negotiation_shards(participants, _num_shards))
+      _publishers[shard]->publish(msg);
+  }
+
+  /// Use this when the participants of the negotiation are not known
+  void publish_all(const Message& msg)
+  {
+    for (const auto& publisher : _publishers)
+      publisher->publish(msg);
+  }
+
+private:
+  std::size_t _num_shards;
+  std::vector<typename rclcpp::Publisher<Message>::SharedPtr> _publishers;
+};
+
+//==============================================================================
+/// Subscribes to the shards of a negotiation topic as they become relevant.
+/// When sharding is turned off, the whole topic is subscribed to as soon as
+/// any shard is requested.
+template<typename Message>
+class NegotiationSubscriptions
+{
+public:
+
+  using Callback = std::function<void(const Message&)>;
+
+  NegotiationSubscriptions(
+    rclcpp::Node& node,
+    std::string topic,
+    rclcpp::QoS qos,
+    const std::size_t num_shards,
+    Callback callback,
+    rclcpp::SubscriptionOptions options = rclcpp::SubscriptionOptions())
+  : _node(node),
+    _topic(std::move(topic)),
+    _qos(std::move(qos)),
+    _num_shards(num_shards),
+    _callback(std::move(callback)),
+    _options(std::move(options))
+  {
+    // Do nothing
+  }
+
+  /// Make sure that messages about this participant will be received
+  void subscribe_for(const rmf_traffic::schedule::ParticipantId participant)
+  {
+    subscribe(_num_shards == 0 ? 0 : participant % _num_shards);
+  }
+
+  /// Make sure that every message will be received
+  void subscribe_all()
+  {
+    if (_num_shards == 0)
+      return subscribe(0);
+
+    for (std::size_t shard = 0; shard < _num_shards; ++shard)
+      subscribe(shard);
+  }
+
+private:
+
+  void subscribe(const std::size_t shard)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_subscriptions.count(shard))
+      return;
+
+    const auto topic = _num_shards == 0 ?
+      _topic : negotiation_shard_topic(_topic, shard);
+
+    _subscriptions[shard] = _node.create_subscription<Message>(
+      topic, _qos,
+      [callback = _callback](const typename Message::UniquePtr msg)
+      {
+        callback(*msg);
+      },
+      _options);
+  }
+
+  rclcpp::Node& _node;
+  std::string _topic;
+  rclcpp::QoS _qos;
+  std::size_t _num_shards;
+  Callback _callback;
+  rclcpp::SubscriptionOptions _options;
+  std::mutex _mutex;
+  std::map<std::size_t, typename rclcpp::Subscription<Message>::SharedPtr>
+  _subscriptions;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__NEGOTIATIONTOPICS_HPP
@@ -16,13 +16,23 @@
 */
 
 #include "internal_Node.hpp"
+#include "LevelOfDetail.hpp"
+#include "ScheduleRetention.hpp"
+#include "ScheduleShards.hpp"
+#include "TimedExecutor.hpp"
+#include "Tracing.hpp"
+#include "WorkerPool.hpp"
 
 #include <cstring>
 
+#include <rmf_traffic_ros2/MemoryUsage.hpp>
 #include <rmf_traffic_ros2/Route.hpp>
 #include <rmf_traffic_ros2/StandardNames.hpp>
 #include <rmf_traffic_ros2/Time.hpp>
+#include <rmf_traffic_ros2/Timer.hpp>
+#include <rmf_traffic_ros2/Tracer.hpp>
 #include <rmf_traffic_ros2/Trajectory.hpp>
+#include <rmf_traffic_ros2/TrajectoryCircles.hpp>
 #include <rmf_traffic_ros2/schedule/Itinerary.hpp>
 #include <rmf_traffic_ros2/schedule/Query.hpp>
 #include <rmf_traffic_ros2/schedule/Patch.hpp>
@@ -35,15 +45,45 @@
 
 #include <rmf_utils/optional.hpp>
 
+#include <rclcpp/executors/multi_threaded_executor.hpp>
+#include <rclcpp/serialization.hpp>
+
+#include <algorithm>
 #include <unordered_map>
+#include <variant>
 
 namespace rmf_traffic_ros2 {
 namespace schedule {
 
+//==============================================================================
+using ViewIterator = rmf_traffic::schedule::Viewer::View::const_iterator;
+
+//==============================================================================
+// The participants whose changes began after the look-ahead window of the
+// conflict checker, with the earliest start time among those changes
+using DeferredChecks =
+  std::unordered_map<ScheduleNode::ParticipantId, rmf_traffic::Time>;
+
+//==============================================================================
+void defer_conflict_check(
+  DeferredChecks& deferred,
+  const ScheduleNode::ParticipantId participant,
+  const rmf_traffic::Time start)
+{
+  const auto insertion = deferred.insert({participant, start});
+  if (!insertion.second && start < insertion.first->second)
+    insertion.first->second = start;
+}
+
 //==============================================================================
 std::vector<ScheduleNode::ConflictSet> get_conflicts(
-  const rmf_traffic::schedule::Viewer::View& view_changes,
-  const rmf_traffic::schedule::ItineraryViewer& viewer)
+  const ViewIterator view_begin,
+  const ViewIterator view_end,
+  const rmf_traffic::schedule::ItineraryViewer& viewer,
+  const ConflictBroadphase& broadphase,
+  ConflictCache& cache,
+  const std::optional<rmf_traffic::Time>& horizon_end,
+  DeferredChecks& deferred)
 {
   const auto is_unresponsive = [](
     const rmf_traffic::schedule::ParticipantDescription& desc) -> bool
@@ -53,22 +93,52 @@ std::vector<ScheduleNode::ConflictSet> get_conflicts(
     };
 
   std::vector<ScheduleNode::ConflictSet> conflicts;
-  const auto& participants = viewer.participant_ids();
-  for (const auto participant : participants)
+  for (auto vc = view_begin; vc != view_end; ++vc)
   {
-    const auto itinerary = *viewer.get_itinerary(participant);
-    const auto description = viewer.get_participant(participant);
-    if (!description)
+    if (horizon_end)
+    {
+      const auto* const start = vc->route.trajectory().start_time();
+      if (start && *horizon_end < *start)
+      {
+        defer_conflict_check(deferred, vc->participant, *start);
+        continue;
+      }
+    }
+
+    // The broadphase will only give us routes on the same map as the change
+    // which overlap it in both space and time. There's no need to check a
+    // participant against itself, so those routes are excluded too.
+    const auto candidates = broadphase.candidates(
+      vc->participant, vc->description.profile(), vc->route);
+
+    if (candidates.empty())
       continue;
 
-    for (auto vc = view_changes.begin(); vc != view_changes.end(); ++vc)
+    // The cache keeps its own copy of the changed route so that it can tell
+    // apart routes whose fingerprints collide
+    const ConflictCache::Side change{
+      vc->participant,
+      std::make_shared<const rmf_traffic::Route>(vc->route),
+      ConflictCache::fingerprint(vc->route)
+    };
+
+    const auto change_point =
+      ConflictBroadphase::stationary_point(vc->route.trajectory());
+    std::optional<TrajectoryCircles> change_circles;
+    std::optional<ScheduleNode::ParticipantId> last_conflict;
+    for (const auto& candidate : candidates)
     {
-      if (vc->participant == participant)
+      const auto participant = candidate.participant;
+      if (last_conflict == participant)
       {
-        // There's no need to check a participant against itself
+        // We already know that this pair of participants is in conflict
         continue;
       }
 
+      const auto description = viewer.get_participant(participant);
+      if (!description)
+        continue;
+
       if (is_unresponsive(*description) && is_unresponsive(vc->description))
       {
         // If both participants self-identify as unresponsive, then there's no
@@ -76,27 +146,145 @@ std::vector<ScheduleNode::ConflictSet> get_conflicts(
         continue;
       }
 
-      for (const auto& route : itinerary)
+      const ConflictCache::Side other_side{
+        participant, candidate.route, candidate.fingerprint};
+
+      auto conflict = cache.find(change, other_side);
+
+      if (!conflict.has_value())
       {
-        assert(route);
-        if (route->map() != vc->route.map())
-          continue;
+        // A robot that is waiting in place only needs a point test against
+        // the other trajectory before the full narrowphase
+        const auto& other = candidate.route->trajectory();
+        const auto other_point = change_point ?
+          std::nullopt : ConflictBroadphase::stationary_point(other);
+
+        if (change_point || other_point)
+        {
+          const auto& still = change_point ? vc->route.trajectory() : other;
+          const auto& moving = change_point ? other : vc->route.trajectory();
+          const double distance =
+            ConflictBroadphase::radius(vc->description.profile())
+            + ConflictBroadphase::radius(description->profile());
+
+          if (!ConflictBroadphase::might_reach(
+              moving, change_point ? *change_point : *other_point, distance,
+              *still.start_time(), *still.finish_time()))
+          {
+            conflict = false;
+            cache.insert(change, other_side, false);
+          }
+        }
+      }
+
+      if (!conflict.has_value())
+      {
+        // Most of the candidates are still far apart whenever they overlap in
+        // time, which the bounding circles of their segments can tell cheaply
+        if (!change_circles)
+        {
+          change_circles.emplace(
+            vc->route.trajectory(), vc->description.profile());
+        }
 
-        if (rmf_traffic::DetectConflict::between(
-            vc->description.profile(),
-            vc->route.trajectory(),
-            description->profile(),
-            route->trajectory()))
+        const TrajectoryCircles candidate_circles(
+          candidate.route->trajectory(), description->profile());
+        if (!change_circles->might_conflict(candidate_circles))
         {
-          conflicts.push_back({participant, vc->participant});
+          conflict = false;
+          cache.insert(change, other_side, false);
         }
       }
+
+      if (!conflict.has_value())
+      {
+        conflict = rmf_traffic::DetectConflict::between(
+          vc->description.profile(),
+          vc->route.trajectory(),
+          description->profile(),
+          candidate.route->trajectory()).has_value();
+
+        cache.insert(change, other_side, *conflict);
+      }
+
+      if (*conflict)
+      {
+        conflicts.push_back({participant, vc->participant});
+        last_conflict = participant;
+      }
     }
   }
 
   return conflicts;
 }
 
+//==============================================================================
+std::vector<ScheduleNode::ConflictSet> get_conflicts(
+  const rmf_traffic::schedule::Viewer::View& view_changes,
+  const rmf_traffic::schedule::ItineraryViewer& viewer,
+  const ConflictBroadphase& broadphase,
+  ConflictCache& cache,
+  WorkerPool& pool,
+  const std::optional<rmf_traffic::Time>& horizon_end,
+  DeferredChecks& deferred)
+{
+  // Each change can be checked independently, so we split the changes into
+  // one contiguous chunk per worker and then merge the results in order.
+  const std::size_t num_changes = view_changes.size();
+  const std::size_t num_chunks = std::min(pool.size() + 1, num_changes);
+  if (num_chunks <= 1)
+  {
+    return get_conflicts(
+      view_changes.begin(), view_changes.end(), viewer, broadphase, cache,
+      horizon_end, deferred);
+  }
+
+  std::vector<ViewIterator> bounds;
+  bounds.reserve(num_chunks + 1);
+  std::size_t index = 0;
+  for (auto vc = view_changes.begin(); vc != view_changes.end(); ++vc, ++index)
+  {
+    if (index * num_chunks >= bounds.size() * num_changes)
+      bounds.push_back(vc);
+  }
+  bounds.push_back(view_changes.end());
+
+  std::vector<std::vector<ScheduleNode::ConflictSet>> results(
+    bounds.size() - 1);
+  std::vector<DeferredChecks> chunk_deferred(results.size());
+  std::vector<WorkerPool::Task> tasks;
+  tasks.reserve(results.size());
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    tasks.push_back(
+      [&, i]()
+      {
+        results[i] = get_conflicts(
+          bounds[i], bounds[i+1], viewer, broadphase, cache,
+          horizon_end, chunk_deferred[i]);
+      });
+  }
+
+  pool.run(std::move(tasks));
+
+  for (const auto& chunk : chunk_deferred)
+  {
+    for (const auto& [participant, start] : chunk)
+      defer_conflict_check(deferred, participant, start);
+  }
+
+  std::vector<ScheduleNode::ConflictSet> conflicts;
+  for (auto& r : results)
+  {
+    conflicts.insert(
+      conflicts.end(),
+      std::make_move_iterator(r.begin()),
+      std::make_move_iterator(r.end()));
+  }
+
+  return conflicts;
+}
+
 //==============================================================================
 // This constructor will _not_ automatically call the setup() method to finalise
 // construction of the ScheduleNode object. setup() must be called manually.
@@ -111,21 +299,340 @@ ScheduleNode::ScheduleNode(
   database(std::move(database_)),
   active_conflicts(database)
 {
+  const auto exclusive = rclcpp::CallbackGroupType::MutuallyExclusive;
+  ingest_callback_group = create_callback_group(exclusive);
+  services_callback_group = create_callback_group(exclusive);
+  negotiation_callback_group = create_callback_group(exclusive);
+  mirror_callback_group = create_callback_group(exclusive);
+
+  // Whether the timers of the schedule follow the clock of the node, e.g. a
+  // simulated clock, instead of the wall clock
+  declare_timers_follow_clock(*this);
+
   // Period, in milliseconds, for sending out a heartbeat signal to the monitor
   // node in the redundant pair
   declare_parameter<int>("heartbeat_period", 1000);
   heartbeat_period = std::chrono::milliseconds(
     get_parameter("heartbeat_period").as_int());
 
+  // How the liveliness of the heartbeat is maintained. With "automatic" the
+  // middleware asserts it. With "manual" a dedicated thread publishes the
+  // heartbeat, so a node that stops making progress is noticed too.
+  declare_parameter<std::string>("heartbeat_liveliness", "automatic");
+  const auto heartbeat_liveliness =
+    get_parameter("heartbeat_liveliness").as_string();
+  if (heartbeat_liveliness == "manual")
+  {
+    manual_heartbeat = true;
+  }
+  else if (heartbeat_liveliness != "automatic")
+  {
+    RCLCPP_WARN(
+      get_logger(),
+      "Unknown heartbeat_liveliness [%s]. Using [automatic] instead.",
+      heartbeat_liveliness.c_str());
+  }
+
+  // Lease duration, in milliseconds, of the heartbeat liveliness. This is how
+  // long the monitor waits before declaring this node dead, so it can be set
+  // well below heartbeat_period for fast fail over. Use 0 to match the
+  // heartbeat_period.
+  declare_parameter<int>("heartbeat_lease_duration", 0);
+  const auto lease_param = get_parameter("heartbeat_lease_duration").as_int();
+  heartbeat_lease_duration = lease_param > 0 ?
+    std::chrono::milliseconds(lease_param) : heartbeat_period;
+
   // Participant registry location
   declare_parameter<std::string>(
     "log_file_location", ".rmf_schedule_node.yaml");
 
-  // TODO(MXG): Expose a parameter for the update period
-  // TODO(MXG): We can probably do something smarter to decide when to update
-  // than a simple wall timer
-  mirror_update_timer = create_wall_timer(
-    std::chrono::milliseconds(10), [this]() { this->update_mirrors(); });
+  // Format of the participant registry. Either "yaml", which rewrites the
+  // whole file for each change, or "binary", which appends to a journal.
+  declare_parameter<std::string>("log_file_format", "yaml");
+
+  // When this is true, the participant registry will be written to disk by a
+  // background thread instead of blocking the registration service
+  declare_parameter<bool>("async_participant_logging", false);
+
+  // Duration, in milliseconds, of the time buckets used by the broadphase
+  // index of the conflict checker
+  declare_parameter<int>("conflict_broadphase_time_bucket", 10000);
+  conflict_broadphase_time_bucket = std::chrono::milliseconds(
+    get_parameter("conflict_broadphase_time_bucket").as_int());
+
+  // Namespace of the schedule node that registers the participants when this
+  // node is one shard of a sharded schedule. Leave this empty for a schedule
+  // that is not sharded, and for the node that does the registering.
+  declare_parameter<std::string>("participant_registrar", "");
+  participant_registrar = get_parameter("participant_registrar").as_string();
+
+  // Position of this node among the shards of the schedule, and the total
+  // number of shards. These keep the negotiation versions of the shards apart.
+  declare_parameter<int>("schedule_shard_index", 0);
+  declare_parameter<int>("schedule_shard_count", 1);
+  schedule_shard_count = static_cast<std::size_t>(
+    std::max<int64_t>(1, get_parameter("schedule_shard_count").as_int()));
+  schedule_shard_index = static_cast<std::size_t>(
+    std::max<int64_t>(0, get_parameter("schedule_shard_index").as_int()))
+    % schedule_shard_count;
+  active_conflicts.shard_negotiation_versions(
+    schedule_shard_index, schedule_shard_count);
+
+  // Number of threads that the executor will use to run the callback groups
+  // of this node. A value of 0 will use one thread per hardware core.
+  declare_parameter<int>("executor_threads", 4);
+
+  // Number of threads that will be used to check for conflicts. A value of 0
+  // will use one thread per hardware core.
+  declare_parameter<int>("conflict_check_threads", 1);
+  const auto threads_param = get_parameter("conflict_check_threads").as_int();
+  conflict_check_threads = threads_param > 0 ?
+    static_cast<std::size_t>(threads_param) :
+    std::max(1u, std::thread::hardware_concurrency());
+
+  // CPU affinity, niceness and realtime priority of the threads. The executor
+  // threads handle itinerary changes and negotiations while the conflict
+  // checker looks for conflicts, so they are the traffic-critical ones.
+  executor_thread_settings = ThreadSettings::from_parameters(*this, "executor");
+  conflict_check_thread_settings =
+    ThreadSettings::from_parameters(*this, "conflict_check");
+
+  // Period, in milliseconds, for sending out mirror updates when the node is
+  // not in event-driven mode
+  declare_parameter<int>("mirror_update_period", 10);
+  mirror_update_period = std::chrono::milliseconds(
+    get_parameter("mirror_update_period").as_int());
+
+  // When this is true, mirror updates will be sent out when the database
+  // changes instead of being sent out periodically
+  declare_parameter<bool>("event_driven_mirror_updates", false);
+  event_driven_mirror_updates =
+    get_parameter("event_driven_mirror_updates").as_bool();
+
+  // Minimum time, in milliseconds, between two event-driven mirror updates
+  declare_parameter<int>("mirror_update_min_interval", 10);
+  mirror_update_min_interval = std::chrono::milliseconds(
+    get_parameter("mirror_update_min_interval").as_int());
+
+  // Maximum time, in milliseconds, that an event-driven mirror update may be
+  // postponed after the first change that it contains
+  declare_parameter<int>("mirror_update_max_latency", 50);
+  mirror_update_max_latency = std::chrono::milliseconds(
+    get_parameter("mirror_update_max_latency").as_int());
+
+  // Time, in seconds, after a replacement node starts during which it spaces
+  // out its event-driven mirror updates by takeover_mirror_update_interval
+  // milliseconds, so that the requests of all the mirrors reconnecting to it
+  // are merged. This does not apply to the first node, whose version is 0.
+  declare_parameter<double>("takeover_period", 5.0);
+  declare_parameter<int>("takeover_mirror_update_interval", 500);
+  takeover_mirror_update_interval = std::chrono::milliseconds(
+    get_parameter("takeover_mirror_update_interval").as_int());
+  takeover_period = std::max(
+    std::chrono::steady_clock::duration(0),
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(
+        get_parameter("takeover_period").as_double())));
+  if (node_version > 0 && takeover_period.count() > 0)
+    takeover_until = std::chrono::steady_clock::now() + takeover_period;
+
+  // When this is true, itinerary messages will be queued up and applied
+  // together on the next pass of the executor
+  declare_parameter<bool>("batch_itinerary_ingestion", false);
+  batch_itinerary_ingestion =
+    get_parameter("batch_itinerary_ingestion").as_bool();
+
+  // Itinerary writes per second that each participant, and all the
+  // participants of one fleet together, may make on average. Writes beyond
+  // these rates are deferred, and a deferred set replaces the writes deferred
+  // before it. Zero means there is no limit. The bursts are how many writes
+  // may be made at once.
+  declare_parameter<double>("participant_write_rate", 0.0);
+  declare_parameter<double>("participant_write_burst", 10.0);
+  declare_parameter<double>("fleet_write_rate", 0.0);
+  declare_parameter<double>("fleet_write_burst", 50.0);
+  const IngressQuota::Limit participant_write_limit{
+    get_parameter("participant_write_rate").as_double(),
+    std::max(1.0, get_parameter("participant_write_burst").as_double())
+  };
+  const IngressQuota::Limit fleet_write_limit{
+    get_parameter("fleet_write_rate").as_double(),
+    std::max(1.0, get_parameter("fleet_write_burst").as_double())
+  };
+
+  if (!participant_write_limit.unlimited() || !fleet_write_limit.unlimited())
+  {
+    ingress_quota = std::make_unique<IngressQuota>(
+      participant_write_limit, fleet_write_limit);
+
+    // Check for released writes about as often as a token is refilled
+    const double max_rate =
+      std::max(participant_write_limit.rate, fleet_write_limit.rate);
+    ingress_release_period = std::clamp(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(1.0 / max_rate)),
+      std::chrono::nanoseconds(10ms),
+      std::chrono::nanoseconds(1s));
+  }
+
+  // Minimum time, in milliseconds, between two inconsistency reports for the
+  // same participant
+  declare_parameter<int>("inconsistency_report_min_period", 0);
+  inconsistency_report_min_period = std::chrono::milliseconds(
+    get_parameter("inconsistency_report_min_period").as_int());
+
+  // Time, in milliseconds, after which an unchanged inconsistency report will
+  // be repeated
+  declare_parameter<int>("inconsistency_report_repeat_period", 1000);
+  inconsistency_report_repeat_period = std::chrono::milliseconds(
+    get_parameter("inconsistency_report_repeat_period").as_int());
+
+  // When this is true, mirror updates will also be offered as compact binary
+  // payloads for mirror managers that ask for them
+  declare_parameter<bool>("compact_mirror_updates", false);
+  compact_mirror_updates = get_parameter("compact_mirror_updates").as_bool();
+
+  // Resolution, in meters, that compact mirror updates will quantize positions
+  // and linear velocities to
+  declare_parameter<double>("compact_mirror_linear_resolution", 1e-4);
+  compact_mirror_resolution.linear =
+    get_parameter("compact_mirror_linear_resolution").as_double();
+
+  // Resolution, in radians, that compact mirror updates will quantize yaw and
+  // yaw rates to
+  declare_parameter<double>("compact_mirror_angular_resolution", 1e-4);
+  compact_mirror_resolution.angular =
+    get_parameter("compact_mirror_angular_resolution").as_double();
+
+  if (!(compact_mirror_resolution.linear > 0.0)
+    || !(compact_mirror_resolution.angular > 0.0))
+  {
+    throw std::runtime_error(
+      "[ScheduleNode] The compact mirror update resolutions must be positive");
+  }
+
+  // Periods, in milliseconds, of the slower rate classes that each query will
+  // offer beside its main topic. Mirrors that do not need every update can
+  // subscribe to one of these to receive coalesced updates instead.
+  declare_parameter<std::vector<int64_t>>(
+    "mirror_update_rate_classes", std::vector<int64_t>{});
+  for (const auto period :
+    get_parameter("mirror_update_rate_classes").as_integer_array())
+  {
+    if (period <= 0)
+    {
+      throw std::runtime_error(
+        "[ScheduleNode] The mirror update rate classes must be positive");
+    }
+
+    mirror_update_rate_classes.push_back(std::chrono::milliseconds(period));
+  }
+
+  // Periods, in milliseconds, of the coarse rate classes that each query will
+  // offer for visualization and monitoring, and how far, in meters, their
+  // decimated trajectories may stray from the real ones
+  declare_parameter<std::vector<int64_t>>(
+    "mirror_update_lod_rate_classes", std::vector<int64_t>{});
+  declare_parameter<double>(
+    "mirror_update_lod_tolerance", mirror_update_lod_tolerance);
+  for (const auto period :
+    get_parameter("mirror_update_lod_rate_classes").as_integer_array())
+  {
+    if (period <= 0)
+    {
+      throw std::runtime_error(
+        "[ScheduleNode] The mirror update rate classes must be positive");
+    }
+
+    mirror_update_lod_rate_classes.push_back(
+      std::chrono::milliseconds(period));
+  }
+
+  mirror_update_lod_tolerance =
+    get_parameter("mirror_update_lod_tolerance").as_double();
+  if (mirror_update_lod_tolerance < 0.0)
+  {
+    throw std::runtime_error(
+      "[ScheduleNode] The mirror_update_lod_tolerance must not be negative");
+  }
+
+  // Location of the schedule snapshot file. The schedule will be restored
+  // from this file at startup and periodically saved to it. Leave this empty
+  // to turn snapshots off.
+  declare_parameter<std::string>("schedule_snapshot_location", "");
+  schedule_snapshot_file =
+    get_parameter("schedule_snapshot_location").as_string();
+
+  // Period, in milliseconds, for saving schedule snapshots
+  declare_parameter<int>("schedule_snapshot_period", 10000);
+  schedule_snapshot_period = std::chrono::milliseconds(
+    get_parameter("schedule_snapshot_period").as_int());
+
+  // How far ahead, in seconds, the conflict thread looks for conflicts. Use 0
+  // to check every change as soon as it arrives.
+  declare_parameter<int>("conflict_check_horizon", 0);
+  conflict_check_horizon = std::chrono::seconds(
+    get_parameter("conflict_check_horizon").as_int());
+
+  // How long, in seconds, the schedule keeps routes after they have finished.
+  // Use 0 to keep them until the memory budget is reached.
+  declare_parameter<int>("schedule_retention_horizon", 0);
+  schedule_retention_horizon = std::chrono::seconds(
+    get_parameter("schedule_retention_horizon").as_int());
+
+  // Estimated memory, in bytes, that the routes of the schedule may use
+  // before the routes that finished earliest get culled. Use 0 for no budget.
+  declare_parameter<int>("schedule_memory_budget", 0);
+  schedule_memory_budget = static_cast<std::size_t>(
+    std::max<int64_t>(0, get_parameter("schedule_memory_budget").as_int()));
+
+  // Period, in milliseconds, for culling the schedule
+  declare_parameter<int>("schedule_cull_period", 10000);
+  schedule_cull_period = std::chrono::milliseconds(
+    get_parameter("schedule_cull_period").as_int());
+
+  // Period, in milliseconds, for publishing an estimate of the memory held by
+  // the containers of the node. Use 0 to turn this off.
+  declare_parameter<int>("memory_usage_period", 0);
+  memory_usage_period = std::chrono::milliseconds(
+    get_parameter("memory_usage_period").as_int());
+
+  // Number of shards that the negotiation topics are split into, by
+  // participant ID. Every node that takes part in negotiations must use the
+  // same value. Use 0 to keep each negotiation topic whole.
+  negotiation_topic_shards = get_negotiation_topic_shards(*this);
+
+  // Time, in milliseconds, during which a repeated negotiation proposal is
+  // not asked for again. Use 0 to ask for a repeat on every diff that cannot
+  // be applied.
+  requested_repeats = RepeatCoalescer(get_negotiation_repeat_period(*this));
+
+  // Period, in milliseconds, for publishing the negotiation status. Use 0 to
+  // turn the negotiation status off.
+  declare_parameter<int>("negotiation_status_period", 1000);
+  negotiation_status_period = std::chrono::milliseconds(
+    get_parameter("negotiation_status_period").as_int());
+
+  // Period, in milliseconds, for sending the full set of participants on the
+  // participants delta topic
+  declare_parameter<int>("participants_resync_period", 10000);
+  participants_resync_period = std::chrono::milliseconds(
+    std::max<int64_t>(
+      1, get_parameter("participants_resync_period").as_int()));
+
+  // Maximum number of participants in each chunk of the full state that is
+  // sent to a joining mirror
+  declare_parameter<int>("mirror_sync_chunk_size", 100);
+  mirror_sync_chunk_size = static_cast<std::size_t>(
+    std::max<int64_t>(1, get_parameter("mirror_sync_chunk_size").as_int()));
+
+  if (!event_driven_mirror_updates)
+  {
+    mirror_update_timer = rmf_traffic_ros2::create_timer(
+      *this,
+      mirror_update_period, [this]() { this->update_mirrors(); },
+      mirror_callback_group);
+  }
 }
 
 //==============================================================================
@@ -179,765 +686,2567 @@ ScheduleNode::ScheduleNode(
 //==============================================================================
 ScheduleNode::~ScheduleNode()
 {
+  {
+    std::lock_guard<std::mutex> lock(heartbeat_mutex);
+    heartbeat_quit = true;
+  }
+  heartbeat_cv.notify_all();
+  if (heartbeat_thread.joinable())
+    heartbeat_thread.join();
+
   conflict_check_quit = true;
   if (conflict_check_thread.joinable())
     conflict_check_thread.join();
+
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    snapshot_quit = true;
+  }
+  snapshot_cv.notify_all();
+  if (snapshot_thread.joinable())
+    snapshot_thread.join();
+}
+
+//==============================================================================
+void ScheduleNode::set_database(
+  std::shared_ptr<rmf_traffic::schedule::Database> database_)
+{
+  database = std::move(database_);
+  active_conflicts = ConflictRecord(database);
+  active_conflicts.shard_negotiation_versions(
+    schedule_shard_index, schedule_shard_count);
 }
 
 //==============================================================================
 void ScheduleNode::setup(const QueryMap& queries)
 {
-  //Attempt to load/create participant registry.
-  std::string log_file_name;
-  get_parameter_or<std::string>(
-    "log_file_location",
-    log_file_name,
-    ".rmf_schedule_node.yaml");
+  auto snapshot = load_schedule_snapshot();
 
-  // Re-instantiate any query update topics based on received queries
-  make_mirror_update_topics(queries);
+  // Re-instantiate any query update topics based on received queries. Queries
+  // that were handed to us take priority over the ones in the snapshot.
+  if (snapshot)
+  {
+    QueryMap all_queries = snapshot->queries;
+    for (const auto& [query_id, query] : queries)
+      all_queries.insert_or_assign(query_id, query);
 
-  try
+    make_mirror_update_topics(all_queries);
+  }
+  else
   {
-    auto participant_logger = std::make_unique<YamlLogger>(log_file_name);
+    make_mirror_update_topics(queries);
+  }
 
-    participant_registry =
-      std::make_shared<ParticipantRegistry>(
-      std::move(participant_logger),
-      database);
+  load_participant_registry();
 
-    RCLCPP_INFO(get_logger(),
-      "Successfully loaded logfile %s ",
-      log_file_name.c_str());
-  }
-  catch (std::runtime_error& e)
+  // The participants need to be registered before their itineraries can be
+  // restored, so this has to wait until the registry has been loaded.
+  if (snapshot)
   {
-    RCLCPP_FATAL(get_logger(),
-      "Failed to correctly load participant registry: %s\n",
-      e.what());
-    throw e;
+    const auto restored = restore_schedule_snapshot(*snapshot, *database);
+    RCLCPP_INFO(
+      get_logger(),
+      "Restored the itineraries of %lu out of %lu participants and %lu "
+      "queries from schedule snapshot [%s]",
+      restored,
+      snapshot->participants.size(),
+      snapshot->queries.size(),
+      schedule_snapshot_file.c_str());
   }
 
   setup_redundancy();
   setup_query_services();
   setup_participant_services();
+  setup_registrar_following();
   setup_changes_services();
   setup_itinerary_topics();
   setup_incosistency_pub();
   setup_conflict_topics_and_thread();
+  setup_schedule_snapshots();
+  setup_schedule_retention();
+  setup_memory_usage();
+  setup_metrics();
 }
 
 //==============================================================================
-void ScheduleNode::setup_query_services()
+void ScheduleNode::setup_standby(const QueryMap& queries)
 {
-  register_query_service =
-    create_service<RegisterQuery>(
-    rmf_traffic_ros2::RegisterQueryServiceName,
-    [=](const std::shared_ptr<rmw_request_id_t> request_header,
-    const RegisterQuery::Request::SharedPtr request,
-    const RegisterQuery::Response::SharedPtr response)
-    { this->register_query(request_header, request, response); });
+  // The database of a standby node comes from the primary node, so it is
+  // newer than any snapshot on disk. The participant registry still belongs
+  // to the primary node, which keeps adding to it, so it is only loaded when
+  // this node gets promoted.
+  standby = true;
+  make_mirror_update_topics(queries);
+  setup_registrar_following();
+  setup_itinerary_topics();
+  setup_incosistency_pub();
+  setup_schedule_retention();
 
-  // TODO(MXG): We could expose the timing parameters to the user so the
-  // frequency of cleanups can be customized.
-  query_cleanup_timer =
-    create_wall_timer(
-    query_cleanup_period,
-    [this]() { this->cleanup_queries(); });
+  RCLCPP_INFO(
+    get_logger(),
+    "Standing by with version %lu to replace the primary schedule node",
+    node_version);
 }
 
 //==============================================================================
-void ScheduleNode::setup_participant_services()
+void ScheduleNode::promote(const QueryMap& queries)
 {
-  register_participant_service =
-    create_service<RegisterParticipant>(
-    rmf_traffic_ros2::RegisterParticipantSrvName,
-    [=](const request_id_ptr request_header,
-    const RegisterParticipant::Request::SharedPtr request,
-    const RegisterParticipant::Response::SharedPtr response)
-    { this->register_participant(request_header, request, response); });
+  load_participant_registry();
 
-  unregister_participant_service =
-    create_service<UnregisterParticipant>(
-    rmf_traffic_ros2::UnregisterParticipantSrvName,
-    [=](const request_id_ptr request_header,
-    const UnregisterParticipant::Request::SharedPtr request,
-    const UnregisterParticipant::Response::SharedPtr response)
-    { this->unregister_participant(request_header, request, response); });
-}
+  // The primary node may have registered queries after this node was set up
+  {
+    std::lock_guard<std::mutex> lock(queries_mutex);
+    for (const auto& [query_id, query] : queries)
+    {
+      if (registered_queries.count(query_id) == 0)
+        register_query(query_id, query);
+    }
+  }
 
-//==============================================================================
-void ScheduleNode::setup_changes_services()
-{
-  request_changes_service =
-    create_service<RequestChanges>(
-    rmf_traffic_ros2::RequestChangesServiceName,
-    [=](const request_id_ptr request_header,
-    const RequestChanges::Request::SharedPtr request,
-    const RequestChanges::Response::SharedPtr response)
-    { this->request_changes(request_header, request, response); });
-}
+  // A node that is not a shard has no registrar to follow once the primary
+  // node is gone
+  if (participant_registrar.empty())
+    registrar_participants_sub.reset();
 
-//==============================================================================
-void ScheduleNode::setup_itinerary_topics()
-{
-  const auto itinerary_qos =
-    rclcpp::SystemDefaultsQoS()
-    .reliable()
-    .keep_last(100);
+  setup_redundancy();
+  setup_query_services();
+  setup_participant_services();
+  setup_changes_services();
+  setup_conflict_topics_and_thread();
+  setup_schedule_snapshots();
+  setup_memory_usage();
+  setup_metrics();
 
-  itinerary_set_sub =
-    create_subscription<ItinerarySet>(
-    rmf_traffic_ros2::ItinerarySetTopicName,
-    itinerary_qos,
-    [=](const ItinerarySet::UniquePtr msg)
-    {
-      this->itinerary_set(*msg);
-    });
+  if (!parameter_service && !get_node_options().start_parameter_services())
+  {
+    parameter_service = std::make_shared<rclcpp::ParameterService>(
+      get_node_base_interface(),
+      get_node_services_interface(),
+      get_node_parameters_interface().get());
+  }
 
-  itinerary_extend_sub =
-    create_subscription<ItineraryExtend>(
-    rmf_traffic_ros2::ItineraryExtendTopicName,
-    itinerary_qos,
-    [=](const ItineraryExtend::UniquePtr msg)
-    {
-      this->itinerary_extend(*msg);
-    });
+  // The takeover begins now rather than when this node was set up
+  if (node_version > 0 && takeover_period.count() > 0)
+    takeover_until = std::chrono::steady_clock::now() + takeover_period;
 
-  itinerary_delay_sub =
-    create_subscription<ItineraryDelay>(
-    rmf_traffic_ros2::ItineraryDelayTopicName,
-    itinerary_qos,
-    [=](const ItineraryDelay::UniquePtr msg)
-    {
-      this->itinerary_delay(*msg);
-    });
+  standby = false;
 
-  itinerary_erase_sub =
-    create_subscription<ItineraryErase>(
-    rmf_traffic_ros2::ItineraryEraseTopicName,
-    itinerary_qos,
-    [=](const ItineraryErase::UniquePtr msg)
+  {
+    // Report whatever was missed while the primary node was dying
+    TracedLock lock(database_mutex, "database_mutex");
+    for (const auto& inconsistency : database->inconsistencies())
     {
-      this->itinerary_erase(*msg);
-    });
+      if (database->get_participant(inconsistency.participant))
+        publish_inconsistencies(inconsistency.participant);
+    }
+  }
 
-  itinerary_clear_sub =
-    create_subscription<ItineraryClear>(
-    rmf_traffic_ros2::ItineraryClearTopicName,
-    itinerary_qos,
-    [=](const ItineraryClear::UniquePtr msg)
-    {
-      this->itinerary_clear(*msg);
-    });
-}
+  schedule_mirror_update();
 
-//==============================================================================
-void ScheduleNode::setup_incosistency_pub()
-{
-  inconsistency_pub =
-    create_publisher<InconsistencyMsg>(
-    rmf_traffic_ros2::ScheduleInconsistencyTopicName,
-    rclcpp::SystemDefaultsQoS().reliable());
+  RCLCPP_INFO(
+    get_logger(),
+    "Promoted the standby schedule node with version %lu",
+    node_version);
 }
 
 //==============================================================================
-void ScheduleNode::setup_conflict_topics_and_thread()
+void ScheduleNode::load_participant_registry()
 {
-  const auto negotiation_qos = rclcpp::ServicesQoS().reliable();
-  conflict_ack_sub = create_subscription<ConflictAck>(
-    rmf_traffic_ros2::NegotiationAckTopicName, negotiation_qos,
-    [&](const ConflictAck::UniquePtr msg)
-    {
-      this->receive_conclusion_ack(*msg);
-    });
+  //Attempt to load/create participant registry.
+  std::string log_file_name;
+  get_parameter_or<std::string>(
+    "log_file_location",
+    log_file_name,
+    ".rmf_schedule_node.yaml");
 
-  conflict_notice_pub = create_publisher<ConflictNotice>(
-    rmf_traffic_ros2::NegotiationNoticeTopicName, negotiation_qos);
+  std::string log_file_format;
+  get_parameter_or<std::string>("log_file_format", log_file_format, "yaml");
 
-  conflict_refusal_sub = create_subscription<ConflictRefusal>(
-    rmf_traffic_ros2::NegotiationRefusalTopicName, negotiation_qos,
-    [&](const ConflictRefusal::UniquePtr msg)
+  try
+  {
+    std::unique_ptr<AbstractParticipantLogger> participant_logger;
+    if (log_file_format == "binary")
+      participant_logger = std::make_unique<BinaryLogger>(log_file_name);
+    else if (log_file_format == "yaml")
+      participant_logger = std::make_unique<YamlLogger>(log_file_name);
+    else
     {
-      this->receive_refusal(*msg);
-    });
+      throw std::runtime_error(
+        "Unknown log_file_format [" + log_file_format
+        + "]. Expected [yaml] or [binary].");
+    }
 
-  conflict_proposal_sub = create_subscription<ConflictProposal>(
-    rmf_traffic_ros2::NegotiationProposalTopicName, negotiation_qos,
-    [&](const ConflictProposal::UniquePtr msg)
+    bool async_logging = false;
+    get_parameter_or("async_participant_logging", async_logging, false);
+    if (async_logging)
     {
-      this->receive_proposal(*msg);
-    });
+      ParticipantRegistry::AsyncLogging async;
+      async.on_durable =
+        [logger = get_logger()](
+        const AtomicOperation& op, const std::exception_ptr& error)
+        {
+          if (!error)
+            return;
 
-  conflict_rejection_sub = create_subscription<ConflictRejection>(
-    rmf_traffic_ros2::NegotiationRejectionTopicName, negotiation_qos,
-    [&](const ConflictRejection::UniquePtr msg)
-    {
-      this->receive_rejection(*msg);
-    });
-
-  conflict_forfeit_sub = create_subscription<ConflictForfeit>(
-    rmf_traffic_ros2::NegotiationForfeitTopicName, negotiation_qos,
-    [&](const ConflictForfeit::UniquePtr msg)
-    {
-      this->receive_forfeit(*msg);
-    });
-
-  conflict_conclusion_pub = create_publisher<ConflictConclusion>(
-    rmf_traffic_ros2::NegotiationConclusionTopicName, negotiation_qos);
-
-  conflict_check_quit = false;
-  conflict_check_thread = std::thread(
-    [&]()
-    {
-      rmf_traffic::schedule::Mirror mirror;
-      const auto query_all = rmf_traffic::schedule::query_all();
-      Version last_checked_version = 0;
-
-      while (rclcpp::ok(get_node_options().context()) && !conflict_check_quit)
-      {
-        rmf_utils::optional<rmf_traffic::schedule::Patch> next_patch;
-        rmf_traffic::schedule::Viewer::View view_changes;
-
-        // Use this scope to minimize how long we lock the database for
-        {
-          std::unique_lock<std::mutex> lock(database_mutex);
-          conflict_check_cv.wait_for(lock, std::chrono::milliseconds(100), [&]()
-          {
-            return (database->latest_version() > last_checked_version)
-            && !conflict_check_quit;
-          });
-
-          if ( (database->latest_version() == last_checked_version
-          && last_known_participants_version == current_participants_version)
-          || conflict_check_quit)
-          {
-            // This is a casual wakeup to check if we're supposed to quit yet
-            continue;
-          }
-
-          if (last_known_participants_version != current_participants_version)
-          {
-            last_known_participants_version = current_participants_version;
-            rmf_traffic::schedule::ParticipantDescriptionsMap participants;
-            for (const auto& id: database->participant_ids())
-            {
-              participants.insert({id, *database->get_participant(id)});
-            }
-
-            try
-            {
-              mirror.update_participants_info(participants);
-            }
-            catch (const std::exception& e)
-            {
-              RCLCPP_ERROR(get_logger(), e.what());
-            }
-          }
-
-          next_patch = database->changes(query_all, last_checked_version);
-          // TODO(MXG): Check whether the database really needs to remain locked
-          // during this update.
           try
           {
-            mirror.update(*next_patch);
-            view_changes = database->query(query_all, last_checked_version);
-            last_checked_version = next_patch->latest_version();
+            std::rethrow_exception(error);
           }
           catch (const std::exception& e)
           {
-            RCLCPP_ERROR(get_logger(), e.what());
-            continue;
+            RCLCPP_ERROR(
+              logger,
+              "Failed to log participant [%s] owned by [%s]: %s",
+              op.description.name().c_str(),
+              op.description.owner().c_str(),
+              e.what());
           }
-        }
+        };
 
-        const auto conflicts = get_conflicts(view_changes, mirror);
-        std::unordered_map<Version, const Negotiation*> new_negotiations;
-        for (const auto& conflict : conflicts)
-        {
-          std::unique_lock<std::mutex> lock(active_conflicts_mutex);
-          const auto new_negotiation = active_conflicts.insert(conflict);
+      participant_registry =
+        std::make_shared<ParticipantRegistry>(
+        std::move(participant_logger),
+        database,
+        std::move(async));
+    }
+    else
+    {
+      participant_registry =
+        std::make_shared<ParticipantRegistry>(
+        std::move(participant_logger),
+        database);
+    }
 
-          if (new_negotiation)
-            new_negotiations[new_negotiation->first] = new_negotiation->second;
-        }
+    RCLCPP_INFO(get_logger(),
+      "Successfully loaded logfile %s ",
+      log_file_name.c_str());
+  }
+  catch (std::runtime_error& e)
+  {
+    RCLCPP_FATAL(get_logger(),
+      "Failed to correctly load participant registry: %s\n",
+      e.what());
+    throw e;
+  }
+}
 
-        for (const auto& n : new_negotiations)
-        {
-          ConflictNotice msg;
-          msg.conflict_version = n.first;
+//==============================================================================
+std::optional<ScheduleSnapshot> ScheduleNode::load_schedule_snapshot()
+{
+  if (schedule_snapshot_file.empty())
+    return std::nullopt;
 
-          const auto& participants = n.second->participants();
-          msg.participants = ConflictNotice::_participants_type(
-            participants.begin(), participants.end());
+  try
+  {
+    return read_schedule_snapshot(schedule_snapshot_file);
+  }
+  catch (const std::exception& e)
+  {
+    RCLCPP_ERROR(
+      get_logger(),
+      "Ignoring schedule snapshot: %s",
+      e.what());
+  }
 
-          conflict_notice_pub->publish(msg);
-        }
-      }
-    });
+  return std::nullopt;
 }
 
 //==============================================================================
-void ScheduleNode::setup_redundancy()
+void ScheduleNode::setup_schedule_snapshots()
 {
-  start_heartbeat();
-
-  participants_info_pub =
-    create_publisher<ParticipantsInfo>(
-    rmf_traffic_ros2::ParticipantsInfoTopicName,
-    rclcpp::SystemDefaultsQoS().reliable().keep_last(1).transient_local());
-
-  queries_info_pub =
-    create_publisher<ScheduleQueries>(
-    rmf_traffic_ros2::QueriesInfoTopicName,
-    rclcpp::SystemDefaultsQoS().reliable().keep_last(1).transient_local());
+  if (schedule_snapshot_file.empty())
+    return;
 
-  broadcast_queries();
+  snapshot_thread = std::thread([this]() { this->write_schedule_snapshots(); });
+  schedule_snapshot_timer = rmf_traffic_ros2::create_timer(
+    *this,
+    schedule_snapshot_period, [this]() { this->capture_schedule_snapshot(); },
+    services_callback_group);
 }
 
 //==============================================================================
-void ScheduleNode::start_heartbeat()
+void ScheduleNode::setup_schedule_retention()
 {
-  // Set up liveliness announcements of this node, powered by DDS[tm][r][c][rgb]
-  heartbeat_qos_profile
-  .liveliness(RMW_QOS_POLICY_LIVELINESS_AUTOMATIC)
-  .liveliness_lease_duration(heartbeat_period)
-  .deadline(heartbeat_period);
+  if (schedule_retention_horizon.count() <= 0 && schedule_memory_budget == 0)
+    return;
 
-  heartbeat_pub = create_publisher<Heartbeat>(
-    rmf_traffic_ros2::HeartbeatTopicName,
-    heartbeat_qos_profile);
-  RCLCPP_INFO(
-    get_logger(),
-    "Set up heartbeat on %s with liveliness lease duration of %ld ms "
-    "and deadline of %ld ms",
-    heartbeat_pub->get_topic_name(),
-    heartbeat_period.count(),
-    heartbeat_period.count());
+  schedule_cull_timer = rmf_traffic_ros2::create_timer(
+    *this,
+    schedule_cull_period, [this]() { this->cull_schedule(); },
+    ingest_callback_group);
 }
 
 //==============================================================================
-void ScheduleNode::make_mirror_update_topics(const QueryMap& queries)
+void ScheduleNode::setup_memory_usage()
 {
-  // Delete any existing topics, just to be sure
-  registered_queries.clear();
+  if (memory_usage_period.count() <= 0)
+    return;
 
-  for (const auto& [query_id, query] : queries)
-  {
-    register_query(query_id, query);
-    RCLCPP_INFO(get_logger(), "Registering query ID %ld", query_id);
-  }
+  memory_usage_pub = create_publisher<MemoryUsageMsg>(
+    rmf_traffic_ros2::MemoryUsageTopicName,
+    rclcpp::SystemDefaultsQoS().reliable().keep_last(10));
+
+  // The ingest group keeps this from running alongside the itinerary
+  // callbacks, which own the queue of pending itinerary messages
+  memory_usage_timer = rmf_traffic_ros2::create_timer(
+    *this,
+    memory_usage_period, [this]() { this->publish_memory_usage(); },
+    ingest_callback_group);
 }
 
 //==============================================================================
-void ScheduleNode::register_query(
-  const std::shared_ptr<rmw_request_id_t>& /*request_header*/,
-  const RegisterQuery::Request::SharedPtr& request,
-  const RegisterQuery::Response::SharedPtr& response)
+void ScheduleNode::publish_memory_usage()
 {
-  rmf_traffic::schedule::Query new_query =
-    rmf_traffic_ros2::convert(request->query);
+  MemoryUsage usage;
+  usage.add(
+    "itinerary.pending",
+    pending_itinerary_msgs.size(),
+    memory::heap_bytes(pending_itinerary_msgs));
+
+  usage.add(
+    "inconsistency_reports",
+    last_inconsistency_reports.size(),
+    memory::heap_bytes(last_inconsistency_reports)
+    + memory::heap_bytes(pending_inconsistency_reports));
 
-  response->node_version = node_version;
-
-  // Search for an existing query with the same search parameters
-  for (auto& [existing_query_id, existing_query] : registered_queries)
   {
-    if (existing_query.query == new_query)
+    TracedLock lock(database_mutex, "database_mutex");
+    std::size_t routes = 0;
+    std::size_t route_bytes = 0;
+    for (const auto id : database->participant_ids())
     {
-      RCLCPP_INFO(
-        get_logger(),
-        "A new mirror is tracking query ID [%ld]",
-        existing_query_id);
+      const auto itinerary = database->get_itinerary(id);
+      if (!itinerary)
+        continue;
 
-      existing_query.last_registration_time = std::chrono::steady_clock::now();
-      response->query_id = existing_query_id;
-      broadcast_queries();
-      return;
+      routes += itinerary->size();
+      for (const auto& route : *itinerary)
+        route_bytes += estimate_route_bytes(*route);
     }
+
+    usage.add("database.routes", routes, route_bytes);
   }
 
-  // Find an unused query ID, store the query, and create a topic to publish
-  // updates that match it.
-  //
-  // Note that this search may begin at query ID 0 if this is the first time
-  // it is performed on a replacement schedule node. This is because the set
-  // of queries will have been filled in from the original schedule node's
-  // synchronised data, but last_query_id will have been initialised to zero
-  // when the replacement was constructed. This is not a problem because a
-  // search for the next available query ID does not need to be performed
-  // until we actually need a new query ID, so performing it in the
-  // constructor in advance would be unnecessary early optimisation.
-  uint64_t query_id = last_query_id;
-  uint64_t attempts = 0;
-  do
   {
-    ++query_id;
-    ++attempts;
-    if (attempts == std::numeric_limits<uint64_t>::max())
-    {
-      // I suspect a computer would run out of RAM before we reach this point,
-      // but there's no harm in double-checking.
-      response->error =
-        "No more space for additional queries to be registered";
-      RCLCPP_ERROR(
-        get_logger(),
-        "[ScheduleNode::register_query] %s",
-        response->error.c_str());
-      return;
-    }
-  } while (registered_queries.find(query_id) != registered_queries.end());
+    std::lock_guard<std::mutex> lock(queries_mutex);
+    usage.add(
+      "mirror.queries",
+      registered_queries.size(),
+      memory::heap_bytes(
+        registered_queries,
+        [](const auto& element)
+        {
+          const auto& info = element.second;
+          return memory::heap_bytes(info.rate_lanes);
+        }));
+  }
 
-  response->query_id = query_id;
-  register_query(query_id, new_query);
-  last_query_id = query_id;
-  RCLCPP_INFO(get_logger(), "Registered new query [%ld]", query_id);
+  {
+    TracedLock lock(active_conflicts_mutex, "active_conflicts_mutex");
+    usage.add(
+      "negotiation.open",
+      active_conflicts._negotiations.size(),
+      memory::heap_bytes(
+        active_conflicts._negotiations,
+        [](const auto& element)
+        {
+          return element.second ? estimate_room_bytes(*element.second) : 0;
+        })
+      + memory::heap_bytes(active_conflicts._version));
+
+    usage.add(
+      "negotiation.awaiting_acknowledgment",
+      active_conflicts._waiting.size(),
+      memory::heap_bytes(active_conflicts._waiting));
+  }
 
-  broadcast_queries();
+  MemoryUsageMsg msg;
+  msg.data = rmf_traffic_ros2::serialize(usage, get_fully_qualified_name());
+  memory_usage_pub->publish(msg);
 }
 
 //==============================================================================
-void ScheduleNode::register_query(
-  const uint64_t query_id,
-  const rmf_traffic::schedule::Query& query)
+ScheduleNode::Instruments::Instruments(Metrics& metrics)
+: itinerary_messages(metrics.counter(
+      "rmf_schedule_itinerary_messages",
+      "Itinerary messages that the schedule has ingested")),
+  itinerary_failures(metrics.counter(
+      "rmf_schedule_itinerary_failures",
+      "Itinerary messages that could not be applied to the schedule")),
+  ingest_seconds(metrics.histogram(
+      "rmf_schedule_ingest_seconds",
+      "How long each batch of itinerary messages took to ingest")),
+  conflicts(metrics.counter(
+      "rmf_schedule_conflicts",
+      "Conflicts that the schedule has detected")),
+  conflict_check_seconds(metrics.histogram(
+      "rmf_schedule_conflict_check_seconds",
+      "How long each cycle of the conflict check took")),
+  negotiations_opened(metrics.counter(
+      "rmf_schedule_negotiations_opened",
+      "Negotiations that the schedule has opened")),
+  negotiations_resolved(metrics.counter(
+      "rmf_schedule_negotiations_concluded",
+      "Negotiations that have concluded", {{"outcome", "resolved"}})),
+  negotiations_failed(metrics.counter(
+      "rmf_schedule_negotiations_concluded",
+      "Negotiations that have concluded", {{"outcome", "failed"}})),
+  resolved_negotiation_seconds(metrics.histogram(
+      "rmf_schedule_negotiation_seconds",
+      "How long negotiations took from their notice to their conclusion",
+      {{"outcome", "resolved"}})),
+  failed_negotiation_seconds(metrics.histogram(
+      "rmf_schedule_negotiation_seconds",
+      "How long negotiations took from their notice to their conclusion",
+      {{"outcome", "failed"}})),
+  mirror_updates(metrics.counter(
+      "rmf_schedule_mirror_updates",
+      "Updates that the schedule has published to its mirrors")),
+  participants(metrics.gauge(
+      "rmf_schedule_participants",
+      "Participants that are registered in the schedule")),
+  queries(metrics.gauge(
+      "rmf_schedule_queries",
+      "Mirror queries that are registered in the schedule")),
+  open_negotiations(metrics.gauge(
+      "rmf_schedule_open_negotiations",
+      "Negotiations that are currently open")),
+  schedule_version(metrics.gauge(
+      "rmf_schedule_version",
+      "The latest version of the schedule database")),
+  deferred_writes(metrics.gauge(
+      "rmf_schedule_deferred_writes",
+      "Itinerary messages that are deferred for going over quota")),
+  throttled_participants(metrics.gauge(
+      "rmf_schedule_throttled_participants",
+      "Participants whose itinerary messages are being deferred")),
+  superseded_writes(metrics.counter(
+      "rmf_schedule_superseded_writes",
+      "Deferred itinerary messages that were replaced by a newer itinerary"))
 {
-  MirrorUpdateTopicPublisher update_publisher =
-    create_publisher<MirrorUpdate>(
-    rmf_traffic_ros2::QueryUpdateTopicNameBase + std::to_string(query_id),
-    rclcpp::SystemDefaultsQoS());
+  // Do nothing
+}
 
-  registered_queries.emplace(
-    query_id,
-    QueryInfo{
-      query,
-      std::move(update_publisher),
-      std::nullopt,
-      std::chrono::steady_clock::now(),
-      {}
-    });
+//==============================================================================
+void ScheduleNode::setup_metrics()
+{
+  metrics_exporter = MetricsExporter::from_parameters(
+    *this, metrics, [this]() { this->refresh_metrics(); },
+    ingest_callback_group);
+
+  callback_watchdog = CallbackWatchdog::from_parameters(*this, metrics);
+
+  if (auto tracer = Tracer::from_parameters(*this))
+    tracing::set_tracer(std::move(tracer));
 }
 
 //==============================================================================
-void ScheduleNode::cleanup_queries()
+void ScheduleNode::refresh_metrics()
 {
-  bool any_erased = false;
-  const auto now = std::chrono::steady_clock::now();
-  auto it = registered_queries.begin();
-  while (it != registered_queries.end())
   {
-    if (it->second.publisher->get_subscription_count() == 0)
-    {
-      if (query_grace_period < now - it->second.last_registration_time)
-      {
-        // This query is considered deprecated, so we should erase it.
-        // It's important that we use the post-increment operator here so that
-        // we increment the iterator to its next value while erasing the element
-        // that it used to point at.
-        registered_queries.erase(it++);
-        any_erased = true;
-        continue;
-      }
-    }
+    TracedLock lock(database_mutex, "database_mutex");
+    instruments.participants->set(
+      static_cast<double>(database->participant_ids().size()));
+    instruments.schedule_version->set(
+      static_cast<double>(database->latest_version()));
+  }
 
-    ++it;
+  {
+    std::lock_guard<std::mutex> lock(queries_mutex);
+    instruments.queries->set(static_cast<double>(registered_queries.size()));
   }
 
-  if (any_erased)
-    broadcast_queries();
+  {
+    TracedLock lock(active_conflicts_mutex, "active_conflicts_mutex");
+    instruments.open_negotiations->set(
+      static_cast<double>(active_conflicts._negotiations.size()));
+  }
 }
 
 //==============================================================================
-void ScheduleNode::broadcast_queries()
+void ScheduleNode::negotiation_concluded(
+  const rmf_traffic::schedule::Version conflict_version,
+  const bool resolved)
 {
-  ScheduleQueries msg;
-  msg.node_version = node_version;
-
-  for (const auto& registered_query: registered_queries)
-  {
-    msg.ids.push_back(registered_query.first);
+  const auto latency = negotiation_status.concluded(conflict_version, resolved);
+  if (resolved)
+    instruments.negotiations_resolved->increment();
+  else
+    instruments.negotiations_failed->increment();
 
-    const rmf_traffic::schedule::Query& original =
-      registered_queries.at(registered_query.first).query;
+  if (!latency.has_value())
+    return;
 
-    msg.queries.emplace_back(rmf_traffic_ros2::convert(original));
-  }
+  if (resolved)
+    instruments.resolved_negotiation_seconds->observe(*latency);
+  else
+    instruments.failed_negotiation_seconds->observe(*latency);
 
-  queries_info_pub->publish(msg);
+  tracing::record(
+    "schedule.negotiation", tracing::negotiation(conflict_version), *latency,
+    {{"rmf.outcome", resolved ? "resolved" : "failed"}});
 }
 
 //==============================================================================
-void ScheduleNode::register_participant(
-  const request_id_ptr& /*request_header*/,
-  const RegisterParticipant::Request::SharedPtr& request,
-  const RegisterParticipant::Response::SharedPtr& response)
+void ScheduleNode::cull_schedule()
 {
-  std::unique_lock<std::mutex> lock(database_mutex);
+  const auto now = rmf_traffic_ros2::convert(get_clock()->now());
 
-  // TODO(MXG): Use try on every database operation
-  try
+  std::optional<rmf_traffic::Time> cull_time;
+  if (schedule_retention_horizon.count() > 0)
+    cull_time = now - schedule_retention_horizon;
+
+  TracedLock lock(database_mutex, "database_mutex");
+  if (schedule_memory_budget > 0)
   {
-    const auto registration = participant_registry
-      ->add_or_retrieve_participant(
-      rmf_traffic_ros2::convert(request->description));
+    std::vector<RouteFootprint> footprints;
+    for (const auto id : database->participant_ids())
+    {
+      const auto itinerary = database->get_itinerary(id);
+      if (!itinerary)
+        continue;
 
-    using Response = rmf_traffic_msgs::srv::RegisterParticipant::Response;
+      for (const auto& route : *itinerary)
+      {
+        const auto* const finish = route->trajectory().finish_time();
+        if (!finish)
+          continue;
 
-    *response =
-      rmf_traffic_msgs::build<Response>()
-      .participant_id(registration.id())
-      .last_itinerary_version(registration.last_itinerary_version())
-      .last_route_id(registration.last_route_id())
-      .error("");
+        footprints.push_back({*finish, estimate_route_bytes(*route)});
+      }
+    }
 
-    RCLCPP_INFO(
-      get_logger(),
-      "Registered participant [%ld] named [%s] owned by [%s]",
-      response->participant_id,
-      request->description.name.c_str(),
+    const auto budget_time = choose_budget_cull_time(
+      std::move(footprints), schedule_memory_budget, now);
+    if (budget_time && (!cull_time || *cull_time < *budget_time))
+      cull_time = budget_time;
+  }
+
+  if (!cull_time || (last_cull_time && *cull_time <= *last_cull_time))
+    return;
+
+  database->cull(*cull_time);
+  last_cull_time = cull_time;
+  lock.unlock();
+
+  conflict_check_cv.notify_all();
+  schedule_mirror_update();
+}
+
+//==============================================================================
+void ScheduleNode::capture_schedule_snapshot()
+{
+  QueryMap queries;
+  {
+    std::lock_guard<std::mutex> queries_lock(queries_mutex);
+    for (const auto& [query_id, query_info] : registered_queries)
+      queries.insert({query_id, query_info.query});
+  }
+
+  TracedLock lock(database_mutex, "database_mutex");
+  const auto latest_version = database->latest_version();
+  if (last_snapshot_version == latest_version)
+    return;
+
+  auto snapshot =
+    take_schedule_snapshot(*database, std::move(queries), node_version);
+  lock.unlock();
+
+  last_snapshot_version = latest_version;
+
+  // If the last snapshot has not been written yet, it gets replaced because
+  // there is no value in saving an outdated schedule.
+  {
+    std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex);
+    pending_snapshot = std::move(snapshot);
+  }
+  snapshot_cv.notify_all();
+}
+
+//==============================================================================
+void ScheduleNode::write_schedule_snapshots()
+{
+  std::unique_lock<std::mutex> lock(snapshot_mutex);
+  while (true)
+  {
+    snapshot_cv.wait(
+      lock, [this]() { return snapshot_quit || pending_snapshot.has_value(); });
+
+    if (!pending_snapshot.has_value())
+      return;
+
+    auto snapshot = std::move(*pending_snapshot);
+    pending_snapshot = std::nullopt;
+    lock.unlock();
+
+    try
+    {
+      write_schedule_snapshot(schedule_snapshot_file, snapshot);
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_ERROR(
+        get_logger(),
+        "Failed to save schedule snapshot: %s",
+        e.what());
+    }
+
+    lock.lock();
+  }
+}
+
+//==============================================================================
+void ScheduleNode::setup_query_services()
+{
+  register_query_service =
+    create_service<RegisterQuery>(
+    rmf_traffic_ros2::RegisterQueryServiceName,
+    [=](const std::shared_ptr<rmw_request_id_t> request_header,
+    const RegisterQuery::Request::SharedPtr request,
+    const RegisterQuery::Response::SharedPtr response)
+    { this->register_query(request_header, request, response); },
+    rmw_qos_profile_services_default,
+    services_callback_group);
+
+  // TODO(MXG): We could expose the timing parameters to the user so the
+  // frequency of cleanups can be customized.
+  query_cleanup_timer =
+    rmf_traffic_ros2::create_timer(
+    *this,
+    query_cleanup_period,
+    [this]() { this->cleanup_queries(); },
+    services_callback_group);
+}
+
+//==============================================================================
+void ScheduleNode::setup_participant_services()
+{
+  register_participant_service =
+    create_service<RegisterParticipant>(
+    rmf_traffic_ros2::RegisterParticipantSrvName,
+    [=](const request_id_ptr request_header,
+    const RegisterParticipant::Request::SharedPtr request,
+    const RegisterParticipant::Response::SharedPtr response)
+    { this->register_participant(request_header, request, response); },
+    rmw_qos_profile_services_default,
+    services_callback_group);
+
+  unregister_participant_service =
+    create_service<UnregisterParticipant>(
+    rmf_traffic_ros2::UnregisterParticipantSrvName,
+    [=](const request_id_ptr request_header,
+    const UnregisterParticipant::Request::SharedPtr request,
+    const UnregisterParticipant::Response::SharedPtr response)
+    { this->unregister_participant(request_header, request, response); },
+    rmw_qos_profile_services_default,
+    services_callback_group);
+
+  const auto bulk_qos = rclcpp::SystemDefaultsQoS().reliable().keep_last(10);
+
+  bulk_registration_response_pub = create_publisher<CompactUpdate>(
+    rmf_traffic_ros2::BulkRegistrationResponseTopicName, bulk_qos);
+
+  bulk_registration_request_sub = create_subscription<CompactUpdate>(
+    rmf_traffic_ros2::BulkRegistrationRequestTopicName,
+    bulk_qos,
+    [=](const CompactUpdate::UniquePtr msg)
+    {
+      this->register_participants(*msg);
+    },
+    subscription_options(services_callback_group));
+}
+
+//==============================================================================
+void ScheduleNode::setup_changes_services()
+{
+  request_changes_service =
+    create_service<RequestChanges>(
+    rmf_traffic_ros2::RequestChangesServiceName,
+    [=](const request_id_ptr request_header,
+    const RequestChanges::Request::SharedPtr request,
+    const RequestChanges::Response::SharedPtr response)
+    { this->request_changes(request_header, request, response); },
+    rmw_qos_profile_services_default,
+    services_callback_group);
+
+  request_sync_service =
+    create_service<RequestChanges>(
+    rmf_traffic_ros2::RequestSyncServiceName,
+    [=](const request_id_ptr request_header,
+    const RequestChanges::Request::SharedPtr request,
+    const RequestChanges::Response::SharedPtr response)
+    { this->request_sync(request_header, request, response); },
+    rmw_qos_profile_services_default,
+    services_callback_group);
+}
+
+//==============================================================================
+void ScheduleNode::setup_itinerary_topics()
+{
+  const auto itinerary_qos =
+    rclcpp::SystemDefaultsQoS()
+    .reliable()
+    .keep_last(100);
+
+  itinerary_set_sub =
+    create_subscription<ItinerarySet>(
+    rmf_traffic_ros2::ItinerarySetTopicName,
+    itinerary_qos,
+    [=](ItinerarySet::UniquePtr msg)
+    {
+      if (this->ingress_quota && !this->admit_itinerary_msg(*msg))
+        return;
+
+      if (this->batch_itinerary_ingestion)
+        this->queue_itinerary_msg(std::move(*msg));
+      else
+        this->itinerary_set(*msg);
+    },
+    subscription_options(ingest_callback_group));
+
+  itinerary_extend_sub =
+    create_subscription<ItineraryExtend>(
+    rmf_traffic_ros2::ItineraryExtendTopicName,
+    itinerary_qos,
+    [=](ItineraryExtend::UniquePtr msg)
+    {
+      if (this->ingress_quota && !this->admit_itinerary_msg(*msg))
+        return;
+
+      if (this->batch_itinerary_ingestion)
+        this->queue_itinerary_msg(std::move(*msg));
+      else
+        this->itinerary_extend(*msg);
+    },
+    subscription_options(ingest_callback_group));
+
+  itinerary_delay_sub =
+    create_subscription<ItineraryDelay>(
+    rmf_traffic_ros2::ItineraryDelayTopicName,
+    itinerary_qos,
+    [=](ItineraryDelay::UniquePtr msg)
+    {
+      if (this->ingress_quota && !this->admit_itinerary_msg(*msg))
+        return;
+
+      if (this->batch_itinerary_ingestion)
+        this->queue_itinerary_msg(std::move(*msg));
+      else
+        this->itinerary_delay(*msg);
+    },
+    subscription_options(ingest_callback_group));
+
+  itinerary_erase_sub =
+    create_subscription<ItineraryErase>(
+    rmf_traffic_ros2::ItineraryEraseTopicName,
+    itinerary_qos,
+    [=](ItineraryErase::UniquePtr msg)
+    {
+      if (this->ingress_quota && !this->admit_itinerary_msg(*msg))
+        return;
+
+      if (this->batch_itinerary_ingestion)
+        this->queue_itinerary_msg(std::move(*msg));
+      else
+        this->itinerary_erase(*msg);
+    },
+    subscription_options(ingest_callback_group));
+
+  itinerary_clear_sub =
+    create_subscription<ItineraryClear>(
+    rmf_traffic_ros2::ItineraryClearTopicName,
+    itinerary_qos,
+    [=](ItineraryClear::UniquePtr msg)
+    {
+      if (this->ingress_quota && !this->admit_itinerary_msg(*msg))
+        return;
+
+      if (this->batch_itinerary_ingestion)
+        this->queue_itinerary_msg(std::move(*msg));
+      else
+        this->itinerary_clear(*msg);
+    },
+    subscription_options(ingest_callback_group));
+
+  itinerary_batch_sub =
+    create_subscription<CompactUpdate>(
+    rmf_traffic_ros2::ItineraryBatchTopicName,
+    itinerary_qos,
+    [=](CompactUpdate::UniquePtr msg)
+    {
+      this->itinerary_batch(*msg);
+    },
+    subscription_options(ingest_callback_group));
+}
+
+//==============================================================================
+void ScheduleNode::setup_incosistency_pub()
+{
+  inconsistency_pub =
+    create_publisher<InconsistencyMsg>(
+    rmf_traffic_ros2::ScheduleInconsistencyTopicName,
+    rclcpp::SystemDefaultsQoS().reliable());
+}
+
+//==============================================================================
+void ScheduleNode::setup_conflict_topics_and_thread()
+{
+  const auto negotiation_qos = rclcpp::ServicesQoS().reliable();
+  conflict_ack_sub = create_subscription<ConflictAck>(
+    registrar_topic_name(rmf_traffic_ros2::NegotiationAckTopicName),
+    negotiation_qos,
+    [&](const ConflictAck::UniquePtr msg)
+    {
+      this->receive_conclusion_ack(*msg);
+    },
+    subscription_options(negotiation_callback_group));
+
+  conflict_notice_pub = std::make_unique<ConflictNoticePub>(
+    *this, registrar_topic_name(rmf_traffic_ros2::NegotiationNoticeTopicName),
+    negotiation_qos,
+    negotiation_topic_shards);
+
+  conflict_refusal_sub = create_subscription<ConflictRefusal>(
+    registrar_topic_name(rmf_traffic_ros2::NegotiationRefusalTopicName),
+    negotiation_qos,
+    [&](const ConflictRefusal::UniquePtr msg)
+    {
+      this->receive_refusal(*msg);
+    },
+    subscription_options(negotiation_callback_group));
+
+  // The schedule node takes part in every negotiation, so it listens to
+  // every shard.
+  conflict_proposal_subs = std::make_unique<ConflictProposalSubs>(
+    *this, registrar_topic_name(rmf_traffic_ros2::NegotiationProposalTopicName),
+    negotiation_qos,
+    negotiation_topic_shards,
+    [this](const ConflictProposal& msg)
+    {
+      this->receive_proposal(msg);
+    },
+    subscription_options(negotiation_callback_group));
+  conflict_proposal_subs->subscribe_all();
+
+  conflict_proposal_diff_subs = std::make_unique<ConflictProposalDiffSubs>(
+    *this,
+    registrar_topic_name(rmf_traffic_ros2::NegotiationProposalDiffTopicName),
+    negotiation_qos, negotiation_topic_shards,
+    [this](const CompactUpdate& msg)
+    {
+      this->receive_proposal_diff(msg);
+    },
+    subscription_options(negotiation_callback_group));
+  conflict_proposal_diff_subs->subscribe_all();
+
+  conflict_repeat_pub = create_publisher<ConflictRepeat>(
+    registrar_topic_name(rmf_traffic_ros2::NegotiationRepeatTopicName),
+    negotiation_qos);
+
+  conflict_rejection_subs = std::make_unique<ConflictRejectionSubs>(
+    *this,
+    registrar_topic_name(rmf_traffic_ros2::NegotiationRejectionTopicName),
+    negotiation_qos,
+    negotiation_topic_shards,
+    [this](const ConflictRejection& msg)
+    {
+      this->receive_rejection(msg);
+    },
+    subscription_options(negotiation_callback_group));
+  conflict_rejection_subs->subscribe_all();
+
+  conflict_forfeit_subs = std::make_unique<ConflictForfeitSubs>(
+    *this, registrar_topic_name(rmf_traffic_ros2::NegotiationForfeitTopicName),
+    negotiation_qos,
+    negotiation_topic_shards,
+    [this](const ConflictForfeit& msg)
+    {
+      this->receive_forfeit(msg);
+    },
+    subscription_options(negotiation_callback_group));
+  conflict_forfeit_subs->subscribe_all();
+
+  conflict_conclusion_pub = std::make_unique<ConflictConclusionPub>(
+    *this,
+    registrar_topic_name(rmf_traffic_ros2::NegotiationConclusionTopicName),
+    negotiation_qos,
+    negotiation_topic_shards);
+
+  if (negotiation_status_period.count() > 0)
+  {
+    negotiation_status_pub = create_publisher<NegotiationStatusMsg>(
+      registrar_topic_name(rmf_traffic_ros2::NegotiationStatusTopicName),
+      rclcpp::SystemDefaultsQoS().reliable().keep_last(1));
+
+    negotiation_status_timer = rmf_traffic_ros2::create_timer(
+      *this,
+      negotiation_status_period,
+      [this]()
+      {
+        this->publish_negotiation_status();
+      },
+      negotiation_callback_group);
+  }
+  else
+  {
+    // Nothing will ever collect the conclusions
+    negotiation_status.keep_conclusions(false);
+  }
+
+  conflict_check_quit = false;
+  conflict_check_thread = std::thread(
+    [&]()
+    {
+      const auto apply_thread_settings =
+        conflict_check_thread_settings.applier(*this, "conflict_check");
+      apply_thread_settings();
+
+      rmf_traffic::schedule::Mirror mirror;
+      ConflictBroadphase broadphase(conflict_broadphase_time_bucket);
+      ConflictCache cache;
+
+      // This thread is one of the workers, so the pool only needs helpers for
+      // the remaining threads.
+      WorkerPool pool(conflict_check_threads - 1, apply_thread_settings);
+      const auto query_all = rmf_traffic::schedule::query_all();
+      Version last_checked_version = 0;
+      DeferredChecks deferred;
+
+      while (rclcpp::ok(get_node_options().context()) && !conflict_check_quit)
+      {
+        // Changes that were set aside because they began after the look-ahead
+        // window get checked once the window reaches them.
+        std::optional<rmf_traffic::Time> horizon_end;
+        std::vector<ParticipantId> due;
+        if (conflict_check_horizon.count() > 0)
+        {
+          horizon_end =
+            rmf_traffic_ros2::convert(get_clock()->now())
+            + conflict_check_horizon;
+
+          for (auto it = deferred.begin(); it != deferred.end(); )
+          {
+            if (it->second <= *horizon_end)
+            {
+              due.push_back(it->first);
+              it = deferred.erase(it);
+            }
+            else
+            {
+              ++it;
+            }
+          }
+        }
+
+        rmf_utils::optional<rmf_traffic::schedule::Patch> next_patch;
+        rmf_traffic::schedule::Viewer::View view_changes;
+
+        // The profiles of participants may have changed, in which case every
+        // route needs to be re-indexed.
+        bool reindex_all = false;
+        std::optional<rmf_traffic::schedule::ParticipantDescriptionsMap>
+        participants;
+
+        // Use this scope to minimize how long we lock the database for
+        {
+          TracedLock lock(database_mutex, "database_mutex");
+          conflict_check_cv.wait_for(lock, std::chrono::milliseconds(100), [&]()
+          {
+            return (database->latest_version() > last_checked_version
+            || !due.empty()) && !conflict_check_quit;
+          });
+
+          if ( (database->latest_version() == last_checked_version
+          && last_known_participants_version == current_participants_version
+          && due.empty())
+          || conflict_check_quit)
+          {
+            // This is a casual wakeup to check if we're supposed to quit yet
+            continue;
+          }
+
+          if (last_known_participants_version != current_participants_version)
+          {
+            last_known_participants_version = current_participants_version;
+            participants.emplace();
+            for (const auto& id: database->participant_ids())
+            {
+              participants->insert({id, *database->get_participant(id)});
+            }
+          }
+
+          // Only extract the changes while the database is locked. The patch
+          // and the view hold their own references to the route data, so the
+          // expensive work of applying them to the mirror can happen after the
+          // lock is released, without blocking the itinerary callbacks.
+          try
+          {
+            next_patch = database->changes(query_all, last_checked_version);
+            view_changes = database->query(query_all, last_checked_version);
+          }
+          catch (const std::exception& e)
+          {
+            RCLCPP_ERROR(get_logger(), e.what());
+            continue;
+          }
+        }
+
+        if (participants)
+        {
+          try
+          {
+            mirror.update_participants_info(*participants);
+            reindex_all = true;
+          }
+          catch (const std::exception& e)
+          {
+            RCLCPP_ERROR(get_logger(), e.what());
+          }
+        }
+
+        try
+        {
+          mirror.update(*next_patch);
+          last_checked_version = next_patch->latest_version();
+        }
+        catch (const std::exception& e)
+        {
+          RCLCPP_ERROR(get_logger(), e.what());
+          continue;
+        }
+
+        // Keep the broadphase index in sync with the mirror. Only participants
+        // that appear in the patch need to be re-indexed, unless the patch
+        // culled old routes from every participant.
+        if (reindex_all || next_patch->cull())
+        {
+          broadphase.rebuild(mirror);
+        }
+        else
+        {
+          for (const auto& p : *next_patch)
+            broadphase.update(p.participant_id(), mirror);
+        }
+
+        // Cached verdicts depend on the participant profiles
+        if (reindex_all)
+          cache.clear();
+        else
+          cache.next_cycle();
+
+        const auto check_start = std::chrono::steady_clock::now();
+        std::vector<ConflictSet> conflicts;
+        try
+        {
+          TraceScope trace("get_conflicts");
+          conflicts = get_conflicts(
+            view_changes, mirror, broadphase, cache, pool,
+            horizon_end, deferred);
+
+          if (!due.empty())
+          {
+            auto due_query = query_all;
+            due_query.participants() =
+              rmf_traffic::schedule::Query::Participants::make_only(due);
+            const auto due_view = mirror.query(
+              due_query.spacetime(), due_query.participants());
+
+            auto due_conflicts = get_conflicts(
+              due_view, mirror, broadphase, cache, pool,
+              horizon_end, deferred);
+            conflicts.insert(
+              conflicts.end(), due_conflicts.begin(), due_conflicts.end());
+          }
+        }
+        catch (const std::exception& e)
+        {
+          RCLCPP_ERROR(get_logger(), e.what());
+          continue;
+        }
+
+        RMF_TRAFFIC_ROS2_TRACE(
+          "conflicts_checked", "changes=%lu due=%lu conflicts=%lu",
+          view_changes.size(), due.size(), conflicts.size());
+
+        instruments.conflict_check_seconds->observe(
+          std::chrono::steady_clock::now() - check_start);
+        instruments.conflicts->increment(conflicts.size());
+
+        if (observers.conflicts_checked)
+          observers.conflicts_checked(last_checked_version);
+
+        // Every negotiation that gets opened during this cycle starts from
+        // the same snapshot of the schedule, so the schedule only needs to be
+        // copied once no matter how many conflicts were found.
+        ConflictRecord::SnapshotPtr cycle_snapshot;
+        std::unordered_map<Version, const Negotiation*> new_negotiations;
+        for (const auto& conflict : conflicts)
+        {
+          TracedLock lock(active_conflicts_mutex, "active_conflicts_mutex");
+          const auto new_negotiation =
+            active_conflicts.insert(conflict, cycle_snapshot);
+
+          if (new_negotiation)
+          {
+            new_negotiations[new_negotiation->first] = new_negotiation->second;
+            negotiation_status.opened(new_negotiation->first);
+            instruments.negotiations_opened->increment();
+          }
+        }
+
+        for (const auto& n : new_negotiations)
+        {
+          ConflictNotice msg;
+          msg.conflict_version = n.first;
+
+          const auto& participants = n.second->participants();
+          msg.participants = ConflictNotice::_participants_type(
+            participants.begin(), participants.end());
+
+          conflict_notice_pub->publish(msg, msg.participants);
+        }
+      }
+    });
+}
+
+//==============================================================================
+void ScheduleNode::setup_redundancy()
+{
+  start_heartbeat();
+
+  participants_info_pub =
+    create_publisher<ParticipantsInfo>(
+    rmf_traffic_ros2::ParticipantsInfoTopicName,
+    rclcpp::SystemDefaultsQoS().reliable().keep_last(1).transient_local(),
+    middleware_publisher_options());
+
+  participants_delta_pub =
+    create_publisher<CompactUpdate>(
+    rmf_traffic_ros2::ParticipantsDeltaTopicName,
+    rclcpp::SystemDefaultsQoS().reliable()
+    .keep_last(2*ParticipantsResyncInterval).transient_local(),
+    middleware_publisher_options());
+
+  participants_resync_timer = rmf_traffic_ros2::create_timer(
+    *this,
+    participants_resync_period,
+    [this]()
+    {
+      TracedLock lock(this->database_mutex, "database_mutex");
+      this->broadcast_participants_resync();
+    },
+    services_callback_group);
+
+  queries_info_pub =
+    create_publisher<ScheduleQueries>(
+    rmf_traffic_ros2::QueriesInfoTopicName,
+    rclcpp::SystemDefaultsQoS().reliable().keep_last(1).transient_local(),
+    middleware_publisher_options());
+
+  broadcast_participants_resync();
+  broadcast_queries();
+}
+
+//==============================================================================
+void ScheduleNode::start_heartbeat()
+{
+  // Set up liveliness announcements of this node, powered by DDS[tm][r][c][rgb]
+  heartbeat_qos_profile
+  .liveliness(
+    manual_heartbeat ?
+    RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC :
+    RMW_QOS_POLICY_LIVELINESS_AUTOMATIC)
+  .liveliness_lease_duration(heartbeat_lease_duration)
+  .deadline(manual_heartbeat ? heartbeat_lease_duration : heartbeat_period);
+
+  heartbeat_pub = create_publisher<Heartbeat>(
+    rmf_traffic_ros2::HeartbeatTopicName,
+    heartbeat_qos_profile);
+  RCLCPP_INFO(
+    get_logger(),
+    "Set up %s heartbeat on %s with liveliness lease duration of %ld ms "
+    "and deadline of %ld ms",
+    manual_heartbeat ? "manual" : "automatic",
+    heartbeat_pub->get_topic_name(),
+    heartbeat_lease_duration.count(),
+    manual_heartbeat ?
+    heartbeat_lease_duration.count() : heartbeat_period.count());
+
+  if (manual_heartbeat && !heartbeat_thread.joinable())
+    heartbeat_thread = std::thread([this]() { this->run_heartbeat(); });
+}
+
+//==============================================================================
+void ScheduleNode::run_heartbeat()
+{
+  // Publish several times per lease so that one late wakeup does not let the
+  // lease run out.
+  const auto period = std::max(
+    std::chrono::milliseconds(1), heartbeat_lease_duration / 4);
+
+  std::unique_lock<std::mutex> lock(heartbeat_mutex);
+  auto next = std::chrono::steady_clock::now();
+  while (!heartbeat_quit && rclcpp::ok(get_node_options().context()))
+  {
+    heartbeat_pub->publish(Heartbeat());
+
+    next += period;
+    heartbeat_cv.wait_until(lock, next, [this]() { return heartbeat_quit; });
+  }
+}
+
+//==============================================================================
+void ScheduleNode::make_mirror_update_topics(const QueryMap& queries)
+{
+  std::lock_guard<std::mutex> lock(queries_mutex);
+
+  // Delete any existing topics, just to be sure
+  registered_queries.clear();
+  query_index.clear();
+
+  for (const auto& [query_id, query] : queries)
+  {
+    register_query(query_id, query);
+    RCLCPP_INFO(get_logger(), "Registering query ID %ld", query_id);
+  }
+}
+
+//==============================================================================
+void ScheduleNode::register_query(
+  const std::shared_ptr<rmw_request_id_t>& /*request_header*/,
+  const RegisterQuery::Request::SharedPtr& request,
+  const RegisterQuery::Response::SharedPtr& response)
+{
+  rmf_traffic::schedule::Query new_query =
+    rmf_traffic_ros2::convert(request->query);
+
+  response->node_version = node_version;
+
+  std::lock_guard<std::mutex> lock(queries_mutex);
+
+  // Search for an existing query with the same search parameters
+  if (const auto existing_query_id = find_registered_query(new_query))
+  {
+    RCLCPP_INFO(
+      get_logger(),
+      "A new mirror is tracking query ID [%ld]",
+      *existing_query_id);
+
+    // The set of queries has not changed, so the last broadcast, which is
+    // latched for late joiners, is still correct.
+    registered_queries.at(*existing_query_id).last_registration_time =
+      std::chrono::steady_clock::now();
+    response->query_id = *existing_query_id;
+    return;
+  }
+
+  // Find an unused query ID, store the query, and create a topic to publish
+  // updates that match it.
+  //
+  // Note that this search may begin at query ID 0 if this is the first time
+  // it is performed on a replacement schedule node. This is because the set
+  // of queries will have been filled in from the original schedule node's
+  // synchronised data, but last_query_id will have been initialised to zero
+  // when the replacement was constructed. This is not a problem because a
+  // search for the next available query ID does not need to be performed
+  // until we actually need a new query ID, so performing it in the
+  // constructor in advance would be unnecessary early optimisation.
+  uint64_t query_id = last_query_id;
+  uint64_t attempts = 0;
+  do
+  {
+    ++query_id;
+    ++attempts;
+    if (attempts == std::numeric_limits<uint64_t>::max())
+    {
+      // I suspect a computer would run out of RAM before we reach this point,
+      // but there's no harm in double-checking.
+      response->error =
+        "No more space for additional queries to be registered";
+      RCLCPP_ERROR(
+        get_logger(),
+        "[ScheduleNode::register_query] %s",
+        response->error.c_str());
+      return;
+    }
+  } while (registered_queries.find(query_id) != registered_queries.end());
+
+  response->query_id = query_id;
+  register_query(query_id, new_query);
+  last_query_id = query_id;
+  RCLCPP_INFO(get_logger(), "Registered new query [%ld]", query_id);
+
+  broadcast_queries();
+}
+
+//==============================================================================
+void ScheduleNode::register_query(
+  const uint64_t query_id,
+  const rmf_traffic::schedule::Query& query)
+{
+  MirrorUpdateTopicPublisher update_publisher =
+    create_publisher<MirrorUpdate>(
+    rmf_traffic_ros2::QueryUpdateTopicNameBase + std::to_string(query_id),
+    rclcpp::SystemDefaultsQoS());
+
+  CompactUpdateTopicPublisher compact_publisher;
+  if (compact_mirror_updates)
+  {
+    compact_publisher = create_publisher<CompactUpdate>(
+      rmf_traffic_ros2::QueryUpdateTopicNameBase + std::to_string(query_id)
+      + rmf_traffic_ros2::CompactQueryUpdateTopicSuffix,
+      rclcpp::SystemDefaultsQoS());
+  }
+
+  // The sync topic only reaches joining mirrors, so it must be reliable and
+  // must not drop any chunk of a transfer.
+  CompactUpdateTopicPublisher sync_publisher =
+    create_publisher<CompactUpdate>(
+    rmf_traffic_ros2::QueryUpdateTopicNameBase + std::to_string(query_id)
+    + rmf_traffic_ros2::QuerySyncTopicSuffix,
+    rclcpp::QoS(rclcpp::KeepAll()).reliable(),
+    middleware_publisher_options());
+
+  std::vector<QueryInfo::RateLane> rate_lanes;
+  for (const auto period : mirror_update_rate_classes)
+  {
+    rate_lanes.push_back(
+      QueryInfo::RateLane{
+        period,
+        create_publisher<MirrorUpdate>(
+          rmf_traffic_ros2::QueryUpdateTopicNameBase + std::to_string(query_id)
+          + rmf_traffic_ros2::QueryRateClassTopicSuffix
+          + std::to_string(period.count()),
+          rclcpp::SystemDefaultsQoS()),
+        std::nullopt,
+        std::chrono::steady_clock::time_point()
+      });
+  }
+
+  for (const auto period : mirror_update_lod_rate_classes)
+  {
+    rate_lanes.push_back(
+      QueryInfo::RateLane{
+        period,
+        create_publisher<MirrorUpdate>(
+          rmf_traffic_ros2::QueryUpdateTopicNameBase + std::to_string(query_id)
+          + rmf_traffic_ros2::QueryLevelOfDetailTopicSuffix
+          + std::to_string(period.count()),
+          rclcpp::SystemDefaultsQoS()),
+        std::nullopt,
+        std::chrono::steady_clock::time_point(),
+        true
+      });
+  }
+
+  const auto inserted = registered_queries.emplace(
+    query_id,
+    QueryInfo{
+      query,
+      std::move(update_publisher),
+      std::nullopt,
+      std::chrono::steady_clock::now(),
+      {},
+      std::move(compact_publisher),
+      std::move(sync_publisher),
+      std::move(rate_lanes),
+      rmf_traffic_ros2::convert(query)
+    }).second;
+
+  if (inserted)
+    query_index.emplace(QueryHash()(query), query_id);
+
+  // Make sure the new query gets its initial update
+  schedule_mirror_update();
+}
+
+//==============================================================================
+void ScheduleNode::cleanup_queries()
+{
+  std::lock_guard<std::mutex> lock(queries_mutex);
+  bool any_erased = false;
+  const auto now = std::chrono::steady_clock::now();
+  auto it = registered_queries.begin();
+  while (it != registered_queries.end())
+  {
+    const auto& compact_publisher = it->second.compact_publisher;
+    std::size_t other_subscribers = compact_publisher ?
+      compact_publisher->get_subscription_count() : 0;
+    for (const auto& lane : it->second.rate_lanes)
+      other_subscribers += lane.publisher->get_subscription_count();
+
+    if (it->second.publisher->get_subscription_count() == 0
+      && other_subscribers == 0)
+    {
+      if (query_grace_period < now - it->second.last_registration_time)
+      {
+        // This query is considered deprecated, so we should erase it.
+        // It's important that we use the post-increment operator here so that
+        // we increment the iterator to its next value while erasing the element
+        // that it used to point at.
+        forget_query(it++);
+        any_erased = true;
+        continue;
+      }
+    }
+
+    ++it;
+  }
+
+  if (any_erased)
+    broadcast_queries();
+}
+
+//==============================================================================
+std::optional<uint64_t> ScheduleNode::find_registered_query(
+  const rmf_traffic::schedule::Query& query) const
+{
+  const auto [begin, end] = query_index.equal_range(QueryHash()(query));
+  for (auto it = begin; it != end; ++it)
+  {
+    if (registered_queries.at(it->second).query == query)
+      return it->second;
+  }
+
+  return std::nullopt;
+}
+
+//==============================================================================
+void ScheduleNode::forget_query(const QueryInfoMap::iterator it)
+{
+  const auto [begin, end] = query_index.equal_range(
+    QueryHash()(it->second.query));
+  for (auto index = begin; index != end; ++index)
+  {
+    if (index->second == it->first)
+    {
+      query_index.erase(index);
+      break;
+    }
+  }
+
+  registered_queries.erase(it);
+}
+
+//==============================================================================
+void ScheduleNode::broadcast_queries()
+{
+  ScheduleQueries msg;
+  msg.node_version = node_version;
+  msg.ids.reserve(registered_queries.size());
+  msg.queries.reserve(registered_queries.size());
+
+  for (const auto& [query_id, query_info] : registered_queries)
+  {
+    msg.ids.push_back(query_id);
+    msg.queries.push_back(query_info.msg);
+  }
+
+  queries_info_pub->publish(msg);
+}
+
+//==============================================================================
+void ScheduleNode::register_participant(
+  const request_id_ptr& /*request_header*/,
+  const RegisterParticipant::Request::SharedPtr& request,
+  const RegisterParticipant::Response::SharedPtr& response)
+{
+  TracedLock lock(database_mutex, "database_mutex");
+
+  // TODO(MXG): Use try on every database operation
+  try
+  {
+    using Response = rmf_traffic_msgs::srv::RegisterParticipant::Response;
+    const auto description = rmf_traffic_ros2::convert(request->description);
+
+    // Participants that reconnect usually register with the same description
+    // as before, and then there is nothing new to log or announce.
+    if (const auto unchanged =
+      participant_registry->retrieve_unchanged_participant(description))
+    {
+      *response =
+        rmf_traffic_msgs::build<Response>()
+        .participant_id(unchanged->id())
+        .last_itinerary_version(unchanged->last_itinerary_version())
+        .last_route_id(unchanged->last_route_id())
+        .error("");
+
+      RCLCPP_DEBUG(
+        get_logger(),
+        "Participant [%ld] named [%s] owned by [%s] registered again without "
+        "any changes",
+        response->participant_id,
+        request->description.name.c_str(),
+        request->description.owner.c_str());
+      return;
+    }
+
+    const auto registration =
+      participant_registry->add_or_retrieve_participant(description);
+
+    *response =
+      rmf_traffic_msgs::build<Response>()
+      .participant_id(registration.id())
+      .last_itinerary_version(registration.last_itinerary_version())
+      .last_route_id(registration.last_route_id())
+      .error("");
+
+    RCLCPP_INFO(
+      get_logger(),
+      "Registered participant [%ld] named [%s] owned by [%s]",
+      response->participant_id,
+      request->description.name.c_str(),
       request->description.owner.c_str());
 
-    broadcast_participants();
+    broadcast_participants_delta({participant_info(registration.id())}, {});
+
+    schedule_mirror_update();
+  }
+  catch (const std::exception& e)
+  {
+    RCLCPP_ERROR(
+      get_logger(),
+      "Failed to register participant [%s] owned by [%s]: %s",
+      request->description.name.c_str(),
+      request->description.owner.c_str(),
+      e.what());
+    response->error = e.what();
+  }
+}
+
+//==============================================================================
+void ScheduleNode::register_participants(const CompactUpdate& msg)
+{
+  BulkRegistrationRequest request;
+  try
+  {
+    request = decode_bulk_registration_request(msg.data);
+  }
+  catch (const BulkRegistrationError& e)
+  {
+    RCLCPP_ERROR(
+      get_logger(),
+      "[ScheduleNode::register_participants] Failed to decode a request: %s",
+      e.what());
+    return;
+  }
+
+  using Response = rmf_traffic_msgs::srv::RegisterParticipant::Response;
+
+  BulkRegistrationResponse response;
+  response.request_id = request.request_id;
+  response.registrations.reserve(request.descriptions.size());
+
+  std::vector<SingleParticipantInfo> updated;
+  std::size_t unchanged_count = 0;
+  std::size_t failures = 0;
+  {
+    TracedLock lock(database_mutex, "database_mutex");
+    for (const auto& description : request.descriptions)
+    {
+      try
+      {
+        const auto converted = rmf_traffic_ros2::convert(description);
+        if (const auto unchanged =
+          participant_registry->retrieve_unchanged_participant(converted))
+        {
+          response.registrations.push_back(
+            rmf_traffic_msgs::build<Response>()
+            .participant_id(unchanged->id())
+            .last_itinerary_version(unchanged->last_itinerary_version())
+            .last_route_id(unchanged->last_route_id())
+            .error(""));
+
+          ++unchanged_count;
+          continue;
+        }
+
+        const auto registration =
+          participant_registry->add_or_retrieve_participant(converted);
+
+        response.registrations.push_back(
+          rmf_traffic_msgs::build<Response>()
+          .participant_id(registration.id())
+          .last_itinerary_version(registration.last_itinerary_version())
+          .last_route_id(registration.last_route_id())
+          .error(""));
+
+        updated.push_back(participant_info(registration.id()));
+      }
+      catch (const std::exception& e)
+      {
+        RCLCPP_ERROR(
+          get_logger(),
+          "Failed to register participant [%s] owned by [%s]: %s",
+          description.name.c_str(),
+          description.owner.c_str(),
+          e.what());
+
+        Response failed;
+        failed.error = e.what();
+        response.registrations.push_back(std::move(failed));
+        ++failures;
+      }
+    }
+
+    RCLCPP_INFO(
+      get_logger(),
+      "Registered %lu participants in bulk request [%lu] (%lu unchanged, "
+      "%lu failed)",
+      updated.size() + unchanged_count,
+      request.request_id,
+      unchanged_count,
+      failures);
+
+    // The whole request only needs to be announced once
+    if (!updated.empty())
+    {
+      broadcast_participants_delta(std::move(updated), {});
+      schedule_mirror_update();
+    }
+  }
+
+  CompactUpdate reply;
+  reply.data = encode_bulk_registration_response(response);
+  bulk_registration_response_pub->publish(std::move(reply));
+}
+
+//==============================================================================
+void ScheduleNode::unregister_participant(
+  const request_id_ptr& /*request_header*/,
+  const UnregisterParticipant::Request::SharedPtr& request,
+  const UnregisterParticipant::Response::SharedPtr& response)
+{
+  TracedLock lock(database_mutex, "database_mutex");
+
+  const auto& p = database->get_participant(request->participant_id);
+  if (!p)
+  {
+    response->error =
+      "Failed to unregister participant ["
+      + std::to_string(request->participant_id) + "] because no "
+      "participant has that ID";
+    response->confirmation = false;
+
+    RCLCPP_ERROR(get_logger(), response->error.c_str());
+    return;
+  }
+
+  try
+  {
+    // We need to copy this data before the participant is unregistered, because
+    // unregistering it will invalidate the pointer p.
+    const std::string name = p->name();
+    const std::string owner = p->owner();
+
+    auto version = database->itinerary_version(request->participant_id);
+    database->erase(request->participant_id, version);
+    last_inconsistency_reports.erase(request->participant_id);
+    pending_inconsistency_reports.erase(request->participant_id);
+    response->confirmation = true;
+
+    RCLCPP_INFO(
+      get_logger(),
+      "Unregistered participant [%ld] named [%s] owned by [%s]",
+      request->participant_id,
+      name.c_str(),
+      owner.c_str());
+
+    broadcast_participants_delta({}, {request->participant_id});
+    schedule_mirror_update();
+  }
+  catch (const std::exception& e)
+  {
+    RCLCPP_ERROR(
+      get_logger(),
+      "Failed to unregister participant [%ld]: %s",
+      request->participant_id,
+      e.what());
+    response->error = e.what();
+    response->confirmation = false;
+  }
+}
+
+//==============================================================================
+void ScheduleNode::broadcast_participants()
+{
+  if (!participants_info_pub)
+    return;
+
+  ParticipantsInfo msg;
+
+  for (const auto& id: database->participant_ids())
+    msg.participants.push_back(participant_info(id));
+
+  participants_info_pub->publish(msg);
+}
+
+//==============================================================================
+auto ScheduleNode::participant_info(
+  const rmf_traffic::schedule::ParticipantId id) -> SingleParticipantInfo
+{
+  SingleParticipantInfo participant;
+  participant.id = id;
+
+  auto description = participant_registry ?
+    participant_registry->description_msg(id) : std::nullopt;
+  if (description.has_value())
+  {
+    participant.description = std::move(*description);
+  }
+  else
+  {
+    participant.description = rmf_traffic_ros2::convert(
+      *database->get_participant(id));
+  }
+
+  return participant;
+}
+
+//==============================================================================
+void ScheduleNode::broadcast_participants_delta(
+  std::vector<SingleParticipantInfo> updated,
+  std::vector<rmf_traffic::schedule::ParticipantId> removed)
+{
+  ++current_participants_version;
+  if (!participants_delta_pub)
+    return;
+
+  if (deltas_since_participants_resync >= ParticipantsResyncInterval)
+  {
+    // The resync already contains this change
+    broadcast_participants_resync();
+    return;
+  }
+
+  ParticipantsDelta delta;
+  delta.version = ++participants_delta_version;
+  delta.updated.participants = std::move(updated);
+  delta.removed = std::move(removed);
+
+  CompactUpdate msg;
+  msg.data = encode_participants_delta(delta);
+  participants_delta_pub->publish(msg);
+  ++deltas_since_participants_resync;
+}
+
+//==============================================================================
+void ScheduleNode::broadcast_participants_resync()
+{
+  broadcast_participants();
+  if (!participants_delta_pub)
+    return;
+
+  ParticipantsDelta delta;
+  delta.version = ++participants_delta_version;
+  delta.resync = true;
+  for (const auto& id : database->participant_ids())
+    delta.updated.participants.push_back(participant_info(id));
+
+  CompactUpdate msg;
+  msg.data = encode_participants_delta(delta);
+  participants_delta_pub->publish(msg);
+  deltas_since_participants_resync = 0;
+}
+
+//==============================================================================
+std::string ScheduleNode::registrar_topic_name(const std::string& name) const
+{
+  return shard_topic_name(participant_registrar, name);
+}
+
+//==============================================================================
+void ScheduleNode::setup_registrar_following()
+{
+  // A standby node follows the participants of the primary node, which are
+  // published on the same topic as those of a registrar with no namespace.
+  if (participant_registrar.empty() && !standby)
+    return;
+
+  if (!participant_registrar.empty())
+  {
+    RCLCPP_INFO(
+      get_logger(),
+      "Running as schedule shard [%lu] of [%lu], following the participants "
+      "registered by [%s]",
+      schedule_shard_index,
+      schedule_shard_count,
+      participant_registrar.c_str());
+  }
+
+  // The registrar only publishes its full set of participants at each resync,
+  // so the shard follows its deltas to learn about new participants in time.
+  registrar_participants_sub = create_subscription<CompactUpdate>(
+    registrar_topic_name(rmf_traffic_ros2::ParticipantsDeltaTopicName),
+    rclcpp::SystemDefaultsQoS().reliable()
+    .keep_last(2*ParticipantsResyncInterval).transient_local(),
+    [this](const CompactUpdate::UniquePtr msg)
+    {
+      try
+      {
+        if (!this->registrar_participants.apply(
+            decode_participants_delta(msg->data)))
+        {
+          // The next resync will bring this shard back in line
+          return;
+        }
+      }
+      catch (const ParticipantsDeltaDecodeError& e)
+      {
+        RCLCPP_ERROR(
+          this->get_logger(),
+          "Failed to decode a participants delta from [%s]: %s",
+          this->participant_registrar.c_str(),
+          e.what());
+        return;
+      }
+
+      const auto& participants = this->registrar_participants.participants();
+      this->follow_registrar(rmf_traffic_ros2::convert(participants));
+    },
+    middleware_subscription_options(services_callback_group));
+}
+
+//==============================================================================
+void ScheduleNode::follow_registrar(const ParticipantsInfo& msg)
+{
+  std::unordered_map<rmf_traffic::schedule::ParticipantId,
+    rmf_traffic_msgs::msg::ParticipantDescription> expected;
+  for (const auto& participant : msg.participants)
+    expected.insert({participant.id, participant.description});
+
+  TracedLock lock(database_mutex, "database_mutex");
+  const auto& current_ids = database->participant_ids();
+  bool matches = current_ids.size() == expected.size();
+  for (const auto id : current_ids)
+  {
+    if (!matches)
+      break;
+
+    const auto it = expected.find(id);
+    matches = it != expected.end() && it->second ==
+      rmf_traffic_ros2::convert(*database->get_participant(id));
+  }
+
+  if (matches)
+    return;
+
+  const std::vector<rmf_traffic::schedule::ParticipantId> ids(
+    current_ids.begin(), current_ids.end());
+  for (const auto id : ids)
+  {
+    if (expected.count(id) == 0)
+    {
+      database->unregister_participant(id);
+      last_inconsistency_reports.erase(id);
+      pending_inconsistency_reports.erase(id);
+    }
+  }
+
+  // The database can only hand out participant IDs of its own, so it gets
+  // rebuilt through a mirror, which takes the IDs that the registrar chose.
+  // This only happens when participants come or go, so the cost of copying
+  // the itineraries is acceptable.
+  rmf_traffic::schedule::Mirror mirror;
+  mirror.update_participants_info(rmf_traffic_ros2::convert(msg));
+  mirror.update(
+    database->changes(rmf_traffic::schedule::query_all(), std::nullopt));
+  *database = mirror.fork();
+
+  ++current_participants_version;
+  broadcast_participants_resync();
+  schedule_mirror_update();
+
+  RCLCPP_INFO(
+    get_logger(),
+    "Updated to the [%lu] participants of [%s]",
+    expected.size(),
+    participant_registrar.empty() ?
+    "the primary schedule node" : participant_registrar.c_str());
+}
+
+//==============================================================================
+void ScheduleNode::request_changes(
+  [[maybe_unused]] const request_id_ptr& request_header,
+  const RequestChanges::Request::SharedPtr& request,
+  const RequestChanges::Response::SharedPtr& response)
+{
+  std::lock_guard<std::mutex> queries_lock(queries_mutex);
+  const auto query = registered_queries.find(request->query_id);
+  if (query == registered_queries.end())
+  {
+    // Missing query update topic; something has gone very wrong.
+    RCLCPP_ERROR(
+      get_logger(),
+      "[ScheduleNode::request_changes] "
+      "Could not find a query registered with ID [%ld]",
+      request->query_id);
+    response->result = RequestChanges::Response::UNKNOWN_QUERY_ID;
+  }
+  else
+  {
+    auto& mirror_update_topic_info = query->second;
+    // Tell the next update to send the changes since the requested version by
+    // resetting the last sent version number to the requested version,
+    // which may be std::nullopt if a full update is requested
+    if (request->full_update)
+    {
+      mirror_update_topic_info.remediation.add(std::nullopt);
+    }
+    else
+    {
+      if (mirror_update_topic_info.last_sent_version.has_value() &&
+        rmf_utils::modular(request->version).less_than(
+          *mirror_update_topic_info.last_sent_version))
+      {
+        mirror_update_topic_info.remediation.add(request->version);
+      }
+    }
+
+    response->result = RequestChanges::Response::REQUEST_ACCEPTED;
+    schedule_mirror_update();
   }
-  catch (const std::exception& e)
+}
+
+//==============================================================================
+void ScheduleNode::request_sync(
+  [[maybe_unused]] const request_id_ptr& request_header,
+  const RequestChanges::Request::SharedPtr& request,
+  const RequestChanges::Response::SharedPtr& response)
+{
+  std::unique_lock<std::mutex> queries_lock(queries_mutex);
+  const auto query = registered_queries.find(request->query_id);
+  if (query == registered_queries.end())
   {
     RCLCPP_ERROR(
       get_logger(),
-      "Failed to register participant [%s] owned by [%s]: %s",
-      request->description.name.c_str(),
-      request->description.owner.c_str(),
-      e.what());
-    response->error = e.what();
+      "[ScheduleNode::request_sync] "
+      "Could not find a query registered with ID [%ld]",
+      request->query_id);
+    response->result = RequestChanges::Response::UNKNOWN_QUERY_ID;
+    return;
+  }
+
+  // Copy what we need so that the mirror updates are not held up while the
+  // chunks are being published
+  const auto sync_query = query->second.query;
+  const auto publisher = query->second.sync_publisher;
+  queries_lock.unlock();
+
+  TracedLock lock(database_mutex, "database_mutex");
+  const auto patch = database->changes(sync_query, std::nullopt);
+  const auto database_version = database->latest_version();
+  lock.unlock();
+
+  const auto chunks = split_sync_patch(patch, mirror_sync_chunk_size);
+
+  SyncChunk chunk;
+  chunk.transfer_id = next_sync_transfer_id++;
+  chunk.count = static_cast<uint32_t>(chunks.size());
+  chunk.update.node_version = node_version;
+  chunk.update.database_version = database_version;
+  chunk.update.is_remedial_update = true;
+
+  for (std::size_t i = 0; i < chunks.size(); ++i)
+  {
+    chunk.index = static_cast<uint32_t>(i);
+    chunk.update.patch = rmf_traffic_ros2::convert(chunks[i]);
+
+    CompactUpdate msg;
+    msg.data = encode_sync_chunk(chunk);
+    publisher->publish(std::move(msg));
   }
+
+  RCLCPP_INFO(
+    get_logger(),
+    "Sent %lu participants of query [%ld] at version [%ld] to joining "
+    "mirrors in %lu chunks",
+    patch.size(),
+    request->query_id,
+    database_version,
+    chunks.size());
+
+  response->result = RequestChanges::Response::REQUEST_ACCEPTED;
 }
 
 //==============================================================================
-void ScheduleNode::unregister_participant(
-  const request_id_ptr& /*request_header*/,
-  const UnregisterParticipant::Request::SharedPtr& request,
-  const UnregisterParticipant::Response::SharedPtr& response)
+void ScheduleNode::itinerary_set(const ItinerarySet& set)
 {
-  std::unique_lock<std::mutex> lock(database_mutex);
+  TraceScope trace("itinerary_set");
+  TracedLock lock(database_mutex, "database_mutex");
+  apply_itinerary_msg(set);
 
-  const auto& p = database->get_participant(request->participant_id);
-  if (!p)
-  {
-    response->error =
-      "Failed to unregister participant ["
-      + std::to_string(request->participant_id) + "] because no "
-      "participant has that ID";
-    response->confirmation = false;
+  publish_inconsistencies(set.participant);
+  schedule_mirror_update();
 
-    RCLCPP_ERROR(get_logger(), response->error.c_str());
-    return;
-  }
+  TracedLock lock2(active_conflicts_mutex, "active_conflicts_mutex");
+  active_conflicts.check(set.participant, set.itinerary_version);
+}
 
-  try
-  {
-    // We need to copy this data before the participant is unregistered, because
-    // unregistering it will invalidate the pointer p.
-    const std::string name = p->name();
-    const std::string owner = p->owner();
+//==============================================================================
+void ScheduleNode::itinerary_extend(const ItineraryExtend& extend)
+{
+  TraceScope trace("itinerary_extend");
+  TracedLock lock(database_mutex, "database_mutex");
+  apply_itinerary_msg(extend);
 
-    auto version = database->itinerary_version(request->participant_id);
-    database->erase(request->participant_id, version);
-    response->confirmation = true;
+  publish_inconsistencies(extend.participant);
+  schedule_mirror_update();
 
-    RCLCPP_INFO(
-      get_logger(),
-      "Unregistered participant [%ld] named [%s] owned by [%s]",
-      request->participant_id,
-      name.c_str(),
-      owner.c_str());
+  TracedLock lock2(active_conflicts_mutex, "active_conflicts_mutex");
+  active_conflicts.check(
+    extend.participant, database->itinerary_version(extend.participant));
+}
+
+//==============================================================================
+void ScheduleNode::itinerary_delay(const ItineraryDelay& delay)
+{
+  TraceScope trace("itinerary_delay");
+  TracedLock lock(database_mutex, "database_mutex");
+  apply_itinerary_msg(delay);
+
+  publish_inconsistencies(delay.participant);
+  schedule_mirror_update();
+
+  TracedLock lock2(active_conflicts_mutex, "active_conflicts_mutex");
+  active_conflicts.check(
+    delay.participant, database->itinerary_version(delay.participant));
+}
+
+//==============================================================================
+void ScheduleNode::itinerary_erase(const ItineraryErase& erase)
+{
+  TraceScope trace("itinerary_erase");
+  TracedLock lock(database_mutex, "database_mutex");
+  apply_itinerary_msg(erase);
+
+  publish_inconsistencies(erase.participant);
+  schedule_mirror_update();
+
+  TracedLock lock2(active_conflicts_mutex, "active_conflicts_mutex");
+  active_conflicts.check(
+    erase.participant, database->itinerary_version(erase.participant));
+}
+
+//==============================================================================
+void ScheduleNode::itinerary_clear(const ItineraryClear& clear)
+{
+  TraceScope trace("itinerary_clear");
+  TracedLock lock(database_mutex, "database_mutex");
+  apply_itinerary_msg(clear);
+
+  publish_inconsistencies(clear.participant);
+  schedule_mirror_update();
+
+  TracedLock lock2(active_conflicts_mutex, "active_conflicts_mutex");
+  active_conflicts.check(
+    clear.participant, database->itinerary_version(clear.participant));
+}
 
-    broadcast_participants();
+//==============================================================================
+void ScheduleNode::itinerary_batch(const CompactUpdate& batch)
+{
+  TraceScope trace("itinerary_batch");
+  std::vector<ItineraryMsg> msgs;
+  try
+  {
+    msgs = decode_itinerary_batch(batch.data);
   }
-  catch (const std::exception& e)
+  catch (const ItineraryBatchError& e)
   {
     RCLCPP_ERROR(
       get_logger(),
-      "Failed to unregister participant [%ld]: %s",
-      request->participant_id,
+      "[ScheduleNode::itinerary_batch] Failed to decode a batch: %s",
       e.what());
-    response->error = e.what();
-    response->confirmation = false;
+    return;
+  }
+
+  // A batch gets the same treatment as the messages that batched ingestion
+  // collects from one executor pass, so it only takes the locks once.
+  for (auto& msg : msgs)
+  {
+    if (ingress_quota && !admit_itinerary_msg(msg))
+      continue;
+
+    pending_itinerary_msgs.emplace_back(std::move(msg));
   }
+
+  ingest_itinerary_msgs();
 }
 
 //==============================================================================
-void ScheduleNode::broadcast_participants()
+void ScheduleNode::apply_itinerary_msg(const ItinerarySet& set)
 {
-  ++current_participants_version;
-  ParticipantsInfo msg;
+  assert(!set.itinerary.empty());
+  database->set(
+    set.participant,
+    rmf_traffic_ros2::convert(set.itinerary),
+    set.itinerary_version);
 
-  for (const auto& id: database->participant_ids())
+  observe_itinerary_applied(set.participant, set.itinerary_version);
+}
+
+//==============================================================================
+void ScheduleNode::apply_itinerary_msg(const ItineraryExtend& extend)
+{
+  database->extend(
+    extend.participant,
+    rmf_traffic_ros2::convert(extend.routes),
+    extend.itinerary_version);
+
+  observe_itinerary_applied(extend.participant, extend.itinerary_version);
+}
+
+//==============================================================================
+void ScheduleNode::apply_itinerary_msg(const ItineraryDelay& delay)
+{
+  database->delay(
+    delay.participant,
+    rmf_traffic::Duration(delay.delay),
+    delay.itinerary_version);
+
+  observe_itinerary_applied(delay.participant, delay.itinerary_version);
+}
+
+//==============================================================================
+void ScheduleNode::apply_itinerary_msg(const ItineraryErase& erase)
+{
+  database->erase(
+    erase.participant,
+    std::vector<rmf_traffic::RouteId>(
+      erase.routes.begin(), erase.routes.end()),
+    erase.itinerary_version);
+
+  observe_itinerary_applied(erase.participant, erase.itinerary_version);
+}
+
+//==============================================================================
+void ScheduleNode::apply_itinerary_msg(const ItineraryClear& clear)
+{
+  database->erase(clear.participant, clear.itinerary_version);
+
+  observe_itinerary_applied(clear.participant, clear.itinerary_version);
+}
+
+//==============================================================================
+void ScheduleNode::apply_itinerary_msg(const CoalescedDelay& delay)
+{
+  // The database expects to see every itinerary version, so the merged delay
+  // is applied at the first version and the versions that it absorbed are
+  // filled in with empty delays.
+  database->delay(
+    delay.participant,
+    rmf_traffic::Duration(delay.delay),
+    delay.itinerary_version);
+
+  for (auto v = delay.itinerary_version; v != delay.last_version; )
+    database->delay(delay.participant, rmf_traffic::Duration(0), ++v);
+
+  observe_itinerary_applied(delay.participant, delay.last_version);
+}
+
+//==============================================================================
+void ScheduleNode::observe_itinerary_applied(
+  const ParticipantId participant,
+  const ItineraryVersion itinerary_version)
+{
+  if (observers.itinerary_applied)
   {
-    SingleParticipantInfo participant;
-    participant.id = id;
-    participant.description = rmf_traffic_ros2::convert(
-      *database->get_participant(id));
-    msg.participants.push_back(participant);
+    observers.itinerary_applied(
+      participant, itinerary_version, database->latest_version());
   }
-  participants_info_pub->publish(msg);
 }
 
 //==============================================================================
-void ScheduleNode::request_changes(
-  [[maybe_unused]] const request_id_ptr& request_header,
-  const RequestChanges::Request::SharedPtr& request,
-  const RequestChanges::Response::SharedPtr& response)
+void ScheduleNode::queue_itinerary_msg(ItineraryMsg msg)
 {
-  const auto query = registered_queries.find(request->query_id);
-  if (query == registered_queries.end())
+  pending_itinerary_msgs.emplace_back(std::move(msg));
+  if (itinerary_ingest_timer && !itinerary_ingest_timer->is_canceled())
+    return;
+
+  // A zero-period timer will fire on the next pass of the executor, after it
+  // has finished with every subscription that was ready alongside this one.
+  itinerary_ingest_timer = rmf_traffic_ros2::create_timer(
+    *this,
+    std::chrono::nanoseconds(0),
+    [this]()
+    {
+      // This is a one-shot timer
+      this->itinerary_ingest_timer->cancel();
+      this->ingest_itinerary_msgs();
+    },
+    ingest_callback_group);
+}
+
+//==============================================================================
+const std::string& ScheduleNode::ingress_fleet(
+  const rmf_traffic::schedule::ParticipantId id)
+{
+  const auto it = ingress_fleets.find(id);
+  if (it != ingress_fleets.end())
+    return it->second;
+
+  std::string fleet;
   {
-    // Missing query update topic; something has gone very wrong.
-    RCLCPP_ERROR(
+    TracedLock lock(database_mutex, "database_mutex");
+    if (const auto p = database->get_participant(id))
+      fleet = p->owner();
+  }
+
+  // Participants that are not registered yet share an empty fleet name, and
+  // are looked up again next time.
+  if (fleet.empty())
+  {
+    static const std::string unknown;
+    return unknown;
+  }
+
+  return ingress_fleets.insert({id, std::move(fleet)}).first->second;
+}
+
+//==============================================================================
+bool ScheduleNode::admit_itinerary_msg(const ItineraryMsg& msg)
+{
+  const auto participant =
+    std::visit([](const auto& m) { return m.participant; }, msg);
+  const auto& fleet = ingress_fleet(participant);
+  const auto now = std::chrono::steady_clock::now();
+  if (ingress_quota->admit(participant, fleet, now))
+    return true;
+
+  if (!ingress_quota->throttled(participant))
+  {
+    RCLCPP_WARN(
       get_logger(),
-      "[ScheduleNode::request_changes] "
-      "Could not find a query registered with ID [%ld]",
-      request->query_id);
-    response->result = RequestChanges::Response::UNKNOWN_QUERY_ID;
+      "Participant [%lu] of fleet [%s] has gone over its write quota. Its "
+      "itinerary changes will be deferred until it slows down.",
+      participant, fleet.c_str());
   }
-  else
+
+  instruments.superseded_writes->increment(ingress_quota->defer(msg, fleet));
+
+  auto& throttled = throttled_writes[participant];
+  if (!throttled)
+  {
+    throttled = metrics->counter(
+      "rmf_schedule_throttled_writes",
+      "Itinerary messages that were deferred for going over quota",
+      {{"participant", std::to_string(participant)}, {"fleet", fleet}});
+  }
+  throttled->increment();
+
+  instruments.deferred_writes->set(
+    static_cast<double>(ingress_quota->deferred()));
+  instruments.throttled_participants->set(
+    static_cast<double>(ingress_quota->throttled_participants()));
+
+  if (!ingress_release_timer || ingress_release_timer->is_canceled())
+  {
+    ingress_release_timer = rmf_traffic_ros2::create_timer(
+      *this,
+      ingress_release_period,
+      [this]() { this->release_itinerary_msgs(); },
+      ingest_callback_group);
+  }
+
+  return false;
+}
+
+//==============================================================================
+void ScheduleNode::release_itinerary_msgs()
+{
+  auto released = ingress_quota->release(std::chrono::steady_clock::now());
+  instruments.deferred_writes->set(
+    static_cast<double>(ingress_quota->deferred()));
+  instruments.throttled_participants->set(
+    static_cast<double>(ingress_quota->throttled_participants()));
+
+  if (ingress_quota->deferred() == 0)
+    ingress_release_timer->cancel();
+
+  if (released.empty())
+    return;
+
+  for (auto& msg : released)
+    pending_itinerary_msgs.emplace_back(std::move(msg));
+
+  ingest_itinerary_msgs();
+}
+
+//==============================================================================
+void ScheduleNode::ingest_itinerary_msgs()
+{
+  if (pending_itinerary_msgs.empty())
+    return;
+
+  TraceScope trace("ingest_itinerary_msgs");
+  RMF_TRAFFIC_ROS2_TRACE(
+    "ingest_itinerary_msgs", "count=%lu", pending_itinerary_msgs.size());
+
+  const auto ingest_start = std::chrono::steady_clock::now();
+  std::vector<ItineraryMsg> batch;
+  batch.swap(pending_itinerary_msgs);
+  instruments.itinerary_messages->increment(batch.size());
+
+  const auto participant_of = [](const ItineraryMsg& msg)
+    {
+      return std::visit([](const auto& m) { return m.participant; }, msg);
+    };
+
+  const auto version_of = [](const ItineraryMsg& msg)
+    {
+      return std::visit([](const auto& m) { return m.itinerary_version; }, msg);
+    };
+
+  // Apply the changes of each participant in version order so that messages
+  // which arrived out of order through different topics do not needlessly
+  // produce inconsistencies.
+  std::stable_sort(batch.begin(), batch.end(),
+    [&](const ItineraryMsg& a, const ItineraryMsg& b)
+    {
+      const auto p_a = participant_of(a);
+      const auto p_b = participant_of(b);
+      if (p_a != p_b)
+        return p_a < p_b;
+
+      return rmf_utils::modular(version_of(a)).less_than(version_of(b));
+    });
+
+  const bool traced = tracing::tracer() != nullptr;
+  std::vector<ParticipantId> changed;
+  TracedLock lock(database_mutex, "database_mutex");
+  for (const auto& msg : batch)
   {
-    auto& mirror_update_topic_info = query->second;
-    // Tell the next update to send the changes since the requested version by
-    // resetting the last sent version number to the requested version,
-    // which may be std::nullopt if a full update is requested
-    if (request->full_update)
+    const auto participant = participant_of(msg);
+    const auto apply_start = std::chrono::steady_clock::now();
+    try
     {
-      mirror_update_topic_info.remediation_requests.insert(std::nullopt);
+      std::visit([&](const auto& m) { this->apply_itinerary_msg(m); }, msg);
     }
-    else
+    catch (const std::exception& e)
     {
-      if (mirror_update_topic_info.last_sent_version.has_value() &&
-        rmf_utils::modular(request->version).less_than(
-          *mirror_update_topic_info.last_sent_version))
-      {
-        mirror_update_topic_info.remediation_requests.insert(request->version);
-      }
+      instruments.itinerary_failures->increment();
+      RCLCPP_ERROR(
+        get_logger(),
+        "[ScheduleNode::ingest_itinerary_msgs] Failed to apply itinerary "
+        "version [%lu] of participant [%lu]: %s",
+        version_of(msg), participant, e.what());
     }
 
-    response->result = RequestChanges::Response::REQUEST_ACCEPTED;
+    if (traced)
+    {
+      tracing::record(
+        "schedule.apply_itinerary",
+        tracing::itinerary(participant, version_of(msg)),
+        std::chrono::steady_clock::now() - apply_start,
+        {{"rmf.participant", std::to_string(participant)},
+          {"rmf.batch_size", std::to_string(batch.size())}});
+    }
+
+    if (changed.empty() || changed.back() != participant)
+      changed.push_back(participant);
   }
-}
 
-//==============================================================================
-void ScheduleNode::itinerary_set(const ItinerarySet& set)
-{
-  std::unique_lock<std::mutex> lock(database_mutex);
-  assert(!set.itinerary.empty());
-  database->set(
-    set.participant,
-    rmf_traffic_ros2::convert(set.itinerary),
-    set.itinerary_version);
+  for (const auto p : changed)
+  {
+    if (database->get_participant(p))
+      publish_inconsistencies(p);
+  }
 
-  publish_inconsistencies(set.participant);
+  schedule_mirror_update();
 
-  std::lock_guard<std::mutex> lock2(active_conflicts_mutex);
-  active_conflicts.check(set.participant, set.itinerary_version);
+  {
+    TracedLock lock2(active_conflicts_mutex, "active_conflicts_mutex");
+    for (const auto p : changed)
+    {
+      if (database->get_participant(p))
+        active_conflicts.check(p, database->itinerary_version(p));
+    }
+  }
+
+  lock.unlock();
+  conflict_check_cv.notify_all();
+  instruments.ingest_seconds->observe(
+    std::chrono::steady_clock::now() - ingest_start);
 }
 
 //==============================================================================
-void ScheduleNode::itinerary_extend(const ItineraryExtend& extend)
+void ScheduleNode::publish_inconsistencies(
+  rmf_traffic::schedule::ParticipantId id)
 {
-  std::unique_lock<std::mutex> lock(database_mutex);
-  database->extend(
-    extend.participant,
-    rmf_traffic_ros2::convert(extend.routes),
-    extend.itinerary_version);
+  // The primary node reports inconsistencies until this node takes over
+  if (standby)
+    return;
 
-  publish_inconsistencies(extend.participant);
+  const auto it = database->inconsistencies().find(id);
+  assert(it != database->inconsistencies().end());
+  if (it->ranges.size() == 0)
+  {
+    // Everything is consistent now, so the next inconsistency will be news
+    last_inconsistency_reports.erase(id);
+    pending_inconsistency_reports.erase(id);
+    return;
+  }
 
-  std::lock_guard<std::mutex> lock2(active_conflicts_mutex);
-  active_conflicts.check(
-    extend.participant, database->itinerary_version(extend.participant));
-}
+  auto msg = rmf_traffic_ros2::convert(*it);
+  const auto now = std::chrono::steady_clock::now();
+  const auto r_it = last_inconsistency_reports.find(id);
+  if (r_it != last_inconsistency_reports.end())
+  {
+    const auto& last = r_it->second;
+    const auto elapsed = now - last.published;
 
-//==============================================================================
-void ScheduleNode::itinerary_delay(const ItineraryDelay& delay)
-{
-  std::unique_lock<std::mutex> lock(database_mutex);
-  database->delay(
-    delay.participant,
-    rmf_traffic::Duration(delay.delay),
-    delay.itinerary_version);
+    // The last known version changes with every message that arrives, but the
+    // participant only needs to know which ranges are missing.
+    if (last.msg.ranges == msg.ranges
+      && elapsed < inconsistency_report_repeat_period)
+      return;
 
-  publish_inconsistencies(delay.participant);
+    if (elapsed < inconsistency_report_min_period)
+    {
+      pending_inconsistency_reports.insert(id);
+      if (!inconsistency_report_timer
+        || inconsistency_report_timer->is_canceled())
+      {
+        const auto delay = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          inconsistency_report_min_period - elapsed);
 
-  std::lock_guard<std::mutex> lock2(active_conflicts_mutex);
-  active_conflicts.check(
-    delay.participant, database->itinerary_version(delay.participant));
+        inconsistency_report_timer = rmf_traffic_ros2::create_timer(
+          *this,
+          delay,
+          [this]()
+          {
+            // This is a one-shot timer
+            this->inconsistency_report_timer->cancel();
+            this->flush_inconsistency_reports();
+          },
+          ingest_callback_group);
+      }
+      return;
+    }
+  }
+
+  inconsistency_pub->publish(msg);
+  last_inconsistency_reports[id] = InconsistencyReport{std::move(msg), now};
+  pending_inconsistency_reports.erase(id);
 }
 
 //==============================================================================
-void ScheduleNode::itinerary_erase(const ItineraryErase& erase)
+void ScheduleNode::flush_inconsistency_reports()
 {
-  std::unique_lock<std::mutex> lock(database_mutex);
-  database->erase(
-    erase.participant,
-    std::vector<rmf_traffic::RouteId>(
-      erase.routes.begin(), erase.routes.end()),
-    erase.itinerary_version);
-
-  publish_inconsistencies(erase.participant);
+  TracedLock lock(database_mutex, "database_mutex");
+  std::unordered_set<rmf_traffic::schedule::ParticipantId> pending;
+  pending.swap(pending_inconsistency_reports);
 
-  std::lock_guard<std::mutex> lock2(active_conflicts_mutex);
-  active_conflicts.check(
-    erase.participant, database->itinerary_version(erase.participant));
+  // Any participants that are still inside their rate limit will be put back
+  // into the pending set and a new timer will be started for them.
+  for (const auto id : pending)
+  {
+    if (database->get_participant(id))
+      publish_inconsistencies(id);
+  }
 }
 
 //==============================================================================
-void ScheduleNode::itinerary_clear(const ItineraryClear& clear)
+void ScheduleNode::schedule_mirror_update()
 {
-  std::unique_lock<std::mutex> lock(database_mutex);
-  database->erase(clear.participant, clear.itinerary_version);
-
-  publish_inconsistencies(clear.participant);
+  if (!event_driven_mirror_updates || standby)
+    return;
 
-  std::lock_guard<std::mutex> lock2(active_conflicts_mutex);
-  active_conflicts.check(
-    clear.participant, database->itinerary_version(clear.participant));
-}
+  std::lock_guard<std::mutex> lock(mirror_timer_mutex);
+  const auto now = std::chrono::steady_clock::now();
+  if (!mirror_dirty_since)
+    mirror_dirty_since = now;
 
-//==============================================================================
-void ScheduleNode::publish_inconsistencies(
-  rmf_traffic::schedule::ParticipantId id)
-{
-  // TODO(MXG): This approach is likely to send out a lot of redundant
-  // inconsistency reports. We should try to be smarter about how
-  // inconsistencies get reported.
-  const auto it = database->inconsistencies().find(id);
-  assert(it != database->inconsistencies().end());
-  if (it->ranges.size() == 0)
+  if (mirror_update_timer && !mirror_update_timer->is_canceled())
+  {
+    // An update is already pending, so this change will be coalesced into it
     return;
+  }
+
+  auto min_interval = mirror_update_min_interval;
+  auto max_latency = mirror_update_max_latency;
+  if (takeover_until && now < *takeover_until)
+  {
+    min_interval = std::max(min_interval, takeover_mirror_update_interval);
+    max_latency = std::max(max_latency, takeover_mirror_update_interval);
+  }
 
-  inconsistency_pub->publish(rmf_traffic_ros2::convert(*it));
+  const auto earliest = last_mirror_update_time + min_interval;
+  const auto latest = *mirror_dirty_since + max_latency;
+  const auto when = std::min(std::max(now, earliest), latest);
+  const auto delay = std::max(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(when - now),
+    std::chrono::nanoseconds(0));
+
+  mirror_update_timer = rmf_traffic_ros2::create_timer(
+    *this,
+    delay,
+    [this]()
+    {
+      // This is a one-shot timer
+      {
+        std::lock_guard<std::mutex> lock(this->mirror_timer_mutex);
+        this->mirror_update_timer->cancel();
+      }
+      this->update_mirrors();
+    },
+    mirror_callback_group);
 }
 
 //==============================================================================
 void ScheduleNode::update_mirrors()
 {
+  // The mirrors are updated by the primary node until this node takes over
+  if (standby)
+    return;
 
+  std::lock_guard<std::mutex> queries_lock(queries_mutex);
+  TracedLock database_lock(database_mutex, "database_mutex");
+
+  const auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> timer_lock(mirror_timer_mutex);
+    last_mirror_update_time = now;
+    mirror_dirty_since = std::nullopt;
+  }
+
+  std::optional<std::chrono::steady_clock::time_point> next_lane_due;
+  UpdateCache cache;
   for (auto& [query_id, query_info] : registered_queries)
   {
-    for (const auto request : query_info.remediation_requests)
+    // Every mirror of the query receives the remedial patch, so one patch
+    // from the oldest requested version serves all of the requests
+    const auto requests = query_info.remediation.size();
+    if (const auto since = query_info.remediation.take())
     {
+      if (requests > 1)
+      {
+        RCLCPP_DEBUG(
+          get_logger(),
+          "[ScheduleNode::update_mirrors] Merged %lu remediation requests "
+          "for query [%ld]", requests, query_id);
+      }
+
       update_query(
-        query_info.publisher,
-        query_info.query,
-        request,
-        true);
+        query_info,
+        *since,
+        true,
+        &cache);
     }
-    query_info.remediation_requests.clear();
+
+    const auto lane_due = update_rate_lanes(query_info, now, cache);
+    if (lane_due && (!next_lane_due || *lane_due < *next_lane_due))
+      next_lane_due = lane_due;
 
     if (query_info.last_sent_version == database->latest_version())
       continue;
 
     update_query(
-      query_info.publisher,
-      query_info.query,
+      query_info,
       query_info.last_sent_version,
-      false);
+      false,
+      &cache);
 
     // Update the latest version sent to this topic
     query_info.last_sent_version = database->latest_version();
@@ -948,28 +3257,247 @@ void ScheduleNode::update_mirrors()
       query_id);
   }
 
+  if (event_driven_mirror_updates && next_lane_due)
+  {
+    // Nothing else may trigger an update before the lanes are due, so make
+    // sure that their pending changes do not get stranded.
+    const auto delay = std::max(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        *next_lane_due - now),
+      std::chrono::nanoseconds(0));
+
+    if (rate_lane_timer)
+      rate_lane_timer->cancel();
+
+    rate_lane_timer = rmf_traffic_ros2::create_timer(
+      *this,
+      delay,
+      [this]()
+      {
+        // This is a one-shot timer
+        this->rate_lane_timer->cancel();
+        this->update_mirrors();
+      },
+      mirror_callback_group);
+  }
+
   conflict_check_cv.notify_all();
 }
 
+//==============================================================================
+std::optional<std::chrono::steady_clock::time_point>
+ScheduleNode::update_rate_lanes(
+  QueryInfo& query_info,
+  const std::chrono::steady_clock::time_point now,
+  UpdateCache& cache)
+{
+  const auto latest_version = database->latest_version();
+  std::optional<std::chrono::steady_clock::time_point> next_due;
+  for (auto& lane : query_info.rate_lanes)
+  {
+    if (lane.publisher->get_subscription_count() == 0)
+    {
+      // Whoever subscribes later will ask for a full update anyway
+      lane.last_sent_version = std::nullopt;
+      continue;
+    }
+
+    if (lane.last_sent_version == latest_version)
+      continue;
+
+    const auto due = lane.last_sent_time + lane.period;
+    if (now < due)
+    {
+      if (!next_due || due < *next_due)
+        next_due = due;
+
+      continue;
+    }
+
+    auto& cached = cached_update(
+      query_info.query, lane.last_sent_version, false, cache);
+
+    if (cached.patch)
+    {
+      publish_lane_update(lane, cached);
+      lane.last_sent_time = now;
+    }
+
+    lane.last_sent_version = latest_version;
+  }
+
+  return next_due;
+}
+
 //==============================================================================
 void ScheduleNode::update_query(
-  const MirrorUpdateTopicPublisher& publisher,
+  const QueryInfo& query_info,
+  VersionOpt last_sent_version,
+  bool is_remedial,
+  UpdateCache* cache)
+{
+  TraceScope trace("update_query");
+  UpdateCache local_cache;
+  if (!cache)
+    cache = &local_cache;
+
+  auto& cached = cached_update(
+    query_info.query, last_sent_version, is_remedial, *cache);
+
+  if (!cached.patch)
+    return;
+
+  RMF_TRAFFIC_ROS2_TRACE(
+    "update_query_patch", "patch_size=%lu remedial=%d",
+    cached.patch->size(), is_remedial ? 1 : 0);
+
+  // Remedial updates cannot be held back, so the rate lanes receive them
+  // right away. A mirror of another lane will ignore an update that it does
+  // not need.
+  if (is_remedial)
+  {
+    for (const auto& lane : query_info.rate_lanes)
+    {
+      if (lane.publisher->get_subscription_count() > 0)
+        publish_lane_update(lane, cached);
+    }
+  }
+
+  const auto& compact_publisher = query_info.compact_publisher;
+  const bool send_compact = compact_publisher
+    && compact_publisher->get_subscription_count() > 0;
+
+  // The full message is skipped only when nobody could be listening for it
+  // while a compact listener is known to exist.
+  const bool send_full = !send_compact
+    || query_info.publisher->get_subscription_count() > 0;
+
+  if (send_full)
+    publish_update(query_info.publisher, cached);
+
+  if (send_compact)
+  {
+    if (!cached.compact)
+    {
+      auto compact = std::make_shared<CompactUpdate>();
+      compact->data = encode_compact_mirror_update(
+        node_version,
+        database->latest_version(),
+        *cached.patch,
+        is_remedial,
+        compact_mirror_resolution);
+      cached.compact = std::move(compact);
+    }
+
+    compact_publisher->publish(*cached.compact);
+    instruments.mirror_updates->increment();
+  }
+}
+
+//==============================================================================
+auto ScheduleNode::cached_update(
   const rmf_traffic::schedule::Query& query,
   VersionOpt last_sent_version,
-  bool is_remedial)
+  bool is_remedial,
+  UpdateCache& cache) -> CachedUpdate&
 {
+  // Within a single pass the database version is fixed, so an update for the
+  // same query from the same version will produce identical bytes.
+  const UpdateKey key{&query, last_sent_version, is_remedial};
+  const auto cached = cache.find(key);
+  if (cached != cache.end())
+    return cached->second;
+
+  auto patch = database->changes(query, last_sent_version);
 
-  const auto patch = database->changes(query, last_sent_version);
+  std::shared_ptr<const rmf_traffic::schedule::Patch> patch_ptr;
+  if (is_remedial || patch.size() > 0 || patch.cull())
+  {
+    patch_ptr =
+      std::make_shared<rmf_traffic::schedule::Patch>(std::move(patch));
+  }
+
+  const auto inserted = cache.insert(
+    {key, {is_remedial, std::move(patch_ptr), nullptr, nullptr, nullptr}});
+  return inserted.first->second;
+}
 
-  if (!is_remedial && patch.size() == 0 && !patch.cull())
+//==============================================================================
+void ScheduleNode::publish_update(
+  const MirrorUpdateTopicPublisher& publisher,
+  CachedUpdate& cached)
+{
+  instruments.mirror_updates->increment();
+  if (publisher->can_loan_messages())
+  {
+    // The patch is converted straight into the loaned memory, which
+    // subscribers on the same host can read without any serialization.
+    auto loaned = publisher->borrow_loaned_message();
+    fill_mirror_update(cached, loaned.get());
+    publisher->publish(std::move(loaned));
     return;
+  }
+
+  publisher->publish(serialized_update(cached));
+}
 
-  rmf_traffic_msgs::msg::MirrorUpdate msg;
+//==============================================================================
+void ScheduleNode::fill_mirror_update(
+  const CachedUpdate& cached,
+  MirrorUpdate& msg) const
+{
   msg.node_version = node_version;
   msg.database_version = database->latest_version();
-  msg.patch = rmf_traffic_ros2::convert(patch);
-  msg.is_remedial_update = is_remedial;
-  publisher->publish(msg);
+  rmf_traffic_ros2::convert(*cached.patch, msg.patch);
+  msg.is_remedial_update = cached.is_remedial;
+}
+
+//==============================================================================
+void ScheduleNode::publish_lane_update(
+  const QueryInfo::RateLane& lane,
+  CachedUpdate& cached)
+{
+  if (!lane.coarse)
+  {
+    publish_update(lane.publisher, cached);
+    return;
+  }
+
+  if (!cached.coarse)
+  {
+    auto& msg = mirror_update_buffer;
+    msg.node_version = node_version;
+    msg.database_version = database->latest_version();
+    rmf_traffic_ros2::convert(
+      decimate(*cached.patch, mirror_update_lod_tolerance), msg.patch);
+    msg.is_remedial_update = cached.is_remedial;
+
+    static const rclcpp::Serialization<MirrorUpdate> serializer;
+    auto serialized = std::make_shared<rclcpp::SerializedMessage>();
+    serializer.serialize_message(&msg, serialized.get());
+    cached.coarse = std::move(serialized);
+  }
+
+  instruments.mirror_updates->increment();
+  lane.publisher->publish(*cached.coarse);
+}
+
+//==============================================================================
+const rclcpp::SerializedMessage& ScheduleNode::serialized_update(
+  CachedUpdate& cached)
+{
+  if (!cached.message)
+  {
+    auto& msg = mirror_update_buffer;
+    fill_mirror_update(cached, msg);
+
+    static const rclcpp::Serialization<MirrorUpdate> serializer;
+    auto serialized = std::make_shared<rclcpp::SerializedMessage>();
+    serializer.serialize_message(&msg, serialized.get());
+    cached.message = std::move(serialized);
+  }
+
+  return *cached.message;
 }
 
 //==============================================================================
@@ -977,10 +3505,8 @@ void print_conclusion(
   const std::unordered_map<
     ScheduleNode::Version, ScheduleNode::ConflictRecord::Wait>& _awaiting)
 {
-  // TODO(MXG): Instead of printing this conclusion information to the terminal,
-  // we should periodically output a heartbeat with metadata on the current
-  // negotiation status so that other systems can keep their negotiation caches
-  // clean.
+  // The negotiation status topic carries this information periodically. This
+  // is kept for debugging from a terminal.
   struct Status
   {
     rmf_traffic::schedule::ParticipantId participant;
@@ -1012,10 +3538,52 @@ void print_conclusion(
   std::cout << "\n" << std::endl;
 }
 
+//==============================================================================
+void ScheduleNode::publish_negotiation_status()
+{
+  NegotiationStatus status;
+  {
+    TracedLock lock(active_conflicts_mutex, "active_conflicts_mutex");
+    status = negotiation_status.report();
+    status.awaiting_acknowledgment = active_conflicts._waiting.size();
+
+    const auto now = NegotiationStatusTracker::Clock::now();
+    for (auto& entry : active_conflicts._negotiations)
+    {
+      if (!entry.second)
+        continue;
+
+      auto& negotiation = entry.second->negotiation;
+      const auto& participants = negotiation.participants();
+      status.open.push_back(
+        {
+          entry.first,
+          std::vector<ParticipantId>(participants.begin(), participants.end()),
+          negotiation_depth(negotiation),
+          negotiation_status.since_notice(entry.first, now)
+          .value_or(rmf_traffic::Duration(0))
+        });
+    }
+  }
+
+  std::sort(status.open.begin(), status.open.end(),
+    [](const NegotiationStatus::Open& a, const NegotiationStatus::Open& b)
+    {
+      return a.conflict_version < b.conflict_version;
+    });
+
+  YAML::Emitter emitter;
+  emitter << serialize(status);
+
+  NegotiationStatusMsg msg;
+  msg.data = emitter.c_str();
+  negotiation_status_pub->publish(msg);
+}
+
 //==============================================================================
 void ScheduleNode::receive_conclusion_ack(const ConflictAck& msg)
 {
-  std::unique_lock<std::mutex> lock(active_conflicts_mutex);
+  TracedLock lock(active_conflicts_mutex, "active_conflicts_mutex");
 
   for (const auto ack : msg.acknowledgments)
   {
@@ -1037,35 +3605,51 @@ void ScheduleNode::receive_conclusion_ack(const ConflictAck& msg)
 //==============================================================================
 void ScheduleNode::receive_refusal(const ConflictRefusal& msg)
 {
-  std::unique_lock<std::mutex> lock(active_conflicts_mutex);
+  TracedLock lock(active_conflicts_mutex, "active_conflicts_mutex");
   auto* negotiation_room =
     active_conflicts.negotiation(msg.conflict_version);
 
   if (!negotiation_room)
     return;
 
+  RMF_TRAFFIC_ROS2_TRACE(
+    "negotiation_refusal", "conflict_version=%lu", msg.conflict_version);
+
   std::string output = "Refused negotiation ["
     + std::to_string(msg.conflict_version) + "]";
   RCLCPP_INFO(get_logger(), output.c_str());
 
+  // Refusing the negotiation will close its room
+  const auto participants = negotiation_room->negotiation.participants();
   active_conflicts.refuse(msg.conflict_version);
+  negotiation_concluded(msg.conflict_version, false);
 
   ConflictConclusion conclusion;
   conclusion.conflict_version = msg.conflict_version;
   conclusion.resolved = false;
-  conflict_conclusion_pub->publish(conclusion);
+  conflict_conclusion_pub->publish(conclusion, participants);
 }
 
 //==============================================================================
 void ScheduleNode::receive_proposal(const ConflictProposal& msg)
 {
-  std::unique_lock<std::mutex> lock(active_conflicts_mutex);
+  TracedLock lock(active_conflicts_mutex, "active_conflicts_mutex");
   auto* negotiation_room =
     active_conflicts.negotiation(msg.conflict_version);
 
   if (!negotiation_room)
     return;
 
+  RMF_TRAFFIC_ROS2_TRACE(
+    "negotiation_proposal", "conflict_version=%lu", msg.conflict_version);
+
+  // This answers any repeat that we asked for
+  RepeatCoalescer::Table repeat_table;
+  for (const auto& key : msg.to_accommodate)
+    repeat_table.push_back(key.participant);
+  repeat_table.push_back(msg.for_participant);
+  requested_repeats.clear(msg.conflict_version, repeat_table);
+
   auto& negotiation = negotiation_room->negotiation;
 
   const auto search = negotiation.find(
@@ -1105,7 +3689,9 @@ void ScheduleNode::receive_proposal(const ConflictProposal& msg)
       negotiation.evaluate(rmf_traffic::schedule::QuickestFinishEvaluator());
     assert(choose);
 
+    const auto participants = negotiation.participants();
     active_conflicts.conclude(msg.conflict_version);
+    negotiation_concluded(msg.conflict_version, true);
 
     ConflictConclusion conclusion;
     conclusion.conflict_version = msg.conflict_version;
@@ -1120,7 +3706,7 @@ void ScheduleNode::receive_proposal(const ConflictProposal& msg)
         p.version);
     RCLCPP_INFO(get_logger(), output.c_str());
 
-    conflict_conclusion_pub->publish(std::move(conclusion));
+    conflict_conclusion_pub->publish(conclusion, participants);
 //    print_conclusion(active_conflicts._waiting);
   }
   else if (negotiation.complete())
@@ -1129,27 +3715,79 @@ void ScheduleNode::receive_proposal(const ConflictProposal& msg)
       + std::to_string(msg.conflict_version) + "]";
     RCLCPP_INFO(get_logger(), output.c_str());
 
+    const auto participants = negotiation.participants();
     active_conflicts.conclude(msg.conflict_version);
+    negotiation_concluded(msg.conflict_version, false);
 
     // This implies a complete failure
     ConflictConclusion conclusion;
     conclusion.conflict_version = msg.conflict_version;
     conclusion.resolved = false;
 
-    conflict_conclusion_pub->publish(conclusion);
+    conflict_conclusion_pub->publish(conclusion, participants);
 //    print_conclusion(active_conflicts._waiting);
   }
 }
 
+//==============================================================================
+void ScheduleNode::receive_proposal_diff(const CompactUpdate& msg)
+{
+  ProposalDiff diff;
+  try
+  {
+    diff = decode_proposal_diff(msg.data);
+  }
+  catch (const ProposalDiffError& e)
+  {
+    RCLCPP_WARN(get_logger(), "Ignoring a proposal diff: %s", e.what());
+    return;
+  }
+
+  ConflictRepeat repeat;
+  repeat.conflict_version = diff.proposal.conflict_version;
+  for (const auto& key : diff.proposal.to_accommodate)
+    repeat.table.push_back(key.participant);
+  repeat.table.push_back(diff.proposal.for_participant);
+
+  NegotiationRoom::Reconstruction reconstruction;
+  bool request_repeat = false;
+  {
+    TracedLock lock(active_conflicts_mutex, "active_conflicts_mutex");
+    auto* negotiation_room =
+      active_conflicts.negotiation(diff.proposal.conflict_version);
+
+    if (!negotiation_room)
+      return;
+
+    reconstruction = negotiation_room->reconstruct_proposal(diff);
+
+    // Every diff that arrives before the full proposal would otherwise ask
+    // for the same proposal again.
+    request_repeat = reconstruction.missing_base
+      && requested_repeats.admit(
+      repeat.conflict_version, repeat.table,
+      diff.proposal.proposal_version, std::chrono::steady_clock::now());
+  }
+
+  if (reconstruction.proposal)
+    return receive_proposal(*reconstruction.proposal);
+
+  if (request_repeat)
+    conflict_repeat_pub->publish(repeat);
+}
+
 //==============================================================================
 void ScheduleNode::receive_rejection(const ConflictRejection& msg)
 {
-  std::unique_lock<std::mutex> lock(active_conflicts_mutex);
+  TracedLock lock(active_conflicts_mutex, "active_conflicts_mutex");
   auto* negotiation_room = active_conflicts.negotiation(msg.conflict_version);
 
   if (!negotiation_room)
     return;
 
+  RMF_TRAFFIC_ROS2_TRACE(
+    "negotiation_rejection", "conflict_version=%lu", msg.conflict_version);
+
   auto& negotiation = negotiation_room->negotiation;
 
   const auto search = negotiation.find(rmf_traffic_ros2::convert(msg.table));
@@ -1187,12 +3825,15 @@ void ScheduleNode::receive_rejection(const ConflictRejection& msg)
 //==============================================================================
 void ScheduleNode::receive_forfeit(const ConflictForfeit& msg)
 {
-  std::unique_lock<std::mutex> lock(active_conflicts_mutex);
+  TracedLock lock(active_conflicts_mutex, "active_conflicts_mutex");
   auto* negotiation_room = active_conflicts.negotiation(msg.conflict_version);
 
   if (!negotiation_room)
     return;
 
+  RMF_TRAFFIC_ROS2_TRACE(
+    "negotiation_forfeit", "conflict_version=%lu", msg.conflict_version);
+
   auto& negotiation = negotiation_room->negotiation;
 
   const auto search = negotiation.find(rmf_traffic_ros2::convert(msg.table));
@@ -1227,13 +3868,15 @@ void ScheduleNode::receive_forfeit(const ConflictForfeit& msg)
       + std::to_string(msg.conflict_version) + "]";
     RCLCPP_INFO(get_logger(), output.c_str());
 
+    const auto participants = negotiation.participants();
     active_conflicts.conclude(msg.conflict_version);
+    negotiation_concluded(msg.conflict_version, false);
 
     ConflictConclusion conclusion;
     conclusion.conflict_version = msg.conflict_version;
     conclusion.resolved = false;
 
-    conflict_conclusion_pub->publish(conclusion);
+    conflict_conclusion_pub->publish(conclusion, participants);
 //    print_conclusion(active_conflicts._waiting);
   }
 }
@@ -1243,5 +3886,30 @@ std::shared_ptr<rclcpp::Node> make_node(const rclcpp::NodeOptions& options)
   return std::make_shared<ScheduleNode>(0, options);
 }
 
+//==============================================================================
+void spin_node(const std::shared_ptr<rclcpp::Node>& node)
+{
+  const auto threads = static_cast<std::size_t>(
+    std::max<int64_t>(node->get_parameter("executor_threads").as_int(), 0));
+
+  const auto schedule_node = std::dynamic_pointer_cast<ScheduleNode>(node);
+  if (schedule_node && (schedule_node->callback_watchdog
+    || !schedule_node->executor_thread_settings.is_default()))
+  {
+    TimedExecutor executor(
+      schedule_node->callback_watchdog, threads,
+      schedule_node->executor_thread_settings.applier(*node, "executor"));
+    executor.add_node(node);
+    executor.spin();
+    return;
+  }
+
+  rclcpp::executors::MultiThreadedExecutor executor(
+    rclcpp::ExecutorOptions(), threads);
+
+  executor.add_node(node);
+  executor.spin();
+}
+
 } // namespace schedule
 } // namespace rmf_traffic_ros2
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "ParticipantDescriptionCache.hpp"
+
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+auto ParticipantDescriptionCache::convert(
+  const rmf_traffic_msgs::msg::Participants& msg) -> Descriptions
+{
+  _last_conversions = 0;
+  std::unordered_map<rmf_traffic::schedule::ParticipantId, Entry> entries;
+  Descriptions output;
+  for (const auto& participant : msg.participants)
+  {
+    const auto it = _entries.find(participant.id);
+    if (it != _entries.end() && it->second.msg == participant.description)
+    {
+      output.insert({participant.id, it->second.description});
+      entries.insert({participant.id, std::move(it->second)});
+      continue;
+    }
+
+    auto description = rmf_traffic_ros2::convert(participant.description);
+    ++_last_conversions;
+    output.insert({participant.id, description});
+    entries.insert(
+      {participant.id, Entry{participant.description, std::move(description)}});
+  }
+
+  _entries = std::move(entries);
+  return output;
+}
+
+//==============================================================================
+std::size_t ParticipantDescriptionCache::last_conversions() const
+{
+  return _last_conversions;
+}
+
+//==============================================================================
+std::size_t ParticipantDescriptionCache::size() const
+{
+  return _entries.size();
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PARTICIPANTDESCRIPTIONCACHE_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PARTICIPANTDESCRIPTIONCACHE_HPP
+
+#include <rmf_traffic/schedule/ParticipantDescription.hpp>
+
+#include <rmf_traffic_msgs/msg/participants.hpp>
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Converts the participants that a mirror receives, while reusing the
+/// descriptions that have not changed since the last message. Every message
+/// carries all of the participants, but their descriptions almost never
+/// change, and converting the profile of each description is costly.
+///
+/// This class is not thread-safe.
+class ParticipantDescriptionCache
+{
+public:
+
+  using Descriptions = rmf_traffic::schedule::ParticipantDescriptionsMap;
+
+  /// Convert every participant of a message. Participants that are not in
+  /// the message are dropped from the cache.
+  Descriptions convert(const rmf_traffic_msgs::msg::Participants& msg);
+
+  /// How many descriptions were converted by the last call to convert(),
+  /// instead of being reused.
+  std::size_t last_conversions() const;
+
+  /// How many descriptions are being kept.
+  std::size_t size() const;
+
+private:
+
+  struct Entry
+  {
+    rmf_traffic_msgs::msg::ParticipantDescription msg;
+    rmf_traffic::schedule::ParticipantDescription description;
+  };
+
+  std::unordered_map<rmf_traffic::schedule::ParticipantId, Entry> _entries;
+  std::size_t _last_conversions = 0;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PARTICIPANTDESCRIPTIONCACHE_HPP
@@ -15,7 +15,12 @@
  *
 */
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
 #include <mutex>
+#include <thread>
 #include <rmf_traffic_ros2/schedule/ParticipantRegistry.hpp>
 #include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
 #include "internal_YamlSerialization.hpp"
@@ -24,12 +29,7 @@ namespace rmf_traffic_ros2 {
 namespace schedule {
 
 //==============================================================================
-bool operator!=(
-  const rmf_traffic::schedule::ParticipantDescription& p1,
-  const rmf_traffic::schedule::ParticipantDescription& p2)
-{
-  return rmf_traffic_ros2::convert(p1) != rmf_traffic_ros2::convert(p2);
-}
+using DescriptionMsg = rmf_traffic_msgs::msg::ParticipantDescription;
 
 //==============================================================================
 struct UniqueId
@@ -59,9 +59,11 @@ public:
   //===========================================================================
   Implementation(
     std::unique_ptr<AbstractParticipantLogger> logger,
-    std::shared_ptr<Database> db)
+    std::shared_ptr<Database> db,
+    std::optional<AsyncLogging> async = std::nullopt)
   : _database(db),
-    _logger(std::move(logger))
+    _logger(std::move(logger)),
+    _async(std::move(async))
   {
     _reading_from_log = true;
     while (auto record = _logger->read_next_record())
@@ -69,6 +71,26 @@ public:
       execute(*record);
     }
     _reading_from_log = false;
+
+    if (_async)
+    {
+      _async->max_queue_size = std::max<std::size_t>(1, _async->max_queue_size);
+      _writer = std::thread([this]() { write_queued_operations(); });
+    }
+  }
+
+  //===========================================================================
+  ~Implementation()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _quit = true;
+    }
+    _queue_cv.notify_all();
+
+    // The writer thread will drain the queue before it quits
+    if (_writer.joinable())
+      _writer.join();
   }
 
   //===========================================================================
@@ -82,13 +104,14 @@ public:
     if (it != _id_from_name.end())
     {
       const auto id = it->second;
-      auto& description_entry = _description.at(id);
 
       // Check if footprint has changed
-      if (description_entry != new_description)
+      auto new_msg = rmf_traffic_ros2::convert(new_description);
+      if (stored_description_msg(id) != new_msg)
       {
         _database->update_description(id, new_description);
-        description_entry = new_description;
+        _description.insert_or_assign(id, new_description);
+        _description_msg.insert_or_assign(id, std::move(new_msg));
         write_to_file({AtomicOperation::OpType::Update, new_description});
       }
 
@@ -99,11 +122,50 @@ public:
     const auto registration = _database->register_participant(new_description);
     _id_from_name[key] = registration.id();
     _description.insert_or_assign(registration.id(), new_description);
+    _description_msg.erase(registration.id());
 
     write_to_file({AtomicOperation::OpType::Add, new_description});
     return registration;
   }
 
+  //===========================================================================
+  std::optional<Registration> retrieve_unchanged_participant(
+    const ParticipantDescription& description)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _id_from_name.find(
+      {description.name(), description.owner()});
+    if (it == _id_from_name.end())
+      return std::nullopt;
+
+    const auto id = it->second;
+    if (stored_description_msg(id) != rmf_traffic_ros2::convert(description))
+      return std::nullopt;
+
+    return Registration(
+      id, _database->itinerary_version(id), _database->last_route_id(id));
+  }
+
+  //===========================================================================
+  std::optional<DescriptionMsg> description_msg(const ParticipantId id)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _description.find(id);
+    if (it == _description.end())
+      return std::nullopt;
+
+    // The database may have been given its participants some other way, for
+    // example by following another schedule node, so this makes sure that
+    // the stored description still belongs to the same participant.
+    const auto current = _database->get_participant(id);
+    if (!current
+      || current->name() != it->second.name()
+      || current->owner() != it->second.owner())
+      return std::nullopt;
+
+    return stored_description_msg(id);
+  }
+
   //===========================================================================
   std::optional<ParticipantId> participant_exists(
     const std::string& name,
@@ -118,7 +180,31 @@ public:
     return {id->second};
   }
 
+  //===========================================================================
+  void flush()
+  {
+    if (!_async)
+      return;
+
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    _queue_cv.wait(
+      lock, [&]() { return _queue.empty() && _in_flight == 0; });
+  }
+
 private:
+  //===========================================================================
+  /// The message form of a stored description. This must be called while
+  /// _mutex is locked.
+  const DescriptionMsg& stored_description_msg(const ParticipantId id)
+  {
+    const auto it = _description_msg.find(id);
+    if (it != _description_msg.end())
+      return it->second;
+
+    return _description_msg.insert(
+      {id, rmf_traffic_ros2::convert(_description.at(id))}).first->second;
+  }
+
   //===========================================================================
   void write_to_file(AtomicOperation op)
   {
@@ -132,7 +218,63 @@ private:
       return;
     }
 
-    _logger->write_operation(op);
+    if (!_async)
+    {
+      _logger->write_operation(op);
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    _queue_cv.wait(
+      lock, [&]() { return _queue.size() < _async->max_queue_size; });
+
+    _queue.push_back(std::move(op));
+    _queue_cv.notify_all();
+  }
+
+  //==========================================================================
+  void write_queued_operations()
+  {
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    while (true)
+    {
+      _queue_cv.wait(lock, [&]() { return _quit || !_queue.empty(); });
+      if (_queue.empty())
+        return;
+
+      std::vector<AtomicOperation> batch(
+        std::make_move_iterator(_queue.begin()),
+        std::make_move_iterator(_queue.end()));
+      _queue.clear();
+      _in_flight = batch.size();
+      _queue_cv.notify_all();
+      lock.unlock();
+
+      // Everything that piled up while the last batch was being written will
+      // share a single sync.
+      std::exception_ptr error;
+      try
+      {
+        for (const auto& op : batch)
+          _logger->write_operation(op);
+
+        _logger->sync();
+      }
+      catch (...)
+      {
+        error = std::current_exception();
+      }
+
+      if (_async->on_durable)
+      {
+        for (const auto& op : batch)
+          _async->on_durable(op, error);
+      }
+
+      lock.lock();
+      _in_flight = 0;
+      _queue_cv.notify_all();
+    }
   }
 
   //==========================================================================
@@ -148,10 +290,23 @@ private:
   //==========================================================================
   std::unordered_map<UniqueId, ParticipantId, UniqueIdHasher> _id_from_name;
   std::unordered_map<ParticipantId, ParticipantDescription> _description;
+
+  // Converting a description into a message is costly because of its profile,
+  // so the message form is kept until the description changes.
+  std::unordered_map<ParticipantId, DescriptionMsg> _description_msg;
+
   std::shared_ptr<Database> _database;
   std::unique_ptr<AbstractParticipantLogger> _logger;
   std::mutex _mutex;
   bool _reading_from_log = false;
+
+  std::optional<AsyncLogging> _async;
+  std::deque<AtomicOperation> _queue;
+  std::size_t _in_flight = 0;
+  std::mutex _queue_mutex;
+  std::condition_variable _queue_cv;
+  bool _quit = false;
+  std::thread _writer;
 };
 
 //=============================================================================
@@ -164,6 +319,23 @@ ParticipantRegistry::ParticipantRegistry(
   // Do nothing
 }
 
+//=============================================================================
+ParticipantRegistry::ParticipantRegistry(
+  std::unique_ptr<AbstractParticipantLogger> logger,
+  std::shared_ptr<Database> database,
+  AsyncLogging async)
+: _pimpl(rmf_utils::make_unique_impl<Implementation>(
+      std::move(logger), database, std::move(async)))
+{
+  // Do nothing
+}
+
+//=============================================================================
+void ParticipantRegistry::flush()
+{
+  _pimpl->flush();
+}
+
 //=============================================================================
 ParticipantRegistry::Registration
 ParticipantRegistry::add_or_retrieve_participant(
@@ -172,5 +344,20 @@ ParticipantRegistry::add_or_retrieve_participant(
   return _pimpl->add_or_retrieve_participant(std::move(description));
 }
 
+//=============================================================================
+std::optional<ParticipantRegistry::Registration>
+ParticipantRegistry::retrieve_unchanged_participant(
+  const ParticipantDescription& description)
+{
+  return _pimpl->retrieve_unchanged_participant(description);
+}
+
+//=============================================================================
+std::optional<rmf_traffic_msgs::msg::ParticipantDescription>
+ParticipantRegistry::description_msg(const ParticipantId id)
+{
+  return _pimpl->description_msg(id);
+}
+
 } // namespace schedule
 } // namespace rmf_traffic_ros2
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "ParticipantsDelta.hpp"
+
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// Each delta is laid out as
+//   [magic: 3][format: u8][resync: u8][version: u64][removed: u32]
+//   [removed IDs: u64 each][payload]
+// where the payload is the CDR serialization of a Participants message.
+constexpr std::array<uint8_t, 4> Header = {'R', 'M', 'P', 1};
+constexpr std::size_t PrefixSize = 17;
+
+using Participants = rmf_traffic_msgs::msg::Participants;
+
+//==============================================================================
+void write_uint(std::vector<uint8_t>& buffer, uint64_t value, int bytes)
+{
+  for (int i = 0; i < bytes; ++i)
+    buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+uint64_t read_uint(const uint8_t* data, int bytes)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i)
+    value |= static_cast<uint64_t>(data[i]) << (8*i);
+
+  return value;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+std::vector<uint8_t> encode_participants_delta(const ParticipantsDelta& delta)
+{
+  rclcpp::SerializedMessage serialized;
+  rclcpp::Serialization<Participants>().serialize_message(
+    &delta.updated, &serialized);
+  const auto& raw = serialized.get_rcl_serialized_message();
+
+  std::vector<uint8_t> buffer;
+  buffer.reserve(PrefixSize + 8*delta.removed.size() + raw.buffer_length);
+  buffer.insert(buffer.end(), Header.begin(), Header.end());
+  write_uint(buffer, delta.resync ? 1 : 0, 1);
+  write_uint(buffer, delta.version, 8);
+  write_uint(buffer, delta.removed.size(), 4);
+  for (const auto id : delta.removed)
+    write_uint(buffer, id, 8);
+
+  buffer.insert(buffer.end(), raw.buffer, raw.buffer + raw.buffer_length);
+
+  return buffer;
+}
+
+//==============================================================================
+ParticipantsDelta decode_participants_delta(const std::vector<uint8_t>& buffer)
+{
+  if (buffer.size() < PrefixSize
+    || !std::equal(Header.begin(), Header.end(), buffer.begin()))
+  {
+    throw ParticipantsDeltaDecodeError("Buffer is not a participants delta");
+  }
+
+  ParticipantsDelta delta;
+  delta.resync = buffer[4] != 0;
+  delta.version = read_uint(buffer.data() + 5, 8);
+  const std::size_t num_removed = read_uint(buffer.data() + 13, 4);
+  if ((buffer.size() - PrefixSize) / 8 < num_removed)
+  {
+    throw ParticipantsDeltaDecodeError(
+      "Participants delta is too short for its removed IDs");
+  }
+
+  const uint8_t* data = buffer.data() + PrefixSize;
+  delta.removed.reserve(num_removed);
+  for (std::size_t i = 0; i < num_removed; ++i, data += 8)
+    delta.removed.push_back(read_uint(data, 8));
+
+  const std::size_t size = buffer.data() + buffer.size() - data;
+  rclcpp::SerializedMessage serialized(size);
+  auto& raw = serialized.get_rcl_serialized_message();
+  std::memcpy(raw.buffer, data, size);
+  raw.buffer_length = size;
+
+  try
+  {
+    rclcpp::Serialization<Participants>().deserialize_message(
+      &serialized, &delta.updated);
+  }
+  catch (const std::exception& e)
+  {
+    throw ParticipantsDeltaDecodeError(
+      std::string("Malformed participants delta payload: ") + e.what());
+  }
+
+  return delta;
+}
+
+//==============================================================================
+bool ParticipantsDeltaTracker::apply(const ParticipantsDelta& delta)
+{
+  if (delta.resync)
+  {
+    _participants = _resync_cache.convert(delta.updated);
+    _version = delta.version;
+    return true;
+  }
+
+  if (!_version.has_value() || delta.version != *_version + 1)
+  {
+    // We missed something, so we cannot trust anything until the next resync
+    _version = std::nullopt;
+    return false;
+  }
+
+  for (const auto id : delta.removed)
+    _participants.erase(id);
+
+  for (const auto& p : delta.updated.participants)
+    _participants.insert_or_assign(
+      p.id, rmf_traffic_ros2::convert(p.description));
+
+  _version = delta.version;
+  return true;
+}
+
+//==============================================================================
+bool ParticipantsDeltaTracker::synchronized() const
+{
+  return _version.has_value();
+}
+
+//==============================================================================
+auto ParticipantsDeltaTracker::participants() const
+-> const rmf_traffic::schedule::ParticipantDescriptionsMap&
+{
+  return _participants;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PARTICIPANTSDELTA_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PARTICIPANTSDELTA_HPP
+
+#include "ParticipantDescriptionCache.hpp"
+
+#include <rmf_traffic/schedule/ParticipantDescription.hpp>
+
+#include <rmf_traffic_msgs/msg/participants.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A change to the set of participants on the schedule. Each delta is
+/// numbered, and a delta can only be applied to the participants of the
+/// version before it. A resync carries every participant, resets the version
+/// of whoever receives it, and can be applied at any time.
+struct ParticipantsDelta
+{
+  uint64_t version = 0;
+  bool resync = false;
+
+  /// Participants that were added, or whose descriptions were changed. For a
+  /// resync, this is every participant.
+  rmf_traffic_msgs::msg::Participants updated;
+
+  /// Participants that were removed. This is always empty for a resync.
+  std::vector<rmf_traffic::schedule::ParticipantId> removed;
+};
+
+//==============================================================================
+/// Thrown when a participants delta buffer cannot be decoded.
+class ParticipantsDeltaDecodeError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+std::vector<uint8_t> encode_participants_delta(const ParticipantsDelta& delta);
+
+//==============================================================================
+/// This will throw a ParticipantsDeltaDecodeError if the buffer is malformed.
+ParticipantsDelta decode_participants_delta(const std::vector<uint8_t>& buffer);
+
+//==============================================================================
+/// Keeps track of the participants that a sequence of deltas describes.
+class ParticipantsDeltaTracker
+{
+public:
+
+  /// Apply a delta. This returns false, and leaves the participants as they
+  /// were, if the delta does not follow the last one that was applied. After
+  /// that, only a resync will be accepted.
+  bool apply(const ParticipantsDelta& delta);
+
+  /// True once a resync has been applied and no delta has been missed since.
+  bool synchronized() const;
+
+  const rmf_traffic::schedule::ParticipantDescriptionsMap&
+  participants() const;
+
+private:
+  std::optional<uint64_t> _version;
+  rmf_traffic::schedule::ParticipantDescriptionsMap _participants;
+
+  // A resync carries every participant, so the descriptions that did not
+  // change are reused from the last resync.
+  ParticipantDescriptionCache _resync_cache;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PARTICIPANTSDELTA_HPP
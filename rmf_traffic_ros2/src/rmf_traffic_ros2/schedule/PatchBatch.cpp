@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "PatchBatch.hpp"
+
+#include <utility>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+void PatchBatch::add(Patch patch, bool remedial)
+{
+  _entries.push_back(Entry{std::move(patch), remedial});
+}
+
+//==============================================================================
+bool PatchBatch::empty() const
+{
+  return _entries.empty();
+}
+
+//==============================================================================
+std::size_t PatchBatch::size() const
+{
+  return _entries.size();
+}
+
+//==============================================================================
+void PatchBatch::apply(rmf_traffic::schedule::Mirror& mirror)
+{
+  for (auto& entry : _entries)
+    entry.updated = mirror.update(entry.patch);
+}
+
+//==============================================================================
+auto PatchBatch::applied() const -> std::vector<const Patch*>
+{
+  std::vector<const Patch*> output;
+  for (const auto& entry : _entries)
+  {
+    if (entry.updated)
+      output.push_back(&entry.patch);
+  }
+
+  return output;
+}
+
+//==============================================================================
+auto PatchBatch::failed() const -> const Patch*
+{
+  for (const auto& entry : _entries)
+  {
+    if (!entry.updated && !entry.remedial)
+      return &entry.patch;
+  }
+
+  return nullptr;
+}
+
+//==============================================================================
+bool PatchBatch::claim_request()
+{
+  if (_requested)
+    return false;
+
+  _requested = true;
+  return true;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
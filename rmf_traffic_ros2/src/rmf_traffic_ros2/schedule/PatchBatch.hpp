@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PATCHBATCH_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PATCHBATCH_HPP
+
+#include <rmf_traffic/schedule/Mirror.hpp>
+#include <rmf_traffic/schedule/Patch.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A run of patches that a MirrorManager applies to its mirror in one pass.
+/// The patches are applied in the order that they were added. The batch also
+/// remembers whether a new update has been requested on its behalf, so that a
+/// run with several bad patches asks the schedule node for only one update.
+///
+/// This class is not thread-safe.
+class PatchBatch
+{
+public:
+
+  using Patch = rmf_traffic::schedule::Patch;
+
+  /// Add a patch to the end of the batch.
+  ///
+  /// \param[in] patch
+  ///   The patch to apply
+  ///
+  /// \param[in] remedial
+  ///   True if the patch was sent to remedy an earlier failure. A remedial
+  ///   patch that cannot be applied does not call for a new update.
+  void add(Patch patch, bool remedial);
+
+  /// True if there are no patches in the batch.
+  bool empty() const;
+
+  /// How many patches are in the batch.
+  std::size_t size() const;
+
+  /// Apply every patch of the batch to the mirror.
+  void apply(rmf_traffic::schedule::Mirror& mirror);
+
+  /// The patches that were applied successfully by the last call to apply(),
+  /// in the order that they were added.
+  std::vector<const Patch*> applied() const;
+
+  /// The first patch that could not be applied by the last call to apply()
+  /// and was not remedial, or a nullptr if there was none. A new update
+  /// should be requested when this is not a nullptr.
+  const Patch* failed() const;
+
+  /// Claim the one request for a new update that this batch is allowed to
+  /// make. Returns true the first time it is called and false after that.
+  bool claim_request();
+
+private:
+
+  struct Entry
+  {
+    Patch patch;
+    bool remedial;
+    bool updated = false;
+  };
+
+  std::vector<Entry> _entries;
+  bool _requested = false;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PATCHBATCH_HPP
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "ProposalDiff.hpp"
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// Each diff is laid out as
+//   [magic: 3][format: u8][base version: u64][routes: u32]
+//   [[kind: u8][base index: u32][time shift: i64] for each route][payload]
+// where the payload is the CDR serialization of a NegotiationProposal.
+constexpr std::array<uint8_t, 4> Header = {'R', 'M', 'D', 1};
+constexpr std::size_t PrefixSize = 16;
+constexpr std::size_t RouteChangeSize = 13;
+
+using Proposal = rmf_traffic_msgs::msg::NegotiationProposal;
+using Route = rmf_traffic_msgs::msg::Route;
+
+//==============================================================================
+void write_uint(std::vector<uint8_t>& buffer, uint64_t value, int bytes)
+{
+  for (int i = 0; i < bytes; ++i)
+    buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+uint64_t read_uint(const uint8_t* data, int bytes)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i)
+    value |= static_cast<uint64_t>(data[i]) << (8*i);
+
+  return value;
+}
+
+//==============================================================================
+/// If the route is the base route moved by a constant time offset, get that
+/// offset.
+std::optional<int64_t> time_shift(const Route& route, const Route& base)
+{
+  const auto& waypoints = route.trajectory.waypoints;
+  const auto& base_waypoints = base.trajectory.waypoints;
+  if (route.map != base.map || waypoints.empty()
+    || waypoints.size() != base_waypoints.size())
+  {
+    return std::nullopt;
+  }
+
+  const int64_t shift = waypoints.front().time - base_waypoints.front().time;
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+  {
+    const auto& wp = waypoints[i];
+    const auto& base_wp = base_waypoints[i];
+    if (wp.time - base_wp.time != shift
+      || wp.position != base_wp.position
+      || wp.velocity != base_wp.velocity)
+    {
+      return std::nullopt;
+    }
+  }
+
+  return shift;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+std::optional<ProposalDiff> make_proposal_diff(
+  const Proposal& proposal,
+  const std::vector<Route>& base,
+  const uint64_t base_version)
+{
+  using Kind = ProposalDiff::RouteChange::Kind;
+
+  ProposalDiff diff;
+  diff.base_version = base_version;
+  diff.proposal = proposal;
+  diff.proposal.itinerary.clear();
+
+  bool reused = false;
+  for (std::size_t i = 0; i < proposal.itinerary.size(); ++i)
+  {
+    const auto& route = proposal.itinerary[i];
+
+    // Routes usually keep their position in the itinerary, so check there
+    // before searching the rest of the base itinerary.
+    ProposalDiff::RouteChange change;
+    for (std::size_t k = 0; k < base.size(); ++k)
+    {
+      const std::size_t j = (i + k) % base.size();
+      if (route == base[j])
+      {
+        change = {Kind::Same, static_cast<uint32_t>(j), 0};
+        break;
+      }
+
+      if (change.kind == Kind::New)
+      {
+        if (const auto shift = time_shift(route, base[j]))
+          change = {Kind::Shifted, static_cast<uint32_t>(j), *shift};
+      }
+    }
+
+    if (change.kind == Kind::New)
+      diff.proposal.itinerary.push_back(route);
+    else
+      reused = true;
+
+    diff.routes.push_back(change);
+  }
+
+  if (!reused)
+    return std::nullopt;
+
+  return diff;
+}
+
+//==============================================================================
+Proposal apply_proposal_diff(
+  const ProposalDiff& diff,
+  const std::vector<Route>& base)
+{
+  using Kind = ProposalDiff::RouteChange::Kind;
+
+  Proposal proposal = diff.proposal;
+  proposal.itinerary.clear();
+  proposal.itinerary.reserve(diff.routes.size());
+
+  std::size_t next_new = 0;
+  for (const auto& change : diff.routes)
+  {
+    if (change.kind == Kind::New)
+    {
+      if (next_new >= diff.proposal.itinerary.size())
+        throw ProposalDiffError("Proposal diff is missing a new route");
+
+      proposal.itinerary.push_back(diff.proposal.itinerary[next_new++]);
+      continue;
+    }
+
+    if (change.base_index >= base.size())
+      throw ProposalDiffError("Proposal diff refers to a missing base route");
+
+    proposal.itinerary.push_back(base[change.base_index]);
+    if (change.kind == Kind::Shifted)
+    {
+      for (auto& wp : proposal.itinerary.back().trajectory.waypoints)
+        wp.time += change.time_shift;
+    }
+  }
+
+  if (next_new != diff.proposal.itinerary.size())
+    throw ProposalDiffError("Proposal diff has unused new routes");
+
+  return proposal;
+}
+
+//==============================================================================
+std::vector<uint8_t> encode_proposal_diff(const ProposalDiff& diff)
+{
+  rclcpp::SerializedMessage serialized;
+  rclcpp::Serialization<Proposal>().serialize_message(
+    &diff.proposal, &serialized);
+  const auto& raw = serialized.get_rcl_serialized_message();
+
+  std::vector<uint8_t> buffer;
+  buffer.reserve(
+    PrefixSize + RouteChangeSize*diff.routes.size() + raw.buffer_length);
+  buffer.insert(buffer.end(), Header.begin(), Header.end());
+  write_uint(buffer, diff.base_version, 8);
+  write_uint(buffer, diff.routes.size(), 4);
+  for (const auto& change : diff.routes)
+  {
+    write_uint(buffer, change.kind, 1);
+    write_uint(buffer, change.base_index, 4);
+    write_uint(buffer, static_cast<uint64_t>(change.time_shift), 8);
+  }
+
+  buffer.insert(buffer.end(), raw.buffer, raw.buffer + raw.buffer_length);
+
+  return buffer;
+}
+
+//==============================================================================
+ProposalDiff decode_proposal_diff(const std::vector<uint8_t>& buffer)
+{
+  if (buffer.size() < PrefixSize
+    || !std::equal(Header.begin(), Header.end(), buffer.begin()))
+  {
+    throw ProposalDiffError("Buffer is not a proposal diff");
+  }
+
+  ProposalDiff diff;
+  diff.base_version = read_uint(buffer.data() + 4, 8);
+  const std::size_t num_routes = read_uint(buffer.data() + 12, 4);
+  if ((buffer.size() - PrefixSize) / RouteChangeSize < num_routes)
+    throw ProposalDiffError("Proposal diff is too short for its routes");
+
+  const uint8_t* data = buffer.data() + PrefixSize;
+  diff.routes.reserve(num_routes);
+  for (std::size_t i = 0; i < num_routes; ++i, data += RouteChangeSize)
+  {
+    const auto kind = data[0];
+    if (kind > ProposalDiff::RouteChange::New)
+      throw ProposalDiffError("Invalid route change in proposal diff");
+
+    diff.routes.push_back(
+      {
+        static_cast<ProposalDiff::RouteChange::Kind>(kind),
+        static_cast<uint32_t>(read_uint(data + 1, 4)),
+        static_cast<int64_t>(read_uint(data + 5, 8))
+      });
+  }
+
+  const std::size_t size = buffer.data() + buffer.size() - data;
+  rclcpp::SerializedMessage serialized(size);
+  auto& raw = serialized.get_rcl_serialized_message();
+  std::memcpy(raw.buffer, data, size);
+  raw.buffer_length = size;
+
+  try
+  {
+    rclcpp::Serialization<Proposal>().deserialize_message(
+      &serialized, &diff.proposal);
+  }
+  catch (const std::exception& e)
+  {
+    throw ProposalDiffError(
+      std::string("Malformed proposal diff payload: ") + e.what());
+  }
+
+  return diff;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PROPOSALDIFF_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PROPOSALDIFF_HPP
+
+#include <rmf_traffic_msgs/msg/negotiation_proposal.hpp>
+#include <rmf_traffic_msgs/msg/route.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A negotiation proposal that only carries the routes which changed since an
+/// earlier proposal for the same table. Each route of the new itinerary is
+/// either a copy of a base route, a copy of a base route shifted in time, or
+/// a new route that is carried by the proposal itself.
+struct ProposalDiff
+{
+  struct RouteChange
+  {
+    enum Kind : uint8_t
+    {
+      Same = 0,
+      Shifted = 1,
+      New = 2
+    };
+
+    Kind kind = New;
+    uint32_t base_index = 0;
+    int64_t time_shift = 0;
+  };
+
+  /// The proposal version of the table that this diff builds on
+  uint64_t base_version = 0;
+
+  std::vector<RouteChange> routes;
+
+  /// The proposal, whose itinerary only contains the new routes in the order
+  /// that they appear in routes
+  rmf_traffic_msgs::msg::NegotiationProposal proposal;
+};
+
+//==============================================================================
+/// Thrown when a proposal diff cannot be decoded or applied.
+class ProposalDiffError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+/// Describe a proposal in terms of the itinerary of an earlier proposal. This
+/// returns std::nullopt if none of the base routes could be reused, since the
+/// full proposal would be smaller in that case.
+std::optional<ProposalDiff> make_proposal_diff(
+  const rmf_traffic_msgs::msg::NegotiationProposal& proposal,
+  const std::vector<rmf_traffic_msgs::msg::Route>& base,
+  uint64_t base_version);
+
+//==============================================================================
+/// Rebuild the full proposal from a diff and the itinerary that it builds on.
+/// This throws a ProposalDiffError if the diff does not fit the base.
+rmf_traffic_msgs::msg::NegotiationProposal apply_proposal_diff(
+  const ProposalDiff& diff,
+  const std::vector<rmf_traffic_msgs::msg::Route>& base);
+
+//==============================================================================
+std::vector<uint8_t> encode_proposal_diff(const ProposalDiff& diff);
+
+//==============================================================================
+/// This will throw a ProposalDiffError if the buffer is malformed.
+ProposalDiff decode_proposal_diff(const std::vector<uint8_t>& buffer);
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__PROPOSALDIFF_HPP
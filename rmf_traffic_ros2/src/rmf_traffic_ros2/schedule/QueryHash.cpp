@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "QueryHash.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+void combine(std::size_t& seed, const std::size_t value)
+{
+  seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+//==============================================================================
+std::size_t hash_bound(const rmf_traffic::Time* bound)
+{
+  if (!bound)
+    return 0;
+
+  return std::hash<int64_t>()(bound->time_since_epoch().count()) + 1;
+}
+
+//==============================================================================
+std::size_t hash_region(const rmf_traffic::Region& region)
+{
+  std::size_t seed = std::hash<std::string>()(region.get_map());
+  combine(seed, hash_bound(region.get_lower_time_bound()));
+  combine(seed, hash_bound(region.get_upper_time_bound()));
+
+  // The spaces are summed so that their order does not matter
+  std::size_t spaces = 0;
+  for (const auto& space : region)
+  {
+    const Eigen::Vector2d p = space.get_pose().translation();
+    std::size_t space_seed = std::hash<double>()(p.x());
+    combine(space_seed, std::hash<double>()(p.y()));
+    spaces += space_seed;
+  }
+  combine(seed, spaces);
+
+  return seed;
+}
+} // anonymous namespace
+
+//==============================================================================
+std::size_t QueryHash::operator()(
+  const rmf_traffic::schedule::Query& query) const
+{
+  using Spacetime = rmf_traffic::schedule::Query::Spacetime;
+  using Participants = rmf_traffic::schedule::Query::Participants;
+
+  const auto& spacetime = query.spacetime();
+  std::size_t seed = static_cast<std::size_t>(spacetime.get_mode());
+  if (Spacetime::Mode::Regions == spacetime.get_mode())
+  {
+    std::size_t regions = 0;
+    for (const auto& region : *spacetime.regions())
+      regions += hash_region(region);
+
+    combine(seed, regions);
+  }
+  else if (Spacetime::Mode::Timespan == spacetime.get_mode())
+  {
+    const auto& timespan = *spacetime.timespan();
+    combine(seed, hash_bound(timespan.get_lower_time_bound()));
+    combine(seed, hash_bound(timespan.get_upper_time_bound()));
+  }
+
+  const auto& participants = query.participants();
+  combine(seed, static_cast<std::size_t>(participants.get_mode()));
+
+  std::vector<rmf_traffic::schedule::ParticipantId> ids;
+  if (Participants::Mode::Include == participants.get_mode())
+    ids = participants.include()->get_ids();
+  else if (Participants::Mode::Exclude == participants.get_mode())
+    ids = participants.exclude()->get_ids();
+
+  // The IDs are summed so that their order does not matter
+  std::size_t id_sum = 0;
+  for (const auto id : ids)
+    id_sum += std::hash<rmf_traffic::schedule::ParticipantId>()(id);
+
+  combine(seed, id_sum);
+
+  return seed;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
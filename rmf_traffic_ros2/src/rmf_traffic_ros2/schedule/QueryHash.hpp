@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__QUERYHASH_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__QUERYHASH_HPP
+
+#include <rmf_traffic/schedule/Query.hpp>
+
+#include <cstddef>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Hash a query so that queries which compare equal always produce the same
+/// value, no matter what order their regions or participant IDs were given
+/// in. Queries that differ only in their shapes may collide, so a match must
+/// still be confirmed with operator==.
+struct QueryHash
+{
+  std::size_t operator()(const rmf_traffic::schedule::Query& query) const;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__QUERYHASH_HPP
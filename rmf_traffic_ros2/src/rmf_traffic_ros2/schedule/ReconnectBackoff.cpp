@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ReconnectBackoff.hpp"
+
+#include <algorithm>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+std::chrono::nanoseconds get_fail_over_jitter(rclcpp::Node& node)
+{
+  if (!node.has_parameter(FailOverJitterParameter))
+    node.declare_parameter<double>(FailOverJitterParameter, 1.0);
+
+  const double seconds = std::max(
+    0.0, node.get_parameter(FailOverJitterParameter).as_double());
+
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(seconds));
+}
+
+//==============================================================================
+ReconnectBackoff::ReconnectBackoff(
+  const Duration initial,
+  const Duration maximum,
+  const uint64_t seed)
+: _initial(std::max(initial, Duration(0))),
+  _maximum(std::max(maximum, _initial)),
+  _ceiling(_initial),
+  _rng(seed)
+{
+  // Do nothing
+}
+
+//==============================================================================
+auto ReconnectBackoff::next() -> Duration
+{
+  const auto ceiling = _ceiling;
+  _ceiling = _ceiling > _maximum/2 ? _maximum : 2*_ceiling;
+
+  if (ceiling <= Duration(0))
+    return Duration(0);
+
+  std::uniform_int_distribution<Duration::rep> delay(0, ceiling.count());
+  return Duration(delay(_rng));
+}
+
+//==============================================================================
+void ReconnectBackoff::reset()
+{
+  _ceiling = _initial;
+}
+
+//==============================================================================
+auto ReconnectBackoff::ceiling() const -> Duration
+{
+  return _ceiling;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
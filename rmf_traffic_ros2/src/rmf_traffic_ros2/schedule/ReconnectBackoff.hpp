@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__RECONNECTBACKOFF_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__RECONNECTBACKOFF_HPP
+
+#include <rclcpp/node.hpp>
+
+#include <chrono>
+#include <random>
+#include <string>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// The name of the parameter that sets the longest time, in seconds, that a
+/// writer or mirror waits before it reconnects to a replacement schedule node
+/// after a fail over. A value of 0 reconnects right away.
+const std::string FailOverJitterParameter = "fail_over_jitter";
+
+//==============================================================================
+/// Get the fail_over_jitter of a node, declaring the parameter if needed. The
+/// default is 1 second.
+std::chrono::nanoseconds get_fail_over_jitter(rclcpp::Node& node);
+
+//==============================================================================
+/// Spreads out the attempts of the clients of a schedule node to reconnect
+/// after a fail over, so that the replacement node is not hit by all of them
+/// at the same moment. Each delay is drawn uniformly between zero and a
+/// ceiling, and the ceiling doubles with every attempt until it reaches the
+/// maximum.
+///
+/// This class is not thread-safe.
+class ReconnectBackoff
+{
+public:
+
+  using Duration = std::chrono::nanoseconds;
+
+  /// Constructor
+  ///
+  /// \param[in] initial
+  ///   The ceiling of the first delay
+  ///
+  /// \param[in] maximum
+  ///   The ceiling will never grow past this
+  ///
+  /// \param[in] seed
+  ///   The seed of the random delays
+  ReconnectBackoff(
+    Duration initial,
+    Duration maximum,
+    uint64_t seed = std::random_device()());
+
+  /// Get the delay to wait before the next attempt
+  Duration next();
+
+  /// Start over from the initial ceiling, e.g. after an attempt succeeded
+  void reset();
+
+  /// The ceiling of the next delay
+  Duration ceiling() const;
+
+private:
+  Duration _initial;
+  Duration _maximum;
+  Duration _ceiling;
+  std::mt19937_64 _rng;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__RECONNECTBACKOFF_HPP
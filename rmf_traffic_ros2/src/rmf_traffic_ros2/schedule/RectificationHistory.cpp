@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "RectificationHistory.hpp"
+
+#include <rmf_utils/Modular.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+uint64_t participant_of(const ItineraryMsg& msg)
+{
+  return std::visit([](const auto& m) { return m.participant; }, msg);
+}
+
+//==============================================================================
+uint64_t version_of(const ItineraryMsg& msg)
+{
+  return std::visit([](const auto& m) { return m.itinerary_version; }, msg);
+}
+
+//==============================================================================
+uint64_t last_version_of(const ItineraryMsg& msg)
+{
+  if (const auto* delay = std::get_if<CoalescedDelay>(&msg))
+    return delay->last_version;
+
+  return version_of(msg);
+}
+
+//==============================================================================
+bool replaces_itinerary(const ItineraryMsg& msg)
+{
+  return std::holds_alternative<rmf_traffic_msgs::msg::ItinerarySet>(msg)
+    || std::holds_alternative<rmf_traffic_msgs::msg::ItineraryClear>(msg);
+}
+
+//==============================================================================
+bool needed(
+  const ItineraryMsg& msg,
+  const RectificationHistory::Inconsistency& inconsistency)
+{
+  const auto first = version_of(msg);
+  const auto last = last_version_of(msg);
+  if (rmf_utils::modular(inconsistency.last_known_version).less_than(last))
+    return true;
+
+  for (const auto& range : inconsistency.ranges)
+  {
+    if (rmf_utils::modular(last).less_than(range.lower))
+      continue;
+
+    if (rmf_utils::modular(range.upper).less_than(first))
+      continue;
+
+    return true;
+  }
+
+  return false;
+}
+} // anonymous namespace
+
+//==============================================================================
+RectificationHistory::RectificationHistory(const std::size_t max_messages)
+: _max_messages(max_messages)
+{
+  if (_max_messages == 0)
+  {
+    // *INDENT-OFF*
+    throw std::runtime_error(
+      "[RectificationHistory] The history must be able to hold at least one "
+      "message");
+    // *INDENT-ON*
+  }
+}
+
+//==============================================================================
+void RectificationHistory::record(ItineraryMsg msg)
+{
+  auto& messages = _messages[participant_of(msg)];
+  if (replaces_itinerary(msg))
+    messages.clear();
+
+  messages.emplace_back(std::move(msg));
+  while (messages.size() > _max_messages)
+    messages.pop_front();
+}
+
+//==============================================================================
+std::optional<std::vector<ItineraryMsg>>
+RectificationHistory::retransmission(const Inconsistency& inconsistency) const
+{
+  const auto it = _messages.find(inconsistency.participant);
+  if (it == _messages.end() || it->second.empty())
+    return std::nullopt;
+
+  const auto& messages = it->second;
+
+  // The oldest version that the schedule is missing
+  auto oldest = inconsistency.last_known_version + 1;
+  for (const auto& range : inconsistency.ranges)
+  {
+    if (rmf_utils::modular(range.lower).less_than(oldest))
+      oldest = range.lower;
+  }
+
+  std::vector<ItineraryMsg> msgs;
+  auto begin = messages.begin();
+  if (rmf_utils::modular(oldest).less_than(version_of(messages.front())))
+  {
+    // The changes that the schedule is missing are older than this history,
+    // which can only be made up for by a message that replaces them all.
+    if (!replaces_itinerary(messages.front()))
+      return std::nullopt;
+
+    msgs.push_back(messages.front());
+    ++begin;
+  }
+
+  std::copy_if(
+    begin, messages.end(), std::back_inserter(msgs),
+    [&](const ItineraryMsg& msg) { return needed(msg, inconsistency); });
+
+  return msgs;
+}
+
+//==============================================================================
+void RectificationHistory::forget(const uint64_t participant)
+{
+  _messages.erase(participant);
+}
+
+//==============================================================================
+std::size_t RectificationHistory::size(const uint64_t participant) const
+{
+  const auto it = _messages.find(participant);
+  if (it == _messages.end())
+    return 0;
+
+  return it->second.size();
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__RECTIFICATIONHISTORY_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__RECTIFICATIONHISTORY_HPP
+
+#include "ItineraryBatch.hpp"
+
+#include <rmf_traffic_msgs/msg/schedule_inconsistency.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Keeps the most recent itinerary messages that a writer sent for each of
+/// its participants, so that a schedule inconsistency can be answered by
+/// resending them instead of asking the participant to replay its whole
+/// change history.
+///
+/// A set or a clear replaces everything that came before it, so the history
+/// of a participant starts over at each of those. When the schedule is
+/// missing changes from before the oldest message that is kept, and that
+/// message is a set or a clear, resending it stands in for all of the older
+/// changes. Otherwise the history cannot answer and the participant has to
+/// retransmit on its own.
+///
+/// This class is not thread-safe.
+class RectificationHistory
+{
+public:
+
+  using Inconsistency = rmf_traffic_msgs::msg::ScheduleInconsistency;
+
+  /// Constructor
+  ///
+  /// \param[in] max_messages
+  ///   The most messages that are kept for each participant. This must be at
+  ///   least 1.
+  RectificationHistory(std::size_t max_messages);
+
+  /// Keep a message that was sent. The messages of each participant must be
+  /// recorded in the order of their itinerary versions.
+  void record(ItineraryMsg msg);
+
+  /// Get the messages that need to be resent to fix an inconsistency, or
+  /// std::nullopt if this history does not reach back far enough.
+  std::optional<std::vector<ItineraryMsg>> retransmission(
+    const Inconsistency& inconsistency) const;
+
+  /// Drop the history of a participant.
+  void forget(uint64_t participant);
+
+  /// How many messages are being kept for a participant.
+  std::size_t size(uint64_t participant) const;
+
+private:
+  std::size_t _max_messages;
+  std::unordered_map<uint64_t, std::deque<ItineraryMsg>> _messages;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__RECTIFICATIONHISTORY_HPP
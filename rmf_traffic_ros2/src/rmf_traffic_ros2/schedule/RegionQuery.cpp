@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/schedule/Query.hpp>
+
+#include <rmf_traffic/geometry/Box.hpp>
+
+#include <map>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+rmf_traffic::schedule::Query make_region_query(
+  const rmf_traffic::agv::Graph& graph,
+  const double padding,
+  const std::optional<rmf_traffic::Time> lower_time_bound,
+  const std::optional<rmf_traffic::Time> upper_time_bound)
+{
+  if (padding < 0.0)
+  {
+    throw std::invalid_argument(
+      "[rmf_traffic_ros2::schedule::make_region_query] The padding must not "
+      "be negative");
+  }
+
+  // Use a std::map so the regions come out in a stable order, which lets
+  // identical graphs produce identical queries that the schedule node can
+  // share between mirrors.
+  std::map<std::string, Eigen::AlignedBox2d> bounds;
+  for (std::size_t i = 0; i < graph.num_waypoints(); ++i)
+  {
+    const auto& wp = graph.get_waypoint(i);
+    bounds[wp.get_map_name()].extend(wp.get_location());
+  }
+
+  std::vector<rmf_traffic::Region> regions;
+  for (const auto& [map, box] : bounds)
+  {
+    const Eigen::Vector2d size =
+      box.sizes() + Eigen::Vector2d::Constant(2.0 * padding);
+
+    Eigen::Isometry2d pose = Eigen::Isometry2d::Identity();
+    pose.translation() = box.center();
+
+    rmf_traffic::Region region(
+      map,
+      {
+        rmf_traffic::geometry::Space{
+          rmf_traffic::geometry::make_final_convex<
+            rmf_traffic::geometry::Box>(size.x(), size.y()),
+          pose
+        }
+      });
+
+    if (lower_time_bound)
+      region.set_lower_time_bound(*lower_time_bound);
+
+    if (upper_time_bound)
+      region.set_upper_time_bound(*upper_time_bound);
+
+    regions.emplace_back(std::move(region));
+  }
+
+  auto query = rmf_traffic::schedule::query_all();
+  query.spacetime() = rmf_traffic::schedule::Query::Spacetime(regions);
+  return query;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
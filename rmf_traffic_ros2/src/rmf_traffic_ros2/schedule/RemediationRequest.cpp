@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "RemediationRequest.hpp"
+
+#include <rmf_utils/Modular.hpp>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+void RemediationRequest::add(const VersionOpt since)
+{
+  ++_size;
+  if (!_since.has_value())
+  {
+    _since = since;
+    return;
+  }
+
+  // A full update is already pending, which covers every request
+  if (!_since->has_value())
+    return;
+
+  if (!since.has_value() || rmf_utils::modular(*since).less_than(**_since))
+    _since = since;
+}
+
+//==============================================================================
+auto RemediationRequest::take() -> std::optional<VersionOpt>
+{
+  _size = 0;
+  auto since = _since;
+  _since = std::nullopt;
+  return since;
+}
+
+//==============================================================================
+std::size_t RemediationRequest::size() const
+{
+  return _size;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
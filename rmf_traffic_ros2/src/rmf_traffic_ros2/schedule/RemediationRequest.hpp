@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__REMEDIATIONREQUEST_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__REMEDIATIONREQUEST_HPP
+
+#include <rmf_traffic/schedule/Version.hpp>
+
+#include <cstddef>
+#include <optional>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// The remedial update that the mirrors of a query are waiting for. After a
+/// network blip, many mirrors ask at once for the changes since slightly
+/// different versions. One remedial patch that starts from the oldest of
+/// those versions satisfies all of them, so their requests are merged here
+/// instead of each one getting a patch of its own.
+///
+/// This class is not thread-safe.
+class RemediationRequest
+{
+public:
+
+  using Version = rmf_traffic::schedule::Version;
+  using VersionOpt = std::optional<Version>;
+
+  /// Ask for every change since a version. A std::nullopt asks for a full
+  /// update, which covers every other request.
+  void add(VersionOpt since);
+
+  /// Take the version that the remedial patch should start from, and forget
+  /// the requests that it covers. The outer optional is empty if nothing was
+  /// requested.
+  std::optional<VersionOpt> take();
+
+  /// The number of requests that are waiting to be taken
+  std::size_t size() const;
+
+private:
+  std::optional<VersionOpt> _since;
+  std::size_t _size = 0;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__REMEDIATIONREQUEST_HPP
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "RepeatCoalescer.hpp"
+
+#include <rmf_utils/Modular.hpp>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+RepeatCoalescer::RepeatCoalescer(const Clock::duration period)
+: _period(period)
+{
+  // Do nothing
+}
+
+//==============================================================================
+bool RepeatCoalescer::admit(
+  const Version conflict_version,
+  const Table& table,
+  const Version table_version,
+  const Clock::time_point now)
+{
+  if (_period <= Clock::duration::zero())
+    return true;
+
+  // Drop the repeats that no longer cover anything, so the memory stays
+  // bounded by how many repeats go out within one period.
+  for (auto it = _sent.begin(); it != _sent.end(); )
+  {
+    if (it->second.time + _period <= now)
+      it = _sent.erase(it);
+    else
+      ++it;
+  }
+
+  const auto key = std::make_pair(conflict_version, table);
+  const auto it = _sent.find(key);
+  if (it != _sent.end()
+    && !rmf_utils::modular(it->second.table_version).less_than(table_version))
+    return false;
+
+  _sent.insert_or_assign(key, Sent{table_version, now});
+  return true;
+}
+
+//==============================================================================
+void RepeatCoalescer::clear(const Version conflict_version, const Table& table)
+{
+  _sent.erase(std::make_pair(conflict_version, table));
+}
+
+//==============================================================================
+std::size_t RepeatCoalescer::size() const
+{
+  return _sent.size();
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__REPEATCOALESCER_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__REPEATCOALESCER_HPP
+
+#include <rmf_traffic/schedule/Negotiation.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// Keeps track of the negotiation repeats that went out recently, so that
+/// several requests for the same table can be answered by one full proposal.
+/// A requester uses this to avoid asking for a table again while an earlier
+/// request is still being answered, and a responder uses it to avoid sending
+/// the same version of a table more than once when several participants ask
+/// for it at about the same time. Everyone who is listening receives the
+/// repeated proposal, so the extra repeats would only add to the traffic on
+/// a link that is already losing messages.
+///
+/// This class is not thread-safe.
+class RepeatCoalescer
+{
+public:
+
+  using Clock = std::chrono::steady_clock;
+  using Version = rmf_traffic::schedule::Version;
+  using Table = std::vector<rmf_traffic::schedule::ParticipantId>;
+
+  /// Constructor
+  ///
+  /// \param[in] period
+  ///   How long a repeat covers later requests for the same version of the
+  ///   same table. A period of zero lets every repeat through.
+  RepeatCoalescer(Clock::duration period);
+
+  /// Check if a repeat should go out now, and remember it if so.
+  ///
+  /// \param[in] conflict_version
+  ///   The negotiation that the table belongs to
+  ///
+  /// \param[in] table
+  ///   The participants of the table, ending with the one it is for
+  ///
+  /// \param[in] table_version
+  ///   The version of the table that would be repeated. A newer version is
+  ///   always let through.
+  ///
+  /// \param[in] now
+  ///   The current time
+  bool admit(
+    Version conflict_version,
+    const Table& table,
+    Version table_version,
+    Clock::time_point now);
+
+  /// Forget the repeat of a table, for example because the full proposal
+  /// that it asked for has arrived.
+  void clear(Version conflict_version, const Table& table);
+
+  /// How many repeats are being remembered.
+  std::size_t size() const;
+
+private:
+
+  struct Sent
+  {
+    Version table_version;
+    Clock::time_point time;
+  };
+
+  Clock::duration _period;
+  std::map<std::pair<Version, Table>, Sent> _sent;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__REPEATCOALESCER_HPP
@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "ReplicationLog.hpp"
+
+#include <rmf_traffic_ros2/schedule/Writer.hpp>
+
+#include <rmf_utils/Modular.hpp>
+
+#include <algorithm>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+uint64_t participant_of(const ItineraryMsg& msg)
+{
+  return std::visit([](const auto& m) { return m.participant; }, msg);
+}
+
+//==============================================================================
+uint64_t version_of(const ItineraryMsg& msg)
+{
+  return std::visit([](const auto& m) { return m.itinerary_version; }, msg);
+}
+
+//==============================================================================
+uint64_t last_version_of(const ItineraryMsg& msg)
+{
+  if (const auto* delay = std::get_if<CoalescedDelay>(&msg))
+    return delay->last_version;
+
+  return version_of(msg);
+}
+
+//==============================================================================
+bool replaces_itinerary(const ItineraryMsg& msg)
+{
+  return std::holds_alternative<rmf_traffic_msgs::msg::ItinerarySet>(msg)
+    || std::holds_alternative<rmf_traffic_msgs::msg::ItineraryClear>(msg);
+}
+} // anonymous namespace
+
+//==============================================================================
+void ReplicationLog::rebase(const ScheduleSnapshot& baseline)
+{
+  for (const auto& participant : baseline.participants)
+    _participants.insert_or_assign(participant.id, participant);
+}
+
+//==============================================================================
+void ReplicationLog::participants(const Descriptions& descriptions)
+{
+  for (auto it = _participants.begin(); it != _participants.end(); )
+  {
+    if (descriptions.count(it->first) == 0)
+    {
+      const auto m = _messages.find(it->first);
+      if (m != _messages.end())
+      {
+        _logged -= m->second.size();
+        _messages.erase(m);
+      }
+
+      it = _participants.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  for (const auto& [id, description] : descriptions)
+  {
+    const auto it = _participants.find(id);
+    if (it == _participants.end())
+    {
+      _participants.insert({id, Participant{id, description, 0, {}}});
+    }
+    else
+    {
+      it->second.description = description;
+    }
+  }
+}
+
+//==============================================================================
+void ReplicationLog::record(ItineraryMsg msg)
+{
+  auto& messages = _messages[participant_of(msg)];
+
+  // Whatever came before a set or a clear will never need to be folded
+  if (replaces_itinerary(msg))
+  {
+    _logged -= messages.size();
+    messages.clear();
+  }
+
+  messages.emplace_back(std::move(msg));
+  ++_logged;
+}
+
+//==============================================================================
+void ReplicationLog::compact()
+{
+  for (auto it = _messages.begin(); it != _messages.end(); )
+  {
+    const auto p = _participants.find(it->first);
+    if (p != _participants.end())
+    {
+      _logged -= it->second.size();
+      _fold(p->second, it->second);
+      _logged += it->second.size();
+    }
+
+    if (it->second.empty())
+      it = _messages.erase(it);
+    else
+      ++it;
+  }
+}
+
+//==============================================================================
+ScheduleSnapshot ReplicationLog::snapshot() const
+{
+  ScheduleSnapshot snapshot;
+  snapshot.participants.reserve(_participants.size());
+  for (const auto& [_, participant] : _participants)
+    snapshot.participants.push_back(participant);
+
+  std::sort(
+    snapshot.participants.begin(), snapshot.participants.end(),
+    [](const Participant& a, const Participant& b) { return a.id < b.id; });
+
+  return snapshot;
+}
+
+//==============================================================================
+std::size_t ReplicationLog::logged() const
+{
+  return _logged;
+}
+
+//==============================================================================
+void ReplicationLog::_fold(
+  Participant& participant,
+  std::deque<ItineraryMsg>& messages)
+{
+  auto& itinerary = participant.itinerary;
+  rmf_traffic::Duration delay(0);
+  const auto shift = [&]()
+    {
+      if (delay == rmf_traffic::Duration(0))
+        return;
+
+      // The routes may be shared with earlier snapshots, so they are copied
+      // before being shifted.
+      for (auto& item : itinerary)
+      {
+        auto route = std::make_shared<rmf_traffic::Route>(*item.route);
+        if (route->trajectory().size() > 0)
+          route->trajectory().front().adjust_times(delay);
+
+        item.route = std::move(route);
+      }
+
+      delay = rmf_traffic::Duration(0);
+    };
+
+  bool folded = true;
+  while (folded)
+  {
+    folded = false;
+    for (auto it = messages.begin(); it != messages.end(); ++it)
+    {
+      const auto& msg = *it;
+      const auto current = participant.itinerary_version;
+      const auto version = version_of(msg);
+      const bool newer = rmf_utils::modular(current).less_than(version);
+
+      // A participant that has not changed its itinerary yet can start from
+      // any set or clear.
+      const bool fresh = current == 0 && itinerary.empty();
+
+      if (replaces_itinerary(msg) && (newer || fresh))
+      {
+        delay = rmf_traffic::Duration(0);
+        if (const auto* set =
+          std::get_if<rmf_traffic_msgs::msg::ItinerarySet>(&msg))
+        {
+          itinerary = rmf_traffic_ros2::convert(set->itinerary);
+        }
+        else
+        {
+          itinerary.clear();
+        }
+      }
+      else if (!replaces_itinerary(msg) && version == current + 1)
+      {
+        if (const auto* extend =
+          std::get_if<rmf_traffic_msgs::msg::ItineraryExtend>(&msg))
+        {
+          shift();
+          const auto routes = rmf_traffic_ros2::convert(extend->routes);
+          itinerary.insert(itinerary.end(), routes.begin(), routes.end());
+        }
+        else if (const auto* d =
+          std::get_if<rmf_traffic_msgs::msg::ItineraryDelay>(&msg))
+        {
+          delay += rmf_traffic::Duration(d->delay);
+        }
+        else if (const auto* d = std::get_if<CoalescedDelay>(&msg))
+        {
+          delay += rmf_traffic::Duration(d->delay);
+        }
+        else if (const auto* erase =
+          std::get_if<rmf_traffic_msgs::msg::ItineraryErase>(&msg))
+        {
+          const auto& routes = erase->routes;
+          itinerary.erase(
+            std::remove_if(
+              itinerary.begin(), itinerary.end(),
+              [&](const auto& item)
+              {
+                return std::find(routes.begin(), routes.end(), item.id)
+                != routes.end();
+              }),
+            itinerary.end());
+        }
+      }
+      else if (newer)
+      {
+        // This has to wait for the versions before it
+        continue;
+      }
+
+      // The message has either been folded or is older than the snapshot
+      if (newer || fresh)
+        participant.itinerary_version = last_version_of(msg);
+
+      messages.erase(it);
+      folded = true;
+      break;
+    }
+  }
+
+  shift();
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__REPLICATIONLOG_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__REPLICATIONLOG_HPP
+
+#include "ItineraryBatch.hpp"
+#include "ScheduleSnapshot.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A compact copy of the schedule for a standby that only needs to rebuild
+/// the schedule when it takes over. It holds a snapshot of the itinerary of
+/// each participant and a log of the itinerary messages that have arrived
+/// since then. The log is folded into the snapshot by compact(), so most of
+/// the time this only costs the memory of the itineraries and a few messages,
+/// and no patches need to be computed for it.
+///
+/// Messages are folded in the order of their itinerary versions. A set or a
+/// clear replaces everything that came before it, so it is folded right away,
+/// while any other message waits until the versions before it have arrived.
+/// The delays that are folded in one pass are added together, so the routes
+/// of a participant are only shifted once.
+///
+/// This class is not thread-safe.
+class ReplicationLog
+{
+public:
+
+  using ParticipantId = rmf_traffic::schedule::ParticipantId;
+  using Descriptions = rmf_traffic::schedule::ParticipantDescriptionsMap;
+
+  /// Start the snapshot over from a snapshot of the schedule. Participants
+  /// that are not in the baseline keep their current itineraries, and the
+  /// logged messages that the baseline already covers will be dropped by the
+  /// next compact().
+  void rebase(const ScheduleSnapshot& baseline);
+
+  /// Set which participants are in the schedule. Participants that are not
+  /// in the descriptions are dropped along with their logged messages.
+  void participants(const Descriptions& descriptions);
+
+  /// Log an itinerary message.
+  void record(ItineraryMsg msg);
+
+  /// Fold the logged messages into the snapshot.
+  void compact();
+
+  /// Get the snapshot. Call compact() first to include the logged messages.
+  /// Only the participants whose descriptions are known are included.
+  ScheduleSnapshot snapshot() const;
+
+  /// How many messages are waiting to be folded.
+  std::size_t logged() const;
+
+private:
+
+  using Participant = ScheduleSnapshot::Participant;
+
+  void _fold(Participant& participant, std::deque<ItineraryMsg>& messages);
+
+  std::unordered_map<ParticipantId, Participant> _participants;
+  std::unordered_map<ParticipantId, std::deque<ItineraryMsg>> _messages;
+  std::size_t _logged = 0;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__REPLICATIONLOG_HPP
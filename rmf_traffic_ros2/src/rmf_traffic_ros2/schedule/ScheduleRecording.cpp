@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ScheduleRecording.hpp"
+
+#include "Crc32.hpp"
+
+#include <array>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// Every recording begins with this header. The final byte is the format
+// version.
+constexpr std::array<uint8_t, 8> Header =
+{'R', 'M', 'F', 'S', 'R', 'E', 'C', 1};
+
+// Each record is laid out as
+//   [time: i64][payload length: u32][checksum: u32][input: u8][payload]
+// where the time is in nanoseconds since the start of the recording and the
+// checksum covers the input byte and the payload.
+constexpr std::size_t RecordPrefixSize = 17;
+
+//==============================================================================
+void write_u64(std::vector<uint8_t>& buffer, const uint64_t value)
+{
+  for (int i = 0; i < 8; ++i)
+    buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+void write_u32(std::vector<uint8_t>& buffer, const uint32_t value)
+{
+  for (int i = 0; i < 4; ++i)
+    buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+}
+
+//==============================================================================
+uint64_t read_u64(const uint8_t* data)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i)
+    value |= static_cast<uint64_t>(data[i]) << (8*i);
+
+  return value;
+}
+
+//==============================================================================
+uint32_t read_u32(const uint8_t* data)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i)
+    value |= static_cast<uint32_t>(data[i]) << (8*i);
+
+  return value;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+ScheduleRecordingWriter::ScheduleRecordingWriter(const std::string& file_path)
+: _file(file_path, std::ios::binary | std::ios::trunc)
+{
+  if (!_file)
+  {
+    throw ScheduleRecordingError(
+      "[ScheduleRecordingWriter] Unable to open [" + file_path
+      + "] for writing");
+  }
+
+  _file.write(reinterpret_cast<const char*>(Header.data()), Header.size());
+}
+
+//==============================================================================
+void ScheduleRecordingWriter::write(const RecordedMessage& recorded)
+{
+  const auto input_byte = static_cast<uint8_t>(recorded.input);
+  const uint32_t checksum = crc32(
+    recorded.data.data(), recorded.data.size(), crc32(&input_byte, 1));
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _buffer.clear();
+  write_u64(
+    _buffer,
+    static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        recorded.time).count()));
+  write_u32(_buffer, static_cast<uint32_t>(recorded.data.size()));
+  write_u32(_buffer, checksum);
+  _buffer.push_back(input_byte);
+  _buffer.insert(_buffer.end(), recorded.data.begin(), recorded.data.end());
+
+  _file.write(reinterpret_cast<const char*>(_buffer.data()), _buffer.size());
+}
+
+//==============================================================================
+void ScheduleRecordingWriter::flush()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _file.flush();
+}
+
+//==============================================================================
+ScheduleRecordingReader::ScheduleRecordingReader(const std::string& file_path)
+: _file(file_path, std::ios::binary)
+{
+  if (!_file)
+  {
+    throw ScheduleRecordingError(
+      "[ScheduleRecordingReader] Unable to open [" + file_path + "]");
+  }
+
+  std::array<uint8_t, Header.size()> header;
+  _file.read(reinterpret_cast<char*>(header.data()), header.size());
+  if (!_file || header != Header)
+  {
+    throw ScheduleRecordingError(
+      "[ScheduleRecordingReader] [" + file_path
+      + "] is not a schedule recording");
+  }
+}
+
+//==============================================================================
+std::optional<RecordedMessage> ScheduleRecordingReader::next()
+{
+  std::array<uint8_t, RecordPrefixSize> prefix;
+  _file.read(reinterpret_cast<char*>(prefix.data()), prefix.size());
+  if (_file.gcount() < static_cast<std::streamsize>(prefix.size()))
+    return std::nullopt;
+
+  const auto time = static_cast<int64_t>(read_u64(prefix.data()));
+  const auto size = read_u32(prefix.data() + 8);
+  const auto checksum = read_u32(prefix.data() + 12);
+  const auto input_byte = prefix[16];
+
+  RecordedMessage recorded;
+  recorded.input = static_cast<RecordedInput>(input_byte);
+  recorded.time = std::chrono::nanoseconds(time);
+  recorded.data.resize(size);
+  _file.read(reinterpret_cast<char*>(recorded.data.data()), size);
+  if (_file.gcount() < static_cast<std::streamsize>(size))
+    return std::nullopt;
+
+  if (crc32(recorded.data.data(), size, crc32(&input_byte, 1)) != checksum)
+  {
+    throw ScheduleRecordingError(
+      "[ScheduleRecordingReader] Corrupted record at "
+      + std::to_string(time) + "ns");
+  }
+
+  return recorded;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
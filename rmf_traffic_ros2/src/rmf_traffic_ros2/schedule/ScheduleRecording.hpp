@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULERECORDING_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULERECORDING_HPP
+
+#include <rmf_traffic/Time.hpp>
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// The inputs of the schedule node that a recording can contain. The values
+/// are stored in recordings, so they must never be changed or reused.
+enum class RecordedInput : uint8_t
+{
+  Participants = 1,
+  ItinerarySet = 2,
+  ItineraryExtend = 3,
+  ItineraryDelay = 4,
+  ItineraryErase = 5,
+  ItineraryClear = 6,
+  ItineraryBatch = 7,
+  NegotiationAck = 8,
+  NegotiationRefusal = 9,
+  NegotiationProposal = 10,
+  NegotiationProposalDiff = 11,
+  NegotiationRejection = 12,
+  NegotiationForfeit = 13
+};
+
+//==============================================================================
+/// One message that the schedule node received, in its serialized form
+struct RecordedMessage
+{
+  RecordedInput input;
+
+  /// When the message was received, relative to the start of the recording
+  rmf_traffic::Duration time;
+
+  /// The CDR serialization of the message
+  std::vector<uint8_t> data;
+};
+
+//==============================================================================
+/// Thrown when a recording cannot be written or read.
+class ScheduleRecordingError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+/// Serialize a message so that it can be recorded.
+template<typename Message>
+RecordedMessage make_recorded_message(
+  const RecordedInput input,
+  const rmf_traffic::Duration time,
+  const Message& msg)
+{
+  rclcpp::SerializedMessage serialized;
+  rclcpp::Serialization<Message>().serialize_message(&msg, &serialized);
+  const auto& raw = serialized.get_rcl_serialized_message();
+  return {input, time, {raw.buffer, raw.buffer + raw.buffer_length}};
+}
+
+//==============================================================================
+/// Get back the message of a recording.
+template<typename Message>
+Message decode_recorded_message(const RecordedMessage& recorded)
+{
+  rclcpp::SerializedMessage serialized(recorded.data.size());
+  auto& raw = serialized.get_rcl_serialized_message();
+  std::memcpy(raw.buffer, recorded.data.data(), recorded.data.size());
+  raw.buffer_length = recorded.data.size();
+
+  Message msg;
+  rclcpp::Serialization<Message>().deserialize_message(&serialized, &msg);
+  return msg;
+}
+
+//==============================================================================
+/// Appends the inputs of a schedule node to a recording file. Every record
+/// carries a checksum, so a recording that was cut short by a crash can still
+/// be replayed up to its last complete record. This class is thread-safe.
+class ScheduleRecordingWriter
+{
+public:
+
+  /// Create a new recording, replacing any file that is already at
+  /// file_path. Throws a ScheduleRecordingError if the file cannot be opened.
+  explicit ScheduleRecordingWriter(const std::string& file_path);
+
+  template<typename Message>
+  void write(
+    const RecordedInput input,
+    const rmf_traffic::Duration time,
+    const Message& msg)
+  {
+    write(make_recorded_message(input, time, msg));
+  }
+
+  void write(const RecordedMessage& recorded);
+
+  /// Push everything that has been written so far out to the file.
+  void flush();
+
+private:
+  std::mutex _mutex;
+  std::ofstream _file;
+  std::vector<uint8_t> _buffer;
+};
+
+//==============================================================================
+/// Reads the messages of a recording in the order they were received.
+class ScheduleRecordingReader
+{
+public:
+
+  /// Open a recording. Throws a ScheduleRecordingError if the file cannot be
+  /// opened or is not a schedule recording.
+  explicit ScheduleRecordingReader(const std::string& file_path);
+
+  /// Get the next message. This returns a std::nullopt at the end of the
+  /// recording, including when the last record was only partly written, and
+  /// throws a ScheduleRecordingError if a record has been corrupted.
+  std::optional<RecordedMessage> next();
+
+private:
+  std::ifstream _file;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULERECORDING_HPP
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ScheduleRetention.hpp"
+
+#include <algorithm>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// A waypoint holds a time, a position, and a velocity, plus the bookkeeping
+// of the trajectory that it belongs to.
+constexpr std::size_t WaypointBytes = 8 + 2*3*8 + 48;
+} // anonymous namespace
+
+//==============================================================================
+std::size_t estimate_route_bytes(const rmf_traffic::Route& route)
+{
+  return sizeof(rmf_traffic::Route) + route.map().size()
+    + route.trajectory().size() * WaypointBytes;
+}
+
+//==============================================================================
+std::optional<rmf_traffic::Time> choose_budget_cull_time(
+  std::vector<RouteFootprint> routes,
+  const std::size_t budget,
+  const rmf_traffic::Time latest)
+{
+  std::size_t total = 0;
+  for (const auto& route : routes)
+    total += route.bytes;
+
+  if (total <= budget)
+    return std::nullopt;
+
+  std::sort(
+    routes.begin(), routes.end(),
+    [](const RouteFootprint& a, const RouteFootprint& b)
+    {
+      return a.finish < b.finish;
+    });
+
+  std::optional<rmf_traffic::Time> cull_time;
+  for (const auto& route : routes)
+  {
+    if (total <= budget || latest <= route.finish)
+      break;
+
+    // Culling removes the routes that finish before the cull time, so it has
+    // to land just after this one.
+    total -= route.bytes;
+    cull_time = route.finish + rmf_traffic::Duration(1);
+  }
+
+  return cull_time;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULERETENTION_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULERETENTION_HPP
+
+#include <rmf_traffic/Route.hpp>
+#include <rmf_traffic/Time.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A rough estimate of how much memory the schedule uses to store a route.
+/// This only needs to be good enough to compare against a memory budget.
+std::size_t estimate_route_bytes(const rmf_traffic::Route& route);
+
+//==============================================================================
+/// The finish time and estimated size of one route in the schedule
+struct RouteFootprint
+{
+  rmf_traffic::Time finish;
+  std::size_t bytes;
+};
+
+//==============================================================================
+/// Choose the time that the schedule should be culled up to so that its
+/// routes fit within a memory budget. Routes are given up in the order that
+/// they finish, and no route which finishes at or after the latest time will
+/// be given up, since those still matter to the participants.
+///
+/// \return the cull time, or std::nullopt if nothing needs to be culled.
+std::optional<rmf_traffic::Time> choose_budget_cull_time(
+  std::vector<RouteFootprint> routes,
+  std::size_t budget,
+  rmf_traffic::Time latest);
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULERETENTION_HPP
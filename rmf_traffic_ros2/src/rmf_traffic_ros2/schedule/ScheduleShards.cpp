@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ScheduleShards.hpp"
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+ScheduleShards::ScheduleShards(const std::vector<std::string>& entries)
+: _names({""})
+{
+  for (const auto& entry : entries)
+  {
+    const auto colon = entry.find(':');
+    if (colon == std::string::npos || colon == 0)
+    {
+      throw ScheduleShardsError(
+        "Schedule shard [" + entry + "] must have the form "
+        "<namespace>:<map>,<map>,...");
+    }
+
+    const std::size_t shard = _names.size();
+    _names.push_back(entry.substr(0, colon));
+
+    std::size_t begin = colon + 1;
+    while (begin <= entry.size())
+    {
+      auto end = entry.find(',', begin);
+      if (end == std::string::npos)
+        end = entry.size();
+
+      const auto map = entry.substr(begin, end - begin);
+      begin = end + 1;
+      if (map.empty())
+        continue;
+
+      if (!_maps.insert({map, shard}).second)
+      {
+        throw ScheduleShardsError(
+          "Map [" + map + "] has been given to more than one schedule shard");
+      }
+    }
+  }
+}
+
+//==============================================================================
+std::size_t ScheduleShards::size() const
+{
+  return _names.size();
+}
+
+//==============================================================================
+const std::string& ScheduleShards::name(const std::size_t shard) const
+{
+  return _names.at(shard);
+}
+
+//==============================================================================
+std::size_t ScheduleShards::shard_of(const std::string& map) const
+{
+  const auto it = _maps.find(map);
+  if (it == _maps.end())
+    return 0;
+
+  return it->second;
+}
+
+//==============================================================================
+ScheduleShards get_schedule_shards(rclcpp::Node& node)
+{
+  if (!node.has_parameter(ScheduleShardsParameter))
+  {
+    node.declare_parameter<std::vector<std::string>>(
+      ScheduleShardsParameter, std::vector<std::string>());
+  }
+
+  return ScheduleShards(
+    node.get_parameter(ScheduleShardsParameter).as_string_array());
+}
+
+//==============================================================================
+ItineraryRouter::ItineraryRouter(ScheduleShards shards)
+: _shards(std::move(shards))
+{
+  // Do nothing
+}
+
+//==============================================================================
+const ScheduleShards& ItineraryRouter::shards() const
+{
+  return _shards;
+}
+
+//==============================================================================
+auto ItineraryRouter::split(const Set& msg) -> std::vector<Set>
+{
+  forget(msg.participant);
+
+  auto items = split_items(msg.participant, msg.itinerary);
+  std::vector<Set> output(_shards.size());
+  for (std::size_t i = 0; i < output.size(); ++i)
+  {
+    output[i].participant = msg.participant;
+    output[i].itinerary = std::move(items[i]);
+    output[i].itinerary_version = msg.itinerary_version;
+  }
+
+  return output;
+}
+
+//==============================================================================
+auto ItineraryRouter::split(const Extend& msg) -> std::vector<Extend>
+{
+  auto items = split_items(msg.participant, msg.routes);
+  std::vector<Extend> output(_shards.size());
+  for (std::size_t i = 0; i < output.size(); ++i)
+  {
+    output[i].participant = msg.participant;
+    output[i].routes = std::move(items[i]);
+    output[i].itinerary_version = msg.itinerary_version;
+  }
+
+  return output;
+}
+
+//==============================================================================
+auto ItineraryRouter::split(const Erase& msg) -> std::vector<Erase>
+{
+  std::vector<Erase> output(_shards.size());
+  for (auto& erase : output)
+  {
+    erase.participant = msg.participant;
+    erase.itinerary_version = msg.itinerary_version;
+  }
+
+  const auto participant = _routes.find(msg.participant);
+  for (const auto route : msg.routes)
+  {
+    if (participant != _routes.end())
+    {
+      const auto it = participant->second.find(route);
+      if (it != participant->second.end())
+      {
+        output[it->second].routes.push_back(route);
+        participant->second.erase(it);
+        continue;
+      }
+    }
+
+    for (auto& erase : output)
+      erase.routes.push_back(route);
+  }
+
+  return output;
+}
+
+//==============================================================================
+void ItineraryRouter::forget(const uint64_t participant)
+{
+  _routes.erase(participant);
+}
+
+//==============================================================================
+auto ItineraryRouter::split_items(
+  const uint64_t participant,
+  const Items& items) -> std::vector<Items>
+{
+  std::vector<Items> output(_shards.size());
+  auto& routes = _routes[participant];
+  for (const auto& item : items)
+  {
+    const auto shard = _shards.shard_of(item.route.map);
+    routes[item.id] = shard;
+    output[shard].push_back(item);
+  }
+
+  return output;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULESHARDS_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULESHARDS_HPP
+
+#include <rmf_traffic_msgs/msg/itinerary_set.hpp>
+#include <rmf_traffic_msgs/msg/itinerary_extend.hpp>
+#include <rmf_traffic_msgs/msg/itinerary_erase.hpp>
+
+#include <rclcpp/node.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// The name of the parameter that splits the schedule into shards. Each entry
+/// has the form "<namespace>:<map>,<map>,..." and says that the itineraries
+/// on those maps belong to the schedule node running in that namespace. Maps
+/// that are not listed stay with the schedule node in the namespace of the
+/// writer, which also registers every participant for all the shards.
+const std::string ScheduleShardsParameter = "schedule_shards";
+
+//==============================================================================
+/// Thrown when the schedule_shards parameter cannot be understood.
+class ScheduleShardsError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+/// Decides which shard of the schedule each map belongs to. Shard 0 is always
+/// the schedule node that registers participants, and its namespace is empty.
+class ScheduleShards
+{
+public:
+
+  /// Parse the entries of the schedule_shards parameter. This throws a
+  /// ScheduleShardsError if an entry is malformed or a map is given to more
+  /// than one shard.
+  explicit ScheduleShards(const std::vector<std::string>& entries = {});
+
+  /// The number of shards, including shard 0
+  std::size_t size() const;
+
+  /// The namespace of a shard, relative to the namespace of the writer
+  const std::string& name(std::size_t shard) const;
+
+  /// The shard that owns the itineraries on a map
+  std::size_t shard_of(const std::string& map) const;
+
+private:
+  std::vector<std::string> _names;
+  std::unordered_map<std::string, std::size_t> _maps;
+};
+
+//==============================================================================
+/// Get the schedule shards that the node is configured with, declaring the
+/// parameter if nobody has declared it yet.
+ScheduleShards get_schedule_shards(rclcpp::Node& node);
+
+//==============================================================================
+/// Get the name that a topic or service has within a shard namespace.
+inline std::string shard_topic_name(
+  const std::string& shard,
+  const std::string& name)
+{
+  if (shard.empty())
+    return name;
+
+  if (shard.back() == '/')
+    return shard + name;
+
+  return shard + "/" + name;
+}
+
+//==============================================================================
+/// Splits the itinerary changes of participants across the schedule shards.
+/// Every shard receives one message for every itinerary version, even when
+/// none of the routes belong to it, so that no shard ever sees a gap in the
+/// versions of a participant. Delays and clears apply to every route, so they
+/// can be sent to every shard as they are.
+///
+/// This class is not thread-safe.
+class ItineraryRouter
+{
+public:
+
+  using Set = rmf_traffic_msgs::msg::ItinerarySet;
+  using Extend = rmf_traffic_msgs::msg::ItineraryExtend;
+  using Erase = rmf_traffic_msgs::msg::ItineraryErase;
+
+  explicit ItineraryRouter(ScheduleShards shards);
+
+  const ScheduleShards& shards() const;
+
+  /// Split a set into one message per shard. The routes of the participant
+  /// that were known before are forgotten. The schedule does not accept empty
+  /// sets, so a shard that gets no routes should be sent a clear instead.
+  std::vector<Set> split(const Set& msg);
+
+  /// Split an extend into one message per shard.
+  std::vector<Extend> split(const Extend& msg);
+
+  /// Split an erase into one message per shard. Routes that this router has
+  /// never seen are sent to every shard.
+  std::vector<Erase> split(const Erase& msg);
+
+  /// Forget the routes of a participant, e.g. after its itinerary has been
+  /// cleared.
+  void forget(uint64_t participant);
+
+private:
+  using Items = std::vector<rmf_traffic_msgs::msg::ScheduleWriterItem>;
+  std::vector<Items> split_items(uint64_t participant, const Items& items);
+
+  ScheduleShards _shards;
+
+  // The shard that each route of each participant was sent to
+  std::unordered_map<uint64_t, std::unordered_map<uint64_t, std::size_t>>
+  _routes;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULESHARDS_HPP
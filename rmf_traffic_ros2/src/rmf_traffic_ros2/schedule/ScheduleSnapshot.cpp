@@ -0,0 +1,585 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ScheduleSnapshot.hpp"
+#include "Crc32.hpp"
+
+#include <rmf_traffic_ros2/Route.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+#include <rmf_traffic_ros2/schedule/Query.hpp>
+
+#include <rmf_traffic/schedule/Mirror.hpp>
+
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+// Every snapshot begins with this header, followed by a byte for the format.
+constexpr std::array<uint8_t, 7> Header =
+{'R', 'M', 'F', 'S', 'N', 'A', 'P'};
+
+// The routes of a full snapshot are CDR messages. The routes of a compact
+// snapshot are quantized and delta coded by encode_compact_route(), and the
+// body begins with the resolution that was used.
+constexpr uint8_t FullFormat = 1;
+constexpr uint8_t CompactFormat = 2;
+
+// The file is laid out as
+//   [header: 7][format: 1][body size: u64][body checksum: u32][reserved: u32]
+//   [body]
+// with every integer stored little-endian at a fixed width, so the body can
+// be read straight out of a memory mapping of the file. Each message inside
+// the body is stored as [size: u32][CDR payload].
+constexpr std::size_t PrefixSize = 24;
+
+//==============================================================================
+class ByteWriter
+{
+public:
+
+  std::vector<uint8_t> buffer;
+
+  void u32(const uint32_t value)
+  {
+    for (int i = 0; i < 4; ++i)
+      buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+  }
+
+  void u64(const uint64_t value)
+  {
+    for (int i = 0; i < 8; ++i)
+      buffer.push_back(static_cast<uint8_t>(value >> (8*i)));
+  }
+
+  template<typename Msg>
+  void message(const Msg& msg)
+  {
+    rclcpp::SerializedMessage serialized;
+    rclcpp::Serialization<Msg>().serialize_message(&msg, &serialized);
+    const auto& raw = serialized.get_rcl_serialized_message();
+    u32(static_cast<uint32_t>(raw.buffer_length));
+    buffer.insert(buffer.end(), raw.buffer, raw.buffer + raw.buffer_length);
+  }
+
+  void real(const double value)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    u64(bits);
+  }
+
+  void bytes(const std::vector<uint8_t>& data)
+  {
+    u32(static_cast<uint32_t>(data.size()));
+    buffer.insert(buffer.end(), data.begin(), data.end());
+  }
+};
+
+//==============================================================================
+class ByteReader
+{
+public:
+
+  ByteReader(const uint8_t* data, const std::size_t size)
+  : _data(data),
+    _size(size)
+  {
+    // Do nothing
+  }
+
+  uint32_t u32()
+  {
+    _require(4);
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+      value |= static_cast<uint32_t>(_data[_index++]) << (8*i);
+
+    return value;
+  }
+
+  uint64_t u64()
+  {
+    _require(8);
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i)
+      value |= static_cast<uint64_t>(_data[_index++]) << (8*i);
+
+    return value;
+  }
+
+  template<typename Msg>
+  Msg message()
+  {
+    const std::size_t size = u32();
+    _require(size);
+
+    rclcpp::SerializedMessage serialized(size);
+    auto& raw = serialized.get_rcl_serialized_message();
+    std::memcpy(raw.buffer, _data + _index, size);
+    raw.buffer_length = size;
+    _index += size;
+
+    Msg msg;
+    rclcpp::Serialization<Msg>().deserialize_message(&serialized, &msg);
+    return msg;
+  }
+
+  double real()
+  {
+    const uint64_t bits = u64();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  std::vector<uint8_t> bytes()
+  {
+    const std::size_t size = u32();
+    _require(size);
+    std::vector<uint8_t> data(_data + _index, _data + _index + size);
+    _index += size;
+    return data;
+  }
+
+  bool done() const
+  {
+    return _index == _size;
+  }
+
+private:
+
+  void _require(const std::size_t bytes) const
+  {
+    if (_size - _index < bytes)
+      throw ScheduleSnapshotError("Truncated schedule snapshot");
+  }
+
+  const uint8_t* _data;
+  std::size_t _size;
+  std::size_t _index = 0;
+};
+
+//==============================================================================
+[[noreturn]] void throw_errno(const std::string& what, const std::string& path)
+{
+  throw ScheduleSnapshotError(
+    "[ScheduleSnapshot] Failed to " + what + " [" + path + "]: "
+    + std::strerror(errno));
+}
+
+//==============================================================================
+/// A read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+
+  MappedFile(const std::string& path)
+  {
+    _fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (_fd < 0)
+      throw_errno("open", path);
+
+    struct stat info;
+    if (::fstat(_fd, &info) != 0)
+    {
+      ::close(_fd);
+      throw_errno("stat", path);
+    }
+
+    _size = static_cast<std::size_t>(info.st_size);
+    if (_size == 0)
+      return;
+
+    void* const data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (data == MAP_FAILED)
+    {
+      ::close(_fd);
+      throw_errno("map", path);
+    }
+
+    _data = static_cast<const uint8_t*>(data);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile()
+  {
+    if (_data)
+      ::munmap(const_cast<uint8_t*>(_data), _size);
+    ::close(_fd);
+  }
+
+  const uint8_t* data() const
+  {
+    return _data;
+  }
+
+  std::size_t size() const
+  {
+    return _size;
+  }
+
+private:
+  int _fd = -1;
+  const uint8_t* _data = nullptr;
+  std::size_t _size = 0;
+};
+
+} // anonymous namespace
+
+//==============================================================================
+ScheduleSnapshot take_schedule_snapshot(
+  const rmf_traffic::schedule::Database& database,
+  std::unordered_map<uint64_t, rmf_traffic::schedule::Query> queries,
+  const uint64_t node_version)
+{
+  ScheduleSnapshot snapshot;
+  snapshot.node_version = node_version;
+  snapshot.database_version = database.latest_version();
+  snapshot.queries = std::move(queries);
+
+  // Asking for every change since the beginning of time gives us the current
+  // itinerary of every participant along with their route IDs.
+  const auto patch = database.changes(
+    rmf_traffic::schedule::query_all(), std::nullopt);
+
+  std::unordered_map<
+    rmf_traffic::schedule::ParticipantId,
+    const rmf_traffic::schedule::Patch::Participant*> changes;
+  for (const auto& p : patch)
+    changes[p.participant_id()] = &p;
+
+  for (const auto id : database.participant_ids())
+  {
+    const auto description = database.get_participant(id);
+    if (!description)
+      continue;
+
+    ScheduleSnapshot::Participant participant{
+      id,
+      *description,
+      database.itinerary_version(id),
+      {}
+    };
+
+    const auto it = changes.find(id);
+    if (it != changes.end())
+    {
+      for (const auto& item : it->second->additions().items())
+        participant.itinerary.push_back({item.id, item.route});
+    }
+
+    snapshot.participants.emplace_back(std::move(participant));
+  }
+
+  return snapshot;
+}
+
+//==============================================================================
+std::vector<uint8_t> encode_schedule_snapshot(
+  const ScheduleSnapshot& snapshot,
+  const std::optional<CompactResolution>& compact)
+{
+  ByteWriter body;
+  if (compact)
+  {
+    body.real(compact->linear);
+    body.real(compact->angular);
+  }
+
+  body.u64(snapshot.node_version);
+  body.u64(snapshot.database_version);
+  body.u32(static_cast<uint32_t>(snapshot.queries.size()));
+  body.u32(static_cast<uint32_t>(snapshot.participants.size()));
+
+  for (const auto& [query_id, query] : snapshot.queries)
+  {
+    body.u64(query_id);
+    body.message(rmf_traffic_ros2::convert(query));
+  }
+
+  for (const auto& participant : snapshot.participants)
+  {
+    body.u64(participant.id);
+    body.u64(participant.itinerary_version);
+    body.message(rmf_traffic_ros2::convert(participant.description));
+    body.u32(static_cast<uint32_t>(participant.itinerary.size()));
+    for (const auto& item : participant.itinerary)
+    {
+      body.u64(item.id);
+      if (compact)
+        body.bytes(encode_compact_route(*item.route, *compact));
+      else
+        body.message(rmf_traffic_ros2::convert(*item.route));
+    }
+  }
+
+  ByteWriter file;
+  file.buffer.reserve(PrefixSize + body.buffer.size());
+  file.buffer.insert(file.buffer.end(), Header.begin(), Header.end());
+  file.buffer.push_back(compact ? CompactFormat : FullFormat);
+  file.u64(body.buffer.size());
+  file.u32(crc32(body.buffer.data(), body.buffer.size()));
+  file.u32(0);
+  file.buffer.insert(
+    file.buffer.end(), body.buffer.begin(), body.buffer.end());
+
+  return std::move(file.buffer);
+}
+
+//==============================================================================
+void write_schedule_snapshot(
+  const std::string& file_path,
+  const ScheduleSnapshot& snapshot)
+{
+  const auto buffer = encode_schedule_snapshot(snapshot);
+
+  const std::string tmp_path = file_path + ".tmp";
+  const int fd = ::open(
+    tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    throw_errno("create", tmp_path);
+
+  std::size_t written = 0;
+  while (written < buffer.size())
+  {
+    const auto n = ::write(
+      fd, buffer.data() + written, buffer.size() - written);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      ::close(fd);
+      std::filesystem::remove(tmp_path);
+      throw_errno("write to", tmp_path);
+    }
+
+    written += static_cast<std::size_t>(n);
+  }
+
+  if (::fsync(fd) != 0)
+  {
+    ::close(fd);
+    std::filesystem::remove(tmp_path);
+    throw_errno("sync", tmp_path);
+  }
+
+  ::close(fd);
+  std::filesystem::rename(tmp_path, file_path);
+
+  const auto dir = std::filesystem::absolute(file_path).parent_path();
+  const int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd >= 0)
+  {
+    ::fsync(dir_fd);
+    ::close(dir_fd);
+  }
+}
+
+//==============================================================================
+std::optional<ScheduleSnapshot> read_schedule_snapshot(
+  const std::string& file_path)
+{
+  if (!std::filesystem::exists(file_path))
+    return std::nullopt;
+
+  const MappedFile file(file_path);
+  return decode_schedule_snapshot(file.data(), file.size(), file_path);
+}
+
+//==============================================================================
+ScheduleSnapshot decode_schedule_snapshot(
+  const uint8_t* const data,
+  const std::size_t size,
+  const std::string& source)
+{
+  if (size < PrefixSize || !std::equal(Header.begin(), Header.end(), data))
+  {
+    throw ScheduleSnapshotError(
+      "[ScheduleSnapshot] File [" + source + "] is not a schedule snapshot");
+  }
+
+  const uint8_t format = data[Header.size()];
+  if (format != FullFormat && format != CompactFormat)
+  {
+    throw ScheduleSnapshotError(
+      "[ScheduleSnapshot] File [" + source + "] has unsupported format ["
+      + std::to_string(format) + "]");
+  }
+
+  ByteReader prefix(data + Header.size() + 1, PrefixSize - Header.size() - 1);
+  const uint64_t body_size = prefix.u64();
+  const uint32_t checksum = prefix.u32();
+  if (body_size != size - PrefixSize)
+  {
+    throw ScheduleSnapshotError(
+      "[ScheduleSnapshot] File [" + source + "] has the wrong size");
+  }
+
+  const uint8_t* const body = data + PrefixSize;
+  if (crc32(body, body_size) != checksum)
+  {
+    throw ScheduleSnapshotError(
+      "[ScheduleSnapshot] File [" + source + "] is corrupt");
+  }
+
+  ByteReader r(body, body_size);
+  std::optional<CompactResolution> compact;
+  if (format == CompactFormat)
+  {
+    compact = CompactResolution{r.real(), r.real()};
+    if (!(compact->linear > 0.0) || !(compact->angular > 0.0))
+    {
+      throw ScheduleSnapshotError(
+        "[ScheduleSnapshot] File [" + source + "] has an invalid resolution");
+    }
+  }
+
+  ScheduleSnapshot snapshot;
+  snapshot.node_version = r.u64();
+  snapshot.database_version = r.u64();
+  const uint32_t num_queries = r.u32();
+  const uint32_t num_participants = r.u32();
+
+  for (uint32_t i = 0; i < num_queries; ++i)
+  {
+    const uint64_t query_id = r.u64();
+    snapshot.queries.insert_or_assign(
+      query_id,
+      rmf_traffic_ros2::convert(
+        r.message<rmf_traffic_msgs::msg::ScheduleQuery>()));
+  }
+
+  for (uint32_t i = 0; i < num_participants; ++i)
+  {
+    const auto id = r.u64();
+    const auto itinerary_version = r.u64();
+    auto description = rmf_traffic_ros2::convert(
+      r.message<rmf_traffic_msgs::msg::ParticipantDescription>());
+
+    rmf_traffic::schedule::Writer::Input itinerary;
+    const uint32_t num_routes = r.u32();
+    for (uint32_t k = 0; k < num_routes; ++k)
+    {
+      const auto route_id = r.u64();
+      std::shared_ptr<rmf_traffic::Route> route;
+      if (compact)
+      {
+        try
+        {
+          route = std::make_shared<rmf_traffic::Route>(
+            decode_compact_route(r.bytes(), *compact));
+        }
+        catch (const CompactDecodeError& e)
+        {
+          throw ScheduleSnapshotError(
+            "[ScheduleSnapshot] File [" + source + "] has a bad route: "
+            + e.what());
+        }
+      }
+      else
+      {
+        route = std::make_shared<rmf_traffic::Route>(
+          rmf_traffic_ros2::convert(
+            r.message<rmf_traffic_msgs::msg::Route>()));
+      }
+
+      itinerary.push_back({route_id, std::move(route)});
+    }
+
+    snapshot.participants.push_back(
+      {
+        id,
+        std::move(description),
+        itinerary_version,
+        std::move(itinerary)
+      });
+  }
+
+  if (!r.done())
+  {
+    throw ScheduleSnapshotError(
+      "[ScheduleSnapshot] File [" + source + "] has trailing bytes");
+  }
+
+  return snapshot;
+}
+
+//==============================================================================
+std::size_t restore_schedule_snapshot(
+  const ScheduleSnapshot& snapshot,
+  rmf_traffic::schedule::Database& database)
+{
+  // The registered participants are carried into a fresh database through a
+  // mirror, since that is the only way to give a database participant IDs
+  // that it did not choose itself.
+  rmf_traffic::schedule::ParticipantDescriptionsMap participants;
+  for (const auto id : database.participant_ids())
+    participants.insert({id, *database.get_participant(id)});
+
+  rmf_traffic::schedule::Mirror mirror;
+  mirror.update_participants_info(participants);
+  auto fresh = mirror.fork();
+
+  std::size_t restored = 0;
+  for (const auto& participant : snapshot.participants)
+  {
+    const auto it = participants.find(participant.id);
+    if (it == participants.end()
+      || it->second.name() != participant.description.name()
+      || it->second.owner() != participant.description.owner())
+    {
+      continue;
+    }
+
+    // Setting the itinerary also brings the itinerary version forward, even
+    // when the itinerary is empty, so the participant does not get flagged as
+    // inconsistent the next time it changes its itinerary.
+    if (!participant.itinerary.empty() || participant.itinerary_version != 0)
+    {
+      fresh.set(
+        participant.id,
+        participant.itinerary,
+        participant.itinerary_version);
+    }
+
+    ++restored;
+  }
+
+  database = std::move(fresh);
+  return restored;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULESNAPSHOT_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULESNAPSHOT_HPP
+
+#include "CompactMirrorUpdate.hpp"
+
+#include <rmf_traffic/schedule/Database.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A point-in-time copy of everything the schedule node needs in order to
+/// resume where it left off: the itinerary of every participant, the
+/// itinerary versions that the participants are expecting, and the queries
+/// that mirrors have registered.
+struct ScheduleSnapshot
+{
+  struct Participant
+  {
+    rmf_traffic::schedule::ParticipantId id;
+    rmf_traffic::schedule::ParticipantDescription description;
+    rmf_traffic::schedule::ItineraryVersion itinerary_version;
+    rmf_traffic::schedule::Writer::Input itinerary;
+  };
+
+  uint64_t node_version = 0;
+  rmf_traffic::schedule::Version database_version = 0;
+  std::vector<Participant> participants;
+  std::unordered_map<uint64_t, rmf_traffic::schedule::Query> queries;
+};
+
+//==============================================================================
+/// Thrown when a snapshot file exists but cannot be read.
+class ScheduleSnapshotError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+//==============================================================================
+/// Copy the current state of the database. The routes are shared rather than
+/// copied, so this is cheap enough to do while holding the database mutex.
+ScheduleSnapshot take_schedule_snapshot(
+  const rmf_traffic::schedule::Database& database,
+  std::unordered_map<uint64_t, rmf_traffic::schedule::Query> queries,
+  uint64_t node_version);
+
+//==============================================================================
+/// Write a snapshot to disk. The snapshot is written next to file_path and
+/// then renamed over it, so a crash will never leave a partial snapshot
+/// behind.
+void write_schedule_snapshot(
+  const std::string& file_path,
+  const ScheduleSnapshot& snapshot);
+
+//==============================================================================
+/// Encode a snapshot into the same bytes that write_schedule_snapshot() puts
+/// into a file, including the header and checksum.
+///
+/// If a compact resolution is given, the trajectories are quantized to it and
+/// delta coded, which makes the encoding several times smaller at the cost of
+/// precision. This suits read-mostly copies of the schedule, such as a shared
+/// mirror segment, better than files that the schedule node restores from.
+std::vector<uint8_t> encode_schedule_snapshot(
+  const ScheduleSnapshot& snapshot,
+  const std::optional<CompactResolution>& compact = std::nullopt);
+
+//==============================================================================
+/// Decode the bytes produced by encode_schedule_snapshot(). The source is only
+/// used to describe where the bytes came from if a ScheduleSnapshotError gets
+/// thrown.
+ScheduleSnapshot decode_schedule_snapshot(
+  const uint8_t* data,
+  std::size_t size,
+  const std::string& source);
+
+//==============================================================================
+/// Read a snapshot from disk. This returns a std::nullopt if there is no
+/// snapshot at file_path, and throws a ScheduleSnapshotError if the file is
+/// not a valid snapshot.
+std::optional<ScheduleSnapshot> read_schedule_snapshot(
+  const std::string& file_path);
+
+//==============================================================================
+/// Replace the database with a fresh one that holds the participants of the
+/// database and the itineraries of the snapshot. The participants must
+/// already be registered, which is normally done by the ParticipantRegistry.
+/// Any participant whose ID does not refer to the same name and owner in the
+/// database will be left with an empty itinerary.
+///
+/// \return the number of participants that were restored.
+std::size_t restore_schedule_snapshot(
+  const ScheduleSnapshot& snapshot,
+  rmf_traffic::schedule::Database& database);
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__SCHEDULESNAPSHOT_HPP
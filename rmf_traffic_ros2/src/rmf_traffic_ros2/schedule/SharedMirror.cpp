@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_ros2/schedule/SharedMirror.hpp>
+
+#include "ScheduleSnapshot.hpp"
+
+#include <rmf_traffic/schedule/Mirror.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+namespace {
+//==============================================================================
+constexpr std::array<uint8_t, 8> Magic =
+{'R', 'M', 'F', 'S', 'H', 'M', 'R', 1};
+
+//==============================================================================
+// The segment begins with this header, followed by the encoded snapshot at
+// PayloadOffset. The sequence works as a seqlock: it is odd while a snapshot
+// is being written, and the stamp that readers see is half of it.
+struct SegmentHeader
+{
+  std::array<uint8_t, 8> magic;
+  std::atomic<uint64_t> capacity;
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint64_t> size;
+};
+
+static_assert(
+  std::atomic<uint64_t>::is_always_lock_free,
+  "The shared mirror needs lock-free atomics to work across processes");
+
+constexpr std::size_t PayloadOffset = 64;
+static_assert(sizeof(SegmentHeader) <= PayloadOffset);
+
+// How many times a reader will retry when the publisher writes a new snapshot
+// while the reader is copying the last one.
+constexpr std::size_t MaxReadAttempts = 16;
+
+//==============================================================================
+std::string segment_path(const std::string& segment_name)
+{
+  return "/dev/shm/" + segment_name;
+}
+
+//==============================================================================
+[[noreturn]] void throw_errno(const std::string& what, const std::string& path)
+{
+  throw std::runtime_error(
+    "[SharedMirror] Failed to " + what + " [" + path + "]: "
+    + std::strerror(errno));
+}
+
+//==============================================================================
+std::shared_ptr<const rmf_traffic::schedule::Snapshot> make_snapshot(
+  const ScheduleSnapshot& decoded)
+{
+  rmf_traffic::schedule::ParticipantDescriptionsMap descriptions;
+  std::vector<rmf_traffic::schedule::Patch::Participant> changes;
+  for (const auto& participant : decoded.participants)
+  {
+    descriptions.insert({participant.id, participant.description});
+
+    std::vector<rmf_traffic::schedule::Change::Add::Item> additions;
+    additions.reserve(participant.itinerary.size());
+    for (const auto& item : participant.itinerary)
+      additions.push_back({item.id, item.route});
+
+    changes.emplace_back(
+      participant.id,
+      participant.itinerary_version,
+      rmf_traffic::schedule::Change::Erase(std::vector<uint64_t>()),
+      std::vector<rmf_traffic::schedule::Change::Delay>(),
+      rmf_traffic::schedule::Change::Add(std::move(additions)));
+  }
+
+  rmf_traffic::schedule::Mirror mirror;
+  mirror.update_participants_info(descriptions);
+  mirror.update(
+    rmf_traffic::schedule::Patch(
+      std::move(changes),
+      std::nullopt,
+      std::nullopt,
+      decoded.database_version));
+
+  return mirror.snapshot();
+}
+
+} // anonymous namespace
+
+//==============================================================================
+class SharedMirrorPublisher::Implementation
+{
+public:
+
+  std::string path;
+  int fd = -1;
+  void* data = nullptr;
+  std::size_t mapped_size = 0;
+  SegmentHeader* header = nullptr;
+  uint8_t* payload = nullptr;
+  std::optional<CompactResolution> compact;
+
+  Implementation() = default;
+  Implementation(const Implementation&) = delete;
+  Implementation& operator=(const Implementation&) = delete;
+
+  ~Implementation()
+  {
+    if (data)
+      ::munmap(data, mapped_size);
+
+    if (fd >= 0)
+      ::close(fd);
+  }
+};
+
+//==============================================================================
+SharedMirrorPublisher::SharedMirrorPublisher(
+  const std::string& segment_name,
+  const std::size_t capacity)
+: _pimpl(rmf_utils::make_unique_impl<Implementation>())
+{
+  auto& impl = *_pimpl;
+  impl.path = segment_path(segment_name);
+  impl.fd = ::open(impl.path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (impl.fd < 0)
+    throw_errno("create", impl.path);
+
+  struct stat info;
+  if (::fstat(impl.fd, &info) != 0)
+    throw_errno("stat", impl.path);
+
+  // Never shrink an existing segment, because readers might still have all of
+  // it mapped.
+  const auto existing_size = static_cast<std::size_t>(info.st_size);
+  impl.mapped_size = std::max(existing_size, PayloadOffset + capacity);
+  if (existing_size < impl.mapped_size)
+  {
+    if (::ftruncate(impl.fd, static_cast<off_t>(impl.mapped_size)) != 0)
+      throw_errno("resize", impl.path);
+  }
+
+  impl.data = ::mmap(
+    nullptr, impl.mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, impl.fd, 0);
+  if (impl.data == MAP_FAILED)
+  {
+    impl.data = nullptr;
+    throw_errno("map", impl.path);
+  }
+
+  impl.header = static_cast<SegmentHeader*>(impl.data);
+  impl.payload = static_cast<uint8_t*>(impl.data) + PayloadOffset;
+
+  auto& header = *impl.header;
+  if (header.magic != Magic)
+  {
+    header.sequence.store(0, std::memory_order_relaxed);
+    header.size.store(0, std::memory_order_relaxed);
+    header.capacity.store(
+      impl.mapped_size - PayloadOffset, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header.magic = Magic;
+    return;
+  }
+
+  header.capacity.store(
+    impl.mapped_size - PayloadOffset, std::memory_order_release);
+
+  // A previous publisher may have died while it was writing, so the snapshot
+  // that is in the segment can't be trusted.
+  if (header.sequence.load(std::memory_order_relaxed) % 2 == 1)
+  {
+    header.size.store(0, std::memory_order_relaxed);
+    header.sequence.fetch_add(1, std::memory_order_release);
+  }
+}
+
+//==============================================================================
+bool SharedMirrorPublisher::publish(
+  const rmf_traffic::schedule::Database& database)
+{
+  const auto encoded = encode_schedule_snapshot(
+    take_schedule_snapshot(database, {}, 0), _pimpl->compact);
+
+  auto& impl = *_pimpl;
+  if (encoded.size() > impl.mapped_size - PayloadOffset)
+    return false;
+
+  auto& header = *impl.header;
+  const uint64_t sequence = header.sequence.load(std::memory_order_relaxed);
+  header.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  std::memcpy(impl.payload, encoded.data(), encoded.size());
+  header.size.store(encoded.size(), std::memory_order_relaxed);
+
+  header.sequence.store(sequence + 2, std::memory_order_release);
+  return true;
+}
+
+//==============================================================================
+SharedMirrorPublisher& SharedMirrorPublisher::compact_resolution(
+  const std::optional<double> resolution)
+{
+  if (resolution.has_value() && *resolution > 0.0)
+    _pimpl->compact = CompactResolution{*resolution, *resolution};
+  else
+    _pimpl->compact = std::nullopt;
+
+  return *this;
+}
+
+//==============================================================================
+uint64_t SharedMirrorPublisher::stamp() const
+{
+  return _pimpl->header->sequence.load(std::memory_order_acquire) / 2;
+}
+
+//==============================================================================
+class SharedMirror::Implementation
+{
+public:
+
+  std::string path;
+  int fd = -1;
+
+  // The header gets its own mapping so that it stays in place while the
+  // payload is remapped after the publisher grows the segment.
+  SegmentHeader* header = nullptr;
+
+  mutable std::mutex mutex;
+  mutable void* data = nullptr;
+  mutable std::size_t mapped_size = 0;
+  mutable std::vector<uint8_t> buffer;
+  mutable uint64_t decoded_sequence = 0;
+  mutable std::shared_ptr<const rmf_traffic::schedule::Snapshot> snapshot;
+
+  Implementation() = default;
+  Implementation(const Implementation&) = delete;
+  Implementation& operator=(const Implementation&) = delete;
+
+  ~Implementation()
+  {
+    if (data)
+      ::munmap(data, mapped_size);
+
+    if (header)
+      ::munmap(header, PayloadOffset);
+
+    if (fd >= 0)
+      ::close(fd);
+  }
+
+  // Make sure that a payload of this size is inside of the mapping
+  const uint8_t* map_payload(const std::size_t size) const
+  {
+    const std::size_t required = PayloadOffset + size;
+    if (required > mapped_size)
+    {
+      struct stat info;
+      if (::fstat(fd, &info) != 0)
+        return nullptr;
+
+      const auto file_size = static_cast<std::size_t>(info.st_size);
+      if (file_size < required)
+        return nullptr;
+
+      void* const remapped =
+        ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (remapped == MAP_FAILED)
+        return nullptr;
+
+      if (data)
+        ::munmap(data, mapped_size);
+
+      data = remapped;
+      mapped_size = file_size;
+    }
+
+    return static_cast<const uint8_t*>(data) + PayloadOffset;
+  }
+
+  std::shared_ptr<const rmf_traffic::schedule::Snapshot> read() const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t attempt = 0; attempt < MaxReadAttempts; ++attempt)
+    {
+      const uint64_t begin = header->sequence.load(std::memory_order_acquire);
+      if (snapshot && begin == decoded_sequence)
+        return snapshot;
+
+      if (begin % 2 == 1)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      const std::size_t size = header->size.load(std::memory_order_relaxed);
+      if (size == 0)
+      {
+        // Nothing has been published yet
+        decoded_sequence = begin;
+        snapshot = rmf_traffic::schedule::Mirror().snapshot();
+        return snapshot;
+      }
+
+      const uint8_t* const payload = map_payload(size);
+      if (!payload)
+        break;
+
+      buffer.assign(payload, payload + size);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (header->sequence.load(std::memory_order_relaxed) != begin)
+        continue;
+
+      try
+      {
+        snapshot = make_snapshot(
+          decode_schedule_snapshot(buffer.data(), buffer.size(), path));
+        decoded_sequence = begin;
+        return snapshot;
+      }
+      catch (const ScheduleSnapshotError&)
+      {
+        break;
+      }
+    }
+
+    // Keep handing out the last snapshot that could be read
+    if (!snapshot)
+      snapshot = rmf_traffic::schedule::Mirror().snapshot();
+
+    return snapshot;
+  }
+};
+
+//==============================================================================
+std::shared_ptr<SharedMirror> SharedMirror::make(
+  const std::string& segment_name)
+{
+  std::shared_ptr<SharedMirror> mirror(new SharedMirror);
+  auto& impl = *mirror->_pimpl;
+  impl.path = segment_path(segment_name);
+  impl.fd = ::open(impl.path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (impl.fd < 0)
+    return nullptr;
+
+  struct stat info;
+  if (::fstat(impl.fd, &info) != 0
+    || static_cast<std::size_t>(info.st_size) < PayloadOffset)
+  {
+    return nullptr;
+  }
+
+  void* const header =
+    ::mmap(nullptr, PayloadOffset, PROT_READ, MAP_SHARED, impl.fd, 0);
+  if (header == MAP_FAILED)
+    return nullptr;
+
+  impl.header = static_cast<SegmentHeader*>(header);
+  if (impl.header->magic != Magic)
+    return nullptr;
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return mirror;
+}
+
+//==============================================================================
+uint64_t SharedMirror::stamp() const
+{
+  return _pimpl->header->sequence.load(std::memory_order_acquire) / 2;
+}
+
+//==============================================================================
+std::shared_ptr<const rmf_traffic::schedule::Snapshot>
+SharedMirror::snapshot() const
+{
+  return _pimpl->read();
+}
+
+//==============================================================================
+SharedMirror::SharedMirror()
+: _pimpl(rmf_utils::make_unique_impl<Implementation>())
+{
+  // Do nothing
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "TimedExecutor.hpp"
+
+#include <rclcpp/scope_exit.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+TimedExecutor::TimedExecutor(
+  std::shared_ptr<CallbackWatchdog> watchdog,
+  const std::size_t threads,
+  std::function<void()> on_thread_start,
+  const rclcpp::ExecutorOptions& options)
+: rclcpp::Executor(options),
+  _watchdog(std::move(watchdog)),
+  _threads(threads > 0 ? threads :
+    std::max<std::size_t>(std::thread::hardware_concurrency(), 1)),
+  _on_thread_start(std::move(on_thread_start))
+{
+  // Do nothing
+}
+
+//==============================================================================
+void TimedExecutor::spin()
+{
+  if (spinning.exchange(true))
+    throw std::runtime_error("[TimedExecutor::spin] Already spinning");
+
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
+
+  std::vector<std::thread> threads;
+  threads.reserve(_threads - 1);
+  for (std::size_t i = 1; i < _threads; ++i)
+    threads.emplace_back([this]() { _run(); });
+
+  _run();
+
+  for (auto& thread : threads)
+    thread.join();
+}
+
+//==============================================================================
+void TimedExecutor::_run()
+{
+  if (_on_thread_start)
+    _on_thread_start();
+
+  while (rclcpp::ok(context_) && spinning.load())
+  {
+    rclcpp::AnyExecutable executable;
+    {
+      std::lock_guard<std::mutex> lock(_wait_mutex);
+      if (!rclcpp::ok(context_) || !spinning.load())
+        return;
+
+      if (!get_next_executable(executable))
+        continue;
+
+      if (executable.timer)
+      {
+        std::lock_guard<std::mutex> timers_lock(_timers_mutex);
+        if (!_running_timers.insert(executable.timer).second)
+        {
+          // The timer is still running on another thread, so give its
+          // callback group back and skip it this time
+          if (executable.callback_group)
+            executable.callback_group->can_be_taken_from().store(true);
+
+          continue;
+        }
+      }
+    }
+
+    if (_watchdog)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      execute_any_executable(executable);
+      _watchdog->record(
+        CallbackWatchdog::describe(executable),
+        std::chrono::steady_clock::now() - start);
+    }
+    else
+    {
+      execute_any_executable(executable);
+    }
+
+    if (executable.timer)
+    {
+      std::lock_guard<std::mutex> timers_lock(_timers_mutex);
+      _running_timers.erase(executable.timer);
+    }
+
+    executable.callback_group.reset();
+  }
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
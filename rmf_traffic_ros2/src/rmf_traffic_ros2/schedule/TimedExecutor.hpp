@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__TIMEDEXECUTOR_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__TIMEDEXECUTOR_HPP
+
+#include <rmf_traffic_ros2/CallbackWatchdog.hpp>
+
+#include <rclcpp/executor.hpp>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A multi-threaded executor that records how long each callback ran for in
+/// a CallbackWatchdog and that lets each of its threads be set up before it
+/// runs any callback. It hands out work the same way as
+/// rclcpp::executors::MultiThreadedExecutor, which can do neither.
+class TimedExecutor : public rclcpp::Executor
+{
+public:
+
+  /// Constructor
+  ///
+  /// \param[in] watchdog
+  ///   Records the duration of every callback. If this is null, the callbacks
+  ///   are not timed.
+  ///
+  /// \param[in] threads
+  ///   The number of threads to spin on. Zero means one thread per hardware
+  ///   core.
+  ///
+  /// \param[in] on_thread_start
+  ///   If provided, each thread runs this before it runs any callback. This
+  ///   includes the thread that calls spin().
+  TimedExecutor(
+    std::shared_ptr<CallbackWatchdog> watchdog,
+    std::size_t threads,
+    std::function<void()> on_thread_start = nullptr,
+    const rclcpp::ExecutorOptions& options = rclcpp::ExecutorOptions());
+
+  void spin() override;
+
+private:
+
+  void _run();
+
+  std::shared_ptr<CallbackWatchdog> _watchdog;
+  std::size_t _threads;
+  std::function<void()> _on_thread_start;
+
+  std::mutex _wait_mutex;
+
+  // A timer of a reentrant callback group can be handed out again while it is
+  // still running, so the timers that are running are tracked here
+  std::mutex _timers_mutex;
+  std::set<rclcpp::TimerBase::SharedPtr> _running_timers;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__TIMEDEXECUTOR_HPP
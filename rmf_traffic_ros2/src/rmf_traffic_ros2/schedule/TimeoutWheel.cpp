@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "TimeoutWheel.hpp"
+
+#include <algorithm>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+TimeoutWheel::TimeoutWheel(
+  const rmf_traffic::Duration resolution,
+  const std::size_t slots_per_level,
+  const std::size_t levels)
+: _resolution(std::max(resolution, rmf_traffic::Duration(1))),
+  _slots_per_level(std::max<std::size_t>(slots_per_level, 2)),
+  _origin(rmf_traffic::Time())
+{
+  uint64_t span = 1;
+  for (std::size_t l = 0; l < std::max<std::size_t>(levels, 1); ++l)
+  {
+    _span.push_back(span);
+    _levels.emplace_back(_slots_per_level);
+    span *= _slots_per_level;
+  }
+}
+
+//==============================================================================
+void TimeoutWheel::schedule(
+  const rmf_traffic::Time now,
+  const rmf_traffic::Duration timeout,
+  Callback callback)
+{
+  // While the wheel is empty nobody is advancing it, so catch it up to now
+  // instead of ticking through all the time that passed.
+  if (_size == 0)
+    _tick = std::max(_tick, _ticks(now));
+
+  // Round up so that the callback never fires before its timeout. The slot
+  // of the current tick has already been fired, so the earliest a new entry
+  // can fire is the next tick.
+  const auto expiry = now + std::max(timeout, rmf_traffic::Duration(0));
+  const uint64_t deadline = std::max(
+    _ticks(expiry + _resolution - rmf_traffic::Duration(1)), _tick + 1);
+
+  _insert(Entry{deadline, std::move(callback)});
+  ++_size;
+}
+
+//==============================================================================
+auto TimeoutWheel::advance(const rmf_traffic::Time now)
+-> std::vector<Callback>
+{
+  std::vector<Callback> expired;
+  const uint64_t target = _ticks(now);
+  if (_size == 0)
+  {
+    _tick = std::max(_tick, target);
+    return expired;
+  }
+
+  while (_tick < target && _size > 0)
+  {
+    ++_tick;
+
+    // Bring down the entries of every coarser slot that begins on this tick,
+    // starting from the top so that entries can fall through several levels.
+    for (std::size_t l = _levels.size() - 1; l > 0; --l)
+    {
+      if (_tick % _span[l] != 0)
+        continue;
+
+      auto& slot = _levels[l][(_tick / _span[l]) % _slots_per_level];
+      Slot entries;
+      std::swap(entries, slot);
+      for (auto& entry : entries)
+        _insert(std::move(entry));
+    }
+
+    auto& slot = _levels[0][_tick % _slots_per_level];
+    for (auto& entry : slot)
+      expired.emplace_back(std::move(entry.callback));
+
+    _size -= slot.size();
+    slot.clear();
+  }
+
+  _tick = std::max(_tick, target);
+  return expired;
+}
+
+//==============================================================================
+rmf_traffic::Duration TimeoutWheel::resolution() const
+{
+  return _resolution;
+}
+
+//==============================================================================
+std::size_t TimeoutWheel::size() const
+{
+  return _size;
+}
+
+//==============================================================================
+bool TimeoutWheel::empty() const
+{
+  return _size == 0;
+}
+
+//==============================================================================
+uint64_t TimeoutWheel::_ticks(const rmf_traffic::Time time) const
+{
+  if (time <= _origin)
+    return 0;
+
+  return static_cast<uint64_t>((time - _origin) / _resolution);
+}
+
+//==============================================================================
+void TimeoutWheel::_insert(Entry entry)
+{
+  const uint64_t delta = entry.deadline > _tick ? entry.deadline - _tick : 0;
+
+  // Use the finest level whose rotation reaches the deadline
+  std::size_t level = 0;
+  while (level + 1 < _levels.size()
+    && delta >= _span[level] * _slots_per_level)
+  {
+    ++level;
+  }
+
+  // Entries beyond the reach of the top level wait in the last slot that it
+  // can reach, and are placed again when that slot comes around.
+  uint64_t placement = entry.deadline;
+  const uint64_t reach = _span[level] * _slots_per_level;
+  if (delta >= reach)
+    placement = _tick + reach - 1;
+
+  _levels[level][(placement / _span[level]) % _slots_per_level]
+  .emplace_back(std::move(entry));
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
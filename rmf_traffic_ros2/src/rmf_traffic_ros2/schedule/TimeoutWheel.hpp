@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__TIMEOUTWHEEL_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__TIMEOUTWHEEL_HPP
+
+#include <rmf_traffic/Time.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A hierarchical timing wheel that keeps track of many timeouts so they can
+/// all be driven by one periodic timer. Each level of the wheel has the same
+/// number of slots, and each slot of a level spans as many ticks as a whole
+/// rotation of the level beneath it. A timeout starts in the coarsest level
+/// that it fits in and moves down a level each time its slot comes around,
+/// so scheduling and firing each take constant time no matter how many
+/// timeouts are pending.
+///
+/// Timeouts fire on the first tick at or after their deadline, so they may
+/// fire up to one resolution late, but never early.
+///
+/// This class is not thread-safe.
+class TimeoutWheel
+{
+public:
+
+  using Callback = std::function<void()>;
+
+  /// Constructor
+  ///
+  /// \param[in] resolution
+  ///   The duration of one tick
+  ///
+  /// \param[in] slots_per_level
+  ///   The number of slots in each level of the wheel
+  ///
+  /// \param[in] levels
+  ///   The number of levels. Timeouts that are further away than a rotation
+  ///   of the top level wait in the top level until they fit.
+  TimeoutWheel(
+    rmf_traffic::Duration resolution = std::chrono::milliseconds(100),
+    std::size_t slots_per_level = 64,
+    std::size_t levels = 3);
+
+  /// Schedule a callback to be returned by advance() once the timeout has
+  /// passed.
+  ///
+  /// \param[in] now
+  ///   The current time
+  ///
+  /// \param[in] timeout
+  ///   How long after now the callback should be fired
+  ///
+  /// \param[in] callback
+  ///   The callback to fire
+  void schedule(
+    rmf_traffic::Time now,
+    rmf_traffic::Duration timeout,
+    Callback callback);
+
+  /// Move the wheel forward to the current time.
+  ///
+  /// \return the callbacks whose timeouts have passed, in the order of their
+  /// deadlines. The caller should trigger them.
+  std::vector<Callback> advance(rmf_traffic::Time now);
+
+  /// Get the duration of one tick
+  rmf_traffic::Duration resolution() const;
+
+  /// Get the number of timeouts that have not fired yet
+  std::size_t size() const;
+
+  /// True if no timeouts are waiting to fire
+  bool empty() const;
+
+private:
+
+  struct Entry
+  {
+    uint64_t deadline;
+    Callback callback;
+  };
+
+  using Slot = std::vector<Entry>;
+
+  uint64_t _ticks(rmf_traffic::Time time) const;
+
+  void _insert(Entry entry);
+
+  rmf_traffic::Duration _resolution;
+  std::size_t _slots_per_level;
+
+  // The number of ticks spanned by one slot of each level
+  std::vector<uint64_t> _span;
+
+  std::vector<std::vector<Slot>> _levels;
+  rmf_traffic::Time _origin;
+  uint64_t _tick = 0;
+  std::size_t _size = 0;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__TIMEOUTWHEEL_HPP
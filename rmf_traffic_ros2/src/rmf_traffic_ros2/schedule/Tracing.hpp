@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__TRACING_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__TRACING_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#ifdef RMF_TRAFFIC_ROS2_TRACING
+#include <lttng/tracef.h>
+#endif
+
+//==============================================================================
+// Tracepoints for the hot paths of the schedule node. They are emitted as
+// LTTng-UST tracef events, so they can be recorded alongside the ros2_tracing
+// events of rclcpp with
+//
+//   lttng enable-event --userspace 'lttng_ust_tracef:*'
+//
+// Every event message begins with "rmf_traffic_ros2:" followed by the name of
+// the tracepoint. Configure with -DRMF_TRAFFIC_ROS2_TRACING=ON to enable them.
+// Otherwise they compile to nothing. Even when they are compiled in, an event
+// costs one branch unless a tracing session has enabled it.
+#ifdef RMF_TRAFFIC_ROS2_TRACING
+#define RMF_TRAFFIC_ROS2_TRACE(name, fmt, ...) \
+  tracef("rmf_traffic_ros2:" name " " fmt, __VA_ARGS__)
+#else
+#define RMF_TRAFFIC_ROS2_TRACE(name, fmt, ...) \
+  do {} while (false)
+#endif
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+#ifdef RMF_TRAFFIC_ROS2_TRACING
+//==============================================================================
+/// Emits a tracepoint when it is created and another with the elapsed time
+/// when it is destroyed.
+class TraceScope
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit TraceScope(const char* name)
+  : _name(name),
+    _start(Clock::now())
+  {
+    RMF_TRAFFIC_ROS2_TRACE("scope_enter", "name=%s", _name);
+  }
+
+  ~TraceScope()
+  {
+    RMF_TRAFFIC_ROS2_TRACE(
+      "scope_exit", "name=%s duration_ns=%ld", _name, elapsed_ns());
+  }
+
+  int64_t elapsed_ns() const
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now() - _start).count();
+  }
+
+private:
+  const char* _name;
+  Clock::time_point _start;
+};
+
+//==============================================================================
+/// A std::unique_lock that reports how long it waited to acquire the mutex
+/// and how long it held it. Only unlocks made through this class end a hold,
+/// so a condition variable wait counts as part of the hold time.
+class TracedLock : public std::unique_lock<std::mutex>
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  TracedLock(std::mutex& mutex, const char* name)
+  : std::unique_lock<std::mutex>(mutex, std::defer_lock),
+    _name(name)
+  {
+    lock();
+  }
+
+  void lock()
+  {
+    const auto start = Clock::now();
+    std::unique_lock<std::mutex>::lock();
+    _acquired = Clock::now();
+    RMF_TRAFFIC_ROS2_TRACE(
+      "lock_acquired", "mutex=%s wait_ns=%ld",
+      _name, count_ns(_acquired - start));
+  }
+
+  void unlock()
+  {
+    std::unique_lock<std::mutex>::unlock();
+    RMF_TRAFFIC_ROS2_TRACE(
+      "lock_released", "mutex=%s hold_ns=%ld",
+      _name, count_ns(Clock::now() - _acquired));
+  }
+
+  ~TracedLock()
+  {
+    if (owns_lock())
+      unlock();
+  }
+
+private:
+  static int64_t count_ns(const Clock::duration d)
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+  }
+
+  const char* _name;
+  Clock::time_point _acquired;
+};
+#else
+//==============================================================================
+class TraceScope
+{
+public:
+  explicit TraceScope(const char*) {}
+};
+
+//==============================================================================
+class TracedLock : public std::unique_lock<std::mutex>
+{
+public:
+  TracedLock(std::mutex& mutex, const char*)
+  : std::unique_lock<std::mutex>(mutex)
+  {
+    // Do nothing
+  }
+};
+#endif
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__TRACING_HPP
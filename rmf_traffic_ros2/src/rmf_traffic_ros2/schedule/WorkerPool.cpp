@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "WorkerPool.hpp"
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+WorkerPool::WorkerPool(const std::size_t num_threads, Task on_thread_start)
+{
+  _threads.reserve(num_threads);
+  for (std::size_t i = 0; i < num_threads; ++i)
+  {
+    _threads.emplace_back(
+      [this, on_thread_start]()
+      {
+        if (on_thread_start)
+          on_thread_start();
+
+        this->_work();
+      });
+  }
+}
+
+//==============================================================================
+void WorkerPool::run(std::vector<Task> tasks)
+{
+  if (tasks.empty())
+    return;
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _tasks = std::move(tasks);
+  _next_task = 0;
+  _finished_tasks = 0;
+  _error = nullptr;
+  _work_cv.notify_all();
+
+  // Pitch in on the batch instead of idling while the helpers work
+  while (_next(lock))
+  {
+    // Keep going
+  }
+
+  _done_cv.wait(lock, [&]() { return _finished_tasks == _tasks.size(); });
+  _tasks.clear();
+
+  if (_error)
+    std::rethrow_exception(_error);
+}
+
+//==============================================================================
+std::size_t WorkerPool::size() const
+{
+  return _threads.size();
+}
+
+//==============================================================================
+WorkerPool::~WorkerPool()
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _quit = true;
+  }
+  _work_cv.notify_all();
+
+  for (auto& t : _threads)
+  {
+    if (t.joinable())
+      t.join();
+  }
+}
+
+//==============================================================================
+void WorkerPool::_work()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (!_quit)
+  {
+    _work_cv.wait(lock, [&]() { return _quit || _next_task < _tasks.size(); });
+
+    while (!_quit && _next(lock))
+    {
+      // Keep going
+    }
+  }
+}
+
+//==============================================================================
+bool WorkerPool::_next(std::unique_lock<std::mutex>& lock)
+{
+  if (_next_task >= _tasks.size())
+    return false;
+
+  auto& task = _tasks[_next_task++];
+  lock.unlock();
+  std::exception_ptr error;
+  try
+  {
+    task();
+  }
+  catch (...)
+  {
+    error = std::current_exception();
+  }
+  lock.lock();
+
+  if (error && !_error)
+    _error = error;
+
+  if (++_finished_tasks == _tasks.size())
+    _done_cv.notify_all();
+
+  return true;
+}
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
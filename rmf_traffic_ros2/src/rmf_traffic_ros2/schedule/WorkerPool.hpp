@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SRC__RMF_TRAFFIC_ROS2__SCHEDULE__WORKERPOOL_HPP
+#define SRC__RMF_TRAFFIC_ROS2__SCHEDULE__WORKERPOOL_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rmf_traffic_ros2 {
+namespace schedule {
+
+//==============================================================================
+/// A fixed set of worker threads for fanning out batches of independent
+/// tasks. The thread that calls run() also works on the batch, so a pool of
+/// N threads keeps N+1 cores busy while a batch is running.
+class WorkerPool
+{
+public:
+
+  using Task = std::function<void()>;
+
+  /// Constructor
+  ///
+  /// \param[in] num_threads
+  ///   The number of helper threads to spawn. If this is zero, run() will
+  ///   perform every task on the calling thread.
+  ///
+  /// \param[in] on_thread_start
+  ///   If provided, each helper thread runs this before it takes any task,
+  ///   e.g. to apply ThreadSettings.
+  WorkerPool(std::size_t num_threads, Task on_thread_start = nullptr);
+
+  /// Run every task in the batch and return once they have all finished. If
+  /// any task throws an exception, the first exception will be rethrown here
+  /// after the rest of the batch has finished.
+  ///
+  /// Only one batch may run at a time.
+  void run(std::vector<Task> tasks);
+
+  /// The number of helper threads in the pool
+  std::size_t size() const;
+
+  ~WorkerPool();
+
+private:
+
+  void _work();
+
+  bool _next(std::unique_lock<std::mutex>& lock);
+
+  std::vector<std::thread> _threads;
+  std::mutex _mutex;
+  std::condition_variable _work_cv;
+  std::condition_variable _done_cv;
+  std::vector<Task> _tasks;
+  std::size_t _next_task = 0;
+  std::size_t _finished_tasks = 0;
+  std::exception_ptr _error;
+  bool _quit = false;
+};
+
+} // namespace schedule
+} // namespace rmf_traffic_ros2
+
+#endif // SRC__RMF_TRAFFIC_ROS2__SCHEDULE__WORKERPOOL_HPP
@@ -15,9 +15,20 @@
  *
 */
 
+#include "BulkRegistration.hpp"
+#include "DelayCoalescer.hpp"
+#include "InconsistencyFilter.hpp"
+#include "ItineraryBatch.hpp"
+#include "LoanedPublish.hpp"
+#include "ReconnectBackoff.hpp"
+#include "RectificationHistory.hpp"
+#include "ScheduleShards.hpp"
+
 #include <rmf_traffic_ros2/schedule/Writer.hpp>
 #include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
 #include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/Timer.hpp>
+#include <rmf_traffic_ros2/Tracer.hpp>
 
 #include <rmf_traffic_msgs/msg/itinerary_set.hpp>
 #include <rmf_traffic_msgs/msg/itinerary_extend.hpp>
@@ -32,6 +43,15 @@
 #include <rmf_traffic_msgs/srv/register_participant.hpp>
 #include <rmf_traffic_msgs/srv/unregister_participant.hpp>
 
+#include <std_msgs/msg/u_int8_multi_array.hpp>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <unordered_map>
+
 namespace rmf_traffic_ros2 {
 
 //==============================================================================
@@ -47,7 +67,8 @@ namespace schedule {
 namespace {
 //==============================================================================
 class RectifierFactory
-  : public rmf_traffic::schedule::RectificationRequesterFactory
+  : public rmf_traffic::schedule::RectificationRequesterFactory,
+  public std::enable_shared_from_this<RectifierFactory>
 {
 public:
 
@@ -60,8 +81,15 @@ public:
 
     rmf_traffic::schedule::Rectifier rectifier;
     std::shared_ptr<RectifierStub> stub;
+    rmf_traffic::schedule::ParticipantId participant_id;
+    std::weak_ptr<RectifierFactory> factory;
+
+    Requester(
+      rmf_traffic::schedule::Rectifier rectifier_,
+      rmf_traffic::schedule::ParticipantId participant_id_,
+      std::weak_ptr<RectifierFactory> factory_);
 
-    Requester(rmf_traffic::schedule::Rectifier rectifier_);
+    ~Requester();
 
   };
 
@@ -75,12 +103,39 @@ public:
     std::weak_ptr<RectifierStub>
   >;
 
+  // Indexes the requesters of this process by the participant that they
+  // rectify. This is modified by the threads that make and drop participants
+  // as well as the executor, so it is guarded by stub_mutex.
   StubMap stub_map;
+  std::mutex stub_mutex;
 
   using InconsistencyMsg = rmf_traffic_msgs::msg::ScheduleInconsistency;
-  rclcpp::Subscription<InconsistencyMsg>::SharedPtr inconsistency_sub;
-
-  RectifierFactory(rclcpp::Node& node)
+  using InconsistencySub = rclcpp::Subscription<InconsistencyMsg>::SharedPtr;
+  InconsistencySub inconsistency_sub;
+
+  // Every schedule shard keeps track of its own inconsistencies. A
+  // retransmission goes out to all the shards, and the ones that already have
+  // those changes will ignore them.
+  std::vector<InconsistencySub> shard_inconsistency_subs;
+
+  // The inconsistencies of every participant on the site go out on the same
+  // topic, so the subscriptions ask the middleware to only deliver the ones
+  // for the participants of this process. This is turned off if the
+  // middleware does not support content filtering, and then the messages for
+  // other participants are discarded by check_inconsistencies().
+  bool filter_inconsistencies = true;
+  std::optional<std::string> current_filter;
+
+  // When the rectification_history_size parameter is positive, the most
+  // recent messages of each participant are kept here so that inconsistencies
+  // can be answered by resending them. Without this, the participant would
+  // replay every change since its last set, which can be thousands of delays
+  // after a long outage.
+  std::optional<RectificationHistory> history;
+  std::function<void(const ItineraryMsg&)> resend;
+  std::mutex history_mutex;
+
+  RectifierFactory(rclcpp::Node& node, const ScheduleShards& shards)
   {
     inconsistency_sub = node.create_subscription<InconsistencyMsg>(
       ScheduleInconsistencyTopicName,
@@ -89,21 +144,107 @@ public:
       {
         check_inconsistencies(*msg);
       });
+
+    for (std::size_t i = 1; i < shards.size(); ++i)
+    {
+      shard_inconsistency_subs.push_back(
+        node.create_subscription<InconsistencyMsg>(
+          shard_topic_name(shards.name(i), ScheduleInconsistencyTopicName),
+          rclcpp::SystemDefaultsQoS().reliable(),
+          [&](const InconsistencyMsg::UniquePtr msg)
+          {
+            check_inconsistencies(*msg);
+          }));
+    }
   }
 
   std::unique_ptr<rmf_traffic::schedule::RectificationRequester> make(
     rmf_traffic::schedule::Rectifier rectifier,
     rmf_traffic::schedule::ParticipantId participant_id) final
   {
-    auto requester = std::make_unique<Requester>(std::move(rectifier));
+    auto requester = std::make_unique<Requester>(
+      std::move(rectifier), participant_id, weak_from_this());
 
+    std::lock_guard<std::mutex> lock(stub_mutex);
     // It's okay to just override any entry that might have been in here before,
     // because the Database should never double-assign a ParticipantId
     stub_map[participant_id] = requester->stub;
+    update_filter();
 
     return requester;
   }
 
+  void forget(
+    rmf_traffic::schedule::ParticipantId participant_id,
+    const std::shared_ptr<RectifierStub>& stub)
+  {
+    std::lock_guard<std::mutex> lock(stub_mutex);
+    const auto it = stub_map.find(participant_id);
+    if (it == stub_map.end())
+      return;
+
+    // A newer requester may have taken over this participant ID
+    const auto current = it->second.lock();
+    if (current && current != stub)
+      return;
+
+    stub_map.erase(it);
+
+    {
+      std::lock_guard<std::mutex> history_lock(history_mutex);
+      if (history)
+        history->forget(participant_id);
+    }
+
+    // When the last participant is gone we leave the old filter in place,
+    // because no filter at all would let every inconsistency through.
+    update_filter();
+  }
+
+  /// Must be called while stub_mutex is locked
+  void update_filter()
+  {
+    if (!filter_inconsistencies)
+      return;
+
+    std::vector<rmf_traffic::schedule::ParticipantId> participants;
+    participants.reserve(stub_map.size());
+    for (const auto& [participant, _] : stub_map)
+      participants.push_back(participant);
+
+    auto filter = inconsistency_filter(std::move(participants));
+    if (!filter.has_value())
+    {
+      if (stub_map.empty() || !current_filter.has_value())
+        return;
+
+      // There are too many participants to name, so take the filter off
+      filter = std::string();
+    }
+
+    if (filter == current_filter)
+      return;
+
+    try
+    {
+      inconsistency_sub->set_content_filter(*filter);
+      for (const auto& sub : shard_inconsistency_subs)
+        sub->set_content_filter(*filter);
+    }
+    catch (const std::exception&)
+    {
+      // The middleware does not support content filtered topics, so this
+      // process will check each inconsistency against stub_map instead.
+      filter_inconsistencies = false;
+      return;
+    }
+
+    if (filter->empty())
+      current_filter = std::nullopt;
+    else
+      current_filter = std::move(*filter);
+  }
+
   void check_inconsistencies(const InconsistencyMsg& msg)
   {
     if (msg.ranges.empty())
@@ -113,18 +254,25 @@ public:
       return;
     }
 
-    const auto it = stub_map.find(msg.participant);
-    if (it == stub_map.end())
-      return;
-
-    const auto& stub = it->second.lock();
-    if (!stub)
+    std::shared_ptr<RectifierStub> stub;
     {
-      // This participant has expired, so we should remove it from the map
-      stub_map.erase(it);
-      return;
+      std::lock_guard<std::mutex> lock(stub_mutex);
+      const auto it = stub_map.find(msg.participant);
+      if (it == stub_map.end())
+        return;
+
+      stub = it->second.lock();
+      if (!stub)
+      {
+        // This participant has expired, so we should remove it from the map
+        stub_map.erase(it);
+        return;
+      }
     }
 
+    if (answer_from_history(msg))
+      return;
+
     using Range = rmf_traffic::schedule::Rectifier::Range;
     std::vector<Range> ranges;
     ranges.reserve(msg.ranges.size());
@@ -133,17 +281,59 @@ public:
 
     stub->requester.rectifier.retransmit(ranges, msg.last_known_version);
   }
+
+  void record(ItineraryMsg msg)
+  {
+    std::lock_guard<std::mutex> lock(history_mutex);
+    if (history)
+      history->record(std::move(msg));
+  }
+
+  /// Resend the kept messages that the schedule is missing. Returns false if
+  /// the participant needs to retransmit them itself.
+  bool answer_from_history(const InconsistencyMsg& msg)
+  {
+    std::optional<std::vector<ItineraryMsg>> msgs;
+    std::function<void(const ItineraryMsg&)> send;
+    {
+      std::lock_guard<std::mutex> lock(history_mutex);
+      if (!history || !resend)
+        return false;
+
+      msgs = history->retransmission(msg);
+      send = resend;
+    }
+
+    if (!msgs.has_value())
+      return false;
+
+    for (const auto& m : *msgs)
+      send(m);
+
+    return true;
+  }
 };
 
 //==============================================================================
 RectifierFactory::Requester::Requester(
-  rmf_traffic::schedule::Rectifier rectifier_)
+  rmf_traffic::schedule::Rectifier rectifier_,
+  rmf_traffic::schedule::ParticipantId participant_id_,
+  std::weak_ptr<RectifierFactory> factory_)
 : rectifier(std::move(rectifier_)),
-  stub(std::make_shared<RectifierStub>(RectifierStub{*this}))
+  stub(std::make_shared<RectifierStub>(RectifierStub{*this})),
+  participant_id(participant_id_),
+  factory(std::move(factory_))
 {
   // Do nothing
 }
 
+//==============================================================================
+RectifierFactory::Requester::~Requester()
+{
+  if (const auto f = factory.lock())
+    f->forget(participant_id, stub);
+}
+
 } // anonymous namespace
 
 //==============================================================================
@@ -170,6 +360,43 @@ public:
     rclcpp::Publisher<Erase>::SharedPtr erase_pub;
     rclcpp::Publisher<Clear>::SharedPtr clear_pub;
 
+    // When the schedule_shards parameter is set, each change is split by map
+    // across the schedule shards. Shard 0 uses the publishers above.
+    struct ShardPublishers
+    {
+      rclcpp::Publisher<Set>::SharedPtr set;
+      rclcpp::Publisher<Extend>::SharedPtr extend;
+      rclcpp::Publisher<Delay>::SharedPtr delay;
+      rclcpp::Publisher<Erase>::SharedPtr erase;
+      rclcpp::Publisher<Clear>::SharedPtr clear;
+    };
+
+    std::optional<ItineraryRouter> router;
+    std::vector<ShardPublishers> shard_pubs;
+    std::mutex router_mutex;
+
+    // Sets and extends are converted into these messages so that their routes
+    // can reuse the memory of the earlier messages.
+    std::mutex buffer_mutex;
+    Set set_buffer;
+    Extend extend_buffer;
+
+    // When the itinerary_batch_period parameter is positive, the itinerary
+    // messages of all the participants of this writer are held back and sent
+    // together as one batch per period.
+    using Batch = std_msgs::msg::UInt8MultiArray;
+    rclcpp::Publisher<Batch>::SharedPtr batch_pub;
+    rclcpp::TimerBase::SharedPtr batch_timer;
+    std::mutex batch_mutex;
+    std::vector<ItineraryMsg> pending_msgs;
+
+    // When the itinerary_delay_coalesce_period parameter is positive, delays
+    // are held back for up to that long so that consecutive delays of the same
+    // participant can go out as one message.
+    std::optional<DelayCoalescer> delay_coalescer;
+    rclcpp::TimerBase::SharedPtr delay_timer;
+    std::mutex delay_mutex;
+
     rclcpp::Context::SharedPtr context;
 
     using Register = rmf_traffic_msgs::srv::RegisterParticipant;
@@ -178,12 +405,29 @@ public:
     rclcpp::Client<Register>::SharedPtr register_client;
     rclcpp::Client<Unregister>::SharedPtr unregister_client;
 
+    // Bulk registration sends the descriptions of many participants in one
+    // request. The registrations that come back are held here until
+    // register_participant() is called for each of those participants.
+    rclcpp::Publisher<Batch>::SharedPtr bulk_request_pub;
+    rclcpp::Subscription<Batch>::SharedPtr bulk_response_sub;
+    std::mutex bulk_mutex;
+    uint64_t next_bulk_request_id;
+    std::unordered_map<uint64_t, std::promise<BulkRegistrationResponse>>
+    bulk_waiters;
+    using ParticipantKey = std::pair<std::string, std::string>;
+    std::map<ParticipantKey, Registration> prefetched_registrations;
+
     using FailOverEvent = rmf_traffic_msgs::msg::FailOverEvent;
     using FailOverEventSub = rclcpp::Subscription<FailOverEvent>::SharedPtr;
     FailOverEventSub fail_over_event_sub;
 
-    Transport(rclcpp::Node& node)
-    : rectifier_factory(std::make_shared<RectifierFactory>(node))
+    // Every writer hears about a fail over at the same moment, so each one
+    // waits for a random delay before it reconnects to the new schedule node
+    std::optional<ReconnectBackoff> reconnect_backoff;
+    rclcpp::TimerBase::SharedPtr reconnect_timer;
+
+    Transport(rclcpp::Node& node, ScheduleShards shards)
+    : rectifier_factory(std::make_shared<RectifierFactory>(node, shards))
     {
       const auto itinerary_qos =
         rclcpp::SystemDefaultsQoS()
@@ -210,6 +454,109 @@ public:
         ItineraryClearTopicName,
         itinerary_qos);
 
+      if (!node.has_parameter("itinerary_batch_period"))
+        node.declare_parameter<int>("itinerary_batch_period", 0);
+
+      if (!node.has_parameter("itinerary_delay_coalesce_period"))
+        node.declare_parameter<int>("itinerary_delay_coalesce_period", 0);
+
+      if (!node.has_parameter("rectification_history_size"))
+        node.declare_parameter<int>("rectification_history_size", 0);
+
+      auto batch_period = std::chrono::milliseconds(
+        node.get_parameter("itinerary_batch_period").as_int());
+      auto coalesce_period = std::chrono::milliseconds(
+        node.get_parameter("itinerary_delay_coalesce_period").as_int());
+      auto history_size =
+        node.get_parameter("rectification_history_size").as_int();
+
+      if (shards.size() > 1)
+      {
+        if (batch_period.count() > 0 || coalesce_period.count() > 0)
+        {
+          RCLCPP_WARN(
+            node.get_logger(),
+            "[rmf_traffic_ros2::schedule::Writer] Itinerary batching and "
+            "delay coalescing are not supported while the schedule is "
+            "sharded, so they will be turned off");
+          batch_period = std::chrono::milliseconds(0);
+          coalesce_period = std::chrono::milliseconds(0);
+        }
+
+        // Resending old messages through the router would disturb how it has
+        // split the current itineraries across the shards.
+        if (history_size > 0)
+        {
+          RCLCPP_WARN(
+            node.get_logger(),
+            "[rmf_traffic_ros2::schedule::Writer] The rectification history "
+            "is not supported while the schedule is sharded, so it will be "
+            "turned off");
+          history_size = 0;
+        }
+
+        shard_pubs.push_back(
+          ShardPublishers{
+            set_pub, extend_pub, delay_pub, erase_pub, clear_pub});
+
+        for (std::size_t i = 1; i < shards.size(); ++i)
+        {
+          const auto& ns = shards.name(i);
+          shard_pubs.push_back(
+            ShardPublishers{
+              node.create_publisher<Set>(
+                shard_topic_name(ns, ItinerarySetTopicName), itinerary_qos),
+              node.create_publisher<Extend>(
+                shard_topic_name(ns, ItineraryExtendTopicName), itinerary_qos),
+              node.create_publisher<Delay>(
+                shard_topic_name(ns, ItineraryDelayTopicName), itinerary_qos),
+              node.create_publisher<Erase>(
+                shard_topic_name(ns, ItineraryEraseTopicName), itinerary_qos),
+              node.create_publisher<Clear>(
+                shard_topic_name(ns, ItineraryClearTopicName), itinerary_qos)
+            });
+        }
+
+        router = ItineraryRouter(std::move(shards));
+      }
+
+      // Coalesced delays can only be sent through the batch topic
+      if (batch_period.count() > 0 || coalesce_period.count() > 0)
+      {
+        batch_pub = node.create_publisher<Batch>(
+          ItineraryBatchTopicName,
+          itinerary_qos);
+      }
+
+      if (history_size > 0)
+      {
+        rectifier_factory->history.emplace(
+          static_cast<std::size_t>(history_size));
+      }
+
+      if (coalesce_period.count() > 0)
+      {
+        delay_coalescer = DelayCoalescer();
+        delay_timer = rmf_traffic_ros2::create_timer(
+          node,
+          coalesce_period,
+          [this]()
+          {
+            this->flush_delays();
+          });
+      }
+
+      if (batch_period.count() > 0)
+      {
+        batch_timer = rmf_traffic_ros2::create_timer(
+          node,
+          batch_period,
+          [this]()
+          {
+            this->flush_batch();
+          });
+      }
+
       context = node.get_node_options().context();
 
       register_client =
@@ -218,12 +565,42 @@ public:
       unregister_client =
         node.create_client<Unregister>(UnregisterParticipantSrvName);
 
+      // Responses from the schedule node are seen by every writer, so each
+      // writer starts its request IDs somewhere random to tell its own apart.
+      next_bulk_request_id = std::random_device()();
+      next_bulk_request_id = (next_bulk_request_id << 32)
+        ^ std::random_device()();
+
+      const auto bulk_qos =
+        rclcpp::SystemDefaultsQoS().reliable().keep_last(10);
+
+      bulk_request_pub = node.create_publisher<Batch>(
+        BulkRegistrationRequestTopicName, bulk_qos);
+
+      bulk_response_sub = node.create_subscription<Batch>(
+        BulkRegistrationResponseTopicName,
+        bulk_qos,
+        [this](const Batch::UniquePtr msg)
+        {
+          this->receive_bulk_registration(*msg);
+        });
+
+      const auto jitter = get_fail_over_jitter(node);
+      reconnect_backoff.emplace(jitter, jitter);
       fail_over_event_sub = node.create_subscription<FailOverEvent>(
         rmf_traffic_ros2::FailOverEventTopicName,
         rclcpp::SystemDefaultsQoS(),
         [&]([[maybe_unused]] const FailOverEvent::SharedPtr msg)
         {
-          reconnect_services(node);
+          reconnect_timer = rmf_traffic_ros2::create_timer(
+            node,
+            reconnect_backoff->next(),
+            [this, &node]()
+            {
+              // This is a one-shot timer
+              reconnect_timer->cancel();
+              reconnect_services(node);
+            });
         });
     }
 
@@ -232,12 +609,17 @@ public:
       const Input& itinerary,
       const rmf_traffic::schedule::ItineraryVersion version) final
     {
-      Set msg;
-      msg.participant = participant;
-      msg.itinerary = convert(itinerary);
-      msg.itinerary_version = version;
+      const auto span = trace("writer.set", participant, version);
+      std::lock_guard<std::mutex> lock(buffer_mutex);
+      set_buffer.participant = participant;
+      convert(itinerary, set_buffer.itinerary);
+      set_buffer.itinerary_version = version;
 
-      set_pub->publish(std::move(msg));
+      if (router)
+        return set_shards(set_buffer);
+
+      rectifier_factory->record(set_buffer);
+      send(set_buffer, set_pub);
     }
 
     void extend(
@@ -245,12 +627,17 @@ public:
       const Input& routes,
       const rmf_traffic::schedule::ItineraryVersion version) final
     {
-      Extend msg;
-      msg.participant = participant;
-      msg.routes = convert(routes);
-      msg.itinerary_version = version;
+      const auto span = trace("writer.extend", participant, version);
+      std::lock_guard<std::mutex> lock(buffer_mutex);
+      extend_buffer.participant = participant;
+      convert(routes, extend_buffer.routes);
+      extend_buffer.itinerary_version = version;
+
+      if (router)
+        return send_to_shards(extend_buffer, &ShardPublishers::extend);
 
-      extend_pub->publish(std::move(msg));
+      rectifier_factory->record(extend_buffer);
+      send(extend_buffer, extend_pub);
     }
 
     void delay(
@@ -258,12 +645,22 @@ public:
       const rmf_traffic::Duration duration,
       const rmf_traffic::schedule::ItineraryVersion version) final
     {
+      const auto span = trace("writer.delay", participant, version);
       Delay msg;
       msg.participant = participant;
       msg.delay = duration.count();
       msg.itinerary_version = version;
 
-      delay_pub->publish(std::move(msg));
+      if (router)
+        return broadcast_to_shards(msg, &ShardPublishers::delay);
+
+      rectifier_factory->record(msg);
+      if (!delay_coalescer)
+        return forward(msg, delay_pub);
+
+      std::lock_guard<std::mutex> lock(delay_mutex);
+      if (auto previous = delay_coalescer->add(msg))
+        forward_delay(std::move(*previous));
     }
 
     void erase(
@@ -271,23 +668,196 @@ public:
       const std::vector<rmf_traffic::RouteId>& routes,
       const rmf_traffic::schedule::ItineraryVersion version) final
     {
+      const auto span = trace("writer.erase", participant, version);
       Erase msg;
       msg.participant = participant;
       msg.routes = routes;
       msg.itinerary_version = version;
 
-      erase_pub->publish(std::move(msg));
+      if (router)
+        return send_to_shards(msg, &ShardPublishers::erase);
+
+      rectifier_factory->record(msg);
+      send(msg, erase_pub);
     }
 
     void erase(
       const rmf_traffic::schedule::ParticipantId participant,
       const rmf_traffic::schedule::ItineraryVersion version) final
     {
+      const auto span = trace("writer.clear", participant, version);
       Clear msg;
       msg.participant = participant;
       msg.itinerary_version = version;
 
-      clear_pub->publish(std::move(msg));
+      if (router)
+      {
+        {
+          std::lock_guard<std::mutex> lock(router_mutex);
+          router->forget(participant);
+        }
+
+        return broadcast_to_shards(msg, &ShardPublishers::clear);
+      }
+
+      rectifier_factory->record(msg);
+      send(msg, clear_pub);
+    }
+
+    /// A span of the itinerary version that is being sent, if the process
+    /// is being traced
+    static Tracer::Span trace(
+      const char* name,
+      const rmf_traffic::schedule::ParticipantId participant,
+      const rmf_traffic::schedule::ItineraryVersion version)
+    {
+      if (!tracing::tracer())
+        return Tracer::Span();
+
+      return tracing::span(
+        name, tracing::itinerary(participant, version),
+        {{"rmf.participant", std::to_string(participant)}});
+    }
+
+    void set_shards(const Set& msg)
+    {
+      std::vector<Set> msgs;
+      {
+        std::lock_guard<std::mutex> lock(router_mutex);
+        msgs = router->split(msg);
+      }
+
+      for (std::size_t i = 0; i < msgs.size(); ++i)
+      {
+        if (!msgs[i].itinerary.empty())
+        {
+          forward(msgs[i], shard_pubs[i].set);
+          continue;
+        }
+
+        // The schedule does not accept empty sets, so a shard that has none
+        // of the routes gets its part of the itinerary cleared instead.
+        Clear clear;
+        clear.participant = msg.participant;
+        clear.itinerary_version = msg.itinerary_version;
+        forward(clear, shard_pubs[i].clear);
+      }
+    }
+
+    template<typename Message, typename Publisher>
+    void send_to_shards(const Message& msg, Publisher ShardPublishers::* pub)
+    {
+      std::vector<Message> msgs;
+      {
+        std::lock_guard<std::mutex> lock(router_mutex);
+        msgs = router->split(msg);
+      }
+
+      for (std::size_t i = 0; i < msgs.size(); ++i)
+        forward(msgs[i], shard_pubs[i].*pub);
+    }
+
+    template<typename Message, typename Publisher>
+    void broadcast_to_shards(
+      const Message& msg,
+      Publisher ShardPublishers::* pub)
+    {
+      for (const auto& shard : shard_pubs)
+        forward(msg, shard.*pub);
+    }
+
+    template<typename Message>
+    void send(
+      const Message& msg,
+      const typename rclcpp::Publisher<Message>::SharedPtr& publisher)
+    {
+      if (!delay_coalescer)
+        return forward(msg, publisher);
+
+      // Any delay that is being held for this participant has to go out ahead
+      // of this change. The lock stays held until this change is forwarded so
+      // that another thread cannot slip a delay in between.
+      std::lock_guard<std::mutex> lock(delay_mutex);
+      if (auto held = delay_coalescer->take(msg.participant))
+        forward_delay(std::move(*held));
+
+      forward(msg, publisher);
+    }
+
+    template<typename Message>
+    void forward(
+      const Message& msg,
+      const typename rclcpp::Publisher<Message>::SharedPtr& publisher)
+    {
+      if (!batch_timer)
+      {
+        publish_loaned(*publisher, msg);
+        return;
+      }
+
+      std::lock_guard<std::mutex> lock(batch_mutex);
+      pending_msgs.emplace_back(msg);
+    }
+
+    void forward_delay(ItineraryMsg msg)
+    {
+      if (const auto* delay = std::get_if<Delay>(&msg))
+        return forward(*delay, delay_pub);
+
+      if (batch_timer)
+      {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        pending_msgs.emplace_back(std::move(msg));
+        return;
+      }
+
+      Batch batch;
+      batch.data = encode_itinerary_batch({std::move(msg)});
+      batch_pub->publish(std::move(batch));
+    }
+
+    /// Send a message from the rectification history again
+    void resend(const ItineraryMsg& msg)
+    {
+      if (const auto* set = std::get_if<Set>(&msg))
+        return send(*set, set_pub);
+
+      if (const auto* extend = std::get_if<Extend>(&msg))
+        return send(*extend, extend_pub);
+
+      if (const auto* delay = std::get_if<Delay>(&msg))
+        return send(*delay, delay_pub);
+
+      if (const auto* erase = std::get_if<Erase>(&msg))
+        return send(*erase, erase_pub);
+
+      if (const auto* clear = std::get_if<Clear>(&msg))
+        return send(*clear, clear_pub);
+
+      forward_delay(msg);
+    }
+
+    void flush_delays()
+    {
+      std::lock_guard<std::mutex> lock(delay_mutex);
+      for (auto& msg : delay_coalescer->take_all())
+        forward_delay(std::move(msg));
+    }
+
+    void flush_batch()
+    {
+      std::vector<ItineraryMsg> msgs;
+      {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        if (pending_msgs.empty())
+          return;
+
+        msgs.swap(pending_msgs);
+      }
+
+      Batch batch;
+      batch.data = encode_itinerary_batch(msgs);
+      batch_pub->publish(std::move(batch));
     }
 
     Registration register_participant(
@@ -295,6 +865,18 @@ public:
     {
       using namespace std::chrono_literals;
 
+      {
+        std::lock_guard<std::mutex> lock(bulk_mutex);
+        const auto it = prefetched_registrations.find(
+          {participant_info.owner(), participant_info.name()});
+        if (it != prefetched_registrations.end())
+        {
+          const auto registration = it->second;
+          prefetched_registrations.erase(it);
+          return registration;
+        }
+      }
+
       auto request = std::make_shared<Register::Request>();
       request->description = convert(participant_info);
 
@@ -324,6 +906,90 @@ public:
       return convert(*response);
     }
 
+    /// Register all of these participants with one request to the schedule
+    /// node, so that register_participant() can answer for each of them
+    /// without a round trip. Nothing is prefetched if the schedule node does
+    /// not answer before the timeout, and each participant will then be
+    /// registered on its own.
+    void register_participants_in_bulk(
+      const std::vector<rmf_traffic::schedule::ParticipantDescription>&
+      descriptions,
+      const std::chrono::nanoseconds timeout)
+    {
+      using namespace std::chrono_literals;
+
+      // Fall back right away if no schedule node is listening for this
+      if (descriptions.empty()
+        || bulk_request_pub->get_subscription_count() == 0)
+        return;
+
+      BulkRegistrationRequest request;
+      request.descriptions.reserve(descriptions.size());
+      for (const auto& description : descriptions)
+        request.descriptions.push_back(convert(description));
+
+      std::future<BulkRegistrationResponse> future;
+      {
+        std::lock_guard<std::mutex> lock(bulk_mutex);
+        request.request_id = next_bulk_request_id++;
+        future = bulk_waiters[request.request_id].get_future();
+      }
+
+      Batch msg;
+      msg.data = encode_bulk_registration_request(request);
+      bulk_request_pub->publish(std::move(msg));
+
+      const auto deadline = std::chrono::steady_clock::now() + timeout;
+      while (future.wait_for(100ms) != std::future_status::ready)
+      {
+        if (!rclcpp::ok(context) || std::chrono::steady_clock::now() > deadline)
+        {
+          std::lock_guard<std::mutex> lock(bulk_mutex);
+          bulk_waiters.erase(request.request_id);
+          return;
+        }
+      }
+
+      const auto response = future.get();
+      if (response.registrations.size() != descriptions.size())
+        return;
+
+      std::lock_guard<std::mutex> lock(bulk_mutex);
+      for (std::size_t i = 0; i < descriptions.size(); ++i)
+      {
+        // Failed registrations are left for register_participant() to retry
+        // and report on its own.
+        const auto& registration = response.registrations[i];
+        if (!registration.error.empty())
+          continue;
+
+        prefetched_registrations.insert_or_assign(
+          ParticipantKey{descriptions[i].owner(), descriptions[i].name()},
+          convert(registration));
+      }
+    }
+
+    void receive_bulk_registration(const Batch& msg)
+    {
+      BulkRegistrationResponse response;
+      try
+      {
+        response = decode_bulk_registration_response(msg.data);
+      }
+      catch (const BulkRegistrationError&)
+      {
+        return;
+      }
+
+      std::lock_guard<std::mutex> lock(bulk_mutex);
+      const auto it = bulk_waiters.find(response.request_id);
+      if (it == bulk_waiters.end())
+        return;
+
+      it->second.set_value(std::move(response));
+      bulk_waiters.erase(it);
+    }
+
     void update_description(
       rmf_traffic::schedule::ParticipantId,
       rmf_traffic::schedule::ParticipantDescription participant_info)
@@ -337,6 +1003,18 @@ public:
     void unregister_participant(
       const rmf_traffic::schedule::ParticipantId participant) final
     {
+      // Make sure the last changes of the participant go out before it is
+      // unregistered
+      if (delay_coalescer)
+      {
+        std::lock_guard<std::mutex> lock(delay_mutex);
+        if (auto held = delay_coalescer->take(participant))
+          forward_delay(std::move(*held));
+      }
+
+      if (batch_timer)
+        flush_batch();
+
       auto request = std::make_shared<Unregister::Request>();
       request->participant_id = participant;
 
@@ -370,9 +1048,16 @@ public:
   };
 
   Implementation(rclcpp::Node& node)
-  : transport(std::make_shared<Transport>(node))
+  : transport(std::make_shared<Transport>(node, get_schedule_shards(node)))
   {
-    // Do nothing
+    auto& factory = *transport->rectifier_factory;
+    std::lock_guard<std::mutex> lock(factory.history_mutex);
+    factory.resend =
+      [w = std::weak_ptr<Transport>(transport)](const ItineraryMsg& msg)
+      {
+        if (const auto t = w.lock())
+          t->resend(msg);
+      };
   }
 
   std::shared_ptr<Transport> transport;
@@ -405,6 +1090,34 @@ public:
     return future;
   }
 
+  void async_make_participants(
+    std::vector<rmf_traffic::schedule::ParticipantDescription> descriptions,
+    std::function<void(std::vector<rmf_traffic::schedule::Participant>)>
+    ready_callback)
+  {
+    std::thread worker(
+      [descriptions = std::move(descriptions),
+      this,
+      ready_callback = std::move(ready_callback)]()
+      {
+        using namespace std::chrono_literals;
+        transport->register_participants_in_bulk(descriptions, 10s);
+
+        std::vector<rmf_traffic::schedule::Participant> participants;
+        participants.reserve(descriptions.size());
+        for (const auto& description : descriptions)
+        {
+          participants.push_back(rmf_traffic::schedule::make_participant(
+              description, transport, transport->rectifier_factory));
+        }
+
+        if (ready_callback)
+          ready_callback(std::move(participants));
+      });
+
+    worker.detach();
+  }
+
   void async_make_participant(
     rmf_traffic::schedule::ParticipantDescription description,
     std::function<void(rmf_traffic::schedule::Participant)> ready_callback)
@@ -480,6 +1193,16 @@ void Writer::async_make_participant(
     std::move(description), std::move(ready_callback));
 }
 
+//==============================================================================
+void Writer::async_make_participants(
+  std::vector<rmf_traffic::schedule::ParticipantDescription> descriptions,
+  std::function<void(std::vector<rmf_traffic::schedule::Participant>)>
+  ready_callback)
+{
+  _pimpl->async_make_participants(
+    std::move(descriptions), std::move(ready_callback));
+}
+
 //==============================================================================
 Writer::Writer(rclcpp::Node& node)
 : _pimpl(rmf_utils::make_unique_impl<Implementation>(node))
@@ -32,14 +32,22 @@ rmf_traffic::schedule::Change::Add::Item convert(
 //==============================================================================
 rmf_traffic_msgs::msg::ScheduleChangeAdd convert(
   const rmf_traffic::schedule::Change::Add::Item& from)
+{
+  rmf_traffic_msgs::msg::ScheduleChangeAdd output;
+  convert(from, output);
+  return output;
+}
+
+//==============================================================================
+void convert(
+  const rmf_traffic::schedule::Change::Add::Item& from,
+  rmf_traffic_msgs::msg::ScheduleChangeAdd& into)
 {
   if (!from.route)
     throw std::runtime_error("Cannot convert a nullptr route into a message");
 
-  rmf_traffic_msgs::msg::ScheduleChangeAdd output;
-  output.id = from.id;
-  output.route = convert(*from.route);
-  return output;
+  into.id = from.id;
+  convert(*from.route, into.route);
 }
 
 //==============================================================================
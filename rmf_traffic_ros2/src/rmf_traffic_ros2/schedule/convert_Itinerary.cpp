@@ -25,12 +25,20 @@ std::vector<rmf_traffic_msgs::msg::Route> convert(
   const rmf_traffic::schedule::Itinerary& from)
 {
   std::vector<rmf_traffic_msgs::msg::Route> output;
-  for (const auto& r : from)
-    output.emplace_back(convert(*r));
-
+  convert(from, output);
   return output;
 }
 
+//==============================================================================
+void convert(
+  const rmf_traffic::schedule::Itinerary& from,
+  std::vector<rmf_traffic_msgs::msg::Route>& into)
+{
+  into.resize(from.size());
+  for (std::size_t i = 0; i < from.size(); ++i)
+    convert(*from[i], into[i]);
+}
+
 //==============================================================================
 std::vector<rmf_traffic::schedule::Itinerary> convert(
   const std::vector<rmf_traffic_msgs::msg::Itinerary>& from)
@@ -58,18 +66,18 @@ std::vector<rmf_traffic_msgs::msg::Itinerary> convert(
   const std::vector<rmf_traffic::schedule::Itinerary>& from)
 {
   std::vector<rmf_traffic_msgs::msg::Itinerary> output;
-  output.reserve(from.size());
-  for (const auto& from_itinerary : from)
-  {
-    rmf_traffic_msgs::msg::Itinerary to_itinerary;
-    to_itinerary.routes.reserve(from_itinerary.size());
-    for (const auto& from_route : from_itinerary)
-      to_itinerary.routes.emplace_back(convert(*from_route));
-
-    output.emplace_back(std::move(to_itinerary));
-  }
-
+  convert(from, output);
   return output;
 }
 
+//==============================================================================
+void convert(
+  const std::vector<rmf_traffic::schedule::Itinerary>& from,
+  std::vector<rmf_traffic_msgs::msg::Itinerary>& into)
+{
+  into.resize(from.size());
+  for (std::size_t i = 0; i < from.size(); ++i)
+    convert(from[i], into[i].routes);
+}
+
 } // namespace rmf_traffic_ros2
@@ -55,6 +55,24 @@ std::vector<T_out> convert_vector(
   return output;
 }
 
+//==============================================================================
+void convert(
+  const rmf_traffic::schedule::Patch::Participant& from,
+  rmf_traffic_msgs::msg::ScheduleParticipantPatch& into)
+{
+  into.participant_id = from.participant_id();
+  into.itinerary_version = from.itinerary_version();
+  into.erasures = from.erasures().ids();
+
+  into.delays.clear();
+  convert_vector(into.delays, from.delays());
+
+  const auto& additions = from.additions().items();
+  into.additions.resize(additions.size());
+  for (std::size_t i = 0; i < additions.size(); ++i)
+    convert(additions[i], into.additions[i]);
+}
+
 //==============================================================================
 rmf_traffic_msgs::msg::ScheduleParticipantPatch convert(
   const rmf_traffic::schedule::Patch::Participant& from)
@@ -90,21 +108,27 @@ rmf_traffic_msgs::msg::SchedulePatch convert(
   const rmf_traffic::schedule::Patch& from)
 {
   rmf_traffic_msgs::msg::SchedulePatch output;
+  convert(from, output);
+  return output;
+}
 
-  output.participants.reserve(from.size());
+//==============================================================================
+void convert(
+  const rmf_traffic::schedule::Patch& from,
+  rmf_traffic_msgs::msg::SchedulePatch& into)
+{
+  into.participants.resize(from.size());
+  auto it = into.participants.begin();
   for (const auto& p : from)
-    output.participants.emplace_back(convert(p));
+    convert(p, *it++);
 
+  into.cull.clear();
   if (const auto& cull = from.cull())
-    output.cull.emplace_back(convert(*cull));
+    into.cull.emplace_back(convert(*cull));
 
-  output.has_base_version = from.base_version().has_value();
-  if (from.base_version().has_value())
-    output.base_version = *from.base_version();
-
-  output.latest_version = from.latest_version();
-
-  return output;
+  into.has_base_version = from.base_version().has_value();
+  into.base_version = from.base_version().value_or(0);
+  into.latest_version = from.latest_version();
 }
 
 //==============================================================================
@@ -42,16 +42,23 @@ std::vector<rmf_traffic_msgs::msg::ScheduleWriterItem> convert(
   const rmf_traffic::schedule::Writer::Input& from)
 {
   std::vector<rmf_traffic_msgs::msg::ScheduleWriterItem> output;
-  for (const auto& item : from)
+  convert(from, output);
+  return output;
+}
+
+//==============================================================================
+void convert(
+  const rmf_traffic::schedule::Writer::Input& from,
+  std::vector<rmf_traffic_msgs::msg::ScheduleWriterItem>& into)
+{
+  into.resize(from.size());
+  for (std::size_t i = 0; i < from.size(); ++i)
   {
-    rmf_traffic_msgs::msg::ScheduleWriterItem msg;
-    msg.id = item.id;
+    const auto& item = from[i];
+    into[i].id = item.id;
     assert(item.route);
-    msg.route = convert(*item.route);
-    output.push_back(std::move(msg));
+    convert(*item.route, into[i].route);
   }
-
-  return output;
 }
 
 } // namespace rmf_traffic_ros2
@@ -19,7 +19,10 @@
 #define SRC__RMF_TRAFFIC_SCHEDULE__INTERNAL_MONITORNODE_HPP
 
 #include "internal_Node.hpp"  // For QueryMap and QuerySubscriberCountMap
+#include "ParticipantsDelta.hpp"
+#include "ReplicationLog.hpp"
 
+#include <rclcpp/executors/single_threaded_executor.hpp>
 #include <rclcpp/node.hpp>
 
 #include <rmf_traffic_msgs/msg/heartbeat.hpp>
@@ -31,7 +34,9 @@
 
 #include <rmf_traffic_ros2/schedule/MirrorManager.hpp>
 
+#include <atomic>
 #include <optional>
+#include <thread>
 #include <unordered_map>
 
 namespace rmf_traffic_ros2 {
@@ -54,9 +59,12 @@ public:
     std::function<void(std::shared_ptr<rclcpp::Node>)> callback,
     const rclcpp::NodeOptions& options);
 
+  ~MonitorNode();
+
   void setup();
 
   std::chrono::milliseconds heartbeat_period = 1s;
+  std::chrono::milliseconds heartbeat_lease_duration = 1s;
   rclcpp::QoS heartbeat_qos_profile;
   rclcpp::SubscriptionOptions heartbeat_sub_options;
   using Heartbeat = rmf_traffic_msgs::msg::Heartbeat;
@@ -81,6 +89,44 @@ public:
   int next_schedule_node_version = 1;
   virtual std::shared_ptr<rclcpp::Node> create_new_schedule_node();
 
+  /// Replace the primary schedule node, which has died
+  void fail_over();
+
+  // When hot standby is turned on, the replacement schedule node is set up as
+  // soon as the monitor has its first copy of the schedule. It follows the
+  // schedule on its own executor until the primary node dies, and then it
+  // only needs to be promoted.
+  bool hot_standby = false;
+  std::shared_ptr<ScheduleNode> standby_node;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> standby_executor;
+  std::atomic_bool standby_quit = false;
+  std::thread standby_thread;
+  virtual void prepare_standby_node(std::shared_ptr<Database> database);
+  void stop_standby_executor();
+
+  // When the replication log standby is turned on, the monitor does not keep
+  // a mirror of the schedule. It starts from a snapshot of the schedule and
+  // then follows the itinerary messages of the participants, folding them
+  // into the snapshot once per compact period.
+  bool log_standby = false;
+  std::chrono::milliseconds replication_compact_period = 10s;
+  ReplicationLog replication_log;
+  ParticipantsDeltaTracker participants_tracker;
+  ReplicationLog::Descriptions participants;
+  rclcpp::Subscription<ScheduleNode::CompactUpdate>::SharedPtr
+    participants_delta_sub;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> itinerary_subs;
+  rclcpp::TimerBase::SharedPtr replication_compact_timer;
+
+  void start_replication_log();
+
+  template<typename Msg>
+  void follow_itinerary_topic(const std::string& topic, const rclcpp::QoS& qos);
+
+  /// Make the database for the replacement schedule node out of the mirror
+  /// or the replication log
+  std::shared_ptr<Database> make_database();
+
   std::optional<rmf_traffic_ros2::schedule::MirrorManager> mirror;
   std::function<void(std::shared_ptr<rclcpp::Node>)> on_fail_over_callback;
   ScheduleNode::QueryMap registered_queries;
@@ -18,12 +18,27 @@
 #ifndef SRC__RMF_TRAFFIC_SCHEDULE__SCHEDULENODE_HPP
 #define SRC__RMF_TRAFFIC_SCHEDULE__SCHEDULENODE_HPP
 
+#include "BulkRegistration.hpp"
+#include "CompactMirrorUpdate.hpp"
+#include "ConflictBroadphase.hpp"
+#include "IngressQuota.hpp"
+#include "ItineraryBatch.hpp"
+#include "MirrorSync.hpp"
 #include "NegotiationRoom.hpp"
+#include "NegotiationStatus.hpp"
+#include "NegotiationTopics.hpp"
+#include "ParticipantsDelta.hpp"
+#include "QueryHash.hpp"
+#include "RemediationRequest.hpp"
+#include "RepeatCoalescer.hpp"
+#include "ScheduleSnapshot.hpp"
 
 #include <rmf_traffic/schedule/Database.hpp>
 #include <rmf_traffic/schedule/Negotiation.hpp>
 
 #include <rclcpp/node.hpp>
+#include <rclcpp/parameter_service.hpp>
+#include <rclcpp/serialized_message.hpp>
 
 #include <rmf_traffic_msgs/msg/mirror_update.hpp>
 #include <rmf_traffic_msgs/msg/participant.hpp>
@@ -54,16 +69,30 @@
 #include <rmf_traffic_msgs/srv/register_participant.hpp>
 #include <rmf_traffic_msgs/srv/unregister_participant.hpp>
 
+#include <std_msgs/msg/string.hpp>
+#include <std_msgs/msg/u_int8_multi_array.hpp>
+
 #include <rmf_traffic_msgs/msg/negotiation_notice.hpp>
 
+#include <rmf_traffic_ros2/CallbackWatchdog.hpp>
+#include <rmf_traffic_ros2/Metrics.hpp>
+#include <rmf_traffic_ros2/MetricsExporter.hpp>
+#include <rmf_traffic_ros2/ThreadSettings.hpp>
 #include <rmf_traffic_ros2/schedule/ParticipantRegistry.hpp>
 
 #include <rmf_utils/Modular.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <optional>
 #include <set>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <variant>
 
 namespace rmf_traffic_ros2 {
 namespace schedule {
@@ -105,14 +134,90 @@ public:
 
   virtual void setup(const QueryMap& queries);
 
+  // Swap out the database that this node will manage. This may only be used
+  // before setup() has been called.
+  void set_database(std::shared_ptr<rmf_traffic::schedule::Database> database_);
+
+  // A standby node is set up ahead of time to replace the primary node. It
+  // follows the participants of the primary node and ingests the same
+  // itinerary messages, but it offers no services, sends no heartbeat and
+  // publishes nothing until it is promoted. Use setup_standby(~) instead of
+  // setup(~) for such a node.
+  std::atomic_bool standby = false;
+  void setup_standby(const QueryMap& queries);
+
+  // Take over from the primary node after it has died. This only starts the
+  // parts that must not run alongside the primary node. The executor of the
+  // standby must not be spinning while this is called.
+  void promote(const QueryMap& queries);
+
+  // A standby node is made without parameter services because they would
+  // collide with the ones of the primary node, so they get started here when
+  // it is promoted.
+  std::shared_ptr<rclcpp::ParameterService> parameter_service;
+
+  void load_participant_registry();
+
+  // Each kind of work gets its own mutually exclusive callback group so that a
+  // multi-threaded executor can run them side by side. Anything that is not
+  // assigned to one of these stays in the default callback group of the node.
+  //
+  // When more than one of the node's mutexes need to be held, they are always
+  // locked in this order: queries_mutex, database_mutex,
+  // active_conflicts_mutex, mirror_timer_mutex.
+  rclcpp::CallbackGroup::SharedPtr ingest_callback_group;
+  rclcpp::CallbackGroup::SharedPtr services_callback_group;
+  rclcpp::CallbackGroup::SharedPtr negotiation_callback_group;
+  rclcpp::CallbackGroup::SharedPtr mirror_callback_group;
+
+  static rclcpp::SubscriptionOptions subscription_options(
+    const rclcpp::CallbackGroup::SharedPtr& group)
+  {
+    rclcpp::SubscriptionOptions options;
+    options.callback_group = group;
+    return options;
+  }
+
+  // Intra-process communication does not support transient local durability
+  // or keep-all history, so topics with those settings always go through the
+  // middleware, even when this node is loaded into a container that enables
+  // intra-process communication.
+  static rclcpp::PublisherOptions middleware_publisher_options()
+  {
+    rclcpp::PublisherOptions options;
+    options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+    return options;
+  }
+
+  static rclcpp::SubscriptionOptions middleware_subscription_options(
+    const rclcpp::CallbackGroup::SharedPtr& group)
+  {
+    auto options = subscription_options(group);
+    options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+    return options;
+  }
+
   std::chrono::milliseconds heartbeat_period = 1s;
   rclcpp::QoS heartbeat_qos_profile;
   using Heartbeat = rmf_traffic_msgs::msg::Heartbeat;
   using HeartbeatPub = rclcpp::Publisher<Heartbeat>;
   HeartbeatPub::SharedPtr heartbeat_pub;
 
+  // When this is true, the liveliness of the heartbeat is asserted by
+  // heartbeat_thread instead of by the middleware, so the monitor will notice
+  // a node that is still running but can no longer make progress. The thread
+  // does not depend on the executor, so a busy executor will not cause a
+  // false alarm.
+  bool manual_heartbeat = false;
+  std::chrono::milliseconds heartbeat_lease_duration = 1s;
+  std::mutex heartbeat_mutex;
+  std::condition_variable heartbeat_cv;
+  bool heartbeat_quit = false;
+  std::thread heartbeat_thread;
+
   virtual void setup_redundancy();
   virtual void start_heartbeat();
+  void run_heartbeat();
 
   using request_id_ptr = std::shared_ptr<rmw_request_id_t>;
 
@@ -163,10 +268,21 @@ public:
 
   UnregisterParticipantSrv::SharedPtr unregister_participant_service;
 
+  // Registers a whole batch of participants, such as a fleet that is starting
+  // up, with one lock and one broadcast of the participants.
+  void register_participants(const std_msgs::msg::UInt8MultiArray& msg);
+  rclcpp::Subscription<std_msgs::msg::UInt8MultiArray>::SharedPtr
+    bulk_registration_request_sub;
+  rclcpp::Publisher<std_msgs::msg::UInt8MultiArray>::SharedPtr
+    bulk_registration_response_pub;
+
   virtual void setup_participant_services();
 
   using MirrorUpdate = rmf_traffic_msgs::msg::MirrorUpdate;
   using MirrorUpdateTopicPublisher = rclcpp::Publisher<MirrorUpdate>::SharedPtr;
+  using CompactUpdate = std_msgs::msg::UInt8MultiArray;
+  using CompactUpdateTopicPublisher =
+    rclcpp::Publisher<CompactUpdate>::SharedPtr;
 
   void add_query_topic(uint64_t query_id);
   void remove_query_topic(uint64_t query_id);
@@ -176,8 +292,53 @@ public:
   using SingleParticipantInfo = rmf_traffic_msgs::msg::Participant;
   using ParticipantsInfo = rmf_traffic_msgs::msg::Participants;
   rclcpp::Publisher<ParticipantsInfo>::SharedPtr participants_info_pub;
+
+  // Publish the full set of participants. This is only done as a keyframe
+  // along with each resync of the participant deltas, so tools that follow
+  // the full set see changes no later than the next resync.
   virtual void broadcast_participants();
 
+  // The message form of a participant. The participant registry keeps the
+  // converted descriptions, so they do not get converted again for every
+  // broadcast. This must be called while the database_mutex is locked.
+  SingleParticipantInfo participant_info(
+    rmf_traffic::schedule::ParticipantId id);
+
+  // Numbered changes to the participants, so that mirrors do not need to
+  // receive and rebuild the whole set every time a participant is registered.
+  // A full resync is sent out periodically, and after a fixed number of
+  // deltas, so that the latched history always begins from a resync. Every
+  // change of the participants must go through one of these.
+  CompactUpdateTopicPublisher participants_delta_pub;
+  void broadcast_participants_delta(
+    std::vector<SingleParticipantInfo> updated,
+    std::vector<rmf_traffic::schedule::ParticipantId> removed);
+  void broadcast_participants_resync();
+  static constexpr std::size_t ParticipantsResyncInterval = 50;
+  uint64_t participants_delta_version = 0;
+  std::size_t deltas_since_participants_resync = 0;
+  std::chrono::milliseconds participants_resync_period = 10s;
+  rclcpp::TimerBase::SharedPtr participants_resync_timer;
+
+  // When this node is one shard of the schedule, this is the namespace of the
+  // schedule node that registers participants for every shard. This node
+  // takes its participants from there, so that their IDs match across the
+  // shards, and it joins the negotiations of that node. This is empty when
+  // this node registers its own participants.
+  std::string participant_registrar;
+  std::string registrar_topic_name(const std::string& name) const;
+
+  // Shards hand out the negotiation versions schedule_shard_index +
+  // k*schedule_shard_count so that two shards never open negotiations with
+  // the same version.
+  std::size_t schedule_shard_index = 0;
+  std::size_t schedule_shard_count = 1;
+
+  rclcpp::Subscription<CompactUpdate>::SharedPtr registrar_participants_sub;
+  ParticipantsDeltaTracker registrar_participants;
+  void follow_registrar(const ParticipantsInfo& msg);
+  virtual void setup_registrar_following();
+
   using ScheduleQuery = rmf_traffic_msgs::msg::ScheduleQuery;
   using ScheduleQueries = rmf_traffic_msgs::msg::ScheduleQueries;
   rclcpp::Publisher<ScheduleQueries>::SharedPtr queries_info_pub;
@@ -191,6 +352,17 @@ public:
     const RequestChanges::Response::SharedPtr& response);
   RequestChangesSrv::SharedPtr request_changes_service;
 
+  // Send the full state of a query to the mirrors that are listening on its
+  // sync topic, split into chunks, instead of a remedial update on the query
+  // topic that every mirror would receive.
+  void request_sync(
+    const request_id_ptr& request_header,
+    const RequestChanges::Request::SharedPtr& request,
+    const RequestChanges::Response::SharedPtr& response);
+  RequestChangesSrv::SharedPtr request_sync_service;
+  std::size_t mirror_sync_chunk_size = 100;
+  uint64_t next_sync_transfer_id = 0;
+
   virtual void setup_changes_services();
 
   using ItinerarySet = rmf_traffic_msgs::msg::ItinerarySet;
@@ -213,21 +385,132 @@ public:
   void itinerary_clear(const ItineraryClear& clear);
   rclcpp::Subscription<ItineraryClear>::SharedPtr itinerary_clear_sub;
 
+  // Writers with batching turned on send the itinerary messages of many
+  // participants at once. Each batch is applied in one ingestion pass.
+  void itinerary_batch(const CompactUpdate& batch);
+  rclcpp::Subscription<CompactUpdate>::SharedPtr itinerary_batch_sub;
+
   virtual void setup_itinerary_topics();
 
+  // Apply an itinerary message to the database. The database_mutex must
+  // already be locked.
+  void apply_itinerary_msg(const ItinerarySet& set);
+  void apply_itinerary_msg(const ItineraryExtend& extend);
+  void apply_itinerary_msg(const ItineraryDelay& delay);
+  void apply_itinerary_msg(const ItineraryErase& erase);
+  void apply_itinerary_msg(const ItineraryClear& clear);
+  void apply_itinerary_msg(const CoalescedDelay& delay);
+
+  // When this is true, the itinerary callbacks will queue up their messages,
+  // and the queue will be drained on the next executor pass with just one
+  // acquisition of the locks and one inconsistency report per participant.
+  bool batch_itinerary_ingestion = false;
+
+  using ItineraryMsg = rmf_traffic_ros2::schedule::ItineraryMsg;
+
+  std::vector<ItineraryMsg> pending_itinerary_msgs;
+  rclcpp::TimerBase::SharedPtr itinerary_ingest_timer;
+  void queue_itinerary_msg(ItineraryMsg msg);
+  void ingest_itinerary_msgs();
+
+  // Limits how often each participant and each fleet may write to the
+  // schedule, so that one misbehaving fleet cannot starve the others. This is
+  // null unless a write rate parameter is set. It is only used from the
+  // ingest_callback_group.
+  std::unique_ptr<IngressQuota> ingress_quota;
+  std::chrono::nanoseconds ingress_release_period = 100ms;
+  rclcpp::TimerBase::SharedPtr ingress_release_timer;
+
+  // The fleet that owns each participant which has written to the schedule
+  std::unordered_map<rmf_traffic::schedule::ParticipantId, std::string>
+  ingress_fleets;
+  const std::string& ingress_fleet(rmf_traffic::schedule::ParticipantId id);
+
+  // Returns false if the message was deferred because its participant or its
+  // fleet went over quota. The message must not be applied in that case.
+  bool admit_itinerary_msg(const ItineraryMsg& msg);
+
+  // Apply the deferred messages whose participants have quota again
+  void release_itinerary_msgs();
+
   using InconsistencyMsg = rmf_traffic_msgs::msg::ScheduleInconsistency;
   rclcpp::Publisher<InconsistencyMsg>::SharedPtr inconsistency_pub;
   void publish_inconsistencies(rmf_traffic::schedule::ParticipantId id);
 
+  // Reports for the same participant will never be published more often than
+  // this, even when its inconsistencies change.
+  std::chrono::nanoseconds inconsistency_report_min_period = 0ns;
+
+  // A report whose ranges have not changed will only be published again after
+  // this much time has passed, in case the previous report was missed.
+  std::chrono::nanoseconds inconsistency_report_repeat_period = 1s;
+
+  struct InconsistencyReport
+  {
+    InconsistencyMsg msg;
+    std::chrono::steady_clock::time_point published;
+  };
+
+  std::unordered_map<
+    rmf_traffic::schedule::ParticipantId,
+    InconsistencyReport> last_inconsistency_reports;
+
+  // Participants whose reports have been postponed by the rate limit
+  std::unordered_set<rmf_traffic::schedule::ParticipantId>
+  pending_inconsistency_reports;
+
+  rclcpp::TimerBase::SharedPtr inconsistency_report_timer;
+  void flush_inconsistency_reports();
+
   virtual void setup_incosistency_pub();
 
-  rclcpp::TimerBase::SharedPtr mirror_update_timer;
-  void update_mirrors();
-  void update_query(
-    const MirrorUpdateTopicPublisher& publisher,
-    const rmf_traffic::schedule::Query& query,
-    VersionOpt last_sent_version,
-    bool is_remedial);
+  // In the default mode, mirror updates are sent out by a wall timer with this
+  // period. In event-driven mode, changes to the database will trigger an
+  // update instead, with bursts of changes being coalesced into one update.
+  std::chrono::nanoseconds mirror_update_period = 10ms;
+  bool event_driven_mirror_updates = false;
+
+  // The shortest time that an event-driven update may follow the previous one
+  std::chrono::nanoseconds mirror_update_min_interval = 10ms;
+
+  // The longest time that an event-driven update may be postponed after the
+  // database first changes
+  std::chrono::nanoseconds mirror_update_max_latency = 50ms;
+
+  // A node that replaces a failed one is flooded with query registrations and
+  // remediation requests from every mirror at once. Until takeover_until, its
+  // event-driven mirror updates are spaced out by at least this interval so
+  // that those requests get merged instead of being answered one by one.
+  std::chrono::nanoseconds takeover_mirror_update_interval = 500ms;
+  std::chrono::steady_clock::duration takeover_period = 0s;
+  std::optional<std::chrono::steady_clock::time_point> takeover_until;
+
+  std::optional<std::chrono::steady_clock::time_point> mirror_dirty_since;
+  std::chrono::steady_clock::time_point last_mirror_update_time;
+
+  // Guards the timing of event-driven mirror updates, which may be requested
+  // from any callback group
+  std::mutex mirror_timer_mutex;
+
+  // Tell the node that the database or the remediation requests have changed.
+  // This will schedule a mirror update if the node is in event-driven mode.
+  void schedule_mirror_update();
+
+  // When this is true, each query will also get a side topic that carries its
+  // mirror updates as compact binary payloads.
+  bool compact_mirror_updates = false;
+  CompactResolution compact_mirror_resolution;
+
+  // Periods of the rate classes that every query will offer in addition to
+  // its main topic. Each rate class coalesces the changes of a query into at
+  // most one update per period.
+  std::vector<std::chrono::milliseconds> mirror_update_rate_classes;
+
+  // Periods of the coarse rate classes that every query will offer for
+  // visualization and monitoring. Their updates carry trajectories that are
+  // decimated to within mirror_update_lod_tolerance meters.
+  std::vector<std::chrono::milliseconds> mirror_update_lod_rate_classes;
+  double mirror_update_lod_tolerance = 0.25;
 
   // TODO(MXG): Consider using libguarded instead of a database_mutex
   std::mutex database_mutex;
@@ -239,13 +522,167 @@ public:
     MirrorUpdateTopicPublisher publisher;
     VersionOpt last_sent_version;
     std::chrono::steady_clock::time_point last_registration_time;
-    std::unordered_set<VersionOpt> remediation_requests;
+
+    // The remedial updates that mirrors of this query have asked for, which
+    // are merged into a single patch at the next mirror update
+    RemediationRequest remediation;
+
+    // This will be a nullptr unless compact_mirror_updates is turned on
+    CompactUpdateTopicPublisher compact_publisher;
+
+    // Carries the chunks of full-state transfers to joining mirrors
+    CompactUpdateTopicPublisher sync_publisher;
+
+    // A slower topic for this query that only sends out an update once its
+    // period has passed. Nothing is computed for a lane that has no
+    // subscribers.
+    struct RateLane
+    {
+      std::chrono::milliseconds period;
+      MirrorUpdateTopicPublisher publisher;
+      VersionOpt last_sent_version;
+      std::chrono::steady_clock::time_point last_sent_time;
+
+      // True if the trajectories of this lane are decimated
+      bool coarse = false;
+    };
+    std::vector<RateLane> rate_lanes;
+
+    // The query as it gets broadcast to the redundant nodes, which is kept
+    // so that it does not need to be converted again for every broadcast
+    rmf_traffic_msgs::msg::ScheduleQuery msg;
   };
   using QueryInfoMap = std::unordered_map<uint64_t, QueryInfo>;
 
+  // Identifies a mirror update within the current call to update_mirrors().
+  // The database version cannot change during the call, so the version that
+  // the update leads to is implied.
+  struct UpdateKey
+  {
+    const rmf_traffic::schedule::Query* query;
+    VersionOpt last_sent_version;
+    bool is_remedial;
+
+    bool operator==(const UpdateKey& other) const
+    {
+      return is_remedial == other.is_remedial
+        && last_sent_version == other.last_sent_version
+        && *query == *other.query;
+    }
+  };
+
+  struct UpdateKeyHash
+  {
+    std::size_t operator()(const UpdateKey& key) const
+    {
+      std::size_t seed = QueryHash()(*key.query);
+      for (const std::size_t value :
+        {std::hash<VersionOpt>()(key.last_sent_version),
+          std::hash<bool>()(key.is_remedial)})
+      {
+        seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+      }
+
+      return seed;
+    }
+  };
+
+  // Mirror updates that have already been computed and serialized during the
+  // current call to update_mirrors(). Many mirrors track identical queries
+  // from the same version, so they can all be given the same bytes. Each
+  // encoding is only produced once some topic actually needs it.
+  struct CachedUpdate
+  {
+    bool is_remedial;
+
+    // This will be a nullptr if there was nothing to send
+    std::shared_ptr<const rmf_traffic::schedule::Patch> patch;
+
+    std::shared_ptr<const rclcpp::SerializedMessage> message;
+    std::shared_ptr<const CompactUpdate> compact;
+
+    // The update with decimated trajectories for the coarse rate lanes
+    std::shared_ptr<const rclcpp::SerializedMessage> coarse;
+  };
+  using UpdateCache =
+    std::unordered_map<UpdateKey, CachedUpdate, UpdateKeyHash>;
+
+  rclcpp::TimerBase::SharedPtr mirror_update_timer;
+  void update_mirrors();
+  void update_query(
+    const QueryInfo& query_info,
+    VersionOpt last_sent_version,
+    bool is_remedial,
+    UpdateCache* cache = nullptr);
+
+  // Find or compute the patch for these parameters. The patch of the returned
+  // entry will be a nullptr if there is nothing to send.
+  CachedUpdate& cached_update(
+    const rmf_traffic::schedule::Query& query,
+    VersionOpt last_sent_version,
+    bool is_remedial,
+    UpdateCache& cache);
+
+  // Get the serialized MirrorUpdate of a cache entry that has a patch
+  const rclcpp::SerializedMessage& serialized_update(CachedUpdate& cached);
+
+  // Publish a cached update through a loaned message if the RMW can loan
+  // MirrorUpdate messages, or else through its serialized form.
+  void publish_update(
+    const MirrorUpdateTopicPublisher& publisher,
+    CachedUpdate& cached);
+
+  void fill_mirror_update(const CachedUpdate& cached, MirrorUpdate& msg) const;
+
+  // Publish a cached update to a rate lane, decimating its trajectories first
+  // if the lane is coarse
+  void publish_lane_update(
+    const QueryInfo::RateLane& lane,
+    CachedUpdate& cached);
+
+  // Reused by serialized_update so that converting each patch writes into
+  // memory that is left over from the previous patches. This is guarded by
+  // the database_mutex.
+  MirrorUpdate mirror_update_buffer;
+
+  // Send out coalesced updates for each rate lane whose period has passed.
+  // This returns the earliest time that a lane with pending changes will be
+  // due, if there is one.
+  std::optional<std::chrono::steady_clock::time_point> update_rate_lanes(
+    QueryInfo& query_info,
+    std::chrono::steady_clock::time_point now,
+    UpdateCache& cache);
+
+  // In event-driven mode, this fires when a rate lane becomes due and no
+  // other change has triggered an update in the meantime.
+  rclcpp::TimerBase::SharedPtr rate_lane_timer;
+
+  // Guards registered_queries, query_index, and last_query_id, which are
+  // shared by the query services and the mirror updates
+  std::mutex queries_mutex;
   std::size_t last_query_id = 0;
   QueryInfoMap registered_queries;
 
+  // Look up the IDs of registered queries by the hash of their query, so that
+  // a new registration does not need to be compared against every query
+  std::unordered_multimap<std::size_t, uint64_t> query_index;
+  std::optional<uint64_t> find_registered_query(
+    const rmf_traffic::schedule::Query& query) const;
+  void forget_query(QueryInfoMap::iterator it);
+
+  // The duration of each time bucket in the broadphase index that the conflict
+  // check thread uses to cull route pairs before the narrowphase check.
+  rmf_traffic::Duration conflict_broadphase_time_bucket = 10s;
+
+  // The number of threads that will share the work of checking the schedule
+  // changes for conflicts.
+  std::size_t conflict_check_threads = 1;
+
+  // How the operating system schedules the threads of the executor and of the
+  // conflict checker
+  ThreadSettings executor_thread_settings;
+  ThreadSettings conflict_check_thread_settings;
+
   // TODO(MXG): Make this a separate node
   std::thread conflict_check_thread;
   std::condition_variable conflict_check_cv;
@@ -257,8 +694,8 @@ public:
   void receive_conclusion_ack(const ConflictAck& msg);
 
   using ConflictNotice = rmf_traffic_msgs::msg::NegotiationNotice;
-  using ConflictNoticePub = rclcpp::Publisher<ConflictNotice>;
-  ConflictNoticePub::SharedPtr conflict_notice_pub;
+  using ConflictNoticePub = NegotiationPublisher<ConflictNotice>;
+  std::unique_ptr<ConflictNoticePub> conflict_notice_pub;
 
   using ConflictRefusal = rmf_traffic_msgs::msg::NegotiationRefusal;
   using ConflictRefusalSub = rclcpp::Subscription<ConflictRefusal>;
@@ -266,29 +703,67 @@ public:
   void receive_refusal(const ConflictRefusal& msg);
 
   using ConflictProposal = rmf_traffic_msgs::msg::NegotiationProposal;
-  using ConflictProposalSub = rclcpp::Subscription<ConflictProposal>;
-  ConflictProposalSub::SharedPtr conflict_proposal_sub;
+  using ConflictProposalSubs = NegotiationSubscriptions<ConflictProposal>;
+  std::unique_ptr<ConflictProposalSubs> conflict_proposal_subs;
   void receive_proposal(const ConflictProposal& msg);
 
+  // Proposals may also arrive as diffs against the previous proposal for the
+  // same table. If we are missing the proposal that a diff builds on, we ask
+  // for the full proposal to be repeated.
+  using ConflictProposalDiffSubs = NegotiationSubscriptions<CompactUpdate>;
+  std::unique_ptr<ConflictProposalDiffSubs> conflict_proposal_diff_subs;
+  void receive_proposal_diff(const CompactUpdate& msg);
+
+  using ConflictRepeat = rmf_traffic_msgs::msg::NegotiationRepeat;
+  using ConflictRepeatPub = rclcpp::Publisher<ConflictRepeat>;
+  ConflictRepeatPub::SharedPtr conflict_repeat_pub;
+
+  // The repeats that we asked for within the last negotiation_repeat_period,
+  // so the diffs that arrive before the full proposal do not ask for it
+  // again. This is guarded by the active_conflicts_mutex.
+  RepeatCoalescer requested_repeats{std::chrono::milliseconds(500)};
+
   using ConflictRejection = rmf_traffic_msgs::msg::NegotiationRejection;
-  using ConflictRejectionSub = rclcpp::Subscription<ConflictRejection>;
-  ConflictRejectionSub::SharedPtr conflict_rejection_sub;
+  using ConflictRejectionSubs = NegotiationSubscriptions<ConflictRejection>;
+  std::unique_ptr<ConflictRejectionSubs> conflict_rejection_subs;
   void receive_rejection(const ConflictRejection& msg);
 
   using ConflictForfeit = rmf_traffic_msgs::msg::NegotiationForfeit;
-  using ConflictForfeitSub = rclcpp::Subscription<ConflictForfeit>;
-  ConflictForfeitSub::SharedPtr conflict_forfeit_sub;
+  using ConflictForfeitSubs = NegotiationSubscriptions<ConflictForfeit>;
+  std::unique_ptr<ConflictForfeitSubs> conflict_forfeit_subs;
   void receive_forfeit(const ConflictForfeit& msg);
 
   using ConflictConclusion = rmf_traffic_msgs::msg::NegotiationConclusion;
-  using ConflictConclusionPub = rclcpp::Publisher<ConflictConclusion>;
-  ConflictConclusionPub::SharedPtr conflict_conclusion_pub;
+  using ConflictConclusionPub = NegotiationPublisher<ConflictConclusion>;
+  std::unique_ptr<ConflictConclusionPub> conflict_conclusion_pub;
+
+  // When this is more than zero, the negotiation topics are split into this
+  // many shards by participant ID, so that each fleet adapter only receives
+  // the negotiations that it takes part in.
+  std::size_t negotiation_topic_shards = 0;
 
   using Version = rmf_traffic::schedule::Version;
   using ItineraryVersion = rmf_traffic::schedule::ItineraryVersion;
   using ParticipantId = rmf_traffic::schedule::ParticipantId;
   using ConflictSet = std::unordered_set<ParticipantId>;
 
+  // Optional hooks that let benchmarks and tests observe the progress of the
+  // node. They are empty by default.
+  struct Observers
+  {
+    // Called while the database_mutex is locked, right after an itinerary
+    // message has been applied to the database
+    std::function<void(ParticipantId, ItineraryVersion, Version)>
+    itinerary_applied;
+
+    // Called from the conflict check thread once every change up to the given
+    // database version has been checked for conflicts
+    std::function<void(Version)> conflicts_checked;
+  };
+  Observers observers;
+  void observe_itinerary_applied(
+    ParticipantId participant, ItineraryVersion itinerary_version);
+
   using Negotiation = rmf_traffic::schedule::Negotiation;
 
   class ConflictRecord
@@ -310,7 +785,23 @@ public:
       // Do nothing
     }
 
-    rmf_utils::optional<Entry> insert(const ConflictSet& conflicts)
+    using SnapshotPtr =
+      std::shared_ptr<const rmf_traffic::schedule::Snapshot>;
+
+    /// Open a negotiation for a set of conflicts, or add them to one that is
+    /// already open.
+    ///
+    /// \param[in] conflicts
+    ///   The participants that are in conflict with each other
+    ///
+    /// \param[in,out] snapshot
+    ///   The snapshot of the schedule that new negotiations should begin
+    ///   from. If this is empty when a new negotiation is opened, a snapshot
+    ///   will be taken and stored here so that the rest of the negotiations
+    ///   opened in the same conflict checking cycle can share it.
+    rmf_utils::optional<Entry> insert(
+      const ConflictSet& conflicts,
+      SnapshotPtr& snapshot)
     {
       ConflictSet add_to_negotiation;
       const Version* existing_negotiation = nullptr;
@@ -344,7 +835,10 @@ public:
         return rmf_utils::nullopt;
 
       const Version negotiation_version = existing_negotiation ?
-        *existing_negotiation : _next_negotiation_version++;
+        *existing_negotiation : _next_negotiation_version;
+
+      if (!existing_negotiation)
+        _next_negotiation_version += _negotiation_version_stride;
 
       const auto insertion = _negotiations.insert(
         std::make_pair(negotiation_version, rmf_utils::nullopt));
@@ -355,8 +849,11 @@ public:
       auto& update_negotiation = insertion.first->second;
       if (!update_negotiation)
       {
+        if (!snapshot)
+          snapshot = _viewer->snapshot();
+
         update_negotiation = *rmf_traffic::schedule::Negotiation::make(
-          _viewer->snapshot(), std::vector<ParticipantId>(
+          snapshot, std::vector<ParticipantId>(
             add_to_negotiation.begin(), add_to_negotiation.end()));
       }
       else
@@ -479,14 +976,139 @@ public:
     std::unordered_map<ParticipantId, Wait> _waiting;
     std::shared_ptr<const rmf_traffic::schedule::Snappable> _viewer;
     Version _next_negotiation_version = 0;
+    Version _negotiation_version_stride = 1;
+
+    void shard_negotiation_versions(std::size_t index, std::size_t count)
+    {
+      _next_negotiation_version = index;
+      _negotiation_version_stride = std::max<std::size_t>(count, 1);
+    }
   };
 
   ConflictRecord active_conflicts;
   std::mutex active_conflicts_mutex;
+
+  // Keeps the notice time of each open negotiation and the latency of the
+  // concluded ones. This is guarded by the active_conflicts_mutex.
+  NegotiationStatusTracker negotiation_status;
+
+  // Periodically publishes the negotiation status as a YAML document, which
+  // replaces printing the conclusions to the terminal
+  using NegotiationStatusMsg = std_msgs::msg::String;
+  using NegotiationStatusPub = rclcpp::Publisher<NegotiationStatusMsg>;
+  NegotiationStatusPub::SharedPtr negotiation_status_pub;
+  rclcpp::TimerBase::SharedPtr negotiation_status_timer;
+  std::chrono::milliseconds negotiation_status_period = 1s;
+  void publish_negotiation_status();
   std::shared_ptr<ParticipantRegistry> participant_registry;
 
   virtual void setup_conflict_topics_and_thread();
 
+  // Load the schedule snapshot file, if one has been configured and exists.
+  // Any problem with the file is reported and the node starts empty instead.
+  std::optional<ScheduleSnapshot> load_schedule_snapshot();
+
+  // Periodically capture the database and hand it to the snapshot thread,
+  // which writes it to disk so that file I/O never blocks the executor.
+  virtual void setup_schedule_snapshots();
+  void capture_schedule_snapshot();
+  void write_schedule_snapshots();
+
+  // The snapshot file location. Snapshots are turned off when this is empty.
+  std::string schedule_snapshot_file;
+  std::chrono::milliseconds schedule_snapshot_period = 10s;
+  rclcpp::TimerBase::SharedPtr schedule_snapshot_timer;
+  VersionOpt last_snapshot_version;
+  std::optional<ScheduleSnapshot> pending_snapshot;
+  std::mutex snapshot_mutex;
+  std::condition_variable snapshot_cv;
+  bool snapshot_quit = false;
+  std::thread snapshot_thread;
+
+  // Periodically cull the routes that ended before the retention horizon, and
+  // the routes that finished earliest whenever the schedule grows beyond its
+  // memory budget.
+  virtual void setup_schedule_retention();
+  void cull_schedule();
+
+  // How far into the future the conflict thread looks. Changes to routes that
+  // begin after this window are checked once the window reaches them. A zero
+  // duration checks every change right away.
+  rmf_traffic::Duration conflict_check_horizon = rmf_traffic::Duration(0);
+
+  // Routes which finished longer ago than this are culled. A zero duration
+  // turns off time-based culling.
+  rmf_traffic::Duration schedule_retention_horizon = rmf_traffic::Duration(0);
+
+  // The most memory, in bytes, that the routes in the schedule may use, as
+  // estimated by estimate_route_bytes. Zero means there is no budget.
+  std::size_t schedule_memory_budget = 0;
+  std::chrono::milliseconds schedule_cull_period = 10s;
+  rclcpp::TimerBase::SharedPtr schedule_cull_timer;
+  std::optional<rmf_traffic::Time> last_cull_time;
+
+  // Periodically publish an estimate of the memory held by the containers of
+  // the node, so that budgets can be set and leaks traced to a container
+  virtual void setup_memory_usage();
+  void publish_memory_usage();
+
+  using MemoryUsageMsg = std_msgs::msg::String;
+  rclcpp::Publisher<MemoryUsageMsg>::SharedPtr memory_usage_pub;
+  rclcpp::TimerBase::SharedPtr memory_usage_timer;
+
+  // Turned off when this is zero
+  std::chrono::milliseconds memory_usage_period = 0ms;
+
+  // Counters of the work done by the node, which are exported on the
+  // diagnostics topic and optionally over HTTP according to the
+  // metrics_period and metrics_http_port parameters. This also sets up the
+  // callback watchdog and the tracer of the process when their parameters ask
+  // for them.
+  virtual void setup_metrics();
+  void refresh_metrics();
+
+  // Tell the negotiation_status and the metrics that a negotiation concluded.
+  // This must be called while the active_conflicts_mutex is locked.
+  void negotiation_concluded(
+    rmf_traffic::schedule::Version conflict_version,
+    bool resolved);
+
+  std::shared_ptr<Metrics> metrics = std::make_shared<Metrics>();
+  struct Instruments
+  {
+    Instruments(Metrics& metrics);
+
+    std::shared_ptr<Metrics::Counter> itinerary_messages;
+    std::shared_ptr<Metrics::Counter> itinerary_failures;
+    std::shared_ptr<Metrics::Histogram> ingest_seconds;
+    std::shared_ptr<Metrics::Counter> conflicts;
+    std::shared_ptr<Metrics::Histogram> conflict_check_seconds;
+    std::shared_ptr<Metrics::Counter> negotiations_opened;
+    std::shared_ptr<Metrics::Counter> negotiations_resolved;
+    std::shared_ptr<Metrics::Counter> negotiations_failed;
+    std::shared_ptr<Metrics::Histogram> resolved_negotiation_seconds;
+    std::shared_ptr<Metrics::Histogram> failed_negotiation_seconds;
+    std::shared_ptr<Metrics::Counter> mirror_updates;
+    std::shared_ptr<Metrics::Gauge> participants;
+    std::shared_ptr<Metrics::Gauge> queries;
+    std::shared_ptr<Metrics::Gauge> open_negotiations;
+    std::shared_ptr<Metrics::Gauge> schedule_version;
+    std::shared_ptr<Metrics::Gauge> deferred_writes;
+    std::shared_ptr<Metrics::Gauge> throttled_participants;
+    std::shared_ptr<Metrics::Counter> superseded_writes;
+  };
+  Instruments instruments{*metrics};
+
+  // The writes of each participant that were deferred by the ingress_quota
+  std::unordered_map<
+    rmf_traffic::schedule::ParticipantId,
+    std::shared_ptr<Metrics::Counter>> throttled_writes;
+  std::shared_ptr<MetricsExporter> metrics_exporter;
+
+  // Times the callbacks of this node when spin_node() spins it. This is null
+  // unless the callback_report_period parameter is positive.
+  std::shared_ptr<CallbackWatchdog> callback_watchdog;
+
   // TODO(MXG): Build this into the Database/Mirror class, tracking participant
   // description versions separately from itinerary versions.
   std::size_t last_known_participants_version = 0;
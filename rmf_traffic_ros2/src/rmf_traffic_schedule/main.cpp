@@ -29,7 +29,7 @@ int main(int argc, char* argv[])
     node->get_logger(),
     "Beginning traffic schedule node");
 
-  rclcpp::spin(node);
+  rmf_traffic_ros2::schedule::spin_node(node);
 
   RCLCPP_INFO(
     node->get_logger(),
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Keeps one mirror of the whole traffic schedule for every process on this
+// host and publishes it into a shared memory segment. Other processes can read
+// the segment through rmf_traffic_ros2::schedule::SharedMirror instead of
+// keeping mirrors of their own. For example
+//
+//   rmf_traffic_schedule_mirror --ros-args -p segment_name:=site_schedule
+
+#include <rmf_traffic_ros2/schedule/MirrorManager.hpp>
+#include <rmf_traffic_ros2/schedule/SharedMirror.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <iostream>
+#include <optional>
+#include <unordered_set>
+
+using namespace std::chrono_literals;
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+  rclcpp::init(argc, argv);
+  const auto node = std::make_shared<rclcpp::Node>(
+    "rmf_traffic_schedule_mirror");
+
+  const std::string segment_name = node->declare_parameter<std::string>(
+    "segment_name", "rmf_traffic_schedule_mirror");
+  const auto capacity = static_cast<std::size_t>(
+    std::max<int64_t>(1, node->declare_parameter<int64_t>(
+      "segment_capacity_mb", 256))) * 1024 * 1024;
+  const auto publish_period =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(
+      node->declare_parameter<double>("publish_period", 0.05)));
+
+  // Readers only need the schedule for planning and conflict checks, so the
+  // trajectories can be quantized to this resolution to shrink the segment.
+  // Zero keeps them at full precision.
+  const double compact_resolution =
+    node->declare_parameter<double>("compact_resolution", 0.0);
+
+  std::optional<rmf_traffic_ros2::schedule::SharedMirrorPublisher> publisher;
+  try
+  {
+    publisher.emplace(segment_name, capacity);
+    if (compact_resolution > 0.0)
+      publisher->compact_resolution(compact_resolution);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  auto mirror_future = rmf_traffic_ros2::schedule::make_mirror(
+    *node, rmf_traffic::schedule::query_all());
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  while (rclcpp::ok()
+    && mirror_future.wait_for(0s) != std::future_status::ready)
+  {
+    executor.spin_once(100ms);
+  }
+
+  if (!rclcpp::ok())
+    return 0;
+
+  auto mirror = mirror_future.get();
+
+  // The mirror is only changed by the callbacks of this node, and this timer
+  // runs on the same executor, so no mutex is needed.
+  bool published = false;
+  rmf_traffic::schedule::Version last_version = 0;
+  std::unordered_set<rmf_traffic::schedule::ParticipantId> last_participants;
+  const auto timer = node->create_wall_timer(
+    publish_period,
+    [&]()
+    {
+      const auto& viewer = mirror.viewer();
+      const auto version = viewer.latest_version();
+      if (published && version == last_version
+      && viewer.participant_ids() == last_participants)
+      {
+        return;
+      }
+
+      // Oversized schedules are only reported once per version. The next
+      // change will try again.
+      published = true;
+      last_version = version;
+      last_participants = viewer.participant_ids();
+
+      if (!publisher->publish(mirror.fork()))
+      {
+        RCLCPP_ERROR(
+          node->get_logger(),
+          "The schedule at version [%lu] does not fit in the [%s] segment. "
+          "Increase the segment_capacity_mb parameter.",
+          version, segment_name.c_str());
+      }
+    });
+
+  RCLCPP_INFO(
+    node->get_logger(),
+    "Publishing the traffic schedule to shared memory segment [%s]",
+    segment_name.c_str());
+
+  executor.spin();
+
+  rclcpp::shutdown();
+}
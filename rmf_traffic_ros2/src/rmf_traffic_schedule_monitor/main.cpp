@@ -46,7 +46,7 @@ int main(int argc, char* argv[])
     RCLCPP_INFO(
       active_schedule_node->get_logger(),
       "Spinning up replacement schedule node");
-    rclcpp::spin(active_schedule_node);
+    rmf_traffic_ros2::schedule::spin_node(active_schedule_node);
     RCLCPP_INFO(
       active_schedule_node->get_logger(),
       "Shutting down replacement schedule node");
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Records the inputs of the traffic schedule node so that they can be
+// replayed offline with schedule_replay_benchmark. For example
+//
+//   rmf_traffic_schedule_recorder site.rmfrec
+//
+// Use the same negotiation_topic_shards parameter as the schedule node.
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+
+#include <rmf_traffic_msgs/msg/itinerary_clear.hpp>
+#include <rmf_traffic_msgs/msg/itinerary_delay.hpp>
+#include <rmf_traffic_msgs/msg/itinerary_erase.hpp>
+#include <rmf_traffic_msgs/msg/itinerary_extend.hpp>
+#include <rmf_traffic_msgs/msg/itinerary_set.hpp>
+#include <rmf_traffic_msgs/msg/negotiation_ack.hpp>
+#include <rmf_traffic_msgs/msg/negotiation_forfeit.hpp>
+#include <rmf_traffic_msgs/msg/negotiation_proposal.hpp>
+#include <rmf_traffic_msgs/msg/negotiation_refusal.hpp>
+#include <rmf_traffic_msgs/msg/negotiation_rejection.hpp>
+#include <rmf_traffic_msgs/msg/participants.hpp>
+
+#include <std_msgs/msg/u_int8_multi_array.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include "../rmf_traffic_ros2/schedule/NegotiationTopics.hpp"
+#include "../rmf_traffic_ros2/schedule/ParticipantsDelta.hpp"
+#include "../rmf_traffic_ros2/schedule/ScheduleRecording.hpp"
+
+#include <iostream>
+
+using namespace std::chrono_literals;
+using rmf_traffic_ros2::schedule::RecordedInput;
+
+namespace {
+//==============================================================================
+class Recorder : public rclcpp::Node
+{
+public:
+
+  Recorder(const std::string& file_path)
+  : rclcpp::Node("rmf_traffic_schedule_recorder"),
+    _writer(file_path),
+    _start(std::chrono::steady_clock::now())
+  {
+    using namespace rmf_traffic_msgs::msg;
+    using CompactUpdate = std_msgs::msg::UInt8MultiArray;
+
+    // The schedule node only publishes the full set of participants at each
+    // resync, so the deltas are followed instead and the full set that they
+    // describe is recorded whenever it changes.
+    _subscriptions.push_back(
+      create_subscription<CompactUpdate>(
+        rmf_traffic_ros2::ParticipantsDeltaTopicName,
+        rclcpp::SystemDefaultsQoS().reliable().keep_last(100)
+        .transient_local(),
+        [this](const std::shared_ptr<const CompactUpdate> msg)
+        {
+          record_participants(*msg);
+        }));
+
+    const auto itinerary_qos =
+      rclcpp::SystemDefaultsQoS().reliable().keep_last(100);
+    record<ItinerarySet>(
+      RecordedInput::ItinerarySet,
+      rmf_traffic_ros2::ItinerarySetTopicName, itinerary_qos);
+    record<ItineraryExtend>(
+      RecordedInput::ItineraryExtend,
+      rmf_traffic_ros2::ItineraryExtendTopicName, itinerary_qos);
+    record<ItineraryDelay>(
+      RecordedInput::ItineraryDelay,
+      rmf_traffic_ros2::ItineraryDelayTopicName, itinerary_qos);
+    record<ItineraryErase>(
+      RecordedInput::ItineraryErase,
+      rmf_traffic_ros2::ItineraryEraseTopicName, itinerary_qos);
+    record<ItineraryClear>(
+      RecordedInput::ItineraryClear,
+      rmf_traffic_ros2::ItineraryClearTopicName, itinerary_qos);
+    record<CompactUpdate>(
+      RecordedInput::ItineraryBatch,
+      rmf_traffic_ros2::ItineraryBatchTopicName, itinerary_qos);
+
+    const auto negotiation_qos = rclcpp::ServicesQoS().reliable();
+    record<NegotiationAck>(
+      RecordedInput::NegotiationAck,
+      rmf_traffic_ros2::NegotiationAckTopicName, negotiation_qos);
+    record<NegotiationRefusal>(
+      RecordedInput::NegotiationRefusal,
+      rmf_traffic_ros2::NegotiationRefusalTopicName, negotiation_qos);
+
+    const auto shards =
+      rmf_traffic_ros2::schedule::get_negotiation_topic_shards(*this);
+    record_shards<NegotiationProposal>(
+      RecordedInput::NegotiationProposal,
+      rmf_traffic_ros2::NegotiationProposalTopicName, negotiation_qos, shards);
+    record_shards<CompactUpdate>(
+      RecordedInput::NegotiationProposalDiff,
+      rmf_traffic_ros2::NegotiationProposalDiffTopicName,
+      negotiation_qos, shards);
+    record_shards<NegotiationRejection>(
+      RecordedInput::NegotiationRejection,
+      rmf_traffic_ros2::NegotiationRejectionTopicName,
+      negotiation_qos, shards);
+    record_shards<NegotiationForfeit>(
+      RecordedInput::NegotiationForfeit,
+      rmf_traffic_ros2::NegotiationForfeitTopicName, negotiation_qos, shards);
+
+    // Recordings are flushed regularly so that little is lost if the recorder
+    // is killed.
+    _flush_timer = create_wall_timer(1s, [this]() { _writer.flush(); });
+  }
+
+  ~Recorder()
+  {
+    _writer.flush();
+  }
+
+private:
+
+  rmf_traffic::Duration elapsed() const
+  {
+    return std::chrono::steady_clock::now() - _start;
+  }
+
+  void record_participants(const std_msgs::msg::UInt8MultiArray& msg)
+  {
+    try
+    {
+      using rmf_traffic_ros2::schedule::decode_participants_delta;
+      if (!_participants.apply(decode_participants_delta(msg.data)))
+        return;
+    }
+    catch (const rmf_traffic_ros2::schedule::ParticipantsDeltaDecodeError& e)
+    {
+      RCLCPP_ERROR(
+        get_logger(), "Failed to decode a participants delta: %s", e.what());
+      return;
+    }
+
+    _writer.write(
+      RecordedInput::Participants, elapsed(),
+      rmf_traffic_ros2::convert(_participants.participants()));
+  }
+
+  template<typename Message>
+  void record(
+    const RecordedInput input,
+    const std::string& topic,
+    const rclcpp::QoS& qos)
+  {
+    _subscriptions.push_back(
+      create_subscription<Message>(
+        topic, qos,
+        [this, input](const std::shared_ptr<const Message> msg)
+        {
+          _writer.write(input, elapsed(), *msg);
+        }));
+  }
+
+  template<typename Message>
+  void record_shards(
+    const RecordedInput input,
+    const std::string& topic,
+    const rclcpp::QoS& qos,
+    const std::size_t shards)
+  {
+    auto subs = std::make_shared<
+      rmf_traffic_ros2::schedule::NegotiationSubscriptions<Message>>(
+      *this, topic, qos, shards,
+      [this, input](const Message& msg)
+      {
+        _writer.write(input, elapsed(), msg);
+      });
+    subs->subscribe_all();
+    _shard_subscriptions.push_back(std::move(subs));
+  }
+
+  rmf_traffic_ros2::schedule::ScheduleRecordingWriter _writer;
+  rmf_traffic_ros2::schedule::ParticipantsDeltaTracker _participants;
+  std::chrono::steady_clock::time_point _start;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> _subscriptions;
+  std::vector<std::shared_ptr<void>> _shard_subscriptions;
+  rclcpp::TimerBase::SharedPtr _flush_timer;
+};
+
+} // anonymous namespace
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+  const auto args = rclcpp::init_and_remove_ros_arguments(argc, argv);
+
+  if (args.size() < 2)
+  {
+    std::cerr << "You need to specify a recording file!" << std::endl;
+    return 1;
+  }
+
+  std::shared_ptr<Recorder> node;
+  try
+  {
+    node = std::make_shared<Recorder>(args[1]);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  RCLCPP_INFO(
+    node->get_logger(),
+    "Recording schedule inputs to [%s]",
+    args[1].c_str());
+
+  rclcpp::spin(node);
+  node.reset();
+
+  rclcpp::shutdown();
+}
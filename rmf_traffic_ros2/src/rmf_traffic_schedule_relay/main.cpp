@@ -0,0 +1,519 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Follows the traffic schedule with one mirror and serves the mirrors of
+// local dashboards, UIs and fleet adapters from it, so the schedule node only
+// has to publish to the relay instead of to every one of them. Mirrors reach
+// the relay through its namespace, e.g.
+//
+//   rmf_traffic_schedule_relay --ros-args -p relay_namespace:=host_a_relay
+//
+// and MirrorManager::Options().shard("host_a_relay") on the consumer side.
+// Run one relay per host, each with its own namespace or with
+// ROS_LOCALHOST_ONLY set.
+//
+// The relay serves full MirrorUpdate messages and participant descriptions.
+// It filters updates by the participants of each query, but not by their
+// spacetime, so a mirror may hold routes outside of its query. Participants
+// are served both as a full set and as a resync on the participant delta
+// topic every time they change. Compact updates, sync transfers and rate
+// classes are not relayed, so mirrors of the relay should leave those options
+// off.
+
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/Timer.hpp>
+#include <rmf_traffic_ros2/schedule/MirrorManager.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+#include <rmf_traffic_ros2/schedule/Patch.hpp>
+#include <rmf_traffic_ros2/schedule/Query.hpp>
+
+#include <rmf_traffic_msgs/msg/mirror_update.hpp>
+#include <rmf_traffic_msgs/msg/participant.hpp>
+#include <rmf_traffic_msgs/msg/participants.hpp>
+#include <rmf_traffic_msgs/msg/schedule_queries.hpp>
+#include <rmf_traffic_msgs/srv/register_query.hpp>
+#include <rmf_traffic_msgs/srv/request_changes.hpp>
+
+#include <std_msgs/msg/u_int8_multi_array.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <rmf_utils/Modular.hpp>
+
+#include "../rmf_traffic_ros2/schedule/ParticipantsDelta.hpp"
+#include "../rmf_traffic_ros2/schedule/QueryHash.hpp"
+#include "../rmf_traffic_ros2/schedule/ScheduleShards.hpp"
+
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std::chrono_literals;
+
+namespace {
+//==============================================================================
+/// Decides which participants of the schedule a query is interested in
+class ParticipantFilter
+{
+public:
+
+  using ParticipantId = rmf_traffic::schedule::ParticipantId;
+  using Participants = rmf_traffic::schedule::Query::Participants;
+
+  explicit ParticipantFilter(const Participants& participants)
+  : _mode(participants.get_mode())
+  {
+    if (_mode == Participants::Mode::Include)
+    {
+      const auto& ids = participants.include()->get_ids();
+      _ids.insert(ids.begin(), ids.end());
+    }
+    else if (_mode == Participants::Mode::Exclude)
+    {
+      const auto& ids = participants.exclude()->get_ids();
+      _ids.insert(ids.begin(), ids.end());
+    }
+  }
+
+  bool all() const
+  {
+    return _mode == Participants::Mode::All;
+  }
+
+  bool accepts(const ParticipantId id) const
+  {
+    if (_mode == Participants::Mode::Include)
+      return _ids.count(id) > 0;
+
+    if (_mode == Participants::Mode::Exclude)
+      return _ids.count(id) == 0;
+
+    return true;
+  }
+
+  rmf_traffic::schedule::Patch filter(
+    const rmf_traffic::schedule::Patch& patch) const
+  {
+    std::vector<rmf_traffic::schedule::Patch::Participant> participants;
+    for (const auto& p : patch)
+    {
+      if (accepts(p.participant_id()))
+        participants.push_back(p);
+    }
+
+    std::optional<rmf_traffic::schedule::Change::Cull> cull;
+    if (patch.cull())
+      cull = *patch.cull();
+
+    return rmf_traffic::schedule::Patch(
+      std::move(participants),
+      std::move(cull),
+      patch.base_version(),
+      patch.latest_version());
+  }
+
+private:
+  Participants::Mode _mode;
+  std::unordered_set<ParticipantId> _ids;
+};
+
+//==============================================================================
+class Relay : public rclcpp::Node
+{
+public:
+
+  using MirrorUpdate = rmf_traffic_msgs::msg::MirrorUpdate;
+  using ParticipantsInfo = rmf_traffic_msgs::msg::Participants;
+  using CompactUpdate = std_msgs::msg::UInt8MultiArray;
+  using ScheduleQueries = rmf_traffic_msgs::msg::ScheduleQueries;
+  using RegisterQuery = rmf_traffic_msgs::srv::RegisterQuery;
+  using RequestChanges = rmf_traffic_msgs::srv::RequestChanges;
+  using Query = rmf_traffic::schedule::Query;
+  using Patch = rmf_traffic::schedule::Patch;
+
+  Relay()
+  : rclcpp::Node("rmf_traffic_schedule_relay")
+  {
+    _namespace = declare_parameter<std::string>("relay_namespace", "relay");
+    const auto upstream =
+      declare_parameter<std::string>("upstream_shard", "");
+    _query_grace_period =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(
+        declare_parameter<double>("query_grace_period", 10.0)));
+
+    const auto latched =
+      rclcpp::SystemDefaultsQoS().reliable().keep_last(100).transient_local();
+
+    _participants_pub = create_publisher<ParticipantsInfo>(
+      relay_name(rmf_traffic_ros2::ParticipantsInfoTopicName), latched);
+
+    _participants_delta_pub = create_publisher<CompactUpdate>(
+      relay_name(rmf_traffic_ros2::ParticipantsDeltaTopicName), latched);
+
+    _queries_pub = create_publisher<ScheduleQueries>(
+      relay_name(rmf_traffic_ros2::QueriesInfoTopicName), latched);
+
+    _register_query_service = create_service<RegisterQuery>(
+      relay_name(rmf_traffic_ros2::RegisterQueryServiceName),
+      [this](
+        const std::shared_ptr<rmw_request_id_t>,
+        const RegisterQuery::Request::SharedPtr request,
+        const RegisterQuery::Response::SharedPtr response)
+      {
+        this->register_query(*request, *response);
+      });
+
+    _request_changes_service = create_service<RequestChanges>(
+      relay_name(rmf_traffic_ros2::RequestChangesServiceName),
+      [this](
+        const std::shared_ptr<rmw_request_id_t>,
+        const RequestChanges::Request::SharedPtr request,
+        const RequestChanges::Response::SharedPtr response)
+      {
+        this->request_changes(*request, *response);
+      });
+
+    _cleanup_timer = rmf_traffic_ros2::create_timer(
+      *this,
+      _query_grace_period,
+      [this]() { this->cleanup_queries(); });
+
+    broadcast_queries();
+
+    // The whole schedule is followed, and every local query is served from it
+    auto options = rmf_traffic_ros2::schedule::MirrorManager::Options()
+      .shard(upstream)
+      .on_patch([this](const Patch& patch) { this->relay_patch(patch); })
+      .on_participants([this]() { this->broadcast_participants(); });
+
+    _mirror_future.emplace(
+      rmf_traffic_ros2::schedule::make_mirror(
+        *this, rmf_traffic::schedule::query_all(), std::move(options)));
+
+    _mirror_timer = rmf_traffic_ros2::create_timer(
+      *this,
+      100ms,
+      [this]()
+      {
+        if (_mirror_future->wait_for(0s) != std::future_status::ready)
+          return;
+
+        _mirror_timer->cancel();
+        _mirror.emplace(_mirror_future->get());
+        _mirror_future.reset();
+        RCLCPP_INFO(
+          get_logger(),
+          "Relaying the traffic schedule to namespace [%s]",
+          _namespace.c_str());
+
+        // Anyone who registered while the mirror was being made is still
+        // waiting for their first update
+        this->broadcast_participants();
+        for (auto& [query_id, query] : _queries)
+          query.needs_full_update = true;
+        this->schedule_full_updates();
+      });
+  }
+
+private:
+
+  struct LocalQuery
+  {
+    Query query;
+    ParticipantFilter filter;
+    rclcpp::Publisher<MirrorUpdate>::SharedPtr publisher;
+    std::chrono::steady_clock::time_point last_registration_time;
+    bool needs_full_update;
+  };
+
+  std::string relay_name(const std::string& name) const
+  {
+    return rmf_traffic_ros2::schedule::shard_topic_name(_namespace, name);
+  }
+
+  void register_query(
+    const RegisterQuery::Request& request,
+    RegisterQuery::Response& response)
+  {
+    response.node_version = NodeVersion;
+
+    Query query = rmf_traffic_ros2::convert(request.query);
+    const auto hash = rmf_traffic_ros2::schedule::QueryHash()(query);
+    const auto [begin, end] = _query_index.equal_range(hash);
+    for (auto it = begin; it != end; ++it)
+    {
+      auto& existing = _queries.at(it->second);
+      if (existing.query == query)
+      {
+        existing.last_registration_time = std::chrono::steady_clock::now();
+        response.query_id = it->second;
+        return;
+      }
+    }
+
+    uint64_t query_id = _last_query_id;
+    do
+    {
+      ++query_id;
+    } while (_queries.count(query_id) > 0);
+    _last_query_id = query_id;
+
+    auto publisher = create_publisher<MirrorUpdate>(
+      relay_name(
+        rmf_traffic_ros2::QueryUpdateTopicNameBase + std::to_string(query_id)),
+      rclcpp::SystemDefaultsQoS());
+
+    ParticipantFilter filter(query.participants());
+    _queries.insert(
+      {
+        query_id,
+        LocalQuery{
+          std::move(query),
+          std::move(filter),
+          std::move(publisher),
+          std::chrono::steady_clock::now(),
+          true
+        }
+      });
+    _query_index.insert({hash, query_id});
+
+    response.query_id = query_id;
+    RCLCPP_INFO(get_logger(), "Registered new query [%ld]", query_id);
+
+    broadcast_queries();
+    schedule_full_updates();
+  }
+
+  void request_changes(
+    const RequestChanges::Request& request,
+    RequestChanges::Response& response)
+  {
+    const auto it = _queries.find(request.query_id);
+    if (it == _queries.end())
+    {
+      response.result = RequestChanges::Response::UNKNOWN_QUERY_ID;
+      return;
+    }
+
+    response.result = RequestChanges::Response::REQUEST_ACCEPTED;
+
+    // The relay keeps no history, so any mirror that is behind gets a full
+    // update. Mirrors that are up to date are only checking in.
+    if (request.full_update || !_mirror.has_value()
+      || rmf_utils::modular(request.version).less_than(
+        _mirror->viewer().latest_version()))
+    {
+      it->second.needs_full_update = true;
+      schedule_full_updates();
+    }
+  }
+
+  void schedule_full_updates()
+  {
+    if (!_mirror.has_value())
+      return;
+
+    if (_full_update_timer && !_full_update_timer->is_canceled())
+      return;
+
+    // Requests that arrive together are served from one fork of the mirror
+    _full_update_timer = rmf_traffic_ros2::create_timer(
+      *this,
+      std::chrono::nanoseconds(0),
+      [this]()
+      {
+        // This is a one-shot timer
+        this->_full_update_timer->cancel();
+        this->send_full_updates();
+      });
+  }
+
+  void send_full_updates()
+  {
+    std::optional<rmf_traffic::schedule::Database> database;
+    for (auto& [query_id, query] : _queries)
+    {
+      if (!query.needs_full_update)
+        continue;
+
+      query.needs_full_update = false;
+      if (!database)
+        database.emplace(_mirror->fork());
+
+      // Only the participants of the query are filtered, the same as the
+      // incremental updates
+      auto filter = rmf_traffic::schedule::query_all();
+      filter.participants() = query.query.participants();
+      publish(query, database->changes(filter, std::nullopt), true);
+    }
+  }
+
+  void relay_patch(const Patch& patch)
+  {
+    // Each query gets the patch as the relay received it, minus the
+    // participants that it did not ask for. Queries that take everything
+    // share one message.
+    std::optional<MirrorUpdate> shared;
+    for (auto& [query_id, query] : _queries)
+    {
+      if (query.needs_full_update)
+        continue;
+
+      if (!query.filter.all())
+      {
+        publish(query, query.filter.filter(patch), false);
+        continue;
+      }
+
+      if (!shared)
+        shared = make_update(patch, false);
+
+      query.publisher->publish(*shared);
+    }
+  }
+
+  MirrorUpdate make_update(const Patch& patch, const bool is_remedial) const
+  {
+    MirrorUpdate msg;
+    msg.node_version = NodeVersion;
+    msg.database_version = patch.latest_version();
+    rmf_traffic_ros2::convert(patch, msg.patch);
+    msg.is_remedial_update = is_remedial;
+    return msg;
+  }
+
+  void publish(LocalQuery& query, const Patch& patch, const bool is_remedial)
+  {
+    query.publisher->publish(make_update(patch, is_remedial));
+  }
+
+  void broadcast_participants()
+  {
+    if (!_mirror.has_value())
+      return;
+
+    const auto& viewer = _mirror->viewer();
+    ParticipantsInfo msg;
+    for (const auto id : viewer.participant_ids())
+    {
+      rmf_traffic_msgs::msg::Participant participant;
+      participant.id = id;
+      participant.description =
+        rmf_traffic_ros2::convert(*viewer.get_participant(id));
+      msg.participants.push_back(std::move(participant));
+    }
+
+    // Every change is relayed as a resync, which any mirror that follows the
+    // deltas can apply right away
+    using namespace rmf_traffic_ros2::schedule;
+    ParticipantsDelta delta;
+    delta.version = ++_participants_delta_version;
+    delta.resync = true;
+    delta.updated = msg;
+
+    CompactUpdate delta_msg;
+    delta_msg.data = encode_participants_delta(delta);
+    _participants_delta_pub->publish(delta_msg);
+
+    _participants_pub->publish(msg);
+  }
+
+  void broadcast_queries()
+  {
+    ScheduleQueries msg;
+    msg.node_version = NodeVersion;
+    for (const auto& [query_id, query] : _queries)
+    {
+      msg.ids.push_back(query_id);
+      msg.queries.push_back(rmf_traffic_ros2::convert(query.query));
+    }
+
+    _queries_pub->publish(msg);
+  }
+
+  void cleanup_queries()
+  {
+    const auto now = std::chrono::steady_clock::now();
+    bool any_erased = false;
+    auto it = _queries.begin();
+    while (it != _queries.end())
+    {
+      if (it->second.publisher->get_subscription_count() > 0
+        || now - it->second.last_registration_time < _query_grace_period)
+      {
+        ++it;
+        continue;
+      }
+
+      const auto hash = rmf_traffic_ros2::schedule::QueryHash()(
+        it->second.query);
+      const auto [begin, end] = _query_index.equal_range(hash);
+      for (auto index = begin; index != end; ++index)
+      {
+        if (index->second == it->first)
+        {
+          _query_index.erase(index);
+          break;
+        }
+      }
+
+      RCLCPP_INFO(get_logger(), "Forgetting unused query [%ld]", it->first);
+      it = _queries.erase(it);
+      any_erased = true;
+    }
+
+    if (any_erased)
+      broadcast_queries();
+  }
+
+  // The relay is the only schedule that its mirrors ever see, so it never
+  // changes version, even when the schedule node upstream fails over.
+  static constexpr uint64_t NodeVersion = 0;
+
+  std::string _namespace;
+  std::chrono::nanoseconds _query_grace_period;
+
+  std::optional<rmf_traffic_ros2::schedule::MirrorManagerFuture>
+  _mirror_future;
+  std::optional<rmf_traffic_ros2::schedule::MirrorManager> _mirror;
+  rclcpp::TimerBase::SharedPtr _mirror_timer;
+
+  std::unordered_map<uint64_t, LocalQuery> _queries;
+  std::unordered_multimap<std::size_t, uint64_t> _query_index;
+  uint64_t _last_query_id = 0;
+
+  rclcpp::Publisher<ParticipantsInfo>::SharedPtr _participants_pub;
+  rclcpp::Publisher<CompactUpdate>::SharedPtr _participants_delta_pub;
+  uint64_t _participants_delta_version = 0;
+  rclcpp::Publisher<ScheduleQueries>::SharedPtr _queries_pub;
+  rclcpp::Service<RegisterQuery>::SharedPtr _register_query_service;
+  rclcpp::Service<RequestChanges>::SharedPtr _request_changes_service;
+  rclcpp::TimerBase::SharedPtr _cleanup_timer;
+  rclcpp::TimerBase::SharedPtr _full_update_timer;
+};
+} // anonymous namespace
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+  rclcpp::init(argc, argv);
+  const auto relay = std::make_shared<Relay>();
+  rclcpp::spin(relay);
+  rclcpp::shutdown();
+}
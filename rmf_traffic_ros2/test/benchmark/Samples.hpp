@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef TEST__BENCHMARK__SAMPLES_HPP
+#define TEST__BENCHMARK__SAMPLES_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//==============================================================================
+/// Latency samples of a benchmark, printed as a percentile summary
+class Samples
+{
+public:
+
+  void add(const std::chrono::steady_clock::duration value)
+  {
+    _values.push_back(
+      std::chrono::duration<double, std::milli>(value).count());
+  }
+
+  std::size_t size() const
+  {
+    return _values.size();
+  }
+
+  void print(const std::string& name)
+  {
+    std::cout << "  " << std::left << std::setw(10) << name << std::right;
+    if (_values.empty())
+    {
+      std::cout << " no samples\n";
+      return;
+    }
+
+    std::sort(_values.begin(), _values.end());
+    double total = 0.0;
+    for (const auto v : _values)
+      total += v;
+
+    const auto percentile = [&](const double p)
+      {
+        const auto index = static_cast<std::size_t>(
+          p * static_cast<double>(_values.size() - 1));
+        return _values[index];
+      };
+
+    std::cout << std::fixed << std::setprecision(3)
+              << " n=" << std::setw(8) << _values.size()
+              << " mean=" << std::setw(9) << total / _values.size()
+              << " p50=" << std::setw(9) << percentile(0.5)
+              << " p90=" << std::setw(9) << percentile(0.9)
+              << " p99=" << std::setw(9) << percentile(0.99)
+              << " max=" << std::setw(9) << _values.back()
+              << "  [ms]\n";
+  }
+
+private:
+  std::vector<double> _values;
+};
+
+#endif // TEST__BENCHMARK__SAMPLES_HPP
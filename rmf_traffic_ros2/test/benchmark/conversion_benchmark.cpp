@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+// This benchmark measures the round trip throughput of the convert() functions
+// that sit on the hot paths of the schedule: trajectories and routes for
+// itinerary writes and proposals, patches for mirror updates, and profiles
+// and shapes for participant descriptions. Each case converts a native
+// object into its message and back again, and reports the time per round
+// trip in the manner of Google Benchmark.
+//
+// Usage:
+//
+//   conversion_benchmark [--filter=<substring>] [--min_time=<seconds>]
+//
+// Only the cases whose name contains the filter are run. Each case is
+// repeated until at least min_time seconds (0.5 by default) have passed.
+
+#include <rmf_traffic_ros2/Profile.hpp>
+#include <rmf_traffic_ros2/Route.hpp>
+#include <rmf_traffic_ros2/Trajectory.hpp>
+#include <rmf_traffic_ros2/geometry/Circle.hpp>
+#include <rmf_traffic_ros2/geometry/ConvexShape.hpp>
+#include <rmf_traffic_ros2/schedule/Patch.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+//==============================================================================
+/// Keep the optimizer from discarding a result that is never used
+template<typename T>
+void do_not_optimize(const T& value)
+{
+  asm volatile ("" : : "g" (&value) : "memory");
+}
+
+//==============================================================================
+struct Case
+{
+  std::string name;
+  std::function<void()> run;
+};
+
+//==============================================================================
+void run_case(const Case& c, const Clock::duration min_time)
+{
+  // Warm up the caches and the allocator before measuring
+  for (std::size_t i = 0; i < 10; ++i)
+    c.run();
+
+  std::size_t iterations = 0;
+  std::size_t batch = 1;
+  const auto start = Clock::now();
+  auto elapsed = Clock::duration(0);
+  while (elapsed < min_time)
+  {
+    for (std::size_t i = 0; i < batch; ++i)
+      c.run();
+
+    iterations += batch;
+    batch *= 2;
+    elapsed = Clock::now() - start;
+  }
+
+  const double ns_per_op =
+    std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+
+  std::cout << std::left << std::setw(40) << c.name << std::right
+            << std::fixed << std::setprecision(0)
+            << std::setw(14) << ns_per_op << " ns"
+            << std::setw(14) << iterations << "\n";
+}
+
+//==============================================================================
+rmf_traffic::Trajectory make_trajectory(
+  const std::size_t waypoints,
+  const double offset = 0.0)
+{
+  rmf_traffic::Trajectory trajectory;
+  for (std::size_t i = 0; i < waypoints; ++i)
+  {
+    const double x = static_cast<double>(i);
+    trajectory.insert(
+      rmf_traffic::Time(std::chrono::seconds(i)),
+      {x, offset, 0.1*x},
+      {1.0, 0.0, 0.1});
+  }
+
+  return trajectory;
+}
+
+//==============================================================================
+rmf_traffic::schedule::ParticipantDescription make_description(
+  const std::size_t i)
+{
+  return rmf_traffic::schedule::ParticipantDescription(
+    "robot_" + std::to_string(i),
+    "conversion_benchmark",
+    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(0.5)
+    });
+}
+
+//==============================================================================
+/// A full patch of a database where each participant has two routes of ten
+/// waypoints, like a mirror that is joining would receive.
+rmf_traffic::schedule::Patch make_patch(const std::size_t participants)
+{
+  rmf_traffic::schedule::Database database;
+  for (std::size_t i = 0; i < participants; ++i)
+  {
+    const auto id = database.register_participant(make_description(i)).id();
+    const double offset = static_cast<double>(i);
+    database.set(
+      id,
+      {
+        {0, std::make_shared<rmf_traffic::Route>(
+            "L1", make_trajectory(10, offset))},
+        {1, std::make_shared<rmf_traffic::Route>(
+            "L2", make_trajectory(10, offset))}
+      },
+      0);
+  }
+
+  return database.changes(rmf_traffic::schedule::query_all(), std::nullopt);
+}
+
+//==============================================================================
+std::vector<Case> make_cases()
+{
+  std::vector<Case> cases;
+
+  for (const std::size_t n : {10, 100, 1000})
+  {
+    auto trajectory = std::make_shared<rmf_traffic::Trajectory>(
+      make_trajectory(n));
+
+    cases.push_back(
+      {
+        "Trajectory/RoundTrip/" + std::to_string(n),
+        [trajectory]()
+        {
+          const auto msg = rmf_traffic_ros2::convert(*trajectory);
+          do_not_optimize(rmf_traffic_ros2::convert(msg));
+        }
+      });
+
+    auto buffer = std::make_shared<rmf_traffic_msgs::msg::Trajectory>();
+    cases.push_back(
+      {
+        "Trajectory/ToMessageReused/" + std::to_string(n),
+        [trajectory, buffer]()
+        {
+          rmf_traffic_ros2::convert(*trajectory, *buffer);
+          do_not_optimize(*buffer);
+        }
+      });
+
+    auto route = std::make_shared<rmf_traffic::Route>("L1", *trajectory);
+    cases.push_back(
+      {
+        "Route/RoundTrip/" + std::to_string(n),
+        [route]()
+        {
+          const auto msg = rmf_traffic_ros2::convert(*route);
+          do_not_optimize(rmf_traffic_ros2::convert(msg));
+        }
+      });
+  }
+
+  for (const std::size_t n : {1, 50, 500})
+  {
+    auto patch = std::make_shared<rmf_traffic::schedule::Patch>(
+      make_patch(n));
+
+    cases.push_back(
+      {
+        "Patch/RoundTrip/" + std::to_string(n),
+        [patch]()
+        {
+          const auto msg = rmf_traffic_ros2::convert(*patch);
+          do_not_optimize(rmf_traffic_ros2::convert(msg));
+        }
+      });
+
+    auto buffer = std::make_shared<rmf_traffic_msgs::msg::SchedulePatch>();
+    cases.push_back(
+      {
+        "Patch/ToMessageReused/" + std::to_string(n),
+        [patch, buffer]()
+        {
+          rmf_traffic_ros2::convert(*patch, *buffer);
+          do_not_optimize(*buffer);
+        }
+      });
+  }
+
+  auto profile = std::make_shared<rmf_traffic::Profile>(
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5),
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(1.0));
+  cases.push_back(
+    {
+      "Profile/RoundTrip",
+      [profile]()
+      {
+        const auto msg = rmf_traffic_ros2::convert(*profile);
+        do_not_optimize(rmf_traffic_ros2::convert(msg));
+      }
+    });
+
+  const rmf_traffic::geometry::Circle circle(0.75);
+  cases.push_back(
+    {
+      "Shape/Circle/RoundTrip",
+      [circle]()
+      {
+        const auto msg = rmf_traffic_ros2::convert(circle);
+        do_not_optimize(rmf_traffic_ros2::convert(msg));
+      }
+    });
+
+  std::vector<rmf_traffic::geometry::ConstFinalConvexShapePtr> shapes;
+  for (std::size_t i = 1; i <= 10; ++i)
+  {
+    shapes.push_back(
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(0.1*static_cast<double>(i)));
+  }
+
+  cases.push_back(
+    {
+      "Shape/ConvexContext/RoundTrip/10",
+      [shapes]()
+      {
+        rmf_traffic_ros2::geometry::ConvexShapeContext context;
+        for (const auto& shape : shapes)
+          do_not_optimize(context.insert(shape));
+
+        const auto msg = rmf_traffic_ros2::convert(context);
+        do_not_optimize(rmf_traffic_ros2::convert(msg));
+      }
+    });
+
+  return cases;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+  std::string filter;
+  double min_time = 0.5;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg.rfind("--filter=", 0) == 0)
+    {
+      filter = arg.substr(9);
+    }
+    else if (arg.rfind("--min_time=", 0) == 0)
+    {
+      min_time = std::atof(arg.substr(11).c_str());
+    }
+    else
+    {
+      std::cerr << "Unknown argument [" << arg << "]\n"
+                << "Usage: " << argv[0]
+                << " [--filter=<substring>] [--min_time=<seconds>]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  const auto min_duration = std::chrono::duration_cast<Clock::duration>(
+    std::chrono::duration<double>(min_time));
+
+  std::cout << std::left << std::setw(40) << "Benchmark" << std::right
+            << std::setw(17) << "Time" << std::setw(14) << "Iterations"
+            << "\n" << std::string(71, '-') << "\n";
+
+  for (const auto& c : make_cases())
+  {
+    if (c.name.find(filter) != std::string::npos)
+      run_case(c, min_duration);
+  }
+
+  return 0;
+}
@@ -0,0 +1,496 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// This benchmark runs a ScheduleNode in-process and drives it with synthetic
+// participants that are created through the regular Writer API. It reports
+// how long it takes for a participant's change to be
+//   - applied to the database (ingest)
+//   - checked for conflicts (conflict)
+//   - received by a mirror through its query update topic (mirror)
+// along with the CPU time that the whole process used per participant.
+//
+// Every parameter is given through --ros-args, for example
+//
+//   schedule_node_benchmark --ros-args -p participants:=200 -p set_rate:=0.5
+//
+// Parameters of the ScheduleNode itself, such as conflict_check_threads, can
+// be passed the same way. Run this on an isolated ROS_DOMAIN_ID so that it
+// does not interfere with a live schedule.
+
+#include <rmf_traffic_ros2/schedule/internal_Node.hpp>
+#include <rmf_traffic_ros2/schedule/Query.hpp>
+#include <rmf_traffic_ros2/schedule/Writer.hpp>
+#include <rmf_traffic_ros2/StandardNames.hpp>
+#include <rmf_traffic_ros2/Time.hpp>
+
+#include <rmf_traffic/geometry/Circle.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include "Samples.hpp"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+using ScheduleNode = rmf_traffic_ros2::schedule::ScheduleNode;
+using Clock = std::chrono::steady_clock;
+using MirrorUpdate = rmf_traffic_msgs::msg::MirrorUpdate;
+using RegisterQuery = rmf_traffic_msgs::srv::RegisterQuery;
+
+namespace {
+//==============================================================================
+struct Options
+{
+  std::size_t participants;
+  double duration;
+  double warmup;
+  double set_rate;
+  double extend_rate;
+  double delay_rate;
+  double map_size;
+  std::size_t waypoints;
+  int seed;
+
+  static Options from(rclcpp::Node& node)
+  {
+    Options o;
+    o.participants = static_cast<std::size_t>(
+      node.declare_parameter<int>("participants", 50));
+    o.duration = node.declare_parameter<double>("duration", 30.0);
+    o.warmup = node.declare_parameter<double>("warmup", 5.0);
+    o.set_rate = node.declare_parameter<double>("set_rate", 1.0);
+    o.extend_rate = node.declare_parameter<double>("extend_rate", 0.0);
+    o.delay_rate = node.declare_parameter<double>("delay_rate", 2.0);
+    o.map_size = node.declare_parameter<double>("map_size", 100.0);
+    o.waypoints = static_cast<std::size_t>(
+      std::max<int64_t>(2, node.declare_parameter<int>("waypoints", 10)));
+    o.seed = node.declare_parameter<int>("seed", 42);
+    return o;
+  }
+};
+
+//==============================================================================
+// Every change that a participant sends will be tracked from the moment it is
+// sent until it has been ingested, checked and mirrored.
+class Tracker
+{
+public:
+
+  using ParticipantId = ScheduleNode::ParticipantId;
+  using ItineraryVersion = ScheduleNode::ItineraryVersion;
+  using Version = ScheduleNode::Version;
+
+  // The change is sent while the tracker is locked so that the schedule node
+  // cannot report it as applied before we know which version it became.
+  template<typename Action>
+  void send(const ParticipantId participant, Action&& action)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto sent_time = Clock::now();
+    const ItineraryVersion version = action();
+    _sent[{participant, version}] = sent_time;
+    ++_num_sent;
+  }
+
+  void applied(
+    const ParticipantId participant,
+    const ItineraryVersion version,
+    const Version database_version)
+  {
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _sent.find({participant, version});
+    if (it == _sent.end())
+      return;
+
+    const auto sent_time = it->second;
+    _sent.erase(it);
+
+    if (!_recording)
+      return;
+
+    ++_num_applied;
+    ingest.add(now - sent_time);
+    _unchecked.push_back({database_version, sent_time});
+    _unmirrored.push_back({database_version, sent_time});
+  }
+
+  void checked(const Version database_version)
+  {
+    _drain(_unchecked, database_version, conflict);
+  }
+
+  void mirrored(const Version database_version)
+  {
+    _drain(_unmirrored, database_version, mirror);
+  }
+
+  void recording(const bool choice)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _recording = choice;
+  }
+
+  void print(
+    const Options& options,
+    const double wall_seconds,
+    const double cpu_seconds)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::cout << "\nSchedule node benchmark with " << options.participants
+              << " participants over " << wall_seconds << "s\n"
+              << "  changes sent: " << _num_sent
+              << ", ingested while recording: " << _num_applied
+              << ", still in flight: " << _sent.size() << "\n";
+
+    ingest.print("ingest");
+    conflict.print("conflict");
+    mirror.print("mirror");
+
+    const double cpu_fraction = cpu_seconds / wall_seconds;
+    std::cout << std::fixed << std::setprecision(3)
+              << "  cpu: " << 100.0 * cpu_fraction << "% of one core, "
+              << 100.0 * cpu_fraction / options.participants
+              << "% per participant (includes the benchmark driver)\n";
+  }
+
+  Samples ingest;
+  Samples conflict;
+  Samples mirror;
+
+private:
+
+  struct Pending
+  {
+    Version database_version;
+    Clock::time_point sent_time;
+  };
+
+  void _drain(
+    std::deque<Pending>& pending,
+    const Version database_version,
+    Samples& samples)
+  {
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    while (!pending.empty()
+      && pending.front().database_version <= database_version)
+    {
+      samples.add(now - pending.front().sent_time);
+      pending.pop_front();
+    }
+  }
+
+  std::mutex _mutex;
+  bool _recording = false;
+  std::size_t _num_sent = 0;
+  std::size_t _num_applied = 0;
+  std::map<std::pair<ParticipantId, ItineraryVersion>, Clock::time_point>
+  _sent;
+  std::deque<Pending> _unchecked;
+  std::deque<Pending> _unmirrored;
+};
+
+//==============================================================================
+double cpu_seconds()
+{
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  const auto to_seconds = [](const timeval& t)
+    {
+      return static_cast<double>(t.tv_sec) + 1e-6 * t.tv_usec;
+    };
+
+  return to_seconds(usage.ru_utime) + to_seconds(usage.ru_stime);
+}
+
+//==============================================================================
+class Driver
+{
+public:
+
+  using Participant = rmf_traffic::schedule::Participant;
+
+  Driver(
+    rclcpp::Node& node,
+    Options options,
+    std::vector<Participant>& participants,
+    Tracker& tracker)
+  : _node(node),
+    _options(std::move(options)),
+    _participants(participants),
+    _tracker(tracker),
+    _rng(_options.seed)
+  {
+    _set_timer = _make_timer(
+      _options.set_rate, _next_set, [this](Participant& p)
+      {
+        p.set({_make_route(rmf_traffic_ros2::convert(_node.now()))});
+      });
+
+    _extend_timer = _make_timer(
+      _options.extend_rate, _next_extend, [this](Participant& p)
+      {
+        p.extend({_make_route(rmf_traffic_ros2::convert(_node.now()) + 1min)});
+      });
+
+    _delay_timer = _make_timer(
+      _options.delay_rate, _next_delay, [this](Participant& p)
+      {
+        std::uniform_int_distribution<int> delay_ms(100, 1000);
+        p.delay(std::chrono::milliseconds(delay_ms(_rng)));
+      });
+  }
+
+  void stop()
+  {
+    for (const auto& timer : {_set_timer, _extend_timer, _delay_timer})
+    {
+      if (timer)
+        timer->cancel();
+    }
+  }
+
+private:
+
+  rclcpp::TimerBase::SharedPtr _make_timer(
+    const double rate_per_participant,
+    std::size_t& next,
+    std::function<void(Participant&)> action)
+  {
+    const double total_rate = rate_per_participant * _participants.size();
+    if (total_rate <= 0.0)
+      return nullptr;
+
+    // One timer round-robins through the participants instead of giving each
+    // participant its own timer.
+    const auto period = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(1.0 / total_rate));
+
+    return _node.create_wall_timer(
+      period, [this, &next, action = std::move(action)]()
+      {
+        auto& participant = _participants[next];
+        next = (next + 1) % _participants.size();
+
+        _tracker.send(
+          participant.id(), [&]()
+          {
+            action(participant);
+            return participant.version();
+          });
+      });
+  }
+
+  rmf_traffic::Route _make_route(const rmf_traffic::Time start)
+  {
+    std::uniform_real_distribution<double> coord(0.0, _options.map_size);
+    std::uniform_real_distribution<double> heading(-M_PI, M_PI);
+
+    // Wander at 1 m/s, turning a little at every waypoint
+    Eigen::Vector3d p(coord(_rng), coord(_rng), heading(_rng));
+    rmf_traffic::Trajectory trajectory;
+    auto t = start;
+    for (std::size_t i = 0; i < _options.waypoints; ++i)
+    {
+      const Eigen::Vector3d v(std::cos(p[2]), std::sin(p[2]), 0.0);
+      trajectory.insert(t, p, v);
+
+      p.head<2>() += 5.0 * v.head<2>();
+      p[2] += 0.25 * heading(_rng);
+      t += 5s;
+    }
+
+    return {"L1", std::move(trajectory)};
+  }
+
+  rclcpp::Node& _node;
+  Options _options;
+  std::vector<Participant>& _participants;
+  Tracker& _tracker;
+  std::mt19937 _rng;
+
+  std::size_t _next_set = 0;
+  std::size_t _next_extend = 0;
+  std::size_t _next_delay = 0;
+  rclcpp::TimerBase::SharedPtr _set_timer;
+  rclcpp::TimerBase::SharedPtr _extend_timer;
+  rclcpp::TimerBase::SharedPtr _delay_timer;
+};
+
+} // anonymous namespace
+
+//==============================================================================
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+
+  // Keep the participant registry of the benchmark away from any real one
+  const std::string log_file =
+    "/tmp/rmf_schedule_benchmark_" + std::to_string(getpid()) + ".yaml";
+
+  Tracker tracker;
+  auto schedule_node = std::make_shared<ScheduleNode>(
+    0,
+    rclcpp::NodeOptions().append_parameter_override(
+      "log_file_location", log_file),
+    ScheduleNode::no_automatic_setup);
+
+  schedule_node->observers.itinerary_applied =
+    [&tracker](auto participant, auto version, auto database_version)
+    {
+      tracker.applied(participant, version, database_version);
+    };
+
+  schedule_node->observers.conflicts_checked =
+    [&tracker](auto database_version)
+    {
+      tracker.checked(database_version);
+    };
+
+  schedule_node->setup(ScheduleNode::QueryMap());
+
+  auto driver_node = std::make_shared<rclcpp::Node>(
+    "rmf_traffic_schedule_benchmark");
+  const auto options = Options::from(*driver_node);
+
+  // The schedule node and the driver each get their own executor thread so
+  // that the load generator does not steal time from the node's callbacks.
+  rclcpp::executors::SingleThreadedExecutor schedule_executor;
+  schedule_executor.add_node(schedule_node);
+  std::thread schedule_thread([&]() { schedule_executor.spin(); });
+
+  rclcpp::executors::SingleThreadedExecutor driver_executor;
+  driver_executor.add_node(driver_node);
+  std::thread driver_thread([&]() { driver_executor.spin(); });
+
+  std::vector<rmf_traffic::schedule::Participant> participants;
+  std::unique_ptr<Driver> driver;
+
+  const auto finish = [&](const int code)
+    {
+      schedule_executor.cancel();
+      driver_executor.cancel();
+      schedule_thread.join();
+      driver_thread.join();
+
+      // Nothing is spinning anymore, so the driver and the participants can
+      // be safely torn down before the context goes away.
+      driver.reset();
+      participants.clear();
+      rclcpp::shutdown();
+      std::remove(log_file.c_str());
+      return code;
+    };
+
+  // Register a query that sees everything, just like a fleet adapter would
+  auto register_query = driver_node->create_client<RegisterQuery>(
+    rmf_traffic_ros2::RegisterQueryServiceName);
+  register_query->wait_for_service();
+  auto query_request = std::make_shared<RegisterQuery::Request>();
+  query_request->query = rmf_traffic_ros2::convert(
+    rmf_traffic::schedule::query_all());
+  auto query_response = register_query->async_send_request(query_request);
+  if (query_response.wait_for(10s) != std::future_status::ready)
+  {
+    RCLCPP_ERROR(driver_node->get_logger(), "Failed to register a query");
+    return finish(1);
+  }
+
+  const auto mirror_sub = driver_node->create_subscription<MirrorUpdate>(
+    rmf_traffic_ros2::QueryUpdateTopicNameBase
+    + std::to_string(query_response.get()->query_id),
+    rclcpp::SystemDefaultsQoS(),
+    [&tracker](const MirrorUpdate::SharedPtr msg)
+    {
+      tracker.mirrored(msg->database_version);
+    });
+
+  // Register the synthetic participants
+  const auto writer = rmf_traffic_ros2::schedule::Writer::make(*driver_node);
+  writer->wait_for_service();
+
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(0.5);
+
+  std::vector<std::future<rmf_traffic::schedule::Participant>> futures;
+  for (std::size_t i = 0; i < options.participants; ++i)
+  {
+    futures.push_back(
+      writer->make_participant(
+        rmf_traffic::schedule::ParticipantDescription(
+          "benchmark_" + std::to_string(i),
+          "schedule_node_benchmark",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          rmf_traffic::Profile{shape})));
+  }
+
+  participants.reserve(futures.size());
+  for (auto& f : futures)
+  {
+    if (f.wait_for(30s) != std::future_status::ready)
+    {
+      RCLCPP_ERROR(
+        driver_node->get_logger(), "Timed out while registering participants");
+      return finish(1);
+    }
+
+    participants.push_back(f.get());
+  }
+
+  RCLCPP_INFO(
+    driver_node->get_logger(),
+    "Registered %lu participants; warming up for %.1fs",
+    participants.size(), options.warmup);
+
+  driver = std::make_unique<Driver>(
+    *driver_node, options, participants, tracker);
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.warmup));
+
+  tracker.recording(true);
+  const auto wall_start = Clock::now();
+  const double cpu_start = cpu_seconds();
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.duration));
+
+  tracker.recording(false);
+  const double wall = std::chrono::duration<double>(
+    Clock::now() - wall_start).count();
+  const double cpu = cpu_seconds() - cpu_start;
+
+  // Give the in-flight changes a moment to be checked and mirrored
+  driver->stop();
+  std::this_thread::sleep_for(1s);
+
+  tracker.print(options, wall, cpu);
+  return finish(0);
+}
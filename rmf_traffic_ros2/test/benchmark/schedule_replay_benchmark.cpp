@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// This benchmark replays a recording made by rmf_traffic_schedule_recorder
+// into a ScheduleNode that runs in-process. It reports the throughput of the
+// node along with how long after each input was due it was
+//   - applied to the schedule (ingest)
+//   - checked for conflicts (conflict)
+//   - received by a mirror through its query update topic (mirror)
+// and how far the replay fell behind the recorded timing (lag).
+//
+// The recording is given as the first argument and every parameter is given
+// through --ros-args, for example
+//
+//   schedule_replay_benchmark site.rmfrec --ros-args -p speed:=10.0
+//
+// A speed of 1.0 replays the recording in real time, and a speed of 0.0 feeds
+// the inputs as fast as the node accepts them. Parameters of the ScheduleNode
+// itself can be passed the same way, except for batch_itinerary_ingestion,
+// because the inputs are fed to the node from the replay thread. Run this on
+// an isolated ROS_DOMAIN_ID so that it does not interfere with a live
+// schedule.
+//
+// Negotiation messages refer to the conflict versions of the recorded node,
+// so they only take effect when the replayed node finds the same conflicts.
+
+#include <rmf_traffic_ros2/schedule/internal_Node.hpp>
+#include <rmf_traffic_ros2/schedule/Query.hpp>
+#include <rmf_traffic_ros2/StandardNames.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ScheduleRecording.hpp"
+
+#include "Samples.hpp"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+using ScheduleNode = rmf_traffic_ros2::schedule::ScheduleNode;
+using Clock = std::chrono::steady_clock;
+using MirrorUpdate = rmf_traffic_msgs::msg::MirrorUpdate;
+using RegisterQuery = rmf_traffic_msgs::srv::RegisterQuery;
+using rmf_traffic_ros2::schedule::RecordedInput;
+using rmf_traffic_ros2::schedule::RecordedMessage;
+
+namespace {
+//==============================================================================
+class Tracker
+{
+public:
+
+  using Version = ScheduleNode::Version;
+
+  void applied(const Version database_version)
+  {
+    _latest_version = database_version;
+  }
+
+  void dispatched(const Clock::time_point due)
+  {
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    ingest.add(now - due);
+    _unchecked.push_back({_latest_version, due});
+    _unmirrored.push_back({_latest_version, due});
+  }
+
+  void checked(const Version database_version)
+  {
+    _drain(_unchecked, database_version, conflict);
+  }
+
+  void mirrored(const Version database_version)
+  {
+    _drain(_unmirrored, database_version, mirror);
+  }
+
+  void print()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ingest.print("ingest");
+    conflict.print("conflict");
+    mirror.print("mirror");
+    lag.print("lag");
+  }
+
+  Samples ingest;
+  Samples conflict;
+  Samples mirror;
+  Samples lag;
+
+private:
+
+  struct Pending
+  {
+    Version database_version;
+    Clock::time_point due;
+  };
+
+  void _drain(
+    std::deque<Pending>& pending,
+    const Version database_version,
+    Samples& samples)
+  {
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    while (!pending.empty()
+      && pending.front().database_version <= database_version)
+    {
+      samples.add(now - pending.front().due);
+      pending.pop_front();
+    }
+  }
+
+  std::mutex _mutex;
+  std::atomic<Version> _latest_version = 0;
+  std::deque<Pending> _unchecked;
+  std::deque<Pending> _unmirrored;
+};
+
+//==============================================================================
+/// Hand a recorded message to the schedule node in the same way that its
+/// subscription would have.
+/// \return true if the message changes an itinerary.
+bool dispatch(ScheduleNode& node, const RecordedMessage& recorded)
+{
+  using namespace rmf_traffic_ros2::schedule;
+  switch (recorded.input)
+  {
+    case RecordedInput::Participants:
+      node.follow_registrar(
+        decode_recorded_message<ScheduleNode::ParticipantsInfo>(recorded));
+      return false;
+    case RecordedInput::ItinerarySet:
+      node.itinerary_set(
+        decode_recorded_message<ScheduleNode::ItinerarySet>(recorded));
+      return true;
+    case RecordedInput::ItineraryExtend:
+      node.itinerary_extend(
+        decode_recorded_message<ScheduleNode::ItineraryExtend>(recorded));
+      return true;
+    case RecordedInput::ItineraryDelay:
+      node.itinerary_delay(
+        decode_recorded_message<ScheduleNode::ItineraryDelay>(recorded));
+      return true;
+    case RecordedInput::ItineraryErase:
+      node.itinerary_erase(
+        decode_recorded_message<ScheduleNode::ItineraryErase>(recorded));
+      return true;
+    case RecordedInput::ItineraryClear:
+      node.itinerary_clear(
+        decode_recorded_message<ScheduleNode::ItineraryClear>(recorded));
+      return true;
+    case RecordedInput::ItineraryBatch:
+      node.itinerary_batch(
+        decode_recorded_message<ScheduleNode::CompactUpdate>(recorded));
+      return true;
+    case RecordedInput::NegotiationAck:
+      node.receive_conclusion_ack(
+        decode_recorded_message<ScheduleNode::ConflictAck>(recorded));
+      return false;
+    case RecordedInput::NegotiationRefusal:
+      node.receive_refusal(
+        decode_recorded_message<ScheduleNode::ConflictRefusal>(recorded));
+      return false;
+    case RecordedInput::NegotiationProposal:
+      node.receive_proposal(
+        decode_recorded_message<ScheduleNode::ConflictProposal>(recorded));
+      return false;
+    case RecordedInput::NegotiationProposalDiff:
+      node.receive_proposal_diff(
+        decode_recorded_message<ScheduleNode::CompactUpdate>(recorded));
+      return false;
+    case RecordedInput::NegotiationRejection:
+      node.receive_rejection(
+        decode_recorded_message<ScheduleNode::ConflictRejection>(recorded));
+      return false;
+    case RecordedInput::NegotiationForfeit:
+      node.receive_forfeit(
+        decode_recorded_message<ScheduleNode::ConflictForfeit>(recorded));
+      return false;
+  }
+
+  std::cerr << "Skipping a record of unknown type ["
+            << static_cast<int>(recorded.input) << "]" << std::endl;
+  return false;
+}
+
+} // anonymous namespace
+
+//==============================================================================
+int main(int argc, char** argv)
+{
+  const auto args = rclcpp::init_and_remove_ros_arguments(argc, argv);
+  if (args.size() < 2)
+  {
+    std::cerr << "You need to specify a recording file!" << std::endl;
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  std::vector<RecordedMessage> recording;
+  try
+  {
+    rmf_traffic_ros2::schedule::ScheduleRecordingReader reader(args[1]);
+    while (auto next = reader.next())
+      recording.push_back(std::move(*next));
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  // Keep the participant registry of the benchmark away from any real one
+  const std::string log_file =
+    "/tmp/rmf_schedule_replay_" + std::to_string(getpid()) + ".yaml";
+
+  Tracker tracker;
+  auto schedule_node = std::make_shared<ScheduleNode>(
+    0,
+    rclcpp::NodeOptions()
+    .append_parameter_override("log_file_location", log_file)
+    .append_parameter_override("batch_itinerary_ingestion", false),
+    ScheduleNode::no_automatic_setup);
+
+  schedule_node->observers.itinerary_applied =
+    [&tracker](auto, auto, auto database_version)
+    {
+      tracker.applied(database_version);
+    };
+
+  schedule_node->observers.conflicts_checked =
+    [&tracker](auto database_version)
+    {
+      tracker.checked(database_version);
+    };
+
+  schedule_node->setup(ScheduleNode::QueryMap());
+
+  auto driver_node = std::make_shared<rclcpp::Node>(
+    "rmf_traffic_schedule_replay");
+  const double speed = driver_node->declare_parameter<double>("speed", 1.0);
+
+  rclcpp::executors::MultiThreadedExecutor schedule_executor;
+  schedule_executor.add_node(schedule_node);
+  std::thread schedule_thread([&]() { schedule_executor.spin(); });
+
+  rclcpp::executors::SingleThreadedExecutor driver_executor;
+  driver_executor.add_node(driver_node);
+  std::thread driver_thread([&]() { driver_executor.spin(); });
+
+  const auto finish = [&](const int code)
+    {
+      schedule_executor.cancel();
+      driver_executor.cancel();
+      schedule_thread.join();
+      driver_thread.join();
+      rclcpp::shutdown();
+      std::remove(log_file.c_str());
+      return code;
+    };
+
+  // Register a query that sees everything, just like a fleet adapter would
+  auto register_query = driver_node->create_client<RegisterQuery>(
+    rmf_traffic_ros2::RegisterQueryServiceName);
+  register_query->wait_for_service();
+  auto query_request = std::make_shared<RegisterQuery::Request>();
+  query_request->query = rmf_traffic_ros2::convert(
+    rmf_traffic::schedule::query_all());
+  auto query_response = register_query->async_send_request(query_request);
+  if (query_response.wait_for(10s) != std::future_status::ready)
+  {
+    RCLCPP_ERROR(driver_node->get_logger(), "Failed to register a query");
+    return finish(1);
+  }
+
+  const auto mirror_sub = driver_node->create_subscription<MirrorUpdate>(
+    rmf_traffic_ros2::QueryUpdateTopicNameBase
+    + std::to_string(query_response.get()->query_id),
+    rclcpp::SystemDefaultsQoS(),
+    [&tracker](const MirrorUpdate::SharedPtr msg)
+    {
+      tracker.mirrored(msg->database_version);
+    });
+
+  RCLCPP_INFO(
+    driver_node->get_logger(),
+    "Replaying %lu inputs at %s",
+    recording.size(),
+    speed > 0.0 ? (std::to_string(speed) + "x").c_str() : "maximum speed");
+
+  std::size_t itinerary_inputs = 0;
+  const auto replay_start = Clock::now();
+  for (const auto& recorded : recording)
+  {
+    auto due = Clock::now();
+    if (speed > 0.0)
+    {
+      due = replay_start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::nano>(
+          static_cast<double>(recorded.time.count()) / speed));
+      std::this_thread::sleep_until(due);
+      tracker.lag.add(Clock::now() - due);
+    }
+
+    try
+    {
+      if (dispatch(*schedule_node, recorded))
+      {
+        ++itinerary_inputs;
+        tracker.dispatched(due);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_WARN(
+        driver_node->get_logger(),
+        "Failed to replay an input: %s", e.what());
+    }
+  }
+
+  const double wall = std::chrono::duration<double>(
+    Clock::now() - replay_start).count();
+
+  // Give the last inputs a moment to be checked and mirrored
+  std::this_thread::sleep_for(1s);
+
+  std::cout << "\nSchedule replay of " << recording.size() << " inputs ("
+            << itinerary_inputs << " itinerary changes) in " << wall << "s\n"
+            << "  throughput: " << recording.size() / wall << " inputs/s\n";
+  tracker.print();
+
+  return finish(0);
+}
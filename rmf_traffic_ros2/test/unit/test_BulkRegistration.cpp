@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/BulkRegistration.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Bulk registration messages survive encoding")
+{
+  BulkRegistrationRequest request;
+  request.request_id = 0x123456789abcdef0;
+  for (const auto& name : {"robot_1", "robot_2", "robot_3"})
+  {
+    rmf_traffic_msgs::msg::ParticipantDescription description;
+    description.name = name;
+    description.owner = "test_BulkRegistration";
+    request.descriptions.push_back(description);
+  }
+
+  const auto decoded_request =
+    decode_bulk_registration_request(encode_bulk_registration_request(request));
+  CHECK(decoded_request.request_id == request.request_id);
+  CHECK(decoded_request.descriptions == request.descriptions);
+
+  BulkRegistrationResponse response;
+  response.request_id = request.request_id;
+  response.registrations.resize(2);
+  response.registrations[0].participant_id = 4;
+  response.registrations[0].last_itinerary_version = 10;
+  response.registrations[0].last_route_id = 2;
+  response.registrations[1].error = "Owner mismatch";
+
+  const auto buffer = encode_bulk_registration_response(response);
+  const auto decoded_response = decode_bulk_registration_response(buffer);
+  CHECK(decoded_response.request_id == response.request_id);
+  CHECK(decoded_response.registrations == response.registrations);
+
+  // A response is not a valid request
+  CHECK_THROWS_AS(
+    decode_bulk_registration_request(buffer), BulkRegistrationError);
+
+  auto truncated = buffer;
+  truncated.resize(buffer.size() - 1);
+  CHECK_THROWS_AS(
+    decode_bulk_registration_response(truncated), BulkRegistrationError);
+}
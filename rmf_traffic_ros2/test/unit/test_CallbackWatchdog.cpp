@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include <rmf_traffic_ros2/CallbackWatchdog.hpp>
+
+using namespace rmf_traffic_ros2;
+using namespace std::chrono_literals;
+
+//==============================================================================
+SCENARIO("Callback watchdog reports the worst offenders")
+{
+  const auto metrics = std::make_shared<Metrics>();
+  CallbackWatchdog watchdog(100ms, metrics);
+
+  watchdog.record("subscription /fleet_states", 2ms);
+  watchdog.record("subscription /fleet_states", 250ms);
+  watchdog.record("timer 0x1", 50ms);
+  watchdog.record("job FindPath", 1s);
+  watchdog.record("service /register_participant", 30us);
+
+  const auto report = watchdog.take_report(2);
+  CHECK(report.count == 5);
+  CHECK(report.slow == 2);
+  CHECK(report.slow_threshold == 100ms);
+
+  REQUIRE(report.worst.size() == 2);
+  CHECK(report.worst[0].source == "job FindPath");
+  CHECK(report.worst[0].count == 1);
+  CHECK(report.worst[1].source == "subscription /fleet_states");
+  CHECK(report.worst[1].count == 2);
+  CHECK(report.worst[1].slow == 1);
+  CHECK(report.worst[1].total == 252ms);
+  CHECK(report.worst[1].max == 250ms);
+
+  const auto& histogram = report.histogram;
+  REQUIRE(histogram.counts.size() == histogram.bounds.size() + 1);
+  CHECK(histogram.count == 5);
+  CHECK(histogram.counts[0] == 1);
+  CHECK(histogram.sum == Approx(1.30203));
+
+  const auto text = CallbackWatchdog::format(report);
+  CHECK(text.find("job FindPath") != std::string::npos);
+  CHECK(text.find("timer 0x1") == std::string::npos);
+
+  // The metrics keep counting across reports
+  CHECK(metrics->counter("rmf_slow_callbacks", "")->value() == 2);
+
+  WHEN("The next report is taken")
+  {
+    watchdog.record("timer 0x1", 1ms);
+    const auto next = watchdog.take_report();
+    CHECK(next.count == 1);
+    CHECK(next.slow == 0);
+    REQUIRE(next.worst.size() == 1);
+    CHECK(next.worst[0].source == "timer 0x1");
+    CHECK(next.histogram.count == 1);
+  }
+}
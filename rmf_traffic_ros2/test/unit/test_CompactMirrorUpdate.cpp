@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic_ros2/schedule/Patch.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/CompactMirrorUpdate.hpp"
+
+using namespace std::chrono_literals;
+using rmf_traffic_ros2::schedule::CompactDecodeError;
+using rmf_traffic_ros2::schedule::decode_compact_mirror_update;
+using rmf_traffic_ros2::schedule::encode_compact_mirror_update;
+
+//==============================================================================
+SCENARIO("Compact mirror updates survive a round trip")
+{
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(0.5);
+
+  rmf_traffic::schedule::Database database;
+  const auto id = database.register_participant(
+    rmf_traffic::schedule::ParticipantDescription(
+      "participant",
+      "test_CompactMirrorUpdate",
+      rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+      rmf_traffic::Profile{shape})).id();
+
+  const auto start = rmf_traffic::Time(1234567891s);
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {1.23456, -7.5, 0.5}, {0.5, 0.0, 0.0});
+  trajectory.insert(start + 2500ms, {2.5, -7.5, 3.1}, {0.0, -0.25, 0.1});
+  trajectory.insert(start + 10s, {-20.0, 40.0, -3.1}, {0.0, 0.0, 0.0});
+  database.set(
+    id,
+    {
+      {0, std::make_shared<rmf_traffic::Route>("L1", trajectory)},
+      {1, std::make_shared<rmf_traffic::Route>("L2", trajectory)}
+    },
+    0);
+
+  const auto query = rmf_traffic::schedule::query_all();
+  const auto patch = database.changes(query, std::nullopt);
+  const auto buffer = encode_compact_mirror_update(
+    3, database.latest_version(), patch, true);
+
+  const auto msg = decode_compact_mirror_update(buffer);
+  CHECK(msg.node_version == 3);
+  CHECK(msg.database_version == database.latest_version());
+  CHECK(msg.is_remedial_update);
+
+  const auto decoded = rmf_traffic_ros2::convert(msg.patch);
+  CHECK(decoded.latest_version() == patch.latest_version());
+  CHECK(decoded.base_version() == patch.base_version());
+  REQUIRE(decoded.size() == 1);
+
+  const auto& participant = *decoded.begin();
+  CHECK(participant.participant_id() == id);
+  const auto& items = participant.additions().items();
+  REQUIRE(items.size() == 2);
+  CHECK(items[1].route->map() == "L2");
+
+  const auto& decoded_trajectory = items[0].route->trajectory();
+  REQUIRE(decoded_trajectory.size() == trajectory.size());
+  auto expected = trajectory.begin();
+  for (const auto& wp : decoded_trajectory)
+  {
+    CHECK(wp.time() == expected->time());
+    CHECK((wp.position() - expected->position()).norm() < 1e-3);
+    CHECK((wp.velocity() - expected->velocity()).norm() < 1e-3);
+    ++expected;
+  }
+
+  // Every prefix of the buffer is malformed and must be rejected
+  for (std::size_t n = 0; n < buffer.size(); ++n)
+  {
+    const std::vector<uint8_t> truncated(buffer.begin(), buffer.begin() + n);
+    CHECK_THROWS_AS(
+      decode_compact_mirror_update(truncated), CompactDecodeError);
+  }
+}
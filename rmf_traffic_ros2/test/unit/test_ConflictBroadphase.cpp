@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ConflictBroadphase.hpp"
+
+using namespace std::chrono_literals;
+using rmf_traffic_ros2::schedule::ConflictBroadphase;
+
+namespace {
+//==============================================================================
+rmf_traffic::Trajectory make_line(
+  const rmf_traffic::Time start,
+  const Eigen::Vector2d p0,
+  const Eigen::Vector2d p1,
+  const rmf_traffic::Duration duration)
+{
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {p0.x(), p0.y(), 0.0}, Eigen::Vector3d::Zero());
+  trajectory.insert(
+    start + duration, {p1.x(), p1.y(), 0.0}, Eigen::Vector3d::Zero());
+  return trajectory;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Broadphase sweeps trajectories into time buckets")
+{
+  const auto start = rmf_traffic::Time(100s);
+  const auto trajectory = make_line(start, {0, 0}, {10, 0}, 25s);
+
+  const auto slices = ConflictBroadphase::sweep(trajectory, 1.0, 10s);
+  REQUIRE(slices.size() == 3);
+  CHECK(slices[0].bucket == 10);
+  CHECK(slices[2].bucket == 12);
+
+  for (const auto& slice : slices)
+  {
+    CHECK(slice.box.min().x() == Approx(-1.0));
+    CHECK(slice.box.max().x() == Approx(11.0));
+    CHECK(slice.box.min().y() == Approx(-1.0));
+    CHECK(slice.box.max().y() == Approx(1.0));
+  }
+
+  CHECK(ConflictBroadphase::sweep(rmf_traffic::Trajectory(), 1.0, 10s).empty());
+}
+
+//==============================================================================
+SCENARIO("Broadphase only yields overlapping routes")
+{
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(0.5);
+
+  const rmf_traffic::Profile profile{shape};
+  rmf_traffic::schedule::Database database;
+  const auto make_participant = [&](const std::string& name)
+    {
+      return database.register_participant(
+        rmf_traffic::schedule::ParticipantDescription(
+          name,
+          "test_ConflictBroadphase",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          profile)).id();
+    };
+
+  const auto near_id = make_participant("near");
+  const auto far_id = make_participant("far");
+  const auto later_id = make_participant("later");
+  const auto other_map_id = make_participant("other map");
+
+  const auto start = rmf_traffic::Time(0s);
+  const auto set = [&](
+    const rmf_traffic::schedule::ParticipantId id,
+    const std::string& map,
+    rmf_traffic::Trajectory trajectory)
+    {
+      database.set(
+        id,
+        {{0, std::make_shared<rmf_traffic::Route>(map, std::move(trajectory))}},
+        0);
+    };
+
+  set(near_id, "L1", make_line(start, {0, 0.8}, {10, 0.8}, 20s));
+  set(far_id, "L1", make_line(start, {0, 50}, {10, 50}, 20s));
+  set(later_id, "L1", make_line(start + 5min, {0, 0}, {10, 0}, 20s));
+  set(other_map_id, "L2", make_line(start, {0, 0}, {10, 0}, 20s));
+
+  ConflictBroadphase broadphase(10s);
+  broadphase.rebuild(database);
+  CHECK(broadphase.size() > 0);
+
+  const rmf_traffic::Route change{"L1", make_line(start, {0, 0}, {10, 0}, 20s)};
+  const auto candidates = broadphase.candidates(far_id, profile, change);
+  REQUIRE(candidates.size() == 1);
+  CHECK(candidates.front().participant == near_id);
+
+  // A participant is never a candidate against itself
+  CHECK(broadphase.candidates(near_id, profile, change).empty());
+
+  broadphase.erase(near_id);
+  CHECK(broadphase.candidates(far_id, profile, change).empty());
+
+  broadphase.update(near_id, database);
+  CHECK(broadphase.candidates(far_id, profile, change).size() == 1);
+}
+
+//==============================================================================
+SCENARIO("Stationary trajectories get a point test")
+{
+  const auto start = rmf_traffic::Time(100s);
+  const auto waiting = make_line(start, {5, 5}, {5, 5}, 30s);
+  const auto moving = make_line(start, {0, 0}, {10, 0}, 10s);
+
+  const auto point = ConflictBroadphase::stationary_point(waiting);
+  REQUIRE(point.has_value());
+  CHECK(point->x() == Approx(5.0));
+  CHECK(point->y() == Approx(5.0));
+  CHECK_FALSE(ConflictBroadphase::stationary_point(moving).has_value());
+
+  // The moving trajectory passes 5m below the waiting point
+  CHECK_FALSE(ConflictBroadphase::might_reach(
+      moving, *point, 1.0, start, start + 30s));
+  CHECK(ConflictBroadphase::might_reach(
+      moving, *point, 6.0, start, start + 30s));
+
+  // Only the part of the trajectory within the time range counts
+  const auto crossing = make_line(start + 20s, {5, 0}, {5, 10}, 10s);
+  CHECK(ConflictBroadphase::might_reach(
+      crossing, *point, 1.0, start, start + 30s));
+  CHECK_FALSE(ConflictBroadphase::might_reach(
+      crossing, *point, 1.0, start, start + 10s));
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ConflictCache.hpp"
+
+using namespace std::chrono_literals;
+using rmf_traffic_ros2::schedule::ConflictCache;
+
+namespace {
+//==============================================================================
+rmf_traffic::ConstRoutePtr make_route(const double y)
+{
+  const auto start = rmf_traffic::Time(100s);
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {0.0, y, 0.0}, Eigen::Vector3d::Zero());
+  trajectory.insert(start + 10s, {10.0, y, 0.0}, Eigen::Vector3d::Zero());
+  return std::make_shared<const rmf_traffic::Route>("L1", trajectory);
+}
+
+//==============================================================================
+ConflictCache::Side make_side(
+  const ConflictCache::ParticipantId participant,
+  rmf_traffic::ConstRoutePtr route)
+{
+  const auto fingerprint = ConflictCache::fingerprint(*route);
+  return {participant, std::move(route), fingerprint};
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Conflict cache hits, misses, and invalidation")
+{
+  ConflictCache cache(2);
+  const auto a = make_side(1, make_route(0.0));
+  const auto b = make_side(2, make_route(5.0));
+
+  CHECK_FALSE(cache.find(a, b).has_value());
+
+  cache.insert(a, b, true);
+  CHECK(cache.size() == 1);
+
+  WHEN("The same pair is looked up")
+  {
+    CHECK(cache.find(a, b) == std::optional<bool>(true));
+    CHECK(cache.find(b, a) == std::optional<bool>(true));
+
+    // A route that was sent again without changing should still hit
+    const auto a_again = make_side(1, make_route(0.0));
+    CHECK(a_again.route != a.route);
+    CHECK(cache.find(a_again, b) == std::optional<bool>(true));
+  }
+
+  WHEN("One of the routes has changed")
+  {
+    CHECK_FALSE(cache.find(make_side(1, make_route(1.0)), b).has_value());
+    CHECK_FALSE(cache.find(make_side(3, make_route(0.0)), b).has_value());
+  }
+
+  WHEN("A different route collides with the fingerprint of a cached route")
+  {
+    auto collision = make_side(1, make_route(1.0));
+    collision.fingerprint = a.fingerprint;
+    CHECK_FALSE(cache.find(collision, b).has_value());
+
+    cache.insert(collision, b, false);
+    CHECK(cache.size() == 1);
+    CHECK(cache.find(collision, b) == std::optional<bool>(false));
+    CHECK_FALSE(cache.find(a, b).has_value());
+  }
+
+  WHEN("The cache is cleared")
+  {
+    cache.clear();
+    CHECK(cache.size() == 0);
+    CHECK_FALSE(cache.find(a, b).has_value());
+  }
+
+  WHEN("Cycles pass")
+  {
+    const auto c = make_side(3, make_route(9.0));
+    cache.insert(a, c, false);
+
+    cache.next_cycle();
+    cache.next_cycle();
+    CHECK(cache.size() == 2);
+
+    // Using a verdict keeps it alive while the idle one gets dropped
+    CHECK(cache.find(a, c) == std::optional<bool>(false));
+    cache.next_cycle();
+    CHECK(cache.size() == 1);
+    CHECK_FALSE(cache.find(a, b).has_value());
+    CHECK(cache.find(a, c) == std::optional<bool>(false));
+  }
+}
+
+//==============================================================================
+SCENARIO("Conflict cache compares route contents")
+{
+  const auto route = make_route(0.0);
+  CHECK(ConflictCache::same_route(*route, *route));
+  CHECK(ConflictCache::same_route(*route, *make_route(0.0)));
+  CHECK_FALSE(ConflictCache::same_route(*route, *make_route(0.5)));
+
+  const rmf_traffic::Route other_map("L2", route->trajectory());
+  CHECK_FALSE(ConflictCache::same_route(*route, other_map));
+
+  auto longer = route->trajectory();
+  longer.insert(
+    *longer.finish_time() + 5s, {10.0, 0.0, 0.0}, Eigen::Vector3d::Zero());
+  CHECK_FALSE(
+    ConflictCache::same_route(*route, rmf_traffic::Route("L1", longer)));
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_traffic_ros2/Route.hpp>
+#include <rmf_traffic_ros2/Trajectory.hpp>
+#include <rmf_traffic_ros2/schedule/Itinerary.hpp>
+#include <rmf_utils/catch.hpp>
+
+using namespace std::chrono_literals;
+
+namespace {
+//==============================================================================
+rmf_traffic::Trajectory make_trajectory(std::size_t waypoints)
+{
+  rmf_traffic::Trajectory trajectory;
+  for (std::size_t i = 0; i < waypoints; ++i)
+  {
+    trajectory.insert(
+      rmf_traffic::Time(std::chrono::seconds(i)),
+      {static_cast<double>(i), 0.0, 0.0},
+      {1.0, 0.0, 0.0});
+  }
+
+  return trajectory;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Converting into a reused message matches a fresh conversion")
+{
+  rmf_traffic_msgs::msg::Trajectory trajectory_msg;
+  rmf_traffic_ros2::convert(make_trajectory(10), trajectory_msg);
+  REQUIRE(trajectory_msg.waypoints.size() == 10);
+
+  const auto shorter = make_trajectory(4);
+  rmf_traffic_ros2::convert(shorter, trajectory_msg);
+  CHECK(trajectory_msg == rmf_traffic_ros2::convert(shorter));
+  CHECK(trajectory_msg.waypoints.capacity() >= 10);
+
+  const rmf_traffic::schedule::Itinerary itinerary = {
+    std::make_shared<rmf_traffic::Route>("L1", make_trajectory(3)),
+    std::make_shared<rmf_traffic::Route>("L2", make_trajectory(6))
+  };
+
+  std::vector<rmf_traffic_msgs::msg::Route> routes;
+  rmf_traffic_ros2::convert(
+    rmf_traffic::schedule::Itinerary{
+      std::make_shared<rmf_traffic::Route>("L3", make_trajectory(8))},
+    routes);
+  REQUIRE(routes.size() == 1);
+
+  rmf_traffic_ros2::convert(itinerary, routes);
+  CHECK(routes == rmf_traffic_ros2::convert(itinerary));
+}
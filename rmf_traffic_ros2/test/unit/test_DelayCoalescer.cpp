@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/DelayCoalescer.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+
+namespace {
+//==============================================================================
+DelayCoalescer::Delay make_delay(
+  uint64_t participant, int64_t delay, uint64_t version)
+{
+  DelayCoalescer::Delay msg;
+  msg.participant = participant;
+  msg.delay = delay;
+  msg.itinerary_version = version;
+  return msg;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Consecutive delays of a participant are merged")
+{
+  DelayCoalescer coalescer;
+  CHECK_FALSE(coalescer.take(1).has_value());
+
+  CHECK_FALSE(coalescer.add(make_delay(1, 10, 4)).has_value());
+  CHECK_FALSE(coalescer.add(make_delay(1, 20, 5)).has_value());
+  CHECK_FALSE(coalescer.add(make_delay(1, 30, 6)).has_value());
+  CHECK_FALSE(coalescer.add(make_delay(2, 5, 9)).has_value());
+
+  const auto merged = coalescer.take(1);
+  REQUIRE(merged.has_value());
+  const auto* coalesced = std::get_if<CoalescedDelay>(&*merged);
+  REQUIRE(coalesced);
+  CHECK(coalesced->participant == 1);
+  CHECK(coalesced->delay == 60);
+  CHECK(coalesced->itinerary_version == 4);
+  CHECK(coalesced->last_version == 6);
+  CHECK_FALSE(coalescer.take(1).has_value());
+
+  WHEN("A delay does not follow the one that is held")
+  {
+    const auto previous = coalescer.add(make_delay(2, 7, 3));
+    REQUIRE(previous.has_value());
+
+    // A single delay is passed along unchanged
+    const auto* single = std::get_if<DelayCoalescer::Delay>(&*previous);
+    REQUIRE(single);
+    CHECK(*single == make_delay(2, 5, 9));
+
+    const auto rest = coalescer.take_all();
+    REQUIRE(rest.size() == 1);
+    CHECK(std::get<DelayCoalescer::Delay>(rest.front()) == make_delay(2, 7, 3));
+    CHECK(coalescer.take_all().empty());
+  }
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/blockade/HeartbeatChecks.hpp"
+
+#include <algorithm>
+
+using rmf_traffic_ros2::blockade::HeartbeatChecks;
+using StatusMsg = HeartbeatChecks::StatusMsg;
+using ParticipantSet = std::unordered_set<HeartbeatChecks::ParticipantId>;
+
+namespace {
+//==============================================================================
+StatusMsg make_status(
+  const HeartbeatChecks::ParticipantId participant,
+  const uint64_t reservation,
+  const std::optional<uint64_t> last_ready,
+  const uint64_t last_reached)
+{
+  StatusMsg status;
+  status.participant = participant;
+  status.reservation = reservation;
+  status.any_ready = last_ready.has_value();
+  status.last_ready = last_ready.value_or(0);
+  status.last_reached = last_reached;
+  return status;
+}
+
+//==============================================================================
+bool checks_status(
+  const HeartbeatChecks::Checks& checks,
+  const HeartbeatChecks::ParticipantId participant)
+{
+  return std::any_of(
+    checks.reported.begin(), checks.reported.end(),
+    [&](const StatusMsg& s) { return s.participant == participant; });
+}
+
+//==============================================================================
+bool checks_unreported(
+  const HeartbeatChecks::Checks& checks,
+  const HeartbeatChecks::ParticipantId participant)
+{
+  return std::count(
+    checks.unreported.begin(), checks.unreported.end(), participant) == 1;
+}
+
+const auto everyone = [](HeartbeatChecks::ParticipantId) { return true; };
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Blockade heartbeats only check the participants that need it")
+{
+  HeartbeatChecks heartbeats(1);
+  heartbeats.add(1);
+  heartbeats.add(2);
+  CHECK(heartbeats.tracks(1));
+  CHECK_FALSE(heartbeats.tracks(3));
+
+  // What the moderator believes about participant 1. The set that moves it to
+  // reservation 2 and the ready for checkpoint 3 never reach the moderator.
+  const auto moderator_view = make_status(1, 1, std::nullopt, 0);
+  const auto other = make_status(2, 5, 2, 1);
+  const std::vector<StatusMsg> statuses = {moderator_view, other};
+
+  // The first heartbeat checks everything that it reports
+  auto checks = heartbeats.next(0, statuses, {}, everyone);
+  CHECK(checks.reported.size() == 2);
+  CHECK(checks.unreported.empty());
+
+  // A heartbeat that repeats the same statuses needs no checks
+  checks = heartbeats.next(0, statuses, {}, everyone);
+  CHECK(checks.reported.empty());
+  CHECK(checks.unreported.empty());
+
+  WHEN("A participant changes on its own side")
+  {
+    checks = heartbeats.next(0, statuses, {1}, everyone);
+
+    THEN("Its next heartbeat checks it even though its status is the same")
+    {
+      CHECK(checks_status(checks, 1));
+      CHECK_FALSE(checks_status(checks, 2));
+    }
+  }
+
+  WHEN("The moderator reports a different status")
+  {
+    const std::vector<StatusMsg> changed = {
+      make_status(1, 1, 0, 0), other};
+    checks = heartbeats.next(0, changed, {}, everyone);
+
+    THEN("The participant gets checked right away")
+    {
+      CHECK(checks_status(checks, 1));
+      CHECK_FALSE(checks_status(checks, 2));
+    }
+  }
+
+  WHEN("The correction of a dropped set or ready is dropped as well")
+  {
+    // The participant noticed the mismatch on the heartbeat where it was
+    // dirty, but the resent set and ready never arrive either, so the
+    // moderator keeps reporting the same status and nothing is dirty anymore.
+    heartbeats.next(0, statuses, {1}, everyone);
+
+    std::size_t heartbeats_until_check = 0;
+    bool checked = false;
+    while (!checked
+      && heartbeats_until_check < 2*HeartbeatChecks::FullCheckInterval)
+    {
+      ++heartbeats_until_check;
+      checked = checks_status(heartbeats.next(0, statuses, {}, everyone), 1);
+    }
+
+    THEN("It is checked again within the full check interval")
+    {
+      CHECK(checked);
+      CHECK(heartbeats_until_check <= HeartbeatChecks::FullCheckInterval);
+    }
+  }
+
+  WHEN("A participant drops out of the heartbeat")
+  {
+    const std::vector<StatusMsg> without_1 = {other};
+    checks = heartbeats.next(0, without_1, {}, everyone);
+    CHECK(checks_unreported(checks, 1));
+    CHECK_FALSE(checks_unreported(checks, 2));
+
+    checks = heartbeats.next(0, without_1, {}, everyone);
+    CHECK(checks.unreported.empty());
+
+    THEN("It is checked again within the full check interval")
+    {
+      std::size_t heartbeats_until_check = 0;
+      bool checked = false;
+      while (!checked
+        && heartbeats_until_check < 2*HeartbeatChecks::FullCheckInterval)
+      {
+        ++heartbeats_until_check;
+        checked = checks_unreported(
+          heartbeats.next(0, without_1, {}, everyone), 1);
+      }
+
+      CHECK(checked);
+      CHECK(heartbeats_until_check < HeartbeatChecks::FullCheckInterval);
+    }
+  }
+
+  WHEN("A check could not be carried out")
+  {
+    heartbeats.retry(1);
+    checks = heartbeats.next(0, statuses, {}, everyone);
+
+    THEN("The participant is checked on the next heartbeat")
+    {
+      CHECK(checks_status(checks, 1));
+      CHECK_FALSE(checks_status(checks, 2));
+    }
+  }
+
+  WHEN("A participant is no longer tracked")
+  {
+    heartbeats.remove(1);
+    heartbeats.add(3);
+    const std::vector<StatusMsg> reported = {
+      make_status(1, 2, 0, 0), make_status(3, 1, std::nullopt, 0)};
+    checks = heartbeats.next(0, reported, {}, everyone);
+
+    THEN("Its statuses are ignored")
+    {
+      CHECK_FALSE(checks_status(checks, 1));
+      CHECK(checks_status(checks, 3));
+    }
+  }
+}
+
+//==============================================================================
+SCENARIO("Each blockade shard keeps its own full check interval")
+{
+  HeartbeatChecks heartbeats(2);
+  heartbeats.add(1);
+  heartbeats.add(2);
+
+  const auto in_shard = [](const std::size_t shard)
+    {
+      return [shard](HeartbeatChecks::ParticipantId id)
+        {
+          return static_cast<std::size_t>(id - 1) == shard;
+        };
+    };
+
+  const std::vector<StatusMsg> shard_0 = {make_status(1, 1, 0, 0)};
+  const std::vector<StatusMsg> shard_1 = {make_status(2, 1, 0, 0)};
+
+  heartbeats.next(0, shard_0, {}, in_shard(0));
+  heartbeats.next(1, shard_1, {}, in_shard(1));
+
+  // Many heartbeats from shard 1 do not bring on a full check of shard 0
+  for (std::size_t i = 0; i < 3*HeartbeatChecks::FullCheckInterval; ++i)
+  {
+    const auto checks = heartbeats.next(1, shard_1, {}, in_shard(1));
+    CHECK_FALSE(checks_status(checks, 1));
+    CHECK_FALSE(checks_unreported(checks, 1));
+  }
+
+  // Shard 0 still gets its full check on its own schedule
+  std::size_t heartbeats_until_check = 0;
+  bool checked = false;
+  while (!checked
+    && heartbeats_until_check < 2*HeartbeatChecks::FullCheckInterval)
+  {
+    ++heartbeats_until_check;
+    const auto checks = heartbeats.next(0, shard_0, {}, in_shard(0));
+    CHECK_FALSE(checks_status(checks, 2));
+    checked = checks_status(checks, 1);
+  }
+
+  CHECK(checked);
+  CHECK(heartbeats_until_check < HeartbeatChecks::FullCheckInterval);
+}
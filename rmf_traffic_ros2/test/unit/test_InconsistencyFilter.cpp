@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/InconsistencyFilter.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Inconsistency filters only name the owned participants")
+{
+  CHECK_FALSE(inconsistency_filter({}).has_value());
+
+  const auto single = inconsistency_filter({7});
+  REQUIRE(single.has_value());
+  CHECK(*single == "participant = 7");
+
+  // The order and duplicates of the participants do not change the filter
+  const auto several = inconsistency_filter({12, 3, 12, 5});
+  REQUIRE(several.has_value());
+  CHECK(*several == "participant = 3 OR participant = 5 OR participant = 12");
+  CHECK(inconsistency_filter({5, 3, 12}) == several);
+
+  WHEN("There are too many participants to name")
+  {
+    std::vector<rmf_traffic::schedule::ParticipantId> participants;
+    for (std::size_t i = 0; i < MaxFilteredInconsistencyParticipants; ++i)
+      participants.push_back(i);
+
+    CHECK(inconsistency_filter(participants).has_value());
+
+    participants.push_back(MaxFilteredInconsistencyParticipants);
+    CHECK_FALSE(inconsistency_filter(participants).has_value());
+  }
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/IngressQuota.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+using namespace std::chrono_literals;
+
+namespace {
+//==============================================================================
+ItineraryMsg make_set(uint64_t participant, uint64_t version)
+{
+  rmf_traffic_msgs::msg::ItinerarySet set;
+  set.participant = participant;
+  set.itinerary_version = version;
+  return set;
+}
+
+//==============================================================================
+ItineraryMsg make_delay(uint64_t participant, uint64_t version)
+{
+  rmf_traffic_msgs::msg::ItineraryDelay delay;
+  delay.participant = participant;
+  delay.delay = 1000;
+  delay.itinerary_version = version;
+  return delay;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Writes beyond the quota of a participant are deferred")
+{
+  IngressQuota quota({2.0, 2.0}, {});
+  const auto start = IngressQuota::Clock::now();
+
+  CHECK(quota.admit(1, "fleet", start));
+  CHECK(quota.admit(1, "fleet", start));
+  CHECK_FALSE(quota.admit(1, "fleet", start));
+
+  // Other participants are not affected
+  CHECK(quota.admit(2, "fleet", start));
+
+  CHECK(quota.defer(make_delay(1, 2), "fleet") == 0);
+  CHECK(quota.throttled(1));
+
+  // Even with tokens, writes must queue up behind the deferred ones
+  CHECK_FALSE(quota.admit(1, "fleet", start + 10s));
+  CHECK(quota.defer(make_delay(1, 3), "fleet") == 0);
+  CHECK(quota.deferred() == 2);
+
+  CHECK(quota.release(start).empty());
+
+  const auto released = quota.release(start + 1s);
+  REQUIRE(released.size() == 2);
+  CHECK(std::get<rmf_traffic_msgs::msg::ItineraryDelay>(
+      released[0]).itinerary_version == 2);
+  CHECK(std::get<rmf_traffic_msgs::msg::ItineraryDelay>(
+      released[1]).itinerary_version == 3);
+  CHECK_FALSE(quota.throttled(1));
+  CHECK(quota.deferred() == 0);
+}
+
+//==============================================================================
+SCENARIO("A fleet shares one quota among its participants")
+{
+  IngressQuota quota({}, {1.0, 2.0});
+  const auto start = IngressQuota::Clock::now();
+
+  CHECK(quota.admit(1, "a", start));
+  CHECK(quota.admit(2, "a", start));
+  CHECK_FALSE(quota.admit(3, "a", start));
+  CHECK(quota.admit(3, "b", start));
+
+  quota.defer(make_delay(3, 0), "a");
+  CHECK(quota.release(start + 1s).size() == 1);
+}
+
+//==============================================================================
+SCENARIO("A deferred set replaces the writes deferred before it")
+{
+  IngressQuota quota({1.0, 1.0}, {});
+  const auto start = IngressQuota::Clock::now();
+  CHECK(quota.admit(1, "fleet", start));
+
+  quota.defer(make_delay(1, 1), "fleet");
+  quota.defer(make_set(1, 2), "fleet");
+  quota.defer(make_delay(1, 3), "fleet");
+  quota.defer(make_delay(1, 5), "fleet");
+  CHECK(quota.defer(make_set(1, 6), "fleet") == 3);
+  CHECK(quota.defer(make_delay(1, 7), "fleet") == 0);
+
+  // A late arrival of an older version stays deferred behind the set
+  const auto replaced = quota.defer(make_set(1, 4), "fleet");
+  CHECK(replaced == 0);
+
+  const auto released = quota.release(start + 1s);
+  REQUIRE(released.size() == 5);
+
+  // Versions 1 through 3 and version 5 are kept as empty delays
+  const auto& first = std::get<CoalescedDelay>(released[0]);
+  CHECK(first.itinerary_version == 1);
+  CHECK(first.last_version == 3);
+  CHECK(first.delay == 0);
+
+  const auto& second = std::get<CoalescedDelay>(released[1]);
+  CHECK(second.itinerary_version == 5);
+  CHECK(second.last_version == 5);
+
+  CHECK(std::get<rmf_traffic_msgs::msg::ItinerarySet>(
+      released[2]).itinerary_version == 6);
+  CHECK(std::get<rmf_traffic_msgs::msg::ItineraryDelay>(
+      released[3]).itinerary_version == 7);
+  CHECK(std::get<rmf_traffic_msgs::msg::ItinerarySet>(
+      released[4]).itinerary_version == 4);
+}
+
+//==============================================================================
+SCENARIO("Without limits every write is admitted")
+{
+  IngressQuota quota({}, {});
+  const auto now = IngressQuota::Clock::now();
+  for (std::size_t i = 0; i < 1000; ++i)
+    CHECK(quota.admit(1, "fleet", now));
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_traffic_ros2/Route.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ItineraryBatch.hpp"
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Itinerary batches keep every message of every participant")
+{
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(rmf_traffic::Time(10s), {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+  trajectory.insert(rmf_traffic::Time(20s), {5.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+
+  rmf_traffic_msgs::msg::ItinerarySet set;
+  set.participant = 3;
+  set.itinerary_version = 7;
+  set.itinerary.resize(1);
+  set.itinerary[0].id = 2;
+  set.itinerary[0].route =
+    rmf_traffic_ros2::convert(rmf_traffic::Route("L1", trajectory));
+
+  rmf_traffic_msgs::msg::ItineraryDelay delay;
+  delay.participant = 4;
+  delay.itinerary_version = 1;
+  delay.delay = std::chrono::nanoseconds(5s).count();
+
+  rmf_traffic_msgs::msg::ItineraryErase erase;
+  erase.participant = 3;
+  erase.itinerary_version = 8;
+  erase.routes = {2};
+
+  rmf_traffic_msgs::msg::ItineraryClear clear;
+  clear.participant = 5;
+  clear.itinerary_version = 12;
+
+  CoalescedDelay coalesced;
+  coalesced.participant = 4;
+  coalesced.delay = -std::chrono::nanoseconds(2s).count();
+  coalesced.itinerary_version = 2;
+  coalesced.last_version = 6;
+
+  const std::vector<ItineraryMsg> msgs = {set, delay, erase, clear, coalesced};
+  const auto buffer = encode_itinerary_batch(msgs);
+  const auto decoded = decode_itinerary_batch(buffer);
+  REQUIRE(decoded.size() == msgs.size());
+  CHECK(decoded == msgs);
+
+  CHECK(decode_itinerary_batch(encode_itinerary_batch({})).empty());
+
+  GIVEN("A batch that was cut short")
+  {
+    auto truncated = buffer;
+    truncated.resize(buffer.size() - 3);
+    CHECK_THROWS_AS(decode_itinerary_batch(truncated), ItineraryBatchError);
+  }
+
+  GIVEN("A buffer that is not an itinerary batch")
+  {
+    auto wrong = buffer;
+    wrong[2] = 'X';
+    CHECK_THROWS_AS(decode_itinerary_batch(wrong), ItineraryBatchError);
+  }
+}
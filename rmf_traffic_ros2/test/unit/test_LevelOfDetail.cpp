@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/LevelOfDetail.hpp"
+
+#include <cmath>
+
+using rmf_traffic_ros2::schedule::decimate;
+
+namespace {
+//==============================================================================
+rmf_traffic::Trajectory make_trajectory(
+  const std::vector<Eigen::Vector3d>& positions)
+{
+  const auto start = rmf_traffic::Time(std::chrono::seconds(100));
+  rmf_traffic::Trajectory trajectory;
+  for (std::size_t i = 0; i < positions.size(); ++i)
+  {
+    trajectory.insert(
+      start + std::chrono::seconds(i),
+      positions[i],
+      Eigen::Vector3d::Zero());
+  }
+
+  return trajectory;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Decimation drops waypoints along straight lines")
+{
+  std::vector<Eigen::Vector3d> positions;
+  for (std::size_t i = 0; i <= 10; ++i)
+    positions.push_back({static_cast<double>(i), 0.0, 0.0});
+
+  for (std::size_t i = 1; i <= 10; ++i)
+    positions.push_back({10.0, static_cast<double>(i), 0.0});
+
+  const auto trajectory = make_trajectory(positions);
+  const auto decimated = decimate(trajectory, 0.01);
+  REQUIRE(decimated.size() == 3);
+  CHECK((decimated[0].position() - positions.front()).norm() == Approx(0.0));
+  CHECK((decimated[1].position() - positions[10]).norm() == Approx(0.0));
+  CHECK((decimated[2].position() - positions.back()).norm() == Approx(0.0));
+  CHECK(decimated[2].time() == trajectory[trajectory.size()-1].time());
+}
+
+//==============================================================================
+SCENARIO("Decimation keeps deviations beyond the tolerance")
+{
+  // A wiggle that is larger than the tolerance must survive
+  std::vector<Eigen::Vector3d> positions;
+  for (std::size_t i = 0; i <= 20; ++i)
+  {
+    const double x = static_cast<double>(i);
+    positions.push_back({x, 0.3*std::sin(x), 0.0});
+  }
+
+  const auto trajectory = make_trajectory(positions);
+  const double tolerance = 0.1;
+  const auto decimated = decimate(trajectory, tolerance);
+  CHECK(decimated.size() < trajectory.size());
+  CHECK(decimated.size() > 2);
+
+  // Every original waypoint is within the tolerance of the straight line
+  // between the kept waypoints around it
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < trajectory.size(); ++i)
+  {
+    const auto& wp = trajectory[i];
+    while (decimated[k+1].time() < wp.time())
+      ++k;
+
+    const auto& a = decimated[k];
+    const auto& b = decimated[k+1];
+    const double s = rmf_traffic::time::to_seconds(wp.time() - a.time())
+      / rmf_traffic::time::to_seconds(b.time() - a.time());
+    const Eigen::Vector3d expected =
+      a.position() + s*(b.position() - a.position());
+    CHECK((wp.position() - expected).block<2, 1>(0, 0).norm()
+      <= tolerance + 1e-9);
+  }
+
+  // A robot that stops in place is not mistaken for a straight line, because
+  // the deviation is measured at the same time
+  const auto paused = make_trajectory(
+    {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {10.0, 0.0, 0.0}});
+  CHECK(decimate(paused, tolerance).size() == 3);
+}
+
+//==============================================================================
+SCENARIO("Short trajectories are left alone")
+{
+  const auto two = make_trajectory({{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}});
+  CHECK(decimate(two, 1.0).size() == 2);
+}
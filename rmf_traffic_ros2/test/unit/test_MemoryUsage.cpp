@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include <rmf_traffic_ros2/MemoryUsage.hpp>
+
+#include <yaml-cpp/yaml.h>
+
+using namespace rmf_traffic_ros2;
+
+//==============================================================================
+SCENARIO("Memory estimates grow with the contents of containers")
+{
+  std::vector<double> values;
+  values.reserve(100);
+  CHECK(memory::heap_bytes(values) == 100 * sizeof(double));
+
+  std::unordered_map<std::size_t, std::string> names;
+  const auto empty_bytes = memory::heap_bytes(names);
+  for (std::size_t i = 0; i < 50; ++i)
+    names[i] = "a name that is too long to fit inside of the string";
+
+  const auto shallow_bytes = memory::heap_bytes(names);
+  CHECK(shallow_bytes > empty_bytes + 50 * sizeof(std::string));
+
+  const auto deep_bytes = memory::heap_bytes(
+    names,
+    [](const auto& element)
+    {
+      return memory::heap_bytes(element.second);
+    });
+  CHECK(deep_bytes >= shallow_bytes + 50 * names.at(0).size());
+
+  // Short strings do not hold anything on the heap
+  CHECK(memory::heap_bytes(std::string("short")) == 0);
+}
+
+//==============================================================================
+SCENARIO("Memory usage is serialized with every container")
+{
+  MemoryUsage usage;
+  usage.add("first", 3, 100).add("second", 5, 250);
+  CHECK(usage.accounted_bytes() == 350);
+
+  const auto yaml = YAML::Load(serialize(usage, "/test_node"));
+  CHECK(yaml["node"].as<std::string>() == "/test_node");
+  CHECK(yaml["accounted_bytes"].as<std::size_t>() == 350);
+
+  const auto containers = yaml["containers"];
+  REQUIRE(containers.size() == 2);
+  CHECK(containers[0]["name"].as<std::string>() == "first");
+  CHECK(containers[0]["count"].as<std::size_t>() == 3);
+  CHECK(containers[1]["name"].as<std::string>() == "second");
+  CHECK(containers[1]["bytes"].as<std::size_t>() == 250);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include <rmf_traffic_ros2/Metrics.hpp>
+
+#include <thread>
+
+using namespace rmf_traffic_ros2;
+
+//==============================================================================
+SCENARIO("Metrics give back the same series for the same labels")
+{
+  Metrics metrics;
+  const auto tasks = metrics.counter(
+    "rmf_tasks", "Tasks that were submitted", {{"fleet", "tinyRobot"}});
+  tasks->increment();
+  metrics.counter("rmf_tasks", "", {{"fleet", "tinyRobot"}})->increment(2);
+  metrics.counter("rmf_tasks", "", {{"fleet", "deliveryRobot"}})->increment();
+  CHECK(tasks->value() == 3);
+
+  const auto open = metrics.gauge("rmf_open", "Open negotiations");
+  open->set(4.0);
+  open->add(-1.5);
+  CHECK(open->value() == Approx(2.5));
+
+  CHECK_THROWS(metrics.gauge("rmf_tasks", "Not a counter"));
+
+  const auto samples = metrics.samples();
+  REQUIRE(samples.size() == 3);
+  CHECK(samples[0].name == "rmf_open");
+  CHECK(samples[1].name == "rmf_tasks_total");
+  CHECK(samples[1].labels.at("fleet") == "deliveryRobot");
+  CHECK(samples[2].value == 3.0);
+}
+
+//==============================================================================
+SCENARIO("Histograms count observations into cumulative buckets")
+{
+  Metrics metrics;
+  const auto latency = metrics.histogram(
+    "rmf_latency_seconds", "How long things take", {}, {0.1, 1.0});
+
+  latency->observe(0.05);
+  latency->observe(0.1);
+  latency->observe(std::chrono::milliseconds(500));
+  latency->observe(30.0);
+
+  const auto snapshot = latency->snapshot();
+  CHECK(snapshot.counts == std::vector<uint64_t>({2, 1, 1}));
+  CHECK(snapshot.count == 4);
+  CHECK(snapshot.sum == Approx(30.65));
+
+  const auto text = metrics.openmetrics();
+  CHECK(text.find("# TYPE rmf_latency_seconds histogram\n") == 0);
+  CHECK(text.find("rmf_latency_seconds_bucket{le=\"0.1\"} 2\n")
+    != std::string::npos);
+  CHECK(text.find("rmf_latency_seconds_bucket{le=\"1\"} 3\n")
+    != std::string::npos);
+  CHECK(text.find("rmf_latency_seconds_bucket{le=\"+Inf\"} 4\n")
+    != std::string::npos);
+  CHECK(text.find("rmf_latency_seconds_count 4\n") != std::string::npos);
+  CHECK(text.rfind("# EOF\n") == text.size() - 6);
+
+  CHECK_THROWS(Metrics::Histogram({1.0, 0.5}));
+}
+
+//==============================================================================
+SCENARIO("Label values are escaped in the OpenMetrics text")
+{
+  Metrics metrics;
+  metrics.counter("rmf_events", "Events", {{"name", "a \"quoted\" name"}});
+  CHECK(format_series("rmf_events_total", {{"name", "a\\b"}})
+    == "rmf_events_total{name=\"a\\\\b\"}");
+  CHECK(metrics.openmetrics().find(
+      "rmf_events_total{name=\"a \\\"quoted\\\" name\"} 0\n")
+    != std::string::npos);
+}
+
+//==============================================================================
+SCENARIO("Counters can be incremented from several threads")
+{
+  Metrics metrics;
+  const auto counter = metrics.counter("rmf_increments", "Increments");
+  const auto histogram = metrics.histogram("rmf_values", "Values");
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < 4; ++t)
+  {
+    threads.emplace_back(
+      [&]()
+      {
+        for (std::size_t i = 0; i < 1000; ++i)
+        {
+          counter->increment();
+          histogram->observe(0.01);
+        }
+      });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  CHECK(counter->value() == 4000);
+  CHECK(histogram->snapshot().count == 4000);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic_ros2/schedule/Patch.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/MirrorSync.hpp"
+
+#include <set>
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Sync transfers are split into chunks and reassembled")
+{
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(0.5);
+
+  rmf_traffic::schedule::Database database;
+  std::set<rmf_traffic::schedule::ParticipantId> ids;
+
+  const auto start = rmf_traffic::Time(100s);
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+  trajectory.insert(start + 10s, {5.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+
+  for (std::size_t i = 0; i < 5; ++i)
+  {
+    const auto id = database.register_participant(
+      rmf_traffic::schedule::ParticipantDescription(
+        "participant " + std::to_string(i),
+        "test_MirrorSync",
+        rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+        rmf_traffic::Profile{shape})).id();
+
+    database.set(
+      id, {{0, std::make_shared<rmf_traffic::Route>("L1", trajectory)}}, 0);
+    ids.insert(id);
+  }
+
+  const auto patch = database.changes(
+    rmf_traffic::schedule::query_all(), std::nullopt);
+
+  const auto chunks = split_sync_patch(patch, 2);
+  REQUIRE(chunks.size() == 3);
+  CHECK(chunks[0].size() == 2);
+  CHECK(chunks[1].size() == 2);
+  CHECK(chunks[2].size() == 1);
+
+  std::set<rmf_traffic::schedule::ParticipantId> received;
+  for (std::size_t i = 0; i < chunks.size(); ++i)
+  {
+    CHECK(chunks[i].latest_version() == patch.latest_version());
+
+    SyncChunk chunk;
+    chunk.transfer_id = 42;
+    chunk.index = static_cast<uint32_t>(i);
+    chunk.count = static_cast<uint32_t>(chunks.size());
+    chunk.update.database_version = database.latest_version();
+    chunk.update.patch = rmf_traffic_ros2::convert(chunks[i]);
+
+    const auto decoded = decode_sync_chunk(encode_sync_chunk(chunk));
+    CHECK(decoded.transfer_id == 42);
+    CHECK(decoded.index == i);
+    CHECK(decoded.count == chunks.size());
+    CHECK(decoded.update.database_version == database.latest_version());
+
+    for (const auto& p : rmf_traffic_ros2::convert(decoded.update.patch))
+      received.insert(p.participant_id());
+  }
+
+  CHECK(received == ids);
+
+  // An empty patch still produces one chunk so that the transfer completes
+  const auto empty = database.changes(
+    rmf_traffic::schedule::query_all(), database.latest_version());
+  CHECK(split_sync_patch(empty, 2).size() == 1);
+
+  SyncChunk bad;
+  bad.index = 3;
+  bad.count = 3;
+  CHECK_THROWS_AS(decode_sync_chunk(encode_sync_chunk(bad)), SyncDecodeError);
+  CHECK_THROWS_AS(decode_sync_chunk({'R', 'M', 'S'}), SyncDecodeError);
+}
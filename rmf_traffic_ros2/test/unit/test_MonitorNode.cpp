@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Query.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/internal_MonitorNode.hpp"
+
+#include <rclcpp/executors/single_threaded_executor.hpp>
+
+#include <cstdio>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("A hot standby takes over without being set up again")
+{
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = context;
+
+  const std::string log_file =
+    "/tmp/test_monitor_node_" + std::to_string(getpid()) + ".yaml";
+  std::remove(log_file.c_str());
+
+  auto primary = std::make_shared<ScheduleNode>(
+    0,
+    rclcpp::NodeOptions().context(context)
+    .append_parameter_override("log_file_location", log_file),
+    ScheduleNode::no_automatic_setup);
+  primary->setup(ScheduleNode::QueryMap());
+
+  rclcpp::executors::SingleThreadedExecutor primary_executor(executor_options);
+  primary_executor.add_node(primary);
+  std::thread primary_thread([&]() { primary_executor.spin(); });
+
+  // Stop the primary node even when a REQUIRE fails
+  struct StopSpinning
+  {
+    rclcpp::Executor& executor;
+    std::thread& thread;
+    ~StopSpinning()
+    {
+      executor.cancel();
+      if (thread.joinable())
+        thread.join();
+    }
+  } stop_primary{primary_executor, primary_thread};
+
+  std::shared_ptr<rclcpp::Node> promoted;
+  auto monitor = std::make_shared<MonitorNode>(
+    [&promoted](std::shared_ptr<rclcpp::Node> node)
+    {
+      promoted = std::move(node);
+    },
+    rclcpp::NodeOptions().context(context),
+    MonitorNode::no_automatic_setup);
+  monitor->setup();
+
+  auto mirror_future =
+    make_mirror(*monitor, rmf_traffic::schedule::query_all());
+
+  rclcpp::executors::SingleThreadedExecutor monitor_executor(executor_options);
+  monitor_executor.add_node(monitor);
+  auto stop_time = std::chrono::steady_clock::now() + 10s;
+  while (mirror_future.wait_for(0s) != std::future_status::ready
+    && std::chrono::steady_clock::now() < stop_time)
+  {
+    monitor_executor.spin_some();
+  }
+  REQUIRE(mirror_future.wait_for(0s) == std::future_status::ready);
+  monitor->mirror = mirror_future.get();
+
+  monitor->prepare_standby_node(
+    std::make_shared<Database>(monitor->mirror->fork()));
+  auto standby = monitor->standby_node;
+  REQUIRE(standby != nullptr);
+  CHECK(standby->standby);
+  CHECK(standby->heartbeat_pub == nullptr);
+  CHECK(standby->register_participant_service == nullptr);
+  CHECK(standby->parameter_service == nullptr);
+
+  // This participant arrives after the standby has been prepared, so the
+  // standby can only know about it by following the primary node
+  const rmf_traffic::schedule::ParticipantDescription description(
+    "late_robot",
+    "test_MonitorNode",
+    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+    rmf_traffic::Profile{
+      rmf_traffic::geometry::make_final_convex<
+        rmf_traffic::geometry::Circle>(0.5)});
+
+  rmf_traffic::schedule::ParticipantId id;
+  {
+    std::lock_guard<std::mutex> lock(primary->database_mutex);
+    id = primary->participant_registry->add_or_retrieve_participant(
+      description).id();
+    primary->broadcast_participants_delta({primary->participant_info(id)}, {});
+  }
+
+  const auto standby_knows_participant = [&]()
+    {
+      std::lock_guard<std::mutex> lock(standby->database_mutex);
+      const auto participant = standby->database->get_participant(id);
+      return participant && participant->name() == description.name();
+    };
+
+  stop_time = std::chrono::steady_clock::now() + 10s;
+  while (!standby_knows_participant()
+    && std::chrono::steady_clock::now() < stop_time)
+  {
+    std::this_thread::sleep_for(10ms);
+  }
+  REQUIRE(standby_knows_participant());
+
+  WHEN("The monitor fails over")
+  {
+    monitor->fail_over();
+
+    THEN("The prepared standby is promoted with all of its services")
+    {
+      REQUIRE(promoted != nullptr);
+      CHECK(promoted.get() == standby.get());
+      CHECK(monitor->standby_node == nullptr);
+      CHECK_FALSE(standby->standby);
+      CHECK(standby->heartbeat_pub != nullptr);
+      CHECK(standby->register_participant_service != nullptr);
+      CHECK(standby->parameter_service != nullptr);
+      CHECK(standby_knows_participant());
+    }
+  }
+
+  primary_executor.cancel();
+  primary_thread.join();
+
+  promoted.reset();
+  monitor.reset();
+  standby.reset();
+  primary.reset();
+  context->shutdown("test finished");
+  std::remove(log_file.c_str());
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/NegotiationStatus.hpp"
+
+#include <cmath>
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Negotiation latencies are tracked from notice to conclusion")
+{
+  const auto start = NegotiationStatusTracker::Clock::time_point();
+
+  NegotiationStatusTracker tracker;
+  tracker.opened(1, start);
+  tracker.opened(2, start + 1s);
+  tracker.opened(3, start + 2s);
+
+  // A second notice for an open negotiation should not restart its clock
+  tracker.opened(1, start + 5s);
+  CHECK(tracker.since_notice(1, start + 6s) == rmf_traffic::Duration(6s));
+
+  tracker.concluded(1, true, start + 300ms);
+  tracker.concluded(2, false, start + 21s);
+  tracker.concluded(4, true, start + 1s);
+  CHECK_FALSE(tracker.since_notice(1, start + 6s).has_value());
+  CHECK(tracker.since_notice(3, start + 6s) == rmf_traffic::Duration(4s));
+
+  auto status = tracker.report();
+  REQUIRE(status.concluded.size() == 2);
+  CHECK(status.concluded[0].conflict_version == 1);
+  CHECK(status.concluded[0].resolved);
+  CHECK(status.concluded[0].notice_to_conclusion ==
+    rmf_traffic::Duration(300ms));
+  CHECK(status.concluded[1].notice_to_conclusion ==
+    rmf_traffic::Duration(20s));
+
+  CHECK(status.resolved_latency.total() == 1);
+  CHECK(status.resolved_latency.counts()[2] == 1);
+  CHECK(status.failed_latency.total() == 1);
+  CHECK(status.failed_latency.counts()[7] == 1);
+  CHECK(status.failed_latency.max() == rmf_traffic::Duration(20s));
+
+  // The conclusions are only reported once, but the histograms accumulate
+  CHECK(tracker.report().concluded.empty());
+  CHECK(tracker.report().failed_latency.total() == 1);
+
+  GIVEN("A tracker that does not keep its conclusions")
+  {
+    NegotiationStatusTracker quiet;
+    quiet.keep_conclusions(false);
+    for (std::size_t i = 0; i < 100; ++i)
+    {
+      quiet.opened(i, start);
+      CHECK(quiet.concluded(i, true, start + 1s) ==
+        rmf_traffic::Duration(1s));
+    }
+
+    const auto quiet_status = quiet.report();
+    CHECK(quiet_status.concluded.empty());
+    CHECK(quiet_status.resolved_latency.total() == 100);
+  }
+
+  status.open.push_back({3, {7, 8}, 2, 4s});
+  status.awaiting_acknowledgment = 2;
+
+  const YAML::Node node = YAML::Load(YAML::Dump(serialize(status)));
+  REQUIRE(node["open"].size() == 1);
+  CHECK(node["open"][0]["conflict_version"].as<uint64_t>() == 3);
+  CHECK(node["open"][0]["participants"].as<std::vector<uint64_t>>() ==
+    std::vector<uint64_t>{7, 8});
+  CHECK(node["open"][0]["depth"].as<std::size_t>() == 2);
+  CHECK(node["open"][0]["since_notice"].as<double>() == Approx(4.0));
+  CHECK(node["concluded"].size() == 2);
+  CHECK(node["awaiting_acknowledgment"].as<std::size_t>() == 2);
+
+  const auto failed = node["latency"]["failed"];
+  CHECK(failed["count"].as<uint64_t>() == 1);
+  CHECK(failed["sum"].as<double>() == Approx(20.0));
+  REQUIRE(failed["buckets"].size() ==
+    NegotiationLatencyHistogram::default_bounds().size() + 1);
+  CHECK(failed["buckets"][7]["le"].as<double>() == Approx(30.0));
+  CHECK(failed["buckets"][7]["count"].as<uint64_t>() == 1);
+  CHECK(std::isinf(
+      failed["buckets"][
+        NegotiationLatencyHistogram::default_bounds().size()]["le"]
+      .as<double>()));
+}
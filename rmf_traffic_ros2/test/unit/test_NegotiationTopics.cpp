@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/NegotiationTopics.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Negotiation messages are delivered to the shards of participants")
+{
+  const std::vector<rmf_traffic::schedule::ParticipantId> participants =
+  {3, 7, 11, 4};
+
+  CHECK(negotiation_shards(participants, 0).empty());
+  CHECK(negotiation_shards(participants, 4) == std::set<std::size_t>{0, 3});
+  CHECK(negotiation_shards(participants, 1) == std::set<std::size_t>{0});
+
+  CHECK(negotiation_shard_topic("negotiation_notice", 2)
+    == "negotiation_notice/shard_2");
+}
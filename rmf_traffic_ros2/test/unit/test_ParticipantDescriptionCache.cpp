@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ParticipantDescriptionCache.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+
+namespace {
+//==============================================================================
+rmf_traffic_msgs::msg::Participant make_participant(
+  const rmf_traffic::schedule::ParticipantId id,
+  const std::string& name,
+  const double radius = 0.5)
+{
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(radius);
+
+  rmf_traffic_msgs::msg::Participant participant;
+  participant.id = id;
+  participant.description = rmf_traffic_ros2::convert(
+    rmf_traffic::schedule::ParticipantDescription(
+      name,
+      "test_ParticipantDescriptionCache",
+      rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+      rmf_traffic::Profile{shape}));
+
+  return participant;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Unchanged participant descriptions are not converted again")
+{
+  rmf_traffic_msgs::msg::Participants msg;
+  msg.participants = {make_participant(0, "a"), make_participant(1, "b")};
+
+  ParticipantDescriptionCache cache;
+  const auto first = cache.convert(msg);
+  CHECK(cache.last_conversions() == 2);
+  CHECK(cache.size() == 2);
+  REQUIRE(first.size() == 2);
+  CHECK(first.at(0).name() == "a");
+  CHECK(first.at(1).name() == "b");
+
+  const auto second = cache.convert(msg);
+  CHECK(cache.last_conversions() == 0);
+  REQUIRE(second.size() == 2);
+  CHECK(second.at(0).name() == "a");
+  CHECK(second.at(1).name() == "b");
+
+  WHEN("A description changes")
+  {
+    msg.participants[1] = make_participant(1, "b", 1.0);
+    const auto changed = cache.convert(msg);
+    CHECK(cache.last_conversions() == 1);
+    REQUIRE(changed.size() == 2);
+    CHECK(rmf_traffic_ros2::convert(changed.at(1))
+      == msg.participants[1].description);
+  }
+
+  WHEN("A participant is added and another is removed")
+  {
+    msg.participants = {make_participant(1, "b"), make_participant(2, "c")};
+    const auto changed = cache.convert(msg);
+    CHECK(cache.last_conversions() == 1);
+    CHECK(cache.size() == 2);
+    CHECK(changed.count(0) == 0);
+    CHECK(changed.at(2).name() == "c");
+  }
+}
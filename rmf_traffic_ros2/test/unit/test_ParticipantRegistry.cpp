@@ -17,6 +17,7 @@
 
 #include <rmf_traffic/geometry/Circle.hpp>
 #include <rmf_traffic_ros2/schedule/ParticipantRegistry.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
 #include <filesystem>
 #include <rmf_utils/catch.hpp>
 #include <fstream>
@@ -171,6 +172,55 @@ SCENARIO("Participant registry restores participants from logger")
 
       std::vector<AtomicOperation> journal_old = journal;
 
+      THEN("Unchanged participants are retrieved without being logged")
+      {
+        const auto unchanged = registry1.retrieve_unchanged_participant(p2);
+        REQUIRE(unchanged.has_value());
+        CHECK(unchanged->id() == participant_id2.id());
+
+        const rmf_traffic::schedule::ParticipantDescription resized(
+          p2.name(),
+          p2.owner(),
+          p2.responsiveness(),
+          rmf_traffic::Profile{
+            rmf_traffic::geometry::make_final_convex<
+              rmf_traffic::geometry::Circle>(2.0)});
+        CHECK_FALSE(registry1.retrieve_unchanged_participant(resized));
+
+        const rmf_traffic::schedule::ParticipantDescription p4(
+          "participant 4",
+          "test_Participant",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          rmf_traffic::Profile{shape});
+        CHECK_FALSE(registry1.retrieve_unchanged_participant(p4));
+
+        CHECK(journal.size() == 3);
+        CHECK(db1->participant_ids().size() == 3);
+      }
+
+      THEN("Description messages are kept until they are updated")
+      {
+        const auto msg = registry1.description_msg(participant_id2.id());
+        REQUIRE(msg.has_value());
+        CHECK(*msg == rmf_traffic_ros2::convert(p2));
+        CHECK_FALSE(registry1.description_msg(participant_id3.id() + 1));
+
+        const rmf_traffic::schedule::ParticipantDescription resized(
+          p2.name(),
+          p2.owner(),
+          p2.responsiveness(),
+          rmf_traffic::Profile{
+            rmf_traffic::geometry::make_final_convex<
+              rmf_traffic::geometry::Circle>(2.0)});
+        registry1.add_or_retrieve_participant(resized);
+        CHECK(journal.size() == 4);
+
+        const auto updated = registry1.description_msg(participant_id2.id());
+        REQUIRE(updated.has_value());
+        CHECK(*updated == rmf_traffic_ros2::convert(resized));
+        CHECK(*updated != *msg);
+      }
+
       THEN("Restoring DB")
       {
         auto db2 = std::make_shared<Database>();
@@ -200,6 +250,63 @@ SCENARIO("Participant registry restores participants from logger")
   }
 }
 
+SCENARIO("Participant registry logs asynchronously")
+{
+  using Database = rmf_traffic::schedule::Database;
+
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(1.0);
+
+  std::vector<rmf_traffic::schedule::ParticipantDescription> descriptions;
+  for (std::size_t i = 0; i < 10; ++i)
+  {
+    descriptions.emplace_back(
+      "participant " + std::to_string(i),
+      "test_Participant",
+      rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+      rmf_traffic::Profile{shape});
+  }
+
+  std::vector<AtomicOperation> journal;
+  std::vector<AtomicOperation> durable;
+  std::size_t failures = 0;
+
+  ParticipantRegistry::AsyncLogging async;
+  async.max_queue_size = 2;
+  async.on_durable =
+    [&](const AtomicOperation& op, std::exception_ptr error)
+    {
+      durable.push_back(op);
+      if (error)
+        ++failures;
+    };
+
+  auto db1 = std::make_shared<Database>();
+  {
+    ParticipantRegistry registry(
+      std::make_unique<TestOperationLogger>(&journal), db1, async);
+
+    for (const auto& desc : descriptions)
+      registry.add_or_retrieve_participant(desc);
+
+    // Registering the same participant again should not be logged
+    registry.add_or_retrieve_participant(descriptions.front());
+
+    // The database is updated without waiting for the logger
+    CHECK(db1->participant_ids().size() == descriptions.size());
+
+    registry.flush();
+    CHECK(journal.size() == descriptions.size());
+    CHECK(durable.size() == descriptions.size());
+    CHECK(failures == 0);
+  }
+
+  auto db2 = std::make_shared<Database>();
+  ParticipantRegistry registry(
+    std::make_unique<TestOperationLogger>(&journal), db2);
+  CHECK(db2->participant_ids() == db1->participant_ids());
+}
+
 SCENARIO("Test file logger")
 {
   if (std::filesystem::exists("test_yamllogger.yaml"))
@@ -310,3 +417,140 @@ SCENARIO("Test file logger")
     }
   }
 }
+
+SCENARIO("Test binary logger")
+{
+  const std::string journal = "test_binarylogger.journal";
+  if (std::filesystem::exists(journal))
+  {
+    std::remove(journal.c_str());
+  }
+
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(1.0);
+
+  const auto bigger_shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(2.0);
+
+  rmf_traffic::schedule::ParticipantDescription p1(
+    "participant 1",
+    "test_Participant",
+    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+    rmf_traffic::Profile{shape});
+
+  rmf_traffic::schedule::ParticipantDescription p2(
+    "participant 2",
+    "test_Participant",
+    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+    rmf_traffic::Profile{shape});
+
+  rmf_traffic::schedule::ParticipantDescription p1_updated(
+    "participant 1",
+    "test_Participant",
+    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+    rmf_traffic::Profile{bigger_shape});
+
+  GIVEN("non-existant file")
+  {
+    WHEN("Storing records")
+    {
+      {
+        BinaryLogger logger(journal);
+        logger.write_operation({AtomicOperation::OpType::Add, p1});
+        logger.write_operation({AtomicOperation::OpType::Add, p2});
+        logger.write_operation({AtomicOperation::OpType::Update, p1_updated});
+      }
+
+      THEN("Able to retrieve the records in order")
+      {
+        BinaryLogger logger(journal);
+        std::vector<AtomicOperation> expected = {
+          {AtomicOperation::OpType::Add, p1},
+          {AtomicOperation::OpType::Add, p2},
+          {AtomicOperation::OpType::Update, p1_updated},
+        };
+
+        std::size_t i = 0;
+        while (auto record = logger.read_next_record())
+        {
+          REQUIRE(i < expected.size());
+          REQUIRE(expected[i] == *record);
+          i++;
+        }
+        REQUIRE(i == expected.size());
+      }
+    }
+
+    WHEN("Enough updates are written to trigger a compaction")
+    {
+      {
+        BinaryLogger logger(journal, std::chrono::nanoseconds(0), 2);
+        logger.write_operation({AtomicOperation::OpType::Add, p1});
+        logger.write_operation({AtomicOperation::OpType::Add, p2});
+        logger.write_operation({AtomicOperation::OpType::Update, p1});
+        logger.write_operation({AtomicOperation::OpType::Update, p1_updated});
+      }
+
+      THEN("Only the latest description of each participant remains")
+      {
+        BinaryLogger logger(journal);
+        std::vector<AtomicOperation> expected = {
+          {AtomicOperation::OpType::Add, p1_updated},
+          {AtomicOperation::OpType::Add, p2},
+        };
+
+        std::size_t i = 0;
+        while (auto record = logger.read_next_record())
+        {
+          REQUIRE(i < expected.size());
+          REQUIRE(expected[i] == *record);
+          i++;
+        }
+        REQUIRE(i == expected.size());
+      }
+    }
+  }
+
+  GIVEN("a journal whose last record was only partially written")
+  {
+    {
+      BinaryLogger logger(journal);
+      logger.write_operation({AtomicOperation::OpType::Add, p1});
+      logger.write_operation({AtomicOperation::OpType::Add, p2});
+    }
+
+    std::filesystem::resize_file(
+      journal, std::filesystem::file_size(journal) - 3);
+
+    THEN("the torn record is dropped and new records can be appended")
+    {
+      {
+        BinaryLogger logger(journal);
+        auto record = logger.read_next_record();
+        REQUIRE(record.has_value());
+        CHECK(*record == AtomicOperation{AtomicOperation::OpType::Add, p1});
+        CHECK_FALSE(logger.read_next_record().has_value());
+
+        logger.write_operation({AtomicOperation::OpType::Add, p2});
+      }
+
+      auto db = std::make_shared<Database>();
+      ParticipantRegistry registry(
+        std::make_unique<BinaryLogger>(journal), db);
+      CHECK(db->participant_ids().size() == 2);
+    }
+  }
+
+  GIVEN("a file that is not a journal")
+  {
+    std::ofstream invalid;
+    invalid.open(journal, std::ofstream::out);
+    invalid << "- not a journal";
+    invalid.close();
+
+    THEN("throws exception")
+    {
+      REQUIRE_THROWS(std::make_unique<BinaryLogger>(journal));
+    }
+  }
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic_ros2/schedule/ParticipantDescription.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ParticipantsDelta.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+
+namespace {
+//==============================================================================
+rmf_traffic_msgs::msg::Participant make_participant(
+  const rmf_traffic::schedule::ParticipantId id,
+  const std::string& name)
+{
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(0.5);
+
+  rmf_traffic_msgs::msg::Participant participant;
+  participant.id = id;
+  participant.description = rmf_traffic_ros2::convert(
+    rmf_traffic::schedule::ParticipantDescription(
+      name,
+      "test_ParticipantsDelta",
+      rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+      rmf_traffic::Profile{shape}));
+
+  return participant;
+}
+
+//==============================================================================
+ParticipantsDelta round_trip(const ParticipantsDelta& delta)
+{
+  return decode_participants_delta(encode_participants_delta(delta));
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Participants deltas are applied in order after a resync")
+{
+  ParticipantsDelta resync;
+  resync.version = 10;
+  resync.resync = true;
+  resync.updated.participants = {make_participant(0, "a")};
+
+  ParticipantsDelta added;
+  added.version = 11;
+  added.updated.participants = {make_participant(1, "b")};
+
+  ParticipantsDelta removed;
+  removed.version = 12;
+  removed.removed = {0};
+
+  const auto decoded = round_trip(removed);
+  CHECK(decoded.version == 12);
+  CHECK_FALSE(decoded.resync);
+  CHECK(decoded.removed == removed.removed);
+  CHECK(decoded.updated.participants.empty());
+
+  ParticipantsDeltaTracker tracker;
+  CHECK_FALSE(tracker.synchronized());
+
+  // Nothing can be applied before the first resync
+  CHECK_FALSE(tracker.apply(round_trip(added)));
+  CHECK(tracker.participants().empty());
+
+  CHECK(tracker.apply(round_trip(resync)));
+  CHECK(tracker.synchronized());
+  CHECK(tracker.participants().size() == 1);
+
+  GIVEN("Each delta in order")
+  {
+    CHECK(tracker.apply(round_trip(added)));
+    CHECK(tracker.apply(round_trip(removed)));
+    REQUIRE(tracker.participants().size() == 1);
+    CHECK(tracker.participants().at(1).name() == "b");
+  }
+
+  GIVEN("A missed delta")
+  {
+    CHECK_FALSE(tracker.apply(round_trip(removed)));
+    CHECK_FALSE(tracker.synchronized());
+    CHECK(tracker.participants().size() == 1);
+
+    // Later deltas are refused until the next resync
+    ParticipantsDelta next;
+    next.version = 13;
+    CHECK_FALSE(tracker.apply(round_trip(next)));
+
+    resync.version = 14;
+    resync.updated.participants = {make_participant(1, "b")};
+    CHECK(tracker.apply(round_trip(resync)));
+    REQUIRE(tracker.participants().size() == 1);
+    CHECK(tracker.participants().count(1) == 1);
+  }
+
+  CHECK_THROWS_AS(
+    decode_participants_delta({'R', 'M', 'S', 1}),
+    ParticipantsDeltaDecodeError);
+}
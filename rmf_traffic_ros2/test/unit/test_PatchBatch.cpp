@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic/schedule/Mirror.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/PatchBatch.hpp"
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Batched patches are applied to a mirror in one pass")
+{
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(0.5);
+
+  const rmf_traffic::schedule::ParticipantDescription description(
+    "participant",
+    "test_PatchBatch",
+    rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+    rmf_traffic::Profile{shape});
+
+  rmf_traffic::schedule::Database database;
+  const auto id = database.register_participant(description).id();
+
+  const auto start = rmf_traffic::Time(100s);
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+  trajectory.insert(start + 10s, {5.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+  const auto route = std::make_shared<rmf_traffic::Route>("L1", trajectory);
+
+  const auto query = rmf_traffic::schedule::query_all();
+
+  rmf_traffic::schedule::Mirror mirror;
+  mirror.update_participants_info({{id, description}});
+  REQUIRE(mirror.update(database.changes(query, std::nullopt)));
+
+  // Queue up several patches, each one building on the last
+  std::vector<rmf_traffic::schedule::Patch> patches;
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    const auto base = database.latest_version();
+    database.set(id, {{0, route}}, i);
+    patches.push_back(database.changes(query, base));
+  }
+
+  WHEN("All of the patches are in order")
+  {
+    PatchBatch batch;
+    for (const auto& patch : patches)
+      batch.add(patch, false);
+
+    CHECK(batch.size() == 3);
+    batch.apply(mirror);
+
+    THEN("They are all applied in the one pass")
+    {
+      const auto applied = batch.applied();
+      REQUIRE(applied.size() == 3);
+      for (std::size_t i = 0; i < applied.size(); ++i)
+        CHECK(applied[i]->latest_version() == patches[i].latest_version());
+
+      CHECK(mirror.latest_version() == database.latest_version());
+      CHECK(batch.failed() == nullptr);
+    }
+  }
+
+  WHEN("A patch in the middle of the run is missing")
+  {
+    PatchBatch batch;
+    batch.add(patches[0], false);
+    batch.add(patches[2], false);
+    batch.apply(mirror);
+
+    THEN("The patch after the gap fails and calls for one new update")
+    {
+      REQUIRE(batch.applied().size() == 1);
+      CHECK(mirror.latest_version() == patches[0].latest_version());
+
+      const auto* failed = batch.failed();
+      REQUIRE(failed);
+      CHECK(failed->latest_version() == patches[2].latest_version());
+
+      CHECK(batch.claim_request());
+      CHECK_FALSE(batch.claim_request());
+    }
+  }
+
+  WHEN("The patch after the gap was a remedial update")
+  {
+    PatchBatch batch;
+    batch.add(patches[0], false);
+    batch.add(patches[2], true);
+    batch.apply(mirror);
+
+    THEN("No new update is called for")
+    {
+      CHECK(batch.applied().size() == 1);
+      CHECK(batch.failed() == nullptr);
+    }
+  }
+}
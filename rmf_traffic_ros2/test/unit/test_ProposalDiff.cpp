@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_traffic_ros2/Route.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ProposalDiff.hpp"
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+namespace {
+//==============================================================================
+rmf_traffic_msgs::msg::Route make_route(
+  const std::string& map,
+  const double x,
+  const rmf_traffic::Duration start)
+{
+  rmf_traffic::Trajectory trajectory;
+  const auto t = rmf_traffic::Time(start);
+  trajectory.insert(t, {x, 0.0, 0.0}, {1.0, 0.0, 0.0});
+  trajectory.insert(t + 10s, {x + 10.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+  return rmf_traffic_ros2::convert(rmf_traffic::Route(map, trajectory));
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Proposal diffs only carry the routes that changed")
+{
+  const std::vector<rmf_traffic_msgs::msg::Route> base = {
+    make_route("L1", 0.0, 100s),
+    make_route("L1", 20.0, 200s),
+    make_route("L2", 0.0, 300s)
+  };
+
+  rmf_traffic_msgs::msg::NegotiationProposal proposal;
+  proposal.conflict_version = 5;
+  proposal.proposal_version = 2;
+  proposal.for_participant = 3;
+  proposal.to_accommodate.resize(1);
+  proposal.to_accommodate[0].participant = 1;
+  proposal.to_accommodate[0].version = 4;
+  proposal.itinerary = {
+    make_route("L2", 0.0, 300s),
+    make_route("L1", 20.0, 205s),
+    make_route("L3", 0.0, 400s)
+  };
+
+  const auto diff = make_proposal_diff(proposal, base, 1);
+  REQUIRE(diff.has_value());
+  CHECK(diff->base_version == 1);
+  REQUIRE(diff->routes.size() == 3);
+  CHECK(diff->routes[0].kind == ProposalDiff::RouteChange::Same);
+  CHECK(diff->routes[0].base_index == 2);
+  CHECK(diff->routes[1].kind == ProposalDiff::RouteChange::Shifted);
+  CHECK(diff->routes[1].base_index == 1);
+  CHECK(diff->routes[1].time_shift ==
+    std::chrono::nanoseconds(5s).count());
+  CHECK(diff->routes[2].kind == ProposalDiff::RouteChange::New);
+  CHECK(diff->proposal.itinerary.size() == 1);
+
+  const auto decoded = decode_proposal_diff(encode_proposal_diff(*diff));
+  CHECK(decoded.base_version == diff->base_version);
+  REQUIRE(decoded.routes.size() == diff->routes.size());
+  CHECK(decoded.proposal == diff->proposal);
+
+  CHECK(apply_proposal_diff(decoded, base) == proposal);
+
+  GIVEN("A base itinerary that does not match the diff")
+  {
+    const std::vector<rmf_traffic_msgs::msg::Route> short_base(
+      base.begin(), base.begin() + 1);
+    CHECK_THROWS_AS(
+      apply_proposal_diff(decoded, short_base), ProposalDiffError);
+  }
+
+  GIVEN("A proposal that shares nothing with the base")
+  {
+    proposal.itinerary = {make_route("L4", 0.0, 100s)};
+    CHECK_FALSE(make_proposal_diff(proposal, base, 1).has_value());
+  }
+
+  GIVEN("A buffer that is not a proposal diff")
+  {
+    auto buffer = encode_proposal_diff(*diff);
+    buffer[0] = 'X';
+    CHECK_THROWS_AS(decode_proposal_diff(buffer), ProposalDiffError);
+
+    buffer = encode_proposal_diff(*diff);
+    buffer.resize(20);
+    CHECK_THROWS_AS(decode_proposal_diff(buffer), ProposalDiffError);
+  }
+}
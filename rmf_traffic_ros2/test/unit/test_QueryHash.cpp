@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_traffic/geometry/Box.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/QueryHash.hpp"
+
+using namespace std::chrono_literals;
+
+//==============================================================================
+SCENARIO("Equal queries hash equally regardless of ordering")
+{
+  const rmf_traffic_ros2::schedule::QueryHash hash;
+  using Query = rmf_traffic::schedule::Query;
+  using Participants = Query::Participants;
+
+  const auto box = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Box>(2.0, 2.0);
+
+  const auto make_region = [&](const std::string& map, const double x)
+    {
+      Eigen::Isometry2d pose = Eigen::Isometry2d::Identity();
+      pose.translation() = Eigen::Vector2d{x, 0.0};
+      rmf_traffic::Region region(map, {{box, pose}});
+      region.set_upper_time_bound(rmf_traffic::Time(10min));
+      return region;
+    };
+
+  auto forward = rmf_traffic::schedule::query_all();
+  forward.spacetime() = Query::Spacetime(
+    {make_region("L1", 0.0), make_region("L2", 5.0)});
+  forward.participants() = Participants::make_only({1, 2, 3});
+
+  auto backward = rmf_traffic::schedule::query_all();
+  backward.spacetime() = Query::Spacetime(
+    {make_region("L2", 5.0), make_region("L1", 0.0)});
+  backward.participants() = Participants::make_only({3, 2, 1});
+
+  CHECK(hash(forward) == hash(backward));
+  CHECK(hash(rmf_traffic::schedule::query_all())
+    == hash(rmf_traffic::schedule::query_all()));
+
+  auto moved = forward;
+  moved.spacetime() = Query::Spacetime(
+    {make_region("L1", 1.0), make_region("L2", 5.0)});
+  CHECK(hash(moved) != hash(forward));
+
+  auto excluded = forward;
+  excluded.participants() = Participants::make_all_except({1, 2, 3});
+  CHECK(hash(excluded) != hash(forward));
+
+  CHECK(hash(forward) != hash(rmf_traffic::schedule::query_all()));
+}
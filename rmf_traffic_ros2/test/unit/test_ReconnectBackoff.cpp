@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ReconnectBackoff.hpp"
+
+#include <set>
+
+using namespace rmf_traffic_ros2::schedule;
+using namespace std::chrono_literals;
+
+//==============================================================================
+SCENARIO("Reconnection delays are jittered and back off")
+{
+  ReconnectBackoff backoff(100ms, 500ms, 42);
+  CHECK(backoff.ceiling() == 100ms);
+
+  const auto first = backoff.next();
+  CHECK(0ms <= first);
+  CHECK(first <= 100ms);
+  CHECK(backoff.ceiling() == 200ms);
+
+  CHECK(backoff.next() <= 200ms);
+  CHECK(backoff.ceiling() == 400ms);
+
+  CHECK(backoff.next() <= 400ms);
+  CHECK(backoff.ceiling() == 500ms);
+
+  CHECK(backoff.next() <= 500ms);
+  CHECK(backoff.ceiling() == 500ms);
+
+  backoff.reset();
+  CHECK(backoff.ceiling() == 100ms);
+
+  WHEN("Many clients back off at once")
+  {
+    std::set<ReconnectBackoff::Duration> delays;
+    for (uint64_t seed = 0; seed < 20; ++seed)
+      delays.insert(ReconnectBackoff(1s, 1s, seed).next());
+
+    // The clients do not all reconnect at the same moment
+    CHECK(delays.size() > 10);
+  }
+
+  WHEN("There is no jitter")
+  {
+    ReconnectBackoff none(0ms, 0ms);
+    CHECK(none.next() == 0ms);
+    CHECK(none.next() == 0ms);
+  }
+}
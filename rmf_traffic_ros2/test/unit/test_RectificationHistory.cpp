@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/RectificationHistory.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+
+namespace {
+//==============================================================================
+rmf_traffic_msgs::msg::ItinerarySet make_set(
+  uint64_t participant, uint64_t version)
+{
+  rmf_traffic_msgs::msg::ItinerarySet msg;
+  msg.participant = participant;
+  msg.itinerary_version = version;
+  return msg;
+}
+
+//==============================================================================
+rmf_traffic_msgs::msg::ItineraryDelay make_delay(
+  uint64_t participant, uint64_t version)
+{
+  rmf_traffic_msgs::msg::ItineraryDelay msg;
+  msg.participant = participant;
+  msg.delay = 10;
+  msg.itinerary_version = version;
+  return msg;
+}
+
+//==============================================================================
+RectificationHistory::Inconsistency make_inconsistency(
+  uint64_t participant,
+  std::vector<std::pair<uint64_t, uint64_t>> ranges,
+  uint64_t last_known_version)
+{
+  RectificationHistory::Inconsistency msg;
+  msg.participant = participant;
+  for (const auto& [lower, upper] : ranges)
+  {
+    msg.ranges.emplace_back();
+    msg.ranges.back().lower = lower;
+    msg.ranges.back().upper = upper;
+  }
+
+  msg.last_known_version = last_known_version;
+  return msg;
+}
+
+//==============================================================================
+std::vector<uint64_t> versions(const std::vector<ItineraryMsg>& msgs)
+{
+  std::vector<uint64_t> output;
+  for (const auto& msg : msgs)
+  {
+    output.push_back(
+      std::visit([](const auto& m) { return m.itinerary_version; }, msg));
+  }
+
+  return output;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Inconsistencies are answered from the rectification history")
+{
+  RectificationHistory history(4);
+  CHECK_FALSE(history.retransmission(make_inconsistency(1, {{0, 0}}, 1)));
+
+  history.record(make_set(1, 0));
+  history.record(make_delay(1, 1));
+  history.record(make_delay(1, 2));
+  CHECK(history.size(1) == 3);
+
+  WHEN("A range in the middle of the history is missing")
+  {
+    const auto msgs =
+      history.retransmission(make_inconsistency(1, {{1, 1}}, 2));
+    REQUIRE(msgs.has_value());
+    CHECK(versions(*msgs) == std::vector<uint64_t>({1}));
+  }
+
+  WHEN("The latest changes are missing")
+  {
+    const auto msgs = history.retransmission(make_inconsistency(1, {}, 0));
+    REQUIRE(msgs.has_value());
+    CHECK(versions(*msgs) == std::vector<uint64_t>({1, 2}));
+  }
+
+  WHEN("The history grows past its limit")
+  {
+    history.record(make_delay(1, 3));
+    history.record(make_delay(1, 4));
+    CHECK(history.size(1) == 4);
+
+    THEN("Changes older than the history cannot be answered")
+    {
+      CHECK_FALSE(history.retransmission(make_inconsistency(1, {{0, 1}}, 4)));
+    }
+
+    THEN("Changes within the history can still be answered")
+    {
+      const auto msgs =
+        history.retransmission(make_inconsistency(1, {{2, 3}}, 4));
+      REQUIRE(msgs.has_value());
+      CHECK(versions(*msgs) == std::vector<uint64_t>({2, 3}));
+    }
+  }
+
+  WHEN("A set replaces the older changes")
+  {
+    history.record(make_delay(1, 3));
+    history.record(make_set(1, 4));
+    history.record(make_delay(1, 5));
+    CHECK(history.size(1) == 2);
+
+    THEN("Anything older than the set is answered with the set")
+    {
+      const auto msgs =
+        history.retransmission(make_inconsistency(1, {{1, 2}}, 5));
+      REQUIRE(msgs.has_value());
+      CHECK(versions(*msgs) == std::vector<uint64_t>({4}));
+      CHECK(std::holds_alternative<rmf_traffic_msgs::msg::ItinerarySet>(
+          msgs->front()));
+    }
+
+    THEN("The set is followed by the later changes that are missing")
+    {
+      const auto msgs = history.retransmission(make_inconsistency(1, {}, 2));
+      REQUIRE(msgs.has_value());
+      CHECK(versions(*msgs) == std::vector<uint64_t>({4, 5}));
+    }
+  }
+
+  WHEN("The participant is forgotten")
+  {
+    history.forget(1);
+    CHECK(history.size(1) == 0);
+    CHECK_FALSE(history.retransmission(make_inconsistency(1, {}, 0)));
+  }
+
+  CHECK_FALSE(history.retransmission(make_inconsistency(2, {}, 0)));
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic_ros2/schedule/Query.hpp>
+#include <rmf_utils/catch.hpp>
+
+using namespace std::chrono_literals;
+
+//==============================================================================
+SCENARIO("Region queries only match traffic near the graph")
+{
+  rmf_traffic::agv::Graph graph;
+  graph.add_waypoint("L1", {0.0, 0.0});
+  graph.add_waypoint("L1", {10.0, 5.0});
+  graph.add_waypoint("L2", {3.0, 3.0});
+
+  const auto start = rmf_traffic::Time(0s);
+  const auto query = rmf_traffic_ros2::schedule::make_region_query(
+    graph, 1.0, std::nullopt, start + 1min);
+
+  using Mode = rmf_traffic::schedule::Query::Spacetime::Mode;
+  REQUIRE(query.spacetime().get_mode() == Mode::Regions);
+  CHECK(query.spacetime().regions()->size() == 2);
+
+  // The query survives a round trip through its message
+  CHECK(rmf_traffic_ros2::convert(rmf_traffic_ros2::convert(query)) == query);
+
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(0.2);
+
+  rmf_traffic::schedule::Database database;
+  const auto add = [&](
+    const std::string& name,
+    const std::string& map,
+    const Eigen::Vector3d& p,
+    const rmf_traffic::Time time)
+    {
+      const auto id = database.register_participant(
+        rmf_traffic::schedule::ParticipantDescription(
+          name,
+          "test_RegionQuery",
+          rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+          rmf_traffic::Profile{shape})).id();
+
+      rmf_traffic::Trajectory trajectory;
+      trajectory.insert(time, p, Eigen::Vector3d::Zero());
+      trajectory.insert(time + 10s, p, Eigen::Vector3d::Zero());
+      database.set(
+        id, {{0, std::make_shared<rmf_traffic::Route>(map, trajectory)}}, 0);
+      return id;
+    };
+
+  const auto inside = add("inside", "L1", {5.0, 2.0, 0.0}, start);
+  add("padding", "L1", {10.5, 5.5, 0.0}, start);
+  add("outside", "L1", {30.0, 2.0, 0.0}, start);
+  add("other map", "L3", {5.0, 2.0, 0.0}, start);
+  add("too late", "L1", {5.0, 2.0, 0.0}, start + 10min);
+
+  std::size_t matches = 0;
+  bool found_inside = false;
+  for (const auto& p : database.changes(query, std::nullopt))
+  {
+    ++matches;
+    found_inside |= (p.participant_id() == inside);
+  }
+
+  CHECK(found_inside);
+  CHECK(matches == 2);
+
+  CHECK_THROWS(rmf_traffic_ros2::schedule::make_region_query(graph, -1.0));
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/RemediationRequest.hpp"
+
+#include <limits>
+
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Remediation requests are merged into one")
+{
+  RemediationRequest remediation;
+  CHECK(remediation.size() == 0);
+  CHECK_FALSE(remediation.take().has_value());
+
+  remediation.add(12);
+  remediation.add(9);
+  remediation.add(15);
+  CHECK(remediation.size() == 3);
+
+  auto since = remediation.take();
+  REQUIRE(since.has_value());
+  CHECK(*since == RemediationRequest::VersionOpt(9));
+  CHECK(remediation.size() == 0);
+  CHECK_FALSE(remediation.take().has_value());
+
+  WHEN("A full update is requested")
+  {
+    remediation.add(4);
+    remediation.add(std::nullopt);
+    remediation.add(2);
+
+    since = remediation.take();
+    REQUIRE(since.has_value());
+    CHECK_FALSE(since->has_value());
+  }
+
+  WHEN("The versions wrap around")
+  {
+    const auto max = std::numeric_limits<RemediationRequest::Version>::max();
+    remediation.add(3);
+    remediation.add(max - 1);
+
+    since = remediation.take();
+    REQUIRE(since.has_value());
+    CHECK(*since == RemediationRequest::VersionOpt(max - 1));
+  }
+}
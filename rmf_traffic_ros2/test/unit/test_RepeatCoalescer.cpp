@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/RepeatCoalescer.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Repeats of the same table are coalesced")
+{
+  using namespace std::chrono_literals;
+  const auto start = RepeatCoalescer::Clock::now();
+
+  RepeatCoalescer coalescer(500ms);
+  const RepeatCoalescer::Table table = {2, 1};
+  CHECK(coalescer.admit(3, table, 1, start));
+  CHECK_FALSE(coalescer.admit(3, table, 1, start + 100ms));
+  CHECK(coalescer.size() == 1);
+
+  // Other tables and other negotiations are not held back
+  CHECK(coalescer.admit(3, {1, 2}, 1, start + 100ms));
+  CHECK(coalescer.admit(4, table, 1, start + 100ms));
+  CHECK(coalescer.size() == 3);
+
+  WHEN("A newer version of the table is asked for")
+  {
+    CHECK(coalescer.admit(3, table, 2, start + 200ms));
+    CHECK_FALSE(coalescer.admit(3, table, 2, start + 300ms));
+    CHECK_FALSE(coalescer.admit(3, table, 1, start + 300ms));
+  }
+
+  WHEN("The period has passed")
+  {
+    CHECK(coalescer.admit(3, table, 1, start + 600ms));
+    CHECK(coalescer.size() == 1);
+  }
+
+  WHEN("The repeat has been answered")
+  {
+    coalescer.clear(3, table);
+    CHECK(coalescer.admit(3, table, 1, start + 200ms));
+  }
+
+  WHEN("The period is zero")
+  {
+    RepeatCoalescer passthrough(0ms);
+    CHECK(passthrough.admit(3, table, 1, start));
+    CHECK(passthrough.admit(3, table, 1, start));
+    CHECK(passthrough.size() == 0);
+  }
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic_ros2/schedule/Writer.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ReplicationLog.hpp"
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+namespace {
+//==============================================================================
+rmf_traffic_msgs::msg::ItinerarySet make_set(
+  uint64_t participant,
+  const rmf_traffic::schedule::Writer::Input& itinerary,
+  uint64_t version)
+{
+  rmf_traffic_msgs::msg::ItinerarySet msg;
+  msg.participant = participant;
+  msg.itinerary = rmf_traffic_ros2::convert(itinerary);
+  msg.itinerary_version = version;
+  return msg;
+}
+
+//==============================================================================
+rmf_traffic_msgs::msg::ItineraryExtend make_extend(
+  uint64_t participant,
+  const rmf_traffic::schedule::Writer::Input& routes,
+  uint64_t version)
+{
+  rmf_traffic_msgs::msg::ItineraryExtend msg;
+  msg.participant = participant;
+  msg.routes = rmf_traffic_ros2::convert(routes);
+  msg.itinerary_version = version;
+  return msg;
+}
+
+//==============================================================================
+rmf_traffic_msgs::msg::ItineraryDelay make_delay(
+  uint64_t participant,
+  rmf_traffic::Duration delay,
+  uint64_t version)
+{
+  rmf_traffic_msgs::msg::ItineraryDelay msg;
+  msg.participant = participant;
+  msg.delay = delay.count();
+  msg.itinerary_version = version;
+  return msg;
+}
+
+//==============================================================================
+rmf_traffic_msgs::msg::ItineraryErase make_erase(
+  uint64_t participant,
+  std::vector<uint64_t> routes,
+  uint64_t version)
+{
+  rmf_traffic_msgs::msg::ItineraryErase msg;
+  msg.participant = participant;
+  msg.routes = std::move(routes);
+  msg.itinerary_version = version;
+  return msg;
+}
+
+//==============================================================================
+const ScheduleSnapshot::Participant* find(
+  const ScheduleSnapshot& snapshot,
+  uint64_t participant)
+{
+  for (const auto& p : snapshot.participants)
+  {
+    if (p.id == participant)
+      return &p;
+  }
+
+  return nullptr;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Replication logs fold itinerary messages into a snapshot")
+{
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(0.5);
+
+  std::vector<rmf_traffic::schedule::ParticipantDescription> descriptions;
+  for (const auto& name : {"early", "late"})
+  {
+    descriptions.emplace_back(
+      name,
+      "test_ReplicationLog",
+      rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+      rmf_traffic::Profile{shape});
+  }
+
+  rmf_traffic::schedule::Database original;
+  rmf_traffic::schedule::ParticipantDescriptionsMap registered;
+  std::vector<rmf_traffic::schedule::ParticipantId> ids;
+  for (const auto& desc : descriptions)
+  {
+    ids.push_back(original.register_participant(desc).id());
+    registered.insert({ids.back(), desc});
+  }
+
+  const auto start = rmf_traffic::Time(1000s);
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {0.0, 0.0, 0.0}, {1.0, 0.0, 0.0});
+  trajectory.insert(start + 10s, {10.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+  const auto route = std::make_shared<rmf_traffic::Route>("L1", trajectory);
+
+  original.set(ids[0], {{0, route}}, 1);
+
+  ReplicationLog log;
+  log.participants(registered);
+  log.rebase(take_schedule_snapshot(original, {}, 0));
+
+  const auto early = ids[0];
+  const auto late = ids[1];
+
+  log.record(make_extend(early, {{1, route}}, 2));
+  log.record(make_delay(early, 5s, 3));
+  log.record(make_delay(early, 5s, 4));
+  log.record(make_erase(early, {0}, 5));
+  log.record(make_set(late, {{0, route}}, 1));
+  CHECK(log.logged() == 5);
+
+  log.compact();
+  CHECK(log.logged() == 0);
+
+  auto snapshot = log.snapshot();
+  REQUIRE(snapshot.participants.size() == 2);
+
+  const auto* p = find(snapshot, early);
+  REQUIRE(p);
+  CHECK(p->itinerary_version == 5);
+  REQUIRE(p->itinerary.size() == 1);
+  CHECK(p->itinerary.front().id == 1);
+  CHECK(p->itinerary.front().route->trajectory().begin()->time()
+    == start + 10s);
+
+  // The route that the snapshot started from must not have been shifted
+  CHECK(route->trajectory().begin()->time() == start);
+
+  p = find(snapshot, late);
+  REQUIRE(p);
+  CHECK(p->itinerary_version == 1);
+  CHECK(p->itinerary.size() == 1);
+
+  WHEN("A message arrives ahead of the versions before it")
+  {
+    log.record(make_extend(early, {{2, route}}, 7));
+    log.compact();
+    CHECK(log.logged() == 1);
+    CHECK(find(log.snapshot(), early)->itinerary_version == 5);
+
+    log.record(make_delay(early, 1s, 6));
+    log.compact();
+    CHECK(log.logged() == 0);
+
+    snapshot = log.snapshot();
+    p = find(snapshot, early);
+    CHECK(p->itinerary_version == 7);
+    REQUIRE(p->itinerary.size() == 2);
+
+    // The delay only applies to the routes that came before it
+    CHECK(p->itinerary[0].route->trajectory().begin()->time()
+      == start + 11s);
+    CHECK(p->itinerary[1].route->trajectory().begin()->time() == start);
+  }
+
+  WHEN("A set arrives ahead of the versions before it")
+  {
+    log.record(make_delay(early, 1s, 8));
+    log.record(make_set(early, {{4, route}}, 9));
+    CHECK(log.logged() == 1);
+
+    log.compact();
+    p = find(log.snapshot(), early);
+    CHECK(p->itinerary_version == 9);
+    REQUIRE(p->itinerary.size() == 1);
+    CHECK(p->itinerary.front().id == 4);
+  }
+
+  WHEN("A message is older than the snapshot")
+  {
+    log.record(make_delay(early, 1s, 3));
+    log.compact();
+    CHECK(log.logged() == 0);
+    CHECK(find(log.snapshot(), early)->itinerary_version == 5);
+  }
+
+  WHEN("A participant leaves the schedule")
+  {
+    log.record(make_delay(late, 1s, 3));
+    registered.erase(late);
+    log.participants(registered);
+    CHECK(log.logged() == 0);
+
+    snapshot = log.snapshot();
+    CHECK(snapshot.participants.size() == 1);
+    CHECK_FALSE(find(snapshot, late));
+  }
+
+  WHEN("The snapshot is restored into a database")
+  {
+    rmf_traffic::schedule::Database restored;
+    for (const auto& desc : descriptions)
+      restored.register_participant(desc);
+
+    CHECK(restore_schedule_snapshot(snapshot, restored) == 2);
+    CHECK(restored.itinerary_version(early) == 5);
+    CHECK(restored.last_route_id(early) == 1);
+
+    const auto itinerary = restored.get_itinerary(early);
+    REQUIRE(itinerary.has_value());
+    REQUIRE(itinerary->size() == 1);
+    CHECK(itinerary->front()->trajectory().begin()->time() == start + 10s);
+  }
+}
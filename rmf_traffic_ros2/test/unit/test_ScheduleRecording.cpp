@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic_msgs/msg/itinerary_delay.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ScheduleRecording.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Schedule recordings can be read back")
+{
+  const std::string file = "test_schedule_recording.bin";
+  std::filesystem::remove(file);
+  CHECK_THROWS_AS(ScheduleRecordingReader(file), ScheduleRecordingError);
+
+  rmf_traffic_msgs::msg::ItineraryDelay delay;
+  delay.participant = 3;
+  delay.delay = 250;
+  delay.itinerary_version = 7;
+
+  {
+    ScheduleRecordingWriter writer(file);
+    writer.write(RecordedInput::ItineraryDelay, 10ms, delay);
+    delay.itinerary_version = 8;
+    writer.write(RecordedInput::ItineraryDelay, 20ms, delay);
+  }
+
+  {
+    ScheduleRecordingReader reader(file);
+    const auto first = reader.next();
+    REQUIRE(first.has_value());
+    CHECK(first->input == RecordedInput::ItineraryDelay);
+    CHECK(first->time == 10ms);
+
+    const auto first_msg =
+      decode_recorded_message<rmf_traffic_msgs::msg::ItineraryDelay>(*first);
+    CHECK(first_msg.participant == 3);
+    CHECK(first_msg.delay == 250);
+    CHECK(first_msg.itinerary_version == 7);
+
+    const auto second = reader.next();
+    REQUIRE(second.has_value());
+    CHECK(second->time == 20ms);
+    CHECK(
+      decode_recorded_message<rmf_traffic_msgs::msg::ItineraryDelay>(*second)
+      .itinerary_version == 8);
+
+    CHECK_FALSE(reader.next().has_value());
+  }
+
+  GIVEN("A recording whose last record was cut short")
+  {
+    std::filesystem::resize_file(file, std::filesystem::file_size(file) - 1);
+
+    ScheduleRecordingReader reader(file);
+    CHECK(reader.next().has_value());
+    CHECK_FALSE(reader.next().has_value());
+  }
+
+  GIVEN("A recording that has been corrupted")
+  {
+    {
+      std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+      f.seekp(-1, std::ios::end);
+      f.put('\xFF');
+    }
+
+    ScheduleRecordingReader reader(file);
+    CHECK(reader.next().has_value());
+    CHECK_THROWS_AS(reader.next(), ScheduleRecordingError);
+  }
+
+  GIVEN("A file that is not a recording")
+  {
+    {
+      std::ofstream f(file, std::ios::trunc);
+      f << "- not a recording";
+    }
+
+    CHECK_THROWS_AS(ScheduleRecordingReader(file), ScheduleRecordingError);
+  }
+
+  std::filesystem::remove(file);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ScheduleRetention.hpp"
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Memory budget cull times")
+{
+  const auto t = [](const int seconds)
+    {
+      return rmf_traffic::Time(std::chrono::seconds(seconds));
+    };
+
+  const std::vector<RouteFootprint> routes = {
+    {t(30), 100},
+    {t(10), 100},
+    {t(20), 100},
+    {t(40), 100}
+  };
+
+  CHECK_FALSE(choose_budget_cull_time(routes, 400, t(100)).has_value());
+  CHECK_FALSE(choose_budget_cull_time({}, 0, t(100)).has_value());
+
+  const auto one = choose_budget_cull_time(routes, 350, t(100));
+  REQUIRE(one.has_value());
+  CHECK(t(10) < *one);
+  CHECK(*one < t(20));
+
+  const auto two = choose_budget_cull_time(routes, 200, t(100));
+  REQUIRE(two.has_value());
+  CHECK(t(20) < *two);
+  CHECK(*two < t(30));
+
+  WHEN("The budget can only be met by culling routes that are still needed")
+  {
+    const auto limited = choose_budget_cull_time(routes, 0, t(25));
+    REQUIRE(limited.has_value());
+    CHECK(t(20) < *limited);
+    CHECK(*limited < t(30));
+
+    CHECK_FALSE(choose_budget_cull_time(routes, 0, t(10)).has_value());
+  }
+}
+
+//==============================================================================
+SCENARIO("Route size estimates grow with the trajectory")
+{
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(rmf_traffic::Time(0s), {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+  const rmf_traffic::Route short_route("L1", trajectory);
+
+  trajectory.insert(rmf_traffic::Time(10s), {1.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+  const rmf_traffic::Route long_route("L1", trajectory);
+
+  CHECK(estimate_route_bytes(short_route) < estimate_route_bytes(long_route));
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ScheduleShards.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+
+namespace {
+//==============================================================================
+rmf_traffic_msgs::msg::ScheduleWriterItem make_item(
+  uint64_t id, const std::string& map)
+{
+  rmf_traffic_msgs::msg::ScheduleWriterItem item;
+  item.id = id;
+  item.route.map = map;
+  return item;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Schedule shards are parsed from their parameter")
+{
+  const ScheduleShards shards({"building_a:L1,L2", "building_b:B1"});
+  CHECK(shards.size() == 3);
+  CHECK(shards.name(0).empty());
+  CHECK(shards.name(1) == "building_a");
+  CHECK(shards.name(2) == "building_b");
+  CHECK(shards.shard_of("L1") == 1);
+  CHECK(shards.shard_of("L2") == 1);
+  CHECK(shards.shard_of("B1") == 2);
+  CHECK(shards.shard_of("parking") == 0);
+
+  CHECK(ScheduleShards().size() == 1);
+  CHECK_THROWS_AS(ScheduleShards({"L1,L2"}), ScheduleShardsError);
+  CHECK_THROWS_AS(ScheduleShards({":L1"}), ScheduleShardsError);
+  CHECK_THROWS_AS(ScheduleShards({"a:L1", "b:L1"}), ScheduleShardsError);
+
+  CHECK(shard_topic_name("", "rmf_traffic/x") == "rmf_traffic/x");
+  CHECK(shard_topic_name("a", "rmf_traffic/x") == "a/rmf_traffic/x");
+  CHECK(shard_topic_name("/", "rmf_traffic/x") == "/rmf_traffic/x");
+}
+
+//==============================================================================
+SCENARIO("Itineraries are split across the shards by map")
+{
+  ItineraryRouter router(ScheduleShards({"a:L1", "b:L2"}));
+
+  ItineraryRouter::Set set;
+  set.participant = 7;
+  set.itinerary_version = 3;
+  set.itinerary = {make_item(0, "L1"), make_item(1, "L2"), make_item(2, "L1")};
+
+  const auto sets = router.split(set);
+  REQUIRE(sets.size() == 3);
+  CHECK(sets[0].itinerary.empty());
+  REQUIRE(sets[1].itinerary.size() == 2);
+  CHECK(sets[1].itinerary[0].id == 0);
+  CHECK(sets[1].itinerary[1].id == 2);
+  REQUIRE(sets[2].itinerary.size() == 1);
+  CHECK(sets[2].itinerary[0].id == 1);
+  for (const auto& msg : sets)
+  {
+    CHECK(msg.participant == 7);
+    CHECK(msg.itinerary_version == 3);
+  }
+
+  ItineraryRouter::Extend extend;
+  extend.participant = 7;
+  extend.itinerary_version = 4;
+  extend.routes = {make_item(3, "parking")};
+
+  const auto extends = router.split(extend);
+  REQUIRE(extends.size() == 3);
+  CHECK(extends[0].routes.size() == 1);
+  CHECK(extends[1].routes.empty());
+  CHECK(extends[2].routes.empty());
+
+  ItineraryRouter::Erase erase;
+  erase.participant = 7;
+  erase.itinerary_version = 5;
+  erase.routes = {1, 3, 9};
+
+  const auto erases = router.split(erase);
+  REQUIRE(erases.size() == 3);
+  CHECK(erases[0].routes == std::vector<uint64_t>({3, 9}));
+  CHECK(erases[1].routes == std::vector<uint64_t>({9}));
+  CHECK(erases[2].routes == std::vector<uint64_t>({1, 9}));
+  for (const auto& msg : erases)
+    CHECK(msg.itinerary_version == 5);
+
+  WHEN("The participant is given a new itinerary")
+  {
+    set.itinerary = {make_item(4, "L2")};
+    set.itinerary_version = 6;
+    router.split(set);
+
+    erase.routes = {0};
+    erase.itinerary_version = 7;
+    const auto forgotten = router.split(erase);
+
+    // Route 0 was replaced by the set, so every shard is told to erase it
+    for (const auto& msg : forgotten)
+      CHECK(msg.routes == std::vector<uint64_t>({0}));
+  }
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/ScheduleSnapshot.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Schedule snapshots restore itineraries and queries")
+{
+  const std::string file = "test_schedule_snapshot.bin";
+  std::filesystem::remove(file);
+  CHECK_FALSE(read_schedule_snapshot(file).has_value());
+
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(0.5);
+
+  std::vector<rmf_traffic::schedule::ParticipantDescription> descriptions;
+  for (const auto& name : {"busy", "idle", "cleared"})
+  {
+    descriptions.emplace_back(
+      name,
+      "test_ScheduleSnapshot",
+      rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+      rmf_traffic::Profile{shape});
+  }
+
+  rmf_traffic::schedule::Database original;
+  std::vector<rmf_traffic::schedule::ParticipantId> ids;
+  for (const auto& desc : descriptions)
+    ids.push_back(original.register_participant(desc).id());
+
+  const auto start = rmf_traffic::Time(1000s);
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {0.0, 0.0, 0.0}, {1.0, 0.0, 0.0});
+  trajectory.insert(start + 10s, {10.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+
+  original.set(
+    ids[0],
+    {
+      {3, std::make_shared<rmf_traffic::Route>("L1", trajectory)},
+      {7, std::make_shared<rmf_traffic::Route>("L2", trajectory)}
+    },
+    4);
+  original.delay(ids[0], 5s, 5);
+
+  original.set(
+    ids[2], {{0, std::make_shared<rmf_traffic::Route>("L1", trajectory)}}, 1);
+  original.erase(ids[2], 2);
+
+  std::unordered_map<uint64_t, rmf_traffic::schedule::Query> queries;
+  queries.insert({12, rmf_traffic::schedule::query_all()});
+
+  write_schedule_snapshot(
+    file, take_schedule_snapshot(original, queries, 3));
+
+  const auto snapshot = read_schedule_snapshot(file);
+  REQUIRE(snapshot.has_value());
+  CHECK(snapshot->node_version == 3);
+  CHECK(snapshot->database_version == original.latest_version());
+  CHECK(snapshot->participants.size() == 3);
+  REQUIRE(snapshot->queries.size() == 1);
+  CHECK(snapshot->queries.at(12) == rmf_traffic::schedule::query_all());
+
+  rmf_traffic::schedule::Database restored;
+  for (const auto& desc : descriptions)
+    restored.register_participant(desc);
+
+  CHECK(restore_schedule_snapshot(*snapshot, restored) == 3);
+
+  for (const auto id : ids)
+    CHECK(restored.itinerary_version(id) == original.itinerary_version(id));
+
+  const auto itinerary = restored.get_itinerary(ids[0]);
+  REQUIRE(itinerary.has_value());
+  REQUIRE(itinerary->size() == 2);
+  CHECK(restored.last_route_id(ids[0]) == 7);
+
+  const auto& restored_trajectory = itinerary->front()->trajectory();
+  REQUIRE(restored_trajectory.size() == trajectory.size());
+  CHECK(restored_trajectory.begin()->time() == start + 5s);
+
+  CHECK(restored.get_itinerary(ids[1])->empty());
+  CHECK(restored.get_itinerary(ids[2])->empty());
+
+  GIVEN("A database whose participants do not match")
+  {
+    rmf_traffic::schedule::Database other;
+    const auto other_id = other.register_participant(descriptions[1]).id();
+    other.set(
+      other_id, {{0, std::make_shared<rmf_traffic::Route>("L3", trajectory)}},
+      0);
+
+    CHECK(restore_schedule_snapshot(*snapshot, other) == 0);
+
+    // The database is rebuilt from scratch, so the participant remains but
+    // whatever it held before the restore is gone.
+    REQUIRE(other.get_participant(other_id));
+    CHECK(other.get_participant(other_id)->name() == descriptions[1].name());
+    CHECK(other.get_itinerary(other_id)->empty());
+  }
+
+  GIVEN("A snapshot that has been corrupted")
+  {
+    {
+      std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+      f.seekp(-1, std::ios::end);
+      f.put('\xFF');
+    }
+
+    CHECK_THROWS_AS(read_schedule_snapshot(file), ScheduleSnapshotError);
+  }
+
+  GIVEN("A compact encoding of the snapshot")
+  {
+    const auto encoded = encode_schedule_snapshot(
+      take_schedule_snapshot(original, queries, 3), CompactResolution());
+    const auto full = encode_schedule_snapshot(
+      take_schedule_snapshot(original, queries, 3));
+    CHECK(encoded.size() < full.size());
+
+    const auto compact = decode_schedule_snapshot(
+      encoded.data(), encoded.size(), "compact");
+    CHECK(compact.database_version == original.latest_version());
+    REQUIRE(compact.participants.size() == 3);
+
+    rmf_traffic::schedule::Database decoded;
+    for (const auto& desc : descriptions)
+      decoded.register_participant(desc);
+
+    CHECK(restore_schedule_snapshot(compact, decoded) == 3);
+    const auto compact_itinerary = decoded.get_itinerary(ids[0]);
+    REQUIRE(compact_itinerary.has_value());
+    REQUIRE(compact_itinerary->size() == 2);
+    CHECK(compact_itinerary->front()->map() == "L1");
+
+    const auto& t = compact_itinerary->front()->trajectory();
+    REQUIRE(t.size() == trajectory.size());
+    CHECK(t.begin()->time() == start + 5s);
+    CHECK((t.back().position() - trajectory.back().position()).norm()
+      == Approx(0.0).margin(1e-3));
+  }
+
+  GIVEN("A file that is not a snapshot")
+  {
+    {
+      std::ofstream f(file, std::ios::trunc);
+      f << "- not a snapshot";
+    }
+
+    CHECK_THROWS_AS(read_schedule_snapshot(file), ScheduleSnapshotError);
+  }
+
+  std::filesystem::remove(file);
+}
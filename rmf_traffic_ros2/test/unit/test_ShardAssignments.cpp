@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/blockade/ShardAssignments.hpp"
+#include "../../src/rmf_traffic_ros2/schedule/ScheduleShards.hpp"
+
+using rmf_traffic_ros2::blockade::ShardAssignments;
+using ParticipantSet = std::unordered_set<ShardAssignments::ParticipantId>;
+
+//==============================================================================
+SCENARIO("Blockade participants follow their reservations between shards")
+{
+  const rmf_traffic_ros2::schedule::ScheduleShards shards(
+    {"north:L1,L2", "south:L3"});
+  REQUIRE(shards.size() == 3);
+
+  ShardAssignments assignments;
+
+  // A participant that has never set a reservation belongs to shard 0
+  CHECK(assignments.get(7) == 0);
+
+  // The first reservation of a participant does not move it away from any
+  // other shard
+  const auto north = shards.shard_of("L2");
+  CHECK_FALSE(assignments.assign(7, north).has_value());
+  CHECK(assignments.get(7) == north);
+
+  // Another reservation in the same shard changes nothing
+  CHECK_FALSE(assignments.assign(7, shards.shard_of("L1")).has_value());
+
+  WHEN("A reservation begins on a map of another shard")
+  {
+    const auto south = shards.shard_of("L3");
+    REQUIRE(south != north);
+    const auto previous = assignments.assign(7, south);
+
+    THEN("The old shard is reported so that it can cancel the participant")
+    {
+      REQUIRE(previous.has_value());
+      CHECK(*previous == north);
+      CHECK(assignments.get(7) == south);
+    }
+  }
+
+  WHEN("A reservation begins on a map that no shard lists")
+  {
+    const auto previous = assignments.assign(7, shards.shard_of("L9"));
+
+    THEN("The participant goes back to the blockade node of the writer")
+    {
+      REQUIRE(previous.has_value());
+      CHECK(*previous == north);
+      CHECK(assignments.get(7) == 0);
+    }
+  }
+
+  WHEN("The heartbeat of a shard checks the participants that changed")
+  {
+    const auto south = shards.shard_of("L3");
+    assignments.assign(8, south);
+    assignments.assign(9, north);
+
+    ParticipantSet dirty = {3, 7, 8, 9};
+    const auto taken = assignments.take_shard(dirty, north);
+
+    THEN("Only the participants of that shard are taken")
+    {
+      CHECK(taken == ParticipantSet({7, 9}));
+      CHECK(dirty == ParticipantSet({3, 8}));
+
+      CHECK(assignments.take_shard(dirty, 0) == ParticipantSet({3}));
+      CHECK(dirty == ParticipantSet({8}));
+    }
+  }
+}
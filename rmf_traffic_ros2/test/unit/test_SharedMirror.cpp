@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_traffic/schedule/Database.hpp>
+#include <rmf_traffic_ros2/schedule/SharedMirror.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include <filesystem>
+
+using namespace std::chrono_literals;
+using namespace rmf_traffic_ros2::schedule;
+
+//==============================================================================
+SCENARIO("Shared mirrors follow the snapshots of a publisher")
+{
+  const std::string segment = "test_rmf_traffic_ros2_shared_mirror";
+  std::filesystem::remove("/dev/shm/" + segment);
+  CHECK(SharedMirror::make(segment) == nullptr);
+
+  SharedMirrorPublisher publisher(segment, 1024*1024);
+  CHECK(publisher.stamp() == 0);
+
+  const auto reader = SharedMirror::make(segment);
+  REQUIRE(reader);
+  CHECK(reader->stamp() == 0);
+  CHECK(reader->snapshot()->participant_ids().empty());
+
+  const auto shape = rmf_traffic::geometry::make_final_convex<
+    rmf_traffic::geometry::Circle>(0.5);
+
+  rmf_traffic::schedule::Database database;
+  const auto id = database.register_participant(
+    rmf_traffic::schedule::ParticipantDescription(
+      "robot",
+      "test_SharedMirror",
+      rmf_traffic::schedule::ParticipantDescription::Rx::Responsive,
+      rmf_traffic::Profile{shape})).id();
+
+  const auto start = rmf_traffic::Time(1000s);
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {0.0, 0.0, 0.0}, {1.0, 0.0, 0.0});
+  trajectory.insert(start + 10s, {10.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+  database.set(
+    id, {{0, std::make_shared<rmf_traffic::Route>("L1", trajectory)}}, 1);
+
+  REQUIRE(publisher.publish(database));
+  CHECK(publisher.stamp() == 1);
+  CHECK(reader->stamp() == 1);
+
+  const auto first = reader->snapshot();
+  CHECK(first->participant_ids().count(id) == 1);
+  REQUIRE(first->get_participant(id));
+  CHECK(first->get_participant(id)->name() == "robot");
+  const auto itinerary = first->get_itinerary(id);
+  REQUIRE(itinerary.has_value());
+  REQUIRE(itinerary->size() == 1);
+  CHECK(itinerary->front()->map() == "L1");
+
+  // Nothing new has been published, so the same snapshot is handed out
+  CHECK(reader->snapshot() == first);
+
+  database.delay(id, 5s, 2);
+  REQUIRE(publisher.publish(database));
+  CHECK(reader->stamp() == 2);
+
+  const auto second = reader->snapshot();
+  CHECK(second != first);
+  const auto delayed = second->get_itinerary(id);
+  REQUIRE(delayed.has_value());
+  REQUIRE(delayed->size() == 1);
+  CHECK(delayed->front()->trajectory().begin()->time() == start + 5s);
+
+  GIVEN("A second publisher that takes over the segment")
+  {
+    SharedMirrorPublisher replacement(segment, 1024);
+    CHECK(replacement.stamp() == 2);
+    CHECK(reader->snapshot() == second);
+  }
+
+  GIVEN("A snapshot that does not fit in the segment")
+  {
+    const std::string small_segment = "test_rmf_traffic_ros2_small_mirror";
+    std::filesystem::remove("/dev/shm/" + small_segment);
+
+    SharedMirrorPublisher small(small_segment, 16);
+    CHECK_FALSE(small.publish(database));
+    CHECK(small.stamp() == 0);
+    std::filesystem::remove("/dev/shm/" + small_segment);
+  }
+
+  std::filesystem::remove("/dev/shm/" + segment);
+}
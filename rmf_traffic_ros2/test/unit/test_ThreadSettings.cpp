@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include <rmf_traffic_ros2/ThreadSettings.hpp>
+
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace rmf_traffic_ros2;
+
+//==============================================================================
+SCENARIO("Default thread settings leave the thread alone")
+{
+  ThreadSettings settings;
+  CHECK(settings.is_default());
+  CHECK(settings.apply().empty());
+
+  settings.niceness = 1;
+  CHECK_FALSE(settings.is_default());
+}
+
+#ifdef __linux__
+//==============================================================================
+SCENARIO("Thread settings apply to the calling thread only")
+{
+  const auto self_tid = static_cast<id_t>(syscall(SYS_gettid));
+  const int original_niceness = getpriority(PRIO_PROCESS, self_tid);
+
+  ThreadSettings settings;
+  settings.cpu_affinity = {sched_getcpu()};
+  settings.niceness = original_niceness + 3;
+
+  std::string failures;
+  int applied_niceness = 0;
+  cpu_set_t applied_affinity;
+  CPU_ZERO(&applied_affinity);
+  std::thread thread([&]()
+    {
+      failures = settings.apply();
+      const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+      applied_niceness = getpriority(PRIO_PROCESS, tid);
+      sched_getaffinity(0, sizeof(applied_affinity), &applied_affinity);
+    });
+  thread.join();
+
+  CHECK(failures.empty());
+  CHECK(applied_niceness == original_niceness + 3);
+  CHECK(CPU_COUNT(&applied_affinity) == 1);
+  CHECK(CPU_ISSET(settings.cpu_affinity.front(), &applied_affinity));
+  CHECK(getpriority(PRIO_PROCESS, self_tid) == original_niceness);
+
+  ThreadSettings impossible;
+  impossible.cpu_affinity = {-1};
+  CHECK_FALSE(impossible.apply().empty());
+}
+#endif
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_utils/catch.hpp>
+
+#include "../../src/rmf_traffic_ros2/schedule/TimeoutWheel.hpp"
+
+using namespace rmf_traffic_ros2::schedule;
+using namespace std::chrono_literals;
+
+//==============================================================================
+SCENARIO("Timeout wheel fires each timeout once, after its deadline")
+{
+  const auto start = std::chrono::steady_clock::now();
+  TimeoutWheel wheel(100ms, 4, 3);
+  CHECK(wheel.empty());
+
+  std::vector<int> fired;
+  const std::vector<rmf_traffic::Duration> timeouts = {
+    50ms, 300ms, 1s, 2500ms, 15s
+  };
+
+  for (std::size_t i = 0; i < timeouts.size(); ++i)
+    wheel.schedule(start, timeouts[i], [&fired, i]() { fired.push_back(i); });
+
+  CHECK(wheel.size() == timeouts.size());
+
+  // Step through time in small increments and make sure that each timeout
+  // fires no earlier than its deadline and no later than one tick after it.
+  for (auto t = start; t < start + 20s; t += 10ms)
+  {
+    for (const auto& cb : wheel.advance(t))
+    {
+      cb();
+      const auto& timeout = timeouts[fired.back()];
+      CHECK(start + timeout <= t);
+      CHECK(t <= start + timeout + wheel.resolution() + 10ms);
+    }
+  }
+
+  CHECK(fired == std::vector<int>({0, 1, 2, 3, 4}));
+  CHECK(wheel.empty());
+}
+
+//==============================================================================
+SCENARIO("Timeout wheel catches up after sitting idle")
+{
+  const auto start = std::chrono::steady_clock::now();
+  TimeoutWheel wheel;
+
+  int fired = 0;
+  wheel.schedule(start, 1s, [&]() { ++fired; });
+  CHECK(wheel.advance(start + 500ms).empty());
+
+  for (const auto& cb : wheel.advance(start + 1100ms))
+    cb();
+  CHECK(fired == 1);
+
+  // Nothing has advanced the wheel for a long time, but a new timeout should
+  // still be measured from the time that it was scheduled.
+  const auto later = start + 1h;
+  wheel.schedule(later, 200ms, [&]() { ++fired; });
+  CHECK(wheel.advance(later + 100ms).empty());
+  for (const auto& cb : wheel.advance(later + 300ms))
+    cb();
+
+  CHECK(fired == 2);
+  CHECK(wheel.empty());
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_utils/catch.hpp>
+
+#include <rmf_traffic_ros2/Tracer.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace rmf_traffic_ros2;
+
+//==============================================================================
+SCENARIO("Spans with the same correlation ID share a trace")
+{
+  const auto task_trace = Tracer::trace_id(tracing::task("delivery0"));
+  CHECK(task_trace.size() == 32);
+  CHECK(task_trace == Tracer::trace_id(tracing::task("delivery0")));
+  CHECK(task_trace != Tracer::trace_id(tracing::task("delivery1")));
+  CHECK(tracing::itinerary(3, 7) == "itinerary:3:7");
+  CHECK(tracing::negotiation(12) == "negotiation:12");
+}
+
+//==============================================================================
+SCENARIO("Tracer exports spans as OTLP/JSON")
+{
+  const std::string file = "test_Tracer_spans.jsonl";
+  std::remove(file.c_str());
+
+  const auto tracer = Tracer::make("/dispatcher_node", file, "");
+  {
+    auto span = tracer->start(
+      "dispatcher.assign", tracing::task("delivery0"), {{"rmf.fleet", "a"}});
+    CHECK(span.active());
+    span.attribute("rmf.outcome", "awarded");
+
+    Tracer::Span moved = std::move(span);
+    CHECK_FALSE(span.active());
+    CHECK(moved.active());
+  }
+
+  const auto now = std::chrono::system_clock::now();
+  tracer->record(
+    "auctioneer.auction", tracing::task("delivery0"),
+    now - std::chrono::seconds(2), now);
+
+  Tracer::Span inactive;
+  CHECK_FALSE(inactive.active());
+  inactive.end();
+
+  tracer->flush();
+
+  std::ifstream input(file);
+  std::string json;
+  std::string line;
+  while (std::getline(input, line))
+    json += line;
+
+  CHECK(json.find("\"resourceSpans\"") != std::string::npos);
+  CHECK(json.find("\"stringValue\":\"/dispatcher_node\"") != std::string::npos);
+  CHECK(json.find("\"name\":\"dispatcher.assign\"") != std::string::npos);
+  CHECK(json.find("\"name\":\"auctioneer.auction\"") != std::string::npos);
+  CHECK(json.find("\"stringValue\":\"awarded\"") != std::string::npos);
+
+  // Both spans are part of the trace of the task
+  const auto trace = "\"traceId\":\""
+    + Tracer::trace_id(tracing::task("delivery0")) + "\"";
+  const auto first = json.find(trace);
+  REQUIRE(first != std::string::npos);
+  CHECK(json.find(trace, first + 1) != std::string::npos);
+
+  std::remove(file.c_str());
+}
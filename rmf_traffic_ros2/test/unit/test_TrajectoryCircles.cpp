@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <rmf_traffic/DetectConflict.hpp>
+#include <rmf_traffic/geometry/Circle.hpp>
+#include <rmf_utils/catch.hpp>
+
+#include <rmf_traffic_ros2/TrajectoryCircles.hpp>
+
+using namespace std::chrono_literals;
+using rmf_traffic_ros2::TrajectoryCircles;
+
+namespace {
+//==============================================================================
+rmf_traffic::Trajectory make_line(
+  const rmf_traffic::Time start,
+  const Eigen::Vector2d p0,
+  const Eigen::Vector2d p1,
+  const rmf_traffic::Duration duration)
+{
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(start, {p0.x(), p0.y(), 0.0}, Eigen::Vector3d::Zero());
+  trajectory.insert(
+    start + duration, {p1.x(), p1.y(), 0.0}, Eigen::Vector3d::Zero());
+  return trajectory;
+}
+} // anonymous namespace
+
+//==============================================================================
+SCENARIO("Segment circles rule out trajectories that stay apart")
+{
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.5)};
+  CHECK(TrajectoryCircles::radius(profile) == Approx(0.5));
+
+  const auto start = rmf_traffic::Time(100s);
+  const auto east = make_line(start, {0, 0}, {10, 0}, 10s);
+  const TrajectoryCircles east_circles(east, profile);
+  CHECK(east_circles.size() == 1);
+
+  const auto parallel = make_line(start, {0, 5}, {10, 5}, 10s);
+  CHECK_FALSE(
+    east_circles.might_conflict(TrajectoryCircles(parallel, profile)));
+  CHECK_FALSE(rmf_traffic::DetectConflict::between(
+      profile, east, profile, parallel).has_value());
+
+  const auto crossing = make_line(start, {5, -5}, {5, 5}, 10s);
+  CHECK(east_circles.might_conflict(TrajectoryCircles(crossing, profile)));
+  CHECK(rmf_traffic::DetectConflict::between(
+      profile, east, profile, crossing).has_value());
+
+  // The same path at a time when the other robot is no longer on it
+  const auto later = make_line(start + 20s, {5, -5}, {5, 5}, 10s);
+  CHECK_FALSE(east_circles.might_conflict(TrajectoryCircles(later, profile)));
+
+  // A trajectory with a single waypoint cannot be bounded
+  rmf_traffic::Trajectory single;
+  single.insert(start, {50, 50, 0}, Eigen::Vector3d::Zero());
+  CHECK(east_circles.might_conflict(TrajectoryCircles(single, profile)));
+}
+
+//==============================================================================
+SCENARIO("Segment circles never miss a conflict")
+{
+  const rmf_traffic::Profile profile{
+    rmf_traffic::geometry::make_final_convex<
+      rmf_traffic::geometry::Circle>(0.3)};
+
+  const auto start = rmf_traffic::Time(0s);
+
+  // Curved segments bulge out of the line between their waypoints, so the
+  // circles have to account for the velocities at the waypoints
+  rmf_traffic::Trajectory curve;
+  curve.insert(start, {0, 0, 0}, {0, 4, 0});
+  curve.insert(start + 5s, {10, 0, 0}, {0, -4, 0});
+  curve.insert(start + 10s, {20, 0, 0}, {0, 0, 0});
+  const TrajectoryCircles curve_circles(curve, profile);
+  CHECK(curve_circles.size() == 2);
+
+  for (int i = 0; i <= 20; ++i)
+  {
+    const double x = static_cast<double>(i);
+    for (const double y : {-3.0, -1.0, 0.0, 1.0, 3.0, 5.0, 8.0})
+    {
+      rmf_traffic::Trajectory still;
+      still.insert(start, {x, y, 0}, Eigen::Vector3d::Zero());
+      still.insert(start + 10s, {x, y, 0}, Eigen::Vector3d::Zero());
+
+      if (rmf_traffic::DetectConflict::between(
+          profile, curve, profile, still).has_value())
+      {
+        CHECK(curve_circles.might_conflict(TrajectoryCircles(still, profile)));
+      }
+    }
+  }
+}
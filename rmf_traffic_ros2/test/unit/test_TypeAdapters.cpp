@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <rmf_traffic_ros2/TypeAdapters.hpp>
+#include <rmf_utils/catch.hpp>
+
+#ifdef RMF_TRAFFIC_ROS2__HAS_TYPE_ADAPTERS
+
+using namespace std::chrono_literals;
+
+//==============================================================================
+SCENARIO("Type adapters convert rmf_traffic types like convert() does")
+{
+  rmf_traffic::Trajectory trajectory;
+  trajectory.insert(rmf_traffic::Time(10s), {0.0, 0.0, 0.0}, {1.0, 0.0, 0.0});
+  trajectory.insert(rmf_traffic::Time(20s), {10.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+
+  rmf_traffic_msgs::msg::Trajectory trajectory_msg;
+  rmf_traffic_ros2::TrajectoryTypeAdapter::convert_to_ros_message(
+    trajectory, trajectory_msg);
+  CHECK(trajectory_msg == rmf_traffic_ros2::convert(trajectory));
+
+  rmf_traffic::Trajectory trajectory_out;
+  rmf_traffic_ros2::TrajectoryTypeAdapter::convert_to_custom(
+    trajectory_msg, trajectory_out);
+  REQUIRE(trajectory_out.size() == trajectory.size());
+  CHECK(trajectory_out.back().time() == trajectory.back().time());
+  CHECK((trajectory_out.back().position() - trajectory.back().position())
+    .norm() == Approx(0.0));
+
+  const auto route = std::make_shared<const rmf_traffic::Route>(
+    "L1", trajectory);
+
+  rmf_traffic_msgs::msg::Route route_msg;
+  rmf_traffic_ros2::RouteTypeAdapter::convert_to_ros_message(route, route_msg);
+  CHECK(route_msg.map == "L1");
+
+  std::shared_ptr<const rmf_traffic::Route> route_out;
+  rmf_traffic_ros2::RouteTypeAdapter::convert_to_custom(route_msg, route_out);
+  REQUIRE(route_out);
+  CHECK(route_out->map() == "L1");
+  CHECK(route_out->trajectory().size() == trajectory.size());
+}
+
+#endif // RMF_TRAFFIC_ROS2__HAS_TYPE_ADAPTERS